@@ -0,0 +1,68 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AUDIO_SAMPLE_ACCUM__H
+#define __AUDIO_SAMPLE_ACCUM__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <retro_common_api.h>
+#include <retro_inline.h>
+
+RETRO_BEGIN_DECLS
+
+/**
+ * audio_sample_rewind_fill:
+ * @buf                  : rewind buffer, filled from the back.
+ * @ptr                  : current front of the filled part of @buf,
+ *                         in samples. Moves towards zero.
+ * @in                   : interleaved stereo s16 input.
+ * @frames               : number of frames in @in.
+ *
+ * Stores @frames in reverse frame order in front of *@ptr, so that
+ * reading @buf forwards from *@ptr plays the audio backwards. The
+ * channel order within each frame is kept. Everything that fits
+ * is copied in one branch-free loop; frames beyond the start of
+ * @buf are dropped.
+ *
+ * Returns: number of frames stored.
+ **/
+static INLINE size_t audio_sample_rewind_fill(int16_t *buf, size_t *ptr,
+      const int16_t *in, size_t frames)
+{
+   size_t i;
+   int16_t *dst;
+
+   if (frames > (*ptr >> 1))
+      frames   = *ptr >> 1;
+   if (!frames)
+      return 0;
+
+   dst         = buf + *ptr - 2;
+
+   for (i = 0; i < frames; i++, in += 2, dst -= 2)
+   {
+      dst[0]   = in[0];
+      dst[1]   = in[1];
+   }
+
+   *ptr       -= frames << 1;
+
+   return frames;
+}
+
+RETRO_END_DECLS
+
+#endif
@@ -303,7 +303,8 @@ bool audio_init_thread(const audio_driver_t **out_driver,
    thr->alive          = true;
    thr->stopped        = true;
 
-   if (!(thr->thread   = sthread_create(audio_thread_loop, thr)))
+   if (!(thr->thread   = sthread_create_with_role(audio_thread_loop, thr,
+               STHREAD_ROLE_AUDIO)))
       goto error;
 
    /* Wait until thread has initialized (or failed) the driver. */
@@ -325,3 +326,182 @@ error:
    audio_thread_free(thr);
    return false;
 }
+
+struct audio_flush_thread
+{
+   audio_flush_thread_cb_t cb;
+   void *userdata;
+
+   sthread_t *thread;
+   /* Protects the queue and the flags below. */
+   slock_t *lock;
+   /* Held while a chunk is being processed. */
+   slock_t *process_lock;
+   scond_t *cond;
+   scond_t *cond_space;
+   fifo_buffer_t *queue;
+   int16_t *buffer;
+
+   size_t max_samples;
+   /* Bumped by audio_flush_thread_clear(), so a chunk that was
+    * taken off the queue before the clear is dropped, too. */
+   unsigned generation;
+
+   bool alive;
+};
+
+static void audio_flush_thread_loop(void *data)
+{
+   audio_flush_thread_t *thr = (audio_flush_thread_t*)data;
+
+   for (;;)
+   {
+      audio_flush_chunk_t chunk;
+      unsigned generation;
+
+      slock_lock(thr->lock);
+
+      while (thr->alive && FIFO_READ_AVAIL(thr->queue) == 0)
+         scond_wait(thr->cond, thr->lock);
+
+      if (!thr->alive)
+      {
+         slock_unlock(thr->lock);
+         break;
+      }
+
+      fifo_read(thr->queue, &chunk, sizeof(chunk));
+      fifo_read(thr->queue, thr->buffer, chunk.samples * sizeof(int16_t));
+      generation = thr->generation;
+
+      scond_signal(thr->cond_space);
+      slock_unlock(thr->lock);
+
+      slock_lock(thr->process_lock);
+      if (generation == thr->generation)
+         thr->cb(thr->userdata, &chunk, thr->buffer);
+      slock_unlock(thr->process_lock);
+   }
+}
+
+audio_flush_thread_t *audio_flush_thread_new(size_t max_samples,
+      audio_flush_thread_cb_t cb, void *userdata)
+{
+   size_t chunk_size         = sizeof(audio_flush_chunk_t)
+      + max_samples * sizeof(int16_t);
+   audio_flush_thread_t *thr = (audio_flush_thread_t*)
+      calloc(1, sizeof(*thr));
+
+   if (!thr)
+      return NULL;
+
+   thr->cb                   = cb;
+   thr->userdata             = userdata;
+   thr->max_samples          = max_samples;
+   thr->alive                = true;
+
+   if (!(thr->buffer         = (int16_t*)malloc(
+               max_samples * sizeof(int16_t))))
+      goto error;
+   /* Room for one chunk being written while another waits. */
+   if (!(thr->queue          = fifo_new(chunk_size * 2 + 1)))
+      goto error;
+   if (!(thr->lock           = slock_new()))
+      goto error;
+   if (!(thr->process_lock   = slock_new()))
+      goto error;
+   if (!(thr->cond           = scond_new()))
+      goto error;
+   if (!(thr->cond_space     = scond_new()))
+      goto error;
+   if (!(thr->thread         = sthread_create_with_role(
+               audio_flush_thread_loop, thr, STHREAD_ROLE_AUDIO)))
+      goto error;
+
+   return thr;
+
+error:
+   audio_flush_thread_free(thr);
+   return NULL;
+}
+
+bool audio_flush_thread_push(audio_flush_thread_t *thr,
+      const audio_flush_chunk_t *chunk, const int16_t *data,
+      bool blocking)
+{
+   size_t size = sizeof(*chunk) + chunk->samples * sizeof(int16_t);
+
+   if (chunk->samples > thr->max_samples)
+      return false;
+
+   slock_lock(thr->lock);
+
+   if (blocking)
+   {
+      while (thr->alive && FIFO_READ_AVAIL(thr->queue) != 0)
+         scond_wait(thr->cond_space, thr->lock);
+   }
+
+   if (!thr->alive || FIFO_WRITE_AVAIL(thr->queue) < size)
+   {
+      slock_unlock(thr->lock);
+      return false;
+   }
+
+   fifo_write(thr->queue, chunk, sizeof(*chunk));
+   fifo_write(thr->queue, data, chunk->samples * sizeof(int16_t));
+
+   scond_signal(thr->cond);
+   slock_unlock(thr->lock);
+
+   return true;
+}
+
+void audio_flush_thread_lock(audio_flush_thread_t *thr)
+{
+   slock_lock(thr->process_lock);
+}
+
+void audio_flush_thread_unlock(audio_flush_thread_t *thr)
+{
+   slock_unlock(thr->process_lock);
+}
+
+void audio_flush_thread_clear(audio_flush_thread_t *thr)
+{
+   slock_lock(thr->lock);
+   fifo_clear(thr->queue);
+   thr->generation++;
+   scond_signal(thr->cond_space);
+   slock_unlock(thr->lock);
+}
+
+void audio_flush_thread_free(audio_flush_thread_t *thr)
+{
+   if (!thr)
+      return;
+
+   if (thr->thread)
+   {
+      slock_lock(thr->lock);
+      thr->alive = false;
+      scond_signal(thr->cond);
+      scond_signal(thr->cond_space);
+      slock_unlock(thr->lock);
+
+      sthread_join(thr->thread);
+   }
+
+   if (thr->cond_space)
+      scond_free(thr->cond_space);
+   if (thr->cond)
+      scond_free(thr->cond);
+   if (thr->process_lock)
+      slock_free(thr->process_lock);
+   if (thr->lock)
+      slock_free(thr->lock);
+   if (thr->queue)
+      fifo_free(thr->queue);
+   free(thr->buffer);
+   free(thr);
+}
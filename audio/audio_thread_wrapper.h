@@ -17,10 +17,28 @@
 #ifndef RARCH_AUDIO_THREAD_H__
 #define RARCH_AUDIO_THREAD_H__
 
+#include <stdint.h>
+#include <stddef.h>
+
 #include <boolean.h>
 
 #include "../retroarch.h"
 
+typedef struct audio_flush_chunk
+{
+   size_t samples;
+   float slowmotion_ratio;
+   bool fastforward_mute;
+   bool is_slowmotion;
+   bool is_fastmotion;
+} audio_flush_chunk_t;
+
+/* Called on the processing thread for every chunk that was pushed. */
+typedef void (*audio_flush_thread_cb_t)(void *userdata,
+      const audio_flush_chunk_t *chunk, const int16_t *data);
+
+typedef struct audio_flush_thread audio_flush_thread_t;
+
 /**
  * audio_init_thread:
  * @out_driver                : output driver
@@ -42,4 +60,59 @@ bool audio_init_thread(const audio_driver_t **out_driver, void **out_data,
       unsigned block_frames,
       const audio_driver_t *driver);
 
+/**
+ * audio_flush_thread_new:
+ * @max_samples               : largest chunk that will be pushed, in samples
+ * @cb                        : processing callback
+ * @userdata                  : passed to @cb
+ *
+ * Starts a thread that takes raw s16 chunks from the emulation
+ * thread and hands them to @cb, so conversion, DSP, resampling
+ * and the driver write happen off the emulation thread.
+ *
+ * Returns: new handle, or NULL on failure.
+ **/
+audio_flush_thread_t *audio_flush_thread_new(size_t max_samples,
+      audio_flush_thread_cb_t cb, void *userdata);
+
+/**
+ * audio_flush_thread_push:
+ * @thr                       : handle
+ * @chunk                     : chunk parameters, @chunk->samples samples
+ * @data                      : s16 interleaved stereo samples
+ * @blocking                  : wait for the previous chunk to be taken
+ *
+ * Queues a chunk for processing. With @blocking, waits until the
+ * queue is empty first. This keeps audio sync pacing the emulation
+ * thread with at most one chunk of extra latency. Without it, the
+ * chunk is dropped if there is no room.
+ *
+ * Returns: true if the chunk was queued.
+ **/
+bool audio_flush_thread_push(audio_flush_thread_t *thr,
+      const audio_flush_chunk_t *chunk, const int16_t *data,
+      bool blocking);
+
+/**
+ * audio_flush_thread_lock:
+ * @thr                       : handle
+ *
+ * Waits for the chunk being processed, if any, and keeps the
+ * processing thread out of @cb until audio_flush_thread_unlock().
+ * Anything @cb touches may be changed in between.
+ **/
+void audio_flush_thread_lock(audio_flush_thread_t *thr);
+
+void audio_flush_thread_unlock(audio_flush_thread_t *thr);
+
+/**
+ * audio_flush_thread_clear:
+ * @thr                       : handle
+ *
+ * Drops all queued chunks. Must be called with the thread locked.
+ **/
+void audio_flush_thread_clear(audio_flush_thread_t *thr);
+
+void audio_flush_thread_free(audio_flush_thread_t *thr);
+
 #endif
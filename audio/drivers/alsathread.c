@@ -220,7 +220,8 @@ static void *alsa_thread_init(const char *device,
    if (!alsa->fifo_lock || !alsa->cond_lock || !alsa->cond || !alsa->buffer)
       goto error;
 
-   alsa->worker_thread = sthread_create(alsa_worker_thread, alsa);
+   alsa->worker_thread = sthread_create_with_role(alsa_worker_thread, alsa,
+         STHREAD_ROLE_AUDIO);
    if (!alsa->worker_thread)
    {
       RARCH_ERR("error initializing worker thread");
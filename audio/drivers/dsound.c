@@ -239,7 +239,8 @@ static bool dsound_start_thread(dsound_t *ds)
       ds->thread_alive = true;
 
 #ifdef HAVE_THREADS
-      ds->thread       = sthread_create(dsound_thread, ds);
+      ds->thread       = sthread_create_with_role(dsound_thread, ds,
+            STHREAD_ROLE_AUDIO);
 #else
       ds->thread       = CreateThread(NULL, 0, dsound_thread, ds, 0, NULL);
 #endif
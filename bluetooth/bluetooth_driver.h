@@ -29,7 +29,10 @@ enum rarch_bluetooth_ctl_state
    RARCH_BLUETOOTH_CTL_DESTROY,
    RARCH_BLUETOOTH_CTL_DEINIT,
    RARCH_BLUETOOTH_CTL_FIND_DRIVER,
-   RARCH_BLUETOOTH_CTL_INIT
+   RARCH_BLUETOOTH_CTL_INIT,
+   /* Initializes the driver if drivers_init()
+    * deferred it, must be called before first use */
+   RARCH_BLUETOOTH_CTL_INIT_DEFERRED
 };
 
 typedef struct bluetooth_driver
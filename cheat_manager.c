@@ -27,6 +27,11 @@
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
+#include <retro_inline.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -52,6 +57,8 @@
 /* TODO/FIXME - public global variables */
 cheat_manager_t cheat_manager_state;
 
+static void cheat_manager_free_ops(cheat_manager_t *cheat_st);
+
 unsigned cheat_manager_get_buf_size(void)
 {
    cheat_manager_t *cheat_st = &cheat_manager_state;
@@ -83,6 +90,8 @@ void cheat_manager_apply_cheats(void)
    if (!cheat_st->cheats)
       return;
 
+   cheat_st->ops_valid = false;
+
    core_reset_cheat();
 
    for (i = 0; i < cheat_st->size; i++)
@@ -286,6 +295,7 @@ bool cheat_manager_copy_working_to_idx(unsigned idx)
       free(cheat_st->cheats[idx].code);
 
    cheat_st->cheats[idx].code = strdup(cheat_st->working_code);
+   cheat_st->ops_valid        = false;
 
    return true;
 }
@@ -311,6 +321,9 @@ static void cheat_manager_free(void)
    if (cheat_st->prev_memory_buf)
       free(cheat_st->prev_memory_buf);
 
+   if (cheat_st->search_memory_buf)
+      free(cheat_st->search_memory_buf);
+
    if (cheat_st->matches)
       free(cheat_st->matches);
 
@@ -320,10 +333,13 @@ static void cheat_manager_free(void)
    if (cheat_st->memory_size_list)
       free(cheat_st->memory_size_list);
 
+   cheat_manager_free_ops(cheat_st);
+
    cheat_st->cheats                    = NULL;
    cheat_st->size                      = 0;
    cheat_st->buf_size                  = 0;
    cheat_st->prev_memory_buf           = NULL;
+   cheat_st->search_memory_buf         = NULL;
    cheat_st->curr_memory_buf           = NULL;
    cheat_st->memory_buf_list           = NULL;
    cheat_st->memory_size_list          = NULL;
@@ -577,6 +593,7 @@ bool cheat_manager_realloc(unsigned new_size, unsigned default_handler)
 
    cheat_st->buf_size = new_size;
    cheat_st->size     = new_size;
+   cheat_st->ops_valid = false;
 
    for (i = orig_size; i < cheat_st->size; i++)
    {
@@ -621,6 +638,7 @@ void cheat_manager_toggle_index(bool apply_cheats_after_toggle,
       return;
 
    cheat_st->cheats[i].state = !cheat_st->cheats[i].state;
+   cheat_st->ops_valid       = false;
    cheat_manager_update(cheat_st, i);
 
    if (apply_cheats_after_toggle)
@@ -634,6 +652,7 @@ void cheat_manager_toggle(void)
       return;
 
    cheat_st->cheats[cheat_st->ptr].state ^= true;
+   cheat_st->ops_valid                    = false;
    cheat_manager_apply_cheats();
    cheat_manager_update(cheat_st, cheat_st->ptr);
 }
@@ -780,6 +799,8 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
    unsigned offset                        = 0;
    cheat_manager_t              *cheat_st = &cheat_manager_state;
 
+   /* Compiled cheats point into the old memory buffers */
+   cheat_st->ops_valid                    = false;
    cheat_st->num_memory_buffers           = 0;
    cheat_st->total_memory_size            = 0;
    cheat_st->curr_memory_buf              = NULL;
@@ -868,6 +889,13 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
       cheat_st->total_memory_size = cheat_st->total_memory_size + (4 - (meminfo.size % 4));
 #endif
 
+   /* Reallocated by the next search, for the new size */
+   if (cheat_st->search_memory_buf)
+   {
+      free(cheat_st->search_memory_buf);
+      cheat_st->search_memory_buf = NULL;
+   }
+
    if (is_search_initialization)
    {
       if (cheat_st->prev_memory_buf)
@@ -993,129 +1021,397 @@ static void cheat_manager_setup_search_meta(
    }
 }
 
-static int cheat_manager_search(enum cheat_search_type search_type)
+static bool cheat_manager_search_match(enum cheat_search_type search_type,
+      unsigned curr_val, unsigned prev_val)
 {
-   char msg[100];
-   cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char *curr         = cheat_st->curr_memory_buf;
-   unsigned char *prev         = cheat_st->prev_memory_buf;
-   unsigned int idx            = 0;
-   unsigned int curr_val       = 0;
-   unsigned int prev_val       = 0;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
-   unsigned int offset         = 0;
-   unsigned int i              = 0;
-   bool refresh                = false;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
 
-   if (cheat_st->num_memory_buffers == 0)
+   switch (search_type)
    {
-      runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-      return 0;
+      case CHEAT_SEARCH_TYPE_EXACT:
+         return (curr_val == cheat_st->search_exact_value);
+      case CHEAT_SEARCH_TYPE_LT:
+         return (curr_val < prev_val);
+      case CHEAT_SEARCH_TYPE_GT:
+         return (curr_val > prev_val);
+      case CHEAT_SEARCH_TYPE_LTE:
+         return (curr_val <= prev_val);
+      case CHEAT_SEARCH_TYPE_GTE:
+         return (curr_val >= prev_val);
+      case CHEAT_SEARCH_TYPE_EQ:
+         return (curr_val == prev_val);
+      case CHEAT_SEARCH_TYPE_NEQ:
+         return (curr_val != prev_val);
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         return (curr_val == prev_val + cheat_st->search_eqplus_value);
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         return (curr_val == prev_val - cheat_st->search_eqminus_value);
    }
 
-   cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
+   return false;
+}
 
-   /* little endian FF000000 = 256 */
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+static unsigned cheat_manager_search_read(const uint8_t *data,
+      unsigned bytes_per_item, bool big_endian)
+{
+   switch (bytes_per_item)
    {
-      unsigned byte_part;
+      case 2:
+         return big_endian
+            ? ((unsigned)data[0] << 8) | data[1]
+            : ((unsigned)data[1] << 8) | data[0];
+      case 4:
+         return big_endian
+            ? ((unsigned)data[0] << 24) | ((unsigned)data[1] << 16)
+               | ((unsigned)data[2] << 8) | data[3]
+            : ((unsigned)data[3] << 24) | ((unsigned)data[2] << 16)
+               | ((unsigned)data[1] << 8) | data[0];
+      default:
+         break;
+   }
 
-      offset = translate_address(idx, &curr);
+   return data[0];
+}
 
-      switch (bytes_per_item)
+/* Items of one or more bytes still matching (the first byte
+ * of the item is set in the matches) are compared one at a
+ * time. Returns how many items stopped matching. */
+static unsigned cheat_manager_search_items(enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev, uint8_t *matches,
+      unsigned start, unsigned size, unsigned bytes_per_item, bool big_endian)
+{
+   unsigned idx;
+   unsigned removed = 0;
+
+   for (idx = start; idx + bytes_per_item <= size; idx += bytes_per_item)
+   {
+      /* Skip over runs without candidates a word at a time */
+      if (!(idx & 7) && idx + 8 <= size)
       {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256) + *(prev + idx + 1) :
-               *(prev + idx) + (*(prev + idx + 1) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
-               *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr - offset + idx);
-            prev_val = *(prev + idx);
-            break;
+         uint64_t word;
+         memcpy(&word, matches + idx, sizeof(word));
+         if (!word)
+         {
+            idx += 8 - bytes_per_item;
+            continue;
+         }
       }
 
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+      if (!matches[idx])
+         continue;
+
+      if (!cheat_manager_search_match(search_type,
+               cheat_manager_search_read(curr + idx, bytes_per_item, big_endian),
+               cheat_manager_search_read(prev + idx, bytes_per_item, big_endian)))
       {
-         unsigned int curr_subval = (curr_val >> (byte_part * bits)) & mask;
-         unsigned int prev_subval = (prev_val >> (byte_part * bits)) & mask;
-         unsigned int prev_match;
+         memset(matches + idx, 0, bytes_per_item);
+         removed++;
+      }
+   }
 
-         if (bits < 8)
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-         else
-            prev_match = *(cheat_st->matches + idx);
+   return removed;
+}
+
+/* Items smaller than a byte are looked up in a table, built from
+ * the comparison for every pair of current and previous nibbles,
+ * of which lanes of the nibble keep matching. Returns how many
+ * items stopped matching. */
+static unsigned cheat_manager_search_lanes(enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev, uint8_t *matches,
+      unsigned size, unsigned bits, unsigned mask)
+{
+   uint8_t keep[256];
+   unsigned idx;
+   unsigned removed = 0;
+   unsigned lanes   = 8 / bits;
+
+   for (idx = 0; idx < 256; idx++)
+   {
+      unsigned lane;
+      unsigned curr_val = idx >> 4;
+      unsigned prev_val = idx & 0x0F;
+      uint8_t lane_keep = 0;
+
+      for (lane = 0; lane < lanes / 2; lane++)
+         if (cheat_manager_search_match(search_type,
+                  (curr_val >> (lane * bits)) & mask,
+                  (prev_val >> (lane * bits)) & mask))
+            lane_keep |= mask << (lane * bits);
+
+      keep[idx] = lane_keep;
+   }
+
+   for (idx = 0; idx < size; idx++)
+   {
+      uint8_t old_match;
+      uint8_t lost;
 
-         if (prev_match > 0)
+      if (!(idx & 7) && idx + 8 <= size)
+      {
+         uint64_t word;
+         memcpy(&word, matches + idx, sizeof(word));
+         if (!word)
          {
-            bool match = false;
-            switch (search_type)
+            idx += 7;
+            continue;
+         }
+      }
+
+      if (!(old_match = matches[idx]))
+         continue;
+
+      lost = old_match & ~(keep[((curr[idx] & 0x0F) << 4) | (prev[idx] & 0x0F)]
+            | (keep[(curr[idx] & 0xF0) | (prev[idx] >> 4)] << 4));
+      if (lost)
+      {
+         unsigned lane;
+         matches[idx] = old_match & ~lost;
+         for (lane = 0; lane < lanes; lane++)
+            if (lost & (mask << (lane * bits)))
+               removed++;
+      }
+   }
+
+   return removed;
+}
+
+#if defined(__SSE2__)
+/* Compares four 32-bit values of curr and prev at once, with the
+ * same unsigned arithmetic as cheat_manager_search_match() */
+static INLINE __m128i cheat_manager_search_keep_sse2(
+      enum cheat_search_type search_type, __m128i curr, __m128i prev,
+      __m128i value)
+{
+   const __m128i sign = _mm_set1_epi32((int)0x80000000);
+   const __m128i ones = _mm_set1_epi32(-1);
+
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         return _mm_cmpeq_epi32(curr, value);
+      case CHEAT_SEARCH_TYPE_LT:
+         return _mm_cmpgt_epi32(_mm_xor_si128(prev, sign),
+               _mm_xor_si128(curr, sign));
+      case CHEAT_SEARCH_TYPE_GT:
+         return _mm_cmpgt_epi32(_mm_xor_si128(curr, sign),
+               _mm_xor_si128(prev, sign));
+      case CHEAT_SEARCH_TYPE_LTE:
+         return _mm_xor_si128(ones, _mm_cmpgt_epi32(
+                  _mm_xor_si128(curr, sign), _mm_xor_si128(prev, sign)));
+      case CHEAT_SEARCH_TYPE_GTE:
+         return _mm_xor_si128(ones, _mm_cmpgt_epi32(
+                  _mm_xor_si128(prev, sign), _mm_xor_si128(curr, sign)));
+      case CHEAT_SEARCH_TYPE_EQ:
+         return _mm_cmpeq_epi32(curr, prev);
+      case CHEAT_SEARCH_TYPE_NEQ:
+         return _mm_xor_si128(ones, _mm_cmpeq_epi32(curr, prev));
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         return _mm_cmpeq_epi32(curr, _mm_add_epi32(prev, value));
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         return _mm_cmpeq_epi32(curr, _mm_sub_epi32(prev, value));
+   }
+
+   return _mm_setzero_si128();
+}
+
+static INLINE __m128i cheat_manager_search_swap16_sse2(__m128i v)
+{
+   return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static INLINE int cheat_manager_search_popcount16(int v)
+{
+   int count = 0;
+   for (; v; v &= v - 1)
+      count++;
+   return count;
+}
+
+/* Compares 16 bytes of items of one, two or four bytes at once.
+ * The values are widened to 32 bits, compared, and the results
+ * packed back to a mask as wide as the items. Returns how many
+ * items stopped matching; the bytes past the last full block
+ * are left to the caller. */
+static unsigned cheat_manager_search_sse2(enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev, uint8_t *matches,
+      unsigned size, unsigned bytes_per_item, bool big_endian)
+{
+   unsigned idx;
+   unsigned removed          = 0;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+   const __m128i zero        = _mm_setzero_si128();
+   const __m128i low_byte    = (bytes_per_item == 2)
+      ? _mm_set1_epi16(0x00FF) : _mm_set1_epi32(0x000000FF);
+   __m128i value;
+
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         value = _mm_set1_epi32((int)cheat_st->search_eqplus_value);
+         break;
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         value = _mm_set1_epi32((int)cheat_st->search_eqminus_value);
+         break;
+      default:
+         value = _mm_set1_epi32((int)cheat_st->search_exact_value);
+         break;
+   }
+
+   for (idx = 0; idx + 16 <= size; idx += 16)
+   {
+      __m128i c, p, keep, alive, lost;
+      __m128i m = _mm_loadu_si128((const __m128i*)(matches + idx));
+      int lost_mask;
+
+      /* Nothing left to narrow down in this block */
+      alive = _mm_xor_si128(_mm_cmpeq_epi8(m, zero), _mm_set1_epi8(-1));
+      if (!_mm_movemask_epi8(alive))
+         continue;
+
+      c = _mm_loadu_si128((const __m128i*)(curr + idx));
+      p = _mm_loadu_si128((const __m128i*)(prev + idx));
+
+      switch (bytes_per_item)
+      {
+         case 4:
+            if (big_endian)
             {
-               case CHEAT_SEARCH_TYPE_EXACT:
-                  match = (curr_subval == cheat_st->search_exact_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_LT:
-                  match = (curr_subval < prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GT:
-                  match = (curr_subval > prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_LTE:
-                  match = (curr_subval <= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GTE:
-                  match = (curr_subval >= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQ:
-                  match = (curr_subval == prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_NEQ:
-                  match = (curr_subval != prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQPLUS:
-                  match = (curr_subval == prev_subval + cheat_st->search_eqplus_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQMINUS:
-                  match = (curr_subval == prev_subval - cheat_st->search_eqminus_value);
-                  break;
+               c = cheat_manager_search_swap16_sse2(
+                     _mm_shufflehi_epi16(_mm_shufflelo_epi16(c,
+                           _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1)));
+               p = cheat_manager_search_swap16_sse2(
+                     _mm_shufflehi_epi16(_mm_shufflelo_epi16(p,
+                           _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1)));
             }
+            keep = cheat_manager_search_keep_sse2(search_type, c, p, value);
 
-            if (!match)
+            /* An item is alive if its first byte is */
+            alive = _mm_and_si128(alive, low_byte);
+            alive = _mm_or_si128(alive, _mm_slli_epi32(alive, 8));
+            alive = _mm_or_si128(alive, _mm_slli_epi32(alive, 16));
+            break;
+         case 2:
+            if (big_endian)
             {
-               if (bits < 8)
-                  *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                     ((~(mask << (byte_part * bits))) & 0xFF);
-               else
-                  memset(cheat_st->matches + idx, 0, bytes_per_item);
-               if (cheat_st->num_matches > 0)
-                  cheat_st->num_matches--;
+               c = cheat_manager_search_swap16_sse2(c);
+               p = cheat_manager_search_swap16_sse2(p);
             }
-         }
+            keep = _mm_packs_epi32(
+                  cheat_manager_search_keep_sse2(search_type,
+                     _mm_unpacklo_epi16(c, zero),
+                     _mm_unpacklo_epi16(p, zero), value),
+                  cheat_manager_search_keep_sse2(search_type,
+                     _mm_unpackhi_epi16(c, zero),
+                     _mm_unpackhi_epi16(p, zero), value));
+
+            alive = _mm_and_si128(alive, low_byte);
+            alive = _mm_or_si128(alive, _mm_slli_epi16(alive, 8));
+            break;
+         default:
+            {
+               __m128i c16 = _mm_unpacklo_epi8(c, zero);
+               __m128i p16 = _mm_unpacklo_epi8(p, zero);
+               __m128i lo  = _mm_packs_epi32(
+                     cheat_manager_search_keep_sse2(search_type,
+                        _mm_unpacklo_epi16(c16, zero),
+                        _mm_unpacklo_epi16(p16, zero), value),
+                     cheat_manager_search_keep_sse2(search_type,
+                        _mm_unpackhi_epi16(c16, zero),
+                        _mm_unpackhi_epi16(p16, zero), value));
+               __m128i hi;
+
+               c16 = _mm_unpackhi_epi8(c, zero);
+               p16 = _mm_unpackhi_epi8(p, zero);
+               hi  = _mm_packs_epi32(
+                     cheat_manager_search_keep_sse2(search_type,
+                        _mm_unpacklo_epi16(c16, zero),
+                        _mm_unpacklo_epi16(p16, zero), value),
+                     cheat_manager_search_keep_sse2(search_type,
+                        _mm_unpackhi_epi16(c16, zero),
+                        _mm_unpackhi_epi16(p16, zero), value));
+               keep = _mm_packs_epi16(lo, hi);
+            }
+            break;
       }
+
+      /* Items that stop matching are cleared as a whole,
+       * the others are left as they are */
+      lost      = _mm_andnot_si128(keep, alive);
+      lost_mask = _mm_movemask_epi8(lost);
+      if (!lost_mask)
+         continue;
+
+      _mm_storeu_si128((__m128i*)(matches + idx), _mm_andnot_si128(lost, m));
+      removed += cheat_manager_search_popcount16(lost_mask) / bytes_per_item;
+   }
+
+   return removed;
+}
+#endif
+
+static int cheat_manager_search(enum cheat_search_type search_type)
+{
+   char msg[100];
+   cheat_manager_t   *cheat_st = &cheat_manager_state;
+   uint8_t *curr               = NULL;
+   unsigned int mask           = 0;
+   unsigned int bytes_per_item = 1;
+   unsigned int bits           = 8;
+   unsigned int offset         = 0;
+   unsigned int removed        = 0;
+   unsigned int start          = 0;
+   unsigned int i              = 0;
+   bool refresh                = false;
+
+   if (     cheat_st->num_memory_buffers == 0
+         || !cheat_st->prev_memory_buf
+         || !cheat_st->matches)
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      return 0;
    }
 
-   offset = 0;
+   /* The memory is compared from a contiguous copy, which
+    * becomes the previous memory of the next search */
+   if (!cheat_st->search_memory_buf)
+      cheat_st->search_memory_buf = (uint8_t*)malloc(
+            cheat_st->total_memory_size);
+   if (!(curr = cheat_st->search_memory_buf))
+      return 0;
 
    for (i = 0; i < cheat_st->num_memory_buffers; i++)
    {
-      memcpy(cheat_st->prev_memory_buf + offset, cheat_st->memory_buf_list[i], cheat_st->memory_size_list[i]);
+      memcpy(curr + offset, cheat_st->memory_buf_list[i], cheat_st->memory_size_list[i]);
       offset += cheat_st->memory_size_list[i];
    }
 
+   cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
+
+   if (bits < 8)
+      removed = cheat_manager_search_lanes(search_type, curr,
+            cheat_st->prev_memory_buf, cheat_st->matches,
+            cheat_st->total_memory_size, bits, mask);
+   else
+   {
+#if defined(__SSE2__)
+      removed = cheat_manager_search_sse2(search_type, curr,
+            cheat_st->prev_memory_buf, cheat_st->matches,
+            cheat_st->total_memory_size, bytes_per_item,
+            cheat_st->big_endian);
+      start   = cheat_st->total_memory_size & ~15;
+#endif
+      removed += cheat_manager_search_items(search_type, curr,
+            cheat_st->prev_memory_buf, cheat_st->matches, start,
+            cheat_st->total_memory_size, bytes_per_item,
+            cheat_st->big_endian);
+   }
+
+   cheat_st->num_matches = (removed < cheat_st->num_matches)
+      ? cheat_st->num_matches - removed : 0;
+
+   cheat_st->search_memory_buf = cheat_st->prev_memory_buf;
+   cheat_st->prev_memory_buf   = curr;
+
    snprintf(msg, sizeof(msg), msg_hash_to_str(MSG_CHEAT_SEARCH_FOUND_MATCHES), cheat_st->num_matches);
    msg[sizeof(msg) - 1] = 0;
 
@@ -1374,14 +1670,241 @@ void cheat_manager_apply_rumble(struct item_cheat *cheat, unsigned int curr_valu
       input_driver_set_rumble_state(cheat->rumble_port, RETRO_RUMBLE_WEAK, cheat->rumble_secondary_strength);
 }
 
+/* One memory write of a cheat, for every repeat of it */
+struct cheat_write
+{
+   uint8_t *ptr;
+   /* The value written next is taken modulo this, if set */
+   unsigned int modulo;
+   /* Bits written, for items smaller than a byte */
+   uint8_t bit_mask;
+};
+
+/* An enabled RetroArch-handler cheat, with all of its
+ * addresses resolved to pointers into the core memory */
+struct cheat_op
+{
+   uint8_t *ptr;
+   unsigned int cheat;
+   unsigned int value;
+   unsigned int repeat_add_to_value;
+   unsigned int first_write;
+   unsigned int num_writes;
+   uint8_t cheat_type;
+   uint8_t bytes_per_item;
+   bool sub_byte;
+   bool write_big_endian;
+   bool rumble;
+};
+
+static void cheat_manager_free_ops(cheat_manager_t *cheat_st)
+{
+   if (cheat_st->ops)
+      free(cheat_st->ops);
+   if (cheat_st->op_writes)
+      free(cheat_st->op_writes);
+
+   cheat_st->ops           = NULL;
+   cheat_st->op_writes     = NULL;
+   cheat_st->num_ops       = 0;
+   cheat_st->num_op_writes = 0;
+   cheat_st->ops_valid     = false;
+}
+
+/* Pointer to an item of the core memory, or NULL if it
+ * doesn't lie within one memory buffer */
+static uint8_t *cheat_manager_resolve_address(cheat_manager_t *cheat_st,
+      unsigned int address, unsigned int bytes_per_item)
+{
+   unsigned i;
+   unsigned offset = 0;
+
+   for (i = 0; i < cheat_st->num_memory_buffers; i++)
+   {
+      unsigned size = cheat_st->memory_size_list[i];
+
+      if (address >= offset && address < offset + size)
+      {
+         if (address - offset + bytes_per_item > size)
+            return NULL;
+         return cheat_st->memory_buf_list[i] + (address - offset);
+      }
+
+      offset += size;
+   }
+
+   return NULL;
+}
+
+static bool cheat_manager_add_write(cheat_manager_t *cheat_st,
+      uint8_t *ptr, unsigned int modulo, uint8_t bit_mask)
+{
+   struct cheat_write *write;
+
+   if (cheat_st->num_op_writes == cheat_st->op_writes_size)
+   {
+      unsigned size = cheat_st->op_writes_size
+         ? cheat_st->op_writes_size * 2 : 64;
+      struct cheat_write *writes = (struct cheat_write*)realloc(
+            cheat_st->op_writes, size * sizeof(*writes));
+
+      if (!writes)
+         return false;
+
+      cheat_st->op_writes      = writes;
+      cheat_st->op_writes_size = size;
+   }
+
+   write           = &cheat_st->op_writes[cheat_st->num_op_writes++];
+   write->ptr      = ptr;
+   write->modulo   = modulo;
+   write->bit_mask = bit_mask;
+   return true;
+}
+
+/* Turns the enabled RetroArch-handler cheats into a flat list
+ * of operations, so that applying them every frame doesn't need
+ * to look at the other cheats or translate any address. The
+ * repeats of a cheat are unrolled into its list of writes. */
+static void cheat_manager_compile(cheat_manager_t *cheat_st)
+{
+   unsigned i;
+   unsigned count = 0;
+
+   cheat_manager_free_ops(cheat_st);
+   cheat_st->op_writes_size = 0;
+
+   for (i = 0; i < cheat_st->size; i++)
+      if (     cheat_st->cheats[i].handler == CHEAT_HANDLER_TYPE_RETRO
+            && cheat_st->cheats[i].state)
+         count++;
+
+   if (count == 0)
+   {
+      cheat_st->ops_valid = true;
+      return;
+   }
+
+   if (!cheat_st->memory_initialized)
+      cheat_manager_initialize_memory(NULL, 0, false);
+
+   /* If we're still not initialized, something
+    * must have gone wrong - try again next frame */
+   if (!cheat_st->memory_initialized)
+      return;
+
+   if (!(cheat_st->ops = (struct cheat_op*)calloc(count, sizeof(struct cheat_op))))
+      return;
+
+   for (i = 0; i < cheat_st->size; i++)
+   {
+      struct cheat_op *op;
+      struct item_cheat *cheat    = &cheat_st->cheats[i];
+      unsigned int mask           = 0;
+      unsigned int bytes_per_item = 1;
+      unsigned int bits           = 8;
+
+      if (cheat->handler != CHEAT_HANDLER_TYPE_RETRO || !cheat->state)
+         continue;
+
+      cheat_manager_setup_search_meta(cheat->memory_search_size,
+            &bytes_per_item, &mask, &bits);
+
+      op                      = &cheat_st->ops[cheat_st->num_ops++];
+      op->ptr                 = cheat_manager_resolve_address(cheat_st,
+            cheat->address, bytes_per_item);
+      op->cheat               = i;
+      op->value               = cheat->value;
+      op->repeat_add_to_value = cheat->repeat_add_to_value;
+      op->first_write         = cheat_st->num_op_writes;
+      op->cheat_type          = cheat->cheat_type;
+      op->bytes_per_item      = bytes_per_item;
+      op->sub_byte            = (bits < 8);
+      op->write_big_endian    = cheat->big_endian;
+      op->rumble              = (cheat->rumble_type != RUMBLE_TYPE_DISABLED);
+
+      if (     cheat->cheat_type == CHEAT_TYPE_SET_TO_VALUE
+            || cheat->cheat_type == CHEAT_TYPE_INCREASE_VALUE
+            || cheat->cheat_type == CHEAT_TYPE_DECREASE_VALUE)
+      {
+         unsigned int repeat_iter;
+         unsigned int idx          = cheat->address;
+         unsigned int address_mask = cheat->address_mask;
+         /* Every write lands in memory, more can't be useful */
+         unsigned int repeat_count = MIN(cheat->repeat_count,
+               cheat_st->total_memory_size);
+
+         /* Addresses and masks follow the same steps as
+          * applying the cheat one repeat at a time would */
+         for (repeat_iter = 1; repeat_iter <= repeat_count; repeat_iter++)
+         {
+            uint8_t *ptr = cheat_manager_resolve_address(cheat_st,
+                  idx, bytes_per_item);
+
+            if (bits < 8)
+            {
+               unsigned bitpos;
+               for (bitpos = 0; bitpos < 8; bitpos++)
+                  if ((address_mask >> bitpos) & 0x01)
+                     mask = (~(1 << bitpos) & 0xFF);
+            }
+
+            if (!cheat_manager_add_write(cheat_st, ptr, mask,
+                     (uint8_t)(address_mask & 0xFF)))
+               break;
+
+            if (bits < 8)
+            {
+               unsigned int bit_iter;
+               for (bit_iter = 0; bit_iter < cheat->repeat_add_to_address; bit_iter++)
+               {
+                  address_mask = (mask < 8) ? ((address_mask << mask) & 0xFF) : 0;
+
+                  if (address_mask == 0)
+                  {
+                     address_mask = mask;
+                     idx++;
+                  }
+               }
+            }
+            else
+               idx += (cheat->repeat_add_to_address * bytes_per_item);
+
+            idx = idx % cheat_st->total_memory_size;
+         }
+      }
+
+      op->num_writes = cheat_st->num_op_writes - op->first_write;
+   }
+
+   cheat_st->ops_valid = true;
+}
+
+static unsigned int cheat_manager_read_value(const uint8_t *ptr,
+      unsigned int bytes_per_item, bool big_endian)
+{
+   switch (bytes_per_item)
+   {
+      case 2:
+         return big_endian
+            ? ((unsigned int)ptr[0] << 8) | ptr[1]
+            : ((unsigned int)ptr[1] << 8) | ptr[0];
+      case 4:
+         return big_endian
+            ? ((unsigned int)ptr[0] << 24) | ((unsigned int)ptr[1] << 16)
+               | ((unsigned int)ptr[2] << 8) | ptr[3]
+            : ((unsigned int)ptr[3] << 24) | ((unsigned int)ptr[2] << 16)
+               | ((unsigned int)ptr[1] << 8) | ptr[0];
+      default:
+         break;
+   }
+
+   return ptr[0];
+}
+
 void cheat_manager_apply_retro_cheats(void)
 {
    unsigned i;
-   unsigned int offset;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
-   unsigned int curr_val       = 0;
    bool run_cheat              = true;
 #ifdef HAVE_CHEEVOS
    bool cheat_applied          = false;
@@ -1391,180 +1914,117 @@ void cheat_manager_apply_retro_cheats(void)
    if ((!cheat_st->cheats))
       return;
 
-   for (i = 0; i < cheat_st->size; i++)
+   if (!cheat_st->ops_valid)
+      cheat_manager_compile(cheat_st);
+
+   for (i = 0; i < cheat_st->num_ops; i++)
    {
-      unsigned char *curr       = NULL;
-      bool set_value            = false;
-      unsigned int idx          = 0;
+      const struct cheat_op *op = &cheat_st->ops[i];
+      const struct cheat_write *write;
+      const struct cheat_write *write_end;
+      unsigned int curr_val     = 0;
       unsigned int value_to_set = 0;
-      unsigned int repeat_iter  = 0;
-      unsigned int address_mask = cheat_st->cheats[i].address_mask;
-
-      if (cheat_st->cheats[i].handler != CHEAT_HANDLER_TYPE_RETRO || !cheat_st->cheats[i].state)
-         continue;
-      if (!cheat_st->memory_initialized)
-         cheat_manager_initialize_memory(NULL, 0, false);
-
-      /* If we're still not initialized, something
-       * must have gone wrong - just bail */
-      if (!cheat_st->memory_initialized)
-         return;
 
       if (!run_cheat)
       {
          run_cheat = true;
          continue;
       }
-      cheat_manager_setup_search_meta(cheat_st->cheats[i].memory_search_size, &bytes_per_item, &mask, &bits);
 
-      curr   = cheat_st->curr_memory_buf;
-      idx    = cheat_st->cheats[i].address;
+      /* Read in the search byte order, which can change
+       * without the cheats being compiled again */
+      if (op->ptr)
+         curr_val = cheat_manager_read_value(op->ptr,
+               op->bytes_per_item, cheat_st->big_endian);
 
-      offset = translate_address(idx, &curr);
+      if (op->rumble)
+         cheat_manager_apply_rumble(&cheat_st->cheats[op->cheat], curr_val);
 
-      switch (bytes_per_item)
-      {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr + idx - offset);
-            break;
-      }
-
-      cheat_manager_apply_rumble(&cheat_st->cheats[i], curr_val);
-
-      switch (cheat_st->cheats[i].cheat_type)
+      switch (op->cheat_type)
       {
          case CHEAT_TYPE_SET_TO_VALUE:
-            set_value = true;
-            value_to_set = cheat_st->cheats[i].value;
+            value_to_set = op->value;
             break;
          case CHEAT_TYPE_INCREASE_VALUE:
-            set_value = true;
-            value_to_set = curr_val + cheat_st->cheats[i].value;
+            value_to_set = curr_val + op->value;
             break;
          case CHEAT_TYPE_DECREASE_VALUE:
-            set_value = true;
-            value_to_set = curr_val - cheat_st->cheats[i].value;
+            value_to_set = curr_val - op->value;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_EQ:
-            if (!(curr_val == cheat_st->cheats[i].value))
-               run_cheat = false;
-            break;
+            run_cheat = (curr_val == op->value);
+            continue;
          case CHEAT_TYPE_RUN_NEXT_IF_NEQ:
-            if (!(curr_val != cheat_st->cheats[i].value))
-               run_cheat = false;
-            break;
+            run_cheat = (curr_val != op->value);
+            continue;
          case CHEAT_TYPE_RUN_NEXT_IF_LT:
-            if (!(cheat_st->cheats[i].value < curr_val))
-               run_cheat = false;
-            break;
+            run_cheat = (op->value < curr_val);
+            continue;
          case CHEAT_TYPE_RUN_NEXT_IF_GT:
-            if (!(cheat_st->cheats[i].value > curr_val))
-               run_cheat = false;
-            break;
+            run_cheat = (op->value > curr_val);
+            continue;
+         default:
+            continue;
       }
 
-      if (set_value)
-      {
 #ifdef HAVE_CHEEVOS
-         cheat_applied = true;
+      cheat_applied = true;
 #endif
-         for (repeat_iter = 1; repeat_iter <= cheat_st->cheats[i].repeat_count; repeat_iter++)
+      write     = cheat_st->op_writes + op->first_write;
+      write_end = write + op->num_writes;
+
+      for (; write < write_end; write++)
+      {
+         uint8_t *ptr = write->ptr;
+
+         if (ptr)
          {
-            switch (bytes_per_item)
+            switch (op->bytes_per_item)
             {
                case 2:
-                  if (cheat_st->cheats[i].big_endian)
+                  if (op->write_big_endian)
                   {
-                     *(curr + idx - offset) = (value_to_set >> 8) & 0xFF;
-                     *(curr + idx + 1 - offset) = value_to_set & 0xFF;
+                     ptr[0] = (value_to_set >> 8) & 0xFF;
+                     ptr[1] =  value_to_set       & 0xFF;
                   }
                   else
                   {
-                     *(curr + idx - offset) = value_to_set & 0xFF;
-                     *(curr + idx + 1 - offset) = (value_to_set >> 8) & 0xFF;
+                     ptr[0] =  value_to_set       & 0xFF;
+                     ptr[1] = (value_to_set >> 8) & 0xFF;
                   }
                   break;
                case 4:
-                  if (cheat_st->cheats[i].big_endian)
+                  if (op->write_big_endian)
                   {
-                     *(curr + idx - offset) = (value_to_set >> 24) & 0xFF;
-                     *(curr + idx + 1 - offset) = (value_to_set >> 16) & 0xFF;
-                     *(curr + idx + 2 - offset) = (value_to_set >> 8) & 0xFF;
-                     *(curr + idx + 3 - offset) = value_to_set & 0xFF;
+                     ptr[0] = (value_to_set >> 24) & 0xFF;
+                     ptr[1] = (value_to_set >> 16) & 0xFF;
+                     ptr[2] = (value_to_set >>  8) & 0xFF;
+                     ptr[3] =  value_to_set        & 0xFF;
                   }
                   else
                   {
-                     *(curr + idx - offset) = value_to_set & 0xFF;
-                     *(curr + idx + 1 - offset) = (value_to_set >> 8) & 0xFF;
-                     *(curr + idx + 2 - offset) = (value_to_set >> 16) & 0xFF;
-                     *(curr + idx + 3 - offset) = (value_to_set >> 24) & 0xFF;
-                  }
-                  break;
-               case 1:
-                  if (bits < 8)
-                  {
-                     unsigned bitpos;
-                     unsigned char val = *(curr + idx - offset);
-
-                     for (bitpos = 0; bitpos < 8; bitpos++)
-                     {
-                        if ((address_mask >> bitpos) & 0x01)
-                        {
-                           mask = (~(1 << bitpos) & 0xFF);
-                           /* Clear current bit value */
-                           val = val & mask;
-                           /* Inject cheat bit value */
-                           val = val | (((value_to_set >> bitpos) & 0x01) << bitpos);
-                        }
-                     }
-
-                     *(curr + idx - offset) = val;
+                     ptr[0] =  value_to_set        & 0xFF;
+                     ptr[1] = (value_to_set >>  8) & 0xFF;
+                     ptr[2] = (value_to_set >> 16) & 0xFF;
+                     ptr[3] = (value_to_set >> 24) & 0xFF;
                   }
-                  else
-                     *(curr + idx - offset) = value_to_set & 0xFF;
                   break;
                default:
-                  *(curr + idx - offset) = value_to_set & 0xFF;
+                  /* Clear the bits of the item and inject
+                   * the cheat bits in their place */
+                  if (op->sub_byte)
+                     ptr[0] = (ptr[0] & ~write->bit_mask)
+                        | (value_to_set & write->bit_mask);
+                  else
+                     ptr[0] = value_to_set & 0xFF;
                   break;
             }
+         }
 
-            value_to_set += cheat_st->cheats[i].repeat_add_to_value;
-
-            if (mask != 0)
-               value_to_set = value_to_set % mask;
-
-            if (bits < 8)
-            {
-               unsigned int bit_iter;
-               for (bit_iter = 0; bit_iter < cheat_st->cheats[i].repeat_add_to_address; bit_iter++)
-               {
-                  address_mask = (address_mask << mask) & 0xFF;
-
-                  if (address_mask == 0)
-                  {
-                     address_mask = mask;
-                     idx++;
-                  }
-               }
-            }
-            else
-               idx += (cheat_st->cheats[i].repeat_add_to_address * bytes_per_item);
-
-            idx = idx % cheat_st->total_memory_size;
+         value_to_set += op->repeat_add_to_value;
 
-            offset = translate_address(idx, &curr);
-         }
+         if (write->modulo != 0)
+            value_to_set = value_to_set % write->modulo;
       }
    }
 
@@ -1574,6 +2034,21 @@ void cheat_manager_apply_retro_cheats(void)
 #endif
 }
 
+/* True if cheat_manager_apply_retro_cheats() writes into core memory */
+bool cheat_manager_has_retro_cheats(void)
+{
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   if (!cheat_st->cheats)
+      return false;
+
+   if (!cheat_st->ops_valid)
+      cheat_manager_compile(cheat_st);
+
+   /* Still not compiled, so there are cheats waiting to apply */
+   return !cheat_st->ops_valid || cheat_st->num_ops > 0;
+}
+
 void cheat_manager_match_action(enum cheat_match_action_type match_action, unsigned int target_match_idx, unsigned int *address, unsigned int *address_mask,
       unsigned int *prev_value, unsigned int *curr_value)
 {
@@ -161,9 +161,15 @@ struct cheat_manager
    struct item_cheat *cheats;
    uint8_t *curr_memory_buf;
    uint8_t *prev_memory_buf;
+   /* Scratch copy of the memory compared by a search */
+   uint8_t *search_memory_buf;
    uint8_t *matches;
    uint8_t **memory_buf_list;
    unsigned *memory_size_list;
+   /* Enabled RetroArch-handler cheats, compiled by
+    * cheat_manager_apply_retro_cheats() */
+   struct cheat_op *ops;
+   struct cheat_write *op_writes;
    unsigned int delete_state;
    unsigned int loading_cheat_size;
    unsigned int loading_cheat_offset;
@@ -181,11 +187,16 @@ struct cheat_manager
    unsigned search_eqminus_value;
    unsigned num_matches;
    unsigned browse_address;
+   unsigned num_ops;
+   unsigned num_op_writes;
+   unsigned op_writes_size;
    char working_desc[CHEAT_DESC_SCRATCH_SIZE];
    char working_code[CHEAT_CODE_SCRATCH_SIZE];
    bool  big_endian;
    bool  memory_initialized;
    bool  memory_search_initialized;
+   /* Cleared whenever the cheats or the memory change */
+   bool  ops_valid;
 };
 
 typedef struct cheat_manager cheat_manager_t;
@@ -271,6 +282,8 @@ int cheat_manager_add_matches(const char *path,
 
 void cheat_manager_apply_retro_cheats(void);
 
+bool cheat_manager_has_retro_cheats(void);
+
 void cheat_manager_match_action(
       enum cheat_match_action_type match_action,
       unsigned int target_match_idx,
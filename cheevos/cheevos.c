@@ -15,8 +15,11 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <file/file_path.h>
+#include <file/config_file.h>
+#include <encodings/crc32.h>
 #include <string/stdstring.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
@@ -24,6 +27,7 @@
 #include <formats/cdfs.h>
 #include <formats/m3u_file.h>
 #include <compat/strl.h>
+#include <compat/posix_string.h>
 #include <retro_miscellaneous.h>
 #include <retro_math.h>
 #include <net/net_http.h>
@@ -65,6 +69,7 @@
 #include "../command.h"
 #include "../dynamic.h"
 #include "../configuration.h"
+#include "../content.h"
 #include "../performance_counters.h"
 #include "../msg_hash.h"
 #include "../retroarch.h"
@@ -117,22 +122,48 @@ enum rcheevos_async_io_type
 
 typedef struct rcheevos_async_io_request
 {
-   const char* success_message;
-   const char* failure_message;
    int id;
-   int value;
-   int attempt_count;
    char user_agent[256];
    char type;
-   char hardcore;
 } rcheevos_async_io_request;
 
+/* Most submissions kept while the server can't be reached */
+#define CHEEVOS_PENDING_MAX 1024
+
+typedef struct rcheevos_pending
+{
+   char username[32];
+   char hash[33];
+   unsigned id;
+   int value;
+   char type; /* CHEEVOS_ASYNC_AWARD_ACHIEVEMENT or CHEEVOS_ASYNC_SUBMIT_LBOARD */
+   char hardcore;
+} rcheevos_pending_t;
+
+typedef struct rcheevos_pending_queue
+{
+   rcheevos_pending_t* entries;
+#ifdef HAVE_THREADS
+   slock_t* lock;
+#endif
+   unsigned count;
+   unsigned capacity;
+   unsigned attempt_count;
+   bool loaded;
+   /* A request is in flight or a retry is scheduled */
+   bool busy;
+   /* The entries differ from the file */
+   bool dirty;
+} rcheevos_pending_queue_t;
+
 typedef struct
 {
    rc_runtime_t runtime;
    rcheevos_rapatchdata_t patchdata; /* ptr alignment */
    rcheevos_memory_regions_t memory; /* ptr alignment */
 
+   rcheevos_memref_table_t memref_table; /* ptr alignment */
+
    retro_task_t* task;
 #ifdef HAVE_THREADS
    slock_t* task_lock;
@@ -156,6 +187,7 @@ static rcheevos_locals_t rcheevos_locals =
    {0},  /* runtime */
    {0},  /* patchdata */
    {{0}},/* memory */
+   {0},  /* memref_table */
    NULL, /* task */
 #ifdef HAVE_THREADS
    NULL, /* task_lock */
@@ -182,11 +214,12 @@ static rcheevos_locals_t rcheevos_locals =
 
 #define CHEEVOS_MB(x)   ((x) * 1024 * 1024)
 
+static rcheevos_pending_queue_t rcheevos_pending_queue;
+
 /* Forward declaration */
-static void rcheevos_async_task_callback(
-      retro_task_t* task, void* task_data, void* user_data, const char* error);
-static void rcheevos_async_submit_lboard(rcheevos_locals_t *locals,
-      rcheevos_async_io_request* request);
+static bool rcheevos_pending_add(rcheevos_pending_queue_t *queue,
+      const rcheevos_pending_t *entry);
+static void rcheevos_pending_submit(rcheevos_locals_t *locals);
 
 /*****************************************************************************
 Supporting functions.
@@ -495,6 +528,7 @@ uint8_t* rcheevos_patch_address(unsigned address)
    {
       /* memory map was not previously initialized (no achievements for this game?) try now */
       rcheevos_memory_init(&rcheevos_locals.memory, rcheevos_locals.patchdata.console_id);
+      rcheevos_locals.memref_table.valid = false;
    }
 
    return rcheevos_memory_find(&rcheevos_locals.memory, address);
@@ -522,37 +556,6 @@ static unsigned rcheevos_peek(unsigned address, unsigned num_bytes, void* ud)
    return 0;
 }
 
-static void rcheevos_async_award_achievement(
-      rcheevos_locals_t *locals,
-      rcheevos_async_io_request* request)
-{
-   char buffer[256];
-   settings_t *settings = config_get_ptr();
-   int              ret = rc_url_award_cheevo(buffer, sizeof(buffer),
-                          settings->arrays.cheevos_username,
-                          locals->token,
-                          request->id,
-                          request->hardcore,
-                          locals->hash);
-
-   if (ret != 0)
-   {
-      CHEEVOS_ERR(RCHEEVOS_TAG "Buffer too small to create URL\n");
-      free(request);
-      return;
-   }
-
-   rcheevos_log_url("rc_url_award_cheevo", buffer);
-   task_push_http_transfer_with_user_agent(buffer, true, NULL,
-         request->user_agent, rcheevos_async_task_callback, request);
-
-#ifdef HAVE_AUDIOMIXER
-   if (settings->bools.cheevos_unlock_sound_enable)
-      audio_driver_mixer_play_menu_sound(
-            AUDIO_MIXER_SYSTEM_SLOT_ACHIEVEMENT_UNLOCK);
-#endif
-}
-
 static retro_time_t rcheevos_async_send_rich_presence(
       rcheevos_locals_t *locals,
       rcheevos_async_io_request* request)
@@ -619,14 +622,9 @@ static void rcheevos_async_task_handler(retro_task_t* task)
          }
          break;
 
-      case CHEEVOS_ASYNC_AWARD_ACHIEVEMENT:
-         rcheevos_async_award_achievement(&rcheevos_locals, request);
-         task_set_finished(task, 1);
-         break;
-
-      case CHEEVOS_ASYNC_SUBMIT_LBOARD:
-         rcheevos_async_submit_lboard(&rcheevos_locals, request);
+      default:
          task_set_finished(task, 1);
+         free(request);
          break;
    }
 }
@@ -642,13 +640,254 @@ static void rcheevos_async_schedule(
    task_queue_push(task);
 }
 
-static void rcheevos_async_task_callback(
+/* Unlocks and leaderboard entries waiting to be sent to the
+ * server. The queue is kept on disk, so that nothing earned
+ * while offline is lost when RetroArch is closed, and is sent
+ * one entry after the other so that every request reuses the
+ * connection of the previous one. */
+static void rcheevos_pending_path(char *s, size_t len)
+{
+   settings_t *settings = config_get_ptr();
+   s[0] = '\0';
+
+   if (!string_is_empty(settings->paths.directory_playlist))
+      fill_pathname_join(s, settings->paths.directory_playlist,
+            FILE_PATH_CHEEVOS_PENDING_QUEUE, len);
+}
+
+static void rcheevos_pending_load(rcheevos_pending_queue_t *queue)
+{
+   char path[PATH_MAX_LENGTH];
+   void *buf   = NULL;
+   int64_t len = 0;
+   char *save  = NULL;
+   char *line;
+
+   queue->loaded = true;
+
+   rcheevos_pending_path(path, sizeof(path));
+   if (     string_is_empty(path)
+         || !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len))
+      return;
+
+   /* One entry per line: type id value hardcore hash username */
+   for (line = strtok_r((char*)buf, "\n", &save); line;
+         line = strtok_r(NULL, "\n", &save))
+   {
+      rcheevos_pending_t entry;
+      char type;
+      unsigned hardcore;
+
+      memset(&entry, 0, sizeof(entry));
+      if (sscanf(line, "%c %u %d %u %32s %31s", &type, &entry.id,
+               &entry.value, &hardcore, entry.hash, entry.username) != 6)
+         continue;
+
+      if (type == 'A')
+         entry.type = CHEEVOS_ASYNC_AWARD_ACHIEVEMENT;
+      else if (type == 'L')
+         entry.type = CHEEVOS_ASYNC_SUBMIT_LBOARD;
+      else
+         continue;
+
+      entry.hardcore = hardcore ? 1 : 0;
+      rcheevos_pending_add(queue, &entry);
+   }
+
+   free(buf);
+
+   CHEEVOS_LOG(RCHEEVOS_TAG "%u pending submission(s) loaded\n", queue->count);
+   queue->dirty = false;
+}
+
+static void rcheevos_pending_save(rcheevos_pending_queue_t *queue)
+{
+   char path[PATH_MAX_LENGTH];
+   char *buf;
+   size_t len = 0;
+   unsigned i;
+   /* "L <id> <value> <hardcore> <hash> <username>\n" */
+   const size_t line_size = 2 + 11 + 12 + 2 + 33 + 32 + 1;
+
+   rcheevos_pending_path(path, sizeof(path));
+   if (string_is_empty(path))
+      return;
+
+   queue->dirty = false;
+
+   if (queue->count == 0)
+   {
+      if (path_is_valid(path))
+         filestream_delete(path);
+      return;
+   }
+
+   if (!(buf = (char*)malloc(queue->count * line_size + 1)))
+      return;
+
+   for (i = 0; i < queue->count; i++)
+   {
+      const rcheevos_pending_t *entry = &queue->entries[i];
+      len += snprintf(buf + len, line_size + 1, "%c %u %d %u %s %s\n",
+            (entry->type == CHEEVOS_ASYNC_AWARD_ACHIEVEMENT) ? 'A' : 'L',
+            entry->id, entry->value, (unsigned)entry->hardcore,
+            entry->hash[0] ? entry->hash : "-", entry->username);
+   }
+
+   if (!filestream_write_file(path, buf, len))
+      CHEEVOS_ERR(RCHEEVOS_TAG "could not write %s\n", path);
+
+   free(buf);
+}
+
+/* Queues an entry, unless it's already queued. An achievement
+ * queued for both modes is only sent once, for hardcore. */
+static bool rcheevos_pending_add(rcheevos_pending_queue_t *queue,
+      const rcheevos_pending_t *entry)
+{
+   unsigned i;
+
+   for (i = 0; i < queue->count; i++)
+   {
+      rcheevos_pending_t *queued = &queue->entries[i];
+
+      if (     queued->type != entry->type
+            || queued->id   != entry->id
+            || !string_is_equal(queued->username, entry->username))
+         continue;
+
+      if (entry->type == CHEEVOS_ASYNC_AWARD_ACHIEVEMENT)
+      {
+         if (entry->hardcore && !queued->hardcore)
+         {
+            queued->hardcore = 1;
+            queue->dirty     = true;
+         }
+         return true;
+      }
+
+      if (queued->value == entry->value)
+         return true;
+   }
+
+   if (queue->count >= CHEEVOS_PENDING_MAX)
+   {
+      CHEEVOS_ERR(RCHEEVOS_TAG "too many pending submissions, dropping %u\n",
+            entry->id);
+      return false;
+   }
+
+   if (queue->count == queue->capacity)
+   {
+      unsigned capacity          = queue->capacity ? queue->capacity * 2 : 16;
+      rcheevos_pending_t *entries = (rcheevos_pending_t*)realloc(
+            queue->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         return false;
+
+      queue->entries  = entries;
+      queue->capacity = capacity;
+   }
+
+   queue->entries[queue->count++] = *entry;
+   queue->dirty                   = true;
+   return true;
+}
+
+static void rcheevos_pending_remove(rcheevos_pending_queue_t *queue,
+      const rcheevos_pending_t *entry)
+{
+   unsigned i;
+
+   for (i = 0; i < queue->count; i++)
+   {
+      rcheevos_pending_t *queued = &queue->entries[i];
+
+      /* An entry upgraded to hardcore while it was in
+       * flight stays queued, and is sent again */
+      if (     queued->type     == entry->type
+            && queued->id       == entry->id
+            && queued->value    == entry->value
+            && queued->hardcore == entry->hardcore
+            && string_is_equal(queued->username, entry->username))
+      {
+         memmove(queued, queued + 1,
+               (queue->count - i - 1) * sizeof(*queued));
+         queue->count--;
+         queue->dirty = true;
+         return;
+      }
+   }
+}
+
+static void rcheevos_pending_retry_handler(retro_task_t *task)
+{
+   rcheevos_pending_queue_t *queue = &rcheevos_pending_queue;
+
+   CHEEVOS_LOCK(queue->lock);
+   queue->busy = false;
+   CHEEVOS_UNLOCK(queue->lock);
+
+   rcheevos_pending_submit(&rcheevos_locals);
+   task_set_finished(task, 1);
+}
+
+static void rcheevos_pending_task_callback(
       retro_task_t* task, void* task_data, void* user_data, const char* error)
 {
-   rcheevos_async_io_request  *request = (rcheevos_async_io_request*)user_data;
-   http_transfer_data_t        *data   = (http_transfer_data_t*)task_data;
+   rcheevos_pending_queue_t *queue = &rcheevos_pending_queue;
+   rcheevos_pending_t       *entry = (rcheevos_pending_t*)user_data;
+   http_transfer_data_t     *data  = (http_transfer_data_t*)task_data;
+   const char *failure_message     =
+      (entry->type == CHEEVOS_ASYNC_AWARD_ACHIEVEMENT)
+      ? "Error awarding achievement"
+      : "Error submitting leaderboard";
+
+   if (error)
+   {
+      /* Keep the entry and try again later, doubling the
+       * wait between each attempt until we hit a maximum
+       * delay of two minutes.
+       * 250ms -> 500ms -> 1s -> 2s -> 4s -> 8s -> 16s -> 32s -> 64s -> 120s -> 120s... */
+      retro_task_t *retry;
+      retro_time_t retry_delay;
+
+      CHEEVOS_ERR(RCHEEVOS_TAG "%s %u: %s\n", failure_message,
+            entry->id, error);
+
+      CHEEVOS_LOCK(queue->lock);
+      retry_delay = (queue->attempt_count > 8)
+         ? (120 * 1000 * 1000)
+         : ((250 * 1000) << queue->attempt_count);
+      queue->attempt_count++;
+
+      if (queue->dirty)
+         rcheevos_pending_save(queue);
+      CHEEVOS_UNLOCK(queue->lock);
+
+      /* The queue stays busy until the retry fires, so
+       * there's only ever one retry scheduled */
+      if ((retry = task_init()))
+      {
+         retry->when     = cpu_features_get_time_usec() + retry_delay;
+         retry->handler  = rcheevos_pending_retry_handler;
+         retry->progress = -1;
+         retry->mute     = true;
+         task_queue_push(retry);
+      }
+      else
+      {
+         CHEEVOS_LOCK(queue->lock);
+         queue->busy = false;
+         CHEEVOS_UNLOCK(queue->lock);
+      }
+
+      free(entry);
+      return;
+   }
 
-   if (!error)
    {
       char buffer[224] = "";
       /* Server did not return HTTP headers */
@@ -656,7 +895,7 @@ static void rcheevos_async_task_callback(
          snprintf(buffer, sizeof(buffer), "Server communication error");
       else if (data->status != 200)
       {
-         /* Server returned an error via status code. 
+         /* Server returned an error via status code.
           * Check to see if it also returned a JSON error */
          if (!data->data || rcheevos_get_json_error(data->data, buffer, sizeof(buffer)) != RC_OK)
             snprintf(buffer, sizeof(buffer), "HTTP error code: %d",
@@ -669,7 +908,7 @@ static void rcheevos_async_task_callback(
       }
       else
       {
-         /* Server sent a message - assume it's JSON 
+         /* Server sent a message - assume it's JSON
           * and check for a JSON error */
          rcheevos_get_json_error(data->data, buffer, sizeof(buffer));
       }
@@ -678,54 +917,148 @@ static void rcheevos_async_task_callback(
       {
          char errbuf[256];
          snprintf(errbuf, sizeof(errbuf), "%s %u: %s",
-               request->failure_message, request->id, buffer);
+               failure_message, entry->id, buffer);
          CHEEVOS_LOG(RCHEEVOS_TAG "%s\n", errbuf);
 
-         switch (request->type)
-         {
-            case CHEEVOS_ASYNC_RICHPRESENCE:
-               /* Don't bother informing user when 
-                * rich presence update fails */
-               break;
+         /* ignore already unlocked, it was probably
+          * sent before RetroArch was closed */
+         if (!(entry->type == CHEEVOS_ASYNC_AWARD_ACHIEVEMENT &&
+                  string_starts_with_size(buffer, "User already has ",
+                     STRLEN_CONST("User already has "))))
+            runloop_msg_queue_push(errbuf, 0, 5 * 60, false, NULL,
+               MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_ERROR);
+      }
+      else
+         CHEEVOS_LOG(RCHEEVOS_TAG "%s %u\n",
+               (entry->type == CHEEVOS_ASYNC_AWARD_ACHIEVEMENT)
+               ? "Awarded achievement" : "Submitted leaderboard",
+               entry->id);
+   }
 
-            case CHEEVOS_ASYNC_AWARD_ACHIEVEMENT:
-               /* ignore already unlocked */
-               if (string_starts_with_size(buffer, "User already has ",
-                        STRLEN_CONST("User already has ")))
-                  break;
-               /* fallthrough to default */
+   /* The server answered, the entry won't get any
+    * better by sending it again */
+   CHEEVOS_LOCK(queue->lock);
+   rcheevos_pending_remove(queue, entry);
+   queue->attempt_count = 0;
+   queue->busy          = false;
+   CHEEVOS_UNLOCK(queue->lock);
 
-            default:
-               runloop_msg_queue_push(errbuf, 0, 5 * 60, false, NULL,
-                  MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_ERROR);
-               break;
-         }
+   free(entry);
+
+   /* Send the next one over the same connection */
+   rcheevos_pending_submit(&rcheevos_locals);
+}
+
+/* Sends the next queued entry of the logged in user, if no
+ * other one is in flight. The file is only rewritten once the
+ * queue has been drained (or a request fails): if RetroArch
+ * is closed in between, entries are sent twice, which the
+ * server ignores. */
+static void rcheevos_pending_submit(rcheevos_locals_t *locals)
+{
+   char url[256];
+   char user_agent[256];
+   rcheevos_pending_queue_t *queue = &rcheevos_pending_queue;
+   settings_t *settings            = config_get_ptr();
+   const char *username            = settings->arrays.cheevos_username;
+   const char *token               = locals->token[0]
+            ? locals->token : settings->arrays.cheevos_token;
+   rcheevos_pending_t *entry       = NULL;
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   if (!queue->lock)
+      return;
+#endif
+
+   CHEEVOS_LOCK(queue->lock);
+
+   if (!queue->loaded)
+      rcheevos_pending_load(queue);
+
+   if (queue->busy || string_is_empty(username) || string_is_empty(token))
+   {
+      CHEEVOS_UNLOCK(queue->lock);
+      return;
+   }
+
+   for (i = 0; i < queue->count && !entry; i++)
+   {
+      rcheevos_pending_t *queued = &queue->entries[i];
+      int ret;
+
+      if (!string_is_equal(queued->username, username))
+         continue;
+
+      if (queued->type == CHEEVOS_ASYNC_AWARD_ACHIEVEMENT)
+      {
+         ret = rc_url_award_cheevo(url, sizeof(url), username, token,
+               queued->id, queued->hardcore, queued->hash);
+         if (ret == 0)
+            rcheevos_log_url("rc_url_award_cheevo", url);
       }
       else
       {
-         CHEEVOS_LOG(RCHEEVOS_TAG "%s %u\n", request->success_message, request->id);
+         ret = rc_url_submit_lboard(url, sizeof(url), username, token,
+               queued->id, queued->value);
+         if (ret == 0)
+            rcheevos_log_url("rc_url_submit_lboard", url);
+      }
+
+      if (ret != 0)
+      {
+         CHEEVOS_ERR(RCHEEVOS_TAG "Buffer too small to create URL\n");
+         rcheevos_pending_remove(queue, queued);
+         i--;
+         continue;
       }
 
-      free(request);
+      if ((entry = (rcheevos_pending_t*)malloc(sizeof(*entry))))
+      {
+         *entry      = *queued;
+         queue->busy = true;
+      }
+      else
+         break;
    }
-   else
-   {
-      /* Double the wait between each attempt until we hit 
-       * a maximum delay of two minutes.
-      * 250ms -> 500ms -> 1s -> 2s -> 4s -> 8s -> 16s -> 32s -> 64s -> 120s -> 120s... */
-      retro_time_t retry_delay = 
-           (request->attempt_count > 8) 
-         ? (120 * 1000 * 1000) 
-         : ((250 * 1000) << request->attempt_count);
 
-      request->attempt_count++;
-      rcheevos_async_schedule(request, retry_delay);
+   if (!entry && queue->dirty)
+      rcheevos_pending_save(queue);
+
+   CHEEVOS_UNLOCK(queue->lock);
 
-      CHEEVOS_ERR(RCHEEVOS_TAG "%s %u: %s\n", request->failure_message,
-            request->id, error);
+   if (entry)
+   {
+      rcheevos_get_user_agent(locals, user_agent, sizeof(user_agent));
+      task_push_http_transfer_with_user_agent(url, true, NULL,
+            user_agent, rcheevos_pending_task_callback, entry);
    }
 }
 
+/* Queues an entry and kicks off its submission */
+static void rcheevos_pending_push(rcheevos_locals_t *locals,
+      const rcheevos_pending_t *entry)
+{
+   rcheevos_pending_queue_t *queue = &rcheevos_pending_queue;
+
+#ifdef HAVE_THREADS
+   if (!queue->lock)
+      return;
+#endif
+
+   CHEEVOS_LOCK(queue->lock);
+   if (!queue->loaded)
+      rcheevos_pending_load(queue);
+
+   /* Saved right away, in case RetroArch doesn't get
+    * to close cleanly */
+   if (rcheevos_pending_add(queue, entry) && queue->dirty)
+      rcheevos_pending_save(queue);
+   CHEEVOS_UNLOCK(queue->lock);
+
+   rcheevos_pending_submit(locals);
+}
+
 static void rcheevos_validate_memrefs(rcheevos_locals_t* locals)
 {
    rc_memref_value_t* memref = locals->runtime.memrefs;
@@ -741,6 +1074,9 @@ static void rcheevos_validate_memrefs(rcheevos_locals_t* locals)
 
       memref = memref->next;
    }
+
+   rcheevos_memref_table_build(&locals->memref_table,
+         locals->runtime.memrefs, &locals->memory);
 }
 
 static void rcheevos_activate_achievements(rcheevos_locals_t *locals,
@@ -998,15 +1334,23 @@ static void rcheevos_award_achievement(rcheevos_locals_t *locals,
    /* Start the award task (unofficial achievement unlocks are not submitted). */
    if (!(cheevo->active & RCHEEVOS_ACTIVE_UNOFFICIAL))
    {
-      rcheevos_async_io_request *request = (rcheevos_async_io_request*)calloc(1, sizeof(rcheevos_async_io_request));
-      request->type            = CHEEVOS_ASYNC_AWARD_ACHIEVEMENT;
-      request->id              = cheevo->id;
-      request->hardcore        = locals->hardcore_active ? 1 : 0;
-      request->success_message = "Awarded achievement";
-      request->failure_message = "Error awarding achievement";
-      rcheevos_get_user_agent(locals,
-            request->user_agent, sizeof(request->user_agent));
-      rcheevos_async_award_achievement(locals, request);
+      rcheevos_pending_t entry;
+      settings_t *settings = config_get_ptr();
+
+      memset(&entry, 0, sizeof(entry));
+      entry.type     = CHEEVOS_ASYNC_AWARD_ACHIEVEMENT;
+      entry.id       = cheevo->id;
+      entry.hardcore = locals->hardcore_active ? 1 : 0;
+      strlcpy(entry.hash, locals->hash, sizeof(entry.hash));
+      strlcpy(entry.username, settings->arrays.cheevos_username,
+            sizeof(entry.username));
+      rcheevos_pending_push(locals, &entry);
+
+#ifdef HAVE_AUDIOMIXER
+      if (settings->bools.cheevos_unlock_sound_enable)
+         audio_driver_mixer_play_menu_sound(
+               AUDIO_MIXER_SYSTEM_SLOT_ACHIEVEMENT_UNLOCK);
+#endif
    }
 
 #ifdef HAVE_SCREENSHOTS
@@ -1044,27 +1388,6 @@ static void rcheevos_award_achievement(rcheevos_locals_t *locals,
 #endif
 }
 
-static void rcheevos_async_submit_lboard(rcheevos_locals_t *locals,
-      rcheevos_async_io_request* request)
-{
-   char buffer[256];
-   settings_t *settings = config_get_ptr();
-   int ret              = rc_url_submit_lboard(buffer, sizeof(buffer),
-         settings->arrays.cheevos_username,
-         locals->token, request->id, request->value);
-
-   if (ret != 0)
-   {
-      CHEEVOS_ERR(RCHEEVOS_TAG "Buffer too small to create URL\n");
-      free(request);
-      return;
-   }
-
-   rcheevos_log_url("rc_url_submit_lboard", buffer);
-   task_push_http_transfer_with_user_agent(buffer, true, NULL,
-         request->user_agent, rcheevos_async_task_callback, request);
-}
-
 static rcheevos_ralboard_t* rcheevos_find_lboard(unsigned id)
 {
    rcheevos_ralboard_t* lboard = rcheevos_locals.patchdata.lboards;
@@ -1104,18 +1427,17 @@ static void rcheevos_lboard_submit(rcheevos_locals_t *locals,
 
    /* Start the submit task. */
    {
-      rcheevos_async_io_request
-         *request              = (rcheevos_async_io_request*)
-         calloc(1, sizeof(rcheevos_async_io_request));
-     
-      request->type            = CHEEVOS_ASYNC_SUBMIT_LBOARD;
-      request->id              = lboard->id;
-      request->value           = value;
-      request->success_message = "Submitted leaderboard";
-      request->failure_message = "Error submitting leaderboard";
-      rcheevos_get_user_agent(locals,
-            request->user_agent, sizeof(request->user_agent));
-      rcheevos_async_submit_lboard(locals, request);
+      rcheevos_pending_t entry;
+      settings_t *settings = config_get_ptr();
+
+      memset(&entry, 0, sizeof(entry));
+      entry.type  = CHEEVOS_ASYNC_SUBMIT_LBOARD;
+      entry.id    = lboard->id;
+      entry.value = value;
+      strlcpy(entry.hash, locals->hash, sizeof(entry.hash));
+      strlcpy(entry.username, settings->arrays.cheevos_username,
+            sizeof(entry.username));
+      rcheevos_pending_push(locals, &entry);
    }
 }
 
@@ -1217,9 +1539,13 @@ void rcheevos_reset_game(bool widgets_ready)
    /* Some cores reallocate memory on reset, 
     * make sure we update our pointers */
    if (rcheevos_locals.memory.total_size > 0)
+   {
       rcheevos_memory_init(
             &rcheevos_locals.memory,
              rcheevos_locals.patchdata.console_id);
+      rcheevos_memref_table_build(&rcheevos_locals.memref_table,
+            rcheevos_locals.runtime.memrefs, &rcheevos_locals.memory);
+   }
 }
 
 #ifdef HAVE_MENU
@@ -1501,6 +1827,7 @@ bool rcheevos_unload(void)
 #endif
 
    rc_runtime_destroy(&rcheevos_locals.runtime);
+   rcheevos_memref_table_free(&rcheevos_locals.memref_table);
 
    /* If the config-level token has been cleared, 
     * we need to re-login on loading the next game */
@@ -1996,7 +2323,28 @@ void rcheevos_test(void)
       rcheevos_validate_memrefs(&rcheevos_locals);
    }
 
-   rc_runtime_do_frame(&rcheevos_locals.runtime, &rcheevos_runtime_event_handler, rcheevos_peek, NULL, 0);
+   /* Toggling hardcore mode activates achievements,
+    * adding memrefs to the end of the chain */
+   if (rcheevos_memref_table_is_stale(&rcheevos_locals.memref_table,
+            rcheevos_locals.runtime.memrefs))
+      rcheevos_memref_table_build(&rcheevos_locals.memref_table,
+            rcheevos_locals.runtime.memrefs, &rcheevos_locals.memory);
+
+   if (rcheevos_locals.memref_table.valid)
+   {
+      /* The memrefs are already up to date, hide them from
+       * the runtime so it doesn't peek every one of them again */
+      rc_memref_value_t* memrefs      = rcheevos_locals.runtime.memrefs;
+
+      rcheevos_memref_table_update(&rcheevos_locals.memref_table,
+            &rcheevos_locals.memory);
+
+      rcheevos_locals.runtime.memrefs = NULL;
+      rc_runtime_do_frame(&rcheevos_locals.runtime, &rcheevos_runtime_event_handler, rcheevos_peek, NULL, 0);
+      rcheevos_locals.runtime.memrefs = memrefs;
+   }
+   else
+      rc_runtime_do_frame(&rcheevos_locals.runtime, &rcheevos_runtime_event_handler, rcheevos_peek, NULL, 0);
 }
 
 size_t rcheevos_get_serialize_size(void)
@@ -2085,6 +2433,7 @@ typedef struct
    char badge_basepath[PATH_MAX_LENGTH];
    char badge_fullpath[PATH_MAX_LENGTH];
    char hash[33];
+   char cache_key[64];
    unsigned gameid;
    unsigned i;
    unsigned j;
@@ -2094,6 +2443,8 @@ typedef struct
    void *data;
    char *json;
    const char *path;
+   uint32_t content_crc;
+   bool cache_hit;
    rcheevos_racheevo_t *cheevo;
    const rcheevos_racheevo_t *cheevo_end;
    settings_t *settings;
@@ -2118,6 +2469,139 @@ enum
    RCHEEVOS_DELAY        = -8
 };
 
+/* Game ids looked up from the hash cache are trusted for a week,
+ * after which the hash is sent to the server again */
+#define RCHEEVOS_HASH_CACHE_TTL (7 * 24 * 60 * 60)
+
+static void rcheevos_hash_cache_path(char* s, size_t len)
+{
+   settings_t* settings = config_get_ptr();
+   s[0] = '\0';
+
+   if (!string_is_empty(settings->paths.directory_playlist))
+      fill_pathname_join(s, settings->paths.directory_playlist,
+            FILE_PATH_CHEEVOS_HASH_CACHE, len);
+}
+
+/* Builds the key identifying the content being loaded. Patched
+ * content is known by the CRC of the patched buffer, anything
+ * else by its path, size and modification time. */
+static bool rcheevos_hash_cache_init_key(rcheevos_coro_t* coro)
+{
+   char file[PATH_MAX_LENGTH];
+   const char* delim;
+   int64_t mtime;
+   int32_t size;
+
+   coro->cache_key[0] = '\0';
+
+   if (coro->content_crc)
+   {
+      snprintf(coro->cache_key, sizeof(coro->cache_key), "crc_%08x_%u",
+            (unsigned)coro->content_crc, (unsigned)coro->len);
+      return true;
+   }
+
+   if (string_is_empty(coro->path))
+      return false;
+
+   /* content inside an archive is dated by the archive */
+   strlcpy(file, coro->path, sizeof(file));
+   if ((delim = path_get_archive_delim(file)))
+      file[delim - file] = '\0';
+
+   mtime = path_get_mtime(file);
+   size  = path_get_size(file);
+   if (mtime <= 0 || size < 0)
+      return false;
+
+   snprintf(coro->cache_key, sizeof(coro->cache_key), "file_%08x_%u_%u",
+         (unsigned)encoding_crc32(0, (const uint8_t*)coro->path,
+            strlen(coro->path)),
+         (unsigned)size, (unsigned)mtime);
+   return true;
+}
+
+/* Looks the content up in the hash cache, filling coro->hash. The
+ * game id is only filled in if it was confirmed recently enough. */
+static bool rcheevos_hash_cache_find(rcheevos_coro_t* coro)
+{
+   char path[PATH_MAX_LENGTH];
+   char entry[64];
+   char hash[sizeof(coro->hash)];
+   config_file_t* conf;
+   unsigned gameid = 0;
+   uint64_t stamp  = 0;
+   bool found      = false;
+
+   coro->cache_hit = false;
+
+   if (!rcheevos_hash_cache_init_key(coro))
+      return false;
+
+   rcheevos_hash_cache_path(path, sizeof(path));
+   if (string_is_empty(path) || !path_is_valid(path))
+      return false;
+
+   if (!(conf = config_file_new_from_path_to_string(path)))
+      return false;
+
+   if (     config_get_array(conf, coro->cache_key, hash, sizeof(hash))
+         && strlen(hash) == sizeof(hash) - 1)
+   {
+      memcpy(coro->hash, hash, sizeof(hash));
+      found = true;
+
+      snprintf(entry, sizeof(entry), "game_%s", hash);
+      if (config_get_uint(conf, entry, &gameid) && gameid)
+      {
+         snprintf(entry, sizeof(entry), "time_%s", hash);
+         if (     config_get_uint64(conf, entry, &stamp)
+               && (uint64_t)time(NULL) - stamp < RCHEEVOS_HASH_CACHE_TTL)
+         {
+            coro->gameid    = gameid;
+            coro->cache_hit = true;
+         }
+      }
+   }
+
+   config_file_free(conf);
+   return found;
+}
+
+/* Remembers the hash that matched for the content and the game id
+ * it belongs to. Misses are not stored, so that content added to
+ * the server later is picked up. */
+static void rcheevos_hash_cache_store(rcheevos_coro_t* coro)
+{
+   char path[PATH_MAX_LENGTH];
+   char entry[64];
+   config_file_t* conf;
+
+   if (coro->cache_hit || coro->gameid == 0 || !coro->cache_key[0])
+      return;
+
+   rcheevos_hash_cache_path(path, sizeof(path));
+   if (string_is_empty(path))
+      return;
+
+   if (!path_is_valid(path) ||
+         !(conf = config_file_new_from_path_to_string(path)))
+      if (!(conf = config_file_new_alloc()))
+         return;
+
+   config_set_string(conf, coro->cache_key, coro->hash);
+   snprintf(entry, sizeof(entry), "game_%s", coro->hash);
+   config_set_uint(conf, entry, coro->gameid);
+   snprintf(entry, sizeof(entry), "time_%s", coro->hash);
+   config_set_uint64(conf, entry, (uint64_t)time(NULL));
+
+   if (!config_file_write(conf, path, true))
+      CHEEVOS_ERR(RCHEEVOS_TAG "could not write %s\n", path);
+
+   config_file_free(conf);
+}
+
 static int rcheevos_iterate(rcheevos_coro_t* coro)
 {
    char buffer[2048];
@@ -2136,25 +2620,42 @@ static int rcheevos_iterate(rcheevos_coro_t* coro)
       if (!coro->settings->bools.cheevos_enable)
          CORO_STOP();
 
-      /* iterate over the possible hashes for the file being loaded */
-      rc_hash_initialize_iterator(&coro->iterator, coro->path, (uint8_t*)coro->data, coro->len);
+      /* content loaded before doesn't need to be hashed again,
+       * and if its game id is recent, it doesn't need to be
+       * looked up either */
+      if (rcheevos_hash_cache_find(coro))
+      {
+         if (coro->cache_hit)
+         {
+            CHEEVOS_LOG(RCHEEVOS_TAG "cached hash %s, game id %u\n", coro->hash, coro->gameid);
+            memcpy(rcheevos_locals.hash, coro->hash, sizeof(coro->hash));
+         }
+         else
+            CORO_GOSUB(RCHEEVOS_GET_GAMEID);
+      }
+
+      if (coro->gameid == 0)
+      {
+         /* iterate over the possible hashes for the file being loaded */
+         rc_hash_initialize_iterator(&coro->iterator, coro->path, (uint8_t*)coro->data, coro->len);
 #ifdef CHEEVOS_TIME_HASH
-      start = cpu_features_get_time_usec();
+         start = cpu_features_get_time_usec();
 #endif
-      while (rc_hash_iterate(coro->hash, &coro->iterator))
-      {
+         while (rc_hash_iterate(coro->hash, &coro->iterator))
+         {
 #ifdef CHEEVOS_TIME_HASH
-         CHEEVOS_LOG(RCHEEVOS_TAG "hash generated in %ums\n", (cpu_features_get_time_usec() - start) / 1000);
+            CHEEVOS_LOG(RCHEEVOS_TAG "hash generated in %ums\n", (cpu_features_get_time_usec() - start) / 1000);
 #endif
-         CORO_GOSUB(RCHEEVOS_GET_GAMEID);
-         if (coro->gameid != 0)
-            break;
+            CORO_GOSUB(RCHEEVOS_GET_GAMEID);
+            if (coro->gameid != 0)
+               break;
 
 #ifdef CHEEVOS_TIME_HASH
-         start = cpu_features_get_time_usec();
+            start = cpu_features_get_time_usec();
 #endif
+         }
+         rc_hash_destroy_iterator(&coro->iterator);
       }
-      rc_hash_destroy_iterator(&coro->iterator);
 
       /* if no match was found, bail */
       if (coro->gameid == 0)
@@ -2165,6 +2666,8 @@ static int rcheevos_iterate(rcheevos_coro_t* coro)
          CORO_STOP();
       }
 
+      rcheevos_hash_cache_store(coro);
+
 #ifdef CHEEVOS_JSON_OVERRIDE
       {
          size_t size = 0;
@@ -2618,6 +3121,9 @@ static int rcheevos_iterate(rcheevos_coro_t* coro)
             sizeof(coro->settings->arrays.cheevos_token));
 
       *coro->settings->arrays.cheevos_password = 0;
+
+      /* send what was earned before the login */
+      rcheevos_pending_submit(&rcheevos_locals);
       CORO_RET();
    }
 
@@ -2970,6 +3476,8 @@ bool rcheevos_load(const void *data)
 
    info = (const struct retro_game_info*)data;
    coro->path = strdup(info->path);
+   /* only known this early when the content was patched */
+   coro->content_crc = content_peek_crc();
 
    if (info->data)
    {
@@ -2996,6 +3504,9 @@ bool rcheevos_load(const void *data)
    }
 
    task->handler   = rcheevos_task_handler;
+   /* hashing may read a whole disc, don't hold up the
+    * tasks started while the core boots */
+   task->affinity  = TASK_AFFINITY_ANY;
    task->state     = (void*)coro;
    task->mute      = true;
    task->callback  = NULL;
@@ -3006,8 +3517,13 @@ bool rcheevos_load(const void *data)
 #ifdef HAVE_THREADS
    if (!rcheevos_locals.task_lock)
       rcheevos_locals.task_lock = slock_new();
+   if (!rcheevos_pending_queue.lock)
+      rcheevos_pending_queue.lock = slock_new();
 #endif
 
+   /* send what is left from previous sessions */
+   rcheevos_pending_submit(&rcheevos_locals);
+
    CHEEVOS_LOCK(rcheevos_locals.task_lock);
    rcheevos_locals.task = task;
    CHEEVOS_UNLOCK(rcheevos_locals.task_lock);
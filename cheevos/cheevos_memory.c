@@ -46,6 +46,126 @@ uint8_t* rcheevos_memory_find(
    return NULL;
 }
 
+/* Address rcheevos uses for the dereferenced half of
+ * an indirect memref until it is first evaluated */
+#define RCHEEVOS_MEMREF_PLACEHOLDER_ADDRESS 0xFFFFFFFF
+
+static unsigned rcheevos_memref_read(const uint8_t* data, char size)
+{
+   switch (size)
+   {
+      case RC_MEMSIZE_8_BITS:
+         return data[0];
+      case RC_MEMSIZE_16_BITS:
+         return (data[1] << 8)  | (data[0]);
+      case RC_MEMSIZE_24_BITS:
+         return (data[2] << 16) | (data[1] << 8) | (data[0]);
+      case RC_MEMSIZE_32_BITS:
+         return (data[3] << 24) | (data[2] << 16) |
+                (data[1] <<  8) | (data[0]);
+      case RC_MEMSIZE_LOW:
+         return data[0] & 0x0f;
+      case RC_MEMSIZE_HIGH:
+         return (data[0] >> 4) & 0x0f;
+      case RC_MEMSIZE_BIT_0:
+      case RC_MEMSIZE_BIT_1:
+      case RC_MEMSIZE_BIT_2:
+      case RC_MEMSIZE_BIT_3:
+      case RC_MEMSIZE_BIT_4:
+      case RC_MEMSIZE_BIT_5:
+      case RC_MEMSIZE_BIT_6:
+      case RC_MEMSIZE_BIT_7:
+         return (data[0] >> (size - RC_MEMSIZE_BIT_0)) & 1;
+   }
+
+   return 0;
+}
+
+void rcheevos_memref_table_build(rcheevos_memref_table_t* table,
+      rc_memref_value_t* memrefs, const rcheevos_memory_regions_t* regions)
+{
+   unsigned count            = 0;
+   rc_memref_value_t* memref = memrefs;
+   rc_memref_value_t* tail   = NULL;
+
+   table->valid              = false;
+   table->count              = 0;
+
+   for (; memref; memref = memref->next)
+      count++;
+
+   if (count > 0)
+   {
+      rcheevos_memref_ptr_t* ptrs = (rcheevos_memref_ptr_t*)realloc(
+            table->ptrs, count * sizeof(*ptrs));
+      if (!ptrs)
+         return;
+      table->ptrs = ptrs;
+   }
+
+   for (memref = memrefs; memref; memref = memref->next)
+   {
+      rcheevos_memref_ptr_t* ptr = &table->ptrs[table->count++];
+
+      ptr->memref = memref;
+      ptr->data   = memref->memref.is_indirect ? NULL
+            : rcheevos_memory_find(regions, memref->memref.address);
+      tail        = memref;
+   }
+
+   table->head  = memrefs;
+   table->tail  = tail;
+   table->valid = true;
+}
+
+bool rcheevos_memref_table_is_stale(const rcheevos_memref_table_t* table,
+      const rc_memref_value_t* memrefs)
+{
+   return !table->valid
+      || table->head != memrefs
+      || (table->tail && table->tail->next);
+}
+
+void rcheevos_memref_table_free(rcheevos_memref_table_t* table)
+{
+   free(table->ptrs);
+   table->ptrs  = NULL;
+   table->head  = NULL;
+   table->tail  = NULL;
+   table->count = 0;
+   table->valid = false;
+}
+
+void rcheevos_memref_table_update(const rcheevos_memref_table_t* table,
+      const rcheevos_memory_regions_t* regions)
+{
+   const rcheevos_memref_ptr_t* ptr = table->ptrs;
+   const rcheevos_memref_ptr_t* end = ptr + table->count;
+
+   for (; ptr < end; ptr++)
+   {
+      rc_memref_value_t* memref = ptr->memref;
+      const uint8_t* data       = ptr->data;
+      unsigned value            = 0;
+
+      if (!data)
+      {
+         if (memref->memref.address == RCHEEVOS_MEMREF_PLACEHOLDER_ADDRESS)
+            continue;
+
+         data = rcheevos_memory_find(regions, memref->memref.address);
+      }
+
+      if (data)
+         value = rcheevos_memref_read(data, memref->memref.size);
+
+      memref->previous = memref->value;
+      memref->value    = value;
+      if (value != memref->previous)
+         memref->prior = memref->previous;
+   }
+}
+
 static const char* rcheevos_memory_type(int type)
 {
    switch (type)
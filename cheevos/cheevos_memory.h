@@ -21,6 +21,8 @@
 
 #include <retro_common_api.h>
 
+#include "../deps/rcheevos/include/rcheevos.h"
+
 RETRO_BEGIN_DECLS
 
 #define MAX_MEMORY_REGIONS 32
@@ -39,6 +41,46 @@ void rcheevos_memory_destroy(rcheevos_memory_regions_t* regions);
 uint8_t* rcheevos_memory_find(const rcheevos_memory_regions_t* regions,
       unsigned address);
 
+/* Memory a memref reads from, resolved once at load
+ * so that the memrefs can be updated in a tight loop
+ * every frame instead of one peek per memref */
+typedef struct rcheevos_memref_ptr
+{
+   rc_memref_value_t* memref;
+   /* NULL if the address has to be resolved every
+    * frame (indirect memrefs) or is not exposed */
+   const uint8_t* data;
+} rcheevos_memref_ptr_t;
+
+typedef struct
+{
+   rcheevos_memref_ptr_t* ptrs;
+   /* First and last memref of the chain when the
+    * table was built, to notice new ones */
+   rc_memref_value_t* head;
+   rc_memref_value_t* tail;
+   unsigned count;
+   bool valid;
+} rcheevos_memref_table_t;
+
+/* Resolves the memory of every memref in @memrefs.
+ * Needs to be called again whenever memrefs are added
+ * or removed, or the memory map changes */
+void rcheevos_memref_table_build(rcheevos_memref_table_t* table,
+      rc_memref_value_t* memrefs, const rcheevos_memory_regions_t* regions);
+
+/* True if the table was invalidated or memrefs were
+ * added to @memrefs since it was built */
+bool rcheevos_memref_table_is_stale(const rcheevos_memref_table_t* table,
+      const rc_memref_value_t* memrefs);
+
+void rcheevos_memref_table_free(rcheevos_memref_table_t* table);
+
+/* Same as rc_update_memref_values(), reading through
+ * the pointers resolved by rcheevos_memref_table_build() */
+void rcheevos_memref_table_update(const rcheevos_memref_table_t* table,
+      const rcheevos_memory_regions_t* regions);
+
 RETRO_END_DECLS
 
 #endif
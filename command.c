@@ -24,6 +24,7 @@
 #endif
 #include <streams/stdin_stream.h>
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
 
 #include "verbosity.h"
 #include "command.h"
@@ -62,8 +63,9 @@ static bool command_get_arg(const char *tok,
          if (*argument != ' ' && *argument != '\0')
             return false;
 
+         /* No argument - don't step past the terminator */
          if (arg)
-            *arg = argument + 1;
+            *arg = *argument ? argument + 1 : argument;
 
          if (index)
             *index = i;
@@ -111,16 +113,420 @@ static void command_parse_msg(
 }
 
 #if defined(HAVE_NETWORK_CMD)
+/* Binary commands
+ *
+ * Datagrams that start with CMD_BIN_MAGIC are binary commands
+ * instead of text. Text commands never start with a NUL byte.
+ * All fields are 32-bit big-endian words:
+ *
+ *   header:  magic, type (high 16 bits) | status (low 16 bits),
+ *            sequence number, payload length
+ *
+ * Replies have CMD_BIN_REPLY set in the type, echo the sequence
+ * number and carry a CMD_BIN_STATUS_* code. Payloads:
+ *
+ *   READ_MEMORY    space, address, length
+ *     reply        address, raw bytes (fewer where memory ends)
+ *   WRITE_MEMORY   space, address, raw bytes (the whole
+ *                  datagram is at most CMD_BUF_SIZE bytes)
+ *     reply        number of bytes written
+ *   SUBSCRIBE      interval in frames, CMD_BIN_SUB_* flags,
+ *                  then up to CMD_BIN_MAX_RANGES times
+ *                  space, address, length
+ *     reply        subscription id
+ *   UNSUBSCRIBE    subscription id, 0 for all of the sender's
+ *   PING           nothing, keeps the sender's subscriptions alive
+ *
+ * A subscription makes the frontend send a PUSH to the subscriber
+ * every 'interval' frames, without any further requests:
+ *
+ *   PUSH           subscription id, frame count (high, low word),
+ *                  with CMD_BIN_SUB_FRAME_STATS: usec in core_run(),
+ *                  usec between frames, CMD_FRAME_STATS_* flags,
+ *                  then the raw bytes of every range in order,
+ *                  zero-filled where the memory ends.
+ *
+ * Subscriptions of a sender that went quiet for
+ * CMD_BIN_SUB_TIMEOUT are dropped.
+ *
+ * Replies and pushes can be much larger than the request, and
+ * the UDP source address can be spoofed, so binary commands are
+ * only served to loopback senders. Anything else would let a
+ * small spoofed datagram aim a stream of pushes at a third
+ * party. Text commands are unaffected. */
+#define CMD_BIN_MAGIC              0x00524142 /* "\0RAB" */
+#define CMD_BIN_HEADER_SIZE        16
+#define CMD_BIN_REPLY              0x8000
+
+#define CMD_BIN_READ_MEMORY        1
+#define CMD_BIN_WRITE_MEMORY       2
+#define CMD_BIN_SUBSCRIBE          3
+#define CMD_BIN_UNSUBSCRIBE        4
+#define CMD_BIN_PING               5
+#define CMD_BIN_PUSH               6
+
+#define CMD_BIN_STATUS_OK          0
+#define CMD_BIN_STATUS_BAD_REQUEST 1
+#define CMD_BIN_STATUS_UNKNOWN     2
+#define CMD_BIN_STATUS_NO_MEMORY   3
+#define CMD_BIN_STATUS_NO_SLOT     4
+
+#define CMD_BIN_SUB_FRAME_STATS    (1 << 0)
+
+#define CMD_BIN_MAX_SUBSCRIPTIONS  8
+#define CMD_BIN_MAX_RANGES         16
+/* Largest UDP payload */
+#define CMD_BIN_MAX_DATAGRAM       65507
+#define CMD_BIN_SUB_TIMEOUT        (30 * 1000000)
+
 typedef struct
 {
+   unsigned space;
+   unsigned address;
+   unsigned len;
+} command_range_t;
+
+typedef struct
+{
+   struct sockaddr_storage addr;
+   retro_time_t last_seen;
+   uint64_t next_frame;
+   uint8_t *buf;          /* Whole PUSH datagram */
+   size_t buf_len;
+   socklen_t addr_len;
+   uint32_t id;           /* 0 if the slot is free */
+   uint32_t seq;
+   unsigned interval;
+   unsigned flags;
+   unsigned num_ranges;
+   command_range_t ranges[CMD_BIN_MAX_RANGES];
+} command_subscription_t;
+
+typedef struct
+{
+   command_subscription_t subs[CMD_BIN_MAX_SUBSCRIPTIONS];
    /* Network socket FD */
    int net_fd;
    /* Source address for the command received */
    struct sockaddr_storage cmd_source;
    /* Size of the previous structure in use */
    socklen_t cmd_source_len;
+   uint32_t next_sub_id;
 } command_network_t;
 
+static uint32_t command_bin_get32(const uint8_t *data)
+{
+   return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16)
+        | ((uint32_t)data[2] <<  8) |  (uint32_t)data[3];
+}
+
+static void command_bin_put32(uint8_t *data, uint32_t value)
+{
+   data[0] = (uint8_t)(value >> 24);
+   data[1] = (uint8_t)(value >> 16);
+   data[2] = (uint8_t)(value >>  8);
+   data[3] = (uint8_t)value;
+}
+
+static void command_bin_put_header(uint8_t *data, unsigned type,
+      unsigned status, uint32_t seq, size_t len)
+{
+   command_bin_put32(data,      CMD_BIN_MAGIC);
+   command_bin_put32(data + 4,  ((uint32_t)type << 16) | status);
+   command_bin_put32(data + 8,  seq);
+   command_bin_put32(data + 12, (uint32_t)len);
+}
+
+static bool command_bin_same_source(const command_network_t *netcmd,
+      const command_subscription_t *sub)
+{
+   return sub->addr_len == netcmd->cmd_source_len
+      && !memcmp(&sub->addr, &netcmd->cmd_source, sub->addr_len);
+}
+
+static bool command_bin_source_is_loopback(const command_network_t *netcmd)
+{
+   const struct sockaddr *addr = (const struct sockaddr*)&netcmd->cmd_source;
+
+   if (addr->sa_family == AF_INET)
+   {
+      const struct sockaddr_in *in = (const struct sockaddr_in*)addr;
+      return (ntohl(in->sin_addr.s_addr) >> 24) == 127;
+   }
+#if defined(AF_INET6) && !defined(HAVE_SOCKET_LEGACY)
+   if (addr->sa_family == AF_INET6)
+   {
+      const struct sockaddr_in6 *in6 = (const struct sockaddr_in6*)addr;
+      return IN6_IS_ADDR_LOOPBACK(&in6->sin6_addr)
+         || (     IN6_IS_ADDR_V4MAPPED(&in6->sin6_addr)
+               && in6->sin6_addr.s6_addr[12] == 127);
+   }
+#endif
+
+   return false;
+}
+
+static void command_bin_unsubscribe(command_subscription_t *sub)
+{
+   free(sub->buf);
+   memset(sub, 0, sizeof(*sub));
+}
+
+static unsigned command_bin_subscribe(command_network_t *netcmd,
+      const uint8_t *payload, size_t len, uint32_t *id)
+{
+   unsigned i;
+   size_t buf_len               = CMD_BIN_HEADER_SIZE + 12;
+   command_subscription_t *sub  = NULL;
+   unsigned num_ranges          = 0;
+
+   if (len < 8 || (len - 8) % 12)
+      return CMD_BIN_STATUS_BAD_REQUEST;
+
+   num_ranges = (unsigned)((len - 8) / 12);
+   if (num_ranges > CMD_BIN_MAX_RANGES)
+      return CMD_BIN_STATUS_BAD_REQUEST;
+
+   for (i = 0; i < CMD_BIN_MAX_SUBSCRIPTIONS; i++)
+   {
+      if (!netcmd->subs[i].id)
+      {
+         sub = &netcmd->subs[i];
+         break;
+      }
+   }
+
+   if (!sub)
+      return CMD_BIN_STATUS_NO_SLOT;
+
+   sub->interval   = MAX(command_bin_get32(payload), 1);
+   sub->flags      = command_bin_get32(payload + 4);
+   sub->num_ranges = num_ranges;
+
+   if (sub->flags & CMD_BIN_SUB_FRAME_STATS)
+      buf_len     += 12;
+
+   for (i = 0; i < num_ranges; i++)
+   {
+      const uint8_t *range   = payload + 8 + i * 12;
+      sub->ranges[i].space   = command_bin_get32(range);
+      sub->ranges[i].address = command_bin_get32(range + 4);
+      sub->ranges[i].len     = command_bin_get32(range + 8);
+
+      if (sub->ranges[i].len > CMD_BIN_MAX_DATAGRAM - buf_len)
+         goto error;
+      buf_len += sub->ranges[i].len;
+   }
+
+   if (!(sub->buf = (uint8_t*)malloc(buf_len)))
+      goto error;
+
+   if (!++netcmd->next_sub_id)
+      netcmd->next_sub_id = 1;
+
+   sub->id         = netcmd->next_sub_id;
+   sub->buf_len    = buf_len;
+   sub->seq        = 0;
+   sub->next_frame = 0;
+   sub->last_seen  = cpu_features_get_time_usec();
+   sub->addr       = netcmd->cmd_source;
+   sub->addr_len   = netcmd->cmd_source_len;
+   *id             = sub->id;
+
+   return CMD_BIN_STATUS_OK;
+
+error:
+   memset(sub, 0, sizeof(*sub));
+   return CMD_BIN_STATUS_BAD_REQUEST;
+}
+
+static void command_bin_parse_msg(command_network_t *netcmd,
+      const uint8_t *data, size_t len)
+{
+   unsigned i;
+   uint8_t *reply      = NULL;
+   size_t reply_len    = 0;
+   unsigned status     = CMD_BIN_STATUS_OK;
+   unsigned type       = command_bin_get32(data + 4) >> 16;
+   uint32_t seq        = command_bin_get32(data + 8);
+   size_t payload_len  = command_bin_get32(data + 12);
+   const uint8_t *payload = data + CMD_BIN_HEADER_SIZE;
+   retro_time_t now    = cpu_features_get_time_usec();
+   uint8_t small_reply[CMD_BIN_HEADER_SIZE + 4];
+
+   /* Any request keeps the sender's subscriptions alive */
+   for (i = 0; i < CMD_BIN_MAX_SUBSCRIPTIONS; i++)
+      if (netcmd->subs[i].id
+            && command_bin_same_source(netcmd, &netcmd->subs[i]))
+         netcmd->subs[i].last_seen = now;
+
+   reply = small_reply;
+
+   if (payload_len > len - CMD_BIN_HEADER_SIZE)
+      status = CMD_BIN_STATUS_BAD_REQUEST;
+   else switch (type)
+   {
+      case CMD_BIN_READ_MEMORY:
+         {
+            size_t read_len;
+            uint32_t address;
+
+            if (payload_len != 12)
+            {
+               status = CMD_BIN_STATUS_BAD_REQUEST;
+               break;
+            }
+
+            address  = command_bin_get32(payload + 4);
+            read_len = MIN(command_bin_get32(payload + 8),
+                  CMD_BIN_MAX_DATAGRAM - CMD_BIN_HEADER_SIZE - 4);
+
+            if (!(reply = (uint8_t*)malloc(
+                        CMD_BIN_HEADER_SIZE + 4 + read_len)))
+            {
+               reply  = small_reply;
+               status = CMD_BIN_STATUS_NO_MEMORY;
+               break;
+            }
+
+            command_bin_put32(reply + CMD_BIN_HEADER_SIZE, address);
+            read_len  = command_memory_read(
+                  (enum command_memory_space)command_bin_get32(payload),
+                  address, reply + CMD_BIN_HEADER_SIZE + 4, read_len);
+            reply_len = 4 + read_len;
+
+            if (!read_len)
+               status = CMD_BIN_STATUS_NO_MEMORY;
+         }
+         break;
+      case CMD_BIN_WRITE_MEMORY:
+         if (payload_len < 8)
+            status = CMD_BIN_STATUS_BAD_REQUEST;
+         else
+         {
+            size_t written = command_memory_write(
+                  (enum command_memory_space)command_bin_get32(payload),
+                  command_bin_get32(payload + 4),
+                  payload + 8, payload_len - 8);
+
+            command_bin_put32(reply + CMD_BIN_HEADER_SIZE,
+                  (uint32_t)written);
+            reply_len = 4;
+
+            if (!written && payload_len > 8)
+               status = CMD_BIN_STATUS_NO_MEMORY;
+         }
+         break;
+      case CMD_BIN_SUBSCRIBE:
+         {
+            uint32_t id = 0;
+
+            status    = command_bin_subscribe(netcmd,
+                  payload, payload_len, &id);
+            command_bin_put32(reply + CMD_BIN_HEADER_SIZE, id);
+            reply_len = 4;
+         }
+         break;
+      case CMD_BIN_UNSUBSCRIBE:
+         if (payload_len != 4)
+            status = CMD_BIN_STATUS_BAD_REQUEST;
+         else
+         {
+            uint32_t id = command_bin_get32(payload);
+
+            /* Only the subscriber may cancel a subscription */
+            for (i = 0; i < CMD_BIN_MAX_SUBSCRIPTIONS; i++)
+               if (netcmd->subs[i].id
+                     && (!id || netcmd->subs[i].id == id)
+                     && command_bin_same_source(netcmd, &netcmd->subs[i]))
+                  command_bin_unsubscribe(&netcmd->subs[i]);
+         }
+         break;
+      case CMD_BIN_PING:
+         break;
+      default:
+         status = CMD_BIN_STATUS_UNKNOWN;
+         break;
+   }
+
+   command_bin_put_header(reply, type | CMD_BIN_REPLY,
+         status, seq, reply_len);
+   sendto(netcmd->net_fd, (const char*)reply,
+         CMD_BIN_HEADER_SIZE + reply_len, 0,
+         (struct sockaddr*)&netcmd->cmd_source, netcmd->cmd_source_len);
+
+   if (reply != small_reply)
+      free(reply);
+}
+
+/* Sends the PUSH of every subscription that is due */
+static void command_bin_push(command_network_t *netcmd)
+{
+   unsigned i;
+   struct command_frame_stats stats;
+   bool have_stats  = false;
+   retro_time_t now = 0;
+
+   for (i = 0; i < CMD_BIN_MAX_SUBSCRIPTIONS; i++)
+   {
+      unsigned j;
+      uint8_t *pos;
+      command_subscription_t *sub = &netcmd->subs[i];
+
+      if (!sub->id)
+         continue;
+
+      if (!have_stats)
+      {
+         command_get_frame_stats(&stats);
+         now        = cpu_features_get_time_usec();
+         have_stats = true;
+      }
+
+      if (now - sub->last_seen > CMD_BIN_SUB_TIMEOUT)
+      {
+         command_bin_unsubscribe(sub);
+         continue;
+      }
+
+      if (stats.frame_count < sub->next_frame)
+         continue;
+
+      sub->next_frame = stats.frame_count + sub->interval;
+
+      pos = sub->buf + CMD_BIN_HEADER_SIZE;
+      command_bin_put32(pos,     sub->id);
+      command_bin_put32(pos + 4, (uint32_t)(stats.frame_count >> 32));
+      command_bin_put32(pos + 8, (uint32_t)stats.frame_count);
+      pos += 12;
+
+      if (sub->flags & CMD_BIN_SUB_FRAME_STATS)
+      {
+         command_bin_put32(pos,     stats.core_run);
+         command_bin_put32(pos + 4, stats.interval);
+         command_bin_put32(pos + 8, stats.flags);
+         pos += 12;
+      }
+
+      for (j = 0; j < sub->num_ranges; j++)
+      {
+         const command_range_t *range = &sub->ranges[j];
+         size_t copied = command_memory_read(
+               (enum command_memory_space)range->space,
+               range->address, pos, range->len);
+
+         if (copied < range->len)
+            memset(pos + copied, 0, range->len - copied);
+         pos += range->len;
+      }
+
+      command_bin_put_header(sub->buf, CMD_BIN_PUSH, CMD_BIN_STATUS_OK,
+            sub->seq++, sub->buf_len - CMD_BIN_HEADER_SIZE);
+      sendto(netcmd->net_fd, (const char*)sub->buf, sub->buf_len, 0,
+            (struct sockaddr*)&sub->addr, sub->addr_len);
+   }
+}
+
 static void network_command_reply(
       command_t *cmd,
       const char * data, size_t len)
@@ -133,8 +539,12 @@ static void network_command_reply(
 
 static void network_command_free(command_t *handle)
 {
+   unsigned i;
    command_network_t *netcmd = (command_network_t*)handle->userptr;
 
+   for (i = 0; i < CMD_BIN_MAX_SUBSCRIPTIONS; i++)
+      free(netcmd->subs[i].buf);
+
    if (netcmd->net_fd >= 0)
       socket_close(netcmd->net_fd);
 
@@ -154,40 +564,52 @@ static void command_network_poll(command_t *handle)
    FD_ZERO(&fds);
    FD_SET(netcmd->net_fd, &fds);
 
-   if (socket_select(netcmd->net_fd + 1, &fds, NULL, NULL, &tmp_tv) <= 0)
-      return;
-
-   if (!FD_ISSET(netcmd->net_fd, &fds))
-      return;
-
-   for (;;)
+   if (     socket_select(netcmd->net_fd + 1, &fds, NULL, NULL, &tmp_tv) > 0
+         && FD_ISSET(netcmd->net_fd, &fds))
    {
-      ssize_t ret;
-      char buf[1024];
+      for (;;)
+      {
+         ssize_t ret;
+         char buf[CMD_BUF_SIZE];
 
-      buf[0] = '\0';
-      netcmd->cmd_source_len = sizeof(struct sockaddr_storage);
-      ret  = recvfrom(netcmd->net_fd, buf, sizeof(buf) - 1, 0,
-            (struct sockaddr*)&netcmd->cmd_source,
-            &netcmd->cmd_source_len);
+         buf[0] = '\0';
+         netcmd->cmd_source_len = sizeof(struct sockaddr_storage);
+         ret  = recvfrom(netcmd->net_fd, buf, sizeof(buf) - 1, 0,
+               (struct sockaddr*)&netcmd->cmd_source,
+               &netcmd->cmd_source_len);
 
-      if (ret <= 0)
-         break;
+         if (ret <= 0)
+            break;
+
+         if (     ret >= CMD_BIN_HEADER_SIZE
+               && command_bin_get32((const uint8_t*)buf) == CMD_BIN_MAGIC)
+         {
+            if (command_bin_source_is_loopback(netcmd))
+               command_bin_parse_msg(netcmd, (const uint8_t*)buf, (size_t)ret);
+            continue;
+         }
 
-      buf[ret] = '\0';
+         buf[ret] = '\0';
 
-      command_parse_msg(handle, buf);
+         command_parse_msg(handle, buf);
+      }
    }
+
+   /* Runs once per frame */
+   command_bin_push(netcmd);
 }
 
-command_t* command_network_new(uint16_t port)
+/* With 'loopback_only', binds to 127.0.0.1 instead of
+ * every interface */
+command_t* command_network_new(uint16_t port, bool loopback_only)
 {
    struct addrinfo     *res  = NULL;
    command_t            *cmd = (command_t*)calloc(1, sizeof(command_t));
    command_network_t *netcmd = (command_network_t*)calloc(
                                    1, sizeof(command_network_t));
    int fd                    = socket_init(
-         (void**)&res, port, NULL, SOCKET_TYPE_DATAGRAM);
+         (void**)&res, port, loopback_only ? "127.0.0.1" : NULL,
+         SOCKET_TYPE_DATAGRAM);
 
    RARCH_LOG("%s %hu.\n",
          msg_hash_to_str(MSG_BRINGING_UP_COMMAND_INTERFACE_ON_PORT),
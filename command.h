@@ -230,7 +230,12 @@ enum event_command
    CMD_EVENT_RECORDING_TOGGLE,
    CMD_EVENT_STREAMING_TOGGLE,
    CMD_EVENT_RUNAHEAD_TOGGLE,
+   /* Measures the input lag of the running content and
+    * saves the matching run-ahead frames as a game override */
+   CMD_EVENT_RUNAHEAD_CALIBRATE,
    CMD_EVENT_AI_SERVICE_TOGGLE,
+   /* Starts or stops (and writes) a trace recording */
+   CMD_EVENT_TRACE_TOGGLE,
    CMD_EVENT_BSV_RECORDING_TOGGLE,
    CMD_EVENT_SHADER_NEXT,
    CMD_EVENT_SHADER_PREV,
@@ -268,7 +273,7 @@ struct rarch_state;
 bool command_event(enum event_command action, void *data);
 
 /* Constructors for the supported drivers */
-command_t* command_network_new(uint16_t port);
+command_t* command_network_new(uint16_t port, bool loopback_only);
 command_t* command_stdin_new(void);
 command_t* command_uds_new(void);
 
@@ -282,7 +287,21 @@ bool command_set_shader(command_t *cmd, const char *arg);
 #if defined(HAVE_COMMAND)
 bool command_version(command_t *cmd, const char* arg);
 bool command_get_status(command_t *cmd, const char* arg);
+bool command_get_frame_timings(command_t *cmd, const char* arg);
+bool command_dump_frame_timings(command_t *cmd, const char* arg);
+bool command_get_perf_scopes(command_t *cmd, const char* arg);
+#ifdef HAVE_MEMORY_TAGS
+bool command_get_memory_tags(command_t *cmd, const char* arg);
+#endif
+bool command_audio_latency_test(command_t *cmd, const char* arg);
+bool command_get_input_report_stats(command_t *cmd, const char* arg);
+#ifdef HAVE_NETWORKING
+bool command_get_netplay_stats(command_t *cmd, const char* arg);
+#endif
 bool command_get_config_param(command_t *cmd, const char* arg);
+#ifdef HAVE_BSV_MOVIE
+bool command_seek_replay(command_t *cmd, const char* arg);
+#endif
 bool command_show_osd_msg(command_t *cmd, const char* arg);
 #ifdef HAVE_CHEEVOS
 bool command_read_ram(command_t *cmd, const char *arg);
@@ -290,6 +309,40 @@ bool command_write_ram(command_t *cmd, const char *arg);
 #endif
 bool command_read_memory(command_t *cmd, const char *arg);
 bool command_write_memory(command_t *cmd, const char *arg);
+bool command_run_job(command_t *cmd, const char *arg);
+bool command_get_job_status(command_t *cmd, const char *arg);
+
+/* Address spaces of the binary network commands */
+enum command_memory_space
+{
+   /* Memory descriptors of the core, see READ_CORE_MEMORY */
+   CMD_MEMORY_SPACE_MAP = 0,
+   /* Achievement addresses, see READ_CORE_RAM */
+   CMD_MEMORY_SPACE_CHEEVOS
+};
+
+#define CMD_FRAME_STATS_PAUSED       (1 << 0)
+#define CMD_FRAME_STATS_FAST_FORWARD (1 << 1)
+#define CMD_FRAME_STATS_SLOW_MOTION  (1 << 2)
+#define CMD_FRAME_STATS_MENU         (1 << 3)
+
+struct command_frame_stats
+{
+   uint64_t frame_count; /* Video frames presented so far */
+   uint32_t core_run;    /* usec in core_run() for the last frame, 0 for menu frames */
+   uint32_t interval;    /* usec between the last two frames */
+   uint32_t flags;       /* CMD_FRAME_STATS_* */
+};
+
+/* Copy up to 'len' bytes of core memory from or to 'address'.
+ * Return the number of bytes copied, which is less than 'len'
+ * where the memory ends. */
+size_t command_memory_read(enum command_memory_space space,
+      unsigned address, uint8_t *data, size_t len);
+size_t command_memory_write(enum command_memory_space space,
+      unsigned address, const uint8_t *data, size_t len);
+
+void command_get_frame_stats(struct command_frame_stats *stats);
 
 struct cmd_action_map
 {
@@ -304,8 +357,23 @@ static const struct cmd_action_map action_map[] = {
 #endif
    { "VERSION",          command_version,          "No argument"},
    { "GET_STATUS",       command_get_status,       "No argument" },
+   { "GET_FRAME_TIMINGS",  command_get_frame_timings,  "No argument" },
+   { "DUMP_FRAME_TIMINGS", command_dump_frame_timings, "<csv path>" },
+   { "GET_PERF_SCOPES",    command_get_perf_scopes,    "No argument" },
+#ifdef HAVE_MEMORY_TAGS
+   { "GET_MEMORY_TAGS",    command_get_memory_tags,    "[RESET]" },
+#endif
+   { "AUDIO_LATENCY_TEST", command_audio_latency_test, "[seconds]" },
+   { "GET_INPUT_REPORT_STATS", command_get_input_report_stats, "[port]" },
+#ifdef HAVE_NETWORKING
+   { "GET_NETPLAY_STATS",  command_get_netplay_stats,  "No argument" },
+#endif
    { "GET_CONFIG_PARAM", command_get_config_param, "<param name>" },
    { "SHOW_MSG",         command_show_osd_msg,     "No argument" },
+#ifdef HAVE_BSV_MOVIE
+   /* Reaches <frame> from the last keyframe before it at full speed */
+   { "SEEK_REPLAY",      command_seek_replay,      "<frame>" },
+#endif
 #if defined(HAVE_CHEEVOS)
    /* These functions use achievement addresses and only work if a game with achievements is
     * loaded. READ_CORE_MEMORY and WRITE_CORE_MEMORY are preferred and use system addresses. */
@@ -314,6 +382,9 @@ static const struct cmd_action_map action_map[] = {
 #endif
    { "READ_CORE_MEMORY", command_read_memory,      "<address> <number of bytes>" },
    { "WRITE_CORE_MEMORY",command_write_memory,     "<address> <byte1> <byte2> ..." },
+   /* Loads the content and runs it, then saves <output>.png, .state and .ram */
+   { "RUN_JOB",          command_run_job,          "<frames>|<core file>|<content path>|<output name>" },
+   { "GET_JOB_STATUS",   command_get_job_status,   "No argument" },
 };
 
 static const struct cmd_map map[] = {
@@ -365,6 +436,7 @@ static const struct cmd_map map[] = {
    { "MENU_A",                 RETRO_DEVICE_ID_JOYPAD_A },
    { "MENU_B",                 RETRO_DEVICE_ID_JOYPAD_B },
    { "AI_SERVICE",             RARCH_AI_SERVICE },
+   { "TRACE_TOGGLE",           RARCH_TRACE_TOGGLE },
 };
 #endif
 
@@ -255,6 +255,22 @@
 #define DEFAULT_CORE_INFO_CACHE_ENABLE false
 #endif
 
+/* Block size in KB of the read cache for content
+ * files opened by cores through VFS, 0 disables it.
+ * Loads the next block in the background while a
+ * file is read sequentially, which helps with disc
+ * images on network shares */
+#define DEFAULT_VFS_READ_BLOCK_SIZE 0
+
+/* CPU cores and priority of the main (emulation),
+ * video, audio, task and recording threads.
+ * Affinity: 0 = any core, 1 = big cores, 2 = little cores
+ * Priority: 0 = unchanged, 1 = high, 2 = low
+ * Big and little cores are only known on Linux;
+ * elsewhere, affinity is left unchanged */
+#define DEFAULT_THREAD_AFFINITY 0
+#define DEFAULT_THREAD_PRIORITY 0
+
 /* Specifies whether to 'reload' (fork and quit)
  * RetroArch when launching content with the
  * currently loaded core
@@ -294,6 +310,11 @@
  */
 #define DEFAULT_FRAME_DELAY 0
 
+/* Picks the frame delay automatically from the measured
+ * core run time. A non-zero video_frame_delay is the upper limit.
+ */
+#define DEFAULT_FRAME_DELAY_AUTO false
+
 /* Inserts black frame(s) inbetween frames.
  * Useful for Higher Hz monitors (set to multiples of 60 Hz) who want to play 60 Hz 
  * material with eliminated  ghosting. video_refresh_rate should still be configured
@@ -597,6 +618,15 @@ static const bool menu_savestate_resume     = false;
 
 #define DEFAULT_MENU_INSERT_DISK_RESUME true
 
+/* Stop redrawing and presenting the menu while
+ * nothing on screen changes, saves power on
+ * battery powered devices */
+#if defined(ANDROID) || defined(IOS) || defined(HAVE_LIBNX) || defined(VITA)
+#define DEFAULT_MENU_SKIP_STATIC_FRAMES true
+#else
+#define DEFAULT_MENU_SKIP_STATIC_FRAMES false
+#endif
+
 #define DEFAULT_QUIT_ON_CLOSE_CONTENT QUIT_ON_CLOSE_CONTENT_DISABLED
 
 /* While the menu is active, supported drivers
@@ -762,6 +792,13 @@ static const unsigned input_backtouch_toggle       = false;
 
 #define DEFAULT_LOG_TO_FILE_TIMESTAMP false
 
+/* Leave writing log messages to a background thread */
+#define DEFAULT_LOG_ASYNC false
+
+/* Seconds recorded by the trace recording hotkey,
+ * 0 records until it is pressed again */
+#define DEFAULT_TRACE_DURATION 5
+
 /* Crop overscanned frames. */
 #define DEFAULT_CROP_OVERSCAN true
 
@@ -795,6 +832,14 @@ static const float message_bgcolor_opacity = 1.0f;
 /* Screenshots post-shaded GPU output if available. */
 #define DEFAULT_GPU_SCREENSHOT true
 
+/* Treat software rendered frames identical to the
+ * previous one as dupes, skipping their upload. */
+#define DEFAULT_VIDEO_FRAME_DUPE_DETECT false
+
+/* PNG, fast multi-threaded PNG or uncompressed BMP.
+ * Savestate thumbnails are always regular PNG. */
+#define DEFAULT_SCREENSHOT_MODE SCREENSHOT_MODE_PNG
+
 /* Watch shader files for changes and auto-apply as necessary. */
 #define DEFAULT_VIDEO_SHADER_WATCH_FILES false
 
@@ -802,6 +847,15 @@ static const float message_bgcolor_opacity = 1.0f;
  * when selecting shader presets/passes via the menu */
 #define DEFAULT_VIDEO_SHADER_REMEMBER_LAST_DIR false
 
+/* Use half float instead of 32-bit float render
+ * targets for slang shader passes. Saves bandwidth
+ * on mobile GPUs, at the cost of precision. */
+#if defined(RARCH_MOBILE)
+#define DEFAULT_VIDEO_SHADER_FP16_FRAMEBUFFERS true
+#else
+#define DEFAULT_VIDEO_SHADER_FP16_FRAMEBUFFERS false
+#endif
+
 /* Screenshots named automatically. */
 #define DEFAULT_AUTO_SCREENSHOT_FILENAME true
 
@@ -811,6 +865,11 @@ static const float message_bgcolor_opacity = 1.0f;
 /* OSD-messages. */
 #define DEFAULT_FONT_ENABLE true
 
+/* Draw text from a distance field atlas rendered once
+ * per font, which stays sharp at any size. Only used by
+ * video drivers with a distance field font shader. */
+#define DEFAULT_FONT_SDF_ENABLE false
+
 /* The accurate refresh rate of your monitor (Hz).
  * This is used to calculate audio input rate with the formula:
  * audio_input_rate = game_input_rate * display_refresh_rate /
@@ -944,6 +1003,10 @@ static const bool audio_enable_menu_bgm    = false;
 /* Will sync audio. (recommended) */
 #define DEFAULT_AUDIO_SYNC true
 
+/* Run audio conversion, DSP, resampling and the driver
+ * write on a separate thread. */
+#define DEFAULT_AUDIO_THREADED_PROCESSING false
+
 /* Audio rate control. */
 #if !defined(RARCH_CONSOLE)
 #define DEFAULT_RATE_CONTROL true
@@ -955,6 +1018,15 @@ static const bool audio_enable_menu_bgm    = false;
  * is allowed to adjust input rate. */
 #define DEFAULT_RATE_CONTROL_DELTA  0.005
 
+/* Use a proportional-integral controller on the smoothed
+ * buffer fill level instead of the plain proportional one.
+ * Better suited to small audio_latency values. */
+#define DEFAULT_RATE_CONTROL_PI false
+
+/* Buffer fill level (in percent) the PI rate controller
+ * steers towards. */
+#define DEFAULT_RATE_CONTROL_TARGET 50
+
 /* Maximum timing skew. Defines how much adjust_system_rates
  * is allowed to adjust input rate. */
 #define DEFAULT_MAX_TIMING_SKEW  0.05
@@ -1055,6 +1127,16 @@ static const bool netplay_client_swap_input = true;
 
 static const bool netplay_nat_traversal = false;
 
+/* Also send input over UDP, repeating the last few frames
+ * in every packet, so a lost TCP segment does not hold up
+ * the inputs behind it. Needs the peer to support it too. */
+static const bool netplay_udp_input = false;
+
+/* When connected as a spectator, re-broadcast the input
+ * stream to further spectators on this TCP port, so that
+ * extra viewers cost the host no upload. 0 disables it. */
+static const unsigned netplay_relay_port = 0;
+
 static const unsigned netplay_delay_frames = 16;
 
 static const int netplay_check_frames = 600;
@@ -1116,6 +1198,10 @@ static const bool savestate_thumbnail_enable = false;
 /* Maximum fast forward ratio. */
 #define DEFAULT_FASTFORWARD_RATIO 0.0
 
+/* Skip presenting frames while fast-forwarding, so that
+ * only about one frame per display refresh is shown. */
+#define DEFAULT_FASTFORWARD_FRAMESKIP false
+
 /* Enable runloop for variable refresh rate screens. Force x1 speed while handling fast forward too. */
 #define DEFAULT_VRR_RUNLOOP_ENABLE false
 
@@ -1125,6 +1211,11 @@ static const bool savestate_thumbnail_enable = false;
 /* When using the Run Ahead feature, use a secondary instance of the core. */
 #define DEFAULT_RUN_AHEAD_SECONDARY_INSTANCE true
 
+/* Load the secondary instance into a namespace of its own instead of
+ * from a temporary copy of the core. Only used for software rendered
+ * cores, and may still break cores that start threads. */
+#define DEFAULT_RUN_AHEAD_SECONDARY_ISOLATED false
+
 /* Hide warning messages when using the Run Ahead feature. */
 #define DEFAULT_RUN_AHEAD_HIDE_WARNINGS false
 
@@ -1135,6 +1226,10 @@ static const bool stdin_cmd_enable = false;
 
 static const uint16_t network_remote_base_port = 55400;
 
+/* Mirror core memory into a shared memory segment
+ * for external tools, see memory_watch.h. */
+#define DEFAULT_MEMORY_WATCH_ENABLE false
+
 #define DEFAULT_NETWORK_BUILDBOT_AUTO_EXTRACT_ARCHIVE true
 #define DEFAULT_NETWORK_BUILDBOT_SHOW_EXPERIMENTAL_CORES false
 
@@ -1158,6 +1253,10 @@ static const uint16_t network_remote_base_port = 55400;
 #define DEFAULT_NETWORK_ON_DEMAND_THUMBNAILS false
 #endif
 
+/* Number of thumbnails the playlist thumbnail
+ * downloader keeps in flight at the same time */
+#define DEFAULT_NETWORK_THUMBNAIL_DOWNLOADS 4
+
 /* Number of entries that will be kept in content history playlist file. */
 static const unsigned default_content_history_size = 200;
 
@@ -1189,6 +1288,11 @@ static const int default_content_favorites_size = 200;
 
 #define DEFAULT_SCAN_WITHOUT_CORE_MATCH false
 
+/* Number of threads reading and hashing content
+ * while a scan matches it against the databases.
+ * 1 scans one file at a time. */
+#define DEFAULT_SCAN_THREADS 4
+
 #ifdef __WINRT__
 /* Be paranoid about WinRT file I/O performance, and leave this disabled by
  * default */
@@ -1295,6 +1399,11 @@ static const unsigned menu_left_thumbnails_default = 0;
 
 static const unsigned gfx_thumbnail_upscale_threshold = 0;
 
+/* Video memory (in MB) that textures of thumbnails
+ * no longer on screen may keep using, so going back
+ * to an entry does not reload them from disk */
+#define DEFAULT_MENU_THUMBNAIL_CACHE_SIZE 32
+
 #ifdef HAVE_MENU
 #define DEFAULT_MENU_TIMEDATE_STYLE          MENU_TIMEDATE_STYLE_DDMM_HM
 #define DEFAULT_MENU_TIMEDATE_DATE_SEPARATOR MENU_TIMEDATE_DATE_SEPARATOR_HYPHEN
@@ -1352,6 +1461,11 @@ static const unsigned midi_volume = 100;
 /* Only applies to Android 7.0 (API 24) and up */
 static const bool sustained_performance_mode = false;
 
+/* Sleeps instead of busy-waiting for frames, throttles
+ * the menu and asks the frontend to keep clocks low
+ * (sustained performance mode, where supported) */
+#define DEFAULT_POWER_SAVING_MODE false
+
 static const bool vibrate_on_keypress        = false;
 static const bool enable_device_vibration    = false;
 
@@ -27,6 +27,7 @@
 #include <retro_assert.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -1366,6 +1367,8 @@ static struct config_path_setting *populate_settings_path(
          settings->paths.directory_system, true, NULL, true);
    SETTING_PATH("cache_directory",
          settings->paths.directory_cache, false, NULL, true);
+   SETTING_PATH("job_directory",
+         settings->paths.directory_job, false, NULL, true);
    SETTING_PATH("input_remapping_directory",
          settings->paths.directory_input_remapping, false, NULL, true);
    SETTING_PATH("resampler_directory",
@@ -1503,15 +1506,19 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("suspend_screensaver_enable",    &settings->bools.ui_suspend_screensaver_enable, true, true, false);
    SETTING_BOOL("rewind_enable",                 &settings->bools.rewind_enable, true, DEFAULT_REWIND_ENABLE, false);
    SETTING_BOOL("vrr_runloop_enable",            &settings->bools.vrr_runloop_enable, true, DEFAULT_VRR_RUNLOOP_ENABLE, false);
+   SETTING_BOOL("fastforward_frameskip",         &settings->bools.fastforward_frameskip, true, DEFAULT_FASTFORWARD_FRAMESKIP, false);
    SETTING_BOOL("apply_cheats_after_toggle",     &settings->bools.apply_cheats_after_toggle, true, DEFAULT_APPLY_CHEATS_AFTER_TOGGLE, false);
    SETTING_BOOL("apply_cheats_after_load",       &settings->bools.apply_cheats_after_load, true, DEFAULT_APPLY_CHEATS_AFTER_LOAD, false);
    SETTING_BOOL("run_ahead_enabled",             &settings->bools.run_ahead_enabled, true, false, false);
    SETTING_BOOL("run_ahead_secondary_instance",  &settings->bools.run_ahead_secondary_instance, true, DEFAULT_RUN_AHEAD_SECONDARY_INSTANCE, false);
+   SETTING_BOOL("run_ahead_secondary_isolated",  &settings->bools.run_ahead_secondary_isolated, true, DEFAULT_RUN_AHEAD_SECONDARY_ISOLATED, false);
    SETTING_BOOL("run_ahead_hide_warnings",       &settings->bools.run_ahead_hide_warnings, true, DEFAULT_RUN_AHEAD_HIDE_WARNINGS, false);
    SETTING_BOOL("audio_sync",                    &settings->bools.audio_sync, true, DEFAULT_AUDIO_SYNC, false);
+   SETTING_BOOL("audio_threaded_processing",     &settings->bools.audio_threaded_processing, true, DEFAULT_AUDIO_THREADED_PROCESSING, false);
    SETTING_BOOL("video_shader_enable",           &settings->bools.video_shader_enable, true, DEFAULT_SHADER_ENABLE, false);
    SETTING_BOOL("video_shader_watch_files",      &settings->bools.video_shader_watch_files, true, DEFAULT_VIDEO_SHADER_WATCH_FILES, false);
    SETTING_BOOL("video_shader_remember_last_dir", &settings->bools.video_shader_remember_last_dir, true, DEFAULT_VIDEO_SHADER_REMEMBER_LAST_DIR, false);
+   SETTING_BOOL("video_shader_fp16_framebuffers", &settings->bools.video_shader_fp16_framebuffers, true, DEFAULT_VIDEO_SHADER_FP16_FRAMEBUFFERS, false);
    SETTING_BOOL("video_shader_preset_save_reference_enable",   &settings->bools.video_shader_preset_save_reference_enable, true, DEFAULT_VIDEO_SHADER_PRESET_SAVE_REFERENCE_ENABLE, false);
 
    /* Let implementation decide if automatic, or 1:1 PAR. */
@@ -1539,9 +1546,11 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("video_vsync",                   &settings->bools.video_vsync, true, DEFAULT_VSYNC, false);
    SETTING_BOOL("video_adaptive_vsync",          &settings->bools.video_adaptive_vsync, true, DEFAULT_ADAPTIVE_VSYNC, false);
    SETTING_BOOL("video_hard_sync",               &settings->bools.video_hard_sync, true, DEFAULT_HARD_SYNC, false);
+   SETTING_BOOL("video_frame_delay_auto",        &settings->bools.video_frame_delay_auto, true, DEFAULT_FRAME_DELAY_AUTO, false);
    SETTING_BOOL("video_disable_composition",     &settings->bools.video_disable_composition, true, DEFAULT_DISABLE_COMPOSITION, false);
    SETTING_BOOL("pause_nonactive",               &settings->bools.pause_nonactive, true, DEFAULT_PAUSE_NONACTIVE, false);
    SETTING_BOOL("video_gpu_screenshot",          &settings->bools.video_gpu_screenshot, true, DEFAULT_GPU_SCREENSHOT, false);
+   SETTING_BOOL("video_frame_dupe_detect",       &settings->bools.video_frame_dupe_detect, true, DEFAULT_VIDEO_FRAME_DUPE_DETECT, false);
    SETTING_BOOL("video_post_filter_record",      &settings->bools.video_post_filter_record, true, DEFAULT_POST_FILTER_RECORD, false);
    SETTING_BOOL("video_notch_write_over_enable", &settings->bools.video_notch_write_over_enable, true, DEFAULT_NOTCH_WRITE_OVER_ENABLE, false);
    SETTING_BOOL("keyboard_gamepad_enable",       &settings->bools.input_keyboard_gamepad_enable, true, true, false);
@@ -1573,6 +1582,7 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("audio_fastforward_mute",        &settings->bools.audio_fastforward_mute, true, DEFAULT_AUDIO_FASTFORWARD_MUTE, false);
    SETTING_BOOL("location_allow",                &settings->bools.location_allow, true, false, false);
    SETTING_BOOL("video_font_enable",             &settings->bools.video_font_enable, true, DEFAULT_FONT_ENABLE, false);
+   SETTING_BOOL("video_font_sdf_enable",         &settings->bools.video_font_sdf_enable, true, DEFAULT_FONT_SDF_ENABLE, false);
    SETTING_BOOL("core_updater_auto_extract_archive", &settings->bools.network_buildbot_auto_extract_archive, true, DEFAULT_NETWORK_BUILDBOT_AUTO_EXTRACT_ARCHIVE, false);
    SETTING_BOOL("core_updater_show_experimental_cores", &settings->bools.network_buildbot_show_experimental_cores, true, DEFAULT_NETWORK_BUILDBOT_SHOW_EXPERIMENTAL_CORES, false);
    SETTING_BOOL("core_updater_auto_backup",      &settings->bools.core_updater_auto_backup, true, DEFAULT_CORE_UPDATER_AUTO_BACKUP, false);
@@ -1599,6 +1609,7 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("menu_pause_libretro",           &settings->bools.menu_pause_libretro, true, true, false);
    SETTING_BOOL("menu_savestate_resume",         &settings->bools.menu_savestate_resume, true, menu_savestate_resume, false);
    SETTING_BOOL("menu_insert_disk_resume",       &settings->bools.menu_insert_disk_resume, true, DEFAULT_MENU_INSERT_DISK_RESUME, false);
+   SETTING_BOOL("menu_skip_static_frames",       &settings->bools.menu_skip_static_frames, true, DEFAULT_MENU_SKIP_STATIC_FRAMES, false);
    SETTING_BOOL("menu_mouse_enable",             &settings->bools.menu_mouse_enable, true, DEFAULT_MOUSE_ENABLE, false);
    SETTING_BOOL("menu_pointer_enable",           &settings->bools.menu_pointer_enable, true, DEFAULT_POINTER_ENABLE, false);
    SETTING_BOOL("menu_timedate_enable",          &settings->bools.menu_timedate_enable, true, true, false);
@@ -1758,11 +1769,15 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("network_cmd_enable",           &settings->bools.network_cmd_enable, true, network_cmd_enable, false);
    SETTING_BOOL("stdin_cmd_enable",             &settings->bools.stdin_cmd_enable, true, stdin_cmd_enable, false);
 #endif
+#ifdef HAVE_MEMORY_WATCH
+   SETTING_BOOL("memory_watch_enable",          &settings->bools.memory_watch_enable, true, DEFAULT_MEMORY_WATCH_ENABLE, false);
+#endif
 #ifdef HAVE_NETWORKGAMEPAD
    SETTING_BOOL("network_remote_enable",        &settings->bools.network_remote_enable, false, false /* TODO */, false);
 #endif
 #ifdef HAVE_NETWORKING
    SETTING_BOOL("netplay_nat_traversal",        &settings->bools.netplay_nat_traversal, true, true, false);
+   SETTING_BOOL("netplay_udp_input",            &settings->bools.netplay_udp_input, true, netplay_udp_input, false);
 #endif
    SETTING_BOOL("block_sram_overwrite",         &settings->bools.block_sram_overwrite, true, DEFAULT_BLOCK_SRAM_OVERWRITE, false);
    SETTING_BOOL("savestate_auto_index",         &settings->bools.savestate_auto_index, true, savestate_auto_index, false);
@@ -1793,6 +1808,7 @@ static struct config_bool_setting *populate_settings_bool(
 #endif
    SETTING_BOOL("input_sensors_enable",         &settings->bools.input_sensors_enable, true, DEFAULT_INPUT_SENSORS_ENABLE, false);
    SETTING_BOOL("audio_rate_control",           &settings->bools.audio_rate_control, true, DEFAULT_RATE_CONTROL, false);
+   SETTING_BOOL("audio_rate_control_pi",        &settings->bools.audio_rate_control_pi, true, DEFAULT_RATE_CONTROL_PI, false);
 #ifdef HAVE_WASAPI
    SETTING_BOOL("audio_wasapi_exclusive_mode",  &settings->bools.audio_wasapi_exclusive_mode, true, DEFAULT_WASAPI_EXCLUSIVE_MODE, false);
    SETTING_BOOL("audio_wasapi_float_format",    &settings->bools.audio_wasapi_float_format, true, DEFAULT_WASAPI_FLOAT_FORMAT, false);
@@ -1808,6 +1824,7 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("video_window_save_positions", &settings->bools.video_window_save_positions, true, false, false);
 
    SETTING_BOOL("sustained_performance_mode",    &settings->bools.sustained_performance_mode, true, sustained_performance_mode, false);
+   SETTING_BOOL("power_saving_mode",             &settings->bools.power_saving_mode, true, DEFAULT_POWER_SAVING_MODE, false);
 
 #ifdef _3DS
    SETTING_BOOL("video_3ds_lcd_bottom",          &settings->bools.video_3ds_lcd_bottom, true, video_3ds_lcd_bottom, false);
@@ -1835,6 +1852,7 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("log_to_file", &settings->bools.log_to_file, true, DEFAULT_LOG_TO_FILE, false);
    SETTING_OVERRIDE(RARCH_OVERRIDE_SETTING_LOG_TO_FILE);
    SETTING_BOOL("log_to_file_timestamp", &settings->bools.log_to_file_timestamp, true, DEFAULT_LOG_TO_FILE_TIMESTAMP, false);
+   SETTING_BOOL("log_async",             &settings->bools.log_async, true, DEFAULT_LOG_ASYNC, false);
    SETTING_BOOL("ai_service_enable",     &settings->bools.ai_service_enable, true, DEFAULT_AI_SERVICE_ENABLE, false);
    SETTING_BOOL("ai_service_pause",      &settings->bools.ai_service_pause, true, DEFAULT_AI_SERVICE_PAUSE, false);
    SETTING_BOOL("wifi_enabled",          &settings->bools.wifi_enabled, true, DEFAULT_WIFI_ENABLE, false);
@@ -1944,6 +1962,7 @@ static struct config_uint_setting *populate_settings_uint(
 #endif
    SETTING_UINT("input_auto_game_focus",        &settings->uints.input_auto_game_focus, true, DEFAULT_INPUT_AUTO_GAME_FOCUS, false);
    SETTING_UINT("audio_latency",                &settings->uints.audio_latency, false, 0 /* TODO */, false);
+   SETTING_UINT("audio_rate_control_target",    &settings->uints.audio_rate_control_target, true, DEFAULT_RATE_CONTROL_TARGET, false);
    SETTING_UINT("audio_resampler_quality",      &settings->uints.audio_resampler_quality, true, audio_resampler_quality_level, false);
    SETTING_UINT("audio_block_frames",           &settings->uints.audio_block_frames, true, 0, false);
 #ifdef ANDROID
@@ -1955,6 +1974,18 @@ static struct config_uint_setting *populate_settings_uint(
    SETTING_UINT("savestate_max_keep",           &settings->uints.savestate_max_keep, true, DEFAULT_SAVESTATE_MAX_KEEP, false);
    SETTING_UINT("frontend_log_level",           &settings->uints.frontend_log_level, true, DEFAULT_FRONTEND_LOG_LEVEL, false);
    SETTING_UINT("libretro_log_level",           &settings->uints.libretro_log_level, true, DEFAULT_LIBRETRO_LOG_LEVEL, false);
+   SETTING_UINT("trace_duration",               &settings->uints.trace_duration, true, DEFAULT_TRACE_DURATION, false);
+   SETTING_UINT("vfs_read_block_size",          &settings->uints.vfs_read_block_size, true, DEFAULT_VFS_READ_BLOCK_SIZE, false);
+   SETTING_UINT("thread_affinity_main",         &settings->uints.thread_affinity_main, true, DEFAULT_THREAD_AFFINITY, false);
+   SETTING_UINT("thread_affinity_video",        &settings->uints.thread_affinity_video, true, DEFAULT_THREAD_AFFINITY, false);
+   SETTING_UINT("thread_affinity_audio",        &settings->uints.thread_affinity_audio, true, DEFAULT_THREAD_AFFINITY, false);
+   SETTING_UINT("thread_affinity_task",         &settings->uints.thread_affinity_task, true, DEFAULT_THREAD_AFFINITY, false);
+   SETTING_UINT("thread_affinity_record",       &settings->uints.thread_affinity_record, true, DEFAULT_THREAD_AFFINITY, false);
+   SETTING_UINT("thread_priority_main",         &settings->uints.thread_priority_main, true, DEFAULT_THREAD_PRIORITY, false);
+   SETTING_UINT("thread_priority_video",        &settings->uints.thread_priority_video, true, DEFAULT_THREAD_PRIORITY, false);
+   SETTING_UINT("thread_priority_audio",        &settings->uints.thread_priority_audio, true, DEFAULT_THREAD_PRIORITY, false);
+   SETTING_UINT("thread_priority_task",         &settings->uints.thread_priority_task, true, DEFAULT_THREAD_PRIORITY, false);
+   SETTING_UINT("thread_priority_record",       &settings->uints.thread_priority_record, true, DEFAULT_THREAD_PRIORITY, false);
    SETTING_UINT("keyboard_gamepad_mapping_type",&settings->uints.input_keyboard_gamepad_mapping_type, true, 1, false);
    SETTING_UINT("input_poll_type_behavior",     &settings->uints.input_poll_type_behavior, true, 2, false);
    SETTING_UINT("video_monitor_index",          &settings->uints.video_monitor_index, true, DEFAULT_MONITOR_INDEX, false);
@@ -1980,6 +2011,7 @@ static struct config_uint_setting *populate_settings_uint(
    SETTING_UINT("menu_thumbnails",              &settings->uints.gfx_thumbnails, true, gfx_thumbnails_default, false);
    SETTING_UINT("menu_left_thumbnails",         &settings->uints.menu_left_thumbnails, true, menu_left_thumbnails_default, false);
    SETTING_UINT("menu_thumbnail_upscale_threshold", &settings->uints.gfx_thumbnail_upscale_threshold, true, gfx_thumbnail_upscale_threshold, false);
+   SETTING_UINT("menu_thumbnail_cache_size",        &settings->uints.menu_thumbnail_cache_size, true, DEFAULT_MENU_THUMBNAIL_CACHE_SIZE, false);
    SETTING_UINT("menu_timedate_style",          &settings->uints.menu_timedate_style, true, DEFAULT_MENU_TIMEDATE_STYLE, false);
    SETTING_UINT("menu_timedate_date_separator", &settings->uints.menu_timedate_date_separator, true, DEFAULT_MENU_TIMEDATE_DATE_SEPARATOR, false);
    SETTING_UINT("menu_ticker_type",             &settings->uints.menu_ticker_type, true, DEFAULT_MENU_TICKER_TYPE, false);
@@ -2052,6 +2084,8 @@ static struct config_uint_setting *populate_settings_uint(
 #ifdef HAVE_NETWORKING
    SETTING_UINT("netplay_ip_port",              &settings->uints.netplay_port,         true, RARCH_DEFAULT_PORT, false);
    SETTING_OVERRIDE(RARCH_OVERRIDE_SETTING_NETPLAY_IP_PORT);
+   SETTING_UINT("netplay_relay_port",           &settings->uints.netplay_relay_port,   true, netplay_relay_port, false);
+   SETTING_UINT("network_thumbnail_downloads",  &settings->uints.network_thumbnail_downloads, true, DEFAULT_NETWORK_THUMBNAIL_DOWNLOADS, false);
    SETTING_UINT("netplay_input_latency_frames_min",&settings->uints.netplay_input_latency_frames_min, true, 0, false);
    SETTING_UINT("netplay_input_latency_frames_range",&settings->uints.netplay_input_latency_frames_range, true, 0, false);
    SETTING_UINT("netplay_share_digital",        &settings->uints.netplay_share_digital, true, netplay_share_digital, false);
@@ -2091,6 +2125,8 @@ static struct config_uint_setting *populate_settings_uint(
    SETTING_UINT("ai_service_source_lang",            &settings->uints.ai_service_source_lang,    true, 0, false);
 
    SETTING_UINT("video_record_threads",            &settings->uints.video_record_threads,    true, DEFAULT_VIDEO_RECORD_THREADS, false);
+   SETTING_UINT("scan_threads",                    &settings->uints.scan_threads,            true, DEFAULT_SCAN_THREADS, false);
+   SETTING_UINT("screenshot_mode",                 &settings->uints.screenshot_mode,         true, DEFAULT_SCREENSHOT_MODE, false);
 
 #ifdef HAVE_LIBNX
    SETTING_UINT("libnx_overclock",  &settings->uints.libnx_overclock, true, SWITCH_DEFAULT_CPU_PROFILE, false);
@@ -2472,6 +2508,7 @@ void config_set_defaults(void *data)
    *settings->paths.directory_screenshot = '\0';
    *settings->paths.directory_system = '\0';
    *settings->paths.directory_cache = '\0';
+   *settings->paths.directory_job = '\0';
    *settings->paths.directory_input_remapping = '\0';
    *settings->paths.directory_core_assets = '\0';
    *settings->paths.directory_assets = '\0';
@@ -2750,9 +2787,14 @@ void config_set_defaults(void *data)
 void config_load(void *data)
 {
    global_t *global = (global_t*)data;
+#ifdef HAVE_CONFIGFILE
+   retro_time_t start_usec;
+#endif
    config_set_defaults(global);
 #ifdef HAVE_CONFIGFILE
+   start_usec       = cpu_features_get_time_usec();
    config_parse_file(global);
+   retroarch_startup_trace_add("Config file", start_usec);
 #endif
 }
 
@@ -2799,6 +2841,19 @@ static bool check_menu_driver_compatibility(settings_t *settings)
 }
 #endif
 
+/* Loads a main config file, through its binary
+ * cache, see config_file_new_from_path_cached() */
+static config_file_t *config_file_new_main(const char *path)
+{
+   char cache_path[PATH_MAX_LENGTH];
+
+   cache_path[0] = '\0';
+
+   fill_pathname(cache_path, path,
+         FILE_PATH_CONFIG_CACHE_EXTENSION, sizeof(cache_path));
+   return config_file_new_from_path_cached(path, cache_path);
+}
+
 /**
  * open_default_config_file
  *
@@ -2826,7 +2881,7 @@ static config_file_t *open_default_config_file(void)
    fill_pathname_resolve_relative(conf_path, app_path,
          FILE_PATH_MAIN_CONFIG, sizeof(conf_path));
 
-   conf = config_file_new_from_path_to_string(conf_path);
+   conf = config_file_new_main(conf_path);
 
    if (!conf)
    {
@@ -2835,7 +2890,7 @@ static config_file_t *open_default_config_file(void)
       {
          fill_pathname_join(conf_path, application_data,
                FILE_PATH_MAIN_CONFIG, sizeof(conf_path));
-         conf = config_file_new_from_path_to_string(conf_path);
+         conf = config_file_new_main(conf_path);
       }
    }
 
@@ -2878,7 +2933,7 @@ static config_file_t *open_default_config_file(void)
 
    fill_pathname_join(conf_path, application_data,
          FILE_PATH_MAIN_CONFIG, sizeof(conf_path));
-   conf = config_file_new_from_path_to_string(conf_path);
+   conf = config_file_new_main(conf_path);
 
    if (!conf)
    {
@@ -2911,7 +2966,7 @@ static config_file_t *open_default_config_file(void)
       fill_pathname_join(conf_path, application_data,
             FILE_PATH_MAIN_CONFIG, sizeof(conf_path));
       RARCH_LOG("[Config]: Looking for config in: \"%s\".\n", conf_path);
-      conf = config_file_new_from_path_to_string(conf_path);
+      conf = config_file_new_main(conf_path);
    }
 
    /* Fallback to $HOME/.retroarch.cfg. */
@@ -2920,7 +2975,7 @@ static config_file_t *open_default_config_file(void)
       fill_pathname_join(conf_path, getenv("HOME"),
             "." FILE_PATH_MAIN_CONFIG, sizeof(conf_path));
       RARCH_LOG("[Config]: Looking for config in: \"%s\".\n", conf_path);
-      conf = config_file_new_from_path_to_string(conf_path);
+      conf = config_file_new_main(conf_path);
    }
 
    if (!conf && has_application_data)
@@ -3055,7 +3110,7 @@ static bool config_load_file(global_t *global,
    struct config_size_setting *size_settings       = populate_settings_size  (settings, &size_settings_size);
    struct config_array_setting *array_settings     = populate_settings_array (settings, &array_settings_size);
    struct config_path_setting *path_settings       = populate_settings_path  (settings, &path_settings_size);
-   config_file_t *conf                             = path ? config_file_new_from_path_to_string(path) : open_default_config_file();
+   config_file_t *conf                             = path ? config_file_new_main(path) : open_default_config_file();
 
    tmp_str[0] = '\0';
 
@@ -3526,7 +3581,9 @@ static bool config_load_file(global_t *global,
    libnx_apply_overclock();
 #endif
 
-   frontend_driver_set_sustained_performance_mode(settings->bools.sustained_performance_mode);
+   frontend_driver_set_sustained_performance_mode(
+         settings->bools.sustained_performance_mode ||
+         settings->bools.power_saving_mode);
    recording_driver_update_streaming_url();
 
    if (!config_entry_exists(conf, "user_language"))
@@ -4085,7 +4142,7 @@ bool config_save_file(const char *path)
    struct config_float_setting     *float_settings   = NULL;
    struct config_array_setting     *array_settings   = NULL;
    struct config_path_setting     *path_settings     = NULL;
-   config_file_t                              *conf  = config_file_new_from_path_to_string(path);
+   config_file_t                              *conf  = config_file_new_main(path);
    settings_t                              *settings = config_get_ptr();
    global_t *global                                  = global_get_ptr();
    int bool_settings_size                            = sizeof(settings->bools) / sizeof(settings->bools.placeholder);
@@ -137,6 +137,7 @@ typedef struct settings
       unsigned audio_out_rate;
       unsigned audio_block_frames;
       unsigned audio_latency;
+      unsigned audio_rate_control_target;
 
       unsigned fps_update_interval;
       unsigned memory_update_interval;
@@ -164,6 +165,8 @@ typedef struct settings
       unsigned input_auto_game_focus;
 
       unsigned netplay_port;
+      unsigned netplay_relay_port;
+      unsigned network_thumbnail_downloads;
       unsigned netplay_input_latency_frames_min;
       unsigned netplay_input_latency_frames_range;
       unsigned netplay_share_digital;
@@ -173,6 +176,18 @@ typedef struct settings
       unsigned content_history_size;
       unsigned frontend_log_level;
       unsigned libretro_log_level;
+      unsigned trace_duration;
+      unsigned vfs_read_block_size;
+      unsigned thread_affinity_main;
+      unsigned thread_affinity_video;
+      unsigned thread_affinity_audio;
+      unsigned thread_affinity_task;
+      unsigned thread_affinity_record;
+      unsigned thread_priority_main;
+      unsigned thread_priority_video;
+      unsigned thread_priority_audio;
+      unsigned thread_priority_task;
+      unsigned thread_priority_record;
       unsigned rewind_granularity;
       unsigned rewind_buffer_size_step;
       unsigned autosave_interval;
@@ -227,6 +242,7 @@ typedef struct settings
       unsigned gfx_thumbnails;
       unsigned menu_left_thumbnails;
       unsigned gfx_thumbnail_upscale_threshold;
+      unsigned menu_thumbnail_cache_size;
       unsigned menu_rgui_thumbnail_downscaler;
       unsigned menu_rgui_thumbnail_delay;
       unsigned menu_rgui_color_theme;
@@ -279,6 +295,8 @@ typedef struct settings
       unsigned window_position_height;
 
       unsigned video_record_threads;
+      unsigned scan_threads;
+      unsigned screenshot_mode;
 
       unsigned libnx_overclock;
       unsigned ai_service_mode;
@@ -455,6 +473,7 @@ typedef struct settings
       char directory_screenshot[PATH_MAX_LENGTH];
       char directory_system[PATH_MAX_LENGTH];
       char directory_cache[PATH_MAX_LENGTH];
+      char directory_job[PATH_MAX_LENGTH];
       char directory_playlist[PATH_MAX_LENGTH];
       char directory_content_favorites[PATH_MAX_LENGTH];
       char directory_content_history[PATH_MAX_LENGTH];
@@ -485,6 +504,7 @@ typedef struct settings
       bool video_vsync;
       bool video_adaptive_vsync;
       bool video_hard_sync;
+      bool video_frame_delay_auto;
       bool video_vfilter;
       bool video_smooth;
       bool video_ctx_scaling;
@@ -496,13 +516,16 @@ typedef struct settings
       bool video_shader_enable;
       bool video_shader_watch_files;
       bool video_shader_remember_last_dir;
+      bool video_shader_fp16_framebuffers;
       bool video_shader_preset_save_reference_enable;
       bool video_threaded;
       bool video_font_enable;
+      bool video_font_sdf_enable;
       bool video_disable_composition;
       bool video_post_filter_record;
       bool video_gpu_record;
       bool video_gpu_screenshot;
+      bool video_frame_dupe_detect;
       bool video_allow_rotate;
       bool video_shared_context;
       bool video_force_srgb_disable;
@@ -529,7 +552,9 @@ typedef struct settings
       bool audio_enable_menu_notice;
       bool audio_enable_menu_bgm;
       bool audio_sync;
+      bool audio_threaded_processing;
       bool audio_rate_control;
+      bool audio_rate_control_pi;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
       bool audio_fastforward_mute;
@@ -582,6 +607,7 @@ typedef struct settings
       bool menu_pause_libretro;
       bool menu_savestate_resume;
       bool menu_insert_disk_resume;
+      bool menu_skip_static_frames;
       bool menu_timedate_enable;
       bool menu_battery_level_enable;
       bool menu_core_enable;
@@ -705,6 +731,7 @@ typedef struct settings
       bool netplay_require_slaves;
       bool netplay_stateless_mode;
       bool netplay_nat_traversal;
+      bool netplay_udp_input;
       bool netplay_use_mitm_server;
       bool netplay_request_devices[MAX_USERS];
 
@@ -766,10 +793,12 @@ typedef struct settings
       bool playlist_entry_rename;
       bool rewind_enable;
       bool vrr_runloop_enable;
+      bool fastforward_frameskip;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
+      bool run_ahead_secondary_isolated;
       bool run_ahead_hide_warnings;
       bool pause_nonactive;
       bool block_sram_overwrite;
@@ -781,6 +810,7 @@ typedef struct settings
       bool savestate_file_compression;
       bool network_cmd_enable;
       bool stdin_cmd_enable;
+      bool memory_watch_enable;
       bool keymapper_enable;
       bool network_remote_enable;
       bool network_remote_enable_user[MAX_USERS];
@@ -819,6 +849,7 @@ typedef struct settings
       bool video_window_save_positions;
 
       bool sustained_performance_mode;
+      bool power_saving_mode;
       bool playlist_use_old_format;
       bool playlist_compression;
       bool content_runtime_log;
@@ -839,6 +870,7 @@ typedef struct settings
 
       bool log_to_file;
       bool log_to_file_timestamp;
+      bool log_async;
 
       bool scan_without_core_match;
 
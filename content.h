@@ -54,7 +54,8 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave);
 /* Gets the number of bytes required to serialize the state. */
 size_t content_get_serialized_size(void);
 
-/* Serializes the current state. buffer must be at least content_get_serialized_size bytes */
+/* Serializes the current state. buffer must be at least content_get_serialized_size bytes.
+ * The rastate headers and the core data are written in place, without an intermediate copy. */
 bool content_serialize_state(void* buffer, size_t buffer_size);
 
 /* Deserializes the current state. */
@@ -66,6 +67,29 @@ void content_wait_for_save_state_task(void);
 /* Copy a save state. */
 bool content_rename_state(const char *origin, const char *dest);
 
+typedef struct
+{
+   int64_t timestamp;   /* Time of the save, in seconds since the epoch */
+   uint64_t size;       /* Size of the state file, in bytes */
+   int slot;            /* -1 is the auto slot */
+   bool has_thumbnail;
+} content_state_slot_info_t;
+
+/* Looks up a savestate slot of the current content in
+ * the slot index, without touching the state file.
+ * Returns false if the slot holds no state. */
+bool content_get_state_slot_info(int slot, content_state_slot_info_t *info);
+
+/* Returns all savestate slots of the current content
+ * that hold a state, ordered by slot, and their number
+ * in @count. The list stays valid until the next save. */
+const content_state_slot_info_t *content_get_state_slots(size_t *count);
+
+/* Refreshes the slot index entry of the state at @path
+ * after it was created, replaced or deleted outside of
+ * the save tasks. */
+void content_update_state_slot_info(const char *path);
+
 /* Undoes the last load state operation that was done */
 bool content_undo_load_state(void);
 
@@ -81,6 +105,10 @@ void content_unset_does_not_need_content(void);
 
 uint32_t content_get_crc(void);
 
+/* Returns the CRC32 of the loaded content if it is already
+ * known, without computing a pending one; 0 otherwise */
+uint32_t content_peek_crc(void);
+
 void content_deinit(void);
 
 /* Initializes and loads a content file for the currently
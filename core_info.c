@@ -21,10 +21,10 @@
 #include <file/config_file.h>
 #include <file/file_path.h>
 #include <streams/file_stream.h>
-#include <streams/interface_stream.h>
-#include <formats/rjson.h>
 #include <lists/dir_list.h>
 #include <file/archive_file.h>
+#include <array/rbuf.h>
+#include <array/rhmap.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -50,10 +50,18 @@
 
 #define CORE_INFO_CACHE_DEFAULT_CAPACITY 8
 
-/* TODO/FIXME: Apparently rzip compression is an issue on UWP */
-#if defined(HAVE_ZLIB) && !(defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP)
-#define CORE_INFO_CACHE_COMPRESS
-#endif
+/* The info cache holds what core_info_list_new() needs
+ * of every installed core. It is a header followed by
+ * fixed size records and the string table they point
+ * into, so loading it needs no parsing. The details are
+ * not part of it, see core_info_get_details() */
+#define CORE_INFO_CACHE_MAGIC   0x49434152 /* 'RACI' */
+#define CORE_INFO_CACHE_VERSION 1
+
+#define CORE_INFO_CACHE_FLAG_HAS_INFO                      (1 << 0)
+#define CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME              (1 << 1)
+#define CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER (1 << 2)
+#define CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL               (1 << 3)
 
 typedef struct
 {
@@ -65,17 +73,28 @@ typedef struct
 
 typedef struct
 {
-   core_info_t *core_info;
-   core_info_cache_list_t *core_info_cache_list;
-   char **current_string_val;
-   struct string_list **current_string_list_val;
-   uint32_t *current_entry_uint_val;
-   bool *current_entry_bool_val;
-   unsigned array_depth;
-   unsigned object_depth;
-   bool to_core_file_id;
-   bool to_firmware;
-} CCJSONContext;
+   uint32_t magic;
+   uint32_t version;
+   uint32_t count;
+   uint32_t strings_size;
+} core_info_cache_header_t;
+
+/* Strings are offsets into the string table, 0 if NULL */
+typedef struct
+{
+   uint32_t path;
+   uint32_t display_name;
+   uint32_t display_version;
+   uint32_t core_name;
+   uint32_t systemname;
+   uint32_t system_id;
+   uint32_t supported_extensions;
+   uint32_t licenses;
+   uint32_t databases;
+   uint32_t required_hw_api;
+   uint32_t core_file_id;
+   uint32_t flags;
+} core_info_cache_record_t;
 
 /* Forward declarations */
 static void core_info_free(core_info_t* info);
@@ -84,341 +103,27 @@ static core_info_cache_list_t *core_info_cache_list_new(void);
 static void core_info_cache_add(core_info_cache_list_t *list, core_info_t *info,
       bool transfer);
 
-/* JSON Handlers START */
-
-static bool CCJSONObjectMemberHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext *)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_string_list_val = NULL;
-      pCtx->current_entry_uint_val  = NULL;
-      pCtx->current_entry_bool_val  = NULL;
-      pCtx->to_core_file_id         = false;
-      pCtx->to_firmware             = false;
-
-      switch (pValue[0])
-      {
-         case 'a':
-            if (string_is_equal(pValue,      "authors"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->authors;
-               pCtx->current_string_list_val = &pCtx->core_info->authors_list;
-            }
-            break;
-         case 'c':
-            if (string_is_equal(pValue,      "categories"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->categories;
-               pCtx->current_string_list_val = &pCtx->core_info->categories_list;
-            }
-            else if (string_is_equal(pValue, "core_name"))
-               pCtx->current_string_val      = &pCtx->core_info->core_name;
-            else if (string_is_equal(pValue, "core_file_id"))
-               pCtx->to_core_file_id         = true;
-            break;
-         case 'd':
-            if (string_is_equal(pValue,      "display_name"))
-               pCtx->current_string_val      = &pCtx->core_info->display_name;
-            else if (string_is_equal(pValue, "display_version"))
-               pCtx->current_string_val      = &pCtx->core_info->display_version;
-            else if (string_is_equal(pValue, "databases"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->databases;
-               pCtx->current_string_list_val = &pCtx->core_info->databases_list;
-            }
-            else if (string_is_equal(pValue, "description"))
-               pCtx->current_string_val      = &pCtx->core_info->description;
-            else if (string_is_equal(pValue, "database_match_archive_member"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->database_match_archive_member;
-            break;
-         case 'f':
-            if (string_is_equal(pValue,      "firmware"))
-               pCtx->to_firmware             = true;
-            break;
-         case 'h':
-            if (string_is_equal(pValue,      "has_info"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->has_info;
-            break;
-         case 'l':
-            if (string_is_equal(pValue,      "licenses"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->licenses;
-               pCtx->current_string_list_val = &pCtx->core_info->licenses_list;
-            }
-            else if (string_is_equal(pValue, "is_experimental"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->is_experimental;
-            break;
-         case 'n':
-            if (string_is_equal(pValue,      "notes"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->notes;
-               pCtx->current_string_list_val = &pCtx->core_info->note_list;
-            }
-            break;
-         case 'p':
-            if (string_is_equal(pValue,      "path"))
-               pCtx->current_string_val      = &pCtx->core_info->path;
-            else if (string_is_equal(pValue, "permissions"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->permissions;
-               pCtx->current_string_list_val = &pCtx->core_info->permissions_list;
-            }
-            break;
-         case 'r':
-            if (string_is_equal(pValue,      "required_hw_api"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->required_hw_api;
-               pCtx->current_string_list_val = &pCtx->core_info->required_hw_api_list;
-            }
-            break;
-         case 's':
-            if (string_is_equal(pValue,      "system_manufacturer"))
-               pCtx->current_string_val      = &pCtx->core_info->system_manufacturer;
-            else if (string_is_equal(pValue, "systemname"))
-               pCtx->current_string_val      = &pCtx->core_info->systemname;
-            else if (string_is_equal(pValue, "system_id"))
-               pCtx->current_string_val      = &pCtx->core_info->system_id;
-            else if (string_is_equal(pValue, "supported_extensions"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->supported_extensions;
-               pCtx->current_string_list_val = &pCtx->core_info->supported_extensions_list;
-            }
-            else if (string_is_equal(pValue, "supports_no_game"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->supports_no_game;
-            break;
-      }
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 1) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_entry_uint_val  = NULL;
-
-      if (pCtx->to_core_file_id)
-      {
-         if (string_is_equal(pValue,         "str"))
-            pCtx->current_string_val         = &pCtx->core_info->core_file_id.str;
-         else if (string_is_equal(pValue,    "hash"))
-            pCtx->current_entry_uint_val     = &pCtx->core_info->core_file_id.hash;
-      }
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 2) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_entry_bool_val  = NULL;
-
-      if (pCtx->to_firmware && (pCtx->core_info->firmware_count > 0))
-      {
-         size_t firmware_idx = pCtx->core_info->firmware_count - 1;
-
-         if (string_is_equal(pValue,         "path"))
-            pCtx->current_string_val         = &pCtx->core_info->firmware[firmware_idx].path;
-         else if (string_is_equal(pValue,    "desc"))
-            pCtx->current_string_val         = &pCtx->core_info->firmware[firmware_idx].desc;
-         else if (string_is_equal(pValue,    "optional"))
-            pCtx->current_entry_bool_val     = &pCtx->core_info->firmware[firmware_idx].optional;
-      }
-   }
-
-   return true;
-}
-
-static bool CCJSONStringHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if (pCtx->current_string_val && length && !string_is_empty(pValue))
-   {
-      if (*pCtx->current_string_val)
-         free(*pCtx->current_string_val);
-      *pCtx->current_string_val = strdup(pValue);
-
-      if (pCtx->current_string_list_val)
-      {
-         if (*pCtx->current_string_list_val)
-            string_list_free(*pCtx->current_string_list_val);
-         *pCtx->current_string_list_val = string_split(*pCtx->current_string_val, "|");
-      }
-   }
-
-   pCtx->current_string_val      = NULL;
-   pCtx->current_string_list_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONNumberHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if (pCtx->current_entry_uint_val)
-      *pCtx->current_entry_uint_val = string_to_unsigned(pValue);
-
-   pCtx->current_entry_uint_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONBoolHandler(void *context, bool value)
-{
-   CCJSONContext *pCtx = (CCJSONContext *)context;
-
-   if (pCtx->current_entry_bool_val)
-      *pCtx->current_entry_bool_val = value;
-
-   pCtx->current_entry_bool_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONStartObjectHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   pCtx->object_depth++;
-
-   if ((pCtx->object_depth == 1) && (pCtx->array_depth == 0))
-   {
-      if (pCtx->core_info_cache_list)
-         return false;
-
-      pCtx->core_info_cache_list = core_info_cache_list_new();
-      if (!pCtx->core_info_cache_list)
-         return false;
-   }
-   else if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1))
-   {
-      if (pCtx->core_info)
-      {
-         core_info_free(pCtx->core_info);
-         free(pCtx->core_info);
-         pCtx->core_info = NULL;
-      }
-
-      pCtx->core_info = (core_info_t*)calloc(1, sizeof(core_info_t));
-      if (!pCtx->core_info)
-         return false;
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 2))
-   {
-      if (pCtx->to_firmware)
-      {
-         size_t new_idx                     = pCtx->core_info->firmware_count;
-         core_info_firmware_t *firmware_tmp = (core_info_firmware_t*)
-               realloc(pCtx->core_info->firmware,
-                     (pCtx->core_info->firmware_count + 1) * sizeof(core_info_firmware_t));
-
-         if (!firmware_tmp)
-            return false;
-
-         firmware_tmp[new_idx].path     = NULL;
-         firmware_tmp[new_idx].desc     = NULL;
-         firmware_tmp[new_idx].missing  = false;
-         firmware_tmp[new_idx].optional = false;
-
-         pCtx->core_info->firmware      = firmware_tmp;
-         pCtx->core_info->firmware_count++;
-      }
-   }
-
-   return true;
-}
-
-static bool CCJSONEndObjectHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1) && pCtx->core_info)
-   {
-      core_info_cache_add(pCtx->core_info_cache_list, pCtx->core_info, true);
-      free(pCtx->core_info);
-      pCtx->core_info = NULL;
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 1))
-      pCtx->to_core_file_id = false;
-
-   retro_assert(pCtx->object_depth > 0);
-   pCtx->object_depth--;
-
-   return true;
-}
-
-static bool CCJSONStartArrayHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-   pCtx->array_depth++;
-   return true;
-}
-
-static bool CCJSONEndArrayHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 2))
-      pCtx->to_firmware = false;
-
-   retro_assert(pCtx->array_depth > 0);
-   pCtx->array_depth--;
-
-   return true;
-}
-
-/* JSON Handlers END */
-
 /* Note: 'dst' must be zero initialised, or memory
- * leaks will occur */
+ * leaks will occur. Details are not copied. */
 static void core_info_copy(core_info_t *src, core_info_t *dst)
 {
    dst->path                      = src->path                 ? strdup(src->path)                 : NULL;
    dst->display_name              = src->display_name         ? strdup(src->display_name)         : NULL;
    dst->display_version           = src->display_version      ? strdup(src->display_version)      : NULL;
    dst->core_name                 = src->core_name            ? strdup(src->core_name)            : NULL;
-   dst->system_manufacturer       = src->system_manufacturer  ? strdup(src->system_manufacturer)  : NULL;
    dst->systemname                = src->systemname           ? strdup(src->systemname)           : NULL;
    dst->system_id                 = src->system_id            ? strdup(src->system_id)            : NULL;
    dst->supported_extensions      = src->supported_extensions ? strdup(src->supported_extensions) : NULL;
-   dst->authors                   = src->authors              ? strdup(src->authors)              : NULL;
-   dst->permissions               = src->permissions          ? strdup(src->permissions)          : NULL;
    dst->licenses                  = src->licenses             ? strdup(src->licenses)             : NULL;
-   dst->categories                = src->categories           ? strdup(src->categories)           : NULL;
    dst->databases                 = src->databases            ? strdup(src->databases)            : NULL;
-   dst->notes                     = src->notes                ? strdup(src->notes)                : NULL;
    dst->required_hw_api           = src->required_hw_api      ? strdup(src->required_hw_api)      : NULL;
-   dst->description               = src->description          ? strdup(src->description)          : NULL;
 
-   dst->categories_list           = src->categories_list           ? string_list_clone(src->categories_list)           : NULL;
    dst->databases_list            = src->databases_list            ? string_list_clone(src->databases_list)            : NULL;
-   dst->note_list                 = src->note_list                 ? string_list_clone(src->note_list)                 : NULL;
    dst->supported_extensions_list = src->supported_extensions_list ? string_list_clone(src->supported_extensions_list) : NULL;
-   dst->authors_list              = src->authors_list              ? string_list_clone(src->authors_list)              : NULL;
-   dst->permissions_list          = src->permissions_list          ? string_list_clone(src->permissions_list)          : NULL;
    dst->licenses_list             = src->licenses_list             ? string_list_clone(src->licenses_list)             : NULL;
    dst->required_hw_api_list      = src->required_hw_api_list      ? string_list_clone(src->required_hw_api_list)      : NULL;
 
-   if (src->firmware_count > 0)
-   {
-      dst->firmware = (core_info_firmware_t*)calloc(src->firmware_count,
-            sizeof(core_info_firmware_t));
-
-      if (dst->firmware)
-      {
-         size_t i;
-
-         dst->firmware_count = src->firmware_count;
-
-         for (i = 0; i < src->firmware_count; i++)
-         {
-            dst->firmware[i].path     = src->firmware[i].path ? strdup(src->firmware[i].path) : NULL;
-            dst->firmware[i].desc     = src->firmware[i].desc ? strdup(src->firmware[i].desc) : NULL;
-            dst->firmware[i].missing  = src->firmware[i].missing;
-            dst->firmware[i].optional = src->firmware[i].optional;
-         }
-      }
-      else
-         dst->firmware_count = 0;
-   }
+   dst->details                   = NULL;
 
    dst->core_file_id.str  = src->core_file_id.str ? strdup(src->core_file_id.str) : NULL;
    dst->core_file_id.hash = src->core_file_id.hash;
@@ -448,9 +153,6 @@ static void core_info_transfer(core_info_t *src, core_info_t *dst)
    dst->core_name                 = src->core_name;
    src->core_name                 = NULL;
 
-   dst->system_manufacturer       = src->system_manufacturer;
-   src->system_manufacturer       = NULL;
-
    dst->systemname                = src->systemname;
    src->systemname                = NULL;
 
@@ -460,58 +162,29 @@ static void core_info_transfer(core_info_t *src, core_info_t *dst)
    dst->supported_extensions      = src->supported_extensions;
    src->supported_extensions      = NULL;
 
-   dst->authors                   = src->authors;
-   src->authors                   = NULL;
-
-   dst->permissions               = src->permissions;
-   src->permissions               = NULL;
-
    dst->licenses                  = src->licenses;
    src->licenses                  = NULL;
 
-   dst->categories                = src->categories;
-   src->categories                = NULL;
-
    dst->databases                 = src->databases;
    src->databases                 = NULL;
 
-   dst->notes                     = src->notes;
-   src->notes                     = NULL;
-
    dst->required_hw_api           = src->required_hw_api;
    src->required_hw_api           = NULL;
 
-   dst->description               = src->description;
-   src->description               = NULL;
-
-   dst->categories_list           = src->categories_list;
-   src->categories_list           = NULL;
-
    dst->databases_list            = src->databases_list;
    src->databases_list            = NULL;
 
-   dst->note_list                 = src->note_list;
-   src->note_list                 = NULL;
-
    dst->supported_extensions_list = src->supported_extensions_list;
    src->supported_extensions_list = NULL;
 
-   dst->authors_list              = src->authors_list;
-   src->authors_list              = NULL;
-
-   dst->permissions_list          = src->permissions_list;
-   src->permissions_list          = NULL;
-
    dst->licenses_list             = src->licenses_list;
    src->licenses_list             = NULL;
 
    dst->required_hw_api_list      = src->required_hw_api_list;
    src->required_hw_api_list      = NULL;
 
-   dst->firmware                  = src->firmware;
-   dst->firmware_count            = src->firmware_count;
-   src->firmware                  = NULL;
-   src->firmware_count            = 0;
+   dst->details                   = src->details;
+   src->details                   = NULL;
 
    dst->core_file_id.str          = src->core_file_id.str;
    src->core_file_id.str          = NULL;
@@ -632,459 +305,231 @@ static void core_info_cache_add(core_info_cache_list_t *list, core_info_t *info,
    list->length++;
 }
 
+static void core_info_cache_get_path(const char *info_dir,
+      const char *name, char *s, size_t len)
+{
+   if (string_is_empty(info_dir))
+      strlcpy(s, name, len);
+   else
+      fill_pathname_join(s, info_dir, name, len);
+}
+
+static char *core_info_cache_get_string(const char *strings,
+      size_t strings_size, uint32_t offset)
+{
+   if (!offset || offset >= strings_size)
+      return NULL;
+   return strdup(strings + offset);
+}
+
 static core_info_cache_list_t *core_info_cache_read(const char *info_dir)
 {
-   intfstream_t *file                           = NULL;
-   rjson_t *parser                              = NULL;
-   CCJSONContext context                        = {0};
-   core_info_cache_list_t *core_info_cache_list = NULL;
+   size_t i;
    char file_path[PATH_MAX_LENGTH];
+   const core_info_cache_header_t *header       = NULL;
+   const core_info_cache_record_t *records      = NULL;
+   const char *strings                          = NULL;
+   core_info_cache_list_t *core_info_cache_list = NULL;
+   void *buf                                    = NULL;
+   int64_t len                                  = 0;
 
    /* Check whether a 'force refresh' file
     * is present */
-   file_path[0] = '\0';
-
-   if (string_is_empty(info_dir))
-      strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE_REFRESH, sizeof(file_path));
-   else
-      fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE_REFRESH,
-            sizeof(file_path));
+   core_info_cache_get_path(info_dir, FILE_PATH_CORE_INFO_CACHE_REFRESH,
+         file_path, sizeof(file_path));
 
    if (path_is_valid(file_path))
       return core_info_cache_list_new();
 
-   /* Open info cache file */
-   file_path[0] = '\0';
+   /* Read info cache file */
+   core_info_cache_get_path(info_dir, FILE_PATH_CORE_INFO_CACHE,
+         file_path, sizeof(file_path));
 
-   if (string_is_empty(info_dir))
-      strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE, sizeof(file_path));
-   else
-      fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE,
-            sizeof(file_path));
+   if (     !path_is_valid(file_path)
+         || !filestream_read_file(file_path, &buf, &len))
+      return core_info_cache_list_new();
 
-#if defined(HAVE_ZLIB)
-   file = intfstream_open_rzip_file(file_path,
-         RETRO_VFS_FILE_ACCESS_READ);
-#else
-   file = intfstream_open_file(file_path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-#endif
+   header = (const core_info_cache_header_t*)buf;
 
-   if (!file)
+   /* Caches of an older format are simply rebuilt */
+   if (     (size_t)len < sizeof(*header)
+         || header->magic        != CORE_INFO_CACHE_MAGIC
+         || header->version      != CORE_INFO_CACHE_VERSION
+         || header->strings_size == 0
+         || (uint64_t)len != sizeof(*header)
+            + (uint64_t)header->count * sizeof(*records)
+            + header->strings_size)
+   {
+      free(buf);
       return core_info_cache_list_new();
+   }
+
+   records = (const core_info_cache_record_t*)(header + 1);
+   strings = (const char*)(records + header->count);
 
-   /* Parse info cache file */
-   parser = rjson_open_stream(file);
-   if (!parser)
+   /* Every string must be terminated within the table */
+   if (     strings[0] != '\0'
+         || strings[header->strings_size - 1] != '\0'
+         || !(core_info_cache_list = core_info_cache_list_new()))
    {
-      RARCH_ERR("[Core Info] Failed to create JSON parser\n");
-      goto end;
+      free(buf);
+      return core_info_cache_list_new();
    }
 
-   rjson_set_options(parser,
-           RJSON_OPTION_ALLOW_UTF8BOM
-         | RJSON_OPTION_ALLOW_COMMENTS
-         | RJSON_OPTION_ALLOW_UNESCAPED_CONTROL_CHARACTERS
-         | RJSON_OPTION_REPLACE_INVALID_ENCODING);
-
-   if (rjson_parse(parser, &context,
-         CCJSONObjectMemberHandler,
-         CCJSONStringHandler,
-         CCJSONNumberHandler,
-         CCJSONStartObjectHandler,
-         CCJSONEndObjectHandler,
-         CCJSONStartArrayHandler,
-         CCJSONEndArrayHandler,
-         CCJSONBoolHandler,
-         NULL) /* Unused null handler */
-         != RJSON_DONE)
+   for (i = 0; i < header->count; i++)
    {
-      RARCH_WARN("[Core Info] Error parsing chunk:\n---snip---\n%.*s\n---snip---\n",
-            rjson_get_source_context_len(parser),
-            rjson_get_source_context_buf(parser));
-      RARCH_WARN("[Core Info] Error: Invalid JSON at line %d, column %d - %s.\n",
-            (int)rjson_get_source_line(parser),
-            (int)rjson_get_source_column(parser),
-            (*rjson_get_error(parser) ? rjson_get_error(parser) : "format error"));
-
-      /* Info cache is corrupt - discard it */
-      core_info_cache_list_free(context.core_info_cache_list);
-      core_info_cache_list = core_info_cache_list_new();
-   }
-   else
-      core_info_cache_list = context.core_info_cache_list;
+      core_info_t info;
+      const core_info_cache_record_t *record = &records[i];
+      size_t strings_size                    = header->strings_size;
 
-   rjson_free(parser);
+      memset(&info, 0, sizeof(info));
 
-   /* Clean up leftovers in the event of
-    * a parsing error */
-   if (context.core_info)
-   {
-      core_info_free(context.core_info);
-      free(context.core_info);
-   }
+      info.path                 = core_info_cache_get_string(strings, strings_size, record->path);
+      info.display_name         = core_info_cache_get_string(strings, strings_size, record->display_name);
+      info.display_version      = core_info_cache_get_string(strings, strings_size, record->display_version);
+      info.core_name            = core_info_cache_get_string(strings, strings_size, record->core_name);
+      info.systemname           = core_info_cache_get_string(strings, strings_size, record->systemname);
+      info.system_id            = core_info_cache_get_string(strings, strings_size, record->system_id);
+      info.supported_extensions = core_info_cache_get_string(strings, strings_size, record->supported_extensions);
+      info.licenses             = core_info_cache_get_string(strings, strings_size, record->licenses);
+      info.databases            = core_info_cache_get_string(strings, strings_size, record->databases);
+      info.required_hw_api      = core_info_cache_get_string(strings, strings_size, record->required_hw_api);
+      info.core_file_id.str     = core_info_cache_get_string(strings, strings_size, record->core_file_id);
 
-end:
-   intfstream_close(file);
-   free(file);
+      if (info.supported_extensions)
+         info.supported_extensions_list = string_split(info.supported_extensions, "|");
+      if (info.licenses)
+         info.licenses_list             = string_split(info.licenses, "|");
+      if (info.databases)
+         info.databases_list            = string_split(info.databases, "|");
+      if (info.required_hw_api)
+         info.required_hw_api_list      = string_split(info.required_hw_api, "|");
 
+      if (info.core_file_id.str)
+         info.core_file_id.hash = core_info_hash_string(info.core_file_id.str);
+
+      info.has_info                      = !!(record->flags & CORE_INFO_CACHE_FLAG_HAS_INFO);
+      info.supports_no_game              = !!(record->flags & CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME);
+      info.database_match_archive_member = !!(record->flags & CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER);
+      info.is_experimental               = !!(record->flags & CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL);
+
+      /* Entries without a file id are ignored */
+      core_info_cache_add(core_info_cache_list, &info, true);
+      core_info_free(&info);
+   }
+
+   free(buf);
    return core_info_cache_list;
 }
 
-static void core_info_cache_write(core_info_cache_list_t *list, const char *info_dir)
+static uint32_t core_info_cache_add_string(char *strings,
+      size_t *strings_size, const char *str)
 {
-   intfstream_t *file    = NULL;
-   rjsonwriter_t *writer = NULL;
-   char file_path[PATH_MAX_LENGTH];
-   size_t i, j;
+   size_t offset = *strings_size;
+   size_t len;
 
-   file_path[0] = '\0';
+   if (string_is_empty(str))
+      return 0;
 
-   if (!list)
-      return;
+   len = strlen(str) + 1;
+   if (strings)
+      memcpy(strings + offset, str, len);
+   *strings_size += len;
+   return (uint32_t)offset;
+}
 
-   /* Open info cache file */
-   if (string_is_empty(info_dir))
-      strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE, sizeof(file_path));
-   else
-      fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE,
-            sizeof(file_path));
+/* Measures the strings of a record if 'strings' is NULL */
+static void core_info_cache_fill_record(core_info_cache_record_t *record,
+      const core_info_t *info, char *strings, size_t *strings_size)
+{
+   record->path                 = core_info_cache_add_string(strings, strings_size, info->path);
+   record->display_name         = core_info_cache_add_string(strings, strings_size, info->display_name);
+   record->display_version      = core_info_cache_add_string(strings, strings_size, info->display_version);
+   record->core_name            = core_info_cache_add_string(strings, strings_size, info->core_name);
+   record->systemname           = core_info_cache_add_string(strings, strings_size, info->systemname);
+   record->system_id            = core_info_cache_add_string(strings, strings_size, info->system_id);
+   record->supported_extensions = core_info_cache_add_string(strings, strings_size, info->supported_extensions);
+   record->licenses             = core_info_cache_add_string(strings, strings_size, info->licenses);
+   record->databases            = core_info_cache_add_string(strings, strings_size, info->databases);
+   record->required_hw_api      = core_info_cache_add_string(strings, strings_size, info->required_hw_api);
+   record->core_file_id         = core_info_cache_add_string(strings, strings_size, info->core_file_id.str);
+
+   record->flags                = 0;
+   if (info->has_info)
+      record->flags            |= CORE_INFO_CACHE_FLAG_HAS_INFO;
+   if (info->supports_no_game)
+      record->flags            |= CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME;
+   if (info->database_match_archive_member)
+      record->flags            |= CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER;
+   if (info->is_experimental)
+      record->flags            |= CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL;
+}
 
-#if defined(CORE_INFO_CACHE_COMPRESS)
-   file = intfstream_open_rzip_file(file_path,
-         RETRO_VFS_FILE_ACCESS_WRITE);
-#else
-   file = intfstream_open_file(file_path,
-         RETRO_VFS_FILE_ACCESS_WRITE,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-#endif
+static void core_info_cache_write(core_info_cache_list_t *list, const char *info_dir)
+{
+   size_t i;
+   char file_path[PATH_MAX_LENGTH];
+   core_info_cache_record_t record;
+   core_info_cache_header_t *header  = NULL;
+   core_info_cache_record_t *records = NULL;
+   char *strings                     = NULL;
+   uint8_t *buf                      = NULL;
+   size_t count                      = 0;
+   size_t strings_size               = 1;
 
-   if (!file)
-   {
-      RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
+   if (!list)
       return;
-   }
-
-   /* Write info cache */
-   writer = rjsonwriter_open_stream(file);
-   if (!writer)
-   {
-      RARCH_ERR("[Core Info] Failed to create JSON writer\n");
-      goto end;
-   }
-
-#if defined(CORE_INFO_CACHE_COMPRESS)
-   /* When compressing info cache, human readability
-    * is not a factor - can skip all indentation
-    * and new line characters */
-   rjsonwriter_set_options(writer, RJSONWRITER_OPTION_SKIP_WHITESPACE);
-#endif
-
-   rjsonwriter_add_start_object(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_string(writer, "version");
-   rjsonwriter_add_colon(writer);
-   rjsonwriter_add_space(writer);
-   rjsonwriter_add_string(writer, "1.0");
-   rjsonwriter_add_comma(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_string(writer, "items");
-   rjsonwriter_add_colon(writer);
-   rjsonwriter_add_space(writer);
-   rjsonwriter_add_start_array(writer);
-   rjsonwriter_add_newline(writer);
 
+   /* Uninstalled cores are dropped */
    for (i = 0; i < list->length; i++)
    {
-      core_info_t* info = &list->items[i];
-
-      if (!info || !info->is_installed)
+      if (!list->items[i].is_installed)
          continue;
+      core_info_cache_fill_record(&record, &list->items[i],
+            NULL, &strings_size);
+      count++;
+   }
 
-      if (i > 0)
-      {
-         rjsonwriter_add_comma(writer);
-         rjsonwriter_add_newline(writer);
-      }
-
-      rjsonwriter_add_spaces(writer, 4);
-      rjsonwriter_add_start_object(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "path");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->path);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "display_name");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->display_name);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "display_version");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->display_version);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "core_name");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->core_name);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "system_manufacturer");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->system_manufacturer);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "systemname");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->systemname);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "system_id");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->system_id);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "supported_extensions");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->supported_extensions);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "authors");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->authors);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "permissions");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->permissions);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "licenses");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->licenses);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "categories");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->categories);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "databases");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->databases);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "notes");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->notes);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "required_hw_api");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->required_hw_api);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "description");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->description);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      if (info->firmware_count > 0)
-      {
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "firmware");
-         rjsonwriter_add_colon(writer);
-         rjsonwriter_add_space(writer);
-         rjsonwriter_add_start_array(writer);
-         rjsonwriter_add_newline(writer);
-
-         for (j = 0; j < info->firmware_count; j++)
-         {
-            rjsonwriter_add_spaces(writer, 8);
-            rjsonwriter_add_start_object(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "path");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_string(writer, info->firmware[j].path);
-            rjsonwriter_add_comma(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "desc");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_string(writer, info->firmware[j].desc);
-            rjsonwriter_add_comma(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "optional");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_bool(writer, info->firmware[j].optional);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 8);
-            rjsonwriter_add_end_object(writer);
-
-            if (j < info->firmware_count - 1)
-               rjsonwriter_add_comma(writer);
-
-            rjsonwriter_add_newline(writer);
-         }
-
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_end_array(writer);
-         rjsonwriter_add_comma(writer);
-         rjsonwriter_add_newline(writer);
-      }
+   if (!(buf = (uint8_t*)malloc(sizeof(*header)
+         + count * sizeof(*records) + strings_size)))
+      return;
 
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "core_file_id");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_start_object(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 8);
-      rjsonwriter_add_string(writer, "str");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->core_file_id.str);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 8);
-      rjsonwriter_add_string(writer, "hash");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_unsigned(writer, info->core_file_id.hash);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_end_object(writer);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "firmware_count");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_unsigned(writer, info->firmware_count);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "has_info");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->has_info);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "supports_no_game");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->supports_no_game);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "database_match_archive_member");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->database_match_archive_member);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "is_experimental");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->is_experimental);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 4);
-      rjsonwriter_add_end_object(writer);
-   }
+   header       = (core_info_cache_header_t*)buf;
+   records      = (core_info_cache_record_t*)(header + 1);
+   strings      = (char*)(records + count);
+   strings[0]   = '\0';
+   strings_size = 1;
+   count        = 0;
 
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_end_array(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_end_object(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_free(writer);
+   for (i = 0; i < list->length; i++)
+      if (list->items[i].is_installed)
+         core_info_cache_fill_record(&records[count++], &list->items[i],
+               strings, &strings_size);
 
-   RARCH_LOG("[Core Info] Wrote to cache file: %s\n", file_path);
+   header->magic        = CORE_INFO_CACHE_MAGIC;
+   header->version      = CORE_INFO_CACHE_VERSION;
+   header->count        = (uint32_t)count;
+   header->strings_size = (uint32_t)strings_size;
 
-   /* Remove 'force refresh' file, if required */
-   file_path[0] = '\0';
+   core_info_cache_get_path(info_dir, FILE_PATH_CORE_INFO_CACHE,
+         file_path, sizeof(file_path));
 
-   if (string_is_empty(info_dir))
-      strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE_REFRESH, sizeof(file_path));
+   if (!filestream_write_file(file_path, buf,
+         sizeof(*header) + count * sizeof(*records) + strings_size))
+      RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
    else
-      fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE_REFRESH,
-            sizeof(file_path));
+   {
+      RARCH_LOG("[Core Info] Wrote to cache file: %s\n", file_path);
 
-   if (path_is_valid(file_path))
-      filestream_delete(file_path);
+      /* Remove 'force refresh' file, if required */
+      core_info_cache_get_path(info_dir, FILE_PATH_CORE_INFO_CACHE_REFRESH,
+            file_path, sizeof(file_path));
 
-end:
-   intfstream_close(file);
-   free(file);
+      if (path_is_valid(file_path))
+         filestream_delete(file_path);
+   }
 
+   free(buf);
    list->refresh = false;
 }
 
@@ -1430,7 +875,7 @@ static core_info_t *core_info_find_internal(
 }
 
 static void core_info_resolve_firmware(
-      core_info_t *info, config_file_t *conf)
+      core_info_details_t *details, config_file_t *conf)
 {
    unsigned i;
    unsigned firmware_count        = 0;
@@ -1464,24 +909,22 @@ static void core_info_resolve_firmware(
 
       if (entry && !string_is_empty(entry->value))
       {
-         firmware[i].path = entry->value;
-         entry->value     = NULL;
+         firmware[i].path = strdup(entry->value);
       }
 
       entry = config_get_entry(conf, desc_key);
 
       if (entry && !string_is_empty(entry->value))
       {
-         firmware[i].desc = entry->value;
-         entry->value     = NULL;
+         firmware[i].desc = strdup(entry->value);
       }
 
       if (config_get_bool(conf, opt_key , &tmp_bool))
          firmware[i].optional = tmp_bool;
    }
 
-   info->firmware_count = firmware_count;
-   info->firmware       = firmware;
+   details->firmware_count = firmware_count;
+   details->firmware       = firmware;
 }
 
 static config_file_t *core_info_get_config_file(
@@ -1514,162 +957,153 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->display_name = entry->value;
-      entry->value       = NULL;
+      info->display_name = strdup(entry->value);
    }
 
    entry = config_get_entry(conf, "display_version");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->display_version = entry->value;
-      entry->value          = NULL;
+      info->display_version = strdup(entry->value);
    }
 
    entry = config_get_entry(conf, "corename");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->core_name = entry->value;
-      entry->value    = NULL;
+      info->core_name = strdup(entry->value);
    }
 
    entry = config_get_entry(conf, "systemname");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->systemname = entry->value;
-      entry->value     = NULL;
+      info->systemname = strdup(entry->value);
    }
 
    entry = config_get_entry(conf, "systemid");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->system_id = entry->value;
-      entry->value    = NULL;
+      info->system_id = strdup(entry->value);
    }
 
-   entry = config_get_entry(conf, "manufacturer");
+   entry = config_get_entry(conf, "supported_extensions");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->system_manufacturer = entry->value;
-      entry->value              = NULL;
+      info->supported_extensions      = strdup(entry->value);
+
+      info->supported_extensions_list =
+            string_split(info->supported_extensions, "|");
    }
 
-   entry = config_get_entry(conf, "supported_extensions");
+   entry = config_get_entry(conf, "license");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->supported_extensions      = entry->value;
-      entry->value                    = NULL;
+      info->licenses      = strdup(entry->value);
 
-      info->supported_extensions_list =
-            string_split(info->supported_extensions, "|");
+      info->licenses_list =
+            string_split(info->licenses, "|");
    }
 
-   entry = config_get_entry(conf, "authors");
+   entry = config_get_entry(conf, "database");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->authors      = entry->value;
-      entry->value       = NULL;
+      info->databases      = strdup(entry->value);
 
-      info->authors_list =
-            string_split(info->authors, "|");
+      info->databases_list =
+            string_split(info->databases, "|");
    }
 
-   entry = config_get_entry(conf, "permissions");
+   entry = config_get_entry(conf, "required_hw_api");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->permissions      = entry->value;
-      entry->value           = NULL;
+      info->required_hw_api      = strdup(entry->value);
 
-      info->permissions_list =
-            string_split(info->permissions, "|");
+      info->required_hw_api_list =
+            string_split(info->required_hw_api, "|");
    }
 
-   entry = config_get_entry(conf, "license");
+   if (config_get_bool(conf, "supports_no_game",
+            &tmp_bool))
+      info->supports_no_game = tmp_bool;
+
+   if (config_get_bool(conf, "database_match_archive_member",
+            &tmp_bool))
+      info->database_match_archive_member = tmp_bool;
+
+   if (config_get_bool(conf, "is_experimental",
+            &tmp_bool))
+      info->is_experimental = tmp_bool;
+
+   info->has_info = true;
+   list->info_count++;
+}
+
+static void core_info_parse_details(core_info_details_t *details,
+      config_file_t *conf)
+{
+   struct config_entry_list *entry = NULL;
+
+   entry = config_get_entry(conf, "manufacturer");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->licenses      = entry->value;
-      entry->value        = NULL;
-
-      info->licenses_list =
-            string_split(info->licenses, "|");
+      details->system_manufacturer = strdup(entry->value);
    }
 
-   entry = config_get_entry(conf, "categories");
+   entry = config_get_entry(conf, "authors");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->categories      = entry->value;
-      entry->value          = NULL;
+      details->authors      = strdup(entry->value);
 
-      info->categories_list =
-            string_split(info->categories, "|");
+      details->authors_list =
+            string_split(details->authors, "|");
    }
 
-   entry = config_get_entry(conf, "database");
+   entry = config_get_entry(conf, "permissions");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->databases      = entry->value;
-      entry->value         = NULL;
+      details->permissions      = strdup(entry->value);
 
-      info->databases_list =
-            string_split(info->databases, "|");
+      details->permissions_list =
+            string_split(details->permissions, "|");
    }
 
-   entry = config_get_entry(conf, "notes");
+   entry = config_get_entry(conf, "categories");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->notes     = entry->value;
-      entry->value    = NULL;
+      details->categories      = strdup(entry->value);
 
-      info->note_list =
-            string_split(info->notes, "|");
+      details->categories_list =
+            string_split(details->categories, "|");
    }
 
-   entry = config_get_entry(conf, "required_hw_api");
+   entry = config_get_entry(conf, "notes");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->required_hw_api      = entry->value;
-      entry->value               = NULL;
+      details->notes     = strdup(entry->value);
 
-      info->required_hw_api_list =
-            string_split(info->required_hw_api, "|");
+      details->note_list =
+            string_split(details->notes, "|");
    }
 
    entry = config_get_entry(conf, "description");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->description = entry->value;
-      entry->value      = NULL;
+      details->description = strdup(entry->value);
    }
 
-   if (config_get_bool(conf, "supports_no_game",
-            &tmp_bool))
-      info->supports_no_game = tmp_bool;
-
-   if (config_get_bool(conf, "database_match_archive_member",
-            &tmp_bool))
-      info->database_match_archive_member = tmp_bool;
-
-   if (config_get_bool(conf, "is_experimental",
-            &tmp_bool))
-      info->is_experimental = tmp_bool;
-
-   core_info_resolve_firmware(info, conf);
-
-   info->has_info = true;
-   list->info_count++;
+   core_info_resolve_firmware(details, conf);
 }
 
 static void core_info_list_resolve_all_extensions(
@@ -1712,41 +1146,135 @@ static void core_info_list_resolve_all_extensions(
 #endif
 }
 
-static void core_info_free(core_info_t* info)
+/* Key of an extension in the extension index:
+ * lower case, without leading dot */
+static bool core_info_exts_index_key(const char *ext,
+      char *s, size_t len)
+{
+   if (string_is_empty(ext))
+      return false;
+
+   if (*ext == '.')
+      ext++;
+
+   if (!*ext || strlcpy(s, ext, len) >= len)
+      return false;
+
+   string_to_lower(s);
+   return true;
+}
+
+static void core_info_list_free_exts_index(
+      core_info_list_t *core_info_list)
+{
+   size_t i, cap;
+
+   for (i = 0, cap = RHMAP_CAP(core_info_list->exts_index); i != cap; i++)
+      if (RHMAP_KEY(core_info_list->exts_index, i))
+         RBUF_FREE(core_info_list->exts_index[i]);
+
+   RHMAP_FREE(core_info_list->exts_index);
+}
+
+/* Maps every supported extension to the indices
+ * of the cores that support it. Must be rebuilt
+ * whenever the list is reordered */
+static void core_info_list_build_exts_index(
+      core_info_list_t *core_info_list)
+{
+   size_t i, j;
+
+   core_info_list_free_exts_index(core_info_list);
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const struct string_list *exts =
+            core_info_list->list[i].supported_extensions_list;
+
+      if (!exts)
+         continue;
+
+      for (j = 0; j < exts->size; j++)
+      {
+         char key[64];
+         size_t *cores;
+
+         if (!core_info_exts_index_key(exts->elems[j].data,
+                  key, sizeof(key)))
+            continue;
+
+         cores = RHMAP_GET_STR(core_info_list->exts_index, key);
+
+         /* Extensions may be listed twice */
+         if (RBUF_LEN(cores) && cores[RBUF_LEN(cores) - 1] == i)
+            continue;
+
+         RBUF_PUSH(cores, i);
+         RHMAP_SET_STR(core_info_list->exts_index, key, cores);
+      }
+   }
+}
+
+/* Returns the indices of the cores supporting the
+ * extension of 'path' as an RBUF owned by the
+ * index, NULL if there are none */
+static const size_t *core_info_list_lookup_exts_index(
+      const core_info_list_t *core_info_list, const char *path)
+{
+   char key[64];
+
+   if (     !core_info_list->exts_index
+         || string_is_empty(path)
+         || !core_info_exts_index_key(path_get_extension(path),
+               key, sizeof(key)))
+      return NULL;
+
+   return RHMAP_GET_STR(core_info_list->exts_index, key);
+}
+
+static void core_info_details_free(core_info_details_t *details)
 {
    size_t i;
 
+   free(details->system_manufacturer);
+   free(details->authors);
+   free(details->permissions);
+   free(details->categories);
+   free(details->notes);
+   free(details->description);
+   string_list_free(details->authors_list);
+   string_list_free(details->note_list);
+   string_list_free(details->permissions_list);
+   string_list_free(details->categories_list);
+
+   for (i = 0; i < details->firmware_count; i++)
+   {
+      free(details->firmware[i].path);
+      free(details->firmware[i].desc);
+   }
+   free(details->firmware);
+   free(details);
+}
+
+static void core_info_free(core_info_t* info)
+{
    free(info->path);
    free(info->core_name);
    free(info->systemname);
    free(info->system_id);
-   free(info->system_manufacturer);
    free(info->display_name);
    free(info->display_version);
    free(info->supported_extensions);
-   free(info->authors);
-   free(info->permissions);
    free(info->licenses);
-   free(info->categories);
    free(info->databases);
-   free(info->notes);
    free(info->required_hw_api);
-   free(info->description);
    string_list_free(info->supported_extensions_list);
-   string_list_free(info->authors_list);
-   string_list_free(info->note_list);
-   string_list_free(info->permissions_list);
    string_list_free(info->licenses_list);
-   string_list_free(info->categories_list);
    string_list_free(info->databases_list);
    string_list_free(info->required_hw_api_list);
 
-   for (i = 0; i < info->firmware_count; i++)
-   {
-      free(info->firmware[i].path);
-      free(info->firmware[i].desc);
-   }
-   free(info->firmware);
+   if (info->details)
+      core_info_details_free(info->details);
 
    free(info->core_file_id.str);
 }
@@ -1764,7 +1292,11 @@ static void core_info_list_free(core_info_list_t *core_info_list)
       core_info_free(info);
    }
 
+   core_info_list_free_exts_index(core_info_list);
+   RBUF_FREE(core_info_list->supported);
+
    free(core_info_list->all_ext);
+   free(core_info_list->info_dir);
    free(core_info_list->list);
    free(core_info_list);
 }
@@ -1795,6 +1327,9 @@ static core_info_list_t *core_info_list_new(const char *path,
    core_info_list->count      = 0;
    core_info_list->info_count = 0;
    core_info_list->all_ext    = NULL;
+   core_info_list->info_dir   = info_dir ? strdup(info_dir) : NULL;
+   core_info_list->exts_index = NULL;
+   core_info_list->supported  = NULL;
 
    core_info = (core_info_t*)calloc(path_list->core_list->size,
          sizeof(*core_info));
@@ -1887,6 +1422,7 @@ static core_info_list_t *core_info_list_new(const char *path,
    }
 
    core_info_list_resolve_all_extensions(core_info_list);
+   core_info_list_build_exts_index(core_info_list);
 
    /* If info cache is enabled
     * > Check whether any cached cores have been
@@ -1936,57 +1472,6 @@ bool core_info_list_get_info(core_info_list_t *core_info_list,
    return false;
 }
 
-#ifdef HAVE_COMPRESSION
-static bool core_info_does_support_any_file(const core_info_t *core,
-      const struct string_list *list)
-{
-   size_t i;
-   if (!list || !core || !core->supported_extensions_list)
-      return false;
-
-   for (i = 0; i < list->size; i++)
-      if (string_list_find_elem_prefix(core->supported_extensions_list,
-               ".", path_get_extension(list->elems[i].data)))
-         return true;
-   return false;
-}
-#endif
-
-static bool core_info_does_support_file(
-      const core_info_t *core, const char *path)
-{
-   if (!core || !core->supported_extensions_list)
-      return false;
-   if (string_is_empty(path))
-      return false;
-
-   return string_list_find_elem_prefix(
-         core->supported_extensions_list, ".", path_get_extension(path));
-}
-
-/* qsort_r() is not in standard C, sadly. */
-
-static int core_info_qsort_cmp(const void *a_, const void *b_)
-{
-   core_info_state_t *p_coreinfo = coreinfo_get_ptr();
-   const core_info_t          *a = (const core_info_t*)a_;
-   const core_info_t          *b = (const core_info_t*)b_;
-   int support_a                 = core_info_does_support_file(a,
-         p_coreinfo->tmp_path);
-   int support_b                 = core_info_does_support_file(b,
-         p_coreinfo->tmp_path);
-#ifdef HAVE_COMPRESSION
-   support_a            = support_a ||
-      core_info_does_support_any_file(a, p_coreinfo->tmp_list);
-   support_b            = support_b ||
-      core_info_does_support_any_file(b, p_coreinfo->tmp_list);
-#endif
-
-   if (support_a != support_b)
-      return support_b - support_a;
-   return strcasecmp(a->display_name, b->display_name);
-}
-
 static bool core_info_list_update_missing_firmware_internal(
       core_info_list_t *core_info_list,
       const char *core_path,
@@ -1995,27 +1480,28 @@ static bool core_info_list_update_missing_firmware_internal(
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
-   core_info_t      *info = NULL;
+   core_info_t         *info    = NULL;
+   core_info_details_t *details = NULL;
 
    if (!core_info_list)
       return false;
 
    info                   = core_info_find_internal(core_info_list, core_path);
 
-   if (!info)
+   if (!info || !(details = core_info_get_details(info)))
       return false;
 
    path[0]                = '\0';
 
-   for (i = 0; i < info->firmware_count; i++)
+   for (i = 0; i < details->firmware_count; i++)
    {
-      if (string_is_empty(info->firmware[i].path))
+      if (string_is_empty(details->firmware[i].path))
          continue;
 
       fill_pathname_join(path, systemdir,
-            info->firmware[i].path, sizeof(path));
-      info->firmware[i].missing = !path_is_valid(path);
-      if (info->firmware[i].missing && !info->firmware[i].optional)
+            details->firmware[i].path, sizeof(path));
+      details->firmware[i].missing = !path_is_valid(path);
+      if (details->firmware[i].missing && !details->firmware[i].optional)
          *set_missing_bios = true;
    }
 
@@ -2041,32 +1527,21 @@ bool core_info_init_current_core(void)
    current->database_match_archive_member = false;
    current->is_experimental               = false;
    current->is_locked                     = false;
-   current->firmware_count                = 0;
    current->path                          = NULL;
    current->display_name                  = NULL;
    current->display_version               = NULL;
    current->core_name                     = NULL;
-   current->system_manufacturer           = NULL;
    current->systemname                    = NULL;
    current->system_id                     = NULL;
    current->supported_extensions          = NULL;
-   current->authors                       = NULL;
-   current->permissions                   = NULL;
    current->licenses                      = NULL;
-   current->categories                    = NULL;
    current->databases                     = NULL;
-   current->notes                         = NULL;
    current->required_hw_api               = NULL;
-   current->description                   = NULL;
-   current->categories_list               = NULL;
    current->databases_list                = NULL;
-   current->note_list                     = NULL;
    current->supported_extensions_list     = NULL;
-   current->authors_list                  = NULL;
-   current->permissions_list              = NULL;
    current->licenses_list                 = NULL;
    current->required_hw_api_list          = NULL;
-   current->firmware                      = NULL;
+   current->details                       = NULL;
    current->core_file_id.str              = NULL;
    current->core_file_id.hash             = 0;
 
@@ -2172,67 +1647,68 @@ bool core_info_find(const char *core_path,
    return true;
 }
 
-core_info_t *core_info_get(core_info_list_t *list, size_t i)
-{
-   core_info_t *info = NULL;
-
-   if (!list || (i >= list->count))
-      return NULL;
-   info = (core_info_t*)&list->list[i];
-   if (!info || !info->path)
-      return NULL;
-
-   return info;
-}
-
-void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
-      const char *path, const core_info_t **infos, size_t *num_infos)
+core_info_details_t *core_info_get_details(core_info_t *info)
 {
    size_t i;
-   size_t supported              = 0;
-#ifdef HAVE_COMPRESSION
-   struct string_list *list      = NULL;
-#endif
+   config_file_t *conf           = NULL;
+   core_info_t *entry            = NULL;
    core_info_state_t *p_coreinfo = coreinfo_get_ptr();
+   core_info_list_t *list        = p_coreinfo->curr_list;
 
-   if (!core_info_list)
-      return;
+   if (!info)
+      return NULL;
+   if (info->details)
+      return info->details;
+   if (!list || string_is_empty(info->core_file_id.str))
+      return NULL;
 
-   p_coreinfo->tmp_path          = path;
+   /* Copies such as the current core share
+    * the details of their list entry */
+   for (i = 0; i < list->count; i++)
+   {
+      core_info_t *item = &list->list[i];
 
-#ifdef HAVE_COMPRESSION
-   if (path_is_compressed_file(path))
-      list = file_archive_get_file_list(path, NULL);
-   p_coreinfo->tmp_list = list;
-#endif
+      if (     (item->core_file_id.hash == info->core_file_id.hash)
+            && string_is_equal(item->core_file_id.str,
+               info->core_file_id.str))
+      {
+         entry = item;
+         break;
+      }
+   }
 
-   /* Let supported core come first in list so we can return
-    * a pointer to them. */
-   qsort(core_info_list->list, core_info_list->count,
-         sizeof(core_info_t), core_info_qsort_cmp);
+   if (!entry)
+      return NULL;
 
-   for (i = 0; i < core_info_list->count; i++, supported++)
+   if (!entry->details)
    {
-      const core_info_t *core = &core_info_list->list[i];
+      if (!(entry->details = (core_info_details_t*)
+               calloc(1, sizeof(*entry->details))))
+         return NULL;
 
-      if (core_info_does_support_file(core, path))
-         continue;
+      if (entry->has_info && (conf = core_info_get_config_file(
+                  entry->core_file_id.str, list->info_dir)))
+      {
+         core_info_parse_details(entry->details, conf);
+         config_file_free(conf);
+      }
+   }
 
-#ifdef HAVE_COMPRESSION
-      if (core_info_does_support_any_file(core, list))
-         continue;
-#endif
+   info->details = entry->details;
+   return info->details;
+}
 
-      break;
-   }
+core_info_t *core_info_get(core_info_list_t *list, size_t i)
+{
+   core_info_t *info = NULL;
 
-#ifdef HAVE_COMPRESSION
-   if (list)
-      string_list_free(list);
-#endif
+   if (!list || (i >= list->count))
+      return NULL;
+   info = (core_info_t*)&list->list[i];
+   if (!info || !info->path)
+      return NULL;
 
-   *infos     = core_info_list->list;
-   *num_infos = supported;
+   return info;
 }
 
 /*
@@ -2320,14 +1796,12 @@ bool core_info_database_supports_content_path(
    if (p_coreinfo->curr_list)
    {
       size_t i;
+      const size_t *cores = core_info_list_lookup_exts_index(
+            p_coreinfo->curr_list, path);
 
-      for (i = 0; i < p_coreinfo->curr_list->count; i++)
+      for (i = 0; i < RBUF_LEN(cores); i++)
       {
-         const core_info_t *info = &p_coreinfo->curr_list->list[i];
-
-         if (!string_list_find_elem(info->supported_extensions_list,
-                  path_get_extension(path)))
-            continue;
+         const core_info_t *info = &p_coreinfo->curr_list->list[cores[i]];
 
          if (!string_list_find_elem(info->databases_list, database))
             continue;
@@ -2402,8 +1876,7 @@ core_updater_info_t *core_info_get_core_updater_info(const char *info_path)
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->display_name     = entry->value;
-      entry->value           = NULL;
+      info->display_name     = strdup(entry->value);
    }
 
    /* > description */
@@ -2411,8 +1884,7 @@ core_updater_info_t *core_info_get_core_updater_info(const char *info_path)
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->description      = entry->value;
-      entry->value           = NULL;
+      info->description      = strdup(entry->value);
    }
 
    /* > licenses */
@@ -2420,8 +1892,7 @@ core_updater_info_t *core_info_get_core_updater_info(const char *info_path)
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->licenses         = entry->value;
-      entry->value           = NULL;
+      info->licenses         = strdup(entry->value);
    }
 
    /* Clean up */
@@ -2538,6 +2009,76 @@ void core_info_qsort(core_info_list_t *core_info_list,
       default:
          return;
    }
+
+   core_info_list_build_exts_index(core_info_list);
+}
+
+void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
+      const char *path, const core_info_t **infos, size_t *num_infos)
+{
+   size_t i;
+   const size_t *cores           = NULL;
+#ifdef HAVE_COMPRESSION
+   struct string_list *list      = NULL;
+#endif
+
+   if (!core_info_list)
+      return;
+
+   RBUF_CLEAR(core_info_list->supported);
+
+   cores = core_info_list_lookup_exts_index(core_info_list, path);
+
+   for (i = 0; i < RBUF_LEN(cores); i++)
+      RBUF_PUSH(core_info_list->supported,
+            core_info_list->list[cores[i]]);
+
+#ifdef HAVE_COMPRESSION
+   /* Cores supporting any file of an archive
+    * support the archive */
+   if (     path_is_compressed_file(path)
+         && (list = file_archive_get_file_list(path, NULL)))
+   {
+      size_t j;
+      bool *listed = (bool*)calloc(core_info_list->count, sizeof(bool));
+
+      if (listed)
+      {
+         for (i = 0; i < RBUF_LEN(cores); i++)
+            listed[cores[i]] = true;
+
+         for (i = 0; i < list->size; i++)
+         {
+            cores = core_info_list_lookup_exts_index(core_info_list,
+                  list->elems[i].data);
+
+            for (j = 0; j < RBUF_LEN(cores); j++)
+            {
+               if (listed[cores[j]])
+                  continue;
+
+               listed[cores[j]] = true;
+               RBUF_PUSH(core_info_list->supported,
+                     core_info_list->list[cores[j]]);
+            }
+         }
+
+         free(listed);
+      }
+
+      string_list_free(list);
+   }
+#endif
+
+   if (RBUF_LEN(core_info_list->supported) > 1)
+      qsort(core_info_list->supported,
+            RBUF_LEN(core_info_list->supported),
+            sizeof(core_info_t),
+            (int (*)(const void *, const void *))
+            core_info_qsort_func_display_name);
+
+   *infos     = core_info_list->supported;
+   *num_infos = RBUF_LEN(core_info_list->supported);
 }
 
 static bool core_info_compare_api_version(int sys_major, int sys_minor, int major, int minor, enum compare_op op)
@@ -55,35 +55,42 @@ typedef struct
    uint32_t hash;
 } core_file_id_t;
 
+/* Parts of a core info file that are only shown
+ * on request, see core_info_get_details() */
+typedef struct
+{
+   char *system_manufacturer;
+   char *authors;
+   char *permissions;
+   char *categories;
+   char *notes;
+   char *description;
+   struct string_list *categories_list;
+   struct string_list *note_list;
+   struct string_list *authors_list;
+   struct string_list *permissions_list;
+   core_info_firmware_t *firmware;
+   size_t firmware_count;
+} core_info_details_t;
+
 typedef struct
 {
    char *path;
    char *display_name;
    char *display_version;
    char *core_name;
-   char *system_manufacturer;
    char *systemname;
    char *system_id;
    char *supported_extensions;
-   char *authors;
-   char *permissions;
    char *licenses;
-   char *categories;
    char *databases;
-   char *notes;
    char *required_hw_api;
-   char *description;
-   struct string_list *categories_list;
    struct string_list *databases_list;
-   struct string_list *note_list;
    struct string_list *supported_extensions_list;
-   struct string_list *authors_list;
-   struct string_list *permissions_list;
    struct string_list *licenses_list;
    struct string_list *required_hw_api_list;
-   core_info_firmware_t *firmware;
+   core_info_details_t *details; /* NULL until first requested */
    core_file_id_t core_file_id; /* ptr alignment */
-   size_t firmware_count;
    bool has_info;
    bool supports_no_game;
    bool database_match_archive_member;
@@ -105,7 +112,10 @@ typedef struct
 typedef struct
 {
    core_info_t *list;
+   core_info_t *supported; /* RBUF, see core_info_list_get_supported_cores() */
+   size_t **exts_index;    /* RHMAP of RBUFs, extension -> indices in 'list' */
    char *all_ext;
+   char *info_dir;
    size_t count;
    size_t info_count;
 } core_info_list_t;
@@ -121,17 +131,15 @@ typedef struct core_info_ctx_firmware
 
 struct core_info_state
 {
-#ifdef HAVE_COMPRESSION
-   const struct string_list *tmp_list;
-#endif
-   const char *tmp_path;
    core_info_t *current;
    core_info_list_t *curr_list;
 };
 
 typedef struct core_info_state core_info_state_t;
 
-/* Non-reentrant, does not allocate. Returns pointer to internal state. */
+/* Non-reentrant. Returns shallow copies of the cores
+ * supporting 'path', sorted by display name, in an array
+ * owned by the list and valid until the next call. */
 void core_info_list_get_supported_cores(core_info_list_t *list,
       const char *path, const core_info_t **infos, size_t *num_infos);
 
@@ -148,6 +156,14 @@ void core_info_free_core_updater_info(core_updater_info_t *info);
 
 core_info_t *core_info_get(core_info_list_t *list, size_t i);
 
+/* Returns the details of a core, reading them from
+ * its info file the first time. NULL if that is not
+ * possible. Copies of a core share the details of
+ * the core info list entry they were made from.
+ * Like all functions that access the list, this is
+ * *not* thread safe */
+core_info_details_t *core_info_get_details(core_info_t *info);
+
 void core_info_free_current_core(core_info_state_t *p_coreinfo);
 
 bool core_info_init_current_core(void);
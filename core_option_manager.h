@@ -18,6 +18,7 @@
 #define CORE_OPTION_MANAGER_H__
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <boolean.h>
 #include <retro_common_api.h>
@@ -36,6 +37,7 @@ struct core_option
    struct string_list *val_labels;
    size_t default_index;
    size_t index;
+   uint32_t key_hash;
    bool visible;
 };
 
@@ -45,6 +47,10 @@ struct core_option_manager
    char conf_path[PATH_MAX_LENGTH];
 
    struct core_option *opts;
+   /* Open addressing table from key hash to
+    * option index (plus one, 0 marks empty slots) */
+   size_t *map;
+   size_t map_mask;
    size_t size;
    bool updated;
 };
@@ -124,6 +130,19 @@ bool core_option_manager_get_visible(core_option_manager_t *opt,
 void core_option_manager_set_val(core_option_manager_t *opt,
       size_t idx, size_t val_idx);
 
+/**
+ * core_option_manager_get_idx:
+ * @opt              : options manager handle
+ * @key              : core option key
+ * @idx              : index of the option, if found
+ *
+ * Finds the option with key @key, in constant time.
+ *
+ * Returns: 'true' if the option exists.
+ **/
+bool core_option_manager_get_idx(core_option_manager_t *opt,
+      const char *key, size_t *idx);
+
 RETRO_END_DECLS
 
 #endif
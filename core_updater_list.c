@@ -25,6 +25,7 @@
 #include <lists/string_list.h>
 #include <net/net_http.h>
 #include <array/rbuf.h>
+#include <encodings/crc32.h>
 #include <retro_miscellaneous.h>
 
 #include "file_path_special.h"
@@ -37,6 +38,9 @@ struct core_updater_list
 {
    core_updater_list_entry_t *entries;
    enum core_updater_list_type type;
+   /* CRC of the network data (and paths) the
+    * entries were parsed from, 0 if none */
+   uint32_t network_data_crc;
 };
 
 /* Cached ('global') core updater list */
@@ -109,8 +113,9 @@ core_updater_list_t *core_updater_list_init(void)
       return NULL;
 
    /* Initialise members */
-   core_list->entries = NULL;
-   core_list->type    = CORE_UPDATER_LIST_TYPE_UNKNOWN;
+   core_list->entries          = NULL;
+   core_list->type             = CORE_UPDATER_LIST_TYPE_UNKNOWN;
+   core_list->network_data_crc = 0;
 
    return core_list;
 }
@@ -132,7 +137,8 @@ void core_updater_list_reset(core_updater_list_t *core_list)
       RBUF_FREE(core_list->entries);
    }
 
-   core_list->type = CORE_UPDATER_LIST_TYPE_UNKNOWN;
+   core_list->type             = CORE_UPDATER_LIST_TYPE_UNKNOWN;
+   core_list->network_data_crc = 0;
 }
 
 /* Frees specified core updater list */
@@ -795,6 +801,7 @@ bool core_updater_list_parse_network_data(
       const char *data, size_t len)
 {
    size_t i;
+   uint32_t crc;
    char *data_buf                       = NULL;
    struct string_list network_core_list = {0};
 
@@ -802,6 +809,25 @@ bool core_updater_list_parse_network_data(
    if (!core_list || string_is_empty(data) || (len < 1))
       goto error;
 
+   /* Parsing reads the info file of every core, so
+    * don't redo it if the listing (typically served
+    * from the HTTP cache) and paths are unchanged */
+   crc = encoding_crc32(0, (const uint8_t*)data, len);
+   if (path_dir_libretro)
+      crc = encoding_crc32(crc, (const uint8_t*)path_dir_libretro,
+            strlen(path_dir_libretro));
+   if (path_libretro_info)
+      crc = encoding_crc32(crc, (const uint8_t*)path_libretro_info,
+            strlen(path_libretro_info));
+   if (network_buildbot_url)
+      crc = encoding_crc32(crc, (const uint8_t*)network_buildbot_url,
+            strlen(network_buildbot_url));
+
+   if (     core_list->type == CORE_UPDATER_LIST_TYPE_BUILDBOT
+         && core_list->network_data_crc == crc
+         && RBUF_LEN(core_list->entries) > 0)
+      return true;
+
    /* We're populating a list 'from scratch' - remove
     * any existing entries */
    core_updater_list_reset(core_list);
@@ -865,7 +891,8 @@ bool core_updater_list_parse_network_data(
    core_updater_list_qsort(core_list);
 
    /* Set list type */
-   core_list->type = CORE_UPDATER_LIST_TYPE_BUILDBOT;
+   core_list->type             = CORE_UPDATER_LIST_TYPE_BUILDBOT;
+   core_list->network_data_crc = crc;
 
    return true;
 
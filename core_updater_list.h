@@ -147,6 +147,8 @@ bool core_updater_list_get_core(
 /* Reads the contents of a buildbot core list
  * network request into the specified
  * core_updater_list_t object.
+ * If the list was already read from identical
+ * data (with identical paths), it is left as is.
  * Returns false in the event of an error. */
 bool core_updater_list_parse_network_data(
       core_updater_list_t *core_list,
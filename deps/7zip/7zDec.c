@@ -20,6 +20,11 @@
 #include "Ppmd7.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
+#endif
+
 #define k_Copy 0
 #define k_Delta 3
 #define k_LZMA2 0x21
@@ -191,6 +196,210 @@ static SRes SzDecodeLzma(const Byte *props, unsigned propsSize, UInt64 inSize, I
 
 #ifndef _7Z_NO_METHOD_LZMA2
 
+#ifdef HAVE_THREADS
+
+/* Multi-threaded LZMA2 decoding.
+   An LZMA2 chunk that resets the dictionary starts a stretch of the
+   stream that never refers back to data decoded before it, and every
+   chunk header carries its packed and unpacked size. So the packed
+   stream is read into memory, split at those chunks, and the segments
+   are decoded in parallel, each straight into its place in outBuffer.
+   Streams written by a multi-threaded LZMA2 encoder are made of such
+   blocks; a stream with a single block decodes on one thread. */
+
+#define LZMA2_MT_MIN_OUT_SIZE ((SizeT)1 << 22)
+#define LZMA2_MT_MAX_THREADS 8
+
+typedef struct
+{
+  const Byte *in;
+  SizeT inSize;
+  Byte *out;
+  SizeT outSize;
+} CLzma2MtSegment;
+
+typedef struct
+{
+  CLzma2MtSegment *segments;
+  unsigned numSegments;
+  unsigned next;
+  Byte prop;
+  ISzAllocPtr alloc;
+  slock_t *lock;
+  SRes res;
+} CLzma2MtDec;
+
+/* Counts the segments of the LZMA2 stream in 'in', and fills
+   'segments' if it is not NULL. */
+static SRes Lzma2Mt_Split(const Byte *in, SizeT inSize, Byte *out, SizeT outSize,
+    CLzma2MtSegment *segments, unsigned *numSegments)
+{
+  SizeT inPos = 0, outPos = 0;
+  unsigned num = 0;
+
+  for (;;)
+  {
+    unsigned control;
+    SizeT headerSize, packSize, unpackSize;
+
+    if (inPos >= inSize)
+      return SZ_ERROR_DATA;
+    control = in[inPos];
+    if (control == 0)
+      break;
+
+    if (control & 0x80)
+    {
+      if (inSize - inPos < 5)
+        return SZ_ERROR_DATA;
+      unpackSize = (((SizeT)control & 0x1F) << 16) + ((SizeT)in[inPos + 1] << 8) + in[inPos + 2] + 1;
+      packSize = ((SizeT)in[inPos + 3] << 8) + in[inPos + 4] + 1;
+      headerSize = (control >= 0xC0) ? 6 : 5;
+    }
+    else if (control <= 2)
+    {
+      if (inSize - inPos < 3)
+        return SZ_ERROR_DATA;
+      unpackSize = packSize = ((SizeT)in[inPos + 1] << 8) + in[inPos + 2] + 1;
+      headerSize = 3;
+    }
+    else
+      return SZ_ERROR_DATA;
+
+    if (inSize - inPos < headerSize + packSize || outSize - outPos < unpackSize)
+      return SZ_ERROR_DATA;
+
+    if (control == 1 || control >= 0xE0)
+    {
+      if (segments)
+      {
+        segments[num].in = in + inPos;
+        segments[num].out = out + outPos;
+      }
+      num++;
+    }
+    else if (num == 0)
+      return SZ_ERROR_DATA;
+
+    inPos += headerSize + packSize;
+    outPos += unpackSize;
+
+    if (segments)
+    {
+      segments[num - 1].inSize = (SizeT)(in + inPos - segments[num - 1].in);
+      segments[num - 1].outSize = (SizeT)(out + outPos - segments[num - 1].out);
+    }
+  }
+
+  if (inPos + 1 != inSize || outPos != outSize)
+    return SZ_ERROR_DATA;
+
+  *numSegments = num;
+  return SZ_OK;
+}
+
+static SRes Lzma2Mt_DecodeSegment(const CLzma2MtSegment *segment, Byte prop, ISzAllocPtr alloc)
+{
+  CLzma2Dec state;
+  SizeT inProcessed = segment->inSize;
+  ELzmaStatus status;
+  SRes res;
+
+  Lzma2Dec_Construct(&state);
+  RINOK(Lzma2Dec_AllocateProbs(&state, prop, alloc));
+  state.decoder.dic = segment->out;
+  state.decoder.dicBufSize = segment->outSize;
+  Lzma2Dec_Init(&state);
+
+  res = Lzma2Dec_DecodeToDic(&state, segment->outSize, segment->in, &inProcessed, LZMA_FINISH_ANY, &status);
+  if (res == SZ_OK && (inProcessed != segment->inSize || state.decoder.dicPos != segment->outSize))
+    res = SZ_ERROR_DATA;
+
+  Lzma2Dec_FreeProbs(&state, alloc);
+  return res;
+}
+
+static void Lzma2Mt_Thread(void *data)
+{
+  CLzma2MtDec *p = (CLzma2MtDec *)data;
+
+  for (;;)
+  {
+    unsigned i;
+    SRes res;
+
+    slock_lock(p->lock);
+    i = p->next++;
+    if (p->res != SZ_OK)
+      i = p->numSegments;
+    slock_unlock(p->lock);
+
+    if (i >= p->numSegments)
+      break;
+
+    res = Lzma2Mt_DecodeSegment(&p->segments[i], p->prop, p->alloc);
+    if (res != SZ_OK)
+    {
+      slock_lock(p->lock);
+      if (p->res == SZ_OK)
+        p->res = res;
+      slock_unlock(p->lock);
+    }
+  }
+}
+
+static SRes Lzma2Mt_Decode(Byte prop, const Byte *in, SizeT inSize,
+    Byte *outBuffer, SizeT outSize, unsigned numThreads, ISzAllocPtr allocMain)
+{
+  CLzma2MtDec p;
+  sthread_t *threads[LZMA2_MT_MAX_THREADS];
+  unsigned numSegments = 0;
+  unsigned i;
+
+  RINOK(Lzma2Mt_Split(in, inSize, outBuffer, outSize, NULL, &numSegments));
+
+  p.segments = (CLzma2MtSegment *)ISzAlloc_Alloc(allocMain, numSegments * sizeof(CLzma2MtSegment));
+  if (!p.segments)
+    return SZ_ERROR_MEM;
+  Lzma2Mt_Split(in, inSize, outBuffer, outSize, p.segments, &numSegments);
+
+  p.numSegments = numSegments;
+  p.next = 0;
+  p.prop = prop;
+  p.alloc = allocMain;
+  p.res = SZ_OK;
+  p.lock = NULL;
+
+  if (numThreads > numSegments)
+    numThreads = numSegments;
+  if (numThreads > LZMA2_MT_MAX_THREADS)
+    numThreads = LZMA2_MT_MAX_THREADS;
+  if (numThreads > 1)
+    p.lock = slock_new();
+
+  if (!p.lock)
+  {
+    for (i = 0; i < numSegments && p.res == SZ_OK; i++)
+      p.res = Lzma2Mt_DecodeSegment(&p.segments[i], prop, allocMain);
+  }
+  else
+  {
+    /* The calling thread is the first of the decoders */
+    for (i = 1; i < numThreads; i++)
+      threads[i] = sthread_create(Lzma2Mt_Thread, &p);
+    Lzma2Mt_Thread(&p);
+    for (i = 1; i < numThreads; i++)
+      if (threads[i])
+        sthread_join(threads[i]);
+    slock_free(p.lock);
+  }
+
+  ISzAlloc_Free(allocMain, p.segments);
+  return p.res;
+}
+
+#endif
+
 static SRes SzDecodeLzma2(const Byte *props, unsigned propsSize, UInt64 inSize, ILookInStream *inStream,
     Byte *outBuffer, SizeT outSize, ISzAllocPtr allocMain)
 {
@@ -200,6 +409,27 @@ static SRes SzDecodeLzma2(const Byte *props, unsigned propsSize, UInt64 inSize,
   Lzma2Dec_Construct(&state);
   if (propsSize != 1)
     return SZ_ERROR_DATA;
+
+  #ifdef HAVE_THREADS
+  {
+    unsigned numThreads = cpu_features_get_core_amount();
+    SizeT packSize = (SizeT)inSize;
+
+    if (numThreads > 1 && outSize >= LZMA2_MT_MIN_OUT_SIZE && packSize == inSize)
+    {
+      Byte *inBuf = (Byte *)ISzAlloc_Alloc(allocMain, packSize);
+      if (inBuf)
+      {
+        res = LookInStream_Read(inStream, inBuf, packSize);
+        if (res == SZ_OK)
+          res = Lzma2Mt_Decode(props[0], inBuf, packSize, outBuffer, outSize, numThreads, allocMain);
+        ISzAlloc_Free(allocMain, inBuf);
+        return res;
+      }
+    }
+  }
+  #endif
+
   RINOK(Lzma2Dec_AllocateProbs(&state, props[0], allocMain));
   state.decoder.dic = outBuffer;
   state.decoder.dicBufSize = outSize;
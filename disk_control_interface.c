@@ -22,6 +22,7 @@
 
 #include <string/stdstring.h>
 #include <file/file_path.h>
+#include <formats/m3u_file.h>
 
 #include "paths.h"
 #include "retroarch.h"
@@ -29,6 +30,7 @@
 #include "msg_hash.h"
 
 #include "disk_control_interface.h"
+#include "tasks/tasks_internal.h"
 
 /*****************/
 /* Configuration */
@@ -408,12 +410,70 @@ bool disk_control_set_index(
          else
             disk_index_file_set(
                   &disk_control->index_record, 0, NULL);
+
+         /* Write the record now rather than on unload,
+          * so a crash or forced quit mid-game still
+          * boots into this disk next time */
+         disk_control_save_image_index(disk_control);
       }
    }
 
+   /* The disk after this one is the likely next swap */
+   if (!error)
+      disk_control_prefetch_next(disk_control);
+
    return !error;
 }
 
+/* Warms the image following the current disk index
+ * in a background task. Paths come from the core where
+ * it exposes them, otherwise from the M3U content file */
+void disk_control_prefetch_next(
+      disk_control_interface_t *disk_control)
+{
+   unsigned next_index = 0;
+   char image_path[PATH_MAX_LENGTH];
+
+   image_path[0] = '\0';
+
+   if (!disk_control)
+      return;
+
+   if (!disk_control->cb.get_num_images ||
+       !disk_control->cb.get_image_index)
+      return;
+
+   next_index = disk_control->cb.get_image_index() + 1;
+
+   if (next_index >= disk_control->cb.get_num_images())
+      return;
+
+   if (disk_control->cb.get_image_path)
+      disk_control->cb.get_image_path(
+            next_index, image_path, sizeof(image_path));
+   else
+   {
+      const char *content_path = path_get(RARCH_PATH_CONTENT);
+
+      if (string_is_equal_noncase(
+               path_get_extension(content_path), "m3u"))
+      {
+         m3u_file_entry_t *entry = NULL;
+         m3u_file_t *m3u_file    = m3u_file_init(content_path);
+
+         if (m3u_file &&
+             m3u_file_get_entry(m3u_file, next_index, &entry) &&
+             !string_is_empty(entry->full_path))
+            strlcpy(image_path, entry->full_path, sizeof(image_path));
+
+         m3u_file_free(m3u_file);
+      }
+   }
+
+   if (!string_is_empty(image_path))
+      task_push_disk_prefetch(image_path);
+}
+
 /* Increments selected disk index */
 bool disk_control_set_index_next(
       disk_control_interface_t *disk_control,
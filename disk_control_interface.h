@@ -129,6 +129,12 @@ bool disk_control_set_index(
       disk_control_interface_t *disk_control,
       unsigned index, bool verbosity);
 
+/* Prefetches the disk image following the current
+ * disk index in the background, so that swapping to
+ * it does not stall on a cold read */
+void disk_control_prefetch_next(
+      disk_control_interface_t *disk_control);
+
 /* Increments selected disk index */
 bool disk_control_set_index_next(
       disk_control_interface_t *disk_control,
@@ -48,6 +48,8 @@ RETRO_BEGIN_DECLS
 #define FILE_PATH_STATE_EXTENSION ".state"
 #define FILE_PATH_LPL_EXTENSION ".lpl"
 #define FILE_PATH_LPL_EXTENSION_NO_DOT "lpl"
+#define FILE_PATH_LPL_CACHE_EXTENSION ".lplc"
+#define FILE_PATH_CONFIG_CACHE_EXTENSION ".cfgc"
 #define FILE_PATH_PNG_EXTENSION ".png"
 #define FILE_PATH_MP3_EXTENSION ".mp3"
 #define FILE_PATH_FLAC_EXTENSION ".flac"
@@ -113,6 +115,10 @@ RETRO_BEGIN_DECLS
 #endif
 #define FILE_PATH_CORE_INFO_CACHE "core_info.cache"
 #define FILE_PATH_CORE_INFO_CACHE_REFRESH "core_info.refresh"
+#define FILE_PATH_CONTENT_SCAN_CACHE "content_scan.cache"
+#define FILE_PATH_EXPLORE_CACHE "explore.cache"
+#define FILE_PATH_CHEEVOS_HASH_CACHE "cheevos_hash.cache"
+#define FILE_PATH_CHEEVOS_PENDING_QUEUE "cheevos_pending.queue"
 
 enum application_special_type
 {
@@ -171,6 +171,11 @@ struct gl
    float *overlay_vertex_coord;
    float *overlay_tex_coord;
    float *overlay_color_coord;
+   /* Triangle list of all overlay quads, drawn in one
+    * call when the overlay images are in one atlas */
+   float *overlay_batch_vertex_coord;
+   float *overlay_batch_tex_coord;
+   float *overlay_batch_color_coord;
 
    int version_major;
    int version_minor;
@@ -187,9 +192,13 @@ struct gl
    GLuint hw_render_fbo[GFX_MAX_TEXTURES];
 
 #ifdef HAVE_VIDEO_LAYOUT
-   GLuint video_layout_fbo;
-   GLuint video_layout_fbo_texture;
+   /* One FBO per layer of the current view, holding
+    * what was last drawn for that layer */
+   GLuint *video_layout_fbos;
+   GLuint *video_layout_fbo_textures;
    GLuint video_layout_white_texture;
+   int video_layout_fbos_count;
+   int video_layout_layer_current;
 #endif
 
    unsigned video_width;
@@ -250,6 +259,7 @@ struct gl
 
    bool overlay_enable;
    bool overlay_full_screen;
+   bool overlay_atlas;
    bool menu_texture_enable;
    bool menu_texture_full_screen;
    bool have_sync;
@@ -42,6 +42,7 @@ RETRO_BEGIN_DECLS
 #define GL_CORE_NUM_PBOS 4
 #define GL_CORE_NUM_VBOS 256
 #define GL_CORE_NUM_FENCES 8
+#define GL_CORE_NUM_UPLOAD_SEGMENTS 3
 struct gl_core_streamed_texture
 {
    GLuint tex;
@@ -49,6 +50,19 @@ struct gl_core_streamed_texture
    unsigned height;
 };
 
+/* Persistently mapped pixel unpack buffer for texture uploads.
+ * Split into one segment per frame in flight, each guarded by
+ * a fence placed after the last frame that used it. */
+struct gl_core_upload_ring
+{
+   GLsync fences[GL_CORE_NUM_UPLOAD_SEGMENTS];
+   uint8_t *map;
+   size_t segment_size;
+   size_t offset;
+   GLuint buffer;
+   unsigned segment;
+};
+
 typedef struct gl_core
 {
    const gfx_ctx_driver_t *ctx_driver;
@@ -66,6 +80,7 @@ typedef struct gl_core
    video_viewport_t vp;
    struct gl_core_viewport filter_chain_vp;
    struct gl_core_streamed_texture textures[GL_CORE_NUM_TEXTURES];
+   struct gl_core_upload_ring upload_ring;
 
    GLuint vao;
    GLuint menu_texture;
@@ -75,6 +90,7 @@ typedef struct gl_core
    {
       GLuint alpha_blend;
       GLuint font;
+      GLuint font_sdf;
       GLuint ribbon;
       GLuint ribbon_simple;
       GLuint snow_simple;
@@ -82,6 +98,7 @@ typedef struct gl_core
       GLuint bokeh;
       struct gl_core_buffer_locations alpha_blend_loc;
       struct gl_core_buffer_locations font_loc;
+      struct gl_core_buffer_locations font_sdf_loc;
       struct gl_core_buffer_locations ribbon_loc;
       struct gl_core_buffer_locations ribbon_simple_loc;
       struct gl_core_buffer_locations snow_simple_loc;
@@ -117,8 +134,10 @@ typedef struct gl_core
 
    bool pbo_readback_valid[GL_CORE_NUM_PBOS];
    bool pbo_readback_enable;
+   bool upload_ring_enable;      /* ARB_buffer_storage is available */
    bool hw_render_bottom_left;
    bool hw_render_enable;
+   bool filter_chain_is_stock;   /* No shader preset loaded */
    bool use_shared_context;
    bool overlay_enable;
    bool overlay_full_screen;
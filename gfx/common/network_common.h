@@ -18,15 +18,57 @@
 #ifndef __NETWORK_VIDEO_COMMON_H
 #define __NETWORK_VIDEO_COMMON_H
 
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <libretro.h>
+#include <streams/trans_stream.h>
+
+/* Every frame sent is preceded by a header of NETWORK_VIDEO_HEADER_WORDS
+ * big endian words: magic, frame number, width, height, pixel format,
+ * flags and payload size. The payload is the frame XOR'd against the
+ * previous frame sent if NETWORK_VIDEO_FLAG_DELTA is set (it isn't after
+ * a size change), then deflated if NETWORK_VIDEO_FLAG_DEFLATE is set.
+ * Frames equal to the previous one aren't sent, and frames are dropped
+ * while the link is still busy with an earlier one. */
+#define NETWORK_VIDEO_MAGIC        0x52414E56 /* RANV */
+#define NETWORK_VIDEO_HEADER_WORDS 7
+
+#define NETWORK_VIDEO_FLAG_DELTA   (1 << 0)
+#define NETWORK_VIDEO_FLAG_DEFLATE (1 << 1)
+
+/* How often to log the stream statistics */
+#define NETWORK_VIDEO_STATS_USEC   5000000
+
+RETRO_BEGIN_DECLS
+
 typedef struct network
 {
+   retro_time_t stats_time;
+   retro_time_t encode_time;
+   uint64_t bytes_sent;
+   const struct trans_stream_backend *compression_backend;
+   void *compression_stream;
+   uint32_t *prev_frame;
+   uint32_t *delta_frame;
+   uint8_t *send_buf;
+   size_t frame_bytes;
+   size_t send_size;
+   size_t send_pos;
    unsigned video_width;
    unsigned video_height;
    unsigned screen_width;
    unsigned screen_height;
+   unsigned frames_sent;
+   unsigned frames_unchanged;
+   unsigned frames_dropped;
+   uint32_t frame_count;
    char address[256];
    uint16_t port;
    int fd;
 } network_video_t;
 
+RETRO_END_DECLS
+
 #endif
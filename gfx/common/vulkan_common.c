@@ -1406,6 +1406,13 @@ static bool vulkan_load_device_symbols(gfx_ctx_vulkan_data_t *vk)
    VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_EXTENSION_SYMBOL(vk->context.device, vkGetSwapchainImagesKHR);
    VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_EXTENSION_SYMBOL(vk->context.device, vkAcquireNextImageKHR);
    VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_EXTENSION_SYMBOL(vk->context.device, vkQueuePresentKHR);
+
+   if (vk->context.display_timing)
+      vk->context.display_timing =
+            VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_EXTENSION_SYMBOL(
+               vk->context.device, vkGetRefreshCycleDurationGOOGLE)
+         && VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_EXTENSION_SYMBOL(
+               vk->context.device, vkGetPastPresentationTimingGOOGLE);
    return true;
 }
 
@@ -1604,6 +1611,7 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
 
    static const char *optional_device_extensions[] = {
       "VK_KHR_sampler_mirror_clamp_to_edge",
+      "VK_GOOGLE_display_timing",
    };
 
    struct retro_hw_render_context_negotiation_interface_vulkan *iface =
@@ -1790,6 +1798,11 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
           return false;
       }
 
+      for (i = 0; i < enabled_device_extension_count; i++)
+         if (string_is_equal(enabled_device_extensions[i],
+                  VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME))
+            vk->context.display_timing = true;
+
       queue_info.queueFamilyIndex         = vk->context.graphics_queue_index;
       queue_info.queueCount               = 1;
       queue_info.pQueuePriorities         = &one;
@@ -2526,9 +2539,39 @@ static void vulkan_destroy_swapchain(gfx_ctx_vulkan_data_t *vk)
    vk->context.num_recycled_acquire_semaphores = 0;
 }
 
+/* Hands what VK_GOOGLE_display_timing measured
+ * since the last call to the frame timings. */
+static void vulkan_poll_present_timing(gfx_ctx_vulkan_data_t *vk)
+{
+   unsigned i;
+   VkPastPresentationTimingGOOGLE timings[16];
+   uint32_t count = ARRAY_SIZE(timings);
+   VkResult res   = vkGetPastPresentationTimingGOOGLE(vk->context.device,
+         vk->swapchain, &count, timings);
+
+   if (res != VK_SUCCESS && res != VK_INCOMPLETE)
+      return;
+
+   for (i = 0; i < count; i++)
+   {
+      /* presentID holds the low 32 bits of the frame count */
+      uint32_t frames_ago = (uint32_t)vk->context.present_frame_count
+         - timings[i].presentID;
+
+      if (frames_ago > vk->context.present_frame_count)
+         continue;
+
+      video_driver_frame_presented(
+            vk->context.present_frame_count - frames_ago,
+            (retro_time_t)(timings[i].actualPresentTime / 1000));
+   }
+}
+
 void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
 {
    VkPresentInfoKHR present;
+   VkPresentTimeGOOGLE present_time;
+   VkPresentTimesInfoGOOGLE present_times;
    VkResult result                 = VK_SUCCESS;
    VkResult err                    = VK_SUCCESS;
 
@@ -2541,6 +2584,20 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
    present.pImageIndices           = &index;
    present.pResults                = &result;
 
+   if (vk->context.display_timing)
+   {
+      present_time.presentID          =
+         (uint32_t)vk->context.present_frame_count;
+      present_time.desiredPresentTime = 0;
+
+      present_times.sType             =
+         VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+      present_times.pNext             = NULL;
+      present_times.swapchainCount    = 1;
+      present_times.pTimes            = &present_time;
+      present.pNext                   = &present_times;
+   }
+
    /* Better hope QueuePresent doesn't block D: */
 #ifdef HAVE_THREADS
    slock_lock(vk->context.queue_lock);
@@ -2565,6 +2622,8 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
       RARCH_LOG("[Vulkan]: QueuePresent failed, destroying swapchain.\n");
       vulkan_destroy_swapchain(vk);
    }
+   else if (vk->context.display_timing)
+      vulkan_poll_present_timing(vk);
 
 #ifdef HAVE_THREADS
    slock_unlock(vk->context.queue_lock);
@@ -2886,6 +2945,58 @@ retry:
    vulkan_acquire_wait_fences(vk);
 }
 
+static bool vulkan_has_present_mode(const VkPresentModeKHR *modes,
+      unsigned num_modes, VkPresentModeKHR mode)
+{
+   unsigned i;
+   for (i = 0; i < num_modes; i++)
+      if (modes[i] == mode)
+         return true;
+   return false;
+}
+
+/* Without VSync MAILBOX is preferred over IMMEDIATE as it
+ * doesn't tear, adaptive VSync wants FIFO_RELAXED. FIFO
+ * is always supported. */
+static VkPresentModeKHR vulkan_select_present_mode(
+      const VkPresentModeKHR *modes, unsigned num_modes,
+      unsigned swap_interval, bool adaptive_vsync)
+{
+   if (!swap_interval)
+   {
+      if (vulkan_has_present_mode(modes, num_modes,
+               VK_PRESENT_MODE_MAILBOX_KHR))
+         return VK_PRESENT_MODE_MAILBOX_KHR;
+      if (vulkan_has_present_mode(modes, num_modes,
+               VK_PRESENT_MODE_IMMEDIATE_KHR))
+         return VK_PRESENT_MODE_IMMEDIATE_KHR;
+   }
+   else if (adaptive_vsync && vulkan_has_present_mode(modes, num_modes,
+            VK_PRESENT_MODE_FIFO_RELAXED_KHR))
+      return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+
+   return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+static const char *vulkan_present_mode_to_str(VkPresentModeKHR mode)
+{
+   switch (mode)
+   {
+      case VK_PRESENT_MODE_IMMEDIATE_KHR:
+         return "IMMEDIATE";
+      case VK_PRESENT_MODE_MAILBOX_KHR:
+         return "MAILBOX";
+      case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+         return "FIFO_RELAXED";
+      case VK_PRESENT_MODE_FIFO_KHR:
+         return "FIFO";
+      default:
+         break;
+   }
+
+   return "unknown";
+}
+
 bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
       unsigned width, unsigned height,
       unsigned swap_interval)
@@ -2905,6 +3016,7 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
    VkSwapchainCreateInfoKHR info           = {
       VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
    VkPresentModeKHR swapchain_present_mode = VK_PRESENT_MODE_FIFO_KHR;
+   bool adaptive_vsync                     = false;
    settings_t                    *settings = config_get_ptr();
    VkCompositeAlphaFlagBitsKHR composite   = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 
@@ -2919,6 +3031,37 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
        !surface_properties.currentExtent.height)
       return false;
 
+   present_mode_count = 0;
+   vkGetPhysicalDeviceSurfacePresentModesKHR(
+         vk->context.gpu, vk->vk_surface,
+         &present_mode_count, NULL);
+   if (present_mode_count < 1 || present_mode_count > 16)
+   {
+      RARCH_ERR("[Vulkan]: Bogus present modes found.\n");
+      return false;
+   }
+   vkGetPhysicalDeviceSurfacePresentModesKHR(
+         vk->context.gpu, vk->vk_surface,
+         &present_mode_count, present_modes);
+
+#ifdef VULKAN_DEBUG
+   for (i = 0; i < present_mode_count; i++)
+   {
+      RARCH_LOG("[Vulkan]: Swapchain supports present mode: %u.\n",
+            present_modes[i]);
+   }
+#endif
+
+   vk->adaptive_vsync = vulkan_has_present_mode(present_modes,
+         present_mode_count, VK_PRESENT_MODE_FIFO_RELAXED_KHR);
+
+   /* Adaptive VSync is requested with a swap interval of -1 */
+   if ((int)swap_interval < 0)
+   {
+      swap_interval          = 1;
+      adaptive_vsync         = true;
+   }
+
    if (swap_interval == 0 && vk->emulate_mailbox)
    {
       swap_interval          = 1;
@@ -2927,13 +3070,17 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
    else
       vk->emulating_mailbox  = false;
 
+   swapchain_present_mode    = vulkan_select_present_mode(present_modes,
+         present_mode_count, swap_interval, adaptive_vsync);
+
    vk->created_new_swapchain = true;
 
    if (vk->swapchain != VK_NULL_HANDLE &&
          !vk->context.invalid_swapchain &&
          vk->context.swapchain_width == width &&
          vk->context.swapchain_height == height &&
-         vk->context.swap_interval == swap_interval)
+         vk->context.swap_interval == swap_interval &&
+         vk->context.present_mode == swapchain_present_mode)
    {
       /* Do not bother creating a swapchain redundantly. */
 #ifdef VULKAN_DEBUG
@@ -2989,53 +3136,12 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
 
    vulkan_emulated_mailbox_deinit(&vk->mailbox);
 
-   present_mode_count = 0;
-   vkGetPhysicalDeviceSurfacePresentModesKHR(
-         vk->context.gpu, vk->vk_surface,
-         &present_mode_count, NULL);
-   if (present_mode_count < 1 || present_mode_count > 16)
-   {
-      RARCH_ERR("[Vulkan]: Bogus present modes found.\n");
-      return false;
-   }
-   vkGetPhysicalDeviceSurfacePresentModesKHR(
-         vk->context.gpu, vk->vk_surface,
-         &present_mode_count, present_modes);
-
-#ifdef VULKAN_DEBUG
-   for (i = 0; i < present_mode_count; i++)
-   {
-      RARCH_LOG("[Vulkan]: Swapchain supports present mode: %u.\n",
-            present_modes[i]);
-   }
-#endif
-
    vk->context.swap_interval = swap_interval;
-   for (i = 0; i < present_mode_count; i++)
-   {
-      if (!swap_interval && present_modes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
-      {
-         swapchain_present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
-         break;
-      }
-      else if (!swap_interval && present_modes[i]
-            == VK_PRESENT_MODE_IMMEDIATE_KHR)
-      {
-         swapchain_present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
-         break;
-      }
-      else if (swap_interval && present_modes[i] == VK_PRESENT_MODE_FIFO_KHR)
-      {
-         /* Kind of tautological since FIFO must always be present. */
-         swapchain_present_mode = VK_PRESENT_MODE_FIFO_KHR;
-         break;
-      }
-   }
+   vk->context.present_mode  = swapchain_present_mode;
 
-#ifdef VULKAN_DEBUG
-   RARCH_LOG("[Vulkan]: Creating swapchain with present mode: %u\n",
-         (unsigned)swapchain_present_mode);
-#endif
+   RARCH_LOG("[Vulkan]: Creating swapchain with present mode: %s%s.\n",
+         vulkan_present_mode_to_str(swapchain_present_mode),
+         vk->emulating_mailbox ? " (emulated MAILBOX)" : "");
 
    vkGetPhysicalDeviceSurfaceFormatsKHR(vk->context.gpu,
          vk->vk_surface, &format_count, NULL);
@@ -3187,6 +3293,15 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
    vk->context.swapchain_width  = swapchain_size.width;
    vk->context.swapchain_height = swapchain_size.height;
 
+   if (vk->context.display_timing)
+   {
+      VkRefreshCycleDurationGOOGLE refresh;
+      if (vkGetRefreshCycleDurationGOOGLE(vk->context.device,
+               vk->swapchain, &refresh) == VK_SUCCESS)
+         RARCH_LOG("[Vulkan]: Display refresh cycle: %.3f ms.\n",
+               refresh.refreshDuration / 1000000.0);
+   }
+
    /* Make sure we create a backbuffer format that is as we expect. */
    switch (format.format)
    {
@@ -106,6 +106,7 @@ typedef struct vulkan_context
    VkImage swapchain_images[VULKAN_MAX_SWAPCHAIN_IMAGES];
    VkFence swapchain_fences[VULKAN_MAX_SWAPCHAIN_IMAGES];
    VkFormat swapchain_format;
+   VkPresentModeKHR present_mode;
 
    VkSemaphore swapchain_semaphores[VULKAN_MAX_SWAPCHAIN_IMAGES];
    VkSemaphore swapchain_acquire_semaphore;
@@ -115,6 +116,9 @@ typedef struct vulkan_context
 #ifdef VULKAN_DEBUG
    VkDebugReportCallbackEXT debug_callback;
 #endif
+   /* Frame being presented, passed to video_driver_frame_presented() */
+   uint64_t present_frame_count;
+
    uint32_t graphics_queue_index;
    uint32_t num_swapchain_images;
    uint32_t current_swapchain_index;
@@ -131,6 +135,8 @@ typedef struct vulkan_context
    bool swapchain_is_srgb;
    bool swap_interval_emulation_lock;
    bool has_acquired_swapchain;
+   /* VK_GOOGLE_display_timing is enabled on the device */
+   bool display_timing;
 } vulkan_context_t;
 
 struct vulkan_emulated_mailbox
@@ -167,6 +173,9 @@ typedef struct gfx_ctx_vulkan_data
    bool created_new_swapchain;
    bool emulate_mailbox;
    bool emulating_mailbox;
+   /* The surface supports FIFO_RELAXED, requested
+    * with a swap interval of -1 (adaptive VSync). */
+   bool adaptive_vsync;
    /* If set, prefer a path where we use
     * semaphores instead of fences for vkAcquireNextImageKHR.
     * Helps workaround certain performance issues on some drivers. */
@@ -327,6 +336,7 @@ typedef struct vk
    math_matrix_4x4 mvp, mvp_no_rot; /* float alignment */
    VkViewport vk_vp;
    VkRenderPass render_pass;
+   VkRenderPass render_pass_load; /* Keeps the backbuffer contents */
    struct video_viewport vp;
    struct vk_per_frame swapchain[VULKAN_MAX_SWAPCHAIN_IMAGES];
    struct vk_image backbuffers[VULKAN_MAX_SWAPCHAIN_IMAGES];
@@ -359,6 +369,7 @@ typedef struct vk
    {
       VkPipeline alpha_blend;
       VkPipeline font;
+      VkPipeline font_sdf;
       VkDescriptorSetLayout set_layout;
       VkPipelineLayout layout;
       VkPipelineCache cache;
@@ -427,6 +438,7 @@ typedef struct vk
    bool fullscreen;
    bool quitting;
    bool should_resize;
+   bool filter_chain_is_stock; /* No shader preset loaded */
 
 } vk_t;
 
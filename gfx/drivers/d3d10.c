@@ -31,6 +31,7 @@
 #include "../../verbosity.h"
 #include "../../configuration.h"
 #include "../../retroarch.h"
+#include "../../memory_tags.h"
 #ifdef HAVE_REWIND
 #include "../../state_manager.h"
 #endif
@@ -326,7 +327,7 @@ static void d3d10_free_shader_preset(d3d10_video_t* d3d10)
 
    memset(d3d10->luts, 0, sizeof(d3d10->luts));
 
-   free(d3d10->shader_preset);
+   memory_tag_free(MEMORY_TAG_SHADERS, d3d10->shader_preset);
    d3d10->shader_preset         = NULL;
    d3d10->init_history          = false;
    d3d10->resize_render_targets = false;
@@ -354,7 +355,8 @@ static bool d3d10_gfx_set_shader(void* data, enum rarch_shader_type type, const
       return false;
    }
 
-   d3d10->shader_preset = (struct video_shader*)calloc(1, sizeof(*d3d10->shader_preset));
+   d3d10->shader_preset = (struct video_shader*)memory_tag_calloc(
+         MEMORY_TAG_SHADERS, 1, sizeof(*d3d10->shader_preset));
 
    if (!video_shader_load_preset_into_shader(path, d3d10->shader_preset))
       goto error;
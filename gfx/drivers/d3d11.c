@@ -40,6 +40,7 @@
 #include "../../verbosity.h"
 #include "../../configuration.h"
 #include "../../retroarch.h"
+#include "../../memory_tags.h"
 #include "../font_driver.h"
 #include "../common/win32_common.h"
 #include "../../performance_counters.h"
@@ -349,7 +350,7 @@ static void d3d11_free_shader_preset(d3d11_video_t* d3d11)
 
    memset(d3d11->luts, 0, sizeof(d3d11->luts));
 
-   free(d3d11->shader_preset);
+   memory_tag_free(MEMORY_TAG_SHADERS, d3d11->shader_preset);
    d3d11->shader_preset         = NULL;
    d3d11->init_history          = false;
    d3d11->resize_render_targets = false;
@@ -377,7 +378,8 @@ static bool d3d11_gfx_set_shader(void* data, enum rarch_shader_type type, const
       return false;
    }
 
-   d3d11->shader_preset = (struct video_shader*)calloc(1, sizeof(*d3d11->shader_preset));
+   d3d11->shader_preset = (struct video_shader*)memory_tag_calloc(
+         MEMORY_TAG_SHADERS, 1, sizeof(*d3d11->shader_preset));
 
    if (!video_shader_load_preset_into_shader(path, d3d11->shader_preset))
       goto error;
@@ -33,6 +33,7 @@
 #include "../../verbosity.h"
 #include "../../configuration.h"
 #include "../../retroarch.h"
+#include "../../memory_tags.h"
 #ifdef HAVE_REWIND
 #include "../../state_manager.h"
 #endif
@@ -333,7 +334,7 @@ static void d3d12_free_shader_preset(d3d12_video_t* d3d12)
 
    memset(d3d12->luts, 0, sizeof(d3d12->luts));
 
-   free(d3d12->shader_preset);
+   memory_tag_free(MEMORY_TAG_SHADERS, d3d12->shader_preset);
    d3d12->shader_preset         = NULL;
    d3d12->init_history          = false;
    d3d12->resize_render_targets = false;
@@ -361,7 +362,8 @@ static bool d3d12_gfx_set_shader(void* data, enum rarch_shader_type type, const
       return false;
    }
 
-   d3d12->shader_preset = (struct video_shader*)calloc(1, sizeof(*d3d12->shader_preset));
+   d3d12->shader_preset = (struct video_shader*)memory_tag_calloc(
+         MEMORY_TAG_SHADERS, 1, sizeof(*d3d12->shader_preset));
 
    if (!video_shader_load_preset_into_shader(path, d3d12->shader_preset))
       goto error;
@@ -1803,17 +1803,24 @@ bool gl_load_luts(
 #ifdef HAVE_OVERLAY
 static void gl2_free_overlay(gl_t *gl)
 {
-   glDeleteTextures(gl->overlays, gl->overlay_tex);
+   glDeleteTextures(gl->overlay_atlas ? 1 : gl->overlays, gl->overlay_tex);
 
    free(gl->overlay_tex);
    free(gl->overlay_vertex_coord);
    free(gl->overlay_tex_coord);
    free(gl->overlay_color_coord);
-   gl->overlay_tex          = NULL;
-   gl->overlay_vertex_coord = NULL;
-   gl->overlay_tex_coord    = NULL;
-   gl->overlay_color_coord  = NULL;
-   gl->overlays             = 0;
+   free(gl->overlay_batch_vertex_coord);
+   free(gl->overlay_batch_tex_coord);
+   free(gl->overlay_batch_color_coord);
+   gl->overlay_tex                = NULL;
+   gl->overlay_vertex_coord       = NULL;
+   gl->overlay_tex_coord          = NULL;
+   gl->overlay_color_coord        = NULL;
+   gl->overlay_batch_vertex_coord = NULL;
+   gl->overlay_batch_tex_coord    = NULL;
+   gl->overlay_batch_color_coord  = NULL;
+   gl->overlays                   = 0;
+   gl->overlay_atlas              = false;
 }
 
 static void gl2_overlay_vertex_geom(void *data,
@@ -1887,18 +1894,56 @@ static void gl2_render_overlay(gl_t *gl)
    gl->shader->use(gl, gl->shader_data,
          VIDEO_SHADER_STOCK_BLEND, true);
 
-   gl->coords.vertex    = gl->overlay_vertex_coord;
-   gl->coords.tex_coord = gl->overlay_tex_coord;
-   gl->coords.color     = gl->overlay_color_coord;
-   gl->coords.vertices  = 4 * gl->overlays;
+   if (gl->overlay_atlas)
+   {
+      /* All images share one texture, so the quads are
+       * expanded into a triangle list and drawn at once */
+      static const unsigned strip_to_list[6] = { 0, 1, 2, 2, 1, 3 };
 
-   gl->shader->set_coords(gl->shader_data, &gl->coords);
-   gl->shader->set_mvp(gl->shader_data, &gl->mvp_no_rot);
+      for (i = 0; i < gl->overlays; i++)
+      {
+         unsigned j;
+
+         for (j = 0; j < 6; j++)
+         {
+            unsigned src = 4 * i + strip_to_list[j];
+            unsigned dst = 6 * i + j;
+
+            memcpy(&gl->overlay_batch_vertex_coord[2 * dst],
+                  &gl->overlay_vertex_coord[2 * src], 2 * sizeof(GLfloat));
+            memcpy(&gl->overlay_batch_tex_coord[2 * dst],
+                  &gl->overlay_tex_coord[2 * src], 2 * sizeof(GLfloat));
+            memcpy(&gl->overlay_batch_color_coord[4 * dst],
+                  &gl->overlay_color_coord[4 * src], 4 * sizeof(GLfloat));
+         }
+      }
+
+      gl->coords.vertex    = gl->overlay_batch_vertex_coord;
+      gl->coords.tex_coord = gl->overlay_batch_tex_coord;
+      gl->coords.color     = gl->overlay_batch_color_coord;
+      gl->coords.vertices  = 6 * gl->overlays;
 
-   for (i = 0; i < gl->overlays; i++)
+      gl->shader->set_coords(gl->shader_data, &gl->coords);
+      gl->shader->set_mvp(gl->shader_data, &gl->mvp_no_rot);
+
+      glBindTexture(GL_TEXTURE_2D, gl->overlay_tex[0]);
+      glDrawArrays(GL_TRIANGLES, 0, 6 * gl->overlays);
+   }
+   else
    {
-      glBindTexture(GL_TEXTURE_2D, gl->overlay_tex[i]);
-      glDrawArrays(GL_TRIANGLE_STRIP, 4 * i, 4);
+      gl->coords.vertex    = gl->overlay_vertex_coord;
+      gl->coords.tex_coord = gl->overlay_tex_coord;
+      gl->coords.color     = gl->overlay_color_coord;
+      gl->coords.vertices  = 4 * gl->overlays;
+
+      gl->shader->set_coords(gl->shader_data, &gl->coords);
+      gl->shader->set_mvp(gl->shader_data, &gl->mvp_no_rot);
+
+      for (i = 0; i < gl->overlays; i++)
+      {
+         glBindTexture(GL_TEXTURE_2D, gl->overlay_tex[i]);
+         glDrawArrays(GL_TRIANGLE_STRIP, 4 * i, 4);
+      }
    }
 
    glDisable(GL_BLEND);
@@ -2510,40 +2555,69 @@ static float video_layout_layer_tex_coord[] = {
    1.0f, 0.0f,
 };
 
-static void gl2_video_layout_fbo_init(gl_t *gl, unsigned width, unsigned height)
+static void gl2_video_layout_fbo_free(gl_t *gl)
 {
-   glGenTextures(1, &gl->video_layout_fbo_texture);
-   glBindTexture(GL_TEXTURE_2D, gl->video_layout_fbo_texture);
+   if (gl->video_layout_fbos)
+   {
+      gl2_delete_fb(gl->video_layout_fbos_count, gl->video_layout_fbos);
+      free(gl->video_layout_fbos);
+      gl->video_layout_fbos = NULL;
+   }
 
-   gl2_load_texture_image(GL_TEXTURE_2D, 0, RARCH_GL_INTERNAL_FORMAT32,
-      width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+   if (gl->video_layout_fbo_textures)
+   {
+      glDeleteTextures(gl->video_layout_fbos_count,
+            gl->video_layout_fbo_textures);
+      free(gl->video_layout_fbo_textures);
+      gl->video_layout_fbo_textures = NULL;
+   }
 
-   gl2_gen_fb(1, &gl->video_layout_fbo);
-   gl2_bind_fb(gl->video_layout_fbo);
+   gl->video_layout_fbos_count = 0;
+}
 
-   gl2_fb_texture_2d(RARCH_GL_FRAMEBUFFER, RARCH_GL_COLOR_ATTACHMENT0,
-      GL_TEXTURE_2D, gl->video_layout_fbo_texture, 0);
+static void gl2_video_layout_fbo_init(gl_t *gl,
+      unsigned width, unsigned height, int count)
+{
+   int i;
 
-   if (gl2_check_fb_status(RARCH_GL_FRAMEBUFFER) != 
-         RARCH_GL_FRAMEBUFFER_COMPLETE)
-      RARCH_LOG("[GL]: Unable to create FBO for video_layout\n");
+   if (count <= 0)
+      return;
 
-   gl2_bind_fb(0);
-}
+   gl->video_layout_fbos         = (GLuint*)calloc(count, sizeof(GLuint));
+   gl->video_layout_fbo_textures = (GLuint*)calloc(count, sizeof(GLuint));
 
-static void gl2_video_layout_fbo_free(gl_t *gl)
-{
-   if (gl->video_layout_fbo)
+   if (!gl->video_layout_fbos || !gl->video_layout_fbo_textures)
    {
-      gl2_delete_fb(1, &gl->video_layout_fbo);
-      gl->video_layout_fbo = 0;
+      free(gl->video_layout_fbos);
+      free(gl->video_layout_fbo_textures);
+      gl->video_layout_fbos         = NULL;
+      gl->video_layout_fbo_textures = NULL;
+      return;
    }
 
-   if (gl->video_layout_fbo_texture)
+   gl->video_layout_fbos_count = count;
+
+   glGenTextures(count, gl->video_layout_fbo_textures);
+   gl2_gen_fb(count, gl->video_layout_fbos);
+
+   for (i = 0; i < count; ++i)
    {
-      glDeleteTextures(1, &gl->video_layout_fbo_texture);
-      gl->video_layout_fbo_texture = 0;
+      glBindTexture(GL_TEXTURE_2D, gl->video_layout_fbo_textures[i]);
+
+      gl2_load_texture_image(GL_TEXTURE_2D, 0, RARCH_GL_INTERNAL_FORMAT32,
+         width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+
+      gl2_bind_fb(gl->video_layout_fbos[i]);
+
+      gl2_fb_texture_2d(RARCH_GL_FRAMEBUFFER, RARCH_GL_COLOR_ATTACHMENT0,
+         GL_TEXTURE_2D, gl->video_layout_fbo_textures[i], 0);
+
+      if (gl2_check_fb_status(RARCH_GL_FRAMEBUFFER) != 
+            RARCH_GL_FRAMEBUFFER_COMPLETE)
+         RARCH_LOG("[GL]: Unable to create FBO for video_layout\n");
    }
+
+   gl2_bind_fb(0);
 }
 
 static void gl2_video_layout_viewport(gl_t *gl)
@@ -2553,16 +2627,14 @@ static void gl2_video_layout_viewport(gl_t *gl)
 
    if (gl->video_layout_resize)
    {
-      if (gl->video_layout_fbo)
-         gl2_video_layout_fbo_free(gl);
-
-      gl2_video_layout_fbo_init(gl, gl->video_width, gl->video_height);
-
       video_layout_view_change();
 
       gl->video_layout_resize = false;
    }
 
+   /* Resizing changes the view too, so the layer FBOs are
+    * only ever recreated here; fitting the view marks all
+    * layers to be drawn again */
    if (video_layout_view_on_change())
    {
       video_layout_bounds_t b;
@@ -2570,6 +2642,11 @@ static void gl2_video_layout_viewport(gl_t *gl)
       b.y = 0.0f;
       b.w = (float)gl->video_width;
       b.h = (float)gl->video_height;
+
+      gl2_video_layout_fbo_free(gl);
+      gl2_video_layout_fbo_init(gl, gl->video_width, gl->video_height,
+            video_layout_layer_count());
+
       video_layout_view_fit_bounds(b);
    }
 
@@ -2585,6 +2662,39 @@ static void gl2_video_layout_viewport(gl_t *gl)
    }
 }
 
+static void gl2_video_layout_layer_composite(gl_t *gl,
+      int index, video_layout_blend_t blend_type)
+{
+   gl->shader->use(gl, gl->shader_data,
+      VIDEO_SHADER_STOCK_BLEND, true);
+
+   switch (blend_type)
+   {
+   case VIDEO_LAYOUT_BLEND_ALPHA:
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      break;
+   case VIDEO_LAYOUT_BLEND_ADD:
+      glBlendFunc(GL_ONE, GL_ONE);
+      break;
+   case VIDEO_LAYOUT_BLEND_MOD:
+      glBlendFunc(GL_DST_COLOR, GL_ZERO);
+      break;
+   }
+
+   gl->coords.vertex = gl->vertex_ptr;
+   gl->coords.tex_coord = video_layout_layer_tex_coord;
+   gl->coords.color = gl->white_color_ptr;
+   gl->coords.vertices = 4;
+
+   gl->shader->set_coords(gl->shader_data, &gl->coords);
+   gl->shader->set_mvp(gl->shader_data, &gl->mvp_no_rot);
+
+   glBindTexture(GL_TEXTURE_2D, gl->video_layout_fbo_textures[index]);
+   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+   gl->coords.tex_coord = gl->tex_info.coord;
+}
+
 static void gl2_video_layout_render(gl_t *gl)
 {
    int i;
@@ -2595,8 +2705,19 @@ static void gl2_video_layout_render(gl_t *gl)
    glViewport(0, 0, gl->video_width, gl->video_height);
    glEnable(GL_BLEND);
 
-   for (i = 0; i < video_layout_layer_count(); ++i)
-      video_layout_layer_render(i);
+   /* Layers are only drawn again when one of their
+    * elements changed state; otherwise what was drawn
+    * last time is composited as is */
+   for (i = 0; i < gl->video_layout_fbos_count; ++i)
+   {
+      if (video_layout_layer_update(i))
+      {
+         gl->video_layout_layer_current = i;
+         video_layout_layer_render(i);
+      }
+      else
+         gl2_video_layout_layer_composite(gl, i, video_layout_layer_blend(i));
+   }
 
    glDisable(GL_BLEND);
 }
@@ -2655,7 +2776,7 @@ static void gl2_video_layout_layer_begin(const video_layout_render_info_t *info)
    gl_t *gl;
    gl = (gl_t*)info->video_driver_data;
 
-   gl2_bind_fb(gl->video_layout_fbo);
+   gl2_bind_fb(gl->video_layout_fbos[gl->video_layout_layer_current]);
 
    glClearColor(0, 0, 0, 0);
    glClear(GL_COLOR_BUFFER_BIT);
@@ -2755,33 +2876,10 @@ static void gl2_video_layout_layer_end(const video_layout_render_info_t *info, v
    gl_t *gl;
    gl = (gl_t*)info->video_driver_data;
 
-   switch (blend_type)
-   {
-   case VIDEO_LAYOUT_BLEND_ALPHA:
-      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      break;
-   case VIDEO_LAYOUT_BLEND_ADD:
-      glBlendFunc(GL_ONE, GL_ONE);
-      break;
-   case VIDEO_LAYOUT_BLEND_MOD:
-      glBlendFunc(GL_DST_COLOR, GL_ZERO);
-      break;
-   }
-
    gl2_bind_fb(0);
 
-   gl->coords.vertex = gl->vertex_ptr;
-   gl->coords.tex_coord = video_layout_layer_tex_coord;
-   gl->coords.color = gl->white_color_ptr;
-   gl->coords.vertices = 4;
-
-   gl->shader->set_coords(gl->shader_data, &gl->coords);
-   gl->shader->set_mvp(gl->shader_data, &gl->mvp_no_rot);
-
-   glBindTexture(GL_TEXTURE_2D, gl->video_layout_fbo_texture);
-   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-   gl->coords.tex_coord = gl->tex_info.coord;
+   gl2_video_layout_layer_composite(gl,
+         gl->video_layout_layer_current, blend_type);
 }
 
 static video_layout_render_interface_t gl2_video_layout_render_interface =
@@ -4329,6 +4427,79 @@ static bool gl2_overlay_load(void *data,
    return true;
 }
 
+static bool gl2_overlay_load_atlas(void *data,
+      const void *atlas_data, const float *rects, unsigned num_images)
+{
+   unsigned i, j;
+   GLint max_size                     = 0;
+   gl_t *gl                           = (gl_t*)data;
+   const struct texture_image *atlas  =
+      (const struct texture_image*)atlas_data;
+
+   if (!gl || !num_images)
+      return false;
+
+   glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+   if (     (GLint)atlas->width  > max_size
+         || (GLint)atlas->height > max_size)
+      return false;
+
+   gl2_context_bind_hw_render(gl, false);
+
+   gl2_free_overlay(gl);
+   gl->overlay_tex                = (GLuint*)calloc(1, sizeof(*gl->overlay_tex));
+   gl->overlay_vertex_coord       = (GLfloat*)
+      calloc(2 * 4 * num_images, sizeof(GLfloat));
+   gl->overlay_tex_coord          = (GLfloat*)
+      calloc(2 * 4 * num_images, sizeof(GLfloat));
+   gl->overlay_color_coord        = (GLfloat*)
+      calloc(4 * 4 * num_images, sizeof(GLfloat));
+   gl->overlay_batch_vertex_coord = (GLfloat*)
+      calloc(2 * 6 * num_images, sizeof(GLfloat));
+   gl->overlay_batch_tex_coord    = (GLfloat*)
+      calloc(2 * 6 * num_images, sizeof(GLfloat));
+   gl->overlay_batch_color_coord  = (GLfloat*)
+      calloc(4 * 6 * num_images, sizeof(GLfloat));
+
+   if (     !gl->overlay_tex
+         || !gl->overlay_vertex_coord
+         || !gl->overlay_tex_coord
+         || !gl->overlay_color_coord
+         || !gl->overlay_batch_vertex_coord
+         || !gl->overlay_batch_tex_coord
+         || !gl->overlay_batch_color_coord)
+   {
+      gl2_free_overlay(gl);
+      gl2_context_bind_hw_render(gl, true);
+      return false;
+   }
+
+   gl->overlays      = num_images;
+   gl->overlay_atlas = true;
+   glGenTextures(1, gl->overlay_tex);
+
+   gl_load_texture_data(gl->overlay_tex[0],
+         RARCH_WRAP_EDGE, TEXTURE_FILTER_LINEAR,
+         gl2_get_alignment(atlas->width * sizeof(uint32_t)),
+         atlas->width, atlas->height, atlas->pixels,
+         sizeof(uint32_t));
+
+   for (i = 0; i < num_images; i++)
+   {
+      gl2_overlay_tex_geom(gl, i,
+            rects[4 * i + 0], rects[4 * i + 1],
+            rects[4 * i + 2], rects[4 * i + 3]);
+      /* Default. Stretch to whole screen. */
+      gl2_overlay_vertex_geom(gl, i, 0, 0, 1, 1);
+
+      for (j = 0; j < 16; j++)
+         gl->overlay_color_coord[16 * i + j] = 1.0f;
+   }
+
+   gl2_context_bind_hw_render(gl, true);
+   return true;
+}
+
 static void gl2_overlay_enable(void *data, bool state)
 {
    gl_t *gl = (gl_t*)data;
@@ -4373,6 +4544,7 @@ static const video_overlay_interface_t gl2_overlay_interface = {
    gl2_overlay_vertex_geom,
    gl2_overlay_full_screen,
    gl2_overlay_set_alpha,
+   gl2_overlay_load_atlas,
 };
 
 static void gl2_get_overlay_interface(void *data,
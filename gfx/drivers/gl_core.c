@@ -192,6 +192,187 @@ static void gl_core_deinit_fences(gl_core_t *gl)
    memset(gl->fences, 0, sizeof(gl->fences));
 }
 
+/* Smallest upload ring segment, enough for most cores' frames */
+#define GL_CORE_UPLOAD_SEGMENT_MIN_SIZE (4 * 1024 * 1024)
+
+/* GL 4.4 / ARB_buffer_storage, missing from older glext.h */
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT   0x0080
+#endif
+
+static void gl_core_deinit_upload_ring(gl_core_t *gl)
+{
+   unsigned i;
+   struct gl_core_upload_ring *ring = &gl->upload_ring;
+
+   for (i = 0; i < GL_CORE_NUM_UPLOAD_SEGMENTS; i++)
+   {
+      if (ring->fences[i])
+         glDeleteSync(ring->fences[i]);
+   }
+
+   if (ring->buffer)
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffer);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers(1, &ring->buffer);
+   }
+
+   memset(ring, 0, sizeof(*ring));
+}
+
+#ifndef HAVE_OPENGLES
+static bool gl_core_init_upload_ring(gl_core_t *gl, size_t segment_size)
+{
+   struct gl_core_upload_ring *ring = &gl->upload_ring;
+   GLbitfield flags                 = GL_MAP_WRITE_BIT
+      | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+   size_t size                      = segment_size * GL_CORE_NUM_UPLOAD_SEGMENTS;
+
+   gl_core_deinit_upload_ring(gl);
+
+   glGenBuffers(1, &ring->buffer);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffer);
+   glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, NULL, flags);
+   ring->map = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   if (!ring->map)
+   {
+      RARCH_WARN("[GLCore]: Failed to map texture upload buffer, "
+            "uploading from client memory.\n");
+      gl_core_deinit_upload_ring(gl);
+      gl->upload_ring_enable = false;
+      return false;
+   }
+
+   ring->segment_size = segment_size;
+   RARCH_LOG("[GLCore]: Texture upload ring: %u x %u KiB.\n",
+         GL_CORE_NUM_UPLOAD_SEGMENTS, (unsigned)(segment_size >> 10));
+   return true;
+}
+#endif
+
+/**
+ * gl_core_upload_ring_alloc:
+ * @gl               : driver data.
+ * @size             : bytes to reserve.
+ * @offset           : offset of the reservation in the ring buffer.
+ *
+ * Reserves upload memory in the segment of the current frame,
+ * waiting for the GPU to finish the frame that used it last.
+ *
+ * Returns: pointer to the reserved memory, NULL if the
+ * upload has to go through client memory instead.
+ **/
+static uint8_t *gl_core_upload_ring_alloc(gl_core_t *gl,
+      size_t size, size_t *offset)
+{
+#ifndef HAVE_OPENGLES
+   struct gl_core_upload_ring *ring = &gl->upload_ring;
+   size_t aligned                   = (size + 63) & ~(size_t)63;
+
+   if (!gl->upload_ring_enable)
+      return NULL;
+
+   if (aligned > ring->segment_size)
+   {
+      size_t segment_size = GL_CORE_UPLOAD_SEGMENT_MIN_SIZE;
+      while (segment_size < aligned)
+         segment_size <<= 1;
+      if (!gl_core_init_upload_ring(gl, segment_size))
+         return NULL;
+   }
+
+   /* Rare, mostly a frame and a large menu texture at once */
+   if (ring->offset + aligned > ring->segment_size)
+      return NULL;
+
+   if (ring->fences[ring->segment])
+   {
+      glClientWaitSync(ring->fences[ring->segment],
+            GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+      glDeleteSync(ring->fences[ring->segment]);
+      ring->fences[ring->segment] = NULL;
+   }
+
+   *offset       = ring->segment * ring->segment_size + ring->offset;
+   ring->offset += aligned;
+   return ring->map + *offset;
+#else
+   return NULL;
+#endif
+}
+
+/* Fences the current segment once the frame is submitted */
+static void gl_core_upload_ring_end_frame(gl_core_t *gl)
+{
+   struct gl_core_upload_ring *ring = &gl->upload_ring;
+
+   if (!ring->offset)
+      return;
+
+   ring->fences[ring->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+   ring->segment               = (ring->segment + 1) % GL_CORE_NUM_UPLOAD_SEGMENTS;
+   ring->offset                = 0;
+}
+
+/**
+ * gl_core_upload_texture:
+ * @gl               : driver data.
+ * @width            : width of the upload.
+ * @height           : height of the upload.
+ * @format           : pixel format, as for glTexSubImage2D().
+ * @type             : pixel type, as for glTexSubImage2D().
+ * @bpp              : bytes per pixel.
+ * @pitch            : bytes per line of @data.
+ * @data             : pixels.
+ *
+ * Uploads into level 0 of the texture bound to GL_TEXTURE_2D.
+ * Goes through the upload ring when possible, which avoids the
+ * synchronous copy many drivers do for client memory.
+ **/
+static void gl_core_upload_texture(gl_core_t *gl,
+      unsigned width, unsigned height, GLenum format, GLenum type,
+      unsigned bpp, unsigned pitch, const void *data)
+{
+   size_t offset;
+   size_t row_size = width * bpp;
+   uint8_t *dst    = gl_core_upload_ring_alloc(gl, row_size * height, &offset);
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, bpp >= 4 ? 4 : bpp);
+
+   if (dst)
+   {
+      unsigned y;
+      const uint8_t *src = (const uint8_t*)data;
+
+      if (pitch == row_size)
+         memcpy(dst, src, row_size * height);
+      else
+         for (y = 0; y < height; y++, src += pitch, dst += row_size)
+            memcpy(dst, src, row_size);
+
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->upload_ring.buffer);
+      glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+            format, type, (const void*)(uintptr_t)offset);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      return;
+   }
+
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch / bpp);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+         format, type, data);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
 static bool gl_core_init_pbo_readback(gl_core_t *gl)
 {
    unsigned i;
@@ -256,6 +437,18 @@ static void gl_core_slow_readback(gl_core_t *gl, void *buffer)
 
 static void gl_core_pbo_async_readback(gl_core_t *gl)
 {
+   /* Viewport was resized, start over with a ring of the new
+    * size. Frames queued at the old size are dropped. */
+   if (  gl->vp.width  != (unsigned)gl->pbo_readback_scaler.in_width ||
+         gl->vp.height != (unsigned)gl->pbo_readback_scaler.in_height)
+   {
+      gl_core_deinit_pbo_readback(gl);
+      memset(gl->pbo_readback_valid, 0, sizeof(gl->pbo_readback_valid));
+      gl->pbo_readback_index = 0;
+      if (!gl_core_init_pbo_readback(gl))
+         return;
+   }
+
    glBindBuffer(GL_PIXEL_PACK_BUFFER, gl->pbo_readback[gl->pbo_readback_index++]);
    glPixelStorei(GL_PACK_ALIGNMENT, 4);
    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
@@ -576,6 +769,8 @@ static void gl_core_destroy_resources(gl_core_t *gl)
       glDeleteProgram(gl->pipelines.alpha_blend);
    if (gl->pipelines.font)
       glDeleteProgram(gl->pipelines.font);
+   if (gl->pipelines.font_sdf)
+      glDeleteProgram(gl->pipelines.font_sdf);
    if (gl->pipelines.ribbon)
       glDeleteProgram(gl->pipelines.ribbon);
    if (gl->pipelines.ribbon_simple)
@@ -592,6 +787,7 @@ static void gl_core_destroy_resources(gl_core_t *gl)
    gl_core_free_scratch_vbos(gl);
 #endif
    gl_core_deinit_fences(gl);
+   gl_core_deinit_upload_ring(gl);
    gl_core_deinit_pbo_readback(gl);
    gl_core_deinit_hw_render(gl);
 }
@@ -878,6 +1074,10 @@ static bool gl_core_init_pipelines(gl_core_t *gl)
 #include "vulkan_shaders/font.frag.inc"
       ;
 
+   static const uint32_t font_sdf_frag[] =
+#include "vulkan_shaders/font_sdf.frag.inc"
+      ;
+
    static const uint32_t pipeline_ribbon_vert[] =
 #include "vulkan_shaders/pipeline_ribbon.vert.inc"
       ;
@@ -918,6 +1118,12 @@ static bool gl_core_init_pipelines(gl_core_t *gl)
    if (!gl->pipelines.font)
       return false;
 
+   gl->pipelines.font_sdf = gl_core_cross_compile_program(alpha_blend_vert, sizeof(alpha_blend_vert),
+                                                          font_sdf_frag, sizeof(font_sdf_frag),
+                                                          &gl->pipelines.font_sdf_loc, true);
+   if (!gl->pipelines.font_sdf)
+      return false;
+
    gl->pipelines.ribbon_simple = gl_core_cross_compile_program(pipeline_ribbon_simple_vert, sizeof(pipeline_ribbon_simple_vert),
                                                                pipeline_ribbon_simple_frag, sizeof(pipeline_ribbon_simple_frag),
                                                                &gl->pipelines.ribbon_simple_loc, true);
@@ -967,6 +1173,7 @@ static bool gl_core_init_default_filter_chain(gl_core_t *gl)
       return false;
    }
 
+   gl->filter_chain_is_stock = true;
    return true;
 }
 
@@ -984,6 +1191,7 @@ static bool gl_core_init_filter_chain_preset(gl_core_t *gl, const char *shader_p
       return false;
    }
 
+   gl->filter_chain_is_stock = false;
    return true;
 }
 
@@ -1338,6 +1546,11 @@ static void *gl_core_init(const video_info_t *video,
       RARCH_LOG("[GLCore]: Async PBO readback enabled.\n");
    }
 
+   gl->upload_ring_enable = gl_check_capability(GL_CAPS_BUFFER_STORAGE);
+   if (!gl->upload_ring_enable)
+      RARCH_LOG("[GLCore]: ARB_buffer_storage not available, "
+            "uploading textures from client memory.\n");
+
    if (!gl_check_error(&error_string))
    {
       RARCH_ERR("%s\n", error_string);
@@ -1373,7 +1586,7 @@ static unsigned gl_core_num_miplevels(unsigned width, unsigned height)
    return levels;
 }
 
-static void video_texture_load_gl_core(
+static void video_texture_load_gl_core(gl_core_t *gl,
       const struct texture_image *ti,
       enum texture_filter_type filter_type,
       uintptr_t *idptr)
@@ -1421,10 +1634,9 @@ static void video_texture_load_gl_core(
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
 
-   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                   ti->width, ti->height, GL_RGBA, GL_UNSIGNED_BYTE, ti->pixels);
+   gl_core_upload_texture(gl, ti->width, ti->height,
+         GL_RGBA, GL_UNSIGNED_BYTE, sizeof(uint32_t),
+         ti->width * sizeof(uint32_t), ti->pixels);
 
    if (levels > 1)
       glGenerateMipmap(GL_TEXTURE_2D);
@@ -1470,7 +1682,7 @@ static bool gl_core_overlay_load(void *data,
 
    for (i = 0; i < num_images; i++)
    {
-      video_texture_load_gl_core(&images[i], TEXTURE_FILTER_LINEAR, &id);
+      video_texture_load_gl_core(gl, &images[i], TEXTURE_FILTER_LINEAR, &id);
       gl->overlay_tex[i] = id;
 
       /* Default. Stretch to whole screen. */
@@ -1701,6 +1913,12 @@ static bool gl_core_read_viewport(void *data, uint8_t *buffer, bool is_idle)
       if (!gl->pbo_readback_valid[gl->pbo_readback_index])
          goto error;
 
+      /* Ring is rebuilt on the next frame, the caller
+       * has already sized its buffer for the new viewport */
+      if (  gl->vp.width  != (unsigned)ctx->in_width ||
+            gl->vp.height != (unsigned)ctx->in_height)
+         goto error;
+
       gl->pbo_readback_valid[gl->pbo_readback_index] = false;
       glBindBuffer(GL_PIXEL_PACK_BUFFER, gl->pbo_readback[gl->pbo_readback_index]);
 
@@ -1772,21 +1990,12 @@ static void gl_core_update_cpu_texture(gl_core_t *gl,
    else
       glBindTexture(GL_TEXTURE_2D, streamed->tex);
 
-   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
    if (gl->video_info.rgb32)
-   {
-      glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch >> 2);
-      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                      width, height, GL_RGBA, GL_UNSIGNED_BYTE, frame);
-   }
+      gl_core_upload_texture(gl, width, height,
+            GL_RGBA, GL_UNSIGNED_BYTE, sizeof(uint32_t), pitch, frame);
    else
-   {
-      glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch >> 1);
-      glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                      width, height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, frame);
-   }
+      gl_core_upload_texture(gl, width, height,
+            GL_RGB, GL_UNSIGNED_SHORT_5_6_5, sizeof(uint16_t), pitch, frame);
 }
 
 #if defined(HAVE_MENU)
@@ -1835,6 +2044,52 @@ static void gl_core_draw_menu_texture(gl_core_t *gl,
 }
 #endif
 
+/* With the stock shader and nothing drawn under or around
+ * the game, a HW frame can be blitted straight to the
+ * backbuffer instead of going through a shader pass.
+ * Integer upscales only look the same unfiltered. */
+static bool gl_core_can_direct_present(gl_core_t *gl,
+      unsigned width, unsigned height)
+{
+   /* FBOs are not shared, so the core's one is not
+    * usable from the frontend context */
+   if (     !gl->hw_render_enable
+         || gl->use_shared_context
+         || !gl->filter_chain_is_stock
+         || gl->rotation
+         || gl->overlay_enable
+         || gl->menu_texture_enable)
+      return false;
+
+   if (gl->vp.width == width && gl->vp.height == height)
+      return true;
+
+   return !gl->video_info.smooth
+      && (gl->vp.width  % width)  == 0
+      && (gl->vp.height % height) == 0;
+}
+
+static void gl_core_direct_present(gl_core_t *gl,
+      unsigned width, unsigned height)
+{
+   int dst_y0 = gl->vp.y;
+   int dst_y1 = gl->vp.y + gl->vp.height;
+
+   /* Top-left origin frames are upside down in GL terms */
+   if (!gl->hw_render_bottom_left)
+   {
+      dst_y0 = gl->vp.y + gl->vp.height;
+      dst_y1 = gl->vp.y;
+   }
+
+   glBindFramebuffer(GL_READ_FRAMEBUFFER, gl->hw_render_fbo);
+   glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+   glBlitFramebuffer(0, 0, width, height,
+         gl->vp.x, dst_y0, gl->vp.x + gl->vp.width, dst_y1,
+         GL_COLOR_BUFFER_BIT, GL_NEAREST);
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 static bool gl_core_frame(void *data, const void *frame,
       unsigned frame_width, unsigned frame_height,
       uint64_t frame_count,
@@ -1921,21 +2176,33 @@ static bool gl_core_frame(void *data, const void *frame,
       texture.padded_width  = streamed->width;
       texture.padded_height = streamed->height;
    }
-   gl_core_filter_chain_set_frame_count(gl->filter_chain, frame_count);
+   if (gl_core_can_direct_present(gl, texture.width, texture.height))
+   {
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+      glClear(GL_COLOR_BUFFER_BIT);
+      gl_core_direct_present(gl, texture.width, texture.height);
+      /* Later draws expect the viewport pass to have set this */
+      glViewport(gl->vp.x, gl->vp.y, gl->vp.width, gl->vp.height);
+   }
+   else
+   {
+      gl_core_filter_chain_set_frame_count(gl->filter_chain, frame_count);
 #ifdef HAVE_REWIND
-   gl_core_filter_chain_set_frame_direction(gl->filter_chain, state_manager_frame_is_reversed() ? -1 : 1);
+      gl_core_filter_chain_set_frame_direction(gl->filter_chain, state_manager_frame_is_reversed() ? -1 : 1);
 #else
-   gl_core_filter_chain_set_frame_direction(gl->filter_chain, 1);
+      gl_core_filter_chain_set_frame_direction(gl->filter_chain, 1);
 #endif
-   gl_core_filter_chain_set_input_texture(gl->filter_chain, &texture);
-   gl_core_filter_chain_build_offscreen_passes(gl->filter_chain, &gl->filter_chain_vp);
+      gl_core_filter_chain_set_input_texture(gl->filter_chain, &texture);
+      gl_core_filter_chain_build_offscreen_passes(gl->filter_chain, &gl->filter_chain_vp);
 
-   glBindFramebuffer(GL_FRAMEBUFFER, 0);
-   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-   glClear(GL_COLOR_BUFFER_BIT);
-   gl_core_filter_chain_build_viewport_pass(gl->filter_chain, &gl->filter_chain_vp,
-                                            gl->hw_render_bottom_left ? gl->mvp.data : gl->mvp_yflip.data);
-   gl_core_filter_chain_end_frame(gl->filter_chain);
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+      glClear(GL_COLOR_BUFFER_BIT);
+      gl_core_filter_chain_build_viewport_pass(gl->filter_chain, &gl->filter_chain_vp,
+                                               gl->hw_render_bottom_left ? gl->mvp.data : gl->mvp_yflip.data);
+      gl_core_filter_chain_end_frame(gl->filter_chain);
+   }
 
 #if defined(HAVE_MENU)
    if (gl->menu_texture_enable)
@@ -1989,6 +2256,8 @@ static bool gl_core_frame(void *data, const void *frame,
    }
 
 
+   gl_core_upload_ring_end_frame(gl);
+
    if (gl->ctx_driver->swap_buffers)
       gl->ctx_driver->swap_buffers(gl->ctx_data);
 
@@ -2081,8 +2350,8 @@ static int video_texture_load_wrap_gl_core_mipmap(void *data)
 
    if (!data)
       return 0;
-   video_texture_load_gl_core((struct texture_image*)data,
-         TEXTURE_FILTER_MIPMAP_LINEAR, &id);
+   video_texture_load_gl_core((gl_core_t*)video_driver_get_ptr(),
+         (struct texture_image*)data, TEXTURE_FILTER_MIPMAP_LINEAR, &id);
    return (int)id;
 }
 
@@ -2092,8 +2361,8 @@ static int video_texture_load_wrap_gl_core(void *data)
 
    if (!data)
       return 0;
-   video_texture_load_gl_core((struct texture_image*)data,
-         TEXTURE_FILTER_LINEAR, &id);
+   video_texture_load_gl_core((gl_core_t*)video_driver_get_ptr(),
+         (struct texture_image*)data, TEXTURE_FILTER_LINEAR, &id);
    return (int)id;
 }
 #endif
@@ -2125,7 +2394,8 @@ static uintptr_t gl_core_load_texture(void *video_data, void *data,
    }
 #endif
 
-   video_texture_load_gl_core((struct texture_image*)data, filter_type, &id);
+   video_texture_load_gl_core((gl_core_t*)video_data,
+         (struct texture_image*)data, filter_type, &id);
    return id;
 }
 
@@ -2187,12 +2457,9 @@ static void gl_core_set_texture_frame(void *data,
    glTexStorage2D(GL_TEXTURE_2D, 1, rgb32 
          ? GL_RGBA8 : GL_RGBA4, width, height);
 
-   glPixelStorei(GL_UNPACK_ALIGNMENT, base_size);
-   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                   width, height, GL_RGBA, rgb32 
-                   ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT_4_4_4_4, frame);
+   gl_core_upload_texture(gl, width, height, GL_RGBA, rgb32
+         ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT_4_4_4_4,
+         base_size, width * base_size, frame);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, menu_filter);
@@ -18,7 +18,9 @@
 #include <retro_miscellaneous.h>
 #include <retro_timers.h>
 #include <stdlib.h>
+#include <string.h>
 #include <compat/strl.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_NETWORKING
 #include <net/net_compat.h>
@@ -89,7 +91,7 @@ static void *network_gfx_init(const video_info_t *video,
    settings_t *settings                 = config_get_ptr();
    network_video_t *network             = (network_video_t*)calloc(1, sizeof(*network));
    bool video_font_enable               = settings->bools.video_font_enable;
-   const char *joypad_driver            = settings->arrays.joypad_driver;
+   const char *joypad_driver            = settings->arrays.input_joypad_driver;
 
    *input                               = NULL;
    *input_data                          = NULL;
@@ -105,7 +107,7 @@ static void *network_gfx_init(const video_info_t *video,
    gfx_ctx_network_input_driver(joypad_driver,
          input, input_data);
 
-   if (font_enable)
+   if (video_font_enable)
       font_driver_init_osd(network,
             video,
             false,
@@ -140,10 +142,6 @@ try_connect:
 
    network->fd = fd;
 
-#if 0
-   socket_nonblock(network->fd);
-#endif
-
    if (network->fd > 0)
       RARCH_LOG("[Network]: Connected to host.\n");
    else
@@ -153,6 +151,21 @@ try_connect:
       goto try_connect;
    }
 
+   /* Frames are dropped rather than stall the emulation
+    * when the link can't keep up */
+   socket_nonblock(network->fd);
+
+#ifdef HAVE_ZLIB
+   network->compression_backend = trans_stream_get_zlib_deflate_backend();
+   if (network->compression_backend)
+      network->compression_stream =
+         network->compression_backend->stream_new();
+   if (!network->compression_stream)
+      network->compression_backend = NULL;
+#endif
+
+   network->stats_time = cpu_features_get_time_usec();
+
    RARCH_LOG("[Network]: Init complete.\n");
 
    return network;
@@ -163,6 +176,172 @@ error:
    return NULL;
 }
 
+static void network_gfx_close(network_video_t *network)
+{
+   if (network->fd >= 0)
+      socket_close(network->fd);
+   network->fd = -1;
+}
+
+/* Sends what's left of the last frame, returns true once it's gone */
+static bool network_gfx_flush(network_video_t *network)
+{
+   ssize_t sent;
+
+   if (network->send_pos >= network->send_size)
+      return true;
+
+   sent = socket_send_all_nonblocking(network->fd,
+         network->send_buf + network->send_pos,
+         network->send_size - network->send_pos, true);
+
+   if (sent < 0)
+   {
+      RARCH_ERR("[Network]: Lost connection to host.\n");
+      network_gfx_close(network);
+      return false;
+   }
+
+   network->send_pos   += sent;
+   network->bytes_sent += sent;
+   return network->send_pos >= network->send_size;
+}
+
+static void network_gfx_log_stats(network_video_t *network)
+{
+   retro_time_t now     = cpu_features_get_time_usec();
+   retro_time_t elapsed = now - network->stats_time;
+
+   if (elapsed < NETWORK_VIDEO_STATS_USEC)
+      return;
+
+   RARCH_LOG("[Network]: %u frames sent (%.1f KB/s, %.2f ms to encode), "
+         "%u unchanged, %u dropped.\n",
+         network->frames_sent,
+         network->bytes_sent * 1000.0 / elapsed,
+         network->frames_sent
+         ? network->encode_time / 1000.0 / network->frames_sent : 0.0,
+         network->frames_unchanged, network->frames_dropped);
+
+   network->stats_time       = now;
+   network->encode_time      = 0;
+   network->bytes_sent       = 0;
+   network->frames_sent      = 0;
+   network->frames_unchanged = 0;
+   network->frames_dropped   = 0;
+}
+
+/**
+ * network_gfx_send_frame:
+ * @network              : network video handle
+ * @pixels               : 32-bit frame at the screen size
+ * @pixfmt               : its pixel format
+ *
+ * Queue a frame for sending as a delta against the last frame
+ * sent, compressed if we can.
+ **/
+static void network_gfx_send_frame(network_video_t *network,
+      const uint32_t *pixels, unsigned pixfmt)
+{
+   size_t i;
+   uint32_t rd, wn;
+   uint32_t *header;
+   retro_time_t start;
+   enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+   size_t count           = network->screen_width * network->screen_height;
+   size_t bytes           = count * sizeof(uint32_t);
+   size_t header_size     = NETWORK_VIDEO_HEADER_WORDS * sizeof(uint32_t);
+   const uint32_t *in     = pixels;
+   uint32_t flags         = 0;
+   uint32_t size          = (uint32_t)bytes;
+
+   /* Rather than queue up latency, skip frames while
+    * the link is busy with an earlier one */
+   if (!network_gfx_flush(network))
+   {
+      network->frames_dropped++;
+      return;
+   }
+
+   start = cpu_features_get_time_usec();
+
+   if (network->frame_bytes != bytes)
+   {
+      free(network->prev_frame);
+      free(network->delta_frame);
+      free(network->send_buf);
+      network->prev_frame  = (uint32_t*)malloc(bytes);
+      network->delta_frame = (uint32_t*)malloc(bytes);
+      network->send_buf    = (uint8_t*)malloc(header_size + bytes);
+      network->frame_bytes = 0;
+
+      if (!network->prev_frame || !network->delta_frame ||
+            !network->send_buf)
+         return;
+
+      network->frame_bytes = bytes;
+   }
+   else
+   {
+      if (!memcmp(network->prev_frame, pixels, bytes))
+      {
+         network->frames_unchanged++;
+         return;
+      }
+
+      for (i = 0; i < count; i++)
+         network->delta_frame[i] = pixels[i] ^ network->prev_frame[i];
+      in     = network->delta_frame;
+      flags |= NETWORK_VIDEO_FLAG_DELTA;
+   }
+
+   memcpy(network->prev_frame, pixels, bytes);
+
+   /* Compressed unless that doesn't fit in the raw size */
+   if (network->compression_backend)
+   {
+      network->compression_backend->set_in(network->compression_stream,
+            (const uint8_t*)in, (uint32_t)bytes);
+      network->compression_backend->set_out(network->compression_stream,
+            network->send_buf + header_size, (uint32_t)bytes);
+      if (network->compression_backend->trans(network->compression_stream,
+               true, &rd, &wn, &err) && err == TRANS_STREAM_ERROR_NONE)
+      {
+         flags |= NETWORK_VIDEO_FLAG_DEFLATE;
+         size   = wn;
+      }
+      else
+      {
+         /* Didn't finish, start over with a fresh stream */
+         network->compression_backend->stream_free(
+               network->compression_stream);
+         network->compression_stream =
+            network->compression_backend->stream_new();
+         if (!network->compression_stream)
+            network->compression_backend = NULL;
+      }
+   }
+
+   if (!(flags & NETWORK_VIDEO_FLAG_DEFLATE))
+      memcpy(network->send_buf + header_size, in, bytes);
+
+   header    = (uint32_t*)network->send_buf;
+   header[0] = htonl(NETWORK_VIDEO_MAGIC);
+   header[1] = htonl(network->frame_count++);
+   header[2] = htonl(network->screen_width);
+   header[3] = htonl(network->screen_height);
+   header[4] = htonl(pixfmt);
+   header[5] = htonl(flags);
+   header[6] = htonl(size);
+
+   network->send_size    = header_size + size;
+   network->send_pos     = 0;
+   network->encode_time += cpu_features_get_time_usec() - start;
+   network->frames_sent++;
+
+   network_gfx_flush(network);
+}
+
 static bool network_gfx_frame(void *data, const void *frame,
       unsigned frame_width, unsigned frame_height, uint64_t frame_count,
       unsigned pitch, const char *msg, video_frame_info_t *video_info)
@@ -332,10 +511,13 @@ static bool network_gfx_frame(void *data, const void *frame,
 
    if (draw && network->screen_width > 0 && network->screen_height > 0)
    {
-      if (network->fd > 0)
-         socket_send_all_blocking(network->fd, frame_to_copy, network->screen_width * network->screen_height * 4, true);
+      if (network->fd > 0 && frame_to_copy == network_video_temp_buf)
+         network_gfx_send_frame(network,
+               (const uint32_t*)frame_to_copy, pixfmt);
    }
 
+   network_gfx_log_stats(network);
+
    if (msg)
       font_driver_render_msg(network, msg, NULL, NULL);
 
@@ -379,11 +561,16 @@ static void network_gfx_free(void *data)
 
    font_driver_free_osd();
 
-   if (network->fd >= 0)
-      socket_close(network->fd);
+   network_gfx_close(network);
 
-   if (network)
-      free(network);
+   if (network->compression_stream)
+      network->compression_backend->stream_free(
+            network->compression_stream);
+
+   free(network->prev_frame);
+   free(network->delta_frame);
+   free(network->send_buf);
+   free(network);
 }
 
 static bool network_gfx_set_shader(void *data,
@@ -19,6 +19,8 @@
 #include <string.h>
 
 #include <compat/strl.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <formats/image.h>
@@ -122,6 +124,14 @@ static void vulkan_init_render_pass(
 
    vkCreateRenderPass(vk->context->device,
          &rp_info, NULL, &vk->render_pass);
+
+   /* Same pass for drawing on top of a frame that was
+    * copied into the backbuffer. The two are compatible,
+    * so pipelines and framebuffers work with either. */
+   attachment.loadOp            = VK_ATTACHMENT_LOAD_OP_LOAD;
+
+   vkCreateRenderPass(vk->context->device,
+         &rp_info, NULL, &vk->render_pass_load);
 }
 
 static void vulkan_init_framebuffers(
@@ -225,6 +235,10 @@ static void vulkan_init_pipelines(vk_t *vk)
 #include "vulkan_shaders/font.frag.inc"
       ;
 
+   static const uint32_t font_sdf_frag[] =
+#include "vulkan_shaders/font_sdf.frag.inc"
+      ;
+
    static const uint32_t pipeline_ribbon_vert[] =
 #include "vulkan_shaders/pipeline_ribbon.vert.inc"
       ;
@@ -392,6 +406,16 @@ static void vulkan_init_pipelines(vk_t *vk)
          1, &pipe, NULL, &vk->pipelines.font);
    vkDestroyShaderModule(vk->context->device, shader_stages[1].module, NULL);
 
+   /* Distance field glyph pipeline */
+   module_info.codeSize                 = sizeof(font_sdf_frag);
+   module_info.pCode                    = font_sdf_frag;
+   vkCreateShaderModule(vk->context->device,
+         &module_info, NULL, &shader_stages[1].module);
+
+   vkCreateGraphicsPipelines(vk->context->device, vk->pipelines.cache,
+         1, &pipe, NULL, &vk->pipelines.font_sdf);
+   vkDestroyShaderModule(vk->context->device, shader_stages[1].module, NULL);
+
    /* Alpha-blended pipeline. */
    module_info.codeSize   = sizeof(alpha_blend_frag);
    module_info.pCode      = alpha_blend_frag;
@@ -730,6 +754,8 @@ static void vulkan_deinit_pipelines(vk_t *vk)
          vk->pipelines.alpha_blend, NULL);
    vkDestroyPipeline(vk->context->device,
          vk->pipelines.font, NULL);
+   vkDestroyPipeline(vk->context->device,
+         vk->pipelines.font_sdf, NULL);
 
    for (i = 0; i < ARRAY_SIZE(vk->display.pipelines); i++)
       vkDestroyPipeline(vk->context->device,
@@ -755,6 +781,7 @@ static void vulkan_deinit_framebuffers(vk_t *vk)
    }
 
    vkDestroyRenderPass(vk->context->device, vk->render_pass, NULL);
+   vkDestroyRenderPass(vk->context->device, vk->render_pass_load, NULL);
 }
 
 static bool vulkan_init_default_filter_chain(vk_t *vk)
@@ -791,6 +818,7 @@ static bool vulkan_init_default_filter_chain(vk_t *vk)
       return false;
    }
 
+   vk->filter_chain_is_stock  = true;
    return true;
 }
 
@@ -825,6 +853,7 @@ static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
       return false;
    }
 
+   vk->filter_chain_is_stock  = false;
    return true;
 }
 
@@ -866,10 +895,88 @@ static void vulkan_init_resources(vk_t *vk)
    vulkan_init_command_buffers(vk);
 }
 
+/* The pipeline cache, which the shader filter chain shares, is
+ * kept in "<cache_directory>/vulkan/<pipelineCacheUUID>.bin" so
+ * presets don't have to rebuild every pipeline on launch */
+static bool vulkan_pipeline_cache_path(vk_t *vk, char *s, size_t len)
+{
+   unsigned i;
+   char name[2 * VK_UUID_SIZE + 5];
+   settings_t *settings = config_get_ptr();
+   const uint8_t *uuid  = vk->context->gpu_properties.pipelineCacheUUID;
+
+   if (string_is_empty(settings->paths.directory_cache))
+      return false;
+
+   for (i = 0; i < VK_UUID_SIZE; i++)
+      snprintf(name + 2 * i, 3, "%02x", (unsigned)uuid[i]);
+   strlcpy(name + 2 * VK_UUID_SIZE, ".bin", 5);
+
+   fill_pathname_join(s, settings->paths.directory_cache, "vulkan", len);
+   fill_pathname_join(s, s, name, len);
+   return true;
+}
+
+static uint32_t vulkan_read_le32(const uint8_t *data)
+{
+   return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+/* Some drivers don't cope with data from another device,
+ * check VkPipelineCacheHeaderVersionOne before handing it over */
+static bool vulkan_pipeline_cache_valid(vk_t *vk,
+      const uint8_t *data, int64_t len)
+{
+   const VkPhysicalDeviceProperties *props = &vk->context->gpu_properties;
+
+   if (len < 16 + VK_UUID_SIZE)
+      return false;
+
+   return vulkan_read_le32(data +  0) >= 16 + VK_UUID_SIZE
+      &&  vulkan_read_le32(data +  4) == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+      &&  vulkan_read_le32(data +  8) == props->vendorID
+      &&  vulkan_read_le32(data + 12) == props->deviceID
+      &&  !memcmp(data + 16, props->pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+static void vulkan_save_pipeline_cache(vk_t *vk)
+{
+   char path[PATH_MAX_LENGTH];
+   char dir[PATH_MAX_LENGTH];
+   size_t size = 0;
+   void *data  = NULL;
+
+   if (     vk->pipelines.cache == VK_NULL_HANDLE
+         || !vulkan_pipeline_cache_path(vk, path, sizeof(path)))
+      return;
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, NULL) != VK_SUCCESS || !size)
+      return;
+
+   if (!(data = malloc(size)))
+      return;
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, data) == VK_SUCCESS)
+   {
+      fill_pathname_basedir(dir, path, sizeof(dir));
+      if (     (path_is_directory(dir) || path_mkdir(dir))
+            && filestream_write_file(path, data, size))
+         RARCH_LOG("[Vulkan]: Saved %u bytes of pipeline cache.\n",
+               (unsigned)size);
+   }
+
+   free(data);
+}
+
 static void vulkan_init_static_resources(vk_t *vk)
 {
    unsigned i;
    uint32_t blank[4 * 4];
+   char cache_path[PATH_MAX_LENGTH];
+   void *cache_data                  = NULL;
+   int64_t cache_len                 = 0;
    VkCommandPoolCreateInfo pool_info = {
       VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
 
@@ -882,8 +989,31 @@ static void vulkan_init_static_resources(vk_t *vk)
    if (!vk->context)
       return;
 
-   vkCreatePipelineCache(vk->context->device,
-         &cache, NULL, &vk->pipelines.cache);
+   if (     vulkan_pipeline_cache_path(vk, cache_path, sizeof(cache_path))
+         && path_is_valid(cache_path)
+         && filestream_read_file(cache_path, &cache_data, &cache_len))
+   {
+      if (vulkan_pipeline_cache_valid(vk,
+               (const uint8_t*)cache_data, cache_len))
+      {
+         cache.initialDataSize = (size_t)cache_len;
+         cache.pInitialData    = cache_data;
+      }
+      else
+         RARCH_LOG("[Vulkan]: Pipeline cache is from another device or driver, ignoring it.\n");
+   }
+
+   if (vkCreatePipelineCache(vk->context->device,
+         &cache, NULL, &vk->pipelines.cache) != VK_SUCCESS
+         && cache.initialDataSize)
+   {
+      cache.initialDataSize = 0;
+      cache.pInitialData    = NULL;
+      vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->pipelines.cache);
+   }
+
+   free(cache_data);
 
    pool_info.queueFamilyIndex = vk->context->graphics_queue_index;
 
@@ -901,6 +1031,7 @@ static void vulkan_init_static_resources(vk_t *vk)
 static void vulkan_deinit_static_resources(vk_t *vk)
 {
    unsigned i;
+   vulkan_save_pipeline_cache(vk);
    vkDestroyPipelineCache(vk->context->device,
          vk->pipelines.cache, NULL);
    vulkan_destroy_texture(
@@ -1233,6 +1364,14 @@ static void *vulkan_init(const video_info_t *video,
       goto error;
    }
 
+   /* Whether the surface supports adaptive VSync
+    * (FIFO_RELAXED) is only known once it exists. */
+   if (     ctx_driver->swap_interval
+         && interval == 1
+         && video->adaptive_vsync
+         && video_driver_test_all_flags(GFX_CTX_FLAGS_ADAPTIVE_VSYNC))
+      ctx_driver->swap_interval(vk->ctx_data, -1);
+
    if (vk->ctx_driver->get_video_size)
       vk->ctx_driver->get_video_size(vk->ctx_data,
             &mode_width, &mode_height);
@@ -1712,6 +1851,188 @@ static void vulkan_inject_black_frame(vk_t *vk, video_frame_info_t *video_info,
       vk->ctx_driver->swap_buffers(context_data);
 }
 
+/**
+ * vulkan_update_frame_texture:
+ * @vk               : Vulkan driver.
+ * @chain            : per-frame resources to update.
+ * @width            : frame width.
+ * @height           : frame height.
+ *
+ * (Re)creates the persistently mapped texture software frames are
+ * written to. When the GPU cannot sample it directly it is a staging
+ * buffer and the device local texture_optimal image it is copied to
+ * with a single vkCmdCopyBufferToImage() is resized along with it.
+ *
+ * Both vulkan_frame() and vulkan_get_current_sw_framebuffer() must
+ * go through here, so a core rendering into the framebuffer gets
+ * exactly the memory the frame is uploaded from.
+ **/
+static void vulkan_update_frame_texture(vk_t *vk,
+      struct vk_per_frame *chain, unsigned width, unsigned height)
+{
+   if (     chain->texture.width  == width
+         && chain->texture.height == height)
+      return;
+
+   chain->texture = vulkan_create_texture(vk, &chain->texture,
+         width, height, chain->texture.format, NULL, NULL,
+         chain->texture_optimal.memory
+         ? VULKAN_TEXTURE_STAGING : VULKAN_TEXTURE_STREAMED);
+
+   {
+      struct vk_texture *texture = &chain->texture;
+      VK_MAP_PERSISTENT_TEXTURE(vk->context->device, texture);
+   }
+
+   if (chain->texture.type == VULKAN_TEXTURE_STAGING)
+      chain->texture_optimal = vulkan_create_texture(
+            vk,
+            &chain->texture_optimal,
+            width, height,
+            chain->texture_optimal.format,
+            NULL, NULL, VULKAN_TEXTURE_DYNAMIC);
+}
+
+/* With the stock shader and nothing drawn under the game,
+ * a HW frame can be blitted straight into the backbuffer
+ * instead of going through a shader pass.
+ * Integer upscales only look the same unfiltered. */
+static bool vulkan_can_direct_present(vk_t *vk,
+      unsigned width, unsigned height)
+{
+   VkFormatProperties src_props;
+   VkFormatProperties dst_props;
+
+   if (     !vk->hw.enable
+         || !vk->hw.image
+         || !vk->filter_chain_is_stock
+         || vk->rotation
+         || vk->overlay.enable
+         || vk->menu.enable
+         || !width || !height)
+      return false;
+
+   /* Blits are not clipped */
+   if (     vk->vp.x < 0
+         || vk->vp.y < 0
+         || vk->vp.x + vk->vp.width  > vk->context->swapchain_width
+         || vk->vp.y + vk->vp.height > vk->context->swapchain_height)
+      return false;
+
+   if (vk->vp.width != width || vk->vp.height != height)
+   {
+      if (     vk->video.smooth
+            || (vk->vp.width  % width)  != 0
+            || (vk->vp.height % height) != 0)
+         return false;
+   }
+
+   /* An sRGB view of a UNORM image would be decoded when
+    * sampled, but not when blitted */
+   switch (vk->hw.image->create_info.format)
+   {
+      case VK_FORMAT_R8G8B8A8_SRGB:
+      case VK_FORMAT_B8G8R8A8_SRGB:
+      case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+         return false;
+      default:
+         break;
+   }
+
+   vkGetPhysicalDeviceFormatProperties(vk->context->gpu,
+         vk->hw.image->create_info.format, &src_props);
+   vkGetPhysicalDeviceFormatProperties(vk->context->gpu,
+         vk->context->swapchain_format, &dst_props);
+
+   return (src_props.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT)
+      &&  (dst_props.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT);
+}
+
+/* Leaves the backbuffer in COLOR_ATTACHMENT_OPTIMAL */
+static void vulkan_direct_present(vk_t *vk,
+      struct vk_image *backbuffer,
+      unsigned width, unsigned height)
+{
+   VkImageBlit blit;
+   const VkClearColorValue clear_color     = {{ 0.0f, 0.0f, 0.0f, 0.0f }};
+   const VkImageSubresourceRange range     = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+   const struct retro_vulkan_image *image  = vk->hw.image;
+   VkImage src                             = image->create_info.image;
+   VkImageLayout src_layout                = 
+      image->image_layout == VK_IMAGE_LAYOUT_GENERAL
+      ? VK_IMAGE_LAYOUT_GENERAL
+      : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+   /* Chains onto the swapchain acquire and core semaphore
+    * waits, like the layout transitions for rendering */
+   VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, backbuffer->image,
+         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         0, VK_ACCESS_TRANSFER_WRITE_BIT,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT);
+   VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, src,
+         image->image_layout, src_layout,
+         0, VK_ACCESS_TRANSFER_READ_BIT,
+         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+   /* Black borders around the game */
+   if (     vk->vp.width  != vk->context->swapchain_width
+         || vk->vp.height != vk->context->swapchain_height)
+   {
+      vkCmdClearColorImage(vk->cmd, backbuffer->image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            &clear_color, 1, &range);
+      VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, backbuffer->image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT);
+   }
+
+   blit.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+   blit.srcSubresource.mipLevel       = 
+      image->create_info.subresourceRange.baseMipLevel;
+   blit.srcSubresource.baseArrayLayer = 
+      image->create_info.subresourceRange.baseArrayLayer;
+   blit.srcSubresource.layerCount     = 1;
+   blit.srcOffsets[0].x               = 0;
+   blit.srcOffsets[0].y               = 0;
+   blit.srcOffsets[0].z               = 0;
+   blit.srcOffsets[1].x               = width;
+   blit.srcOffsets[1].y               = height;
+   blit.srcOffsets[1].z               = 1;
+   blit.dstSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+   blit.dstSubresource.mipLevel       = 0;
+   blit.dstSubresource.baseArrayLayer = 0;
+   blit.dstSubresource.layerCount     = 1;
+   blit.dstOffsets[0].x               = vk->vp.x;
+   blit.dstOffsets[0].y               = vk->vp.y;
+   blit.dstOffsets[0].z               = 0;
+   blit.dstOffsets[1].x               = vk->vp.x + vk->vp.width;
+   blit.dstOffsets[1].y               = vk->vp.y + vk->vp.height;
+   blit.dstOffsets[1].z               = 1;
+
+   vkCmdBlitImage(vk->cmd,
+         src, src_layout,
+         backbuffer->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         1, &blit, VK_FILTER_NEAREST);
+
+   VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, src,
+         src_layout, image->image_layout,
+         0, 0,
+         VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+   VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, backbuffer->image,
+         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+         VK_ACCESS_TRANSFER_WRITE_BIT,
+         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+}
+
 static bool vulkan_frame(void *data, const void *frame,
       unsigned frame_width, unsigned frame_height,
       uint64_t frame_count,
@@ -1725,6 +2046,7 @@ static bool vulkan_frame(void *data, const void *frame,
    VkSemaphore signal_semaphores[2];
    vk_t *vk                                      = (vk_t*)data;
    bool waits_for_semaphores                     = false;
+   bool direct_present                           = false;
    unsigned width                                = video_info->width;
    unsigned height                               = video_info->height;
    bool statistics_show                          = video_info->statistics_show;
@@ -1757,6 +2079,7 @@ static bool vulkan_frame(void *data, const void *frame,
 
    vk->chain                                     = chain;
    vk->backbuffer                                = backbuffer;
+   vk->context->present_frame_count              = frame_count;
 
    VK_DESCRIPTOR_MANAGER_RESTART(manager);
    VK_BUFFER_CHAIN_DISCARD(buff_chain_vbo);
@@ -1816,28 +2139,10 @@ static bool vulkan_frame(void *data, const void *frame,
       const uint8_t *src  = (const uint8_t*)frame;
       unsigned bpp        = vk->video.rgb32 ? 4 : 2;
 
-      if (     chain->texture.width  != frame_width
-            || chain->texture.height != frame_height)
-      {
-         chain->texture = vulkan_create_texture(vk, &chain->texture,
-               frame_width, frame_height, chain->texture.format, NULL, NULL,
-               chain->texture_optimal.memory
-               ? VULKAN_TEXTURE_STAGING : VULKAN_TEXTURE_STREAMED);
-
-         {
-            struct vk_texture *texture = &chain->texture;
-            VK_MAP_PERSISTENT_TEXTURE(vk->context->device, texture);
-         }
-
-         if (chain->texture.type == VULKAN_TEXTURE_STAGING)
-            chain->texture_optimal = vulkan_create_texture(
-                  vk,
-                  &chain->texture_optimal,
-                  frame_width, frame_height,
-                  chain->texture_optimal.format,
-                  NULL, NULL, VULKAN_TEXTURE_DYNAMIC);
-      }
+      vulkan_update_frame_texture(vk, chain, frame_width, frame_height);
 
+      /* Cores rendering through GET_CURRENT_SOFTWARE_FRAMEBUFFER
+       * already wrote into the mapped texture, nothing to copy. */
       if (frame != chain->texture.mapped)
       {
          dst = (uint8_t*)chain->texture.mapped;
@@ -1952,9 +2257,13 @@ static bool vulkan_frame(void *data, const void *frame,
 
    vulkan_set_viewport(vk, width, height, false, true);
 
-   vulkan_filter_chain_build_offscreen_passes(
-         (vulkan_filter_chain_t*)vk->filter_chain,
-         vk->cmd, &vk->vk_vp);
+   direct_present = vulkan_can_direct_present(vk,
+         vk->hw.last_width, vk->hw.last_height);
+
+   if (!direct_present)
+      vulkan_filter_chain_build_offscreen_passes(
+            (vulkan_filter_chain_t*)vk->filter_chain,
+            vk->cmd, &vk->vk_vp);
 
 #if defined(HAVE_MENU)
    /* Upload menu texture. */
@@ -2002,19 +2311,30 @@ static bool vulkan_frame(void *data, const void *frame,
       clear_color.color.float32[2]     = 0.0f;
       clear_color.color.float32[3]     = 0.0f;
 
-      /* Prepare backbuffer for rendering. */
-      VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, backbuffer->image,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+      if (direct_present)
+      {
+         /* Draw everything else on top of the copied frame */
+         vulkan_direct_present(vk, backbuffer,
+               vk->hw.last_width, vk->hw.last_height);
+         rp_info.renderPass            = vk->render_pass_load;
+      }
+      else
+      {
+         /* Prepare backbuffer for rendering. */
+         VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, backbuffer->image,
+               VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+               0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
+               VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+               VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+      }
 
       /* Begin render pass and set up viewport */
       vkCmdBeginRenderPass(vk->cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
 
-      vulkan_filter_chain_build_viewport_pass(
-            (vulkan_filter_chain_t*)vk->filter_chain, vk->cmd,
-            &vk->vk_vp, vk->mvp.data);
+      if (!direct_present)
+         vulkan_filter_chain_build_viewport_pass(
+               (vulkan_filter_chain_t*)vk->filter_chain, vk->cmd,
+               &vk->vk_vp, vk->mvp.data);
 
 #if defined(HAVE_MENU)
       if (vk->menu.enable)
@@ -2352,28 +2672,14 @@ static bool vulkan_get_current_sw_framebuffer(void *data,
       &vk->swapchain[vk->context->current_frame_index];
    chain                      = vk->chain;
 
-   if (chain->texture.width != framebuffer->width ||
-         chain->texture.height != framebuffer->height)
-   {
-      chain->texture   = vulkan_create_texture(vk, &chain->texture,
-            framebuffer->width, framebuffer->height, chain->texture.format,
-            NULL, NULL, VULKAN_TEXTURE_STREAMED);
-      {
-         struct vk_texture *texture = &chain->texture;
-         VK_MAP_PERSISTENT_TEXTURE(vk->context->device, texture);
-      }
+   if (vk->hw.enable || !framebuffer->width || !framebuffer->height)
+      return false;
 
-      if (chain->texture.type == VULKAN_TEXTURE_STAGING)
-      {
-         chain->texture_optimal = vulkan_create_texture(
-               vk,
-               &chain->texture_optimal,
-               framebuffer->width,
-               framebuffer->height,
-               chain->texture_optimal.format,
-               NULL, NULL, VULKAN_TEXTURE_DYNAMIC);
-      }
-   }
+   vulkan_update_frame_texture(vk, chain,
+         framebuffer->width, framebuffer->height);
+
+   if (!chain->texture.mapped)
+      return false;
 
    framebuffer->data         = chain->texture.mapped;
    framebuffer->pitch        = chain->texture.stride;
@@ -2681,6 +2987,25 @@ static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
          if (staging->memory == VK_NULL_HANDLE)
             return false;
 
+         /* This frame's staging buffer was filled before the
+          * viewport was resized, skip it rather than reading
+          * it back at the wrong size. */
+         if (  staging->width  != vk->vp.width ||
+               staging->height != vk->vp.height)
+            return false;
+
+         if (  (unsigned)ctx->in_width  != vk->vp.width ||
+               (unsigned)ctx->in_height != vk->vp.height)
+         {
+            ctx->in_width   = vk->vp.width;
+            ctx->in_height  = vk->vp.height;
+            ctx->out_width  = vk->vp.width;
+            ctx->out_height = vk->vp.height;
+
+            if (!scaler_ctx_gen_filter(ctx))
+               return false;
+         }
+
          buffer += 3 * (vk->vp.height - 1) * vk->vp.width;
          vkMapMemory(vk->context->device, staging->memory,
                staging->offset, staging->size, 0, (void**)&src);
@@ -0,0 +1,15 @@
+#version 310 es
+precision highp float;
+layout(location = 0) in vec2 vTexCoord;
+layout(location = 1) in vec4 vColor;
+layout(location = 0) out vec4 FragColor;
+layout(set = 0, binding = 1) uniform highp sampler2D uTex;
+
+void main()
+{
+   // Distance field, the glyph edge is at 0.5. Smooth over
+   // the width of about one screen pixel for anti-aliasing.
+   float dist  = texture(uTex, vTexCoord).x;
+   float width = max(fwidth(dist) * 0.7, 1.0 / 255.0);
+   FragColor   = vec4(vColor.rgb, vColor.a * smoothstep(0.5 - width, 0.5 + width, dist));
+}
@@ -246,12 +246,16 @@ static void gfx_ctx_khr_display_swap_buffers(void *data)
 
 static uint32_t gfx_ctx_khr_display_get_flags(void *data)
 {
-   uint32_t flags = 0;
+   uint32_t flags              = 0;
+   khr_display_ctx_data_t *khr = (khr_display_ctx_data_t*)data;
 
 #if defined(HAVE_SLANG) && defined(HAVE_SPIRV_CROSS)
    BIT32_SET(flags, GFX_CTX_FLAGS_SHADERS_SLANG);
 #endif
 
+   if (khr && khr->vk.adaptive_vsync)
+      BIT32_SET(flags, GFX_CTX_FLAGS_ADAPTIVE_VSYNC);
+
    return flags;
 }
 
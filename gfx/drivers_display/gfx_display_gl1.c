@@ -213,5 +213,6 @@ gfx_display_ctx_driver_t gfx_display_ctx_gl1 = {
    "gl1",
    false,
    gfx_display_gl1_scissor_begin,
-   gfx_display_gl1_scissor_end
+   gfx_display_gl1_scissor_end,
+   true                                   /* supports_batching */
 };
@@ -51,6 +51,7 @@ typedef struct
    struct font_atlas *atlas;
 
    video_font_raster_block_t *block;
+   bool sdf;
 } gl_core_raster_t;
 
 static void gl_core_raster_font_free_font(void *data,
@@ -97,10 +98,39 @@ static bool gl_core_raster_font_upload_atlas(gl_core_raster_t *font)
    return true;
 }
 
+/* Uploads what changed since the last upload, newly
+ * rasterised glyphs are usually a small part of the atlas */
+static void gl_core_raster_font_update_atlas(gl_core_raster_t *font)
+{
+   struct font_atlas *atlas = font->atlas;
+
+   if (!atlas->dirty_width || !atlas->dirty_height)
+   {
+      gl_core_raster_font_upload_atlas(font);
+      font_atlas_clear_dirty(atlas);
+      return;
+   }
+
+   glBindTexture(GL_TEXTURE_2D, font->tex);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, atlas->width);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   glTexSubImage2D(GL_TEXTURE_2D, 0,
+         atlas->dirty_x, atlas->dirty_y,
+         atlas->dirty_width, atlas->dirty_height,
+         GL_RED, GL_UNSIGNED_BYTE,
+         atlas->buffer + atlas->dirty_y * atlas->width + atlas->dirty_x);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glBindTexture(GL_TEXTURE_2D, 0);
+
+   font_atlas_clear_dirty(atlas);
+}
+
 static void *gl_core_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
 {
+   settings_t *settings   = config_get_ptr();
    gl_core_raster_t *font = (gl_core_raster_t*)calloc(1, sizeof(*font));
 
    if (!font)
@@ -108,7 +138,12 @@ static void *gl_core_raster_font_init_font(void *data,
 
    font->gl = (gl_core_t*)data;
 
-   if (!font_renderer_create_default(
+   if (settings->bools.video_font_sdf_enable
+         && font_renderer_create_sdf(
+            &font->font_driver,
+            &font->font_data, font_path, font_size))
+      font->sdf = true;
+   else if (!font_renderer_create_default(
             &font->font_driver,
             &font->font_data, font_path, font_size))
    {
@@ -129,7 +164,7 @@ static void *gl_core_raster_font_init_font(void *data,
    if (!gl_core_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font_atlas_clear_dirty(font->atlas);
    return font;
 
 error:
@@ -164,25 +199,28 @@ static int gl_core_get_message_width(void *data, const char *msg,
       delta_x += glyph->advance_x;
    }
 
-   return delta_x * scale;
+   return delta_x * scale * FONT_ATLAS_GLYPH_SCALE(font->atlas);
 }
 
 static void gl_core_raster_font_draw_vertices(gl_core_raster_t *font,
       const video_coords_t *coords)
 {
    if (font->atlas->dirty)
-   {
-      gl_core_raster_font_upload_atlas(font);
-      font->atlas->dirty   = false;
-   }
+      gl_core_raster_font_update_atlas(font);
 
    glActiveTexture(GL_TEXTURE1);
    glBindTexture(GL_TEXTURE_2D, font->tex);
 
-   if (  font->gl &&
-         font->gl->pipelines.font_loc.flat_ubo_vertex >= 0)
-      glUniform4fv(font->gl->pipelines.font_loc.flat_ubo_vertex,
-                   4, font->gl->mvp_no_rot.data);
+   if (font->gl)
+   {
+      const struct gl_core_buffer_locations *loc = font->sdf
+         ? &font->gl->pipelines.font_sdf_loc
+         : &font->gl->pipelines.font_loc;
+
+      if (loc->flat_ubo_vertex >= 0)
+         glUniform4fv(loc->flat_ubo_vertex,
+                      4, font->gl->mvp_no_rot.data);
+   }
 
    glEnableVertexAttribArray(0);
    glEnableVertexAttribArray(1);
@@ -236,6 +274,8 @@ static void gl_core_raster_font_render_line(
          break;
    }
 
+   scale *= FONT_ATLAS_GLYPH_SCALE(font->atlas);
+
    while (msg < msg_end)
    {
       i = 0;
@@ -335,7 +375,8 @@ static void gl_core_raster_font_setup_viewport(unsigned width, unsigned height,
    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
    glBlendEquation(GL_FUNC_ADD);
    if (font->gl)
-      glUseProgram(font->gl->pipelines.font);
+      glUseProgram(font->sdf
+            ? font->gl->pipelines.font_sdf : font->gl->pipelines.font);
 }
 
 static void gl_core_raster_font_render_msg(
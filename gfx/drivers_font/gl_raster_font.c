@@ -118,6 +118,21 @@ static bool gl_raster_font_upload_atlas_components_4(gl_raster_t *font)
 }
 #endif
 
+/* Whether the atlas is stored as GL_R8 instead of
+ * GL_LUMINANCE_ALPHA, which core contexts do not have */
+static bool gl_raster_font_atlas_is_r8(gl_raster_t *font)
+{
+#if defined(GL_VERSION_3_0)
+   struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
+
+   if ((font->gl && font->gl->core_context_in_use) ||
+         (hwr->context_type == RETRO_HW_CONTEXT_OPENGL &&
+          hwr->version_major >= 3))
+      return true;
+#endif
+   return false;
+}
+
 static bool gl_raster_font_upload_atlas(gl_raster_t *font)
 {
    unsigned i, j;
@@ -126,11 +141,7 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    size_t ncomponents                   = 2;
    uint8_t       *tmp                   = NULL;
 #if defined(GL_VERSION_3_0)
-   struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
-
-   if ((font->gl && font->gl->core_context_in_use) ||
-         (hwr->context_type == RETRO_HW_CONTEXT_OPENGL &&
-          hwr->version_major >= 3))
+   if (gl_raster_font_atlas_is_r8(font))
    {
       GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
       glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
@@ -178,6 +189,61 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    return true;
 }
 
+/* Uploads what changed since the last upload, newly
+ * rasterised glyphs are usually a small part of the atlas */
+static void gl_raster_font_update_atlas(gl_raster_t *font)
+{
+   unsigned i, j;
+   GLenum gl_format         = GL_LUMINANCE_ALPHA;
+   size_t ncomponents       = 2;
+   struct font_atlas *atlas = font->atlas;
+   unsigned width           = atlas->dirty_width;
+   unsigned height          = atlas->dirty_height;
+   uint8_t *tmp             = NULL;
+
+#if defined(GL_VERSION_3_0)
+   if (gl_raster_font_atlas_is_r8(font))
+   {
+      gl_format   = GL_RED;
+      ncomponents = 1;
+   }
+#endif
+
+   if (!width || !height
+         || !(tmp = (uint8_t*)malloc(width * height * ncomponents)))
+   {
+      gl_raster_font_upload_atlas(font);
+      font_atlas_clear_dirty(atlas);
+      return;
+   }
+
+   for (i = 0; i < height; i++)
+   {
+      const uint8_t *src = &atlas->buffer[
+         (atlas->dirty_y + i) * atlas->width + atlas->dirty_x];
+      uint8_t       *dst = &tmp[i * width * ncomponents];
+
+      if (ncomponents == 1)
+         memcpy(dst, src, width);
+      else
+      {
+         for (j = 0; j < width; j++)
+         {
+            *dst++ = 0xff;
+            *dst++ = *src++;
+         }
+      }
+   }
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, atlas->dirty_x, atlas->dirty_y,
+         width, height, gl_format, GL_UNSIGNED_BYTE, tmp);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+   free(tmp);
+   font_atlas_clear_dirty(atlas);
+}
+
 static void *gl_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -216,7 +282,7 @@ static void *gl_raster_font_init_font(void *data,
    if (!gl_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font_atlas_clear_dirty(font->atlas);
 
    if (font->gl)
       glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
@@ -264,10 +330,7 @@ static void gl_raster_font_draw_vertices(gl_raster_t *font,
       const video_coords_t *coords)
 {
    if (font->atlas->dirty)
-   {
-      gl_raster_font_upload_atlas(font);
-      font->atlas->dirty   = false;
-   }
+      gl_raster_font_update_atlas(font);
 
    if (font->gl && font->gl->shader)
    {
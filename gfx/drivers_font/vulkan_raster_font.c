@@ -42,19 +42,45 @@ typedef struct
 static INLINE void vulkan_raster_font_update_glyph(
       vulkan_raster_t *font, const struct font_glyph *glyph)
 {
-   if(font->atlas->dirty)
+   unsigned row, x, y, width, height;
+   struct font_atlas *atlas = font->atlas;
+
+   if (!atlas->dirty)
+      return;
+
+   if (atlas->dirty_width && atlas->dirty_height)
    {
-      unsigned row;
-      for (row = glyph->atlas_offset_y; row < (glyph->atlas_offset_y + glyph->height); row++)
-      {
-         uint8_t *src = font->atlas->buffer + row * font->atlas->width + glyph->atlas_offset_x;
-         uint8_t *dst = (uint8_t*)font->texture.mapped + row * font->texture.stride + glyph->atlas_offset_x;
-         memcpy(dst, src, glyph->width);
-      }
+      x      = atlas->dirty_x;
+      y      = atlas->dirty_y;
+      width  = atlas->dirty_width;
+      height = atlas->dirty_height;
+   }
+   else if (atlas->sdf)
+   {
+      /* Distance field atlases are shared with other fonts,
+       * which may have changed other glyphs than this one */
+      x      = 0;
+      y      = 0;
+      width  = atlas->width;
+      height = atlas->height;
+   }
+   else
+   {
+      x      = glyph->atlas_offset_x;
+      y      = glyph->atlas_offset_y;
+      width  = glyph->width;
+      height = glyph->height;
+   }
 
-      font->atlas->dirty = false;
-      font->needs_update = true;
+   for (row = y; row < y + height; row++)
+   {
+      uint8_t *src = atlas->buffer + row * atlas->width + x;
+      uint8_t *dst = (uint8_t*)font->texture.mapped + row * font->texture.stride + x;
+      memcpy(dst, src, width);
    }
+
+   font_atlas_clear_dirty(atlas);
+   font->needs_update = true;
 }
 
 
@@ -92,12 +118,18 @@ static void *vulkan_raster_font_init_font(void *data,
    };
 #endif
 
+   settings_t *settings           = config_get_ptr();
+
    if (!font)
       return NULL;
 
    font->vk = (vk_t*)data;
 
-   if (!font_renderer_create_default(
+   if (!(settings->bools.video_font_sdf_enable
+         && font_renderer_create_sdf(
+            &font->font_driver,
+            &font->font_data, font_path, font_size))
+         && !font_renderer_create_default(
             &font->font_driver,
             &font->font_data, font_path, font_size))
    {
@@ -154,7 +186,7 @@ static int vulkan_get_message_width(void *data, const char *msg,
       }
    }
 
-   return delta_x * scale;
+   return delta_x * scale * FONT_ATLAS_GLYPH_SCALE(font->atlas);
 }
 
 static void vulkan_raster_font_render_line(
@@ -189,6 +221,8 @@ static void vulkan_raster_font_render_line(
          break;
    }
 
+   scale *= FONT_ATLAS_GLYPH_SCALE(font->atlas);
+
    while (msg < msg_end)
    {
       int off_x, off_y, tex_x, tex_y, width, height;
@@ -280,7 +314,8 @@ static void vulkan_raster_font_flush(vulkan_raster_t *font)
 {
    struct vk_draw_triangles call;
 
-   call.pipeline     = font->vk->pipelines.font;
+   call.pipeline     = font->atlas->sdf
+      ? font->vk->pipelines.font_sdf : font->vk->pipelines.font;
    call.texture      = &font->texture_optimal;
    call.sampler      = font->vk->samplers.mipmap_linear;
    call.uniform      = &font->vk->mvp;
@@ -71,6 +71,7 @@ typedef struct freetype_renderer
    unsigned max_glyph_width;
    unsigned max_glyph_height;
    unsigned usage_counter;
+   unsigned slots_used;
    struct font_line_metrics line_metrics;            /* float alignment */
 } ft_font_renderer_t;
 
@@ -102,6 +103,10 @@ static freetype_atlas_slot_t* font_renderer_get_slot(ft_font_renderer_t *handle)
    int i, map_id;
    unsigned oldest = 0;
 
+   /* Hand out unused slots before evicting anything */
+   if (handle->slots_used < FT_ATLAS_SIZE)
+      return &handle->atlas_slots[handle->slots_used++];
+
    for (i = 1; i < FT_ATLAS_SIZE; i++)
       if ((handle->usage_counter - handle->atlas_slots[i].last_used) >
          (handle->usage_counter - handle->atlas_slots[oldest].last_used))
@@ -202,7 +207,9 @@ static const struct font_glyph *font_renderer_ft_get_glyph(
       }
    }
 
-   handle->atlas.dirty = true;
+   font_atlas_mark_dirty(&handle->atlas,
+         atlas_slot->glyph.atlas_offset_x, atlas_slot->glyph.atlas_offset_y,
+         handle->max_glyph_width, handle->max_glyph_height);
    atlas_slot->last_used = handle->usage_counter++;
    return &atlas_slot->glyph;
 }
@@ -241,13 +248,11 @@ static bool font_renderer_create_atlas(ft_font_renderer_t *handle, float font_si
       }
    }
 
-   for (i = 0; i < 256; i++)
+   /* Only printable ASCII up front, everything else is
+    * rasterised on first use */
+   for (i = 32; i < 127; i++)
       font_renderer_ft_get_glyph(handle, i);
 
-   for (i = 0; i < 256; i++)
-      if (ISALNUM(i))
-         font_renderer_ft_get_glyph(handle, i);
-
    return true;
 }
 
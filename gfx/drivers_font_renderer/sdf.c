@@ -0,0 +1,591 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Signed distance field atlases.
+ *
+ * Glyphs are rasterised once at FONT_SDF_SIZE by one of the
+ * regular renderers and converted to a distance field, which
+ * font drivers can draw sharply at any size. All fonts using
+ * the same font file share one atlas, and a few atlases stay
+ * cached after their last font is freed, so recreating the
+ * menu fonts after a resolution or scale change does not
+ * rasterise anything again. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <compat/strl.h>
+#include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "../font_driver.h"
+
+#define SDF_ATLAS_ROWS 16
+#define SDF_ATLAS_COLS 16
+#define SDF_ATLAS_SIZE (SDF_ATLAS_ROWS * SDF_ATLAS_COLS)
+
+/* Glyphs larger than this are clipped, 1.25em covers
+ * everything but the widest symbols */
+#define SDF_CELL_SIZE  (FONT_SDF_SIZE + FONT_SDF_SIZE / 4 + 2 * FONT_SDF_SPREAD)
+
+/* Atlases kept around without any font using them */
+#define SDF_CACHE_SIZE 4
+
+#define SDF_INF        1e20f
+
+typedef struct sdf_atlas_slot
+{
+   struct sdf_atlas_slot *next;        /* ptr alignment */
+   struct font_glyph glyph;            /* unsigned alignment */
+   unsigned charcode;
+   unsigned last_used;
+} sdf_atlas_slot_t;
+
+/* One atlas per font file */
+typedef struct sdf_face
+{
+   struct sdf_face *next;                         /* ptr alignment */
+   const font_renderer_driver_t *base_driver;
+   void *base_data;
+   uint8_t *buffer;
+   sdf_atlas_slot_t *uc_map[0x100];
+   sdf_atlas_slot_t slots[SDF_ATLAS_SIZE];
+   char path[PATH_MAX_LENGTH];
+   /* Scratch space of the distance transform */
+   float outer[SDF_CELL_SIZE * SDF_CELL_SIZE];
+   float inner[SDF_CELL_SIZE * SDF_CELL_SIZE];
+   float f[SDF_CELL_SIZE];
+   float d[SDF_CELL_SIZE];
+   float z[SDF_CELL_SIZE + 1];
+   int v[SDF_CELL_SIZE];
+   unsigned width;
+   unsigned height;
+   unsigned usage_counter;
+   /* Bumped whenever texels of the atlas change */
+   unsigned generation;
+   unsigned refcount;
+   struct font_line_metrics line_metrics;         /* float alignment */
+   bool has_line_metrics;
+} sdf_face_t;
+
+/* One per font size */
+typedef struct sdf_font
+{
+   sdf_face_t *face;
+   struct font_atlas atlas;
+   unsigned generation;
+   struct font_line_metrics line_metrics;
+} sdf_font_t;
+
+static sdf_face_t *sdf_faces = NULL;
+#ifdef HAVE_THREADS
+static slock_t *sdf_faces_lock = NULL;
+#endif
+
+/* 1D squared distance transform, Felzenszwalb & Huttenlocher */
+static void sdf_edt_1d(sdf_face_t *face, float *grid,
+      unsigned offset, unsigned stride, unsigned length)
+{
+   unsigned q;
+   int k      = 0;
+   float *f   = face->f;
+   float *d   = face->d;
+   float *z   = face->z;
+   int *v     = face->v;
+
+   for (q = 0; q < length; q++)
+      f[q]    = grid[offset + q * stride];
+
+   v[0]       = 0;
+   z[0]       = -SDF_INF;
+   z[1]       = SDF_INF;
+
+   for (q = 1; q < length; q++)
+   {
+      float s;
+
+      do
+      {
+         int r = v[k];
+         s     = (f[q] - f[r] + (float)(q * q) - (float)(r * r))
+               / (float)(2 * ((int)q - r));
+      } while (s <= z[k] && --k >= 0);
+
+      k++;
+      v[k]     = q;
+      z[k]     = s;
+      z[k + 1] = SDF_INF;
+   }
+
+   for (q = 0, k = 0; q < length; q++)
+   {
+      float dq;
+
+      while (z[k + 1] < (float)q)
+         k++;
+
+      dq   = (float)q - (float)v[k];
+      d[q] = dq * dq + f[v[k]];
+   }
+
+   for (q = 0; q < length; q++)
+      grid[offset + q * stride] = d[q];
+}
+
+static void sdf_edt_2d(sdf_face_t *face, float *grid,
+      unsigned width, unsigned height)
+{
+   unsigned i;
+
+   for (i = 0; i < width; i++)
+      sdf_edt_1d(face, grid, i, width, height);
+   for (i = 0; i < height; i++)
+      sdf_edt_1d(face, grid, i * width, 1, width);
+}
+
+/* Converts a coverage bitmap into a distance field of
+ * (width + 2 * FONT_SDF_SPREAD) x (height + 2 * FONT_SDF_SPREAD).
+ * Partially covered pixels seed the transform with their
+ * sub-pixel distance to the edge, which keeps the result
+ * smooth even at a small rasterisation size. */
+static void sdf_render_glyph(sdf_face_t *face,
+      const uint8_t *src, unsigned src_pitch,
+      unsigned width, unsigned height,
+      uint8_t *dst, unsigned dst_pitch)
+{
+   unsigned x, y;
+   unsigned out_width  = width  + 2 * FONT_SDF_SPREAD;
+   unsigned out_height = height + 2 * FONT_SDF_SPREAD;
+   unsigned size       = out_width * out_height;
+
+   for (y = 0; y < size; y++)
+   {
+      face->outer[y] = SDF_INF;
+      face->inner[y] = 0.0f;
+   }
+
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
+      {
+         unsigned idx = (y + FONT_SDF_SPREAD) * out_width
+            + x + FONT_SDF_SPREAD;
+         float a      = src[y * src_pitch + x] / 255.0f;
+
+         if (a <= 0.0f)
+            continue;
+
+         if (a >= 1.0f)
+         {
+            face->outer[idx] = 0.0f;
+            face->inner[idx] = SDF_INF;
+         }
+         else
+         {
+            float d          = 0.5f - a;
+            face->outer[idx] = d > 0.0f ? d * d : 0.0f;
+            face->inner[idx] = d < 0.0f ? d * d : 0.0f;
+         }
+      }
+   }
+
+   sdf_edt_2d(face, face->outer, out_width, out_height);
+   sdf_edt_2d(face, face->inner, out_width, out_height);
+
+   for (y = 0; y < out_height; y++)
+   {
+      for (x = 0; x < out_width; x++)
+      {
+         unsigned idx = y * out_width + x;
+         float dist   = (float)sqrt(face->outer[idx])
+            - (float)sqrt(face->inner[idx]);
+         float value  = 128.0f - dist * (127.0f / FONT_SDF_SPREAD);
+
+         dst[y * dst_pitch + x] = (uint8_t)(value < 0.0f
+               ? 0 : value > 255.0f ? 255 : (value + 0.5f));
+      }
+   }
+}
+
+static sdf_atlas_slot_t *sdf_face_get_slot(sdf_face_t *face)
+{
+   unsigned i, map_id;
+   unsigned oldest = 0;
+
+   for (i = 1; i < SDF_ATLAS_SIZE; i++)
+      if ((face->usage_counter - face->slots[i].last_used) >
+          (face->usage_counter - face->slots[oldest].last_used))
+         oldest = i;
+
+   /* Remove from map */
+   map_id = face->slots[oldest].charcode & 0xFF;
+   if (face->uc_map[map_id] == &face->slots[oldest])
+      face->uc_map[map_id] = face->slots[oldest].next;
+   else if (face->uc_map[map_id])
+   {
+      sdf_atlas_slot_t *ptr = face->uc_map[map_id];
+      while (ptr->next && ptr->next != &face->slots[oldest])
+         ptr = ptr->next;
+      ptr->next = face->slots[oldest].next;
+   }
+
+   return &face->slots[oldest];
+}
+
+static const struct font_glyph *sdf_face_get_glyph(
+      sdf_face_t *face, uint32_t charcode)
+{
+   unsigned y, width, height;
+   uint8_t *dst;
+   const struct font_glyph *src_glyph;
+   const struct font_atlas *src_atlas;
+   sdf_atlas_slot_t *slot;
+   unsigned map_id = charcode & 0xFF;
+
+   for (slot = face->uc_map[map_id]; slot; slot = slot->next)
+   {
+      if (slot->charcode == charcode)
+      {
+         slot->last_used = face->usage_counter++;
+         return &slot->glyph;
+      }
+   }
+
+   if (!(src_glyph = face->base_driver->get_glyph(
+               face->base_data, charcode)))
+      return NULL;
+
+   src_atlas           = face->base_driver->get_atlas(face->base_data);
+
+   slot                = sdf_face_get_slot(face);
+   slot->charcode      = charcode;
+   slot->next          = face->uc_map[map_id];
+   face->uc_map[map_id] = slot;
+
+   width               = MIN(src_glyph->width,
+         SDF_CELL_SIZE - 2 * FONT_SDF_SPREAD);
+   height              = MIN(src_glyph->height,
+         SDF_CELL_SIZE - 2 * FONT_SDF_SPREAD);
+
+   slot->glyph.advance_x     = src_glyph->advance_x;
+   slot->glyph.advance_y     = src_glyph->advance_y;
+
+   dst = face->buffer + slot->glyph.atlas_offset_x
+      + slot->glyph.atlas_offset_y * face->width;
+
+   /* Blank glyphs stay blank */
+   if (!width || !height)
+   {
+      slot->glyph.width         = 0;
+      slot->glyph.height        = 0;
+      slot->glyph.draw_offset_x = src_glyph->draw_offset_x;
+      slot->glyph.draw_offset_y = src_glyph->draw_offset_y;
+   }
+   else
+   {
+      slot->glyph.width         = width  + 2 * FONT_SDF_SPREAD;
+      slot->glyph.height        = height + 2 * FONT_SDF_SPREAD;
+      slot->glyph.draw_offset_x = src_glyph->draw_offset_x - FONT_SDF_SPREAD;
+      slot->glyph.draw_offset_y = src_glyph->draw_offset_y - FONT_SDF_SPREAD;
+
+      sdf_render_glyph(face,
+            src_atlas->buffer + src_glyph->atlas_offset_x
+            + src_glyph->atlas_offset_y * src_atlas->width,
+            src_atlas->width, width, height,
+            dst, face->width);
+   }
+
+   /* Clear what the previous glyph of the slot left,
+    * filtering would pick it up at the glyph edges */
+   for (y = 0; y < SDF_CELL_SIZE; y++)
+   {
+      uint8_t *row = dst + y * face->width;
+
+      if (y < slot->glyph.height)
+         memset(row + slot->glyph.width, 0,
+               SDF_CELL_SIZE - slot->glyph.width);
+      else
+         memset(row, 0, SDF_CELL_SIZE);
+   }
+
+   face->generation++;
+   slot->last_used = face->usage_counter++;
+   return &slot->glyph;
+}
+
+static void sdf_face_free(sdf_face_t *face)
+{
+   if (face->base_driver && face->base_data)
+      face->base_driver->free(face->base_data);
+   free(face->buffer);
+   free(face);
+}
+
+static sdf_face_t *sdf_face_new(const char *font_path)
+{
+   unsigned i, x, y;
+   struct font_line_metrics *metrics = NULL;
+   sdf_face_t *face = (sdf_face_t*)calloc(1, sizeof(*face));
+
+   if (!face)
+      return NULL;
+
+   if (!font_renderer_create_default(&face->base_driver,
+            &face->base_data, font_path, FONT_SDF_SIZE))
+      goto error;
+
+   face->width  = SDF_CELL_SIZE * SDF_ATLAS_COLS;
+   face->height = SDF_CELL_SIZE * SDF_ATLAS_ROWS;
+   if (!(face->buffer = (uint8_t*)calloc(face->width, face->height)))
+      goto error;
+
+   if (font_path)
+      strlcpy(face->path, font_path, sizeof(face->path));
+
+   for (y = 0, i = 0; y < SDF_ATLAS_ROWS; y++)
+   {
+      for (x = 0; x < SDF_ATLAS_COLS; x++, i++)
+      {
+         face->slots[i].glyph.atlas_offset_x = x * SDF_CELL_SIZE;
+         face->slots[i].glyph.atlas_offset_y = y * SDF_CELL_SIZE;
+      }
+   }
+
+   if (     face->base_driver->get_line_metrics
+         && face->base_driver->get_line_metrics(face->base_data, &metrics))
+   {
+      face->line_metrics     = *metrics;
+      face->has_line_metrics = true;
+   }
+
+   /* Printable ASCII up front, like the other renderers */
+   for (i = 32; i < 127; i++)
+      sdf_face_get_glyph(face, i);
+
+   return face;
+
+error:
+   sdf_face_free(face);
+   return NULL;
+}
+
+/* Drops unused faces beyond the first 'keep' ones */
+static void sdf_faces_trim(unsigned keep)
+{
+   sdf_face_t **link = &sdf_faces;
+
+   while (*link)
+   {
+      sdf_face_t *face = *link;
+
+      if (!face->refcount && !keep)
+      {
+         *link = face->next;
+         sdf_face_free(face);
+         continue;
+      }
+
+      if (!face->refcount)
+         keep--;
+      link = &face->next;
+   }
+}
+
+static void sdf_faces_lock_acquire(void)
+{
+#ifdef HAVE_THREADS
+   if (!sdf_faces_lock)
+      sdf_faces_lock = slock_new();
+   if (sdf_faces_lock)
+      slock_lock(sdf_faces_lock);
+#endif
+}
+
+static void sdf_faces_lock_release(void)
+{
+#ifdef HAVE_THREADS
+   if (sdf_faces_lock)
+      slock_unlock(sdf_faces_lock);
+#endif
+}
+
+static void sdf_font_sync(sdf_font_t *font)
+{
+   if (font->generation != font->face->generation)
+   {
+      font->generation = font->face->generation;
+      font->atlas.dirty = true;
+   }
+}
+
+static void *font_renderer_sdf_init(const char *font_path, float font_size)
+{
+   sdf_face_t *face  = NULL;
+   sdf_font_t *font  = NULL;
+   const char *key   = font_path ? font_path : "";
+
+   if (font_size < 1.0f)
+      return NULL;
+
+   if (!(font = (sdf_font_t*)calloc(1, sizeof(*font))))
+      return NULL;
+
+   sdf_faces_lock_acquire();
+
+   for (face = sdf_faces; face; face = face->next)
+      if (string_is_equal(face->path, key))
+         break;
+
+   if (!face && (face = sdf_face_new(font_path)))
+   {
+      face->next = sdf_faces;
+      sdf_faces  = face;
+   }
+
+   if (face)
+   {
+      face->refcount++;
+
+      /* The most recently used faces come first */
+      if (sdf_faces != face)
+      {
+         sdf_face_t *prev = sdf_faces;
+         while (prev->next != face)
+            prev = prev->next;
+         prev->next = face->next;
+         face->next = sdf_faces;
+         sdf_faces  = face;
+      }
+   }
+
+   sdf_faces_lock_release();
+
+   if (!face)
+   {
+      free(font);
+      return NULL;
+   }
+
+   font->face                     = face;
+   font->generation               = face->generation;
+   font->atlas.buffer             = face->buffer;
+   font->atlas.width              = face->width;
+   font->atlas.height             = face->height;
+   font->atlas.sdf                = true;
+   font->atlas.sdf_scale          = font_size / FONT_SDF_SIZE;
+   font->atlas.dirty              = true;
+
+   font->line_metrics.height      = face->line_metrics.height
+      * font->atlas.sdf_scale;
+   font->line_metrics.ascender    = face->line_metrics.ascender
+      * font->atlas.sdf_scale;
+   font->line_metrics.descender   = face->line_metrics.descender
+      * font->atlas.sdf_scale;
+
+   return font;
+}
+
+static struct font_atlas *font_renderer_sdf_get_atlas(void *data)
+{
+   sdf_font_t *font = (sdf_font_t*)data;
+   if (!font)
+      return NULL;
+   sdf_font_sync(font);
+   return &font->atlas;
+}
+
+static const struct font_glyph *font_renderer_sdf_get_glyph(
+      void *data, uint32_t code)
+{
+   const struct font_glyph *glyph = NULL;
+   sdf_font_t *font               = (sdf_font_t*)data;
+
+   if (!font)
+      return NULL;
+
+   sdf_faces_lock_acquire();
+   glyph = sdf_face_get_glyph(font->face, code);
+   sdf_faces_lock_release();
+
+   sdf_font_sync(font);
+   return glyph;
+}
+
+static void font_renderer_sdf_free(void *data)
+{
+   sdf_font_t *font = (sdf_font_t*)data;
+
+   if (!font)
+      return;
+
+   sdf_faces_lock_acquire();
+   font->face->refcount--;
+   sdf_faces_trim(SDF_CACHE_SIZE);
+   sdf_faces_lock_release();
+
+   free(font);
+}
+
+static const char *font_renderer_sdf_get_default_font(void)
+{
+   return NULL;
+}
+
+static bool font_renderer_sdf_get_line_metrics(
+      void *data, struct font_line_metrics **metrics)
+{
+   sdf_font_t *font = (sdf_font_t*)data;
+
+   if (!font || !font->face->has_line_metrics)
+      return false;
+
+   *metrics = &font->line_metrics;
+   return true;
+}
+
+int font_renderer_create_sdf(
+      const font_renderer_driver_t **drv,
+      void **handle,
+      const char *font_path, float font_size)
+{
+   if (!(*handle = font_renderer_sdf_init(font_path, font_size)))
+   {
+      *drv = NULL;
+      return 0;
+   }
+
+   *drv = &sdf_font_renderer;
+   return 1;
+}
+
+void font_renderer_sdf_cache_free(void)
+{
+   sdf_faces_lock_acquire();
+   sdf_faces_trim(0);
+   sdf_faces_lock_release();
+}
+
+font_renderer_driver_t sdf_font_renderer = {
+   font_renderer_sdf_init,
+   font_renderer_sdf_get_atlas,
+   font_renderer_sdf_get_glyph,
+   font_renderer_sdf_free,
+   font_renderer_sdf_get_default_font,
+   "sdf",
+   font_renderer_sdf_get_line_metrics
+};
@@ -65,6 +65,7 @@ typedef struct
    int max_glyph_width;
    int max_glyph_height;
    unsigned usage_counter;
+   unsigned slots_used;
    float scale_factor;
    struct font_line_metrics line_metrics; /* float alignment */
 } stb_unicode_font_renderer_t;
@@ -89,6 +90,10 @@ static stb_unicode_atlas_slot_t* font_renderer_stb_unicode_get_slot(stb_unicode_
    int i, map_id;
    unsigned oldest = 0;
 
+   /* Hand out unused slots before evicting anything */
+   if (handle->slots_used < STB_UNICODE_ATLAS_SIZE)
+      return &handle->atlas_slots[handle->slots_used++];
+
    for (i = 1; i < STB_UNICODE_ATLAS_SIZE; i++)
       if ((handle->usage_counter - handle->atlas_slots[i].last_used) >
          (handle->usage_counter - handle->atlas_slots[oldest].last_used))
@@ -185,7 +190,9 @@ static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
    atlas_slot->glyph.draw_offset_y  = (int)((glyph_draw_offset_y < 0.0f) ?
          floor((double)glyph_draw_offset_y) : ceil((double)glyph_draw_offset_y));
 
-   self->atlas.dirty = true;
+   font_atlas_mark_dirty(&self->atlas,
+         atlas_slot->glyph.atlas_offset_x, atlas_slot->glyph.atlas_offset_y,
+         self->max_glyph_width, self->max_glyph_height);
    atlas_slot->last_used = self->usage_counter++;
    return &atlas_slot->glyph;
 }
@@ -220,15 +227,11 @@ static bool font_renderer_stb_unicode_create_atlas(
       }
    }
 
-   for (i = 0; i < 256; i++)
+   /* Only printable ASCII up front, everything else is
+    * rasterised on first use */
+   for (i = 32; i < 127; i++)
       font_renderer_stb_unicode_get_glyph(self, i);
 
-   for (i = 0; i < 256; i++)
-   {
-      if (ISALNUM(i))
-         font_renderer_stb_unicode_get_glyph(self, i);
-   }
-
    return true;
 }
 
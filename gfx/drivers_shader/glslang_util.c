@@ -97,6 +97,78 @@ enum slang_texture_semantic slang_name_to_texture_semantic_array(
    return SLANG_INVALID_TEXTURE_SEMANTIC;
 }
 
+enum glslang_format glslang_format_to_fp16(enum glslang_format fmt)
+{
+   switch (fmt)
+   {
+      case SLANG_FORMAT_R32_SFLOAT:
+         return SLANG_FORMAT_R16_SFLOAT;
+      case SLANG_FORMAT_R32G32_SFLOAT:
+         return SLANG_FORMAT_R16G16_SFLOAT;
+      case SLANG_FORMAT_R32G32B32A32_SFLOAT:
+         return SLANG_FORMAT_R16G16B16A16_SFLOAT;
+      default:
+         break;
+   }
+
+   return fmt;
+}
+
+static bool glslang_shader_mentions(const char *path, const char *str)
+{
+   size_t i;
+   struct string_list lines = {0};
+   bool found               = true;
+
+   if (!string_list_initialize(&lines))
+      return true;
+
+   if (glslang_read_shader_file(path, &lines, true))
+   {
+      found = false;
+      for (i = 0; i < lines.size; i++)
+      {
+         if (strstr(lines.elems[i].data, str))
+         {
+            found = true;
+            break;
+         }
+      }
+   }
+
+   string_list_deinitialize(&lines);
+   return found;
+}
+
+bool glslang_preset_can_fuse_final_pass(const struct video_shader *shader)
+{
+   unsigned i;
+   const struct video_shader_pass *pass = NULL;
+
+   if (!shader || !shader->passes)
+      return false;
+
+   pass = &shader->pass[shader->passes - 1];
+
+   /* A 1:1 copy only changes anything if the framebuffer
+    * is not exactly the size of the viewport */
+   if (     !pass->fbo.valid
+         || pass->fbo.type_x  != RARCH_SCALE_VIEWPORT
+         || pass->fbo.type_y  != RARCH_SCALE_VIEWPORT
+         || pass->fbo.scale_x != 1.0f
+         || pass->fbo.scale_y != 1.0f)
+      return false;
+
+   /* The final pass has no feedback framebuffer. Reflection
+    * only happens once the chain is built, so look for any
+    * feedback semantic in the sources instead. */
+   for (i = 0; i < shader->passes; i++)
+      if (glslang_shader_mentions(shader->pass[i].source.path, "Feedback"))
+         return false;
+
+   return true;
+}
+
 bool glslang_read_shader_file(const char *path,
       struct string_list *output, bool root_file)
 {
@@ -131,6 +131,20 @@ enum slang_texture_semantic slang_name_to_texture_semantic_array(
 
 unsigned glslang_num_miplevels(unsigned width, unsigned height);
 
+/* Half float counterpart of a 32-bit float format,
+ * other formats are returned as is */
+enum glslang_format glslang_format_to_fp16(enum glslang_format fmt);
+
+/* Whether the last pass of a preset can render straight to
+ * the backbuffer, instead of to a viewport sized framebuffer
+ * followed by a copy */
+bool glslang_preset_can_fuse_final_pass(const struct video_shader *shader);
+
+/* Compiles a slang shader to SPIR-V and stores the result in the
+ * shader cache, so the driver finds it there when building the
+ * filter chain. Safe to call from a worker thread. */
+bool glslang_precompile_shader(const char *shader_path);
+
 RETRO_END_DECLS
 
 #endif
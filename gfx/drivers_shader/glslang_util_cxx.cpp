@@ -17,12 +17,17 @@
 #include <string.h>
 #include <string>
 #include <algorithm>
+#include <deque>
+#include <mutex>
+#include <utility>
 
 #include <retro_miscellaneous.h>
 #include <file/file_path.h>
 #include <file/config_file.h>
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
+#include <compat/strl.h>
+#include <lrc_hash.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -33,8 +38,21 @@
 #if defined(HAVE_GLSLANG)
 #include "glslang.hpp"
 #endif
+#include "../../configuration.h"
 #include "../../verbosity.h"
 
+#define SLANG_CACHE_MAGIC   0x43534152 /* "RASC" */
+
+/* Recently used entries are also kept in memory, so a preset
+ * compiled in the background is found again by the video thread
+ * even when no cache directory is set */
+#define SLANG_MEMORY_CACHE_ENTRIES 128
+
+typedef std::pair<std::string, std::vector<std::string> > slang_cache_entry;
+
+static std::mutex slang_memory_cache_lock;
+static std::deque<slang_cache_entry> slang_memory_cache;
+
 static std::string build_stage_source(
       const struct string_list *lines, const char *stage)
 {
@@ -218,36 +236,220 @@ bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta)
    return true;
 }
 
+bool slang_cache_path(const std::string &key, const char *ext,
+      char *s, size_t len)
+{
+   char hash[65];
+   std::string versioned_key;
+   settings_t *settings = config_get_ptr();
+   const char *dir      = settings ? settings->paths.directory_cache : NULL;
+
+   versioned_key  = std::to_string(SLANG_CACHE_VERSION);
+   versioned_key.push_back('\0');
+   versioned_key += key;
+   sha256_hash(hash, (const uint8_t*)versioned_key.data(),
+         versioned_key.size());
+
+   /* Without a directory only the memory cache is used */
+   if (string_is_empty(dir))
+      strlcpy(s, hash, len);
+   else
+   {
+      fill_pathname_join(s, dir, "slang", len);
+      fill_pathname_join(s, s, hash, len);
+   }
+   strlcat(s, ext, len);
+   return true;
+}
+
+static bool slang_cache_on_disk(const char *path)
+{
+   return path_basename(path) != path;
+}
+
+/* Magic, blob count, then each blob's size and bytes */
+bool slang_cache_load(const char *path, std::vector<std::string> *blobs)
+{
+   uint32_t count, i;
+   const uint8_t *data = NULL;
+   void *buf           = NULL;
+   int64_t len         = 0;
+   int64_t offset      = 2 * sizeof(uint32_t);
+   bool ret            = false;
+
+   {
+      std::lock_guard<std::mutex> lock(slang_memory_cache_lock);
+      std::deque<slang_cache_entry>::const_iterator it;
+
+      for (it = slang_memory_cache.begin(); it != slang_memory_cache.end(); ++it)
+      {
+         if (it->first == path)
+         {
+            *blobs = it->second;
+            return true;
+         }
+      }
+   }
+
+   if (  !slang_cache_on_disk(path)
+       || !path_is_valid(path)
+       || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   data = (const uint8_t*)buf;
+   if (len < offset || ((const uint32_t*)data)[0] != SLANG_CACHE_MAGIC)
+      goto end;
+
+   count = ((const uint32_t*)data)[1];
+   blobs->clear();
+
+   for (i = 0; i < count; i++)
+   {
+      uint32_t size;
+
+      if (len - offset < (int64_t)sizeof(size))
+         goto end;
+      memcpy(&size, data + offset, sizeof(size));
+      offset += sizeof(size);
+
+      if (len - offset < (int64_t)size)
+         goto end;
+      blobs->push_back(std::string((const char*)data + offset, size));
+      offset += size;
+   }
+
+   if ((ret = (offset == len)))
+   {
+      std::lock_guard<std::mutex> lock(slang_memory_cache_lock);
+      if (slang_memory_cache.size() >= SLANG_MEMORY_CACHE_ENTRIES)
+         slang_memory_cache.pop_front();
+      slang_memory_cache.push_back(slang_cache_entry(path, *blobs));
+   }
+
+end:
+   free(buf);
+   return ret;
+}
+
+void slang_cache_save(const char *path, const std::vector<std::string> &blobs)
+{
+   size_t i;
+   uint32_t word;
+   char dir[PATH_MAX_LENGTH];
+   std::string data;
+
+   {
+      std::lock_guard<std::mutex> lock(slang_memory_cache_lock);
+      if (slang_memory_cache.size() >= SLANG_MEMORY_CACHE_ENTRIES)
+         slang_memory_cache.pop_front();
+      slang_memory_cache.push_back(slang_cache_entry(path, blobs));
+   }
+
+   if (!slang_cache_on_disk(path))
+      return;
+
+   fill_pathname_basedir(dir, path, sizeof(dir));
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      return;
+
+   word = SLANG_CACHE_MAGIC;
+   data.append((const char*)&word, sizeof(word));
+   word = (uint32_t)blobs.size();
+   data.append((const char*)&word, sizeof(word));
+
+   for (i = 0; i < blobs.size(); i++)
+   {
+      word = (uint32_t)blobs[i].size();
+      data.append((const char*)&word, sizeof(word));
+      data += blobs[i];
+   }
+
+   if (!filestream_write_file(path, data.data(), data.size()))
+      RARCH_WARN("[slang]: Failed to write shader cache \"%s\".\n", path);
+}
+
+#if defined(HAVE_GLSLANG)
+static bool glslang_spirv_from_blob(const std::string &blob,
+      std::vector<uint32_t> *spirv)
+{
+   /* Starts with the SPIR-V magic number */
+   if (     blob.size() < sizeof(uint32_t)
+         || blob.size() % sizeof(uint32_t)
+         || *(const uint32_t*)blob.data() != 0x07230203)
+      return false;
+
+   spirv->resize(blob.size() / sizeof(uint32_t));
+   memcpy(spirv->data(), blob.data(), blob.size());
+   return true;
+}
+#endif
+
 bool glslang_compile_shader(const char *shader_path, glslang_output *output)
 {
 #if defined(HAVE_GLSLANG)
+   char cache_path[PATH_MAX_LENGTH];
    struct string_list lines;
-   
+   std::string vertex_source;
+   std::string fragment_source;
+   bool use_cache = false;
+
    if (!string_list_initialize(&lines))
       return false;
 
-   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
-
    if (!glslang_read_shader_file(shader_path, &lines, true))
       goto error;
    output->meta = glslang_meta{};
    if (!glslang_parse_meta(&lines, &output->meta))
       goto error;
 
-   if (!glslang::compile_spirv(build_stage_source(&lines, "vertex"),
+   vertex_source   = build_stage_source(&lines, "vertex");
+   fragment_source = build_stage_source(&lines, "fragment");
+   use_cache       = slang_cache_path(
+         "spirv" + std::string(1, '\0') + vertex_source
+         + std::string(1, '\0') + fragment_source,
+         ".spv", cache_path, sizeof(cache_path));
+
+   if (use_cache)
+   {
+      std::vector<std::string> blobs;
+
+      if (     slang_cache_load(cache_path, &blobs)
+            && blobs.size() == 2
+            && glslang_spirv_from_blob(blobs[0], &output->vertex)
+            && glslang_spirv_from_blob(blobs[1], &output->fragment))
+      {
+         RARCH_LOG("[slang]: Using cached SPIR-V for \"%s\".\n", shader_path);
+         string_list_deinitialize(&lines);
+         return true;
+      }
+   }
+
+   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+
+   if (!glslang::compile_spirv(vertex_source,
             glslang::StageVertex, &output->vertex))
    {
       RARCH_ERR("Failed to compile vertex shader stage.\n");
       goto error;
    }
 
-   if (!glslang::compile_spirv(build_stage_source(&lines, "fragment"),
+   if (!glslang::compile_spirv(fragment_source,
             glslang::StageFragment, &output->fragment))
    {
       RARCH_ERR("Failed to compile fragment shader stage.\n");
       goto error;
    }
 
+   if (use_cache)
+   {
+      std::vector<std::string> blobs;
+      blobs.push_back(std::string((const char*)output->vertex.data(),
+               output->vertex.size() * sizeof(uint32_t)));
+      blobs.push_back(std::string((const char*)output->fragment.data(),
+               output->fragment.size() * sizeof(uint32_t)));
+      slang_cache_save(cache_path, blobs);
+   }
+
    string_list_deinitialize(&lines);
 
    return true;
@@ -258,3 +460,9 @@ error:
 
    return false;
 }
+
+bool glslang_precompile_shader(const char *shader_path)
+{
+   glslang_output output;
+   return glslang_compile_shader(shader_path, &output);
+}
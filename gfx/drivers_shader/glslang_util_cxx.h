@@ -55,6 +55,22 @@ struct glslang_output
 
 bool glslang_compile_shader(const char *shader_path, glslang_output *output);
 
+/* Bump when the compile options or the output of any
+ * backend change, so old cache entries are no longer hit */
+#define SLANG_CACHE_VERSION 1
+
+/* Content-addressed cache for compiled shaders, shared by the
+ * slang backends. Entries live in "<cache_directory>/slang/",
+ * named after the SHA-256 of @key and SLANG_CACHE_VERSION.
+ * The most recent entries are also kept in memory, which is all
+ * that is used when no cache directory is configured. */
+bool slang_cache_path(const std::string &key, const char *ext,
+      char *s, size_t len);
+
+/* An entry is a list of binary blobs */
+bool slang_cache_load(const char *path, std::vector<std::string> *blobs);
+void slang_cache_save(const char *path, const std::vector<std::string> &blobs);
+
 /* Helpers for internal use. */
 bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta);
 
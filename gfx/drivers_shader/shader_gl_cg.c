@@ -51,6 +51,7 @@
 #include "../../verbosity.h"
 #ifdef HAVE_REWIND
 #include "../../state_manager.h"
+#include "../../memory_tags.h"
 #endif
 
 #define PREV_TEXTURES         (GFX_MAX_TEXTURES - 1)
@@ -460,7 +461,7 @@ static void gl_cg_destroy_resources(void *data)
       memset(cg->lut_textures, 0, sizeof(cg->lut_textures));
    }
 
-   free(cg->shader);
+   memory_tag_free(MEMORY_TAG_SHADERS, cg->shader);
    cg->shader = NULL;
 }
 
@@ -638,8 +639,8 @@ static bool gl_cg_load_plain(void *data, const char *path)
    if (!gl_cg_load_stock(cg))
       return false;
 
-   cg->shader = (struct video_shader*)
-      calloc(1, sizeof(*cg->shader));
+   cg->shader = (struct video_shader*)memory_tag_calloc(
+         MEMORY_TAG_SHADERS, 1, sizeof(*cg->shader));
    if (!cg->shader)
       return false;
 
@@ -696,7 +697,8 @@ static bool gl_cg_load_preset(void *data, const char *path)
 
    RARCH_LOG("[CG]: Loading Cg meta-shader: %s\n", path);
 
-   cg->shader = (struct video_shader*)calloc(1, sizeof(*cg->shader));
+   cg->shader = (struct video_shader*)memory_tag_calloc(
+         MEMORY_TAG_SHADERS, 1, sizeof(*cg->shader));
    if (!cg->shader)
    {
       return false;
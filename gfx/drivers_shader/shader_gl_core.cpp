@@ -34,6 +34,8 @@
 
 #include "../common/gl_core_common.h"
 
+#include "../../configuration.h"
+#include "../../memory_tags.h"
 #include "../../verbosity.h"
 #include "../../msg_hash.h"
 
@@ -161,8 +163,44 @@ GLuint gl_core_cross_compile_program(
          texture_binding_fixups.push_back(binding);
       }
 
-      auto vertex_source = vertex_compiler.compile();
-      auto fragment_source = fragment_compiler.compile();
+      std::string vertex_source;
+      std::string fragment_source;
+      {
+         char cache_path[PATH_MAX_LENGTH];
+         std::vector<std::string> blobs;
+         std::string key = "glcore/" + std::to_string(opts.es ? 1 : 0)
+            + "/" + std::to_string(opts.version)
+            + "/" + std::to_string(flatten ? 1 : 0);
+         bool use_cache;
+
+         key.push_back('\0');
+         key.append((const char*)vertex, vertex_size);
+         key.push_back('\0');
+         key.append((const char*)fragment, fragment_size);
+         use_cache = slang_cache_path(key, ".glsl",
+               cache_path, sizeof(cache_path));
+
+         if (     use_cache
+               && slang_cache_load(cache_path, &blobs)
+               && blobs.size() == 2)
+         {
+            vertex_source   = blobs[0];
+            fragment_source = blobs[1];
+         }
+         else
+         {
+            vertex_source   = vertex_compiler.compile();
+            fragment_source = fragment_compiler.compile();
+
+            if (use_cache)
+            {
+               blobs.clear();
+               blobs.push_back(vertex_source);
+               blobs.push_back(fragment_source);
+               slang_cache_save(cache_path, blobs);
+            }
+         }
+      }
       GLuint vertex_shader = gl_core_compile_shader(GL_VERTEX_SHADER, vertex_source.c_str());
       GLuint fragment_shader = gl_core_compile_shader(GL_FRAGMENT_SHADER, fragment_source.c_str());
 
@@ -1601,9 +1639,13 @@ struct gl_core_filter_chain
 {
 public:
    gl_core_filter_chain(unsigned num_passes) { set_num_passes(num_passes); }
+   ~gl_core_filter_chain() { set_shader_preset(nullptr); }
 
    inline void set_shader_preset(std::unique_ptr<video_shader> shader)
    {
+      memory_tag_add(MEMORY_TAG_SHADERS,
+            ((shader ? 1 : 0) - (common.shader_preset ? 1 : 0))
+            * (int64_t)sizeof(video_shader));
       common.shader_preset = std::move(shader);
    }
 
@@ -2206,7 +2248,15 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
    if (!video_shader_load_preset_into_shader(path, shader.get()))
       return nullptr;
 
-   bool last_pass_is_fbo = shader->pass[shader->passes - 1].fbo.valid;
+   settings_t *settings    = config_get_ptr();
+   bool fp16_framebuffers  = settings && settings->bools.video_shader_fp16_framebuffers;
+   bool fuse_final_pass    = glslang_preset_can_fuse_final_pass(shader.get());
+   bool last_pass_is_fbo   = shader->pass[shader->passes - 1].fbo.valid
+      && !fuse_final_pass;
+
+   if (fuse_final_pass)
+      RARCH_LOG("[slang]: Rendering last pass straight to the backbuffer.\n");
+
 
    std::unique_ptr<gl_core_filter_chain> chain{ new gl_core_filter_chain(shader->passes + (last_pass_is_fbo ? 1 : 0)) };
    if (!chain)
@@ -2335,7 +2385,11 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
       if (output.meta.rt_format == SLANG_FORMAT_UNKNOWN)
          output.meta.rt_format = SLANG_FORMAT_R8G8B8A8_UNORM;
 
-      if (!pass->fbo.valid)
+      /* Halves the bandwidth of float targets */
+      if (fp16_framebuffers)
+         output.meta.rt_format = glslang_format_to_fp16(output.meta.rt_format);
+
+      if (!pass->fbo.valid || (fuse_final_pass && i + 1 == shader->passes))
       {
          bool scale_viewport       = i + 1 == shader->passes;
          if (scale_viewport)
@@ -2355,7 +2409,7 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
          {
             pass_info.rt_format    = 0;
 
-            if (explicit_format)
+            if (explicit_format && !fuse_final_pass)
                RARCH_WARN("[slang]: Using explicit format for last pass in chain,"
                      " but it is not rendered to framebuffer, using swapchain format instead.\n");
          }
@@ -36,6 +36,7 @@
 #include "shader_glsl.h"
 #ifdef HAVE_REWIND
 #include "../../state_manager.h"
+#include "../../memory_tags.h"
 #endif
 #include "../../core.h"
 #include "../../verbosity.h"
@@ -694,7 +695,7 @@ static void gl_glsl_deinit_shader(glsl_shader_data_t *glsl)
       free(glsl->shader->pass[i].source.string.fragment);
    }
 
-   free(glsl->shader);
+   memory_tag_free(MEMORY_TAG_SHADERS, glsl->shader);
    glsl->shader = NULL;
 }
 
@@ -925,7 +926,8 @@ static void *gl_glsl_init(void *data, const char *path)
    }
 #endif
 
-   glsl->shader = (struct video_shader*)calloc(1, sizeof(*glsl->shader));
+   glsl->shader = (struct video_shader*)memory_tag_calloc(
+         MEMORY_TAG_SHADERS, 1, sizeof(*glsl->shader));
    if (!glsl->shader)
       goto error;
 
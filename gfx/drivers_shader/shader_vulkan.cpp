@@ -34,6 +34,8 @@
 #include "slang_reflection.hpp"
 
 #include "../../retroarch.h"
+#include "../../memory_tags.h"
+#include "../../configuration.h"
 #include "../../verbosity.h"
 #include "../../msg_hash.h"
 
@@ -362,6 +364,9 @@ struct vulkan_filter_chain
 
       inline void set_shader_preset(std::unique_ptr<video_shader> shader)
       {
+         memory_tag_add(MEMORY_TAG_SHADERS,
+               ((shader ? 1 : 0) - (common.shader_preset ? 1 : 0))
+               * (int64_t)sizeof(video_shader));
          common.shader_preset = std::move(shader);
       }
 
@@ -771,6 +776,7 @@ vulkan_filter_chain::vulkan_filter_chain(
 vulkan_filter_chain::~vulkan_filter_chain()
 {
    flush();
+   set_shader_preset(nullptr);
 }
 
 void vulkan_filter_chain::set_swapchain_info(
@@ -2584,7 +2590,15 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
     if (!video_shader_load_preset_into_shader(path, shader.get()))
         return nullptr;
 
-   bool last_pass_is_fbo = shader->pass[shader->passes - 1].fbo.valid;
+   settings_t *settings    = config_get_ptr();
+   bool fp16_framebuffers  = settings && settings->bools.video_shader_fp16_framebuffers;
+   bool fuse_final_pass    = glslang_preset_can_fuse_final_pass(shader.get());
+   bool last_pass_is_fbo   = shader->pass[shader->passes - 1].fbo.valid
+      && !fuse_final_pass;
+
+   if (fuse_final_pass)
+      RARCH_LOG("[slang]: Rendering last pass straight to the backbuffer.\n");
+
    auto tmpinfo          = *info;
    tmpinfo.num_passes    = shader->passes + (last_pass_is_fbo ? 1 : 0);
 
@@ -2715,7 +2729,11 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
       if (output.meta.rt_format == SLANG_FORMAT_UNKNOWN)
          output.meta.rt_format     = SLANG_FORMAT_R8G8B8A8_UNORM;
 
-      if (!pass->fbo.valid)
+      /* Halves the bandwidth of float targets */
+      if (fp16_framebuffers)
+         output.meta.rt_format     = glslang_format_to_fp16(output.meta.rt_format);
+
+      if (!pass->fbo.valid || (fuse_final_pass && i + 1 == shader->passes))
       {
          pass_info.scale_type_x    = GLSLANG_FILTER_CHAIN_SCALE_SOURCE;
          pass_info.scale_type_y    = GLSLANG_FILTER_CHAIN_SCALE_SOURCE;
@@ -2728,7 +2746,7 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
             pass_info.scale_type_y = GLSLANG_FILTER_CHAIN_SCALE_VIEWPORT;
             pass_info.rt_format    = tmpinfo.swapchain.format;
 
-            if (explicit_format)
+            if (explicit_format && !fuse_final_pass)
                RARCH_WARN("[slang]: Using explicit format for last pass in chain,"
                      " but it is not rendered to framebuffer, using swapchain format instead.\n");
          }
@@ -18,6 +18,7 @@
 #include <spirv_glsl.hpp>
 #include <spirv_hlsl.hpp>
 #include <spirv_msl.hpp>
+#include <retro_miscellaneous.h>
 #include <compat/strl.h>
 #include <string>
 #include <stdint.h>
@@ -25,6 +26,7 @@
 #include <string/stdstring.h>
 
 #include "glslang_util.h"
+#include "glslang_util_cxx.h"
 #include "slang_reflection.h"
 #include "slang_reflection.hpp"
 #include "slang_process.h"
@@ -406,6 +408,24 @@ error:
    return false;
 }
 
+/* Cross-compiled code only depends on the SPIR-V, the target
+ * language and its version */
+static std::string slang_process_cache_key(
+      enum rarch_shader_type dst_type, unsigned version,
+      const glslang_output &output)
+{
+   std::string key = "cross/" + std::to_string((int)dst_type)
+      + "/" + std::to_string(version);
+
+   key.push_back('\0');
+   key.append((const char*)output.vertex.data(),
+         output.vertex.size() * sizeof(uint32_t));
+   key.push_back('\0');
+   key.append((const char*)output.fragment.data(),
+         output.fragment.size() * sizeof(uint32_t));
+   return key;
+}
+
 bool slang_process(
       video_shader*          shader_info,
       unsigned               pass_number,
@@ -445,10 +465,16 @@ bool slang_process(
 
    try
    {
+      char            cache_path[PATH_MAX_LENGTH];
       ShaderResources vs_resources;
       ShaderResources ps_resources;
       std::string     vs_code;
       std::string     ps_code;
+      std::vector<std::string> blobs;
+      bool            cached    = false;
+      bool            use_cache = slang_cache_path(
+            slang_process_cache_key(dst_type, version, output),
+            ".src", cache_path, sizeof(cache_path));
 
       switch (dst_type)
       {
@@ -490,6 +516,17 @@ bool slang_process(
          ps_compiler->set_decoration(
                ps_resources.push_constant_buffers[0].id, spv::DecorationBinding, 1);
 
+      if (     use_cache
+            && slang_cache_load(cache_path, &blobs)
+            && blobs.size() == 2)
+      {
+         vs_code = blobs[0];
+         ps_code = blobs[1];
+         cached  = true;
+      }
+
+      /* Reflection below doesn't need compile() to have run */
+      if (!cached)
       switch (dst_type)
       {
          case RARCH_SHADER_HLSL:
@@ -581,6 +618,14 @@ bool slang_process(
             goto error;
       }
 
+      if (use_cache && !cached && !vs_code.empty() && !ps_code.empty())
+      {
+         blobs.clear();
+         blobs.push_back(vs_code);
+         blobs.push_back(ps_code);
+         slang_cache_save(cache_path, blobs);
+      }
+
       pass.source.string.vertex   = strdup(vs_code.c_str());
       pass.source.string.fragment = strdup(ps_code.c_str());
 
@@ -22,6 +22,7 @@
 #endif
 
 #include "font_driver.h"
+#include "gfx_display.h"
 #include "video_thread_wrapper.h"
 
 #include "../retroarch.h"
@@ -83,6 +84,43 @@ int font_renderer_create_default(
    return 0;
 }
 
+void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   if (!width || !height)
+      return;
+
+   if (atlas->dirty_width && atlas->dirty_height)
+   {
+      unsigned right  = MAX(atlas->dirty_x + atlas->dirty_width,  x + width);
+      unsigned bottom = MAX(atlas->dirty_y + atlas->dirty_height, y + height);
+
+      atlas->dirty_x      = MIN(atlas->dirty_x, x);
+      atlas->dirty_y      = MIN(atlas->dirty_y, y);
+      atlas->dirty_width  = right  - atlas->dirty_x;
+      atlas->dirty_height = bottom - atlas->dirty_y;
+   }
+   else if (!atlas->dirty)
+   {
+      atlas->dirty_x      = x;
+      atlas->dirty_y      = y;
+      atlas->dirty_width  = width;
+      atlas->dirty_height = height;
+   }
+   /* Otherwise the whole atlas is already out of date */
+
+   atlas->dirty = true;
+}
+
+void font_atlas_clear_dirty(struct font_atlas *atlas)
+{
+   atlas->dirty        = false;
+   atlas->dirty_x      = 0;
+   atlas->dirty_y      = 0;
+   atlas->dirty_width  = 0;
+   atlas->dirty_height = 0;
+}
+
 #ifdef HAVE_D3D8
 static const font_renderer_t *d3d8_font_backends[] = {
 #if defined(_XBOX1)
@@ -1045,7 +1083,18 @@ static char* font_driver_reshape_msg(const char* msg, unsigned char *buffer, siz
    const unsigned char* src     = (const unsigned char*)msg;
    unsigned char*       dst;
    bool                 reverse = false;
-   size_t              msg_size = (strlen(msg) * 2) + 1;
+   size_t              msg_size;
+
+   /* Nothing to reshape without right-to-left text,
+    * which is most messages */
+   for (src = (const unsigned char*)msg; *src; src++)
+      if (IS_RTL(src))
+         break;
+   if (!*src)
+      return (char*)msg;
+
+   src      = (const unsigned char*)msg;
+   msg_size = (strlen(msg) * 2) + 1;
 
    /* fallback to heap allocated buffer if the buffer is too small */
    /* worst case transformations are 2 bytes to 4 bytes -- aliaspider */
@@ -1148,10 +1197,13 @@ void font_driver_render_msg(
 #else
       char *new_msg = (char*)msg;
 #endif
+      /* Immediate text must land on top of pending menu quads */
+      if (!font->block_bound)
+         gfx_display_flush(disp_get_ptr());
       font->renderer->render_msg(data,
             font->renderer_data, new_msg, params);
 #ifdef HAVE_LANGEXTRA
-      if (new_msg != (char*)tmp_buffer)
+      if (new_msg != (char*)tmp_buffer && new_msg != msg)
          free(new_msg);
 #endif
    }
@@ -1162,25 +1214,70 @@ void font_driver_bind_block(void *font_data, void *block)
    font_data_t *font = (font_data_t*)(font_data ? font_data : video_font_driver);
 
    if (font && font->renderer && font->renderer->bind_block)
+   {
       font->renderer->bind_block(font->renderer_data, block);
+      font->block_bound = block != NULL;
+   }
 }
 
 void font_driver_flush(unsigned width, unsigned height, void *font_data)
 {
    font_data_t *font = (font_data_t*)(font_data ? font_data : video_font_driver);
    if (font && font->renderer && font->renderer->flush)
+   {
+      gfx_display_flush(disp_get_ptr());
       font->renderer->flush(width, height, font->renderer_data);
+   }
 }
 
 int font_driver_get_message_width(void *font_data,
       const char *msg, unsigned len, float scale)
 {
+   unsigned i;
+   uint32_t hash                    = 0x811c9dc5;
+   font_width_cache_entry_t *oldest = NULL;
    font_data_t *font = (font_data_t*)(font_data ? font_data : video_font_driver);
+
    if (len == 0 && msg)
       len = (unsigned)strlen(msg);
-   if (font && font->renderer && font->renderer->get_message_width)
+   if (!font || !font->renderer || !font->renderer->get_message_width)
+      return -1;
+   if (!len || len > FONT_WIDTH_CACHE_MSG_LEN)
       return font->renderer->get_message_width(font->renderer_data, msg, len, scale);
-   return -1;
+
+   /* Glyph advances never change for a font, so neither
+    * do the widths. Hashing the string is much cheaper than
+    * looking up all of its glyphs, the hash only saves
+    * comparing against every entry. */
+   for (i = 0; i < len; i++)
+      hash = (hash ^ (uint8_t)msg[i]) * 0x01000193;
+
+   for (i = 0; i < FONT_WIDTH_CACHE_SIZE; i++)
+   {
+      font_width_cache_entry_t *entry = &font->width_cache[i];
+
+      if (     entry->len   == len
+            && entry->hash  == hash
+            && entry->scale == scale
+            && !memcmp(entry->msg, msg, len))
+      {
+         entry->last_used = font->width_cache_counter++;
+         return entry->width;
+      }
+
+      if (!oldest || (font->width_cache_counter - entry->last_used) >
+            (font->width_cache_counter - oldest->last_used))
+         oldest = entry;
+   }
+
+   oldest->hash      = hash;
+   oldest->len       = len;
+   memcpy(oldest->msg, msg, len);
+   oldest->scale     = scale;
+   oldest->width     = font->renderer->get_message_width(
+         font->renderer_data, msg, len, scale);
+   oldest->last_used = font->width_cache_counter++;
+   return oldest->width;
 }
 
 int font_driver_get_line_height(void *font_data, float scale)
@@ -1293,10 +1390,11 @@ font_data_t *font_driver_init_first(
 
    if (ok)
    {
-      font_data_t *font   = (font_data_t*)malloc(sizeof(*font));
+      font_data_t *font   = (font_data_t*)calloc(1, sizeof(*font));
       font->renderer      = (const font_renderer_t*)font_driver;
       font->renderer_data = font_handle;
       font->size          = font_size;
+      font->block_bound   = false;
       return font;
    }
 
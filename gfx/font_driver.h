@@ -57,12 +57,34 @@ struct font_glyph
 
 struct font_atlas
 {
-   uint8_t *buffer; /* Alpha channel. */
+   uint8_t *buffer; /* Alpha channel, or a distance field if sdf is set. */
    unsigned width;
    unsigned height;
+   /* Region that changed since the atlas was last uploaded,
+    * see font_atlas_mark_dirty(). Empty if the renderer does
+    * not track it, the whole atlas is out of date then. */
+   unsigned dirty_x;
+   unsigned dirty_y;
+   unsigned dirty_width;
+   unsigned dirty_height;
+   /* Distance field atlases are rendered at one size for
+    * every font size. Glyph metrics are then in atlas texels
+    * and have to be multiplied by sdf_scale, line metrics
+    * are already at the requested size. */
+   float sdf_scale;
    bool dirty;
+   bool sdf;
 };
 
+/* Texels of distance on either side of a glyph edge that
+ * an SDF atlas encodes, the edge itself is at 128/255 */
+#define FONT_SDF_SPREAD 6
+/* Size glyphs of SDF atlases are rasterised at */
+#define FONT_SDF_SIZE   32
+
+/* Scale from glyph metrics to pixels at the font size */
+#define FONT_ATLAS_GLYPH_SCALE(atlas) ((atlas)->sdf ? (atlas)->sdf_scale : 1.0f)
+
 struct font_params
 {
    /* Drop shadow offset.
@@ -128,11 +150,31 @@ typedef struct font_renderer_driver
    bool (*get_line_metrics)(void* data, struct font_line_metrics **metrics);
 } font_renderer_driver_t;
 
+/* Message widths remembered per font, the menus measure
+ * the same labels every frame. Longer messages are always
+ * measured. */
+#define FONT_WIDTH_CACHE_SIZE    32
+#define FONT_WIDTH_CACHE_MSG_LEN 128
+
+typedef struct
+{
+   uint32_t hash;
+   unsigned len;
+   unsigned last_used;
+   float scale;
+   int width;
+   char msg[FONT_WIDTH_CACHE_MSG_LEN];
+} font_width_cache_entry_t;
+
 typedef struct
 {
    const font_renderer_t *renderer;
    void *renderer_data;
+   font_width_cache_entry_t width_cache[FONT_WIDTH_CACHE_SIZE];
+   unsigned width_cache_counter;
    float size;
+   /* Text goes to a raster block instead of the screen */
+   bool block_bound;
 } font_data_t;
 
 /* font_path can be NULL for default font. */
@@ -141,6 +183,41 @@ int font_renderer_create_default(
       void **handle,
       const char *font_path, unsigned font_size);
 
+/**
+ * font_renderer_create_sdf:
+ *
+ * Same as font_renderer_create_default(), but the atlas holds
+ * a signed distance field shared by all sizes of the same font,
+ * see struct font_atlas. Only for font drivers that draw it
+ * through a distance field shader.
+ *
+ * Returns: 1 on success, 0 if no renderer could load the font.
+ **/
+int font_renderer_create_sdf(
+      const font_renderer_driver_t **drv,
+      void **handle,
+      const char *font_path, float font_size);
+
+/* Frees distance field atlases no font uses anymore */
+void font_renderer_sdf_cache_free(void);
+
+/**
+ * font_atlas_mark_dirty:
+ * @atlas            : font atlas.
+ * @x                : left edge of the changed region.
+ * @y                : top edge of the changed region.
+ * @width            : width of the changed region.
+ * @height           : height of the changed region.
+ *
+ * Sets the dirty flag and grows the dirty region to cover the
+ * given one, so font drivers can upload only what changed.
+ **/
+void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height);
+
+/* Clears the dirty flag and region after an upload */
+void font_atlas_clear_dirty(struct font_atlas *atlas);
+
 void font_driver_render_msg(void *data,
       const char *msg, const void *params, void *font_data);
 
@@ -199,6 +276,7 @@ extern font_renderer_driver_t stb_unicode_font_renderer;
 extern font_renderer_driver_t freetype_font_renderer;
 extern font_renderer_driver_t coretext_font_renderer;
 extern font_renderer_driver_t bitmap_font_renderer;
+extern font_renderer_driver_t sdf_font_renderer;
 
 RETRO_END_DECLS
 
@@ -526,6 +526,255 @@ void gfx_display_draw_bg(
             userdata);
 }
 
+/* Adds one GFX_DISPLAY_PRIM_TRIANGLESTRIP quad, with vertices
+ * normalised to a (width x height) canvas at the origin.
+ * The quad joins an earlier batch with the same texture and
+ * canvas as long as it does not overlap anything queued after
+ * that batch, so drawing the batches in order keeps the result
+ * identical to drawing every quad as it comes. */
+static bool gfx_display_batch_add(gfx_display_t *p_disp,
+      void *userdata, unsigned video_width, unsigned video_height,
+      unsigned width, unsigned height, uintptr_t texture,
+      const float *vertex, const float *tex_coord, const float *color)
+{
+   static const unsigned strip_to_triangles[6] = { 0, 1, 2, 2, 1, 3 };
+   static const float white[16]                = {
+      1.0f, 1.0f, 1.0f, 1.0f,
+      1.0f, 1.0f, 1.0f, 1.0f,
+      1.0f, 1.0f, 1.0f, 1.0f,
+      1.0f, 1.0f, 1.0f, 1.0f
+   };
+   unsigned i;
+   float bounds[4];
+   float tri_vertex[12];
+   float tri_tex_coord[12];
+   float tri_color[24];
+   video_coords_t coords;
+   gfx_display_batch_t *batch = NULL;
+
+   if (     p_disp->num_batches
+         && (   p_disp->batch_userdata     != userdata
+             || p_disp->batch_video_width  != video_width
+             || p_disp->batch_video_height != video_height))
+      gfx_display_flush(p_disp);
+
+   if (!color)
+      color     = white;
+
+   bounds[0]    = bounds[2] = vertex[0] * width;
+   bounds[1]    = bounds[3] = vertex[1] * height;
+   for (i = 1; i < 4; i++)
+   {
+      float x   = vertex[i * 2 + 0] * width;
+      float y   = vertex[i * 2 + 1] * height;
+      bounds[0] = MIN(bounds[0], x);
+      bounds[1] = MIN(bounds[1], y);
+      bounds[2] = MAX(bounds[2], x);
+      bounds[3] = MAX(bounds[3], y);
+   }
+
+   for (i = p_disp->num_batches; i-- > 0; )
+   {
+      gfx_display_batch_t *cur = &p_disp->batches[i];
+
+      if (     cur->texture == texture
+            && cur->width   == width
+            && cur->height  == height)
+      {
+         batch = cur;
+         break;
+      }
+
+      if (     bounds[0] < cur->bounds[2] && cur->bounds[0] < bounds[2]
+            && bounds[1] < cur->bounds[3] && cur->bounds[1] < bounds[3])
+         break;
+   }
+
+   if (!batch)
+   {
+      if (p_disp->num_batches == GFX_DISPLAY_MAX_BATCHES)
+         gfx_display_flush(p_disp);
+
+      batch             = &p_disp->batches[p_disp->num_batches++];
+      batch->texture    = texture;
+      batch->width      = width;
+      batch->height     = height;
+      batch->bounds[0]  = bounds[0];
+      batch->bounds[1]  = bounds[1];
+      batch->bounds[2]  = bounds[2];
+      batch->bounds[3]  = bounds[3];
+   }
+   else
+   {
+      batch->bounds[0]  = MIN(batch->bounds[0], bounds[0]);
+      batch->bounds[1]  = MIN(batch->bounds[1], bounds[1]);
+      batch->bounds[2]  = MAX(batch->bounds[2], bounds[2]);
+      batch->bounds[3]  = MAX(batch->bounds[3], bounds[3]);
+   }
+
+   for (i = 0; i < 6; i++)
+   {
+      unsigned v               = strip_to_triangles[i];
+      tri_vertex[i * 2 + 0]    = vertex[v * 2 + 0];
+      tri_vertex[i * 2 + 1]    = vertex[v * 2 + 1];
+      tri_tex_coord[i * 2 + 0] = tex_coord[v * 2 + 0];
+      tri_tex_coord[i * 2 + 1] = tex_coord[v * 2 + 1];
+      memcpy(&tri_color[i * 4], &color[v * 4], 4 * sizeof(float));
+   }
+
+   coords.vertex                = tri_vertex;
+   coords.tex_coord             = tri_tex_coord;
+   coords.lut_tex_coord         = tri_tex_coord;
+   coords.color                 = tri_color;
+   coords.vertices              = 6;
+
+   p_disp->batch_userdata       = userdata;
+   p_disp->batch_video_width    = video_width;
+   p_disp->batch_video_height   = video_height;
+
+   return video_coord_array_append(&batch->ca, &coords, 6);
+}
+
+void gfx_display_flush(gfx_display_t *p_disp)
+{
+   unsigned i;
+   gfx_display_ctx_driver_t *dispctx = p_disp->batch_dispctx;
+   void *userdata                    = p_disp->batch_userdata;
+   unsigned num_batches              = p_disp->num_batches;
+
+   if (!num_batches || !dispctx)
+      return;
+
+   p_disp->num_batches               = 0;
+
+   /* One blend state for everything, the batches
+    * themselves must stay in the order they were
+    * opened in */
+   if (dispctx->blend_begin)
+      dispctx->blend_begin(userdata);
+
+   for (i = 0; i < num_batches; i++)
+   {
+      gfx_display_ctx_draw_t draw;
+      struct video_coords coords;
+      gfx_display_batch_t *batch = &p_disp->batches[i];
+
+      if (!batch->ca.coords.vertices)
+         continue;
+
+      coords.vertices      = batch->ca.coords.vertices;
+      coords.vertex        = batch->ca.coords.vertex;
+      coords.tex_coord     = batch->ca.coords.tex_coord;
+      coords.lut_tex_coord = batch->ca.coords.lut_tex_coord;
+      coords.color         = batch->ca.coords.color;
+
+      draw.x               = 0;
+      draw.y               = 0;
+      draw.width           = batch->width;
+      draw.height          = batch->height;
+      draw.coords          = &coords;
+      draw.matrix_data     = NULL;
+      draw.texture         = batch->texture;
+      draw.prim_type       = GFX_DISPLAY_PRIM_TRIANGLES;
+      draw.pipeline_id     = 0;
+      draw.scale_factor    = 1.0f;
+      draw.rotation        = 0.0f;
+
+      dispctx->draw(&draw, userdata,
+            p_disp->batch_video_width, p_disp->batch_video_height);
+
+      batch->ca.coords.vertices = 0;
+   }
+
+   if (dispctx->blend_end)
+      dispctx->blend_end(userdata);
+}
+
+void gfx_display_batch_begin(gfx_display_t *p_disp)
+{
+   p_disp->batching = p_disp->batch_dispctx
+      && p_disp->dispctx == &p_disp->batch_wrapper;
+}
+
+void gfx_display_batch_end(gfx_display_t *p_disp)
+{
+   gfx_display_flush(p_disp);
+   p_disp->batching = false;
+}
+
+/* Wrapper entry points, anything the menu drivers draw
+ * directly has to land on top of the pending quads */
+static void gfx_display_batch_draw(gfx_display_ctx_draw_t *draw,
+      void *data, unsigned video_width, unsigned video_height)
+{
+   gfx_display_t *p_disp = disp_get_ptr();
+   gfx_display_flush(p_disp);
+   p_disp->batch_dispctx->draw(draw, data, video_width, video_height);
+}
+
+static void gfx_display_batch_draw_pipeline(gfx_display_ctx_draw_t *draw,
+      gfx_display_t *p_disp,
+      void *data, unsigned video_width, unsigned video_height)
+{
+   gfx_display_flush(p_disp);
+   p_disp->batch_dispctx->draw_pipeline(draw, p_disp,
+         data, video_width, video_height);
+}
+
+static void gfx_display_batch_blend_begin(void *data)
+{
+   gfx_display_t *p_disp = disp_get_ptr();
+   gfx_display_flush(p_disp);
+   p_disp->batch_dispctx->blend_begin(data);
+}
+
+static void gfx_display_batch_blend_end(void *data)
+{
+   gfx_display_t *p_disp = disp_get_ptr();
+   gfx_display_flush(p_disp);
+   p_disp->batch_dispctx->blend_end(data);
+}
+
+static void gfx_display_batch_scissor_begin(void *data,
+      unsigned video_width, unsigned video_height,
+      int x, int y, unsigned width, unsigned height)
+{
+   gfx_display_t *p_disp = disp_get_ptr();
+   gfx_display_flush(p_disp);
+   p_disp->batch_dispctx->scissor_begin(data,
+         video_width, video_height, x, y, width, height);
+}
+
+static void gfx_display_batch_scissor_end(void *data,
+      unsigned video_width, unsigned video_height)
+{
+   gfx_display_t *p_disp = disp_get_ptr();
+   gfx_display_flush(p_disp);
+   p_disp->batch_dispctx->scissor_end(data, video_width, video_height);
+}
+
+static void gfx_display_batch_wrap(gfx_display_t *p_disp,
+      gfx_display_ctx_driver_t *dispctx)
+{
+   gfx_display_ctx_driver_t *wrapper = &p_disp->batch_wrapper;
+
+   *wrapper                          = *dispctx;
+   wrapper->draw                     = gfx_display_batch_draw;
+   if (dispctx->draw_pipeline)
+      wrapper->draw_pipeline         = gfx_display_batch_draw_pipeline;
+   if (dispctx->blend_begin)
+      wrapper->blend_begin           = gfx_display_batch_blend_begin;
+   if (dispctx->blend_end)
+      wrapper->blend_end             = gfx_display_batch_blend_end;
+   if (dispctx->scissor_begin)
+      wrapper->scissor_begin         = gfx_display_batch_scissor_begin;
+   if (dispctx->scissor_end)
+      wrapper->scissor_end           = gfx_display_batch_scissor_end;
+
+   p_disp->batch_dispctx             = dispctx;
+   p_disp->dispctx                   = wrapper;
+}
+
 void gfx_display_draw_quad(
       gfx_display_t *p_disp,
       void *data,
@@ -545,6 +794,27 @@ void gfx_display_draw_quad(
    if (!dispctx)
       return;
 
+   if (p_disp->batching)
+   {
+      unsigned i;
+      float vertex[8];
+      const float *def_vertex    = dispctx->get_default_vertices();
+      const float *def_tex_coord = dispctx->get_default_tex_coords();
+
+      for (i = 0; i < 4; i++)
+      {
+         vertex[i * 2 + 0] = (x + def_vertex[i * 2 + 0] * w)
+            / (float)video_width;
+         vertex[i * 2 + 1] = ((int)height - y - (int)h
+               + def_vertex[i * 2 + 1] * h) / (float)video_height;
+      }
+
+      if (gfx_display_batch_add(p_disp, data, video_width, video_height,
+               video_width, video_height, gfx_display_white_texture,
+               vertex, def_tex_coord, color))
+         return;
+   }
+
    coords.vertices      = 4;
    coords.vertex        = NULL;
    coords.tex_coord     = NULL;
@@ -602,6 +872,12 @@ void gfx_display_draw_polygon(
    vertex[6]             = x4 / (float)width;
    vertex[7]             = y4 / (float)height;
 
+   if (p_disp->batching && gfx_display_batch_add(p_disp, userdata,
+            video_width, video_height, width, height,
+            gfx_display_white_texture, vertex,
+            dispctx->get_default_tex_coords(), color))
+      return;
+
    coords.vertices       = 4;
    coords.vertex         = &vertex[0];
    coords.tex_coord      = NULL;
@@ -1315,9 +1591,15 @@ void gfx_display_init_white_texture(uintptr_t white_texture)
 
 void gfx_display_free(void)
 {
+   unsigned i;
    gfx_display_t           *p_disp   = disp_get_ptr();
    video_coord_array_free(&p_disp->dispca);
+   for (i = 0; i < GFX_DISPLAY_MAX_BATCHES; i++)
+      video_coord_array_free(&p_disp->batches[i].ca);
 
+   p_disp->num_batches         = 0;
+   p_disp->batching            = false;
+   p_disp->batch_dispctx       = NULL;
    p_disp->msg_force           = false;
    p_disp->header_height       = 0;
    p_disp->framebuf_width      = 0;
@@ -1362,7 +1644,13 @@ bool gfx_display_init_first_driver(gfx_display_t *p_disp,
 
       RARCH_LOG("[Display]: Found display driver: \"%s\".\n",
             gfx_display_ctx_drivers[i]->ident);
-      p_disp->dispctx = gfx_display_ctx_drivers[i];
+      p_disp->dispctx       = gfx_display_ctx_drivers[i];
+      p_disp->batch_dispctx = NULL;
+      p_disp->batching      = false;
+      p_disp->num_batches   = 0;
+
+      if (p_disp->dispctx->supports_batching)
+         gfx_display_batch_wrap(p_disp, p_disp->dispctx);
       return true;
    }
    return false;
@@ -66,6 +66,10 @@ RETRO_BEGIN_DECLS
  * */
 #define GFX_DISPLAY_GET_UPDATE_PENDING(p_anim, p_disp) (ANIM_IS_ACTIVE(p_anim) || p_disp->framebuf_dirty)
 
+/* Number of texture/canvas combinations collected at once
+ * while batching, see gfx_display_batch_begin() */
+#define GFX_DISPLAY_MAX_BATCHES 4
+
 enum menu_driver_id_type
 {
    MENU_DRIVER_ID_UNKNOWN = 0,
@@ -147,6 +151,9 @@ typedef struct gfx_display_ctx_driver
          int x, int y, unsigned width, unsigned height);
    void (*scissor_end)(void *data, unsigned video_width,
          unsigned video_height);
+   /* draw() accepts GFX_DISPLAY_PRIM_TRIANGLES with any
+    * number of vertices, so quads can be batched */
+   bool supports_batching;
 } gfx_display_ctx_driver_t;
 
 struct gfx_display_ctx_draw
@@ -194,6 +201,17 @@ typedef struct gfx_display_ctx_datetime
    unsigned date_separator;
 } gfx_display_ctx_datetime_t;
 
+/* Quads sharing a texture and a canvas size, stored as
+ * GFX_DISPLAY_PRIM_TRIANGLES normalised to the canvas */
+typedef struct gfx_display_batch
+{
+   video_coord_array_t ca; /* ptr alignment */
+   uintptr_t texture;
+   float bounds[4];        /* x0, y0, x1, y1 in pixels */
+   unsigned width;
+   unsigned height;
+} gfx_display_batch_t;
+
 typedef struct gfx_display_ctx_powerstate
 {
    char *s;
@@ -206,7 +224,13 @@ typedef struct gfx_display_ctx_powerstate
 struct gfx_display
 {
    gfx_display_ctx_driver_t *dispctx;
+   /* Driver wrapped by dispctx when it supports batching */
+   gfx_display_ctx_driver_t *batch_dispctx;
+   void *batch_userdata;
    video_coord_array_t dispca; /* ptr alignment */
+   gfx_display_batch_t batches[GFX_DISPLAY_MAX_BATCHES]; /* ptr alignment */
+   /* Flushes pending batches before forwarding to batch_dispctx */
+   gfx_display_ctx_driver_t batch_wrapper;
 
    /* Width, height and pitch of the display framebuffer */
    size_t   framebuf_pitch;
@@ -218,9 +242,14 @@ struct gfx_display
 
    enum menu_driver_id_type menu_driver_id;
 
+   unsigned num_batches;
+   unsigned batch_video_width;
+   unsigned batch_video_height;
+
    bool has_windowed;
    bool msg_force;
    bool framebuf_dirty;
+   bool batching;
 };
 
 void gfx_display_free(void);
@@ -286,6 +315,23 @@ void gfx_display_draw_bg(
       void *userdata,
       bool add_opacity, float opacity_override);
 
+/**
+ * gfx_display_batch_begin:
+ * @p_disp           : display state.
+ *
+ * Until gfx_display_batch_end(), solid quads and polygons are
+ * collected instead of drawn one by one, if the display driver
+ * supports it. Anything else drawn through p_disp->dispctx,
+ * scissoring and immediate text rendering flush the pending
+ * quads first, so the drawing order is kept.
+ **/
+void gfx_display_batch_begin(gfx_display_t *p_disp);
+
+/* Draws all pending quads */
+void gfx_display_flush(gfx_display_t *p_disp);
+
+void gfx_display_batch_end(gfx_display_t *p_disp);
+
 void gfx_display_draw_quad(
       gfx_display_t *p_disp,
       void *data,
@@ -20,6 +20,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -33,6 +34,9 @@
 
 #include "gfx_thumbnail.h"
 
+#include "../configuration.h"
+#include "../memory_tags.h"
+
 #include "../tasks/tasks_internal.h"
 
 #define DEFAULT_GFX_THUMBNAIL_STREAM_DELAY  83.333333f
@@ -46,6 +50,13 @@ typedef struct
    gfx_thumbnail_t *thumbnail;
 } gfx_thumbnail_tag_t;
 
+/* Same for prefetches, which load into the cache */
+typedef struct
+{
+   uint64_t key;
+   unsigned generation;
+} gfx_thumbnail_prefetch_tag_t;
+
 /* Setters */
 
 /* When streaming thumbnails, sets time in ms that an
@@ -82,6 +93,262 @@ void gfx_thumbnail_set_fade_missing(bool fade_missing)
    p_gfx_thumb->fade_missing = fade_missing;
 }
 
+/* Texture cache */
+
+static uint64_t gfx_thumbnail_cache_key(const char *path,
+      unsigned gfx_thumbnail_upscale_threshold)
+{
+   /* 64 bit FNV-1a of the path, the upscale threshold
+    * changes the texture as well */
+   uint64_t hash = 0xcbf29ce484222325ULL;
+
+   for (; *path; path++)
+      hash = (hash ^ (uint8_t)*path) * 0x100000001b3ULL;
+   hash = (hash ^ gfx_thumbnail_upscale_threshold) * 0x100000001b3ULL;
+
+   /* 0 means 'not cached' */
+   return hash ? hash : 1;
+}
+
+/* Estimated texture size, including mipmaps */
+static size_t gfx_thumbnail_cache_texture_size(
+      unsigned width, unsigned height)
+{
+   return ((size_t)width * height * 4 * 4) / 3;
+}
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_find(
+      gfx_thumbnail_state_t *p_gfx_thumb, uint64_t key)
+{
+   size_t i;
+
+   for (i = 0; i < p_gfx_thumb->cache_count; i++)
+      if (p_gfx_thumb->cache[i].key == key)
+         return &p_gfx_thumb->cache[i];
+
+   return NULL;
+}
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_add(
+      gfx_thumbnail_state_t *p_gfx_thumb, uint64_t key)
+{
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+
+   if (p_gfx_thumb->cache_count == p_gfx_thumb->cache_capacity)
+   {
+      size_t capacity = p_gfx_thumb->cache_capacity
+         ? p_gfx_thumb->cache_capacity * 2 : 16;
+      gfx_thumbnail_cache_entry_t *cache = (gfx_thumbnail_cache_entry_t*)
+         realloc(p_gfx_thumb->cache, capacity * sizeof(*cache));
+
+      if (!cache)
+         return NULL;
+
+      p_gfx_thumb->cache          = cache;
+      p_gfx_thumb->cache_capacity = capacity;
+   }
+
+   entry            = &p_gfx_thumb->cache[p_gfx_thumb->cache_count++];
+   entry->key       = key;
+   entry->texture   = 0;
+   entry->size      = 0;
+   entry->width     = 0;
+   entry->height    = 0;
+   entry->last_used = p_gfx_thumb->cache_counter++;
+   entry->pending   = false;
+   return entry;
+}
+
+/* Removes an entry without unloading its texture */
+static void gfx_thumbnail_cache_remove(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   p_gfx_thumb->cache_size -= entry->size;
+   *entry = p_gfx_thumb->cache[--p_gfx_thumb->cache_count];
+}
+
+/* Evicts least recently used textures until
+ * the cache fits into its budget */
+static void gfx_thumbnail_cache_trim(gfx_thumbnail_state_t *p_gfx_thumb)
+{
+   while (p_gfx_thumb->cache_size > p_gfx_thumb->cache_budget)
+   {
+      size_t i;
+      gfx_thumbnail_cache_entry_t *oldest = NULL;
+
+      for (i = 0; i < p_gfx_thumb->cache_count; i++)
+      {
+         gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->cache[i];
+
+         if (entry->pending)
+            continue;
+
+         if (!oldest ||
+               (p_gfx_thumb->cache_counter - entry->last_used) >
+               (p_gfx_thumb->cache_counter - oldest->last_used))
+            oldest = entry;
+      }
+
+      if (!oldest)
+         break;
+
+      if (oldest->texture)
+      {
+         memory_tag_add(MEMORY_TAG_THUMBNAILS, -(int64_t)oldest->size);
+         video_driver_texture_unload(&oldest->texture);
+      }
+      gfx_thumbnail_cache_remove(p_gfx_thumb, oldest);
+   }
+}
+
+/* Hands the texture of a thumbnail that is being reset
+ * over to the cache. Returns false if the caller has to
+ * unload it. */
+static bool gfx_thumbnail_cache_store(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_t *thumbnail)
+{
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+
+   if (     !thumbnail->cache_key
+         || !p_gfx_thumb->cache_budget
+         ||  thumbnail->status != GFX_THUMBNAIL_STATUS_AVAILABLE)
+      return false;
+
+   if ((entry = gfx_thumbnail_cache_find(
+               p_gfx_thumb, thumbnail->cache_key)))
+   {
+      /* Same image is cached already */
+      if (!entry->pending)
+         return false;
+   }
+   else if (!(entry = gfx_thumbnail_cache_add(
+               p_gfx_thumb, thumbnail->cache_key)))
+      return false;
+
+   /* A pending prefetch of the same image
+    * is dropped once it completes */
+   entry->texture           = thumbnail->texture;
+   entry->width             = thumbnail->width;
+   entry->height            = thumbnail->height;
+   entry->size              = gfx_thumbnail_cache_texture_size(
+         thumbnail->width, thumbnail->height);
+   entry->last_used         = p_gfx_thumb->cache_counter++;
+   entry->pending           = false;
+   p_gfx_thumb->cache_size += entry->size;
+
+   gfx_thumbnail_cache_trim(p_gfx_thumb);
+   return true;
+}
+
+/* Moves a cached texture to 'thumbnail',
+ * returns false if it is not cached */
+static bool gfx_thumbnail_cache_take(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      uint64_t key, gfx_thumbnail_t *thumbnail)
+{
+   gfx_thumbnail_cache_entry_t *entry =
+      gfx_thumbnail_cache_find(p_gfx_thumb, key);
+
+   if (!entry || entry->pending)
+      return false;
+
+   thumbnail->cache_key = key;
+   thumbnail->texture   = entry->texture;
+   thumbnail->width     = entry->width;
+   thumbnail->height    = entry->height;
+   thumbnail->status    = GFX_THUMBNAIL_STATUS_AVAILABLE;
+
+   gfx_thumbnail_cache_remove(p_gfx_thumb, entry);
+   return true;
+}
+
+/* Sets the size in bytes that textures of thumbnails
+ * no longer shown may use, 0 disables the cache */
+void gfx_thumbnail_set_cache_budget(size_t budget)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   p_gfx_thumb->cache_budget = budget;
+   gfx_thumbnail_cache_trim(p_gfx_thumb);
+}
+
+/* Unloads all cached textures
+ * >> **MUST** be called before the video context
+ *    is destroyed, after the menu driver has reset
+ *    its thumbnails */
+void gfx_thumbnail_cache_flush(void)
+{
+   size_t i;
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   for (i = 0; i < p_gfx_thumb->cache_count; i++)
+   {
+      if (p_gfx_thumb->cache[i].texture)
+      {
+         memory_tag_add(MEMORY_TAG_THUMBNAILS,
+               -(int64_t)p_gfx_thumb->cache[i].size);
+         video_driver_texture_unload(&p_gfx_thumb->cache[i].texture);
+      }
+   }
+
+   free(p_gfx_thumb->cache);
+   free(p_gfx_thumb->prefetch_path_data);
+
+   p_gfx_thumb->cache              = NULL;
+   p_gfx_thumb->prefetch_path_data = NULL;
+   p_gfx_thumb->cache_count        = 0;
+   p_gfx_thumb->cache_capacity     = 0;
+   p_gfx_thumb->cache_size         = 0;
+   p_gfx_thumb->cache_generation++;
+}
+
+/* Image loading */
+
+/* Loads 'path' through a downscaled copy in the cache
+ * directory below the thumbnails directory. Menus never
+ * show thumbnails larger than half the screen, so there
+ * is no point in decoding and uploading full size boxart
+ * every time. */
+static bool gfx_thumbnail_push_image_load(const char *path,
+      unsigned gfx_thumbnail_upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+   char sidecar_dir[PATH_MAX_LENGTH];
+   char sidecar_name[32];
+   char sidecar_path[PATH_MAX_LENGTH];
+   unsigned width           = 0;
+   unsigned height          = 0;
+   unsigned max_size        = 0;
+   uint64_t key             = 0;
+   settings_t *settings     = config_get_ptr();
+   const char *dir_thumbs   = settings->paths.directory_thumbnails;
+   bool supports_rgba       = video_driver_supports_rgba();
+
+   video_driver_get_size(&width, &height);
+
+   if (string_is_empty(dir_thumbs) || (height < 1))
+      return task_push_image_load(path, supports_rgba,
+            gfx_thumbnail_upscale_threshold, cb, user_data);
+
+   /* Round up, so that small changes of the window
+    * size keep using the same copies */
+   max_size = ((height / 2 + 127) / 128) * 128;
+
+   key      = gfx_thumbnail_cache_key(path, 0);
+   snprintf(sidecar_name, sizeof(sidecar_name), "%08x%08x.rgba",
+         (unsigned)(key >> 32), (unsigned)key);
+
+   fill_pathname_join(sidecar_dir, dir_thumbs, ".cache",
+         sizeof(sidecar_dir));
+   fill_pathname_join(sidecar_path, sidecar_dir, sidecar_name,
+         sizeof(sidecar_path));
+
+   return task_push_image_load_sidecar(path, sidecar_path, max_size,
+         supports_rgba, gfx_thumbnail_upscale_threshold, cb, user_data);
+}
+
 /* Callbacks */
 
 /* Fade animation callback - simply resets thumbnail
@@ -187,6 +454,9 @@ static void gfx_thumbnail_handle_upload(
    thumbnail_tag->thumbnail->width  = img->width;
    thumbnail_tag->thumbnail->height = img->height;
 
+   memory_tag_add(MEMORY_TAG_THUMBNAILS, (int64_t)
+         gfx_thumbnail_cache_texture_size(img->width, img->height));
+
    /* Update thumbnail status */
    thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
 
@@ -209,6 +479,57 @@ end:
    }
 }
 
+/* Used to process thumbnail data following completion
+ * of a prefetch */
+static void gfx_thumbnail_handle_prefetch(
+      retro_task_t *task, void *task_data, void *user_data, const char *err)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb         = gfx_thumb_get_ptr();
+   struct texture_image *img                  = (struct texture_image*)task_data;
+   gfx_thumbnail_prefetch_tag_t *prefetch_tag = (gfx_thumbnail_prefetch_tag_t*)user_data;
+   gfx_thumbnail_cache_entry_t *entry         = NULL;
+
+   if (!prefetch_tag)
+      goto end;
+
+   if (prefetch_tag->generation != p_gfx_thumb->cache_generation)
+      goto end;
+
+   /* Entry is no longer pending if the thumbnail
+    * was loaded and cached in the meantime */
+   if (!(entry = gfx_thumbnail_cache_find(p_gfx_thumb, prefetch_tag->key))
+         || !entry->pending)
+      goto end;
+
+   if (     !img || (img->width < 1) || (img->height < 1)
+         || !video_driver_texture_load(
+            img, TEXTURE_FILTER_MIPMAP_LINEAR, &entry->texture))
+   {
+      gfx_thumbnail_cache_remove(p_gfx_thumb, entry);
+      goto end;
+   }
+
+   entry->width             = img->width;
+   entry->height            = img->height;
+   entry->size              = gfx_thumbnail_cache_texture_size(
+         img->width, img->height);
+   entry->pending           = false;
+   p_gfx_thumb->cache_size += entry->size;
+
+   memory_tag_add(MEMORY_TAG_THUMBNAILS, (int64_t)entry->size);
+
+   gfx_thumbnail_cache_trim(p_gfx_thumb);
+
+end:
+   if (img)
+   {
+      image_texture_free(img);
+      free(img);
+   }
+
+   free(prefetch_tag);
+}
+
 /* Core interface */
 
 /* When called, prevents the handling of any pending
@@ -266,6 +587,14 @@ void gfx_thumbnail_request(
    /* Load thumbnail, if required */
    if (has_thumbnail)
    {
+      uint64_t cache_key = gfx_thumbnail_cache_key(
+            thumbnail_path, gfx_thumbnail_upscale_threshold);
+
+      /* Texture may still be around from the last
+       * time this entry was shown */
+      if (gfx_thumbnail_cache_take(p_gfx_thumb, cache_key, thumbnail))
+         goto end;
+
       if (path_is_valid(thumbnail_path))
       {
          gfx_thumbnail_tag_t *thumbnail_tag =
@@ -280,11 +609,13 @@ void gfx_thumbnail_request(
 
          /* Would like to cancel any existing image load tasks
           * here, but can't see how to do it... */
-         if (task_push_image_load(
-               thumbnail_path, video_driver_supports_rgba(),
-               gfx_thumbnail_upscale_threshold,
+         if (gfx_thumbnail_push_image_load(
+               thumbnail_path, gfx_thumbnail_upscale_threshold,
                gfx_thumbnail_handle_upload, thumbnail_tag))
-            thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+         {
+            thumbnail->status    = GFX_THUMBNAIL_STATUS_PENDING;
+            thumbnail->cache_key = cache_key;
+         }
       }
 #ifdef HAVE_NETWORKING
       /* Handle on demand thumbnail downloads */
@@ -380,9 +711,8 @@ void gfx_thumbnail_request_file(
 
    /* Would like to cancel any existing image load tasks
     * here, but can't see how to do it... */
-   if (task_push_image_load(
-         file_path, video_driver_supports_rgba(),
-         gfx_thumbnail_upscale_threshold,
+   if (gfx_thumbnail_push_image_load(
+         file_path, gfx_thumbnail_upscale_threshold,
          gfx_thumbnail_handle_upload, thumbnail_tag))
       thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
 }
@@ -394,9 +724,15 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    if (!thumbnail)
       return;
 
-   /* Unload texture */
-   if (thumbnail->texture)
+   /* Unload texture, unless the cache keeps it */
+   if (thumbnail->texture &&
+         !gfx_thumbnail_cache_store(gfx_thumb_get_ptr(), thumbnail))
+   {
+      memory_tag_add(MEMORY_TAG_THUMBNAILS, -(int64_t)
+            gfx_thumbnail_cache_texture_size(
+               thumbnail->width, thumbnail->height));
       video_driver_texture_unload(&thumbnail->texture);
+   }
 
    /* Ensure any 'fade in' animation is killed */
    if (thumbnail->fade_active)
@@ -407,6 +743,7 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
 
    /* Reset all parameters */
    thumbnail->status      = GFX_THUMBNAIL_STATUS_UNKNOWN;
+   thumbnail->cache_key   = 0;
    thumbnail->texture     = 0;
    thumbnail->width       = 0;
    thumbnail->height      = 0;
@@ -415,6 +752,90 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    thumbnail->fade_active = false;
 }
 
+/* Loads the thumbnails of playlist entry 'idx' into the
+ * cache ahead of time, so they are available as soon as
+ * the entry is selected or scrolled into view.
+ * NOTE: Must be called *after* gfx_thumbnail_set_system(),
+ *       'path_data' itself is not modified */
+void gfx_thumbnail_prefetch(
+      gfx_thumbnail_path_data_t *path_data,
+      playlist_t *playlist, size_t idx,
+      unsigned gfx_thumbnail_upscale_threshold)
+{
+   unsigned i;
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   gfx_thumbnail_path_data_t *prefetch_path_data = NULL;
+
+   if (!path_data || !playlist || !p_gfx_thumb->cache_budget)
+      return;
+
+   if (idx >= playlist_get_size(playlist))
+      return;
+
+   if (!p_gfx_thumb->prefetch_path_data &&
+       !(p_gfx_thumb->prefetch_path_data = gfx_thumbnail_path_init()))
+      return;
+
+   /* Work on a copy, the menu driver keeps
+    * the content of the selected entry in its own */
+   prefetch_path_data = p_gfx_thumb->prefetch_path_data;
+   gfx_thumbnail_path_copy(prefetch_path_data, path_data);
+
+   if (!gfx_thumbnail_set_content_playlist(prefetch_path_data, playlist, idx))
+      return;
+
+   for (i = 0; i < 2; i++)
+   {
+      gfx_thumbnail_cache_entry_t *entry          = NULL;
+      gfx_thumbnail_prefetch_tag_t *prefetch_tag  = NULL;
+      const char *thumbnail_path                  = NULL;
+      enum gfx_thumbnail_id thumbnail_id          = i
+            ? GFX_THUMBNAIL_LEFT : GFX_THUMBNAIL_RIGHT;
+      uint64_t cache_key;
+
+      if (     !gfx_thumbnail_is_enabled(prefetch_path_data, thumbnail_id)
+            || !gfx_thumbnail_update_path(prefetch_path_data, thumbnail_id)
+            || !gfx_thumbnail_get_path(prefetch_path_data, thumbnail_id,
+               &thumbnail_path))
+         continue;
+
+      cache_key = gfx_thumbnail_cache_key(
+            thumbnail_path, gfx_thumbnail_upscale_threshold);
+
+      /* Already cached or loading */
+      if ((entry = gfx_thumbnail_cache_find(p_gfx_thumb, cache_key)))
+      {
+         entry->last_used = p_gfx_thumb->cache_counter++;
+         continue;
+      }
+
+      if (!path_is_valid(thumbnail_path))
+         continue;
+
+      if (!(prefetch_tag = (gfx_thumbnail_prefetch_tag_t*)
+               malloc(sizeof(*prefetch_tag))))
+         return;
+
+      if (!(entry = gfx_thumbnail_cache_add(p_gfx_thumb, cache_key)))
+      {
+         free(prefetch_tag);
+         return;
+      }
+
+      entry->pending           = true;
+      prefetch_tag->key        = cache_key;
+      prefetch_tag->generation = p_gfx_thumb->cache_generation;
+
+      if (!gfx_thumbnail_push_image_load(
+            thumbnail_path, gfx_thumbnail_upscale_threshold,
+            gfx_thumbnail_handle_prefetch, prefetch_tag))
+      {
+         gfx_thumbnail_cache_remove(p_gfx_thumb, entry);
+         free(prefetch_tag);
+      }
+   }
+}
+
 /* Stream processing */
 
 /* Handles streaming of the specified thumbnail as it moves
@@ -67,6 +67,9 @@ enum gfx_thumbnail_shadow_type
  * an entry thumbnail */
 typedef struct
 {
+   /* Identifies the image in the texture cache,
+    * 0 if the texture must not be cached */
+   uint64_t cache_key;
    uintptr_t texture;
    unsigned width;
    unsigned height;
@@ -76,6 +79,20 @@ typedef struct
    bool fade_active;
 } gfx_thumbnail_t;
 
+/* Texture kept by the thumbnail cache after
+ * its thumbnail was reset */
+typedef struct
+{
+   uint64_t key;
+   uintptr_t texture;
+   size_t size;
+   unsigned width;
+   unsigned height;
+   unsigned last_used;
+   /* Image is still loading (prefetch) */
+   bool pending;
+} gfx_thumbnail_cache_entry_t;
+
 /* Holds all configuration parameters associated
  * with a thumbnail shadow effect */
 typedef struct
@@ -118,6 +135,22 @@ struct gfx_thumbnail_state
    /* Duration in ms of the thumbnail 'fade in' animation */
    float fade_duration;
 
+   /* Playlist thumbnails scrolled out of view keep their
+    * textures here, so scrolling back does not load and
+    * decode the images again. Shared by all menu drivers,
+    * entries are evicted least recently used first once
+    * the estimated size exceeds 'cache_budget' bytes */
+   gfx_thumbnail_cache_entry_t *cache;
+   gfx_thumbnail_path_data_t *prefetch_path_data;
+   size_t cache_count;
+   size_t cache_capacity;
+   size_t cache_size;
+   size_t cache_budget;
+   unsigned cache_counter;
+   /* Incremented when the cache is flushed, so
+    * prefetches from before that are dropped */
+   unsigned cache_generation;
+
    /* When true, 'fade in' animation will also be
     * triggered for missing thumbnails */
    bool fade_missing;
@@ -190,6 +223,28 @@ void gfx_thumbnail_request_file(
  * specified thumbnail */
 void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail);
 
+/* Texture cache */
+
+/* Sets the size in bytes that textures of thumbnails
+ * no longer shown may use, 0 disables the cache */
+void gfx_thumbnail_set_cache_budget(size_t budget);
+
+/* Loads the thumbnails of playlist entry 'idx' into the
+ * cache ahead of time, so they are available as soon as
+ * the entry is selected or scrolled into view.
+ * NOTE: Must be called *after* gfx_thumbnail_set_system(),
+ *       'path_data' itself is not modified */
+void gfx_thumbnail_prefetch(
+      gfx_thumbnail_path_data_t *path_data,
+      playlist_t *playlist, size_t idx,
+      unsigned gfx_thumbnail_upscale_threshold);
+
+/* Unloads all cached textures
+ * >> **MUST** be called before the video context
+ *    is destroyed, after the menu driver has reset
+ *    its thumbnails */
+void gfx_thumbnail_cache_flush(void);
+
 /* Stream processing */
 
 /* Handles streaming of the specified thumbnail as it moves
@@ -90,6 +90,14 @@ gfx_thumbnail_path_data_t *gfx_thumbnail_path_init(void)
    return path_data;
 }
 
+/* Copies all settings and content of 'src' to 'dst' */
+void gfx_thumbnail_path_copy(gfx_thumbnail_path_data_t *dst,
+      const gfx_thumbnail_path_data_t *src)
+{
+   if (dst && src)
+      memcpy(dst, src, sizeof(*dst));
+}
+
 
 /* Utility Functions */
 
@@ -58,6 +58,10 @@ typedef struct gfx_thumbnail_path_data gfx_thumbnail_path_data_t;
  * Note: Returned object must be free()d */
 gfx_thumbnail_path_data_t *gfx_thumbnail_path_init(void);
 
+/* Copies all settings and content of 'src' to 'dst' */
+void gfx_thumbnail_path_copy(gfx_thumbnail_path_data_t *dst,
+      const gfx_thumbnail_path_data_t *src);
+
 /* Resets thumbnail path data
  * (blanks all internal string containers) */
 void gfx_thumbnail_path_reset(gfx_thumbnail_path_data_t *path_data);
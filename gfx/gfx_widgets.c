@@ -1580,6 +1580,43 @@ static void INLINE gfx_widgets_font_unbind(gfx_widget_font_data_t *font_data)
    font_driver_bind_block(font_data->font, NULL);
 }
 
+/* Returns true if anything at all is going to be
+ * drawn this frame */
+static bool gfx_widgets_frame_is_active(
+      dispgfx_widget_t *p_dispwidget,
+      video_frame_info_t *video_info)
+{
+   size_t i;
+
+   if (     video_info->fps_show
+         || video_info->framecount_show
+         || video_info->memory_show
+         || video_info->core_status_msg_show
+         || video_info->widgets_is_paused
+         || video_info->widgets_is_fast_forwarding
+         || video_info->widgets_is_rewinding
+         || video_info->runloop_is_slowmotion
+         || p_dispwidget->current_msgs_size)
+      return true;
+
+#ifdef HAVE_TRANSLATE
+   if (p_dispwidget->ai_service_overlay_state > 0)
+      return true;
+#endif
+
+   for (i = 0; i < ARRAY_SIZE(widgets); i++)
+   {
+      const gfx_widget_t* widget = widgets[i];
+
+      if (!widget->frame)
+         continue;
+      if (!widget->is_active || widget->is_active())
+         return true;
+   }
+
+   return false;
+}
+
 void gfx_widgets_frame(void *data)
 {
    size_t i;
@@ -1607,8 +1644,17 @@ void gfx_widgets_frame(void *data)
    if (menu_screensaver_active)
       return;
 
+   /* Nothing visible: skip the viewport switch and
+    * font binding altogether */
+   if (!gfx_widgets_frame_is_active(p_dispwidget, video_info))
+      return;
+
    video_driver_set_viewport(video_width, video_height, true, false);
 
+   /* Backdrops and quads of all widgets are collected
+    * into as few draws as the display driver allows */
+   gfx_display_batch_begin(p_disp);
+
    /* Font setup */
    gfx_widgets_font_bind(&p_dispwidget->gfx_widget_fonts.regular);
    gfx_widgets_font_bind(&p_dispwidget->gfx_widget_fonts.bold);
@@ -1860,6 +1906,8 @@ void gfx_widgets_frame(void *data)
    gfx_widgets_flush_text(video_width, video_height,
          &p_dispwidget->gfx_widget_fonts.msg_queue);
 
+   gfx_display_batch_end(p_disp);
+
    /* Unbind fonts */
    gfx_widgets_font_unbind(&p_dispwidget->gfx_widget_fonts.regular);
    gfx_widgets_font_unbind(&p_dispwidget->gfx_widget_fonts.bold);
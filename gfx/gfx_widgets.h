@@ -272,6 +272,12 @@ struct gfx_widget
     * -- userdata is a dispgfx_widget_t
     * -> draw the widget here */
    void (*frame)(void* data, void *userdata);
+
+   /* called every frame before frame()
+    * (on the video thread if threaded video is on)
+    * -> return true if the widget has anything to draw;
+    *    NULL means the widget is always drawn */
+   bool (*is_active)(void);
 };
 
 float gfx_widgets_get_thumbnail_scale_factor(
@@ -68,6 +68,16 @@ enum rotation
    ORIENTATION_END
 };
 
+enum screenshot_mode_type
+{
+   SCREENSHOT_MODE_PNG = 0,
+   /* Multi-threaded deflate at the fastest level */
+   SCREENSHOT_MODE_PNG_FAST,
+   /* Uncompressed, for burst capture */
+   SCREENSHOT_MODE_BMP,
+   SCREENSHOT_MODE_LAST
+};
+
 enum rarch_display_type
 {
    /* Non-bindable types like consoles, KMS, VideoCore, etc. */
@@ -59,49 +59,36 @@ struct rarch_softfilter
    struct softfilter_work_packet *packets;
    unsigned threads;
 
+   /* Smoothed time spent in rarch_softfilter_process() */
+   float process_time_usec;
+
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   struct filter_tile *tiles;
+   /* Tracks this filter's tiles on the shared pool */
+   struct tpool_group *group;
 #endif
 };
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+
+/* Filters are asked for this many work packets per core, smaller
+ * tiles keep all workers busy when some rows cost more than others */
+#define SOFTFILTER_TILES_PER_THREAD 4
 
-struct filter_thread_data
+struct filter_tile
 {
-   sthread_t *thread;
    const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
    void *userdata;
-   bool die;
-   bool done;
 };
 
-static void filter_thread_loop(void *data)
+static void softfilter_tile_work(void *data)
 {
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
-
-   for (;;)
-   {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
-         break;
+   struct filter_tile *tile = (struct filter_tile*)data;
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
-
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
-   }
+   if (tile->packet->work)
+      tile->packet->work(tile->userdata, tile->packet->thread_data);
 }
 #endif
 
@@ -208,11 +195,18 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = cpu_features_get_core_amount();
+#ifdef HAVE_THREADS
+   if (threads > 1)
+      threads *= SOFTFILTER_TILES_PER_THREAD;
+#else
+   threads = 1;
+#endif
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads :
-         cpu_features_get_core_amount(), cpu_features,
-         &userdata);
+         threads, cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("Failed to create softfilter state.\n");
@@ -227,7 +221,7 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    }
 
    filt->threads = threads;
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
+   RARCH_LOG("Using %u work packets for softfilter.\n", threads);
 
    filt->packets = (struct softfilter_work_packet*)
       calloc(threads, sizeof(*filt->packets));
@@ -240,26 +234,22 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
 #ifdef HAVE_THREADS
    if (filt->threads > 1)
    {
-      filt->thread_data = (struct filter_thread_data*)
-         calloc(threads, sizeof(*filt->thread_data));
-      if (!filt->thread_data)
+      filt->tiles = (struct filter_tile*)
+         calloc(threads, sizeof(*filt->tiles));
+      if (!filt->tiles)
          return false;
 
       for (i = 0; i < threads; i++)
       {
-         filt->thread_data[i].userdata = filt->impl_data;
-         filt->thread_data[i].done     = true;
-
-         filt->thread_data[i].lock     = slock_new();
-         if (!filt->thread_data[i].lock)
-            return false;
-         filt->thread_data[i].cond     = scond_new();
-         if (!filt->thread_data[i].cond)
-            return false;
-         filt->thread_data[i].thread   = sthread_create(
-               filter_thread_loop, &filt->thread_data[i]);
-         if (!filt->thread_data[i].thread)
-            return false;
+         filt->tiles[i].packet   = &filt->packets[i];
+         filt->tiles[i].userdata = filt->impl_data;
+      }
+
+      /* Run everything on the calling thread without a pool */
+      if (!tpool_shared() || !(filt->group = tpool_group_new()))
+      {
+         free(filt->tiles);
+         filt->tiles = NULL;
       }
    }
 #endif
@@ -499,24 +489,10 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
 #endif
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
-   {
-      for (i = 0; i < filt->threads; i++)
-      {
-         if (!&filt->thread_data[i])
-            continue;
-         if (!filt->thread_data[i].thread)
-            continue;
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].die = true;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-         sthread_join(filt->thread_data[i].thread);
-         slock_free(filt->thread_data[i].lock);
-         scond_free(filt->thread_data[i].cond);
-      }
-      free(filt->thread_data);
-   }
+   if (filt->tiles)
+      free(filt->tiles);
+   if (filt->group)
+      tpool_group_free(filt->group);
 #endif
 
    if (filt->conf)
@@ -553,45 +529,45 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
       size_t input_stride)
 {
    unsigned i;
+   retro_time_t start;
 
    if (!filt)
       return;
 
+   start = cpu_features_get_time_usec();
+
    if (filt->impl && filt->impl->get_work_packets)
       filt->impl->get_work_packets(filt->impl_data, filt->packets,
             output, output_stride, input, width, height, input_stride);
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
+   if (filt->tiles)
    {
-      /* Fire off workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-         filt->thread_data[i].packet = &filt->packets[i];
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].done = false;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      /* Idle workers pick up the next tile, the calling thread
+       * helps out while waiting for the rest of them */
+      tpool_t *pool = tpool_shared();
 
-      /* Wait for workers */
       for (i = 0; i < filt->threads; i++)
       {
-#if 0
-         RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-         slock_lock(filt->thread_data[i].lock);
-         while (!filt->thread_data[i].done)
-            scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-         slock_unlock(filt->thread_data[i].lock);
+         if (!tpool_group_add_work(pool, filt->group,
+                  softfilter_tile_work, &filt->tiles[i]))
+            softfilter_tile_work(&filt->tiles[i]);
       }
-      return;
+      tpool_group_wait(pool, filt->group);
    }
+   else
 #endif
-
    for (i = 0; i < filt->threads; i++)
       filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
+
+   filt->process_time_usec += ((float)(cpu_features_get_time_usec() - start)
+         - filt->process_time_usec) / 16.0f;
+}
+
+float rarch_softfilter_get_process_time(rarch_softfilter_t *filt,
+      const char **ident)
+{
+   if (ident)
+      *ident = (filt->impl && filt->impl->ident) ? filt->impl->ident : "";
+   return filt->process_time_usec / 1000.0f;
 }
@@ -50,6 +50,11 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride);
 
+/* Returns the smoothed time spent per frame in rarch_softfilter_process()
+ * in milliseconds, @ident receives the filter's name */
+float rarch_softfilter_get_process_time(rarch_softfilter_t *filt,
+      const char **ident);
+
 const char *rarch_softfilter_get_name(void *data);
 
 RETRO_END_DECLS
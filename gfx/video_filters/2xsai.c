@@ -15,6 +15,7 @@
  */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -288,6 +289,124 @@ static void twoxsai_generic_rgb565(unsigned width, unsigned height,
    }
 }
 
+#ifdef SOFTFILTER_SIMD_MASK
+/* Flat runs are written with SIMD, the rest of each
+ * group falls back to the generic per-pixel code */
+static void twoxsai_simd_xrgb8888(unsigned width, unsigned height,
+      int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   unsigned finish;
+   unsigned nextline = (last) ? 0 : src_stride;
+
+   for (; height; height--)
+   {
+      uint32_t *in  = (uint32_t*)src;
+      uint32_t *out = (uint32_t*)dst;
+
+      for (finish = width; finish > SOFTFILTER_SIMD_PIXELS_XRGB8888; )
+      {
+         unsigned i;
+
+         finish -= SOFTFILTER_SIMD_PIXELS_XRGB8888;
+
+         if (softfilter_simd_flat2x_xrgb8888(in, nextline, out, dst_stride))
+         {
+            in  += SOFTFILTER_SIMD_PIXELS_XRGB8888;
+            out += SOFTFILTER_SIMD_PIXELS_XRGB8888 * 2;
+            continue;
+         }
+
+         for (i = 0; i < SOFTFILTER_SIMD_PIXELS_XRGB8888; i++)
+         {
+            twoxsai_declare_variables(uint32_t, in, nextline);
+            twoxsai_function(twoxsai_result, twoxsai_interpolate_xrgb8888,
+                  twoxsai_interpolate2_xrgb8888);
+         }
+      }
+
+      for (; finish; finish -= 1)
+      {
+         twoxsai_declare_variables(uint32_t, in, nextline);
+         twoxsai_function(twoxsai_result, twoxsai_interpolate_xrgb8888,
+               twoxsai_interpolate2_xrgb8888);
+      }
+
+      src += src_stride;
+      dst += 2 * dst_stride;
+   }
+}
+
+static void twoxsai_simd_rgb565(unsigned width, unsigned height,
+      int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   unsigned finish;
+   unsigned nextline = (last) ? 0 : src_stride;
+
+   for (; height; height--)
+   {
+      uint16_t *in  = (uint16_t*)src;
+      uint16_t *out = (uint16_t*)dst;
+
+      for (finish = width; finish > SOFTFILTER_SIMD_PIXELS_RGB565; )
+      {
+         unsigned i;
+
+         finish -= SOFTFILTER_SIMD_PIXELS_RGB565;
+
+         if (softfilter_simd_flat2x_rgb565(in, nextline, out, dst_stride))
+         {
+            in  += SOFTFILTER_SIMD_PIXELS_RGB565;
+            out += SOFTFILTER_SIMD_PIXELS_RGB565 * 2;
+            continue;
+         }
+
+         for (i = 0; i < SOFTFILTER_SIMD_PIXELS_RGB565; i++)
+         {
+            twoxsai_declare_variables(uint16_t, in, nextline);
+            twoxsai_function(twoxsai_result, twoxsai_interpolate_rgb565,
+                  twoxsai_interpolate2_rgb565);
+         }
+      }
+
+      for (; finish; finish -= 1)
+      {
+         twoxsai_declare_variables(uint16_t, in, nextline);
+         twoxsai_function(twoxsai_result, twoxsai_interpolate_rgb565,
+               twoxsai_interpolate2_rgb565);
+      }
+
+      src += src_stride;
+      dst += 2 * dst_stride;
+   }
+}
+
+static void twoxsai_simd_work_cb_rgb565(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+
+   twoxsai_simd_rgb565(thr->width, thr->height,
+         thr->first, thr->last, (uint16_t*)thr->in_data,
+         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
+         (uint16_t*)thr->out_data,
+         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
+}
+
+static void twoxsai_simd_work_cb_xrgb8888(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+
+   twoxsai_simd_xrgb8888(thr->width, thr->height,
+         thr->first, thr->last, (uint32_t*)thr->in_data,
+         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
+         (uint32_t*)thr->out_data,
+         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
+}
+#endif
+
 static void twoxsai_work_cb_rgb565(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr =
@@ -320,11 +439,12 @@ static void twoxsai_work_cb_xrgb8888(void *data, void *thread_data)
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
 }
 
-static void twoxsai_generic_packets(void *data,
+static void twoxsai_packets(void *data,
       struct softfilter_work_packet *packets,
       void *output, size_t output_stride,
       const void *input, unsigned width,
-      unsigned height, size_t input_stride)
+      unsigned height, size_t input_stride,
+      softfilter_work_t work_rgb565, softfilter_work_t work_xrgb8888)
 {
    unsigned i;
    struct filter_data *filt = (struct filter_data*)data;
@@ -351,17 +471,41 @@ static void twoxsai_generic_packets(void *data,
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
-         packets[i].work = twoxsai_work_cb_rgb565;
+         packets[i].work = work_rgb565;
 #if 0
       else if (filt->in_fmt == SOFTFILTER_FMT_RGB4444)
          packets[i].work = twoxsai_work_cb_rgb4444;
 #endif
       else if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
-         packets[i].work = twoxsai_work_cb_xrgb8888;
+         packets[i].work = work_xrgb8888;
       packets[i].thread_data = thr;
    }
 }
 
+static void twoxsai_generic_packets(void *data,
+      struct softfilter_work_packet *packets,
+      void *output, size_t output_stride,
+      const void *input, unsigned width,
+      unsigned height, size_t input_stride)
+{
+   twoxsai_packets(data, packets, output, output_stride,
+         input, width, height, input_stride,
+         twoxsai_work_cb_rgb565, twoxsai_work_cb_xrgb8888);
+}
+
+#ifdef SOFTFILTER_SIMD_MASK
+static void twoxsai_simd_packets(void *data,
+      struct softfilter_work_packet *packets,
+      void *output, size_t output_stride,
+      const void *input, unsigned width,
+      unsigned height, size_t input_stride)
+{
+   twoxsai_packets(data, packets, output, output_stride,
+         input, width, height, input_stride,
+         twoxsai_simd_work_cb_rgb565, twoxsai_simd_work_cb_xrgb8888);
+}
+#endif
+
 static const struct softfilter_implementation twoxsai_generic = {
    twoxsai_generic_input_fmts,
    twoxsai_generic_output_fmts,
@@ -377,10 +521,30 @@ static const struct softfilter_implementation twoxsai_generic = {
    "2xsai",
 };
 
+#ifdef SOFTFILTER_SIMD_MASK
+static const struct softfilter_implementation twoxsai_simd = {
+   twoxsai_generic_input_fmts,
+   twoxsai_generic_output_fmts,
+
+   twoxsai_generic_create,
+   twoxsai_generic_destroy,
+
+   twoxsai_generic_threads,
+   twoxsai_generic_output,
+   twoxsai_simd_packets,
+   SOFTFILTER_API_VERSION,
+   "2xSaI",
+   "2xsai",
+};
+#endif
+
 const struct softfilter_implementation *softfilter_get_implementation(
       softfilter_simd_mask_t simd)
 {
-   (void)simd;
+#ifdef SOFTFILTER_SIMD_MASK
+   if (simd & SOFTFILTER_SIMD_MASK)
+      return &twoxsai_simd;
+#endif
    return &twoxsai_generic;
 }
 
@@ -15,6 +15,7 @@
  */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 
 #ifdef RARCH_INTERNAL
@@ -191,6 +192,249 @@ static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
    }
 }
 
+#ifdef SOFTFILTER_SIMD_MASK
+/* Same as one iteration of the generic loops, for the border
+ * pixels the SIMD groups don't cover */
+static INLINE void lq2x_pixel_rgb565(const uint16_t *src,
+      unsigned x, unsigned width, int prevline, int nextline,
+      uint16_t *out0, uint16_t *out1)
+{
+   uint16_t A = *(src + x - prevline);
+   uint16_t B = (x > 0) ? *(src + x - 1) : *(src + x);
+   uint16_t C = *(src + x);
+   uint16_t D = (x < width - 1) ? *(src + x + 1) : *(src + x);
+   uint16_t E = *(src + x + nextline);
+
+   out0 += x << 1;
+   out1 += x << 1;
+
+   if (A != E && B != D)
+   {
+      out0[0] = (A == B ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : C);
+      out0[1] = (A == D ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : C);
+      out1[0] = (E == B ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : C);
+      out1[1] = (E == D ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : C);
+   }
+   else
+      out0[0] = out0[1] = out1[0] = out1[1] = C;
+}
+
+static INLINE void lq2x_pixel_xrgb8888(const uint32_t *src,
+      unsigned x, unsigned width, int prevline, int nextline,
+      uint32_t *out0, uint32_t *out1)
+{
+   uint32_t A = *(src + x - prevline);
+   uint32_t B = (x > 0) ? *(src + x - 1) : *(src + x);
+   uint32_t C = *(src + x);
+   uint32_t D = (x < width - 1) ? *(src + x + 1) : *(src + x);
+   uint32_t E = *(src + x + nextline);
+
+   out0 += x << 1;
+   out1 += x << 1;
+
+   if (A != E && B != D)
+   {
+      out0[0] = (A == B ? (C + A - ((C ^ A) & 0x0421)) >> 1 : C);
+      out0[1] = (A == D ? (C + A - ((C ^ A) & 0x0421)) >> 1 : C);
+      out1[0] = (E == B ? (C + E - ((C ^ E) & 0x0421)) >> 1 : C);
+      out1[1] = (E == D ? (C + E - ((C ^ E) & 0x0421)) >> 1 : C);
+   }
+   else
+      out0[0] = out0[1] = out1[0] = out1[1] = C;
+}
+
+/* Branchless version of the generic loop body for
+ * SOFTFILTER_SIMD_PIXELS_RGB565 pixels that have both
+ * horizontal neighbours. The 16-bit lanes can't hold
+ * C + A, so the average is computed as
+ * (C & A) + (((C ^ A) & ~0x0821) >> 1), which is the same value. */
+static INLINE void lq2x_simd_group_rgb565(const uint16_t *src,
+      int prevline, int nextline, uint16_t *out0, uint16_t *out1)
+{
+#if defined(SOFTFILTER_SSE2)
+   const __m128i mask = _mm_set1_epi16((short)(0xFFFF & ~0x0821));
+   __m128i A    = _mm_loadu_si128((const __m128i*)(src - prevline));
+   __m128i B    = _mm_loadu_si128((const __m128i*)(src - 1));
+   __m128i C    = _mm_loadu_si128((const __m128i*)src);
+   __m128i D    = _mm_loadu_si128((const __m128i*)(src + 1));
+   __m128i E    = _mm_loadu_si128((const __m128i*)(src + nextline));
+   __m128i cond = _mm_andnot_si128(_mm_or_si128(
+            _mm_cmpeq_epi16(A, E), _mm_cmpeq_epi16(B, D)),
+         _mm_set1_epi32(-1));
+   __m128i iA   = _mm_add_epi16(_mm_and_si128(C, A),
+         _mm_srli_epi16(_mm_and_si128(_mm_xor_si128(C, A), mask), 1));
+   __m128i iE   = _mm_add_epi16(_mm_and_si128(C, E),
+         _mm_srli_epi16(_mm_and_si128(_mm_xor_si128(C, E), mask), 1));
+   __m128i m00  = _mm_and_si128(cond, _mm_cmpeq_epi16(A, B));
+   __m128i m01  = _mm_and_si128(cond, _mm_cmpeq_epi16(A, D));
+   __m128i m10  = _mm_and_si128(cond, _mm_cmpeq_epi16(E, B));
+   __m128i m11  = _mm_and_si128(cond, _mm_cmpeq_epi16(E, D));
+   __m128i o00  = _mm_or_si128(_mm_and_si128(m00, iA), _mm_andnot_si128(m00, C));
+   __m128i o01  = _mm_or_si128(_mm_and_si128(m01, iA), _mm_andnot_si128(m01, C));
+   __m128i o10  = _mm_or_si128(_mm_and_si128(m10, iE), _mm_andnot_si128(m10, C));
+   __m128i o11  = _mm_or_si128(_mm_and_si128(m11, iE), _mm_andnot_si128(m11, C));
+
+   _mm_storeu_si128((__m128i*)out0,       _mm_unpacklo_epi16(o00, o01));
+   _mm_storeu_si128((__m128i*)(out0 + 8), _mm_unpackhi_epi16(o00, o01));
+   _mm_storeu_si128((__m128i*)out1,       _mm_unpacklo_epi16(o10, o11));
+   _mm_storeu_si128((__m128i*)(out1 + 8), _mm_unpackhi_epi16(o10, o11));
+#else
+   const uint16x8_t mask = vdupq_n_u16(0xFFFF & ~0x0821);
+   uint16x8_t A    = vld1q_u16(src - prevline);
+   uint16x8_t B    = vld1q_u16(src - 1);
+   uint16x8_t C    = vld1q_u16(src);
+   uint16x8_t D    = vld1q_u16(src + 1);
+   uint16x8_t E    = vld1q_u16(src + nextline);
+   uint16x8_t cond = vmvnq_u16(vorrq_u16(vceqq_u16(A, E), vceqq_u16(B, D)));
+   uint16x8_t iA   = vaddq_u16(vandq_u16(C, A),
+         vshrq_n_u16(vandq_u16(veorq_u16(C, A), mask), 1));
+   uint16x8_t iE   = vaddq_u16(vandq_u16(C, E),
+         vshrq_n_u16(vandq_u16(veorq_u16(C, E), mask), 1));
+   uint16x8x2_t row0, row1;
+
+   row0.val[0] = vbslq_u16(vandq_u16(cond, vceqq_u16(A, B)), iA, C);
+   row0.val[1] = vbslq_u16(vandq_u16(cond, vceqq_u16(A, D)), iA, C);
+   row1.val[0] = vbslq_u16(vandq_u16(cond, vceqq_u16(E, B)), iE, C);
+   row1.val[1] = vbslq_u16(vandq_u16(cond, vceqq_u16(E, D)), iE, C);
+   vst2q_u16(out0, row0);
+   vst2q_u16(out1, row1);
+#endif
+}
+
+/* Same for XRGB8888. The 32-bit lanes wrap exactly
+ * like the generic code, so its formula is used as is. */
+static INLINE void lq2x_simd_group_xrgb8888(const uint32_t *src,
+      int prevline, int nextline, uint32_t *out0, uint32_t *out1)
+{
+#if defined(SOFTFILTER_SSE2)
+   const __m128i mask = _mm_set1_epi32(0x0421);
+   __m128i A    = _mm_loadu_si128((const __m128i*)(src - prevline));
+   __m128i B    = _mm_loadu_si128((const __m128i*)(src - 1));
+   __m128i C    = _mm_loadu_si128((const __m128i*)src);
+   __m128i D    = _mm_loadu_si128((const __m128i*)(src + 1));
+   __m128i E    = _mm_loadu_si128((const __m128i*)(src + nextline));
+   __m128i cond = _mm_andnot_si128(_mm_or_si128(
+            _mm_cmpeq_epi32(A, E), _mm_cmpeq_epi32(B, D)),
+         _mm_set1_epi32(-1));
+   __m128i iA   = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(C, A),
+            _mm_and_si128(_mm_xor_si128(C, A), mask)), 1);
+   __m128i iE   = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(C, E),
+            _mm_and_si128(_mm_xor_si128(C, E), mask)), 1);
+   __m128i m00  = _mm_and_si128(cond, _mm_cmpeq_epi32(A, B));
+   __m128i m01  = _mm_and_si128(cond, _mm_cmpeq_epi32(A, D));
+   __m128i m10  = _mm_and_si128(cond, _mm_cmpeq_epi32(E, B));
+   __m128i m11  = _mm_and_si128(cond, _mm_cmpeq_epi32(E, D));
+   __m128i o00  = _mm_or_si128(_mm_and_si128(m00, iA), _mm_andnot_si128(m00, C));
+   __m128i o01  = _mm_or_si128(_mm_and_si128(m01, iA), _mm_andnot_si128(m01, C));
+   __m128i o10  = _mm_or_si128(_mm_and_si128(m10, iE), _mm_andnot_si128(m10, C));
+   __m128i o11  = _mm_or_si128(_mm_and_si128(m11, iE), _mm_andnot_si128(m11, C));
+
+   _mm_storeu_si128((__m128i*)out0,       _mm_unpacklo_epi32(o00, o01));
+   _mm_storeu_si128((__m128i*)(out0 + 4), _mm_unpackhi_epi32(o00, o01));
+   _mm_storeu_si128((__m128i*)out1,       _mm_unpacklo_epi32(o10, o11));
+   _mm_storeu_si128((__m128i*)(out1 + 4), _mm_unpackhi_epi32(o10, o11));
+#else
+   const uint32x4_t mask = vdupq_n_u32(0x0421);
+   uint32x4_t A    = vld1q_u32(src - prevline);
+   uint32x4_t B    = vld1q_u32(src - 1);
+   uint32x4_t C    = vld1q_u32(src);
+   uint32x4_t D    = vld1q_u32(src + 1);
+   uint32x4_t E    = vld1q_u32(src + nextline);
+   uint32x4_t cond = vmvnq_u32(vorrq_u32(vceqq_u32(A, E), vceqq_u32(B, D)));
+   uint32x4_t iA   = vshrq_n_u32(vsubq_u32(vaddq_u32(C, A),
+            vandq_u32(veorq_u32(C, A), mask)), 1);
+   uint32x4_t iE   = vshrq_n_u32(vsubq_u32(vaddq_u32(C, E),
+            vandq_u32(veorq_u32(C, E), mask)), 1);
+   uint32x4x2_t row0, row1;
+
+   row0.val[0] = vbslq_u32(vandq_u32(cond, vceqq_u32(A, B)), iA, C);
+   row0.val[1] = vbslq_u32(vandq_u32(cond, vceqq_u32(A, D)), iA, C);
+   row1.val[0] = vbslq_u32(vandq_u32(cond, vceqq_u32(E, B)), iE, C);
+   row1.val[1] = vbslq_u32(vandq_u32(cond, vceqq_u32(E, D)), iE, C);
+   vst2q_u32(out0, row0);
+   vst2q_u32(out1, row1);
+#endif
+}
+
+static void lq2x_simd_rgb565(unsigned width, unsigned height,
+      int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   unsigned x, y;
+
+   for (y = 0; y < height; y++)
+   {
+      uint16_t *out0 = dst + y * 2 * dst_stride;
+      uint16_t *out1 = out0 + dst_stride;
+      int prevline   = (y == 0 ? 0 : src_stride);
+      int nextline   = (y == height - 1 || last) ? 0 : src_stride;
+
+      lq2x_pixel_rgb565(src, 0, width, prevline, nextline, out0, out1);
+
+      for (x = 1; x + SOFTFILTER_SIMD_PIXELS_RGB565 < width;
+            x += SOFTFILTER_SIMD_PIXELS_RGB565)
+         lq2x_simd_group_rgb565(src + x, prevline, nextline,
+               out0 + (x << 1), out1 + (x << 1));
+
+      for (; x < width; x++)
+         lq2x_pixel_rgb565(src, x, width, prevline, nextline, out0, out1);
+
+      src += src_stride;
+   }
+}
+
+static void lq2x_simd_xrgb8888(unsigned width, unsigned height,
+      int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   unsigned x, y;
+
+   for (y = 0; y < height; y++)
+   {
+      uint32_t *out0 = dst + y * 2 * dst_stride;
+      uint32_t *out1 = out0 + dst_stride;
+      int prevline   = (y == 0 ? 0 : src_stride);
+      int nextline   = (y == height - 1 || last) ? 0 : src_stride;
+
+      lq2x_pixel_xrgb8888(src, 0, width, prevline, nextline, out0, out1);
+
+      for (x = 1; x + SOFTFILTER_SIMD_PIXELS_XRGB8888 < width;
+            x += SOFTFILTER_SIMD_PIXELS_XRGB8888)
+         lq2x_simd_group_xrgb8888(src + x, prevline, nextline,
+               out0 + (x << 1), out1 + (x << 1));
+
+      for (; x < width; x++)
+         lq2x_pixel_xrgb8888(src, x, width, prevline, nextline, out0, out1);
+
+      src += src_stride;
+   }
+}
+
+static void lq2x_simd_work_cb_rgb565(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+
+   lq2x_simd_rgb565(thr->width, thr->height,
+         thr->first, thr->last, (uint16_t*)thr->in_data,
+         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
+         (uint16_t*)thr->out_data,
+         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
+}
+
+static void lq2x_simd_work_cb_xrgb8888(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+
+   lq2x_simd_xrgb8888(thr->width, thr->height,
+         thr->first, thr->last, (uint32_t*)thr->in_data,
+         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
+         (uint32_t*)thr->out_data,
+         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
+}
+#endif
+
 static void lq2x_work_cb_rgb565(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr =
@@ -225,11 +469,12 @@ static void lq2x_work_cb_xrgb8888(void *data, void *thread_data)
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
 }
 
-static void lq2x_generic_packets(void *data,
+static void lq2x_packets(void *data,
       struct softfilter_work_packet *packets,
       void *output, size_t output_stride,
       const void *input, unsigned width,
-      unsigned height, size_t input_stride)
+      unsigned height, size_t input_stride,
+      softfilter_work_t work_rgb565, softfilter_work_t work_xrgb8888)
 {
    struct filter_data *filt = (struct filter_data*)data;
    unsigned i;
@@ -253,17 +498,41 @@ static void lq2x_generic_packets(void *data,
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
-         packets[i].work = lq2x_work_cb_rgb565;
+         packets[i].work = work_rgb565;
 #if 0
       else if (filt->in_fmt == SOFTFILTER_FMT_RGB4444)
          packets[i].work = lq2x_work_cb_rgb4444;
 #endif
       else if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
-         packets[i].work = lq2x_work_cb_xrgb8888;
+         packets[i].work = work_xrgb8888;
       packets[i].thread_data = thr;
    }
 }
 
+static void lq2x_generic_packets(void *data,
+      struct softfilter_work_packet *packets,
+      void *output, size_t output_stride,
+      const void *input, unsigned width,
+      unsigned height, size_t input_stride)
+{
+   lq2x_packets(data, packets, output, output_stride,
+         input, width, height, input_stride,
+         lq2x_work_cb_rgb565, lq2x_work_cb_xrgb8888);
+}
+
+#ifdef SOFTFILTER_SIMD_MASK
+static void lq2x_simd_packets(void *data,
+      struct softfilter_work_packet *packets,
+      void *output, size_t output_stride,
+      const void *input, unsigned width,
+      unsigned height, size_t input_stride)
+{
+   lq2x_packets(data, packets, output, output_stride,
+         input, width, height, input_stride,
+         lq2x_simd_work_cb_rgb565, lq2x_simd_work_cb_xrgb8888);
+}
+#endif
+
 static const struct softfilter_implementation lq2x_generic = {
    lq2x_generic_input_fmts,
    lq2x_generic_output_fmts,
@@ -279,10 +548,30 @@ static const struct softfilter_implementation lq2x_generic = {
    "lq2x",
 };
 
+#ifdef SOFTFILTER_SIMD_MASK
+static const struct softfilter_implementation lq2x_simd = {
+   lq2x_generic_input_fmts,
+   lq2x_generic_output_fmts,
+
+   lq2x_generic_create,
+   lq2x_generic_destroy,
+
+   lq2x_generic_threads,
+   lq2x_generic_output,
+   lq2x_simd_packets,
+   SOFTFILTER_API_VERSION,
+   "LQ2x",
+   "lq2x",
+};
+#endif
+
 const struct softfilter_implementation *softfilter_get_implementation(
       softfilter_simd_mask_t simd)
 {
-   (void)simd;
+#ifdef SOFTFILTER_SIMD_MASK
+   if (simd & SOFTFILTER_SIMD_MASK)
+      return &lq2x_simd;
+#endif
    return &lq2x_generic;
 }
 
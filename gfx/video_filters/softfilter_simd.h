@@ -0,0 +1,148 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOFTFILTER_SIMD_H__
+#define SOFTFILTER_SIMD_H__
+
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_inline.h>
+
+#include "softfilter.h"
+
+/* SIMD helpers shared by the softfilters. At most one of
+ * SOFTFILTER_SSE2 and SOFTFILTER_NEON is defined, depending on
+ * what the compiler targets. Filters still check the runtime
+ * mask passed to softfilter_get_implementation() before using
+ * them, see SOFTFILTER_SIMD_MASK. */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFTFILTER_SSE2
+#define SOFTFILTER_SIMD_MASK SOFTFILTER_SIMD_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define SOFTFILTER_NEON
+#define SOFTFILTER_SIMD_MASK SOFTFILTER_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef SOFTFILTER_SIMD_MASK
+
+/* Pixels handled per call of the helpers below */
+#define SOFTFILTER_SIMD_PIXELS_RGB565   8
+#define SOFTFILTER_SIMD_PIXELS_XRGB8888 4
+
+/**
+ * softfilter_simd_flat2x_rgb565:
+ * @in               : first input pixel.
+ * @nextline         : offset to the next input line, 0 on the last one.
+ * @out              : first output pixel.
+ * @dst_stride       : output line stride in pixels.
+ *
+ * 2x scalers that interpolate between A = in[x], B = in[x + 1],
+ * C = in[x + nextline] and D = in[x + nextline + 1] output A for
+ * all four pixels when these are equal. Checks the next
+ * SOFTFILTER_SIMD_PIXELS_RGB565 pixels and writes them if all
+ * of them are flat, which covers most of a typical frame.
+ * Reads one pixel past the group on both lines.
+ *
+ * Returns: true if the pixels were written.
+ **/
+static INLINE bool softfilter_simd_flat2x_rgb565(const uint16_t *in,
+      unsigned nextline, uint16_t *out, unsigned dst_stride)
+{
+#if defined(SOFTFILTER_SSE2)
+   __m128i a  = _mm_loadu_si128((const __m128i*)in);
+   __m128i b  = _mm_loadu_si128((const __m128i*)(in + 1));
+   __m128i c  = _mm_loadu_si128((const __m128i*)(in + nextline));
+   __m128i d  = _mm_loadu_si128((const __m128i*)(in + nextline + 1));
+   __m128i eq = _mm_and_si128(_mm_cmpeq_epi16(a, b),
+         _mm_and_si128(_mm_cmpeq_epi16(a, c), _mm_cmpeq_epi16(a, d)));
+   __m128i lo, hi;
+
+   if (_mm_movemask_epi8(eq) != 0xFFFF)
+      return false;
+
+   lo = _mm_unpacklo_epi16(a, a);
+   hi = _mm_unpackhi_epi16(a, a);
+   _mm_storeu_si128((__m128i*)out, lo);
+   _mm_storeu_si128((__m128i*)(out + 8), hi);
+   _mm_storeu_si128((__m128i*)(out + dst_stride), lo);
+   _mm_storeu_si128((__m128i*)(out + dst_stride + 8), hi);
+   return true;
+#else
+   uint16x8_t a   = vld1q_u16(in);
+   uint16x8_t eq  = vandq_u16(vceqq_u16(a, vld1q_u16(in + 1)),
+         vandq_u16(vceqq_u16(a, vld1q_u16(in + nextline)),
+            vceqq_u16(a, vld1q_u16(in + nextline + 1))));
+   uint32x2_t all = vreinterpret_u32_u8(vmovn_u16(eq));
+   uint16x8x2_t dup;
+
+   if ((vget_lane_u32(all, 0) & vget_lane_u32(all, 1)) != 0xFFFFFFFF)
+      return false;
+
+   dup.val[0] = a;
+   dup.val[1] = a;
+   vst2q_u16(out, dup);
+   vst2q_u16(out + dst_stride, dup);
+   return true;
+#endif
+}
+
+/* Same for SOFTFILTER_SIMD_PIXELS_XRGB8888 pixels of XRGB8888 */
+static INLINE bool softfilter_simd_flat2x_xrgb8888(const uint32_t *in,
+      unsigned nextline, uint32_t *out, unsigned dst_stride)
+{
+#if defined(SOFTFILTER_SSE2)
+   __m128i a  = _mm_loadu_si128((const __m128i*)in);
+   __m128i b  = _mm_loadu_si128((const __m128i*)(in + 1));
+   __m128i c  = _mm_loadu_si128((const __m128i*)(in + nextline));
+   __m128i d  = _mm_loadu_si128((const __m128i*)(in + nextline + 1));
+   __m128i eq = _mm_and_si128(_mm_cmpeq_epi32(a, b),
+         _mm_and_si128(_mm_cmpeq_epi32(a, c), _mm_cmpeq_epi32(a, d)));
+   __m128i lo, hi;
+
+   if (_mm_movemask_epi8(eq) != 0xFFFF)
+      return false;
+
+   lo = _mm_unpacklo_epi32(a, a);
+   hi = _mm_unpackhi_epi32(a, a);
+   _mm_storeu_si128((__m128i*)out, lo);
+   _mm_storeu_si128((__m128i*)(out + 4), hi);
+   _mm_storeu_si128((__m128i*)(out + dst_stride), lo);
+   _mm_storeu_si128((__m128i*)(out + dst_stride + 4), hi);
+   return true;
+#else
+   uint32x4_t a   = vld1q_u32(in);
+   uint32x4_t eq  = vandq_u32(vceqq_u32(a, vld1q_u32(in + 1)),
+         vandq_u32(vceqq_u32(a, vld1q_u32(in + nextline)),
+            vceqq_u32(a, vld1q_u32(in + nextline + 1))));
+   uint32x2_t all = vreinterpret_u32_u16(vmovn_u32(eq));
+   uint32x4x2_t dup;
+
+   if ((vget_lane_u32(all, 0) & vget_lane_u32(all, 1)) != 0xFFFFFFFF)
+      return false;
+
+   dup.val[0] = a;
+   dup.val[1] = a;
+   vst2q_u32(out, dup);
+   vst2q_u32(out + dst_stride, dup);
+   return true;
+#endif
+}
+
+#endif
+
+#endif
@@ -17,6 +17,7 @@
 /* Compile: gcc -o supereagle.so -shared supereagle.c -std=c99 -O3 -Wall -pedantic -fPIC */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 
 #ifdef RARCH_INTERNAL
@@ -292,10 +293,123 @@ static void supereagle_work_cb_xrgb8888(void *data, void *thread_data)
         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
 }
 
-static void supereagle_generic_packets(void *data,
+#ifdef SOFTFILTER_SIMD_MASK
+/* Flat runs are written with SIMD, the rest of each
+ * group falls back to the generic per-pixel code */
+static void supereagle_simd_xrgb8888(unsigned width, unsigned height,
+      int first, int last, uint32_t *src,
+      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+{
+   unsigned finish;
+   unsigned nextline = (last) ? 0 : src_stride;
+
+   for (; height; height--)
+   {
+      uint32_t *in  = (uint32_t*)src;
+      uint32_t *out = (uint32_t*)dst;
+
+      for (finish = width; finish > SOFTFILTER_SIMD_PIXELS_XRGB8888; )
+      {
+         unsigned i;
+
+         finish -= SOFTFILTER_SIMD_PIXELS_XRGB8888;
+
+         if (softfilter_simd_flat2x_xrgb8888(in, nextline, out, dst_stride))
+         {
+            in  += SOFTFILTER_SIMD_PIXELS_XRGB8888;
+            out += SOFTFILTER_SIMD_PIXELS_XRGB8888 * 2;
+            continue;
+         }
+
+         for (i = 0; i < SOFTFILTER_SIMD_PIXELS_XRGB8888; i++)
+         {
+            supereagle_declare_variables(uint32_t, in, nextline);
+            supereagle_function(supereagle_result, supereagle_interpolate_xrgb8888, supereagle_interpolate2_xrgb8888);
+         }
+      }
+
+      for (; finish; finish -= 1)
+      {
+         supereagle_declare_variables(uint32_t, in, nextline);
+         supereagle_function(supereagle_result, supereagle_interpolate_xrgb8888, supereagle_interpolate2_xrgb8888);
+      }
+
+      src += src_stride;
+      dst += 2 * dst_stride;
+   }
+}
+
+static void supereagle_simd_rgb565(unsigned width, unsigned height,
+      int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+{
+   unsigned finish;
+   unsigned nextline = (last) ? 0 : src_stride;
+
+   for (; height; height--)
+   {
+      uint16_t *in  = (uint16_t*)src;
+      uint16_t *out = (uint16_t*)dst;
+
+      for (finish = width; finish > SOFTFILTER_SIMD_PIXELS_RGB565; )
+      {
+         unsigned i;
+
+         finish -= SOFTFILTER_SIMD_PIXELS_RGB565;
+
+         if (softfilter_simd_flat2x_rgb565(in, nextline, out, dst_stride))
+         {
+            in  += SOFTFILTER_SIMD_PIXELS_RGB565;
+            out += SOFTFILTER_SIMD_PIXELS_RGB565 * 2;
+            continue;
+         }
+
+         for (i = 0; i < SOFTFILTER_SIMD_PIXELS_RGB565; i++)
+         {
+            supereagle_declare_variables(uint16_t, in, nextline);
+            supereagle_function(supereagle_result, supereagle_interpolate_rgb565, supereagle_interpolate2_rgb565);
+         }
+      }
+
+      for (; finish; finish -= 1)
+      {
+         supereagle_declare_variables(uint16_t, in, nextline);
+         supereagle_function(supereagle_result, supereagle_interpolate_rgb565, supereagle_interpolate2_rgb565);
+      }
+
+      src += src_stride;
+      dst += 2 * dst_stride;
+   }
+}
+
+static void supereagle_simd_work_cb_rgb565(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+
+   supereagle_simd_rgb565(thr->width, thr->height,
+         thr->first, thr->last, (uint16_t*)thr->in_data,
+         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
+         (uint16_t*)thr->out_data,
+         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
+}
+
+static void supereagle_simd_work_cb_xrgb8888(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+
+   supereagle_simd_xrgb8888(thr->width, thr->height,
+         thr->first, thr->last, (uint32_t*)thr->in_data,
+         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
+         (uint32_t*)thr->out_data,
+         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
+}
+#endif
+
+static void supereagle_packets(void *data,
       struct softfilter_work_packet *packets,
       void *output, size_t output_stride,
-      const void *input, unsigned width, unsigned height, size_t input_stride)
+      const void *input, unsigned width, unsigned height, size_t input_stride,
+      softfilter_work_t work_rgb565, softfilter_work_t work_xrgb8888)
 {
    unsigned i;
    struct filter_data *filt = (struct filter_data*)data;
@@ -318,13 +432,35 @@ static void supereagle_generic_packets(void *data,
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
-         packets[i].work = supereagle_work_cb_rgb565;
+         packets[i].work = work_rgb565;
       else if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
-         packets[i].work = supereagle_work_cb_xrgb8888;
+         packets[i].work = work_xrgb8888;
       packets[i].thread_data = thr;
    }
 }
 
+static void supereagle_generic_packets(void *data,
+      struct softfilter_work_packet *packets,
+      void *output, size_t output_stride,
+      const void *input, unsigned width, unsigned height, size_t input_stride)
+{
+   supereagle_packets(data, packets, output, output_stride,
+         input, width, height, input_stride,
+         supereagle_work_cb_rgb565, supereagle_work_cb_xrgb8888);
+}
+
+#ifdef SOFTFILTER_SIMD_MASK
+static void supereagle_simd_packets(void *data,
+      struct softfilter_work_packet *packets,
+      void *output, size_t output_stride,
+      const void *input, unsigned width, unsigned height, size_t input_stride)
+{
+   supereagle_packets(data, packets, output, output_stride,
+         input, width, height, input_stride,
+         supereagle_simd_work_cb_rgb565, supereagle_simd_work_cb_xrgb8888);
+}
+#endif
+
 static const struct softfilter_implementation supereagle_generic = {
    supereagle_generic_input_fmts,
    supereagle_generic_output_fmts,
@@ -340,9 +476,29 @@ static const struct softfilter_implementation supereagle_generic = {
    "supereagle",
 };
 
+#ifdef SOFTFILTER_SIMD_MASK
+static const struct softfilter_implementation supereagle_simd = {
+   supereagle_generic_input_fmts,
+   supereagle_generic_output_fmts,
+
+   supereagle_generic_create,
+   supereagle_generic_destroy,
+
+   supereagle_generic_threads,
+   supereagle_generic_output,
+   supereagle_simd_packets,
+   SOFTFILTER_API_VERSION,
+   "SuperEagle",
+   "supereagle",
+};
+#endif
+
 const struct softfilter_implementation *softfilter_get_implementation(softfilter_simd_mask_t simd)
 {
-   (void)simd;
+#ifdef SOFTFILTER_SIMD_MASK
+   if (simd & SOFTFILTER_SIMD_MASK)
+      return &supereagle_simd;
+#endif
    return &supereagle_generic;
 }
 
@@ -368,6 +368,8 @@ void video_layout_view_fit_bounds(video_layout_bounds_t bounds)
                view->screens[comp->attr.screen.index] = comp->render_bounds;
          }
       }
+
+      layer->dirty = true;
    }
 }
 
@@ -376,102 +378,128 @@ int video_layout_layer_count(void)
    return video_layout_state->view->layers_count;
 }
 
+/* Updates the states of the elements of a layer from their
+ * output bindings. Returns true if the layer looks different
+ * since it was last drawn, in which case the video driver
+ * must draw it again; otherwise it can reuse what it drew. */
+bool video_layout_layer_update(int index)
+{
+   unsigned i;
+   layer_t *layer = &video_layout_state->view->layers[index];
+   bool changed   = layer->dirty;
+
+   for (i = 0; i < layer->bound_count; ++i)
+   {
+      element_t *elem = layer->bound[i];
+      int state       = video_layout_state->io[elem->o_bind].value;
+
+      if (elem->state != state)
+      {
+         elem->state = state;
+         changed     = true;
+      }
+   }
+
+   layer->dirty = false;
+   return changed;
+}
+
+video_layout_blend_t video_layout_layer_blend(int index)
+{
+   return video_layout_state->view->layers[index].blend;
+}
+
 void video_layout_layer_render(int index)
 {
-   unsigned i, j;
+   unsigned i;
    video_layout_render_info_t        *info  = &video_layout_state->render_info;
    const video_layout_render_interface_t *r = video_layout_state->render;
    layer_t *layer                           = 
       &video_layout_state->view->layers[index];
 
+   video_layout_layer_update(index);
+
    r->layer_begin(info);
 
-   for (i = 0; i < layer->elements_count; ++i)
+   for (i = 0; i < layer->ops_count; ++i)
    {
-      element_t *elem = &layer->elements[i];
-
-      if (elem->o_bind != -1)
-         elem->state = video_layout_state->io[elem->o_bind].value;
+      component_t *comp = layer->ops[i].comp;
+      element_t *elem   = layer->ops[i].elem;
 
-      for (j = 0; j < elem->components_count; ++j)
+      if (comp->enabled_state != -1)
       {
-         component_t *comp = &elem->components[j];
-
-         if (comp->enabled_state != -1)
-         {
-            if (comp->enabled_state != elem->state)
-               continue;
-         }
+         if (comp->enabled_state != elem->state)
+            continue;
+      }
 
-         info->bounds      = comp->render_bounds;
-         info->orientation = comp->orientation;
-         info->color       = comp->color;
+      info->bounds      = comp->render_bounds;
+      info->orientation = comp->orientation;
+      info->color       = comp->color;
 
-         switch (comp->type)
-         {
-            case VIDEO_LAYOUT_C_UNKNOWN:
-               break;
-            case VIDEO_LAYOUT_C_SCREEN:
-               r->screen(info, comp->attr.screen.index);
-               break;
-            case VIDEO_LAYOUT_C_RECT:
-               r->rect(info);
-               break;
-            case VIDEO_LAYOUT_C_DISK:
-               r->ellipse(info);
-               break;
-            case VIDEO_LAYOUT_C_IMAGE:
-               if (!comp->attr.image.loaded)
-               {
-                  comp->attr.image.image_idx = 
-                     video_layout_load_image(comp->attr.image.file);
-                  if (comp->attr.image.alpha_file)
-                     comp->attr.image.alpha_idx = 
-                        video_layout_load_image(comp->attr.image.alpha_file);
-                  comp->attr.image.loaded = true;
-               }
-               r->image(info,
-                     video_layout_state->images[comp->attr.image.image_idx],
-                     video_layout_state->images[comp->attr.image.alpha_idx]);
-               break;
-            case VIDEO_LAYOUT_C_TEXT:
-               r->text(info, comp->attr.text.string);
-               break;
-            case VIDEO_LAYOUT_C_COUNTER:
-               r->counter(info, MIN(elem->state,
-                        comp->attr.counter.max_state));
-               break;
-            case VIDEO_LAYOUT_C_DOTMATRIX_X1:
-               r->led_dot(info, 1, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_DOTMATRIX_H5:
-               r->led_dot(info, 5, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_DOTMATRIX_H8:
-               r->led_dot(info, 8, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_LED_7:
-               r->led_seg(info, VIDEO_LAYOUT_LED_7, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_LED_8_GTS1:
-               r->led_seg(info, VIDEO_LAYOUT_LED_8_GTS1, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_LED_14:
-               r->led_seg(info, VIDEO_LAYOUT_LED_14, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_LED_14_SC:
-               r->led_seg(info, VIDEO_LAYOUT_LED_14_SC, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_LED_16:
-               r->led_seg(info, VIDEO_LAYOUT_LED_16, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_LED_16_SC:
-               r->led_seg(info, VIDEO_LAYOUT_LED_16_SC, elem->state);
-               break;
-            case VIDEO_LAYOUT_C_REEL:
-               /* not implemented */
-               break;
-         }
+      switch (comp->type)
+      {
+         case VIDEO_LAYOUT_C_UNKNOWN:
+            break;
+         case VIDEO_LAYOUT_C_SCREEN:
+            r->screen(info, comp->attr.screen.index);
+            break;
+         case VIDEO_LAYOUT_C_RECT:
+            r->rect(info);
+            break;
+         case VIDEO_LAYOUT_C_DISK:
+            r->ellipse(info);
+            break;
+         case VIDEO_LAYOUT_C_IMAGE:
+            if (!comp->attr.image.loaded)
+            {
+               comp->attr.image.image_idx = 
+                  video_layout_load_image(comp->attr.image.file);
+               if (comp->attr.image.alpha_file)
+                  comp->attr.image.alpha_idx = 
+                     video_layout_load_image(comp->attr.image.alpha_file);
+               comp->attr.image.loaded = true;
+            }
+            r->image(info,
+                  video_layout_state->images[comp->attr.image.image_idx],
+                  video_layout_state->images[comp->attr.image.alpha_idx]);
+            break;
+         case VIDEO_LAYOUT_C_TEXT:
+            r->text(info, comp->attr.text.string);
+            break;
+         case VIDEO_LAYOUT_C_COUNTER:
+            r->counter(info, MIN(elem->state,
+                     comp->attr.counter.max_state));
+            break;
+         case VIDEO_LAYOUT_C_DOTMATRIX_X1:
+            r->led_dot(info, 1, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_DOTMATRIX_H5:
+            r->led_dot(info, 5, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_DOTMATRIX_H8:
+            r->led_dot(info, 8, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_LED_7:
+            r->led_seg(info, VIDEO_LAYOUT_LED_7, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_LED_8_GTS1:
+            r->led_seg(info, VIDEO_LAYOUT_LED_8_GTS1, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_LED_14:
+            r->led_seg(info, VIDEO_LAYOUT_LED_14, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_LED_14_SC:
+            r->led_seg(info, VIDEO_LAYOUT_LED_14_SC, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_LED_16:
+            r->led_seg(info, VIDEO_LAYOUT_LED_16, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_LED_16_SC:
+            r->led_seg(info, VIDEO_LAYOUT_LED_16_SC, elem->state);
+            break;
+         case VIDEO_LAYOUT_C_REEL:
+            /* not implemented */
+            break;
       }
    }
 
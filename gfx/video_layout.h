@@ -86,7 +86,10 @@ bool        video_layout_view_on_change    (void);
 void        video_layout_view_fit_bounds   (video_layout_bounds_t bounds);
 
 int         video_layout_layer_count       (void);
+bool        video_layout_layer_update      (int index);
 void        video_layout_layer_render      (int index);
+video_layout_blend_t
+            video_layout_layer_blend       (int index);
 
 const video_layout_bounds_t
            *video_layout_screen            (int index);
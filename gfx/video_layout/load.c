@@ -684,6 +684,7 @@ static bool load_views(scope_t *scope, view_array_t *view_array,
          view_sort_layers(view);
          view_normalize(view);
          view_count_screens(view);
+         view_compile(view);
 
          scope_pop(scope);
 
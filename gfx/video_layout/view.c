@@ -11,6 +11,11 @@ void layer_init(layer_t *layer, const char *name)
    layer->blend          = VIDEO_LAYOUT_BLEND_ALPHA;
    layer->elements       = NULL;
    layer->elements_count = 0;
+   layer->ops            = NULL;
+   layer->ops_count      = 0;
+   layer->bound          = NULL;
+   layer->bound_count    = 0;
+   layer->dirty          = true;
 }
 
 void layer_deinit(layer_t *layer)
@@ -21,6 +26,8 @@ void layer_deinit(layer_t *layer)
       element_deinit(&layer->elements[i]);
 
    free(layer->elements);
+   free(layer->ops);
+   free(layer->bound);
    free(layer->name);
 }
 
@@ -226,6 +233,73 @@ void view_count_screens(view_t *view)
    }
 }
 
+static void layer_compile(layer_t *layer)
+{
+   unsigned i, j;
+   int ops_count   = 0;
+   int bound_count = 0;
+
+   free(layer->ops);
+   free(layer->bound);
+   layer->ops         = NULL;
+   layer->ops_count   = 0;
+   layer->bound       = NULL;
+   layer->bound_count = 0;
+   layer->dirty       = true;
+
+   for (i = 0; i < layer->elements_count; ++i)
+   {
+      element_t *elem = &layer->elements[i];
+
+      if (elem->o_bind != -1)
+         ++bound_count;
+
+      for (j = 0; j < elem->components_count; ++j)
+      {
+         comp_type_t type = elem->components[j].type;
+         if (type != VIDEO_LAYOUT_C_UNKNOWN && type != VIDEO_LAYOUT_C_REEL)
+            ++ops_count;
+      }
+   }
+
+   if (ops_count)
+      layer->ops   = (layer_op_t*)malloc(ops_count * sizeof(layer_op_t));
+   if (bound_count)
+      layer->bound = (element_t**)malloc(bound_count * sizeof(element_t*));
+
+   if ((ops_count && !layer->ops) || (bound_count && !layer->bound))
+      return;
+
+   for (i = 0; i < layer->elements_count; ++i)
+   {
+      element_t *elem = &layer->elements[i];
+
+      if (elem->o_bind != -1)
+         layer->bound[layer->bound_count++] = elem;
+
+      for (j = 0; j < elem->components_count; ++j)
+      {
+         component_t *comp = &elem->components[j];
+
+         if (comp->type == VIDEO_LAYOUT_C_UNKNOWN ||
+             comp->type == VIDEO_LAYOUT_C_REEL)
+            continue;
+
+         layer->ops[layer->ops_count].comp = comp;
+         layer->ops[layer->ops_count].elem = elem;
+         ++layer->ops_count;
+      }
+   }
+}
+
+void view_compile(view_t *view)
+{
+   unsigned i;
+
+   for (i = 0; i < view->layers_count; ++i)
+      layer_compile(&view->layers[i]);
+}
+
 void view_array_init(view_array_t *view_array, int views_count)
 {
    view_array->views = (view_t*)(views_count > 0 ?
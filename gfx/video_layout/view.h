@@ -4,6 +4,13 @@
 #include "internal.h"
 #include "element.h"
 
+/* One component to draw, in drawing order */
+typedef struct layer_op
+{
+   component_t          *comp;
+   element_t            *elem;
+} layer_op_t;
+
 typedef struct layer
 {
    char                 *name;
@@ -11,6 +18,17 @@ typedef struct layer
 
    element_t            *elements;
    int                   elements_count;
+
+   /* Compiled by view_compile() once the view is loaded:
+    * the drawable components of all elements, and the
+    * elements whose state follows an output binding */
+   layer_op_t           *ops;
+   int                   ops_count;
+   element_t           **bound;
+   int                   bound_count;
+
+   /* Set when the layer has to be drawn again */
+   bool                  dirty;
 } layer_t;
 
 typedef struct view
@@ -43,6 +61,7 @@ layer_t   *view_emplace_layer (view_t *view, const char *name);
 void       view_sort_layers   (view_t *view);
 void       view_normalize     (view_t *view);
 void       view_count_screens (view_t *view);
+void       view_compile       (view_t *view);
 
 void       view_array_init    (view_array_t *view_array, int views_count);
 void       view_array_deinit  (view_array_t *view_array);
@@ -21,11 +21,13 @@
 
 #include <compat/strl.h>
 #include <features/features_cpu.h>
+#include <memalign.h>
 #include <string/stdstring.h>
 
 #include "video_thread_wrapper.h"
 #include "font_driver.h"
 
+#include "../performance_counters.h"
 #include "../retroarch.h"
 #include "../verbosity.h"
 
@@ -378,16 +380,26 @@ static void video_thread_loop(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
 
+   perf_trace_set_thread_name("video");
+
    for (;;)
    {
       thread_packet_t pkt;
-      bool updated = false;
+      thread_video_frame_t *frame = NULL;
 
       slock_lock(thr->lock);
-      while (thr->send_cmd == CMD_VIDEO_NONE && !thr->frame.updated)
+      while (thr->send_cmd == CMD_VIDEO_NONE && thr->frame.pending < 0)
          scond_wait(thr->cond_thread, thr->lock);
-      if (thr->frame.updated)
-         updated = true;
+
+      /* Take the newest frame; the emulator thread is
+       * free to start on the next one right away. */
+      if (thr->frame.pending >= 0)
+      {
+         thr->frame.rendering = thr->frame.pending;
+         thr->frame.pending   = -1;
+         frame                = &thr->frame.slots[thr->frame.rendering];
+         scond_signal(thr->cond_cmd);
+      }
 
       /* To avoid race condition where send_cmd is updated
        * right after the switch is checked. */
@@ -398,7 +410,7 @@ static void video_thread_loop(void *data)
       if (video_thread_handle_packet(thr, &pkt))
          return;
 
-      if (updated)
+      if (frame)
       {
          struct video_viewport vp;
          bool                 ret = false;
@@ -424,11 +436,14 @@ static void video_thread_loop(void *data)
              * rid of this */
             video_driver_build_info(&video_info);
 
+            perf_trace_begin("video_frame");
             ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count,
-                  thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL,
+                  frame->dupe ? NULL : frame->buffer,
+                  frame->width, frame->height,
+                  frame->count,
+                  frame->pitch, *frame->msg ? frame->msg : NULL,
                   &video_info);
+            perf_trace_end();
          }
 
          slock_unlock(thr->frame.lock);
@@ -448,9 +463,9 @@ static void video_thread_loop(void *data)
          slock_lock(thr->lock);
          thr->alive         = alive;
          thr->focus         = focus;
-         thr->has_windowed  = has_windowed;
-         thr->frame.updated = false;
-         thr->vp            = vp;
+         thr->has_windowed    = has_windowed;
+         thr->frame.rendering = -1;
+         thr->vp              = vp;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
       }
@@ -514,13 +529,30 @@ static bool video_thread_has_windowed(void *data)
    return ret;
 }
 
+static void video_thread_frame_set_info(thread_video_frame_t *frame,
+      unsigned width, unsigned height, uint64_t frame_count,
+      unsigned pitch, const char *msg)
+{
+   frame->width  = width;
+   frame->height = height;
+   frame->count  = frame_count;
+   frame->pitch  = pitch;
+
+   if (msg)
+      strlcpy(frame->msg, msg, sizeof(frame->msg));
+   else
+      *frame->msg = '\0';
+}
+
 static bool video_thread_frame(void *data, const void *frame_,
       unsigned width, unsigned height, uint64_t frame_count,
       unsigned pitch, const char *msg, video_frame_info_t *video_info)
 {
+   int i;
    unsigned copy_stride;
    const uint8_t *src                  = NULL;
    uint8_t *dst                        = NULL;
+   thread_video_frame_t *frame         = NULL;
    thread_video_t *thr                 = (thread_video_t*)data;
 
    /* If called from within read_viewport, we're actually in the
@@ -539,7 +571,6 @@ static bool video_thread_frame(void *data, const void *frame_,
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
    src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
 
    slock_lock(thr->lock);
 
@@ -550,8 +581,10 @@ static bool video_thread_frame(void *data, const void *frame_,
          roundf(1000000 / video_info->refresh_rate);
       retro_time_t target = thr->last_time + target_frame_time;
 
-      /* Ideally, use absolute time, but that is only a good idea on POSIX. */
-      while (thr->frame.updated)
+      /* Wait for the video thread to pick up the previous frame,
+       * it doesn't have to be done rendering it.
+       * Ideally, use absolute time, but that is only a good idea on POSIX. */
+      while (thr->frame.pending >= 0)
       {
          retro_time_t current = cpu_features_get_time_usec();
          retro_time_t delta   = target - current;
@@ -564,10 +597,34 @@ static bool video_thread_frame(void *data, const void *frame_,
       }
    }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   /* A dupe while the previous frame is still pending has
+    * nothing new to show. The video thread hasn't taken that
+    * slot yet, so just update it in place. */
+   if (!src && thr->frame.pending >= 0)
+   {
+      i = thr->frame.pending;
+      video_thread_frame_set_info(&thr->frame.slots[i],
+            width, height, frame_count, copy_stride, msg);
+      thr->miss_count++;
+   }
+   else
    {
+      /* With three slots there is always one that is neither
+       * being rendered nor waiting to be rendered. */
+      for (i = 0; i < THREAD_VIDEO_FRAME_SLOTS; i++)
+         if (i != thr->frame.pending && i != thr->frame.rendering)
+            break;
+
+      slock_unlock(thr->lock);
+
+      /* The video thread never touches this slot before it is
+       * published below, so fill it without holding the lock.
+       * A dupe leaves the buffer alone, the driver still has
+       * the last frame it was given. */
+      frame       = &thr->frame.slots[i];
+      dst         = frame->buffer;
+      frame->dupe = !src;
+
       if (src)
       {
          unsigned h;
@@ -575,30 +632,29 @@ static bool video_thread_frame(void *data, const void *frame_,
             memcpy(dst, src, copy_stride);
       }
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.count  = frame_count;
-      thr->frame.pitch  = copy_stride;
+      video_thread_frame_set_info(frame,
+            width, height, frame_count, copy_stride, msg);
 
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
+      slock_lock(thr->lock);
+
+      /* Replace a frame the video thread didn't get to yet,
+       * the newest one is the one worth showing. */
+      if (thr->frame.pending >= 0)
+         thr->miss_count++;
       else
-         *thr->frame.msg = '\0';
+         thr->hit_count++;
 
+      thr->frame.pending = i;
       scond_signal(thr->cond_thread);
+   }
 
 #if defined(HAVE_MENU)
-      if (thr->texture.enable)
-      {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
-      }
-#endif
-      thr->hit_count++;
+   if (thr->texture.enable)
+   {
+      while (thr->frame.pending == i || thr->frame.rendering == i)
+         scond_wait(thr->cond_cmd, thr->lock);
    }
-   else
-      thr->miss_count++;
+#endif
 
    slock_unlock(thr->lock);
 
@@ -619,6 +675,7 @@ static bool video_thread_init(thread_video_t *thr,
       const video_info_t info,
       input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
    thread_packet_t pkt;
 
@@ -640,19 +697,27 @@ static bool video_thread_init(thread_video_t *thr,
    max_size                  = info.input_scale * RARCH_SCALE_BASE;
    max_size                 *= max_size;
    max_size                 *= info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+
+   for (i = 0; i < THREAD_VIDEO_FRAME_SLOTS; i++)
+   {
 #ifdef _3DS
-   thr->frame.buffer         = linearMemAlign(max_size, 0x80);
+      thr->frame.slots[i].buffer = linearMemAlign(max_size, 0x80);
 #else
-   thr->frame.buffer         = (uint8_t*)malloc(max_size);
+      thr->frame.slots[i].buffer = (uint8_t*)memalign_alloc_large(max_size);
 #endif
 
-   if (!thr->frame.buffer)
-      return false;
+      if (!thr->frame.slots[i].buffer)
+         return false;
 
-   memset(thr->frame.buffer, 0x80, max_size);
+      memset(thr->frame.slots[i].buffer, 0x80, max_size);
+   }
+
+   thr->frame.pending        = -1;
+   thr->frame.rendering      = -1;
 
    thr->last_time            = cpu_features_get_time_usec();
-   thr->thread               = sthread_create(video_thread_loop, thr);
+   thr->thread               = sthread_create_with_role(video_thread_loop,
+         thr, STHREAD_ROLE_VIDEO);
 
    if (!thr->thread)
       return false;
@@ -750,6 +815,7 @@ static bool video_thread_read_viewport(void *data,
 
 static void video_thread_free(void *data)
 {
+   unsigned i;
    thread_packet_t pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
@@ -764,11 +830,14 @@ static void video_thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
+   for (i = 0; i < THREAD_VIDEO_FRAME_SLOTS; i++)
+   {
 #ifdef _3DS
-   linearFree(thr->frame.buffer);
+      linearFree(thr->frame.slots[i].buffer);
 #else
-   free(thr->frame.buffer);
+      memalign_free_large(thr->frame.slots[i].buffer);
 #endif
+   }
    slock_free(thr->frame.lock);
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
@@ -154,6 +154,24 @@ struct thread_packet
    enum thread_cmd type;
 };
 
+/* Frames are triple-buffered: the emulator thread can always
+ * fill one slot while the video thread renders another,
+ * and the third holds the most recent finished frame. */
+#define THREAD_VIDEO_FRAME_SLOTS 3
+
+typedef struct thread_video_frame
+{
+   uint64_t count;
+   uint8_t *buffer;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   char msg[255];
+   /* Duped frame, buffer is stale and the driver
+    * keeps showing what it has */
+   bool dupe;
+} thread_video_frame_t;
+
 typedef struct thread_video
 {
    retro_time_t last_time;
@@ -210,14 +228,12 @@ typedef struct thread_video
 
    struct
    {
-      uint64_t count;
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      char msg[255];
-      bool updated;
+      thread_video_frame_t slots[THREAD_VIDEO_FRAME_SLOTS];
+      /* Indices into slots, protected by thr->lock,
+       * -1 if there is no such frame. */
+      int pending;   /* Finished, waiting for the video thread */
+      int rendering; /* Being rendered by the video thread */
       bool within_thread;
    } frame;
 
@@ -431,6 +431,13 @@ void gfx_widgets_push_achievement(const char *title, const char *badge)
    SLOCK_UNLOCK(state->queue_lock);
 }
 
+static bool gfx_widget_achievement_popup_is_active(void)
+{
+   gfx_widget_achievement_popup_state_t *state = &p_w_achievement_popup_st;
+   return state->queue_read_index >= 0
+      && state->queue[state->queue_read_index].title;
+}
+
 const gfx_widget_t gfx_widget_achievement_popup = {
    &gfx_widget_achievement_popup_init,
    &gfx_widget_achievement_popup_free,
@@ -438,5 +445,6 @@ const gfx_widget_t gfx_widget_achievement_popup = {
    &gfx_widget_achievement_popup_context_destroy,
    NULL, /* layout */
    NULL, /* iterate */
-   &gfx_widget_achievement_popup_frame
+   &gfx_widget_achievement_popup_frame,
+   &gfx_widget_achievement_popup_is_active
 };
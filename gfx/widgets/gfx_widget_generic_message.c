@@ -550,6 +550,12 @@ static void gfx_widget_generic_message_free(void)
 
 /* Widget definition */
 
+static bool gfx_widget_generic_message_is_active(void)
+{
+   gfx_widget_generic_message_state_t *state = &p_w_generic_message_st;
+   return state->status != GFX_WIDGET_GENERIC_MESSAGE_IDLE;
+}
+
 const gfx_widget_t gfx_widget_generic_message = {
    NULL, /* init */
    gfx_widget_generic_message_free,
@@ -557,5 +563,6 @@ const gfx_widget_t gfx_widget_generic_message = {
    NULL, /* context_destroy */
    gfx_widget_generic_message_layout,
    gfx_widget_generic_message_iterate,
-   gfx_widget_generic_message_frame
+   gfx_widget_generic_message_frame,
+   gfx_widget_generic_message_is_active
 };
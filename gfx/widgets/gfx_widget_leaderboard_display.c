@@ -186,6 +186,12 @@ void gfx_widgets_set_leaderboard_display(unsigned id, const char* value)
    SLOCK_UNLOCK(state->array_lock);
 }
 
+static bool gfx_widget_leaderboard_display_is_active(void)
+{
+   gfx_widget_leaderboard_display_state_t *state = &p_w_leaderboard_display_st;
+   return state->count != 0;
+}
+
 const gfx_widget_t gfx_widget_leaderboard_display = {
    &gfx_widget_leaderboard_display_init,
    &gfx_widget_leaderboard_display_free,
@@ -193,5 +199,6 @@ const gfx_widget_t gfx_widget_leaderboard_display = {
    &gfx_widget_leaderboard_display_context_destroy,
    NULL, /* layout */
    NULL, /* iterate */
-   &gfx_widget_leaderboard_display_frame
+   &gfx_widget_leaderboard_display_frame,
+   &gfx_widget_leaderboard_display_is_active
 };
@@ -566,6 +566,7 @@ FONTS
 
 #include "../gfx/drivers_font_renderer/bitmapfont.c"
 #include "../gfx/drivers_font_renderer/bitmapfont_10x10.c"
+#include "../gfx/drivers_font_renderer/sdf.c"
 #include "../gfx/font_driver.c"
 
 #if defined(HAVE_D3D9) && defined(HAVE_D3DX)
@@ -662,6 +663,7 @@ INPUT
 #ifdef HAVE_OVERLAY
 #include "../led/drivers/led_overlay.c"
 #include "../tasks/task_overlay.c"
+#include "../input/input_overlay.c"
 #endif
 
 #ifdef HAVE_X11
@@ -1089,6 +1091,9 @@ FILE
 #include "../libretro-common/file/nbio/nbio_stdio.c"
 #if defined(__linux__)
 #include "../libretro-common/file/nbio/nbio_linux.c"
+#ifdef HAVE_IO_URING
+#include "../libretro-common/file/nbio/nbio_uring.c"
+#endif
 #endif
 #if defined(HAVE_MMAP) && defined(BSD)
 #include "../libretro-common/file/nbio/nbio_unixmmap.c"
@@ -1195,7 +1200,14 @@ GIT
 RETROARCH
 ============================================================ */
 #include "../retroarch.c"
+#include "../performance_counters.c"
 #include "../command.c"
+#ifdef HAVE_MEMORY_WATCH
+#include "../memory_watch.c"
+#endif
+#ifdef HAVE_MEMORY_TAGS
+#include "../memory_tags.c"
+#endif
 #include "../libretro-common/queues/task_queue.c"
 
 #include "../msg_hash.c"
@@ -1281,6 +1293,7 @@ THREAD
 #endif
 
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/tpool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #endif
@@ -1326,6 +1339,7 @@ DATA RUNLOOP
 #include "../tasks/task_playlist_manager.c"
 #include "../tasks/task_manual_content_scan.c"
 #include "../tasks/task_core_backup.c"
+#include "../tasks/task_disk_prefetch.c"
 #ifdef HAVE_ZLIB
 #include "../tasks/task_decompress.c"
 #endif
@@ -1344,6 +1358,10 @@ SCREENSHOTS
 #include "../tasks/task_screenshot.c"
 #endif
 
+#ifdef HAVE_SLANG
+#include "../tasks/task_shader.c"
+#endif
+
 /*============================================================
 PLAYLISTS
 ============================================================ */
@@ -1388,6 +1406,7 @@ MENU
 #include "../menu/cbs/menu_cbs_label.c"
 #include "../menu/cbs/menu_cbs_sublabel.c"
 #include "../menu/menu_displaylist.c"
+#include "../menu/menu_search_index.c"
 #ifdef HAVE_LIBRETRODB
 #include "../menu/menu_explore.c"
 #endif
@@ -1549,7 +1568,6 @@ XML
  LIBRETRODB
 ============================================================ */
 #ifdef HAVE_LIBRETRODB
-#include "../libretro-db/bintree.c"
 #include "../libretro-db/libretrodb.c"
 #include "../libretro-db/rmsgpack.c"
 #include "../libretro-db/rmsgpack_dom.c"
@@ -235,6 +235,7 @@ void pad_connection_packet(joypad_connection_t *joyconn, uint32_t pad,
 {
    if (!joyconn || !joyconn->connected)
        return;
+   input_driver_report_received(pad, 0);
    if (joyconn->iface && joyconn->data && joyconn->iface->packet_handler)
       joyconn->iface->packet_handler(joyconn->data, data, length);
 }
@@ -360,6 +360,19 @@ const input_device_driver_t *input_joypad_init_driver(
  **/
 void input_pad_connect(unsigned port, input_device_driver_t *driver);
 
+/**
+ * input_driver_report_received:
+ * @port                    : Joystick number.
+ * @time                    : Time the report arrived (usec), or 0
+ *                            to use the current time.
+ *
+ * Records the arrival of one input report from the pad on @port,
+ * for the report rate and jitter statistics returned by the
+ * GET_INPUT_REPORT_STATS network command. May be called from
+ * a HID driver's own thread.
+ **/
+void input_driver_report_received(unsigned port, retro_time_t time);
+
 #ifdef HAVE_HID
 #include "include/hid_driver.h"
 
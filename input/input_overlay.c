@@ -0,0 +1,135 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <retro_inline.h>
+
+#include "input_overlay.h"
+
+static INLINE unsigned input_overlay_hit_grid_cell(float pos)
+{
+   int cell = (int)(pos * OVERLAY_HIT_GRID_SIZE);
+
+   if (cell < 0)
+      return 0;
+   if (cell >= OVERLAY_HIT_GRID_SIZE)
+      return OVERLAY_HIT_GRID_SIZE - 1;
+   return (unsigned)cell;
+}
+
+/* Gets the range of grid cells covered by the hitbox of
+ * @desc, enlarged as it is while the descriptor is pressed.
+ * Positions outside the overlay fall into the edge cells. */
+static void input_overlay_desc_grid_bounds(const struct overlay_desc *desc,
+      unsigned *x0, unsigned *y0, unsigned *x1, unsigned *y1)
+{
+   float range_mod = (desc->range_mod > 1.0f) ? desc->range_mod : 1.0f;
+   float range_x   = desc->range_x * range_mod;
+   float range_y   = desc->range_y * range_mod;
+
+   *x0 = input_overlay_hit_grid_cell(desc->x_shift - range_x);
+   *x1 = input_overlay_hit_grid_cell(desc->x_shift + range_x);
+   *y0 = input_overlay_hit_grid_cell(desc->y_shift - range_y);
+   *y1 = input_overlay_hit_grid_cell(desc->y_shift + range_y);
+}
+
+/**
+ * input_overlay_build_hit_grid:
+ * @ol                    : Overlay handle.
+ *
+ * (Re)builds the hitbox grid of @ol from the current
+ * descriptor positions. Without a grid, polling falls
+ * back to testing every descriptor.
+ **/
+void input_overlay_build_hit_grid(struct overlay *ol)
+{
+   size_t i;
+   unsigned c;
+   unsigned x, y, x0, y0, x1, y1;
+   size_t total     = 0;
+   unsigned *cells  = NULL;
+   unsigned *descs  = NULL;
+
+   free(ol->hit_grid_cells);
+   free(ol->hit_grid_descs);
+   ol->hit_grid_cells = NULL;
+   ol->hit_grid_descs = NULL;
+
+   if (!ol->size)
+      return;
+
+   if (!(cells = (unsigned*)calloc(
+         OVERLAY_HIT_GRID_SIZE * OVERLAY_HIT_GRID_SIZE + 1,
+         sizeof(*cells))))
+      return;
+
+   /* Count the descriptors of each cell... */
+   for (i = 0; i < ol->size; i++)
+   {
+      input_overlay_desc_grid_bounds(&ol->descs[i], &x0, &y0, &x1, &y1);
+
+      for (y = y0; y <= y1; y++)
+         for (x = x0; x <= x1; x++)
+            cells[y * OVERLAY_HIT_GRID_SIZE + x + 1]++;
+
+      total += (x1 - x0 + 1) * (y1 - y0 + 1);
+   }
+
+   /* ...turn the counts into start offsets... */
+   for (c = 0; c < OVERLAY_HIT_GRID_SIZE * OVERLAY_HIT_GRID_SIZE; c++)
+      cells[c + 1] += cells[c];
+
+   if (!(descs = (unsigned*)malloc(total * sizeof(*descs))))
+   {
+      free(cells);
+      return;
+   }
+
+   /* ...and fill them in descriptor order, using the
+    * end offsets as write positions (shifted back to
+    * start offsets by the time all are written) */
+   for (i = 0; i < ol->size; i++)
+   {
+      input_overlay_desc_grid_bounds(&ol->descs[i], &x0, &y0, &x1, &y1);
+
+      for (y = y0; y <= y1; y++)
+         for (x = x0; x <= x1; x++)
+            descs[cells[y * OVERLAY_HIT_GRID_SIZE + x]++] = (unsigned)i;
+   }
+
+   for (c = OVERLAY_HIT_GRID_SIZE * OVERLAY_HIT_GRID_SIZE; c > 0; c--)
+      cells[c] = cells[c - 1];
+   cells[0] = 0;
+
+   ol->hit_grid_cells = cells;
+   ol->hit_grid_descs = descs;
+}
+
+const unsigned *input_overlay_hit_grid_candidates(const struct overlay *ol,
+      float x, float y, size_t *count)
+{
+   unsigned cell;
+
+   if (!ol->hit_grid_cells)
+      return NULL;
+
+   cell   = input_overlay_hit_grid_cell(y) * OVERLAY_HIT_GRID_SIZE
+      + input_overlay_hit_grid_cell(x);
+   *count = ol->hit_grid_cells[cell + 1] - ol->hit_grid_cells[cell];
+
+   return ol->hit_grid_descs + ol->hit_grid_cells[cell];
+}
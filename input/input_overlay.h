@@ -50,6 +50,14 @@ typedef struct video_overlay_interface
          float x, float y, float w, float h);
    void (*full_screen)(void *data, bool enable);
    void (*set_alpha)(void *data, unsigned image, float mod);
+   /* Optional. Like load(), but all images are packed into
+    * the single texture 'atlas'; 'rects' holds x, y, w, h
+    * (normalized to the atlas size) of each of the
+    * 'num_images' images. Lets the driver draw the whole
+    * overlay with one texture bind. May return false, in
+    * which case load() is used instead. */
+   bool (*load_atlas)(void *data, const void *atlas,
+         const float *rects, unsigned num_images);
 } video_overlay_interface_t;
 
 enum overlay_hitbox
@@ -103,11 +111,30 @@ enum overlay_orientation
    OVERLAY_ORIENTATION_PORTRAIT
 };
 
+/* Hitboxes of an overlay are bucketed into a uniform
+ * grid of OVERLAY_HIT_GRID_SIZE x OVERLAY_HIT_GRID_SIZE
+ * cells, so that polling a touch only tests the
+ * descriptors of the cell it falls into */
+#define OVERLAY_HIT_GRID_SIZE 8
+
 struct overlay
 {
    struct overlay_desc *descs;
    struct texture_image *load_images;
 
+   /* All of 'load_images' packed into one texture, and
+    * x, y, w, h of each of them inside it (normalized).
+    * Only built for video drivers with load_atlas(). */
+   struct texture_image atlas;
+   float *atlas_rects;
+
+   /* Cell 'c' of the hitbox grid holds the descriptors
+    * hit_grid_descs[hit_grid_cells[c]] up to (but not
+    * including) hit_grid_descs[hit_grid_cells[c + 1]],
+    * in descriptor order. NULL if there is no grid. */
+   unsigned *hit_grid_cells;
+   unsigned *hit_grid_descs;
+
    struct texture_image image;
 
    unsigned load_images_size;
@@ -237,10 +264,24 @@ typedef struct overlay_desc overlay_desc_t;
 
 typedef struct input_overlay input_overlay_t;
 
+/* Number of decoded overlay configs kept in memory
+ * after they were unloaded, so that loading them again
+ * doesn't decode any images */
+#define OVERLAY_CACHE_SIZE 2
+
+typedef struct
+{
+   struct overlay *overlays;
+   char *path;
+   int64_t mtime;
+   size_t size;
+} overlay_cache_entry_t;
+
 typedef struct
 {
    struct overlay *overlays;
    struct overlay *active;
+   char *overlay_path;
    size_t size;
    float overlay_opacity;
    overlay_layout_desc_t layout_desc;
@@ -253,6 +294,24 @@ void input_overlay_free_overlay(struct overlay *overlay);
 
 void input_overlay_set_visibility(int overlay_idx,enum overlay_visibility vis);
 
+void input_overlay_build_hit_grid(struct overlay *ol);
+
+/**
+ * input_overlay_hit_grid_candidates:
+ * @ol                    : Overlay handle.
+ * @x                     : X coordinate, in overlay space.
+ * @y                     : Y coordinate, in overlay space.
+ * @count                 : Number of candidates.
+ *
+ * Looks up the descriptors whose hitbox can contain
+ * the point (@x, @y), in descriptor order.
+ *
+ * Returns: indices into the descriptors of @ol, or
+ * NULL if @ol has no grid and every one is a candidate.
+ **/
+const unsigned *input_overlay_hit_grid_candidates(const struct overlay *ol,
+      float x, float y, size_t *count);
+
 RETRO_END_DECLS
 
 #endif
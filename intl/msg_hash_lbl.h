@@ -126,6 +126,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
    "audio_rate_control_delta"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_PI,
+   "audio_rate_control_pi"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_TARGET,
+   "audio_rate_control_target"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER,
    "audio_resampler_driver"
@@ -150,6 +158,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_SYNC,
    "audio_sync"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_THREADED_PROCESSING,
+   "audio_threaded_processing"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_VOLUME,
    "audio_volume"
@@ -1176,6 +1188,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_CORE_INFO_CACHE_ENABLE,
    "core_info_cache_enable"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VFS_READ_BLOCK_SIZE,
+   "vfs_read_block_size"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_DUMMY_ON_CORE_SHUTDOWN,
    "dummy_on_core_shutdown"
@@ -1198,6 +1214,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_FASTFORWARD_RATIO,
    "fastforward_ratio"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_FASTFORWARD_FRAMESKIP,
+   "fastforward_frameskip"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_FILE_BROWSER_CORE,
    "file_browser_core"
@@ -1722,6 +1742,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_LOG_TO_FILE_TIMESTAMP,
    "log_to_file_timestamp"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_LOG_ASYNC,
+   "log_async"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_TRACE_DURATION,
+   "trace_duration"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MAIN_MENU,
    "main_menu"
@@ -1890,6 +1918,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_NETPLAY_NAT_TRAVERSAL,
    "netplay_nat_traversal"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_NETPLAY_UDP_INPUT,
+   "netplay_udp_input"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_NETPLAY_RELAY_PORT,
+   "netplay_relay_port"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_NETPLAY_NICKNAME,
    "netplay_nickname"
@@ -1970,6 +2006,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_NETWORK_ON_DEMAND_THUMBNAILS,
    "network_on_demand_thumbnails"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_NETWORK_THUMBNAIL_DOWNLOADS,
+   "network_thumbnail_downloads"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SUBSYSTEM_SETTINGS,
    "subsystem_settings"
@@ -2174,6 +2214,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_INSERT_DISK_RESUME,
    "menu_insert_disk_resume"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_SKIP_STATIC_FRAMES,
+   "menu_skip_static_frames"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_QUIT_ON_CLOSE_CONTENT,
    "quit_on_close_content"
@@ -2800,6 +2844,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_SHADER_REMEMBER_LAST_DIR,
    "video_shader_remember_last_dir"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_SHADER_FP16_FRAMEBUFFERS,
+   "video_shader_fp16_framebuffers"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SHADER_OPTIONS,
    "shader_options"
@@ -2844,6 +2892,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,
    "run_ahead_frames"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_CALIBRATE,
+   "run_ahead_calibrate"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SORT_SAVEFILES_ENABLE,
    "sort_savefiles_enable"
@@ -2958,6 +3010,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "menu_thumbnail_upscale_threshold"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "menu_thumbnail_cache_size"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,
    "rgui_thumbnail_downscaler"
@@ -3210,6 +3266,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_FONT_SIZE,
    "video_font_size"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_FONT_SDF_ENABLE,
+   "video_font_sdf_enable"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_FORCE_ASPECT,
    "video_force_aspect"
@@ -3222,6 +3282,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,
    "video_frame_delay"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+   "video_frame_delay_auto"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_SHADER_DELAY,
    "video_shader_delay"
@@ -3238,10 +3302,18 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_GPU_RECORD,
    "video_gpu_record"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_FRAME_DUPE_DETECT,
+   "video_frame_dupe_detect"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT,
    "video_gpu_screenshot"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SCREENSHOT_MODE,
+   "screenshot_mode"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_HARD_SYNC,
    "video_hard_sync"
@@ -4272,6 +4344,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SUSTAINED_PERFORMANCE_MODE,
    "sustained_performance_mode"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_POWER_SAVING_MODE,
+   "power_saving_mode"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_CHEAT_IDX,
    "cheat_idx"
@@ -4686,6 +4762,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SCAN_WITHOUT_CORE_MATCH,
    "scan_without_core_match"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SCAN_THREADS,
+   "scan_threads"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_XMB_ANIMATION_HORIZONTAL_HIGHLIGHT,
    "xmb_menu_animation_horizontal_highlight"
@@ -229,6 +229,11 @@ int msg_hash_get_help_us_enum(enum msg_hash_enums msg, char *s, size_t len)
              snprintf(s, len,
                    "Toggles Run-Ahead mode on/off.");
              break;
+          case RARCH_TRACE_TOGGLE:
+             snprintf(s, len,
+                   "Starts recording a Chrome trace of the \n"
+                   "main loop, or stops and writes it.");
+             break;
           default:
              if (string_is_empty(s))
                 strlcpy(s, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_INFORMATION_AVAILABLE), len);
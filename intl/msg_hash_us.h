@@ -1336,6 +1336,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_BLACK_FRAME_INSERTION,
    "Insert a black frame between frames. Useful on some high refresh rate screens to eliminate ghosting."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DUPE_DETECT,
+   "Detect Duplicate Frames"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_FRAME_DUPE_DETECT,
+   "Compare each software rendered frame with the previous one and skip uploading it when nothing changed. Saves bandwidth and power with cores that repeat identical frames, at the cost of reading every frame once."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_GPU_SCREENSHOT,
    "GPU Screenshot"
@@ -1344,6 +1352,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_GPU_SCREENSHOT,
    "Screenshots capture GPU shaded material if available."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SCREENSHOT_MODE,
+   "Screenshot Format"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SCREENSHOT_MODE,
+   "'PNG (Fast)' compresses on all CPU cores at a lower level. 'BMP' skips compression, for taking many screenshots in a row. Savestate thumbnails are always PNG."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_SMOOTH,
    "Bilinear Filtering"
@@ -1720,6 +1736,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY,
    "Reduces latency at the cost of a higher risk of video stuttering. Adds a delay after VSync (in ms)."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO,
+   "Automatic Frame Delay"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY_AUTO,
+   "Picks the frame delay from the measured core run time, backing off when frames are missed. A non-zero 'Frame Delay' sets the upper limit."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_HARD_SYNC,
    "Hard GPU Sync"
@@ -1928,6 +1952,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_SYNC,
    "Synchronize audio. Recommended."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_THREADED_PROCESSING,
+   "Threaded Audio Processing"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_THREADED_PROCESSING,
+   "Run DSP filters, resampling and mixing on a separate thread, in parallel with the core. Adds up to one audio chunk of latency."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_AUDIO_MAX_TIMING_SKEW,
    "Maximum Timing Skew"
@@ -1944,6 +1976,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_DELTA,
    "Helps smooth out imperfections in timing when synchronizing audio and video. Be aware that if disabled, proper synchronization is nearly impossible to obtain."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_PI,
+   "Smoothed Rate Control"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_PI,
+   "Adjust the audio rate based on the averaged buffer fill level, and also correct steady drift over time. Oscillates less with small buffers, allowing lower audio latency."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_TARGET,
+   "Rate Control Target Fill (%)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_TARGET,
+   "How full the audio buffer is kept by smoothed rate control. Lower values reduce latency, higher values protect better against underruns."
+   )
 
 /* Settings > Audio > MIDI */
 
@@ -2645,6 +2693,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE,
    "Captures an image of the current content then translates and/or reads aloud any on-screen text.\n'AI Service' Must be enabled and configured."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_INPUT_META_TRACE_TOGGLE,
+   "Trace Recording (Toggle)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_INPUT_META_TRACE_TOGGLE,
+   "Records a timeline of the main loop, video and task threads to a Chrome trace file in the log directory."
+   )
 
 /* Settings > Input > Port # Controls */
 
@@ -2855,6 +2911,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS,
    "Hide the warning message that appears when using Run-Ahead and the core does not support save states."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_CALIBRATE,
+   "Calibrate Run-Ahead Frames"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_CALIBRATE,
+   "Measure how many frames the running game takes to respond to input, and save that number of Run-Ahead frames as a game override. Use during gameplay, not in the game's menus."
+   )
 
 /* Settings > Core */
 
@@ -2902,6 +2966,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_CORE_INFO_CACHE_ENABLE,
    "Maintain a persistent local cache of installed core information. Greatly reduces loading times on platforms with slow disk access."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VFS_READ_BLOCK_SIZE,
+   "Content Read Cache Block Size"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VFS_READ_BLOCK_SIZE,
+   "Read large content files in blocks of this size, loading the next block in the background while a file is read in order. Reduces stalls when disc images are on a network share. Takes effect for files opened afterwards."
+   )
 #ifndef HAVE_DYNAMIC
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_ALWAYS_RELOAD_CORE_ON_RUN_CONTENT,
@@ -3165,6 +3237,26 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_LOG_TO_FILE_TIMESTAMP,
    "When logging to file, redirect the output from each RetroArch session to a new timestamped file. If disabled, log is overwritten each time RetroArch is restarted."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_LOG_ASYNC,
+   "Asynchronous Logging"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_LOG_ASYNC,
+   "Write log messages from a background thread. Repeated messages are collapsed, log files are rotated once they grow large, and messages may be dropped under heavy load."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_TRACE_DURATION,
+   "Trace Recording Duration"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_TRACE_DURATION,
+   "Number of seconds recorded after the trace recording hotkey is pressed. At 0 recording goes on until the hotkey is pressed again."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_TRACE_DURATION_MANUAL,
+   "Until Stopped"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PERFCNT_ENABLE,
    "Performance Counters"
@@ -3235,6 +3327,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_FASTFORWARD_RATIO,
    "The maximum rate at which content will be run when using fast-forward (e.g., 5.0x for 60 fps content = 300 fps cap). If set to 0.0x, fast-forward ratio is unlimited (no FPS cap)."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_FASTFORWARD_FRAMESKIP,
+   "Fast-Forward Frameskip"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_FASTFORWARD_FRAMESKIP,
+   "When fast-forwarding, only display about one frame per screen refresh and skip audio of the frames in between. Allows fast-forwarding faster than the display can present frames."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SLOWMOTION_RATIO,
    "Slow-Motion Rate"
@@ -3850,6 +3950,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_FONT_SIZE,
    "Specify the font size in points."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_FONT_SDF_ENABLE,
+   "Scalable Font Rendering"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_FONT_SDF_ENABLE,
+   "Render menu and notification text from a single distance field atlas per font. Text stays sharp at any size and changing the scale does not rasterize the font again. Only supported by some video drivers."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_MESSAGE_POS_X,
    "Notification Position (Horizontal)"
@@ -3973,6 +4081,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_INSERT_DISK_RESUME,
    "Automatically close the menu and resume content after inserting or loading a new disc."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_SKIP_STATIC_FRAMES,
+   "Skip Static Menu Frames"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_SKIP_STATIC_FRAMES,
+   "Stop redrawing the menu while nothing on screen changes. Reduces power consumption when the menu is idle."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_QUIT_ON_CLOSE_CONTENT,
    "Quit on Close Content"
@@ -4793,6 +4909,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "Automatically upscale thumbnail images with a width/height smaller than the specified value. Improves picture quality. Has a moderate performance impact."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+   "Thumbnail Cache Size"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "Video memory (in MB) used to keep thumbnails after they leave the screen and to load those of neighbouring entries in advance. Makes scrolling through playlists smoother. Set to 0 to disable."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_MENU_TICKER_TYPE,
    "Ticker Text Animation"
@@ -5095,6 +5219,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_NETPLAY_NAT_TRAVERSAL,
    "When hosting, attempt to listen for connections from the public Internet, using UPnP or similar technologies to escape LANs."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_NETPLAY_UDP_INPUT,
+   "Netplay UDP Input"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_NETPLAY_UDP_INPUT,
+   "Also send input over UDP, on the port after the netplay port, repeating recent frames in every packet. Fewer stalls on lossy networks such as Wi-Fi. Only used if the other side has it enabled too."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_NETPLAY_RELAY_PORT,
+   "Netplay Spectator Relay Port"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_NETPLAY_RELAY_PORT,
+   "When connected as a spectator, pass the game on to further spectators connecting to this TCP port, so they don't use the host's bandwidth. A relay stays a spectator. 0 disables it."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_NETPLAY_SHARE_DIGITAL,
    "Digital Input Sharing"
@@ -5143,6 +5283,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_NETWORK_ON_DEMAND_THUMBNAILS,
    "Automatically download missing thumbnails while browsing playlists. Has a severe performance impact."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_NETWORK_THUMBNAIL_DOWNLOADS,
+   "Parallel Thumbnail Downloads"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_NETWORK_THUMBNAIL_DOWNLOADS,
+   "Number of thumbnails fetched at the same time when downloading thumbnails for a playlist."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_UPDATER_SETTINGS,
    "Updater"
@@ -5325,6 +5473,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SCAN_WITHOUT_CORE_MATCH,
    "Allow content to be scanned and added to a playlist without a core installed that supports it."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SCAN_THREADS,
+   "Scan Threads"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SCAN_THREADS,
+   "Number of files read and hashed at the same time while scanning content. Higher values make scans of large collections faster, especially on network storage."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PLAYLIST_MANAGER_LIST,
    "Manage Playlists"
@@ -6869,6 +7025,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_SHADER_REMEMBER_LAST_DIR,
    "Open the file browser at the last used directory when loading shader presets and passes."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_FP16_FRAMEBUFFERS,
+   "Half Precision Shader Framebuffers"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_SHADER_FP16_FRAMEBUFFERS,
+   "Render shader passes that ask for 32-bit float framebuffers to 16-bit float ones instead. Halves their memory bandwidth, which helps on mobile GPUs, but may cause artifacts in some shaders. Applies when a preset is loaded."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_PRESET,
    "Load"
@@ -10722,6 +10886,10 @@ MSG_HASH(
    MSG_APPLYING_SHADER,
    "Applying shader"
    )
+MSG_HASH(
+   MSG_COMPILING_SHADER,
+   "Compiling shader"
+   )
 MSG_HASH(
    MSG_AUDIO_MUTED,
    "Audio muted."
@@ -11650,6 +11818,18 @@ MSG_HASH(
    MSG_CORE_REMAP_FILE_LOADED,
    "Core remap file loaded."
    )
+MSG_HASH(
+   MSG_TRACE_STARTED,
+   "Trace recording started."
+   )
+MSG_HASH(
+   MSG_TRACE_WRITTEN,
+   "Trace written to"
+   )
+MSG_HASH(
+   MSG_TRACE_FAILED,
+   "Failed to write trace."
+   )
 MSG_HASH(
    MSG_RUNAHEAD_ENABLED,
    "Run-Ahead enabled. Latency frames removed: %u."
@@ -11678,6 +11858,18 @@ MSG_HASH(
    MSG_RUNAHEAD_FAILED_TO_CREATE_SECONDARY_INSTANCE,
    "Failed to create second instance.  Run-Ahead will now use only one instance."
    )
+MSG_HASH(
+   MSG_RUNAHEAD_CALIBRATED,
+   "Run-Ahead calibrated. Latency frames: %u."
+   )
+MSG_HASH(
+   MSG_RUNAHEAD_CALIBRATION_NO_LAG,
+   "Run-Ahead calibration found no input lag to remove."
+   )
+MSG_HASH(
+   MSG_RUNAHEAD_CALIBRATION_FAILED,
+   "Run-Ahead calibration failed. The core must support save states, render in software and respond to input within %u frames."
+   )
 MSG_HASH(
    MSG_SCANNING_OF_FILE_FINISHED,
    "Scanning of file finished"
@@ -12092,6 +12284,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SUSTAINED_PERFORMANCE_MODE,
    "Sustained Performance Mode"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_POWER_SAVING_MODE,
+   "Power Saving Mode"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_POWER_SAVING_MODE,
+   "Save battery: sleep until each frame is due instead of busy-waiting, delay running the core by its measured run time, limit the menu frame rate and keep CPU clocks low where supported."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_CPU_PERFPOWER,
    "CPU Performance and Power"
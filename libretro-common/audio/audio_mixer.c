@@ -31,6 +31,7 @@
 #include <formats/rwav.h>
 #endif
 #include <memalign.h>
+#include <streams/file_stream.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -64,10 +65,22 @@
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
 
+/* Size of the canonical WAV header accepted by rwav */
+#define AUDIO_MIXER_WAV_HEADER_SIZE 44
+
+/* Compressed sounds up to this long are decoded once at
+ * the output rate and replayed from memory */
+#define AUDIO_MIXER_CACHE_MAX_SECONDS 5
+#define AUDIO_MIXER_CACHE_CHUNK_FRAMES 1024
+
 struct audio_mixer_sound
 {
    enum audio_mixer_type type;
 
+   /* Set when the sound is streamed from disk,
+    * see audio_mixer_load_file() */
+   char *path;
+
    union
    {
       struct
@@ -75,6 +88,10 @@ struct audio_mixer_sound
          /* wav */
          const float* pcm;
          unsigned frames;
+         /* streamed wav only */
+         unsigned rate;
+         unsigned channels;
+         unsigned bits;
       } wav;
 
 #ifdef HAVE_STB_VORBIS
@@ -113,6 +130,16 @@ struct audio_mixer_sound
       } mod;
 #endif
    } types;
+
+   /* Decoded and resampled PCM of a short compressed sound.
+    * Valid for output rate 'rate'; pcm stays NULL if the
+    * sound was too long to be cached at that rate. */
+   struct
+   {
+      float *pcm;
+      unsigned frames;
+      unsigned rate;
+   } cache;
 };
 
 struct audio_mixer_voice
@@ -122,6 +149,14 @@ struct audio_mixer_voice
       struct
       {
          unsigned position;
+         /* streamed wav only */
+         RFILE       *file;
+         void        *resampler_data;
+         const retro_resampler_t *resampler;
+         float       *buffer;
+         unsigned    samples;
+         unsigned    frames_left;
+         float       ratio;
       } wav;
 
 #ifdef HAVE_STB_VORBIS
@@ -143,6 +178,7 @@ struct audio_mixer_voice
       {
          float*      buffer;
          drflac      *stream;
+         RFILE       *file;
          void        *resampler_data;
          const retro_resampler_t *resampler;
          unsigned    position;
@@ -156,6 +192,7 @@ struct audio_mixer_voice
       struct
       {
          drmp3       stream;
+         RFILE       *file;
          void        *resampler_data;
          const retro_resampler_t *resampler;
          float*      buffer;
@@ -181,8 +218,11 @@ struct audio_mixer_voice
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
    unsigned type;
+   unsigned cache_position;
    float    volume;
    bool     repeat;
+   /* Playing sound->cache instead of decoding */
+   bool     cached;
 
 };
 
@@ -190,6 +230,8 @@ struct audio_mixer_voice
 static struct audio_mixer_voice s_voices[AUDIO_MIXER_MAX_VOICES] = {0};
 static unsigned s_rate = 0;
 
+static bool audio_mixer_cache_sound(audio_mixer_sound_t* sound);
+
 #ifdef HAVE_RWAV
 static bool wav_to_float(const rwav_t* wav, float** pcm, size_t samples_out)
 {
@@ -305,6 +347,117 @@ static bool one_shot_resample(const float* in, size_t samples_in,
 }
 #endif
 
+#if defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+static size_t audio_mixer_file_read(void *userdata,
+      void *out, size_t len)
+{
+   int64_t ret = filestream_read((RFILE*)userdata, out, (int64_t)len);
+   return (ret > 0) ? (size_t)ret : 0;
+}
+
+static bool audio_mixer_file_seek(void *userdata,
+      int offset, bool from_current)
+{
+   return filestream_seek((RFILE*)userdata, offset, from_current
+         ? RETRO_VFS_SEEK_POSITION_CURRENT
+         : RETRO_VFS_SEEK_POSITION_START) != -1;
+}
+#endif
+
+#ifdef HAVE_DR_FLAC
+static drflac_bool32 audio_mixer_flac_seek(void *userdata,
+      int offset, drflac_seek_origin origin)
+{
+   return audio_mixer_file_seek(userdata, offset,
+         origin == drflac_seek_origin_current);
+}
+#endif
+
+#ifdef HAVE_DR_MP3
+static drmp3_bool32 audio_mixer_mp3_seek(void *userdata,
+      int offset, drmp3_seek_origin origin)
+{
+   return audio_mixer_file_seek(userdata, offset,
+         origin == drmp3_seek_origin_current);
+}
+#endif
+
+static RFILE *audio_mixer_open_file(const char *path)
+{
+   return filestream_open(path, RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+}
+
+/* Validates the header of a streamed WAV file. Only the
+ * layout rwav understands is accepted: 8 or 16-bit PCM,
+ * mono or stereo, with the samples right after the header. */
+static bool audio_mixer_wav_read_header(audio_mixer_sound_t *sound)
+{
+   uint8_t data[AUDIO_MIXER_WAV_HEADER_SIZE];
+   uint32_t data_size = 0;
+   int64_t file_size  = 0;
+   int64_t bytes      = 0;
+   RFILE *file        = audio_mixer_open_file(sound->path);
+
+   if (!file)
+      return false;
+
+   file_size = filestream_get_size(file);
+   bytes     = filestream_read(file, data, sizeof(data));
+   filestream_close(file);
+
+   if (bytes != sizeof(data))
+      return false;
+
+   if (     memcmp(data,      "RIFF", 4)
+         || memcmp(data + 8,  "WAVE", 4)
+         || memcmp(data + 12, "fmt ", 4)
+         || memcmp(data + 36, "data", 4))
+      return false;
+
+   /* PCM only */
+   if (data[16] != 16 || data[17] != 0 || data[18] != 0 || data[19] != 0)
+      return false;
+   if (data[20] != 1 || data[21] != 0)
+      return false;
+
+   sound->types.wav.channels = data[22] | data[23] << 8;
+   sound->types.wav.rate     = data[24] | data[25] << 8
+      | data[26] << 16 | (uint32_t)data[27] << 24;
+   sound->types.wav.bits     = data[34] | data[35] << 8;
+   data_size                 = data[40] | data[41] << 8
+      | data[42] << 16 | (uint32_t)data[43] << 24;
+
+   if (sound->types.wav.bits != 8 && sound->types.wav.bits != 16)
+      return false;
+   if (sound->types.wav.channels != 1 && sound->types.wav.channels != 2)
+      return false;
+   if (!sound->types.wav.rate)
+      return false;
+   if (data_size > file_size - AUDIO_MIXER_WAV_HEADER_SIZE)
+      return false;
+
+   sound->types.wav.frames   = data_size / (sound->types.wav.channels
+         * (sound->types.wav.bits / 8));
+
+   return sound->types.wav.frames != 0;
+}
+
+static void audio_mixer_wav_stream_close(audio_mixer_voice_t* voice)
+{
+   if (voice->types.wav.file)
+      filestream_close(voice->types.wav.file);
+   if (voice->types.wav.resampler && voice->types.wav.resampler_data)
+      voice->types.wav.resampler->free(voice->types.wav.resampler_data);
+   if (voice->types.wav.buffer)
+      memalign_free(voice->types.wav.buffer);
+
+   voice->types.wav.file           = NULL;
+   voice->types.wav.resampler      = NULL;
+   voice->types.wav.resampler_data = NULL;
+   voice->types.wav.buffer         = NULL;
+}
+
 void audio_mixer_init(unsigned rate)
 {
    unsigned i;
@@ -320,7 +473,11 @@ void audio_mixer_done(void)
    unsigned i;
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+   {
+      if (s_voices[i].type == AUDIO_MIXER_TYPE_WAV)
+         audio_mixer_wav_stream_close(&s_voices[i]);
       s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   }
 }
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
@@ -447,6 +604,50 @@ audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size)
 #endif
 }
 
+audio_mixer_sound_t* audio_mixer_load_file(const char *path,
+      enum audio_mixer_type type)
+{
+   audio_mixer_sound_t* sound = NULL;
+
+   if (!path || !*path)
+      return NULL;
+
+   switch (type)
+   {
+      case AUDIO_MIXER_TYPE_WAV:
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+#endif
+         break;
+      default:
+         return NULL;
+   }
+
+   sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+
+   if (!sound)
+      return NULL;
+
+   sound->type = type;
+   sound->path = strdup(path);
+
+   if (!sound->path)
+      goto error;
+
+   if (type == AUDIO_MIXER_TYPE_WAV && !audio_mixer_wav_read_header(sound))
+      goto error;
+
+   return sound;
+
+error:
+   free(sound->path);
+   free(sound);
+   return NULL;
+}
+
 void audio_mixer_destroy(audio_mixer_sound_t* sound)
 {
    void *handle = NULL;
@@ -492,14 +693,81 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
          break;
    }
 
+   if (sound->path)
+      free(sound->path);
+   if (sound->cache.pcm)
+      free(sound->cache.pcm);
    free(sound);
 }
 
+static bool audio_mixer_play_wav_stream(audio_mixer_sound_t* sound,
+      audio_mixer_voice_t* voice)
+{
+   float ratio                     = 1.0f;
+   unsigned samples                = 0;
+   void *wav_buffer                = NULL;
+   void *resampler_data            = NULL;
+   const retro_resampler_t* resamp = NULL;
+   RFILE *file                     = audio_mixer_open_file(sound->path);
+
+   if (!file)
+      return false;
+
+   if (filestream_seek(file, AUDIO_MIXER_WAV_HEADER_SIZE,
+            RETRO_VFS_SEEK_POSITION_START) == -1)
+      goto error;
+
+   if (sound->types.wav.rate != s_rate)
+   {
+      ratio = (double)s_rate / (double)sound->types.wav.rate;
+
+      if (!retro_resampler_realloc(&resampler_data,
+               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
+               ratio))
+         goto error;
+   }
+
+   /* A few extra samples, the resampler may output
+    * slightly more than the ratio suggests */
+   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio) + 16;
+   wav_buffer                      = (float*)memalign_alloc(16,
+         ((samples + 15) & ~15) * sizeof(float));
+
+   if (!wav_buffer)
+   {
+      if (resamp && resampler_data)
+         resamp->free(resampler_data);
+      goto error;
+   }
+
+   voice->types.wav.file           = file;
+   voice->types.wav.resampler      = resamp;
+   voice->types.wav.resampler_data = resampler_data;
+   voice->types.wav.buffer         = (float*)wav_buffer;
+   voice->types.wav.ratio          = ratio;
+   voice->types.wav.frames_left    = sound->types.wav.frames;
+   voice->types.wav.position       = 0;
+   voice->types.wav.samples        = 0;
+
+   return true;
+
+error:
+   filestream_close(file);
+   return false;
+}
+
 static bool audio_mixer_play_wav(audio_mixer_sound_t* sound,
       audio_mixer_voice_t* voice, bool repeat, float volume,
       audio_mixer_stop_cb_t stop_cb)
 {
-   voice->types.wav.position = 0;
+   voice->types.wav.position       = 0;
+   voice->types.wav.file           = NULL;
+   voice->types.wav.resampler      = NULL;
+   voice->types.wav.resampler_data = NULL;
+   voice->types.wav.buffer         = NULL;
+
+   if (sound->path)
+      return audio_mixer_play_wav_stream(sound, voice);
    return true;
 }
 
@@ -663,10 +931,25 @@ static bool audio_mixer_play_flac(
    void *flac_buffer                = NULL;
    void *resampler_data            = NULL;
    const retro_resampler_t* resamp = NULL;
-   drflac *dr_flac          = drflac_open_memory((const unsigned char*)sound->types.flac.data,sound->types.flac.size);
+   RFILE *file                     = NULL;
+   drflac *dr_flac                 = NULL;
+
+   if (sound->path)
+   {
+      if (!(file = audio_mixer_open_file(sound->path)))
+         return false;
+      dr_flac = drflac_open(audio_mixer_file_read,
+            audio_mixer_flac_seek, file);
+   }
+   else
+      dr_flac = drflac_open_memory((const unsigned char*)sound->types.flac.data,sound->types.flac.size);
 
    if (!dr_flac)
+   {
+      if (file)
+         filestream_close(file);
       return false;
+   }
    if (dr_flac->sampleRate != s_rate)
    {
       ratio = (double)s_rate / (double)(dr_flac->sampleRate);
@@ -690,6 +973,8 @@ static bool audio_mixer_play_flac(
 
    if (voice->types.flac.stream)
       drflac_close(voice->types.flac.stream);
+   if (voice->types.flac.file)
+      filestream_close(voice->types.flac.file);
    if (voice->types.flac.resampler && voice->types.flac.resampler_data)
       voice->types.flac.resampler->free(voice->types.flac.resampler_data);
    if (voice->types.flac.buffer)
@@ -701,6 +986,7 @@ static bool audio_mixer_play_flac(
    voice->types.flac.buf_samples    = samples;
    voice->types.flac.ratio          = ratio;
    voice->types.flac.stream         = dr_flac;
+   voice->types.flac.file           = file;
    voice->types.flac.position       = 0;
    voice->types.flac.samples        = 0;
 
@@ -708,6 +994,8 @@ static bool audio_mixer_play_flac(
 
 error:
    drflac_close(dr_flac);
+   if (file)
+      filestream_close(file);
    return false;
 }
 #endif
@@ -724,6 +1012,7 @@ static bool audio_mixer_play_mp3(
    void *mp3_buffer                = NULL;
    void *resampler_data            = NULL;
    const retro_resampler_t* resamp = NULL;
+   RFILE *file                     = NULL;
    bool res;
 
    if (voice->types.mp3.stream.pData)
@@ -731,11 +1020,28 @@ static bool audio_mixer_play_mp3(
       drmp3_uninit(&voice->types.mp3.stream);
       memset(&voice->types.mp3.stream, 0, sizeof(voice->types.mp3.stream));
    }
+   if (voice->types.mp3.file)
+   {
+      filestream_close(voice->types.mp3.file);
+      voice->types.mp3.file = NULL;
+   }
 
-   res = drmp3_init_memory(&voice->types.mp3.stream, (const unsigned char*)sound->types.mp3.data, sound->types.mp3.size, NULL);
+   if (sound->path)
+   {
+      if (!(file = audio_mixer_open_file(sound->path)))
+         return false;
+      res = drmp3_init(&voice->types.mp3.stream, audio_mixer_file_read,
+            audio_mixer_mp3_seek, file, NULL);
+   }
+   else
+      res = drmp3_init_memory(&voice->types.mp3.stream, (const unsigned char*)sound->types.mp3.data, sound->types.mp3.size, NULL);
 
    if (!res)
+   {
+      if (file)
+         filestream_close(file);
       return false;
+   }
 
    if (voice->types.mp3.stream.sampleRate != s_rate)
    {
@@ -769,6 +1075,7 @@ static bool audio_mixer_play_mp3(
    voice->types.mp3.buffer         = (float*)mp3_buffer;
    voice->types.mp3.buf_samples    = samples;
    voice->types.mp3.ratio          = ratio;
+   voice->types.mp3.file           = file;
    voice->types.mp3.position       = 0;
    voice->types.mp3.samples        = 0;
 
@@ -776,6 +1083,8 @@ static bool audio_mixer_play_mp3(
 
 error:
    drmp3_uninit(&voice->types.mp3.stream);
+   if (file)
+      filestream_close(file);
    return false;
 }
 #endif
@@ -795,6 +1104,15 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       if (voice->type != AUDIO_MIXER_TYPE_NONE)
          continue;
 
+      voice->cached = audio_mixer_cache_sound(sound);
+
+      if (voice->cached)
+      {
+         voice->cache_position = 0;
+         res                   = true;
+         break;
+      }
+
       switch (sound->type)
       {
          case AUDIO_MIXER_TYPE_WAV:
@@ -851,6 +1169,9 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
       stop_cb     = voice->stop_cb;
       sound       = voice->sound;
 
+      if (voice->type == AUDIO_MIXER_TYPE_WAV)
+         audio_mixer_wav_stream_close(voice);
+
       voice->type = AUDIO_MIXER_TYPE_NONE;
 
       if (stop_cb)
@@ -858,17 +1179,15 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
    }
 }
 
-static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+/* Mixes interleaved stereo PCM that is already at the output rate */
+static void audio_mixer_mix_pcm(float* buffer, size_t num_frames,
+      audio_mixer_voice_t* voice, float volume,
+      const float* pcm_start, unsigned frames, unsigned *position)
 {
    int i;
    unsigned buf_free                = (unsigned)(num_frames * 2);
-   const audio_mixer_sound_t* sound = voice->sound;
-   unsigned pcm_available           = sound->types.wav.frames
-      * 2 - voice->types.wav.position;
-   const float* pcm                 = sound->types.wav.pcm +
-      voice->types.wav.position;
+   unsigned pcm_available           = frames * 2 - *position;
+   const float* pcm                 = pcm_start + *position;
 
 again:
    if (pcm_available < buf_free)
@@ -882,9 +1201,9 @@ again:
             voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
 
          buf_free                  -= pcm_available;
-         pcm_available              = sound->types.wav.frames * 2;
-         pcm                        = sound->types.wav.pcm;
-         voice->types.wav.position  = 0;
+         pcm_available              = frames * 2;
+         pcm                        = pcm_start;
+         *position                  = 0;
          goto again;
       }
 
@@ -898,7 +1217,164 @@ again:
       for (i = buf_free; i != 0; i--)
          *buffer++ += *pcm++ * volume;
 
-      voice->types.wav.position += buf_free;
+      *position += buf_free;
+   }
+}
+
+static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
+      audio_mixer_voice_t* voice,
+      float volume)
+{
+   const audio_mixer_sound_t* sound = voice->sound;
+
+   audio_mixer_mix_pcm(buffer, num_frames, voice, volume,
+         sound->types.wav.pcm, sound->types.wav.frames,
+         &voice->types.wav.position);
+}
+
+static void audio_mixer_mix_cached(float* buffer, size_t num_frames,
+      audio_mixer_voice_t* voice,
+      float volume)
+{
+   const audio_mixer_sound_t* sound = voice->sound;
+
+   audio_mixer_mix_pcm(buffer, num_frames, voice, volume,
+         sound->cache.pcm, sound->cache.frames,
+         &voice->cache_position);
+}
+
+/* Decodes the next chunk of a streamed WAV into the voice buffer.
+ * Returns false once the end of the samples has been reached. */
+static bool audio_mixer_wav_stream_fill(audio_mixer_voice_t* voice)
+{
+   unsigned i;
+   uint8_t raw[AUDIO_MIXER_TEMP_BUFFER];
+   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER];
+   struct resampler_data info;
+   const audio_mixer_sound_t* sound = voice->sound;
+   unsigned channels                = sound->types.wav.channels;
+   unsigned frame_size              = channels * (sound->types.wav.bits / 8);
+   unsigned frames                  = AUDIO_MIXER_TEMP_BUFFER / frame_size;
+   float *out                       = temp_buffer;
+   int64_t bytes                    = 0;
+
+   /* The float buffer is always stereo */
+   if (frames > AUDIO_MIXER_TEMP_BUFFER / 2)
+      frames = AUDIO_MIXER_TEMP_BUFFER / 2;
+   if (frames > voice->types.wav.frames_left)
+      frames = voice->types.wav.frames_left;
+   if (frames == 0)
+      return false;
+
+   bytes = filestream_read(voice->types.wav.file, raw, frames * frame_size);
+
+   if (bytes < (int64_t)frame_size)
+      return false;
+
+   frames                         = (unsigned)(bytes / frame_size);
+   voice->types.wav.frames_left  -= frames;
+
+   if (sound->types.wav.bits == 8)
+   {
+      for (i = 0; i < frames * channels; i++)
+      {
+         float sample = (float)raw[i] / 255.0f;
+         sample       = sample * 2.0f - 1.0f;
+         *out++       = sample;
+         if (channels == 1)
+            *out++    = sample;
+      }
+   }
+   else
+   {
+      for (i = 0; i < frames * channels; i++)
+      {
+         int16_t s16  = (int16_t)(raw[i * 2] | raw[i * 2 + 1] << 8);
+         float sample = (float)((int)s16 + 32768) / 65535.0f;
+         sample       = sample * 2.0f - 1.0f;
+         *out++       = sample;
+         if (channels == 1)
+            *out++    = sample;
+      }
+   }
+
+   if (voice->types.wav.resampler)
+   {
+      info.data_in              = temp_buffer;
+      info.data_out             = voice->types.wav.buffer;
+      info.input_frames         = frames;
+      info.output_frames        = 0;
+      info.ratio                = voice->types.wav.ratio;
+
+      voice->types.wav.resampler->process(
+            voice->types.wav.resampler_data, &info);
+      voice->types.wav.samples  = (unsigned)(info.output_frames * 2);
+   }
+   else
+   {
+      memcpy(voice->types.wav.buffer, temp_buffer,
+            frames * 2 * sizeof(float));
+      voice->types.wav.samples  = frames * 2;
+   }
+
+   voice->types.wav.position    = 0;
+   return true;
+}
+
+static void audio_mixer_mix_wav_stream(float* buffer, size_t num_frames,
+      audio_mixer_voice_t* voice,
+      float volume)
+{
+   unsigned i;
+   unsigned buf_free                = (unsigned)(num_frames * 2);
+   bool rewound                     = false;
+
+   while (buf_free)
+   {
+      const float* pcm              = NULL;
+      unsigned pcm_available        = voice->types.wav.samples
+         - voice->types.wav.position;
+
+      if (pcm_available == 0)
+      {
+         if (audio_mixer_wav_stream_fill(voice))
+         {
+            rewound = false;
+            continue;
+         }
+
+         /* Don't spin if the file can't be read after a rewind */
+         if (voice->repeat && !rewound && filestream_seek(
+                  voice->types.wav.file, AUDIO_MIXER_WAV_HEADER_SIZE,
+                  RETRO_VFS_SEEK_POSITION_START) != -1)
+         {
+            if (voice->stop_cb)
+               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
+
+            voice->types.wav.frames_left = voice->sound->types.wav.frames;
+            rewound                      = true;
+            continue;
+         }
+
+         audio_mixer_wav_stream_close(voice);
+
+         if (voice->stop_cb)
+            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
+
+         voice->type = AUDIO_MIXER_TYPE_NONE;
+         return;
+      }
+
+      if (pcm_available > buf_free)
+         pcm_available = buf_free;
+
+      pcm = voice->types.wav.buffer + voice->types.wav.position;
+
+      for (i = pcm_available; i != 0; i--)
+         *buffer++ += *pcm++ * volume;
+
+      buf_free                  -= pcm_available;
+      voice->types.wav.position += pcm_available;
    }
 }
 
@@ -1189,46 +1665,213 @@ again:
 }
 #endif
 
-void audio_mixer_mix(float* buffer, size_t num_frames,
-      float volume_override, bool override)
+static void audio_mixer_mix_voice(float* buffer, size_t num_frames,
+      audio_mixer_voice_t* voice, float volume)
 {
-   unsigned i;
-   size_t j                   = 0;
-   float* sample              = NULL;
-   audio_mixer_voice_t* voice = s_voices;
-
-   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
+   if (voice->type != AUDIO_MIXER_TYPE_NONE && voice->cached)
    {
-      float volume = (override) ? volume_override : voice->volume;
+      audio_mixer_mix_cached(buffer, num_frames, voice, volume);
+      return;
+   }
 
-      switch (voice->type)
-      {
-         case AUDIO_MIXER_TYPE_WAV:
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_WAV:
+         if (voice->sound->path)
+            audio_mixer_mix_wav_stream(buffer, num_frames, voice, volume);
+         else
             audio_mixer_mix_wav(buffer, num_frames, voice, volume);
-            break;
-         case AUDIO_MIXER_TYPE_OGG:
+         break;
+      case AUDIO_MIXER_TYPE_OGG:
 #ifdef HAVE_STB_VORBIS
-            audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
+         audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
 #endif
-            break;
-         case AUDIO_MIXER_TYPE_MOD:
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
 #ifdef HAVE_IBXM
-            audio_mixer_mix_mod(buffer, num_frames, voice, volume);
+         audio_mixer_mix_mod(buffer, num_frames, voice, volume);
 #endif
-            break;
-         case AUDIO_MIXER_TYPE_FLAC:
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
 #ifdef HAVE_DR_FLAC
-            audio_mixer_mix_flac(buffer, num_frames, voice, volume);
+         audio_mixer_mix_flac(buffer, num_frames, voice, volume);
 #endif
-            break;
-            case AUDIO_MIXER_TYPE_MP3:
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
 #ifdef HAVE_DR_MP3
-            audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
+         audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
 #endif
-            break;
-         case AUDIO_MIXER_TYPE_NONE:
-            break;
+         break;
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
+   }
+}
+
+/* Frees the decoder state audio_mixer_play_*() set up on @voice */
+static void audio_mixer_release_decoder(audio_mixer_voice_t* voice,
+      enum audio_mixer_type type)
+{
+   switch (type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         if (voice->types.ogg.stream)
+            stb_vorbis_close(voice->types.ogg.stream);
+         if (voice->types.ogg.resampler && voice->types.ogg.resampler_data)
+            voice->types.ogg.resampler->free(voice->types.ogg.resampler_data);
+         if (voice->types.ogg.buffer)
+            memalign_free(voice->types.ogg.buffer);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         if (voice->types.flac.stream)
+            drflac_close(voice->types.flac.stream);
+         if (voice->types.flac.file)
+            filestream_close(voice->types.flac.file);
+         if (voice->types.flac.resampler && voice->types.flac.resampler_data)
+            voice->types.flac.resampler->free(voice->types.flac.resampler_data);
+         if (voice->types.flac.buffer)
+            memalign_free(voice->types.flac.buffer);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         drmp3_uninit(&voice->types.mp3.stream);
+         if (voice->types.mp3.file)
+            filestream_close(voice->types.mp3.file);
+         if (voice->types.mp3.resampler && voice->types.mp3.resampler_data)
+            voice->types.mp3.resampler->free(voice->types.mp3.resampler_data);
+         if (voice->types.mp3.buffer)
+            memalign_free(voice->types.mp3.buffer);
+#endif
+         break;
+      default:
+         break;
+   }
+}
+
+/* Makes sure sound->cache holds the sound at the current output
+ * rate, decoding it through a scratch voice the first time it is
+ * played. Returns false for sounds that aren't cached. */
+static bool audio_mixer_cache_sound(audio_mixer_sound_t* sound)
+{
+   audio_mixer_voice_t voice;
+   bool res                = false;
+   float *pcm              = NULL;
+   unsigned frames         = 0;
+   unsigned capacity       = 0;
+   unsigned padded         = 0;
+   unsigned max_frames     = s_rate * AUDIO_MIXER_CACHE_MAX_SECONDS;
+
+   /* Streamed sounds are long by definition */
+   if (sound->path)
+      return false;
+
+   if (sound->cache.rate == s_rate)
+      return sound->cache.pcm != NULL;
+
+   if (sound->cache.pcm)
+      free(sound->cache.pcm);
+
+   sound->cache.pcm    = NULL;
+   sound->cache.frames = 0;
+   sound->cache.rate   = s_rate;
+
+   memset(&voice, 0, sizeof(voice));
+
+   switch (sound->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         res = audio_mixer_play_ogg(sound, &voice, false, 1.0f, NULL);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         res = audio_mixer_play_flac(sound, &voice, false, 1.0f, NULL);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         res = audio_mixer_play_mp3(sound, &voice, false, 1.0f, NULL);
+#endif
+         break;
+      default:
+         /* WAV is resampled at load, MOD renders at the output rate */
+         break;
+   }
+
+   if (!res)
+      return false;
+
+   voice.type   = sound->type;
+   voice.sound  = sound;
+   voice.volume = 1.0f;
+
+   while (voice.type != AUDIO_MIXER_TYPE_NONE)
+   {
+      if (frames + AUDIO_MIXER_CACHE_CHUNK_FRAMES > max_frames)
+         goto error;
+
+      if (frames + AUDIO_MIXER_CACHE_CHUNK_FRAMES > capacity)
+      {
+         float *tmp   = NULL;
+         capacity     = capacity ? capacity * 2 : s_rate;
+         if (capacity > max_frames)
+            capacity  = max_frames;
+         tmp          = (float*)realloc(pcm,
+               capacity * 2 * sizeof(float));
+         if (!tmp)
+            goto error;
+         pcm          = tmp;
       }
+
+      memset(pcm + frames * 2, 0,
+            AUDIO_MIXER_CACHE_CHUNK_FRAMES * 2 * sizeof(float));
+      audio_mixer_mix_voice(pcm + frames * 2,
+            AUDIO_MIXER_CACHE_CHUNK_FRAMES, &voice, 1.0f);
+      frames += AUDIO_MIXER_CACHE_CHUNK_FRAMES;
+   }
+
+   audio_mixer_release_decoder(&voice, sound->type);
+
+   /* The last chunk is padded with silence */
+   for (padded = AUDIO_MIXER_CACHE_CHUNK_FRAMES; padded && frames
+         && pcm[frames * 2 - 1] == 0.0f
+         && pcm[frames * 2 - 2] == 0.0f; padded--)
+      frames--;
+
+   if (!frames)
+   {
+      free(pcm);
+      return false;
+   }
+
+   sound->cache.pcm    = pcm;
+   sound->cache.frames = frames;
+   return true;
+
+error:
+   audio_mixer_release_decoder(&voice, sound->type);
+   if (pcm)
+      free(pcm);
+   return false;
+}
+
+void audio_mixer_mix(float* buffer, size_t num_frames,
+      float volume_override, bool override)
+{
+   unsigned i;
+   size_t j                   = 0;
+   float* sample              = NULL;
+   audio_mixer_voice_t* voice = s_voices;
+
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
+   {
+      float volume = (override) ? volume_override : voice->volume;
+
+      audio_mixer_mix_voice(buffer, num_frames, voice, volume);
    }
 
    for (j = 0, sample = buffer; j < num_frames * 2; j++, sample++)
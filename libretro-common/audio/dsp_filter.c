@@ -21,6 +21,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <retro_miscellaneous.h>
 
@@ -50,6 +51,11 @@ struct retro_dsp_instance
    void *impl_data;
 };
 
+/* Frames pushed through the whole chain at a time, so the
+ * block stays in L1 while each filter in turn works on it,
+ * instead of every filter streaming over the full buffer. */
+#define DSP_FILTER_BLOCK_FRAMES 256
+
 struct retro_dsp_filter
 {
    config_file_t *conf;
@@ -59,6 +65,11 @@ struct retro_dsp_filter
 
    struct retro_dsp_instance *instances;
    unsigned num_instances;
+
+   /* Collects the chain output when it isn't simply the
+    * input processed in place. */
+   float *out;
+   size_t out_frames;
 };
 
 static const struct dspfilter_implementation *find_implementation(
@@ -298,27 +309,80 @@ void retro_dsp_filter_free(retro_dsp_filter_t *dsp)
    if (dsp->conf)
       config_file_free(dsp->conf);
 
+   free(dsp->out);
    free(dsp);
 }
 
+static bool retro_dsp_filter_reserve(retro_dsp_filter_t *dsp,
+      size_t frames)
+{
+   float *out;
+
+   if (frames <= dsp->out_frames)
+      return true;
+
+   frames          = MAX(frames, dsp->out_frames * 2);
+   if (!(out       = (float*)realloc(dsp->out,
+               frames * 2 * sizeof(float))))
+      return false;
+
+   dsp->out        = out;
+   dsp->out_frames = frames;
+   return true;
+}
+
 void retro_dsp_filter_process(retro_dsp_filter_t *dsp,
       struct retro_dsp_data *data)
 {
-   unsigned i;
-   struct dspfilter_output output = {0};
-   struct dspfilter_input input   = {0};
-
-   output.samples = data->input;
-   output.frames  = data->input_frames;
+   unsigned offset;
+   unsigned out_frames = 0;
+   bool in_place       = true;
 
-   for (i = 0; i < dsp->num_instances; i++)
+   for (offset = 0; offset < data->input_frames;
+         offset += DSP_FILTER_BLOCK_FRAMES)
    {
-      input.samples = output.samples;
-      input.frames  = output.frames;
-      dsp->instances[i].impl->process(
-            dsp->instances[i].impl_data, &output, &input);
+      unsigned i;
+      struct dspfilter_output output = {0};
+      struct dspfilter_input input   = {0};
+      float *block                   = data->input + offset * 2;
+      unsigned frames                = MIN(DSP_FILTER_BLOCK_FRAMES,
+            data->input_frames - offset);
+
+      output.samples = block;
+      output.frames  = frames;
+
+      for (i = 0; i < dsp->num_instances; i++)
+      {
+         input.samples = output.samples;
+         input.frames  = output.frames;
+         dsp->instances[i].impl->process(
+               dsp->instances[i].impl_data, &output, &input);
+      }
+
+      /* Common case, every filter worked in place. */
+      if (in_place && output.samples == block && output.frames == frames)
+      {
+         out_frames += frames;
+         continue;
+      }
+
+      /* A filter returned its own buffer or changed the frame
+       * count. It may reuse that buffer on the next call, so
+       * collect everything from here on. */
+      if (!retro_dsp_filter_reserve(dsp, out_frames + output.frames))
+         break;
+
+      if (in_place)
+      {
+         memcpy(dsp->out, data->input, out_frames * 2 * sizeof(float));
+         in_place = false;
+      }
+
+      memcpy(dsp->out + out_frames * 2, output.samples,
+            output.frames * 2 * sizeof(float));
+      out_frames += output.frames;
    }
 
-   data->output        = output.samples;
-   data->output_frames = output.frames;
+   data->output        = in_place ? data->input : dsp->out;
+   data->output_frames = out_frames;
 }
@@ -26,6 +26,15 @@
 
 #include <libretro_dspfilter.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define PANNING_NEON
+#include <arm_neon.h>
+#endif
+
 struct panning_data
 {
    float left[2];
@@ -56,6 +65,77 @@ static void panning_process(void *data, struct dspfilter_output *output,
    }
 }
 
+#if defined(__SSE__)
+static void panning_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   struct panning_data *pan = (struct panning_data*)data;
+   float *out               = output->samples;
+   /* { Ll, Rl, Ll, Rl } and { Lr, Rr, Lr, Rr } for two frames. */
+   __m128 mix_l             = _mm_setr_ps(pan->left[0], pan->right[0],
+         pan->left[0], pan->right[0]);
+   __m128 mix_r             = _mm_setr_ps(pan->left[1], pan->right[1],
+         pan->left[1], pan->right[1]);
+
+   output->samples          = input->samples;
+   output->frames           = input->frames;
+
+   for (i = 0; i + 2 <= input->frames; i += 2, out += 4)
+   {
+      __m128 frames = _mm_loadu_ps(out);
+      __m128 left   = _mm_shuffle_ps(frames, frames, _MM_SHUFFLE(2, 2, 0, 0));
+      __m128 right  = _mm_shuffle_ps(frames, frames, _MM_SHUFFLE(3, 3, 1, 1));
+
+      _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(left, mix_l),
+               _mm_mul_ps(right, mix_r)));
+   }
+
+   for (; i < input->frames; i++, out += 2)
+   {
+      float left  = out[0];
+      float right = out[1];
+      out[0]      = left * pan->left[0]  + right * pan->left[1];
+      out[1]      = left * pan->right[0] + right * pan->right[1];
+   }
+}
+#endif
+
+#if defined(PANNING_NEON)
+static void panning_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   struct panning_data *pan = (struct panning_data*)data;
+   float *out               = output->samples;
+
+   output->samples          = input->samples;
+   output->frames           = input->frames;
+
+   for (i = 0; i + 4 <= input->frames; i += 4, out += 8)
+   {
+      /* Deinterleaves four frames into val[0] = left, val[1] = right. */
+      float32x4x2_t frames = vld2q_f32(out);
+      float32x4x2_t res;
+
+      res.val[0] = vmlaq_n_f32(vmulq_n_f32(frames.val[0], pan->left[0]),
+            frames.val[1], pan->left[1]);
+      res.val[1] = vmlaq_n_f32(vmulq_n_f32(frames.val[0], pan->right[0]),
+            frames.val[1], pan->right[1]);
+
+      vst2q_f32(out, res);
+   }
+
+   for (; i < input->frames; i++, out += 2)
+   {
+      float left  = out[0];
+      float right = out[1];
+      out[0]      = left * pan->left[0]  + right * pan->left[1];
+      out[1]      = left * pan->right[0] + right * pan->right[1];
+   }
+}
+#endif
+
 static void *panning_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
 {
@@ -97,6 +177,30 @@ static const struct dspfilter_implementation panning = {
    "panning",
 };
 
+#if defined(__SSE__)
+static const struct dspfilter_implementation panning_sse = {
+   panning_init,
+   panning_process_sse,
+   panning_free,
+
+   DSPFILTER_API_VERSION,
+   "Panning",
+   "panning",
+};
+#endif
+
+#if defined(PANNING_NEON)
+static const struct dspfilter_implementation panning_neon = {
+   panning_init,
+   panning_process_neon,
+   panning_free,
+
+   DSPFILTER_API_VERSION,
+   "Panning",
+   "panning",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation panning_dspfilter_get_implementation
 #endif
@@ -104,8 +208,16 @@ static const struct dspfilter_implementation panning = {
 const struct dspfilter_implementation *
 dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
-   (void)mask;
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &panning_sse;
+#endif
+#if defined(PANNING_NEON)
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &panning_neon;
+#endif
    return &panning;
 }
 
 #undef dspfilter_get_implementation
+#undef PANNING_NEON
@@ -39,10 +39,41 @@
 #include <xmmintrin.h>
 #endif
 
+#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
+#define SINC_CPU_X86
+#endif
+
+/* The AVX and AVX2/FMA kernels are built with target attributes
+ * where the compiler supports it, so they can be picked at runtime
+ * from the SIMD mask even when the rest of RetroArch is built for
+ * plain SSE. */
 #if defined(__AVX__)
+#define SINC_AVX
+#define SINC_AVX_TARGET
+#elif defined(SINC_CPU_X86) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SINC_AVX
+#define SINC_AVX_TARGET __attribute__((target("avx")))
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+#define SINC_AVX2
+#define SINC_AVX2_TARGET
+#elif defined(SINC_CPU_X86) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SINC_AVX2
+#define SINC_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+#if defined(SINC_AVX) || defined(SINC_AVX2)
 #include <immintrin.h>
 #endif
 
+/* NEON intrinsics cover the Kaiser-windowed qualities, which the
+ * ARMv7 assembly kernel below does not handle. */
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define SINC_NEON_INTRINSICS
+#include <arm_neon.h>
+#endif
+
 /* Rough SNR values for upsampling:
  * LOWEST: 40 dB
  * LOWER: 55 dB
@@ -75,6 +106,8 @@ typedef struct rarch_sinc_resampler
    float *phase_table;
    float *buffer_l;
    float *buffer_r;
+   /* Kernel picked for this instance's taps and CPU */
+   resampler_process_t process;
    unsigned enable_avx;
    unsigned phase_bits;
    unsigned subphase_bits;
@@ -153,7 +186,85 @@ static void resampler_sinc_process_neon(void *re_, struct resampler_data *data)
 }
 #endif
 
-#if defined(__AVX__)
+#if defined(SINC_NEON_INTRINSICS)
+static void resampler_sinc_process_neon_kaiser(void *re_,
+      struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+            resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+            resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         while (resamp->time < phases)
+         {
+            unsigned i;
+            float32x2_t sum_lo_l, sum_lo_r;
+            unsigned phase           = resamp->time >> resamp->subphase_bits;
+            const float *phase_table = resamp->phase_table + phase * taps * 2;
+            const float *delta_table = phase_table + taps;
+            float delta              = (float)
+               (resamp->time & resamp->subphase_mask) * resamp->subphase_mod;
+
+            float32x4_t sum_l        = vdupq_n_f32(0.0f);
+            float32x4_t sum_r        = vdupq_n_f32(0.0f);
+
+            for (i = 0; i < taps; i += 4)
+            {
+               float32x4_t buf_l  = vld1q_f32(buffer_l + i);
+               float32x4_t buf_r  = vld1q_f32(buffer_r + i);
+               float32x4_t sinc   = vmlaq_n_f32(vld1q_f32(phase_table + i),
+                     vld1q_f32(delta_table + i), delta);
+
+               sum_l              = vmlaq_f32(sum_l, buf_l, sinc);
+               sum_r              = vmlaq_f32(sum_r, buf_r, sinc);
+            }
+
+            /* { l0 + l2, l1 + l3 } and { r0 + r2, r1 + r3 },
+             * then a pairwise add leaves { L, R } for the store. */
+            sum_lo_l = vadd_f32(vget_low_f32(sum_l), vget_high_f32(sum_l));
+            sum_lo_r = vadd_f32(vget_low_f32(sum_r), vget_high_f32(sum_r));
+            vst1_f32(output, vpadd_f32(sum_lo_l, sum_lo_r));
+
+            output += 2;
+            out_frames++;
+            resamp->time += ratio;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
+#if defined(SINC_AVX)
+SINC_AVX_TARGET
 static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
@@ -307,6 +418,160 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 }
 #endif
 
+#if defined(SINC_AVX2)
+SINC_AVX2_TARGET
+static void resampler_sinc_process_avx2(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   if (resamp->window_type == SINC_WINDOW_KAISER)
+   {
+      while (frames)
+      {
+         while (frames && resamp->time >= phases)
+         {
+            /* Push in reverse to make filter more obvious. */
+            if (!resamp->ptr)
+               resamp->ptr = resamp->taps;
+            resamp->ptr--;
+
+            resamp->buffer_l[resamp->ptr + resamp->taps] =
+               resamp->buffer_l[resamp->ptr]                = *input++;
+
+            resamp->buffer_r[resamp->ptr + resamp->taps] =
+               resamp->buffer_r[resamp->ptr]                = *input++;
+
+            resamp->time                                -= phases;
+            frames--;
+         }
+
+         {
+            const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+            const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+            unsigned taps            = resamp->taps;
+            while (resamp->time < phases)
+            {
+               unsigned i;
+               unsigned phase           = resamp->time >> resamp->subphase_bits;
+
+               float *phase_table       = resamp->phase_table + phase * taps * 2;
+               float *delta_table       = phase_table + taps;
+               __m256 delta             = _mm256_set1_ps((float)
+                     (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+
+               __m256 sum_l             = _mm256_setzero_ps();
+               __m256 sum_r             = _mm256_setzero_ps();
+
+               for (i = 0; i < taps; i += 8)
+               {
+                  __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+                  __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+                  __m256 deltas = _mm256_load_ps(delta_table + i);
+                  __m256 sinc   = _mm256_fmadd_ps(deltas, delta,
+                        _mm256_load_ps((const float*)phase_table + i));
+
+                  sum_l         = _mm256_fmadd_ps(buf_l, sinc, sum_l);
+                  sum_r         = _mm256_fmadd_ps(buf_r, sinc, sum_r);
+               }
+
+               /* hadd on AVX is weird, and acts on low-lanes
+                * and high-lanes separately. */
+               __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
+               __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
+               res_l        = _mm256_hadd_ps(res_l, res_l);
+               res_r        = _mm256_hadd_ps(res_r, res_r);
+               res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
+               res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
+
+               /* This is optimized to mov %xmmN, [mem].
+                * There doesn't seem to be any _mm256_store_ss intrinsic. */
+               _mm_store_ss(output + 0, _mm256_extractf128_ps(res_l, 0));
+               _mm_store_ss(output + 1, _mm256_extractf128_ps(res_r, 0));
+
+               output += 2;
+               out_frames++;
+               resamp->time += ratio;
+            }
+         }
+      }
+   }
+   else
+   {
+      while (frames)
+      {
+         while (frames && resamp->time >= phases)
+         {
+            /* Push in reverse to make filter more obvious. */
+            if (!resamp->ptr)
+               resamp->ptr = resamp->taps;
+            resamp->ptr--;
+
+            resamp->buffer_l[resamp->ptr + resamp->taps] =
+               resamp->buffer_l[resamp->ptr]                = *input++;
+
+            resamp->buffer_r[resamp->ptr + resamp->taps] =
+               resamp->buffer_r[resamp->ptr]                = *input++;
+
+            resamp->time                                -= phases;
+            frames--;
+         }
+
+         {
+            const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+            const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+            unsigned taps            = resamp->taps;
+            while (resamp->time < phases)
+            {
+               unsigned i;
+               unsigned phase           = resamp->time >> resamp->subphase_bits;
+               float *phase_table       = resamp->phase_table + phase * taps;
+
+               __m256 sum_l             = _mm256_setzero_ps();
+               __m256 sum_r             = _mm256_setzero_ps();
+
+               for (i = 0; i < taps; i += 8)
+               {
+                  __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+                  __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+                  __m256 sinc   = _mm256_load_ps((const float*)phase_table + i);
+
+                  sum_l         = _mm256_fmadd_ps(buf_l, sinc, sum_l);
+                  sum_r         = _mm256_fmadd_ps(buf_r, sinc, sum_r);
+               }
+
+               /* hadd on AVX is weird, and acts on low-lanes
+                * and high-lanes separately. */
+               __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
+               __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
+               res_l        = _mm256_hadd_ps(res_l, res_l);
+               res_r        = _mm256_hadd_ps(res_r, res_r);
+               res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
+               res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
+
+               /* This is optimized to mov %xmmN, [mem].
+                * There doesn't seem to be any _mm256_store_ss intrinsic. */
+               _mm_store_ss(output + 0, _mm256_extractf128_ps(res_l, 0));
+               _mm_store_ss(output + 1, _mm256_extractf128_ps(res_r, 0));
+
+               output += 2;
+               out_frames++;
+               resamp->time += ratio;
+            }
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
 #if defined(__SSE__)
 static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
 {
@@ -603,6 +868,12 @@ static void resampler_sinc_process_c(void *re_, struct resampler_data *data)
    data->output_frames = out_frames;
 }
 
+static void resampler_sinc_process(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   resamp->process(re_, data);
+}
+
 static void resampler_sinc_free(void *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)data;
@@ -735,6 +1006,7 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    size_t phase_elems             = 0;
    size_t elems                   = 0;
    unsigned sidelobes             = 0;
+   unsigned simd_width            = 0;
    rarch_sinc_resampler_t *re     = (rarch_sinc_resampler_t*)
       calloc(1, sizeof(*re));
 
@@ -803,20 +1075,58 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
    }
 
-   /* Be SIMD-friendly. */
-#if defined(__AVX__)
-   if (re->enable_avx)
-      re->taps  = (re->taps + 7) & ~7;
-   else
+   /* Pick the kernel first, the taps have to be rounded
+    * to its vector width. */
+   re->process = resampler_sinc_process_c;
+   simd_width             = 4;
+
+   if (     re->enable_avx
+         && (mask & RESAMPLER_SIMD_AVX2)
+         && (mask & RESAMPLER_SIMD_FMA))
+   {
+#if defined(SINC_AVX2)
+      re->process = resampler_sinc_process_avx2;
+      simd_width             = 8;
 #endif
+   }
+
+   if (     re->process == resampler_sinc_process_c
+         && re->enable_avx && (mask & RESAMPLER_SIMD_AVX))
    {
+#if defined(SINC_AVX)
+      re->process = resampler_sinc_process_avx;
+      simd_width             = 8;
+#endif
+   }
+
+   if (     re->process == resampler_sinc_process_c
+         && (mask & RESAMPLER_SIMD_SSE))
+   {
+#if defined(__SSE__)
+      re->process = resampler_sinc_process_sse;
+#endif
+   }
+
+   if (     re->process == resampler_sinc_process_c
+         && (mask & RESAMPLER_SIMD_NEON))
+   {
+      if (re->window_type == SINC_WINDOW_KAISER)
+      {
+#if defined(SINC_NEON_INTRINSICS)
+         re->process = resampler_sinc_process_neon_kaiser;
+#endif
+      }
+      else
+      {
 #if defined(WANT_NEON)
-      re->taps     = (re->taps + 7) & ~7;
-#else
-      re->taps     = (re->taps + 3) & ~3;
+         re->process = resampler_sinc_process_neon;
+         simd_width             = 8;
 #endif
+      }
    }
 
+   re->taps        = (re->taps + simd_width - 1) & ~(simd_width - 1);
+
    phase_elems     = ((1 << re->phase_bits) * re->taps);
    if (re->window_type == SINC_WINDOW_KAISER)
       phase_elems  = phase_elems * 2;
@@ -846,27 +1156,6 @@ static void *resampler_sinc_new(const struct resampler_config *config,
          goto error;
    }
 
-   sinc_resampler.process = resampler_sinc_process_c;
-
-   if (mask & RESAMPLER_SIMD_AVX && re->enable_avx)
-   {
-#if defined(__AVX__)
-      sinc_resampler.process = resampler_sinc_process_avx;
-#endif
-   }
-   else if (mask & RESAMPLER_SIMD_SSE)
-   {
-#if defined(__SSE__)
-      sinc_resampler.process = resampler_sinc_process_sse;
-#endif
-   }
-   else if (mask & RESAMPLER_SIMD_NEON && re->window_type != SINC_WINDOW_KAISER)
-   {
-#if defined(WANT_NEON)
-      sinc_resampler.process = resampler_sinc_process_neon;
-#endif
-   }
-
    return re;
 
 error:
@@ -876,7 +1165,7 @@ error:
 
 retro_resampler_t sinc_resampler = {
    resampler_sinc_new,
-   resampler_sinc_process_c,
+   resampler_sinc_process,
    resampler_sinc_free,
    RESAMPLER_API_VERSION,
    "sinc",
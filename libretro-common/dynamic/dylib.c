@@ -20,6 +20,11 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#if defined(__linux__) && !defined(ANDROID) && !defined(_GNU_SOURCE)
+/* For dlmopen() */
+#define _GNU_SOURCE
+#endif
+
 #include <string.h>
 #include <stdio.h>
 #include <dynamic/dylib.h>
@@ -124,6 +129,29 @@ dylib_t dylib_load(const char *path)
    return lib;
 }
 
+/**
+ * dylib_load_isolated:
+ * @path                         : Path to libretro core library.
+ *
+ * Loads the library into a link map of its own, so that
+ * a library which is already loaded (by dylib_load) is
+ * loaded a second time, with its own copy of all global
+ * state, instead of returning the existing handle.
+ * Its dependencies get loaded again too, so callers
+ * should only use it for libraries known to cope.
+ *
+ * Returns: library handle on success, otherwise NULL
+ * (including on platforms without namespace support).
+ **/
+dylib_t dylib_load_isolated(const char *path)
+{
+#if !defined(_WIN32) && defined(LM_ID_NEWLM)
+   return dlmopen(LM_ID_NEWLM, path, RTLD_LAZY | RTLD_LOCAL);
+#else
+   return NULL;
+#endif
+}
+
 char *dylib_error(void)
 {
 #ifdef _WIN32
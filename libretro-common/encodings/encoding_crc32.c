@@ -26,6 +26,29 @@
 #include <streams/file_stream.h>
 #include <stdlib.h>
 
+/* Buffers of at least CRC32_SIMD_MIN bytes are folded with
+ * carry-less multiplies on x86 CPUs that have PCLMULQDQ
+ * (picked at runtime), or use the CRC32 instructions on
+ * ARMv8 targets that have them. The table below handles
+ * everything else. */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define CRC32_PCLMUL
+#define CRC32_PCLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && _MSC_VER >= 1600 && (defined(_M_X64) || defined(_M_IX86))
+#define CRC32_PCLMUL
+#define CRC32_PCLMUL_TARGET
+#include <intrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#define CRC32_ARM
+#include <arm_acle.h>
+#endif
+
+#define CRC32_SIMD_MIN 64
+
 static const uint32_t crc32_table[256] = {
   0x00000000L, 0x77073096L, 0xee0e612cL, 0x990951baL, 0x076dc419L,
   0x706af48fL, 0xe963a535L, 0x9e6495a3L, 0x0edb8832L, 0x79dcb8a4L,
@@ -81,10 +104,163 @@ static const uint32_t crc32_table[256] = {
   0x2d02ef8dL
 };
 
+#if defined(CRC32_PCLMUL)
+/* -1 until the CPU was checked */
+static int crc32_pclmul_supported = -1;
+
+static int crc32_pclmul_detect(void)
+{
+#if defined(_MSC_VER)
+   int flags[4];
+   __cpuid(flags, 1);
+   return (flags[2] & (1 << 1)) && (flags[2] & (1 << 19));
+#else
+   unsigned eax, ebx, ecx, edx;
+   if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return 0;
+   /* PCLMULQDQ and SSE4.1 */
+   return (ecx & (1 << 1)) && (ecx & (1 << 19));
+#endif
+}
+
+/* Folds four 16 byte lanes at a time with carry-less
+ * multiplies, then reduces them to the 32 bit remainder,
+ * see "Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ Instruction" (Intel, 2009). @crc is the inverted
+ * running value, @len a multiple of 16 and at least
+ * CRC32_SIMD_MIN. */
+static CRC32_PCLMUL_TARGET uint32_t crc32_pclmul(uint32_t crc,
+      const uint8_t *buf, size_t len)
+{
+   const __m128i k1k2 = _mm_set_epi32(0x00000001, 0xc6e41596,
+         0x00000001, 0x54442bd4);
+   const __m128i k3k4 = _mm_set_epi32(0x00000000, 0xccaa009e,
+         0x00000001, 0x751997d0);
+   const __m128i k5   = _mm_set_epi32(0x00000000, 0x00000000,
+         0x00000001, 0x63cd6124);
+   const __m128i poly = _mm_set_epi32(0x00000001, 0xf7011641,
+         0x00000001, 0xdb710641);
+   const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+   __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+   x1   = _mm_loadu_si128((const __m128i*)(buf + 0x00));
+   x2   = _mm_loadu_si128((const __m128i*)(buf + 0x10));
+   x3   = _mm_loadu_si128((const __m128i*)(buf + 0x20));
+   x4   = _mm_loadu_si128((const __m128i*)(buf + 0x30));
+   x1   = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+   x0   = k1k2;
+   buf += 64;
+   len -= 64;
+
+   while (len >= 64)
+   {
+      x5   = _mm_clmulepi64_si128(x1, x0, 0x00);
+      x6   = _mm_clmulepi64_si128(x2, x0, 0x00);
+      x7   = _mm_clmulepi64_si128(x3, x0, 0x00);
+      x8   = _mm_clmulepi64_si128(x4, x0, 0x00);
+      x1   = _mm_clmulepi64_si128(x1, x0, 0x11);
+      x2   = _mm_clmulepi64_si128(x2, x0, 0x11);
+      x3   = _mm_clmulepi64_si128(x3, x0, 0x11);
+      x4   = _mm_clmulepi64_si128(x4, x0, 0x11);
+      x1   = _mm_xor_si128(_mm_xor_si128(x1, x5),
+            _mm_loadu_si128((const __m128i*)(buf + 0x00)));
+      x2   = _mm_xor_si128(_mm_xor_si128(x2, x6),
+            _mm_loadu_si128((const __m128i*)(buf + 0x10)));
+      x3   = _mm_xor_si128(_mm_xor_si128(x3, x7),
+            _mm_loadu_si128((const __m128i*)(buf + 0x20)));
+      x4   = _mm_xor_si128(_mm_xor_si128(x4, x8),
+            _mm_loadu_si128((const __m128i*)(buf + 0x30)));
+      buf += 64;
+      len -= 64;
+   }
+
+   /* Fold the four lanes into one */
+   x0 = k3k4;
+   x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+   x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+   x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+   while (len >= 16)
+   {
+      x5   = _mm_clmulepi64_si128(x1, x0, 0x00);
+      x1   = _mm_clmulepi64_si128(x1, x0, 0x11);
+      x1   = _mm_xor_si128(_mm_xor_si128(x1, x5),
+            _mm_loadu_si128((const __m128i*)buf));
+      buf += 16;
+      len -= 16;
+   }
+
+   /* 128 to 64 bits */
+   x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+   x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+   x2 = _mm_srli_si128(x1, 4);
+   x1 = _mm_and_si128(x1, mask);
+   x1 = _mm_clmulepi64_si128(x1, k5, 0x00);
+   x1 = _mm_xor_si128(x1, x2);
+
+   /* Barrett reduction to 32 bits */
+   x2 = _mm_and_si128(x1, mask);
+   x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+   x2 = _mm_and_si128(x2, mask);
+   x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+   x1 = _mm_xor_si128(x1, x2);
+
+   return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+#elif defined(CRC32_ARM)
+/* @crc is the inverted running value */
+static uint32_t crc32_arm(uint32_t crc, const uint8_t *buf, size_t len)
+{
+   while (len && ((uintptr_t)buf & 7))
+   {
+      crc = __crc32b(crc, *buf++);
+      len--;
+   }
+
+#if defined(__aarch64__)
+   for (; len >= 8; len -= 8, buf += 8)
+      crc = __crc32d(crc, *(const uint64_t*)buf);
+#else
+   for (; len >= 4; len -= 4, buf += 4)
+      crc = __crc32w(crc, *(const uint32_t*)buf);
+#endif
+
+   while (len--)
+      crc = __crc32b(crc, *buf++);
+
+   return crc;
+}
+#endif
+
 uint32_t encoding_crc32(uint32_t crc, const uint8_t *buf, size_t len)
 {
    crc = crc ^ 0xffffffff;
 
+#if defined(CRC32_PCLMUL)
+   if (len >= CRC32_SIMD_MIN)
+   {
+      if (crc32_pclmul_supported < 0)
+         crc32_pclmul_supported = crc32_pclmul_detect();
+
+      if (crc32_pclmul_supported)
+      {
+         size_t chunk = len & ~(size_t)15;
+         crc          = crc32_pclmul(crc, buf, chunk);
+         buf         += chunk;
+         len         -= chunk;
+      }
+   }
+#elif defined(CRC32_ARM)
+   if (len >= CRC32_SIMD_MIN)
+      return crc32_arm(crc, buf, len) ^ 0xffffffff;
+#endif
+
    while (len--)
       crc = crc32_table[(crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
 
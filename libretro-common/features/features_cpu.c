@@ -581,6 +581,92 @@ unsigned cpu_features_get_core_amount(void)
 #endif
 }
 
+#if defined(__linux__)
+/* Reads the relative performance of one core: its
+ * capacity (ARM), or else its maximum clock */
+static uint64_t cpu_features_get_core_performance(unsigned core)
+{
+   int i;
+   static const char *files[] = {
+      "/sys/devices/system/cpu/cpu%u/cpu_capacity",
+      "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq"
+   };
+
+   for (i = 0; i < 2; i++)
+   {
+      char path[64];
+      int64_t length  = 0;
+      char *buf       = NULL;
+      uint64_t perf   = 0;
+
+      snprintf(path, sizeof(path), files[i], core);
+
+      if (filestream_read_file(path, (void**)&buf, &length) != 1)
+         continue;
+
+      if (buf)
+      {
+         perf = strtoull(buf, NULL, 10);
+         free(buf);
+      }
+
+      if (perf)
+         return perf;
+   }
+
+   return 0;
+}
+#endif
+
+/**
+ * cpu_features_get_core_classes:
+ * @big                  : mask of the fastest CPU cores
+ * @little               : mask of all other CPU cores
+ *
+ * Sorts the (first 64) CPU cores of a heterogeneous system,
+ * e.g. ARM big.LITTLE, by their maximum performance. When all
+ * cores are alike, @big holds all of them and @little is 0.
+ *
+ * Returns: false if the performance of the cores is unknown.
+ **/
+bool cpu_features_get_core_classes(uint64_t *big, uint64_t *little)
+{
+#if defined(__linux__)
+   unsigned i;
+   uint64_t perf[64];
+   uint64_t best_perf = 0;
+   unsigned num_cores = cpu_features_get_core_amount();
+
+   if (!num_cores)
+      return false;
+   if (num_cores > 64)
+      num_cores = 64;
+
+   for (i = 0; i < num_cores; i++)
+   {
+      if (!(perf[i] = cpu_features_get_core_performance(i)))
+         return false;
+      if (perf[i] > best_perf)
+         best_perf = perf[i];
+   }
+
+   *big    = 0;
+   *little = 0;
+
+   for (i = 0; i < num_cores; i++)
+   {
+      if (perf[i] == best_perf)
+         *big    |= UINT64_C(1) << i;
+      else
+         *little |= UINT64_C(1) << i;
+   }
+
+   return true;
+#else
+   return false;
+#endif
+}
+
 /* According to http://en.wikipedia.org/wiki/CPUID */
 #define VENDOR_INTEL_b  0x756e6547
 #define VENDOR_INTEL_c  0x6c65746e
@@ -652,6 +738,10 @@ uint64_t cpu_features_get(void)
    if (sysctlbyname("hw.optional.avx2_0", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_AVX2;
 
+   len            = sizeof(size_t);
+   if (sysctlbyname("hw.optional.fma", NULL, &len, NULL, 0) == 0)
+      cpu |= RETRO_SIMD_FMA;
+
    len            = sizeof(size_t);
    if (sysctlbyname("hw.optional.altivec", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_VMX;
@@ -741,8 +831,14 @@ uint64_t cpu_features_get(void)
     * AVX CPU support (guaranteed to have at least i686). */
    if (((flags[2] & avx_flags) == avx_flags)
          && ((xgetbv_x86(0) & 0x6) == 0x6))
+   {
       cpu |= RETRO_SIMD_AVX;
 
+      /* FMA3 works on YMM state, so it needs the same OS support */
+      if (flags[2] & (1 << 12))
+         cpu |= RETRO_SIMD_FMA;
+   }
+
    if (max_flag >= 7)
    {
       x86_cpuid(7, flags);
@@ -31,6 +31,11 @@
 #include <retro_miscellaneous.h>
 #include <lists/string_list.h>
 #include <string/stdstring.h>
+#include <time.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #ifdef HAVE_MMAP
 #include <fcntl.h>
@@ -40,6 +45,390 @@
 #include <sys/stat.h>
 #endif
 
+/* Archive directories kept by
+ * file_archive_directory_cache_init() */
+#define FILE_ARCHIVE_DIRECTORY_CACHE_SIZE     4
+#define FILE_ARCHIVE_DIRECTORY_CACHE_MAX_SIZE (4 * 1024 * 1024)
+
+struct file_archive_directory_cache_entry
+{
+   char *path;
+   uint8_t *data;
+   int64_t archive_size;
+   int64_t archive_mtime;
+   size_t len;
+   unsigned entries;
+   unsigned last_used;
+};
+
+static struct file_archive_directory_cache_entry
+   file_archive_directory_cache[FILE_ARCHIVE_DIRECTORY_CACHE_SIZE];
+static unsigned file_archive_directory_cache_clock = 0;
+static bool file_archive_directory_cache_inited    = false;
+#ifdef HAVE_THREADS
+static slock_t *file_archive_directory_cache_lock  = NULL;
+#endif
+
+static void file_archive_directory_cache_entry_free(
+      struct file_archive_directory_cache_entry *entry)
+{
+   if (entry->path)
+      free(entry->path);
+   if (entry->data)
+      free(entry->data);
+   entry->path = NULL;
+   entry->data = NULL;
+}
+
+void file_archive_directory_cache_init(void)
+{
+   if (file_archive_directory_cache_inited)
+      return;
+
+#ifdef HAVE_THREADS
+   if (!(file_archive_directory_cache_lock = slock_new()))
+      return;
+#endif
+   memset(file_archive_directory_cache, 0,
+         sizeof(file_archive_directory_cache));
+   file_archive_directory_cache_inited = true;
+}
+
+void file_archive_directory_cache_deinit(void)
+{
+   size_t i;
+
+   if (!file_archive_directory_cache_inited)
+      return;
+
+   for (i = 0; i < FILE_ARCHIVE_DIRECTORY_CACHE_SIZE; i++)
+      file_archive_directory_cache_entry_free(
+            &file_archive_directory_cache[i]);
+
+#ifdef HAVE_THREADS
+   slock_free(file_archive_directory_cache_lock);
+   file_archive_directory_cache_lock   = NULL;
+#endif
+   file_archive_directory_cache_inited = false;
+}
+
+uint8_t *file_archive_directory_cache_get(
+      const file_archive_transfer_t *state, const char *path,
+      size_t *len, unsigned *entries)
+{
+   size_t i;
+   int64_t mtime = 0;
+   uint8_t *data = NULL;
+
+   if (!file_archive_directory_cache_inited)
+      return NULL;
+
+   if (!(mtime = path_get_mtime(path)))
+      return NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(file_archive_directory_cache_lock);
+#endif
+   for (i = 0; i < FILE_ARCHIVE_DIRECTORY_CACHE_SIZE; i++)
+   {
+      struct file_archive_directory_cache_entry *entry =
+         &file_archive_directory_cache[i];
+
+      if (     !entry->path
+            || entry->archive_size  != state->archive_size
+            || entry->archive_mtime != mtime
+            || !string_is_equal(entry->path, path))
+         continue;
+
+      if ((data = (uint8_t*)malloc(entry->len ? entry->len : 1)))
+      {
+         memcpy(data, entry->data, entry->len);
+         *len             = entry->len;
+         *entries         = entry->entries;
+         entry->last_used = ++file_archive_directory_cache_clock;
+      }
+      break;
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(file_archive_directory_cache_lock);
+#endif
+
+   return data;
+}
+
+void file_archive_directory_cache_put(
+      const file_archive_transfer_t *state, const char *path,
+      const uint8_t *data, size_t len, unsigned entries)
+{
+   size_t i;
+   struct file_archive_directory_cache_entry *slot = NULL;
+   int64_t mtime                                   = 0;
+   char *path_copy                                 = NULL;
+   uint8_t *data_copy                              = NULL;
+
+   if (     !file_archive_directory_cache_inited
+         || len > FILE_ARCHIVE_DIRECTORY_CACHE_MAX_SIZE)
+      return;
+
+   /* An archive written within the current second could
+    * be rewritten without its modification time changing */
+   if (     !(mtime = path_get_mtime(path))
+         || mtime >= (int64_t)time(NULL))
+      return;
+
+   if (     !(path_copy = strdup(path))
+         || !(data_copy = (uint8_t*)malloc(len ? len : 1)))
+   {
+      if (path_copy)
+         free(path_copy);
+      return;
+   }
+   memcpy(data_copy, data, len);
+
+#ifdef HAVE_THREADS
+   slock_lock(file_archive_directory_cache_lock);
+#endif
+   /* Replace the entry for the same archive if there
+    * is one, otherwise the least recently used one */
+   for (i = 0; i < FILE_ARCHIVE_DIRECTORY_CACHE_SIZE; i++)
+   {
+      struct file_archive_directory_cache_entry *entry =
+         &file_archive_directory_cache[i];
+
+      if (entry->path && string_is_equal(entry->path, path))
+      {
+         slot = entry;
+         break;
+      }
+
+      if (!slot || !entry->path
+            || (slot->path && entry->last_used < slot->last_used))
+         slot = entry;
+   }
+
+   file_archive_directory_cache_entry_free(slot);
+   slot->path          = path_copy;
+   slot->data          = data_copy;
+   slot->archive_size  = state->archive_size;
+   slot->archive_mtime = mtime;
+   slot->len           = len;
+   slot->entries       = entries;
+   slot->last_used     = ++file_archive_directory_cache_clock;
+#ifdef HAVE_THREADS
+   slock_unlock(file_archive_directory_cache_lock);
+#endif
+}
+
+/* Entries extracted by file_archive_extract_cache_init() */
+#define FILE_ARCHIVE_EXTRACT_CACHE_SIZE     8
+#define FILE_ARCHIVE_EXTRACT_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+struct file_archive_extract_cache_entry
+{
+   char *path;
+   char *entry;
+   uint8_t *data;
+   int64_t archive_size;
+   int64_t archive_mtime;
+   size_t len;
+   unsigned last_used;
+};
+
+static struct file_archive_extract_cache_entry
+   file_archive_extract_cache[FILE_ARCHIVE_EXTRACT_CACHE_SIZE];
+static size_t file_archive_extract_cache_total   = 0;
+static unsigned file_archive_extract_cache_clock = 0;
+static bool file_archive_extract_cache_inited    = false;
+#ifdef HAVE_THREADS
+static slock_t *file_archive_extract_cache_lock  = NULL;
+#endif
+
+static void file_archive_extract_cache_entry_free(
+      struct file_archive_extract_cache_entry *entry)
+{
+   if (entry->path)
+      free(entry->path);
+   if (entry->entry)
+      free(entry->entry);
+   if (entry->data)
+      free(entry->data);
+   file_archive_extract_cache_total -= entry->len;
+   entry->path  = NULL;
+   entry->entry = NULL;
+   entry->data  = NULL;
+   entry->len   = 0;
+}
+
+void file_archive_extract_cache_init(void)
+{
+   if (file_archive_extract_cache_inited)
+      return;
+
+#ifdef HAVE_THREADS
+   if (!(file_archive_extract_cache_lock = slock_new()))
+      return;
+#endif
+   memset(file_archive_extract_cache, 0,
+         sizeof(file_archive_extract_cache));
+   file_archive_extract_cache_total  = 0;
+   file_archive_extract_cache_inited = true;
+}
+
+void file_archive_extract_cache_deinit(void)
+{
+   size_t i;
+
+   if (!file_archive_extract_cache_inited)
+      return;
+
+   for (i = 0; i < FILE_ARCHIVE_EXTRACT_CACHE_SIZE; i++)
+      file_archive_extract_cache_entry_free(
+            &file_archive_extract_cache[i]);
+
+#ifdef HAVE_THREADS
+   slock_free(file_archive_extract_cache_lock);
+   file_archive_extract_cache_lock   = NULL;
+#endif
+   file_archive_extract_cache_inited = false;
+}
+
+void *file_archive_extract_cache_get(const char *path,
+      const char *entry_name, int64_t *len)
+{
+   size_t i;
+   int64_t size  = 0;
+   int64_t mtime = 0;
+   uint8_t *data = NULL;
+
+   if (!file_archive_extract_cache_inited)
+      return NULL;
+
+   if (     !(mtime = path_get_mtime(path))
+         || (size = path_get_size(path)) < 0)
+      return NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(file_archive_extract_cache_lock);
+#endif
+   for (i = 0; i < FILE_ARCHIVE_EXTRACT_CACHE_SIZE; i++)
+   {
+      struct file_archive_extract_cache_entry *entry =
+         &file_archive_extract_cache[i];
+
+      if (     !entry->path
+            || entry->archive_size  != size
+            || entry->archive_mtime != mtime
+            || !string_is_equal(entry->entry, entry_name)
+            || !string_is_equal(entry->path, path))
+         continue;
+
+      if ((data = (uint8_t*)malloc(entry->len + 1)))
+      {
+         memcpy(data, entry->data, entry->len);
+         data[entry->len] = '\0';
+         *len             = (int64_t)entry->len;
+         entry->last_used = ++file_archive_extract_cache_clock;
+      }
+      break;
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(file_archive_extract_cache_lock);
+#endif
+
+   return data;
+}
+
+void file_archive_extract_cache_put(const char *path,
+      const char *entry_name, const void *data, int64_t len)
+{
+   size_t i;
+   struct file_archive_extract_cache_entry *slot = NULL;
+   int64_t size                                  = 0;
+   int64_t mtime                                 = 0;
+   char *path_copy                               = NULL;
+   char *entry_copy                              = NULL;
+   uint8_t *data_copy                            = NULL;
+
+   if (     !file_archive_extract_cache_inited
+         || len < 0
+         || len > FILE_ARCHIVE_EXTRACT_CACHE_MAX_SIZE)
+      return;
+
+   /* An archive written within the current second could
+    * be rewritten without its modification time changing */
+   if (     !(mtime = path_get_mtime(path))
+         || mtime >= (int64_t)time(NULL)
+         || (size = path_get_size(path)) < 0)
+      return;
+
+   if (     !(path_copy  = strdup(path))
+         || !(entry_copy = strdup(entry_name))
+         || !(data_copy  = (uint8_t*)malloc(len ? (size_t)len : 1)))
+   {
+      if (path_copy)
+         free(path_copy);
+      if (entry_copy)
+         free(entry_copy);
+      return;
+   }
+   memcpy(data_copy, data, (size_t)len);
+
+#ifdef HAVE_THREADS
+   slock_lock(file_archive_extract_cache_lock);
+#endif
+   /* Drop an older copy of the same entry */
+   for (i = 0; i < FILE_ARCHIVE_EXTRACT_CACHE_SIZE; i++)
+   {
+      struct file_archive_extract_cache_entry *entry =
+         &file_archive_extract_cache[i];
+
+      if (     entry->path
+            && string_is_equal(entry->entry, entry_name)
+            && string_is_equal(entry->path, path))
+         file_archive_extract_cache_entry_free(entry);
+   }
+
+   /* Evict the least recently used entries until there
+    * is a free slot and the new entry fits the size cap */
+   for (;;)
+   {
+      struct file_archive_extract_cache_entry *lru = NULL;
+
+      slot = NULL;
+      for (i = 0; i < FILE_ARCHIVE_EXTRACT_CACHE_SIZE; i++)
+      {
+         struct file_archive_extract_cache_entry *entry =
+            &file_archive_extract_cache[i];
+
+         if (!entry->path)
+         {
+            if (!slot)
+               slot = entry;
+         }
+         else if (!lru || entry->last_used < lru->last_used)
+            lru = entry;
+      }
+
+      if (slot && file_archive_extract_cache_total + (size_t)len
+            <= FILE_ARCHIVE_EXTRACT_CACHE_MAX_SIZE)
+         break;
+
+      file_archive_extract_cache_entry_free(lru);
+   }
+
+   slot->path          = path_copy;
+   slot->entry         = entry_copy;
+   slot->data          = data_copy;
+   slot->archive_size  = size;
+   slot->archive_mtime = mtime;
+   slot->len           = (size_t)len;
+   slot->last_used     = ++file_archive_extract_cache_clock;
+   file_archive_extract_cache_total += slot->len;
+#ifdef HAVE_THREADS
+   slock_unlock(file_archive_extract_cache_lock);
+#endif
+}
+
 static int file_archive_get_file_list_cb(
       const char *path,
       const char *valid_exts,
@@ -155,6 +155,12 @@ static int64_t sevenzip_file_read(
    allocTempImp.Alloc   = sevenzip_stream_alloc_tmp_impl;
    allocTempImp.Free    = sevenzip_stream_free_impl;
 
+   /* Solid archives have to be decompressed from the start
+    * of the block, keep what was extracted for next time */
+   if (!optional_outfile
+         && (*buf = file_archive_extract_cache_get(path, needle, &outsize)))
+      return outsize;
+
    lookStream.bufSize   = SEVENZIP_LOOKTOREAD_BUF_SIZE * sizeof(Byte);
    lookStream.buf       = (Byte*)malloc(lookStream.bufSize);
 
@@ -274,9 +280,14 @@ static int64_t sevenzip_file_read(
                 * We would however need to realloc anyways, because RetroArch
                 * expects a \0 at the end, therefore we allocate new,
                 * copy and free the old one. */
-               *buf = malloc((size_t)(outsize + 1));
+               if (!(*buf = malloc((size_t)(outsize + 1))))
+               {
+                  res = SZ_ERROR_MEM;
+                  break;
+               }
                ((char*)(*buf))[outsize] = '\0';
                memcpy(*buf,output + offset,outsize);
+               file_archive_extract_cache_put(path, needle, *buf, outsize);
             }
             break;
          }
@@ -128,6 +128,12 @@ static bool zlib_stream_decompress_data_to_file_init(
    offsetEL = read_le(local_header + 2, 2); /* extra field length */
    offsetData = (int64_t)(size_t)cdata + 26 + 4 + offsetNL + offsetEL;
 
+   /* A stored entry is handed out as is, see
+    * zip_context_take_data() */
+   if (     offsetData + csize > state->archive_size
+         || (cmode == ZIP_MODE_STORED && csize != size))
+      goto error;
+
 #ifdef HAVE_MMAP
    if (state->archive_mmap_data)
    {
@@ -214,6 +220,37 @@ static int zlib_stream_decompress_data_to_file_iterate(
    return 0;
 }
 
+/* Hands the data of 'handle' over to the caller, the
+ * context no longer owns it. Stored entries are not
+ * decompressed, without a mapping of the archive their
+ * data is passed on as read from it. */
+static void *zip_context_take_data(zip_context_t *zip_context,
+      file_archive_file_handle_t *handle, uint32_t size)
+{
+   uint8_t *data = handle->data;
+
+   handle->data  = NULL;
+
+   if (data == zip_context->decompressed_data)
+      zip_context->decompressed_data = NULL;
+#ifdef HAVE_MMAP
+   else if (zip_context->state->archive_mmap_data)
+   {
+      /* Points into the mapping, which goes away
+       * with the context */
+      uint8_t *copy = (uint8_t*)malloc(size ? size : 1);
+      if (copy)
+         memcpy(copy, data, size);
+      zip_context->compressed_data = NULL;
+      return copy;
+   }
+#endif
+   else if (data == zip_context->compressed_data)
+      zip_context->compressed_data = NULL;
+
+   return data;
+}
+
 static uint32_t zlib_stream_crc32_calculate(uint32_t crc,
       const uint8_t *data, size_t length)
 {
@@ -294,12 +331,10 @@ static int zip_file_decompressed(
       {
          if (decomp_state->opt_file != 0)
          {
-            /* Called in case core has need_fullpath enabled. */
+            /* Called in case core has need_fullpath enabled.
+             * The data stays with the context. */
             bool success = filestream_write_file(decomp_state->opt_file, handle.data, size);
 
-            free(handle.data);
-            handle.data = NULL;
-
             decomp_state->size = 0;
 
             if (!success)
@@ -310,8 +345,10 @@ static int zip_file_decompressed(
             /* Called in case core has need_fullpath disabled.
              * Will move decompressed content directly into
              * RetroArch's ROM buffer. */
-            *decomp_state->buf = handle.data;
-            handle.data = NULL;
+            if (!(*decomp_state->buf = zip_context_take_data(
+                        (zip_context_t*)userdata->transfer->context,
+                        &handle, size)))
+               return -1;
 
             decomp_state->size = size;
          }
@@ -365,19 +402,21 @@ static int64_t zip_file_read(
    return (int64_t)decomp.size;
 }
 
-static int zip_parse_file_init(file_archive_transfer_t *state,
-      const char *file)
+/* Reads the central directory of the archive opened
+ * by 'state', returns it or NULL if this is no ZIP file */
+static uint8_t *zip_read_directory(file_archive_transfer_t *state,
+      size_t *len, unsigned *entries)
 {
    uint8_t footer_buf[1024];
    uint8_t *footer = footer_buf;
    int64_t read_pos = state->archive_size;
    int64_t read_block = MIN(read_pos, sizeof(footer_buf));
    int64_t directory_size, directory_offset;
-   zip_context_t *zip_context = NULL;
+   uint8_t *directory = NULL;
 
    /* Minimal ZIP file size is 22 bytes */
    if (read_block < 22)
-      return -1;
+      return NULL;
 
    /* Find the end of central directory record by scanning
     * the file from the end towards the beginning.
@@ -387,7 +426,7 @@ static int zip_parse_file_init(file_archive_transfer_t *state,
       if (--footer < footer_buf)
       {
          if (read_pos <= 0)
-            return -1; /* reached beginning of file */
+            return NULL; /* reached beginning of file */
 
          /* Read 21 bytes of overlaps except on the first block. */
          if (read_pos == state->archive_size)
@@ -398,7 +437,7 @@ static int zip_parse_file_init(file_archive_transfer_t *state,
          /* Seek to read_pos and read read_block bytes. */
          filestream_seek(state->archive_file, read_pos, RETRO_VFS_SEEK_POSITION_START);
          if (filestream_read(state->archive_file, footer_buf, read_block) != read_block)
-            return -1;
+            return NULL;
 
          footer = footer_buf + read_block - 22;
       }
@@ -415,29 +454,59 @@ static int zip_parse_file_init(file_archive_transfer_t *state,
    directory_offset = read_le(footer + 16, 4);
    if (directory_size > state->archive_size
          || directory_offset > state->archive_size)
+      return NULL;
+
+   if (!(directory = (uint8_t*)malloc(directory_size ? (size_t)directory_size : 1)))
+      return NULL;
+
+   filestream_seek(state->archive_file, directory_offset, RETRO_VFS_SEEK_POSITION_START);
+   if (filestream_read(state->archive_file, directory, directory_size) != directory_size)
+   {
+      free(directory);
+      return NULL;
+   }
+
+   *len     = (size_t)directory_size;
+   *entries = read_le(footer + 10, 2); /* total entries */
+
+   return directory;
+}
+
+static int zip_parse_file_init(file_archive_transfer_t *state,
+      const char *file)
+{
+   size_t directory_size      = 0;
+   unsigned entries           = 0;
+   zip_context_t *zip_context = NULL;
+   uint8_t *directory         = file_archive_directory_cache_get(
+         state, file, &directory_size, &entries);
+
+   if (!directory)
+   {
+      if (!(directory = zip_read_directory(state,
+                  &directory_size, &entries)))
+         return -1;
+
+      file_archive_directory_cache_put(state, file,
+            directory, directory_size, entries);
+   }
+
+   if (!(zip_context = (zip_context_t*)malloc(sizeof(zip_context_t))))
+   {
+      free(directory);
       return -1;
+   }
 
-   /* This is a ZIP file, allocate one block of memory for both the
-    * context and the entire directory, then read the directory.
-    */
-   zip_context = (zip_context_t*)malloc(sizeof(zip_context_t) + (size_t)directory_size);
    zip_context->state             = state;
-   zip_context->directory         = (uint8_t*)(zip_context + 1);
+   zip_context->directory         = directory;
    zip_context->directory_entry   = zip_context->directory;
-   zip_context->directory_end     = zip_context->directory + (size_t)directory_size;
+   zip_context->directory_end     = zip_context->directory + directory_size;
    zip_context->current_stream    = NULL;
    zip_context->compressed_data   = NULL;
    zip_context->decompressed_data = NULL;
 
-   filestream_seek(state->archive_file, directory_offset, RETRO_VFS_SEEK_POSITION_START);
-   if (filestream_read(state->archive_file, zip_context->directory, directory_size) != directory_size)
-   {
-      free(zip_context);
-      return -1;
-   }
-
-   state->context = zip_context;
-   state->step_total = read_le(footer + 10, 2); /* total entries */;
+   state->context    = zip_context;
+   state->step_total = entries;
 
    return 0;
 }
@@ -451,7 +520,7 @@ static int zip_parse_file_iterate_step_internal(
    uint8_t *entry = zip_context->directory_entry;
    uint32_t signature, namelength, extralength, commentlength, offset;
 
-   if (entry < zip_context->directory || entry >= zip_context->directory_end)
+   if (entry < zip_context->directory || entry + 46 > zip_context->directory_end)
       return 0;
 
    signature = read_le(zip_context->directory_entry + 0, 4);
@@ -468,7 +537,8 @@ static int zip_parse_file_iterate_step_internal(
    extralength    = read_le(zip_context->directory_entry + 30, 2); /* extra field length */
    commentlength  = read_le(zip_context->directory_entry + 32, 2); /* file comment length */
 
-   if (namelength >= PATH_MAX_LENGTH)
+   if (     namelength >= PATH_MAX_LENGTH
+         || entry + 46 + namelength > zip_context->directory_end)
       return -1;
 
    memcpy(filename, zip_context->directory_entry + 46, namelength); /* file name */
@@ -515,6 +585,7 @@ static void zip_parse_file_free(void *context)
 {
    zip_context_t *zip_context = (zip_context_t *)context;
    zip_context_free_stream(zip_context, false);
+   free(zip_context->directory);
    free(zip_context);
 }
 
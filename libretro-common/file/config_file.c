@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <errno.h>
+#include <time.h>
 
 #ifdef ORBIS
 #include <sys/fcntl.h>
@@ -49,6 +50,17 @@ struct config_include_list
    struct config_include_list *next;
 };
 
+/* Block holding the text of a parsed file, that keys
+ * and values point into, followed by room for
+ * 'entry_count' entries */
+struct config_file_arena
+{
+   struct config_file_arena *next;
+   char *data;
+   size_t size;
+   size_t entry_count;
+};
+
 /* Forward declaration */
 static bool config_file_parse_line(config_file_t *conf,
       struct config_entry_list *list, char *line, config_file_cb_t *cb);
@@ -205,10 +217,11 @@ static char *config_file_strip_comment(char *str)
    return NULL;
 }
 
-static char *config_file_extract_value(char *line, bool is_value)
+/* Returns the value at 'line', terminated in place,
+ * or NULL if it is not a valid value */
+static char *config_file_extract_value_in_place(char *line, bool is_value)
 {
    size_t idx  = 0;
-   char *value = NULL;
 
    if (is_value)
    {
@@ -227,8 +240,8 @@ static char *config_file_extract_value(char *line, bool is_value)
       line++;
 
    /* Note: From this point on, an empty value
-    * string is valid - and in this case, strdup("")
-    * will be returned
+    * string is valid - and in this case, an empty
+    * string will be returned
     * > If we instead return NULL, the the entry
     *   is ignored completely - which means we cannot
     *   track *changes* in entry value */
@@ -240,34 +253,68 @@ static char *config_file_extract_value(char *line, bool is_value)
       /* Skip to next character */
       line++;
 
-      /* If this a ("), then value string is empty */
-      if (*line == '"')
-         return strdup("");
-
       /* Find the next (") character */
       while (line[idx] && (line[idx] != '\"'))
          idx++;
-
-      line[idx] = '\0';
-      value     = line;
    }
    /* This is not a string literal - just read
-    * until the next space is found
-    * > Note: Skip this if line is empty */
-   else if (*line != '\0')
-   {
-      /* Find next space character */
+    * until the next space is found */
+   else
       while (line[idx] && isgraph((int)line[idx]))
          idx++;
 
-      line[idx] = '\0';
-      value     = line;
+   line[idx] = '\0';
+   return line;
+}
+
+static char *config_file_extract_value(char *line, bool is_value)
+{
+   char *value = config_file_extract_value_in_place(line, is_value);
+   return value ? strdup(value) : NULL;
+}
+
+/* Returns true if 'ptr' is a string or entry
+ * allocated in one of the arenas of 'conf' */
+static bool config_file_arena_owns(const config_file_t *conf,
+      const void *ptr)
+{
+   const struct config_file_arena *arena = conf->arenas;
+   const char *p                         = (const char*)ptr;
+
+   for (; arena; arena = arena->next)
+   {
+      const char *entries = (const char*)(arena + 1);
+
+      if (     (p >= arena->data && p < arena->data + arena->size)
+            || (p >= entries && p < entries
+               + arena->entry_count * sizeof(struct config_entry_list)))
+         return true;
    }
 
-   if (value && *value)
-      return strdup(value);
+   return false;
+}
 
-   return strdup("");
+static void config_file_free_owned(const config_file_t *conf, void *ptr)
+{
+   if (ptr && !config_file_arena_owns(conf, ptr))
+      free(ptr);
+}
+
+/* Hands the arenas of 'src' over to 'dst', along
+ * with its entries */
+static void config_file_move_arenas(config_file_t *dst, config_file_t *src)
+{
+   struct config_file_arena *arena = src->arenas;
+
+   if (!arena)
+      return;
+
+   while (arena->next)
+      arena = arena->next;
+
+   arena->next  = dst->arenas;
+   dst->arenas  = src->arenas;
+   src->arenas  = NULL;
 }
 
 /* Move semantics? */
@@ -355,6 +402,7 @@ static void config_file_add_child_list(config_file_t *parent, config_file_t *chi
    }
 
    child->entries = NULL;
+   config_file_move_arenas(parent, child);
 }
 
 static void config_file_get_realpath(char *s, size_t len,
@@ -412,56 +460,62 @@ static void config_file_add_sub_conf(config_file_t *conf, char *path,
          conf->path);
 }
 
-static int config_file_load_internal(
-      struct config_file *conf,
-      const char *path, unsigned depth, config_file_cb_t *cb)
+/* Parses 'buf', a NUL terminated string of 'len'
+ * bytes that 'conf' takes ownership of. Keys and
+ * values are tokenized in place, and entries are
+ * allocated in a single block along with it. */
+static int config_file_from_buffer(config_file_t *conf,
+      char *buf, size_t len, config_file_cb_t *cb)
 {
-   RFILE         *file = NULL;
-   char      *new_path = strdup(path);
-   if (!new_path)
-      return 1;
-
-   conf->path          = new_path;
-   conf->include_depth = depth;
-   file                = filestream_open(path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   struct config_file_arena *arena  = NULL;
+   struct config_entry_list *entries = NULL;
+   char *end                         = buf + len;
+   char *line                        = buf;
+   const char *nl                    = buf;
+   size_t count                      = 0;
+   size_t lines                      = 1;
+
+   /* Each line holds at most one entry */
+   while ((nl = (const char*)memchr(nl, '\n', end - nl)))
+   {
+      lines++;
+      nl++;
+   }
 
-   if (!file)
+   if (!(arena = (struct config_file_arena*)malloc(
+         sizeof(*arena) + lines * sizeof(*entries))))
    {
-      free(conf->path);
-      return 1;
+      free(buf);
+      return -1;
    }
 
-   while (!filestream_eof(file))
+   arena->data        = buf;
+   arena->size        = len + 1;
+   arena->entry_count = lines;
+   arena->next        = conf->arenas;
+   conf->arenas       = arena;
+   entries            = (struct config_entry_list*)(arena + 1);
+
+   while (line < end)
    {
-      char *line                     = NULL;
-      struct config_entry_list *list = (struct config_entry_list*)
-         malloc(sizeof(*list));
+      struct config_entry_list *list = &entries[count];
+      char *next                     = (char*)memchr(line, '\n', end - line);
 
-      if (!list)
-      {
-         filestream_close(file);
-         return -1;
-      }
+      if (next)
+         *next++ = '\0';
+      else
+         next    = end;
 
       list->readonly  = false;
       list->key       = NULL;
       list->value     = NULL;
       list->next      = NULL;
 
-      line            = filestream_getline(file);
-
-      if (!line)
-      {
-         free(list);
-         continue;
-      }
-
-      if ( 
-              !string_is_empty(line) 
+      if (     !string_is_empty(line)
             && config_file_parse_line(conf, list, line, cb))
       {
+         count++;
+
          if (conf->entries)
             conf->tail->next = list;
          else
@@ -486,24 +540,40 @@ static int config_file_load_internal(
          }
       }
 
-      free(line);
-
-      if (list != conf->tail)
-         free(list);
+      line = next;
    }
 
-   filestream_close(file);
-
    return 0;
 }
 
+static int config_file_load_internal(
+      struct config_file *conf,
+      const char *path, unsigned depth, config_file_cb_t *cb)
+{
+   void *buf           = NULL;
+   int64_t len         = 0;
+   char      *new_path = strdup(path);
+   if (!new_path)
+      return 1;
+
+   conf->path          = new_path;
+   conf->include_depth = depth;
+
+   if (!filestream_read_file(path, &buf, &len))
+   {
+      free(conf->path);
+      conf->path       = NULL;
+      return 1;
+   }
+
+   return config_file_from_buffer(conf, (char*)buf, (size_t)len, cb);
+}
+
 static bool config_file_parse_line(config_file_t *conf,
       struct config_entry_list *list, char *line, config_file_cb_t *cb)
 {
-   size_t cur_size       = 32;
-   size_t idx            = 0;
    char *key             = NULL;
-   char *key_tmp         = NULL;
+   char *key_end         = NULL;
    /* Remove any comment text */
    char *comment         = config_file_strip_comment(line);
 
@@ -599,111 +669,41 @@ static bool config_file_parse_line(config_file_t *conf,
    while (ISSPACE((int)*line))
       line++;
 
-   /* Allocate storage for key */
-   key = (char*)malloc(cur_size + 1);
-   if (!key)
-      return false;
-
-   /* Copy line contents into key until we
-    * reach the next space character */
+   /* The key runs until the next space character */
+   key = line;
    while (isgraph((int)*line))
-   {
-      /* If current key storage is too small,
-       * double its size */
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         key_tmp   = (char*)realloc(key, cur_size + 1);
-
-         if (!key_tmp)
-         {
-            free(key);
-            return false;
-         }
-
-         key = key_tmp;
-      }
-
-      key[idx++] = *line++;
-   }
-   key[idx]      = '\0';
-
-   /* Add key and value entries to list */
-   list->key     = key;
-   list->value   = config_file_extract_value(line, true);
+      line++;
+   key_end       = line;
 
    /* An entry without a value is invalid */
-   if (!list->value)
-   {
-      list->key = NULL;
-      free(key);
+   if (!(list->value = config_file_extract_value_in_place(line, true)))
       return false;
-   }
+
+   *key_end      = '\0';
+   list->key     = key;
 
    return true;
 }
 
 static int config_file_from_string_internal(
       struct config_file *conf,
-      char *from_string,
+      const char *from_string,
       const char *path)
 {
-   char *lines                    = from_string;
-   char *save_ptr                 = NULL;
-   char *line                     = NULL;
+   size_t len = 0;
+   char *buf  = NULL;
 
    if (!string_is_empty(path))
       conf->path                  = strdup(path);
-   if (string_is_empty(lines))
+   if (string_is_empty(from_string))
       return 0;
 
-   /* Get first line of config file */
-   line = strtok_r(lines, "\n", &save_ptr);
-
-   while (line)
-   {
-      struct config_entry_list *list = (struct config_entry_list*)
-            malloc(sizeof(*list));
-
-      if (!list)
-         return -1;
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
+   len = strlen(from_string);
+   if (!(buf = (char*)malloc(len + 1)))
+      return -1;
+   memcpy(buf, from_string, len + 1);
 
-      /* Parse current line */
-      if (
-              !string_is_empty(line)
-            && config_file_parse_line(conf, list, line, NULL))
-      {
-         if (conf->entries)
-            conf->tail->next = list;
-         else
-            conf->entries    = list;
-
-         conf->tail          = list;
-
-         if (list->key)
-         {
-            /* Only add entry to the map if an entry
-             * with the specified value does not
-             * already exist */
-            uint32_t hash = rhmap_hash_string(list->key);
-            if (!RHMAP_HAS_FULL(conf->entries_map, hash, list->key))
-               RHMAP_SET_FULL(conf->entries_map, hash, list->key, list);
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
-
-      /* Get next line of config file */
-      line = strtok_r(NULL, "\n", &save_ptr);
-   }
-   
-   return 0;
+   return config_file_from_buffer(conf, buf, len, NULL);
 }
 
 void config_file_set_reference_path(config_file_t *conf, char *path)
@@ -732,6 +732,7 @@ bool config_file_deinitialize(config_file_t *conf)
 {
    struct config_include_list *inc_tmp = NULL;
    struct config_entry_list *tmp       = NULL;
+   struct config_file_arena *arena     = NULL;
    if (!conf)
       return false;
 
@@ -739,10 +740,8 @@ bool config_file_deinitialize(config_file_t *conf)
    while (tmp)
    {
       struct config_entry_list *hold = NULL;
-      if (tmp->key)
-         free(tmp->key);
-      if (tmp->value)
-         free(tmp->value);
+      config_file_free_owned(conf, tmp->key);
+      config_file_free_owned(conf, tmp->value);
 
       tmp->value = NULL;
       tmp->key   = NULL;
@@ -750,9 +749,18 @@ bool config_file_deinitialize(config_file_t *conf)
       hold       = tmp;
       tmp        = tmp->next;
 
-      if (hold)
-         free(hold);
+      config_file_free_owned(conf, hold);
+   }
+
+   arena = conf->arenas;
+   while (arena)
+   {
+      struct config_file_arena *hold = arena;
+      arena = arena->next;
+      free(hold->data);
+      free(hold);
    }
+   conf->arenas = NULL;
 
    inc_tmp = (struct config_include_list*)conf->includes;
    while (inc_tmp)
@@ -815,6 +823,8 @@ bool config_append_file(config_file_t *conf, const char *path)
       new_conf->entries    = NULL;
    }
 
+   config_file_move_arenas(conf, new_conf);
+
    config_file_free(new_conf);
    return true;
 }
@@ -836,25 +846,257 @@ config_file_t *config_file_new_from_string(char *from_string,
 
 config_file_t *config_file_new_from_path_to_string(const char *path)
 {
-   int64_t length                = 0;
-   uint8_t *ret_buf              = NULL;
-   config_file_t *conf           = NULL;
+   if (!path_is_valid(path))
+      return NULL;
+   return config_file_new(path);
+}
+
+/* Binary snapshot of a parsed config file, see
+ * config_file_new_from_path_cached(). The header is
+ * followed by a (key, value) pair of string table
+ * offsets for each entry, in list order, then the
+ * string table. Offset 0 is NULL. */
+#define CONFIG_FILE_CACHE_MAGIC   0x43434152 /* 'RACC' */
+#define CONFIG_FILE_CACHE_VERSION 1
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   /* Size and modification time of the config file */
+   uint32_t source_size;
+   uint32_t source_mtime_lo;
+   uint32_t source_mtime_hi;
+   uint32_t reference;
+   uint32_t entry_count;
+   uint32_t strings_size;
+} config_file_cache_header_t;
+
+static uint32_t config_file_cache_add_string(char *strings,
+      uint32_t *offset, const char *str)
+{
+   size_t len;
+   uint32_t ret = *offset;
 
-   if (path_is_valid(path))
+   if (!str)
+      return 0;
+
+   len      = strlen(str) + 1;
+   memcpy(strings + ret, str, len);
+   *offset += (uint32_t)len;
+   return ret;
+}
+
+static void config_file_cache_write(const config_file_t *conf,
+      const char *cache_path, int32_t source_size, int64_t source_mtime)
+{
+   size_t i;
+   config_file_cache_header_t header;
+   const struct config_entry_list *list = NULL;
+   uint32_t *records                    = NULL;
+   char *strings                        = NULL;
+   RFILE *file                          = NULL;
+   size_t count                         = 0;
+   /* Offset 0 is reserved for NULL strings */
+   size_t strings_size                  = 1;
+   uint32_t offset                      = 1;
+
+   if (conf->reference)
+      strings_size += strlen(conf->reference) + 1;
+
+   for (list = conf->entries; list; list = list->next)
+   {
+      count++;
+      if (list->key)
+         strings_size += strlen(list->key) + 1;
+      if (list->value)
+         strings_size += strlen(list->value) + 1;
+   }
+
+   if (     (uint64_t)strings_size > UINT32_MAX
+         || !(strings = (char*)malloc(strings_size))
+         || (count && !(records = (uint32_t*)
+               malloc(count * 2 * sizeof(*records)))))
+      goto end;
+
+   strings[0]             = '\0';
+   header.magic           = CONFIG_FILE_CACHE_MAGIC;
+   header.version         = CONFIG_FILE_CACHE_VERSION;
+   header.source_size     = (uint32_t)source_size;
+   header.source_mtime_lo = (uint32_t)source_mtime;
+   header.source_mtime_hi = (uint32_t)((uint64_t)source_mtime >> 32);
+   header.reference       = config_file_cache_add_string(strings,
+         &offset, conf->reference);
+   header.entry_count     = (uint32_t)count;
+   header.strings_size    = (uint32_t)strings_size;
+
+   for (i = 0, list = conf->entries; list; list = list->next, i += 2)
    {
-      if (filestream_read_file(path, (void**)&ret_buf, &length))
+      records[i]     = config_file_cache_add_string(strings,
+            &offset, list->key);
+      records[i + 1] = config_file_cache_add_string(strings,
+            &offset, list->value);
+   }
+
+   if (!(file = filestream_open(cache_path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      goto end;
+
+   /* A partially written file fails the size check,
+    * but don't leave it around */
+   if (     filestream_write(file, &header, sizeof(header)) != sizeof(header)
+         || filestream_write(file, records, count * 2 * sizeof(*records))
+            != (int64_t)(count * 2 * sizeof(*records))
+         || filestream_write(file, strings, strings_size)
+            != (int64_t)strings_size)
+   {
+      filestream_close(file);
+      filestream_delete(cache_path);
+      goto end;
+   }
+
+   filestream_close(file);
+
+end:
+   if (records)
+      free(records);
+   if (strings)
+      free(strings);
+}
+
+static config_file_t *config_file_cache_read(const char *path,
+      const char *cache_path, int32_t source_size, int64_t source_mtime)
+{
+   size_t i;
+   const config_file_cache_header_t *header = NULL;
+   const uint32_t *records                  = NULL;
+   const char *strings                      = NULL;
+   struct config_file_arena *arena          = NULL;
+   struct config_entry_list *entries        = NULL;
+   config_file_t *conf                      = NULL;
+   void *buf                                = NULL;
+   int64_t len                              = 0;
+
+   if (     !path_is_valid(cache_path)
+         || !filestream_read_file(cache_path, &buf, &len))
+      return NULL;
+
+   header = (const config_file_cache_header_t*)buf;
+
+   if (     len < (int64_t)sizeof(*header)
+         || header->magic           != CONFIG_FILE_CACHE_MAGIC
+         || header->version         != CONFIG_FILE_CACHE_VERSION
+         || header->source_size     != (uint32_t)source_size
+         || header->source_mtime_lo != (uint32_t)source_mtime
+         || header->source_mtime_hi != (uint32_t)((uint64_t)source_mtime >> 32)
+         || header->strings_size    == 0
+         || (uint64_t)len != sizeof(*header)
+            + (uint64_t)header->entry_count * 2 * sizeof(*records)
+            + header->strings_size)
+      goto end;
+
+   records = (const uint32_t*)(header + 1);
+   strings = (const char*)(records + (size_t)header->entry_count * 2);
+
+   /* Every string must be terminated within the table */
+   if (     strings[header->strings_size - 1] != '\0'
+         || header->reference >= header->strings_size)
+      goto end;
+
+   for (i = 0; i < (size_t)header->entry_count * 2; i++)
+      if (records[i] >= header->strings_size)
+         goto end;
+
+   if (     !(conf = config_file_new_alloc())
+         || !(conf->path = strdup(path)))
+      goto error;
+
+   if (     header->reference
+         && !(conf->reference = strdup(strings + header->reference)))
+      goto error;
+
+   /* Keys and values point straight into the
+    * string table, the file becomes an arena */
+   if (!(arena = (struct config_file_arena*)malloc(sizeof(*arena)
+         + header->entry_count * sizeof(*entries))))
+      goto error;
+
+   arena->data        = (char*)buf;
+   arena->size        = (size_t)len + 1;
+   arena->entry_count = header->entry_count;
+   arena->next        = NULL;
+   conf->arenas       = arena;
+   entries            = (struct config_entry_list*)(arena + 1);
+   buf                = NULL;
+
+   /* Size the map once rather than growing it */
+   RHMAP_FIT(conf->entries_map, header->entry_count);
+
+   for (i = 0; i < header->entry_count; i++)
+   {
+      uint32_t key                   = records[i * 2];
+      uint32_t value                 = records[i * 2 + 1];
+      struct config_entry_list *list = &entries[i];
+
+      list->readonly = false;
+      list->key      = key   ? (char*)strings + key   : NULL;
+      list->value    = value ? (char*)strings + value : NULL;
+      list->next     = NULL;
+
+      if (conf->entries)
+         conf->tail->next = list;
+      else
+         conf->entries    = list;
+
+      conf->tail          = list;
+
+      /* Same as when parsing, the first entry
+       * with a given key is the one in the map */
+      if (list->key)
       {
-         /* Note: 'ret_buf' is not used outside this
-          * function - we do not care that it will be
-          * modified by config_file_new_from_string() */
-         if (length >= 0)
-            conf = config_file_new_from_string((char*)ret_buf, path);
-
-         if ((void*)ret_buf)
-            free((void*)ret_buf);
+         uint32_t hash = rhmap_hash_string(list->key);
+         if (!RHMAP_HAS_FULL(conf->entries_map, hash, list->key))
+            RHMAP_SET_FULL(conf->entries_map, hash, list->key, list);
       }
    }
 
+   goto end;
+
+error:
+   if (conf)
+      config_file_free(conf);
+   conf = NULL;
+end:
+   free(buf);
+   return conf;
+}
+
+config_file_t *config_file_new_from_path_cached(const char *path,
+      const char *cache_path)
+{
+   config_file_t *conf  = NULL;
+   int32_t source_size  = path_get_size(path);
+   int64_t source_mtime = path_get_mtime(path);
+
+   /* Without a modification time, changes
+    * to the file can't be detected */
+   if (source_size < 0 || !source_mtime || string_is_empty(cache_path))
+      return config_file_new_from_path_to_string(path);
+
+   if ((conf = config_file_cache_read(path, cache_path,
+               source_size, source_mtime)))
+      return conf;
+
+   if (!(conf = config_file_new_from_path_to_string(path)))
+      return NULL;
+
+   /* Included files would need the same checks. A file
+    * written within the current second could change again
+    * without its modification time doing so, cache it once
+    * that second has passed */
+   if (!conf->includes && source_mtime < (int64_t)time(NULL))
+      config_file_cache_write(conf, cache_path, source_size, source_mtime);
+
    return conf;
 }
 
@@ -911,6 +1153,7 @@ void config_file_initialize(struct config_file *conf)
    conf->last                     = NULL;
    conf->reference                = NULL;
    conf->includes                 = NULL;
+   conf->arenas                   = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false;
    conf->modified                 = false;
@@ -1193,7 +1436,7 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
 
             /* Value is to be updated
              * > Free existing */
-            free(entry->value);
+            config_file_free_owned(conf, entry->value);
          }
 
          /* Update value
@@ -1244,11 +1487,8 @@ void config_unset(config_file_t *conf, const char *key)
 
    (void)RHMAP_DEL_STR(conf->entries_map, entry->key);
 
-   if (entry->key)
-      free(entry->key);
-
-   if (entry->value)
-      free(entry->value);
+   config_file_free_owned(conf, entry->key);
+   config_file_free_owned(conf, entry->value);
 
    entry->key     = NULL;
    entry->value   = NULL;
@@ -40,6 +40,7 @@
 
 #ifdef _WIN32
 #include <direct.h>
+#include <encodings/utf.h>
 #else
 #include <unistd.h> /* stat() is defined here */
 #endif
@@ -100,6 +101,57 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Gets the last modification time of a file in seconds,
+ * bypassing any VFS interface set with path_vfs_init(),
+ * since libretro VFS has no notion of file times.
+ *
+ * Returns: modification time, or 0 if it is unknown or
+ * not supported on this platform.
+ */
+int64_t path_get_mtime(const char *path)
+{
+#if defined(_WIN32) && !defined(_XBOX)
+   struct _stat buf;
+   int ret;
+#if defined(LEGACY_WIN32)
+   char *path_local    = NULL;
+#else
+   wchar_t *path_wide  = NULL;
+#endif
+
+   if (!path || !*path)
+      return 0;
+
+#if defined(LEGACY_WIN32)
+   if (!(path_local = utf8_to_local_string_alloc(path)))
+      return 0;
+   ret = _stat(path_local, &buf);
+   free(path_local);
+#else
+   if (!(path_wide = utf8_to_utf16_string_alloc(path)))
+      return 0;
+   ret = _wstat(path_wide, &buf);
+   free(path_wide);
+#endif
+
+   if (ret != 0)
+      return 0;
+   return (int64_t)buf.st_mtime;
+#elif defined(_XBOX) || defined(VITA) || defined(PSP) || defined(ORBIS) || defined(__PSL1GHT__) || defined(__PS3__)
+   return 0;
+#else
+   struct stat buf;
+
+   if (!path || !*path || stat(path, &buf) != 0)
+      return 0;
+   return (int64_t)buf.st_mtime;
+#endif
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
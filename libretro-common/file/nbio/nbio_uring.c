@@ -0,0 +1,541 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (nbio_uring.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <file/nbio.h>
+
+#if defined(__linux__) && defined(HAVE_IO_URING)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+/* Requests in flight per file, and the size of each */
+#define NBIO_URING_DEPTH 16
+#define NBIO_URING_CHUNK (256 * 1024)
+
+/* Like nbio_linux, talks to the kernel directly
+ * instead of depending on liburing. Below kernel 5.1,
+ * or where io_uring is blocked, files are read and
+ * written synchronously instead */
+struct nbio_uring_t
+{
+   struct iovec iov[NBIO_URING_DEPTH];
+   size_t offset[NBIO_URING_DEPTH];
+   void *ptr;
+   void *sq_ring;
+   void *cq_ring;
+   struct io_uring_sqe *sqes;
+   struct io_uring_cqe *cqes;
+   unsigned *sq_head;
+   unsigned *sq_tail;
+   unsigned *sq_mask;
+   unsigned *sq_array;
+   unsigned *cq_head;
+   unsigned *cq_tail;
+   unsigned *cq_mask;
+   size_t sq_ring_size;
+   size_t cq_ring_size;
+   size_t sqes_size;
+   size_t len;
+   /* Bytes handed to the kernel and bytes done */
+   size_t queued;
+   size_t done;
+   int fd;
+   /* -1 when io_uring is not available */
+   int ring_fd;
+   /* Slots with a request in flight */
+   unsigned busy;
+   /*
+    * possible values:
+    * NBIO_READ, NBIO_WRITE - obvious
+    * -1 - currently doing nothing
+    * -2 - opened, nothing has been read yet
+    */
+   signed char op;
+   signed char mode;
+};
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+   return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter(int fd, unsigned to_submit,
+      unsigned min_complete, unsigned flags)
+{
+   return (int)syscall(__NR_io_uring_enter, fd, to_submit,
+         min_complete, flags, NULL, 0);
+}
+
+static void nbio_uring_unmap(struct nbio_uring_t *handle)
+{
+   if (handle->sqes)
+      munmap(handle->sqes, handle->sqes_size);
+   if (handle->cq_ring && handle->cq_ring != handle->sq_ring)
+      munmap(handle->cq_ring, handle->cq_ring_size);
+   if (handle->sq_ring)
+      munmap(handle->sq_ring, handle->sq_ring_size);
+   if (handle->ring_fd >= 0)
+      close(handle->ring_fd);
+
+   handle->sqes    = NULL;
+   handle->cq_ring = NULL;
+   handle->sq_ring = NULL;
+   handle->ring_fd = -1;
+}
+
+static bool nbio_uring_map(struct nbio_uring_t *handle)
+{
+   struct io_uring_params p;
+   char *sq, *cq;
+
+   memset(&p, 0, sizeof(p));
+
+   if ((handle->ring_fd = io_uring_setup(NBIO_URING_DEPTH, &p)) < 0)
+   {
+      handle->ring_fd = -1;
+      return false;
+   }
+
+   handle->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+   handle->cq_ring_size = p.cq_off.cqes
+      + p.cq_entries * sizeof(struct io_uring_cqe);
+   handle->sqes_size    = p.sq_entries * sizeof(struct io_uring_sqe);
+
+   /* Both rings share one mapping since kernel 5.4 */
+   if (p.features & IORING_FEAT_SINGLE_MMAP)
+   {
+      if (handle->cq_ring_size > handle->sq_ring_size)
+         handle->sq_ring_size = handle->cq_ring_size;
+      handle->cq_ring_size    = handle->sq_ring_size;
+   }
+
+   handle->sq_ring = mmap(NULL, handle->sq_ring_size,
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+         handle->ring_fd, IORING_OFF_SQ_RING);
+   if (handle->sq_ring == MAP_FAILED)
+   {
+      handle->sq_ring = NULL;
+      goto error;
+   }
+
+   if (p.features & IORING_FEAT_SINGLE_MMAP)
+      handle->cq_ring = handle->sq_ring;
+   else
+   {
+      handle->cq_ring = mmap(NULL, handle->cq_ring_size,
+            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            handle->ring_fd, IORING_OFF_CQ_RING);
+      if (handle->cq_ring == MAP_FAILED)
+      {
+         handle->cq_ring = NULL;
+         goto error;
+      }
+   }
+
+   handle->sqes = (struct io_uring_sqe*)mmap(NULL, handle->sqes_size,
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+         handle->ring_fd, IORING_OFF_SQES);
+   if (handle->sqes == MAP_FAILED)
+   {
+      handle->sqes = NULL;
+      goto error;
+   }
+
+   sq               = (char*)handle->sq_ring;
+   cq               = (char*)handle->cq_ring;
+   handle->sq_head  = (unsigned*)(sq + p.sq_off.head);
+   handle->sq_tail  = (unsigned*)(sq + p.sq_off.tail);
+   handle->sq_mask  = (unsigned*)(sq + p.sq_off.ring_mask);
+   handle->sq_array = (unsigned*)(sq + p.sq_off.array);
+   handle->cq_head  = (unsigned*)(cq + p.cq_off.head);
+   handle->cq_tail  = (unsigned*)(cq + p.cq_off.tail);
+   handle->cq_mask  = (unsigned*)(cq + p.cq_off.ring_mask);
+   handle->cqes     = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+
+   return true;
+
+error:
+   nbio_uring_unmap(handle);
+   return false;
+}
+
+/* Synchronous path, used without io_uring and to
+ * finish an operation after an I/O error */
+static void nbio_uring_sync(struct nbio_uring_t *handle)
+{
+   while (handle->done < handle->len)
+   {
+      char   *buf = (char*)handle->ptr + handle->done;
+      size_t  len = handle->len - handle->done;
+      ssize_t ret = (handle->op == NBIO_READ)
+         ? pread(handle->fd,  buf, len, (off_t)handle->done)
+         : pwrite(handle->fd, buf, len, (off_t)handle->done);
+
+      if (ret < 0 && errno == EINTR)
+         continue;
+      /* Leaves the rest of a file that shrank untouched */
+      if (ret <= 0)
+         break;
+
+      handle->done += (size_t)ret;
+   }
+
+   handle->queued = handle->len;
+   handle->done   = handle->len;
+}
+
+static void nbio_uring_queue(struct nbio_uring_t *handle, unsigned slot)
+{
+   unsigned tail            = *handle->sq_tail;
+   unsigned idx             = tail & *handle->sq_mask;
+   struct io_uring_sqe *sqe = &handle->sqes[idx];
+
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode    = (handle->op == NBIO_READ)
+      ? IORING_OP_READV : IORING_OP_WRITEV;
+   sqe->fd        = handle->fd;
+   sqe->off       = handle->offset[slot];
+   sqe->addr      = (uint64_t)(uintptr_t)&handle->iov[slot];
+   sqe->len       = 1;
+   sqe->user_data = slot;
+
+   handle->sq_array[idx] = idx;
+   handle->busy         |= 1u << slot;
+
+   /* The kernel must see the entry before the new tail */
+   __atomic_store_n(handle->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/* Fills all free slots with the next chunks */
+static unsigned nbio_uring_fill(struct nbio_uring_t *handle)
+{
+   unsigned slot;
+   unsigned queued = 0;
+
+   for (slot = 0; slot < NBIO_URING_DEPTH
+         && handle->queued < handle->len; slot++)
+   {
+      size_t chunk;
+
+      if (handle->busy & (1u << slot))
+         continue;
+
+      chunk = handle->len - handle->queued;
+      if (chunk > NBIO_URING_CHUNK)
+         chunk = NBIO_URING_CHUNK;
+
+      handle->offset[slot]       = handle->queued;
+      handle->iov[slot].iov_base = (char*)handle->ptr + handle->queued;
+      handle->iov[slot].iov_len  = chunk;
+      handle->queued            += chunk;
+
+      nbio_uring_queue(handle, slot);
+      queued++;
+   }
+
+   return queued;
+}
+
+/* Returns false on an I/O error */
+static bool nbio_uring_reap(struct nbio_uring_t *handle)
+{
+   bool ret      = true;
+   unsigned head = *handle->cq_head;
+   unsigned tail = __atomic_load_n(handle->cq_tail, __ATOMIC_ACQUIRE);
+
+   for (; head != tail; head++)
+   {
+      struct io_uring_cqe *cqe = &handle->cqes[head & *handle->cq_mask];
+      unsigned slot            = (unsigned)cqe->user_data;
+      struct iovec *iov        = &handle->iov[slot];
+      int res                  = cqe->res;
+
+      handle->busy &= ~(1u << slot);
+
+      if (res == -EAGAIN || res == -EINTR)
+         res = 0;
+      else if (res <= 0)
+      {
+         ret = false;
+         continue;
+      }
+
+      handle->done         += (size_t)res;
+      handle->offset[slot] += (size_t)res;
+
+      /* Short read or write, queue the rest of the chunk */
+      if ((size_t)res < iov->iov_len)
+      {
+         iov->iov_base = (char*)iov->iov_base + res;
+         iov->iov_len -= (size_t)res;
+         nbio_uring_queue(handle, slot);
+      }
+   }
+
+   __atomic_store_n(handle->cq_head, head, __ATOMIC_RELEASE);
+
+   return ret;
+}
+
+/* Entries queued since the last submission */
+static unsigned nbio_uring_pending(struct nbio_uring_t *handle)
+{
+   return *handle->sq_tail
+      - __atomic_load_n(handle->sq_head, __ATOMIC_ACQUIRE);
+}
+
+/* Waits for all requests in flight, without queueing new chunks */
+static void nbio_uring_drain(struct nbio_uring_t *handle)
+{
+   while (handle->busy)
+   {
+      if (io_uring_enter(handle->ring_fd, nbio_uring_pending(handle), 1,
+               IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+         break;
+      nbio_uring_reap(handle);
+   }
+}
+
+/* Chunks complete out of order, so after an error
+ * the whole file is transferred again */
+static void nbio_uring_recover(struct nbio_uring_t *handle)
+{
+   nbio_uring_drain(handle);
+   handle->done = 0;
+   nbio_uring_sync(handle);
+}
+
+static void nbio_uring_begin_op(struct nbio_uring_t *handle,
+      signed char op)
+{
+   if (handle->op >= 0)
+      abort();
+
+   handle->op     = op;
+   handle->queued = 0;
+   handle->done   = 0;
+
+   if (handle->ring_fd < 0)
+   {
+      nbio_uring_sync(handle);
+      return;
+   }
+
+   if (io_uring_enter(handle->ring_fd, nbio_uring_fill(handle), 0, 0) < 0)
+      nbio_uring_sync(handle);
+}
+
+static void *nbio_uring_open(const char * filename, unsigned mode)
+{
+   static const int o_flags[]  = { O_RDONLY, O_RDWR|O_CREAT|O_TRUNC,
+      O_RDWR, O_RDONLY, O_RDWR|O_CREAT|O_TRUNC };
+   struct nbio_uring_t *handle = NULL;
+   off_t len                   = 0;
+   int fd                      = open(filename, o_flags[mode]|O_CLOEXEC, 0644);
+
+   if (fd < 0)
+      return NULL;
+
+   if (!(handle = (struct nbio_uring_t*)calloc(1, sizeof(*handle))))
+   {
+      close(fd);
+      return NULL;
+   }
+
+   handle->fd      = fd;
+   handle->mode    = mode;
+   handle->op      = -2;
+   handle->ring_fd = -1;
+
+   if (mode != NBIO_WRITE && mode != BIO_WRITE)
+      len          = lseek(fd, 0, SEEK_END);
+
+   if (len > 0 && !(handle->ptr = malloc((size_t)len)))
+   {
+      close(fd);
+      free(handle);
+      return NULL;
+   }
+
+   handle->len     = (size_t)(len > 0 ? len : 0);
+
+   /* Blocking reads and writes gain nothing from a ring */
+   if (mode != BIO_READ && mode != BIO_WRITE)
+      nbio_uring_map(handle);
+
+   return handle;
+}
+
+static void nbio_uring_begin_read(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (handle)
+      nbio_uring_begin_op(handle, NBIO_READ);
+}
+
+static void nbio_uring_begin_write(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (handle)
+      nbio_uring_begin_op(handle, NBIO_WRITE);
+}
+
+static bool nbio_uring_iterate(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+
+   if (!handle)
+      return false;
+
+   if (handle->op < 0)
+      return true;
+
+   if (handle->ring_fd >= 0 && handle->done < handle->len)
+   {
+      if (nbio_uring_reap(handle))
+      {
+         unsigned pending;
+
+         nbio_uring_fill(handle);
+
+         /* Includes requeued short transfers */
+         if (     (pending = nbio_uring_pending(handle))
+               && io_uring_enter(handle->ring_fd, pending, 0, 0) < 0
+               && errno != EINTR)
+            nbio_uring_recover(handle);
+      }
+      else
+         nbio_uring_recover(handle);
+   }
+
+   if (handle->done >= handle->len && !handle->busy)
+      handle->op = -1;
+
+   return handle->op < 0;
+}
+
+static void nbio_uring_resize(void *data, size_t len)
+{
+   void *ptr                   = NULL;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   if (handle->op >= 0)
+      abort();
+   if (len < handle->len)
+      abort();
+
+   if (ftruncate(handle->fd, (off_t)len) != 0)
+      abort(); /* same as nbio_linux, there is no way to report it */
+
+   if (!(ptr = realloc(handle->ptr, len)))
+      abort();
+
+   handle->ptr = ptr;
+   handle->len = len;
+   handle->op  = -1;
+}
+
+static void *nbio_uring_get_ptr(void *data, size_t* len)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return NULL;
+   if (len)
+      *len = handle->len;
+   if (handle->op == -1)
+      return handle->ptr;
+   return NULL;
+}
+
+static void nbio_uring_cancel(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   /* Requests on regular files can not be interrupted,
+    * the buffer has to stay until they completed */
+   nbio_uring_drain(handle);
+
+   handle->queued = handle->len;
+   handle->done   = handle->len;
+   handle->op     = -1;
+}
+
+static void nbio_uring_free(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+   if (handle->op >= 0)
+      abort();
+
+   nbio_uring_unmap(handle);
+   close(handle->fd);
+   free(handle->ptr);
+   free(handle);
+}
+
+nbio_intf_t nbio_uring = {
+   nbio_uring_open,
+   nbio_uring_begin_read,
+   nbio_uring_begin_write,
+   nbio_uring_iterate,
+   nbio_uring_resize,
+   nbio_uring_get_ptr,
+   nbio_uring_cancel,
+   nbio_uring_free,
+   "nbio_uring",
+};
+#else
+nbio_intf_t nbio_uring = {
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   "nbio_uring",
+};
+
+#endif
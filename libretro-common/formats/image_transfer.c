@@ -207,6 +207,26 @@ void image_transfer_set_buffer_ptr(
    }
 }
 
+/* Only a hint: decoders that can decode straight to a
+ * smaller size (JPEG) will do so as long as the image's
+ * largest side stays at or above max_size */
+void image_transfer_set_max_size(
+      void *data,
+      enum image_type_enum type,
+      unsigned max_size)
+{
+   switch (type)
+   {
+      case IMAGE_TYPE_JPEG:
+#ifdef HAVE_RJPEG
+         rjpeg_set_max_size((rjpeg_t*)data, max_size);
+#endif
+         break;
+      default:
+         break;
+   }
+}
+
 int image_transfer_process(
       void *data,
       enum image_type_enum type,
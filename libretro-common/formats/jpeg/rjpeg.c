@@ -68,6 +68,7 @@ typedef struct
 struct rjpeg
 {
    uint8_t *buff_data;
+   unsigned max_size;
 };
 
 #ifdef _MSC_VER
@@ -187,6 +188,17 @@ typedef struct
          const uint8_t *pcr, int count, int step);
    uint8_t *(*resample_row_hv_2_kernel)(uint8_t *out, uint8_t *in_near,
          uint8_t *in_far, int w, int hs);
+   uint8_t *(*resample_row_h_2_kernel)(uint8_t *out, uint8_t *in_near,
+         uint8_t *in_far, int w, int hs);
+   uint8_t *(*resample_row_v_2_kernel)(uint8_t *out, uint8_t *in_near,
+         uint8_t *in_far, int w, int hs);
+
+   /* Decode straight to 1/2, 1/4 or 1/8 of the size by
+    * only computing the low frequencies of each block,
+    * chosen to stay at or above max_size */
+   unsigned max_size;
+   int scale_shift;
+   int idct_block_size;            /* 8 >> scale_shift */
 
    /* definition of jpeg image component */
    struct
@@ -893,6 +905,76 @@ static void rjpeg_idct_block(uint8_t *out, int out_stride, short data[64])
    }
 }
 
+/* Reduced size IDCTs: an NxN IDCT of the N lowest frequencies
+ * of each dimension, scaled to keep the DC level of the 8x8 one
+ * (C(u) * cos((2x + 1) * u * pi / 2N) / 2, 12 bit fixed point) */
+#define RJPEG_IDCT_R_C0  1448 /* 1 / (2 * sqrt(2)) */
+#define RJPEG_IDCT_R_C1  1892 /* cos(pi / 8) / 2   */
+#define RJPEG_IDCT_R_C3   784 /* cos(3pi / 8) / 2  */
+
+#define RJPEG_IDCT_4(s0, s1, s2, s3, d0, d1, d2, d3) \
+   do { \
+      int e0 = ((d0) + (d2)) * RJPEG_IDCT_R_C0; \
+      int e1 = ((d0) - (d2)) * RJPEG_IDCT_R_C0; \
+      int o0 = (d1) * RJPEG_IDCT_R_C1 + (d3) * RJPEG_IDCT_R_C3; \
+      int o1 = (d1) * RJPEG_IDCT_R_C3 - (d3) * RJPEG_IDCT_R_C1; \
+      s0 = e0 + o0; \
+      s1 = e1 + o1; \
+      s2 = e1 - o1; \
+      s3 = e0 - o0; \
+   } while (0)
+
+static void rjpeg_idct_block_4(uint8_t *out, int out_stride, short data[64])
+{
+   int i;
+   int tmp[4 * 4];
+   int *t = tmp;
+   short *d = data;
+
+   /* rows */
+   for (i = 0; i < 4; ++i, d += 8, t += 4)
+   {
+      int s0, s1, s2, s3;
+      RJPEG_IDCT_4(s0, s1, s2, s3, d[0], d[1], d[2], d[3]);
+      t[0] = (s0 + 2048) >> 12;
+      t[1] = (s1 + 2048) >> 12;
+      t[2] = (s2 + 2048) >> 12;
+      t[3] = (s3 + 2048) >> 12;
+   }
+
+   /* columns, the +128 level shift goes into the rounding */
+   for (i = 0, t = tmp; i < 4; ++i, ++t)
+   {
+      int s0, s1, s2, s3;
+      RJPEG_IDCT_4(s0, s1, s2, s3, t[0], t[4], t[8], t[12]);
+      out[i]                = rjpeg_clamp((s0 + 2048 + (128 << 12)) >> 12);
+      out[i + out_stride]   = rjpeg_clamp((s1 + 2048 + (128 << 12)) >> 12);
+      out[i + out_stride*2] = rjpeg_clamp((s2 + 2048 + (128 << 12)) >> 12);
+      out[i + out_stride*3] = rjpeg_clamp((s3 + 2048 + (128 << 12)) >> 12);
+   }
+}
+
+static void rjpeg_idct_block_2(uint8_t *out, int out_stride, short data[64])
+{
+   int t0 = ((data[0] + data[1]) * RJPEG_IDCT_R_C0 + 2048) >> 12;
+   int t1 = ((data[0] - data[1]) * RJPEG_IDCT_R_C0 + 2048) >> 12;
+   int t2 = ((data[8] + data[9]) * RJPEG_IDCT_R_C0 + 2048) >> 12;
+   int t3 = ((data[8] - data[9]) * RJPEG_IDCT_R_C0 + 2048) >> 12;
+   int bias = 2048 + (128 << 12);
+
+   out[0]              = rjpeg_clamp(((t0 + t2) * RJPEG_IDCT_R_C0 + bias) >> 12);
+   out[1]              = rjpeg_clamp(((t1 + t3) * RJPEG_IDCT_R_C0 + bias) >> 12);
+   out[out_stride]     = rjpeg_clamp(((t0 - t2) * RJPEG_IDCT_R_C0 + bias) >> 12);
+   out[out_stride + 1] = rjpeg_clamp(((t1 - t3) * RJPEG_IDCT_R_C0 + bias) >> 12);
+}
+
+/* 1/8 is just the DC coefficient */
+static void rjpeg_idct_block_1(uint8_t *out, int out_stride, short data[64])
+{
+   (void)out_stride;
+   out[0] = rjpeg_clamp(((data[0] + 4) >> 3) + 128);
+}
+
 #if defined(__SSE2__)
 /* sse2 integer IDCT. not the fastest possible implementation but it
  * produces bit-identical results to the generic C version so it's
@@ -1391,7 +1473,9 @@ static int rjpeg_parse_entropy_coded_data(rjpeg_jpeg *z)
                         z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq]))
                   return 0;
 
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8,
+               z->idct_block_kernel(z->img_comp[n].data
+                     + z->img_comp[n].w2 * j * z->idct_block_size
+                     + i * z->idct_block_size,
                      z->img_comp[n].w2, data);
 
                /* every data block is an MCU, so countdown the restart interval */
@@ -1471,8 +1555,8 @@ static int rjpeg_parse_entropy_coded_data(rjpeg_jpeg *z)
                   {
                      for (x = 0; x < z->img_comp[n].h; ++x)
                      {
-                        int x2 = (i*z->img_comp[n].h + x)*8;
-                        int y2 = (j*z->img_comp[n].v + y)*8;
+                        int x2 = (i*z->img_comp[n].h + x)*z->idct_block_size;
+                        int y2 = (j*z->img_comp[n].v + y)*z->idct_block_size;
                         int ha = z->img_comp[n].ha;
 
                         if (!rjpeg_jpeg_decode_block(z, data,
@@ -1530,7 +1614,9 @@ static void rjpeg_jpeg_finish(rjpeg_jpeg *z)
          {
             short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
             rjpeg_jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-            z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8,
+            z->idct_block_kernel(z->img_comp[n].data
+                  + z->img_comp[n].w2 * j * z->idct_block_size
+                  + i * z->idct_block_size,
                   z->img_comp[n].w2, data);
          }
       }
@@ -1808,6 +1894,32 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
    z->img_mcu_x = (s->img_x + z->img_mcu_w-1) / z->img_mcu_w;
    z->img_mcu_y = (s->img_y + z->img_mcu_h-1) / z->img_mcu_h;
 
+   /* pick the smallest DCT scaling that still covers max_size */
+   if (z->max_size)
+   {
+      unsigned largest = (s->img_x > s->img_y) ? s->img_x : s->img_y;
+
+      while (z->scale_shift < 3 &&
+            ((largest + (2u << z->scale_shift) - 1) >> (z->scale_shift + 1))
+            >= z->max_size)
+         z->scale_shift++;
+
+      z->idct_block_size = 8 >> z->scale_shift;
+
+      switch (z->scale_shift)
+      {
+         case 1:
+            z->idct_block_kernel = rjpeg_idct_block_4;
+            break;
+         case 2:
+            z->idct_block_kernel = rjpeg_idct_block_2;
+            break;
+         case 3:
+            z->idct_block_kernel = rjpeg_idct_block_1;
+            break;
+      }
+   }
+
    if (z->progressive)
    {
       for (i = 0; i < s->img_n; ++i)
@@ -1820,8 +1932,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
           * the bogus oversized data from using interleaved MCUs and their
           * big blocks (e.g. a 16x16 iMCU on an image of width 33); we won't
           * discard the extra data until colorspace conversion */
-         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * 8;
-         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * 8;
+         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * z->idct_block_size;
+         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * z->idct_block_size;
          z->img_comp[i].raw_data = malloc(z->img_comp[i].w2 * z->img_comp[i].h2+15);
 
          /* Out of memory? */
@@ -1839,8 +1951,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
          /* align blocks for IDCT using MMX/SSE */
          z->img_comp[i].data      = (uint8_t*) (((size_t) z->img_comp[i].raw_data + 15) & ~15);
          z->img_comp[i].linebuf   = NULL;
-         z->img_comp[i].coeff_w   = (z->img_comp[i].w2 + 7) >> 3;
-         z->img_comp[i].coeff_h   = (z->img_comp[i].h2 + 7) >> 3;
+         z->img_comp[i].coeff_w   = z->img_mcu_x * z->img_comp[i].h;
+         z->img_comp[i].coeff_h   = z->img_mcu_y * z->img_comp[i].v;
          z->img_comp[i].raw_coeff = malloc(z->img_comp[i].coeff_w *
                                     z->img_comp[i].coeff_h * 64 * sizeof(short) + 15);
          z->img_comp[i].coeff     = (short*) (((size_t) z->img_comp[i].raw_coeff + 15) & ~15);
@@ -1858,8 +1970,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
           * the bogus oversized data from using interleaved MCUs and their
           * big blocks (e.g. a 16x16 iMCU on an image of width 33); we won't
           * discard the extra data until colorspace conversion */
-         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * 8;
-         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * 8;
+         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * z->idct_block_size;
+         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * z->idct_block_size;
          z->img_comp[i].raw_data = malloc(z->img_comp[i].w2 * z->img_comp[i].h2+15);
 
          /* Out of memory? */
@@ -2180,6 +2292,113 @@ static uint8_t *rjpeg_resample_row_hv_2_simd(uint8_t *out, uint8_t *in_near,
 
    return out;
 }
+
+static uint8_t *rjpeg_resample_row_v_2_simd(uint8_t *out, uint8_t *in_near,
+      uint8_t *in_far, int w, int hs)
+{
+   /* need to generate two samples vertically for every one in input */
+   int i = 0;
+#if defined(__SSE2__)
+   __m128i zero  = _mm_setzero_si128();
+   __m128i bias  = _mm_set1_epi16(2);
+
+   for (; i + 16 <= w; i += 16)
+   {
+      /* 3*near + far = 2*near + near + far */
+      __m128i nearb = _mm_loadu_si128((__m128i *) (in_near + i));
+      __m128i farb  = _mm_loadu_si128((__m128i *) (in_far + i));
+      __m128i nlo   = _mm_unpacklo_epi8(nearb, zero);
+      __m128i nhi   = _mm_unpackhi_epi8(nearb, zero);
+      __m128i lo    = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(nlo, 1), nlo),
+            _mm_add_epi16(_mm_unpacklo_epi8(farb, zero), bias));
+      __m128i hi    = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(nhi, 1), nhi),
+            _mm_add_epi16(_mm_unpackhi_epi8(farb, zero), bias));
+
+      _mm_storeu_si128((__m128i *) (out + i),
+            _mm_packus_epi16(_mm_srli_epi16(lo, 2), _mm_srli_epi16(hi, 2)));
+   }
+#elif defined(RJPEG_NEON)
+   uint8x8_t three = vdup_n_u8(3);
+
+   for (; i + 8 <= w; i += 8)
+   {
+      /* rounding narrow adds the +2 */
+      uint16x8_t sum = vaddw_u8(vmull_u8(vld1_u8(in_near + i), three),
+            vld1_u8(in_far + i));
+      vst1_u8(out + i, vrshrn_n_u16(sum, 2));
+   }
+#endif
+
+   for (; i < w; ++i)
+      out[i] = RJPEG_DIV4(3*in_near[i] + in_far[i] + 2);
+
+   (void)hs;
+
+   return out;
+}
+
+static uint8_t *rjpeg_resample_row_h_2_simd(uint8_t *out, uint8_t *in_near,
+      uint8_t *in_far, int w, int hs)
+{
+   /* need to generate two samples horizontally for every one in input */
+   int i;
+   uint8_t *input = in_near;
+#if defined(__SSE2__)
+   __m128i zero   = _mm_setzero_si128();
+   __m128i bias   = _mm_set1_epi16(2);
+#elif defined(RJPEG_NEON)
+   uint8x8_t three = vdup_n_u8(3);
+#endif
+
+   if (w == 1)
+   {
+      /* if only one sample, can't do any interpolation */
+      out[0] = out[1] = input[0];
+      return out;
+   }
+
+   out[0] = input[0];
+   out[1] = RJPEG_DIV4(input[0]*3 + input[1] + 2);
+
+   /* groups of 8 input pixels, each needs its left and
+    * right neighbour so the last pixel is left to the tail */
+   for (i = 1; i + 9 <= w; i += 8)
+   {
+#if defined(__SSE2__)
+      /* even pixels = 3*cur + prev, odd pixels = 3*cur + next */
+      __m128i curr = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *) (input + i)), zero);
+      __m128i prev = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *) (input + i - 1)), zero);
+      __m128i next = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *) (input + i + 1)), zero);
+      __m128i curb = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(curr, 1), curr), bias);
+      __m128i even = _mm_srli_epi16(_mm_add_epi16(curb, prev), 2);
+      __m128i odd  = _mm_srli_epi16(_mm_add_epi16(curb, next), 2);
+
+      /* interleave the phases */
+      __m128i outv = _mm_or_si128(even, _mm_slli_epi16(odd, 8));
+      _mm_storeu_si128((__m128i *) (out + i*2), outv);
+#elif defined(RJPEG_NEON)
+      uint16x8_t curr = vmull_u8(vld1_u8(input + i), three);
+      uint8x8x2_t o;
+      o.val[0] = vrshrn_n_u16(vaddw_u8(curr, vld1_u8(input + i - 1)), 2);
+      o.val[1] = vrshrn_n_u16(vaddw_u8(curr, vld1_u8(input + i + 1)), 2);
+      vst2_u8(out + i*2, o);
+#endif
+   }
+
+   for (; i < w-1; ++i)
+   {
+      int n      = 3 * input[i] + 2;
+      out[i*2+0] = RJPEG_DIV4(n+input[i-1]);
+      out[i*2+1] = RJPEG_DIV4(n+input[i+1]);
+   }
+   out[i*2+0] = RJPEG_DIV4(input[w-2]*3 + input[w-1] + 2);
+   out[i*2+1] = input[w-1];
+
+   (void)in_far;
+   (void)hs;
+
+   return out;
+}
 #endif
 
 static uint8_t *rjpeg_resample_row_generic(uint8_t *out,
@@ -2385,6 +2604,11 @@ static void rjpeg_setup_jpeg(rjpeg_jpeg *j)
    j->idct_block_kernel        = rjpeg_idct_block;
    j->YCbCr_to_RGB_kernel      = rjpeg_YCbCr_to_RGB_row;
    j->resample_row_hv_2_kernel = rjpeg_resample_row_hv_2;
+   j->resample_row_h_2_kernel  = rjpeg_resample_row_h_2;
+   j->resample_row_v_2_kernel  = rjpeg_resample_row_v_2;
+   j->max_size                 = 0;
+   j->scale_shift              = 0;
+   j->idct_block_size          = 8;
 
 #if defined(__SSE2__)
    if (mask & RETRO_SIMD_SSE2)
@@ -2392,6 +2616,8 @@ static void rjpeg_setup_jpeg(rjpeg_jpeg *j)
       j->idct_block_kernel        = rjpeg_idct_simd;
       j->YCbCr_to_RGB_kernel      = rjpeg_YCbCr_to_RGB_simd;
       j->resample_row_hv_2_kernel = rjpeg_resample_row_hv_2_simd;
+      j->resample_row_h_2_kernel  = rjpeg_resample_row_h_2_simd;
+      j->resample_row_v_2_kernel  = rjpeg_resample_row_v_2_simd;
    }
 #endif
 
@@ -2399,6 +2625,8 @@ static void rjpeg_setup_jpeg(rjpeg_jpeg *j)
    j->idct_block_kernel           = rjpeg_idct_simd;
    j->YCbCr_to_RGB_kernel         = rjpeg_YCbCr_to_RGB_simd;
    j->resample_row_hv_2_kernel    = rjpeg_resample_row_hv_2_simd;
+   j->resample_row_h_2_kernel     = rjpeg_resample_row_h_2_simd;
+   j->resample_row_v_2_kernel     = rjpeg_resample_row_v_2_simd;
 #endif
 }
 
@@ -2445,6 +2673,23 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    if (!rjpeg_decode_jpeg_image(z))
       goto error;
 
+   /* the blocks were decoded at 1/2^scale_shift of their size,
+    * carry on as if the image had been that small */
+   if (z->scale_shift)
+   {
+      int shift = z->scale_shift;
+      int round = (1 << shift) - 1;
+
+      z->s->img_x = (z->s->img_x + round) >> shift;
+      z->s->img_y = (z->s->img_y + round) >> shift;
+
+      for (k = 0; k < z->s->img_n; ++k)
+      {
+         z->img_comp[k].x = (z->img_comp[k].x + round) >> shift;
+         z->img_comp[k].y = (z->img_comp[k].y + round) >> shift;
+      }
+   }
+
    /* determine actual number of components to generate */
    n = req_comp ? req_comp : z->s->img_n;
 
@@ -2475,9 +2720,9 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
       if      (r->hs == 1 && r->vs == 1)
          r->resample = rjpeg_resample_row_1;
       else if (r->hs == 1 && r->vs == 2)
-         r->resample = rjpeg_resample_row_v_2;
+         r->resample = z->resample_row_v_2_kernel;
       else if (r->hs == 2 && r->vs == 1)
-         r->resample = rjpeg_resample_row_h_2;
+         r->resample = z->resample_row_h_2_kernel;
       else if (r->hs == 2 && r->vs == 2)
          r->resample = z->resample_row_hv_2_kernel;
    }
@@ -2562,8 +2807,8 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    rjpeg_context s;
    int comp;
    uint32_t *img         = NULL;
-   uint32_t *pixels      = NULL;
    unsigned size_tex     = 0;
+   unsigned i            = 0;
 
    if (!rjpeg)
       return IMAGE_PROCESS_ERROR;
@@ -2575,36 +2820,57 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    j.s                   = &s;
 
    rjpeg_setup_jpeg(&j);
+   j.max_size            = rjpeg->max_size;
 
    img                   =  (uint32_t*)rjpeg_load_jpeg_image(&j, width, height, &comp, 4);
 
    if (!img)
       return IMAGE_PROCESS_ERROR;
 
-   size_tex = (*width) * (*height);
-   pixels   = (uint32_t*)malloc(size_tex * sizeof(uint32_t));
+   size_tex  = (*width) * (*height);
+   *buf_data = img;
 
-   if (!pixels)
+   /* Convert RGBA to ARGB in place, swapping R and B */
+#if defined(__SSE2__)
    {
-      free(img);
-      return IMAGE_PROCESS_ERROR;
+      __m128i ag_mask = _mm_set1_epi32(0xFF00FF00);
+      __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+
+      for (; i + 4 <= size_tex; i += 4)
+      {
+         __m128i texel = _mm_loadu_si128((__m128i*)(img + i));
+         __m128i rb    = _mm_and_si128(texel, rb_mask);
+         rb            = _mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+         rb            = _mm_shufflehi_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+         _mm_storeu_si128((__m128i*)(img + i),
+               _mm_or_si128(_mm_and_si128(texel, ag_mask), rb));
+      }
    }
+#elif defined(RJPEG_NEON)
+   {
+      uint32x4_t ag_mask = vdupq_n_u32(0xFF00FF00);
+      uint32x4_t rb_mask = vdupq_n_u32(0x00FF00FF);
 
-   *buf_data = pixels;
+      for (; i + 4 <= size_tex; i += 4)
+      {
+         uint32x4_t texel = vld1q_u32(img + i);
+         uint32x4_t rb    = vreinterpretq_u32_u16(vrev32q_u16(
+                  vreinterpretq_u16_u32(vandq_u32(texel, rb_mask))));
+         vst1q_u32(img + i, vorrq_u32(vandq_u32(texel, ag_mask), rb));
+      }
+   }
+#endif
 
-   /* Convert RGBA to ARGB */
-   while (size_tex--)
+   for (; i < size_tex; i++)
    {
-      unsigned int texel = img[size_tex];
-      unsigned int A     = texel & 0xFF000000;
-      unsigned int B     = texel & 0x00FF0000;
-      unsigned int G     = texel & 0x0000FF00;
-      unsigned int R     = texel & 0x000000FF;
-      ((unsigned int*)pixels)[size_tex] = A | (R << 16) | G | (B >> 16);
+      uint32_t texel = img[i];
+      uint32_t A     = texel & 0xFF000000;
+      uint32_t B     = texel & 0x00FF0000;
+      uint32_t G     = texel & 0x0000FF00;
+      uint32_t R     = texel & 0x000000FF;
+      img[i]         = A | (R << 16) | G | (B >> 16);
    }
 
-   free(img);
-
    return IMAGE_PROCESS_END;
 }
 
@@ -2618,6 +2884,12 @@ bool rjpeg_set_buf_ptr(rjpeg_t *rjpeg, void *data)
    return true;
 }
 
+void rjpeg_set_max_size(rjpeg_t *rjpeg, unsigned max_size)
+{
+   if (rjpeg)
+      rjpeg->max_size = max_size;
+}
+
 void rjpeg_free(rjpeg_t *rjpeg)
 {
    if (!rjpeg)
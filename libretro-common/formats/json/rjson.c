@@ -28,7 +28,14 @@
 #include <stdint.h> /* int64_t */
 #include <stdlib.h> /* malloc, realloc, atof, atoi */
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include <formats/rjson.h>
+#include <compat/intrinsics.h>
 #include <compat/posix_string.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
@@ -363,6 +370,80 @@ static bool _rjson_validate_utf8(rjson_t *json)
    }
 }
 
+/* Returns the number of leading bytes of p..end that need no
+ * special handling inside a string (not '"', '\\' or a control
+ * character), OR-ing them into utf8mask. Only whole 16 byte
+ * blocks are looked at, the caller handles what's left. */
+static INLINE size_t _rjson_scan_string(const unsigned char *p,
+      const unsigned char *end, unsigned char *utf8mask)
+{
+   const unsigned char *start = p;
+#if defined(__SSE2__)
+   const __m128i quote = _mm_set1_epi8('"');
+   const __m128i bslash = _mm_set1_epi8('\\');
+   const __m128i ctrl  = _mm_set1_epi8(0x1F);
+   int high            = 0;
+
+   while (end - p >= 16)
+   {
+      __m128i v  = _mm_loadu_si128((const __m128i*)p);
+      /* c <= 0x1F unsigned is max(c, 0x1F) == 0x1F */
+      __m128i sp = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));
+      int mask   = _mm_movemask_epi8(sp);
+
+      if (mask)
+      {
+         int n = compat_ctz((unsigned)mask);
+         high |= _mm_movemask_epi8(v) & ((1 << n) - 1);
+         p    += n;
+         break;
+      }
+
+      high |= _mm_movemask_epi8(v);
+      p    += 16;
+   }
+
+   if (high)
+      *utf8mask |= 0x80;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+   const uint8x16_t quote = vdupq_n_u8('"');
+   const uint8x16_t bslash = vdupq_n_u8('\\');
+   const uint8x16_t ctrl  = vdupq_n_u8(0x20);
+   uint8x16_t high        = vdupq_n_u8(0);
+
+   while (end - p >= 16)
+   {
+      uint8x16_t v  = vld1q_u8(p);
+      uint8x16_t sp = vorrq_u8(
+            vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, bslash)),
+            vcltq_u8(v, ctrl));
+
+      if (vmaxvq_u8(sp))
+      {
+         /* Narrow to 4 bits per byte to find the first match */
+         uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(
+                  vshrn_n_u16(vreinterpretq_u16_u8(sp), 4)), 0);
+         size_t n      = (uint32_t)bits
+            ? (size_t)compat_ctz((uint32_t)bits) >> 2
+            : 8 + ((size_t)compat_ctz((uint32_t)(bits >> 32)) >> 2);
+         size_t i;
+         for (i = 0; i < n; i++)
+            *utf8mask |= p[i];
+         p += n;
+         break;
+      }
+
+      high = vorrq_u8(high, v);
+      p   += 16;
+   }
+
+   *utf8mask |= vmaxvq_u8(high) & 0x80;
+#endif
+   return p - start;
+}
+
 static enum rjson_type _rjson_read_string(rjson_t *json)
 {
    const unsigned char *p   = json->input_p, *raw = p;
@@ -370,6 +451,7 @@ static enum rjson_type _rjson_read_string(rjson_t *json)
    unsigned char utf8mask = 0;
    json->string_pass_through = NULL;
    json->string_len = 0;
+   p += _rjson_scan_string(p, end, &utf8mask);
    for (;;)
    {
       if (_rJSON_LIKELY(p != end))
@@ -445,6 +527,7 @@ static enum rjson_type _rjson_read_string(rjson_t *json)
             }
             raw = p = json->input_p;
             end     = json->input_end;
+            p      += _rjson_scan_string(p, end, &utf8mask);
          }
          else if (!(json->option_flags & RJSON_OPTION_ALLOW_UNESCAPED_CONTROL_CHARACTERS))
             return _rjson_error_char(json, "unescaped control character %s in string", c);
@@ -462,6 +545,7 @@ static enum rjson_type _rjson_read_string(rjson_t *json)
             return _rjson_error(json, "unterminated string literal");
          raw = p = json->input_p;
          end     = json->input_end;
+         p      += _rjson_scan_string(p, end, &utf8mask);
       }
    }
 }
@@ -32,6 +32,7 @@
 #endif
 
 #include <boolean.h>
+#include <retro_endianness.h>
 #include <formats/image.h>
 #include <formats/rpng.h>
 #include <streams/trans_stream.h>
@@ -39,6 +40,22 @@
 
 #include "rpng_internal.h"
 
+#if _MSC_VER && _MSC_VER <= 1800
+#define RPNG_NO_SIMD
+#endif
+
+#if defined(__SSE2__) && !defined(RPNG_NO_SIMD)
+#define RPNG_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS) && !defined(RPNG_NO_SIMD)
+#define RPNG_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+#define RPNG_SIMD
+#endif
+
 enum png_ihdr_color_type
 {
    PNG_IHDR_COLOR_GRAY       = 0,
@@ -220,14 +237,286 @@ static bool png_process_ihdr(struct png_ihdr *ihdr)
 }
 #endif
 
+#ifdef RPNG_SIMD
+/* Sub, Average and Paeth depend on the pixel to the left,
+ * so these unfilter one pixel per step with all of its
+ * channels in one vector. Only used for 8 bit RGB(A),
+ * 'bpp' is 3 or 4 bytes. */
+#if defined(RPNG_SSE2)
+static INLINE __m128i png_simd_load_pixel(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   if (bpp == 4)
+      memcpy(&v, p, 4);
+   else
+      memcpy(&v, p, 3);
+   return _mm_cvtsi32_si128((int)v);
+}
+
+static INLINE void png_simd_store_pixel(uint8_t *p, __m128i v, unsigned bpp)
+{
+   uint32_t w = (uint32_t)_mm_cvtsi128_si32(v);
+   if (bpp == 4)
+      memcpy(p, &w, 4);
+   else
+      memcpy(p, &w, 3);
+}
+
+static void png_unfilter_sub_simd(uint8_t *out,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = _mm_add_epi8(a, png_simd_load_pixel(in + i, bpp));
+      png_simd_store_pixel(out + i, a, bpp);
+   }
+}
+
+static void png_unfilter_avg_simd(uint8_t *out, const uint8_t *prev,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i one = _mm_set1_epi8(1);
+   __m128i a         = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b   = png_simd_load_pixel(prev + i, bpp);
+      /* pavgb rounds up, PNG rounds down */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), one));
+      a           = _mm_add_epi8(png_simd_load_pixel(in + i, bpp), avg);
+      png_simd_store_pixel(out + i, a, bpp);
+   }
+}
+
+static INLINE __m128i png_simd_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static INLINE __m128i png_simd_select(__m128i mask, __m128i x, __m128i y)
+{
+   return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y));
+}
+
+static void png_unfilter_paeth_simd(uint8_t *out, const uint8_t *prev,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i zero = _mm_setzero_si128();
+   /* Left, above-left, 16 bit per channel */
+   __m128i a          = zero;
+   __m128i c          = zero;
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b  = _mm_unpacklo_epi8(png_simd_load_pixel(prev + i, bpp), zero);
+      __m128i pa = _mm_sub_epi16(b, c);
+      __m128i pb = _mm_sub_epi16(a, c);
+      __m128i pc = _mm_add_epi16(pa, pb);
+      __m128i smallest, nearest;
+
+      pa       = png_simd_abs_epi16(pa);
+      pb       = png_simd_abs_epi16(pb);
+      pc       = png_simd_abs_epi16(pc);
+      smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      nearest  = png_simd_select(_mm_cmpeq_epi16(pa, smallest), a,
+            png_simd_select(_mm_cmpeq_epi16(pb, smallest), b, c));
+
+      a        = _mm_add_epi8(png_simd_load_pixel(in + i, bpp),
+            _mm_packus_epi16(nearest, nearest));
+      png_simd_store_pixel(out + i, a, bpp);
+
+      a        = _mm_unpacklo_epi8(a, zero);
+      c        = b;
+   }
+}
+#else
+static INLINE uint8x8_t png_simd_load_pixel(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   if (bpp == 4)
+      memcpy(&v, p, 4);
+   else
+      memcpy(&v, p, 3);
+   return vreinterpret_u8_u32(vdup_n_u32(v));
+}
+
+static INLINE void png_simd_store_pixel(uint8_t *p, uint8x8_t v, unsigned bpp)
+{
+   uint32_t w = vget_lane_u32(vreinterpret_u32_u8(v), 0);
+   if (bpp == 4)
+      memcpy(p, &w, 4);
+   else
+      memcpy(p, &w, 3);
+}
+
+static void png_unfilter_sub_simd(uint8_t *out,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = vadd_u8(a, png_simd_load_pixel(in + i, bpp));
+      png_simd_store_pixel(out + i, a, bpp);
+   }
+}
+
+static void png_unfilter_avg_simd(uint8_t *out, const uint8_t *prev,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      uint8x8_t avg = vhadd_u8(a, png_simd_load_pixel(prev + i, bpp));
+      a             = vadd_u8(png_simd_load_pixel(in + i, bpp), avg);
+      png_simd_store_pixel(out + i, a, bpp);
+   }
+}
+
+static void png_unfilter_paeth_simd(uint8_t *out, const uint8_t *prev,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+   uint8x8_t c = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      uint8x8_t b    = png_simd_load_pixel(prev + i, bpp);
+      uint16x8_t pa  = vabdl_u8(b, c);
+      uint16x8_t pb  = vabdl_u8(a, c);
+      uint16x8_t pc  = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+      uint16x8_t use_a = vandq_u16(vcleq_u16(pa, pb), vcleq_u16(pa, pc));
+      uint8x8_t nearest = vbsl_u8(vmovn_u16(use_a), a,
+            vbsl_u8(vmovn_u16(vcleq_u16(pb, pc)), b, c));
+
+      a = vadd_u8(png_simd_load_pixel(in + i, bpp), nearest);
+      png_simd_store_pixel(out + i, a, bpp);
+      c = b;
+   }
+}
+#endif
+
+/* Up has no dependency within the line */
+static void png_unfilter_up_simd(uint8_t *out, const uint8_t *prev,
+      const uint8_t *in, unsigned pitch)
+{
+   unsigned i = 0;
+
+#if defined(RPNG_SSE2)
+   for (; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(prev + i)),
+               _mm_loadu_si128((const __m128i*)(in + i))));
+#else
+   for (; i + 16 <= pitch; i += 16)
+      vst1q_u8(out + i, vaddq_u8(vld1q_u8(prev + i), vld1q_u8(in + i)));
+#endif
+
+   for (; i < pitch; i++)
+      out[i] = prev[i] + in[i];
+}
+
+#if !defined(MSB_FIRST)
+/* 8 bit RGBA to ARGB8888, returns the number of pixels done */
+static unsigned png_convert_rgba_simd(uint32_t *data,
+      const uint8_t *decoded, unsigned width)
+{
+   unsigned i = 0;
+#if defined(RPNG_SSE2)
+   const __m128i ag_mask = _mm_set1_epi32((int)0xff00ff00);
+   const __m128i rb_mask = _mm_set1_epi32(0x00ff00ff);
+
+   for (; i + 4 <= width; i += 4)
+   {
+      __m128i v  = _mm_loadu_si128((const __m128i*)(decoded + i * 4));
+      __m128i rb = _mm_and_si128(v, rb_mask);
+      rb         = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+      _mm_storeu_si128((__m128i*)(data + i),
+            _mm_or_si128(_mm_and_si128(v, ag_mask), rb));
+   }
+#else
+   for (; i + 8 <= width; i += 8)
+   {
+      uint8x8x4_t px = vld4_u8(decoded + i * 4);
+      uint8x8_t r    = px.val[0];
+      px.val[0]      = px.val[2];
+      px.val[2]      = r;
+      vst4_u8((uint8_t*)(data + i), px);
+   }
+#endif
+   return i;
+}
+
+/* 8 bit RGB to ARGB8888, returns the number of pixels done */
+static unsigned png_convert_rgb_simd(uint32_t *data,
+      const uint8_t *decoded, unsigned width)
+{
+   unsigned i = 0;
+#if defined(RPNG_SSE2)
+   const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+
+   /* Reads 16 bytes for 12, keep clear of the end */
+   for (; i + 6 <= width; i += 4)
+   {
+      const uint8_t *p = decoded + i * 3;
+      uint32_t px[4];
+      __m128i v, rb;
+
+      memcpy(&px[0], p,     4);
+      memcpy(&px[1], p + 3, 4);
+      memcpy(&px[2], p + 6, 4);
+      memcpy(&px[3], p + 9, 4);
+
+      v  = _mm_loadu_si128((const __m128i*)px);
+      rb = _mm_and_si128(v, _mm_set1_epi32(0x00ff00ff));
+      rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+      v  = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(0x0000ff00)),
+            _mm_and_si128(rb, _mm_set1_epi32(0x00ff00ff)));
+      _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(v, alpha));
+   }
+#else
+   for (; i + 8 <= width; i += 8)
+   {
+      uint8x8x3_t rgb = vld3_u8(decoded + i * 3);
+      uint8x8x4_t px;
+      px.val[0]       = rgb.val[2];
+      px.val[1]       = rgb.val[1];
+      px.val[2]       = rgb.val[0];
+      px.val[3]       = vdup_n_u8(0xff);
+      vst4_u8((uint8_t*)(data + i), px);
+   }
+#endif
+   return i;
+}
+#endif
+#endif
+
 static void png_reverse_filter_copy_line_rgb(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
+
+#if defined(RPNG_SIMD) && !defined(MSB_FIRST)
+   if (bpp == 8)
+   {
+      i        = png_convert_rgb_simd(data, decoded, width);
+      decoded += i * 3;
+   }
+#endif
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+   for (; i < width; i++)
    {
       uint32_t r, g, b;
 
@@ -244,11 +533,19 @@ static void png_reverse_filter_copy_line_rgb(uint32_t *data,
 static void png_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
+
+#if defined(RPNG_SIMD) && !defined(MSB_FIRST)
+   if (bpp == 8)
+   {
+      i        = png_convert_rgba_simd(data, decoded, width);
+      decoded += i * 4;
+   }
+#endif
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+   for (; i < width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -555,48 +852,96 @@ error:
    return -1;
 }
 
-static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
+#ifdef RPNG_SIMD
+/* Returns false if the line has to be unfiltered by the C code */
+static bool png_reverse_filter_line_simd(const struct png_ihdr *ihdr,
       struct rpng_process *pngp, unsigned filter)
 {
-   unsigned i;
+   if (filter == PNG_FILTER_UP)
+   {
+      png_unfilter_up_simd(pngp->decoded_scanline,
+            pngp->prev_scanline, pngp->inflate_buf, pngp->pitch);
+      return true;
+   }
+
+   if (ihdr->depth != 8 || (pngp->bpp != 3 && pngp->bpp != 4))
+      return false;
 
    switch (filter)
    {
-      case PNG_FILTER_NONE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         break;
       case PNG_FILTER_SUB:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
-         break;
-      case PNG_FILTER_UP:
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
-         break;
+         png_unfilter_sub_simd(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->pitch, pngp->bpp);
+         return true;
       case PNG_FILTER_AVERAGE:
-         for (i = 0; i < pngp->bpp; i++)
-         {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
-         }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-         {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
-         }
-         break;
+         png_unfilter_avg_simd(pngp->decoded_scanline,
+               pngp->prev_scanline, pngp->inflate_buf,
+               pngp->pitch, pngp->bpp);
+         return true;
       case PNG_FILTER_PAETH:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = paeth(0, pngp->prev_scanline[i], 0) + pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]) + pngp->inflate_buf[i];
+         png_unfilter_paeth_simd(pngp->decoded_scanline,
+               pngp->prev_scanline, pngp->inflate_buf,
+               pngp->pitch, pngp->bpp);
+         return true;
+      default:
          break;
+   }
 
-      default:
-         return IMAGE_PROCESS_ERROR_END;
+   return false;
+}
+#endif
+
+static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
+      struct rpng_process *pngp, unsigned filter)
+{
+   unsigned i;
+   uint8_t *swap   = NULL;
+   bool unfiltered = false;
+
+#ifdef RPNG_SIMD
+   unfiltered      = png_reverse_filter_line_simd(ihdr, pngp, filter);
+#endif
+
+   if (!unfiltered)
+   {
+      switch (filter)
+      {
+         case PNG_FILTER_NONE:
+            memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
+            break;
+         case PNG_FILTER_SUB:
+            for (i = 0; i < pngp->bpp; i++)
+               pngp->decoded_scanline[i] = pngp->inflate_buf[i];
+            for (i = pngp->bpp; i < pngp->pitch; i++)
+               pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
+            break;
+         case PNG_FILTER_UP:
+            for (i = 0; i < pngp->pitch; i++)
+               pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
+            break;
+         case PNG_FILTER_AVERAGE:
+            for (i = 0; i < pngp->bpp; i++)
+            {
+               uint8_t avg = pngp->prev_scanline[i] >> 1;
+               pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
+            }
+            for (i = pngp->bpp; i < pngp->pitch; i++)
+            {
+               uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
+               pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
+            }
+            break;
+         case PNG_FILTER_PAETH:
+            for (i = 0; i < pngp->bpp; i++)
+               pngp->decoded_scanline[i] = paeth(0, pngp->prev_scanline[i], 0) + pngp->inflate_buf[i];
+            for (i = pngp->bpp; i < pngp->pitch; i++)
+               pngp->decoded_scanline[i] = paeth(pngp->decoded_scanline[i - pngp->bpp],
+                     pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]) + pngp->inflate_buf[i];
+            break;
+
+         default:
+            return IMAGE_PROCESS_ERROR_END;
+      }
    }
 
    switch (ihdr->color_type)
@@ -620,7 +965,11 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          break;
    }
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+   /* Every filter writes the whole line, so the
+    * buffers can trade places instead of copying */
+   swap                   = pngp->prev_scanline;
+   pngp->prev_scanline    = pngp->decoded_scanline;
+   pngp->decoded_scanline = swap;
 
    return IMAGE_PROCESS_NEXT;
 }
@@ -25,10 +25,17 @@
 #include <string.h>
 
 #include <libretro.h>
+#include <retro_miscellaneous.h>
 #include <encodings/crc32.h>
 #include <streams/interface_stream.h>
 #include <streams/trans_stream.h>
 
+#if defined(HAVE_THREADS) && defined(HAVE_ZLIB)
+#include <zlib.h>
+#include <features/features_cpu.h>
+#include <rthreads/tpool.h>
+#endif
+
 #include "rpng_internal.h"
 
 #undef GOTO_END_ERROR
@@ -203,27 +210,458 @@ static unsigned filter_paeth(uint8_t *target,
    return count_sad(target, width);
 }
 
+/* The filter for a line is picked from its score on every
+ * PNG_FILTER_SAMPLE_STEP-th pixel, then only that filter runs
+ * over the whole line. Shorter lines try every filter. */
+#define PNG_FILTER_SAMPLE_STEP 4
+#define PNG_FILTER_SAMPLE_MIN_WIDTH 64
+
+struct png_filter_lines
+{
+   uint8_t *rgba_line;
+   uint8_t *up_filtered;
+   uint8_t *sub_filtered;
+   uint8_t *avg_filtered;
+   uint8_t *paeth_filtered;
+   uint8_t *prev_encoded;
+};
+
+static void png_filter_lines_free(struct png_filter_lines *lines)
+{
+   free(lines->rgba_line);
+   free(lines->up_filtered);
+   free(lines->sub_filtered);
+   free(lines->avg_filtered);
+   free(lines->paeth_filtered);
+   free(lines->prev_encoded);
+}
+
+static bool png_filter_lines_init(struct png_filter_lines *lines,
+      size_t size)
+{
+   lines->rgba_line      = (uint8_t*)malloc(size);
+   lines->up_filtered    = (uint8_t*)malloc(size);
+   lines->sub_filtered   = (uint8_t*)malloc(size);
+   lines->avg_filtered   = (uint8_t*)malloc(size);
+   lines->paeth_filtered = (uint8_t*)malloc(size);
+   lines->prev_encoded   = (uint8_t*)calloc(1, size);
+
+   if (     lines->rgba_line
+         && lines->up_filtered
+         && lines->sub_filtered
+         && lines->avg_filtered
+         && lines->paeth_filtered
+         && lines->prev_encoded)
+      return true;
+
+   png_filter_lines_free(lines);
+   return false;
+}
+
+static void png_copy_line(uint8_t *dst, const uint8_t *src,
+      unsigned width, unsigned bpp)
+{
+   if (bpp == sizeof(uint32_t))
+      copy_argb_line(dst, (const uint32_t*)src, width);
+   else
+      copy_bgr24_line(dst, src, width);
+}
+
+static unsigned png_run_filter(struct png_filter_lines *lines,
+      unsigned filter, unsigned width, unsigned bpp,
+      const uint8_t **filtered)
+{
+   switch (filter)
+   {
+      case 1:
+         *filtered = lines->sub_filtered;
+         return filter_sub(lines->sub_filtered, lines->rgba_line,
+               width, bpp);
+      case 2:
+         *filtered = lines->up_filtered;
+         return filter_up(lines->up_filtered, lines->rgba_line,
+               lines->prev_encoded, width, bpp);
+      case 3:
+         *filtered = lines->avg_filtered;
+         return filter_avg(lines->avg_filtered, lines->rgba_line,
+               lines->prev_encoded, width, bpp);
+      case 4:
+         *filtered = lines->paeth_filtered;
+         return filter_paeth(lines->paeth_filtered, lines->rgba_line,
+               lines->prev_encoded, width, bpp);
+      default:
+         break;
+   }
+
+   *filtered = lines->rgba_line;
+   return count_sad(lines->rgba_line, width * bpp);
+}
+
+/* Same scores as the filter_* functions, on a subset of pixels */
+static unsigned png_estimate_filter(const uint8_t *line,
+      const uint8_t *prev, unsigned width, unsigned bpp)
+{
+   unsigned i, j;
+   unsigned filter    = 0;
+   unsigned scores[5] = {0};
+
+   for (i = bpp; i < width * bpp; i += PNG_FILTER_SAMPLE_STEP * bpp)
+   {
+      for (j = i; j < i + bpp; j++)
+      {
+         int x = line[j];
+         int a = line[j - bpp];
+         int b = prev[j];
+         int c = prev[j - bpp];
+
+         scores[0] += abs((int8_t)x);
+         scores[1] += abs((int8_t)(x - a));
+         scores[2] += abs((int8_t)(x - b));
+         scores[3] += abs((int8_t)(x - ((a + b) >> 1)));
+         scores[4] += abs((int8_t)(x - paeth(a, b, c)));
+      }
+   }
+
+   for (i = 1; i < 5; i++)
+      if (scores[i] < scores[filter])
+         filter = i;
+
+   return filter;
+}
+
+/* Filters one line into encode_target (filter type byte
+ * first) and remembers it as the previous line. */
+static void png_filter_line(struct png_filter_lines *lines,
+      uint8_t *encode_target, const uint8_t *data,
+      unsigned width, unsigned bpp)
+{
+   uint8_t filter                 = 0;
+   const uint8_t *chosen_filtered = NULL;
+
+   png_copy_line(lines->rgba_line, data, width, bpp);
+
+   if (width >= PNG_FILTER_SAMPLE_MIN_WIDTH)
+   {
+      filter = (uint8_t)png_estimate_filter(lines->rgba_line,
+            lines->prev_encoded, width, bpp);
+      png_run_filter(lines, filter, width, bpp, &chosen_filtered);
+   }
+   else
+   {
+      unsigned i;
+      unsigned min_sad = png_run_filter(lines, 0, width, bpp,
+            &chosen_filtered);
+
+      /* Try every filtering method, and choose the method
+       * which has most entries as zero. */
+      for (i = 1; i < 5; i++)
+      {
+         const uint8_t *filtered = NULL;
+         unsigned score          = png_run_filter(lines, i,
+               width, bpp, &filtered);
+
+         if (score < min_sad)
+         {
+            min_sad         = score;
+            filter          = (uint8_t)i;
+            chosen_filtered = filtered;
+         }
+      }
+   }
+
+   *encode_target++ = filter;
+   memcpy(encode_target, chosen_filtered, width * bpp);
+
+   memcpy(lines->prev_encoded, lines->rgba_line, width * bpp);
+}
+
+#if defined(HAVE_THREADS) && defined(HAVE_ZLIB)
+/* Bands shorter than this aren't worth a thread */
+#define PNG_BAND_MIN_LINES 32
+
+/* Back-references can reach this far into the previous band */
+#define PNG_BAND_DICT_SIZE (1 << MAX_WBITS)
+
+/* A horizontal band of the image, filtered and then deflated
+ * on its own. Every band but the last ends with a sync flush,
+ * so the raw deflate outputs can be concatenated into one zlib
+ * stream. Like pigz, each band is primed with the tail of the
+ * one above, which keeps the file about as small as a single
+ * stream. */
+struct png_band
+{
+   const uint8_t *data;   /* First source line */
+   const uint8_t *prev;   /* Source line above it, NULL for the top band */
+   uint8_t *encode_buf;   /* Filtered lines, width * bpp + 1 bytes each */
+   uint8_t *out;
+   size_t dict_len;       /* Filtered bytes before encode_buf to prime with */
+   size_t out_len;
+   uint32_t adler;
+   signed pitch;
+   unsigned width;
+   unsigned height;
+   unsigned bpp;
+   int level;
+   bool last;
+   bool filtered;
+   bool ok;
+};
+
+static void png_filter_band(void *arg)
+{
+   unsigned h;
+   struct png_filter_lines lines;
+   struct png_band *band   = (struct png_band*)arg;
+   size_t line_size        = band->width * band->bpp + 1;
+   const uint8_t *data     = band->data;
+   uint8_t *encode_target  = band->encode_buf;
+
+   if (!png_filter_lines_init(&lines, line_size - 1))
+      return;
+
+   /* Up, avg and paeth look at the line above */
+   if (band->prev)
+      png_copy_line(lines.prev_encoded, band->prev, band->width, band->bpp);
+
+   for (h = 0; h < band->height;
+         h++, encode_target += line_size, data += band->pitch)
+      png_filter_line(&lines, encode_target, data, band->width, band->bpp);
+
+   png_filter_lines_free(&lines);
+   band->filtered = true;
+}
+
+/* Needs the band above to be filtered already */
+static void png_deflate_band(void *arg)
+{
+   z_stream z;
+   struct png_band *band   = (struct png_band*)arg;
+   size_t encode_buf_size  = (band->width * band->bpp + 1) * band->height;
+   uLong out_size;
+
+   band->adler = (uint32_t)adler32(adler32(0L, Z_NULL, 0),
+         band->encode_buf, (uInt)encode_buf_size);
+
+   memset(&z, 0, sizeof(z));
+   if (deflateInit2(&z, band->level, Z_DEFLATED,
+            -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      return;
+
+   if (band->dict_len && deflateSetDictionary(&z,
+            band->encode_buf - band->dict_len,
+            (uInt)band->dict_len) != Z_OK)
+   {
+      deflateEnd(&z);
+      return;
+   }
+
+   /* Leave room for the sync flush marker */
+   out_size  = deflateBound(&z, (uLong)encode_buf_size) + 16;
+   band->out = (uint8_t*)malloc(out_size);
+
+   if (band->out)
+   {
+      int zret;
+
+      z.next_in   = band->encode_buf;
+      z.avail_in  = (uInt)encode_buf_size;
+      z.next_out  = band->out;
+      z.avail_out = (uInt)out_size;
+      zret        = deflate(&z, band->last ? Z_FINISH : Z_SYNC_FLUSH);
+
+      band->out_len = out_size - z.avail_out;
+      band->ok      = band->last
+         ? (zret == Z_STREAM_END)
+         : (zret == Z_OK && z.avail_in == 0 && z.avail_out != 0);
+   }
+
+   deflateEnd(&z);
+}
+
+/* Same as zlib's adler32_combine(), which older bundled
+ * copies don't have */
+static uint32_t png_adler32_combine(uint32_t adler1, uint32_t adler2,
+      size_t len2)
+{
+   const uint32_t base = 65521;
+   uint32_t rem        = (uint32_t)(len2 % base);
+   uint32_t sum1       = adler1 & 0xffff;
+   uint32_t sum2       = (uint32_t)(((uint64_t)rem * sum1) % base);
+
+   sum1 += (adler2 & 0xffff) + base - 1;
+   sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - rem;
+   if (sum1 >= base)
+      sum1 -= base;
+   if (sum1 >= base)
+      sum1 -= base;
+   if (sum2 >= (base << 1))
+      sum2 -= (base << 1);
+   if (sum2 >= base)
+      sum2 -= base;
+   return sum1 | (sum2 << 16);
+}
+
+static bool rpng_save_image_stream_threaded(const uint8_t *data,
+      intfstream_t* intf_s, unsigned width, unsigned height,
+      signed pitch, unsigned bpp, unsigned threads, int level)
+{
+   unsigned i;
+   struct png_ihdr ihdr      = {0};
+   bool ret                  = true;
+   size_t line_size          = width * bpp + 1;
+   size_t idat_size          = 0;
+   uint32_t adler            = 1;
+   unsigned num_bands        = 0;
+   unsigned band_lines       = 0;
+   uint8_t *encode_buf       = NULL;
+   uint8_t *idat             = NULL;
+   uint8_t *idat_target      = NULL;
+   struct png_band *bands    = NULL;
+   tpool_t *pool             = NULL;
+   tpool_t *own_pool         = NULL;
+   tpool_group_t *group      = NULL;
+
+   if (!intf_s || !height)
+      GOTO_END_ERROR();
+
+   num_bands  = MIN(MAX(threads, 1), MAX(height / PNG_BAND_MIN_LINES, 1));
+   band_lines = (height + num_bands - 1) / num_bands;
+   num_bands  = (height + band_lines - 1) / band_lines;
+
+   encode_buf = (uint8_t*)malloc(line_size * height);
+   bands      = (struct png_band*)calloc(num_bands, sizeof(*bands));
+   if (!encode_buf || !bands)
+      GOTO_END_ERROR();
+
+   for (i = 0; i < num_bands; i++)
+   {
+      struct png_band *band = &bands[i];
+      band->data       = data + (signed)(i * band_lines) * pitch;
+      band->prev       = i ? band->data - pitch : NULL;
+      band->encode_buf = encode_buf + i * band_lines * line_size;
+      band->pitch      = pitch;
+      band->width      = width;
+      band->height     = MIN(band_lines, height - i * band_lines);
+      band->bpp        = bpp;
+      band->dict_len   = MIN(i * band_lines * line_size, PNG_BAND_DICT_SIZE);
+      band->level      = level;
+      band->last       = (i == num_bands - 1);
+   }
+
+   /* The calling thread takes the last band itself, the
+    * rest goes to the shared pool or one of our own */
+   if (num_bands > 1)
+   {
+      if (!(pool = tpool_shared()))
+         pool = own_pool = tpool_create(num_bands - 1);
+      if (!pool || !(group = tpool_group_new()))
+         GOTO_END_ERROR();
+   }
+
+   for (i = 0; i + 1 < num_bands; i++)
+      if (!tpool_group_add_work(pool, group, png_filter_band, &bands[i]))
+         png_filter_band(&bands[i]);
+   png_filter_band(&bands[num_bands - 1]);
+
+   tpool_group_wait(pool, group);
+
+   for (i = 0; i < num_bands; i++)
+      if (!bands[i].filtered)
+         GOTO_END_ERROR();
+
+   for (i = 0; i + 1 < num_bands; i++)
+      if (!tpool_group_add_work(pool, group, png_deflate_band, &bands[i]))
+         png_deflate_band(&bands[i]);
+   png_deflate_band(&bands[num_bands - 1]);
+
+   tpool_group_wait(pool, group);
+
+   for (i = 0; i < num_bands; i++)
+   {
+      if (!bands[i].ok)
+         GOTO_END_ERROR();
+      idat_size += bands[i].out_len;
+   }
+
+   /* Chunk length and type, zlib header, bands, adler32 */
+   idat = (uint8_t*)malloc(8 + 2 + idat_size + 4);
+   if (!idat)
+      GOTO_END_ERROR();
+
+   /* Deflate with a 32K window, FLEVEL matching the level */
+   idat[8]     = 0x78;
+   idat[9]     = level <= Z_BEST_SPEED ? 0x01
+      : level >= 7 ? 0xDA : 0x9C;
+   idat_target = idat + 10;
+
+   for (i = 0; i < num_bands; i++)
+   {
+      memcpy(idat_target, bands[i].out, bands[i].out_len);
+      idat_target += bands[i].out_len;
+      adler        = png_adler32_combine(adler, bands[i].adler,
+            bands[i].height * line_size);
+   }
+
+   dword_write_be(idat_target, adler);
+   idat_size += 2 + 4;
+   dword_write_be(idat + 0, (uint32_t)idat_size);
+   memcpy(idat + 4, "IDAT", 4);
+
+   if (intfstream_write(intf_s, png_magic, sizeof(png_magic)) != sizeof(png_magic))
+      GOTO_END_ERROR();
+
+   ihdr.width      = width;
+   ihdr.height     = height;
+   ihdr.depth      = 8;
+   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
+   if (!png_write_ihdr_string(intf_s, &ihdr))
+      GOTO_END_ERROR();
+
+   if (!png_write_idat_string(intf_s, idat, idat_size + 8))
+      GOTO_END_ERROR();
+
+   if (!png_write_iend_string(intf_s))
+      GOTO_END_ERROR();
+
+end:
+   if (group)
+      tpool_group_free(group);
+   if (own_pool)
+      tpool_destroy(own_pool);
+   if (bands)
+   {
+      for (i = 0; i < num_bands; i++)
+         free(bands[i].out);
+      free(bands);
+   }
+   free(encode_buf);
+   free(idat);
+   return ret;
+}
+#endif
+
 bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
       unsigned width, unsigned height, signed pitch, unsigned bpp)
 {
+#if defined(HAVE_THREADS) && defined(HAVE_ZLIB)
+   return rpng_save_image_stream_threaded(data, intf_s, width, height,
+         pitch, bpp, cpu_features_get_core_amount(), Z_BEST_COMPRESSION);
+#else
    unsigned h;
    struct png_ihdr ihdr = {0};
+   struct png_filter_lines lines;
    bool ret = true;
    const struct trans_stream_backend *stream_backend = NULL;
    size_t encode_buf_size  = 0;
    uint8_t *encode_buf     = NULL;
    uint8_t *deflate_buf    = NULL;
-   uint8_t *rgba_line      = NULL;
-   uint8_t *up_filtered    = NULL;
-   uint8_t *sub_filtered   = NULL;
-   uint8_t *avg_filtered   = NULL;
-   uint8_t *paeth_filtered = NULL;
-   uint8_t *prev_encoded   = NULL;
    uint8_t *encode_target  = NULL;
    void *stream            = NULL;
    uint32_t total_in       = 0;
    uint32_t total_out      = 0;
-   
+
+   memset(&lines, 0, sizeof(lines));
+
    if (!intf_s)
       GOTO_END_ERROR();
 
@@ -244,77 +682,13 @@ bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
    if (!encode_buf)
       GOTO_END_ERROR();
 
-   prev_encoded = (uint8_t*)calloc(1, width * bpp);
-   if (!prev_encoded)
-      GOTO_END_ERROR();
-
-   rgba_line      = (uint8_t*)malloc(width * bpp);
-   up_filtered    = (uint8_t*)malloc(width * bpp);
-   sub_filtered   = (uint8_t*)malloc(width * bpp);
-   avg_filtered   = (uint8_t*)malloc(width * bpp);
-   paeth_filtered = (uint8_t*)malloc(width * bpp);
-   if (!rgba_line || !up_filtered || !sub_filtered || !avg_filtered || !paeth_filtered)
+   if (!png_filter_lines_init(&lines, width * bpp))
       GOTO_END_ERROR();
 
    encode_target = encode_buf;
    for (h = 0; h < height;
-         h++, encode_target += width * bpp, data += pitch)
-   {
-      if (bpp == sizeof(uint32_t))
-         copy_argb_line(rgba_line, (const uint32_t*)data, width);
-      else
-         copy_bgr24_line(rgba_line, data, width);
-
-      /* Try every filtering method, and choose the method
-       * which has most entries as zero.
-       *
-       * This is probably not very optimal, but it's very
-       * simple to implement.
-       */
-      {
-         unsigned none_score  = count_sad(rgba_line, width * bpp);
-         unsigned up_score    = filter_up(up_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned sub_score   = filter_sub(sub_filtered, rgba_line, width, bpp);
-         unsigned avg_score   = filter_avg(avg_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned paeth_score = filter_paeth(paeth_filtered, rgba_line, prev_encoded, width, bpp);
-
-         uint8_t filter       = 0;
-         unsigned min_sad     = none_score;
-         const uint8_t *chosen_filtered = rgba_line;
-
-         if (sub_score < min_sad)
-         {
-            filter = 1;
-            chosen_filtered = sub_filtered;
-            min_sad = sub_score;
-         }
-
-         if (up_score < min_sad)
-         {
-            filter = 2;
-            chosen_filtered = up_filtered;
-            min_sad = up_score;
-         }
-
-         if (avg_score < min_sad)
-         {
-            filter = 3;
-            chosen_filtered = avg_filtered;
-            min_sad = avg_score;
-         }
-
-         if (paeth_score < min_sad)
-         {
-            filter = 4;
-            chosen_filtered = paeth_filtered;
-         }
-
-         *encode_target++ = filter;
-         memcpy(encode_target, chosen_filtered, width * bpp);
-
-         memcpy(prev_encoded, rgba_line, width * bpp);
-      }
-   }
+         h++, encode_target += width * bpp + 1, data += pitch)
+      png_filter_line(&lines, encode_target, data, width, bpp);
 
    deflate_buf = (uint8_t*)malloc(encode_buf_size * 2); /* Just to be sure. */
    if (!deflate_buf)
@@ -347,12 +721,7 @@ bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
 end:
    free(encode_buf);
    free(deflate_buf);
-   free(rgba_line);
-   free(prev_encoded);
-   free(up_filtered);
-   free(sub_filtered);
-   free(avg_filtered);
-   free(paeth_filtered);
+   png_filter_lines_free(&lines);
 
    if (stream_backend)
    {
@@ -363,6 +732,7 @@ end:
       }
    }
    return ret;
+#endif
 }
 
 bool rpng_save_image_argb(const char *path, const uint32_t *data,
@@ -399,9 +769,30 @@ bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
    return ret;
 }
 
+bool rpng_save_image_bgr24_fast(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned threads)
+{
+   bool ret                      = false;
+   intfstream_t* intf_s          = NULL;
 
-uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
-      unsigned width, unsigned height, signed pitch, uint64_t* bytes)
+   intf_s = intfstream_open_file(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+#if defined(HAVE_THREADS) && defined(HAVE_ZLIB)
+   ret = rpng_save_image_stream_threaded(data, intf_s, width, height,
+         (signed) pitch, 3, threads, Z_BEST_SPEED);
+#else
+   ret = rpng_save_image_stream(data, intf_s, width, height,
+                                (signed) pitch, 3);
+#endif
+   intfstream_close(intf_s);
+   free(intf_s);
+   return ret;
+}
+
+static uint8_t* rpng_save_image_bgr24_string_internal(const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t* bytes,
+      bool fast)
 {
    bool ret                    = false;
    uint8_t* buf                = NULL;
@@ -419,7 +810,14 @@ uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
          RETRO_VFS_FILE_ACCESS_HINT_NONE,
          buf_length);
 
-   ret = rpng_save_image_stream((const uint8_t*)data, 
+#if defined(HAVE_THREADS) && defined(HAVE_ZLIB)
+   if (fast)
+      ret = rpng_save_image_stream_threaded((const uint8_t*)data,
+            intf_s, width, height, pitch, 3,
+            cpu_features_get_core_amount(), Z_BEST_SPEED);
+   else
+#endif
+      ret = rpng_save_image_stream((const uint8_t*)data, 
             intf_s, width, height, pitch, 3);
 
    *bytes = intfstream_get_ptr(intf_s);
@@ -446,3 +844,16 @@ end:
    return output;
 }
 
+uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t* bytes)
+{
+   return rpng_save_image_bgr24_string_internal(data,
+         width, height, pitch, bytes, false);
+}
+
+uint8_t* rpng_save_image_bgr24_string_fast(const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t* bytes)
+{
+   return rpng_save_image_bgr24_string_internal(data,
+         width, height, pitch, bytes, true);
+}
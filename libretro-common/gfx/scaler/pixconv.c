@@ -25,7 +25,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <boolean.h>
 #include <retro_inline.h>
+#include <features/features_cpu.h>
 
 #include <gfx/scaler/pixconv.h>
 
@@ -43,33 +45,1985 @@
 #include <mmintrin.h>
 #endif
 
-void conv_rgb565_0rgb1555(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
+/* The SSSE3 and AVX2 kernels are built with target attributes
+ * where the compiler supports it, so they can be picked at runtime
+ * from the SIMD mask even when the rest of RetroArch is built for
+ * plain SSE2. They reuse the SSE2 helpers below. */
+#if defined(__SSE2__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define PIXCONV_TARGET_ATTRIBUTES
+#endif
+
+#if defined(__SSE2__) && defined(__SSSE3__)
+#define PIXCONV_SSSE3
+#define PIXCONV_SSSE3_TARGET
+#elif defined(PIXCONV_TARGET_ATTRIBUTES)
+#define PIXCONV_SSSE3
+#define PIXCONV_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
+#if defined(__SSE2__) && defined(__AVX2__)
+#define PIXCONV_AVX2
+#define PIXCONV_AVX2_TARGET
+#elif defined(PIXCONV_TARGET_ATTRIBUTES)
+#define PIXCONV_AVX2
+#define PIXCONV_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef PIXCONV_SSSE3
+#include <tmmintrin.h>
+#endif
+
+#ifdef PIXCONV_AVX2
+#include <immintrin.h>
+#endif
+
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS) && !defined(SCALER_NO_SIMD)
+#define PIXCONV_NEON
+#include <arm_neon.h>
+#endif
+
+/* The SIMD kernels convert as many whole vectors of a line as
+ * fit and return the number of pixels they did, the C loops of
+ * the conv_*() functions take care of the rest. */
+typedef int (*pixconv_kernel_t)(void *output, const void *input, int width);
+
+enum pixconv_kernel
+{
+   PIXCONV_0RGB1555_ARGB8888 = 0,
+   PIXCONV_0RGB1555_RGB565,
+   PIXCONV_RGB565_0RGB1555,
+   PIXCONV_RGB565_ABGR8888,
+   PIXCONV_RGB565_ARGB8888,
+   PIXCONV_RGBA4444_ARGB8888,
+   PIXCONV_RGBA4444_RGB565,
+   PIXCONV_BGR24_ARGB8888,
+   PIXCONV_BGR24_RGB565,
+   PIXCONV_ARGB8888_0RGB1555,
+   PIXCONV_ARGB8888_RGBA4444,
+   PIXCONV_ARGB8888_RGB565,
+   PIXCONV_ARGB8888_BGR24,
+   PIXCONV_ABGR8888_BGR24,
+   PIXCONV_ARGB8888_ABGR8888,
+   PIXCONV_0RGB1555_BGR24,
+   PIXCONV_RGB565_BGR24,
+   PIXCONV_YUYV_ARGB8888,
+
+   PIXCONV_KERNEL_LAST
+};
+
+#define YUV_SHIFT 6
+#define YUV_OFFSET (1 << (YUV_SHIFT - 1))
+#define YUV_MAT_Y (1 << 6)
+#define YUV_MAT_U_G (-22)
+#define YUV_MAT_U_B (113)
+#define YUV_MAT_V_R (90)
+#define YUV_MAT_V_G (-46)
+
+#if defined(__SSE2__)
+/* Splits 8 pixels into their channels, expanded to
+ * 8 bits and held in 16-bit lanes. */
+static INLINE void pixconv_unpack_rgb565_sse2(__m128i in,
+      __m128i *r, __m128i *g, __m128i *b)
+{
+   *r = _mm_mulhi_epi16(_mm_and_si128(_mm_srli_epi16(in, 1),
+            _mm_set1_epi16(0x1f << 10)), _mm_set1_epi16(0x0210));
+   *g = _mm_mulhi_epi16(_mm_and_si128(in,
+            _mm_set1_epi16(0x3f << 5)), _mm_set1_epi16(0x2080));
+   *b = _mm_mulhi_epi16(_mm_and_si128(_mm_slli_epi16(in, 5),
+            _mm_set1_epi16(0x1f << 5)), _mm_set1_epi16(0x4200));
+}
+
+static INLINE void pixconv_unpack_0rgb1555_sse2(__m128i in,
+      __m128i *r, __m128i *g, __m128i *b)
+{
+   *r = _mm_mulhi_epi16(_mm_and_si128(in,
+            _mm_set1_epi16(0x1f << 10)), _mm_set1_epi16(0x0210));
+   *g = _mm_mulhi_epi16(_mm_and_si128(in,
+            _mm_set1_epi16(0x1f << 5)), _mm_set1_epi16(0x4200));
+   *b = _mm_mulhi_epi16(_mm_and_si128(_mm_slli_epi16(in, 5),
+            _mm_set1_epi16(0x1f << 5)), _mm_set1_epi16(0x4200));
+}
+
+/* Interleaves 8 pixels worth of channels from 16-bit lanes
+ * into 32-bit (a << 24) | (r << 16) | (g << 8) | b pixels. */
+static INLINE void pixconv_pack_argb_sse2(__m128i b, __m128i g,
+      __m128i r, __m128i a, __m128i *lo, __m128i *hi)
+{
+   *lo = _mm_or_si128(_mm_unpacklo_epi8(b, g),
+         _mm_slli_si128(_mm_unpacklo_epi8(r, a), 2));
+   *hi = _mm_or_si128(_mm_unpackhi_epi8(b, g),
+         _mm_slli_si128(_mm_unpackhi_epi8(r, a), 2));
+}
+
+/* Packs the low 16 bits of 8 32-bit lanes. */
+static INLINE __m128i pixconv_pack_epi32_sse2(__m128i lo, __m128i hi)
+{
+   return _mm_packs_epi32(
+         _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16),
+         _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+}
+
+static INLINE __m128i pixconv_argb8888_rgb565_sse2(__m128i c)
+{
+   return _mm_or_si128(
+         _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0xf800)),
+         _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(c, 5), _mm_set1_epi32(0x07e0)),
+            _mm_and_si128(_mm_srli_epi32(c, 3), _mm_set1_epi32(0x001f))));
+}
+
+static INLINE __m128i pixconv_argb8888_0rgb1555_sse2(__m128i c)
+{
+   return _mm_or_si128(
+         _mm_and_si128(_mm_srli_epi32(c, 9), _mm_set1_epi32(0x7c00)),
+         _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(c, 6), _mm_set1_epi32(0x03e0)),
+            _mm_and_si128(_mm_srli_epi32(c, 3), _mm_set1_epi32(0x001f))));
+}
+
+static INLINE __m128i pixconv_argb8888_rgba4444_sse2(__m128i c)
+{
+   return _mm_or_si128(
+         _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0xf000)),
+            _mm_and_si128(_mm_srli_epi32(c, 4), _mm_set1_epi32(0x0f00))),
+         _mm_or_si128(
+            _mm_and_si128(c, _mm_set1_epi32(0x00f0)),
+            _mm_srli_epi32(c, 28)));
+}
+
+/* Expands 8 RGBA4444 pixels into 8-bit channels in 16-bit lanes */
+static INLINE void pixconv_unpack_rgba4444_sse2(__m128i in,
+      __m128i *r, __m128i *g, __m128i *b, __m128i *a)
+{
+   const __m128i mask = _mm_set1_epi16(0xf);
+   __m128i r4         = _mm_srli_epi16(in, 12);
+   __m128i g4         = _mm_and_si128(_mm_srli_epi16(in, 8), mask);
+   __m128i b4         = _mm_and_si128(_mm_srli_epi16(in, 4), mask);
+   __m128i a4         = _mm_and_si128(in, mask);
+   *r                 = _mm_or_si128(r4, _mm_slli_epi16(r4, 4));
+   *g                 = _mm_or_si128(g4, _mm_slli_epi16(g4, 4));
+   *b                 = _mm_or_si128(b4, _mm_slli_epi16(b4, 4));
+   *a                 = _mm_or_si128(a4, _mm_slli_epi16(a4, 4));
+}
+
+/* :( TODO: Make this saner. */
+static INLINE void store_bgr24_sse2(void *output, __m128i a,
+      __m128i b, __m128i c, __m128i d)
+{
+   const __m128i mask_0 = _mm_set_epi32(0, 0, 0, 0x00ffffff);
+   const __m128i mask_1 = _mm_set_epi32(0, 0, 0x00ffffff, 0);
+   const __m128i mask_2 = _mm_set_epi32(0, 0x00ffffff, 0, 0);
+   const __m128i mask_3 = _mm_set_epi32(0x00ffffff, 0, 0, 0);
+
+   __m128i a0 = _mm_and_si128(a, mask_0);
+   __m128i a1 = _mm_srli_si128(_mm_and_si128(a, mask_1),  1);
+   __m128i a2 = _mm_srli_si128(_mm_and_si128(a, mask_2),  2);
+   __m128i a3 = _mm_srli_si128(_mm_and_si128(a, mask_3),  3);
+   __m128i a4 = _mm_slli_si128(_mm_and_si128(b, mask_0), 12);
+   __m128i a5 = _mm_slli_si128(_mm_and_si128(b, mask_1), 11);
+
+   __m128i b0 = _mm_srli_si128(_mm_and_si128(b, mask_1), 5);
+   __m128i b1 = _mm_srli_si128(_mm_and_si128(b, mask_2), 6);
+   __m128i b2 = _mm_srli_si128(_mm_and_si128(b, mask_3), 7);
+   __m128i b3 = _mm_slli_si128(_mm_and_si128(c, mask_0), 8);
+   __m128i b4 = _mm_slli_si128(_mm_and_si128(c, mask_1), 7);
+   __m128i b5 = _mm_slli_si128(_mm_and_si128(c, mask_2), 6);
+
+   __m128i c0 = _mm_srli_si128(_mm_and_si128(c, mask_2), 10);
+   __m128i c1 = _mm_srli_si128(_mm_and_si128(c, mask_3), 11);
+   __m128i c2 = _mm_slli_si128(_mm_and_si128(d, mask_0),  4);
+   __m128i c3 = _mm_slli_si128(_mm_and_si128(d, mask_1),  3);
+   __m128i c4 = _mm_slli_si128(_mm_and_si128(d, mask_2),  2);
+   __m128i c5 = _mm_slli_si128(_mm_and_si128(d, mask_3),  1);
+
+   __m128i *out = (__m128i*)output;
+
+   _mm_storeu_si128(out + 0,
+         _mm_or_si128(a0, _mm_or_si128(a1, _mm_or_si128(a2,
+                  _mm_or_si128(a3, _mm_or_si128(a4, a5))))));
+
+   _mm_storeu_si128(out + 1,
+         _mm_or_si128(b0, _mm_or_si128(b1, _mm_or_si128(b2,
+                  _mm_or_si128(b3, _mm_or_si128(b4, b5))))));
+
+   _mm_storeu_si128(out + 2,
+         _mm_or_si128(c0, _mm_or_si128(c1, _mm_or_si128(c2,
+                  _mm_or_si128(c3, _mm_or_si128(c4, c5))))));
+}
+
+static INLINE __m128i conv_shuffle_rb_epi32(__m128i c)
+{
+   const __m128i b_mask = _mm_set1_epi32(0x000000ff);
+   const __m128i g_mask = _mm_set1_epi32(0x0000ff00);
+   const __m128i r_mask = _mm_set1_epi32(0x00ff0000);
+   __m128i sl = _mm_and_si128(_mm_slli_epi32(c, 16), r_mask);
+   __m128i sr = _mm_and_si128(_mm_srli_epi32(c, 16), b_mask);
+   __m128i g  = _mm_and_si128(c, g_mask);
+   __m128i rb = _mm_or_si128(sl, sr);
+   return _mm_or_si128(g, rb);
+}
+
+static int conv_rgb565_0rgb1555_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   const __m128i hi_mask   = _mm_set1_epi16(0x7fe0);
+   const __m128i lo_mask   = _mm_set1_epi16(0x1f);
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 1), hi_mask);
+      __m128i lo = _mm_and_si128(in, lo_mask);
+      _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
+   }
+
+   return w;
+}
+
+static int conv_0rgb1555_rgb565_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   const __m128i hi_mask   = _mm_set1_epi16(
+         (int16_t)((0x1f << 11) | (0x1f << 6)));
+   const __m128i lo_mask   = _mm_set1_epi16(0x1f);
+   const __m128i glow_mask = _mm_set1_epi16(1 << 5);
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i rg   = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
+      __m128i b    = _mm_and_si128(in, lo_mask);
+      __m128i glow = _mm_and_si128(_mm_srli_epi16(in, 4), glow_mask);
+      _mm_storeu_si128((__m128i*)(output + w),
+            _mm_or_si128(rg, _mm_or_si128(b, glow)));
+   }
+
+   return w;
+}
+
+static int conv_0rgb1555_argb8888_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m128i a       = _mm_set1_epi16(0x00ff);
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      __m128i r, g, b, res_lo, res_hi;
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+
+      pixconv_unpack_0rgb1555_sse2(in, &r, &g, &b);
+      pixconv_pack_argb_sse2(b, g, r, a, &res_lo, &res_hi);
+
+      _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+      _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+   }
+
+   return w;
+}
+
+static int conv_rgb565_argb8888_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m128i a       = _mm_set1_epi16(0x00ff);
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      __m128i r, g, b, res_lo, res_hi;
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+
+      pixconv_unpack_rgb565_sse2(in, &r, &g, &b);
+      pixconv_pack_argb_sse2(b, g, r, a, &res_lo, &res_hi);
+
+      _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+      _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+   }
+
+   return w;
+}
+
+static int conv_rgb565_abgr8888_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m128i a       = _mm_set1_epi16(0x00ff);
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      __m128i r, g, b, res_lo, res_hi;
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+
+      pixconv_unpack_rgb565_sse2(in, &r, &g, &b);
+      pixconv_pack_argb_sse2(r, g, b, a, &res_lo, &res_hi);
+
+      _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+      _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+   }
+
+   return w;
+}
+
+static int conv_rgba4444_argb8888_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      __m128i r, g, b, a, res_lo, res_hi;
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+
+      pixconv_unpack_rgba4444_sse2(in, &r, &g, &b, &a);
+      pixconv_pack_argb_sse2(b, g, r, a, &res_lo, &res_hi);
+
+      _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+      _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+   }
+
+   return w;
+}
+
+static int conv_rgba4444_rgb565_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m128i r_mask  = _mm_set1_epi16((int16_t)0xf000);
+   const __m128i g_mask  = _mm_set1_epi16(0x0780);
+   const __m128i b_mask  = _mm_set1_epi16(0x001e);
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i r        = _mm_and_si128(in, r_mask);
+      __m128i g        = _mm_and_si128(_mm_srli_epi16(in, 1), g_mask);
+      __m128i b        = _mm_and_si128(_mm_srli_epi16(in, 3), b_mask);
+      _mm_storeu_si128((__m128i*)(output + w),
+            _mm_or_si128(r, _mm_or_si128(g, b)));
+   }
+
+   return w;
+}
+
+static int conv_argb8888_0rgb1555_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      __m128i lo = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      __m128i hi = _mm_loadu_si128((const __m128i*)(input + w + 4));
+      _mm_storeu_si128((__m128i*)(output + w), pixconv_pack_epi32_sse2(
+               pixconv_argb8888_0rgb1555_sse2(lo),
+               pixconv_argb8888_0rgb1555_sse2(hi)));
+   }
+
+   return w;
+}
+
+static int conv_argb8888_rgba4444_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      __m128i lo = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      __m128i hi = _mm_loadu_si128((const __m128i*)(input + w + 4));
+      _mm_storeu_si128((__m128i*)(output + w), pixconv_pack_epi32_sse2(
+               pixconv_argb8888_rgba4444_sse2(lo),
+               pixconv_argb8888_rgba4444_sse2(hi)));
+   }
+
+   return w;
+}
+
+static int conv_argb8888_rgb565_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      __m128i lo = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      __m128i hi = _mm_loadu_si128((const __m128i*)(input + w + 4));
+      _mm_storeu_si128((__m128i*)(output + w), pixconv_pack_epi32_sse2(
+               pixconv_argb8888_rgb565_sse2(lo),
+               pixconv_argb8888_rgb565_sse2(hi)));
+   }
+
+   return w;
+}
+
+static int conv_argb8888_bgr24_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i l0 = _mm_loadu_si128((const __m128i*)(input + w +  0));
+      __m128i l1 = _mm_loadu_si128((const __m128i*)(input + w +  4));
+      __m128i l2 = _mm_loadu_si128((const __m128i*)(input + w +  8));
+      __m128i l3 = _mm_loadu_si128((const __m128i*)(input + w + 12));
+      store_bgr24_sse2(out, l0, l1, l2, l3);
+   }
+
+   return w;
+}
+
+static int conv_abgr8888_bgr24_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i a = _mm_loadu_si128((const __m128i*)(input + w +  0));
+      __m128i b = _mm_loadu_si128((const __m128i*)(input + w +  4));
+      __m128i c = _mm_loadu_si128((const __m128i*)(input + w +  8));
+      __m128i d = _mm_loadu_si128((const __m128i*)(input + w + 12));
+      a = conv_shuffle_rb_epi32(a);
+      b = conv_shuffle_rb_epi32(b);
+      c = conv_shuffle_rb_epi32(c);
+      d = conv_shuffle_rb_epi32(d);
+      store_bgr24_sse2(out, a, b, c, d);
+   }
+
+   return w;
+}
+
+static int conv_argb8888_abgr8888_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m128i ag_mask = _mm_set1_epi32((int)0xff00ff00);
+   const __m128i r_mask  = _mm_set1_epi32(0x00ff0000);
+   const __m128i b_mask  = _mm_set1_epi32(0x000000ff);
+
+   for (w = 0; w + 4 <= width; w += 4)
+   {
+      __m128i c  = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i ag = _mm_and_si128(c, ag_mask);
+      __m128i r  = _mm_and_si128(_mm_slli_epi32(c, 16), r_mask);
+      __m128i b  = _mm_and_si128(_mm_srli_epi32(c, 16), b_mask);
+      _mm_storeu_si128((__m128i*)(output + w),
+            _mm_or_si128(ag, _mm_or_si128(r, b)));
+   }
+
+   return w;
+}
+
+static int conv_0rgb1555_bgr24_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+   const __m128i a       = _mm_set1_epi16(0x00ff);
+
+   for (w = 0; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i r0, g0, b0, r1, g1, b1;
+      __m128i res_lo0, res_hi0, res_lo1, res_hi1;
+      const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
+
+      pixconv_unpack_0rgb1555_sse2(in0, &r0, &g0, &b0);
+      pixconv_unpack_0rgb1555_sse2(in1, &r1, &g1, &b1);
+      pixconv_pack_argb_sse2(b0, g0, r0, a, &res_lo0, &res_hi0);
+      pixconv_pack_argb_sse2(b1, g1, r1, a, &res_lo1, &res_hi1);
+
+      /* Non-POT pixel sizes for the loss */
+      store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
+   }
+
+   return w;
+}
+
+static int conv_rgb565_bgr24_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+   const __m128i a       = _mm_set1_epi16(0x00ff);
+
+   for (w = 0; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i r0, g0, b0, r1, g1, b1;
+      __m128i res_lo0, res_hi0, res_lo1, res_hi1;
+      const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
+
+      pixconv_unpack_rgb565_sse2(in0, &r0, &g0, &b0);
+      pixconv_unpack_rgb565_sse2(in1, &r1, &g1, &b1);
+      pixconv_pack_argb_sse2(b0, g0, r0, a, &res_lo0, &res_hi0);
+      pixconv_pack_argb_sse2(b1, g1, r1, a, &res_lo1, &res_hi1);
+
+      store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
+   }
+
+   return w;
+}
+
+/* Converts 16 pixels to ARGB8888. Luma for pixels 0-7 and 8-15
+ * is held in @y0 and @y1, the 8 horizontally subsampled chroma
+ * pairs in @u and @v, all as unsigned 16-bit lanes. */
+static INLINE void pixconv_yuv_argb8888_sse2(uint32_t *dst,
+      __m128i _y0, __m128i _y1, __m128i u, __m128i v)
+{
+   __m128i u0, u1, v0, v1, u0_g, u1_g, u0_b, u1_b, v0_r, v1_r, v0_g, v1_g,
+           r0, g0, b0, r1, g1, b1;
+   __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+   __m128i res0, res1, res2, res3;
+   const __m128i chroma_offset = _mm_set1_epi16(128);
+   const __m128i round_offset  = _mm_set1_epi16(YUV_OFFSET);
+   const __m128i yuv_mul       = _mm_set1_epi16(YUV_MAT_Y);
+   const __m128i u_g_mul       = _mm_set1_epi16(YUV_MAT_U_G);
+   const __m128i u_b_mul       = _mm_set1_epi16(YUV_MAT_U_B);
+   const __m128i v_r_mul       = _mm_set1_epi16(YUV_MAT_V_R);
+   const __m128i v_g_mul       = _mm_set1_epi16(YUV_MAT_V_G);
+   const __m128i a             = _mm_cmpeq_epi16(
+         _mm_setzero_si128(), _mm_setzero_si128());
+
+   /* Apply YUV offsets (U, V) -= (-128, -128). */
+   u = _mm_sub_epi16(u, chroma_offset);
+   v = _mm_sub_epi16(v, chroma_offset);
+
+   /* Upscale chroma horizontally (nearest). */
+   u0 = _mm_unpacklo_epi16(u, u);
+   u1 = _mm_unpackhi_epi16(u, u);
+   v0 = _mm_unpacklo_epi16(v, v);
+   v1 = _mm_unpackhi_epi16(v, v);
+
+   /* Apply transformations. */
+   _y0 = _mm_mullo_epi16(_y0, yuv_mul);
+   _y1 = _mm_mullo_epi16(_y1, yuv_mul);
+   u0_g   = _mm_mullo_epi16(u0, u_g_mul);
+   u1_g   = _mm_mullo_epi16(u1, u_g_mul);
+   u0_b   = _mm_mullo_epi16(u0, u_b_mul);
+   u1_b   = _mm_mullo_epi16(u1, u_b_mul);
+   v0_r   = _mm_mullo_epi16(v0, v_r_mul);
+   v1_r   = _mm_mullo_epi16(v1, v_r_mul);
+   v0_g   = _mm_mullo_epi16(v0, v_g_mul);
+   v1_g   = _mm_mullo_epi16(v1, v_g_mul);
+
+   /* Add contibutions from the transformed components. */
+   r0 = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(_y0, v0_r),
+            round_offset), YUV_SHIFT);
+   g0 = _mm_srai_epi16(_mm_adds_epi16(
+            _mm_adds_epi16(_mm_adds_epi16(_y0, v0_g), u0_g), round_offset), YUV_SHIFT);
+   b0 = _mm_srai_epi16(_mm_adds_epi16(
+            _mm_adds_epi16(_y0, u0_b), round_offset), YUV_SHIFT);
+
+   r1 = _mm_srai_epi16(_mm_adds_epi16(
+            _mm_adds_epi16(_y1, v1_r), round_offset), YUV_SHIFT);
+   g1 = _mm_srai_epi16(_mm_adds_epi16(
+            _mm_adds_epi16(_mm_adds_epi16(_y1, v1_g), u1_g), round_offset), YUV_SHIFT);
+   b1 = _mm_srai_epi16(_mm_adds_epi16(
+            _mm_adds_epi16(_y1, u1_b), round_offset), YUV_SHIFT);
+
+   /* Saturate into 8-bit. */
+   r0 = _mm_packus_epi16(r0, r1);
+   g0 = _mm_packus_epi16(g0, g1);
+   b0 = _mm_packus_epi16(b0, b1);
+
+   /* Interleave into ARGB. */
+   res_lo_bg = _mm_unpacklo_epi8(b0, g0);
+   res_hi_bg = _mm_unpackhi_epi8(b0, g0);
+   res_lo_ra = _mm_unpacklo_epi8(r0, a);
+   res_hi_ra = _mm_unpackhi_epi8(r0, a);
+   res0 = _mm_unpacklo_epi16(res_lo_bg, res_lo_ra);
+   res1 = _mm_unpackhi_epi16(res_lo_bg, res_lo_ra);
+   res2 = _mm_unpacklo_epi16(res_hi_bg, res_hi_ra);
+   res3 = _mm_unpackhi_epi16(res_hi_bg, res_hi_ra);
+
+   _mm_storeu_si128((__m128i*)(dst +  0), res0);
+   _mm_storeu_si128((__m128i*)(dst +  4), res1);
+   _mm_storeu_si128((__m128i*)(dst +  8), res2);
+   _mm_storeu_si128((__m128i*)(dst + 12), res3);
+}
+
+static int conv_yuyv_argb8888_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint8_t *src          = (const uint8_t*)input_;
+   uint32_t *dst               = (uint32_t*)output_;
+   const __m128i mask_y        = _mm_set1_epi16(0xffu);
+   const __m128i mask_u        = _mm_set1_epi32(0xffu << 8);
+   const __m128i mask_v        = _mm_set1_epi32(0xffu << 24);
+
+   /* Each loop processes 16 pixels. */
+   for (w = 0; w + 16 <= width; w += 16, src += 32, dst += 16)
+   {
+      __m128i yuv0 = _mm_loadu_si128((const __m128i*)(src +  0)); /* [Y0, U0, Y1, V0, Y2, U1, Y3, V1, ...] */
+      __m128i yuv1 = _mm_loadu_si128((const __m128i*)(src + 16)); /* [Y0, U0, Y1, V0, Y2, U1, Y3, V1, ...] */
+
+      __m128i _y0 = _mm_and_si128(yuv0, mask_y); /* [Y0, Y1, Y2, ...] (16-bit) */
+      __m128i u0 = _mm_and_si128(yuv0, mask_u); /* [0, U0, 0, 0, 0, U1, 0, 0, ...] */
+      __m128i v0 = _mm_and_si128(yuv0, mask_v); /* [0, 0, 0, V1, 0, , 0, V1, ...] */
+      __m128i _y1 = _mm_and_si128(yuv1, mask_y); /* [Y0, Y1, Y2, ...] (16-bit) */
+      __m128i u1 = _mm_and_si128(yuv1, mask_u); /* [0, U0, 0, 0, 0, U1, 0, 0, ...] */
+      __m128i v1 = _mm_and_si128(yuv1, mask_v); /* [0, 0, 0, V1, 0, , 0, V1, ...] */
+
+      /* Juggle around to get U and V in the same 16-bit format as Y. */
+      u0 = _mm_srli_si128(u0, 1);
+      v0 = _mm_srli_si128(v0, 3);
+      u1 = _mm_srli_si128(u1, 1);
+      v1 = _mm_srli_si128(v1, 3);
+
+      pixconv_yuv_argb8888_sse2(dst, _y0, _y1,
+            _mm_packs_epi32(u0, u1), _mm_packs_epi32(v0, v1));
+   }
+
+   return w;
+}
+
+static int conv_nv12_argb8888_sse2(uint32_t *dst,
+      const uint8_t *src_y, const uint8_t *src_uv, int width)
+{
+   int w;
+   const __m128i zero   = _mm_setzero_si128();
+   const __m128i mask_u = _mm_set1_epi16(0xffu);
+
+   /* Each loop processes 16 pixels. */
+   for (w = 0; w + 16 <= width; w += 16, src_y += 16, src_uv += 16, dst += 16)
+   {
+      __m128i y  = _mm_loadu_si128((const __m128i*)src_y);  /* [Y0, Y1, Y2, ...] */
+      __m128i uv = _mm_loadu_si128((const __m128i*)src_uv); /* [U0, V0, U1, V1, ...] */
+
+      pixconv_yuv_argb8888_sse2(dst,
+            _mm_unpacklo_epi8(y, zero), _mm_unpackhi_epi8(y, zero),
+            _mm_and_si128(uv, mask_u), _mm_srli_epi16(uv, 8));
+   }
+
+   return w;
+}
+#elif defined(__MMX__)
+static int conv_rgb565_argb8888_mmx(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input  = (const uint16_t*)input_;
+   uint32_t *output       = (uint32_t*)output_;
+   const __m64 pix_mask_r = _mm_set1_pi16(0x1f << 10);
+   const __m64 pix_mask_g = _mm_set1_pi16(0x3f << 5);
+   const __m64 pix_mask_b = _mm_set1_pi16(0x1f << 5);
+   const __m64 mul16_r    = _mm_set1_pi16(0x0210);
+   const __m64 mul16_g    = _mm_set1_pi16(0x2080);
+   const __m64 mul16_b    = _mm_set1_pi16(0x4200);
+   const __m64 a          = _mm_set1_pi16(0x00ff);
+
+   for (w = 0; w + 4 <= width; w += 4)
+   {
+      __m64 res_lo, res_hi;
+      __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      const __m64 in = *((__m64*)(input + w));
+      __m64          r = _mm_and_si64(_mm_srli_pi16(in, 1), pix_mask_r);
+      __m64          g = _mm_and_si64(in, pix_mask_g);
+      __m64          b = _mm_and_si64(_mm_slli_pi16(in, 5), pix_mask_b);
+
+      r                = _mm_mulhi_pi16(r, mul16_r);
+      g                = _mm_mulhi_pi16(g, mul16_g);
+      b                = _mm_mulhi_pi16(b, mul16_b);
+
+      res_lo_bg        = _mm_unpacklo_pi8(b, g);
+      res_hi_bg        = _mm_unpackhi_pi8(b, g);
+      res_lo_ra        = _mm_unpacklo_pi8(r, a);
+      res_hi_ra        = _mm_unpackhi_pi8(r, a);
+
+      res_lo           = _mm_or_si64(res_lo_bg,
+            _mm_slli_si64(res_lo_ra, 16));
+      res_hi           = _mm_or_si64(res_hi_bg,
+            _mm_slli_si64(res_hi_ra, 16));
+
+      *((__m64*)(output + w + 0)) = res_lo;
+      *((__m64*)(output + w + 2)) = res_hi;
+   }
+
+   _mm_empty();
+   return w;
+}
+
+static int conv_rgba4444_argb8888_mmx(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input  = (const uint16_t*)input_;
+   uint32_t *output       = (uint32_t*)output_;
+   const __m64 pix_mask_r = _mm_set1_pi16(0xf << 10);
+   const __m64 pix_mask_g = _mm_set1_pi16(0xf << 8);
+   const __m64 pix_mask_b = _mm_set1_pi16(0xf << 8);
+   const __m64 mul16_r    = _mm_set1_pi16(0x0440);
+   const __m64 mul16_g    = _mm_set1_pi16(0x1100);
+   const __m64 mul16_b    = _mm_set1_pi16(0x1100);
+   const __m64 a          = _mm_set1_pi16(0x00ff);
+
+   for (w = 0; w + 4 <= width; w += 4)
+   {
+      __m64 res_lo, res_hi;
+      __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      const __m64 in = *((__m64*)(input + w));
+      __m64          r = _mm_and_si64(_mm_srli_pi16(in, 2), pix_mask_r);
+      __m64          g = _mm_and_si64(in, pix_mask_g);
+      __m64          b = _mm_and_si64(_mm_slli_pi16(in, 4), pix_mask_b);
+
+      r                = _mm_mulhi_pi16(r, mul16_r);
+      g                = _mm_mulhi_pi16(g, mul16_g);
+      b                = _mm_mulhi_pi16(b, mul16_b);
+
+      res_lo_bg        = _mm_unpacklo_pi8(b, g);
+      res_hi_bg        = _mm_unpackhi_pi8(b, g);
+      res_lo_ra        = _mm_unpacklo_pi8(r, a);
+      res_hi_ra        = _mm_unpackhi_pi8(r, a);
+
+      res_lo           = _mm_or_si64(res_lo_bg,
+            _mm_slli_si64(res_lo_ra, 16));
+      res_hi           = _mm_or_si64(res_hi_bg,
+            _mm_slli_si64(res_hi_ra, 16));
+
+      *((__m64*)(output + w + 0)) = res_lo;
+      *((__m64*)(output + w + 2)) = res_hi;
+   }
+
+   _mm_empty();
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_SSSE3
+/* Packs 16 pixels of 32 bits into 48 bytes of 24-bit pixels,
+ * @shuf picks the three bytes to keep out of each pixel. */
+PIXCONV_SSSE3_TARGET
+static INLINE void pixconv_store_bgr24_ssse3(uint8_t *out, __m128i a,
+      __m128i b, __m128i c, __m128i d, __m128i shuf)
+{
+   __m128i p0 = _mm_shuffle_epi8(a, shuf);
+   __m128i p1 = _mm_shuffle_epi8(b, shuf);
+   __m128i p2 = _mm_shuffle_epi8(c, shuf);
+   __m128i p3 = _mm_shuffle_epi8(d, shuf);
+
+   _mm_storeu_si128((__m128i*)(out +  0),
+         _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+   _mm_storeu_si128((__m128i*)(out + 16),
+         _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+   _mm_storeu_si128((__m128i*)(out + 32),
+         _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+}
+
+/* Expands 48 bytes of BGR24 into 16 pixels of 0RGB8888 */
+PIXCONV_SSSE3_TARGET
+static INLINE void pixconv_load_bgr24_ssse3(const uint8_t *in, __m128i *p)
+{
+   const __m128i shuf = _mm_setr_epi8(
+         0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+   __m128i x0         = _mm_loadu_si128((const __m128i*)(in +  0));
+   __m128i x1         = _mm_loadu_si128((const __m128i*)(in + 16));
+   __m128i x2         = _mm_loadu_si128((const __m128i*)(in + 32));
+
+   p[0]               = _mm_shuffle_epi8(x0, shuf);
+   p[1]               = _mm_shuffle_epi8(_mm_alignr_epi8(x1, x0, 12), shuf);
+   p[2]               = _mm_shuffle_epi8(_mm_alignr_epi8(x2, x1, 8), shuf);
+   p[3]               = _mm_shuffle_epi8(_mm_srli_si128(x2, 4), shuf);
+}
+
+PIXCONV_SSSE3_TARGET
+static int conv_bgr24_argb8888_ssse3(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint8_t *input = (const uint8_t*)input_;
+   uint32_t *output     = (uint32_t*)output_;
+   const __m128i a      = _mm_set1_epi32((int)0xff000000);
+
+   for (w = 0; w + 16 <= width; w += 16, input += 48)
+   {
+      __m128i p[4];
+      pixconv_load_bgr24_ssse3(input, p);
+      _mm_storeu_si128((__m128i*)(output + w +  0), _mm_or_si128(p[0], a));
+      _mm_storeu_si128((__m128i*)(output + w +  4), _mm_or_si128(p[1], a));
+      _mm_storeu_si128((__m128i*)(output + w +  8), _mm_or_si128(p[2], a));
+      _mm_storeu_si128((__m128i*)(output + w + 12), _mm_or_si128(p[3], a));
+   }
+
+   return w;
+}
+
+PIXCONV_SSSE3_TARGET
+static int conv_bgr24_rgb565_ssse3(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint8_t *input = (const uint8_t*)input_;
+   uint16_t *output     = (uint16_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16, input += 48)
+   {
+      __m128i p[4];
+      pixconv_load_bgr24_ssse3(input, p);
+      _mm_storeu_si128((__m128i*)(output + w + 0), pixconv_pack_epi32_sse2(
+               pixconv_argb8888_rgb565_sse2(p[0]),
+               pixconv_argb8888_rgb565_sse2(p[1])));
+      _mm_storeu_si128((__m128i*)(output + w + 8), pixconv_pack_epi32_sse2(
+               pixconv_argb8888_rgb565_sse2(p[2]),
+               pixconv_argb8888_rgb565_sse2(p[3])));
+   }
+
+   return w;
+}
+
+PIXCONV_SSSE3_TARGET
+static int conv_argb8888_bgr24_ssse3(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+   const __m128i shuf    = _mm_setr_epi8(
+         0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+   for (w = 0; w + 16 <= width; w += 16, out += 48)
+      pixconv_store_bgr24_ssse3(out,
+            _mm_loadu_si128((const __m128i*)(input + w +  0)),
+            _mm_loadu_si128((const __m128i*)(input + w +  4)),
+            _mm_loadu_si128((const __m128i*)(input + w +  8)),
+            _mm_loadu_si128((const __m128i*)(input + w + 12)), shuf);
+
+   return w;
+}
+
+PIXCONV_SSSE3_TARGET
+static int conv_abgr8888_bgr24_ssse3(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+   const __m128i shuf    = _mm_setr_epi8(
+         2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+   for (w = 0; w + 16 <= width; w += 16, out += 48)
+      pixconv_store_bgr24_ssse3(out,
+            _mm_loadu_si128((const __m128i*)(input + w +  0)),
+            _mm_loadu_si128((const __m128i*)(input + w +  4)),
+            _mm_loadu_si128((const __m128i*)(input + w +  8)),
+            _mm_loadu_si128((const __m128i*)(input + w + 12)), shuf);
+
+   return w;
+}
+
+PIXCONV_SSSE3_TARGET
+static int conv_argb8888_abgr8888_ssse3(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m128i shuf    = _mm_setr_epi8(
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+   for (w = 0; w + 4 <= width; w += 4)
+      _mm_storeu_si128((__m128i*)(output + w), _mm_shuffle_epi8(
+               _mm_loadu_si128((const __m128i*)(input + w)), shuf));
+
+   return w;
+}
+
+PIXCONV_SSSE3_TARGET
+static int conv_0rgb1555_bgr24_ssse3(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+   const __m128i a       = _mm_setzero_si128();
+   const __m128i shuf    = _mm_setr_epi8(
+         0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+   for (w = 0; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i r0, g0, b0, r1, g1, b1;
+      __m128i res_lo0, res_hi0, res_lo1, res_hi1;
+      const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
+
+      pixconv_unpack_0rgb1555_sse2(in0, &r0, &g0, &b0);
+      pixconv_unpack_0rgb1555_sse2(in1, &r1, &g1, &b1);
+      pixconv_pack_argb_sse2(b0, g0, r0, a, &res_lo0, &res_hi0);
+      pixconv_pack_argb_sse2(b1, g1, r1, a, &res_lo1, &res_hi1);
+      pixconv_store_bgr24_ssse3(out, res_lo0, res_hi0, res_lo1, res_hi1, shuf);
+   }
+
+   return w;
+}
+
+PIXCONV_SSSE3_TARGET
+static int conv_rgb565_bgr24_ssse3(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+   const __m128i a       = _mm_setzero_si128();
+   const __m128i shuf    = _mm_setr_epi8(
+         0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+   for (w = 0; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i r0, g0, b0, r1, g1, b1;
+      __m128i res_lo0, res_hi0, res_lo1, res_hi1;
+      const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
+
+      pixconv_unpack_rgb565_sse2(in0, &r0, &g0, &b0);
+      pixconv_unpack_rgb565_sse2(in1, &r1, &g1, &b1);
+      pixconv_pack_argb_sse2(b0, g0, r0, a, &res_lo0, &res_hi0);
+      pixconv_pack_argb_sse2(b1, g1, r1, a, &res_lo1, &res_hi1);
+      pixconv_store_bgr24_ssse3(out, res_lo0, res_hi0, res_lo1, res_hi1, shuf);
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_AVX2
+/* 256-bit versions of the SSE2 helpers, 16 pixels at a time.
+ * The unpacks work within 128-bit lanes, so the results are
+ * put back in order before storing. */
+PIXCONV_AVX2_TARGET
+static INLINE void pixconv_unpack_rgb565_avx2(__m256i in,
+      __m256i *r, __m256i *g, __m256i *b)
+{
+   *r = _mm256_mulhi_epi16(_mm256_and_si256(_mm256_srli_epi16(in, 1),
+            _mm256_set1_epi16(0x1f << 10)), _mm256_set1_epi16(0x0210));
+   *g = _mm256_mulhi_epi16(_mm256_and_si256(in,
+            _mm256_set1_epi16(0x3f << 5)), _mm256_set1_epi16(0x2080));
+   *b = _mm256_mulhi_epi16(_mm256_and_si256(_mm256_slli_epi16(in, 5),
+            _mm256_set1_epi16(0x1f << 5)), _mm256_set1_epi16(0x4200));
+}
+
+PIXCONV_AVX2_TARGET
+static INLINE void pixconv_unpack_0rgb1555_avx2(__m256i in,
+      __m256i *r, __m256i *g, __m256i *b)
+{
+   *r = _mm256_mulhi_epi16(_mm256_and_si256(in,
+            _mm256_set1_epi16(0x1f << 10)), _mm256_set1_epi16(0x0210));
+   *g = _mm256_mulhi_epi16(_mm256_and_si256(in,
+            _mm256_set1_epi16(0x1f << 5)), _mm256_set1_epi16(0x4200));
+   *b = _mm256_mulhi_epi16(_mm256_and_si256(_mm256_slli_epi16(in, 5),
+            _mm256_set1_epi16(0x1f << 5)), _mm256_set1_epi16(0x4200));
+}
+
+PIXCONV_AVX2_TARGET
+static INLINE void pixconv_unpack_rgba4444_avx2(__m256i in,
+      __m256i *r, __m256i *g, __m256i *b, __m256i *a)
+{
+   const __m256i mask = _mm256_set1_epi16(0xf);
+   __m256i r4         = _mm256_srli_epi16(in, 12);
+   __m256i g4         = _mm256_and_si256(_mm256_srli_epi16(in, 8), mask);
+   __m256i b4         = _mm256_and_si256(_mm256_srli_epi16(in, 4), mask);
+   __m256i a4         = _mm256_and_si256(in, mask);
+   *r                 = _mm256_or_si256(r4, _mm256_slli_epi16(r4, 4));
+   *g                 = _mm256_or_si256(g4, _mm256_slli_epi16(g4, 4));
+   *b                 = _mm256_or_si256(b4, _mm256_slli_epi16(b4, 4));
+   *a                 = _mm256_or_si256(a4, _mm256_slli_epi16(a4, 4));
+}
+
+PIXCONV_AVX2_TARGET
+static INLINE void pixconv_store_argb_avx2(uint32_t *out, __m256i b,
+      __m256i g, __m256i r, __m256i a)
+{
+   __m256i lo = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+   __m256i hi = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+
+   _mm256_storeu_si256((__m256i*)(out + 0),
+         _mm256_permute2x128_si256(lo, hi, 0x20));
+   _mm256_storeu_si256((__m256i*)(out + 8),
+         _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+PIXCONV_AVX2_TARGET
+static INLINE __m256i pixconv_pack_epi32_avx2(__m256i lo, __m256i hi)
+{
+   __m256i packed = _mm256_packs_epi32(
+         _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16),
+         _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16));
+   return _mm256_permute4x64_epi64(packed, 0xd8);
+}
+
+PIXCONV_AVX2_TARGET
+static INLINE __m256i pixconv_argb8888_rgb565_avx2(__m256i c)
+{
+   return _mm256_or_si256(
+         _mm256_and_si256(_mm256_srli_epi32(c, 8), _mm256_set1_epi32(0xf800)),
+         _mm256_or_si256(
+            _mm256_and_si256(_mm256_srli_epi32(c, 5), _mm256_set1_epi32(0x07e0)),
+            _mm256_and_si256(_mm256_srli_epi32(c, 3), _mm256_set1_epi32(0x001f))));
+}
+
+PIXCONV_AVX2_TARGET
+static INLINE __m256i pixconv_argb8888_0rgb1555_avx2(__m256i c)
+{
+   return _mm256_or_si256(
+         _mm256_and_si256(_mm256_srli_epi32(c, 9), _mm256_set1_epi32(0x7c00)),
+         _mm256_or_si256(
+            _mm256_and_si256(_mm256_srli_epi32(c, 6), _mm256_set1_epi32(0x03e0)),
+            _mm256_and_si256(_mm256_srli_epi32(c, 3), _mm256_set1_epi32(0x001f))));
+}
+
+PIXCONV_AVX2_TARGET
+static INLINE __m256i pixconv_argb8888_rgba4444_avx2(__m256i c)
+{
+   return _mm256_or_si256(
+         _mm256_or_si256(
+            _mm256_and_si256(_mm256_srli_epi32(c, 8), _mm256_set1_epi32(0xf000)),
+            _mm256_and_si256(_mm256_srli_epi32(c, 4), _mm256_set1_epi32(0x0f00))),
+         _mm256_or_si256(
+            _mm256_and_si256(c, _mm256_set1_epi32(0x00f0)),
+            _mm256_srli_epi32(c, 28)));
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_rgb565_0rgb1555_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i hi_mask = _mm256_set1_epi16(0x7fe0);
+   const __m256i lo_mask = _mm256_set1_epi16(0x1f);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(in, 1), hi_mask);
+      __m256i lo = _mm256_and_si256(in, lo_mask);
+      _mm256_storeu_si256((__m256i*)(output + w), _mm256_or_si256(hi, lo));
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_0rgb1555_rgb565_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   const __m256i hi_mask   = _mm256_set1_epi16(
+         (int16_t)((0x1f << 11) | (0x1f << 6)));
+   const __m256i lo_mask   = _mm256_set1_epi16(0x1f);
+   const __m256i glow_mask = _mm256_set1_epi16(1 << 5);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i rg   = _mm256_and_si256(_mm256_slli_epi16(in, 1), hi_mask);
+      __m256i b    = _mm256_and_si256(in, lo_mask);
+      __m256i glow = _mm256_and_si256(_mm256_srli_epi16(in, 4), glow_mask);
+      _mm256_storeu_si256((__m256i*)(output + w),
+            _mm256_or_si256(rg, _mm256_or_si256(b, glow)));
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_0rgb1555_argb8888_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m256i a       = _mm256_set1_epi16(0x00ff);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i r, g, b;
+      pixconv_unpack_0rgb1555_avx2(
+            _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+      pixconv_store_argb_avx2(output + w, b, g, r, a);
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_rgb565_argb8888_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m256i a       = _mm256_set1_epi16(0x00ff);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i r, g, b;
+      pixconv_unpack_rgb565_avx2(
+            _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+      pixconv_store_argb_avx2(output + w, b, g, r, a);
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_rgb565_abgr8888_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m256i a       = _mm256_set1_epi16(0x00ff);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i r, g, b;
+      pixconv_unpack_rgb565_avx2(
+            _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+      pixconv_store_argb_avx2(output + w, r, g, b, a);
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_rgba4444_argb8888_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i r, g, b, a;
+      pixconv_unpack_rgba4444_avx2(
+            _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b, &a);
+      pixconv_store_argb_avx2(output + w, b, g, r, a);
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_rgba4444_rgb565_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i r_mask  = _mm256_set1_epi16((int16_t)0xf000);
+   const __m256i g_mask  = _mm256_set1_epi16(0x0780);
+   const __m256i b_mask  = _mm256_set1_epi16(0x001e);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i r        = _mm256_and_si256(in, r_mask);
+      __m256i g        = _mm256_and_si256(_mm256_srli_epi16(in, 1), g_mask);
+      __m256i b        = _mm256_and_si256(_mm256_srli_epi16(in, 3), b_mask);
+      _mm256_storeu_si256((__m256i*)(output + w),
+            _mm256_or_si256(r, _mm256_or_si256(g, b)));
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_argb8888_0rgb1555_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i lo = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+      __m256i hi = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+      _mm256_storeu_si256((__m256i*)(output + w), pixconv_pack_epi32_avx2(
+               pixconv_argb8888_0rgb1555_avx2(lo),
+               pixconv_argb8888_0rgb1555_avx2(hi)));
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_argb8888_rgba4444_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i lo = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+      __m256i hi = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+      _mm256_storeu_si256((__m256i*)(output + w), pixconv_pack_epi32_avx2(
+               pixconv_argb8888_rgba4444_avx2(lo),
+               pixconv_argb8888_rgba4444_avx2(hi)));
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_argb8888_rgb565_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i lo = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+      __m256i hi = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+      _mm256_storeu_si256((__m256i*)(output + w), pixconv_pack_epi32_avx2(
+               pixconv_argb8888_rgb565_avx2(lo),
+               pixconv_argb8888_rgb565_avx2(hi)));
+   }
+
+   return w;
+}
+
+PIXCONV_AVX2_TARGET
+static int conv_argb8888_abgr8888_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m256i shuf    = _mm256_setr_epi8(
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+   for (w = 0; w + 8 <= width; w += 8)
+      _mm256_storeu_si256((__m256i*)(output + w), _mm256_shuffle_epi8(
+               _mm256_loadu_si256((const __m256i*)(input + w)), shuf));
+
+   return w;
+}
+
+/* Same steps as the SSE2 version. Each 128-bit lane works on
+ * one half of the 32 pixels, so the loads are arranged to give
+ * every lane the two vectors the SSE2 version starts with. */
+PIXCONV_AVX2_TARGET
+static int conv_yuyv_argb8888_avx2(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint8_t *src          = (const uint8_t*)input_;
+   uint32_t *dst               = (uint32_t*)output_;
+   const __m256i mask_y        = _mm256_set1_epi16(0xffu);
+   const __m256i mask_u        = _mm256_set1_epi32(0xffu << 8);
+   const __m256i mask_v        = _mm256_set1_epi32(0xffu << 24);
+   const __m256i chroma_offset = _mm256_set1_epi16(128);
+   const __m256i round_offset  = _mm256_set1_epi16(YUV_OFFSET);
+
+   const __m256i yuv_mul       = _mm256_set1_epi16(YUV_MAT_Y);
+   const __m256i u_g_mul       = _mm256_set1_epi16(YUV_MAT_U_G);
+   const __m256i u_b_mul       = _mm256_set1_epi16(YUV_MAT_U_B);
+   const __m256i v_r_mul       = _mm256_set1_epi16(YUV_MAT_V_R);
+   const __m256i v_g_mul       = _mm256_set1_epi16(YUV_MAT_V_G);
+   const __m256i a             = _mm256_set1_epi8(-1);
+
+   for (w = 0; w + 32 <= width; w += 32, src += 64, dst += 32)
+   {
+      __m256i u, v, u0, u1, v0, v1, _y0, _y1, r0, g0, b0, r1, g1, b1;
+      __m256i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      __m256i res0, res1, res2, res3;
+      __m256i t0   = _mm256_loadu_si256((const __m256i*)(src +  0));
+      __m256i t1   = _mm256_loadu_si256((const __m256i*)(src + 32));
+      __m256i yuv0 = _mm256_permute2x128_si256(t0, t1, 0x20);
+      __m256i yuv1 = _mm256_permute2x128_si256(t0, t1, 0x31);
+
+      _y0 = _mm256_and_si256(yuv0, mask_y);
+      _y1 = _mm256_and_si256(yuv1, mask_y);
+      u0  = _mm256_srli_si256(_mm256_and_si256(yuv0, mask_u), 1);
+      v0  = _mm256_srli_si256(_mm256_and_si256(yuv0, mask_v), 3);
+      u1  = _mm256_srli_si256(_mm256_and_si256(yuv1, mask_u), 1);
+      v1  = _mm256_srli_si256(_mm256_and_si256(yuv1, mask_v), 3);
+      u   = _mm256_sub_epi16(_mm256_packs_epi32(u0, u1), chroma_offset);
+      v   = _mm256_sub_epi16(_mm256_packs_epi32(v0, v1), chroma_offset);
+
+      u0  = _mm256_unpacklo_epi16(u, u);
+      u1  = _mm256_unpackhi_epi16(u, u);
+      v0  = _mm256_unpacklo_epi16(v, v);
+      v1  = _mm256_unpackhi_epi16(v, v);
+
+      _y0 = _mm256_mullo_epi16(_y0, yuv_mul);
+      _y1 = _mm256_mullo_epi16(_y1, yuv_mul);
+
+      r0  = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(_y0,
+                  _mm256_mullo_epi16(v0, v_r_mul)), round_offset), YUV_SHIFT);
+      g0  = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y0, _mm256_mullo_epi16(v0, v_g_mul)),
+                  _mm256_mullo_epi16(u0, u_g_mul)), round_offset), YUV_SHIFT);
+      b0  = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(_y0,
+                  _mm256_mullo_epi16(u0, u_b_mul)), round_offset), YUV_SHIFT);
+      r1  = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(_y1,
+                  _mm256_mullo_epi16(v1, v_r_mul)), round_offset), YUV_SHIFT);
+      g1  = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y1, _mm256_mullo_epi16(v1, v_g_mul)),
+                  _mm256_mullo_epi16(u1, u_g_mul)), round_offset), YUV_SHIFT);
+      b1  = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(_y1,
+                  _mm256_mullo_epi16(u1, u_b_mul)), round_offset), YUV_SHIFT);
+
+      r0  = _mm256_packus_epi16(r0, r1);
+      g0  = _mm256_packus_epi16(g0, g1);
+      b0  = _mm256_packus_epi16(b0, b1);
+
+      res_lo_bg = _mm256_unpacklo_epi8(b0, g0);
+      res_hi_bg = _mm256_unpackhi_epi8(b0, g0);
+      res_lo_ra = _mm256_unpacklo_epi8(r0, a);
+      res_hi_ra = _mm256_unpackhi_epi8(r0, a);
+      res0      = _mm256_unpacklo_epi16(res_lo_bg, res_lo_ra);
+      res1      = _mm256_unpackhi_epi16(res_lo_bg, res_lo_ra);
+      res2      = _mm256_unpacklo_epi16(res_hi_bg, res_hi_ra);
+      res3      = _mm256_unpackhi_epi16(res_hi_bg, res_hi_ra);
+
+      _mm256_storeu_si256((__m256i*)(dst +  0),
+            _mm256_permute2x128_si256(res0, res1, 0x20));
+      _mm256_storeu_si256((__m256i*)(dst +  8),
+            _mm256_permute2x128_si256(res2, res3, 0x20));
+      _mm256_storeu_si256((__m256i*)(dst + 16),
+            _mm256_permute2x128_si256(res0, res1, 0x31));
+      _mm256_storeu_si256((__m256i*)(dst + 24),
+            _mm256_permute2x128_si256(res2, res3, 0x31));
+   }
+
+   /* The C loop is slow enough for a last group of 16 to matter */
+   return w + conv_yuyv_argb8888_sse2(dst, src, width - w);
+}
+#endif
+
+#ifdef PIXCONV_NEON
+/* Splits 8 pixels into their channels, expanded to 8 bits */
+static INLINE void pixconv_unpack_rgb565_neon(uint16x8_t in,
+      uint8x8_t *r, uint8x8_t *g, uint8x8_t *b)
+{
+   uint8x8_t r5 = vand_u8(vshrn_n_u16(in, 8), vdup_n_u8(0xf8));
+   uint8x8_t g6 = vand_u8(vshrn_n_u16(in, 3), vdup_n_u8(0xfc));
+   uint8x8_t b5 = vmovn_u16(vshlq_n_u16(in, 3));
+   *r           = vorr_u8(r5, vshr_n_u8(r5, 5));
+   *g           = vorr_u8(g6, vshr_n_u8(g6, 6));
+   *b           = vorr_u8(b5, vshr_n_u8(b5, 5));
+}
+
+static INLINE void pixconv_unpack_0rgb1555_neon(uint16x8_t in,
+      uint8x8_t *r, uint8x8_t *g, uint8x8_t *b)
+{
+   uint8x8_t r5 = vand_u8(vshrn_n_u16(in, 7), vdup_n_u8(0xf8));
+   uint8x8_t g5 = vand_u8(vshrn_n_u16(in, 2), vdup_n_u8(0xf8));
+   uint8x8_t b5 = vmovn_u16(vshlq_n_u16(in, 3));
+   *r           = vorr_u8(r5, vshr_n_u8(r5, 5));
+   *g           = vorr_u8(g5, vshr_n_u8(g5, 5));
+   *b           = vorr_u8(b5, vshr_n_u8(b5, 5));
+}
+
+static INLINE void pixconv_unpack_rgba4444_neon(uint16x8_t in,
+      uint8x8x4_t *argb)
+{
+   const uint8x8_t mask = vdup_n_u8(0xf0);
+   uint8x8_t r4         = vand_u8(vshrn_n_u16(in, 8), mask);
+   uint8x8_t g4         = vand_u8(vshrn_n_u16(in, 4), mask);
+   uint8x8_t b4         = vand_u8(vmovn_u16(in), mask);
+   uint8x8_t a4         = vmovn_u16(vshlq_n_u16(in, 4));
+   argb->val[0]         = vorr_u8(b4, vshr_n_u8(b4, 4));
+   argb->val[1]         = vorr_u8(g4, vshr_n_u8(g4, 4));
+   argb->val[2]         = vorr_u8(r4, vshr_n_u8(r4, 4));
+   argb->val[3]         = vorr_u8(a4, vshr_n_u8(a4, 4));
+}
+
+/* Builds 16-bit pixels from the top bits of each channel,
+ * shifting them in from the right one after the other. */
+static INLINE uint16x8_t pixconv_pack_rgb565_neon(uint8x8_t r,
+      uint8x8_t g, uint8x8_t b)
+{
+   uint16x8_t out = vshll_n_u8(r, 8);
+   out            = vsriq_n_u16(out, vshll_n_u8(g, 8), 5);
+   return vsriq_n_u16(out, vshll_n_u8(b, 8), 11);
+}
+
+static INLINE uint16x8_t pixconv_pack_0rgb1555_neon(uint8x8_t r,
+      uint8x8_t g, uint8x8_t b)
 {
-   int h;
+   uint16x8_t out = vshll_n_u8(r, 7);
+   out            = vsriq_n_u16(out, vshll_n_u8(g, 8), 6);
+   return vsriq_n_u16(out, vshll_n_u8(b, 8), 11);
+}
+
+static int conv_rgb565_0rgb1555_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint16x8_t in = vld1q_u16(input + w);
+      vst1q_u16(output + w, vorrq_u16(
+               vandq_u16(vshrq_n_u16(in, 1), vdupq_n_u16(0x7fe0)),
+               vandq_u16(in, vdupq_n_u16(0x1f))));
+   }
+
+   return w;
+}
+
+static int conv_0rgb1555_rgb565_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint16x8_t in   = vld1q_u16(input + w);
+      uint16x8_t rg   = vandq_u16(vshlq_n_u16(in, 1),
+            vdupq_n_u16((0x1f << 11) | (0x1f << 6)));
+      uint16x8_t b    = vandq_u16(in, vdupq_n_u16(0x1f));
+      uint16x8_t glow = vandq_u16(vshrq_n_u16(in, 4), vdupq_n_u16(1 << 5));
+      vst1q_u16(output + w, vorrq_u16(rg, vorrq_u16(b, glow)));
+   }
+
+   return w;
+}
+
+static int conv_0rgb1555_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint8x8x4_t argb;
+      pixconv_unpack_0rgb1555_neon(vld1q_u16(input + w),
+            &argb.val[2], &argb.val[1], &argb.val[0]);
+      argb.val[3] = vdup_n_u8(0xff);
+      vst4_u8((uint8_t*)(output + w), argb);
+   }
+
+   return w;
+}
+
+static int conv_rgb565_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint8x8x4_t argb;
+      pixconv_unpack_rgb565_neon(vld1q_u16(input + w),
+            &argb.val[2], &argb.val[1], &argb.val[0]);
+      argb.val[3] = vdup_n_u8(0xff);
+      vst4_u8((uint8_t*)(output + w), argb);
+   }
+
+   return w;
+}
+
+static int conv_rgb565_abgr8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint8x8x4_t abgr;
+      pixconv_unpack_rgb565_neon(vld1q_u16(input + w),
+            &abgr.val[0], &abgr.val[1], &abgr.val[2]);
+      abgr.val[3] = vdup_n_u8(0xff);
+      vst4_u8((uint8_t*)(output + w), abgr);
+   }
+
+   return w;
+}
+
+static int conv_rgba4444_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint8x8x4_t argb;
+      pixconv_unpack_rgba4444_neon(vld1q_u16(input + w), &argb);
+      vst4_u8((uint8_t*)(output + w), argb);
+   }
+
+   return w;
+}
+
+static int conv_rgba4444_rgb565_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint16x8_t in = vld1q_u16(input + w);
+      uint16x8_t r  = vandq_u16(in, vdupq_n_u16(0xf000));
+      uint16x8_t g  = vandq_u16(vshrq_n_u16(in, 1), vdupq_n_u16(0x0780));
+      uint16x8_t b  = vandq_u16(vshrq_n_u16(in, 3), vdupq_n_u16(0x001e));
+      vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+   }
+
+   return w;
+}
+
+static int conv_bgr24_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint8_t *input = (const uint8_t*)input_;
+   uint32_t *output     = (uint32_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8, input += 24)
+   {
+      uint8x8x3_t bgr = vld3_u8(input);
+      uint8x8x4_t argb;
+      argb.val[0]     = bgr.val[0];
+      argb.val[1]     = bgr.val[1];
+      argb.val[2]     = bgr.val[2];
+      argb.val[3]     = vdup_n_u8(0xff);
+      vst4_u8((uint8_t*)(output + w), argb);
+   }
+
+   return w;
+}
+
+static int conv_bgr24_rgb565_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint8_t *input = (const uint8_t*)input_;
+   uint16_t *output     = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8, input += 24)
+   {
+      uint8x8x3_t bgr = vld3_u8(input);
+      vst1q_u16(output + w, pixconv_pack_rgb565_neon(
+               bgr.val[2], bgr.val[1], bgr.val[0]));
+   }
+
+   return w;
+}
+
+static int conv_argb8888_0rgb1555_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint8x8x4_t argb = vld4_u8((const uint8_t*)(input + w));
+      vst1q_u16(output + w, pixconv_pack_0rgb1555_neon(
+               argb.val[2], argb.val[1], argb.val[0]));
+   }
+
+   return w;
+}
+
+static int conv_argb8888_rgba4444_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint8x8x4_t argb = vld4_u8((const uint8_t*)(input + w));
+      uint16x8_t out   = vshll_n_u8(argb.val[2], 8);
+      out              = vsriq_n_u16(out, vshll_n_u8(argb.val[1], 8), 4);
+      out              = vsriq_n_u16(out, vshll_n_u8(argb.val[0], 8), 8);
+      out              = vsriq_n_u16(out, vshll_n_u8(argb.val[3], 8), 12);
+      vst1q_u16(output + w, out);
+   }
+
+   return w;
+}
+
+static int conv_argb8888_rgb565_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      uint8x8x4_t argb = vld4_u8((const uint8_t*)(input + w));
+      vst1q_u16(output + w, pixconv_pack_rgb565_neon(
+               argb.val[2], argb.val[1], argb.val[0]));
+   }
+
+   return w;
+}
+
+static int conv_argb8888_bgr24_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8, out += 24)
+   {
+      uint8x8x4_t argb = vld4_u8((const uint8_t*)(input + w));
+      uint8x8x3_t bgr;
+      bgr.val[0]       = argb.val[0];
+      bgr.val[1]       = argb.val[1];
+      bgr.val[2]       = argb.val[2];
+      vst3_u8(out, bgr);
+   }
+
+   return w;
+}
+
+static int conv_abgr8888_bgr24_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8, out += 24)
+   {
+      uint8x8x4_t abgr = vld4_u8((const uint8_t*)(input + w));
+      uint8x8x3_t bgr;
+      bgr.val[0]       = abgr.val[2];
+      bgr.val[1]       = abgr.val[1];
+      bgr.val[2]       = abgr.val[0];
+      vst3_u8(out, bgr);
+   }
+
+   return w;
+}
+
+static int conv_argb8888_abgr8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      uint8x16x4_t argb = vld4q_u8((const uint8_t*)(input + w));
+      uint8x16_t b      = argb.val[0];
+      argb.val[0]       = argb.val[2];
+      argb.val[2]       = b;
+      vst4q_u8((uint8_t*)(output + w), argb);
+   }
+
+   return w;
+}
+
+static int conv_0rgb1555_bgr24_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8, out += 24)
+   {
+      uint8x8x3_t bgr;
+      pixconv_unpack_0rgb1555_neon(vld1q_u16(input + w),
+            &bgr.val[2], &bgr.val[1], &bgr.val[0]);
+      vst3_u8(out, bgr);
+   }
+
+   return w;
+}
+
+static int conv_rgb565_bgr24_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
    const uint16_t *input = (const uint16_t*)input_;
-   uint16_t *output = (uint16_t*)output_;
+   uint8_t *out          = (uint8_t*)output_;
+
+   for (w = 0; w + 8 <= width; w += 8, out += 24)
+   {
+      uint8x8x3_t bgr;
+      pixconv_unpack_rgb565_neon(vld1q_u16(input + w),
+            &bgr.val[2], &bgr.val[1], &bgr.val[0]);
+      vst3_u8(out, bgr);
+   }
+
+   return w;
+}
+
+/* The sums stay within 16 bits, so the saturating
+ * narrowing shift matches clamp_8bit() exactly. */
+static INLINE uint8x8_t pixconv_yuv_channel_neon(int16x8_t y,
+      int16x8_t u, int16x8_t v, int16_t u_mul, int16_t v_mul)
+{
+   int16x8_t sum = vmlaq_n_s16(vmlaq_n_s16(y, u, u_mul), v, v_mul);
+   return vqshrun_n_s16(vaddq_s16(sum, vdupq_n_s16(YUV_OFFSET)), YUV_SHIFT);
+}
+
+/* Converts 16 pixels to ARGB8888 from their even and odd
+ * luma samples and the 8 horizontally subsampled chroma pairs. */
+static INLINE void pixconv_yuv_argb8888_neon(uint32_t *dst,
+      uint8x8_t y_even, uint8x8_t y_odd, uint8x8_t u_, uint8x8_t v_)
+{
+   int16x8_t u      = vreinterpretq_s16_u16(vsubl_u8(u_, vdup_n_u8(128)));
+   int16x8_t v      = vreinterpretq_s16_u16(vsubl_u8(v_, vdup_n_u8(128)));
+   int16x8_t y0     = vreinterpretq_s16_u16(vshll_n_u8(y_even, 6));
+   int16x8_t y1     = vreinterpretq_s16_u16(vshll_n_u8(y_odd, 6));
+   uint8x8x2_t r    = vzip_u8(
+         pixconv_yuv_channel_neon(y0, u, v, 0, YUV_MAT_V_R),
+         pixconv_yuv_channel_neon(y1, u, v, 0, YUV_MAT_V_R));
+   uint8x8x2_t g    = vzip_u8(
+         pixconv_yuv_channel_neon(y0, u, v, YUV_MAT_U_G, YUV_MAT_V_G),
+         pixconv_yuv_channel_neon(y1, u, v, YUV_MAT_U_G, YUV_MAT_V_G));
+   uint8x8x2_t b    = vzip_u8(
+         pixconv_yuv_channel_neon(y0, u, v, YUV_MAT_U_B, 0),
+         pixconv_yuv_channel_neon(y1, u, v, YUV_MAT_U_B, 0));
+   uint8x8x4_t argb;
+
+   argb.val[3]      = vdup_n_u8(0xff);
+   argb.val[0]      = b.val[0];
+   argb.val[1]      = g.val[0];
+   argb.val[2]      = r.val[0];
+   vst4_u8((uint8_t*)(dst + 0), argb);
+   argb.val[0]      = b.val[1];
+   argb.val[1]      = g.val[1];
+   argb.val[2]      = r.val[1];
+   vst4_u8((uint8_t*)(dst + 8), argb);
+}
+
+static int conv_yuyv_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w;
+   const uint8_t *src = (const uint8_t*)input_;
+   uint32_t *dst      = (uint32_t*)output_;
+
+   for (w = 0; w + 16 <= width; w += 16, src += 32, dst += 16)
+   {
+      /* [Y0, U, Y1, V] for 8 pixel pairs */
+      uint8x8x4_t yuyv = vld4_u8(src);
+      pixconv_yuv_argb8888_neon(dst, yuyv.val[0], yuyv.val[2],
+            yuyv.val[1], yuyv.val[3]);
+   }
+
+   return w;
+}
+
+static int conv_nv12_argb8888_neon(uint32_t *dst,
+      const uint8_t *src_y, const uint8_t *src_uv, int width)
+{
+   int w;
+
+   for (w = 0; w + 16 <= width; w += 16, src_y += 16, src_uv += 16, dst += 16)
+   {
+      uint8x8x2_t y  = vld2_u8(src_y);  /* even, odd */
+      uint8x8x2_t uv = vld2_u8(src_uv); /* U, V */
+      pixconv_yuv_argb8888_neon(dst, y.val[0], y.val[1],
+            uv.val[0], uv.val[1]);
+   }
+
+   return w;
+}
+#endif
+
+/* Semi-planar input needs a second source pointer per row,
+ * so it gets a kernel slot of its own. */
+typedef int (*pixconv_nv12_kernel_t)(uint32_t *output,
+      const uint8_t *input_y, const uint8_t *input_uv, int width);
+
+static pixconv_kernel_t pixconv_kernels[PIXCONV_KERNEL_LAST];
+static pixconv_nv12_kernel_t pixconv_nv12_kernel = NULL;
+static bool pixconv_kernels_inited = false;
+
+/**
+ * pixconv_init_kernels:
+ * @simd             : RETRO_SIMD_* features that may be used.
+ *
+ * Picks the fastest kernel available for every conversion,
+ * later entries override earlier ones.
+ **/
+static void pixconv_init_kernels(uint64_t simd)
+{
+   memset(pixconv_kernels, 0, sizeof(pixconv_kernels));
+   pixconv_nv12_kernel = NULL;
 
 #if defined(__SSE2__)
-   int max_width           = width - 7;
-   const __m128i hi_mask   = _mm_set1_epi16(0x7fe0);
-   const __m128i lo_mask   = _mm_set1_epi16(0x1f);
+   if (simd & RETRO_SIMD_SSE2)
+   {
+      pixconv_kernels[PIXCONV_0RGB1555_ARGB8888] = conv_0rgb1555_argb8888_sse2;
+      pixconv_kernels[PIXCONV_0RGB1555_RGB565]   = conv_0rgb1555_rgb565_sse2;
+      pixconv_kernels[PIXCONV_RGB565_0RGB1555]   = conv_rgb565_0rgb1555_sse2;
+      pixconv_kernels[PIXCONV_RGB565_ABGR8888]   = conv_rgb565_abgr8888_sse2;
+      pixconv_kernels[PIXCONV_RGB565_ARGB8888]   = conv_rgb565_argb8888_sse2;
+      pixconv_kernels[PIXCONV_RGBA4444_ARGB8888] = conv_rgba4444_argb8888_sse2;
+      pixconv_kernels[PIXCONV_RGBA4444_RGB565]   = conv_rgba4444_rgb565_sse2;
+      pixconv_kernels[PIXCONV_ARGB8888_0RGB1555] = conv_argb8888_0rgb1555_sse2;
+      pixconv_kernels[PIXCONV_ARGB8888_RGBA4444] = conv_argb8888_rgba4444_sse2;
+      pixconv_kernels[PIXCONV_ARGB8888_RGB565]   = conv_argb8888_rgb565_sse2;
+      pixconv_kernels[PIXCONV_ARGB8888_BGR24]    = conv_argb8888_bgr24_sse2;
+      pixconv_kernels[PIXCONV_ABGR8888_BGR24]    = conv_abgr8888_bgr24_sse2;
+      pixconv_kernels[PIXCONV_ARGB8888_ABGR8888] = conv_argb8888_abgr8888_sse2;
+      pixconv_kernels[PIXCONV_0RGB1555_BGR24]    = conv_0rgb1555_bgr24_sse2;
+      pixconv_kernels[PIXCONV_RGB565_BGR24]      = conv_rgb565_bgr24_sse2;
+      pixconv_kernels[PIXCONV_YUYV_ARGB8888]     = conv_yuyv_argb8888_sse2;
+      pixconv_nv12_kernel                        = conv_nv12_argb8888_sse2;
+   }
+#elif defined(__MMX__)
+   if (simd & RETRO_SIMD_MMX)
+   {
+      pixconv_kernels[PIXCONV_RGB565_ARGB8888]   = conv_rgb565_argb8888_mmx;
+      pixconv_kernels[PIXCONV_RGBA4444_ARGB8888] = conv_rgba4444_argb8888_mmx;
+   }
+#endif
+
+#ifdef PIXCONV_SSSE3
+   if ((simd & RETRO_SIMD_SSE2) && (simd & RETRO_SIMD_SSSE3))
+   {
+      pixconv_kernels[PIXCONV_BGR24_ARGB8888]    = conv_bgr24_argb8888_ssse3;
+      pixconv_kernels[PIXCONV_BGR24_RGB565]      = conv_bgr24_rgb565_ssse3;
+      pixconv_kernels[PIXCONV_ARGB8888_BGR24]    = conv_argb8888_bgr24_ssse3;
+      pixconv_kernels[PIXCONV_ABGR8888_BGR24]    = conv_abgr8888_bgr24_ssse3;
+      pixconv_kernels[PIXCONV_ARGB8888_ABGR8888] = conv_argb8888_abgr8888_ssse3;
+      pixconv_kernels[PIXCONV_0RGB1555_BGR24]    = conv_0rgb1555_bgr24_ssse3;
+      pixconv_kernels[PIXCONV_RGB565_BGR24]      = conv_rgb565_bgr24_ssse3;
+   }
+#endif
+
+#ifdef PIXCONV_AVX2
+   /* The 24-bit conversions stay on SSSE3, AVX2 shuffles
+    * cannot cross 128-bit lanes and gain nothing there. */
+   if ((simd & RETRO_SIMD_SSE2) && (simd & RETRO_SIMD_AVX2))
+   {
+      pixconv_kernels[PIXCONV_0RGB1555_ARGB8888] = conv_0rgb1555_argb8888_avx2;
+      pixconv_kernels[PIXCONV_0RGB1555_RGB565]   = conv_0rgb1555_rgb565_avx2;
+      pixconv_kernels[PIXCONV_RGB565_0RGB1555]   = conv_rgb565_0rgb1555_avx2;
+      pixconv_kernels[PIXCONV_RGB565_ABGR8888]   = conv_rgb565_abgr8888_avx2;
+      pixconv_kernels[PIXCONV_RGB565_ARGB8888]   = conv_rgb565_argb8888_avx2;
+      pixconv_kernels[PIXCONV_RGBA4444_ARGB8888] = conv_rgba4444_argb8888_avx2;
+      pixconv_kernels[PIXCONV_RGBA4444_RGB565]   = conv_rgba4444_rgb565_avx2;
+      pixconv_kernels[PIXCONV_ARGB8888_0RGB1555] = conv_argb8888_0rgb1555_avx2;
+      pixconv_kernels[PIXCONV_ARGB8888_RGBA4444] = conv_argb8888_rgba4444_avx2;
+      pixconv_kernels[PIXCONV_ARGB8888_RGB565]   = conv_argb8888_rgb565_avx2;
+      pixconv_kernels[PIXCONV_ARGB8888_ABGR8888] = conv_argb8888_abgr8888_avx2;
+      pixconv_kernels[PIXCONV_YUYV_ARGB8888]     = conv_yuyv_argb8888_avx2;
+   }
+#endif
+
+#ifdef PIXCONV_NEON
+#if !defined(__aarch64__)
+   if (simd & RETRO_SIMD_NEON)
+#endif
+   {
+      pixconv_kernels[PIXCONV_0RGB1555_ARGB8888] = conv_0rgb1555_argb8888_neon;
+      pixconv_kernels[PIXCONV_0RGB1555_RGB565]   = conv_0rgb1555_rgb565_neon;
+      pixconv_kernels[PIXCONV_RGB565_0RGB1555]   = conv_rgb565_0rgb1555_neon;
+      pixconv_kernels[PIXCONV_RGB565_ABGR8888]   = conv_rgb565_abgr8888_neon;
+      pixconv_kernels[PIXCONV_RGB565_ARGB8888]   = conv_rgb565_argb8888_neon;
+      pixconv_kernels[PIXCONV_RGBA4444_ARGB8888] = conv_rgba4444_argb8888_neon;
+      pixconv_kernels[PIXCONV_RGBA4444_RGB565]   = conv_rgba4444_rgb565_neon;
+      pixconv_kernels[PIXCONV_BGR24_ARGB8888]    = conv_bgr24_argb8888_neon;
+      pixconv_kernels[PIXCONV_BGR24_RGB565]      = conv_bgr24_rgb565_neon;
+      pixconv_kernels[PIXCONV_ARGB8888_0RGB1555] = conv_argb8888_0rgb1555_neon;
+      pixconv_kernels[PIXCONV_ARGB8888_RGBA4444] = conv_argb8888_rgba4444_neon;
+      pixconv_kernels[PIXCONV_ARGB8888_RGB565]   = conv_argb8888_rgb565_neon;
+      pixconv_kernels[PIXCONV_ARGB8888_BGR24]    = conv_argb8888_bgr24_neon;
+      pixconv_kernels[PIXCONV_ABGR8888_BGR24]    = conv_abgr8888_bgr24_neon;
+      pixconv_kernels[PIXCONV_ARGB8888_ABGR8888] = conv_argb8888_abgr8888_neon;
+      pixconv_kernels[PIXCONV_0RGB1555_BGR24]    = conv_0rgb1555_bgr24_neon;
+      pixconv_kernels[PIXCONV_RGB565_BGR24]      = conv_rgb565_bgr24_neon;
+      pixconv_kernels[PIXCONV_YUYV_ARGB8888]     = conv_yuyv_argb8888_neon;
+      pixconv_nv12_kernel                        = conv_nv12_argb8888_neon;
+   }
 #endif
 
+   pixconv_kernels_inited = true;
+}
+
+static pixconv_kernel_t pixconv_get_kernel(enum pixconv_kernel kernel)
+{
+   if (!pixconv_kernels_inited)
+      pixconv_init_kernels(cpu_features_get());
+   return pixconv_kernels[kernel];
+}
+
+void conv_set_simd_mask(uint64_t simd)
+{
+   pixconv_init_kernels(simd & cpu_features_get());
+}
+
+void conv_rgb565_0rgb1555(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_RGB565_0RGB1555);
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      int w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 8)
-      {
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i hi = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
-         __m128i lo = _mm_and_si128(in, lo_mask);
-         _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
-      }
-#endif
+      int w = kernel ? kernel(output, input, width) : 0;
 
       for (; w < width; w++)
       {
@@ -88,31 +2042,12 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
    int h;
    const uint16_t *input   = (const uint16_t*)input_;
    uint16_t *output        = (uint16_t*)output_;
-
-#if defined(__SSE2__)
-   int max_width           = width - 7;
-
-   const __m128i hi_mask   = _mm_set1_epi16(
-         (int16_t)((0x1f << 11) | (0x1f << 6)));
-   const __m128i lo_mask   = _mm_set1_epi16(0x1f);
-   const __m128i glow_mask = _mm_set1_epi16(1 << 5);
-#endif
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_0RGB1555_RGB565);
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      int w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 8)
-      {
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i rg   = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
-         __m128i b    = _mm_and_si128(in, lo_mask);
-         __m128i glow = _mm_and_si128(_mm_srli_epi16(in, 4), glow_mask);
-         _mm_storeu_si128((__m128i*)(output + w),
-               _mm_or_si128(rg, _mm_or_si128(b, glow)));
-      }
-#endif
+      int w = kernel ? kernel(output, input, width) : 0;
 
       for (; w < width; w++)
       {
@@ -130,52 +2065,14 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
       int out_stride, int in_stride)
 {
    int h;
-   const uint16_t *input = (const uint16_t*)input_;
-   uint32_t *output      = (uint32_t*)output_;
-
-#ifdef __SSE2__
-   const __m128i pix_mask_r  = _mm_set1_epi16(0x1f << 10);
-   const __m128i pix_mask_gb = _mm_set1_epi16(0x1f <<  5);
-   const __m128i mul15_mid   = _mm_set1_epi16(0x4200);
-   const __m128i mul15_hi    = _mm_set1_epi16(0x0210);
-   const __m128i a           = _mm_set1_epi16(0x00ff);
-
-   int max_width = width - 7;
-#endif
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint32_t *output        = (uint32_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_0RGB1555_ARGB8888);
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
-      int w = 0;
-#ifdef __SSE2__
-      for (; w < max_width; w += 8)
-      {
-         __m128i res_lo_bg, res_hi_bg;
-         __m128i res_lo_ra, res_hi_ra;
-         __m128i res_lo, res_hi;
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i r = _mm_and_si128(in, pix_mask_r);
-         __m128i g = _mm_and_si128(in, pix_mask_gb);
-         __m128i b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_gb);
-
-         r = _mm_mulhi_epi16(r, mul15_hi);
-         g = _mm_mulhi_epi16(g, mul15_mid);
-         b = _mm_mulhi_epi16(b, mul15_mid);
-
-         res_lo_bg = _mm_unpacklo_epi8(b, g);
-         res_hi_bg = _mm_unpackhi_epi8(b, g);
-         res_lo_ra = _mm_unpacklo_epi8(r, a);
-         res_hi_ra = _mm_unpackhi_epi8(r, a);
-
-         res_lo = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
-
-         _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
-         _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
-      }
-#endif
+      int w = kernel ? kernel(output, input, width) : 0;
 
       for (; w < width; w++)
       {
@@ -190,99 +2087,21 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
          output[w]    = (0xffu << 24) | (r << 16) | (g << 8) | (b << 0);
       }
    }
-}
-
-void conv_rgb565_argb8888(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
-{
-   int h;
-   const uint16_t *input    = (const uint16_t*)input_;
-   uint32_t *output         = (uint32_t*)output_;
-
-#if defined(__SSE2__)
-   const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
-   const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
-   const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
-   const __m128i mul16_r    = _mm_set1_epi16(0x0210);
-   const __m128i mul16_g    = _mm_set1_epi16(0x2080);
-   const __m128i mul16_b    = _mm_set1_epi16(0x4200);
-   const __m128i a          = _mm_set1_epi16(0x00ff);
-
-   int max_width            = width - 7;
-#elif defined(__MMX__)
-   const __m64 pix_mask_r = _mm_set1_pi16(0x1f << 10);
-   const __m64 pix_mask_g = _mm_set1_pi16(0x3f << 5);
-   const __m64 pix_mask_b = _mm_set1_pi16(0x1f << 5);
-   const __m64 mul16_r    = _mm_set1_pi16(0x0210);
-   const __m64 mul16_g    = _mm_set1_pi16(0x2080);
-   const __m64 mul16_b    = _mm_set1_pi16(0x4200);
-   const __m64 a          = _mm_set1_pi16(0x00ff);
+}
 
-   int max_width            = width - 3;
-#endif
+void conv_rgb565_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint32_t *output        = (uint32_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_RGB565_ARGB8888);
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
-      int w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 8)
-      {
-         __m128i res_lo, res_hi;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
-         __m128i        g = _mm_and_si128(in, pix_mask_g);
-         __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_b);
-
-         r                = _mm_mulhi_epi16(r, mul16_r);
-         g                = _mm_mulhi_epi16(g, mul16_g);
-         b                = _mm_mulhi_epi16(b, mul16_b);
-
-         res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
-
-         res_lo           = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi           = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
-
-         _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
-         _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
-      }
-#elif defined(__MMX__)
-      for (; w < max_width; w += 4)
-      {
-         __m64 res_lo, res_hi;
-         __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m64 in = *((__m64*)(input + w));
-         __m64          r = _mm_and_si64(_mm_srli_pi16(in, 1), pix_mask_r);
-         __m64          g = _mm_and_si64(in, pix_mask_g);
-         __m64          b = _mm_and_si64(_mm_slli_pi16(in, 5), pix_mask_b);
-
-         r                = _mm_mulhi_pi16(r, mul16_r);
-         g                = _mm_mulhi_pi16(g, mul16_g);
-         b                = _mm_mulhi_pi16(b, mul16_b);
-
-         res_lo_bg        = _mm_unpacklo_pi8(b, g);
-         res_hi_bg        = _mm_unpackhi_pi8(b, g);
-         res_lo_ra        = _mm_unpacklo_pi8(r, a);
-         res_hi_ra        = _mm_unpackhi_pi8(r, a);
-
-         res_lo           = _mm_or_si64(res_lo_bg,
-               _mm_slli_si64(res_lo_ra, 16));
-         res_hi           = _mm_or_si64(res_hi_bg,
-               _mm_slli_si64(res_hi_ra, 16));
-
-         *((__m64*)(output + w + 0)) = res_lo;
-         *((__m64*)(output + w + 2)) = res_hi;
-      }
-
-      _mm_empty();
-#endif
+      int w = kernel ? kernel(output, input, width) : 0;
 
       for (; w < width; w++)
       {
@@ -304,47 +2123,16 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
       int out_stride, int in_stride)
 {
    int h;
-   const uint16_t *input    = (const uint16_t*)input_;
-   uint32_t *output         = (uint32_t*)output_;
- #if defined(__SSE2__)
-   const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
-   const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
-   const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
-   const __m128i mul16_r    = _mm_set1_epi16(0x0210);
-   const __m128i mul16_g    = _mm_set1_epi16(0x2080);
-   const __m128i mul16_b    = _mm_set1_epi16(0x4200);
-   const __m128i a          = _mm_set1_epi16(0x00ff);
-    int max_width            = width - 7;
-#endif
-    for (h = 0; h < height;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint32_t *output        = (uint32_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_RGB565_ABGR8888);
+
+   for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
-      int w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 8)
-      {
-         __m128i res_lo, res_hi;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
-         __m128i        g = _mm_and_si128(in, pix_mask_g);
-         __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_b);
-         r                = _mm_mulhi_epi16(r, mul16_r);
-         g                = _mm_mulhi_epi16(g, mul16_g);
-         b                = _mm_mulhi_epi16(b, mul16_b);
-         res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
-         res_lo           = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi           = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
-         _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
-         _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
-      }
-#endif
-       for (; w < width; w++)
+      int w = kernel ? kernel(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 11) & 0x1f;
@@ -362,24 +2150,23 @@ void conv_argb8888_rgba4444(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
-   const uint32_t *input = (const uint32_t*)input_;
-   uint16_t *output      = (uint16_t*)output_;
+   int h;
+   const uint32_t *input   = (const uint32_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_ARGB8888_RGBA4444);
 
    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = kernel ? kernel(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
-         uint32_t r   = (col >> 16) & 0xf;
-         uint32_t g   = (col >>  8) & 0xf;
-         uint32_t b   = (col) & 0xf;
-         uint32_t a   = (col >>  24) & 0xf;
-         r            = (r >> 4) | r;
-         g            = (g >> 4) | g;
-         b            = (b >> 4) | b;
-         a            = (a >> 4) | a;
+         uint32_t r   = (col >> 20) & 0xf;
+         uint32_t g   = (col >> 12) & 0xf;
+         uint32_t b   = (col >>  4) & 0xf;
+         uint32_t a   = (col >> 28) & 0xf;
 
          output[w]    = (r << 12) | (g << 8) | (b << 4) | a;
       }
@@ -391,55 +2178,14 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
       int out_stride, int in_stride)
 {
    int h;
-   const uint16_t *input = (const uint16_t*)input_;
-   uint32_t *output      = (uint32_t*)output_;
-
-#if defined(__MMX__)
-   const __m64 pix_mask_r = _mm_set1_pi16(0xf << 10);
-   const __m64 pix_mask_g = _mm_set1_pi16(0xf << 8);
-   const __m64 pix_mask_b = _mm_set1_pi16(0xf << 8);
-   const __m64 mul16_r    = _mm_set1_pi16(0x0440);
-   const __m64 mul16_g    = _mm_set1_pi16(0x1100);
-   const __m64 mul16_b    = _mm_set1_pi16(0x1100);
-   const __m64 a          = _mm_set1_pi16(0x00ff);
-
-   int max_width            = width - 3;
-#endif
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint32_t *output        = (uint32_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_RGBA4444_ARGB8888);
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
-      int w = 0;
-#if defined(__MMX__)
-      for (; w < max_width; w += 4)
-      {
-         __m64 res_lo, res_hi;
-         __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m64 in = *((__m64*)(input + w));
-         __m64          r = _mm_and_si64(_mm_srli_pi16(in, 2), pix_mask_r);
-         __m64          g = _mm_and_si64(in, pix_mask_g);
-         __m64          b = _mm_and_si64(_mm_slli_pi16(in, 4), pix_mask_b);
-
-         r                = _mm_mulhi_pi16(r, mul16_r);
-         g                = _mm_mulhi_pi16(g, mul16_g);
-         b                = _mm_mulhi_pi16(b, mul16_b);
-
-         res_lo_bg        = _mm_unpacklo_pi8(b, g);
-         res_hi_bg        = _mm_unpackhi_pi8(b, g);
-         res_lo_ra        = _mm_unpacklo_pi8(r, a);
-         res_hi_ra        = _mm_unpackhi_pi8(r, a);
-
-         res_lo           = _mm_or_si64(res_lo_bg,
-               _mm_slli_si64(res_lo_ra, 16));
-         res_hi           = _mm_or_si64(res_hi_bg,
-               _mm_slli_si64(res_hi_ra, 16));
-
-         *((__m64*)(output + w + 0)) = res_lo;
-         *((__m64*)(output + w + 2)) = res_hi;
-      }
-
-      _mm_empty();
-#endif
+      int w = kernel ? kernel(output, input, width) : 0;
 
       for (; w < width; w++)
       {
@@ -462,14 +2208,17 @@ void conv_rgba4444_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
-   const uint16_t *input = (const uint16_t*)input_;
-   uint16_t *output      = (uint16_t*)output_;
+   int h;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_RGBA4444_RGB565);
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      for (w = 0; w < width; w++)
+      int w = kernel ? kernel(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 12) & 0xf;
@@ -481,121 +2230,20 @@ void conv_rgba4444_rgb565(void *output_, const void *input_,
    }
 }
 
-#if defined(__SSE2__)
-/* :( TODO: Make this saner. */
-static INLINE void store_bgr24_sse2(void *output, __m128i a,
-      __m128i b, __m128i c, __m128i d)
-{
-   const __m128i mask_0 = _mm_set_epi32(0, 0, 0, 0x00ffffff);
-   const __m128i mask_1 = _mm_set_epi32(0, 0, 0x00ffffff, 0);
-   const __m128i mask_2 = _mm_set_epi32(0, 0x00ffffff, 0, 0);
-   const __m128i mask_3 = _mm_set_epi32(0x00ffffff, 0, 0, 0);
-
-   __m128i a0 = _mm_and_si128(a, mask_0);
-   __m128i a1 = _mm_srli_si128(_mm_and_si128(a, mask_1),  1);
-   __m128i a2 = _mm_srli_si128(_mm_and_si128(a, mask_2),  2);
-   __m128i a3 = _mm_srli_si128(_mm_and_si128(a, mask_3),  3);
-   __m128i a4 = _mm_slli_si128(_mm_and_si128(b, mask_0), 12);
-   __m128i a5 = _mm_slli_si128(_mm_and_si128(b, mask_1), 11);
-
-   __m128i b0 = _mm_srli_si128(_mm_and_si128(b, mask_1), 5);
-   __m128i b1 = _mm_srli_si128(_mm_and_si128(b, mask_2), 6);
-   __m128i b2 = _mm_srli_si128(_mm_and_si128(b, mask_3), 7);
-   __m128i b3 = _mm_slli_si128(_mm_and_si128(c, mask_0), 8);
-   __m128i b4 = _mm_slli_si128(_mm_and_si128(c, mask_1), 7);
-   __m128i b5 = _mm_slli_si128(_mm_and_si128(c, mask_2), 6);
-
-   __m128i c0 = _mm_srli_si128(_mm_and_si128(c, mask_2), 10);
-   __m128i c1 = _mm_srli_si128(_mm_and_si128(c, mask_3), 11);
-   __m128i c2 = _mm_slli_si128(_mm_and_si128(d, mask_0),  4);
-   __m128i c3 = _mm_slli_si128(_mm_and_si128(d, mask_1),  3);
-   __m128i c4 = _mm_slli_si128(_mm_and_si128(d, mask_2),  2);
-   __m128i c5 = _mm_slli_si128(_mm_and_si128(d, mask_3),  1);
-
-   __m128i *out = (__m128i*)output;
-
-   _mm_storeu_si128(out + 0,
-         _mm_or_si128(a0, _mm_or_si128(a1, _mm_or_si128(a2,
-                  _mm_or_si128(a3, _mm_or_si128(a4, a5))))));
-
-   _mm_storeu_si128(out + 1,
-         _mm_or_si128(b0, _mm_or_si128(b1, _mm_or_si128(b2,
-                  _mm_or_si128(b3, _mm_or_si128(b4, b5))))));
-
-   _mm_storeu_si128(out + 2,
-         _mm_or_si128(c0, _mm_or_si128(c1, _mm_or_si128(c2,
-                  _mm_or_si128(c3, _mm_or_si128(c4, c5))))));
-}
-#endif
-
 void conv_0rgb1555_bgr24(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
    int h;
-   const uint16_t *input     = (const uint16_t*)input_;
-   uint8_t *output           = (uint8_t*)output_;
-
-#if defined(__SSE2__)
-   const __m128i pix_mask_r  = _mm_set1_epi16(0x1f << 10);
-   const __m128i pix_mask_gb = _mm_set1_epi16(0x1f <<  5);
-   const __m128i mul15_mid   = _mm_set1_epi16(0x4200);
-   const __m128i mul15_hi    = _mm_set1_epi16(0x0210);
-   const __m128i a           = _mm_set1_epi16(0x00ff);
-
-   int max_width             = width - 15;
-#endif
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint8_t *output         = (uint8_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_0RGB1555_BGR24);
 
    for (h = 0; h < height;
          h++, output += out_stride, input += in_stride >> 1)
    {
-      uint8_t *out = output;
-      int   w = 0;
-
-#if defined(__SSE2__)
-      for (; w < max_width; w += 16, out += 48)
-      {
-         __m128i res_lo_bg0, res_lo_bg1, res_hi_bg0, res_hi_bg1,
-                 res_lo_ra0, res_lo_ra1, res_hi_ra0, res_hi_ra1,
-                 res_lo0, res_lo1, res_hi0, res_hi1;
-         const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
-         const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
-         __m128i r0        = _mm_and_si128(in0, pix_mask_r);
-         __m128i r1        = _mm_and_si128(in1, pix_mask_r);
-         __m128i g0        = _mm_and_si128(in0, pix_mask_gb);
-         __m128i g1        = _mm_and_si128(in1, pix_mask_gb);
-         __m128i b0        = _mm_and_si128(_mm_slli_epi16(in0, 5), pix_mask_gb);
-         __m128i b1        = _mm_and_si128(_mm_slli_epi16(in1, 5), pix_mask_gb);
-
-         r0                = _mm_mulhi_epi16(r0, mul15_hi);
-         r1                = _mm_mulhi_epi16(r1, mul15_hi);
-         g0                = _mm_mulhi_epi16(g0, mul15_mid);
-         g1                = _mm_mulhi_epi16(g1, mul15_mid);
-         b0                = _mm_mulhi_epi16(b0, mul15_mid);
-         b1                = _mm_mulhi_epi16(b1, mul15_mid);
-
-         res_lo_bg0        = _mm_unpacklo_epi8(b0, g0);
-         res_lo_bg1        = _mm_unpacklo_epi8(b1, g1);
-         res_hi_bg0        = _mm_unpackhi_epi8(b0, g0);
-         res_hi_bg1        = _mm_unpackhi_epi8(b1, g1);
-         res_lo_ra0        = _mm_unpacklo_epi8(r0, a);
-         res_lo_ra1        = _mm_unpacklo_epi8(r1, a);
-         res_hi_ra0        = _mm_unpackhi_epi8(r0, a);
-         res_hi_ra1        = _mm_unpackhi_epi8(r1, a);
-
-         res_lo0           = _mm_or_si128(res_lo_bg0,
-               _mm_slli_si128(res_lo_ra0, 2));
-         res_lo1           = _mm_or_si128(res_lo_bg1,
-               _mm_slli_si128(res_lo_ra1, 2));
-         res_hi0           = _mm_or_si128(res_hi_bg0,
-               _mm_slli_si128(res_hi_ra0, 2));
-         res_hi1           = _mm_or_si128(res_hi_bg1,
-               _mm_slli_si128(res_hi_ra1, 2));
-
-         /* Non-POT pixel sizes for the loss */
-         store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
-      }
-#endif
+      int w        = kernel ? kernel(output, input, width) : 0;
+      uint8_t *out = output + w * 3;
 
       for (; w < width; w++)
       {
@@ -619,68 +2267,14 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
       int out_stride, int in_stride)
 {
    int h;
-   const uint16_t *input    = (const uint16_t*)input_;
-   uint8_t *output          = (uint8_t*)output_;
-
-#if defined(__SSE2__)
-   const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
-   const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
-   const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
-   const __m128i mul16_r    = _mm_set1_epi16(0x0210);
-   const __m128i mul16_g    = _mm_set1_epi16(0x2080);
-   const __m128i mul16_b    = _mm_set1_epi16(0x4200);
-   const __m128i a          = _mm_set1_epi16(0x00ff);
-
-   int max_width            = width - 15;
-#endif
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint8_t *output         = (uint8_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_RGB565_BGR24);
 
    for (h = 0; h < height; h++, output += out_stride, input += in_stride >> 1)
    {
-      uint8_t *out = output;
-      int        w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 16, out += 48)
-      {
-         __m128i res_lo_bg0, res_hi_bg0, res_lo_ra0, res_hi_ra0;
-         __m128i res_lo_bg1, res_hi_bg1, res_lo_ra1, res_hi_ra1;
-         __m128i res_lo0, res_hi0, res_lo1, res_hi1;
-         const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w));
-         const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
-         __m128i r0 = _mm_and_si128(_mm_srli_epi16(in0, 1), pix_mask_r);
-         __m128i g0 = _mm_and_si128(in0, pix_mask_g);
-         __m128i b0 = _mm_and_si128(_mm_slli_epi16(in0, 5), pix_mask_b);
-         __m128i r1 = _mm_and_si128(_mm_srli_epi16(in1, 1), pix_mask_r);
-         __m128i g1 = _mm_and_si128(in1, pix_mask_g);
-         __m128i b1 = _mm_and_si128(_mm_slli_epi16(in1, 5), pix_mask_b);
-
-         r0         = _mm_mulhi_epi16(r0, mul16_r);
-         g0         = _mm_mulhi_epi16(g0, mul16_g);
-         b0         = _mm_mulhi_epi16(b0, mul16_b);
-         r1         = _mm_mulhi_epi16(r1, mul16_r);
-         g1         = _mm_mulhi_epi16(g1, mul16_g);
-         b1         = _mm_mulhi_epi16(b1, mul16_b);
-
-         res_lo_bg0 = _mm_unpacklo_epi8(b0, g0);
-         res_hi_bg0 = _mm_unpackhi_epi8(b0, g0);
-         res_lo_ra0 = _mm_unpacklo_epi8(r0, a);
-         res_hi_ra0 = _mm_unpackhi_epi8(r0, a);
-         res_lo_bg1 = _mm_unpacklo_epi8(b1, g1);
-         res_hi_bg1 = _mm_unpackhi_epi8(b1, g1);
-         res_lo_ra1 = _mm_unpacklo_epi8(r1, a);
-         res_hi_ra1 = _mm_unpackhi_epi8(r1, a);
-
-         res_lo0    = _mm_or_si128(res_lo_bg0,
-               _mm_slli_si128(res_lo_ra0, 2));
-         res_hi0    = _mm_or_si128(res_hi_bg0,
-               _mm_slli_si128(res_hi_ra0, 2));
-         res_lo1    = _mm_or_si128(res_lo_bg1,
-               _mm_slli_si128(res_lo_ra1, 2));
-         res_hi1    = _mm_or_si128(res_hi_bg1,
-               _mm_slli_si128(res_hi_ra1, 2));
-
-         store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
-      }
-#endif
+      int w        = kernel ? kernel(output, input, width) : 0;
+      uint8_t *out = output + w * 3;
 
       for (; w < width; w++)
       {
@@ -703,15 +2297,18 @@ void conv_bgr24_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
-   const uint8_t *input = (const uint8_t*)input_;
-   uint32_t *output     = (uint32_t*)output_;
+   int h;
+   const uint8_t *input    = (const uint8_t*)input_;
+   uint32_t *output        = (uint32_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_BGR24_ARGB8888);
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride)
    {
-      const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int w              = kernel ? kernel(output, input, width) : 0;
+      const uint8_t *inp = input + w * 3;
+
+      for (; w < width; w++)
       {
          uint32_t b = *inp++;
          uint32_t g = *inp++;
@@ -725,21 +2322,25 @@ void conv_bgr24_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
-   const uint8_t *input = (const uint8_t*)input_;
-   uint16_t *output     = (uint16_t*)output_;
+   int h;
+   const uint8_t *input    = (const uint8_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_BGR24_RGB565);
+
    for (h = 0; h < height;
-         h++, output += out_stride, input += in_stride)
+         h++, output += out_stride >> 1, input += in_stride)
    {
-      const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int w              = kernel ? kernel(output, input, width) : 0;
+      const uint8_t *inp = input + w * 3;
+
+      for (; w < width; w++)
       {
          uint16_t b = *inp++;
          uint16_t g = *inp++;
          uint16_t r = *inp++;
-    
+
          output[w] = ((r & 0x00F8) << 8) | ((g&0x00FC) << 3) | ((b&0x00F8) >> 3);
-      }  
+      }
    }
 }
 
@@ -747,14 +2348,17 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
-   const uint32_t *input = (const uint32_t*)input_;
-   uint16_t *output      = (uint16_t*)output_;
+   int h;
+   const uint32_t *input   = (const uint32_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_ARGB8888_0RGB1555);
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = kernel ? kernel(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint16_t r   = (col >> 19) & 0x1f;
@@ -765,33 +2369,45 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
    }
 }
 
-void conv_argb8888_bgr24(void *output_, const void *input_,
+void conv_argb8888_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
    int h;
-   const uint32_t *input = (const uint32_t*)input_;
-   uint8_t *output       = (uint8_t*)output_;
-
-#if defined(__SSE2__)
-   int max_width = width - 15;
-#endif
+   const uint32_t *input   = (const uint32_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_ARGB8888_RGB565);
 
    for (h = 0; h < height;
-         h++, output += out_stride, input += in_stride >> 2)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      uint8_t *out = output;
-      int        w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 16, out += 48)
+      int w = kernel ? kernel(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
-         __m128i l0 = _mm_loadu_si128((const __m128i*)(input + w +  0));
-         __m128i l1 = _mm_loadu_si128((const __m128i*)(input + w +  4));
-         __m128i l2 = _mm_loadu_si128((const __m128i*)(input + w +  8));
-         __m128i l3 = _mm_loadu_si128((const __m128i*)(input + w + 12));
-         store_bgr24_sse2(out, l0, l1, l2, l3);
+         uint32_t col = input[w];
+         uint16_t r   = (col >> 19) & 0x1f;
+         uint16_t g   = (col >> 10) & 0x3f;
+         uint16_t b   = (col >>  3) & 0x1f;
+         output[w]    = (r << 11) | (g << 5) | (b << 0);
       }
-#endif
+   }
+}
+
+void conv_argb8888_bgr24(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input   = (const uint32_t*)input_;
+   uint8_t *output         = (uint8_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_ARGB8888_BGR24);
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 2)
+   {
+      int w        = kernel ? kernel(output, input, width) : 0;
+      uint8_t *out = output + w * 3;
 
       for (; w < width; w++)
       {
@@ -803,52 +2419,20 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
    }
 }
 
-#if defined(__SSE2__)
-static INLINE __m128i conv_shuffle_rb_epi32(__m128i c)
-{
-   /* SSSE3 plz */
-   const __m128i b_mask = _mm_set1_epi32(0x000000ff);
-   const __m128i g_mask = _mm_set1_epi32(0x0000ff00);
-   const __m128i r_mask = _mm_set1_epi32(0x00ff0000);
-   __m128i sl = _mm_and_si128(_mm_slli_epi32(c, 16), r_mask);
-   __m128i sr = _mm_and_si128(_mm_srli_epi32(c, 16), b_mask);
-   __m128i g  = _mm_and_si128(c, g_mask);
-   __m128i rb = _mm_or_si128(sl, sr);
-   return _mm_or_si128(g, rb);
-}
-#endif
-
 void conv_abgr8888_bgr24(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
    int h;
-   const uint32_t *input = (const uint32_t*)input_;
-   uint8_t *output       = (uint8_t*)output_;
-
-#if defined(__SSE2__)
-   int max_width = width - 15;
-#endif
+   const uint32_t *input   = (const uint32_t*)input_;
+   uint8_t *output         = (uint8_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_ABGR8888_BGR24);
 
    for (h = 0; h < height;
          h++, output += out_stride, input += in_stride >> 2)
    {
-      uint8_t *out = output;
-      int        w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 16, out += 48)
-      {
-		 __m128i a = _mm_loadu_si128((const __m128i*)(input + w +  0));
-		 __m128i b = _mm_loadu_si128((const __m128i*)(input + w +  4));
-		 __m128i c = _mm_loadu_si128((const __m128i*)(input + w +  8));
-		 __m128i d = _mm_loadu_si128((const __m128i*)(input + w + 12));
-         a = conv_shuffle_rb_epi32(a);
-         b = conv_shuffle_rb_epi32(b);
-         c = conv_shuffle_rb_epi32(c);
-         d = conv_shuffle_rb_epi32(d);
-         store_bgr24_sse2(out, a, b, c, d);
-      }
-#endif
+      int w        = kernel ? kernel(output, input, width) : 0;
+      uint8_t *out = output + w * 3;
 
       for (; w < width; w++)
       {
@@ -864,14 +2448,17 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
-   const uint32_t *input = (const uint32_t*)input_;
-   uint32_t *output      = (uint32_t*)output_;
+   int h;
+   const uint32_t *input   = (const uint32_t*)input_;
+   uint32_t *output        = (uint32_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_ARGB8888_ABGR8888);
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = kernel ? kernel(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w]    = ((col << 16) & 0xff0000) |
@@ -880,128 +2467,20 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
    }
 }
 
-#define YUV_SHIFT 6
-#define YUV_OFFSET (1 << (YUV_SHIFT - 1))
-#define YUV_MAT_Y (1 << 6)
-#define YUV_MAT_U_G (-22)
-#define YUV_MAT_U_B (113)
-#define YUV_MAT_V_R (90)
-#define YUV_MAT_V_G (-46)
-
 void conv_yuyv_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
    int h;
-   const uint8_t *input        = (const uint8_t*)input_;
-   uint32_t *output            = (uint32_t*)output_;
-
-#if defined(__SSE2__)
-   const __m128i mask_y        = _mm_set1_epi16(0xffu);
-   const __m128i mask_u        = _mm_set1_epi32(0xffu << 8);
-   const __m128i mask_v        = _mm_set1_epi32(0xffu << 24);
-   const __m128i chroma_offset = _mm_set1_epi16(128);
-   const __m128i round_offset  = _mm_set1_epi16(YUV_OFFSET);
-
-   const __m128i yuv_mul       = _mm_set1_epi16(YUV_MAT_Y);
-   const __m128i u_g_mul       = _mm_set1_epi16(YUV_MAT_U_G);
-   const __m128i u_b_mul       = _mm_set1_epi16(YUV_MAT_U_B);
-   const __m128i v_r_mul       = _mm_set1_epi16(YUV_MAT_V_R);
-   const __m128i v_g_mul       = _mm_set1_epi16(YUV_MAT_V_G);
-   const __m128i a             = _mm_cmpeq_epi16(
-         _mm_setzero_si128(), _mm_setzero_si128());
-#endif
+   const uint8_t *input    = (const uint8_t*)input_;
+   uint32_t *output        = (uint32_t*)output_;
+   pixconv_kernel_t kernel = pixconv_get_kernel(PIXCONV_YUYV_ARGB8888);
 
    for (h = 0; h < height; h++, output += out_stride >> 2, input += in_stride)
    {
-      const uint8_t *src = input;
-      uint32_t      *dst = output;
-      int              w = 0;
-
-#if defined(__SSE2__)
-      /* Each loop processes 16 pixels. */
-      for (; w + 16 <= width; w += 16, src += 32, dst += 16)
-      {
-         __m128i u, v, u0_g, u1_g, u0_b, u1_b, v0_r, v1_r, v0_g, v1_g,
-                 r0, g0, b0, r1, g1, b1;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         __m128i res0, res1, res2, res3;
-         __m128i yuv0 = _mm_loadu_si128((const __m128i*)(src +  0)); /* [Y0, U0, Y1, V0, Y2, U1, Y3, V1, ...] */
-         __m128i yuv1 = _mm_loadu_si128((const __m128i*)(src + 16)); /* [Y0, U0, Y1, V0, Y2, U1, Y3, V1, ...] */
-
-         __m128i _y0 = _mm_and_si128(yuv0, mask_y); /* [Y0, Y1, Y2, ...] (16-bit) */
-         __m128i u0 = _mm_and_si128(yuv0, mask_u); /* [0, U0, 0, 0, 0, U1, 0, 0, ...] */
-         __m128i v0 = _mm_and_si128(yuv0, mask_v); /* [0, 0, 0, V1, 0, , 0, V1, ...] */
-         __m128i _y1 = _mm_and_si128(yuv1, mask_y); /* [Y0, Y1, Y2, ...] (16-bit) */
-         __m128i u1 = _mm_and_si128(yuv1, mask_u); /* [0, U0, 0, 0, 0, U1, 0, 0, ...] */
-         __m128i v1 = _mm_and_si128(yuv1, mask_v); /* [0, 0, 0, V1, 0, , 0, V1, ...] */
-
-         /* Juggle around to get U and V in the same 16-bit format as Y. */
-         u0 = _mm_srli_si128(u0, 1);
-         v0 = _mm_srli_si128(v0, 3);
-         u1 = _mm_srli_si128(u1, 1);
-         v1 = _mm_srli_si128(v1, 3);
-         u = _mm_packs_epi32(u0, u1);
-         v = _mm_packs_epi32(v0, v1);
-
-         /* Apply YUV offsets (U, V) -= (-128, -128). */
-         u = _mm_sub_epi16(u, chroma_offset);
-         v = _mm_sub_epi16(v, chroma_offset);
-
-         /* Upscale chroma horizontally (nearest). */
-         u0 = _mm_unpacklo_epi16(u, u);
-         u1 = _mm_unpackhi_epi16(u, u);
-         v0 = _mm_unpacklo_epi16(v, v);
-         v1 = _mm_unpackhi_epi16(v, v);
-
-         /* Apply transformations. */
-         _y0 = _mm_mullo_epi16(_y0, yuv_mul);
-         _y1 = _mm_mullo_epi16(_y1, yuv_mul);
-         u0_g   = _mm_mullo_epi16(u0, u_g_mul);
-         u1_g   = _mm_mullo_epi16(u1, u_g_mul);
-         u0_b   = _mm_mullo_epi16(u0, u_b_mul);
-         u1_b   = _mm_mullo_epi16(u1, u_b_mul);
-         v0_r   = _mm_mullo_epi16(v0, v_r_mul);
-         v1_r   = _mm_mullo_epi16(v1, v_r_mul);
-         v0_g   = _mm_mullo_epi16(v0, v_g_mul);
-         v1_g   = _mm_mullo_epi16(v1, v_g_mul);
-
-         /* Add contibutions from the transformed components. */
-         r0 = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(_y0, v0_r),
-                  round_offset), YUV_SHIFT);
-         g0 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_mm_adds_epi16(_y0, v0_g), u0_g), round_offset), YUV_SHIFT);
-         b0 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_y0, u0_b), round_offset), YUV_SHIFT);
-
-         r1 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_y1, v1_r), round_offset), YUV_SHIFT);
-         g1 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_mm_adds_epi16(_y1, v1_g), u1_g), round_offset), YUV_SHIFT);
-         b1 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_y1, u1_b), round_offset), YUV_SHIFT);
-
-         /* Saturate into 8-bit. */
-         r0 = _mm_packus_epi16(r0, r1);
-         g0 = _mm_packus_epi16(g0, g1);
-         b0 = _mm_packus_epi16(b0, b1);
-
-         /* Interleave into ARGB. */
-         res_lo_bg = _mm_unpacklo_epi8(b0, g0);
-         res_hi_bg = _mm_unpackhi_epi8(b0, g0);
-         res_lo_ra = _mm_unpacklo_epi8(r0, a);
-         res_hi_ra = _mm_unpackhi_epi8(r0, a);
-         res0 = _mm_unpacklo_epi16(res_lo_bg, res_lo_ra);
-         res1 = _mm_unpackhi_epi16(res_lo_bg, res_lo_ra);
-         res2 = _mm_unpacklo_epi16(res_hi_bg, res_hi_ra);
-         res3 = _mm_unpackhi_epi16(res_hi_bg, res_hi_ra);
-
-         _mm_storeu_si128((__m128i*)(dst +  0), res0);
-         _mm_storeu_si128((__m128i*)(dst +  4), res1);
-         _mm_storeu_si128((__m128i*)(dst +  8), res2);
-         _mm_storeu_si128((__m128i*)(dst + 12), res3);
-      }
-#endif
+      int w              = kernel ? kernel(output, input, width) : 0;
+      const uint8_t *src = input + w * 2;
+      uint32_t      *dst = output + w;
 
       /* Finish off the rest (if any) in C. */
       for (; w < width; w += 2, src += 4, dst += 2)
@@ -1025,6 +2504,52 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
    }
 }
 
+void conv_nv12_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint8_t *input_y     = (const uint8_t*)input_;
+   const uint8_t *input_uv    = input_y + in_stride * height;
+   uint32_t *output           = (uint32_t*)output_;
+   pixconv_nv12_kernel_t kernel;
+
+   if (!pixconv_kernels_inited)
+      pixconv_init_kernels(cpu_features_get());
+   kernel = pixconv_nv12_kernel;
+
+   for (h = 0; h < height; h++, output += out_stride >> 2, input_y += in_stride)
+   {
+      /* Each chroma row covers two luma rows. */
+      const uint8_t *uv  = input_uv + (h >> 1) * in_stride;
+      int w              = kernel ? kernel(output, input_y, uv, width) : 0;
+      const uint8_t *src = input_y + w;
+      uint32_t      *dst = output + w;
+
+      uv                += w;
+
+      /* Finish off the rest (if any) in C. */
+      for (; w < width; w += 2, src += 2, uv += 2, dst += 2)
+      {
+         int _y0    = src[0];
+         int _y1    = src[1];
+         int  u     = uv[0] - 128;
+         int  v     = uv[1] - 128;
+
+         uint8_t r0 = clamp_8bit((YUV_MAT_Y * _y0 +                   YUV_MAT_V_R * v + YUV_OFFSET) >> YUV_SHIFT);
+         uint8_t g0 = clamp_8bit((YUV_MAT_Y * _y0 + YUV_MAT_U_G * u + YUV_MAT_V_G * v + YUV_OFFSET) >> YUV_SHIFT);
+         uint8_t b0 = clamp_8bit((YUV_MAT_Y * _y0 + YUV_MAT_U_B * u                   + YUV_OFFSET) >> YUV_SHIFT);
+
+         uint8_t r1 = clamp_8bit((YUV_MAT_Y * _y1 +                   YUV_MAT_V_R * v + YUV_OFFSET) >> YUV_SHIFT);
+         uint8_t g1 = clamp_8bit((YUV_MAT_Y * _y1 + YUV_MAT_U_G * u + YUV_MAT_V_G * v + YUV_OFFSET) >> YUV_SHIFT);
+         uint8_t b1 = clamp_8bit((YUV_MAT_Y * _y1 + YUV_MAT_U_B * u                   + YUV_OFFSET) >> YUV_SHIFT);
+
+         dst[0]     = 0xff000000u | (r0 << 16) | (g0 << 8) | (b0 << 0);
+         dst[1]     = 0xff000000u | (r1 << 16) | (g1 << 8) | (b1 << 0);
+      }
+   }
+}
+
 void conv_copy(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
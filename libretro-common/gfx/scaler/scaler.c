@@ -30,6 +30,27 @@
 #include <gfx/scaler/filter.h>
 #include <gfx/scaler/pixconv.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
+
+/* Bands shorter than this aren't worth handing to a worker */
+#define SCALER_BAND_MIN_LINES 16
+
+/* Lines one worker converts and filters. The horizontal pass has
+ * to finish on all bands before the vertical one can start, as
+ * each output line reads several intermediate lines. */
+struct scaler_band
+{
+   const struct scaler_ctx *ctx;
+   const void *input;
+   void *output;
+   int in_first;
+   int in_last;
+   int out_first;
+   int out_last;
+};
+
 static bool allocate_frames(struct scaler_ctx *ctx)
 {
    uint64_t *scaled_frame = NULL;
@@ -74,6 +95,46 @@ static bool allocate_frames(struct scaler_ctx *ctx)
    return true;
 }
 
+/* Splits the lines over ctx->threads bands, one of which
+ * the calling thread takes, and starts the workers for the rest */
+static bool scaler_ctx_gen_bands(struct scaler_ctx *ctx)
+{
+#ifdef HAVE_THREADS
+   unsigned i;
+   unsigned lines     = ctx->in_height < ctx->out_height
+      ? ctx->in_height : ctx->out_height;
+   unsigned num_bands = lines / SCALER_BAND_MIN_LINES;
+
+   if (num_bands > ctx->threads)
+      num_bands = ctx->threads;
+   if (num_bands < 2)
+      return true;
+
+   if (!(ctx->bands = (struct scaler_band*)
+            calloc(num_bands, sizeof(*ctx->bands))))
+      return false;
+
+   for (i = 0; i < num_bands; i++)
+   {
+      struct scaler_band *band = &ctx->bands[i];
+      band->ctx                = ctx;
+      band->in_first           = ctx->in_height  *  i      / num_bands;
+      band->in_last            = ctx->in_height  * (i + 1) / num_bands;
+      band->out_first          = ctx->out_height *  i      / num_bands;
+      band->out_last           = ctx->out_height * (i + 1) / num_bands;
+   }
+
+   ctx->num_bands = num_bands;
+
+   /* Bands go to the shared pool where there is one. Without
+    * workers everything simply runs on the calling thread */
+   if (!tpool_shared())
+      ctx->pool   = tpool_create(num_bands - 1);
+   ctx->group     = tpool_group_new();
+#endif
+   return true;
+}
+
 bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 {
    scaler_ctx_gen_reset(ctx);
@@ -173,6 +234,16 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
                      break;
                }
                break;
+            case SCALER_FMT_NV12:
+               switch (ctx->out_fmt)
+               {
+                  case SCALER_FMT_ARGB8888:
+                     ctx->direct_pixconv = conv_nv12_argb8888;
+                     break;
+                  default:
+                     break;
+               }
+               break;
             case SCALER_FMT_RGBA4444:
                switch (ctx->out_fmt)
                {
@@ -261,6 +332,10 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 
       if (!scaler_gen_filter(ctx))
          return false;
+
+      if (!ctx->scaler_special && ctx->threads > 1)
+         if (!scaler_ctx_gen_bands(ctx))
+            return false;
    }
 
    return true;
@@ -282,6 +357,14 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
       free(ctx->input.frame);
    if (ctx->output.frame)
       free(ctx->output.frame);
+#ifdef HAVE_THREADS
+   if (ctx->pool)
+      tpool_destroy(ctx->pool);
+   if (ctx->group)
+      tpool_group_free(ctx->group);
+#endif
+   if (ctx->bands)
+      free(ctx->bands);
 
    ctx->horiz.filter        = NULL;
    ctx->horiz.filter_len    = 0;
@@ -303,8 +386,87 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 
    ctx->output.frame        = NULL;
    ctx->output.stride       = 0;
+
+   ctx->pool                = NULL;
+   ctx->group               = NULL;
+   ctx->bands               = NULL;
+   ctx->num_bands           = 0;
+}
+
+/* Converts and horizontally scales the band's input lines */
+static void scaler_band_horiz(void *data)
+{
+   struct scaler_band   *band = (struct scaler_band*)data;
+   const struct scaler_ctx *ctx = band->ctx;
+   const void *input_frame    = band->input;
+   int input_stride           = ctx->in_stride;
+
+   if (band->in_first >= band->in_last)
+      return;
+
+   if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+   {
+      ctx->in_pixconv(
+            (uint8_t*)ctx->input.frame + band->in_first * ctx->input.stride,
+            (const uint8_t*)band->input + band->in_first * ctx->in_stride,
+            ctx->in_width, band->in_last - band->in_first,
+            ctx->input.stride, ctx->in_stride);
+
+      input_frame  = ctx->input.frame;
+      input_stride = ctx->input.stride;
+   }
+
+   ctx->scaler_horiz(ctx, input_frame, input_stride,
+         band->in_first, band->in_last);
+}
+
+/* Vertically scales and converts the band's output lines */
+static void scaler_band_vert(void *data)
+{
+   struct scaler_band   *band = (struct scaler_band*)data;
+   const struct scaler_ctx *ctx = band->ctx;
+   void *output_frame         = band->output;
+   int output_stride          = ctx->out_stride;
+
+   if (band->out_first >= band->out_last)
+      return;
+
+   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+   {
+      output_frame  = ctx->output.frame;
+      output_stride = ctx->output.stride;
+   }
+
+   ctx->scaler_vert(ctx, output_frame, output_stride,
+         band->out_first, band->out_last);
+
+   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+      ctx->out_pixconv(
+            (uint8_t*)band->output + band->out_first * ctx->out_stride,
+            (const uint8_t*)ctx->output.frame
+            + band->out_first * ctx->output.stride,
+            ctx->out_width, band->out_last - band->out_first,
+            ctx->out_stride, ctx->output.stride);
 }
 
+#ifdef HAVE_THREADS
+static void scaler_ctx_run_bands(struct scaler_ctx *ctx,
+      void (*func)(void*))
+{
+   unsigned i;
+   unsigned last = ctx->num_bands - 1;
+   tpool_t  *pool = ctx->pool ? ctx->pool : tpool_shared();
+
+   for (i = 0; i < last; i++)
+      if (!ctx->group || !tpool_group_add_work(pool, ctx->group,
+               func, &ctx->bands[i]))
+         func(&ctx->bands[i]);
+   func(&ctx->bands[last]);
+
+   tpool_group_wait(pool, ctx->group);
+}
+#endif
+
 /**
  * scaler_ctx_scale:
  * @ctx          : pointer to scaler context object.
@@ -321,6 +483,49 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
    int input_stride        = ctx->in_stride;
    int output_stride       = ctx->out_stride;
 
+   if (ctx->unscaled)
+   {
+      ctx->direct_pixconv(output, input,
+            ctx->out_width, ctx->out_height,
+            ctx->out_stride, ctx->in_stride);
+      return;
+   }
+
+   /* Generic filter path, split into bands if there are threads */
+   if (!ctx->scaler_special)
+   {
+      struct scaler_band band;
+
+#ifdef HAVE_THREADS
+      if (ctx->bands)
+      {
+         unsigned i;
+
+         for (i = 0; i < ctx->num_bands; i++)
+         {
+            ctx->bands[i].input  = input;
+            ctx->bands[i].output = output;
+         }
+
+         scaler_ctx_run_bands(ctx, scaler_band_horiz);
+         scaler_ctx_run_bands(ctx, scaler_band_vert);
+         return;
+      }
+#endif
+
+      band.ctx       = ctx;
+      band.input     = input;
+      band.output    = output;
+      band.in_first  = 0;
+      band.in_last   = ctx->scaled.height;
+      band.out_first = 0;
+      band.out_last  = ctx->out_height;
+
+      scaler_band_horiz(&band);
+      scaler_band_vert(&band);
+      return;
+   }
+
    if (ctx->in_fmt != SCALER_FMT_ARGB8888)
    {
       ctx->in_pixconv(ctx->input.frame, input,
@@ -338,19 +543,10 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
    }
 
    /* Take some special, and (hopefully) more optimized path. */
-   if (ctx->scaler_special)
-      ctx->scaler_special(ctx, output_frame, input_frame,
-            ctx->out_width, ctx->out_height,
-            ctx->in_width, ctx->in_height,
-            output_stride, input_stride);
-   else
-   {
-      /* Take generic filter path. */
-      if (ctx->scaler_horiz)
-         ctx->scaler_horiz(ctx, input_frame, input_stride);
-      if (ctx->scaler_vert)
-         ctx->scaler_vert (ctx, output, output_stride);
-   }
+   ctx->scaler_special(ctx, output_frame, input_frame,
+         ctx->out_width, ctx->out_height,
+         ctx->in_width, ctx->in_height,
+         output_stride, input_stride);
 
    if (ctx->out_fmt != SCALER_FMT_ARGB8888)
       ctx->out_pixconv(output, ctx->output.frame,
@@ -19,6 +19,7 @@
  * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <string.h>
 
 #include <gfx/scaler/scaler_int.h>
 
@@ -30,9 +31,9 @@
 
 #if defined(__SSE2__)
 #include <emmintrin.h>
-#ifdef _WIN32
-#include <intrin.h>
-#endif
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS) && !defined(SCALER_NO_SIMD)
+#define SCALER_NEON
+#include <arm_neon.h>
 #endif
 
 /* ARGB8888 scaler is split in two:
@@ -60,174 +61,256 @@
  *
  * The C version of scalers perform the exact same operations as the
  * SIMD code for testing purposes.
+ *
+ * The SIMD versions work on whole lines: the vertical scaler
+ * filters several output pixels at once, the horizontal one
+ * loads two taps at a time. Pixels left over at the end of a
+ * line go through the C version.
  */
 
-void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
+static INLINE uint32_t scaler_argb8888_vert_pixel(const struct scaler_ctx *ctx,
+      const uint64_t *input_base_y, const int16_t *filter_vert)
 {
-   int h, w, y;
-   const uint64_t      *input = ctx->scaled.frame;
-   uint32_t           *output = (uint32_t*)output_;
+   int y;
+   int16_t res_a = 0;
+   int16_t res_r = 0;
+   int16_t res_g = 0;
+   int16_t res_b = 0;
+
+   for (y = 0; y < ctx->vert.filter_len; y++,
+         input_base_y += (ctx->scaled.stride >> 3))
+   {
+      uint64_t col   = *input_base_y;
 
-   const int16_t *filter_vert = ctx->vert.filter;
+      int16_t a      = (col >> 48) & 0xffff;
+      int16_t r      = (col >> 32) & 0xffff;
+      int16_t g      = (col >> 16) & 0xffff;
+      int16_t b      = (col >>  0) & 0xffff;
 
-   for (h = 0; h < ctx->out_height; h++,
-         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+      int16_t coeff  = filter_vert[y];
+
+      res_a         += (a * coeff) >> 16;
+      res_r         += (r * coeff) >> 16;
+      res_g         += (g * coeff) >> 16;
+      res_b         += (b * coeff) >> 16;
+   }
+
+   res_a           >>= (7 - 2 - 2);
+   res_r           >>= (7 - 2 - 2);
+   res_g           >>= (7 - 2 - 2);
+   res_b           >>= (7 - 2 - 2);
+
+   return
+      (clamp_8bit(res_a) << 24) |
+      (clamp_8bit(res_r) << 16) |
+      (clamp_8bit(res_g) << 8)  |
+      (clamp_8bit(res_b) << 0);
+}
+
+static INLINE uint64_t scaler_argb8888_horiz_pixel(const struct scaler_ctx *ctx,
+      const uint32_t *input_base_x, const int16_t *filter_horiz)
+{
+   int x;
+   int16_t res_a = 0;
+   int16_t res_r = 0;
+   int16_t res_g = 0;
+   int16_t res_b = 0;
+
+   for (x = 0; x < ctx->horiz.filter_len; x++)
    {
-      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
-         * (ctx->scaled.stride >> 3);
+      uint32_t col   = input_base_x[x];
+
+      int16_t a      = (col >> (24 - 7)) & (0xff << 7);
+      int16_t r      = (col >> (16 - 7)) & (0xff << 7);
+      int16_t g      = (col >> ( 8 - 7)) & (0xff << 7);
+      int16_t b      = (col << ( 0 + 7)) & (0xff << 7);
+
+      int16_t coeff  = filter_horiz[x];
+
+      res_a         += (a * coeff) >> 16;
+      res_r         += (r * coeff) >> 16;
+      res_g         += (g * coeff) >> 16;
+      res_b         += (b * coeff) >> 16;
+   }
+
+   return ((uint64_t)(uint16_t)res_a << 48) |
+          ((uint64_t)(uint16_t)res_r << 32) |
+          ((uint64_t)(uint16_t)res_g << 16) |
+          ((uint64_t)(uint16_t)res_b << 0);
+}
 
-      for (w = 0; w < ctx->out_width; w++)
-      {
-         const uint64_t *input_base_y = input_base + w;
 #if defined(__SSE2__)
-         __m128i final;
-         __m128i res = _mm_setzero_si128();
+/* Two taps of the horizontal filter, (f0 x 4, f1 x 4) */
+static INLINE __m128i scaler_coeff_pair_sse2(const int16_t *filter)
+{
+   int32_t pair;
+   __m128i coeff;
+   memcpy(&pair, filter, sizeof(pair));
+   coeff = _mm_cvtsi32_si128(pair);
+   coeff = _mm_unpacklo_epi16(coeff, coeff);
+   return _mm_unpacklo_epi32(coeff, coeff);
+}
 
-         for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2,
-               input_base_y += (ctx->scaled.stride >> 2))
-         {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
+/* Two neighbouring input pixels, expanded to 15 bits per channel */
+static INLINE __m128i scaler_load_pair_sse2(const uint32_t *input)
+{
+   __m128i col = _mm_loadl_epi64((const __m128i*)input);
+   return _mm_slli_epi16(_mm_unpacklo_epi8(col, _mm_setzero_si128()), 7);
+}
 
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
+/* Filters two output pixels at once, needs an even filter_len.
+ * Returns pixel @w in the low and @w + 1 in the high half. */
+static INLINE __m128i scaler_horiz_two_sse2(const struct scaler_ctx *ctx,
+      const uint32_t *input, int w, const int16_t *filter_horiz)
+{
+   int x;
+   const int16_t *filter_next = filter_horiz + ctx->horiz.filter_stride;
+   const uint32_t *input_0    = input + ctx->horiz.filter_pos[w];
+   const uint32_t *input_1    = input + ctx->horiz.filter_pos[w + 1];
+   __m128i res_0              = _mm_setzero_si128();
+   __m128i res_1              = _mm_setzero_si128();
+
+   for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
+   {
+      res_0 = _mm_adds_epi16(res_0, _mm_mulhi_epi16(
+               scaler_load_pair_sse2(input_0 + x),
+               scaler_coeff_pair_sse2(filter_horiz + x)));
+      res_1 = _mm_adds_epi16(res_1, _mm_mulhi_epi16(
+               scaler_load_pair_sse2(input_1 + x),
+               scaler_coeff_pair_sse2(filter_next + x)));
+   }
 
-         for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
-         {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
+   return _mm_adds_epi16(_mm_unpacklo_epi64(res_0, res_1),
+         _mm_unpackhi_epi64(res_0, res_1));
+}
+#endif
 
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
+void scaler_argb8888_vert(const struct scaler_ctx *ctx,
+      void *output_, int stride, int first, int last)
+{
+   int h, w, y;
+   const uint64_t      *input = ctx->scaled.frame;
+   uint32_t           *output = (uint32_t*)output_ + first * (stride >> 2);
+   int         scaled_stride  = ctx->scaled.stride >> 3;
 
-         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-         res       = _mm_srai_epi16(res, (7 - 2 - 2));
+   const int16_t *filter_vert = ctx->vert.filter
+      + first * ctx->vert.filter_stride;
 
-         final     = _mm_packus_epi16(res, res);
+   for (h = first; h < last; h++,
+         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
+         * scaled_stride;
+
+      w = 0;
 
-         output[w] = _mm_cvtsi128_si32(final);
-#else
-         int16_t res_a = 0;
-         int16_t res_r = 0;
-         int16_t res_g = 0;
-         int16_t res_b = 0;
+#if defined(__SSE2__)
+      /* Four pixels per iteration, the taps are the same
+       * for the whole line */
+      for (; w + 4 <= ctx->out_width; w += 4)
+      {
+         const uint64_t *input_base_y = input_base + w;
+         __m128i res_0                = _mm_setzero_si128();
+         __m128i res_1                = _mm_setzero_si128();
 
          for (y = 0; y < ctx->vert.filter_len; y++,
-               input_base_y += (ctx->scaled.stride >> 3))
+               input_base_y += scaled_stride)
          {
-            uint64_t col   = *input_base_y;
+            __m128i coeff = _mm_set1_epi16(filter_vert[y]);
+            res_0 = _mm_adds_epi16(res_0, _mm_mulhi_epi16(
+                     _mm_loadu_si128((const __m128i*)input_base_y), coeff));
+            res_1 = _mm_adds_epi16(res_1, _mm_mulhi_epi16(
+                     _mm_loadu_si128((const __m128i*)(input_base_y + 2)), coeff));
+         }
 
-            int16_t a      = (col >> 48) & 0xffff;
-            int16_t r      = (col >> 32) & 0xffff;
-            int16_t g      = (col >> 16) & 0xffff;
-            int16_t b      = (col >>  0) & 0xffff;
+         res_0 = _mm_srai_epi16(res_0, (7 - 2 - 2));
+         res_1 = _mm_srai_epi16(res_1, (7 - 2 - 2));
 
-            int16_t coeff  = filter_vert[y];
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_packus_epi16(res_0, res_1));
+      }
+#elif defined(SCALER_NEON)
+      for (; w + 4 <= ctx->out_width; w += 4)
+      {
+         const int16_t *input_base_y = (const int16_t*)(input_base + w);
+         int16x8_t res_0             = vdupq_n_s16(0);
+         int16x8_t res_1             = vdupq_n_s16(0);
 
-            res_a         += (a * coeff) >> 16;
-            res_r         += (r * coeff) >> 16;
-            res_g         += (g * coeff) >> 16;
-            res_b         += (b * coeff) >> 16;
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += scaled_stride * 4)
+         {
+            int16_t coeff = filter_vert[y];
+            int16x8_t c_0 = vld1q_s16(input_base_y);
+            int16x8_t c_1 = vld1q_s16(input_base_y + 8);
+
+            res_0 = vqaddq_s16(res_0, vcombine_s16(
+                     vshrn_n_s32(vmull_n_s16(vget_low_s16(c_0),  coeff), 16),
+                     vshrn_n_s32(vmull_n_s16(vget_high_s16(c_0), coeff), 16)));
+            res_1 = vqaddq_s16(res_1, vcombine_s16(
+                     vshrn_n_s32(vmull_n_s16(vget_low_s16(c_1),  coeff), 16),
+                     vshrn_n_s32(vmull_n_s16(vget_high_s16(c_1), coeff), 16)));
          }
 
-         res_a           >>= (7 - 2 - 2);
-         res_r           >>= (7 - 2 - 2);
-         res_g           >>= (7 - 2 - 2);
-         res_b           >>= (7 - 2 - 2);
-
-         output[w]         =
-            (clamp_8bit(res_a) << 24) |
-            (clamp_8bit(res_r) << 16) |
-            (clamp_8bit(res_g) << 8)  |
-            (clamp_8bit(res_b) << 0);
-#endif
+         vst1q_u8((uint8_t*)(output + w), vcombine_u8(
+                  vqshrun_n_s16(res_0, (7 - 2 - 2)),
+                  vqshrun_n_s16(res_1, (7 - 2 - 2))));
       }
+#endif
+
+      for (; w < ctx->out_width; w++)
+         output[w] = scaler_argb8888_vert_pixel(ctx,
+               input_base + w, filter_vert);
    }
 }
 
-void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int stride)
+void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
+      const void *input_, int stride, int first, int last)
 {
-   int h, w, x;
-   const uint32_t *input = (uint32_t*)input_;
-   uint64_t *output      = ctx->scaled.frame;
+   int h, w;
+   const uint32_t *input = (const uint32_t*)input_ + first * (stride >> 2);
+   uint64_t *output      = ctx->scaled.frame
+      + first * (ctx->scaled.stride >> 3);
 
-   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2,
+   for (h = first; h < last; h++, input += stride >> 2,
          output += ctx->scaled.stride >> 3)
    {
       const int16_t *filter_horiz = ctx->horiz.filter;
 
-      for (w = 0; w < ctx->scaled.width; w++,
+      w = 0;
+
+#if defined(__SSE2__)
+      if (!(ctx->horiz.filter_len & 1))
+      {
+         for (; w + 2 <= ctx->scaled.width; w += 2,
+               filter_horiz += ctx->horiz.filter_stride * 2)
+            _mm_storeu_si128((__m128i*)(output + w),
+                  scaler_horiz_two_sse2(ctx, input, w, filter_horiz));
+      }
+#elif defined(SCALER_NEON)
+      for (; w < ctx->scaled.width; w++,
             filter_horiz += ctx->horiz.filter_stride)
       {
+         int x;
          const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
-#if defined(__SSE2__)
-         __m128i res = _mm_setzero_si128();
-#ifndef __x86_64__
-         union
-         {
-            uint32_t *u32;
-            uint64_t *u64;
-         } u;
-#endif
-         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
-         {
-            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
-
-            __m128i col   = _mm_unpacklo_epi8(_mm_set_epi64x(0,
-                     ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
-
-            col           = _mm_slli_epi16(col, 7);
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
-
-         for (; x < ctx->horiz.filter_len; x++)
-         {
-            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
-            __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
-
-            col           = _mm_slli_epi16(col, 7);
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
-
-         res              = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-
-#ifdef __x86_64__
-         output[w]        = _mm_cvtsi128_si64(res);
-#else /* 32-bit doesn't have si64. Do it in two steps. */
-         u.u64    = output + w;
-         u.u32[0] = _mm_cvtsi128_si32(res);
-         u.u32[1] = _mm_cvtsi128_si32(_mm_srli_si128(res, 4));
-#endif
-#else
-         int16_t res_a = 0;
-         int16_t res_r = 0;
-         int16_t res_g = 0;
-         int16_t res_b = 0;
+         int16x4_t res                = vdup_n_s16(0);
 
          for (x = 0; x < ctx->horiz.filter_len; x++)
          {
-            uint32_t col   = input_base_x[x];
-
-            int16_t a      = (col >> (24 - 7)) & (0xff << 7);
-            int16_t r      = (col >> (16 - 7)) & (0xff << 7);
-            int16_t g      = (col >> ( 8 - 7)) & (0xff << 7);
-            int16_t b      = (col << ( 0 + 7)) & (0xff << 7);
-
-            int16_t coeff  = filter_horiz[x];
-
-            res_a         += (a * coeff) >> 16;
-            res_r         += (r * coeff) >> 16;
-            res_g         += (g * coeff) >> 16;
-            res_b         += (b * coeff) >> 16;
+            int16x4_t col = vreinterpret_s16_u16(vshl_n_u16(vget_low_u16(
+                        vmovl_u8(vreinterpret_u8_u32(
+                              vdup_n_u32(input_base_x[x])))), 7));
+            res           = vqadd_s16(res, vshrn_n_s32(
+                     vmull_n_s16(col, filter_horiz[x]), 16));
          }
 
-         output[w]         = (
-               (uint64_t)res_a  << 48)  |
-               ((uint64_t)res_r << 32)  |
-               ((uint64_t)res_g << 16)  |
-               ((uint64_t)res_b << 0);
-#endif
+         vst1_s16((int16_t*)(output + w), res);
       }
+#endif
+
+      for (; w < ctx->scaled.width; w++,
+            filter_horiz += ctx->horiz.filter_stride)
+         output[w] = scaler_argb8888_horiz_pixel(ctx,
+               input + ctx->horiz.filter_pos[w], filter_horiz);
    }
 }
 
@@ -246,7 +246,8 @@ RHMAP__UNUSED static ptrdiff_t rhmap__idx(struct rhmap__hdr* hdr, uint32_t key,
             hdr->key_strs[i] = NULL;
             while ((key = hdr->keys[i = (i + 1) & hdr->maxlen]) != 0)
             {
-               if ((key = (uint32_t)rhmap__idx(hdr, key, str, 1, 0)) == i) continue;
+               /* re-add the following keys with their own strings */
+               if ((key = (uint32_t)rhmap__idx(hdr, key, hdr->key_strs[i], 1, 0)) == i) continue;
                hdr->len--;
                hdr->keys[i] = 0;
                free(hdr->key_strs[i]);
@@ -66,6 +66,12 @@ audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_flac(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_mp3(void *buffer, int32_t size);
 
+/* Streams the sound from @path instead of keeping it in memory.
+ * Every voice playing it opens its own handle and decodes small
+ * chunks on demand. Only WAV, FLAC and MP3 can be streamed. */
+audio_mixer_sound_t* audio_mixer_load_file(const char *path,
+      enum audio_mixer_type type);
+
 void audio_mixer_destroy(audio_mixer_sound_t* sound);
 
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
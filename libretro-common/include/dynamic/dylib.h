@@ -53,6 +53,19 @@ typedef void (*function_t)(void);
  **/
 dylib_t dylib_load(const char *path);
 
+/**
+ * dylib_load_isolated:
+ * @path                         : Path to libretro core library.
+ *
+ * Loads a second, independent instance of a library,
+ * where the platform supports it (dlmopen). Libraries it
+ * pulls in are loaded again as well, which not all of
+ * them survive (e.g. GL drivers, older libpthread).
+ *
+ * Returns: library handle on success, otherwise NULL.
+ **/
+dylib_t dylib_load_isolated(const char *path);
+
 /**
  * dylib_close:
  * @lib                          : Library handle.
@@ -30,6 +30,10 @@
 
 RETRO_BEGIN_DECLS
 
+/* Updates @crc, 0 to start with, over the next @len bytes,
+ * so large inputs can be hashed chunk by chunk. Uses the
+ * CPU's carry-less multiply or CRC32 instructions where
+ * available. */
 uint32_t encoding_crc32(uint32_t crc, const uint8_t *buf, size_t len);
 uint32_t file_crc32(uint32_t crc, const char *path);
 
@@ -27,6 +27,7 @@
 
 #include <stdint.h>
 
+#include <boolean.h>
 #include <libretro.h>
 
 RETRO_BEGIN_DECLS
@@ -68,6 +69,18 @@ uint64_t cpu_features_get(void);
  **/
 unsigned cpu_features_get_core_amount(void);
 
+/**
+ * cpu_features_get_core_classes:
+ * @big                  : mask of the fastest CPU cores
+ * @little               : mask of all other CPU cores
+ *
+ * Sorts the CPU cores of a heterogeneous system (e.g. ARM
+ * big.LITTLE) by their maximum performance.
+ *
+ * Returns: false if the performance of the cores is unknown.
+ **/
+bool cpu_features_get_core_classes(uint64_t *big, uint64_t *little);
+
 void cpu_features_get_model_name(char *name, int len);
 
 RETRO_END_DECLS
@@ -147,6 +147,47 @@ void file_archive_parse_file_iterate_stop(file_archive_transfer_t *state);
 
 int file_archive_parse_file_progress(file_archive_transfer_t *state);
 
+/* Keeps the directories of the most recently parsed
+ * archives in memory, keyed by path, size and modification
+ * time, so that listing or reading from them again skips
+ * finding and reading the directory. Until this is called,
+ * nothing is cached. Not thread safe, call before archives
+ * are accessed from other threads. */
+void file_archive_directory_cache_init(void);
+
+void file_archive_directory_cache_deinit(void);
+
+/* For backends: returns a copy of the cached directory
+ * of the archive opened by 'state' to be freed by the
+ * caller, or NULL if there is none */
+uint8_t *file_archive_directory_cache_get(
+      const file_archive_transfer_t *state, const char *path,
+      size_t *len, unsigned *entries);
+
+void file_archive_directory_cache_put(
+      const file_archive_transfer_t *state, const char *path,
+      const uint8_t *data, size_t len, unsigned entries);
+
+/* Keeps the most recently extracted entries of archives
+ * in memory, keyed by archive path, size, modification
+ * time and entry name, up to a total size cap, so that
+ * loading the same content again does not decompress it
+ * again. Used by backends whose entries are expensive
+ * to extract. Not thread safe, call before archives are
+ * accessed from other threads. */
+void file_archive_extract_cache_init(void);
+
+void file_archive_extract_cache_deinit(void);
+
+/* For backends: returns a copy of the cached entry, with
+ * a terminating \0 not counted in 'len', to be freed by
+ * the caller, or NULL if there is none */
+void *file_archive_extract_cache_get(const char *path,
+      const char *entry_name, int64_t *len);
+
+void file_archive_extract_cache_put(const char *path,
+      const char *entry_name, const void *data, int64_t len);
+
 /**
  * file_archive_extract_file:
  * @archive_path                    : filename path to ZIP archive.
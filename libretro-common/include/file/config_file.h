@@ -60,6 +60,7 @@ struct config_file
    struct config_entry_list *tail;
    struct config_entry_list *last;
    struct config_include_list *includes;
+   struct config_file_arena *arenas;
    unsigned include_depth;
    bool guaranteed_no_duplicates;
    bool modified;
@@ -97,15 +98,22 @@ void config_file_initialize(struct config_file *conf);
  * Includes cb callbacks to run custom code during config file processing.*/
 config_file_t *config_file_new_with_callback(const char *path, config_file_cb_t *cb);
 
-/* Load a config file from a string.
- * > WARNING: This will modify 'from_string'.
- *   Pass a copy of source string if original
- *   contents must be preserved */
+/* Load a config file from a string, which
+ * is copied */
 config_file_t *config_file_new_from_string(char *from_string,
       const char *path);
 
 config_file_t *config_file_new_from_path_to_string(const char *path);
 
+/* Same as config_file_new_from_path_to_string(), but
+ * reads the entries from the binary snapshot at
+ * 'cache_path' if this was written for the current
+ * size and modification time of 'path'. Otherwise
+ * the file is parsed and the snapshot rewritten.
+ * Files using #include directives are not cached. */
+config_file_t *config_file_new_from_path_cached(const char *path,
+      const char *cache_path);
+
 /* Frees config file. */
 void config_file_free(config_file_t *conf);
 
@@ -122,6 +130,9 @@ bool config_append_file(config_file_t *conf, const char *path);
 
 bool config_entry_exists(config_file_t *conf, const char *entry);
 
+/* Keys and values belong to the config file, they
+ * may point into the text it was parsed from and
+ * must not be freed or taken over by callers */
 struct config_entry_list
 {
    char *key;
@@ -87,6 +87,11 @@ void image_transfer_set_buffer_ptr(
       void *ptr,
       size_t len);
 
+void image_transfer_set_max_size(
+      void *data,
+      enum image_type_enum type,
+      unsigned max_size);
+
 int image_transfer_process(
       void *data,
       enum image_type_enum type,
@@ -39,6 +39,12 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf,
 
 bool rjpeg_set_buf_ptr(rjpeg_t *rjpeg, void *data);
 
+/* Allows the decoder to skip DCT coefficients so that the
+ * output is the smallest of 1/1, 1/2, 1/4 and 1/8 of the
+ * image size whose largest side is still at least max_size
+ * pixels. 0 (default) decodes at full size. */
+void rjpeg_set_max_size(rjpeg_t *rjpeg, unsigned max_size);
+
 void rjpeg_free(rjpeg_t *rjpeg);
 
 rjpeg_t *rjpeg_alloc(void);
@@ -56,9 +56,20 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch);
 
+/* Filters and deflates horizontal bands of the image on up
+ * to @threads threads, at the fastest compression level.
+ * Larger output than rpng_save_image_bgr24(), but it takes
+ * a fraction of the time on big images. */
+bool rpng_save_image_bgr24_fast(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned threads);
+
 uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
       unsigned width, unsigned height, signed pitch, uint64_t *bytes);
 
+/* As above, at the fastest compression level. */
+uint8_t* rpng_save_image_bgr24_string_fast(const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t *bytes);
+
 RETRO_END_DECLS
 
 #endif
@@ -23,12 +23,24 @@
 #ifndef __LIBRETRO_SDK_SCALER_PIXCONV_H__
 #define __LIBRETRO_SDK_SCALER_PIXCONV_H__
 
+#include <stdint.h>
+
 #include <clamping.h>
 
 #include <retro_common_api.h>
 
 RETRO_BEGIN_DECLS
 
+/**
+ * conv_set_simd_mask:
+ * @simd             : RETRO_SIMD_* features the conversions may use.
+ *
+ * Restricts the conversion kernels to @simd and what the CPU
+ * supports, 0 forces the plain C paths. By default everything
+ * cpu_features_get() reports is used.
+ **/
+void conv_set_simd_mask(uint64_t simd);
+
 void conv_0rgb1555_argb8888(void *output, const void *input,
       int width, int height,
       int out_stride, int in_stride);
@@ -101,6 +113,12 @@ void conv_yuyv_argb8888(void *output, const void *input,
       int width, int height,
       int out_stride, int in_stride);
 
+/* Semi-planar 4:2:0, the interleaved UV plane follows the
+ * Y plane at in_stride * height and shares its stride. */
+void conv_nv12_argb8888(void *output, const void *input,
+      int width, int height,
+      int out_stride, int in_stride);
+
 void conv_copy(void *output, const void *input,
       int width, int height,
       int out_stride, int in_stride);
@@ -40,7 +40,8 @@ enum scaler_pix_fmt
    SCALER_FMT_RGB565,
    SCALER_FMT_BGR24,
    SCALER_FMT_YUYV,
-   SCALER_FMT_RGBA4444
+   SCALER_FMT_RGBA4444,
+   SCALER_FMT_NV12
 };
 
 enum scaler_type
@@ -59,12 +60,18 @@ struct scaler_filter
    int      filter_stride;
 };
 
+struct tpool;
+struct tpool_group;
+struct scaler_band;
+
 struct scaler_ctx
 {
+   /* Filter lines [first, last) of the intermediate
+    * (horizontally scaled) and output image respectively */
    void (*scaler_horiz)(const struct scaler_ctx*,
-         const void*, int);
+         const void*, int, int, int);
    void (*scaler_vert)(const struct scaler_ctx*,
-         void*, int);
+         void*, int, int, int);
    void (*scaler_special)(const struct scaler_ctx*,
          void*, const void*, int, int, int, int, int, int);
 
@@ -73,6 +80,12 @@ struct scaler_ctx
    void (*direct_pixconv)(void*, const void*, int, int, int, int);
    struct scaler_filter horiz, vert;   /* ptr alignment */
 
+   /* Workers and line bands for the filtered path, pool is
+    * only set when the shared pool was not available */
+   struct tpool *pool;
+   struct tpool_group *group;
+   struct scaler_band *bands;
+
    struct
    {
       uint32_t *frame;
@@ -105,6 +118,12 @@ struct scaler_ctx
    enum scaler_pix_fmt out_fmt;
    enum scaler_type scaler_type;
 
+   /* Threads to split bilinear and sinc scaling over, the calling
+    * thread included. Needs HAVE_THREADS, 0 and 1 keep all the
+    * work on the calling thread. */
+   unsigned threads;
+   unsigned num_bands;
+
    bool unscaled;
 };
 
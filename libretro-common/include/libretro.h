@@ -1966,6 +1966,7 @@ struct retro_log_callback
 #define RETRO_SIMD_MOVBE    (1 << 19)
 #define RETRO_SIMD_CMOV     (1 << 20)
 #define RETRO_SIMD_ASIMD    (1 << 21)
+#define RETRO_SIMD_FMA      (1 << 22)
 
 typedef uint64_t retro_perf_tick_t;
 typedef int64_t retro_time_t;
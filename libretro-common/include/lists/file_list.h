@@ -44,10 +44,18 @@ struct item_file
    unsigned type;
 };
 
+struct file_list_strings;
+
 typedef struct file_list
 {
    struct item_file *list;
 
+   /* Backing store of the path, label and alt strings
+    * of all entries; identical strings are shared.
+    * Entry strings must only be changed through the
+    * file_list_* functions. */
+   struct file_list_strings *strings;
+
    size_t capacity;
    size_t size;
 } file_list_t;
@@ -123,6 +131,9 @@ void file_list_free_userdata(const file_list_t *list, size_t index);
 
 void file_list_free_actiondata(const file_list_t *list, size_t idx);
 
+void file_list_set_path_at_offset(file_list_t *list, size_t index,
+      const char *path);
+
 void file_list_set_label_at_offset(file_list_t *list, size_t index,
       const char *label);
 
@@ -132,6 +143,20 @@ void file_list_get_label_at_offset(const file_list_t *list, size_t index,
 void file_list_set_alt_at_offset(file_list_t *list, size_t index,
       const char *alt);
 
+/**
+ * @brief appends a copy of an entry of another list
+ *
+ * Copies path, label, alt, type, directory_ptr and entry_idx.
+ * userdata and actiondata are left NULL.
+ *
+ * @param list List to append to
+ * @param src List to copy from
+ * @param index Index of the entry in src
+ * @return whether or not the operation succeeded
+ */
+bool file_list_append_copy(file_list_t *list, const file_list_t *src,
+      size_t index);
+
 void file_list_set_userdata(const file_list_t *list, size_t idx, void *ptr);
 
 void file_list_set_actiondata(const file_list_t *list, size_t idx, void *ptr);
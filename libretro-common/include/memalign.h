@@ -35,6 +35,24 @@ void *memalign_alloc_aligned(size_t size);
 
 void memalign_free(void *ptr);
 
+/**
+ * memalign_alloc_large:
+ * @size                 : size of the buffer
+ *
+ * Allocates a zeroed, cacheline aligned buffer meant for
+ * large buffers touched every frame (e.g. savestates).
+ * Buffers of at least 2 MB are backed by huge pages when
+ * the system provides them (MAP_HUGETLB or transparent
+ * huge pages on Linux, large pages on Windows), which
+ * saves TLB misses.
+ *
+ * Returns: the buffer, to be freed with memalign_free_large(),
+ * or NULL if out of memory.
+ **/
+void *memalign_alloc_large(size_t size);
+
+void memalign_free_large(void *ptr);
+
 RETRO_END_DECLS
 
 #endif
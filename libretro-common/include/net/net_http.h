@@ -44,10 +44,26 @@ void net_http_connection_free(struct http_connection_t *conn);
 
 void net_http_connection_set_user_agent(struct http_connection_t* conn, const char* user_agent);
 
+/* Extra request header lines, each one terminated by "\r\n".
+ * They are sent as-is by the next net_http_new(). */
+void net_http_connection_set_headers(struct http_connection_t *conn, const char *headers);
+
 const char *net_http_connection_url(struct http_connection_t *conn);
 
 struct http_t *net_http_new(struct http_connection_t *conn);
 
+/* Receives the response body piece by piece as it arrives.
+ * Return false to abort the transfer. */
+typedef bool (*net_http_sink_t)(void *userdata,
+      const uint8_t *data, size_t len);
+
+/* Streams the body of a successful (20x) response to 'sink'
+ * instead of collecting it, so net_http_data() has nothing
+ * to return. Bodies of other responses are collected as
+ * usual. Must be set before the first net_http_update(). */
+void net_http_set_sink(struct http_t *state,
+      net_http_sink_t sink, void *userdata);
+
 /* You can use this to call net_http_update
  * only when something will happen; select() it for reading. */
 int net_http_fd(struct http_t *state);
@@ -59,6 +75,17 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total);
 /* 200, 404, or whatever.  */
 int net_http_status(struct http_t *state);
 
+/* Content-Length header of the response, 0 if there was none.
+ * Also set for HEAD requests, which have no body. */
+size_t net_http_content_length(struct http_t *state);
+
+/* ETag and Last-Modified headers of the response,
+ * NULL if the server did not send them. Owned by
+ * the HTTP handler. */
+const char *net_http_etag(struct http_t *state);
+
+const char *net_http_last_modified(struct http_t *state);
+
 bool net_http_error(struct http_t *state);
 
 /* Returns the downloaded data. The returned buffer is owned by the
@@ -67,9 +94,20 @@ bool net_http_error(struct http_t *state);
  * If the status is not 20x and accept_error is false, it returns NULL. */
 uint8_t* net_http_data(struct http_t *state, size_t* len, bool accept_error);
 
-/* Cleans up all memory. */
+/* Cleans up all memory. If the server agreed to keep the
+ * connection alive and the response was read in full, it is
+ * handed back to the connection pool. */
 void net_http_delete(struct http_t *state);
 
+/* Enables reuse of keep-alive connections between requests
+ * to the same server. Until this is called, every request
+ * uses (and closes) its own connection. Safe to call more
+ * than once. */
+void net_http_pool_init(void);
+
+/* Closes all idle connections and disables the pool. */
+void net_http_pool_deinit(void);
+
 /* URL Encode a string */
 void net_http_urlencode(char **dest, const char *source);
 
@@ -55,13 +55,13 @@ struct natt_status
    struct sockaddr_in6 ext_inet6_addr;
 #endif
 
-   /** Internal status (currently unused) */
+   /** Internal status, allocated by natt_new() */
    void *internal;
 };
 
 /**
- * Initialize global NAT traversal structures (must be called once to use other
- * functions) */
+ * Initialize global NAT traversal structures. Does not block, router discovery
+ * happens in natt_open_port_any(). */
 void natt_init(void);
 
 /** Initialize a NAT traversal status object */
@@ -71,12 +71,18 @@ bool natt_new(struct natt_status *status);
 void natt_free(struct natt_status *status);
 
 /**
- * Make a port forwarding request when only the port is known. Forwards any
- * address it can find. */
+ * Make a port forwarding request when only the port is known. UPnP, NAT-PMP
+ * and PCP requests are all sent at once and do not wait for an answer, except
+ * when a router found by an earlier request can map the port right away.
+ * Returns false if no request could be sent. Poll natt_read() until
+ * request_outstanding is cleared. */
 bool natt_open_port_any(struct natt_status *status, uint16_t port,
    enum socket_protocol proto);
 
-/** Check for port forwarding responses */
+/**
+ * Check for port forwarding responses without blocking, retransmit lost
+ * requests and give up after a few seconds. Returns true once a mapping was
+ * made, have_inet4 or have_inet6 then hold the external address. */
 bool natt_read(struct natt_status *status);
 
 RETRO_END_DECLS
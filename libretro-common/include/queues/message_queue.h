@@ -47,20 +47,44 @@ typedef struct queue_elem
 {
    char *msg;
    char *title;
+   struct queue_elem *next; /* Posted, not yet collected */
    unsigned duration;
    unsigned prio;
    enum message_queue_icon icon;
    enum message_queue_category category;
+   bool flush;
 } queue_elem_t;
 
 typedef struct msg_queue
 {
    char *tmp_msg;
    queue_elem_t **elems;
+   /* Messages posted by any thread, newest first.
+    * Only accessed through atomic operations */
+   queue_elem_t *volatile posted;
+   /* Number of messages in 'posted' */
+   volatile long posted_count;
+   /* Protects 'posted' and 'posted_count' where
+    * the compiler has no atomic operations */
+   struct slock *post_lock;
    size_t ptr;
    size_t size;
 } msg_queue_t;
 
+/* Most messages msg_queue_post() lets wait
+ * for msg_queue_collect() */
+#define MSG_QUEUE_MAX_POSTED 256
+
+/**
+ * (*msg_queue_collect_t):
+ * @userdata          : userdata passed to msg_queue_collect()
+ * @elem              : posted message
+ *
+ * Returns: true if the callback took care of the message,
+ * false to add it to the queue.
+ **/
+typedef bool (*msg_queue_collect_t)(void *userdata, const queue_elem_t *elem);
+
 typedef struct
 {
    unsigned duration;
@@ -100,6 +124,53 @@ void msg_queue_push(msg_queue_t *queue, const char *msg,
       char *title,
       enum message_queue_icon icon, enum message_queue_category category);
 
+/**
+ * msg_queue_post:
+ * @queue             : pointer to queue object
+ * @msg               : message to add to the queue
+ * @prio              : priority level of the message
+ * @duration          : how many times the message can be pulled
+ *                      before it vanishes
+ * @flush             : clear the queue before adding the message
+ *
+ * Same as msg_queue_push(), but safe to call from any thread
+ * without holding a lock. The message only becomes part of
+ * the queue once the thread owning it calls msg_queue_collect().
+ *
+ * Returns: true if the message was posted, false if it could
+ * not be allocated or MSG_QUEUE_MAX_POSTED messages are
+ * already waiting.
+ **/
+bool msg_queue_post(msg_queue_t *queue, const char *msg,
+      unsigned prio, unsigned duration, bool flush,
+      char *title,
+      enum message_queue_icon icon, enum message_queue_category category);
+
+/**
+ * msg_queue_collect:
+ * @queue             : pointer to queue object
+ * @cb                : optional callback, may take over messages
+ * @userdata          : userdata passed to @cb
+ *
+ * Moves all messages posted so far into the queue, oldest
+ * first, so priorities are only sorted out here.
+ *
+ * Returns: number of messages collected.
+ **/
+size_t msg_queue_collect(msg_queue_t *queue,
+      msg_queue_collect_t cb, void *userdata);
+
+/**
+ * msg_queue_has_posted:
+ * @queue             : pointer to queue object
+ *
+ * Safe to call from any thread, though the answer
+ * may be outdated by the time it returns.
+ *
+ * Returns: true if messages wait for msg_queue_collect().
+ **/
+bool msg_queue_has_posted(msg_queue_t *queue);
+
 /**
  * msg_queue_pull:
  * @queue             : pointer to queue object
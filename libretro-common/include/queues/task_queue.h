@@ -34,6 +34,8 @@
 
 RETRO_BEGIN_DECLS
 
+#define TASK_QUEUE_MAX_WORKERS 8
+
 enum task_type
 {
    TASK_TYPE_NONE,
@@ -44,6 +46,28 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/* When several tasks are ready, workers take the one
+ * with the lowest priority value first */
+enum task_priority
+{
+   /* The user is waiting for it (default) */
+   TASK_PRIORITY_INTERACTIVE = 0,
+   /* Downloads and other long running work */
+   TASK_PRIORITY_BACKGROUND,
+   /* Scans and other work that may take minutes */
+   TASK_PRIORITY_BULK
+};
+
+enum task_affinity
+{
+   /* Runs on the primary worker only, so it never runs at the
+    * same time as another such task (default, for handlers
+    * that are not thread safe) */
+   TASK_AFFINITY_PRIMARY = 0,
+   /* May run on any worker of the threaded task queue */
+   TASK_AFFINITY_ANY
+};
+
 typedef struct retro_task retro_task_t;
 typedef void (*retro_task_callback_t)(retro_task_t *task,
       void *task_data,
@@ -62,6 +86,8 @@ typedef bool (*retro_task_retriever_t)(retro_task_t *task, void *data);
 
 typedef bool (*retro_task_condition_fn_t)(void *data);
 
+typedef void (*retro_task_queue_trace_t)(retro_task_t *task, bool begin);
+
 typedef struct
 {
    char *source_file;
@@ -115,6 +141,10 @@ struct retro_task
 
    enum task_type type;
 
+   enum task_priority priority;
+
+   enum task_affinity affinity;
+
    /* if set to true, frontend will
    use an alternative look for the
    task progress display */
@@ -130,6 +160,9 @@ struct retro_task
 
    /* if true no OSD messages will be displayed. */
    bool mute;
+
+   /* don't touch this, set while a worker runs the handler. */
+   bool busy;
 };
 
 typedef struct task_finder_data
@@ -197,6 +230,17 @@ void task_queue_unset_threaded(void);
 
 bool task_queue_is_threaded(void);
 
+/* Sets the number of worker threads used by the
+ * threaded task queue, clamped to 1 to TASK_QUEUE_MAX_WORKERS.
+ * Takes effect the next time the threaded task queue
+ * is initialized. */
+void task_queue_set_worker_count(unsigned count);
+
+/* Sets a callback invoked right before (@begin true) and
+ * after each call of a task handler, on the thread running
+ * the handler. Used for tracing; NULL disables it. */
+void task_queue_set_trace_cb(retro_task_queue_trace_t cb);
+
 /**
  * Calls func for every running task
  * until it returns true.
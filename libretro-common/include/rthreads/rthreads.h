@@ -36,6 +36,25 @@ typedef struct sthread sthread_t;
 typedef struct slock slock_t;
 typedef struct scond scond_t;
 
+/* What a thread is used for, selecting the scheduling
+ * policy it runs with (see sthread_set_role_policy()) */
+enum sthread_role
+{
+   STHREAD_ROLE_NONE = 0,
+   STHREAD_ROLE_MAIN,
+   STHREAD_ROLE_VIDEO,
+   STHREAD_ROLE_AUDIO,
+   STHREAD_ROLE_TASK,
+   STHREAD_ROLE_RECORD,
+   STHREAD_ROLE_LAST
+};
+
+typedef struct sthread_policy
+{
+   uint64_t cpu_mask; /* CPUs the thread may run on, 0 for any */
+   int priority;      /* < 0 below normal, 0 default, > 0 above normal */
+} sthread_policy_t;
+
 #ifdef HAVE_THREAD_STORAGE
 typedef unsigned sthread_tls_t;
 #endif
@@ -69,6 +88,42 @@ sthread_t *sthread_create(void (*thread_func)(void*), void *userdata);
  */
 sthread_t *sthread_create_with_priority(void (*thread_func)(void*), void *userdata, int thread_priority);
 
+/**
+ * sthread_create_with_role:
+ * @start_routine           : thread entry callback function
+ * @userdata                : pointer to userdata that will be made
+ *                            available in thread entry callback function
+ * @role                    : what the thread is used for
+ *
+ * Create a new thread, which applies the policy of @role
+ * before running @start_routine.
+ *
+ * Returns: pointer to new thread if successful, otherwise NULL.
+ */
+sthread_t *sthread_create_with_role(void (*thread_func)(void*), void *userdata, enum sthread_role role);
+
+/**
+ * sthread_set_role_policy:
+ * @role                    : thread role
+ * @policy                  : scheduling policy, NULL for the default
+ *
+ * Sets the policy of threads with @role created from now on.
+ * Affinity is supported on Linux and Windows, priority on
+ * Linux (niceness, raising it may need privileges) and Windows.
+ */
+void sthread_set_role_policy(enum sthread_role role, const sthread_policy_t *policy);
+
+/**
+ * sthread_apply_role:
+ * @role                    : thread role
+ *
+ * Applies the policy of @role to the calling thread, for
+ * threads not created by rthreads (e.g. the main thread).
+ *
+ * Returns: false if the policy could not (fully) be applied.
+ */
+bool sthread_apply_role(enum sthread_role role);
+
 /**
  * sthread_detach:
  * @thread                  : pointer to thread object
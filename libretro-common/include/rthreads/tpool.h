@@ -40,6 +40,9 @@ RETRO_BEGIN_DECLS
 struct tpool;
 typedef struct tpool tpool_t;
 
+struct tpool_group;
+typedef struct tpool_group tpool_group_t;
+
 /** 
  * (*thread_func_t):
  * @arg           : Argument.
@@ -48,6 +51,16 @@ typedef struct tpool tpool_t;
  **/
 typedef void (*thread_func_t)(void *arg);
 
+/**
+ * (*tpool_range_func_t):
+ * @arg           : Argument.
+ * @begin         : First index of the range.
+ * @end           : One past the last index of the range.
+ *
+ * Callback function tpool_parallel_for() calls for each range.
+ **/
+typedef void (*tpool_range_func_t)(void *arg, size_t begin, size_t end);
+
 /**
  * tpool_create:
  * @num           : Number of threads the pool should have.
@@ -91,6 +104,94 @@ bool tpool_add_work(tpool_t *tp, thread_func_t func, void *arg);
  */
 void tpool_wait(tpool_t *tp);
 
+/**
+ * tpool_get_thread_count:
+ * @tp            : Thread pool.
+ *
+ * Returns: number of worker threads in the pool, 0 if @tp is NULL.
+ */
+size_t tpool_get_thread_count(tpool_t *tp);
+
+/**
+ * tpool_group_new:
+ *
+ * Create a wait group tracking a batch of work, so callers
+ * sharing a pool can wait for their own work only.
+ *
+ * Returns: wait group, or NULL on failure.
+ */
+tpool_group_t *tpool_group_new(void);
+
+/**
+ * tpool_group_free:
+ * @group         : Wait group.
+ *
+ * Free a wait group. It must not have any outstanding work.
+ */
+void tpool_group_free(tpool_group_t *group);
+
+/**
+ * tpool_group_add_work:
+ * @tp            : Thread pool.
+ * @group         : Wait group the work belongs to.
+ * @func          : Function the pool should call.
+ * @arg           : Argument to pass to func.
+ *
+ * Add work to a thread pool as part of @group.
+ *
+ * Returns: true if work was added, otherwise false.
+ **/
+bool tpool_group_add_work(tpool_t *tp, tpool_group_t *group,
+      thread_func_t func, void *arg);
+
+/**
+ * tpool_group_wait:
+ * @tp            : Thread pool the work was added to.
+ * @group         : Wait group.
+ *
+ * Wait for all work of @group to be completed. The calling
+ * thread runs queued work of the pool meanwhile, which also
+ * makes it safe to wait from within a work function.
+ */
+void tpool_group_wait(tpool_t *tp, tpool_group_t *group);
+
+/**
+ * tpool_parallel_for:
+ * @tp            : Thread pool, runs everything inline if NULL.
+ * @count         : Number of indices.
+ * @grain         : Indices per range, 0 picks a few ranges per thread.
+ * @func          : Function to call for each range.
+ * @arg           : Argument to pass to func.
+ *
+ * Split [0, @count) into ranges, run them on the pool and
+ * the calling thread, and return once all of them are done.
+ */
+void tpool_parallel_for(tpool_t *tp, size_t count, size_t grain,
+      tpool_range_func_t func, void *arg);
+
+/**
+ * tpool_shared_init:
+ * @num           : Number of threads the pool should have.
+ *
+ * Create the pool shared by short lived parallel work,
+ * so it does not need a pool of its own.
+ */
+void tpool_shared_init(size_t num);
+
+/**
+ * tpool_shared_deinit:
+ *
+ * Destroy the shared pool.
+ */
+void tpool_shared_deinit(void);
+
+/**
+ * tpool_shared:
+ *
+ * Returns: the shared pool, or NULL if it was not created.
+ */
+tpool_t *tpool_shared(void);
+
 RETRO_END_DECLS
 
 #endif
@@ -110,6 +110,13 @@ bool intfstream_is_compressed(intfstream_internal_t *intf);
 
 bool intfstream_get_crc(intfstream_internal_t *intf, uint32_t *crc);
 
+/* CRC32 of @size bytes from @offset on, or of everything
+ * up to the end when @size is negative. Reads the stream in
+ * fixed size chunks, so it is safe on large files. Returns
+ * false on read errors and when the range runs past the end. */
+bool intfstream_get_crc_range(intfstream_internal_t *intf,
+      int64_t offset, int64_t size, uint32_t *crc);
+
 intfstream_t *intfstream_open_file(const char *path,
       unsigned mode, unsigned hints);
 
@@ -66,9 +66,40 @@ RETRO_BEGIN_DECLS
  * ...
  * <size of next compressed chunk> : repeated until end of file
  * <next compressed chunk>         :
+ * <chunk offset table>:            8 bytes per chunk, little endian order
+ *                                  - file offset of each chunk size field
+ *                                  - only present for files holding more
+ *                                    than one chunk
+ * <number of chunks>:              4 bytes, little endian order
+ * <table id footer>:               8 bytes
+ *                                  - [#][R][Z][I][P][I][X][#]
+ * 
+ * Chunks are (de)compressed in parallel, and the
+ * chunk offset table lets readers seek without
+ * decompressing any data before the target. Files
+ * without a table (written by older versions) can
+ * still be seeked by walking the chunk size fields.
+ * 
+ * Version 2 files have 4 more header bytes after the
+ * total uncompressed data size: the codec (1 byte,
+ * enum rzip_codec) followed by 3 reserved bytes. The
+ * version 1 header is written whenever the codec is
+ * RZIP_CODEC_DEFLATE, so older readers can open the
+ * file.
  * 
  */
 
+/* Compression codec of the chunks of an RZIP file
+ * > RZIP_CODEC_DEFLATE: zlib compressed chunks
+ * > RZIP_CODEC_STORE: uncompressed chunks, for data
+ *   that does not compress or when speed matters more
+ *   than size - still supports seeking */
+enum rzip_codec
+{
+   RZIP_CODEC_DEFLATE = 0,
+   RZIP_CODEC_STORE
+};
+
 /* Prevent direct access to rzipstream_t members */
 typedef struct rzipstream rzipstream_t;
 
@@ -146,12 +177,25 @@ bool rzipstream_write_file(const char *path, const void *data, int64_t len);
 
 /* File Control */
 
+/* Sets the codec used to compress the chunks
+ * of an RZIP file open for writing.
+ * Must be called before any data is written.
+ * Returns false if arguments are invalid or
+ * data has already been written */
+bool rzipstream_set_codec(rzipstream_t *stream, unsigned codec);
+
+/* Sets file position of an RZIP file open for
+ * reading to 'offset' bytes of *uncompressed* data
+ * relative to 'whence' (SEEK_SET, SEEK_CUR or
+ * SEEK_END).
+ * Returns 0 on success, or -1 in the event
+ * of an error */
+int64_t rzipstream_seek(rzipstream_t *stream, int64_t offset, int whence);
+
 /* Sets file position to the beginning of the
  * specified RZIP file.
- * Note: It is not recommended to rewind a file
- * that is open for writing, since the caller
- * may end up with a file containing junk data
- * at the end (harmless, but a waste of space). */
+ * Note: Rewinding a file that is open for writing
+ * discards everything written so far. */
 void rzipstream_rewind(rzipstream_t *stream);
 
 /* File Status */
@@ -82,6 +82,8 @@ struct libretro_vfs_implementation_file
    char *buf;
    char* orig_path;
    uint8_t *mapped;
+   /* Set for read-only files while the read cache is enabled */
+   struct vfs_read_cache *cache;
    int fd;
    unsigned hints;
    enum vfs_scheme scheme;
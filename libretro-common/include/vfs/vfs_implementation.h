@@ -31,6 +31,44 @@
 
 RETRO_BEGIN_DECLS
 
+/* Counters of a file read through the read cache */
+typedef struct retro_vfs_file_stats
+{
+   /* Bytes returned to the caller and read from the device */
+   uint64_t bytes_read;
+   uint64_t bytes_fetched;
+   unsigned reads;
+   /* Reads that had to load a block synchronously */
+   unsigned misses;
+   /* Blocks loaded ahead of time and how many of those were used */
+   unsigned readaheads;
+   unsigned readahead_hits;
+   /* Seeks that moved outside the current block */
+   unsigned seeks;
+} retro_vfs_file_stats_t;
+
+typedef void (*retro_vfs_file_stats_cb_t)(const char *path,
+      const retro_vfs_file_stats_t *stats);
+
+/**
+ * retro_vfs_set_read_cache:
+ * @block_size         : size of a cache block in bytes,
+ *                       0 disables the cache
+ * @stats_cb           : called with the counters of each cached
+ *                       file when it is closed, may be NULL
+ *
+ * Files opened read-only afterwards that are larger than a block
+ * are read in blocks of @block_size. Once a file is read
+ * sequentially the next block is loaded in the background where
+ * threads are available.
+ **/
+void retro_vfs_set_read_cache(size_t block_size,
+      retro_vfs_file_stats_cb_t stats_cb);
+
+/* Returns false if @stream is not read through the cache */
+bool retro_vfs_file_get_stats_impl(libretro_vfs_implementation_file *stream,
+      retro_vfs_file_stats_t *stats);
+
 libretro_vfs_implementation_file *retro_vfs_file_open_impl(const char *path, unsigned mode, unsigned hints);
 
 int retro_vfs_file_close_impl(libretro_vfs_implementation_file *stream);
@@ -193,10 +193,18 @@ void co_switch(cothread_t handle)
 #else
 #define ASM_PREFIX ""
 #endif
+/* With indirect branch tracking, co_switch may be reached through
+ * the PLT or a function pointer and has to start with a landing pad */
+#if defined(__CET__) && (__CET__ & 1)
+#define ASM_ENDBR "endbr64                        \n"
+#else
+#define ASM_ENDBR ""
+#endif
 __asm__(
 ".intel_syntax noprefix         \n"
 ".globl " ASM_PREFIX "co_switch              \n"
 ASM_PREFIX "co_switch:                     \n"
+ASM_ENDBR
 "mov rsi, [rip+" ASM_PREFIX "co_active_handle]\n"
 "mov [rsi],rsp                  \n"
 "mov [rsi+0x08],rbp             \n"
@@ -21,7 +21,14 @@ void genode_free_secondary_stack(void *stack);
     #include "fiber.c"
   #endif
 #elif defined __GNUC__
-  #if defined __i386__
+  /* The assembly switchers move between stacks with a plain
+   * ret, which an enforced hardware shadow stack (x86 CET, arm64
+   * GCS) rejects; glibc's swapcontext keeps one per context.
+   * Distributions build with -fcf-protection by default without
+   * enforcing the shadow stack, so on x86 this is opt-in. */
+  #if defined(LIBCO_SHADOW_STACK) || defined(__ARM_FEATURE_GCS_DEFAULT)
+    #include "ucontext.c"
+  #elif defined __i386__
     #include "x86.c"
   #elif defined __amd64__
     #include "amd64.c"
@@ -22,6 +22,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <retro_common.h>
@@ -29,6 +31,278 @@
 #include <string/stdstring.h>
 #include <compat/strcasestr.h>
 
+/* Strings are allocated from blocks of this size
+ * (or larger, for longer strings) */
+#define FILE_LIST_BLOCK_SIZE 16384
+
+struct file_list_block
+{
+   struct file_list_block *next;
+   size_t size;
+   size_t used;
+   char data[1];
+};
+
+struct file_list_slot
+{
+   char *str;
+   uint32_t hash;
+   unsigned refs;
+};
+
+/* Entry strings live in a chain of blocks that is kept
+ * (and reused) when the list is cleared, so rebuilding
+ * a list does not allocate once the blocks are there.
+ * A hash table shares identical strings between entries
+ * and counts their references; a string that is no
+ * longer referenced is given back when it is the last
+ * one allocated, which covers menu stack push/pop. */
+struct file_list_strings
+{
+   struct file_list_block *first;
+   struct file_list_block *cur;
+   struct file_list_slot *slots;
+   size_t slots_capacity;
+   size_t slots_used;
+};
+
+/* Marks a table slot whose string was given back */
+static char file_list_tombstone;
+
+static uint32_t file_list_string_hash(const char *str, size_t *len)
+{
+   const unsigned char *s = (const unsigned char*)str;
+   uint32_t hash          = 5381;
+
+   while (*s)
+      hash = (hash << 5) + hash + *s++;
+
+   *len = (const char*)s - str;
+   return hash;
+}
+
+static char *file_list_strings_alloc(struct file_list_strings *st,
+      size_t len)
+{
+   char *ret;
+   struct file_list_block *block = st->cur;
+
+   if (!block || block->size - block->used < len)
+   {
+      /* Move on to the next block kept from before
+       * the list was cleared, or make a new one */
+      if (block && block->next && block->next->size >= len)
+      {
+         block       = block->next;
+         block->used = 0;
+      }
+      else
+      {
+         size_t size                 = (len > FILE_LIST_BLOCK_SIZE)
+            ? len : FILE_LIST_BLOCK_SIZE;
+         struct file_list_block *blk = (struct file_list_block*)
+            malloc(offsetof(struct file_list_block, data) + size);
+
+         if (!blk)
+            return NULL;
+
+         blk->size = size;
+         blk->used = 0;
+
+         if (block)
+         {
+            blk->next   = block->next;
+            block->next = blk;
+         }
+         else
+         {
+            blk->next   = st->first;
+            st->first   = blk;
+         }
+
+         block          = blk;
+      }
+
+      st->cur           = block;
+   }
+
+   ret          = block->data + block->used;
+   block->used += len;
+   return ret;
+}
+
+static bool file_list_strings_grow(struct file_list_strings *st)
+{
+   size_t i;
+   size_t capacity             = st->slots_capacity
+      ? st->slots_capacity * 2 : 64;
+   struct file_list_slot *slots = (struct file_list_slot*)
+      calloc(capacity, sizeof(*slots));
+
+   if (!slots)
+      return false;
+
+   st->slots_used = 0;
+
+   for (i = 0; i < st->slots_capacity; i++)
+   {
+      size_t j;
+      struct file_list_slot *slot = &st->slots[i];
+
+      if (!slot->str || slot->str == &file_list_tombstone)
+         continue;
+
+      for (j = slot->hash & (capacity - 1); slots[j].str;
+            j = (j + 1) & (capacity - 1));
+
+      slots[j] = *slot;
+      st->slots_used++;
+   }
+
+   free(st->slots);
+   st->slots          = slots;
+   st->slots_capacity = capacity;
+
+   return true;
+}
+
+/* Returns the list's copy of str, or NULL on failure */
+static char *file_list_string_get(file_list_t *list, const char *str)
+{
+   size_t i, len;
+   uint32_t hash;
+   struct file_list_slot *slot  = NULL;
+   struct file_list_strings *st = list->strings;
+
+   if (!str)
+      return NULL;
+
+   if (!st)
+   {
+      if (!(st = (struct file_list_strings*)calloc(1, sizeof(*st))))
+         return NULL;
+      list->strings = st;
+   }
+
+   if ((st->slots_used + 1) * 4 > st->slots_capacity * 3)
+      if (!file_list_strings_grow(st))
+         return NULL;
+
+   hash = file_list_string_hash(str, &len);
+
+   for (i = hash & (st->slots_capacity - 1); st->slots[i].str;
+         i = (i + 1) & (st->slots_capacity - 1))
+   {
+      struct file_list_slot *cur = &st->slots[i];
+
+      if (cur->str == &file_list_tombstone)
+      {
+         if (!slot)
+            slot = cur;
+      }
+      else if (cur->hash == hash && string_is_equal(cur->str, str))
+      {
+         cur->refs++;
+         return cur->str;
+      }
+   }
+
+   if (!slot)
+   {
+      slot = &st->slots[i];
+      st->slots_used++;
+   }
+
+   if (!(slot->str = file_list_strings_alloc(st, len + 1)))
+   {
+      slot->str = &file_list_tombstone;
+      return NULL;
+   }
+
+   memcpy(slot->str, str, len + 1);
+   slot->hash = hash;
+   slot->refs = 1;
+
+   return slot->str;
+}
+
+/* Drops a reference to a string returned by
+ * file_list_string_get() */
+static void file_list_string_put(file_list_t *list, char *str)
+{
+   size_t i, len;
+   uint32_t hash;
+   struct file_list_strings *st = list->strings;
+
+   if (!str || !st || !st->slots_capacity)
+      return;
+
+   hash = file_list_string_hash(str, &len);
+
+   for (i = hash & (st->slots_capacity - 1); st->slots[i].str;
+         i = (i + 1) & (st->slots_capacity - 1))
+   {
+      struct file_list_slot *slot = &st->slots[i];
+
+      if (slot->str != str)
+         continue;
+
+      if (--slot->refs == 0)
+      {
+         struct file_list_block *block = st->cur;
+
+         /* Only the last string allocated can be given
+          * back; anything else is kept (and shared again
+          * if the same string comes back) until the list
+          * is cleared */
+         if (block && str + len + 1 == block->data + block->used)
+         {
+            block->used -= len + 1;
+            slot->str    = &file_list_tombstone;
+         }
+      }
+      return;
+   }
+}
+
+/* Forgets all strings, keeping the memory for reuse */
+static void file_list_strings_reset(file_list_t *list)
+{
+   struct file_list_strings *st = list->strings;
+
+   if (!st)
+      return;
+
+   if (st->slots)
+      memset(st->slots, 0, st->slots_capacity * sizeof(*st->slots));
+   st->slots_used = 0;
+
+   st->cur        = st->first;
+   if (st->cur)
+      st->cur->used = 0;
+}
+
+static void file_list_strings_free(file_list_t *list)
+{
+   struct file_list_strings *st = list->strings;
+   struct file_list_block *block;
+
+   if (!st)
+      return;
+
+   block = st->first;
+   while (block)
+   {
+      struct file_list_block *next = block->next;
+      free(block);
+      block = next;
+   }
+
+   free(st->slots);
+   free(st);
+   list->strings = NULL;
+}
+
 static bool file_list_deinitialize_internal(file_list_t *list)
 {
    size_t i;
@@ -36,19 +310,8 @@ static bool file_list_deinitialize_internal(file_list_t *list)
    {
       file_list_free_userdata(list, i);
       file_list_free_actiondata(list, i);
-
-      if (list->list[i].path)
-         free(list->list[i].path);
-      list->list[i].path = NULL;
-
-      if (list->list[i].label)
-         free(list->list[i].label);
-      list->list[i].label = NULL;
-
-      if (list->list[i].alt)
-         free(list->list[i].alt);
-      list->list[i].alt = NULL;
    }
+   file_list_strings_free(list);
    if (list->list)
       free(list->list);
    list->list = NULL;
@@ -61,6 +324,7 @@ bool file_list_initialize(file_list_t *list)
       return false;
 
    list->list     = NULL;
+   list->strings  = NULL;
    list->capacity = 0;
    list->size     = 0;
 
@@ -144,10 +408,8 @@ bool file_list_insert(file_list_t *list,
    list->list[idx].userdata      = NULL;
    list->list[idx].actiondata    = NULL;
 
-   if (label)
-      list->list[idx].label      = strdup(label);
-   if (path)
-      list->list[idx].path       = strdup(path);
+   list->list[idx].label         = file_list_string_get(list, label);
+   list->list[idx].path          = file_list_string_get(list, path);
 
    list->size++;
 
@@ -174,10 +436,8 @@ bool file_list_append(file_list_t *list,
    list->list[idx].userdata      = NULL;
    list->list[idx].actiondata    = NULL;
 
-   if (label)
-      list->list[idx].label      = strdup(label);
-   if (path)
-      list->list[idx].path       = strdup(path);
+   list->list[idx].label         = file_list_string_get(list, label);
+   list->list[idx].path          = file_list_string_get(list, path);
 
    list->size++;
 
@@ -204,14 +464,18 @@ void file_list_pop(file_list_t *list, size_t *directory_ptr)
 
    if (list->size != 0)
    {
-      --list->size;
-      if (list->list[list->size].path)
-         free(list->list[list->size].path);
-      list->list[list->size].path = NULL;
-
-      if (list->list[list->size].label)
-         free(list->list[list->size].label);
-      list->list[list->size].label = NULL;
+      struct item_file *item = &list->list[--list->size];
+
+      /* Last allocated first */
+      file_list_string_put(list, item->alt);
+      file_list_string_put(list, item->path);
+      file_list_string_put(list, item->label);
+      item->path  = NULL;
+      item->label = NULL;
+      item->alt   = NULL;
+
+      if (list->size == 0)
+         file_list_strings_reset(list);
    }
 
    if (directory_ptr)
@@ -246,34 +510,40 @@ void file_list_clear(file_list_t *list)
 
    for (i = 0; i < list->size; i++)
    {
-      if (list->list[i].path)
-         free(list->list[i].path);
-      list->list[i].path = NULL;
-
-      if (list->list[i].label)
-         free(list->list[i].label);
+      list->list[i].path  = NULL;
       list->list[i].label = NULL;
-
-      if (list->list[i].alt)
-         free(list->list[i].alt);
-      list->list[i].alt = NULL;
+      list->list[i].alt   = NULL;
    }
 
+   file_list_strings_reset(list);
+
    list->size = 0;
 }
 
+void file_list_set_path_at_offset(file_list_t *list, size_t idx,
+      const char *path)
+{
+   char *old_path;
+
+   if (!list)
+      return;
+
+   old_path              = list->list[idx].path;
+   list->list[idx].path  = file_list_string_get(list, path);
+   file_list_string_put(list, old_path);
+}
+
 void file_list_set_label_at_offset(file_list_t *list, size_t idx,
       const char *label)
 {
+   char *old_label;
+
    if (!list)
       return;
 
-   if (list->list[idx].label)
-      free(list->list[idx].label);
-   list->list[idx].alt      = NULL;
-
-   if (label)
-      list->list[idx].label = strdup(label);
+   old_label             = list->list[idx].label;
+   list->list[idx].label = file_list_string_get(list, label);
+   file_list_string_put(list, old_label);
 }
 
 void file_list_get_label_at_offset(const file_list_t *list, size_t idx,
@@ -290,15 +560,27 @@ void file_list_get_label_at_offset(const file_list_t *list, size_t idx,
 void file_list_set_alt_at_offset(file_list_t *list, size_t idx,
       const char *alt)
 {
+   char *old_alt;
+
    if (!list || !alt)
       return;
 
-   if (list->list[idx].alt)
-      free(list->list[idx].alt);
-   list->list[idx].alt      = NULL;
+   old_alt               = list->list[idx].alt;
+   list->list[idx].alt   = file_list_string_get(list, alt);
+   file_list_string_put(list, old_alt);
+}
+
+bool file_list_append_copy(file_list_t *list, const file_list_t *src,
+      size_t idx)
+{
+   const struct item_file *item = &src->list[idx];
+
+   if (!file_list_append(list, item->path, item->label, item->type,
+            item->directory_ptr, item->entry_idx))
+      return false;
 
-   if (alt)
-      list->list[idx].alt   = strdup(alt);
+   list->list[list->size - 1].alt = file_list_string_get(list, item->alt);
+   return true;
 }
 
 static int file_list_alt_cmp(const void *a_, const void *b_)
@@ -22,8 +22,41 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <memalign.h>
+#include <memmap.h>
+
+/* Smallest buffer worth backing with huge pages */
+#define MEMALIGN_LARGE_MIN  (2 * 1024 * 1024)
+#define MEMALIGN_CACHELINE  64
+
+#if defined(_WIN32) && !defined(_XBOX) && !defined(__WINRT__)
+#define MEMALIGN_LARGE_WIN32
+#elif defined(HAVE_MMAN) && (defined(MAP_ANONYMOUS) || defined(MAP_ANON))
+#define MEMALIGN_LARGE_MMAN
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+enum memalign_large_type
+{
+   MEMALIGN_LARGE_HEAP = 0,
+   MEMALIGN_LARGE_MAP
+};
+
+/* Stored in the cacheline before each large buffer */
+typedef union memalign_large_header
+{
+   struct
+   {
+      void *base;
+      size_t len;
+      enum memalign_large_type type;
+   } info;
+   char pad[MEMALIGN_CACHELINE];
+} memalign_large_header_t;
 
 void *memalign_alloc(size_t boundary, size_t size)
 {
@@ -61,3 +94,119 @@ void *memalign_alloc_aligned(size_t size)
    return memalign_alloc(32, size);
 #endif
 }
+
+/* Maps 'len' bytes of zeroed memory, with huge pages if possible */
+static void *memalign_map_large(size_t *len)
+{
+#if defined(MEMALIGN_LARGE_WIN32)
+#if defined(MEM_LARGE_PAGES) && defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0502
+   /* Needs the 'Lock pages in memory' privilege,
+    * fails otherwise */
+   SIZE_T page = GetLargePageMinimum();
+
+   if (page)
+   {
+      size_t page_len = (*len + page - 1) & ~(size_t)(page - 1);
+      void *ptr       = NULL;
+
+      if ((ptr = VirtualAlloc(NULL, page_len,
+                  MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES,
+                  PAGE_READWRITE)))
+      {
+         *len = page_len;
+         return ptr;
+      }
+   }
+#endif
+   return VirtualAlloc(NULL, *len, MEM_COMMIT | MEM_RESERVE,
+         PAGE_READWRITE);
+#elif defined(MEMALIGN_LARGE_MMAN)
+   void *ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+   /* Only succeeds with huge pages reserved up front */
+   {
+      size_t page_len = (*len + MEMALIGN_LARGE_MIN - 1)
+         & ~(size_t)(MEMALIGN_LARGE_MIN - 1);
+
+      if ((ptr = mmap(NULL, page_len, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                  -1, 0)) != MAP_FAILED)
+      {
+         *len = page_len;
+         return ptr;
+      }
+   }
+#endif
+   if ((ptr = mmap(NULL, *len, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+      return NULL;
+#ifdef MADV_HUGEPAGE
+   /* Transparent huge pages, where enabled */
+   madvise(ptr, *len, MADV_HUGEPAGE);
+#endif
+   return ptr;
+#else
+   return NULL;
+#endif
+}
+
+static void memalign_unmap_large(void *ptr, size_t len)
+{
+#if defined(MEMALIGN_LARGE_WIN32)
+   VirtualFree(ptr, 0, MEM_RELEASE);
+#elif defined(MEMALIGN_LARGE_MMAN)
+   munmap(ptr, len);
+#endif
+}
+
+void *memalign_alloc_large(size_t size)
+{
+   memalign_large_header_t *header = NULL;
+   size_t len                      = size + sizeof(*header);
+   void *base                      = NULL;
+   enum memalign_large_type type   = MEMALIGN_LARGE_HEAP;
+
+   if (len < size)
+      return NULL;
+
+   if (     (len >= MEMALIGN_LARGE_MIN)
+         && (base = memalign_map_large(&len)))
+   {
+      /* Mappings are page aligned (and zeroed) already */
+      header = (memalign_large_header_t*)base;
+      type   = MEMALIGN_LARGE_MAP;
+   }
+   else
+   {
+      uintptr_t addr;
+
+      if (!(base = malloc(len + MEMALIGN_CACHELINE - 1)))
+         return NULL;
+
+      addr   = ((uintptr_t)base + MEMALIGN_CACHELINE - 1)
+         & ~(uintptr_t)(MEMALIGN_CACHELINE - 1);
+      header = (memalign_large_header_t*)addr;
+      memset(header + 1, 0, size);
+   }
+
+   header->info.base = base;
+   header->info.len  = len;
+   header->info.type = type;
+
+   return header + 1;
+}
+
+void memalign_free_large(void *ptr)
+{
+   memalign_large_header_t *header = NULL;
+
+   if (!ptr)
+      return;
+
+   header = (memalign_large_header_t*)ptr - 1;
+
+   if (header->info.type == MEMALIGN_LARGE_MAP)
+      memalign_unmap_large(header->info.base, header->info.len);
+   else
+      free(header->info.base);
+}
@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <net/net_http.h>
 #include <net/net_compat.h>
@@ -35,6 +36,17 @@
 #include <string.h>
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Idle keep-alive connections kept around for reuse */
+#define NET_HTTP_POOL_SIZE     8
+/* Servers drop idle connections after a while, don't
+ * bother with ones older than this */
+#define NET_HTTP_POOL_IDLE_SEC 15
+/* Largest receive buffer used when streaming the body */
+#define NET_HTTP_SINK_BUFLEN   (64 * 1024)
 
 enum
 {
@@ -63,14 +75,27 @@ struct http_socket_state_t
 struct http_t
 {
    char *data;
+   char *domain;  /* Only set if the connection may be pooled */
+   char *request; /* Kept to resend it on a fresh connection */
+   char *etag;
+   char *last_modified;
+   net_http_sink_t sink;
+   void *sink_data;
    struct http_socket_state_t sock_state; /* ptr alignment */
    size_t pos;
    size_t len;
    size_t buflen;
+   size_t request_len;
+   size_t content_length;
+   size_t sunk;   /* Body bytes already handed to the sink */
    int status;
+   int port;
    char part;
    char bodytype;
    bool error;
+   bool head;       /* HEAD request, the response has no body */
+   bool reused;     /* Sent over a pooled connection */
+   bool keep_alive; /* The server keeps the connection open */
 };
 
 struct http_connection_t
@@ -83,10 +108,33 @@ struct http_connection_t
    char *contenttypecopy;
    char *postdatacopy;
    char* useragentcopy;
+   char *headerscopy;
+   struct http_socket_state_t sock_state; /* ptr alignment */
+   int port;
+};
+
+struct http_pool_entry
+{
+   char *domain;
    struct http_socket_state_t sock_state; /* ptr alignment */
+   time_t idle_since;
    int port;
 };
 
+struct http_request_buf
+{
+   char *data;
+   size_t len;
+   size_t size;
+   bool error;
+};
+
+static struct http_pool_entry net_http_pool[NET_HTTP_POOL_SIZE];
+static bool net_http_pool_inited   = false;
+#ifdef HAVE_THREADS
+static slock_t *net_http_pool_lock = NULL;
+#endif
+
 /* URL Encode a string
    caller is responsible for deleting the destination buffer */
 void net_http_urlencode(char **dest, const char *source)
@@ -412,16 +460,17 @@ void net_http_urlencode_full(char *dest,
    free (tmp);
 }
 
-static int net_http_new_socket(struct http_connection_t *conn)
+static int net_http_new_socket(struct http_socket_state_t *sock_state,
+      const char *domain, int port)
 {
    int ret;
    struct addrinfo *addr = NULL, *next_addr = NULL;
    int fd                = socket_init(
-         (void**)&addr, conn->port, conn->domain, SOCKET_TYPE_STREAM);
+         (void**)&addr, port, domain, SOCKET_TYPE_STREAM);
 #ifdef HAVE_SSL
-   if (conn->sock_state.ssl)
+   if (sock_state->ssl)
    {
-      if (!(conn->sock_state.ssl_ctx = ssl_socket_init(fd, conn->domain)))
+      if (!(sock_state->ssl_ctx = ssl_socket_init(fd, domain)))
          return -1;
    }
 #endif
@@ -431,15 +480,15 @@ static int net_http_new_socket(struct http_connection_t *conn)
    while (fd >= 0)
    {
 #ifdef HAVE_SSL
-      if (conn->sock_state.ssl)
+      if (sock_state->ssl)
       {
-         ret = ssl_socket_connect(conn->sock_state.ssl_ctx,
+         ret = ssl_socket_connect(sock_state->ssl_ctx,
                (void*)next_addr, true, true);
 
          if (ret >= 0)
             break;
 
-         ssl_socket_close(conn->sock_state.ssl_ctx);
+         ssl_socket_close(sock_state->ssl_ctx);
       }
       else
 #endif
@@ -458,32 +507,222 @@ static int net_http_new_socket(struct http_connection_t *conn)
    if (addr)
       freeaddrinfo_retro(addr);
 
-   conn->sock_state.fd = fd;
+   sock_state->fd = fd;
 
    return fd;
 }
 
+static void net_http_close_socket(struct http_socket_state_t *sock_state)
+{
+   if (sock_state->fd < 0)
+      return;
+
+   socket_close(sock_state->fd);
+#ifdef HAVE_SSL
+   if (sock_state->ssl && sock_state->ssl_ctx)
+   {
+      ssl_socket_free(sock_state->ssl_ctx);
+      sock_state->ssl_ctx = NULL;
+   }
+#endif
+   sock_state->fd = -1;
+}
+
+static bool net_http_send(struct http_socket_state_t *sock_state,
+      const char *data, size_t size)
+{
+#ifdef HAVE_SSL
+   if (sock_state->ssl)
+      return ssl_socket_send_all_blocking(
+               sock_state->ssl_ctx, data, size, true);
+#endif
+   return socket_send_all_blocking(sock_state->fd, data, size, true);
+}
+
+/* The request is put together first and then sent at once,
+ * rather than in a dozen small writes (and TLS records) */
 static void net_http_send_str(
-      struct http_socket_state_t *sock_state, bool *error, const char *text)
+      struct http_request_buf *req, const char *text)
 {
    size_t text_size;
-   if (*error)
+   if (req->error)
       return;
    text_size = strlen(text);
+   if (req->len + text_size + 1 > req->size)
+   {
+      size_t new_size = MAX(req->size * 2, req->len + text_size + 1);
+      char *new_data  = (char*)realloc(req->data, new_size);
+      if (!new_data)
+      {
+         req->error = true;
+         return;
+      }
+      req->data = new_data;
+      req->size = new_size;
+   }
+   memcpy(req->data + req->len, text, text_size + 1);
+   req->len += text_size;
+}
+
+/* An idle keep-alive connection may only have the end of a
+ * chunked response (an empty line) left to read. Anything
+ * else, including the server having closed it, makes it
+ * unusable. */
+static bool net_http_socket_is_idle(struct http_socket_state_t *sock_state)
+{
+   for (;;)
+   {
+      char buf[16];
+      ssize_t i, newlen;
+      bool error = false;
+
 #ifdef HAVE_SSL
-   if (sock_state->ssl)
+      if (sock_state->ssl && sock_state->ssl_ctx)
+         newlen = ssl_socket_receive_all_nonblocking(sock_state->ssl_ctx,
+               &error, buf, sizeof(buf));
+      else
+#endif
+         newlen = socket_receive_all_nonblocking(sock_state->fd,
+               &error, buf, sizeof(buf));
+
+      if (newlen < 0 || error)
+         return false;
+      if (newlen == 0)
+         return true;
+
+      for (i = 0; i < newlen; i++)
+         if (buf[i] != '\r' && buf[i] != '\n')
+            return false;
+   }
+}
+
+/* Takes an idle connection to the same server out of the pool */
+static bool net_http_pool_take(struct http_connection_t *conn)
+{
+   size_t i;
+   time_t now = time(NULL);
+
+   if (!net_http_pool_inited)
+      return false;
+
+#ifdef HAVE_THREADS
+   slock_lock(net_http_pool_lock);
+#endif
+   for (i = 0; i < NET_HTTP_POOL_SIZE; i++)
    {
-      if (!ssl_socket_send_all_blocking(
-               sock_state->ssl_ctx, text, text_size, true))
-         *error = true;
+      struct http_pool_entry *entry = &net_http_pool[i];
+      bool usable;
+
+      if (!entry->domain)
+         continue;
+
+      usable = now - entry->idle_since < NET_HTTP_POOL_IDLE_SEC
+         && net_http_socket_is_idle(&entry->sock_state);
+
+      /* Drop anything stale while we're at it */
+      if (!usable)
+      {
+         net_http_close_socket(&entry->sock_state);
+         free(entry->domain);
+         entry->domain = NULL;
+         continue;
+      }
+
+      if (     entry->port           != conn->port
+            || entry->sock_state.ssl != conn->sock_state.ssl
+            || !string_is_equal_noncase(entry->domain, conn->domain))
+         continue;
+
+      conn->sock_state = entry->sock_state;
+      free(entry->domain);
+      entry->domain    = NULL;
+#ifdef HAVE_THREADS
+      slock_unlock(net_http_pool_lock);
+#endif
+      return true;
    }
-   else
+#ifdef HAVE_THREADS
+   slock_unlock(net_http_pool_lock);
+#endif
+
+   return false;
+}
+
+/* Hands a connection whose response was read in full back to the
+ * pool, in place of the oldest idle one if the pool is full */
+static bool net_http_pool_put(struct http_t *state)
+{
+   size_t i, slot = 0;
+
+   if (!net_http_pool_inited)
+      return false;
+
+#ifdef HAVE_THREADS
+   slock_lock(net_http_pool_lock);
+#endif
+   for (i = 0; i < NET_HTTP_POOL_SIZE; i++)
+   {
+      if (!net_http_pool[i].domain)
+      {
+         slot = i;
+         break;
+      }
+      if (net_http_pool[i].idle_since < net_http_pool[slot].idle_since)
+         slot = i;
+   }
+
+   if (net_http_pool[slot].domain)
+   {
+      net_http_close_socket(&net_http_pool[slot].sock_state);
+      free(net_http_pool[slot].domain);
+   }
+
+   net_http_pool[slot].domain     = state->domain;
+   net_http_pool[slot].port       = state->port;
+   net_http_pool[slot].sock_state = state->sock_state;
+   net_http_pool[slot].idle_since = time(NULL);
+   state->domain                  = NULL;
+#ifdef HAVE_THREADS
+   slock_unlock(net_http_pool_lock);
+#endif
+
+   return true;
+}
+
+void net_http_pool_init(void)
+{
+   if (net_http_pool_inited)
+      return;
+
+#ifdef HAVE_THREADS
+   if (!(net_http_pool_lock = slock_new()))
+      return;
 #endif
+   memset(net_http_pool, 0, sizeof(net_http_pool));
+   net_http_pool_inited = true;
+}
+
+void net_http_pool_deinit(void)
+{
+   size_t i;
+
+   if (!net_http_pool_inited)
+      return;
+
+   for (i = 0; i < NET_HTTP_POOL_SIZE; i++)
    {
-      if (!socket_send_all_blocking(
-               sock_state->fd, text, text_size, true))
-         *error = true;
+      if (!net_http_pool[i].domain)
+         continue;
+      net_http_close_socket(&net_http_pool[i].sock_state);
+      free(net_http_pool[i].domain);
+      net_http_pool[i].domain = NULL;
    }
+
+#ifdef HAVE_THREADS
+   slock_free(net_http_pool_lock);
+   net_http_pool_lock   = NULL;
+#endif
+   net_http_pool_inited = false;
 }
 
 struct http_connection_t *net_http_connection_new(const char *url,
@@ -509,6 +748,7 @@ struct http_connection_t *net_http_connection_new(const char *url,
    conn->contenttypecopy   = NULL;
    conn->postdatacopy      = NULL;
    conn->useragentcopy     = NULL;
+   conn->headerscopy       = NULL;
    conn->port              = 0;
    conn->sock_state.fd     = 0;
    conn->sock_state.ssl    = false;
@@ -659,11 +899,15 @@ void net_http_connection_free(struct http_connection_t *conn)
    if (conn->useragentcopy)
       free(conn->useragentcopy);
 
+   if (conn->headerscopy)
+      free(conn->headerscopy);
+
    conn->urlcopy         = NULL;
    conn->methodcopy      = NULL;
    conn->contenttypecopy = NULL;
    conn->postdatacopy    = NULL;
    conn->useragentcopy   = NULL;
+   conn->headerscopy     = NULL;
 
    free(conn);
 }
@@ -677,6 +921,15 @@ void net_http_connection_set_user_agent(
    conn->useragentcopy = user_agent ? strdup(user_agent) : NULL;
 }
 
+void net_http_connection_set_headers(
+      struct http_connection_t *conn, const char *headers)
+{
+   if (conn->headerscopy)
+      free(conn->headerscopy);
+
+   conn->headerscopy = !string_is_empty(headers) ? strdup(headers) : NULL;
+}
+
 const char *net_http_connection_url(struct http_connection_t *conn)
 {
    return conn->urlcopy;
@@ -684,36 +937,35 @@ const char *net_http_connection_url(struct http_connection_t *conn)
 
 struct http_t *net_http_new(struct http_connection_t *conn)
 {
-   bool error            = false;
+   struct http_request_buf req;
+   bool reused           = false;
    int fd                = -1;
    struct http_t *state  = NULL;
 
-   if (!conn)
-      goto error;
+   req.data              = NULL;
+   req.len               = 0;
+   req.size              = 0;
+   req.error             = false;
 
-   fd = net_http_new_socket(conn);
-
-   if (fd < 0)
+   if (!conn)
       goto error;
 
-   error = false;
-
    /* This is a bit lazy, but it works. */
    if (conn->methodcopy)
    {
-      net_http_send_str(&conn->sock_state, &error, conn->methodcopy);
-      net_http_send_str(&conn->sock_state, &error, " /");
+      net_http_send_str(&req, conn->methodcopy);
+      net_http_send_str(&req, " /");
    }
    else
    {
-      net_http_send_str(&conn->sock_state, &error, "GET /");
+      net_http_send_str(&req, "GET /");
    }
 
-   net_http_send_str(&conn->sock_state, &error, conn->location);
-   net_http_send_str(&conn->sock_state, &error, " HTTP/1.1\r\n");
+   net_http_send_str(&req, conn->location);
+   net_http_send_str(&req, " HTTP/1.1\r\n");
 
-   net_http_send_str(&conn->sock_state, &error, "Host: ");
-   net_http_send_str(&conn->sock_state, &error, conn->domain);
+   net_http_send_str(&req, "Host: ");
+   net_http_send_str(&req, conn->domain);
 
    if (!conn->port)
    {
@@ -722,17 +974,17 @@ struct http_t *net_http_new(struct http_connection_t *conn)
       portstr[0] = '\0';
 
       snprintf(portstr, sizeof(portstr), ":%i", conn->port);
-      net_http_send_str(&conn->sock_state, &error, portstr);
+      net_http_send_str(&req, portstr);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "\r\n");
+   net_http_send_str(&req, "\r\n");
 
    /* This is not being set anywhere yet */
    if (conn->contenttypecopy)
    {
-      net_http_send_str(&conn->sock_state, &error, "Content-Type: ");
-      net_http_send_str(&conn->sock_state, &error, conn->contenttypecopy);
-      net_http_send_str(&conn->sock_state, &error, "\r\n");
+      net_http_send_str(&req, "Content-Type: ");
+      net_http_send_str(&req, conn->contenttypecopy);
+      net_http_send_str(&req, "\r\n");
    }
 
    if (conn->methodcopy && (string_is_equal(conn->methodcopy, "POST")))
@@ -744,10 +996,10 @@ struct http_t *net_http_new(struct http_connection_t *conn)
          goto error;
 
       if (!conn->contenttypecopy)
-         net_http_send_str(&conn->sock_state, &error,
+         net_http_send_str(&req,
                "Content-Type: application/x-www-form-urlencoded\r\n");
 
-      net_http_send_str(&conn->sock_state, &error, "Content-Length: ");
+      net_http_send_str(&req, "Content-Length: ");
 
       post_len = strlen(conn->postdatacopy);
 #ifdef _WIN32
@@ -762,30 +1014,74 @@ struct http_t *net_http_new(struct http_connection_t *conn)
 
       len_str[len] = '\0';
 
-      net_http_send_str(&conn->sock_state, &error, len_str);
-      net_http_send_str(&conn->sock_state, &error, "\r\n");
+      net_http_send_str(&req, len_str);
+      net_http_send_str(&req, "\r\n");
 
       free(len_str);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "User-Agent: ");
+   net_http_send_str(&req, "User-Agent: ");
    if (conn->useragentcopy)
-      net_http_send_str(&conn->sock_state, &error, conn->useragentcopy);
+      net_http_send_str(&req, conn->useragentcopy);
    else
-      net_http_send_str(&conn->sock_state, &error, "libretro");
-   net_http_send_str(&conn->sock_state, &error, "\r\n");
+      net_http_send_str(&req, "libretro");
+   net_http_send_str(&req, "\r\n");
 
-   net_http_send_str(&conn->sock_state, &error, "Connection: close\r\n");
-   net_http_send_str(&conn->sock_state, &error, "\r\n");
+   if (conn->headerscopy)
+      net_http_send_str(&req, conn->headerscopy);
+
+   if (net_http_pool_inited)
+      net_http_send_str(&req, "Connection: keep-alive\r\n");
+   else
+      net_http_send_str(&req, "Connection: close\r\n");
+   net_http_send_str(&req, "\r\n");
 
    if (conn->methodcopy && (string_is_equal(conn->methodcopy, "POST")))
-      net_http_send_str(&conn->sock_state, &error, conn->postdatacopy);
+      net_http_send_str(&req, conn->postdatacopy);
 
-   if (error)
+   if (req.error)
       goto error;
 
-   state             = (struct http_t*)malloc(sizeof(struct http_t));
-   state->sock_state = conn->sock_state;
+   if ((reused = net_http_pool_take(conn)))
+   {
+      fd = conn->sock_state.fd;
+      /* The server may have dropped it in the meantime */
+      if (!net_http_send(&conn->sock_state, req.data, req.len))
+      {
+         net_http_close_socket(&conn->sock_state);
+         reused = false;
+      }
+   }
+
+   if (!reused)
+   {
+      fd = net_http_new_socket(&conn->sock_state, conn->domain, conn->port);
+
+      if (fd < 0)
+         goto error;
+
+      if (!net_http_send(&conn->sock_state, req.data, req.len))
+         goto error;
+   }
+
+   if (!(state = (struct http_t*)malloc(sizeof(struct http_t))))
+      goto error;
+
+   state->sock_state  = conn->sock_state;
+   state->domain      = net_http_pool_inited ? strdup(conn->domain) : NULL;
+   state->request     = req.data;
+   state->request_len = req.len;
+   state->port        = conn->port;
+   state->head        = conn->methodcopy
+      && string_is_equal(conn->methodcopy, "HEAD");
+   state->reused      = reused;
+   state->keep_alive  = false;
+   state->content_length = 0;
+   state->etag        = NULL;
+   state->last_modified = NULL;
+   state->sink        = NULL;
+   state->sink_data   = NULL;
+   state->sunk        = 0;
    state->status     = -1;
    state->data       = NULL;
    state->part       = P_HEADER_TOP;
@@ -797,7 +1093,13 @@ struct http_t *net_http_new(struct http_connection_t *conn)
    state->data       = (char*)malloc(state->buflen);
 
    if (!state->data)
+   {
+      if (state->domain)
+         free(state->domain);
+      free(state);
+      state = NULL;
       goto error;
+   }
 
    return state;
 
@@ -812,20 +1114,92 @@ error:
       conn->contenttypecopy = NULL;
       conn->postdatacopy = NULL;
    }
-#ifdef HAVE_SSL
-   if (conn && conn->sock_state.ssl && conn->sock_state.ssl_ctx && fd >= 0)
+   if (conn && fd >= 0)
+      net_http_close_socket(&conn->sock_state);
+   if (req.data)
+      free(req.data);
+   return NULL;
+}
+
+/* A pooled connection may turn out to have been closed by the
+ * server only once we wait for the response, retry on a new one */
+static bool net_http_resend(struct http_t *state)
+{
+   if (!state->reused || state->pos || !state->request)
+      return false;
+
+   state->reused = false;
+   state->error  = false;
+   net_http_close_socket(&state->sock_state);
+
+   if (net_http_new_socket(&state->sock_state,
+            state->domain, state->port) < 0)
+      return false;
+
+   return net_http_send(&state->sock_state,
+         state->request, state->request_len);
+}
+
+void net_http_set_sink(struct http_t *state,
+      net_http_sink_t sink, void *userdata)
+{
+   if (!state)
+      return;
+   state->sink      = sink;
+   state->sink_data = userdata;
+}
+
+/* Hands the body received so far to the sink and drops it
+ * from the buffer, so that it never grows past what a single
+ * network read brings in. Error responses are not streamed,
+ * they are collected as usual. */
+static bool net_http_flush_sink(struct http_t *state)
+{
+   size_t body;
+
+   if (     !state->sink
+         || state->part < P_BODY
+         || state->part == P_ERROR
+         || state->status < 200
+         || state->status > 299)
+      return true;
+
+   /* While a chunk header is being read, 'len' is where it
+    * starts and everything in front of it is body */
+   if (state->bodytype == T_CHUNK && state->part == P_BODY_CHUNKLEN)
+      body = state->len;
+   else
+      body = state->pos;
+
+   if (body && !state->sink(state->sink_data,
+            (const uint8_t*)state->data, body))
+      return false;
+
+   state->sunk += body;
+
+   if (state->bodytype == T_CHUNK)
    {
-      ssl_socket_close(conn->sock_state.ssl_ctx);
-      ssl_socket_free(conn->sock_state.ssl_ctx);
-      conn->sock_state.ssl_ctx = NULL;
+      if (state->part == P_BODY_CHUNKLEN)
+      {
+         memmove(state->data, state->data + body, state->pos - body);
+         state->pos -= body;
+         state->len  = 0;
+      }
+      else
+      {
+         state->pos  = 0;
+         if (state->part == P_DONE)
+            state->len = 0;
+      }
    }
-#else
-   if (fd >= 0)
-      socket_close(fd);
-#endif
-   if (state)
-      free(state);
-   return NULL;
+   else
+   {
+      /* 'len' counts what is left to receive from here on */
+      state->len -= body;
+      state->pos  = 0;
+   }
+
+   return true;
 }
 
 int net_http_fd(struct http_t *state)
@@ -835,6 +1209,28 @@ int net_http_fd(struct http_t *state)
    return state->sock_state.fd;
 }
 
+/* Returns the value of a header line if it is the
+ * header 'name' (compared case-insensitively) */
+static const char *net_http_header_value(const char *line,
+      const char *name)
+{
+   size_t name_len = strlen(name);
+   size_t i;
+
+   for (i = 0; i < name_len; i++)
+      if (tolower((unsigned char)line[i]) != tolower((unsigned char)name[i]))
+         return NULL;
+
+   if (line[name_len] != ':')
+      return NULL;
+
+   line += name_len + 1;
+   while (*line == ' ' || *line == '\t')
+      line++;
+
+   return line;
+}
+
 bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
 {
    ssize_t newlen = 0;
@@ -861,7 +1257,11 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
       }
 
       if (newlen < 0)
+      {
+         if (state->part == P_HEADER_TOP && net_http_resend(state))
+            return false;
          goto fail;
+      }
 
       if (state->pos + newlen >= state->buflen - 64)
       {
@@ -885,23 +1285,40 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
 
          if (state->part == P_HEADER_TOP)
          {
-            if (strncmp(state->data, "HTTP/1.", STRLEN_CONST("HTTP/1."))!=0)
-               goto fail;
-            state->status = (int)strtoul(state->data 
-                  + STRLEN_CONST("HTTP/1.1 "), NULL, 10);
-            state->part   = P_HEADER;
+            /* Skip what's left of a previous chunked response */
+            if (state->data[0] != '\0')
+            {
+               if (strncmp(state->data, "HTTP/1.", STRLEN_CONST("HTTP/1."))!=0)
+                  goto fail;
+               state->status     = (int)strtoul(state->data
+                     + STRLEN_CONST("HTTP/1.1 "), NULL, 10);
+               state->keep_alive = !strncmp(state->data, "HTTP/1.1",
+                     STRLEN_CONST("HTTP/1.1"));
+               state->part       = P_HEADER;
+            }
          }
          else
          {
+            const char *value = NULL;
+
             if (!strncmp(state->data, "Content-Length: ",
                      STRLEN_CONST("Content-Length: ")))
             {
                state->bodytype = T_LEN;
                state->len = strtol(state->data +
                      STRLEN_CONST("Content-Length: "), NULL, 10);
+               state->content_length = state->len;
             }
             if (string_is_equal(state->data, "Transfer-Encoding: chunked"))
                state->bodytype = T_CHUNK;
+            if (string_is_equal_noncase(state->data, "Connection: close"))
+               state->keep_alive = false;
+            if (!state->etag && (value =
+                     net_http_header_value(state->data, "ETag")))
+               state->etag = strdup(value);
+            if (!state->last_modified && (value =
+                     net_http_header_value(state->data, "Last-Modified")))
+               state->last_modified = strdup(value);
 
             /* TODO: save headers somewhere */
             if (state->data[0]=='\0')
@@ -909,6 +1326,17 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
                state->part = P_BODY;
                if (state->bodytype == T_CHUNK)
                   state->part = P_BODY_CHUNKLEN;
+
+               /* These never have a body, don't wait for one
+                * (or for the server to close the connection) */
+               if (     state->head
+                     || state->status == 204
+                     || state->status == 304)
+               {
+                  state->bodytype = T_LEN;
+                  state->len      = 0;
+                  state->part     = P_DONE;
+               }
             }
          }
 
@@ -958,7 +1386,9 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
             newlen=0;
          }
 
-         if (state->pos + newlen >= state->buflen - 64)
+         /* When streaming, the buffer is emptied after every read */
+         if (     state->pos + newlen >= state->buflen - 64
+               && (!state->sink || state->buflen < NET_HTTP_SINK_BUFLEN))
          {
             state->buflen *= 2;
             state->data = (char*)realloc(state->data, state->buflen);
@@ -1004,7 +1434,8 @@ parse_again:
                   {
                      state->part = P_DONE;
                      state->len  = state->pos;
-                     state->data = (char*)realloc(state->data, state->len);
+                     if (!state->sink)
+                        state->data = (char*)realloc(state->data, state->len);
                   }
                   goto parse_again;
                }
@@ -1034,20 +1465,24 @@ parse_again:
          if (state->pos == state->len)
          {
             state->part = P_DONE;
-            state->data = (char*)realloc(state->data, state->len);
+            if (!state->sink)
+               state->data = (char*)realloc(state->data, state->len);
          }
          if (state->pos > state->len)
             goto fail;
       }
    }
 
+   if (!net_http_flush_sink(state))
+      goto fail;
+
    if (progress)
-      *progress = state->pos;
+      *progress = state->sunk + state->pos;
 
    if (total)
    {
       if (state->bodytype == T_LEN)
-         *total=state->len;
+         *total = state->sunk + state->len;
       else
          *total=0;
    }
@@ -1065,6 +1500,27 @@ fail:
    return true;
 }
 
+size_t net_http_content_length(struct http_t *state)
+{
+   if (!state)
+      return 0;
+   return state->content_length;
+}
+
+const char *net_http_etag(struct http_t *state)
+{
+   if (!state)
+      return NULL;
+   return state->etag;
+}
+
+const char *net_http_last_modified(struct http_t *state)
+{
+   if (!state)
+      return NULL;
+   return state->last_modified;
+}
+
 int net_http_status(struct http_t *state)
 {
    if (!state)
@@ -1097,15 +1553,25 @@ void net_http_delete(struct http_t *state)
 
    if (state->sock_state.fd >= 0)
    {
-      socket_close(state->sock_state.fd);
-#ifdef HAVE_SSL
-      if (state->sock_state.ssl && state->sock_state.ssl_ctx)
-      {
-         ssl_socket_free(state->sock_state.ssl_ctx);
-         state->sock_state.ssl_ctx = NULL;
-      }
-#endif
+      /* Only a response read up to its very end leaves
+       * the connection in a state that can be reused */
+      bool reusable = state->keep_alive
+         && state->domain
+         && !state->error
+         && state->part == P_DONE
+         && state->bodytype != T_FULL;
+
+      if (!reusable || !net_http_pool_put(state))
+         net_http_close_socket(&state->sock_state);
    }
+   if (state->domain)
+      free(state->domain);
+   if (state->request)
+      free(state->request);
+   if (state->etag)
+      free(state->etag);
+   if (state->last_modified)
+      free(state->last_modified);
    free(state);
 }
 
@@ -23,12 +23,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <sys/types.h>
 
 #include <net/net_compat.h>
 #include <net/net_ifinfo.h>
 #include <retro_miscellaneous.h>
 
+#include <compat/strcasestr.h>
+#include <features/features_cpu.h>
 #include <string/stdstring.h>
 #include <net/net_natt.h>
 
@@ -42,62 +45,349 @@
 #endif
 #endif
 
+#if !defined(HAVE_SOCKET_LEGACY) && (!defined(SWITCH) || defined(SWITCH) && defined(HAVE_LIBNX))
+#define HAVE_NATT_REQUESTS
+#endif
+
+/* NAT-PMP (RFC 6886) and PCP (RFC 6887) share the same port */
+#define NATT_PMP_PORT        5351
+#define NATT_SSDP_PORT       1900
+#define NATT_SSDP_ADDR       "239.255.255.250"
+#define NATT_MAX_GATEWAYS    4
+/* Time given to all methods together, in microseconds */
+#define NATT_TIMEOUT         4000000
+/* First NAT-PMP/PCP retransmission, doubled on every try */
+#define NATT_RETRY           250000
+#define NATT_TRIES           4
+/* Requested mapping lifetime, in seconds */
+#define NATT_LIFETIME        7200
+
+enum natt_method
+{
+   NATT_METHOD_NONE = 0,
+   NATT_METHOD_UPNP,
+   NATT_METHOD_PMP,
+   NATT_METHOD_PCP
+};
+
+struct natt_gateway
+{
+   struct sockaddr_in addr;   /* Gateway address, NATT_PMP_PORT */
+   struct in_addr local;      /* Our address on the gateway's network */
+   uint32_t pmp_ext_addr;     /* NAT-PMP external address, network order */
+   uint16_t pmp_ext_port;     /* NAT-PMP mapped port, 0 until known */
+};
+
+struct natt_internal
+{
+   struct natt_gateway gateways[NATT_MAX_GATEWAYS];
+   retro_time_t deadline;
+   retro_time_t next_send;
+   retro_time_t retry;
+   unsigned num_gateways;
+   unsigned mapped_gateway;
+   unsigned tries;
+   int pmp_fd;
+   int ssdp_fd;
+   uint16_t port;
+   uint8_t nonce[12];
+   enum socket_protocol proto;
+   enum natt_method method;
+};
+
 #if HAVE_MINIUPNPC
+/* Kept between requests, so that hosting again skips discovery
+ * and goes straight to the router's control URL */
 static struct UPNPUrls urls;
 static struct IGDdatas data;
 #endif
 
 void natt_init(void)
 {
-#ifndef HAVE_SOCKET_LEGACY
-#if HAVE_MINIUPNPC
-   struct UPNPDev * devlist;
-   struct UPNPDev * dev;
-   char * descXML;
-   int descXMLsize = 0;
-   int upnperror = 0;
-   memset(&urls, 0, sizeof(struct UPNPUrls));
-   memset(&data, 0, sizeof(struct IGDdatas));
-   devlist = upnpDiscover(2000, NULL, NULL, 0, 0, 2, &upnperror);
-   if (devlist)
-   {
-      dev = devlist;
-      while (dev)
-      {
-         if (strstr (dev->st, "InternetGatewayDevice"))
-            break;
-         dev = dev->pNext;
-      }
-      if (!dev)
-         dev = devlist;
+   /* Nothing to do anymore, discovery is part of every request
+    * and runs alongside NAT-PMP and PCP. */
+}
+
+bool natt_new(struct natt_status *status)
+{
+   struct natt_internal *internal = NULL;
+
+   memset(status, 0, sizeof(struct natt_status));
+
+   internal = (struct natt_internal*)calloc(1, sizeof(*internal));
+   if (!internal)
+      return false;
+
+   internal->pmp_fd  = -1;
+   internal->ssdp_fd = -1;
+   status->internal  = internal;
+   return true;
+}
+
+#ifdef HAVE_NATT_REQUESTS
+static void natt_put16(uint8_t *buf, uint16_t val)
+{
+   buf[0] = (uint8_t)(val >> 8);
+   buf[1] = (uint8_t)val;
+}
+
+static void natt_put32(uint8_t *buf, uint32_t val)
+{
+   buf[0] = (uint8_t)(val >> 24);
+   buf[1] = (uint8_t)(val >> 16);
+   buf[2] = (uint8_t)(val >> 8);
+   buf[3] = (uint8_t)val;
+}
+
+static uint16_t natt_get16(const uint8_t *buf)
+{
+   return (uint16_t)((buf[0] << 8) | buf[1]);
+}
+
+/* Finds our address towards @remote. Connecting a datagram
+ * socket sends nothing, it only picks the route. */
+static bool natt_local_address(const struct sockaddr_in *remote,
+      struct in_addr *local)
+{
+   struct sockaddr_in addr;
+   socklen_t addrlen = sizeof(addr);
+   bool ret          = false;
+   int fd            = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+   if (fd < 0)
+      return false;
+
+   if (  connect(fd, (const struct sockaddr*)remote, sizeof(*remote)) == 0
+      && getsockname(fd, (struct sockaddr*)&addr, &addrlen) == 0
+      && addr.sin_addr.s_addr != htonl(INADDR_ANY))
+   {
+      *local = addr.sin_addr;
+      ret    = true;
+   }
+
+   socket_close(fd);
+   return ret;
+}
+
+static void natt_add_gateway(struct natt_internal *internal, uint32_t addr)
+{
+   unsigned i;
+   struct natt_gateway *gateway = NULL;
+
+   if (internal->num_gateways >= NATT_MAX_GATEWAYS)
+      return;
+
+   for (i = 0; i < internal->num_gateways; i++)
+      if (internal->gateways[i].addr.sin_addr.s_addr == addr)
+         return;
+
+   gateway                       = &internal->gateways[internal->num_gateways];
+   memset(gateway, 0, sizeof(*gateway));
+   gateway->addr.sin_family      = AF_INET;
+   gateway->addr.sin_port        = htons(NATT_PMP_PORT);
+   gateway->addr.sin_addr.s_addr = addr;
+
+   if (natt_local_address(&gateway->addr, &gateway->local))
+      internal->num_gateways++;
+}
+
+static void natt_find_gateways(struct natt_internal *internal)
+{
+   size_t i;
+   struct net_ifinfo list;
+
+#ifdef __linux__
+   FILE *fp = fopen("/proc/net/route", "r");
+
+   if (fp)
+   {
+      char line[256];
 
-      descXML = (char *) miniwget(dev->descURL, &descXMLsize, 0, NULL);
-      if (descXML)
+      while (fgets(line, sizeof(line), fp))
       {
-         parserootdesc(descXML, descXMLsize, &data);
-         free (descXML);
-         descXML = 0;
-         GetUPNPUrls (&urls, &data, dev->descURL, 0);
+         char iface[32];
+         unsigned long dest, gateway;
+         unsigned flags;
+
+         /* Default routes only, the header line does not parse.
+          * Addresses are printed as the raw network order word. */
+         if (     sscanf(line, "%31s %lx %lx %x",
+                     iface, &dest, &gateway, &flags) == 4
+               && !dest && gateway && (flags & 0x2))
+            natt_add_gateway(internal, (uint32_t)gateway);
       }
-      freeUPNPDevlist(devlist);
+
+      fclose(fp);
    }
+
+   if (internal->num_gateways)
+      return;
 #endif
-#endif
+
+   /* No routing table to read, guess the usual .1 router
+    * of every private network we are on */
+   if (!net_ifinfo_new(&list))
+      return;
+
+   for (i = 0; i < list.size; i++)
+   {
+      unsigned a, b, c, d;
+      uint32_t addr;
+
+      if (sscanf(list.entries[i].host, "%u.%u.%u.%u", &a, &b, &c, &d) != 4)
+         continue;
+
+      if (!(a == 10 || (a == 172 && (b & 0xf0) == 16)
+               || (a == 192 && b == 168)) || d == 1)
+         continue;
+
+      addr = htonl((uint32_t)((a << 24) | (b << 16) | (c << 8) | 1));
+      natt_add_gateway(internal, addr);
+   }
+
+   net_ifinfo_free(&list);
 }
 
-bool natt_new(struct natt_status *status)
+static void natt_build_pcp(const struct natt_internal *internal,
+      const struct natt_gateway *gateway, uint8_t *req, uint32_t lifetime)
 {
-   memset(status, 0, sizeof(struct natt_status));
-   return true;
+   /* MAP request, RFC 6887 sections 7.1 and 11.1. Addresses
+    * are IPv4-mapped IPv6 addresses. */
+   memset(req, 0, 60);
+   req[0]  = 2;
+   req[1]  = 1;
+   natt_put32(req + 4, lifetime);
+   req[18] = req[19] = 0xff;
+   memcpy(req + 20, &gateway->local, 4);
+   memcpy(req + 24, internal->nonce, sizeof(internal->nonce));
+   req[36] = (internal->proto == SOCKET_PROTOCOL_UDP) ? 17 : 6;
+   natt_put16(req + 40, internal->port);
+   natt_put16(req + 42, internal->port);
+   /* Any external IPv4 address */
+   req[54] = req[55] = 0xff;
+}
+
+static void natt_build_pmp(const struct natt_internal *internal,
+      uint8_t *req, uint32_t lifetime)
+{
+   /* Mapping request, RFC 6886 section 3.3 */
+   memset(req, 0, 12);
+   req[1] = (internal->proto == SOCKET_PROTOCOL_UDP) ? 1 : 2;
+   natt_put16(req + 4, internal->port);
+   natt_put16(req + 6, lifetime ? internal->port : 0);
+   natt_put32(req + 8, lifetime);
+}
+
+static void natt_pmp_send(struct natt_internal *internal)
+{
+   unsigned i;
+
+   for (i = 0; i < internal->num_gateways; i++)
+   {
+      uint8_t pcp[60];
+      uint8_t pmp[12];
+      /* External address request, RFC 6886 section 3.2 */
+      static const uint8_t pmp_addr[2] = {0, 0};
+      const struct natt_gateway *gateway = &internal->gateways[i];
+      const struct sockaddr *to = (const struct sockaddr*)&gateway->addr;
+
+      /* Routers that only speak NAT-PMP reject the PCP request
+       * and the other way around, so both go out together */
+      natt_build_pcp(internal, gateway, pcp, NATT_LIFETIME);
+      natt_build_pmp(internal, pmp, NATT_LIFETIME);
+
+      sendto(internal->pmp_fd, (const char*)pcp, sizeof(pcp), 0,
+            to, sizeof(gateway->addr));
+      sendto(internal->pmp_fd, (const char*)pmp_addr, sizeof(pmp_addr), 0,
+            to, sizeof(gateway->addr));
+      sendto(internal->pmp_fd, (const char*)pmp, sizeof(pmp), 0,
+            to, sizeof(gateway->addr));
+   }
 }
 
-void natt_free(struct natt_status *status) { }
+static void natt_set_external(struct natt_status *status,
+      uint32_t addr, uint16_t port)
+{
+   memset(&status->ext_inet4_addr, 0, sizeof(status->ext_inet4_addr));
+   status->ext_inet4_addr.sin_family      = AF_INET;
+   status->ext_inet4_addr.sin_port        = htons(port);
+   status->ext_inet4_addr.sin_addr.s_addr = addr;
+   status->have_inet4                     = true;
+}
 
+static void natt_pmp_receive(struct natt_status *status,
+      struct natt_internal *internal)
+{
+   for (;;)
+   {
+      unsigned i;
+      uint8_t buf[128];
+      struct sockaddr_in from;
+      struct natt_gateway *gateway = NULL;
+      socklen_t fromlen            = sizeof(from);
+      ssize_t len                  = recvfrom(internal->pmp_fd,
+            (char*)buf, sizeof(buf), 0, (struct sockaddr*)&from, &fromlen);
+
+      if (len <= 0)
+         break;
+
+      for (i = 0; i < internal->num_gateways; i++)
+      {
+         if (     internal->gateways[i].addr.sin_addr.s_addr
+               == from.sin_addr.s_addr
+               && from.sin_port == htons(NATT_PMP_PORT))
+         {
+            gateway = &internal->gateways[i];
+            break;
+         }
+      }
+
+      if (!gateway || len < 8)
+         continue;
+
+      if (buf[0] == 2)
+      {
+         /* PCP MAP response, result code must be SUCCESS */
+         if (     len >= 60 && buf[1] == 0x81 && !buf[3]
+               && !memcmp(buf + 24, internal->nonce, sizeof(internal->nonce)))
+         {
+            uint32_t addr;
+            memcpy(&addr, buf + 56, sizeof(addr));
+            natt_set_external(status, addr, natt_get16(buf + 42));
+            internal->method         = NATT_METHOD_PCP;
+            internal->mapped_gateway = i;
+            return;
+         }
+      }
+      else if (buf[0] == 0 && !buf[2] && !buf[3])
+      {
+         if (buf[1] == 128 && len >= 12)
+            memcpy(&gateway->pmp_ext_addr, buf + 8,
+                  sizeof(gateway->pmp_ext_addr));
+         else if (buf[1] == 128 + (internal->proto == SOCKET_PROTOCOL_UDP
+                  ? 1 : 2) && len >= 16
+               && natt_get16(buf + 8) == internal->port)
+            gateway->pmp_ext_port = natt_get16(buf + 10);
+
+         /* A router that is behind another NAT itself still
+          * answers, with an address no one can reach; PCP
+          * lets it say so but NAT-PMP does not. */
+         if (gateway->pmp_ext_addr && gateway->pmp_ext_port)
+         {
+            natt_set_external(status, gateway->pmp_ext_addr,
+                  gateway->pmp_ext_port);
+            internal->method         = NATT_METHOD_PMP;
+            internal->mapped_gateway = i;
+            return;
+         }
+      }
+   }
+}
+
+#if HAVE_MINIUPNPC
 static bool natt_open_port(struct natt_status *status,
       struct sockaddr *addr, socklen_t addrlen, enum socket_protocol proto)
 {
-#ifndef HAVE_SOCKET_LEGACY
-#if HAVE_MINIUPNPC
    int r;
    char host[PATH_MAX_LENGTH], ext_host[PATH_MAX_LENGTH],
         port_str[6], ext_port_str[6];
@@ -169,54 +459,267 @@ static bool natt_open_port(struct natt_status *status,
 
    freeaddrinfo_retro(ext_addrinfo);
    return true;
-
-#else
-   return false;
-#endif
-#else
-   return false;
-#endif
 }
 
-bool natt_open_port_any(struct natt_status *status,
-      uint16_t port, enum socket_protocol proto)
+/* Maps the port through the router's control URL. This talks
+ * HTTP to the router and blocks, but only for as long as the
+ * router takes to answer on the local network. */
+static bool natt_upnp_map(struct natt_status *status,
+      struct natt_internal *internal)
 {
-#if !defined(HAVE_SOCKET_LEGACY) && (!defined(SWITCH) || defined(SWITCH) && defined(HAVE_LIBNX))
-   size_t i;
-   char port_str[6];
-   struct net_ifinfo list;
-   struct addrinfo hints = {0}, *addr;
+   char host[256];
+   struct sockaddr_in local;
+   struct addrinfo hints = {0};
+   struct addrinfo *addr = NULL;
    bool ret              = false;
 
-   snprintf(port_str, sizeof(port_str), "%hu", port);
+   if (!urls.controlURL || !urls.controlURL[0])
+      return false;
 
-   /* get our interfaces */
-   if (!net_ifinfo_new(&list))
+   /* Map our address on the router's network, not whatever
+    * other interfaces we have */
+   if (sscanf(urls.controlURL, "%*[^:]://%255[^:/]", host) != 1)
       return false;
 
-   /* loop through them */
-   for (i = 0; i < list.size; i++)
+   hints.ai_family = AF_INET;
+   if (getaddrinfo_retro(host, NULL, &hints, &addr) != 0)
+      return false;
+
+   memset(&local, 0, sizeof(local));
+   if (     addr->ai_family == AF_INET
+         && natt_local_address((const struct sockaddr_in*)addr->ai_addr,
+            &local.sin_addr))
+   {
+      local.sin_family = AF_INET;
+      local.sin_port   = htons(internal->port);
+      ret              = natt_open_port(status, (struct sockaddr*)&local,
+            sizeof(local), internal->proto);
+   }
+
+   freeaddrinfo_retro(addr);
+
+   if (ret)
+      internal->method = NATT_METHOD_UPNP;
+   return ret;
+}
+
+static bool natt_upnp_load(const char *location)
+{
+   int size  = 0;
+   char *xml = (char*)miniwget(location, &size, 0, NULL);
+
+   if (!xml)
+      return false;
+
+   FreeUPNPUrls(&urls);
+   memset(&urls, 0, sizeof(urls));
+   memset(&data, 0, sizeof(data));
+   parserootdesc(xml, size, &data);
+   free(xml);
+   GetUPNPUrls(&urls, &data, location, 0);
+
+   return urls.controlURL && urls.controlURL[0];
+}
+
+static void natt_ssdp_send(struct natt_internal *internal)
+{
+   struct sockaddr_in addr;
+   static const char search[] =
+      "M-SEARCH * HTTP/1.1\r\n"
+      "HOST: " NATT_SSDP_ADDR ":1900\r\n"
+      "MAN: \"ssdp:discover\"\r\n"
+      "MX: 2\r\n"
+      "ST: urn:schemas-upnp-org:device:InternetGatewayDevice:1\r\n"
+      "\r\n";
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family      = AF_INET;
+   addr.sin_port        = htons(NATT_SSDP_PORT);
+   addr.sin_addr.s_addr = inet_addr(NATT_SSDP_ADDR);
+
+   sendto(internal->ssdp_fd, search, sizeof(search) - 1, 0,
+         (const struct sockaddr*)&addr, sizeof(addr));
+}
+
+static void natt_ssdp_receive(struct natt_status *status,
+      struct natt_internal *internal)
+{
+   for (;;)
    {
-      struct net_ifinfo_entry *entry = list.entries + i;
+      char buf[1536];
+      char location[PATH_MAX_LENGTH];
+      size_t i;
+      const char *loc = NULL;
+      ssize_t len     = recv(internal->ssdp_fd, buf, sizeof(buf) - 1, 0);
+
+      if (len <= 0)
+         break;
 
-      /* ignore localhost */
-      if (  string_is_equal(entry->host, "127.0.0.1") ||
-            string_is_equal(entry->host, "::1"))
+      buf[len] = '\0';
+      if (!(loc = strcasestr(buf, "\nLOCATION:")))
          continue;
 
-      /* make a request for this host */
-      if (getaddrinfo_retro(entry->host, port_str, &hints, &addr) == 0)
+      for (loc += STRLEN_CONST("\nLOCATION:"); *loc == ' '; loc++);
+      for (i = 0; i < sizeof(location) - 1
+            && loc[i] && loc[i] != '\r' && loc[i] != '\n'; i++)
+         location[i] = loc[i];
+      location[i] = '\0';
+
+      /* One answer is enough, whether it works or not */
+      socket_close(internal->ssdp_fd);
+      internal->ssdp_fd = -1;
+
+      if (natt_upnp_load(location))
+         natt_upnp_map(status, internal);
+      return;
+   }
+}
+#endif
+
+static void natt_finish(struct natt_status *status,
+      struct natt_internal *internal)
+{
+   if (internal->pmp_fd >= 0)
+      socket_close(internal->pmp_fd);
+   if (internal->ssdp_fd >= 0)
+      socket_close(internal->ssdp_fd);
+   internal->pmp_fd            = -1;
+   internal->ssdp_fd           = -1;
+   status->nfds                = 0;
+   status->request_outstanding = false;
+   FD_ZERO(&status->fds);
+}
+
+static int natt_socket(void)
+{
+   struct sockaddr_in addr;
+   int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+   if (fd < 0)
+      return -1;
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+
+   if (     bind(fd, (const struct sockaddr*)&addr, sizeof(addr)) < 0
+         || !socket_nonblock(fd))
+   {
+      socket_close(fd);
+      return -1;
+   }
+
+   return fd;
+}
+#endif
+
+void natt_free(struct natt_status *status)
+{
+   struct natt_internal *internal = (struct natt_internal*)status->internal;
+
+   if (!internal)
+      return;
+
+#ifdef HAVE_NATT_REQUESTS
+   natt_finish(status, internal);
+
+   /* NAT-PMP and PCP mappings are removed by asking for a zero
+    * lifetime, which costs one datagram. UPnP mappings are left
+    * to expire rather than blocking on the router here. */
+   if (     internal->method == NATT_METHOD_PMP
+         || internal->method == NATT_METHOD_PCP)
+   {
+      uint8_t req[60];
+      int fd                             = natt_socket();
+      const struct natt_gateway *gateway =
+         &internal->gateways[internal->mapped_gateway];
+
+      if (fd >= 0)
       {
-         ret = natt_open_port(status, addr->ai_addr,
-               addr->ai_addrlen, proto) || ret;
-         freeaddrinfo_retro(addr);
+         if (internal->method == NATT_METHOD_PCP)
+         {
+            natt_build_pcp(internal, gateway, req, 0);
+            sendto(fd, (const char*)req, 60, 0,
+                  (const struct sockaddr*)&gateway->addr,
+                  sizeof(gateway->addr));
+         }
+         else
+         {
+            natt_build_pmp(internal, req, 0);
+            sendto(fd, (const char*)req, 12, 0,
+                  (const struct sockaddr*)&gateway->addr,
+                  sizeof(gateway->addr));
+         }
+         socket_close(fd);
       }
    }
+#endif
 
-   net_ifinfo_free(&list);
+   free(internal);
+   status->internal = NULL;
+}
 
-   return ret;
+bool natt_open_port_any(struct natt_status *status,
+      uint16_t port, enum socket_protocol proto)
+{
+#ifdef HAVE_NATT_REQUESTS
+   unsigned i;
+   retro_time_t seed;
+   struct natt_internal *internal = (struct natt_internal*)status->internal;
+
+   if (!internal)
+      return false;
+
+   internal->port   = port;
+   internal->proto  = proto;
+   internal->method = NATT_METHOD_NONE;
+
+   /* Tells our PCP responses apart from stale ones */
+   seed = cpu_features_get_time_usec() ^ (retro_time_t)time(NULL);
+   for (i = 0; i < sizeof(internal->nonce); i++)
+      internal->nonce[i] = (uint8_t)((rand() >> 4) ^ (seed >> (i * 5)));
+
+   FD_ZERO(&status->fds);
+   status->nfds = 0;
 
+   natt_find_gateways(internal);
+   if (internal->num_gateways && (internal->pmp_fd = natt_socket()) >= 0)
+   {
+      natt_pmp_send(internal);
+      FD_SET(internal->pmp_fd, &status->fds);
+      status->nfds = internal->pmp_fd + 1;
+   }
+
+#if HAVE_MINIUPNPC
+   /* A router found by an earlier request answers right away,
+    * only search again if it stopped doing so */
+   if (natt_upnp_map(status, internal))
+   {
+      natt_finish(status, internal);
+      return true;
+   }
+
+   FreeUPNPUrls(&urls);
+   memset(&urls, 0, sizeof(urls));
+
+   if ((internal->ssdp_fd = natt_socket()) >= 0)
+   {
+      natt_ssdp_send(internal);
+      FD_SET(internal->ssdp_fd, &status->fds);
+      if (internal->ssdp_fd >= status->nfds)
+         status->nfds = internal->ssdp_fd + 1;
+   }
+#endif
+
+   if (!status->nfds)
+      return false;
+
+   internal->tries             = 1;
+   internal->retry             = NATT_RETRY;
+   internal->next_send         = cpu_features_get_time_usec() + NATT_RETRY;
+   internal->deadline          = cpu_features_get_time_usec() + NATT_TIMEOUT;
+   status->request_outstanding = true;
+
+   return true;
 #else
    return false;
 #endif
@@ -224,8 +727,45 @@ bool natt_open_port_any(struct natt_status *status,
 
 bool natt_read(struct natt_status *status)
 {
-   /* MiniUPNPC is always synchronous, so there's nothing to read here.
-    * Reserved for future backends. */
+#ifdef HAVE_NATT_REQUESTS
+   retro_time_t now;
+   struct natt_internal *internal = (struct natt_internal*)status->internal;
+
+   if (!internal || !status->request_outstanding)
+      return false;
+
+   /* Whichever method answers first wins */
+   if (internal->pmp_fd >= 0)
+      natt_pmp_receive(status, internal);
+#if HAVE_MINIUPNPC
+   if (internal->method == NATT_METHOD_NONE && internal->ssdp_fd >= 0)
+      natt_ssdp_receive(status, internal);
+#endif
+
+   if (internal->method != NATT_METHOD_NONE)
+   {
+      natt_finish(status, internal);
+      return true;
+   }
+
+   now = cpu_features_get_time_usec();
+
+   if (now >= internal->deadline)
+      natt_finish(status, internal);
+   else if (now >= internal->next_send && internal->tries < NATT_TRIES)
+   {
+      if (internal->pmp_fd >= 0)
+         natt_pmp_send(internal);
+#if HAVE_MINIUPNPC
+      if (internal->ssdp_fd >= 0 && internal->tries < 2)
+         natt_ssdp_send(internal);
+#endif
+      internal->tries++;
+      internal->retry    *= 2;
+      internal->next_send = now + internal->retry;
+   }
+#endif
+
    return false;
 }
 
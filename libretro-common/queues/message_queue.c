@@ -28,6 +28,81 @@
 #include <compat/strl.h>
 #include <compat/posix_string.h>
 
+/* Posting only needs a compare-and-swap, which returns
+ * the previous value. Without one a lock stands in. */
+#if defined(_MSC_VER) && !defined(_XBOX)
+#include <windows.h>
+#define MSG_QUEUE_CAS(ptr, oldval, newval) ((queue_elem_t*) \
+      InterlockedCompareExchangePointer((PVOID volatile*)(ptr), \
+         (PVOID)(newval), (PVOID)(oldval)))
+#define MSG_QUEUE_ADD(ptr, val) \
+      (InterlockedExchangeAdd((LONG volatile*)(ptr), (val)) + (val))
+#elif defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+#define MSG_QUEUE_CAS(ptr, oldval, newval) \
+      __sync_val_compare_and_swap((ptr), (oldval), (newval))
+#define MSG_QUEUE_ADD(ptr, val) __sync_add_and_fetch((ptr), (val))
+#elif defined(HAVE_THREADS)
+#include <rthreads/rthreads.h>
+#define MSG_QUEUE_POST_LOCK
+#endif
+
+/* Swaps the list of posted messages for 'list', returns the old one */
+static queue_elem_t *msg_queue_posted_swap(msg_queue_t *queue,
+      queue_elem_t *list, bool link)
+{
+#ifdef MSG_QUEUE_CAS
+   queue_elem_t *head = MSG_QUEUE_CAS(&queue->posted, NULL, NULL);
+
+   for (;;)
+   {
+      queue_elem_t *prev;
+      if (link)
+         list->next = head;
+      if ((prev = MSG_QUEUE_CAS(&queue->posted, head, list)) == head)
+         return head;
+      head = prev;
+   }
+#else
+   queue_elem_t *head;
+#ifdef MSG_QUEUE_POST_LOCK
+   slock_lock(queue->post_lock);
+#endif
+   head          = queue->posted;
+   if (link)
+      list->next = head;
+   queue->posted = list;
+#ifdef MSG_QUEUE_POST_LOCK
+   slock_unlock(queue->post_lock);
+#endif
+   return head;
+#endif
+}
+
+/* Adds 'delta' to the number of posted messages, returns the new one */
+static long msg_queue_posted_add(msg_queue_t *queue, long delta)
+{
+#ifdef MSG_QUEUE_ADD
+   return MSG_QUEUE_ADD(&queue->posted_count, delta);
+#else
+   long count;
+#ifdef MSG_QUEUE_POST_LOCK
+   slock_lock(queue->post_lock);
+#endif
+   count = (queue->posted_count += delta);
+#ifdef MSG_QUEUE_POST_LOCK
+   slock_unlock(queue->post_lock);
+#endif
+   return count;
+#endif
+}
+
+static void msg_queue_elem_free(queue_elem_t *elem)
+{
+   free(elem->msg);
+   free(elem->title);
+   free(elem);
+}
+
 static bool msg_queue_initialize_internal(msg_queue_t *queue, size_t size)
 {
    struct queue_elem **elems = (struct queue_elem**)calloc(size + 1,
@@ -38,9 +113,20 @@ static bool msg_queue_initialize_internal(msg_queue_t *queue, size_t size)
 
    queue->tmp_msg            = NULL;
    queue->elems              = elems;
+   queue->posted             = NULL;
+   queue->posted_count       = 0;
+   queue->post_lock          = NULL;
    queue->ptr                = 1;
    queue->size               = size + 1;
 
+#ifdef MSG_QUEUE_POST_LOCK
+   if (!(queue->post_lock = slock_new()))
+   {
+      free(elems);
+      return false;
+   }
+#endif
+
    return true;
 }
 
@@ -86,16 +172,32 @@ void msg_queue_free(msg_queue_t *queue)
 {
    if (!queue)
       return;
-   msg_queue_clear(queue);
-   free(queue->elems);
+   msg_queue_deinitialize(queue);
    free(queue);
 }
 
 bool msg_queue_deinitialize(msg_queue_t *queue)
 {
+   queue_elem_t *posted;
+
    if (!queue)
       return false;
    msg_queue_clear(queue);
+
+   posted = msg_queue_posted_swap(queue, NULL, false);
+   while (posted)
+   {
+      queue_elem_t *next = posted->next;
+      msg_queue_elem_free(posted);
+      posted             = next;
+   }
+   queue->posted_count = 0;
+#ifdef MSG_QUEUE_POST_LOCK
+   if (queue->post_lock)
+      slock_free(queue->post_lock);
+#endif
+   queue->post_lock = NULL;
+
    free(queue->elems);
    queue->elems   = NULL;
    queue->tmp_msg = NULL;
@@ -104,6 +206,56 @@ bool msg_queue_deinitialize(msg_queue_t *queue)
    return true;
 }
 
+static queue_elem_t *msg_queue_elem_new(const char *msg,
+      unsigned prio, unsigned duration, bool flush,
+      char *title,
+      enum message_queue_icon icon, enum message_queue_category category)
+{
+   queue_elem_t *new_elem        = (queue_elem_t*)malloc(
+      sizeof(queue_elem_t));
+   if (!new_elem)
+      return NULL;
+
+   new_elem->duration            = duration;
+   new_elem->prio                = prio;
+   new_elem->msg                 = msg   ? strdup(msg)   : NULL;
+   new_elem->title               = title ? strdup(title) : NULL;
+   new_elem->next                = NULL;
+   new_elem->icon                = icon;
+   new_elem->category            = category;
+   new_elem->flush               = flush;
+   return new_elem;
+}
+
+static void msg_queue_insert(msg_queue_t *queue, queue_elem_t *new_elem)
+{
+   size_t tmp_ptr                = 0;
+
+   if (queue->ptr >= queue->size)
+   {
+      msg_queue_elem_free(new_elem);
+      return;
+   }
+
+   queue->elems[queue->ptr]      = new_elem;
+
+   tmp_ptr                       = queue->ptr++;
+
+   while (tmp_ptr > 1)
+   {
+      struct queue_elem *parent  = queue->elems[tmp_ptr >> 1];
+      struct queue_elem *child   = queue->elems[tmp_ptr];
+
+      if (child->prio <= parent->prio)
+         break;
+
+      queue->elems[tmp_ptr >> 1] = child;
+      queue->elems[tmp_ptr]      = parent;
+
+      tmp_ptr >>= 1;
+   }
+}
+
 /**
  * msg_queue_push:
  * @queue             : pointer to queue object
@@ -120,41 +272,91 @@ void msg_queue_push(msg_queue_t *queue, const char *msg,
       char *title,
       enum message_queue_icon icon, enum message_queue_category category)
 {
-   size_t tmp_ptr = 0;
    struct queue_elem *new_elem = NULL;
 
    if (!queue || queue->ptr >= queue->size)
       return;
 
-   new_elem                      = (struct queue_elem*)malloc(
-      sizeof(struct queue_elem));
-   if (!new_elem)
-      return;
+   if ((new_elem = msg_queue_elem_new(msg, prio, duration, false,
+               title, icon, category)))
+      msg_queue_insert(queue, new_elem);
+}
 
-   new_elem->duration            = duration;
-   new_elem->prio                = prio;
-   new_elem->msg                 = msg   ? strdup(msg)   : NULL;
-   new_elem->title               = title ? strdup(title) : NULL;
-   new_elem->icon                = icon;
-   new_elem->category            = category;
+bool msg_queue_post(msg_queue_t *queue, const char *msg,
+      unsigned prio, unsigned duration, bool flush,
+      char *title,
+      enum message_queue_icon icon, enum message_queue_category category)
+{
+   struct queue_elem *new_elem = NULL;
 
-   queue->elems[queue->ptr]      = new_elem;
+   if (!queue || !queue->size)
+      return false;
 
-   tmp_ptr                       = queue->ptr++;
+   /* Nobody collects while the video thread stalls,
+    * don't let a chatty task pile up messages meanwhile */
+   if (msg_queue_posted_add(queue, 1) > MSG_QUEUE_MAX_POSTED)
+   {
+      msg_queue_posted_add(queue, -1);
+      return false;
+   }
 
-   while (tmp_ptr > 1)
+   if (!(new_elem = msg_queue_elem_new(msg, prio, duration, flush,
+               title, icon, category)))
    {
-      struct queue_elem *parent  = queue->elems[tmp_ptr >> 1];
-      struct queue_elem *child   = queue->elems[tmp_ptr];
+      msg_queue_posted_add(queue, -1);
+      return false;
+   }
 
-      if (child->prio <= parent->prio)
-         break;
+   msg_queue_posted_swap(queue, new_elem, true);
+   return true;
+}
 
-      queue->elems[tmp_ptr >> 1] = child;
-      queue->elems[tmp_ptr]      = parent;
+size_t msg_queue_collect(msg_queue_t *queue,
+      msg_queue_collect_t cb, void *userdata)
+{
+   size_t count         = 0;
+   queue_elem_t *oldest = NULL;
+   queue_elem_t *posted;
 
-      tmp_ptr >>= 1;
+   if (!queue)
+      return 0;
+
+   /* The posted list is newest first, reverse it */
+   posted = msg_queue_posted_swap(queue, NULL, false);
+   while (posted)
+   {
+      queue_elem_t *next = posted->next;
+      posted->next       = oldest;
+      oldest             = posted;
+      posted             = next;
+      count++;
+   }
+
+   if (count)
+      msg_queue_posted_add(queue, -(long)count);
+
+   while (oldest)
+   {
+      queue_elem_t *next = oldest->next;
+
+      if (cb && cb(userdata, oldest))
+         msg_queue_elem_free(oldest);
+      else
+      {
+         if (oldest->flush)
+            msg_queue_clear(queue);
+         msg_queue_insert(queue, oldest);
+      }
+
+      oldest = next;
    }
+
+   return count;
+}
+
+bool msg_queue_has_posted(msg_queue_t *queue)
+{
+   return queue && msg_queue_posted_add(queue, 0) > 0;
 }
 
 /**
@@ -174,9 +376,7 @@ void msg_queue_clear(msg_queue_t *queue)
    {
       if (queue->elems[i])
       {
-         free(queue->elems[i]->msg);
-         free(queue->elems[i]->title);
-         free(queue->elems[i]);
+         msg_queue_elem_free(queue->elems[i]);
          queue->elems[i] = NULL;
       }
    }
@@ -224,10 +424,10 @@ const char *msg_queue_pull(msg_queue_t *queue)
       struct queue_elem *parent = NULL;
       struct queue_elem *child  = NULL;
       size_t switch_index       = tmp_ptr;
-      bool left                 = (tmp_ptr * 2 <= queue->ptr)
-         && (queue->elems[tmp_ptr] < queue->elems[tmp_ptr * 2]);
-      bool right                = (tmp_ptr * 2 + 1 <= queue->ptr)
-         && (queue->elems[tmp_ptr] < queue->elems[tmp_ptr * 2 + 1]);
+      bool left                 = (tmp_ptr * 2 < queue->ptr)
+         && (queue->elems[tmp_ptr]->prio < queue->elems[tmp_ptr * 2]->prio);
+      bool right                = (tmp_ptr * 2 + 1 < queue->ptr)
+         && (queue->elems[tmp_ptr]->prio < queue->elems[tmp_ptr * 2 + 1]->prio);
 
       if (!left && !right)
          break;
@@ -238,8 +438,8 @@ const char *msg_queue_pull(msg_queue_t *queue)
          switch_index += switch_index + 1;
       else
       {
-         if (queue->elems[tmp_ptr * 2]
-               >= queue->elems[tmp_ptr * 2 + 1])
+         if (queue->elems[tmp_ptr * 2]->prio
+               >= queue->elems[tmp_ptr * 2 + 1]->prio)
             switch_index <<= 1;
          else
             switch_index += switch_index + 1;
@@ -303,10 +503,10 @@ bool msg_queue_extract(msg_queue_t *queue, msg_queue_entry_t *queue_entry)
       struct queue_elem *parent = NULL;
       struct queue_elem *child  = NULL;
       size_t switch_index       = tmp_ptr;
-      bool left                 = (tmp_ptr * 2 <= queue->ptr)
-         && (queue->elems[tmp_ptr] < queue->elems[tmp_ptr * 2]);
-      bool right                = (tmp_ptr * 2 + 1 <= queue->ptr)
-         && (queue->elems[tmp_ptr] < queue->elems[tmp_ptr * 2 + 1]);
+      bool left                 = (tmp_ptr * 2 < queue->ptr)
+         && (queue->elems[tmp_ptr]->prio < queue->elems[tmp_ptr * 2]->prio);
+      bool right                = (tmp_ptr * 2 + 1 < queue->ptr)
+         && (queue->elems[tmp_ptr]->prio < queue->elems[tmp_ptr * 2 + 1]->prio);
 
       if (!left && !right)
          break;
@@ -317,8 +517,8 @@ bool msg_queue_extract(msg_queue_t *queue, msg_queue_entry_t *queue_entry)
          switch_index += switch_index + 1;
       else
       {
-         if (queue->elems[tmp_ptr * 2]
-               >= queue->elems[tmp_ptr * 2 + 1])
+         if (queue->elems[tmp_ptr * 2]->prio
+               >= queue->elems[tmp_ptr * 2 + 1]->prio)
             switch_index <<= 1;
          else
             switch_index += switch_index + 1;
@@ -59,11 +59,13 @@ struct retro_task_impl
 
 /* TODO/FIXME - static globals */
 static retro_task_queue_msg_t msg_push_bak  = NULL;
+static retro_task_queue_trace_t trace_cb    = NULL;
 static task_queue_t tasks_running           = {NULL, NULL};
 static task_queue_t tasks_finished          = {NULL, NULL};
 
 static struct retro_task_impl *impl_current = NULL;
 static bool task_threaded_enable            = false;
+static unsigned task_worker_count           = 1;
 
 #ifdef HAVE_THREADS
 static slock_t *running_lock                = NULL;
@@ -71,7 +73,9 @@ static slock_t *finished_lock               = NULL;
 static slock_t *property_lock               = NULL;
 static slock_t *queue_lock                  = NULL;
 static scond_t *worker_cond                 = NULL;
-static sthread_t *worker_thread             = NULL;
+/* worker_threads[0] is the primary worker */
+static sthread_t *worker_threads[TASK_QUEUE_MAX_WORKERS];
+static unsigned worker_threads_count        = 0;
 static bool worker_continue                 = true; 
 /* use running_lock when touching it */
 #endif
@@ -219,7 +223,11 @@ static void retro_task_regular_gather(void)
 
       if (!task->when || task->when < cpu_features_get_time_usec())
       {
+         if (trace_cb)
+            trace_cb(task, true);
          task->handler(task);
+         if (trace_cb)
+            trace_cb(task, false);
 
          task_queue_push_progress(task);
       }
@@ -371,7 +379,8 @@ static void retro_task_threaded_push_running(retro_task_t *task)
    slock_lock(running_lock);
    slock_lock(queue_lock);
    task_queue_put(&tasks_running, task);
-   scond_signal(worker_cond);
+   /* Not every worker may take every task */
+   scond_broadcast(worker_cond);
    slock_unlock(queue_lock);
    slock_unlock(running_lock);
 }
@@ -467,87 +476,140 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
    slock_unlock(running_lock);
 }
 
+/* 'running_lock' must be held for the duration of this function.
+ * Returns the task 'worker' should run next: of the tasks that are
+ * due and not being run by another worker, the first one of the
+ * highest priority class. Tasks that are not due yet set 'when'
+ * to the earliest time one of them will be. */
+static retro_task_t *threaded_worker_get_task(unsigned worker,
+      retro_time_t *when)
+{
+   retro_task_t *task = NULL;
+   retro_task_t *best = NULL;
+   retro_time_t now   = 0;
+
+   for (task = tasks_running.front; task; task = task->next)
+   {
+      if (task->busy
+            || (worker != 0 && task->affinity == TASK_AFFINITY_PRIMARY))
+         continue;
+
+      if (task->when)
+      {
+         if (!now)
+            now = cpu_features_get_time_usec();
+
+         /* allow half a millisecond for context switching */
+         if (task->when - now - 500 > 0)
+         {
+            if (!*when || task->when < *when)
+               *when = task->when;
+            continue;
+         }
+      }
+
+      if (!best || task->priority < best->priority)
+      {
+         best = task;
+         if (best->priority == TASK_PRIORITY_INTERACTIVE)
+            break;
+      }
+   }
+
+   return best;
+}
+
 static void threaded_worker(void *userdata)
 {
-   (void)userdata;
+   unsigned worker = (unsigned)(uintptr_t)userdata;
 
    for (;;)
    {
       retro_task_t *task  = NULL;
+      retro_time_t when   = 0;
       bool       finished = false;
-
-      if (!worker_continue)
-         break; /* should we keep running until all tasks finished? */
+      bool    wake_others = false;
 
       slock_lock(running_lock);
 
-      /* Get first task to run */
-      task = tasks_running.front;
-      if (!task)
+      if (!worker_continue)
       {
-         scond_wait(worker_cond, running_lock);
+         /* should we keep running until all tasks finished? */
          slock_unlock(running_lock);
-         continue;
+         break;
       }
 
-      if (task->when)
+      if (!(task = threaded_worker_get_task(worker, &when)))
       {
-         retro_time_t now   = cpu_features_get_time_usec();
-         retro_time_t delay = task->when - now - 500; /* allow half a millisecond for context switching */
-         if (delay > 0)
+         if (when)
          {
-            scond_wait_timeout(worker_cond, running_lock, delay);
-            slock_unlock(running_lock);
-            continue;
+            retro_time_t delay = when - cpu_features_get_time_usec() - 500;
+            if (delay > 0)
+               scond_wait_timeout(worker_cond, running_lock, delay);
          }
+         else
+            scond_wait(worker_cond, running_lock);
+         slock_unlock(running_lock);
+         continue;
       }
 
+      task->busy = true;
       slock_unlock(running_lock);
 
+      if (trace_cb)
+         trace_cb(task, true);
       task->handler(task);
+      if (trace_cb)
+         trace_cb(task, false);
 
       slock_lock(property_lock);
       finished = task->finished;
       slock_unlock(property_lock);
 
+      slock_lock(running_lock);
+      slock_lock(queue_lock);
+
+      task->busy  = false;
+      /* Other workers may be waiting for this task
+       * or for one queued behind it */
+      wake_others = (tasks_running.front != task || task->next);
+
       /* Update queue */
       if (!finished)
       {
          /* Move the task to the back of the queue */
          /* mimics retro_task_threaded_push_running, 
           * but also includes a task_queue_remove */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
 
          /* do nothing if only item in queue */
          if (task->next) 
          {
             task_queue_remove(&tasks_running, task);
             task_queue_put(&tasks_running, task);
-            scond_signal(worker_cond);
          }
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
       }
       else
       {
          /* Remove task from running queue */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
          task_queue_remove(&tasks_running, task);
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
 
          /* Add task to finished queue */
          slock_lock(finished_lock);
          task_queue_put(&tasks_finished, task);
          slock_unlock(finished_lock);
       }
+
+      if (wake_others)
+         scond_broadcast(worker_cond);
+      slock_unlock(queue_lock);
+      slock_unlock(running_lock);
    }
 }
 
 static void retro_task_threaded_init(void)
 {
+   unsigned i;
+
    running_lock    = slock_new();
    finished_lock   = slock_new();
    property_lock   = slock_new();
@@ -558,17 +620,32 @@ static void retro_task_threaded_init(void)
    worker_continue = true;
    slock_unlock(running_lock);
 
-   worker_thread   = sthread_create(threaded_worker, NULL);
+   worker_threads_count = 0;
+   for (i = 0; i < task_worker_count; i++)
+   {
+      if (!(worker_threads[worker_threads_count] = sthread_create_with_role(
+            threaded_worker, (void*)(uintptr_t)worker_threads_count,
+            STHREAD_ROLE_TASK)))
+         break;
+      worker_threads_count++;
+   }
 }
 
 static void retro_task_threaded_deinit(void)
 {
+   unsigned i;
+
    slock_lock(running_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
+   scond_broadcast(worker_cond);
    slock_unlock(running_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < worker_threads_count; i++)
+   {
+      sthread_join(worker_threads[i]);
+      worker_threads[i] = NULL;
+   }
+   worker_threads_count = 0;
 
    scond_free(worker_cond);
    slock_free(running_lock);
@@ -576,7 +653,6 @@ static void retro_task_threaded_deinit(void)
    slock_free(property_lock);
    slock_free(queue_lock);
 
-   worker_thread   = NULL;
    worker_cond     = NULL;
    running_lock    = NULL;
    finished_lock   = NULL;
@@ -642,6 +718,20 @@ bool task_queue_is_threaded(void)
    return task_threaded_enable;
 }
 
+void task_queue_set_worker_count(unsigned count)
+{
+   if (count < 1)
+      count = 1;
+   if (count > TASK_QUEUE_MAX_WORKERS)
+      count = TASK_QUEUE_MAX_WORKERS;
+   task_worker_count = count;
+}
+
+void task_queue_set_trace_cb(retro_task_queue_trace_t cb)
+{
+   trace_cb = cb;
+}
+
 bool task_queue_find(task_finder_data_t *find_data)
 {
    if (!impl_current->find(find_data->func, find_data->userdata))
@@ -908,6 +998,9 @@ retro_task_t *task_init(void)
    task->progress_cb       = NULL;
    task->title             = NULL;
    task->type              = TASK_TYPE_NONE;
+   task->priority          = TASK_PRIORITY_INTERACTIVE;
+   task->affinity          = TASK_AFFINITY_PRIMARY;
+   task->busy              = false;
    task->ident             = task_count++;
    task->frontend_userdata = NULL;
    task->alternative_look  = false;
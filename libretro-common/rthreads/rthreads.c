@@ -26,6 +26,11 @@
 #endif
 #endif
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* For sched_setaffinity() */
+#define _GNU_SOURCE
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 
@@ -55,6 +60,11 @@
 #include <time.h>
 #endif
 
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+
 #if defined(VITA) || defined(BSD) || defined(ORBIS)
 #include <sys/time.h>
 #endif
@@ -68,8 +78,11 @@ struct thread_data
 {
    void (*func)(void*);
    void *userdata;
+   enum sthread_role role;
 };
 
+static sthread_policy_t sthread_role_policies[STHREAD_ROLE_LAST];
+
 struct sthread
 {
 #ifdef USE_WIN32_THREADS
@@ -140,6 +153,8 @@ static void *thread_wrap(void *data_)
    struct thread_data *data = (struct thread_data*)data_;
    if (!data)
 	   return 0;
+   if (data->role != STHREAD_ROLE_NONE)
+      sthread_apply_role(data->role);
    data->func(data->userdata);
    free(data);
    return 0;
@@ -165,22 +180,8 @@ sthread_t *sthread_create(void (*thread_func)(void*), void *userdata)
 #define HAVE_THREAD_ATTR
 #endif
 
-/**
- * sthread_create_with_priority:
- * @start_routine           : thread entry callback function
- * @userdata                : pointer to userdata that will be made
- *                            available in thread entry callback function
- * @thread_priority         : thread priority hint value from [1-100]
- *
- * Create a new thread. It is possible for the caller to give a hint
- * for the thread's priority from [1-100]. Any passed in @thread_priority
- * values that are outside of this range will cause sthread_create() to
- * create a new thread using the operating system's default thread
- * priority.
- *
- * Returns: pointer to new thread if successful, otherwise NULL.
- */
-sthread_t *sthread_create_with_priority(void (*thread_func)(void*), void *userdata, int thread_priority)
+static sthread_t *sthread_create_internal(void (*thread_func)(void*),
+      void *userdata, int thread_priority, enum sthread_role role)
 {
 #ifdef HAVE_THREAD_ATTR
    pthread_attr_t thread_attr;
@@ -199,6 +200,7 @@ sthread_t *sthread_create_with_priority(void (*thread_func)(void*), void *userda
 
    data->func               = thread_func;
    data->userdata           = userdata;
+   data->role               = role;
 
 #ifdef USE_WIN32_THREADS
    thread->id               = 0;
@@ -250,6 +252,106 @@ error:
    return NULL;
 }
 
+/**
+ * sthread_create_with_priority:
+ * @start_routine           : thread entry callback function
+ * @userdata                : pointer to userdata that will be made
+ *                            available in thread entry callback function
+ * @thread_priority         : thread priority hint value from [1-100]
+ *
+ * Create a new thread. It is possible for the caller to give a hint
+ * for the thread's priority from [1-100]. Any passed in @thread_priority
+ * values that are outside of this range will cause sthread_create() to
+ * create a new thread using the operating system's default thread
+ * priority.
+ *
+ * Returns: pointer to new thread if successful, otherwise NULL.
+ */
+sthread_t *sthread_create_with_priority(void (*thread_func)(void*),
+      void *userdata, int thread_priority)
+{
+   return sthread_create_internal(thread_func, userdata,
+         thread_priority, STHREAD_ROLE_NONE);
+}
+
+/**
+ * sthread_create_with_role:
+ * @start_routine           : thread entry callback function
+ * @userdata                : pointer to userdata that will be made
+ *                            available in thread entry callback function
+ * @role                    : what the thread is used for
+ *
+ * Create a new thread, which applies the policy of @role
+ * (from its own context) before running @start_routine.
+ *
+ * Returns: pointer to new thread if successful, otherwise NULL.
+ */
+sthread_t *sthread_create_with_role(void (*thread_func)(void*),
+      void *userdata, enum sthread_role role)
+{
+   if (role >= STHREAD_ROLE_LAST)
+      role = STHREAD_ROLE_NONE;
+   return sthread_create_internal(thread_func, userdata, 0, role);
+}
+
+void sthread_set_role_policy(enum sthread_role role,
+      const sthread_policy_t *policy)
+{
+   if (role == STHREAD_ROLE_NONE || role >= STHREAD_ROLE_LAST)
+      return;
+
+   if (policy)
+      sthread_role_policies[role] = *policy;
+   else
+      memset(&sthread_role_policies[role], 0, sizeof(sthread_policy_t));
+}
+
+bool sthread_apply_role(enum sthread_role role)
+{
+   const sthread_policy_t *policy;
+   bool ret = true;
+
+   if (role == STHREAD_ROLE_NONE || role >= STHREAD_ROLE_LAST)
+      return false;
+
+   policy = &sthread_role_policies[role];
+
+#if defined(USE_WIN32_THREADS) && !defined(_XBOX) && !defined(__WINRT__)
+   if (policy->cpu_mask)
+      ret = SetThreadAffinityMask(GetCurrentThread(),
+            (DWORD_PTR)policy->cpu_mask) != 0;
+
+   if (policy->priority)
+      ret = SetThreadPriority(GetCurrentThread(), (policy->priority > 0)
+            ? THREAD_PRIORITY_ABOVE_NORMAL
+            : THREAD_PRIORITY_BELOW_NORMAL) && ret;
+#elif defined(__linux__)
+   if (policy->cpu_mask)
+   {
+      unsigned i;
+      cpu_set_t set;
+
+      CPU_ZERO(&set);
+      for (i = 0; i < 64; i++)
+         if (policy->cpu_mask & (UINT64_C(1) << i))
+            CPU_SET(i, &set);
+
+      /* pid 0 is the calling thread */
+      ret = sched_setaffinity(0, sizeof(set), &set) == 0;
+   }
+
+   /* On Linux, the nice value is per thread */
+   if (policy->priority)
+      ret = (setpriority(PRIO_PROCESS, 0,
+               (policy->priority > 0) ? -5 : 5) == 0) && ret;
+#else
+   if (policy->cpu_mask || policy->priority)
+      ret = false;
+#endif
+
+   return ret;
+}
+
 /**
  * sthread_detach:
  * @thread                  : pointer to thread object
@@ -34,28 +34,63 @@
 /* Work object which will sit in a queue
  * waiting for the pool to process it.
  *
- * It is a singly linked list acting as a FIFO queue. */
+ * It is a doubly linked list so the owning worker
+ * can take the newest item from the back while
+ * other workers steal the oldest from the front. */
 struct tpool_work
 {
-   thread_func_t      func;  /* Function to be called. */
-   void              *arg;   /* Data to be passed to func. */
-   struct tpool_work *next;  /* Next work item in the queue. */
+   thread_func_t        func;  /* Function to be called. */
+   void                *arg;   /* Data to be passed to func. */
+   struct tpool_group  *group; /* Wait group to notify, if any. */
+   struct tpool_work   *prev;  /* Previous (older) work item in the queue. */
+   struct tpool_work   *next;  /* Next (newer) work item in the queue. */
 };
 typedef struct tpool_work tpool_work_t;
 
+/* One queue per worker, plus one last queue for work
+ * added by threads outside of the pool. */
+struct tpool_queue
+{
+   struct tpool     *tp;
+   tpool_work_t     *first;    /* Oldest work item, stolen first. */
+   tpool_work_t     *last;     /* Newest work item, run first by the owner. */
+   slock_t          *lock;     /* Protects first and last. */
+   uintptr_t         owner;    /* Thread id of the worker owning the queue. */
+};
+
 struct tpool
 {
-   tpool_work_t    *work_first;   /* First work item in the work queue. */
-   tpool_work_t    *work_last;    /* Last work item in the work queue. */
-   slock_t         *work_mutex;   /* Mutex protecting inserting and removing work from the work queue. */
-   scond_t         *work_cond;    /* Conditional to signal when there is work to process. */
-   scond_t         *working_cond; /* Conditional to signal when there is no work processing.
-                                       This will also signal when there are no threads running. */
-   size_t           working_cnt;  /* The number of threads processing work (Not waiting for work). */
-   size_t           thread_cnt;   /* Total number of threads within the pool. */
-   bool             stop;         /* Marker to tell the work threads to exit. */
+   struct tpool_queue *queues;     /* thread_cnt worker queues and the shared queue. */
+   size_t           queue_cnt;     /* Number of queues, thread_cnt + 1. */
+   slock_t         *work_mutex;    /* Mutex protecting the counters below. */
+   scond_t         *work_cond;     /* Conditional to signal when there is work to process. */
+   scond_t         *working_cond;  /* Conditional to signal when there is no work processing.
+                                        This will also signal when there are no threads running. */
+   size_t           pending_cnt;   /* Work items queued that no thread has claimed yet. */
+   size_t           working_cnt;   /* The number of threads processing work (Not waiting for work). */
+   size_t           thread_cnt;    /* Total number of threads within the pool. */
+   size_t           next_queue;    /* Worker queue that gets the next outside work item. */
+   bool             stop;          /* Marker to tell the work threads to exit. */
+};
+
+struct tpool_group
+{
+   slock_t         *lock;
+   scond_t         *cond;          /* Signalled when outstanding drops to 0. */
+   size_t           outstanding;   /* Work items added and not finished yet. */
 };
 
+struct tpool_range
+{
+   tpool_range_func_t func;
+   void              *arg;
+   size_t             begin;
+   size_t             end;
+};
+
+/* Pool handed out by tpool_shared() */
+static tpool_t *tpool_shared_pool = NULL;
+
 static tpool_work_t *tpool_work_create(thread_func_t func, void *arg)
 {
    tpool_work_t *work;
@@ -63,10 +98,14 @@ static tpool_work_t *tpool_work_create(thread_func_t func, void *arg)
    if (!func)
       return NULL;
 
-   work       = (tpool_work_t*)calloc(1, sizeof(*work));
-   work->func = func;
-   work->arg  = arg;
-   work->next = NULL;
+   if (!(work = (tpool_work_t*)malloc(sizeof(*work))))
+      return NULL;
+
+   work->func  = func;
+   work->arg   = arg;
+   work->group = NULL;
+   work->prev  = NULL;
+   work->next  = NULL;
    return work;
 }
 
@@ -76,130 +115,229 @@ static void tpool_work_destroy(tpool_work_t *work)
       free(work);
 }
 
-/* Pull the first work item out of the queue. */
-static tpool_work_t *tpool_work_get(tpool_t *tp)
+static void tpool_group_done(tpool_group_t *group)
 {
-   tpool_work_t *work;
+   slock_lock(group->lock);
+   if (!--group->outstanding)
+      scond_broadcast(group->cond);
+   slock_unlock(group->lock);
+}
 
-   if (!tp)
-      return NULL;
+/* Queue of the pool worker running on the calling thread,
+ * or the shared queue for threads outside of the pool. */
+static size_t tpool_current_queue(tpool_t *tp)
+{
+   size_t    i;
+   uintptr_t self = sthread_get_current_thread_id();
 
-   work = tp->work_first;
-   if (!work)
-      return NULL;
+   for (i = 0; i < tp->thread_cnt; i++)
+      if (tp->queues[i].owner == self)
+         return i;
+   return tp->thread_cnt;
+}
+
+static void tpool_queue_push(struct tpool_queue *queue, tpool_work_t *work)
+{
+   slock_lock(queue->lock);
+   work->prev = queue->last;
+   if (queue->last)
+      queue->last->next = work;
+   else
+      queue->first      = work;
+   queue->last          = work;
+   slock_unlock(queue->lock);
+}
+
+static tpool_work_t *tpool_queue_pop(struct tpool_queue *queue, bool newest)
+{
+   tpool_work_t *work;
 
-   if (!work->next)
+   slock_lock(queue->lock);
+   if ((work = newest ? queue->last : queue->first))
    {
-      tp->work_first = NULL;
-      tp->work_last  = NULL;
+      if (work->prev)
+         work->prev->next = work->next;
+      else
+         queue->first     = work->next;
+      if (work->next)
+         work->next->prev = work->prev;
+      else
+         queue->last      = work->prev;
    }
-   else
-      tp->work_first = work->next;
+   slock_unlock(queue->lock);
 
    return work;
 }
 
+/* Take a work item after one has been claimed through
+ * pending_cnt. The own queue is served newest first,
+ * which keeps freshly split work in a warm cache, the
+ * others are stolen from oldest first. Every claim is
+ * backed by a queued item, so this only loops when
+ * another thread got to the item we looked at. */
+static tpool_work_t *tpool_work_take(tpool_t *tp, size_t self)
+{
+   for (;;)
+   {
+      size_t i;
+
+      for (i = 0; i < tp->queue_cnt; i++)
+      {
+         size_t        idx  = (self + i) % tp->queue_cnt;
+         tpool_work_t *work = tpool_queue_pop(&tp->queues[idx],
+               idx == self && self < tp->thread_cnt);
+         if (work)
+            return work;
+      }
+   }
+}
+
+static void tpool_work_run(tpool_work_t *work)
+{
+   tpool_group_t *group = work->group;
+
+   work->func(work->arg);
+   tpool_work_destroy(work);
+
+   if (group)
+      tpool_group_done(group);
+}
+
+/* Called with work_mutex held after a work item has run. */
+static void tpool_work_finished(tpool_t *tp)
+{
+   tp->working_cnt--;
+   /* At this point if there isn't any work processing and
+    * if there is no work signal this is the case. */
+   if (!tp->stop && tp->working_cnt == 0 && tp->pending_cnt == 0)
+      scond_broadcast(tp->working_cond);
+}
+
 static void tpool_worker(void *arg)
 {
-   tpool_work_t *work = NULL;
-   tpool_t      *tp   = (tpool_t*)arg;
+   struct tpool_queue *queue = (struct tpool_queue*)arg;
+   tpool_t            *tp    = queue->tp;
+   size_t              self  = queue - tp->queues;
+
+   slock_lock(tp->work_mutex);
 
    for (;;)
    {
-      slock_lock(tp->work_mutex);
+      tpool_work_t *work;
+
+      /* If there is no work in the queues wait in the
+       * conditional until there is work to take. */
+      while (!tp->stop && tp->pending_cnt == 0)
+         scond_wait(tp->work_cond, tp->work_mutex);
+
       /* Keep running until told to stop. */
       if (tp->stop)
          break;
 
-      /* If there is no work in the queue wait in the conditional until
-       * there is work to take. */
-      if (!tp->work_first)
-         scond_wait(tp->work_cond, tp->work_mutex);
-
-      /* Try to pull work from the queue. */
-      work = tpool_work_get(tp);
+      tp->pending_cnt--;
       tp->working_cnt++;
       slock_unlock(tp->work_mutex);
 
-      /* Call the work function and let it process.
-       *
-       * work can legitimately be NULL. Since multiple threads from the pool
-       * will wake when there is work, a thread might not get any work. 1
-       * piece of work and 2 threads, both will wake but with 1 only work 1
-       * will get the work and the other won't.
-       *
-       * working_cnt has been increment and work could be NULL. While it's
-       * not true there is work processing the thread is considered working
-       * because it's not waiting in the conditional. Pedantic but...
-       */
-      if (work)
-      {
-         work->func(work->arg);
-         tpool_work_destroy(work);
-      }
+      work = tpool_work_take(tp, self);
+      tpool_work_run(work);
 
       slock_lock(tp->work_mutex);
-      tp->working_cnt--;
-      /* Since we're in a lock no work can be added or removed form the queue.
-       * Also, the working_cnt can't be changed (except the thread holding the lock).
-       * At this point if there isn't any work processing and if there is no work
-       * signal this is the case. */
-      if (!tp->stop && tp->working_cnt == 0 && !tp->work_first)
-         scond_signal(tp->working_cond);
-      slock_unlock(tp->work_mutex);
+      tpool_work_finished(tp);
    }
 
    tp->thread_cnt--;
    if (tp->thread_cnt == 0)
-      scond_signal(tp->working_cond);
+      scond_broadcast(tp->working_cond);
    slock_unlock(tp->work_mutex);
 }
 
 tpool_t *tpool_create(size_t num)
 {
    tpool_t   *tp;
-   sthread_t *thread;
    size_t     i;
 
    if (num == 0)
       num = 2;
 
-   tp               = (tpool_t*)calloc(1, sizeof(*tp));
-   tp->thread_cnt   = num;
+   if (!(tp = (tpool_t*)calloc(1, sizeof(*tp))))
+      return NULL;
 
+   tp->queue_cnt    = num + 1;
+   tp->queues       = (struct tpool_queue*)calloc(tp->queue_cnt,
+         sizeof(*tp->queues));
    tp->work_mutex   = slock_new();
    tp->work_cond    = scond_new();
    tp->working_cond = scond_new();
 
-   tp->work_first   = NULL;
-   tp->work_last    = NULL;
+   if (!tp->queues || !tp->work_mutex || !tp->work_cond || !tp->working_cond)
+      goto error;
 
-   /* Create the requested number of thread and detach them. */
+   for (i = 0; i < tp->queue_cnt; i++)
+   {
+      tp->queues[i].tp = tp;
+      if (!(tp->queues[i].lock = slock_new()))
+         goto error;
+   }
+
+   /* Create the requested number of thread and detach them.
+    * Work can only reach a worker after this returns, so the
+    * owners and the thread count are settled by then. */
    for (i = 0; i < num; i++)
    {
-      thread = sthread_create(tpool_worker, tp);
+      sthread_t *thread = sthread_create(tpool_worker, &tp->queues[i]);
+      if (!thread)
+         break;
+      tp->queues[i].owner = sthread_get_thread_id(thread);
+      slock_lock(tp->work_mutex);
+      tp->thread_cnt++;
+      slock_unlock(tp->work_mutex);
       sthread_detach(thread);
    }
 
-   return tp;
+   if (tp->thread_cnt)
+      return tp;
+
+error:
+   if (tp->queues)
+   {
+      for (i = 0; i < tp->queue_cnt; i++)
+         if (tp->queues[i].lock)
+            slock_free(tp->queues[i].lock);
+      free(tp->queues);
+   }
+   if (tp->work_mutex)
+      slock_free(tp->work_mutex);
+   if (tp->work_cond)
+      scond_free(tp->work_cond);
+   if (tp->working_cond)
+      scond_free(tp->working_cond);
+   free(tp);
+   return NULL;
 }
 
 void tpool_destroy(tpool_t *tp)
 {
-   tpool_work_t *work;
-   tpool_work_t *work2;
+   size_t i;
 
    if (!tp)
       return;
 
-   /* Take all work out of the queue and destroy it. */
+   /* Take all unclaimed work out of the queues and destroy it,
+    * items already claimed are left for the threads about to
+    * run them. Groups are still released so nobody waits forever. */
    slock_lock(tp->work_mutex);
-   work = tp->work_first;
-   while (work)
+   for (i = 0; i < tp->queue_cnt && tp->pending_cnt; i++)
    {
-      work2 = work->next;
-      tpool_work_destroy(work);
-      work = work2;
+      tpool_work_t *work;
+      while (tp->pending_cnt
+            && (work = tpool_queue_pop(&tp->queues[i], false)))
+      {
+         tpool_group_t *group = work->group;
+         tpool_work_destroy(work);
+         if (group)
+            tpool_group_done(group);
+         tp->pending_cnt--;
+      }
    }
 
    /* Tell the worker threads to stop. */
@@ -210,6 +348,10 @@ void tpool_destroy(tpool_t *tp)
    /* Wait for all threads to stop. */
    tpool_wait(tp);
 
+   for (i = 0; i < tp->queue_cnt; i++)
+      slock_free(tp->queues[i].lock);
+   free(tp->queues);
+
    slock_free(tp->work_mutex);
    scond_free(tp->work_cond);
    scond_free(tp->working_cond);
@@ -217,35 +359,51 @@ void tpool_destroy(tpool_t *tp)
    free(tp);
 }
 
-bool tpool_add_work(tpool_t *tp, thread_func_t func, void *arg)
+static bool tpool_add_work_internal(tpool_t *tp, tpool_group_t *group,
+      thread_func_t func, void *arg)
 {
+   size_t        idx;
    tpool_work_t *work;
 
    if (!tp)
       return false;
 
-   work = tpool_work_create(func, arg);
-   if (!work)
+   if (!(work = tpool_work_create(func, arg)))
       return false;
+   work->group = group;
 
-   slock_lock(tp->work_mutex);
-   if (!tp->work_first)
+   /* Workers keep what they split off in their own queue,
+    * outside work is spread over the workers round robin. */
+   if ((idx = tpool_current_queue(tp)) == tp->thread_cnt)
    {
-      tp->work_first      = work;
-      tp->work_last       = tp->work_first;
+      slock_lock(tp->work_mutex);
+      idx            = tp->next_queue;
+      tp->next_queue = (tp->next_queue + 1) % tp->thread_cnt;
+      slock_unlock(tp->work_mutex);
    }
-   else
+
+   if (group)
    {
-      tp->work_last->next = work;
-      tp->work_last       = work;
+      slock_lock(group->lock);
+      group->outstanding++;
+      slock_unlock(group->lock);
    }
 
-   scond_broadcast(tp->work_cond);
+   tpool_queue_push(&tp->queues[idx], work);
+
+   slock_lock(tp->work_mutex);
+   tp->pending_cnt++;
+   scond_signal(tp->work_cond);
    slock_unlock(tp->work_mutex);
 
    return true;
 }
 
+bool tpool_add_work(tpool_t *tp, thread_func_t func, void *arg)
+{
+   return tpool_add_work_internal(tp, NULL, func, arg);
+}
+
 void tpool_wait(tpool_t *tp)
 {
    if (!tp)
@@ -256,9 +414,12 @@ void tpool_wait(tpool_t *tp)
    for (;;)
    {
       /* working_cond is dual use. It signals when we're not stopping but the
-       * working_cnt is 0 indicating there isn't any work processing. If we
-       * are stopping it will trigger when there aren't any threads running. */
-      if ((!tp->stop && tp->working_cnt != 0) || (tp->stop && tp->thread_cnt != 0))
+       * working_cnt is 0 and the queues are empty indicating there isn't any
+       * work processing. Work that no thread has picked up yet counts too.
+       * If we are stopping it will trigger when there aren't any threads
+       * running. */
+      if (     (!tp->stop && (tp->working_cnt != 0 || tp->pending_cnt != 0))
+            || (tp->stop && tp->thread_cnt != 0))
          scond_wait(tp->working_cond, tp->work_mutex);
       else
          break;
@@ -266,3 +427,173 @@ void tpool_wait(tpool_t *tp)
 
    slock_unlock(tp->work_mutex);
 }
+
+size_t tpool_get_thread_count(tpool_t *tp)
+{
+   return tp ? tp->thread_cnt : 0;
+}
+
+tpool_group_t *tpool_group_new(void)
+{
+   tpool_group_t *group = (tpool_group_t*)calloc(1, sizeof(*group));
+
+   if (!group)
+      return NULL;
+
+   group->lock = slock_new();
+   group->cond = scond_new();
+
+   if (!group->lock || !group->cond)
+   {
+      tpool_group_free(group);
+      return NULL;
+   }
+
+   return group;
+}
+
+void tpool_group_free(tpool_group_t *group)
+{
+   if (!group)
+      return;
+
+   if (group->lock)
+      slock_free(group->lock);
+   if (group->cond)
+      scond_free(group->cond);
+   free(group);
+}
+
+bool tpool_group_add_work(tpool_t *tp, tpool_group_t *group,
+      thread_func_t func, void *arg)
+{
+   if (!group)
+      return false;
+   return tpool_add_work_internal(tp, group, func, arg);
+}
+
+void tpool_group_wait(tpool_t *tp, tpool_group_t *group)
+{
+   size_t self;
+
+   if (!group)
+      return;
+
+   self = tp ? tpool_current_queue(tp) : 0;
+
+   for (;;)
+   {
+      bool claimed = false;
+
+      slock_lock(group->lock);
+      if (!group->outstanding)
+      {
+         slock_unlock(group->lock);
+         break;
+      }
+      slock_unlock(group->lock);
+
+      /* Help out instead of blocking, running any queued work
+       * rather than only our own. This keeps workers waiting
+       * on nested groups from starving the pool. */
+      if (tp)
+      {
+         slock_lock(tp->work_mutex);
+         if (tp->pending_cnt && !tp->stop)
+         {
+            tp->pending_cnt--;
+            tp->working_cnt++;
+            claimed = true;
+         }
+         slock_unlock(tp->work_mutex);
+      }
+
+      if (claimed)
+      {
+         tpool_work_run(tpool_work_take(tp, self));
+
+         slock_lock(tp->work_mutex);
+         tpool_work_finished(tp);
+         slock_unlock(tp->work_mutex);
+         continue;
+      }
+
+      /* Everything left is already running elsewhere */
+      slock_lock(group->lock);
+      while (group->outstanding)
+         scond_wait(group->cond, group->lock);
+      slock_unlock(group->lock);
+   }
+}
+
+static void tpool_range_work(void *data)
+{
+   struct tpool_range *range = (struct tpool_range*)data;
+   range->func(range->arg, range->begin, range->end);
+}
+
+void tpool_parallel_for(tpool_t *tp, size_t count, size_t grain,
+      tpool_range_func_t func, void *arg)
+{
+   size_t              i;
+   size_t              num_ranges;
+   tpool_group_t      *group  = NULL;
+   struct tpool_range *ranges = NULL;
+
+   if (!func || !count)
+      return;
+
+   /* Default to a few ranges per thread so
+    * uneven ranges balance out through stealing */
+   if (!grain)
+      grain = MAX(count / ((tpool_get_thread_count(tp) + 1) * 4), 1);
+   num_ranges = (count + grain - 1) / grain;
+
+   if (     !tp
+         || num_ranges < 2
+         || !(ranges = (struct tpool_range*)malloc(
+               num_ranges * sizeof(*ranges)))
+         || !(group  = tpool_group_new()))
+   {
+      free(ranges);
+      func(arg, 0, count);
+      return;
+   }
+
+   for (i = 0; i < num_ranges; i++)
+   {
+      ranges[i].func  = func;
+      ranges[i].arg   = arg;
+      ranges[i].begin = i * grain;
+      ranges[i].end   = MIN((i + 1) * grain, count);
+   }
+
+   /* The calling thread takes the first range itself and
+    * then helps with whatever the workers have not started */
+   for (i = 1; i < num_ranges; i++)
+      if (!tpool_group_add_work(tp, group, tpool_range_work, &ranges[i]))
+         tpool_range_work(&ranges[i]);
+   tpool_range_work(&ranges[0]);
+
+   tpool_group_wait(tp, group);
+   tpool_group_free(group);
+   free(ranges);
+}
+
+void tpool_shared_init(size_t num)
+{
+   if (!tpool_shared_pool)
+      tpool_shared_pool = tpool_create(num);
+}
+
+void tpool_shared_deinit(void)
+{
+   if (tpool_shared_pool)
+      tpool_destroy(tpool_shared_pool);
+   tpool_shared_pool = NULL;
+}
+
+tpool_t *tpool_shared(void)
+{
+   return tpool_shared_pool;
+}
@@ -31,15 +31,70 @@
 #include <libchdr/chd.h>
 #include <string/stdstring.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
+#endif
+
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Decompressed hunks kept per stream */
+#ifndef CHDSTREAM_CACHE_HUNKS
+#define CHDSTREAM_CACHE_HUNKS 16
+#endif
+
+/* Hunks decompressed ahead of sequential reads on a
+ * worker thread. Has to leave room in the cache for the
+ * hunk being read. */
+#ifndef CHDSTREAM_PREFETCH_HUNKS
+#define CHDSTREAM_PREFETCH_HUNKS 4
+#endif
+
+#if CHDSTREAM_PREFETCH_HUNKS + 2 > CHDSTREAM_CACHE_HUNKS
+#error "CHDSTREAM_CACHE_HUNKS is too small for CHDSTREAM_PREFETCH_HUNKS"
+#endif
+
+enum chdstream_hunk_state
+{
+   CHDSTREAM_HUNK_EMPTY = 0,
+   CHDSTREAM_HUNK_LOADING,
+   CHDSTREAM_HUNK_READY
+};
+
+typedef struct chdstream_hunk
+{
+   uint8_t *data;
+   uint32_t hunknum;
+   unsigned last_used;
+   enum chdstream_hunk_state state;
+} chdstream_hunk_t;
+
 struct chdstream
 {
    chd_file *chd;
    /* Loaded hunk */
    uint8_t *hunkmem;
+   /* Cached hunks, hunkmem points into one of them */
+   chdstream_hunk_t hunks[CHDSTREAM_CACHE_HUNKS];
+#ifdef HAVE_THREADS
+   sthread_t *prefetch_thread;
+   /* Guards the cache and the prefetch range */
+   slock_t *lock;
+   /* libchdr is not thread safe, serializes calls into it */
+   slock_t *chd_lock;
+   /* Signalled when a hunk finished loading */
+   scond_t *hunk_cond;
+   /* Signalled when there are hunks to prefetch */
+   scond_t *prefetch_cond;
+   /* Hunks [prefetch_next, prefetch_end) are to be prefetched */
+   uint32_t prefetch_next;
+   uint32_t prefetch_end;
+   /* Only worth it with a core to spare */
+   bool prefetch_enable;
+   bool prefetch_quit;
+#endif
    /* Byte offset where track data starts (after pregap) */
    size_t track_start;
    /* Byte offset where track data ends */
@@ -54,6 +109,10 @@ struct chdstream
    uint32_t frame_offset;
    /* Number of frames per hunk */
    uint32_t frames_per_hunk;
+   /* Number of hunks in chd */
+   uint32_t total_hunks;
+   /* Clock for evicting the least recently used hunk */
+   unsigned hunk_clock;
    /* First frame of track in chd */
    uint32_t track_frame;
    /* Should we swap bytes? */
@@ -208,7 +267,6 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
 {
    metadata_t meta;
    uint32_t pregap         = 0;
-   uint8_t *hunkmem        = NULL;
    const chd_header *hd    = NULL;
    chdstream_t *stream     = NULL;
    chd_file *chd           = NULL;
@@ -220,7 +278,7 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    if (!chdstream_find_track(chd, track, &meta))
       goto error;
 
-   stream                  = (chdstream_t*)malloc(sizeof(*stream));
+   stream                  = (chdstream_t*)calloc(1, sizeof(*stream));
    if (!stream)
       goto error;
 
@@ -235,13 +293,18 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    stream->offset          = 0;
    stream->hunkmem         = NULL;
    stream->hunknum         = -1;
+   stream->hunk_clock      = 0;
 
-   hd                      = chd_get_header(chd);
-   hunkmem                 = (uint8_t*)malloc(hd->hunkbytes);
-   if (!hunkmem)
+#ifdef HAVE_THREADS
+   if (     !(stream->lock          = slock_new())
+         || !(stream->chd_lock      = slock_new())
+         || !(stream->hunk_cond     = scond_new())
+         || !(stream->prefetch_cond = scond_new()))
       goto error;
+   stream->prefetch_enable = cpu_features_get_core_amount() > 1;
+#endif
 
-   stream->hunkmem         = hunkmem;
+   hd                      = chd_get_header(chd);
 
    if (string_is_equal(meta.type, "MODE1_RAW"))
       stream->frame_size   = SECTOR_SIZE;
@@ -261,6 +324,7 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
 
    stream->chd             = chd;
    stream->frames_per_hunk = hd->hunkbytes / hd->unitbytes;
+   stream->total_hunks     = hd->totalhunks;
    stream->track_frame     = meta.frame_offset;
    stream->track_start     = (size_t)pregap * stream->frame_size;
    stream->track_end       = stream->track_start + 
@@ -280,40 +344,233 @@ error:
 
 void chdstream_close(chdstream_t *stream)
 {
+   unsigned i;
+
    if (!stream)
       return;
 
-   if (stream->hunkmem)
-      free(stream->hunkmem);
+#ifdef HAVE_THREADS
+   if (stream->prefetch_thread)
+   {
+      slock_lock(stream->lock);
+      stream->prefetch_quit = true;
+      scond_signal(stream->prefetch_cond);
+      slock_unlock(stream->lock);
+      sthread_join(stream->prefetch_thread);
+   }
+   if (stream->prefetch_cond)
+      scond_free(stream->prefetch_cond);
+   if (stream->hunk_cond)
+      scond_free(stream->hunk_cond);
+   if (stream->chd_lock)
+      slock_free(stream->chd_lock);
+   if (stream->lock)
+      slock_free(stream->lock);
+#endif
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+      if (stream->hunks[i].data)
+         free(stream->hunks[i].data);
    if (stream->chd)
       chd_close(stream->chd);
    free(stream);
 }
 
-static bool
-chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+/* The following expect stream->lock to be held */
+
+static chdstream_hunk_t *chdstream_find_hunk(
+      chdstream_t *stream, uint32_t hunknum)
 {
-   uint16_t *array;
+   unsigned i;
 
-   if (hunknum == stream->hunknum)
-      return true;
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+      if (     stream->hunks[i].state   != CHDSTREAM_HUNK_EMPTY
+            && stream->hunks[i].hunknum == hunknum)
+         return &stream->hunks[i];
 
-   if (chd_read(stream->chd, hunknum, stream->hunkmem) != CHDERR_NONE)
+   return NULL;
+}
+
+/* Returns an empty slot or the least recently used one,
+ * but never the hunk being read or one being loaded */
+static chdstream_hunk_t *chdstream_evict_hunk(chdstream_t *stream)
+{
+   unsigned i;
+   chdstream_hunk_t *slot = NULL;
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+      chdstream_hunk_t *hunk = &stream->hunks[i];
+
+      if (hunk->state == CHDSTREAM_HUNK_EMPTY)
+         return hunk;
+
+      if (     hunk->state == CHDSTREAM_HUNK_LOADING
+            || (int32_t)hunk->hunknum == stream->hunknum)
+         continue;
+
+      if (!slot || hunk->last_used < slot->last_used)
+         slot = hunk;
+   }
+
+   return slot;
+}
+
+/* Called without stream->lock held, on a slot marked as loading */
+static bool chdstream_decode_hunk(chdstream_t *stream,
+      chdstream_hunk_t *hunk)
+{
+   chd_error err;
+   uint32_t hunkbytes = chd_get_header(stream->chd)->hunkbytes;
+
+   if (!hunk->data && !(hunk->data = (uint8_t*)malloc(hunkbytes)))
+      return false;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
+   err = chd_read(stream->chd, hunk->hunknum, hunk->data);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
+
+   if (err != CHDERR_NONE)
       return false;
 
    if (stream->swab)
    {
       uint32_t i;
-      uint32_t count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array          = (uint16_t*)stream->hunkmem;
+      uint32_t count  = hunkbytes / 2;
+      uint16_t *array = (uint16_t*)hunk->data;
       for (i = 0; i < count; ++i)
          array[i] = SWAP16(array[i]);
    }
 
-   stream->hunknum = hunknum;
    return true;
 }
 
+#ifdef HAVE_THREADS
+static void chdstream_prefetch_thread(void *data)
+{
+   chdstream_t *stream = (chdstream_t*)data;
+
+   slock_lock(stream->lock);
+
+   while (!stream->prefetch_quit)
+   {
+      bool ret;
+      chdstream_hunk_t *hunk = NULL;
+      uint32_t hunknum       = stream->prefetch_next;
+
+      if (hunknum >= stream->prefetch_end)
+      {
+         scond_wait(stream->prefetch_cond, stream->lock);
+         continue;
+      }
+
+      stream->prefetch_next++;
+
+      if (     chdstream_find_hunk(stream, hunknum)
+            || !(hunk = chdstream_evict_hunk(stream)))
+         continue;
+
+      hunk->state     = CHDSTREAM_HUNK_LOADING;
+      hunk->hunknum   = hunknum;
+      hunk->last_used = ++stream->hunk_clock;
+      slock_unlock(stream->lock);
+
+      ret             = chdstream_decode_hunk(stream, hunk);
+
+      slock_lock(stream->lock);
+      hunk->state     = ret ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+      scond_broadcast(stream->hunk_cond);
+   }
+
+   slock_unlock(stream->lock);
+}
+
+/* Reading moved on to the next hunk, keep the ones
+ * after it decompressing in the background */
+static void chdstream_prefetch(chdstream_t *stream, uint32_t hunknum)
+{
+   uint32_t end = hunknum + 1 + CHDSTREAM_PREFETCH_HUNKS;
+
+   if (end > stream->total_hunks)
+      end = stream->total_hunks;
+   if (stream->prefetch_next <= hunknum)
+      stream->prefetch_next = hunknum + 1;
+   stream->prefetch_end     = end;
+
+   if (!stream->prefetch_thread)
+      stream->prefetch_thread = sthread_create(
+            chdstream_prefetch_thread, stream);
+
+   scond_signal(stream->prefetch_cond);
+}
+#endif
+
+static bool
+chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   chdstream_hunk_t *hunk = NULL;
+   bool ret               = true;
+
+   if ((int32_t)hunknum == stream->hunknum)
+      return true;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+
+   /* Wait for the prefetcher if it is loading this hunk */
+   while (     (hunk = chdstream_find_hunk(stream, hunknum))
+            && hunk->state == CHDSTREAM_HUNK_LOADING)
+      scond_wait(stream->hunk_cond, stream->lock);
+#else
+   hunk = chdstream_find_hunk(stream, hunknum);
+#endif
+
+   if (!hunk)
+   {
+      if (!(hunk = chdstream_evict_hunk(stream)))
+         ret = false;
+      else
+      {
+         hunk->state   = CHDSTREAM_HUNK_LOADING;
+         hunk->hunknum = hunknum;
+#ifdef HAVE_THREADS
+         slock_unlock(stream->lock);
+#endif
+         ret           = chdstream_decode_hunk(stream, hunk);
+#ifdef HAVE_THREADS
+         slock_lock(stream->lock);
+#endif
+         hunk->state   = ret ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+#ifdef HAVE_THREADS
+         scond_broadcast(stream->hunk_cond);
+#endif
+      }
+   }
+
+   if (ret)
+   {
+#ifdef HAVE_THREADS
+      if (     stream->prefetch_enable
+            && stream->hunknum >= 0
+            && hunknum == (uint32_t)stream->hunknum + 1)
+         chdstream_prefetch(stream, hunknum);
+#endif
+      hunk->last_used = ++stream->hunk_clock;
+      stream->hunknum = hunknum;
+      stream->hunkmem = hunk->data;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
+
+   return ret;
+}
+
 ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
 {
    size_t end;
@@ -435,15 +692,26 @@ uint32_t chdstream_get_track_start(chdstream_t *stream)
    metadata_t meta;
    uint32_t frame_offset = 0;
 
+   uint32_t track_start  = 0;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
    for (i = 0; chdstream_get_meta(stream->chd, i, &meta); ++i)
    {
       if (stream->track_frame == frame_offset)
-         return meta.pregap * stream->frame_size;
+      {
+         track_start = meta.pregap * stream->frame_size;
+         break;
+      }
 
       frame_offset += meta.frames + meta.extra;
    }
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
 
-   return 0;
+   return track_start;
 }
 
 uint32_t chdstream_get_frame_size(chdstream_t *stream)
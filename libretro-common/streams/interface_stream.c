@@ -33,6 +33,9 @@
 #endif
 #include <encodings/crc32.h>
 
+/* Read size when hashing streams */
+#define INTFSTREAM_CRC_CHUNK_SIZE (64 * 1024)
+
 struct intfstream_internal
 {
    struct
@@ -302,8 +305,7 @@ int64_t intfstream_seek(
          break;
 #endif
       case INTFSTREAM_RZIP:
-         /* Unsupported */
-         break;
+         return rzipstream_seek(intf->rzip.fp, offset, whence);
    }
 
    return -1;
@@ -628,30 +630,64 @@ bool intfstream_is_compressed(intfstream_internal_t *intf)
    return false;
 }
 
-bool intfstream_get_crc(intfstream_internal_t *intf, uint32_t *crc)
+bool intfstream_get_crc_range(intfstream_internal_t *intf,
+      int64_t offset, int64_t size, uint32_t *crc)
 {
    int64_t data_read    = 0;
    uint32_t accumulator = 0;
-   uint8_t buffer[4096];
+   uint8_t *buffer      = NULL;
 
    if (!intf || !crc)
       return false;
 
-   /* Ensure we start at the beginning of the file */
-   intfstream_rewind(intf);
+   if (intfstream_seek(intf, offset, SEEK_SET) == -1)
+      return false;
+
+   if (!(buffer = (uint8_t*)malloc(INTFSTREAM_CRC_CHUNK_SIZE)))
+      return false;
+
+   while (size != 0)
+   {
+      int64_t chunk = INTFSTREAM_CRC_CHUNK_SIZE;
+
+      if (size > 0 && size < chunk)
+         chunk = size;
+
+      if ((data_read = intfstream_read(intf, buffer, chunk)) <= 0)
+         break;
 
-   while ((data_read = intfstream_read(intf, buffer, sizeof(buffer))) > 0)
       accumulator = encoding_crc32(accumulator, buffer, (size_t)data_read);
 
-   if (data_read < 0)
+      if (size > 0)
+         size -= data_read;
+   }
+
+   free(buffer);
+
+   /* Either a read error or the range runs past the end */
+   if (data_read < 0 || size > 0)
       return false;
 
    *crc = accumulator;
+   return true;
+}
+
+bool intfstream_get_crc(intfstream_internal_t *intf, uint32_t *crc)
+{
+   bool ret;
+
+   if (!intf || !crc)
+      return false;
+
+   /* Ensure we start at the beginning of the file */
+   intfstream_rewind(intf);
+
+   ret = intfstream_get_crc_range(intf, 0, -1, crc);
 
    /* Reset file to the beginning */
    intfstream_rewind(intf);
 
-   return true;
+   return ret;
 }
 
 intfstream_t* intfstream_open_file(const char *path,
@@ -22,14 +22,25 @@
 
 #include <string/stdstring.h>
 #include <file/file_path.h>
+#include <retro_miscellaneous.h>
 
 #include <streams/file_stream.h>
 #include <streams/trans_stream.h>
 
 #include <streams/rzip_stream.h>
 
-/* Current RZIP file format version */
+#ifdef HAVE_THREADS
+#include <features/features_cpu.h>
+#include <rthreads/tpool.h>
+#endif
+
+/* Current RZIP file format version
+ * > Version 2 is only written when a codec
+ *   other than deflate is selected, so files
+ *   using the default codec remain readable
+ *   by version 1 readers */
 #define RZIP_VERSION 1
+#define RZIP_VERSION_CODEC 2
 
 /* Compression level
  * > zlib default of 6 provides the best
@@ -42,7 +53,32 @@
 
 /* Header sizes (in bytes) */
 #define RZIP_HEADER_SIZE 20
+#define RZIP_HEADER_SIZE_CODEC 24
 #define RZIP_CHUNK_HEADER_SIZE 4
+#define RZIP_INDEX_FOOTER_SIZE 12
+
+/* Maximum number of chunks (de)compressed
+ * in parallel, and the maximum amount of
+ * uncompressed data buffered for them */
+#define RZIP_MAX_THREADS 8
+#define RZIP_MAX_BATCH_SIZE (8 * 1024 * 1024)
+
+/* A single chunk of the batch currently
+ * being (de)compressed */
+struct rzip_chunk
+{
+   void *trans_stream;
+   /* buf: compressed data
+    * data: uncompressed data, points into
+    * the input (writing) or output (reading)
+    * buffer of the stream */
+   uint8_t *buf;
+   uint8_t *data;
+   uint32_t buf_size;
+   uint32_t buf_len;
+   uint32_t data_len;
+   bool ok;
+};
 
 /* Holds all metadata for an RZIP file stream */
 struct rzipstream
@@ -51,19 +87,37 @@ struct rzipstream
    /* virtual_ptr: Used to track how much
     * uncompressed data has been read */
    uint64_t virtual_ptr;
+   /* File offset of each chunk header.
+    * When reading, only the first 'chunks_known'
+    * entries are valid */
+   uint64_t *chunk_offsets;
    RFILE* file;
    const struct trans_stream_backend *deflate_backend;
-   void *deflate_stream;
    const struct trans_stream_backend *inflate_backend;
-   void *inflate_stream;
+#ifdef HAVE_THREADS
+   tpool_t *pool;
+#endif
+   struct rzip_chunk *chunks;
    uint8_t *in_buf;
    uint8_t *out_buf;
+   size_t num_chunks;
+   size_t chunks_known;
+   size_t chunk_offsets_size;
+   /* chunk_next: index of the next chunk to
+    * read from disk
+    * batch_first: index of the first chunk held
+    * in the output buffer */
+   size_t chunk_next;
+   size_t batch_first;
    uint32_t in_buf_size;
    uint32_t in_buf_ptr;
    uint32_t out_buf_size;
    uint32_t out_buf_ptr;
    uint32_t out_buf_occupancy;
    uint32_t chunk_size;
+   uint32_t header_size;
+   unsigned batch_size;
+   unsigned codec;
    bool is_compressed;
    bool is_writing;
 };
@@ -79,12 +133,12 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
 {
    unsigned i;
    int64_t length;
-   uint8_t header_bytes[RZIP_HEADER_SIZE];
+   uint8_t header_bytes[RZIP_HEADER_SIZE_CODEC];
 
    if (!stream)
       return false;
 
-   for (i = 0; i < RZIP_HEADER_SIZE; i++)
+   for (i = 0; i < RZIP_HEADER_SIZE_CODEC; i++)
       header_bytes[i] = 0;
 
    /* Attempt to read header bytes */
@@ -105,10 +159,31 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
        (header_bytes[3] !=           73) || /* I */
        (header_bytes[4] !=           80) || /* P */
        (header_bytes[5] !=          118) || /* v */
-       (header_bytes[6] != RZIP_VERSION) || /* file format version number */
        (header_bytes[7] !=           35))   /* # */
       goto file_uncompressed;
 
+   /* Check file format version number */
+   switch (header_bytes[6])
+   {
+      case RZIP_VERSION:
+         stream->header_size = RZIP_HEADER_SIZE;
+         stream->codec       = RZIP_CODEC_DEFLATE;
+         break;
+      case RZIP_VERSION_CODEC:
+         /* Codec - next byte, followed by
+          * 3 reserved bytes */
+         if (length < RZIP_HEADER_SIZE_CODEC)
+            return false;
+         stream->header_size = RZIP_HEADER_SIZE_CODEC;
+         stream->codec       = header_bytes[20];
+         if ((stream->codec != RZIP_CODEC_DEFLATE) &&
+             (stream->codec != RZIP_CODEC_STORE))
+            return false;
+         break;
+      default:
+         goto file_uncompressed;
+   }
+
    /* Get uncompressed chunk size - next 4 bytes */
    stream->chunk_size = ((uint32_t)header_bytes[11] << 24) |
                         ((uint32_t)header_bytes[10] << 16) |
@@ -129,6 +204,9 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
    if (stream->size == 0)
       return false;
 
+   /* Move to first chunk */
+   filestream_seek(stream->file, stream->header_size, SEEK_SET);
+
    stream->is_compressed = true;
    return true;
 
@@ -151,13 +229,13 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
 {
    unsigned i;
    int64_t length;
-   uint8_t header_bytes[RZIP_HEADER_SIZE];
+   uint8_t header_bytes[RZIP_HEADER_SIZE_CODEC];
 
    if (!stream)
       return false;
 
    /* Populate header array */
-   for (i = 0; i < RZIP_HEADER_SIZE; i++)
+   for (i = 0; i < RZIP_HEADER_SIZE_CODEC; i++)
       header_bytes[i] = 0;
 
    /* > 'Magic numbers' - first 8 bytes */
@@ -167,7 +245,8 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
    header_bytes[3]    =        73;    /* I */
    header_bytes[4]    =        80;    /* P */
    header_bytes[5]    =       118;    /* v */
-   header_bytes[6]    = RZIP_VERSION; /* file format version number */
+   header_bytes[6]    = (stream->header_size == RZIP_HEADER_SIZE_CODEC) ?
+         RZIP_VERSION_CODEC : RZIP_VERSION; /* file format version number */
    header_bytes[7]    =        35;    /* # */
 
    /* > Uncompressed chunk size - next 4 bytes */
@@ -186,18 +265,316 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
    header_bytes[13]   = (stream->size >>  8) & 0xFF;
    header_bytes[12]   =  stream->size        & 0xFF;
 
+   /* > Codec - next byte (version 2 only) */
+   header_bytes[20]   = stream->codec & 0xFF;
+
    /* Reset file to start */
    filestream_seek(stream->file, 0, SEEK_SET);
 
    /* Write header bytes */
    length = filestream_write(stream->file,
-         header_bytes, sizeof(header_bytes));
-   if (length != RZIP_HEADER_SIZE)
+         header_bytes, stream->header_size);
+   if (length != stream->header_size)
       return false;
 
    return true;
 }
 
+/* Chunk Index Functions */
+
+/* Reads the chunk offset table written after
+ * the last chunk, if the file has one
+ * > Files without a (valid) table only know
+ *   the offset of their first chunk, the rest
+ *   are found while reading or seeking */
+static void rzipstream_read_index(rzipstream_t *stream)
+{
+   size_t i;
+   int64_t file_size;
+   int64_t table_pos;
+   uint32_t count;
+   uint8_t footer_bytes[RZIP_INDEX_FOOTER_SIZE];
+   uint8_t *table = NULL;
+
+   stream->chunk_offsets[0] = stream->header_size;
+   stream->chunks_known     = 1;
+
+   if (stream->num_chunks < 2)
+      return;
+
+   file_size = filestream_get_size(stream->file);
+   table_pos = file_size - RZIP_INDEX_FOOTER_SIZE -
+         (int64_t)(stream->num_chunks * 8);
+   if (table_pos < (int64_t)stream->header_size)
+      return;
+
+   /* Footer: number of chunks (4 bytes, little
+    * endian order) and 'magic numbers' */
+   if ((filestream_seek(stream->file,
+         file_size - RZIP_INDEX_FOOTER_SIZE, SEEK_SET) < 0) ||
+       (filestream_read(stream->file, footer_bytes,
+         sizeof(footer_bytes)) != RZIP_INDEX_FOOTER_SIZE))
+      goto end;
+
+   count = ((uint32_t)footer_bytes[3] << 24) |
+           ((uint32_t)footer_bytes[2] << 16) |
+           ((uint32_t)footer_bytes[1] <<  8) |
+            (uint32_t)footer_bytes[0];
+
+   if ((count != stream->num_chunks) ||
+       memcmp(footer_bytes + 4, "#RZIPIX#", 8))
+      goto end;
+
+   /* Table: file offset of each chunk
+    * (8 bytes, little endian order) */
+   if (!(table = (uint8_t*)malloc(stream->num_chunks * 8)))
+      goto end;
+
+   if ((filestream_seek(stream->file, table_pos, SEEK_SET) < 0) ||
+       (filestream_read(stream->file, table,
+         stream->num_chunks * 8) != (int64_t)(stream->num_chunks * 8)))
+      goto end;
+
+   for (i = 0; i < stream->num_chunks; i++)
+   {
+      const uint8_t *entry = table + i * 8;
+      uint64_t offset      = ((uint64_t)entry[7] << 56) |
+                             ((uint64_t)entry[6] << 48) |
+                             ((uint64_t)entry[5] << 40) |
+                             ((uint64_t)entry[4] << 32) |
+                             ((uint64_t)entry[3] << 24) |
+                             ((uint64_t)entry[2] << 16) |
+                             ((uint64_t)entry[1] <<  8) |
+                              (uint64_t)entry[0];
+
+      /* Offsets must be increasing, and leave
+       * room for at least a chunk header and
+       * one byte of data */
+      if (i == 0)
+      {
+         if (offset != stream->header_size)
+            goto end;
+      }
+      else if (offset < stream->chunk_offsets[i - 1] +
+            RZIP_CHUNK_HEADER_SIZE + 1)
+         goto end;
+
+      if (offset + RZIP_CHUNK_HEADER_SIZE + 1 > (uint64_t)table_pos)
+         goto end;
+
+      stream->chunk_offsets[i] = offset;
+   }
+
+   stream->chunks_known = stream->num_chunks;
+
+end:
+   free(table);
+   filestream_seek(stream->file, stream->header_size, SEEK_SET);
+}
+
+/* Writes the chunk offset table and footer
+ * after the last chunk
+ * > Readers that do not know about the table
+ *   stop at the last chunk and never see it */
+static bool rzipstream_write_index(rzipstream_t *stream)
+{
+   size_t i;
+   uint8_t footer_bytes[RZIP_INDEX_FOOTER_SIZE];
+   uint8_t *table = NULL;
+   bool ret       = false;
+
+   if (stream->num_chunks < 2)
+      return true;
+
+   if (!(table = (uint8_t*)malloc(stream->num_chunks * 8)))
+      return false;
+
+   for (i = 0; i < stream->num_chunks; i++)
+   {
+      uint8_t *entry  = table + i * 8;
+      uint64_t offset = stream->chunk_offsets[i];
+
+      entry[7]        = (offset >> 56) & 0xFF;
+      entry[6]        = (offset >> 48) & 0xFF;
+      entry[5]        = (offset >> 40) & 0xFF;
+      entry[4]        = (offset >> 32) & 0xFF;
+      entry[3]        = (offset >> 24) & 0xFF;
+      entry[2]        = (offset >> 16) & 0xFF;
+      entry[1]        = (offset >>  8) & 0xFF;
+      entry[0]        =  offset        & 0xFF;
+   }
+
+   footer_bytes[3] = (stream->num_chunks >> 24) & 0xFF;
+   footer_bytes[2] = (stream->num_chunks >> 16) & 0xFF;
+   footer_bytes[1] = (stream->num_chunks >>  8) & 0xFF;
+   footer_bytes[0] =  stream->num_chunks        & 0xFF;
+   memcpy(footer_bytes + 4, "#RZIPIX#", 8);
+
+   if ((filestream_write(stream->file, table, stream->num_chunks * 8) ==
+         (int64_t)(stream->num_chunks * 8)) &&
+       (filestream_write(stream->file, footer_bytes,
+         sizeof(footer_bytes)) == RZIP_INDEX_FOOTER_SIZE))
+      ret = true;
+
+   free(table);
+   return ret;
+}
+
+/* Parallel Chunk Processing */
+
+typedef void (*rzip_chunk_func_t)(void *arg, size_t begin, size_t end);
+
+/* Returns the number of chunks to process at
+ * once: one per thread of the shared pool
+ * (plus the calling thread), or one per core */
+static unsigned rzipstream_get_batch_size(uint32_t chunk_size)
+{
+   unsigned threads = 1;
+#ifdef HAVE_THREADS
+   tpool_t *pool    = tpool_shared();
+
+   threads = pool
+         ? (unsigned)tpool_get_thread_count(pool) + 1
+         : cpu_features_get_core_amount();
+#endif
+
+   threads = MIN(MAX(threads, 1), RZIP_MAX_THREADS);
+
+   if (chunk_size > RZIP_MAX_BATCH_SIZE / threads)
+      threads = MAX(RZIP_MAX_BATCH_SIZE / chunk_size, 1);
+
+   return threads;
+}
+
+static void rzipstream_deflate_chunks(void *arg, size_t begin, size_t end)
+{
+   size_t i;
+   rzipstream_t *stream = (rzipstream_t*)arg;
+
+   for (i = begin; i < end; i++)
+   {
+      struct rzip_chunk *chunk = &stream->chunks[i];
+      uint32_t deflate_read    = 0;
+      uint32_t deflate_written = 0;
+
+      chunk->ok = false;
+
+      /* Stored chunks are written straight
+       * from the input buffer */
+      if (stream->codec == RZIP_CODEC_STORE)
+      {
+         chunk->buf_len = chunk->data_len;
+         chunk->ok      = true;
+         continue;
+      }
+
+      stream->deflate_backend->set_in(
+            chunk->trans_stream,
+            chunk->data, chunk->data_len);
+
+      stream->deflate_backend->set_out(
+            chunk->trans_stream,
+            chunk->buf, chunk->buf_size);
+
+      /* Note: We have to set 'flush == true' here, otherwise we
+       * can't guarantee that the entire chunk will be written
+       * to the output buffer - this is inefficient, but not
+       * much we can do... */
+      if (!stream->deflate_backend->trans(
+            chunk->trans_stream, true,
+            &deflate_read, &deflate_written, NULL))
+         continue;
+
+      /* Error checking */
+      if (deflate_read != chunk->data_len)
+         continue;
+
+      if ((deflate_written == 0) ||
+          (deflate_written > chunk->buf_size))
+         continue;
+
+      chunk->buf_len = deflate_written;
+      chunk->ok      = true;
+   }
+}
+
+static void rzipstream_inflate_chunks(void *arg, size_t begin, size_t end)
+{
+   size_t i;
+   rzipstream_t *stream = (rzipstream_t*)arg;
+
+   for (i = begin; i < end; i++)
+   {
+      struct rzip_chunk *chunk = &stream->chunks[i];
+      uint32_t inflate_read    = 0;
+      uint32_t inflate_written = 0;
+
+      chunk->ok = false;
+
+      if (stream->codec == RZIP_CODEC_STORE)
+      {
+         if (chunk->buf_len == chunk->data_len)
+         {
+            memcpy(chunk->data, chunk->buf, chunk->data_len);
+            chunk->ok = true;
+         }
+         continue;
+      }
+
+      stream->inflate_backend->set_in(
+            chunk->trans_stream,
+            chunk->buf, chunk->buf_len);
+
+      stream->inflate_backend->set_out(
+            chunk->trans_stream,
+            chunk->data, chunk->data_len);
+
+      /* Every chunk but the last one holds exactly
+       * 'chunk_size' bytes, so inflating straight
+       * into the output buffer cannot overlap
+       * the next chunk */
+      if (     stream->inflate_backend->trans(
+                  chunk->trans_stream, true,
+                  &inflate_read, &inflate_written, NULL)
+            && (inflate_read    == chunk->buf_len)
+            && (inflate_written == chunk->data_len))
+      {
+         chunk->ok = true;
+         continue;
+      }
+
+      /* A failed transform leaves the stream
+       * mid-way through a chunk - start over
+       * with a fresh one */
+      stream->inflate_backend->stream_free(chunk->trans_stream);
+      chunk->trans_stream = stream->inflate_backend->stream_new();
+   }
+}
+
+/* Runs 'func' over the first 'count' chunks
+ * of the batch, in parallel if possible */
+static void rzipstream_process_chunks(rzipstream_t *stream,
+      size_t count, rzip_chunk_func_t func)
+{
+#ifdef HAVE_THREADS
+   tpool_t *pool = NULL;
+
+   if (count > 1)
+   {
+      if (!(pool = tpool_shared()))
+      {
+         if (!stream->pool)
+            stream->pool = tpool_create(stream->batch_size - 1);
+         pool = stream->pool;
+      }
+   }
+
+   tpool_parallel_for(pool, count, 1, func, stream);
+#else
+   func(stream, 0, count);
+#endif
+}
+
 /* Stream Initialisation/De-initialisation */
 
 /* Initialises all members of an rzipstream_t struct,
@@ -205,6 +582,7 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
 static bool rzipstream_init_stream(
       rzipstream_t *stream, const char *path, bool is_writing)
 {
+   unsigned i;
    unsigned file_mode;
 
    if (!stream)
@@ -213,11 +591,13 @@ static bool rzipstream_init_stream(
    /* Ensure stream has valid initial values */
    stream->size              = 0;
    stream->chunk_size        = RZIP_DEFAULT_CHUNK_SIZE;
+   stream->header_size       = RZIP_HEADER_SIZE;
+   stream->codec             = RZIP_CODEC_DEFLATE;
    stream->file              = NULL;
    stream->deflate_backend   = NULL;
-   stream->deflate_stream    = NULL;
    stream->inflate_backend   = NULL;
-   stream->inflate_stream    = NULL;
+   stream->chunks            = NULL;
+   stream->chunk_offsets     = NULL;
    stream->in_buf            = NULL;
    stream->in_buf_size       = 0;
    stream->in_buf_ptr        = 0;
@@ -261,6 +641,13 @@ static bool rzipstream_init_stream(
    else if (!rzipstream_read_file_header(stream))
       return false;
 
+   /* When reading, don't need transform streams
+    * (or buffers) if source file is uncompressed */
+   if (!stream->is_compressed)
+      return true;
+
+   stream->batch_size = rzipstream_get_batch_size(stream->chunk_size);
+
    /* Initialise appropriate transform stream
     * and determine associated buffer sizes */
    if (stream->is_writing)
@@ -270,79 +657,90 @@ static bool rzipstream_init_stream(
       if (!stream->deflate_backend)
          return false;
 
-      stream->deflate_stream = stream->deflate_backend->stream_new();
-      if (!stream->deflate_stream)
-         return false;
-
-      /* Set compression level */
-      if (!stream->deflate_backend->define(
-            stream->deflate_stream, "level", RZIP_COMPRESSION_LEVEL))
-         return false;
+      /* Input buffer: uncompressed
+       * > Starts out holding a single chunk,
+       *   and only grows to a full batch when
+       *   the data turns out to need more */
+      stream->in_buf_size = stream->chunk_size;
 
-      /* Buffers
-       * > Input: uncompressed
-       * > Output: compressed */
-      stream->in_buf_size  = stream->chunk_size;
-      stream->out_buf_size = stream->chunk_size * 2;
-      /* > Account for minimum zlib overhead
-       *   of 11 bytes... */ 
-      stream->out_buf_size =
-            (stream->out_buf_size < (stream->in_buf_size + 11)) ?
-                  stream->out_buf_size + 11 :
-                  stream->out_buf_size;
-
-      /* Redundant safety check */
-      if ((stream->in_buf_size == 0) ||
-          (stream->out_buf_size == 0))
-         return false;
+      /* Chunk offset table */
+      stream->chunk_offsets_size = 16;
    }
-   /* When reading, don't need an inflate transform
-    * stream (or buffers) if source file is uncompressed */
-   else if (stream->is_compressed)
+   else
    {
+      uint64_t max_chunks;
+
       /* Decompression */
       stream->inflate_backend = trans_stream_get_zlib_inflate_backend();
       if (!stream->inflate_backend)
          return false;
 
-      stream->inflate_stream = stream->inflate_backend->stream_new();
-      if (!stream->inflate_stream)
+      /* Every chunk takes at least a chunk header
+       * and one byte on disk, which catches bogus
+       * sizes before allocating the offset table */
+      stream->num_chunks = (size_t)((stream->size +
+            stream->chunk_size - 1) / stream->chunk_size);
+      max_chunks         = (uint64_t)(filestream_get_size(stream->file) -
+            stream->header_size) / (RZIP_CHUNK_HEADER_SIZE + 1);
+      if ((uint64_t)stream->num_chunks > max_chunks)
          return false;
 
-      /* Buffers
-       * > Input: compressed
-       * > Output: uncompressed
-       * Note 1: Actual compressed chunk sizes are read
-       *         from the file - just allocate a sensible
-       *         default to minimise memory reallocations
-       * Note 2: If file header is valid, output buffer
-       *         should have a size of exactly stream->chunk_size.
-       *         Allocate some additional space, just for
-       *         redundant safety... */
-      stream->in_buf_size  = stream->chunk_size * 2;
-      stream->out_buf_size = stream->chunk_size + (stream->chunk_size >> 2);
-
-      /* Redundant safety check */
-      if ((stream->in_buf_size == 0) ||
-          (stream->out_buf_size == 0))
+      stream->chunk_offsets_size = stream->num_chunks;
+      stream->batch_size         = (unsigned)MIN(
+            stream->batch_size, stream->num_chunks);
+
+      /* Output buffer: uncompressed
+       * > Compressed chunk sizes are read from the
+       *   file, their buffers are allocated as
+       *   chunks are read */
+      stream->out_buf_size = stream->chunk_size * stream->batch_size;
+   }
+
+   stream->chunk_offsets = (uint64_t*)malloc(
+         stream->chunk_offsets_size * sizeof(uint64_t));
+   stream->chunks        = (struct rzip_chunk*)calloc(
+         stream->batch_size, sizeof(struct rzip_chunk));
+   if (!stream->chunk_offsets || !stream->chunks)
+      return false;
+
+   /* Each chunk of a batch needs a transform
+    * stream of its own */
+   for (i = 0; i < stream->batch_size; i++)
+   {
+      struct rzip_chunk *chunk = &stream->chunks[i];
+
+      if (stream->is_writing)
+      {
+         if (!(chunk->trans_stream = stream->deflate_backend->stream_new()))
+            return false;
+
+         /* Set compression level */
+         if (!stream->deflate_backend->define(
+               chunk->trans_stream, "level", RZIP_COMPRESSION_LEVEL))
+            return false;
+      }
+      else if (!(chunk->trans_stream = stream->inflate_backend->stream_new()))
          return false;
    }
 
    /* Allocate buffers */
    if (stream->in_buf_size > 0)
    {
-      stream->in_buf = (uint8_t *)calloc(stream->in_buf_size, 1);
+      stream->in_buf = (uint8_t *)malloc(stream->in_buf_size);
       if (!stream->in_buf)
          return false;
    }
 
    if (stream->out_buf_size > 0)
    {
-      stream->out_buf = (uint8_t *)calloc(stream->out_buf_size, 1);
+      stream->out_buf = (uint8_t *)malloc(stream->out_buf_size);
       if (!stream->out_buf)
          return false;
    }
 
+   if (!stream->is_writing)
+      rzipstream_read_index(stream);
+
    return true;
 }
 
@@ -350,24 +748,41 @@ static bool rzipstream_init_stream(
  * > Also closes associated file, if currently open */
 static int rzipstream_free_stream(rzipstream_t *stream)
 {
+   unsigned i;
    int ret = 0;
 
    if (!stream)
       return -1;
 
-   /* Free transform streams */
-   if (stream->deflate_stream && stream->deflate_backend)
-      stream->deflate_backend->stream_free(stream->deflate_stream);
+#ifdef HAVE_THREADS
+   if (stream->pool)
+      tpool_destroy(stream->pool);
+   stream->pool = NULL;
+#endif
 
-   stream->deflate_stream  = NULL;
-   stream->deflate_backend = NULL;
+   /* Free chunks and their transform streams */
+   if (stream->chunks)
+   {
+      const struct trans_stream_backend *backend = stream->is_writing
+            ? stream->deflate_backend : stream->inflate_backend;
 
-   if (stream->inflate_stream && stream->inflate_backend)
-      stream->inflate_backend->stream_free(stream->inflate_stream);
+      for (i = 0; i < stream->batch_size; i++)
+      {
+         if (stream->chunks[i].trans_stream && backend)
+            backend->stream_free(stream->chunks[i].trans_stream);
+         free(stream->chunks[i].buf);
+      }
 
-   stream->inflate_stream  = NULL;
+      free(stream->chunks);
+   }
+   stream->chunks          = NULL;
+   stream->deflate_backend = NULL;
    stream->inflate_backend = NULL;
 
+   if (stream->chunk_offsets)
+      free(stream->chunk_offsets);
+   stream->chunk_offsets = NULL;
+
    /* Free buffers */
    if (stream->in_buf)
       free(stream->in_buf);
@@ -419,23 +834,34 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
    if (!stream)
       return NULL;
 
-   stream->is_compressed   = false;
-   stream->is_writing      = false;
-   stream->size            = 0;
-   stream->chunk_size      = 0;
-   stream->virtual_ptr     = 0;
-   stream->file            = NULL;
-   stream->deflate_backend = NULL;
-   stream->deflate_stream  = NULL;
-   stream->inflate_backend = NULL;
-   stream->inflate_stream  = NULL;
-   stream->in_buf          = NULL;
-   stream->in_buf_size     = 0;
-   stream->in_buf_ptr      = 0;
-   stream->out_buf         = NULL;
-   stream->out_buf_size    = 0;
-   stream->out_buf_ptr     = 0;
-   stream->out_buf_occupancy = 0;
+   stream->is_compressed      = false;
+   stream->is_writing         = false;
+   stream->size               = 0;
+   stream->chunk_size         = 0;
+   stream->header_size        = 0;
+   stream->codec              = RZIP_CODEC_DEFLATE;
+   stream->virtual_ptr        = 0;
+   stream->chunk_offsets      = NULL;
+   stream->file               = NULL;
+   stream->deflate_backend    = NULL;
+   stream->inflate_backend    = NULL;
+#ifdef HAVE_THREADS
+   stream->pool               = NULL;
+#endif
+   stream->chunks             = NULL;
+   stream->in_buf             = NULL;
+   stream->in_buf_size        = 0;
+   stream->in_buf_ptr         = 0;
+   stream->out_buf            = NULL;
+   stream->out_buf_size       = 0;
+   stream->out_buf_ptr        = 0;
+   stream->out_buf_occupancy  = 0;
+   stream->num_chunks         = 0;
+   stream->chunks_known       = 0;
+   stream->chunk_offsets_size = 0;
+   stream->chunk_next         = 0;
+   stream->batch_first        = 0;
+   stream->batch_size         = 0;
 
    /* Initialise stream */
    if (!rzipstream_init_stream(
@@ -451,94 +877,138 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
 
 /* File Read */
 
-/* Reads and decompresses the next chunk of data
- * in the RZIP file */
-static bool rzipstream_read_chunk(rzipstream_t *stream)
+/* Reads the next batch of chunks in the RZIP
+ * file and decompresses them in parallel */
+static bool rzipstream_read_chunks(rzipstream_t *stream)
 {
-   unsigned i;
-   int64_t length;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t compressed_chunk_size;
-   uint32_t inflate_read;
-   uint32_t inflate_written;
+   size_t i;
+   size_t count;
+   uint32_t occupancy = 0;
 
-   if (!stream || !stream->inflate_backend || !stream->inflate_stream)
+   if (!stream || !stream->inflate_backend)
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
-
-   /* Attempt to read chunk header bytes */
-   length = filestream_read(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes));
-   if (length != RZIP_CHUNK_HEADER_SIZE)
+   if (stream->chunk_next >= stream->num_chunks)
       return false;
 
-   /* Get size of next compressed chunk */
-   compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
-                           ((uint32_t)chunk_header_bytes[2] << 16) |
-                           ((uint32_t)chunk_header_bytes[1] <<  8) |
-                            (uint32_t)chunk_header_bytes[0];
-   if (compressed_chunk_size == 0)
-      return false;
+   count = MIN(stream->batch_size, stream->num_chunks - stream->chunk_next);
 
-   /* Resize input buffer, if required */
-   if (compressed_chunk_size > stream->in_buf_size)
+   /* Chunks are read from disk in order... */
+   for (i = 0; i < count; i++)
    {
-      free(stream->in_buf);
-      stream->in_buf      = NULL;
+      int64_t length;
+      uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+      uint32_t compressed_chunk_size;
+      struct rzip_chunk *chunk = &stream->chunks[i];
+      size_t index             = stream->chunk_next + i;
+      uint64_t chunk_start     = (uint64_t)index * stream->chunk_size;
+
+      /* Attempt to read chunk header bytes */
+      length = filestream_read(
+            stream->file, chunk_header_bytes, sizeof(chunk_header_bytes));
+      if (length != RZIP_CHUNK_HEADER_SIZE)
+         return false;
 
-      stream->in_buf_size = compressed_chunk_size;
-      stream->in_buf      = (uint8_t *)calloc(stream->in_buf_size, 1);
-      if (!stream->in_buf)
+      /* Get size of next compressed chunk */
+      compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
+                              ((uint32_t)chunk_header_bytes[2] << 16) |
+                              ((uint32_t)chunk_header_bytes[1] <<  8) |
+                               (uint32_t)chunk_header_bytes[0];
+      if (compressed_chunk_size == 0)
          return false;
 
-      /* Note: Uncompressed data size is fixed, and read
-       * from the file header - we therefore don't attempt
-       * to resize the output buffer (if it's too small, then
-       * that's an error condition) */
-   }
+      /* Resize input buffer, if required */
+      if (compressed_chunk_size > chunk->buf_size)
+      {
+         free(chunk->buf);
 
-   /* Read compressed chunk from file */
-   length = filestream_read(
-         stream->file, stream->in_buf, compressed_chunk_size);
-   if (length != compressed_chunk_size)
-      return false;
+         chunk->buf_size = compressed_chunk_size;
+         chunk->buf      = (uint8_t *)malloc(chunk->buf_size);
+         if (!chunk->buf)
+         {
+            chunk->buf_size = 0;
+            return false;
+         }
+      }
 
-   /* Decompress chunk data */
-   stream->inflate_backend->set_in(
-         stream->inflate_stream,
-         stream->in_buf, compressed_chunk_size);
-
-   stream->inflate_backend->set_out(
-         stream->inflate_stream,
-         stream->out_buf, stream->out_buf_size);
-
-   /* Note: We have to set 'flush == true' here, otherwise we
-    * can't guarantee that the entire chunk will be written
-    * to the output buffer - this is inefficient, but not
-    * much we can do... */
-   if (!stream->inflate_backend->trans(
-         stream->inflate_stream, true,
-         &inflate_read, &inflate_written, NULL))
-      return false;
+      /* Read compressed chunk from file */
+      length = filestream_read(
+            stream->file, chunk->buf, compressed_chunk_size);
+      if (length != compressed_chunk_size)
+         return false;
 
-   /* Error checking */
-   if (inflate_read != compressed_chunk_size)
-      return false;
+      /* Note: Uncompressed data size is fixed, and read
+       * from the file header - only the last chunk may
+       * be short */
+      chunk->buf_len  = compressed_chunk_size;
+      chunk->data     = stream->out_buf + occupancy;
+      chunk->data_len = (uint32_t)MIN(stream->chunk_size,
+            stream->size - chunk_start);
+      occupancy      += chunk->data_len;
+
+      /* Record where the following chunk starts */
+      if ((index + 1 == stream->chunks_known) &&
+          (index + 1 <  stream->num_chunks))
+         stream->chunk_offsets[stream->chunks_known++] =
+               stream->chunk_offsets[index] +
+               RZIP_CHUNK_HEADER_SIZE + compressed_chunk_size;
+   }
 
-   if ((inflate_written == 0) ||
-       (inflate_written > stream->out_buf_size))
-      return false;
+   /* ...and decompressed in parallel */
+   rzipstream_process_chunks(stream, count, rzipstream_inflate_chunks);
+
+   for (i = 0; i < count; i++)
+      if (!stream->chunks[i].ok)
+         return false;
 
    /* Record current output buffer occupancy
     * and reset pointer */
-   stream->out_buf_occupancy = inflate_written;
+   stream->batch_first       = stream->chunk_next;
+   stream->chunk_next       += count;
+   stream->out_buf_occupancy = occupancy;
    stream->out_buf_ptr       = 0;
 
    return true;
 }
 
+/* Moves the file position to the start of
+ * chunk 'index', walking the chunk headers
+ * from the last known offset if required */
+static bool rzipstream_find_chunk(rzipstream_t *stream, size_t index)
+{
+   if (index >= stream->num_chunks)
+      return false;
+
+   while (stream->chunks_known <= index)
+   {
+      uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+      uint32_t compressed_chunk_size;
+      uint64_t offset = stream->chunk_offsets[stream->chunks_known - 1];
+
+      if ((filestream_seek(stream->file, (int64_t)offset, SEEK_SET) < 0) ||
+          (filestream_read(stream->file, chunk_header_bytes,
+            sizeof(chunk_header_bytes)) != RZIP_CHUNK_HEADER_SIZE))
+         return false;
+
+      compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
+                              ((uint32_t)chunk_header_bytes[2] << 16) |
+                              ((uint32_t)chunk_header_bytes[1] <<  8) |
+                               (uint32_t)chunk_header_bytes[0];
+      if (compressed_chunk_size == 0)
+         return false;
+
+      stream->chunk_offsets[stream->chunks_known++] =
+            offset + RZIP_CHUNK_HEADER_SIZE + compressed_chunk_size;
+   }
+
+   if (filestream_seek(stream->file,
+         (int64_t)stream->chunk_offsets[index], SEEK_SET) < 0)
+      return false;
+
+   stream->chunk_next = index;
+   return true;
+}
+
 /* Reads (a maximum of) 'len' bytes from an RZIP file.
  * Returns actual number of bytes read, or -1 in
  * the event of an error */
@@ -567,10 +1037,10 @@ int64_t rzipstream_read(rzipstream_t *stream, void *data, int64_t len)
          return data_read;
 
       /* If everything in the output buffer has already
-       * been read, grab and extract the next chunk
-       * from disk */
+       * been read, grab and extract the next batch
+       * of chunks from disk */
       if (stream->out_buf_ptr >= stream->out_buf_occupancy)
-         if (!rzipstream_read_chunk(stream))
+         if (!rzipstream_read_chunks(stream))
             return -1;
 
       /* Get amount of data to 'read out' this loop
@@ -741,65 +1211,90 @@ error:
 
 /* File Write */
 
-/* Compresses currently cached data and writes it
- * as the next RZIP file chunk */
-static bool rzipstream_write_chunk(rzipstream_t *stream)
+/* Compresses currently cached data in parallel
+ * and writes it as the next RZIP file chunks */
+static bool rzipstream_write_chunks(rzipstream_t *stream)
 {
-   unsigned i;
-   int64_t length;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t deflate_read;
-   uint32_t deflate_written;
+   size_t i;
+   size_t count;
 
-   if (!stream || !stream->deflate_backend || !stream->deflate_stream)
+   if (!stream || !stream->deflate_backend)
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
-
-   /* Compress data currently held in input buffer */
-   stream->deflate_backend->set_in(
-         stream->deflate_stream,
-         stream->in_buf, stream->in_buf_ptr);
-
-   stream->deflate_backend->set_out(
-         stream->deflate_stream,
-         stream->out_buf, stream->out_buf_size);
-
-   /* Note: We have to set 'flush == true' here, otherwise we
-    * can't guarantee that the entire chunk will be written
-    * to the output buffer - this is inefficient, but not
-    * much we can do... */
-   if (!stream->deflate_backend->trans(
-         stream->deflate_stream, true,
-         &deflate_read, &deflate_written, NULL))
-      return false;
+   count = (stream->in_buf_ptr + stream->chunk_size - 1) / stream->chunk_size;
 
-   /* Error checking */
-   if (deflate_read != stream->in_buf_ptr)
-      return false;
+   for (i = 0; i < count; i++)
+   {
+      struct rzip_chunk *chunk = &stream->chunks[i];
 
-   if ((deflate_written == 0) ||
-       (deflate_written > stream->out_buf_size))
-      return false;
+      chunk->data     = stream->in_buf + i * stream->chunk_size;
+      chunk->data_len = MIN(stream->chunk_size,
+            stream->in_buf_ptr - (uint32_t)i * stream->chunk_size);
 
-   /* Write compressed chunk size to file */
-   chunk_header_bytes[3] = (deflate_written >> 24) & 0xFF;
-   chunk_header_bytes[2] = (deflate_written >> 16) & 0xFF;
-   chunk_header_bytes[1] = (deflate_written >>  8) & 0xFF;
-   chunk_header_bytes[0] =  deflate_written        & 0xFF;
+      /* Output buffer: compressed
+       * > Account for minimum zlib overhead
+       *   of 11 bytes... */
+      if (!chunk->buf && stream->codec != RZIP_CODEC_STORE)
+      {
+         chunk->buf_size = stream->chunk_size * 2;
+         chunk->buf_size = (chunk->buf_size < (stream->chunk_size + 11)) ?
+               chunk->buf_size + 11 : chunk->buf_size;
+         if (!(chunk->buf = (uint8_t *)malloc(chunk->buf_size)))
+         {
+            chunk->buf_size = 0;
+            return false;
+         }
+      }
+   }
 
-   length = filestream_write(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes));
-   if (length != RZIP_CHUNK_HEADER_SIZE)
-      return false;
+   /* Chunks are compressed in parallel... */
+   rzipstream_process_chunks(stream, count, rzipstream_deflate_chunks);
 
-   /* Write compressed data to file */
-   length = filestream_write(
-         stream->file, stream->out_buf, deflate_written);
+   /* ...and written to disk in order */
+   for (i = 0; i < count; i++)
+   {
+      int64_t length;
+      uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+      struct rzip_chunk *chunk = &stream->chunks[i];
+      const uint8_t *buf       = (stream->codec == RZIP_CODEC_STORE)
+            ? chunk->data : chunk->buf;
 
-   if (length != deflate_written)
-      return false;
+      if (!chunk->ok)
+         return false;
+
+      /* Record chunk offset */
+      if (stream->num_chunks >= stream->chunk_offsets_size)
+      {
+         size_t new_size    = stream->chunk_offsets_size * 2;
+         uint64_t *offsets  = (uint64_t*)realloc(stream->chunk_offsets,
+               new_size * sizeof(uint64_t));
+         if (!offsets)
+            return false;
+         stream->chunk_offsets      = offsets;
+         stream->chunk_offsets_size = new_size;
+      }
+
+      stream->chunk_offsets[stream->num_chunks++] =
+            (uint64_t)filestream_tell(stream->file);
+
+      /* Write compressed chunk size to file */
+      chunk_header_bytes[3] = (chunk->buf_len >> 24) & 0xFF;
+      chunk_header_bytes[2] = (chunk->buf_len >> 16) & 0xFF;
+      chunk_header_bytes[1] = (chunk->buf_len >>  8) & 0xFF;
+      chunk_header_bytes[0] =  chunk->buf_len        & 0xFF;
+
+      length = filestream_write(
+            stream->file, chunk_header_bytes, sizeof(chunk_header_bytes));
+      if (length != RZIP_CHUNK_HEADER_SIZE)
+         return false;
+
+      /* Write compressed data to file */
+      length = filestream_write(
+            stream->file, buf, chunk->buf_len);
+
+      if (length != chunk->buf_len)
+         return false;
+   }
 
    /* Reset input buffer pointer */
    stream->in_buf_ptr = 0;
@@ -823,10 +1318,25 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
    {
       int64_t cache_size = 0;
 
-      /* If input buffer is full, compress and write to disk */
+      /* If input buffer is full, either grow it
+       * to hold a full batch of chunks, or
+       * compress and write to disk */
       if (stream->in_buf_ptr >= stream->in_buf_size)
-         if (!rzipstream_write_chunk(stream))
+      {
+         uint32_t batch_buf_size = stream->chunk_size * stream->batch_size;
+
+         if (stream->in_buf_size < batch_buf_size)
+         {
+            uint8_t *in_buf = (uint8_t *)realloc(
+                  stream->in_buf, batch_buf_size);
+            if (!in_buf)
+               return -1;
+            stream->in_buf      = in_buf;
+            stream->in_buf_size = batch_buf_size;
+         }
+         else if (!rzipstream_write_chunks(stream))
             return -1;
+      }
 
       /* Get amount of data to cache during this loop
        * > i.e. minimum of space remaining in input buffer
@@ -849,7 +1359,7 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
    }
 
    /* We always write the specified number of bytes
-    * (unless rzipstream_write_chunk() fails, in
+    * (unless rzipstream_write_chunks() fails, in
     * which we register a complete failure...) */
    return len;
 }
@@ -941,12 +1451,140 @@ bool rzipstream_write_file(const char *path, const void *data, int64_t len)
 
 /* File Control */
 
+/* Sets the codec used to compress the chunks
+ * of an RZIP file open for writing.
+ * Must be called before any data is written.
+ * Returns false if arguments are invalid or
+ * data has already been written */
+bool rzipstream_set_codec(rzipstream_t *stream, unsigned codec)
+{
+   if (!stream || !stream->is_writing || (stream->size > 0))
+      return false;
+
+   if ((codec != RZIP_CODEC_DEFLATE) &&
+       (codec != RZIP_CODEC_STORE))
+      return false;
+
+   if (codec == stream->codec)
+      return true;
+
+   /* Deflate keeps the version 1 header, so
+    * that older readers can open the file */
+   stream->codec       = codec;
+   stream->header_size = (codec == RZIP_CODEC_DEFLATE)
+         ? RZIP_HEADER_SIZE : RZIP_HEADER_SIZE_CODEC;
+
+   return rzipstream_write_file_header(stream);
+}
+
+/* Sets file position of an RZIP file open for
+ * reading to 'offset' bytes of *uncompressed* data
+ * relative to 'whence' (SEEK_SET, SEEK_CUR or
+ * SEEK_END).
+ * Returns 0 on success, or -1 in the event
+ * of an error */
+int64_t rzipstream_seek(rzipstream_t *stream, int64_t offset, int whence)
+{
+   int64_t target;
+   size_t index;
+   uint64_t batch_start;
+
+   if (!stream)
+      return -1;
+
+   /* If we are handling uncompressed data, simply
+    * 'pass on' the direct file access request */
+   if (!stream->is_compressed)
+   {
+      int seek_position = RETRO_VFS_SEEK_POSITION_START;
+
+      switch (whence)
+      {
+         case SEEK_SET:
+            break;
+         case SEEK_CUR:
+            seek_position = RETRO_VFS_SEEK_POSITION_CURRENT;
+            break;
+         case SEEK_END:
+            seek_position = RETRO_VFS_SEEK_POSITION_END;
+            break;
+         default:
+            return -1;
+      }
+
+      return (filestream_seek(stream->file, offset, seek_position) < 0)
+            ? -1 : 0;
+   }
+
+   switch (whence)
+   {
+      case SEEK_SET:
+         target = offset;
+         break;
+      case SEEK_CUR:
+         target = (int64_t)stream->virtual_ptr + offset;
+         break;
+      case SEEK_END:
+         target = (int64_t)stream->size + offset;
+         break;
+      default:
+         return -1;
+   }
+
+   if ((target < 0) || ((uint64_t)target > stream->size))
+      return -1;
+
+   /* Data that has been written cannot be
+    * revisited - only the current position
+    * is valid */
+   if (stream->is_writing)
+      return ((uint64_t)target == stream->virtual_ptr) ? 0 : -1;
+
+   /* Check whether target is currently buffered
+    * in memory */
+   batch_start = (uint64_t)stream->batch_first * stream->chunk_size;
+   if ((stream->out_buf_occupancy > 0) &&
+       ((uint64_t)target >= batch_start) &&
+       ((uint64_t)target <  batch_start + stream->out_buf_occupancy))
+   {
+      /* It is: No file access is therefore required
+       * > Just reset pointers */
+      stream->out_buf_ptr = (uint32_t)((uint64_t)target - batch_start);
+      stream->virtual_ptr = (uint64_t)target;
+      return 0;
+   }
+
+   /* Nothing left to read at the end of the file */
+   if ((uint64_t)target == stream->size)
+   {
+      stream->out_buf_ptr = stream->out_buf_occupancy;
+      stream->virtual_ptr = stream->size;
+      return 0;
+   }
+
+   /* It isn't: Jump straight to the chunk holding
+    * the target and decompress from there */
+   index = (size_t)((uint64_t)target / stream->chunk_size);
+   if (!rzipstream_find_chunk(stream, index))
+      return -1;
+
+   if (!rzipstream_read_chunks(stream))
+   {
+      stream->out_buf_occupancy = 0;
+      return -1;
+   }
+
+   stream->out_buf_ptr = (uint32_t)((uint64_t)target -
+         (uint64_t)index * stream->chunk_size);
+   stream->virtual_ptr = (uint64_t)target;
+
+   return 0;
+}
+
 /* Sets file position to the beginning of the
  * specified RZIP file.
- * Note: It is not recommended to rewind a file
- * that is open for writing, since the caller
- * may end up with a file containing junk data
- * at the end (harmless, but a waste of space). */
+ * Note: Rewinding a file that is open for writing
+ * discards everything written so far. */
 void rzipstream_rewind(rzipstream_t *stream)
 {
    if (!stream)
@@ -974,8 +1612,11 @@ void rzipstream_rewind(rzipstream_t *stream)
    /* Check whether we are reading or writing */
    if (stream->is_writing)
    {
-      /* Reset file position to first chunk location */
-      filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
+      /* Drop any chunks written so far and reset
+       * file position to first chunk location */
+      filestream_flush(stream->file);
+      filestream_truncate(stream->file, stream->header_size);
+      filestream_seek(stream->file, stream->header_size, SEEK_SET);
       if (filestream_error(stream->file))
       {
          fprintf(
@@ -987,51 +1628,15 @@ void rzipstream_rewind(rzipstream_t *stream)
       /* Reset pointers */
       stream->virtual_ptr = 0;
       stream->in_buf_ptr  = 0;
+      stream->num_chunks  = 0;
 
       /* Reset file size */
       stream->size        = 0;
    }
-   else
-   {
-      /* Check whether first file chunk is currently
-       * buffered in memory */
-      if ((stream->virtual_ptr < stream->chunk_size) &&
-          (stream->out_buf_ptr < stream->out_buf_occupancy))
-      {
-         /* It is: No file access is therefore required
-          * > Just reset pointers */
-         stream->virtual_ptr = 0;
-         stream->out_buf_ptr = 0;
-      }
-      else
-      {
-         /* It isn't: Have to re-read the first chunk
-          * from disk... */
-
-         /* Reset file position to first chunk location */
-         filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
-         if (filestream_error(stream->file))
-         {
-            fprintf(
-                  stderr,
-                  "rzipstream_rewind(): Failed to reset file position...\n");
-            return;
-         }
-
-         /* Read chunk */
-         if (!rzipstream_read_chunk(stream))
-         {
-            fprintf(
-                  stderr,
-                  "rzipstream_rewind(): Failed to read first chunk of file...\n");
-            return;
-         }
-
-         /* Reset pointers */
-         stream->virtual_ptr = 0;
-         stream->out_buf_ptr = 0;
-      }
-   }
+   else if (rzipstream_seek(stream, 0, SEEK_SET) < 0)
+      fprintf(
+            stderr,
+            "rzipstream_rewind(): Failed to read first chunk of file...\n");
 }
 
 /* File Status */
@@ -1072,6 +1677,8 @@ int64_t rzipstream_tell(rzipstream_t *stream)
    if (!stream)
       return -1;
 
+   if (!stream->is_compressed)
+      return filestream_tell(stream->file);
    return (int64_t)stream->virtual_ptr;
 }
 
@@ -1097,13 +1704,17 @@ int rzipstream_close(rzipstream_t *stream)
 
    /* If we are writing, ensure that any
     * remaining uncompressed data is flushed to
-    * disk and update file header */
+    * disk, followed by the chunk offset table,
+    * and update file header */
    if (stream->is_writing)
    {
       if (stream->in_buf_ptr > 0)
-         if (!rzipstream_write_chunk(stream))
+         if (!rzipstream_write_chunks(stream))
             goto error;
 
+      if (!rzipstream_write_index(stream))
+         goto error;
+
       if (!rzipstream_write_file_header(stream))
          goto error;
    }
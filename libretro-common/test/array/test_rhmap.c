@@ -0,0 +1,152 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_rhmap.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <array/rhmap.h>
+
+#define SUITE_NAME "rhmap"
+
+START_TEST (test_rhmap_set_get_str)
+{
+   int *map = NULL;
+
+   RHMAP_SET_STR(map, "foo", 1);
+   RHMAP_SET_STR(map, "bar", 2);
+   ck_assert_uint_eq(RHMAP_LEN(map), 2);
+   ck_assert_int_eq(RHMAP_GET_STR(map, "foo"), 1);
+   ck_assert_int_eq(RHMAP_GET_STR(map, "bar"), 2);
+   ck_assert(!RHMAP_HAS_STR(map, "baz"));
+
+   RHMAP_FREE(map);
+   ck_assert_ptr_null(map);
+}
+END_TEST
+
+START_TEST (test_rhmap_del_str)
+{
+   int *map = NULL;
+
+   RHMAP_SET_STR(map, "foo", 1);
+   RHMAP_SET_STR(map, "bar", 2);
+   ck_assert(RHMAP_DEL_STR(map, "bar"));
+   ck_assert(!RHMAP_DEL_STR(map, "bar"));
+   ck_assert_uint_eq(RHMAP_LEN(map), 1);
+   ck_assert(!RHMAP_HAS_STR(map, "bar"));
+   ck_assert_int_eq(RHMAP_GET_STR(map, "foo"), 1);
+
+   RHMAP_FREE(map);
+}
+END_TEST
+
+/* Keys sharing one hash sit next to each other in the
+ * probe sequence. Deleting the first one moves the others
+ * back, each must keep its own string. */
+START_TEST (test_rhmap_del_str_collision)
+{
+   int *map = NULL;
+
+   RHMAP_SET_FULL(map, 5, "a", 1);
+   RHMAP_SET_FULL(map, 5, "b", 2);
+   RHMAP_SET_FULL(map, 5, "c", 3);
+   ck_assert_uint_eq(RHMAP_LEN(map), 3);
+
+   ck_assert(RHMAP_DEL_FULL(map, 5, "a"));
+   ck_assert_uint_eq(RHMAP_LEN(map), 2);
+   ck_assert(!RHMAP_HAS_FULL(map, 5, "a"));
+   ck_assert(RHMAP_HAS_FULL(map, 5, "b"));
+   ck_assert(RHMAP_HAS_FULL(map, 5, "c"));
+   ck_assert_int_eq(RHMAP_GET_FULL(map, 5, "b"), 2);
+   ck_assert_int_eq(RHMAP_GET_FULL(map, 5, "c"), 3);
+   ck_assert_str_eq(RHMAP_KEY_STR(map, RHMAP_IDX_FULL(map, 5, "b")), "b");
+   ck_assert_str_eq(RHMAP_KEY_STR(map, RHMAP_IDX_FULL(map, 5, "c")), "c");
+
+   ck_assert(RHMAP_DEL_FULL(map, 5, "b"));
+   ck_assert_uint_eq(RHMAP_LEN(map), 1);
+   ck_assert_int_eq(RHMAP_GET_FULL(map, 5, "c"), 3);
+
+   RHMAP_FREE(map);
+}
+END_TEST
+
+START_TEST (test_rhmap_del_str_many)
+{
+   unsigned i;
+   char key[32];
+   int *map = NULL;
+
+   for (i = 0; i < 1000; i++)
+   {
+      snprintf(key, sizeof(key), "key%u", i);
+      RHMAP_SET_STR(map, key, (int)i);
+   }
+
+   for (i = 0; i < 1000; i += 2)
+   {
+      snprintf(key, sizeof(key), "key%u", i);
+      ck_assert(RHMAP_DEL_STR(map, key));
+   }
+
+   ck_assert_uint_eq(RHMAP_LEN(map), 500);
+
+   for (i = 0; i < 1000; i++)
+   {
+      snprintf(key, sizeof(key), "key%u", i);
+      if (i & 1)
+      {
+         ck_assert(RHMAP_HAS_STR(map, key));
+         ck_assert_int_eq(RHMAP_GET_STR(map, key), (int)i);
+         ck_assert_str_eq(RHMAP_KEY_STR(map, RHMAP_IDX_STR(map, key)), key);
+      }
+      else
+         ck_assert(!RHMAP_HAS_STR(map, key));
+   }
+
+   RHMAP_FREE(map);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_rhmap_set_get_str);
+   tcase_add_test(tc_core, test_rhmap_del_str);
+   tcase_add_test(tc_core, test_rhmap_del_str_collision);
+   tcase_add_test(tc_core, test_rhmap_del_str_many);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,785 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Cheat search and cheat application cost, see frontend.mk.
+ *
+ * cheat_search runs every search type at every item size and
+ * byte order over two memory descriptors, a few rounds each on
+ * changing memory. The match count of every round and the
+ * matches left at the end of each sweep go into a digest.
+ *
+ * cheat_apply applies a generated set of RetroArch cheats over
+ * frames of changing memory, flipping the search byte order
+ * now and then. The memory left at the end goes into a digest.
+ *
+ * 'reference' is what the cheat manager used to do, one item
+ * at a time, kept here as it was. 'current' calls
+ * cheat_manager_search_*() and cheat_manager_apply_retro_cheats().
+ * Both variants fail if their digest differs from the one
+ * 'reference' gave before timing started. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+
+#include "../../../cheat_manager.h"
+#include "../../../configuration.h"
+#include "../../../core.h"
+#include "../../../msg_hash.h"
+#include "../../../retroarch.h"
+#include "../../../input/input_driver.h"
+
+#define BENCH_CHEAT_REGION_SIZE 0x4000
+#define BENCH_CHEAT_ROUNDS      3
+#define BENCH_CHEAT_CHEATS      64
+#define BENCH_CHEAT_FRAMES      256
+
+typedef int (*bench_cheat_search_t)(rarch_setting_t *setting,
+      size_t idx, bool wraparound);
+
+typedef struct bench_cheat
+{
+   uint8_t memory[2][BENCH_CHEAT_REGION_SIZE];
+   uint8_t image[2][BENCH_CHEAT_REGION_SIZE];
+   uint32_t seed;
+   uint32_t digest;
+   uint32_t expected_search;
+   uint32_t expected_apply;
+} bench_cheat_t;
+
+static const enum cheat_search_type bench_cheat_types[] = {
+   CHEAT_SEARCH_TYPE_EXACT,
+   CHEAT_SEARCH_TYPE_LT,
+   CHEAT_SEARCH_TYPE_GT,
+   CHEAT_SEARCH_TYPE_LTE,
+   CHEAT_SEARCH_TYPE_GTE,
+   CHEAT_SEARCH_TYPE_EQ,
+   CHEAT_SEARCH_TYPE_NEQ,
+   CHEAT_SEARCH_TYPE_EQPLUS,
+   CHEAT_SEARCH_TYPE_EQMINUS
+};
+
+/* In the same order */
+static const bench_cheat_search_t bench_cheat_searches[] = {
+   cheat_manager_search_exact,
+   cheat_manager_search_lt,
+   cheat_manager_search_gt,
+   cheat_manager_search_lte,
+   cheat_manager_search_gte,
+   cheat_manager_search_eq,
+   cheat_manager_search_neq,
+   cheat_manager_search_eqplus,
+   cheat_manager_search_eqminus
+};
+
+#define BENCH_CHEAT_TYPES (sizeof(bench_cheat_types) / sizeof(bench_cheat_types[0]))
+
+/* Only its address matters, it marks the initialization
+ * as the start of a search */
+static rarch_setting_t bench_setting;
+static rarch_memory_descriptor_t bench_descriptors[2];
+static rarch_system_info_t bench_system;
+
+/* Stubs for the bits of RetroArch cheat_manager.c talks to,
+ * the memory map is set up here instead */
+rarch_system_info_t *runloop_get_system_info(void) { return &bench_system; }
+bool core_get_memory(retro_ctx_memory_info_t *info) { return false; }
+bool core_get_system_info(struct retro_system_info *system) { return false; }
+bool core_set_cheat(retro_ctx_cheat_info_t *info) { return false; }
+bool core_reset_cheat(void) { return false; }
+settings_t *config_get_ptr(void) { return NULL; }
+global_t *global_get_ptr(void) { return NULL; }
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return ""; }
+bool input_driver_set_rumble_state(unsigned port,
+      enum retro_rumble_effect effect, uint16_t strength) { return false; }
+void runloop_msg_queue_push(const char *msg,
+      unsigned prio, unsigned duration,
+      bool flush,
+      char *title,
+      enum message_queue_icon icon, enum message_queue_category category) { }
+
+#ifndef HAVE_LOGGER
+void RARCH_LOG(const char *fmt, ...) { }
+#endif
+
+/* Not in cheat_manager.h */
+void cheat_manager_apply_rumble(struct item_cheat *cheat,
+      unsigned int curr_value);
+
+static void bench_cheat_hash(bench_cheat_t *b, uint32_t value)
+{
+   /* FNV-1a */
+   unsigned i;
+   for (i = 0; i < 4; i++)
+      b->digest = (b->digest ^ ((value >> (i * 8)) & 0xff)) * 16777619u;
+}
+
+static void bench_cheat_hash_bytes(bench_cheat_t *b,
+      const uint8_t *data, size_t len)
+{
+   size_t i;
+   for (i = 0; i < len; i++)
+      b->digest = (b->digest ^ data[i]) * 16777619u;
+}
+
+static uint32_t bench_cheat_rand(bench_cheat_t *b)
+{
+   b->seed ^= b->seed << 13;
+   b->seed ^= b->seed >> 17;
+   b->seed ^= b->seed << 5;
+   return b->seed;
+}
+
+/* Small values, so that exact searches do hit */
+static void bench_cheat_init(bench_cheat_t *b)
+{
+   unsigned i, j;
+
+   memset(b, 0, sizeof(*b));
+   b->seed = 0x87654321;
+
+   for (i = 0; i < 2; i++)
+      for (j = 0; j < BENCH_CHEAT_REGION_SIZE; j++)
+         b->image[i][j] = (uint8_t)(bench_cheat_rand(b) & 3);
+}
+
+/* Steps of one up or down, so that the searches against
+ * the previous values do hit too */
+static void bench_cheat_poke(bench_cheat_t *b)
+{
+   unsigned i;
+
+   for (i = 0; i < BENCH_CHEAT_REGION_SIZE / 4; i++)
+   {
+      uint32_t r  = bench_cheat_rand(b);
+      uint8_t *p  = &b->memory[(r >> 8) & 1][(r >> 9) % BENCH_CHEAT_REGION_SIZE];
+      *p          = (uint8_t)((*p + ((r & 1) ? 1 : 0xff)) & 3);
+   }
+}
+
+static void bench_cheat_start(bench_cheat_t *b)
+{
+   unsigned i;
+
+   b->seed   = 0x12345678;
+   b->digest = 2166136261u;
+
+   for (i = 0; i < 2; i++)
+   {
+      memset(&bench_descriptors[i], 0, sizeof(bench_descriptors[i]));
+      bench_descriptors[i].core.flags = RETRO_MEMDESC_SYSTEM_RAM;
+      bench_descriptors[i].core.ptr   = b->memory[i];
+      bench_descriptors[i].core.len   = BENCH_CHEAT_REGION_SIZE;
+   }
+
+   bench_system.mmaps.descriptors     = bench_descriptors;
+   bench_system.mmaps.num_descriptors = 2;
+
+   cheat_manager_state.search_exact_value   = 2;
+   cheat_manager_state.search_eqplus_value  = 1;
+   cheat_manager_state.search_eqminus_value = 1;
+}
+
+/* What cheat_manager.c used to do, one item at a time */
+
+static unsigned bench_cheat_translate_address(unsigned address,
+      unsigned char **curr)
+{
+   unsigned             offset = 0;
+   unsigned                  i = 0;
+   cheat_manager_t   *cheat_st = &cheat_manager_state;
+
+   for (i = 0; i < cheat_st->num_memory_buffers; i++)
+   {
+      if ((address >= offset) && (address < offset + cheat_st->memory_size_list[i]))
+      {
+         *curr = cheat_st->memory_buf_list[i];
+         break;
+      }
+      else
+         offset += cheat_st->memory_size_list[i];
+   }
+
+   return offset;
+}
+
+static void bench_cheat_setup_search_meta(
+      unsigned int bitsize,
+      unsigned int *bytes_per_item,
+      unsigned int *mask,
+      unsigned int *bits)
+{
+   switch (bitsize)
+   {
+      case 0:
+         *bytes_per_item = 1;
+         *bits           = 1;
+         *mask           = 0x01;
+         break;
+      case 1:
+         *bytes_per_item = 1;
+         *bits           = 2;
+         *mask           = 0x03;
+         break;
+      case 2:
+         *bytes_per_item = 1;
+         *bits           = 4;
+         *mask           = 0x0F;
+         break;
+      case 3:
+         *bytes_per_item = 1;
+         *bits           = 8;
+         *mask           = 0xFF;
+         break;
+      case 4:
+         *bytes_per_item = 2;
+         *bits           = 8;
+         *mask           = 0xFFFF;
+         break;
+      case 5:
+         *bytes_per_item = 4;
+         *bits           = 8;
+         *mask           = 0xFFFFFFFF;
+         break;
+   }
+}
+
+static void bench_cheat_search_reference(enum cheat_search_type search_type)
+{
+   cheat_manager_t   *cheat_st = &cheat_manager_state;
+   unsigned char *curr         = cheat_st->curr_memory_buf;
+   unsigned char *prev         = cheat_st->prev_memory_buf;
+   unsigned int idx            = 0;
+   unsigned int curr_val       = 0;
+   unsigned int prev_val       = 0;
+   unsigned int mask           = 0;
+   unsigned int bytes_per_item = 1;
+   unsigned int bits           = 8;
+   unsigned int offset         = 0;
+   unsigned int i              = 0;
+
+   bench_cheat_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
+
+   /* little endian FF000000 = 256 */
+   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   {
+      unsigned byte_part;
+
+      offset = bench_cheat_translate_address(idx, &curr);
+
+      switch (bytes_per_item)
+      {
+         case 2:
+            curr_val = cheat_st->big_endian ?
+               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
+               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
+            prev_val = cheat_st->big_endian ?
+               (*(prev + idx) * 256) + *(prev + idx + 1) :
+               *(prev + idx) + (*(prev + idx + 1) * 256);
+            break;
+         case 4:
+            curr_val = cheat_st->big_endian ?
+               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
+               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
+            prev_val = cheat_st->big_endian ?
+               (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
+               *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
+            break;
+         case 1:
+         default:
+            curr_val = *(curr - offset + idx);
+            prev_val = *(prev + idx);
+            break;
+      }
+
+      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+      {
+         unsigned int curr_subval = (curr_val >> (byte_part * bits)) & mask;
+         unsigned int prev_subval = (prev_val >> (byte_part * bits)) & mask;
+         unsigned int prev_match;
+
+         if (bits < 8)
+            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
+         else
+            prev_match = *(cheat_st->matches + idx);
+
+         if (prev_match > 0)
+         {
+            bool match = false;
+            switch (search_type)
+            {
+               case CHEAT_SEARCH_TYPE_EXACT:
+                  match = (curr_subval == cheat_st->search_exact_value);
+                  break;
+               case CHEAT_SEARCH_TYPE_LT:
+                  match = (curr_subval < prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_GT:
+                  match = (curr_subval > prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_LTE:
+                  match = (curr_subval <= prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_GTE:
+                  match = (curr_subval >= prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_EQ:
+                  match = (curr_subval == prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_NEQ:
+                  match = (curr_subval != prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_EQPLUS:
+                  match = (curr_subval == prev_subval + cheat_st->search_eqplus_value);
+                  break;
+               case CHEAT_SEARCH_TYPE_EQMINUS:
+                  match = (curr_subval == prev_subval - cheat_st->search_eqminus_value);
+                  break;
+            }
+
+            if (!match)
+            {
+               if (bits < 8)
+                  *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
+                     ((~(mask << (byte_part * bits))) & 0xFF);
+               else
+                  memset(cheat_st->matches + idx, 0, bytes_per_item);
+               if (cheat_st->num_matches > 0)
+                  cheat_st->num_matches--;
+            }
+         }
+      }
+   }
+
+   offset = 0;
+
+   for (i = 0; i < cheat_st->num_memory_buffers; i++)
+   {
+      memcpy(cheat_st->prev_memory_buf + offset, cheat_st->memory_buf_list[i], cheat_st->memory_size_list[i]);
+      offset += cheat_st->memory_size_list[i];
+   }
+}
+
+/* Every type, item size and byte order in turn, each
+ * starting over from the same memory */
+static bool bench_cheat_search_sweep(bench_cheat_t *b, bool reference)
+{
+   unsigned bit_size, type, round;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   bench_cheat_start(b);
+
+   for (bit_size = 0; bit_size < 12; bit_size++)
+   {
+      for (type = 0; type < BENCH_CHEAT_TYPES; type++)
+      {
+         memcpy(b->memory, b->image, sizeof(b->memory));
+
+         cheat_st->search_bit_size = bit_size >> 1;
+         cheat_st->big_endian      = bit_size & 1;
+         cheat_manager_initialize_memory(&bench_setting, 0, true);
+
+         if (!cheat_st->memory_search_initialized)
+            return false;
+
+         for (round = 0; round < BENCH_CHEAT_ROUNDS; round++)
+         {
+            bench_cheat_poke(b);
+
+            if (reference)
+               bench_cheat_search_reference(bench_cheat_types[type]);
+            else
+               bench_cheat_searches[type](NULL, 0, true);
+
+            bench_cheat_hash(b, cheat_st->num_matches);
+         }
+
+         bench_cheat_hash_bytes(b, cheat_st->matches,
+               cheat_st->total_memory_size);
+      }
+   }
+
+   return b->digest == b->expected_search;
+}
+
+static bool bench_cheat_search_ref(void *data)
+{
+   return bench_cheat_search_sweep((bench_cheat_t*)data, true);
+}
+
+static bool bench_cheat_search_cur(void *data)
+{
+   return bench_cheat_search_sweep((bench_cheat_t*)data, false);
+}
+
+/* Every cheat type, item size and byte order, repeats,
+ * conditions on small values, and a few cheats that are
+ * disabled or left to the core */
+static bool bench_cheat_apply_init(bench_cheat_t *b)
+{
+   unsigned i;
+   unsigned total = 2 * BENCH_CHEAT_REGION_SIZE;
+
+   if (!cheat_manager_realloc(BENCH_CHEAT_CHEATS, CHEAT_HANDLER_TYPE_RETRO))
+      return false;
+
+   for (i = 0; i < BENCH_CHEAT_CHEATS; i++)
+   {
+      struct item_cheat *cheat = &cheat_manager_state.cheats[i];
+      uint32_t r               = bench_cheat_rand(b);
+      unsigned size            = r % 6;
+      unsigned bytes           = (size == 5) ? 4 : (size == 4) ? 2 : 1;
+
+      r                            = bench_cheat_rand(b);
+      cheat->state                 = (r & 15) != 0;
+      cheat->handler               = ((r >> 4) & 15)
+         ? CHEAT_HANDLER_TYPE_RETRO : CHEAT_HANDLER_TYPE_EMU;
+      cheat->memory_search_size    = size;
+      cheat->cheat_type            = 1 + ((r >> 8) % 7);
+      cheat->big_endian            = (r >> 11) & 1;
+      cheat->repeat_count          = (r >> 12) % 5;
+      cheat->repeat_add_to_value   = (r >> 15) % 3;
+      cheat->repeat_add_to_address = (r >> 17) % 4;
+      cheat->rumble_type           = RUMBLE_TYPE_DISABLED;
+
+      r                            = bench_cheat_rand(b);
+      cheat->address               = (r % total) & ~(bytes - 1);
+
+      switch (size)
+      {
+         case 0:
+            cheat->address_mask = 1 << ((r >> 16) & 7);
+            break;
+         case 1:
+            cheat->address_mask = 3 << (2 * ((r >> 16) & 3));
+            break;
+         case 2:
+            cheat->address_mask = 0x0F << (4 * ((r >> 16) & 1));
+            break;
+         default:
+            cheat->address_mask = 0xFF;
+            break;
+      }
+
+      r = bench_cheat_rand(b);
+      if (cheat->cheat_type >= CHEAT_TYPE_RUN_NEXT_IF_EQ)
+         cheat->value = r & 3;
+      else if (cheat->cheat_type == CHEAT_TYPE_SET_TO_VALUE)
+         cheat->value = r;
+      else
+         cheat->value = r & 7;
+   }
+
+   return true;
+}
+
+static void bench_cheat_apply_reference(void)
+{
+   unsigned i;
+   unsigned int offset;
+   unsigned int mask           = 0;
+   unsigned int bytes_per_item = 1;
+   unsigned int bits           = 8;
+   unsigned int curr_val       = 0;
+   bool run_cheat              = true;
+   cheat_manager_t   *cheat_st = &cheat_manager_state;
+
+   if ((!cheat_st->cheats))
+      return;
+
+   for (i = 0; i < cheat_st->size; i++)
+   {
+      unsigned char *curr       = NULL;
+      bool set_value            = false;
+      unsigned int idx          = 0;
+      unsigned int value_to_set = 0;
+      unsigned int repeat_iter  = 0;
+      unsigned int address_mask = cheat_st->cheats[i].address_mask;
+
+      if (cheat_st->cheats[i].handler != CHEAT_HANDLER_TYPE_RETRO || !cheat_st->cheats[i].state)
+         continue;
+      if (!cheat_st->memory_initialized)
+         cheat_manager_initialize_memory(NULL, 0, false);
+
+      /* If we're still not initialized, something
+       * must have gone wrong - just bail */
+      if (!cheat_st->memory_initialized)
+         return;
+
+      if (!run_cheat)
+      {
+         run_cheat = true;
+         continue;
+      }
+      bench_cheat_setup_search_meta(cheat_st->cheats[i].memory_search_size, &bytes_per_item, &mask, &bits);
+
+      curr   = cheat_st->curr_memory_buf;
+      idx    = cheat_st->cheats[i].address;
+
+      offset = bench_cheat_translate_address(idx, &curr);
+
+      switch (bytes_per_item)
+      {
+         case 2:
+            curr_val = cheat_st->big_endian ?
+               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
+               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
+            break;
+         case 4:
+            curr_val = cheat_st->big_endian ?
+               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
+               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
+            break;
+         case 1:
+         default:
+            curr_val = *(curr + idx - offset);
+            break;
+      }
+
+      cheat_manager_apply_rumble(&cheat_st->cheats[i], curr_val);
+
+      switch (cheat_st->cheats[i].cheat_type)
+      {
+         case CHEAT_TYPE_SET_TO_VALUE:
+            set_value = true;
+            value_to_set = cheat_st->cheats[i].value;
+            break;
+         case CHEAT_TYPE_INCREASE_VALUE:
+            set_value = true;
+            value_to_set = curr_val + cheat_st->cheats[i].value;
+            break;
+         case CHEAT_TYPE_DECREASE_VALUE:
+            set_value = true;
+            value_to_set = curr_val - cheat_st->cheats[i].value;
+            break;
+         case CHEAT_TYPE_RUN_NEXT_IF_EQ:
+            if (!(curr_val == cheat_st->cheats[i].value))
+               run_cheat = false;
+            break;
+         case CHEAT_TYPE_RUN_NEXT_IF_NEQ:
+            if (!(curr_val != cheat_st->cheats[i].value))
+               run_cheat = false;
+            break;
+         case CHEAT_TYPE_RUN_NEXT_IF_LT:
+            if (!(cheat_st->cheats[i].value < curr_val))
+               run_cheat = false;
+            break;
+         case CHEAT_TYPE_RUN_NEXT_IF_GT:
+            if (!(cheat_st->cheats[i].value > curr_val))
+               run_cheat = false;
+            break;
+      }
+
+      if (set_value)
+      {
+         for (repeat_iter = 1; repeat_iter <= cheat_st->cheats[i].repeat_count; repeat_iter++)
+         {
+            switch (bytes_per_item)
+            {
+               case 2:
+                  if (cheat_st->cheats[i].big_endian)
+                  {
+                     *(curr + idx - offset) = (value_to_set >> 8) & 0xFF;
+                     *(curr + idx + 1 - offset) = value_to_set & 0xFF;
+                  }
+                  else
+                  {
+                     *(curr + idx - offset) = value_to_set & 0xFF;
+                     *(curr + idx + 1 - offset) = (value_to_set >> 8) & 0xFF;
+                  }
+                  break;
+               case 4:
+                  if (cheat_st->cheats[i].big_endian)
+                  {
+                     *(curr + idx - offset) = (value_to_set >> 24) & 0xFF;
+                     *(curr + idx + 1 - offset) = (value_to_set >> 16) & 0xFF;
+                     *(curr + idx + 2 - offset) = (value_to_set >> 8) & 0xFF;
+                     *(curr + idx + 3 - offset) = value_to_set & 0xFF;
+                  }
+                  else
+                  {
+                     *(curr + idx - offset) = value_to_set & 0xFF;
+                     *(curr + idx + 1 - offset) = (value_to_set >> 8) & 0xFF;
+                     *(curr + idx + 2 - offset) = (value_to_set >> 16) & 0xFF;
+                     *(curr + idx + 3 - offset) = (value_to_set >> 24) & 0xFF;
+                  }
+                  break;
+               case 1:
+                  if (bits < 8)
+                  {
+                     unsigned bitpos;
+                     unsigned char val = *(curr + idx - offset);
+
+                     for (bitpos = 0; bitpos < 8; bitpos++)
+                     {
+                        if ((address_mask >> bitpos) & 0x01)
+                        {
+                           mask = (~(1 << bitpos) & 0xFF);
+                           /* Clear current bit value */
+                           val = val & mask;
+                           /* Inject cheat bit value */
+                           val = val | (((value_to_set >> bitpos) & 0x01) << bitpos);
+                        }
+                     }
+
+                     *(curr + idx - offset) = val;
+                  }
+                  else
+                     *(curr + idx - offset) = value_to_set & 0xFF;
+                  break;
+               default:
+                  *(curr + idx - offset) = value_to_set & 0xFF;
+                  break;
+            }
+
+            value_to_set += cheat_st->cheats[i].repeat_add_to_value;
+
+            if (mask != 0)
+               value_to_set = value_to_set % mask;
+
+            if (bits < 8)
+            {
+               unsigned int bit_iter;
+               for (bit_iter = 0; bit_iter < cheat_st->cheats[i].repeat_add_to_address; bit_iter++)
+               {
+                  /* The mask is at least 0x7F here, which shifts
+                   * everything out on x86 where this ran. Spelled
+                   * out, shifting that far is undefined in C. */
+                  address_mask = (mask < 8) ? ((address_mask << mask) & 0xFF) : 0;
+
+                  if (address_mask == 0)
+                  {
+                     address_mask = mask;
+                     idx++;
+                  }
+               }
+            }
+            else
+               idx += (cheat_st->cheats[i].repeat_add_to_address * bytes_per_item);
+
+            idx = idx % cheat_st->total_memory_size;
+
+            offset = bench_cheat_translate_address(idx, &curr);
+         }
+      }
+   }
+}
+
+/* Conditions and increments read in the search byte order,
+ * flipped every quarter of the frames */
+static bool bench_cheat_apply_frames(bench_cheat_t *b, bool reference)
+{
+   unsigned f;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   bench_cheat_start(b);
+   memcpy(b->memory, b->image, sizeof(b->memory));
+
+   cheat_st->big_endian = false;
+   cheat_manager_initialize_memory(NULL, 0, true);
+
+   if (!cheat_st->memory_initialized)
+      return false;
+
+   for (f = 0; f < BENCH_CHEAT_FRAMES; f++)
+   {
+      unsigned i;
+
+      if (!(f % (BENCH_CHEAT_FRAMES / 4)))
+         cheat_st->big_endian = !cheat_st->big_endian;
+
+      for (i = 0; i < 64; i++)
+      {
+         uint32_t r = bench_cheat_rand(b);
+         b->memory[(r >> 8) & 1][(r >> 9) % BENCH_CHEAT_REGION_SIZE] =
+            (uint8_t)(r & 3);
+      }
+
+      if (reference)
+         bench_cheat_apply_reference();
+      else
+         cheat_manager_apply_retro_cheats();
+   }
+
+   bench_cheat_hash_bytes(b, b->memory[0], sizeof(b->memory));
+
+   return b->digest == b->expected_apply;
+}
+
+static bool bench_cheat_apply_ref(void *data)
+{
+   return bench_cheat_apply_frames((bench_cheat_t*)data, true);
+}
+
+static bool bench_cheat_apply_cur(void *data)
+{
+   return bench_cheat_apply_frames((bench_cheat_t*)data, false);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   bench_options_t opts;
+   bench_t benches[4];
+   const char *skipped[4];
+   unsigned num_benches  = 0;
+   const char **filters  = (const char**)calloc(argc, sizeof(*filters));
+   bench_cheat_t *b      = (bench_cheat_t*)calloc(1, sizeof(*b));
+   int ret               = 0;
+
+   if (!filters || !b)
+      return 1;
+
+   bench_options_init(&opts, filters);
+
+   for (i = 1; i < argc; i++)
+   {
+      if (bench_parse_option(&opts, argc, argv, &i))
+         continue;
+      bench_usage(argv[0], NULL);
+      return 1;
+   }
+
+   bench_options_finish(&opts);
+
+   bench_cheat_init(b);
+
+   if (!bench_cheat_apply_init(b))
+      return 1;
+
+   /* The old code gives the expected digests */
+   bench_cheat_search_ref(b);
+   b->expected_search = b->digest;
+   bench_cheat_apply_ref(b);
+   b->expected_apply  = b->digest;
+
+   BENCH_ADD("cheat_search", "reference", bench_cheat_search_ref,
+         b, 0);
+   BENCH_ADD("cheat_search", "current", bench_cheat_search_cur,
+         b, 0);
+   BENCH_ADD("cheat_apply", "reference", bench_cheat_apply_ref,
+         b, 0);
+   BENCH_ADD("cheat_apply", "current", bench_cheat_apply_cur,
+         b, 0);
+
+   ret = bench_run_all(stdout, &opts, benches, num_benches, skipped, 0);
+
+   cheat_manager_state_free();
+   free(b);
+   free(filters);
+
+   return ret;
+}
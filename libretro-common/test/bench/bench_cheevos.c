@@ -0,0 +1,318 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Achievement evaluation cost, see frontend.mk.
+ *
+ * Runs a set of triggers over frames of changing memory, the
+ * way rcheevos_test() does once per frame. 'peek' updates the
+ * memrefs through rc_runtime_do_frame(), one peek callback per
+ * memref, 'table' reads them through the pointers resolved by
+ * rcheevos_memref_table_build() first.
+ *
+ * Every memref value, previous and prior value, trigger state
+ * and event of every frame goes into a digest. Both variants
+ * fail if theirs differs from the one 'peek' gave before
+ * timing started. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+
+#include "../../../cheevos/cheevos_memory.h"
+#include "../../../core.h"
+#include "../../../retroarch.h"
+
+#define BENCH_CHEEVOS_FRAMES      1000
+#define BENCH_CHEEVOS_REGION_SIZE 0x1000
+#define BENCH_CHEEVOS_TRIGGERS    48
+
+typedef struct bench_cheevos
+{
+   rc_runtime_t runtime;
+   rcheevos_memref_table_t table;
+   rcheevos_memory_regions_t regions;
+   uint8_t memory[2][BENCH_CHEEVOS_REGION_SIZE];
+   char memaddr[BENCH_CHEEVOS_TRIGGERS][128];
+   uint32_t seed;
+   uint32_t digest;
+   uint32_t expected;
+} bench_cheevos_t;
+
+/* The event handler has no user data */
+static bench_cheevos_t *bench_cur = NULL;
+
+/* Stubs for the bits of RetroArch cheevos_memory.c talks to,
+ * the regions are set up here instead */
+bool core_get_memory(retro_ctx_memory_info_t *info) { return false; }
+rarch_system_info_t *runloop_get_system_info(void) { return NULL; }
+void rcheevos_log(const char *fmt, ...) { }
+
+#ifndef HAVE_LOGGER
+void RARCH_LOG(const char *fmt, ...) { }
+#endif
+
+static void bench_cheevos_hash(bench_cheevos_t *b, uint32_t value)
+{
+   /* FNV-1a */
+   unsigned i;
+   for (i = 0; i < 4; i++)
+      b->digest = (b->digest ^ ((value >> (i * 8)) & 0xff)) * 16777619u;
+}
+
+static void bench_cheevos_event(const rc_runtime_event_t *event)
+{
+   bench_cheevos_hash(bench_cur, event->id);
+   bench_cheevos_hash(bench_cur, (uint32_t)event->type);
+}
+
+/* Same as rcheevos_peek() */
+static unsigned bench_cheevos_peek(unsigned address,
+      unsigned num_bytes, void *ud)
+{
+   const uint8_t *data = rcheevos_memory_find(&bench_cur->regions, address);
+
+   if (data)
+   {
+      switch (num_bytes)
+      {
+         case 4:
+            return (data[3] << 24) | (data[2] << 16) |
+                   (data[1] <<  8) | (data[0]);
+         case 3:
+            return (data[2] << 16) | (data[1] << 8) | (data[0]);
+         case 2:
+            return (data[1] << 8)  | (data[0]);
+         case 1:
+            return data[0];
+      }
+   }
+
+   return 0;
+}
+
+/* A mix of every memref size, delta and prior values,
+ * hit counts, resets, an indirect address and memory
+ * outside of the regions */
+static void bench_cheevos_init(bench_cheevos_t *b)
+{
+   unsigned i;
+
+   memset(b, 0, sizeof(*b));
+
+   b->regions.data[0]    = b->memory[0];
+   b->regions.size[0]    = BENCH_CHEEVOS_REGION_SIZE;
+   b->regions.data[1]    = b->memory[1];
+   b->regions.size[1]    = BENCH_CHEEVOS_REGION_SIZE;
+   b->regions.total_size = 2 * BENCH_CHEEVOS_REGION_SIZE;
+   b->regions.count      = 2;
+
+   for (i = 0; i < BENCH_CHEEVOS_TRIGGERS; i++)
+   {
+      unsigned addr = (i * 0x53) % 0xf0;
+
+      switch (i % 6)
+      {
+         case 0:
+            snprintf(b->memaddr[i], sizeof(b->memaddr[i]),
+                  "0xH%04x=5_0xX%04x>d0xX%04x", addr, addr + 4, addr + 4);
+            break;
+         case 1:
+            snprintf(b->memaddr[i], sizeof(b->memaddr[i]),
+                  "0xL%04x=3_0xU%04x!=p0xU%04x", addr, addr, addr);
+            break;
+         case 2:
+            snprintf(b->memaddr[i], sizeof(b->memaddr[i]),
+                  "0xM%04x=1_0x %04x>100_0xW%04x<d0xW%04x",
+                  addr, addr + 1, addr + 3, addr + 3);
+            break;
+         case 3:
+            snprintf(b->memaddr[i], sizeof(b->memaddr[i]),
+                  "I:0xH%04x_0xH%04x=1", addr, i);
+            break;
+         case 4:
+            snprintf(b->memaddr[i], sizeof(b->memaddr[i]),
+                  "0xN%04x=1.10._R:0xO%04x=1",
+                  0x1000 + addr, 0x1000 + addr + 1);
+            break;
+         case 5:
+            snprintf(b->memaddr[i], sizeof(b->memaddr[i]),
+                  "0xH%04x=0_0xS%04x=0", 0x2000 + addr, 0x1000 + addr);
+            break;
+      }
+   }
+}
+
+/* Small values, so that the conditions do hit */
+static void bench_cheevos_poke(bench_cheevos_t *b)
+{
+   unsigned i;
+
+   for (i = 0; i < 32; i++)
+   {
+      b->seed ^= b->seed << 13;
+      b->seed ^= b->seed >> 17;
+      b->seed ^= b->seed << 5;
+      b->memory[(b->seed >> 8) & 1][(b->seed >> 9) & 0xff] =
+         (uint8_t)(b->seed & 7);
+   }
+}
+
+static void bench_cheevos_hash_frame(bench_cheevos_t *b)
+{
+   unsigned i;
+   const rc_memref_value_t *memref;
+
+   for (memref = b->runtime.memrefs; memref; memref = memref->next)
+   {
+      bench_cheevos_hash(b, memref->value);
+      bench_cheevos_hash(b, memref->previous);
+      bench_cheevos_hash(b, memref->prior);
+   }
+
+   for (i = 0; i < b->runtime.trigger_count; i++)
+      bench_cheevos_hash(b, (uint32_t)b->runtime.triggers[i].trigger->state);
+}
+
+/* Fresh triggers over the same memory every call */
+static bool bench_cheevos_start(bench_cheevos_t *b)
+{
+   unsigned i;
+
+   bench_cur      = b;
+   b->seed        = 0x12345678;
+   b->digest      = 2166136261u;
+   /* Its memrefs are about to be freed */
+   b->table.valid = false;
+   memset(b->memory, 0, sizeof(b->memory));
+
+   rc_runtime_destroy(&b->runtime);
+   rc_runtime_init(&b->runtime);
+
+   for (i = 0; i < BENCH_CHEEVOS_TRIGGERS; i++)
+      if (rc_runtime_activate_achievement(&b->runtime, i + 1,
+               b->memaddr[i], NULL, 0) != RC_OK)
+      {
+         fprintf(stderr, "Could not parse %s\n", b->memaddr[i]);
+         return false;
+      }
+
+   return true;
+}
+
+static bool bench_cheevos_peek_frames(void *data)
+{
+   unsigned f;
+   bench_cheevos_t *b = (bench_cheevos_t*)data;
+
+   if (!bench_cheevos_start(b))
+      return false;
+
+   for (f = 0; f < BENCH_CHEEVOS_FRAMES; f++)
+   {
+      bench_cheevos_poke(b);
+      rc_runtime_do_frame(&b->runtime, bench_cheevos_event,
+            bench_cheevos_peek, NULL, 0);
+      bench_cheevos_hash_frame(b);
+   }
+
+   return b->digest == b->expected;
+}
+
+static bool bench_cheevos_table_frames(void *data)
+{
+   unsigned f;
+   bench_cheevos_t *b = (bench_cheevos_t*)data;
+
+   if (!bench_cheevos_start(b))
+      return false;
+
+   for (f = 0; f < BENCH_CHEEVOS_FRAMES; f++)
+   {
+      rc_memref_value_t *memrefs;
+
+      bench_cheevos_poke(b);
+
+      /* As rcheevos_test() does it */
+      if (rcheevos_memref_table_is_stale(&b->table, b->runtime.memrefs))
+         rcheevos_memref_table_build(&b->table, b->runtime.memrefs,
+               &b->regions);
+
+      if (!b->table.valid)
+         return false;
+
+      memrefs            = b->runtime.memrefs;
+      rcheevos_memref_table_update(&b->table, &b->regions);
+      b->runtime.memrefs = NULL;
+      rc_runtime_do_frame(&b->runtime, bench_cheevos_event,
+            bench_cheevos_peek, NULL, 0);
+      b->runtime.memrefs = memrefs;
+
+      bench_cheevos_hash_frame(b);
+   }
+
+   return b->digest == b->expected;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   bench_options_t opts;
+   bench_t benches[2];
+   const char *skipped[2];
+   unsigned num_benches  = 0;
+   const char **filters  = (const char**)calloc(argc, sizeof(*filters));
+   bench_cheevos_t *peek = (bench_cheevos_t*)calloc(1, sizeof(*peek));
+   bench_cheevos_t *tbl  = (bench_cheevos_t*)calloc(1, sizeof(*tbl));
+   int ret               = 0;
+
+   if (!filters || !peek || !tbl)
+      return 1;
+
+   bench_options_init(&opts, filters);
+
+   for (i = 1; i < argc; i++)
+   {
+      if (bench_parse_option(&opts, argc, argv, &i))
+         continue;
+      bench_usage(argv[0], NULL);
+      return 1;
+   }
+
+   bench_options_finish(&opts);
+
+   bench_cheevos_init(peek);
+   bench_cheevos_init(tbl);
+
+   /* The stock path gives the expected digest */
+   bench_cheevos_peek_frames(peek);
+   peek->expected = tbl->expected = peek->digest;
+
+   BENCH_ADD("cheevos_memrefs", "peek", bench_cheevos_peek_frames,
+         peek, 0);
+   BENCH_ADD("cheevos_memrefs", "table", bench_cheevos_table_frames,
+         tbl, 0);
+
+   ret = bench_run_all(stdout, &opts, benches, num_benches, skipped, 0);
+
+   rc_runtime_destroy(&peek->runtime);
+   rc_runtime_destroy(&tbl->runtime);
+   rcheevos_memref_table_free(&tbl->table);
+   free(peek);
+   free(tbl);
+   free(filters);
+
+   return ret;
+}
@@ -0,0 +1,262 @@
+/* Copyright  (C) 2010-2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_common.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+
+#include "bench_common.h"
+
+volatile uint32_t bench_sink;
+
+static uint32_t bench_seed = 0x2545F491;
+
+uint32_t bench_rand(void)
+{
+   bench_seed ^= bench_seed << 13;
+   bench_seed ^= bench_seed >> 17;
+   bench_seed ^= bench_seed << 5;
+   return bench_seed;
+}
+
+bool bench_parse_option(bench_options_t *opts,
+      int argc, char *argv[], int *i)
+{
+   if (!strcmp(argv[*i], "--repeat") && *i + 1 < argc)
+      opts->repeat = (unsigned)atoi(argv[++*i]);
+   else if (!strcmp(argv[*i], "--min-ms") && *i + 1 < argc)
+      opts->min_ms = (unsigned)atoi(argv[++*i]);
+   else if (argv[*i][0] == '-')
+      return false;
+   else
+      opts->filters[opts->num_filters++] = argv[*i];
+
+   return true;
+}
+
+void bench_options_init(bench_options_t *opts, const char **filters)
+{
+   opts->filters     = filters;
+   opts->num_filters = 0;
+   opts->repeat      = 5;
+   opts->min_ms      = 100;
+}
+
+void bench_usage(const char *prog, const char *extra)
+{
+   fprintf(stderr,
+         "Usage: %s [options] [kernel ...]\n"
+         "\n"
+         "Only kernels whose name contains one of the given\n"
+         "strings are run, all of them by default.\n"
+         "\n"
+         "  --repeat <n>     timed repeats per kernel (default 5, max %d)\n"
+         "  --min-ms <ms>    minimum duration of one repeat (default 100)\n"
+         "%s",
+         prog, BENCH_MAX_REPEAT, extra ? extra : "");
+}
+
+void bench_options_finish(bench_options_t *opts)
+{
+   if (opts->repeat < 1)
+      opts->repeat = 1;
+   else if (opts->repeat > BENCH_MAX_REPEAT)
+      opts->repeat = BENCH_MAX_REPEAT;
+}
+
+static bool bench_selected(const bench_options_t *opts, const char *name)
+{
+   unsigned i;
+
+   if (!opts->num_filters)
+      return true;
+
+   for (i = 0; i < opts->num_filters; i++)
+      if (strstr(name, opts->filters[i]))
+         return true;
+
+   return false;
+}
+
+static int bench_compare_time(const void *a, const void *b)
+{
+   retro_time_t x = *(const retro_time_t*)a;
+   retro_time_t y = *(const retro_time_t*)b;
+   return (x > y) - (x < y);
+}
+
+static void bench_print_simd(FILE *out, uint64_t simd)
+{
+   static const struct { uint64_t bit; const char *ident; } flags[] = {
+      { RETRO_SIMD_MMX,    "mmx"    },
+      { RETRO_SIMD_SSE,    "sse"    },
+      { RETRO_SIMD_SSE2,   "sse2"   },
+      { RETRO_SIMD_SSE3,   "sse3"   },
+      { RETRO_SIMD_SSSE3,  "ssse3"  },
+      { RETRO_SIMD_SSE4,   "sse4"   },
+      { RETRO_SIMD_SSE42,  "sse42"  },
+      { RETRO_SIMD_AVX,    "avx"    },
+      { RETRO_SIMD_AVX2,   "avx2"   },
+      { RETRO_SIMD_FMA,    "fma"    },
+      { RETRO_SIMD_NEON,   "neon"   },
+      { RETRO_SIMD_ASIMD,  "asimd"  },
+      { RETRO_SIMD_VMX,    "vmx"    },
+      { RETRO_SIMD_VFPU,   "vfpu"   },
+      { RETRO_SIMD_PS,     "ps"     }
+   };
+   unsigned i;
+   bool first = true;
+
+   fprintf(out, "[");
+   for (i = 0; i < ARRAY_SIZE(flags); i++)
+   {
+      if (!(simd & flags[i].bit))
+         continue;
+      fprintf(out, "%s\"%s\"", first ? "" : ", ", flags[i].ident);
+      first = false;
+   }
+   fprintf(out, "]");
+}
+
+static void bench_report_begin(FILE *out, const bench_options_t *opts)
+{
+   char model[64];
+
+   model[0] = '\0';
+   cpu_features_get_model_name(model, sizeof(model));
+
+   fprintf(out, "{\n");
+   fprintf(out, "  \"version\": %d,\n", BENCH_VERSION);
+   fprintf(out, "  \"cpu\": \"%s\",\n", model);
+   fprintf(out, "  \"cores\": %u,\n", cpu_features_get_core_amount());
+   fprintf(out, "  \"simd\": ");
+   bench_print_simd(out, cpu_features_get());
+   fprintf(out, ",\n");
+   fprintf(out, "  \"repeat\": %u,\n", opts->repeat);
+   fprintf(out, "  \"results\": [\n");
+}
+
+/* Calls fn until one repeat takes at least min_ms, then times
+ * 'repeat' batches of that many calls. */
+static bool bench_run(const bench_t *b, const bench_options_t *opts,
+      bool first, FILE *out)
+{
+   unsigned r;
+   double median_ns, min_ns;
+   retro_time_t times[BENCH_MAX_REPEAT];
+   unsigned long iterations = 1;
+   retro_time_t min_usec    = (retro_time_t)opts->min_ms * 1000;
+
+   /* Warm up, and make sure it works at all */
+   if (!b->fn(b->data))
+      return false;
+
+   for (;;)
+   {
+      unsigned long i;
+      retro_time_t start = cpu_features_get_time_usec();
+
+      for (i = 0; i < iterations; i++)
+         b->fn(b->data);
+
+      if (     cpu_features_get_time_usec() - start >= min_usec
+            || iterations >= (1UL << 24))
+         break;
+
+      iterations <<= 1;
+   }
+
+   for (r = 0; r < opts->repeat; r++)
+   {
+      unsigned long i;
+      retro_time_t start = cpu_features_get_time_usec();
+
+      for (i = 0; i < iterations; i++)
+         b->fn(b->data);
+
+      times[r] = cpu_features_get_time_usec() - start;
+   }
+
+   qsort(times, opts->repeat, sizeof(times[0]), bench_compare_time);
+
+   median_ns = (double)times[opts->repeat / 2] * 1000.0 / iterations;
+   min_ns    = (double)times[0] * 1000.0 / iterations;
+
+   fprintf(out,
+         "%s    {\"name\": \"%s\", \"variant\": \"%s\", "
+         "\"bytes\": %lu, \"iterations\": %lu, "
+         "\"median_ns\": %.1f, \"min_ns\": %.1f, "
+         "\"mb_per_s\": %.2f}",
+         first ? "" : ",\n",
+         b->name, b->variant,
+         (unsigned long)b->bytes, iterations,
+         median_ns, min_ns,
+         median_ns > 0.0 ? (double)b->bytes * 1000.0 / median_ns : 0.0);
+
+   return true;
+}
+
+static void bench_report_end(FILE *out, const char **skipped,
+      unsigned num_skipped)
+{
+   unsigned n;
+
+   fprintf(out, "\n  ],\n  \"skipped\": [");
+   for (n = 0; n < num_skipped; n++)
+      fprintf(out, "%s\"%s\"", n ? ", " : "", skipped[n]);
+   fprintf(out, "]\n}\n");
+}
+
+int bench_run_all(FILE *out, const bench_options_t *opts,
+      const bench_t *benches, unsigned num_benches,
+      const char **skipped, unsigned num_skipped)
+{
+   unsigned n;
+   bool first = true;
+   int ret    = 0;
+
+   bench_report_begin(out, opts);
+
+   for (n = 0; n < num_benches; n++)
+   {
+      if (!bench_selected(opts, benches[n].name))
+         continue;
+
+      if (bench_run(&benches[n], opts, first, out))
+         first = false;
+      else
+      {
+         fprintf(stderr, "%s (%s): failed\n",
+               benches[n].name, benches[n].variant);
+         skipped[num_skipped++] = benches[n].name;
+         ret = 1;
+      }
+
+      fflush(out);
+   }
+
+   bench_report_end(out, skipped, num_skipped);
+
+   return ret;
+}
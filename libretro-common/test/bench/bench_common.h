@@ -0,0 +1,128 @@
+/* Copyright  (C) 2010-2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_common.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_BENCH_COMMON_H
+#define __LIBRETRO_BENCH_COMMON_H
+
+/* Timing and reporting shared by the benchmarks in this
+ * directory, see Makefile.bench.
+ *
+ * A benchmark registers callbacks that do one unit of work
+ * each. Every callback is calibrated to run for at least
+ * --min-ms per repeat, then timed --repeat times; the median
+ * is what should be compared across runs. Reports are JSON on
+ * stdout, with the same keys for every benchmark, so results
+ * from two builds can be diffed line by line. */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+#define BENCH_VERSION    1
+#define BENCH_MAX_REPEAT 31
+
+/* Returns false if the work failed or produced wrong output */
+typedef bool (*bench_fn_t)(void *data);
+
+typedef struct bench
+{
+   const char *name;
+   const char *variant;
+   bench_fn_t fn;
+   void *data;
+   /* Input bytes consumed per call */
+   size_t bytes;
+} bench_t;
+
+typedef struct bench_options
+{
+   const char **filters;
+   unsigned num_filters;
+   unsigned repeat;
+   unsigned min_ms;
+} bench_options_t;
+
+/* Appends to the caller's 'benches' array and 'num_benches' */
+#define BENCH_ADD(_name, _variant, _fn, _data, _bytes) \
+   do { \
+      benches[num_benches].name    = _name; \
+      benches[num_benches].variant = _variant; \
+      benches[num_benches].fn      = _fn; \
+      benches[num_benches].data    = _data; \
+      benches[num_benches].bytes   = _bytes; \
+      num_benches++; \
+   } while (0)
+
+/* Stores to a global so the optimiser can't drop the work */
+extern volatile uint32_t bench_sink;
+
+/* xorshift32 from a fixed seed, input is identical on every run */
+uint32_t bench_rand(void);
+
+/**
+ * bench_parse_option:
+ * @opts               : options to fill in
+ * @argc               : argument count
+ * @argv               : arguments
+ * @i                  : index of the current argument, advanced
+ *                       past any value it takes
+ *
+ * Handles --repeat, --min-ms and the kernel name filters.
+ * @opts->filters must have room for @argc entries.
+ *
+ * Returns: false if the argument is an option it doesn't know,
+ * which the caller may handle itself.
+ **/
+bool bench_parse_option(bench_options_t *opts,
+      int argc, char *argv[], int *i);
+
+/* Defaults: 5 repeats of at least 100 ms, no filters.
+ * @filters needs room for one entry per argument. */
+void bench_options_init(bench_options_t *opts, const char **filters);
+
+/* @extra lists the caller's own options, may be NULL */
+void bench_usage(const char *prog, const char *extra);
+
+/* Clamps --repeat, call once all arguments are parsed */
+void bench_options_finish(bench_options_t *opts);
+
+/**
+ * bench_run_all:
+ *
+ * Writes a whole report, running every selected benchmark
+ * in @benches. Failures are added to @skipped, which must
+ * have room for @num_benches more entries.
+ *
+ * Returns: 0, or 1 if any benchmark failed.
+ **/
+int bench_run_all(FILE *out, const bench_options_t *opts,
+      const bench_t *benches, unsigned num_benches,
+      const char **skipped, unsigned num_skipped);
+
+RETRO_END_DECLS
+
+#endif
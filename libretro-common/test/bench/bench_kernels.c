@@ -0,0 +1,895 @@
+/* Copyright  (C) 2010-2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_kernels.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Throughput of the libretro-common kernels the frontend
+ * spends its time in, see Makefile.bench and bench_common.h.
+ *
+ * Every kernel runs on synthetic input generated from a fixed
+ * seed, so results only change with the code, the compiler
+ * and the machine. Kernels are always listed in the same order,
+ * so results from two builds (say with and without SIMD) can be
+ * diffed line by line. Kernels that could not run are left out
+ * and named in "skipped". */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <boolean.h>
+#include <libretro.h>
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <audio/audio_mix.h>
+#include <audio/audio_resampler.h>
+#include <audio/conversion/float_to_s16.h>
+#include <audio/conversion/s16_to_float.h>
+#include <encodings/crc32.h>
+#include <file/config_file.h>
+#include <formats/image.h>
+#include <formats/rjpeg.h>
+#include <formats/rjson.h>
+#include <formats/rpng.h>
+#include <gfx/scaler/pixconv.h>
+#include <gfx/scaler/scaler.h>
+#include <streams/file_stream.h>
+#include <streams/rzip_stream.h>
+
+#include "bench_common.h"
+
+#define BENCH_AUDIO_FRAMES   (1 << 16)
+#define BENCH_IMAGE_WIDTH    640
+#define BENCH_IMAGE_HEIGHT   480
+#define BENCH_CRC_SIZE       (4 << 20)
+#define BENCH_RZIP_SIZE      (4 << 20)
+#define BENCH_CONFIG_ENTRIES 2000
+#define BENCH_JSON_ENTRIES   2000
+#define BENCH_MAX_RESAMPLERS 12
+#define BENCH_MAX_PIXCONV    (18 * 5)
+#define BENCH_MAX_SCALERS    (7 * 2)
+#define BENCH_MAX_BENCHES    160
+#define BENCH_SCALE_SIZE     (1920 * 1080 * 4)
+
+/* Audio */
+
+typedef struct bench_audio
+{
+   int16_t *s16;
+   float *in;
+   float *out;
+   size_t samples;
+} bench_audio_t;
+
+static bool bench_s16_to_float(void *data)
+{
+   bench_audio_t *a = (bench_audio_t*)data;
+   convert_s16_to_float(a->out, a->s16, a->samples, 1.0f);
+   bench_sink      += (uint32_t)a->out[a->samples - 1];
+   return true;
+}
+
+static bool bench_float_to_s16(void *data)
+{
+   bench_audio_t *a = (bench_audio_t*)data;
+   convert_float_to_s16(a->s16, a->in, a->samples);
+   bench_sink      += a->s16[a->samples - 1];
+   return true;
+}
+
+static bool bench_audio_mix_c(void *data)
+{
+   bench_audio_t *a = (bench_audio_t*)data;
+   audio_mix_volume_C(a->out, a->in, 0.5f, a->samples);
+   bench_sink      += (uint32_t)a->out[0];
+   return true;
+}
+
+static bool bench_audio_mix(void *data)
+{
+   bench_audio_t *a = (bench_audio_t*)data;
+   audio_mix_volume(a->out, a->in, 0.5f, a->samples);
+   bench_sink      += (uint32_t)a->out[0];
+   return true;
+}
+
+typedef struct bench_resampler
+{
+   const retro_resampler_t *backend;
+   void *handle;
+   const float *in;
+   float *out;
+   size_t frames;
+   double ratio;
+   /* Output matches the C kernel */
+   bool ok;
+} bench_resampler_t;
+
+static size_t bench_resample(bench_resampler_t *r)
+{
+   size_t pos;
+   size_t out_pos = 0;
+
+   /* Typical audio driver write size */
+   for (pos = 0; pos + 512 <= r->frames; pos += 512)
+   {
+      struct resampler_data rd;
+
+      rd.data_in       = r->in + pos * 2;
+      rd.data_out      = r->out + out_pos * 2;
+      rd.input_frames  = 512;
+      rd.output_frames = 0;
+      rd.ratio         = r->ratio;
+
+      r->backend->process(r->handle, &rd);
+      out_pos         += rd.output_frames;
+   }
+
+   return out_pos;
+}
+
+static bool bench_resampler(void *data)
+{
+   bench_resampler_t *r = (bench_resampler_t*)data;
+   size_t out_pos       = bench_resample(r);
+
+   bench_sink          += (uint32_t)out_pos;
+   return r->ok && out_pos > 0;
+}
+
+/* Runs both from their initial state; the SIMD kernels sum in
+ * a different order, but must stay well below 16-bit resolution */
+static bool bench_resampler_check(bench_resampler_t *c,
+      bench_resampler_t *simd, float *c_out)
+{
+   size_t i, c_frames, simd_frames;
+   float *out  = c->out;
+
+   c->out      = c_out;
+   c_frames    = bench_resample(c);
+   c->out      = out;
+   simd_frames = bench_resample(simd);
+
+   if (c_frames != simd_frames)
+      return false;
+
+   for (i = 0; i < c_frames * 2; i++)
+      if (fabsf(c_out[i] - simd->out[i]) > 1.0f / 65536.0f)
+         return false;
+
+   return true;
+}
+
+/* Video */
+
+typedef void (*bench_conv_fn_t)(void *output, const void *input,
+      int width, int height, int out_stride, int in_stride);
+
+typedef struct bench_pixconv
+{
+   bench_conv_fn_t conv;
+   const void *in;
+   void *out;
+   uint64_t simd;
+   int in_bpp;
+   int out_bpp;
+   /* Output matches the C kernels */
+   bool ok;
+} bench_pixconv_t;
+
+static bool bench_pixconv(void *data)
+{
+   bench_pixconv_t *p = (bench_pixconv_t*)data;
+
+   /* Kernels are picked per call from the current mask */
+   conv_set_simd_mask(p->simd);
+   p->conv(p->out, p->in, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT,
+         BENCH_IMAGE_WIDTH * p->out_bpp, BENCH_IMAGE_WIDTH * p->in_bpp);
+   bench_sink += *(const uint8_t*)p->out;
+   return p->ok;
+}
+
+/* Converts a frame two pixels narrower than the stride, so the
+ * scalar tails and stride handling are covered as well */
+static void bench_pixconv_check(const bench_pixconv_t *p, uint8_t *out)
+{
+   memset(out, 0, BENCH_IMAGE_WIDTH * BENCH_IMAGE_HEIGHT * p->out_bpp);
+   conv_set_simd_mask(p->simd);
+   p->conv(out, p->in, BENCH_IMAGE_WIDTH - 2, BENCH_IMAGE_HEIGHT,
+         BENCH_IMAGE_WIDTH * p->out_bpp, BENCH_IMAGE_WIDTH * p->in_bpp);
+}
+
+typedef struct bench_scaler
+{
+   struct scaler_ctx ctx;
+   const void *in;
+   void *out;
+   /* Output matches the single threaded one */
+   bool ok;
+} bench_scaler_t;
+
+static bool bench_scaler(void *data)
+{
+   bench_scaler_t *s = (bench_scaler_t*)data;
+   scaler_ctx_scale(&s->ctx, s->out, s->in);
+   bench_sink       += *(const uint8_t*)s->out;
+   return s->ok;
+}
+
+static unsigned bench_scaler_bpp(enum scaler_pix_fmt fmt)
+{
+   switch (fmt)
+   {
+      case SCALER_FMT_BGR24:
+         return 3;
+      case SCALER_FMT_RGB565:
+      case SCALER_FMT_0RGB1555:
+      case SCALER_FMT_RGBA4444:
+         return 2;
+      default:
+         break;
+   }
+   return 4;
+}
+
+/* Formats */
+
+typedef struct bench_buffer
+{
+   void *data;
+   size_t len;
+   const char *path;
+} bench_buffer_t;
+
+static bool bench_rpng(void *data)
+{
+   unsigned width, height;
+   int ret;
+   bench_buffer_t *b = (bench_buffer_t*)data;
+   uint32_t *img     = NULL;
+   rpng_t *rpng      = rpng_alloc();
+
+   if (!rpng)
+      return false;
+
+   if (     !rpng_set_buf_ptr(rpng, b->data, b->len)
+         || !rpng_start(rpng))
+   {
+      rpng_free(rpng);
+      return false;
+   }
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+   {
+      rpng_free(rpng);
+      return false;
+   }
+
+   do
+   {
+      ret = rpng_process_image(rpng, (void**)&img, b->len, &width, &height);
+   } while (ret == IMAGE_PROCESS_NEXT);
+
+   rpng_free(rpng);
+
+   if (!img)
+      return false;
+
+   bench_sink += img[0];
+   free(img);
+   return ret == IMAGE_PROCESS_END;
+}
+
+static bool bench_rjpeg(void *data)
+{
+   unsigned width, height;
+   int ret;
+   bench_buffer_t *b = (bench_buffer_t*)data;
+   uint32_t *img     = NULL;
+   rjpeg_t *rjpeg    = rjpeg_alloc();
+
+   if (!rjpeg)
+      return false;
+
+   rjpeg_set_buf_ptr(rjpeg, b->data);
+   ret = rjpeg_process_image(rjpeg, (void**)&img, b->len, &width, &height);
+   rjpeg_free(rjpeg);
+
+   if (!img)
+      return false;
+
+   bench_sink += img[0];
+   free(img);
+   return ret == IMAGE_PROCESS_END;
+}
+
+static bool bench_crc32(void *data)
+{
+   bench_buffer_t *b = (bench_buffer_t*)data;
+   bench_sink       += encoding_crc32(0, (const uint8_t*)b->data, b->len);
+   return true;
+}
+
+static bool bench_rzip_write(void *data)
+{
+   bench_buffer_t *b = (bench_buffer_t*)data;
+   return rzipstream_write_file(b->path, b->data, (int64_t)b->len);
+}
+
+static bool bench_rzip_read(void *data)
+{
+   int64_t len       = 0;
+   void *buf         = NULL;
+   bench_buffer_t *b = (bench_buffer_t*)data;
+
+   if (!rzipstream_read_file(b->path, &buf, &len))
+      return false;
+
+   bench_sink += (uint32_t)len;
+   free(buf);
+   return len == (int64_t)b->len;
+}
+
+static bool bench_config_file(void *data)
+{
+   int value          = 0;
+   bench_buffer_t *b  = (bench_buffer_t*)data;
+   config_file_t *conf = config_file_new_from_string(
+         (char*)b->data, NULL);
+
+   if (!conf)
+      return false;
+
+   config_get_int(conf, "bench_entry_1999", &value);
+   bench_sink += (uint32_t)value;
+   config_file_free(conf);
+   return value == 1999;
+}
+
+static bool bench_rjson(void *data)
+{
+   enum rjson_type type;
+   unsigned tokens   = 0;
+   bench_buffer_t *b = (bench_buffer_t*)data;
+   rjson_t *json     = rjson_open_buffer(b->data, b->len);
+
+   if (!json)
+      return false;
+
+   while ((type = rjson_next(json)) != RJSON_DONE && type != RJSON_ERROR)
+      tokens++;
+
+   rjson_free(json);
+   bench_sink += tokens;
+   return type == RJSON_DONE;
+}
+
+/* Input generation */
+
+static void bench_gen_audio(bench_audio_t *a, size_t samples)
+{
+   size_t i;
+
+   a->samples = samples;
+   a->s16     = (int16_t*)malloc(samples * sizeof(int16_t));
+   a->in      = (float*)malloc(samples * sizeof(float));
+   a->out     = (float*)malloc(samples * sizeof(float));
+
+   if (!a->s16 || !a->in || !a->out)
+      return;
+
+   /* Two tones plus a little noise, in range for both formats */
+   for (i = 0; i < samples; i++)
+   {
+      double t  = (double)(i >> 1) / 44100.0;
+      a->in[i]  = (float)(0.4 * sin(2.0 * M_PI * 440.0 * t)
+            + 0.3 * sin(2.0 * M_PI * 3520.0 * t)
+            + 0.05 * ((double)(bench_rand() & 0xffff) / 65536.0 - 0.5));
+      a->s16[i] = (int16_t)(a->in[i] * 0x7fff);
+   }
+}
+
+static void bench_gen_pixels(uint8_t *buf, size_t len)
+{
+   size_t i;
+   /* Gradients with noise in the low bits: compressible,
+    * but not trivially */
+   for (i = 0; i < len; i++)
+      buf[i] = (uint8_t)((i * 7 / 13) ^ (bench_rand() & 0x7));
+}
+
+static char *bench_gen_config(size_t *len)
+{
+   unsigned i;
+   size_t pos = 0;
+   size_t cap = BENCH_CONFIG_ENTRIES * 80 + 1;
+   char *s    = (char*)malloc(cap);
+
+   if (!s)
+      return NULL;
+
+   for (i = 0; i < BENCH_CONFIG_ENTRIES; i++)
+   {
+      switch (i % 4)
+      {
+         case 0:
+            pos += snprintf(s + pos, cap - pos,
+                  "bench_path_%u = \"~/retroarch/system/dir_%u\"\n", i, i);
+            break;
+         case 1:
+            pos += snprintf(s + pos, cap - pos,
+                  "# comment line %u\nbench_bool_%u = \"true\"\n", i, i);
+            break;
+         default:
+            pos += snprintf(s + pos, cap - pos,
+                  "bench_entry_%u = \"%u\"\n", i, i);
+            break;
+      }
+   }
+
+   /* Looked up by bench_config_file() */
+   pos += snprintf(s + pos, cap - pos, "bench_entry_1999 = \"1999\"\n");
+
+   *len = pos;
+   return s;
+}
+
+static char *bench_gen_json(size_t *len)
+{
+   unsigned i;
+   size_t pos = 0;
+   size_t cap = BENCH_JSON_ENTRIES * 320 + 64;
+   char *s    = (char*)malloc(cap);
+
+   if (!s)
+      return NULL;
+
+   /* Shaped like a playlist */
+   pos += snprintf(s + pos, cap - pos,
+         "{\n  \"version\": \"1.5\",\n  \"items\": [\n");
+
+   for (i = 0; i < BENCH_JSON_ENTRIES; i++)
+      pos += snprintf(s + pos, cap - pos,
+            "    {\n"
+            "      \"path\": \"/roms/system/Game Title %u (Region) (Rev %u).zip#game.bin\",\n"
+            "      \"label\": \"Game Title %u (Region) \\u00e9\",\n"
+            "      \"core_path\": \"DETECT\",\n"
+            "      \"core_name\": \"DETECT\",\n"
+            "      \"crc32\": \"%08X|crc\",\n"
+            "      \"runtime\": %u.%02u,\n"
+            "      \"favorite\": %s\n"
+            "    }%s\n",
+            i, i % 3, i, bench_rand(), i, i % 100,
+            (i & 1) ? "true" : "false",
+            (i + 1 < BENCH_JSON_ENTRIES) ? "," : "");
+
+   pos += snprintf(s + pos, cap - pos, "  ]\n}\n");
+
+   *len = pos;
+   return s;
+}
+
+static bool bench_load_file(const char *path, bench_buffer_t *b)
+{
+   int64_t len = 0;
+   void *buf   = NULL;
+
+   if (!path || !filestream_read_file(path, &buf, &len) || len <= 0)
+      return false;
+
+   b->data = buf;
+   b->len  = (size_t)len;
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned n;
+   char rzip_path[PATH_MAX_LENGTH];
+   bench_options_t opts;
+   const char *jpeg_path  = NULL;
+   const char *tmp_dir    = ".";
+   bench_audio_t audio;
+   bench_resampler_t resamplers[BENCH_MAX_RESAMPLERS];
+   unsigned num_resamplers = 0;
+   bench_pixconv_t pixconv[BENCH_MAX_PIXCONV];
+   unsigned num_pixconv   = 0;
+   bench_scaler_t scalers[BENCH_MAX_SCALERS];
+   bench_buffer_t png, jpeg, crc, rzip, config, json;
+   bench_t benches[BENCH_MAX_BENCHES];
+   const char *skipped[BENCH_MAX_BENCHES];
+   unsigned num_benches   = 0;
+   unsigned num_skipped   = 0;
+   uint64_t simd          = cpu_features_get();
+   size_t image_pixels    = BENCH_IMAGE_WIDTH * BENCH_IMAGE_HEIGHT;
+   uint8_t *pixels_in     = (uint8_t*)malloc(image_pixels * 4);
+   uint8_t *pixels_out    = (uint8_t*)malloc(image_pixels * 4 * 4);
+   float *resampled       = NULL;
+   uint8_t *scale_in      = (uint8_t*)malloc(BENCH_SCALE_SIZE);
+   uint8_t *scale_out     = (uint8_t*)malloc(BENCH_SCALE_SIZE * 2);
+   const char **filters   = (const char**)calloc(argc, sizeof(*filters));
+   int ret                = 0;
+
+   memset(&audio, 0, sizeof(audio));
+   memset(resamplers, 0, sizeof(resamplers));
+   memset(scalers, 0, sizeof(scalers));
+   memset(&png, 0, sizeof(png));
+   memset(&jpeg, 0, sizeof(jpeg));
+   memset(&crc, 0, sizeof(crc));
+   memset(&rzip, 0, sizeof(rzip));
+   memset(&config, 0, sizeof(config));
+   memset(&json, 0, sizeof(json));
+
+   if (!pixels_in || !pixels_out || !scale_in || !scale_out || !filters)
+      return 1;
+
+   bench_options_init(&opts, filters);
+
+   for (i = 1; i < argc; i++)
+   {
+      if (bench_parse_option(&opts, argc, argv, &i))
+         continue;
+      else if (!strcmp(argv[i], "--jpeg") && i + 1 < argc)
+         jpeg_path = argv[++i];
+      else if (!strcmp(argv[i], "--tmp") && i + 1 < argc)
+         tmp_dir   = argv[++i];
+      else
+      {
+         bench_usage(argv[0],
+               "  --jpeg <path>    JPEG image to decode (skipped without one)\n"
+               "  --tmp <dir>      directory for the rzip file (default .)\n");
+         return 1;
+      }
+   }
+
+   bench_options_finish(&opts);
+
+   /* Audio, stereo at 44.1 kHz */
+   convert_s16_to_float_init_simd();
+   convert_float_to_s16_init_simd();
+   bench_gen_audio(&audio, BENCH_AUDIO_FRAMES * 2);
+   /* Room for the output at 48 kHz, twice: C and SIMD */
+   resampled = (float*)malloc(BENCH_AUDIO_FRAMES * 2 * 2 * 2 * sizeof(float));
+
+   if (!audio.s16 || !audio.in || !audio.out || !resampled)
+      return 1;
+
+   BENCH_ADD("convert_s16_to_float", "default", bench_s16_to_float,
+         &audio, audio.samples * sizeof(int16_t));
+   BENCH_ADD("convert_float_to_s16", "default", bench_float_to_s16,
+         &audio, audio.samples * sizeof(float));
+   BENCH_ADD("audio_mix_volume", "c", bench_audio_mix_c,
+         &audio, audio.samples * sizeof(float));
+   BENCH_ADD("audio_mix_volume", "default", bench_audio_mix,
+         &audio, audio.samples * sizeof(float));
+
+   /* Every sinc quality with the C and the SIMD kernel, the
+    * latter fails if its output strays from the former */
+   {
+      static const struct
+      {
+         const char *variant;
+         const retro_resampler_t *backend;
+         enum resampler_quality quality;
+         bool simd;
+      } kinds[] = {
+         { "sinc_lowest_c",     &sinc_resampler, RESAMPLER_QUALITY_LOWEST,  false },
+         { "sinc_lowest_simd",  &sinc_resampler, RESAMPLER_QUALITY_LOWEST,  true  },
+         { "sinc_lower_c",      &sinc_resampler, RESAMPLER_QUALITY_LOWER,   false },
+         { "sinc_lower_simd",   &sinc_resampler, RESAMPLER_QUALITY_LOWER,   true  },
+         { "sinc_normal_c",     &sinc_resampler, RESAMPLER_QUALITY_NORMAL,  false },
+         { "sinc_normal_simd",  &sinc_resampler, RESAMPLER_QUALITY_NORMAL,  true  },
+         { "sinc_higher_c",     &sinc_resampler, RESAMPLER_QUALITY_HIGHER,  false },
+         { "sinc_higher_simd",  &sinc_resampler, RESAMPLER_QUALITY_HIGHER,  true  },
+         { "sinc_highest_c",    &sinc_resampler, RESAMPLER_QUALITY_HIGHEST, false },
+         { "sinc_highest_simd", &sinc_resampler, RESAMPLER_QUALITY_HIGHEST, true  },
+         { "nearest",           &nearest_resampler, RESAMPLER_QUALITY_NORMAL, true },
+#ifdef HAVE_CC_RESAMPLER
+         { "cc",                &CC_resampler,   RESAMPLER_QUALITY_NORMAL,  true  },
+#endif
+      };
+      struct resampler_config config;
+      bench_resampler_t *ref = NULL;
+
+      memset(&config, 0, sizeof(config));
+
+      for (n = 0; n < ARRAY_SIZE(kinds); n++)
+      {
+         bench_resampler_t *r = &resamplers[num_resamplers];
+
+         r->backend = kinds[n].backend;
+         r->in      = audio.in;
+         r->out     = resampled;
+         r->frames  = BENCH_AUDIO_FRAMES;
+         r->ratio   = 48000.0 / 44100.0;
+         r->ok      = true;
+         r->handle  = r->backend->init(&config, r->ratio,
+               kinds[n].quality, kinds[n].simd ? simd : 0);
+
+         if (!r->handle)
+         {
+            skipped[num_skipped++] = "audio_resampler";
+            ref = NULL;
+            continue;
+         }
+
+         num_resamplers++;
+
+         /* Each SIMD entry directly follows its C one */
+         if (!kinds[n].simd)
+            ref     = r;
+         else if (ref)
+         {
+            r->ok   = bench_resampler_check(ref, r,
+                  resampled + BENCH_AUDIO_FRAMES * 2 * 2);
+            ref     = NULL;
+         }
+
+         BENCH_ADD("audio_resampler", kinds[n].variant, bench_resampler,
+               r, BENCH_AUDIO_FRAMES * 2 * sizeof(float));
+      }
+   }
+
+   /* Pixel conversions, VGA frame */
+   bench_gen_pixels(pixels_in, image_pixels * 4);
+
+   {
+      static const struct
+      {
+         const char *name;
+         bench_conv_fn_t conv;
+         int in_bpp;
+         int out_bpp;
+      } convs[] = {
+         { "conv_0rgb1555_argb8888",  conv_0rgb1555_argb8888,  2, 4 },
+         { "conv_0rgb1555_rgb565",    conv_0rgb1555_rgb565,    2, 2 },
+         { "conv_0rgb1555_bgr24",     conv_0rgb1555_bgr24,     2, 3 },
+         { "conv_rgb565_0rgb1555",    conv_rgb565_0rgb1555,    2, 2 },
+         { "conv_rgb565_abgr8888",    conv_rgb565_abgr8888,    2, 4 },
+         { "conv_rgb565_argb8888",    conv_rgb565_argb8888,    2, 4 },
+         { "conv_rgb565_bgr24",       conv_rgb565_bgr24,       2, 3 },
+         { "conv_rgba4444_argb8888",  conv_rgba4444_argb8888,  2, 4 },
+         { "conv_rgba4444_rgb565",    conv_rgba4444_rgb565,    2, 2 },
+         { "conv_bgr24_argb8888",     conv_bgr24_argb8888,     3, 4 },
+         { "conv_bgr24_rgb565",       conv_bgr24_rgb565,       3, 2 },
+         { "conv_argb8888_0rgb1555",  conv_argb8888_0rgb1555,  4, 2 },
+         { "conv_argb8888_rgba4444",  conv_argb8888_rgba4444,  4, 2 },
+         { "conv_argb8888_rgb565",    conv_argb8888_rgb565,    4, 2 },
+         { "conv_argb8888_bgr24",     conv_argb8888_bgr24,     4, 3 },
+         { "conv_argb8888_abgr8888",  conv_argb8888_abgr8888,  4, 4 },
+         { "conv_abgr8888_bgr24",     conv_abgr8888_bgr24,     4, 3 },
+         { "conv_yuyv_argb8888",      conv_yuyv_argb8888,      2, 4 }
+      };
+      /* Each level includes the ones before it */
+      static const struct
+      {
+         const char *variant;
+         uint64_t simd;
+      } levels[] = {
+         { "c",     0 },
+         { "sse2",  RETRO_SIMD_MMX | RETRO_SIMD_SSE | RETRO_SIMD_SSE2 },
+         { "ssse3", RETRO_SIMD_MMX | RETRO_SIMD_SSE | RETRO_SIMD_SSE2
+            | RETRO_SIMD_SSE3 | RETRO_SIMD_SSSE3 },
+         { "avx2",  RETRO_SIMD_MMX | RETRO_SIMD_SSE | RETRO_SIMD_SSE2
+            | RETRO_SIMD_SSE3 | RETRO_SIMD_SSSE3 | RETRO_SIMD_AVX
+            | RETRO_SIMD_AVX2 },
+         { "neon",  RETRO_SIMD_NEON }
+      };
+      uint8_t *ref   = pixels_out + image_pixels * 4 * 2;
+      uint8_t *check = pixels_out + image_pixels * 4 * 3;
+
+      for (n = 0; n < ARRAY_SIZE(convs); n++)
+      {
+         unsigned l, y;
+         size_t row  = (BENCH_IMAGE_WIDTH - 2) * convs[n].out_bpp;
+         int pitch   = BENCH_IMAGE_WIDTH * convs[n].out_bpp;
+
+         for (l = 0; l < ARRAY_SIZE(levels); l++)
+         {
+            bench_pixconv_t *p = &pixconv[num_pixconv];
+
+            if ((levels[l].simd & simd) != levels[l].simd)
+               continue;
+
+            p->conv    = convs[n].conv;
+            p->in      = pixels_in;
+            p->out     = pixels_out;
+            p->in_bpp  = convs[n].in_bpp;
+            p->out_bpp = convs[n].out_bpp;
+            p->simd    = levels[l].simd;
+            p->ok      = true;
+
+            bench_pixconv_check(p, (l == 0) ? ref : check);
+
+            if (l > 0)
+               for (y = 0; y < BENCH_IMAGE_HEIGHT; y++)
+                  if (memcmp(ref + y * pitch, check + y * pitch, row))
+                     p->ok = false;
+
+            num_pixconv++;
+            BENCH_ADD(convs[n].name, levels[l].variant,
+                  bench_pixconv, p, image_pixels * p->in_bpp);
+         }
+      }
+   }
+
+   /* Upscales as for the video filters and software screenshots,
+    * downscales as for recording. Each also runs split into bands
+    * over the cores, which must not change the output. */
+   {
+      static const struct
+      {
+         const char *variant;
+         const char *variant_threaded;
+         enum scaler_type type;
+         enum scaler_pix_fmt in_fmt;
+         enum scaler_pix_fmt out_fmt;
+         int in_width, in_height;
+         int out_width, out_height;
+      } cases[] = {
+         { "point", "point_threaded", SCALER_TYPE_POINT,
+            SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, 320, 240, 1280, 960 },
+         { "bilinear", "bilinear_threaded", SCALER_TYPE_BILINEAR,
+            SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, 320, 240, 1280, 960 },
+         { "sinc", "sinc_threaded", SCALER_TYPE_SINC,
+            SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, 320, 240, 1280, 960 },
+         { "bilinear_rgb565", "bilinear_rgb565_threaded", SCALER_TYPE_BILINEAR,
+            SCALER_FMT_RGB565, SCALER_FMT_ARGB8888, 320, 240, 1920, 1080 },
+         { "bilinear_bgr24", "bilinear_bgr24_threaded", SCALER_TYPE_BILINEAR,
+            SCALER_FMT_ARGB8888, SCALER_FMT_BGR24, 640, 480, 1920, 1080 },
+         { "bilinear_down", "bilinear_down_threaded", SCALER_TYPE_BILINEAR,
+            SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, 1920, 1080, 1279, 719 },
+         { "sinc_down", "sinc_down_threaded", SCALER_TYPE_SINC,
+            SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, 1920, 1080, 640, 360 }
+      };
+      /* At least two, so the band split is checked everywhere */
+      unsigned threads = cpu_features_get_core_amount();
+      if (threads < 2)
+         threads = 2;
+
+      bench_gen_pixels(scale_in, BENCH_SCALE_SIZE);
+
+      for (n = 0; n < ARRAY_SIZE(cases); n++)
+      {
+         unsigned t;
+         size_t in_size  = (size_t)cases[n].in_width * cases[n].in_height
+            * bench_scaler_bpp(cases[n].in_fmt);
+         size_t out_size = (size_t)cases[n].out_width * cases[n].out_height
+            * bench_scaler_bpp(cases[n].out_fmt);
+
+         for (t = 0; t < 2; t++)
+         {
+            bench_scaler_t *sc = &scalers[n * 2 + t];
+
+            sc->ctx.in_width    = cases[n].in_width;
+            sc->ctx.in_height   = cases[n].in_height;
+            sc->ctx.in_stride   = cases[n].in_width
+               * bench_scaler_bpp(cases[n].in_fmt);
+            sc->ctx.out_width   = cases[n].out_width;
+            sc->ctx.out_height  = cases[n].out_height;
+            sc->ctx.out_stride  = cases[n].out_width
+               * bench_scaler_bpp(cases[n].out_fmt);
+            sc->ctx.in_fmt      = cases[n].in_fmt;
+            sc->ctx.out_fmt     = cases[n].out_fmt;
+            sc->ctx.scaler_type = cases[n].type;
+            sc->ctx.threads     = t ? threads : 1;
+            sc->in              = scale_in;
+            sc->out             = scale_out + (t ? out_size : 0);
+            sc->ok              = true;
+
+            if (!scaler_ctx_gen_filter(&sc->ctx))
+            {
+               skipped[num_skipped++] = "scaler_ctx_scale";
+               sc->ok = false;
+               continue;
+            }
+
+            scaler_ctx_scale(&sc->ctx, sc->out, sc->in);
+
+            if (t)
+               sc->ok = sc[-1].ok && !memcmp(scale_out,
+                     scale_out + out_size, out_size);
+
+            BENCH_ADD("scaler_ctx_scale",
+                  t ? cases[n].variant_threaded : cases[n].variant,
+                  bench_scaler, sc, in_size);
+         }
+      }
+   }
+
+   /* Formats; byte counts are of the encoded input */
+   {
+      uint64_t bytes = 0;
+      png.data       = rpng_save_image_bgr24_string(pixels_in,
+            BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT,
+            BENCH_IMAGE_WIDTH * 3, &bytes);
+      png.len        = (size_t)bytes;
+   }
+
+   if (png.data)
+      BENCH_ADD("rpng_decode", "default", bench_rpng, &png, png.len);
+   else
+      skipped[num_skipped++] = "rpng_decode";
+
+   if (bench_load_file(jpeg_path, &jpeg))
+      BENCH_ADD("rjpeg_decode", "default", bench_rjpeg, &jpeg, jpeg.len);
+   else
+      skipped[num_skipped++] = "rjpeg_decode";
+
+   crc.len  = BENCH_CRC_SIZE;
+   crc.data = malloc(crc.len);
+   if (crc.data)
+   {
+      bench_gen_pixels((uint8_t*)crc.data, crc.len);
+      BENCH_ADD("encoding_crc32", "default", bench_crc32, &crc, crc.len);
+   }
+
+   snprintf(rzip_path, sizeof(rzip_path), "%s/bench_kernels.rzip",
+         tmp_dir);
+   rzip.len  = BENCH_RZIP_SIZE;
+   rzip.data = malloc(rzip.len);
+   rzip.path = rzip_path;
+   if (rzip.data)
+   {
+      bench_gen_pixels((uint8_t*)rzip.data, rzip.len);
+      BENCH_ADD("rzip_write", "default", bench_rzip_write, &rzip, rzip.len);
+      BENCH_ADD("rzip_read", "default", bench_rzip_read, &rzip, rzip.len);
+   }
+
+   if ((config.data = bench_gen_config(&config.len)))
+      BENCH_ADD("config_file_parse", "default", bench_config_file,
+            &config, config.len);
+
+   if ((json.data = bench_gen_json(&json.len)))
+      BENCH_ADD("rjson_parse", "default", bench_rjson, &json, json.len);
+
+   ret = bench_run_all(stdout, &opts, benches, num_benches,
+         skipped, num_skipped);
+
+   /* Cleanup */
+   remove(rzip_path);
+
+   for (n = 0; n < num_resamplers; n++)
+      resamplers[n].backend->free(resamplers[n].handle);
+   for (n = 0; n < ARRAY_SIZE(scalers); n++)
+      scaler_ctx_gen_reset(&scalers[n].ctx);
+
+   free(audio.s16);
+   free(audio.in);
+   free(audio.out);
+   free(resampled);
+   free(pixels_in);
+   free(pixels_out);
+   free(scale_in);
+   free(scale_out);
+   free(png.data);
+   free(jpeg.data);
+   free(crc.data);
+   free(rzip.data);
+   free(config.data);
+   free(json.data);
+   free((void*)filters);
+
+   return ret;
+}
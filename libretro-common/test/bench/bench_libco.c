@@ -0,0 +1,205 @@
+/* Copyright  (C) 2010-2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_libco.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Cost of a libco context switch, see Makefile.bench.
+ *
+ * Built once per backend: the backends all define the same
+ * symbols, so each one gets its own binary and BENCH_LIBCO_BACKEND
+ * names it in the report. 'libco' is the auto-selected one.
+ *
+ * Before timing, a switch ping-pong with integer and floating
+ * point state live on both sides checks that the backend keeps
+ * the callee-saved registers the ABI asks for. Timing follows
+ * bench_kernels: calibrated to --min-ms, median of --repeat. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <libco.h>
+#include <features/features_cpu.h>
+
+#ifndef BENCH_LIBCO_BACKEND
+#define BENCH_LIBCO_BACKEND "libco"
+#endif
+
+#define BENCH_VERSION      1
+#define BENCH_MAX_REPEAT   31
+#define BENCH_CHECK_ROUNDS 1000
+#define BENCH_STACK_SIZE   (64 * 1024)
+
+static cothread_t bench_main;
+static cothread_t bench_co;
+static volatile double bench_check_value;
+
+static void bench_entry(void)
+{
+   for (;;)
+      co_switch(bench_main);
+}
+
+/* Clobbers everything it can between switches, so values the
+ * main side keeps in registers only survive if the switch
+ * restores them */
+static void bench_check_entry(void)
+{
+   unsigned i;
+   double f = 0.5;
+
+   for (i = 0; ; i++)
+   {
+      f = f * 1.000001 + (double)i;
+      bench_check_value = f;
+      co_switch(bench_main);
+   }
+}
+
+static bool bench_check(void)
+{
+   unsigned i;
+   double f                   = 1.0;
+   double f_expected          = 1.0;
+   unsigned long sum          = 0;
+   unsigned long sum_expected = 0;
+   cothread_t co              = co_create(BENCH_STACK_SIZE,
+         bench_check_entry);
+
+   if (!co)
+      return false;
+
+   for (i = 0; i < BENCH_CHECK_ROUNDS; i++)
+   {
+      f   = f * 0.999999 + 0.25;
+      sum = sum * 31 + i;
+      co_switch(co);
+   }
+
+   co_delete(co);
+
+   for (i = 0; i < BENCH_CHECK_ROUNDS; i++)
+   {
+      f_expected   = f_expected * 0.999999 + 0.25;
+      sum_expected = sum_expected * 31 + i;
+   }
+
+   return f == f_expected && sum == sum_expected;
+}
+
+static int bench_compare_time(const void *a, const void *b)
+{
+   retro_time_t x = *(const retro_time_t*)a;
+   retro_time_t y = *(const retro_time_t*)b;
+   return (x > y) - (x < y);
+}
+
+/* One iteration is a round trip, i.e. two switches */
+static retro_time_t bench_time(unsigned long iterations)
+{
+   unsigned long i;
+   retro_time_t start = cpu_features_get_time_usec();
+
+   for (i = 0; i < iterations; i++)
+      co_switch(bench_co);
+
+   return cpu_features_get_time_usec() - start;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned r;
+   char model[64];
+   double median_ns, min_ns;
+   retro_time_t times[BENCH_MAX_REPEAT];
+   unsigned long iterations = 1;
+   unsigned repeat          = 5;
+   unsigned min_ms          = 100;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "--repeat") && i + 1 < argc)
+         repeat = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "--min-ms") && i + 1 < argc)
+         min_ms = (unsigned)atoi(argv[++i]);
+      else
+      {
+         fprintf(stderr,
+               "Usage: %s [options]\n"
+               "\n"
+               "  --repeat <n>     timed repeats (default 5, max %d)\n"
+               "  --min-ms <ms>    minimum duration of one repeat (default 100)\n",
+               argv[0], BENCH_MAX_REPEAT);
+         return 1;
+      }
+   }
+
+   if (repeat < 1)
+      repeat = 1;
+   else if (repeat > BENCH_MAX_REPEAT)
+      repeat = BENCH_MAX_REPEAT;
+
+   bench_main = co_active();
+
+   if (!bench_check())
+   {
+      fprintf(stderr, "%s: callee-saved registers not preserved\n",
+            BENCH_LIBCO_BACKEND);
+      return 1;
+   }
+
+   if (!(bench_co = co_create(BENCH_STACK_SIZE, bench_entry)))
+      return 1;
+
+   /* Warm up, then calibrate */
+   bench_time(1000);
+
+   while (     bench_time(iterations) < (retro_time_t)min_ms * 1000
+            && iterations < (1UL << 28))
+      iterations <<= 1;
+
+   for (r = 0; r < repeat; r++)
+      times[r] = bench_time(iterations);
+
+   qsort(times, repeat, sizeof(times[0]), bench_compare_time);
+
+   median_ns = (double)times[repeat / 2] * 1000.0 / (iterations * 2);
+   min_ns    = (double)times[0] * 1000.0 / (iterations * 2);
+
+   model[0]  = '\0';
+   cpu_features_get_model_name(model, sizeof(model));
+
+   printf("{\n");
+   printf("  \"version\": %d,\n", BENCH_VERSION);
+   printf("  \"cpu\": \"%s\",\n", model);
+   printf("  \"repeat\": %u,\n", repeat);
+   printf("  \"results\": [\n");
+   printf("    {\"name\": \"co_switch\", \"variant\": \"%s\", "
+         "\"iterations\": %lu, "
+         "\"median_ns\": %.1f, \"min_ns\": %.1f}\n",
+         BENCH_LIBCO_BACKEND, iterations * 2, median_ns, min_ns);
+   printf("  ]\n}\n");
+
+   co_delete(bench_co);
+
+   return 0;
+}
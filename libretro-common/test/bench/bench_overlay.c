@@ -0,0 +1,251 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Overlay hit testing cost, see frontend.mk.
+ *
+ * Tests touches against the hitboxes of a generated overlay,
+ * the way input_overlay_poll() does. The overlay has rect and
+ * radial hitboxes, some pressed (and so enlarged), some reaching
+ * past the edges. The touches are spread over and around the
+ * overlay, plus the edges of every hitbox.
+ *
+ * 'scan' tests every descriptor, 'grid' only the candidates
+ * from input_overlay_hit_grid_candidates(). The descriptors hit
+ * by every touch go into a digest. Both variants fail if theirs
+ * differs from the one 'scan' gave before timing started. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+
+#include "../../../input/input_overlay.h"
+
+#define BENCH_OVERLAY_DESCS 48
+#define BENCH_OVERLAY_STEPS 256
+
+typedef struct bench_overlay
+{
+   struct overlay ol;
+   struct overlay_desc descs[BENCH_OVERLAY_DESCS];
+   float *points;
+   size_t num_points;
+   uint32_t seed;
+   uint32_t digest;
+   uint32_t expected;
+} bench_overlay_t;
+
+static void bench_overlay_hash(bench_overlay_t *b, uint32_t value)
+{
+   /* FNV-1a */
+   unsigned i;
+   for (i = 0; i < 4; i++)
+      b->digest = (b->digest ^ ((value >> (i * 8)) & 0xff)) * 16777619u;
+}
+
+/* In [0, 1) */
+static float bench_overlay_rand(bench_overlay_t *b)
+{
+   b->seed ^= b->seed << 13;
+   b->seed ^= b->seed >> 17;
+   b->seed ^= b->seed << 5;
+   return (float)(b->seed >> 8) / (float)(1 << 24);
+}
+
+/* Same as inside_hitbox() in retroarch.c */
+static bool bench_overlay_inside_hitbox(const struct overlay_desc *desc,
+      float x, float y)
+{
+   switch (desc->hitbox)
+   {
+      case OVERLAY_HITBOX_RADIAL:
+      {
+         /* Ellipsis. */
+         float x_dist  = (x - desc->x_shift) / desc->range_x_mod;
+         float y_dist  = (y - desc->y_shift) / desc->range_y_mod;
+         float sq_dist = x_dist * x_dist + y_dist * y_dist;
+         return (sq_dist <= 1.0f);
+      }
+
+      case OVERLAY_HITBOX_RECT:
+         return
+            (fabs(x - desc->x_shift) <= desc->range_x_mod) &&
+            (fabs(y - desc->y_shift) <= desc->range_y_mod);
+   }
+
+   return false;
+}
+
+static void bench_overlay_add_point(bench_overlay_t *b, float x, float y)
+{
+   b->points[2 * b->num_points + 0] = x;
+   b->points[2 * b->num_points + 1] = y;
+   b->num_points++;
+}
+
+static bool bench_overlay_init(bench_overlay_t *b)
+{
+   unsigned i, j;
+
+   memset(b, 0, sizeof(*b));
+   b->seed = 0x12345678;
+
+   if (!(b->points = (float*)malloc((BENCH_OVERLAY_STEPS
+                  * BENCH_OVERLAY_STEPS + 4 * BENCH_OVERLAY_DESCS)
+               * 2 * sizeof(float))))
+      return false;
+
+   for (i = 0; i < BENCH_OVERLAY_DESCS; i++)
+   {
+      struct overlay_desc *desc = &b->descs[i];
+
+      desc->hitbox      = (i & 1) ? OVERLAY_HITBOX_RADIAL : OVERLAY_HITBOX_RECT;
+      desc->x_shift     = -0.1f + 1.2f * bench_overlay_rand(b);
+      desc->y_shift     = -0.1f + 1.2f * bench_overlay_rand(b);
+      desc->range_x     = 0.01f + 0.14f * bench_overlay_rand(b);
+      desc->range_y     = 0.01f + 0.14f * bench_overlay_rand(b);
+      desc->range_mod   = 0.5f + 1.5f * bench_overlay_rand(b);
+      desc->range_x_mod = desc->range_x;
+      desc->range_y_mod = desc->range_y;
+
+      /* As input_overlay_post_poll() enlarges the pressed ones */
+      if (i % 3 == 0)
+      {
+         desc->range_x_mod *= desc->range_mod;
+         desc->range_y_mod *= desc->range_mod;
+      }
+   }
+
+   b->ol.descs = b->descs;
+   b->ol.size  = BENCH_OVERLAY_DESCS;
+   input_overlay_build_hit_grid(&b->ol);
+
+   if (!b->ol.hit_grid_cells)
+      return false;
+
+   for (i = 0; i < BENCH_OVERLAY_STEPS; i++)
+      for (j = 0; j < BENCH_OVERLAY_STEPS; j++)
+         bench_overlay_add_point(b,
+               -0.1f + 1.2f * j / BENCH_OVERLAY_STEPS,
+               -0.1f + 1.2f * i / BENCH_OVERLAY_STEPS);
+
+   /* Right on the edges, where rounding could put
+    * a touch in the next cell over */
+   for (i = 0; i < BENCH_OVERLAY_DESCS; i++)
+   {
+      const struct overlay_desc *desc = &b->descs[i];
+
+      bench_overlay_add_point(b,
+            desc->x_shift - desc->range_x_mod, desc->y_shift);
+      bench_overlay_add_point(b,
+            desc->x_shift + desc->range_x_mod, desc->y_shift);
+      bench_overlay_add_point(b,
+            desc->x_shift, desc->y_shift - desc->range_y_mod);
+      bench_overlay_add_point(b,
+            desc->x_shift, desc->y_shift + desc->range_y_mod);
+   }
+
+   return true;
+}
+
+static bool bench_overlay_poll(bench_overlay_t *b, bool grid)
+{
+   size_t p;
+
+   b->digest = 2166136261u;
+
+   for (p = 0; p < b->num_points; p++)
+   {
+      size_t i;
+      size_t count;
+      float x                    = b->points[2 * p + 0];
+      float y                    = b->points[2 * p + 1];
+      const unsigned *candidates = grid
+         ? input_overlay_hit_grid_candidates(&b->ol, x, y, &count) : NULL;
+
+      if (!candidates)
+         count = b->ol.size;
+
+      for (i = 0; i < count; i++)
+      {
+         unsigned idx = candidates ? candidates[i] : (unsigned)i;
+
+         if (bench_overlay_inside_hitbox(&b->ol.descs[idx], x, y))
+            bench_overlay_hash(b, idx);
+      }
+
+      bench_overlay_hash(b, 0xffffffff);
+   }
+
+   return b->digest == b->expected;
+}
+
+static bool bench_overlay_scan(void *data)
+{
+   return bench_overlay_poll((bench_overlay_t*)data, false);
+}
+
+static bool bench_overlay_grid(void *data)
+{
+   return bench_overlay_poll((bench_overlay_t*)data, true);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   bench_options_t opts;
+   bench_t benches[2];
+   const char *skipped[2];
+   unsigned num_benches  = 0;
+   const char **filters  = (const char**)calloc(argc, sizeof(*filters));
+   bench_overlay_t *b    = (bench_overlay_t*)calloc(1, sizeof(*b));
+   int ret               = 0;
+
+   if (!filters || !b)
+      return 1;
+
+   bench_options_init(&opts, filters);
+
+   for (i = 1; i < argc; i++)
+   {
+      if (bench_parse_option(&opts, argc, argv, &i))
+         continue;
+      bench_usage(argv[0], NULL);
+      return 1;
+   }
+
+   bench_options_finish(&opts);
+
+   if (!bench_overlay_init(b))
+      return 1;
+
+   /* Testing every descriptor gives the expected digest */
+   bench_overlay_scan(b);
+   b->expected = b->digest;
+
+   BENCH_ADD("overlay_poll", "scan", bench_overlay_scan, b, 0);
+   BENCH_ADD("overlay_poll", "grid", bench_overlay_grid, b, 0);
+
+   ret = bench_run_all(stdout, &opts, benches, num_benches, skipped, 0);
+
+   free(b->ol.hit_grid_cells);
+   free(b->ol.hit_grid_descs);
+   free(b->points);
+   free(b);
+   free(filters);
+
+   return ret;
+}
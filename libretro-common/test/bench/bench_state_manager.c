@@ -0,0 +1,342 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Rewind buffer throughput, see frontend.mk.
+ *
+ * Feeds a sequence of savestates through the rewind buffer.
+ * 'state_manager_push' measures steady state recording, where
+ * the buffer is full and every push evicts the oldest patch.
+ * 'state_manager_rewind' records the whole sequence into an
+ * empty buffer, rewinds all the way back and checks every
+ * state comes back intact.
+ *
+ * Without arguments the states are synthetic: mostly static
+ * memory with a few regions rewritten every frame, one small
+ * and one large set. Real states (one file per frame, e.g.
+ * dumped with a core's serialize function) can be given with
+ * --state. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <retro_miscellaneous.h>
+#include <streams/file_stream.h>
+
+#include "bench_common.h"
+
+#include "../../../state_manager.h"
+#include "../../../msg_hash.h"
+#include "../../../retroarch.h"
+
+#define BENCH_STATE_FRAMES 60
+
+typedef struct bench_states
+{
+   const char *name;
+   uint8_t **frames;
+   size_t num_frames;
+   size_t frame_size;
+   /* Frame the next serialize hands out */
+   size_t cur_frame;
+   /* Frame the next deserialize must match */
+   size_t expect_frame;
+   unsigned mismatches;
+   unsigned buffer_size;
+   struct state_manager_rewind_state push_st;
+} bench_states_t;
+
+/* Whose frames the stubs below hand out */
+static bench_states_t *bench_cur = NULL;
+
+/* Stubs for the bits of RetroArch state_manager.c talks to */
+size_t content_get_serialized_size(void)
+{
+   return bench_cur->frame_size;
+}
+
+bool content_serialize_state(void *buffer, size_t buffer_size)
+{
+   memcpy(buffer, bench_cur->frames[bench_cur->cur_frame], buffer_size);
+   return true;
+}
+
+bool content_deserialize_state(const void *data, size_t size)
+{
+   if (memcmp(data, bench_cur->frames[bench_cur->expect_frame], size))
+      bench_cur->mismatches++;
+   return true;
+}
+
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return ""; }
+bool audio_driver_has_callback(void) { return false; }
+void audio_driver_frame_is_reverse(void) { }
+void audio_driver_setup_rewind(void) { }
+bool core_set_rewind_callbacks(void) { return true; }
+bool rarch_ctl(enum rarch_ctl_state state, void *data) { return false; }
+
+#ifndef HAVE_LOGGER
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+#endif
+
+/* Most of a core's state is memory the game doesn't touch
+ * from one frame to the next, the rest is a handful of small
+ * regions: registers, a stack, sprite tables, timers. */
+static bool bench_states_synthetic(bench_states_t *set,
+      const char *name, size_t frame_size)
+{
+   size_t f, i, j;
+   size_t active = frame_size / 4;
+
+   set->name       = name;
+   set->frame_size = frame_size;
+   set->num_frames = BENCH_STATE_FRAMES;
+   set->frames     = (uint8_t**)calloc(set->num_frames, sizeof(uint8_t*));
+
+   if (!set->frames)
+      return false;
+
+   for (f = 0; f < set->num_frames; f++)
+   {
+      if (!(set->frames[f] = (uint8_t*)malloc(frame_size)))
+         return false;
+
+      if (f == 0)
+      {
+         for (i = 0; i < frame_size; i++)
+            set->frames[f][i] = (i < active) ? (uint8_t)bench_rand() : 0;
+         continue;
+      }
+
+      memcpy(set->frames[f], set->frames[f - 1], frame_size);
+
+      for (i = 0; i < 16; i++)
+      {
+         size_t pos = bench_rand() % (active - 64);
+         for (j = 0; j < 64; j++)
+            set->frames[f][pos + j] = (uint8_t)bench_rand();
+      }
+   }
+
+   return true;
+}
+
+static bool bench_states_add_file(bench_states_t *set, const char *path)
+{
+   void *buf   = NULL;
+   int64_t len = 0;
+   uint8_t **frames;
+
+   if (!filestream_read_file(path, &buf, &len) || len <= 0)
+   {
+      fprintf(stderr, "Could not read %s\n", path);
+      return false;
+   }
+
+   if (!(frames = (uint8_t**)realloc(set->frames,
+               (set->num_frames + 1) * sizeof(*frames))))
+   {
+      free(buf);
+      return false;
+   }
+
+   set->name                      = "files";
+   set->frames                    = frames;
+   set->frames[set->num_frames++] = (uint8_t*)buf;
+
+   if ((size_t)len > set->frame_size)
+      set->frame_size             = (size_t)len;
+
+   return true;
+}
+
+/* Cores pad their states to a fixed size anyway,
+ * make short dumps match the biggest one */
+static bool bench_states_pad(bench_states_t *set)
+{
+   size_t f;
+
+   for (f = 0; f < set->num_frames; f++)
+   {
+      uint8_t *frame = (uint8_t*)realloc(set->frames[f], set->frame_size);
+      if (!frame)
+         return false;
+      set->frames[f] = frame;
+   }
+
+   return true;
+}
+
+static void bench_states_free(bench_states_t *set)
+{
+   size_t f;
+
+   bench_cur = set;
+   state_manager_event_deinit(&set->push_st);
+
+   for (f = 0; f < set->num_frames; f++)
+      free(set->frames[f]);
+   free(set->frames);
+}
+
+static bool bench_state_manager_push(void *data)
+{
+   char msg[256];
+   unsigned time       = 0;
+   bench_states_t *set = (bench_states_t*)data;
+
+   bench_cur           = set;
+
+   /* Keep the buffer full, as it is after a few minutes of play */
+   if (!set->push_st.state)
+   {
+      set->cur_frame   = 0;
+      state_manager_event_init(&set->push_st, set->buffer_size);
+      if (!set->push_st.state)
+         return false;
+   }
+
+   set->cur_frame      = (set->cur_frame + 1) % set->num_frames;
+   state_manager_check_rewind(&set->push_st, false, 1, false,
+         msg, sizeof(msg), &time);
+
+   return true;
+}
+
+static bool bench_state_manager_rewind(void *data)
+{
+   char msg[256];
+   unsigned time       = 0;
+   bench_states_t *set = (bench_states_t*)data;
+   struct state_manager_rewind_state rewind_st = {0};
+
+   bench_cur           = set;
+   set->cur_frame      = 0;
+   set->mismatches     = 0;
+
+   state_manager_event_init(&rewind_st, set->buffer_size);
+   if (!rewind_st.state)
+      return false;
+
+   for (set->cur_frame = 1; set->cur_frame < set->num_frames;
+         set->cur_frame++)
+      state_manager_check_rewind(&rewind_st, false, 1, false,
+            msg, sizeof(msg), &time);
+
+   /* Rewind until the buffer runs dry */
+   for (set->expect_frame = set->num_frames - 1;
+         rewind_st.state->entries; set->expect_frame--)
+      state_manager_check_rewind(&rewind_st, true, 1, false,
+            msg, sizeof(msg), &time);
+
+   state_manager_event_deinit(&rewind_st);
+
+   /* All of it must fit, anything else is a lost state */
+   return !set->mismatches && set->expect_frame == (size_t)-1;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned s;
+   bench_options_t opts;
+   bench_states_t sets[2];
+   struct state_manager_rewind_state prime = {0};
+   char msg[256];
+   bench_t benches[4];
+   const char *skipped[4];
+   unsigned time          = 0;
+   unsigned num_sets      = 0;
+   unsigned num_benches   = 0;
+   unsigned buffer_mb     = 64;
+   const char **filters   = (const char**)calloc(argc, sizeof(*filters));
+   int ret                = 0;
+
+   if (!filters)
+      return 1;
+
+   memset(sets, 0, sizeof(sets));
+   bench_options_init(&opts, filters);
+
+   for (i = 1; i < argc; i++)
+   {
+      if (bench_parse_option(&opts, argc, argv, &i))
+         continue;
+      else if (!strcmp(argv[i], "--buffer-mb") && i + 1 < argc)
+         buffer_mb = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "--state") && i + 1 < argc)
+      {
+         if (!bench_states_add_file(&sets[0], argv[++i]))
+            return 1;
+         num_sets = 1;
+      }
+      else
+      {
+         bench_usage(argv[0],
+               "  --buffer-mb <n>  rewind buffer size (default 64)\n"
+               "  --state <path>   savestate to use instead of synthetic\n"
+               "                   ones, give one per frame, in order\n");
+         return 1;
+      }
+   }
+
+   bench_options_finish(&opts);
+
+   if (num_sets)
+   {
+      if (sets[0].num_frames < 2 || !bench_states_pad(&sets[0]))
+      {
+         fprintf(stderr, "Need at least two states\n");
+         return 1;
+      }
+   }
+   else if (   !bench_states_synthetic(&sets[num_sets++], "64k",
+                  64 * 1024)
+            || !bench_states_synthetic(&sets[num_sets++], "1m",
+                  1024 * 1024))
+      return 1;
+
+   /* check_rewind ignores the very first call */
+   state_manager_check_rewind(&prime, false, 1, false,
+         msg, sizeof(msg), &time);
+
+   for (s = 0; s < num_sets; s++)
+   {
+      sets[s].buffer_size = buffer_mb * 1024 * 1024;
+
+      BENCH_ADD("state_manager_push", sets[s].name,
+            bench_state_manager_push, &sets[s], sets[s].frame_size);
+      BENCH_ADD("state_manager_rewind", sets[s].name,
+            bench_state_manager_rewind, &sets[s],
+            sets[s].frame_size * sets[s].num_frames * 2);
+   }
+
+   ret = bench_run_all(stdout, &opts, benches, num_benches,
+         skipped, 0);
+
+   for (s = 0; s < num_sets; s++)
+      bench_states_free(&sets[s]);
+   free(filters);
+
+   return ret;
+}
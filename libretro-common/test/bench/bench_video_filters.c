@@ -0,0 +1,363 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Softfilter throughput, see frontend.mk.
+ *
+ * Runs the filters with SIMD paths over synthetic frames, with
+ * their default parameters: once with the generic implementation
+ * ('generic'), once with the one selected for this CPU ('simd'),
+ * then with the work split into packets on a thread pool the way
+ * the frontend does it ('threaded'). The last two fail if their
+ * output differs from the generic one. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <compat/strl.h>
+#include <file/config_file.h>
+#include <file/config_file_userdata.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
+
+#include "bench_common.h"
+
+#include "../../../gfx/video_filters/softfilter.h"
+
+#define FRAME_WIDTH   256
+#define FRAME_HEIGHT  224
+#define MAX_PACKETS   256
+
+/* The filters read up to two lines and a few pixels
+ * outside the frame, as the frontend's buffers allow */
+#define FRAME_GUARD   (FRAME_WIDTH * 2 + 16)
+
+typedef const struct softfilter_implementation *
+   (*get_implementation_t)(softfilter_simd_mask_t);
+
+extern const struct softfilter_implementation *twoxsai_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *supereagle_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *lq2x_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *blargg_ntsc_snes_get_implementation(softfilter_simd_mask_t simd);
+
+static const get_implementation_t implementations[] = {
+   twoxsai_get_implementation,
+   supereagle_get_implementation,
+   lq2x_get_implementation,
+   blargg_ntsc_snes_get_implementation,
+};
+
+#define BENCH_MAX_RUNS (ARRAY_SIZE(implementations) * 2 * 3)
+
+static const struct softfilter_config bench_config = {
+   config_userdata_get_float,
+   config_userdata_get_int,
+   config_userdata_get_hex,
+   config_userdata_get_float_array,
+   config_userdata_get_int_array,
+   config_userdata_get_string,
+   config_userdata_free,
+};
+
+typedef struct bench_filter_run
+{
+   char name[64];
+   const struct softfilter_implementation *impl;
+   void *data;
+   struct softfilter_work_packet packets[MAX_PACKETS];
+   unsigned threads;
+   uint8_t *out;
+   size_t out_pitch;
+   size_t out_size;
+   void **frames;
+   size_t in_pitch;
+   unsigned frame;
+   /* Output matches the generic implementation */
+   bool ok;
+} bench_filter_run_t;
+
+#ifdef HAVE_THREADS
+static tpool_t *bench_pool = NULL;
+
+struct bench_tile
+{
+   bench_filter_run_t *run;
+   unsigned index;
+};
+
+static void bench_tile_work(void *data)
+{
+   struct bench_tile *tile = (struct bench_tile*)data;
+   struct softfilter_work_packet *packet = &tile->run->packets[tile->index];
+   packet->work(tile->run->data, packet->thread_data);
+}
+#endif
+
+/* Flat background, a banded sky, tiled patterns and a few noisy
+ * sprites, roughly the mix of a 16-bit era game screen */
+static void bench_make_frame(uint32_t *xrgb, unsigned frame)
+{
+   unsigned x, y;
+
+   for (y = 0; y < FRAME_HEIGHT; y++)
+   {
+      for (x = 0; x < FRAME_WIDTH; x++)
+      {
+         uint32_t c;
+
+         if (y < 64)
+            c = 0x204080 + ((y >> 3) << 17);
+         else if (y > 176)
+            c = ((x >> 3) + (y >> 3)) & 1 ? 0x806020 : 0x604010;
+         else
+            c = 0x50a050;
+
+         xrgb[y * FRAME_WIDTH + x] = c;
+      }
+   }
+
+   for (y = 0; y < 12; y++)
+   {
+      unsigned sx = (bench_rand() + frame) % (FRAME_WIDTH - 24);
+      unsigned sy = bench_rand() % (FRAME_HEIGHT - 24);
+      unsigned i, j;
+
+      for (j = 0; j < 24; j++)
+         for (i = 0; i < 24; i++)
+            xrgb[(sy + j) * FRAME_WIDTH + sx + i] = (bench_rand() & 3)
+               ? 0xf8f8f8 & bench_rand() : 0x000000;
+   }
+}
+
+static uint16_t bench_to_rgb565(uint32_t c)
+{
+   return (uint16_t)(((c >> 8) & 0xf800) | ((c >> 5) & 0x07e0) | ((c >> 3) & 0x001f));
+}
+
+static void bench_filter_process(bench_filter_run_t *run, const void *in)
+{
+   unsigned i;
+
+   run->impl->get_work_packets(run->data, run->packets,
+         run->out, run->out_pitch,
+         in, FRAME_WIDTH, FRAME_HEIGHT, run->in_pitch);
+
+#ifdef HAVE_THREADS
+   if (run->threads > 1 && bench_pool)
+   {
+      struct bench_tile tiles[MAX_PACKETS];
+
+      for (i = 0; i < run->threads; i++)
+      {
+         tiles[i].run   = run;
+         tiles[i].index = i;
+         tpool_add_work(bench_pool, bench_tile_work, &tiles[i]);
+      }
+      tpool_wait(bench_pool);
+      return;
+   }
+#endif
+
+   for (i = 0; i < run->threads; i++)
+      run->packets[i].work(run->data, run->packets[i].thread_data);
+}
+
+static bool bench_filter(void *data)
+{
+   bench_filter_run_t *run = (bench_filter_run_t*)data;
+   bench_filter_process(run, run->frames[run->frame++ & 7]);
+   return run->ok;
+}
+
+static bool bench_filter_create(bench_filter_run_t *run,
+      const struct softfilter_implementation *impl,
+      struct config_file_userdata *userdata, unsigned fmt,
+      unsigned threads, softfilter_simd_mask_t simd,
+      void **frames, size_t bpp)
+{
+   unsigned out_w, out_h;
+
+   run->impl      = impl;
+   run->frames    = frames;
+   run->in_pitch  = FRAME_WIDTH * bpp;
+   run->ok        = true;
+
+   if (!(run->data = impl->create(&bench_config, fmt, fmt,
+               FRAME_WIDTH, FRAME_HEIGHT, threads, simd, userdata)))
+      return false;
+
+   if ((run->threads = impl->query_num_threads(run->data)) > MAX_PACKETS)
+      return false;
+
+   impl->query_output_size(run->data, &out_w, &out_h,
+         FRAME_WIDTH, FRAME_HEIGHT);
+   run->out_pitch = out_w * bpp;
+   run->out_size  = out_h * run->out_pitch;
+
+   if (!(run->out = (uint8_t*)malloc(run->out_size)))
+      return false;
+
+   bench_filter_process(run, frames[0]);
+   return true;
+}
+
+static void bench_filter_destroy(bench_filter_run_t *run)
+{
+   if (run->data)
+      run->impl->destroy(run->data);
+   free(run->out);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned f, p, n;
+   bench_options_t opts;
+   void **frames[2];
+   bench_filter_run_t *runs     = NULL;
+   unsigned num_runs            = 0;
+   bench_t benches[BENCH_MAX_RUNS];
+   const char *skipped[BENCH_MAX_RUNS * 2];
+   unsigned num_benches         = 0;
+   unsigned num_skipped         = 0;
+   softfilter_simd_mask_t simd  = (softfilter_simd_mask_t)cpu_features_get();
+   unsigned cores               = cpu_features_get_core_amount();
+   config_file_t *conf          = config_file_new_alloc();
+   uint32_t *xrgb               = (uint32_t*)malloc(
+         FRAME_WIDTH * FRAME_HEIGHT * sizeof(uint32_t));
+   const char **filters         = (const char**)calloc(argc, sizeof(*filters));
+   int ret                      = 0;
+
+   runs = (bench_filter_run_t*)calloc(BENCH_MAX_RUNS, sizeof(*runs));
+
+   if (!conf || !xrgb || !filters || !runs)
+      return 1;
+
+   bench_options_init(&opts, filters);
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!bench_parse_option(&opts, argc, argv, &i))
+      {
+         bench_usage(argv[0], NULL);
+         return 1;
+      }
+   }
+
+   bench_options_finish(&opts);
+
+   frames[0] = (void**)calloc(8, sizeof(void*));
+   frames[1] = (void**)calloc(8, sizeof(void*));
+
+   for (f = 0; f < 8; f++)
+   {
+      uint16_t *rgb565;
+
+      bench_make_frame(xrgb, f);
+      frames[1][f] = (uint32_t*)calloc(FRAME_WIDTH * FRAME_HEIGHT
+            + 2 * FRAME_GUARD, sizeof(uint32_t)) + FRAME_GUARD;
+      frames[0][f] = (uint16_t*)calloc(FRAME_WIDTH * FRAME_HEIGHT
+            + 2 * FRAME_GUARD, sizeof(uint16_t)) + FRAME_GUARD;
+      memcpy(frames[1][f], xrgb, FRAME_WIDTH * FRAME_HEIGHT * sizeof(uint32_t));
+      rgb565 = (uint16_t*)frames[0][f];
+      for (p = 0; p < FRAME_WIDTH * FRAME_HEIGHT; p++)
+         rgb565[p] = bench_to_rgb565(xrgb[p]);
+   }
+
+#ifdef HAVE_THREADS
+   bench_pool = tpool_create(cores);
+#endif
+
+   for (n = 0; n < ARRAY_SIZE(implementations); n++)
+   {
+      const struct softfilter_implementation *generic = implementations[n](0);
+      const struct softfilter_implementation *impl    = implementations[n](simd);
+      struct config_file_userdata userdata;
+
+      /* Empty config, every parameter takes its default */
+      userdata.conf      = conf;
+      userdata.prefix[0] = "filter";
+      userdata.prefix[1] = impl->short_ident;
+
+      for (f = 0; f < 2; f++)
+      {
+         static const char *variants[3] = { "generic", "simd", "threaded" };
+         bench_filter_run_t *run = &runs[num_runs];
+         unsigned fmt = f ? SOFTFILTER_FMT_XRGB8888 : SOFTFILTER_FMT_RGB565;
+         size_t bpp   = f ? SOFTFILTER_BPP_XRGB8888 : SOFTFILTER_BPP_RGB565;
+         unsigned r;
+
+         if (!(impl->query_input_formats() & fmt))
+            continue;
+
+         num_runs += 3;
+
+         snprintf(run[0].name, sizeof(run[0].name), "softfilter_%s_%s",
+               impl->short_ident, f ? "xrgb8888" : "rgb565");
+         strlcpy(run[1].name, run[0].name, sizeof(run[1].name));
+         strlcpy(run[2].name, run[0].name, sizeof(run[2].name));
+
+         if (  !bench_filter_create(&run[0], generic, &userdata, fmt,
+                  1, 0, frames[f], bpp)
+            || !bench_filter_create(&run[1], impl, &userdata, fmt,
+                  1, simd, frames[f], bpp)
+            || !bench_filter_create(&run[2], impl, &userdata, fmt,
+                  cores * 4, simd, frames[f], bpp))
+         {
+            fprintf(stderr, "%s: failed to create filter\n", run[0].name);
+            skipped[num_skipped++] = run[0].name;
+            ret = 1;
+            continue;
+         }
+
+         for (r = 0; r < 3; r++)
+         {
+            if (r > 0)
+               run[r].ok = run[r].out_size == run[0].out_size
+                  && !memcmp(run[r].out, run[0].out, run[0].out_size);
+
+            BENCH_ADD(run[r].name, variants[r], bench_filter, &run[r],
+                  FRAME_WIDTH * FRAME_HEIGHT * bpp);
+         }
+      }
+   }
+
+   ret |= bench_run_all(stdout, &opts, benches, num_benches,
+         skipped, num_skipped);
+
+#ifdef HAVE_THREADS
+   if (bench_pool)
+      tpool_destroy(bench_pool);
+#endif
+
+   for (n = 0; n < num_runs; n++)
+      bench_filter_destroy(&runs[n]);
+
+   for (f = 0; f < 8; f++)
+   {
+      free((uint16_t*)frames[0][f] - FRAME_GUARD);
+      free((uint32_t*)frames[1][f] - FRAME_GUARD);
+   }
+   free(frames[0]);
+   free(frames[1]);
+   free(runs);
+   free(filters);
+   free(xrgb);
+   config_file_free(conf);
+
+   return ret;
+}
@@ -0,0 +1,77 @@
+# Benchmarks of RetroArch code rather than libretro-common,
+# only built from inside the RetroArch tree, see Makefile.bench
+
+BENCH_FRONTEND_DIR = ..
+BENCH_FRONTEND_CFLAGS = $(BENCH_CFLAGS) -I$(BENCH_FRONTEND_DIR)
+BENCH_FRONTEND_SRC = test/bench/bench_common.c features/features_cpu.c \
+		     rthreads/rthreads.c memmap/memalign.c \
+		     file/file_path.c file/file_path_io.c \
+		     streams/file_stream.c vfs/vfs_implementation.c \
+		     string/stdstring.c encodings/encoding_utf.c \
+		     time/rtime.c compat/compat_strl.c \
+		     compat/compat_strcasestr.c compat/compat_posix_string.c \
+		     compat/fopen_utf8.c
+
+BENCH_STATE_MANAGER = test/bench/bench_state_manager
+BENCH_STATE_MANAGER_SRC = test/bench/bench_state_manager.c \
+			  $(BENCH_FRONTEND_DIR)/state_manager.c \
+			  streams/trans_stream.c streams/trans_stream_pipe.c \
+			  streams/trans_stream_zlib.c
+
+BENCH_VIDEO_FILTERS = test/bench/bench_video_filters
+BENCH_VIDEO_FILTERS_SRC = test/bench/bench_video_filters.c \
+			  $(BENCH_FRONTEND_DIR)/gfx/video_filters/2xsai.c \
+			  $(BENCH_FRONTEND_DIR)/gfx/video_filters/supereagle.c \
+			  $(BENCH_FRONTEND_DIR)/gfx/video_filters/lq2x.c \
+			  $(BENCH_FRONTEND_DIR)/gfx/video_filters/blargg_ntsc_snes.c \
+			  file/config_file.c file/config_file_userdata.c \
+			  lists/string_list.c rthreads/tpool.c
+
+BENCH_CHEEVOS = test/bench/bench_cheevos
+BENCH_CHEEVOS_SRC = test/bench/bench_cheevos.c \
+		    $(BENCH_FRONTEND_DIR)/cheevos/cheevos_memory.c \
+		    utils/md5.c \
+		    $(wildcard $(BENCH_FRONTEND_DIR)/deps/rcheevos/src/rcheevos/*.c)
+
+BENCH_CHEAT_MANAGER = test/bench/bench_cheat_manager
+BENCH_CHEAT_MANAGER_SRC = test/bench/bench_cheat_manager.c \
+			  $(BENCH_FRONTEND_DIR)/cheat_manager.c \
+			  file/config_file.c file/config_file_userdata.c \
+			  lists/string_list.c
+
+BENCH_OVERLAY = test/bench/bench_overlay
+BENCH_OVERLAY_SRC = test/bench/bench_overlay.c \
+		    $(BENCH_FRONTEND_DIR)/input/input_overlay.c
+
+BENCH_FRONTEND = $(BENCH_STATE_MANAGER) $(BENCH_VIDEO_FILTERS) \
+		 $(BENCH_CHEEVOS) $(BENCH_CHEAT_MANAGER) $(BENCH_OVERLAY)
+
+$(BENCH_STATE_MANAGER): $(BENCH_FRONTEND_SRC) $(BENCH_STATE_MANAGER_SRC)
+	$(CC) $(BENCH_FRONTEND_CFLAGS) -DHAVE_REWIND $(BENCH_FRONTEND_SRC) \
+		$(BENCH_STATE_MANAGER_SRC) -o $@ $(BENCH_LDFLAGS)
+
+$(BENCH_VIDEO_FILTERS): $(BENCH_FRONTEND_SRC) $(BENCH_VIDEO_FILTERS_SRC)
+	$(CC) $(BENCH_FRONTEND_CFLAGS) -DRARCH_INTERNAL $(BENCH_FRONTEND_SRC) \
+		$(BENCH_VIDEO_FILTERS_SRC) -o $@ $(BENCH_LDFLAGS)
+
+$(BENCH_CHEEVOS): $(BENCH_FRONTEND_SRC) $(BENCH_CHEEVOS_SRC)
+	$(CC) $(BENCH_FRONTEND_CFLAGS) -DHAVE_CHEEVOS -DRC_DISABLE_LUA \
+		-I$(BENCH_FRONTEND_DIR)/deps/rcheevos/include \
+		$(BENCH_FRONTEND_SRC) $(BENCH_CHEEVOS_SRC) -o $@ $(BENCH_LDFLAGS)
+
+# cheat_manager.h includes ../setting_list.h
+$(BENCH_CHEAT_MANAGER): $(BENCH_FRONTEND_SRC) $(BENCH_CHEAT_MANAGER_SRC)
+	$(CC) $(BENCH_FRONTEND_CFLAGS) -I. $(BENCH_FRONTEND_SRC) \
+		$(BENCH_CHEAT_MANAGER_SRC) -o $@ $(BENCH_LDFLAGS)
+
+$(BENCH_OVERLAY): $(BENCH_FRONTEND_SRC) $(BENCH_OVERLAY_SRC)
+	$(CC) $(BENCH_FRONTEND_CFLAGS) -DHAVE_OVERLAY $(BENCH_FRONTEND_SRC) \
+		$(BENCH_OVERLAY_SRC) -o $@ $(BENCH_LDFLAGS)
+
+# One report per benchmark, as a JSON array
+run-frontend: $(BENCH_FRONTEND)
+	@sep="["; for bench in $(BENCH_FRONTEND); do \
+		echo "$$sep"; $$bench || exit 1; sep=","; \
+	done; echo "]"
+
+.PHONY: run-frontend
@@ -0,0 +1,357 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_message_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <compat/strl.h>
+#include <queues/message_queue.h>
+#include <rthreads/rthreads.h>
+#include <retro_timers.h>
+
+#define SUITE_NAME "Message Queue"
+
+#define TEST_MSG_QUEUE_SIZE    64
+#define TEST_MSG_QUEUE_THREADS 4
+#define TEST_MSG_QUEUE_POSTS   1000
+
+static void push_prio(msg_queue_t *queue, unsigned prio, unsigned duration)
+{
+   char msg[32];
+   snprintf(msg, sizeof(msg), "prio %u", prio);
+   msg_queue_push(queue, msg, prio, duration, NULL,
+         MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+}
+
+/* Priorities in an order that needs the heap to sift
+ * down through both children on the way */
+static const unsigned test_prios[] = {
+   3, 17, 8, 1, 12, 30, 5, 22, 9, 14, 2, 27, 11, 6, 19, 25, 4, 16
+};
+
+START_TEST (test_msg_queue_extract_order)
+{
+   unsigned i, last;
+   msg_queue_entry_t entry;
+   size_t count        = sizeof(test_prios) / sizeof(test_prios[0]);
+   msg_queue_t *queue  = msg_queue_new(TEST_MSG_QUEUE_SIZE);
+
+   ck_assert_ptr_nonnull(queue);
+
+   for (i = 0; i < count; i++)
+      push_prio(queue, test_prios[i], 1);
+   ck_assert_uint_eq(msg_queue_size(queue), count);
+
+   last = (unsigned)-1;
+   for (i = 0; i < count; i++)
+   {
+      char expected[32];
+      ck_assert(msg_queue_extract(queue, &entry));
+      ck_assert_uint_le(entry.prio, last);
+      snprintf(expected, sizeof(expected), "prio %u", entry.prio);
+      ck_assert_str_eq(entry.msg, expected);
+      last = entry.prio;
+   }
+
+   ck_assert_uint_eq(last, 1);
+   ck_assert_uint_eq(msg_queue_size(queue), 0);
+   ck_assert(!msg_queue_extract(queue, &entry));
+
+   msg_queue_free(queue);
+}
+END_TEST
+
+START_TEST (test_msg_queue_pull_order)
+{
+   unsigned i, last;
+   size_t count        = sizeof(test_prios) / sizeof(test_prios[0]);
+   msg_queue_t *queue  = msg_queue_new(TEST_MSG_QUEUE_SIZE);
+
+   ck_assert_ptr_nonnull(queue);
+
+   for (i = 0; i < count; i++)
+      push_prio(queue, test_prios[i], 1);
+
+   last = (unsigned)-1;
+   for (i = 0; i < count; i++)
+   {
+      unsigned prio;
+      const char *msg = msg_queue_pull(queue);
+      ck_assert_ptr_nonnull(msg);
+      ck_assert_int_eq(sscanf(msg, "prio %u", &prio), 1);
+      ck_assert_uint_le(prio, last);
+      last = prio;
+   }
+
+   ck_assert_ptr_null(msg_queue_pull(queue));
+
+   msg_queue_free(queue);
+}
+END_TEST
+
+START_TEST (test_msg_queue_pull_duration)
+{
+   msg_queue_t *queue  = msg_queue_new(TEST_MSG_QUEUE_SIZE);
+
+   ck_assert_ptr_nonnull(queue);
+
+   push_prio(queue, 1, 3);
+   push_prio(queue, 2, 1);
+
+   /* The highest priority is shown until it runs out */
+   ck_assert_str_eq(msg_queue_pull(queue), "prio 2");
+   ck_assert_str_eq(msg_queue_pull(queue), "prio 1");
+   ck_assert_str_eq(msg_queue_pull(queue), "prio 1");
+   ck_assert_str_eq(msg_queue_pull(queue), "prio 1");
+   ck_assert_ptr_null(msg_queue_pull(queue));
+
+   msg_queue_free(queue);
+}
+END_TEST
+
+typedef struct
+{
+   unsigned seen;
+   unsigned taken;
+   char order[8][16];
+} collect_state_t;
+
+static bool collect_cb(void *userdata, const queue_elem_t *elem)
+{
+   collect_state_t *state = (collect_state_t*)userdata;
+
+   if (state->seen < 8)
+      strlcpy(state->order[state->seen], elem->msg,
+            sizeof(state->order[0]));
+   state->seen++;
+
+   /* Take over anything with priority 0 */
+   if (elem->prio == 0)
+   {
+      state->taken++;
+      return true;
+   }
+   return false;
+}
+
+START_TEST (test_msg_queue_post_collect)
+{
+   collect_state_t state;
+   msg_queue_entry_t entry;
+   msg_queue_t *queue  = msg_queue_new(TEST_MSG_QUEUE_SIZE);
+
+   ck_assert_ptr_nonnull(queue);
+   memset(&state, 0, sizeof(state));
+
+   ck_assert(msg_queue_post(queue, "first", 1, 1, false, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO));
+   ck_assert(msg_queue_post(queue, "second", 0, 1, false, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO));
+   ck_assert(msg_queue_post(queue, "third", 5, 1, false, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO));
+
+   /* Nothing is queued before collecting */
+   ck_assert_uint_eq(msg_queue_size(queue), 0);
+
+   ck_assert_uint_eq(msg_queue_collect(queue, collect_cb, &state), 3);
+   ck_assert_uint_eq(state.seen, 3);
+   ck_assert_uint_eq(state.taken, 1);
+   ck_assert_str_eq(state.order[0], "first");
+   ck_assert_str_eq(state.order[1], "second");
+   ck_assert_str_eq(state.order[2], "third");
+
+   ck_assert_uint_eq(msg_queue_size(queue), 2);
+   ck_assert(msg_queue_extract(queue, &entry));
+   ck_assert_str_eq(entry.msg, "third");
+   ck_assert(msg_queue_extract(queue, &entry));
+   ck_assert_str_eq(entry.msg, "first");
+
+   ck_assert_uint_eq(msg_queue_collect(queue, NULL, NULL), 0);
+
+   msg_queue_free(queue);
+}
+END_TEST
+
+START_TEST (test_msg_queue_post_flush)
+{
+   msg_queue_entry_t entry;
+   msg_queue_t *queue  = msg_queue_new(TEST_MSG_QUEUE_SIZE);
+
+   ck_assert_ptr_nonnull(queue);
+
+   push_prio(queue, 9, 1);
+   msg_queue_post(queue, "before", 3, 1, false, NULL,
+         MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+   msg_queue_post(queue, "flush", 1, 1, true, NULL,
+         MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+   msg_queue_post(queue, "after", 2, 1, false, NULL,
+         MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+
+   /* A flush drops what was queued and posted before it */
+   ck_assert_uint_eq(msg_queue_collect(queue, NULL, NULL), 3);
+   ck_assert_uint_eq(msg_queue_size(queue), 2);
+   ck_assert(msg_queue_extract(queue, &entry));
+   ck_assert_str_eq(entry.msg, "after");
+   ck_assert(msg_queue_extract(queue, &entry));
+   ck_assert_str_eq(entry.msg, "flush");
+
+   msg_queue_free(queue);
+}
+END_TEST
+
+START_TEST (test_msg_queue_post_max)
+{
+   unsigned i;
+   msg_queue_t *queue  = msg_queue_new(TEST_MSG_QUEUE_SIZE);
+
+   ck_assert_ptr_nonnull(queue);
+   ck_assert(!msg_queue_has_posted(queue));
+
+   for (i = 0; i < MSG_QUEUE_MAX_POSTED; i++)
+      ck_assert(msg_queue_post(queue, "msg", 0, 1, false, NULL,
+               MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO));
+   ck_assert(msg_queue_has_posted(queue));
+
+   /* Refused until the others are collected */
+   ck_assert(!msg_queue_post(queue, "msg", 0, 1, false, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO));
+   ck_assert_uint_eq(msg_queue_collect(queue, NULL, NULL),
+         MSG_QUEUE_MAX_POSTED);
+   ck_assert(!msg_queue_has_posted(queue));
+   ck_assert(msg_queue_post(queue, "msg", 0, 1, false, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO));
+
+   msg_queue_free(queue);
+}
+END_TEST
+
+typedef struct
+{
+   msg_queue_t *queue;
+   unsigned id;
+} post_thread_t;
+
+static void post_thread(void *data)
+{
+   unsigned i;
+   post_thread_t *t = (post_thread_t*)data;
+
+   for (i = 0; i < TEST_MSG_QUEUE_POSTS; i++)
+   {
+      char msg[32];
+      snprintf(msg, sizeof(msg), "%u %u", t->id, i);
+      /* Full until the main thread collects again */
+      while (!msg_queue_post(t->queue, msg, 0, 1, false, NULL,
+               MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO))
+         retro_sleep(0);
+   }
+}
+
+typedef struct
+{
+   unsigned next[TEST_MSG_QUEUE_THREADS];
+   unsigned bad;
+} order_state_t;
+
+/* Each thread's messages must come out in the order it posted them */
+static bool order_cb(void *userdata, const queue_elem_t *elem)
+{
+   unsigned id, i;
+   order_state_t *state = (order_state_t*)userdata;
+
+   if (     sscanf(elem->msg, "%u %u", &id, &i) != 2
+         || id >= TEST_MSG_QUEUE_THREADS
+         || state->next[id] != i)
+      state->bad++;
+   else
+      state->next[id]++;
+
+   return true;
+}
+
+START_TEST (test_msg_queue_post_threads)
+{
+   unsigned i;
+   size_t collected = 0;
+   order_state_t state;
+   post_thread_t threads[TEST_MSG_QUEUE_THREADS];
+   sthread_t *handles[TEST_MSG_QUEUE_THREADS];
+   msg_queue_t *queue  = msg_queue_new(TEST_MSG_QUEUE_SIZE);
+
+   ck_assert_ptr_nonnull(queue);
+   memset(&state, 0, sizeof(state));
+
+   for (i = 0; i < TEST_MSG_QUEUE_THREADS; i++)
+   {
+      threads[i].queue = queue;
+      threads[i].id    = i;
+      handles[i]       = sthread_create(post_thread, &threads[i]);
+      ck_assert_ptr_nonnull(handles[i]);
+   }
+
+   /* Collect while the others are still posting */
+   while (collected < TEST_MSG_QUEUE_THREADS * TEST_MSG_QUEUE_POSTS)
+      collected += msg_queue_collect(queue, order_cb, &state);
+
+   for (i = 0; i < TEST_MSG_QUEUE_THREADS; i++)
+      sthread_join(handles[i]);
+
+   collected += msg_queue_collect(queue, order_cb, &state);
+
+   ck_assert_uint_eq(collected,
+         TEST_MSG_QUEUE_THREADS * TEST_MSG_QUEUE_POSTS);
+   ck_assert_uint_eq(state.bad, 0);
+   for (i = 0; i < TEST_MSG_QUEUE_THREADS; i++)
+      ck_assert_uint_eq(state.next[i], TEST_MSG_QUEUE_POSTS);
+
+   msg_queue_free(queue);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_msg_queue_extract_order);
+   tcase_add_test(tc_core, test_msg_queue_pull_order);
+   tcase_add_test(tc_core, test_msg_queue_pull_duration);
+   tcase_add_test(tc_core, test_msg_queue_post_collect);
+   tcase_add_test(tc_core, test_msg_queue_post_flush);
+   tcase_add_test(tc_core, test_msg_queue_post_max);
+   tcase_add_test(tc_core, test_msg_queue_post_threads);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -70,6 +70,26 @@ START_TEST (test_crc32)
 }
 END_TEST
 
+START_TEST (test_crc32_chunked)
+{
+   /* Long enough for the SIMD paths, hashed at once and
+    * in uneven chunks that split them */
+   static const size_t chunks[] = { 1, 15, 64, 100, 333, 487 };
+   uint8_t buf[1000];
+   uint32_t crc = 0;
+   size_t i, pos = 0;
+   for (i = 0; i < sizeof(buf); i++)
+      buf[i] = (uint8_t)(i * 7 + 3);
+   ck_assert_uint_eq(0x17bc2a46, encoding_crc32(0, buf, sizeof(buf)));
+   for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+   {
+      crc  = encoding_crc32(crc, buf + pos, chunks[i]);
+      pos += chunks[i];
+   }
+   ck_assert_uint_eq(0x17bc2a46, crc);
+}
+END_TEST
+
 START_TEST (test_crc32_file)
 {
    char tmpfile[512];
@@ -94,6 +114,7 @@ Suite *create_suite(void)
    TCase *tc_core = tcase_create("Core");
    tcase_add_test(tc_core, test_md5);
    tcase_add_test(tc_core, test_crc32);
+   tcase_add_test(tc_core, test_crc32_chunked);
    tcase_add_test(tc_core, test_crc32_file);
    suite_add_tcase(s, tc_core);
 
@@ -168,6 +168,15 @@
 #include <vfs/vfs_implementation_cdrom.h>
 #endif
 
+/* The read cache works on top of stdio streams */
+#if !defined(ORBIS)
+#define VFS_READ_CACHE
+#if defined(HAVE_THREADS) && defined(VFS_FRONTEND)
+#define VFS_READ_AHEAD
+#include <rthreads/rthreads.h>
+#endif
+#endif
+
 #if (defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE - 0) >= 200112) || (defined(__POSIX_VISIBLE) && __POSIX_VISIBLE >= 200112) || (defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112) || __USE_LARGEFILE || (defined(_FILE_OFFSET_BITS) && _FILE_OFFSET_BITS == 64)
 #ifndef HAVE_64BIT_OFFSETS
 #define HAVE_64BIT_OFFSETS
@@ -248,6 +257,297 @@ int64_t retro_vfs_file_seek_internal(
    return 0;
 }
 
+#ifdef VFS_READ_CACHE
+/* Two blocks, the one being consumed and the one
+ * after it which the read ahead thread loads */
+struct vfs_read_cache
+{
+   retro_vfs_file_stats_t stats;
+   int64_t start[2];
+   int64_t len[2];
+   int64_t pos;
+   /* Offset of the block consumed last, to detect sequential reads */
+   int64_t last;
+   uint8_t *data[2];
+#ifdef VFS_READ_AHEAD
+   sthread_t *thread;
+   /* Held while the stream is read */
+   slock_t *lock;
+   /* Signals a new request to the thread, and
+    * its completion to a reader waiting for it */
+   scond_t *cond;
+   int64_t request;
+   bool quit;
+#endif
+   unsigned cur;
+   /* Set until a block loaded ahead is first used */
+   bool ahead[2];
+};
+
+static size_t vfs_read_cache_block_size;
+static retro_vfs_file_stats_cb_t vfs_read_cache_stats_cb;
+
+void retro_vfs_set_read_cache(size_t block_size,
+      retro_vfs_file_stats_cb_t stats_cb)
+{
+   vfs_read_cache_block_size = block_size;
+   vfs_read_cache_stats_cb   = stats_cb;
+}
+
+/* Must be called with the cache lock held */
+static void vfs_read_cache_fill(libretro_vfs_implementation_file *stream,
+      unsigned idx, int64_t offset)
+{
+   struct vfs_read_cache *cache = stream->cache;
+   size_t                 read  = 0;
+
+   if (retro_vfs_file_seek_internal(stream, offset, SEEK_SET) == 0)
+      read = fread(cache->data[idx], 1, vfs_read_cache_block_size,
+            stream->fp);
+
+   cache->start[idx]           = offset;
+   cache->len[idx]             = (int64_t)read;
+   cache->ahead[idx]           = false;
+   cache->stats.bytes_fetched += read;
+}
+
+#ifdef VFS_READ_AHEAD
+static void vfs_read_cache_thread(void *data)
+{
+   libretro_vfs_implementation_file *stream =
+      (libretro_vfs_implementation_file*)data;
+   struct vfs_read_cache *cache = stream->cache;
+
+   slock_lock(cache->lock);
+
+   while (!cache->quit)
+   {
+      if (cache->request >= 0)
+      {
+         unsigned idx = cache->cur ^ 1;
+         vfs_read_cache_fill(stream, idx, cache->request);
+         cache->ahead[idx] = true;
+         cache->request    = -1;
+         cache->stats.readaheads++;
+         scond_signal(cache->cond);
+      }
+      else
+         scond_wait(cache->cond, cache->lock);
+   }
+
+   slock_unlock(cache->lock);
+}
+#endif
+
+static void vfs_read_cache_free(libretro_vfs_implementation_file *stream)
+{
+   struct vfs_read_cache *cache = stream->cache;
+
+   if (!cache)
+      return;
+
+#ifdef VFS_READ_AHEAD
+   if (cache->thread)
+   {
+      slock_lock(cache->lock);
+      cache->quit = true;
+      scond_signal(cache->cond);
+      slock_unlock(cache->lock);
+      sthread_join(cache->thread);
+   }
+   if (cache->cond)
+      scond_free(cache->cond);
+   if (cache->lock)
+      slock_free(cache->lock);
+#endif
+
+   if (vfs_read_cache_stats_cb && cache->stats.reads)
+      vfs_read_cache_stats_cb(stream->orig_path, &cache->stats);
+
+   free(cache->data[0]);
+   free(cache->data[1]);
+   free(cache);
+
+   stream->cache = NULL;
+}
+
+static void vfs_read_cache_new(libretro_vfs_implementation_file *stream)
+{
+   struct vfs_read_cache *cache = (struct vfs_read_cache*)
+      calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return;
+
+   stream->cache    = cache;
+   cache->start[0]  = -1;
+   cache->start[1]  = -1;
+   cache->last      = -(int64_t)vfs_read_cache_block_size;
+   cache->data[0]   = (uint8_t*)malloc(vfs_read_cache_block_size);
+   cache->data[1]   = (uint8_t*)malloc(vfs_read_cache_block_size);
+
+   if (!cache->data[0] || !cache->data[1])
+   {
+      vfs_read_cache_free(stream);
+      return;
+   }
+
+#ifdef VFS_READ_AHEAD
+   /* The thread is only started once the file is read sequentially */
+   cache->request   = -1;
+   cache->lock      = slock_new();
+   cache->cond      = scond_new();
+
+   if (!cache->lock || !cache->cond)
+      vfs_read_cache_free(stream);
+#endif
+}
+
+static void vfs_read_cache_prefetch(libretro_vfs_implementation_file *stream,
+      int64_t offset)
+{
+#ifdef VFS_READ_AHEAD
+   struct vfs_read_cache *cache = stream->cache;
+
+   /* Called with the lock held, the new thread waits for it */
+   if (!cache->thread && !(cache->thread =
+            sthread_create(vfs_read_cache_thread, stream)))
+      return;
+
+   cache->request = offset;
+   scond_signal(cache->cond);
+#endif
+}
+
+static int64_t vfs_read_cache_read(libretro_vfs_implementation_file *stream,
+      uint8_t *s, uint64_t len)
+{
+   struct vfs_read_cache *cache = stream->cache;
+   int64_t block_size           = (int64_t)vfs_read_cache_block_size;
+   uint64_t total               = 0;
+   bool missed                  = false;
+
+   cache->stats.reads++;
+
+   while (len)
+   {
+      unsigned idx  = cache->cur;
+      int64_t start = cache->start[idx];
+      int64_t offset;
+
+      if (start >= 0 && cache->pos >= start
+            && cache->pos < start + cache->len[idx])
+      {
+         uint64_t avail = (uint64_t)(start + cache->len[idx] - cache->pos);
+         uint64_t n     = len < avail ? len : avail;
+
+         memcpy(s + total, cache->data[idx] + (cache->pos - start),
+               (size_t)n);
+         cache->pos += n;
+         total      += n;
+         len        -= n;
+         continue;
+      }
+
+      if (cache->pos >= stream->size)
+         break;
+
+      offset = cache->pos - cache->pos % block_size;
+
+#ifdef VFS_READ_AHEAD
+      slock_lock(cache->lock);
+      /* Waits for the block if it is being loaded ahead */
+      while (cache->request == offset)
+         scond_wait(cache->cond, cache->lock);
+#endif
+
+      if (cache->start[idx ^ 1] == offset && cache->len[idx ^ 1] > 0)
+      {
+         cache->cur = idx ^ 1;
+         if (cache->ahead[cache->cur])
+            cache->stats.readahead_hits++;
+         cache->ahead[cache->cur] = false;
+      }
+      else
+      {
+         vfs_read_cache_fill(stream, idx, offset);
+         missed = true;
+      }
+
+      if (     offset == cache->last + block_size
+            && offset + block_size < stream->size)
+         vfs_read_cache_prefetch(stream, offset + block_size);
+      cache->last = offset;
+
+#ifdef VFS_READ_AHEAD
+      slock_unlock(cache->lock);
+#endif
+
+      if (cache->len[cache->cur] <= 0)
+         break;
+   }
+
+   if (missed)
+      cache->stats.misses++;
+   cache->stats.bytes_read += total;
+
+   return (int64_t)total;
+}
+
+static int64_t vfs_read_cache_seek(libretro_vfs_implementation_file *stream,
+      int64_t offset, int whence)
+{
+   struct vfs_read_cache *cache = stream->cache;
+   unsigned idx                 = cache->cur;
+
+   switch (whence)
+   {
+      case SEEK_CUR:
+         offset += cache->pos;
+         break;
+      case SEEK_END:
+         offset += stream->size;
+         break;
+   }
+
+   if (offset < 0)
+      return -1;
+
+   if (     offset <  cache->start[idx]
+         || offset >= cache->start[idx] + cache->len[idx])
+      cache->stats.seeks++;
+
+   cache->pos = offset;
+   return 0;
+}
+
+bool retro_vfs_file_get_stats_impl(libretro_vfs_implementation_file *stream,
+      retro_vfs_file_stats_t *stats)
+{
+   if (!stream || !stream->cache)
+      return false;
+
+#ifdef VFS_READ_AHEAD
+   slock_lock(stream->cache->lock);
+#endif
+   *stats = stream->cache->stats;
+#ifdef VFS_READ_AHEAD
+   slock_unlock(stream->cache->lock);
+#endif
+
+   return true;
+}
+#else
+void retro_vfs_set_read_cache(size_t block_size,
+      retro_vfs_file_stats_cb_t stats_cb) { }
+
+bool retro_vfs_file_get_stats_impl(libretro_vfs_implementation_file *stream,
+      retro_vfs_file_stats_t *stats)
+{
+   return false;
+}
+#endif
+
 /**
  * retro_vfs_file_open_impl:
  * @path               : path to file
@@ -296,6 +596,7 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
    stream->mapsize                = 0;
    stream->mapped                 = NULL;
    stream->scheme                 = VFS_SCHEME_NONE;
+   stream->cache                  = NULL;
 
 #ifdef VFS_FRONTEND
    if (path_len >= dumb_prefix_len)
@@ -519,6 +820,14 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
 
       retro_vfs_file_seek_internal(stream, 0, SEEK_SET);
    }
+#endif
+#ifdef VFS_READ_CACHE
+   if (     vfs_read_cache_block_size
+         && mode == RETRO_VFS_FILE_ACCESS_READ
+         && stream->scheme == VFS_SCHEME_NONE
+         && (stream->hints & RFILE_HINT_UNBUFFERED) == 0
+         && stream->size > (int64_t)vfs_read_cache_block_size)
+      vfs_read_cache_new(stream);
 #endif
    return stream;
 
@@ -540,6 +849,11 @@ int retro_vfs_file_close_impl(libretro_vfs_implementation_file *stream)
    }
 #endif
 
+#ifdef VFS_READ_CACHE
+   /* Joins the read ahead thread before the stream goes away */
+   vfs_read_cache_free(stream);
+#endif
+
    if ((stream->hints & RFILE_HINT_UNBUFFERED) == 0)
    {
       if (stream->fp)
@@ -620,6 +934,11 @@ int64_t retro_vfs_file_tell_impl(libretro_vfs_implementation_file *stream)
    if (!stream)
       return -1;
 
+#ifdef VFS_READ_CACHE
+   if (stream->cache)
+      return stream->cache->pos;
+#endif
+
    if ((stream->hints & RFILE_HINT_UNBUFFERED) == 0)
    {
 #ifdef HAVE_CDROM
@@ -674,6 +993,11 @@ int64_t retro_vfs_file_seek_impl(libretro_vfs_implementation_file *stream,
          break;
    }
 
+#ifdef VFS_READ_CACHE
+   if (stream && stream->cache)
+      return vfs_read_cache_seek(stream, offset, whence);
+#endif
+
    return retro_vfs_file_seek_internal(stream, offset, whence);
 }
 
@@ -683,6 +1007,11 @@ int64_t retro_vfs_file_read_impl(libretro_vfs_implementation_file *stream,
    if (!stream || !s)
       return -1;
 
+#ifdef VFS_READ_CACHE
+   if (stream->cache)
+      return vfs_read_cache_read(stream, (uint8_t*)s, len);
+#endif
+
    if ((stream->hints & RFILE_HINT_UNBUFFERED) == 0)
    {
 #ifdef HAVE_CDROM
@@ -1171,7 +1500,16 @@ libretro_vfs_implementation_dir *retro_vfs_opendir_impl(
       free(path_local);
 #else
    path_wide               = utf8_to_utf16_string_alloc(path_buf);
-   rdir->directory         = FindFirstFileW(path_wide, &rdir->entry);
+#if !defined(_XBOX) && defined(FIND_FIRST_EX_LARGE_FETCH)
+   /* Skip the 8.3 short names and fetch entries in larger
+    * batches. Windows before 7 rejects both flags. */
+   rdir->directory         = FindFirstFileExW(path_wide, FindExInfoBasic,
+         &rdir->entry, FindExSearchNameMatch, NULL,
+         FIND_FIRST_EX_LARGE_FETCH);
+   if (     rdir->directory == INVALID_HANDLE_VALUE
+         && GetLastError()  == ERROR_INVALID_PARAMETER)
+#endif
+      rdir->directory      = FindFirstFileW(path_wide, &rdir->entry);
 
    if (path_wide)
       free(path_wide);
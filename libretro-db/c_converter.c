@@ -31,6 +31,9 @@
 #include <lrc_hash.h>
 
 #include <retro_assert.h>
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 
@@ -67,8 +70,6 @@ typedef struct
 typedef struct dat_converter_map_t dat_converter_map_t;
 typedef struct dat_converter_list_t dat_converter_list_t;
 typedef union dat_converter_list_item_t dat_converter_list_item_t;
-typedef struct dat_converter_search_tree_t dat_converter_search_tree_t;
-typedef struct dat_converter_bt_node_t dat_converter_bt_node_t;
 
 struct dat_converter_map_t
 {
@@ -86,7 +87,6 @@ struct dat_converter_list_t
 {
    dat_converter_list_enum type;
    dat_converter_list_item_t* values;
-   dat_converter_bt_node_t* bt_root;
    int count;
    int capacity;
 };
@@ -99,14 +99,6 @@ union dat_converter_list_item_t
    dat_converter_list_t* list;
 };
 
-struct dat_converter_bt_node_t
-{
-   int index;
-   uint32_t hash;
-   dat_converter_bt_node_t* right;
-   dat_converter_bt_node_t* left;
-};
-
 static dat_converter_list_t* dat_converter_list_create(
       dat_converter_list_enum type)
 {
@@ -115,23 +107,12 @@ static dat_converter_list_t* dat_converter_list_create(
    list->type                 = type;
    list->count                = 0;
    list->capacity             = (1 << 2);
-   list->bt_root              = NULL;
    list->values               = (dat_converter_list_item_t*)malloc(
          sizeof(*list->values) * list->capacity);
 
    return list;
 }
 
-static void dat_converter_bt_node_free(dat_converter_bt_node_t* node)
-{
-   if (!node)
-      return;
-
-   dat_converter_bt_node_free(node->left);
-   dat_converter_bt_node_free(node->right);
-   free(node);
-}
-
 static void dat_converter_list_free(dat_converter_list_t* list)
 {
    if (!list)
@@ -148,7 +129,6 @@ static void dat_converter_list_free(dat_converter_list_t* list)
          if (list->values[list->count].map.type == DAT_CONVERTER_LIST_MAP)
             dat_converter_list_free(list->values[list->count].map.value.list);
       }
-      dat_converter_bt_node_free(list->bt_root);
       break;
    default:
       break;
@@ -157,58 +137,6 @@ static void dat_converter_list_free(dat_converter_list_t* list)
    free(list->values);
    free(list);
 }
-static void dat_converter_list_append(dat_converter_list_t* dst, void* item);
-
-static dat_converter_bt_node_t* dat_converter_bt_node_insert(
-      dat_converter_list_t* list,
-      dat_converter_bt_node_t** node,
-      dat_converter_map_t* map)
-{
-   retro_assert(map->key);
-   retro_assert(list->type == DAT_CONVERTER_MAP_LIST);
-
-   if (!*node)
-   {
-      *node = calloc(1, sizeof(dat_converter_bt_node_t));
-      return *node;
-   }
-
-   int diff = (*node)->hash - map->hash;
-
-   if (!diff)
-      diff = strcmp(list->values[(*node)->index].map.key, map->key);
-
-   if (diff < 0)
-      return dat_converter_bt_node_insert(list, &(*node)->left, map);
-   else if (diff > 0)
-      return dat_converter_bt_node_insert(list, &(*node)->right, map);
-
-   /* found match */
-
-   if (list->values[(*node)->index].map.type == DAT_CONVERTER_LIST_MAP)
-   {
-      if (map->type == DAT_CONVERTER_LIST_MAP)
-      {
-         int i;
-
-         retro_assert(list->values[(*node)->index].map.value.list->type
-               == map->value.list->type);
-
-         for (i = 0; i < map->value.list->count; i++)
-            dat_converter_list_append(
-                  list->values[(*node)->index].map.value.list,
-                  &map->value.list->values[i]);
-
-         /* set count to 0 to prevent freeing the child nodes */
-         map->value.list->count = 0;
-         dat_converter_list_free(map->value.list);
-      }
-   }
-   else
-      list->values[(*node)->index].map = *map;
-
-   return NULL;
-}
 
 static void dat_converter_list_append(dat_converter_list_t* dst, void* item)
 {
@@ -234,21 +162,11 @@ static void dat_converter_list_append(dat_converter_list_t* dst, void* item)
    case DAT_CONVERTER_MAP_LIST:
    {
       dat_converter_map_t* map = (dat_converter_map_t*) item;
-      if (!map->key)
-         dst->values[dst->count].map = *map;
-      else
-      {
+      /* Entries with the same key are folded together
+       * later, see dat_converter_list_merge() */
+      if (map->key)
          map->hash = djb2_calculate(map->key);
-         dat_converter_bt_node_t* new_node =
-            dat_converter_bt_node_insert(dst, &dst->bt_root, map);
-
-         if (!new_node)
-            return;
-
-         dst->values[dst->count].map = *map;
-         new_node->index = dst->count;
-         new_node->hash = map->hash;
-      }
+      dst->values[dst->count].map = *map;
       break;
    }
    case DAT_CONVERTER_LIST_LIST:
@@ -263,6 +181,119 @@ static void dat_converter_list_append(dat_converter_list_t* dst, void* item)
    dst->count++;
 }
 
+typedef struct
+{
+   const char* key;
+   uint32_t hash;
+   int index;
+} dat_converter_sort_key_t;
+
+static int dat_converter_sort_key_cmp(const void* a, const void* b)
+{
+   const dat_converter_sort_key_t* x = (const dat_converter_sort_key_t*)a;
+   const dat_converter_sort_key_t* y = (const dat_converter_sort_key_t*)b;
+   int diff;
+
+   if (x->hash != y->hash)
+      return (x->hash < y->hash) ? -1 : 1;
+   if ((diff = strcmp(x->key, y->key)))
+      return diff;
+   /* Keep list order within a key */
+   return x->index - y->index;
+}
+
+/* Folds the entries of a map list that share a key into the
+ * first of them, in list order: tables are merged, anything
+ * else takes the later value. Sorting the keys once keeps this
+ * O(n log n) however the DATs are ordered. */
+static void dat_converter_list_merge(dat_converter_list_t* list)
+{
+   int i, j;
+   /* Most lists are the few fields of one game */
+   dat_converter_sort_key_t stack_keys[32];
+   bool stack_removed[32];
+   int key_count                  = 0;
+   bool* removed                  = NULL;
+   dat_converter_sort_key_t* keys = stack_keys;
+
+   if (list->type != DAT_CONVERTER_MAP_LIST || list->count < 2)
+      return;
+
+   if (list->count > (int)ARRAY_SIZE(stack_keys))
+      keys = (dat_converter_sort_key_t*)malloc(list->count * sizeof(*keys));
+
+   for (i = 0; i < list->count; i++)
+   {
+      if (!list->values[i].map.key)
+         continue;
+      keys[key_count].key   = list->values[i].map.key;
+      keys[key_count].hash  = list->values[i].map.hash;
+      keys[key_count].index = i;
+      key_count++;
+   }
+
+   qsort(keys, key_count, sizeof(*keys), dat_converter_sort_key_cmp);
+
+   for (i = 0; i < key_count; i = j)
+   {
+      dat_converter_map_t* dst = &list->values[keys[i].index].map;
+      bool merged              = false;
+
+      for (j = i + 1; j < key_count
+            && keys[j].hash == keys[i].hash
+            && string_is_equal(keys[j].key, keys[i].key); j++)
+      {
+         dat_converter_map_t* src = &list->values[keys[j].index].map;
+
+         if (!removed)
+         {
+            if (keys == stack_keys)
+            {
+               removed = stack_removed;
+               memset(removed, 0, sizeof(stack_removed));
+            }
+            else
+               removed = (bool*)calloc(list->count, sizeof(*removed));
+         }
+         removed[keys[j].index] = true;
+
+         if (dst->type != DAT_CONVERTER_LIST_MAP)
+            *dst = *src;
+         else if (src->type == DAT_CONVERTER_LIST_MAP)
+         {
+            int k;
+
+            retro_assert(dst->value.list->type == src->value.list->type);
+
+            for (k = 0; k < src->value.list->count; k++)
+               dat_converter_list_append(dst->value.list,
+                     &src->value.list->values[k]);
+
+            /* set count to 0 to prevent freeing the child nodes */
+            src->value.list->count = 0;
+            dat_converter_list_free(src->value.list);
+            merged = true;
+         }
+      }
+
+      if (merged)
+         dat_converter_list_merge(dst->value.list);
+   }
+
+   if (removed)
+   {
+      for (i = 0, j = 0; i < list->count; i++)
+         if (!removed[i])
+            list->values[j++] = list->values[i];
+      list->count = j;
+      if (removed != stack_removed)
+         free(removed);
+   }
+
+   if (keys != stack_keys)
+      free(keys);
+}
+
 static dat_converter_list_t* dat_converter_lexer(
       char* src, const char* dat_path)
 {
@@ -344,6 +375,7 @@ static dat_converter_list_t* dat_parser_table(
          {
             current++;
             *start_token = current;
+            dat_converter_list_merge(parsed_table);
             return parsed_table;
          }
          else if (string_is_equal(current->token.label, "("))
@@ -483,29 +515,22 @@ static const char* dat_converter_get_match(
    return NULL;
 }
 
+/* Games of one DAT, keyed by match_key if there is one.
+ * Called from several threads, match_key is only read. */
 static dat_converter_list_t* dat_converter_parser(
-      dat_converter_list_t* target,
       dat_converter_list_t* lexer_list,
       dat_converter_match_key_t* match_key)
 {
    dat_converter_map_t map;
    dat_converter_list_item_t* current = lexer_list->values;
+   dat_converter_list_t* target       =
+      dat_converter_list_create(DAT_CONVERTER_MAP_LIST);
    bool skip                          = true;
    bool warning_displayed             = false;
 
    map.key                            = NULL;
    map.type                           = DAT_CONVERTER_LIST_MAP;
 
-   if (!target)
-   {
-      dat_converter_map_t map;
-      target = dat_converter_list_create(DAT_CONVERTER_MAP_LIST);
-      map.key = NULL;
-      map.type = DAT_CONVERTER_LIST_MAP;
-      map.value.list = NULL;
-      dat_converter_list_append(target, &map);
-   }
-
    while (current->token.label)
    {
       if (!map.key)
@@ -743,10 +768,81 @@ static int dat_converter_value_provider(
    return 0;
 }
 
+typedef struct
+{
+   const char* path;
+   char* buffer;
+   dat_converter_list_t* games;
+} dat_converter_dat_t;
+
+typedef struct
+{
+   dat_converter_dat_t* dats;
+   dat_converter_match_key_t* match_key;
+   slock_t* lock;
+   int count;
+   int next;
+} dat_converter_jobs_t;
+
+static void dat_converter_load(dat_converter_dat_t* dat,
+      dat_converter_match_key_t* match_key)
+{
+   size_t dat_file_size;
+   dat_converter_list_t* dat_lexer_list = NULL;
+   FILE* dat_file                       = fopen(dat->path, "r");
+
+   if (!dat_file)
+   {
+      printf("  could not open dat file '%s': %s\n",
+            dat->path, strerror(errno));
+      dat_converter_exit(1);
+   }
+
+   fseek(dat_file, 0, SEEK_END);
+   dat_file_size = ftell(dat_file);
+   fseek(dat_file, 0, SEEK_SET);
+   dat->buffer = (char*)malloc(dat_file_size + 1);
+   fread(dat->buffer, 1, dat_file_size, dat_file);
+   fclose(dat_file);
+   dat->buffer[dat_file_size] = '\0';
+
+   dat_lexer_list = dat_converter_lexer(dat->buffer, dat->path);
+   dat->games     = dat_converter_parser(dat_lexer_list, match_key);
+
+   dat_converter_list_free(dat_lexer_list);
+}
+
+/* DATs are independent until they are merged, workers
+ * take the next one until none are left */
+static void dat_converter_worker(void* data)
+{
+   dat_converter_jobs_t* jobs = (dat_converter_jobs_t*)data;
+
+   for (;;)
+   {
+      int i;
+
+      slock_lock(jobs->lock);
+      i = jobs->next++;
+      slock_unlock(jobs->lock);
+
+      if (i >= jobs->count)
+         break;
+
+      dat_converter_load(&jobs->dats[i], jobs->match_key);
+   }
+}
+
 int main(int argc, char** argv)
 {
+   int i;
    const char* rdb_path;
-   dat_converter_match_key_t* match_key = NULL;
+   dat_converter_map_t sentinel;
+   dat_converter_jobs_t jobs;
+   sthread_t** threads                   = NULL;
+   int thread_count                      = 0;
+   dat_converter_match_key_t* match_key  = NULL;
+   dat_converter_list_t* dat_parser_list = NULL;
    RFILE* rdb_file;
 
    if (argc < 2)
@@ -768,45 +864,63 @@ int main(int argc, char** argv)
       argv++;
    }
 
-   int dat_count                         = argc;
-   char** dat_buffers                    = (char**)
-      malloc(dat_count * sizeof(*dat_buffers));
-   char** dat_buffer                     = dat_buffers;
-   dat_converter_list_t* dat_parser_list = NULL;
+   jobs.dats      = (dat_converter_dat_t*)calloc(
+         argc ? argc : 1, sizeof(*jobs.dats));
+   jobs.match_key = match_key;
+   jobs.lock      = slock_new();
+   jobs.count     = argc;
+   jobs.next      = 0;
 
-   while (argc)
+   for (i = 0; i < argc; i++)
    {
-      size_t dat_file_size;
-      dat_converter_list_t* dat_lexer_list = NULL;
-      FILE* dat_file                       = fopen(*argv, "r");
+      jobs.dats[i].path = argv[i];
+      printf("  %s\n", argv[i]);
+   }
 
-      if (!dat_file)
-      {
-         printf("  could not open dat file '%s': %s\n",
-               *argv, strerror(errno));
-         dat_converter_exit(1);
-      }
+   thread_count = (int)cpu_features_get_core_amount();
+   if (thread_count > jobs.count)
+      thread_count = jobs.count;
+
+   if (thread_count > 1 && jobs.lock)
+      threads = (sthread_t**)calloc(thread_count, sizeof(*threads));
 
-      fseek(dat_file, 0, SEEK_END);
-      dat_file_size = ftell(dat_file);
-      fseek(dat_file, 0, SEEK_SET);
-      *dat_buffer = (char*)malloc(dat_file_size + 1);
-      fread(*dat_buffer, 1, dat_file_size, dat_file);
-      fclose(dat_file);
-      (*dat_buffer)[dat_file_size] = '\0';
+   if (threads)
+   {
+      for (i = 0; i < thread_count; i++)
+         threads[i] = sthread_create(dat_converter_worker, &jobs);
+      /* Whatever failed to start is picked up by the rest */
+      for (i = 0; i < thread_count; i++)
+         if (threads[i])
+            sthread_join(threads[i]);
+      free(threads);
+   }
 
-      printf("  %s\n", *argv);
-      dat_lexer_list  = dat_converter_lexer(*dat_buffer, *argv);
-      dat_parser_list = dat_converter_parser(
-            dat_parser_list, dat_lexer_list, match_key);
+   /* Also covers a single DAT, or threads being unavailable */
+   dat_converter_worker(&jobs);
 
-      dat_converter_list_free(dat_lexer_list);
+   /* Combine in command line order, so entries and merged
+    * values come out as if the DATs were read one by one */
+   dat_parser_list     = dat_converter_list_create(DAT_CONVERTER_MAP_LIST);
+   sentinel.key        = NULL;
+   sentinel.type       = DAT_CONVERTER_LIST_MAP;
+   sentinel.value.list = NULL;
+   dat_converter_list_append(dat_parser_list, &sentinel);
 
-      argc--;
-      argv++;
-      dat_buffer++;
+   for (i = 0; i < jobs.count; i++)
+   {
+      int j;
+      dat_converter_list_t* games = jobs.dats[i].games;
+
+      for (j = 0; j < games->count; j++)
+         dat_converter_list_append(dat_parser_list, &games->values[j].map);
+
+      /* set count to 0 to prevent freeing the child nodes */
+      games->count = 0;
+      dat_converter_list_free(games);
    }
 
+   dat_converter_list_merge(dat_parser_list);
+
    rdb_file = filestream_open(rdb_path,
          RETRO_VFS_FILE_ACCESS_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -834,9 +948,10 @@ int main(int argc, char** argv)
 
    dat_converter_list_free(dat_parser_list);
 
-   while (dat_count--)
-      free(dat_buffers[dat_count]);
-   free(dat_buffers);
+   for (i = 0; i < jobs.count; i++)
+      free(jobs.dats[i].buffer);
+   free(jobs.dats);
+   slock_free(jobs.lock);
 
    dat_converter_match_key_free(match_key);
 
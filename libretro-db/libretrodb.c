@@ -39,18 +39,51 @@
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
 #include "rmsgpack.h"
-#include "bintree.h"
 #include "query.h"
 #include "libretrodb.h"
 
 #define MAGIC_NUMBER "RARCHDB"
 
-struct node_iter_ctx
+/* Indices follow the metadata. Each one is a header and
+ * a table of (key, entry offset) pairs sorted by key, where
+ * the key is a hash of the field's value, so lookups are
+ * a binary search without decoding unrelated entries. */
+#define LIBRETRODB_INDEX_ENTRY_SIZE  (2 * sizeof(uint32_t))
+#define LIBRETRODB_MAX_INDICES       8
+#define LIBRETRODB_MAX_LOOKUP_VALUES 16
+
+/* Fields that get an index when a database is created,
+ * the ones RetroArch looks entries up by */
+static const char *libretrodb_indexed_fields[] = {
+   "crc",
+   "serial",
+   "name"
+};
+
+struct libretrodb_index
 {
-	libretrodb_t *db;
-	libretrodb_index_t *idx;
+	char name[50];
+	char field[50];
+	uint64_t key_size;
+	uint64_t next;
+	uint64_t count;
+	uint64_t offset; /* of the first key */
 };
 
+typedef struct libretrodb_index_entry
+{
+   uint32_t key;
+   uint32_t offset;
+} libretrodb_index_entry_t;
+
+typedef struct libretrodb_index_builder
+{
+   libretrodb_index_entry_t *entries;
+   size_t count;
+   size_t capacity;
+   int too_large; /* offsets past 4 GB, no index is written */
+} libretrodb_index_builder_t;
+
 struct libretrodb
 {
 	RFILE *fd;
@@ -58,13 +91,8 @@ struct libretrodb
 	uint64_t root;
 	uint64_t count;
 	uint64_t first_index_offset;
-};
-
-struct libretrodb_index
-{
-	char name[50];
-	uint64_t key_size;
-	uint64_t next;
+   libretrodb_index_t indices[LIBRETRODB_MAX_INDICES];
+   unsigned index_count;
 };
 
 typedef struct libretrodb_metadata
@@ -83,8 +111,15 @@ struct libretrodb_cursor
    RFILE *fd;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+   uint64_t *offsets; /* of the entries to read, if an index was used */
+   size_t offset_count;
+   size_t offset_pos;
+   uint8_t *data;     /* whole file, for libretrodb_cursor_read_item_view */
+   int64_t data_size;
+   int64_t data_pos;
 	int is_valid;
 	int eof;
+	int indexed;
 };
 
 static int libretrodb_read_metadata(RFILE *fd, libretrodb_metadata_t *md)
@@ -131,17 +166,332 @@ static int libretrodb_validate_document(const struct rmsgpack_dom_value *doc)
    return rv;
 }
 
+static const struct rmsgpack_dom_value *libretrodb_map_get(
+      const struct rmsgpack_dom_value *map, const char *name)
+{
+   struct rmsgpack_dom_value key;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(name);
+   key.val.string.buff = (char*)name;
+
+   return rmsgpack_dom_value_map_value(map, &key);
+}
+
+/* FNV-1a of the value, numbers are hashed by value so
+ * that signed and unsigned ones compare equal like they
+ * do in queries. Collisions are fine, the entries are
+ * still compared to the query once read. */
+static int libretrodb_index_key(const struct rmsgpack_dom_value *v,
+      uint32_t *key)
+{
+   uint32_t i, len;
+   uint8_t num[8];
+   const uint8_t *data = NULL;
+   uint32_t hash       = 0x811c9dc5;
+
+   switch (v->type)
+   {
+      case RDT_STRING:
+         data = (const uint8_t*)v->val.string.buff;
+         len  = v->val.string.len;
+         break;
+      case RDT_BINARY:
+         data = (const uint8_t*)v->val.binary.buff;
+         len  = v->val.binary.len;
+         break;
+      case RDT_INT:
+      case RDT_UINT:
+         for (i = 0; i < 8; i++)
+            num[i] = (uint8_t)(v->val.uint_ >> (i * 8));
+         data = num;
+         len  = 8;
+         break;
+      default:
+         return -1;
+   }
+
+   for (i = 0; i < len; i++)
+      hash = (hash ^ data[i]) * 0x01000193;
+
+   *key = hash;
+   return 0;
+}
+
+static int libretrodb_index_add(libretrodb_index_builder_t *builder,
+      const struct rmsgpack_dom_value *item, const char *field,
+      uint64_t offset)
+{
+   uint32_t key;
+   const struct rmsgpack_dom_value *value = NULL;
+
+   if (offset > 0xffffffff)
+      builder->too_large = 1;
+
+   /* Entries without the field are left out */
+   if (     builder->too_large
+         || item->type != RDT_MAP
+         || !(value = libretrodb_map_get(item, field))
+         || libretrodb_index_key(value, &key) != 0)
+      return 0;
+
+   if (builder->count == builder->capacity)
+   {
+      size_t capacity                   = builder->capacity
+         ? builder->capacity * 2 : 256;
+      libretrodb_index_entry_t *entries = (libretrodb_index_entry_t*)
+         realloc(builder->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         return -ENOMEM;
+
+      builder->entries  = entries;
+      builder->capacity = capacity;
+   }
+
+   builder->entries[builder->count].key    = key;
+   builder->entries[builder->count].offset = (uint32_t)offset;
+   builder->count++;
+   return 0;
+}
+
+static int libretrodb_index_entry_cmp(const void *a, const void *b)
+{
+   const libretrodb_index_entry_t *ea = (const libretrodb_index_entry_t*)a;
+   const libretrodb_index_entry_t *eb = (const libretrodb_index_entry_t*)b;
+
+   if (ea->key != eb->key)
+      return (ea->key < eb->key) ? -1 : 1;
+   if (ea->offset != eb->offset)
+      return (ea->offset < eb->offset) ? -1 : 1;
+   return 0;
+}
+
+static int libretrodb_read_index_header(RFILE *fd, libretrodb_index_t *idx)
+{
+   struct rmsgpack_dom_value map;
+   const struct rmsgpack_dom_value *name     = NULL;
+   const struct rmsgpack_dom_value *field    = NULL;
+   const struct rmsgpack_dom_value *key_size = NULL;
+   const struct rmsgpack_dom_value *count    = NULL;
+   const struct rmsgpack_dom_value *next     = NULL;
+   int rv                                    = rmsgpack_dom_read(fd, &map);
+
+   if (rv < 0)
+      return rv;
+
+   rv = -EINVAL;
+
+   if (map.type == RDT_MAP)
+   {
+      name     = libretrodb_map_get(&map, "name");
+      field    = libretrodb_map_get(&map, "field");
+      key_size = libretrodb_map_get(&map, "key_size");
+      count    = libretrodb_map_get(&map, "count");
+      next     = libretrodb_map_get(&map, "next");
+   }
+
+   /* Indices written by older versions have no field
+    * and count, they are only skipped */
+   if (     name     && name->type     == RDT_STRING
+         && key_size && key_size->type == RDT_UINT
+         && next     && next->type     == RDT_UINT)
+   {
+      size_t len = name->val.string.len < sizeof(idx->name)
+         ? name->val.string.len : sizeof(idx->name) - 1;
+
+      memcpy(idx->name, name->val.string.buff, len);
+      idx->name[len]  = '\0';
+      idx->field[0]   = '\0';
+      idx->key_size   = key_size->val.uint_;
+      idx->next       = next->val.uint_;
+      idx->count      = 0;
+
+      if (     field && field->type == RDT_STRING
+            && count && count->type == RDT_UINT)
+      {
+         len = field->val.string.len < sizeof(idx->field)
+            ? field->val.string.len : sizeof(idx->field) - 1;
+         memcpy(idx->field, field->val.string.buff, len);
+         idx->field[len] = '\0';
+         idx->count      = count->val.uint_;
+      }
+
+      rv = 0;
+   }
+
+   rmsgpack_dom_value_free(&map);
+   return rv;
+}
+
+static void libretrodb_write_index_header(RFILE *fd, libretrodb_index_t *idx)
+{
+   rmsgpack_write_map_header(fd, 5);
+   rmsgpack_write_string(fd, "name", STRLEN_CONST("name"));
+   rmsgpack_write_string(fd, idx->name, (uint32_t)strlen(idx->name));
+   rmsgpack_write_string(fd, "field", STRLEN_CONST("field"));
+   rmsgpack_write_string(fd, idx->field, (uint32_t)strlen(idx->field));
+   rmsgpack_write_string(fd, "key_size", (uint32_t)STRLEN_CONST("key_size"));
+   rmsgpack_write_uint(fd, idx->key_size);
+   rmsgpack_write_string(fd, "count", STRLEN_CONST("count"));
+   rmsgpack_write_uint(fd, idx->count);
+   rmsgpack_write_string(fd, "next", STRLEN_CONST("next"));
+   rmsgpack_write_uint(fd, idx->next);
+}
+
+static int libretrodb_write_index(RFILE *fd, const char *name,
+      const char *field, libretrodb_index_builder_t *builder)
+{
+   size_t i;
+   libretrodb_index_t idx;
+
+   if (builder->too_large)
+      return -ERANGE;
+
+   qsort(builder->entries, builder->count,
+         sizeof(*builder->entries), libretrodb_index_entry_cmp);
+
+   strlcpy(idx.name,  name,  sizeof(idx.name));
+   strlcpy(idx.field, field, sizeof(idx.field));
+   idx.key_size = sizeof(uint32_t);
+   idx.count    = builder->count;
+   idx.next     = builder->count * LIBRETRODB_INDEX_ENTRY_SIZE;
+   libretrodb_write_index_header(fd, &idx);
+
+   for (i = 0; i < builder->count; i++)
+   {
+      builder->entries[i].key    = swap_if_little32(builder->entries[i].key);
+      builder->entries[i].offset = swap_if_little32(builder->entries[i].offset);
+   }
+
+   if (filestream_write(fd, builder->entries, (int64_t)idx.next)
+         != (int64_t)idx.next)
+      return -1;
+   return 0;
+}
+
+static int libretrodb_read_index_entry(RFILE *fd,
+      const libretrodb_index_t *idx, uint64_t i,
+      libretrodb_index_entry_t *entry)
+{
+   if (     filestream_seek(fd,
+               (int64_t)(idx->offset + i * LIBRETRODB_INDEX_ENTRY_SIZE),
+               RETRO_VFS_SEEK_POSITION_START) < 0
+         || filestream_read(fd, entry, LIBRETRODB_INDEX_ENTRY_SIZE)
+               != (int64_t)LIBRETRODB_INDEX_ENTRY_SIZE)
+      return -1;
+
+   entry->key    = swap_if_little32(entry->key);
+   entry->offset = swap_if_little32(entry->offset);
+   return 0;
+}
+
+/* Appends the offsets of the entries whose key is @key */
+static int libretrodb_index_lookup(RFILE *fd, const libretrodb_index_t *idx,
+      uint32_t key, libretrodb_index_builder_t *found)
+{
+   libretrodb_index_entry_t entry;
+   uint64_t lo = 0;
+   uint64_t hi = idx->count;
+
+   while (lo < hi)
+   {
+      uint64_t mid = lo + (hi - lo) / 2;
+
+      if (libretrodb_read_index_entry(fd, idx, mid, &entry) != 0)
+         return -1;
+
+      if (entry.key < key)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   for (; lo < idx->count; lo++)
+   {
+      if (libretrodb_read_index_entry(fd, idx, lo, &entry) != 0)
+         return -1;
+
+      if (entry.key != key)
+         break;
+
+      if (found->count == found->capacity)
+      {
+         size_t capacity                   = found->capacity
+            ? found->capacity * 2 : 16;
+         libretrodb_index_entry_t *entries = (libretrodb_index_entry_t*)
+            realloc(found->entries, capacity * sizeof(*entries));
+
+         if (!entries)
+            return -ENOMEM;
+
+         found->entries  = entries;
+         found->capacity = capacity;
+      }
+
+      found->entries[found->count++] = entry;
+   }
+
+   return 0;
+}
+
+static const libretrodb_index_t *libretrodb_get_index(libretrodb_t *db,
+      const char *field, size_t len)
+{
+   unsigned i;
+
+   for (i = 0; i < db->index_count; i++)
+   {
+      if (     strlen(db->indices[i].field) == len
+            && !strncmp(db->indices[i].field, field, len))
+         return &db->indices[i];
+   }
+
+   return NULL;
+}
+
+static void libretrodb_read_indices(libretrodb_t *db)
+{
+   int64_t size = filestream_get_size(db->fd);
+   int64_t pos  = (int64_t)db->first_index_offset;
+
+   db->index_count = 0;
+
+   while (pos < size && db->index_count < LIBRETRODB_MAX_INDICES)
+   {
+      libretrodb_index_t *idx = &db->indices[db->index_count];
+
+      if (     filestream_seek(db->fd, pos, RETRO_VFS_SEEK_POSITION_START) < 0
+            || libretrodb_read_index_header(db->fd, idx) != 0)
+         break;
+
+      idx->offset = (uint64_t)filestream_tell(db->fd);
+      pos         = (int64_t)(idx->offset + idx->next);
+
+      if (     idx->count
+            && idx->key_size == sizeof(uint32_t)
+            && idx->next     == idx->count * LIBRETRODB_INDEX_ENTRY_SIZE
+            && pos           <= size)
+         db->index_count++;
+   }
+}
+
 int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
       void *ctx)
 {
    int rv;
+   unsigned i;
    libretrodb_metadata_t md;
    static struct rmsgpack_dom_value sentinal;
    struct rmsgpack_dom_value item;
+   libretrodb_index_builder_t indices[
+      sizeof(libretrodb_indexed_fields) / sizeof(libretrodb_indexed_fields[0])];
    uint64_t item_count        = 0;
    libretrodb_header_t header = {{0}};
    ssize_t root               = filestream_tell(fd);
 
+   memset(indices, 0, sizeof(indices));
+
    memcpy(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)-1);
 
    /* We write the header in the end because we need to know the size of
@@ -153,9 +503,18 @@ int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
    item.type = RDT_NULL;
    while ((rv = value_provider(ctx, &item)) == 0)
    {
+      uint64_t offset = (uint64_t)(filestream_tell(fd) - root);
+
       if ((rv = libretrodb_validate_document(&item)) < 0)
          goto clean;
 
+      for (i = 0; i < sizeof(indices) / sizeof(indices[0]); i++)
+      {
+         if ((rv = libretrodb_index_add(&indices[i], &item,
+                     libretrodb_indexed_fields[i], offset)) < 0)
+            goto clean;
+      }
+
       if ((rv = rmsgpack_dom_write(fd, &item)) < 0)
          goto clean;
 
@@ -173,41 +532,37 @@ int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
    header.metadata_offset = swap_if_little64(filestream_tell(fd));
    md.count = item_count;
    libretrodb_write_metadata(fd, &md);
+
+   for (i = 0; i < sizeof(indices) / sizeof(indices[0]); i++)
+   {
+      if (     indices[i].count
+            && !indices[i].too_large
+            && libretrodb_write_index(fd, libretrodb_indexed_fields[i],
+               libretrodb_indexed_fields[i], &indices[i]) != 0)
+      {
+         rv = -EIO;
+         goto clean;
+      }
+   }
+
    filestream_seek(fd, root, RETRO_VFS_SEEK_POSITION_START);
    filestream_write(fd, &header, sizeof(header));
 clean:
+   for (i = 0; i < sizeof(indices) / sizeof(indices[0]); i++)
+      free(indices[i].entries);
    rmsgpack_dom_value_free(&item);
    return rv;
 }
 
-static int libretrodb_read_index_header(RFILE *fd, libretrodb_index_t *idx)
-{
-   uint64_t name_len = 50;
-   return rmsgpack_dom_read_into(fd,
-         "name", idx->name, &name_len,
-         "key_size", &idx->key_size,
-         "next", &idx->next, NULL);
-}
-
-static void libretrodb_write_index_header(RFILE *fd, libretrodb_index_t *idx)
-{
-   rmsgpack_write_map_header(fd, 3);
-   rmsgpack_write_string(fd, "name", STRLEN_CONST("name"));
-   rmsgpack_write_string(fd, idx->name, (uint32_t)strlen(idx->name));
-   rmsgpack_write_string(fd, "key_size", (uint32_t)STRLEN_CONST("key_size"));
-   rmsgpack_write_uint(fd, idx->key_size);
-   rmsgpack_write_string(fd, "next", STRLEN_CONST("next"));
-   rmsgpack_write_uint(fd, idx->next);
-}
-
 void libretrodb_close(libretrodb_t *db)
 {
    if (db->fd)
       filestream_close(db->fd);
    if (!string_is_empty(db->path))
       free(db->path);
-   db->path = NULL;
-   db->fd   = NULL;
+   db->path        = NULL;
+   db->fd          = NULL;
+   db->index_count = 0;
 }
 
 int libretrodb_open(const char *path, libretrodb_t *db)
@@ -253,6 +608,7 @@ int libretrodb_open(const char *path, libretrodb_t *db)
    db->count              = md.count;
    db->first_index_offset = filestream_tell(fd);
    db->fd                 = fd;
+   libretrodb_read_indices(db);
    return 0;
 
 error:
@@ -261,93 +617,56 @@ error:
    return rv;
 }
 
-static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
-      libretrodb_index_t *idx)
-{
-   ssize_t eof    = filestream_get_size(db->fd);
-   ssize_t offset = filestream_seek(db->fd,
-         (ssize_t)db->first_index_offset,
-         RETRO_VFS_SEEK_POSITION_START);
-
-   /* TODO: this should use filestream_eof instead */
-   while (offset < eof)
-   {
-      libretrodb_read_index_header(db->fd, idx);
-
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
-         return 0;
-
-      filestream_seek(db->fd, (ssize_t)idx->next,
-            RETRO_VFS_SEEK_POSITION_CURRENT);
-      offset = filestream_tell(db->fd);
-   }
-
-   return -1;
-}
-
-static int binsearch(const void *buff, const void *item,
-      uint64_t count, uint8_t field_size, uint64_t *offset)
+int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
+      const struct rmsgpack_dom_value *key, struct rmsgpack_dom_value *out)
 {
-   int mid            = (int)(count / 2);
-   int item_size      = field_size + sizeof(uint64_t);
-   uint64_t *current  = (uint64_t *)buff + (mid * item_size);
-   int rv             = memcmp(current, item, field_size);
+   size_t i;
+   uint32_t hash;
+   libretrodb_index_builder_t found;
+   const libretrodb_index_t *idx = NULL;
+   int rv                        = -1;
 
-   if (rv == 0)
+   for (i = 0; i < db->index_count; i++)
    {
-      *offset = *(uint64_t *)(current + field_size);
-      return 0;
+      if (string_is_equal(db->indices[i].name, index_name))
+      {
+         idx = &db->indices[i];
+         break;
+      }
    }
 
-   if (count == 0)
+   if (!idx || libretrodb_index_key(key, &hash) != 0)
       return -1;
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
-
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
-}
+   found.entries   = NULL;
+   found.count     = 0;
+   found.capacity  = 0;
+   found.too_large = 0;
 
-int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
-      const void *key, struct rmsgpack_dom_value *out)
-{
-   libretrodb_index_t idx;
-   int rv;
-   void *buff;
-   uint64_t offset;
-   ssize_t bufflen, nread = 0;
-
-   if (libretrodb_find_index(db, index_name, &idx) < 0)
-      return -1;
-
-   bufflen = idx.next;
-   buff    = malloc(bufflen);
+   if (libretrodb_index_lookup(db->fd, idx, hash, &found) == 0)
+   {
+      for (i = 0; i < found.count && rv != 0; i++)
+      {
+         const struct rmsgpack_dom_value *value = NULL;
 
-   if (!buff)
-      return -ENOMEM;
+         filestream_seek(db->fd, (int64_t)(db->root + found.entries[i].offset),
+               RETRO_VFS_SEEK_POSITION_START);
 
-   while (nread < bufflen)
-   {
-      void *buff_ = (uint64_t *)buff + nread;
-      rv          = (int)filestream_read(db->fd, buff_, bufflen - nread);
+         if (rmsgpack_dom_read(db->fd, out) < 0)
+            break;
 
-      if (rv <= 0)
-      {
-         free(buff);
-         return -errno;
+         /* Skip hash collisions */
+         if (     out->type == RDT_MAP
+               && (value = libretrodb_map_get(out, idx->field))
+               && rmsgpack_dom_value_cmp(value, key) == 0)
+            rv = 0;
+         else
+            rmsgpack_dom_value_free(out);
       }
-      nread += rv;
    }
 
-   rv = binsearch(buff, key, db->count, (ssize_t)idx.key_size, &offset);
-   free(buff);
-
-   if (rv == 0)
-      filestream_seek(db->fd, (ssize_t)offset,
-            RETRO_VFS_SEEK_POSITION_START);
-
-   return rmsgpack_dom_read(db->fd, out);
+   free(found.entries);
+   return rv;
 }
 
 /**
@@ -360,7 +679,10 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
+   cursor->eof        = 0;
+   cursor->offset_pos = 0;
+   cursor->data_pos   = (int64_t)(cursor->db->root
+         + sizeof(libretrodb_header_t));
    return (int)filestream_seek(cursor->fd,
          (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
          RETRO_VFS_SEEK_POSITION_START);
@@ -375,6 +697,19 @@ int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       return EOF;
 
 retry:
+   if (cursor->indexed)
+   {
+      if (cursor->offset_pos >= cursor->offset_count)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      filestream_seek(cursor->fd, (int64_t)(cursor->db->root
+               + cursor->offsets[cursor->offset_pos++]),
+            RETRO_VFS_SEEK_POSITION_START);
+   }
+
    rv = rmsgpack_dom_read(cursor->fd, out);
    if (rv < 0)
       return rv;
@@ -397,6 +732,52 @@ retry:
    return 0;
 }
 
+int libretrodb_cursor_read_item_view(libretrodb_cursor_t *cursor,
+      const uint8_t **item, size_t *len)
+{
+   int64_t size;
+   struct rmsgpack_dom_value v;
+
+   if (cursor->query)
+      return -EINVAL;
+
+   if (cursor->eof)
+      return EOF;
+
+   /* One read instead of one per value, the entries are
+    * then decoded in place */
+   if (!cursor->data)
+   {
+      void *data = NULL;
+
+      if (!filestream_read_file(cursor->db->path, &data, &cursor->data_size))
+         return -EIO;
+
+      cursor->data = (uint8_t*)data;
+   }
+
+   if (cursor->data_pos >= cursor->data_size)
+      return -EINVAL;
+
+   if ((size = rmsgpack_dom_view_size(cursor->data + cursor->data_pos,
+               (size_t)(cursor->data_size - cursor->data_pos))) < 0)
+      return (int)size;
+
+   rmsgpack_dom_view_read(cursor->data + cursor->data_pos,
+         (size_t)size, &v);
+
+   if (v.type == RDT_NULL)
+   {
+      cursor->eof = 1;
+      return EOF;
+   }
+
+   *item             = cursor->data + cursor->data_pos;
+   *len              = (size_t)size;
+   cursor->data_pos += size;
+   return 0;
+}
+
 /**
  * libretrodb_cursor_close:
  * @cursor              : Handle to database cursor.
@@ -414,11 +795,105 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
-   cursor->eof      = 1;
-   cursor->fd       = NULL;
-   cursor->db       = NULL;
-   cursor->query    = NULL;
+   if (cursor->offsets)
+      free(cursor->offsets);
+
+   if (cursor->data)
+      free(cursor->data);
+
+   cursor->is_valid     = 0;
+   cursor->eof          = 1;
+   cursor->fd           = NULL;
+   cursor->db           = NULL;
+   cursor->query        = NULL;
+   cursor->offsets      = NULL;
+   cursor->offset_count = 0;
+   cursor->indexed      = 0;
+   cursor->data         = NULL;
+   cursor->data_size    = 0;
+}
+
+static int libretrodb_offset_cmp(const void *a, const void *b)
+{
+   uint64_t oa = *(const uint64_t*)a;
+   uint64_t ob = *(const uint64_t*)b;
+   if (oa != ob)
+      return (oa < ob) ? -1 : 1;
+   return 0;
+}
+
+/* Picks the first field of the query that has an index and
+ * is restricted to a few values, and makes the cursor read
+ * only the entries that are listed for them. The query
+ * still filters these. */
+static void libretrodb_cursor_use_index(libretrodb_cursor_t *cursor)
+{
+   unsigned i;
+   int count;
+   const struct rmsgpack_dom_value *field;
+   const struct rmsgpack_dom_value *values[LIBRETRODB_MAX_LOOKUP_VALUES];
+
+   for (i = 0; (count = libretrodb_query_get_constraint(cursor->query, i,
+               &field, values, LIBRETRODB_MAX_LOOKUP_VALUES)) >= 0; i++)
+   {
+      int j;
+      size_t k, n;
+      libretrodb_index_builder_t found;
+      const libretrodb_index_t *idx = NULL;
+
+      if (     count == 0
+            || field->type != RDT_STRING
+            || !(idx = libretrodb_get_index(cursor->db,
+                  field->val.string.buff, field->val.string.len)))
+         continue;
+
+      found.entries   = NULL;
+      found.count     = 0;
+      found.capacity  = 0;
+      found.too_large = 0;
+
+      for (j = 0; j < count; j++)
+      {
+         uint32_t key;
+         if (     libretrodb_index_key(values[j], &key) != 0
+               || libretrodb_index_lookup(cursor->fd, idx, key, &found) != 0)
+            break;
+      }
+
+      /* Values that can't be indexed or a read error,
+       * try the next field */
+      if (j < count)
+      {
+         free(found.entries);
+         continue;
+      }
+
+      cursor->offsets = (uint64_t*)malloc(
+            (found.count ? found.count : 1) * sizeof(uint64_t));
+
+      if (!cursor->offsets)
+      {
+         free(found.entries);
+         break;
+      }
+
+      for (k = 0; k < found.count; k++)
+         cursor->offsets[k] = found.entries[k].offset;
+      free(found.entries);
+
+      /* Read in database order and only once, even when
+       * several values hash alike */
+      qsort(cursor->offsets, found.count, sizeof(uint64_t),
+            libretrodb_offset_cmp);
+
+      for (k = 0, n = 0; k < found.count; k++)
+         if (n == 0 || cursor->offsets[n - 1] != cursor->offsets[k])
+            cursor->offsets[n++] = cursor->offsets[k];
+
+      cursor->offset_count = n;
+      cursor->indexed      = 1;
+      break;
+   }
 }
 
 /**
@@ -446,133 +921,76 @@ int libretrodb_cursor_open(libretrodb_t *db,
    if (!fd)
       return -errno;
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
+   cursor->fd           = fd;
+   cursor->db           = db;
+   cursor->is_valid     = 1;
+   cursor->offsets      = NULL;
+   cursor->offset_count = 0;
+   cursor->indexed      = 0;
+   cursor->data         = NULL;
+   cursor->data_size    = 0;
    libretrodb_cursor_reset(cursor);
-   cursor->query    = q;
+   cursor->query        = q;
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
+      libretrodb_cursor_use_index(cursor);
+   }
 
    return 0;
 }
 
-static int node_iter(void *value, void *ctx)
-{
-   struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
-
-   if (filestream_write(nictx->db->fd, value,
-            (ssize_t)(nictx->idx->key_size + sizeof(uint64_t))) > 0)
-      return 0;
-
-   return -1;
-}
-
-static uint64_t libretrodb_tell(libretrodb_t *db)
-{
-   return filestream_tell(db->fd);
-}
-
-static int node_compare(const void *a, const void *b, void *ctx)
-{
-   return memcmp(a, b, *(uint8_t *)ctx);
-}
-
 int libretrodb_create_index(libretrodb_t *db,
       const char *name, const char *field_name)
 {
-   struct node_iter_ctx nictx;
-   struct rmsgpack_dom_value key;
-   libretrodb_index_t idx;
+   libretrodb_index_builder_t builder;
    struct rmsgpack_dom_value item;
-   libretrodb_cursor_t cur          = {0};
-   struct rmsgpack_dom_value *field = NULL;
-   void *buff                       = NULL;
-   uint64_t *buff_u64               = NULL;
-   uint8_t field_size               = 0;
-   uint64_t item_loc                = libretrodb_tell(db);
-   bintree_t *tree                  = bintree_new(node_compare, &field_size);
+   libretrodb_cursor_t cur = {0};
+   RFILE *fd               = NULL;
+   int rv                  = -1;
 
-   item.type                        = RDT_NULL;
-
-   if (!tree || (libretrodb_cursor_open(db, &cur, NULL) != 0))
-      goto clean;
+   builder.entries         = NULL;
+   builder.count           = 0;
+   builder.capacity        = 0;
+   builder.too_large       = 0;
+   item.type               = RDT_NULL;
 
-   key.type            = RDT_STRING;
-   key.val.string.len  = (uint32_t)strlen(field_name);
-   key.val.string.buff = (char *) field_name;   /* We know we aren't going to change it */
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
+      return -1;
 
-   while (libretrodb_cursor_read_item(&cur, &item) == 0)
+   for (;;)
    {
-      /* Only map keys are supported */
-      if (item.type != RDT_MAP)
-         goto clean;
+      uint64_t offset = (uint64_t)filestream_tell(cur.fd) - db->root;
 
-      field = rmsgpack_dom_value_map_value(&item, &key);
+      if (libretrodb_cursor_read_item(&cur, &item) != 0)
+         break;
 
-      /* Field not found in item */
-      if (!field)
+      if (libretrodb_index_add(&builder, &item, field_name, offset) != 0)
          goto clean;
 
-      /* Field is not binary */
-      if (field->type != RDT_BINARY)
-         goto clean;
-
-      /* Field is empty */
-      if (field->val.binary.len == 0)
-         goto clean;
-
-      if (field_size == 0)
-         field_size = field->val.binary.len;
-      /* Field is not of correct size */
-      else if (field->val.binary.len != field_size) 
-         goto clean;
-
-      buff = malloc(field_size + sizeof(uint64_t));
-      if (!buff)
-         goto clean;
-
-      memcpy(buff, field->val.binary.buff, field_size);
-
-      buff_u64 = (uint64_t *)buff + field_size;
-
-      memcpy(buff_u64, &item_loc, sizeof(uint64_t));
-
-      /* Value is not unique? */
-      if (bintree_insert(tree, buff) != 0)
-      {
-         rmsgpack_dom_value_print(field);
-         goto clean;
-      }
-      buff     = NULL;
       rmsgpack_dom_value_free(&item);
-      item_loc = libretrodb_tell(db);
    }
 
-   filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
-
-   strncpy(idx.name, name, 50);
+   /* The database itself is opened read only */
+   if (!(fd = filestream_open(db->path,
+               RETRO_VFS_FILE_ACCESS_READ_WRITE
+             | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      goto clean;
 
-   idx.name[49] = '\0';
-   idx.key_size = field_size;
-   idx.next     = db->count * (field_size + sizeof(uint64_t));
-   libretrodb_write_index_header(db->fd, &idx);
+   filestream_seek(fd, 0, RETRO_VFS_SEEK_POSITION_END);
+   rv = libretrodb_write_index(fd, name, field_name, &builder);
+   filestream_close(fd);
 
-   nictx.db     = db;
-   nictx.idx    = &idx;
-   bintree_iterate(tree, node_iter, &nictx);
+   if (rv == 0)
+      libretrodb_read_indices(db);
 
 clean:
    rmsgpack_dom_value_free(&item);
-   if (buff)
-      free(buff);
-   if (cur.is_valid)
-      libretrodb_cursor_close(&cur);
-   if (tree)
-      bintree_free(tree);
-   free(tree);
-   return 0;
+   free(builder.entries);
+   libretrodb_cursor_close(&cur);
+   return rv;
 }
 
 libretrodb_cursor_t *libretrodb_cursor_new(void)
@@ -588,6 +1006,13 @@ libretrodb_cursor_t *libretrodb_cursor_new(void)
    dbc->eof                 = 0;
    dbc->query               = NULL;
    dbc->db                  = NULL;
+   dbc->offsets             = NULL;
+   dbc->offset_count        = 0;
+   dbc->offset_pos          = 0;
+   dbc->indexed             = 0;
+   dbc->data                = NULL;
+   dbc->data_size           = 0;
+   dbc->data_pos            = 0;
 
    return dbc;
 }
@@ -612,6 +1037,7 @@ libretrodb_t *libretrodb_new(void)
    db->count              = 0;
    db->first_index_offset = 0;
    db->path               = NULL;
+   db->index_count        = 0;
 
    return db;
 }
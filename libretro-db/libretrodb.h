@@ -51,11 +51,34 @@ void libretrodb_close(libretrodb_t *db);
 
 int libretrodb_open(const char *path, libretrodb_t *db);
 
+/**
+ * libretrodb_create_index:
+ * @db                  : Handle to database.
+ * @name                : Name of the index.
+ * @field_name          : Field to index.
+ *
+ * Appends an index of @field_name to the database file.
+ * libretrodb_create() already indexes the fields RetroArch
+ * looks entries up by. Queries that restrict an indexed
+ * field to one or a few values only read the matching
+ * entries.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
 int libretrodb_create_index(libretrodb_t *db, const char *name,
       const char *field_name);
 
+/**
+ * libretrodb_find_entry:
+ * @db                  : Handle to database.
+ * @index_name          : Name of the index to use.
+ * @key                 : Value of the indexed field.
+ * @out                 : First entry with that value.
+ *
+ * Returns: 0 if an entry was found, otherwise negative.
+ **/
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
-        const void *key, struct rmsgpack_dom_value *out);
+      const struct rmsgpack_dom_value *key, struct rmsgpack_dom_value *out);
 
 libretrodb_t *libretrodb_new(void);
 
@@ -105,6 +128,23 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_cursor_read_item_view:
+ * @cursor              : Handle to database cursor, opened without a query.
+ * @item                : Encoded entry.
+ * @len                 : Size of @item.
+ *
+ * Like libretrodb_cursor_read_item(), but leaves the entry encoded,
+ * its fields can be decoded in place on access with
+ * rmsgpack_dom_view_map_value(). The file is read into memory on
+ * the first call, @item stays valid until the cursor is closed.
+ *
+ * Returns: 0 if successful, EOF after the last entry, otherwise
+ * negative.
+ **/
+int libretrodb_cursor_read_item_view(libretrodb_cursor_t *cursor,
+      const uint8_t **item, size_t *len);
+
 RETRO_END_DECLS
 
 #endif
@@ -172,7 +172,11 @@ int main(int argc, char ** argv)
       index_name = argv[3];
       field_name = argv[4];
 
-      libretrodb_create_index(db, index_name, field_name);
+      if ((rv = libretrodb_create_index(db, index_name, field_name)) != 0)
+      {
+         printf("Could not create index on '%s'\n", field_name);
+         goto error;
+      }
    }
    else
    {
@@ -999,3 +999,45 @@ int libretrodb_query_filter(libretrodb_query_t *q,
    struct rmsgpack_dom_value res = inv.func(*v, inv.argc, inv.argv);
    return (res.type == RDT_BOOL && res.val.bool_);
 }
+
+int libretrodb_query_get_constraint(libretrodb_query_t *q, unsigned i,
+      const struct rmsgpack_dom_value **field,
+      const struct rmsgpack_dom_value **values, unsigned max)
+{
+   unsigned j;
+   const struct argument *arg;
+   struct query *rq = (struct query*)q;
+
+   /* Only the fields of a top level table are
+    * ANDed together */
+   if (     rq->root.func != query_func_all_map
+         || 2 * i + 1 >= rq->root.argc)
+      return -1;
+
+   *field = &rq->root.argv[2 * i].a.value;
+   arg    = &rq->root.argv[2 * i + 1];
+
+   /* A nil value also matches entries without the
+    * field, which an index doesn't know about */
+   if (arg->type == AT_VALUE)
+   {
+      if (max < 1 || arg->a.value.type == RDT_NULL)
+         return 0;
+      values[0] = &arg->a.value;
+      return 1;
+   }
+
+   if (     arg->a.invocation.func != query_func_operator_or
+         || arg->a.invocation.argc > max)
+      return 0;
+
+   for (j = 0; j < arg->a.invocation.argc; j++)
+   {
+      const struct argument *alt = &arg->a.invocation.argv[j];
+      if (alt->type != AT_VALUE || alt->a.value.type == RDT_NULL)
+         return 0;
+      values[j] = &alt->a.value;
+   }
+
+   return (int)arg->a.invocation.argc;
+}
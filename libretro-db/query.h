@@ -38,6 +38,24 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/**
+ * libretrodb_query_get_constraint:
+ * @q                   : Compiled query.
+ * @i                   : Position of the field in the query's table.
+ * @field               : Name of the field.
+ * @values              : Values the field has to be equal to one of.
+ * @max                 : Capacity of @values.
+ *
+ * Tells which values a field can have in entries that pass the
+ * query, so these can be looked up in an index.
+ *
+ * Returns: number of @values, 0 if the field isn't restricted to
+ * a fixed set of values, or -1 once @i is past the last field.
+ **/
+int libretrodb_query_get_constraint(libretrodb_query_t *q, unsigned i,
+      const struct rmsgpack_dom_value **field,
+      const struct rmsgpack_dom_value **values, unsigned max);
+
 RETRO_END_DECLS
 
 #endif
@@ -27,6 +27,39 @@
 
 #include <streams/file_stream.h>
 
+/* Format bytes */
+#define _MPF_FIXMAP     0x80
+#define _MPF_MAP16      0xde
+#define _MPF_MAP32      0xdf
+
+#define _MPF_FIXARRAY   0x90
+#define _MPF_ARRAY16    0xdc
+#define _MPF_ARRAY32    0xdd
+
+#define _MPF_FIXSTR     0xa0
+#define _MPF_STR8       0xd9
+#define _MPF_STR16      0xda
+#define _MPF_STR32      0xdb
+
+#define _MPF_BIN8       0xc4
+#define _MPF_BIN16      0xc5
+#define _MPF_BIN32      0xc6
+
+#define _MPF_FALSE      0xc2
+#define _MPF_TRUE       0xc3
+
+#define _MPF_INT8       0xd0
+#define _MPF_INT16      0xd1
+#define _MPF_INT32      0xd2
+#define _MPF_INT64      0xd3
+
+#define _MPF_UINT8      0xcc
+#define _MPF_UINT16     0xcd
+#define _MPF_UINT32     0xce
+#define _MPF_UINT64     0xcf
+
+#define _MPF_NIL        0xc0
+
 struct rmsgpack_read_callbacks
 {
    int (*read_nil        )(void *);
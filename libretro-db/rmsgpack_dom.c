@@ -505,3 +505,207 @@ clean:
    rmsgpack_dom_value_free(&map);
    return 0;
 }
+
+/* Big endian unsigned of @size bytes */
+static uint64_t dom_view_uint(const uint8_t *buf, size_t size)
+{
+   size_t i;
+   uint64_t value = 0;
+
+   for (i = 0; i < size; i++)
+      value = (value << 8) | buf[i];
+
+   return value;
+}
+
+int64_t rmsgpack_dom_view_read(const uint8_t *buf, size_t len,
+      struct rmsgpack_dom_value *out)
+{
+   uint8_t type;
+   size_t size;
+   uint64_t value;
+
+   if (len < 1)
+      return -EINVAL;
+
+   type = buf[0];
+
+   if (type < _MPF_FIXMAP)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = type;
+      return 1;
+   }
+   else if (type < _MPF_FIXARRAY)
+   {
+      out->type          = RDT_MAP;
+      out->val.map.len   = type - _MPF_FIXMAP;
+      out->val.map.items = NULL;
+      return 1;
+   }
+   else if (type < _MPF_FIXSTR)
+   {
+      out->type            = RDT_ARRAY;
+      out->val.array.len   = type - _MPF_FIXARRAY;
+      out->val.array.items = NULL;
+      return 1;
+   }
+   else if (type < _MPF_NIL)
+   {
+      size = type - _MPF_FIXSTR;
+      if (len < 1 + size)
+         return -EINVAL;
+      out->type            = RDT_STRING;
+      out->val.string.len  = (uint32_t)size;
+      out->val.string.buff = (char*)buf + 1;
+      return (int64_t)(1 + size);
+   }
+   else if (type > _MPF_MAP32)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = (int8_t)type;
+      return 1;
+   }
+
+   switch (type)
+   {
+      case _MPF_NIL:
+         out->type = RDT_NULL;
+         return 1;
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+         out->type      = RDT_BOOL;
+         out->val.bool_ = (type == _MPF_TRUE);
+         return 1;
+      case _MPF_BIN8:
+      case _MPF_BIN16:
+      case _MPF_BIN32:
+      case _MPF_STR8:
+      case _MPF_STR16:
+      case _MPF_STR32:
+         size = (size_t)1 << ((type >= _MPF_STR8)
+               ? type - _MPF_STR8 : type - _MPF_BIN8);
+         if (len < 1 + size)
+            return -EINVAL;
+         value = dom_view_uint(buf + 1, size);
+         if (value > len - 1 - size)
+            return -EINVAL;
+         out->type            = (type >= _MPF_STR8) ? RDT_STRING : RDT_BINARY;
+         out->val.string.len  = (uint32_t)value;
+         out->val.string.buff = (char*)buf + 1 + size;
+         return (int64_t)(1 + size + value);
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         size = (size_t)1 << (type - _MPF_UINT8);
+         if (len < 1 + size)
+            return -EINVAL;
+         out->type      = RDT_UINT;
+         out->val.uint_ = dom_view_uint(buf + 1, size);
+         return (int64_t)(1 + size);
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         size = (size_t)1 << (type - _MPF_INT8);
+         if (len < 1 + size)
+            return -EINVAL;
+         value     = dom_view_uint(buf + 1, size);
+         out->type = RDT_INT;
+         /* Sign extend */
+         if (size < 8 && (value >> (size * 8 - 1)))
+            value |= ~(uint64_t)0 << (size * 8);
+         out->val.int_ = (int64_t)value;
+         return (int64_t)(1 + size);
+      case _MPF_ARRAY16:
+      case _MPF_ARRAY32:
+      case _MPF_MAP16:
+      case _MPF_MAP32:
+         size = (type == _MPF_ARRAY16 || type == _MPF_MAP16) ? 2 : 4;
+         if (len < 1 + size)
+            return -EINVAL;
+         value = dom_view_uint(buf + 1, size);
+         if (type == _MPF_ARRAY16 || type == _MPF_ARRAY32)
+         {
+            out->type            = RDT_ARRAY;
+            out->val.array.len   = (uint32_t)value;
+            out->val.array.items = NULL;
+         }
+         else
+         {
+            out->type          = RDT_MAP;
+            out->val.map.len   = (uint32_t)value;
+            out->val.map.items = NULL;
+         }
+         return (int64_t)(1 + size);
+   }
+
+   return -EINVAL;
+}
+
+static int64_t dom_view_size(const uint8_t *buf, size_t len, int depth)
+{
+   uint64_t i, items;
+   struct rmsgpack_dom_value v;
+   int64_t size = rmsgpack_dom_view_read(buf, len, &v);
+
+   if (size < 0 || (v.type != RDT_MAP && v.type != RDT_ARRAY))
+      return size;
+
+   if (depth >= MAX_DEPTH)
+      return -EINVAL;
+
+   items = (v.type == RDT_MAP)
+      ? (uint64_t)v.val.map.len * 2 : v.val.array.len;
+
+   for (i = 0; i < items; i++)
+   {
+      int64_t item = dom_view_size(buf + size, len - (size_t)size, depth + 1);
+      if (item < 0)
+         return item;
+      size += item;
+   }
+
+   return size;
+}
+
+int64_t rmsgpack_dom_view_size(const uint8_t *buf, size_t len)
+{
+   return dom_view_size(buf, len, 0);
+}
+
+int rmsgpack_dom_view_map_value(const uint8_t *buf, size_t len,
+      const char *key, struct rmsgpack_dom_value *out)
+{
+   uint32_t i;
+   struct rmsgpack_dom_value map;
+   size_t key_len = strlen(key);
+   int64_t pos    = rmsgpack_dom_view_read(buf, len, &map);
+
+   if (pos < 0 || map.type != RDT_MAP)
+      return -EINVAL;
+
+   for (i = 0; i < map.val.map.len; i++)
+   {
+      struct rmsgpack_dom_value k;
+      int64_t size = rmsgpack_dom_view_read(buf + pos, len - (size_t)pos, &k);
+
+      if (size < 0)
+         return -EINVAL;
+      pos += size;
+
+      if (     k.type == RDT_STRING
+            && k.val.string.len == key_len
+            && !memcmp(k.val.string.buff, key, key_len))
+         return (rmsgpack_dom_view_read(buf + pos,
+                  len - (size_t)pos, out) < 0) ? -EINVAL : 0;
+
+      /* Skip the value */
+      if ((size = rmsgpack_dom_view_size(buf + pos, len - (size_t)pos)) < 0)
+         return -EINVAL;
+      pos += size;
+   }
+
+   return -1;
+}
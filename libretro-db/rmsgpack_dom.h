@@ -95,6 +95,42 @@ int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
 
+/**
+ * rmsgpack_dom_view_read:
+ * @buf                 : Encoded value.
+ * @len                 : Size of @buf.
+ * @out                 : Decoded value.
+ *
+ * Decodes a value that is already in memory without copying it.
+ * Strings and binaries in @out point into @buf and are not NUL
+ * terminated. Maps and arrays only get their length, the items
+ * follow in @buf. Nothing is allocated, @out is not to be freed.
+ *
+ * Returns: size of the value, or of the header of a map or
+ * array, negative if @buf is truncated or not valid.
+ **/
+int64_t rmsgpack_dom_view_read(const uint8_t *buf, size_t len,
+      struct rmsgpack_dom_value *out);
+
+/* Size of the value at @buf including all of its items,
+ * negative if @buf is truncated or not valid */
+int64_t rmsgpack_dom_view_size(const uint8_t *buf, size_t len);
+
+/**
+ * rmsgpack_dom_view_map_value:
+ * @buf                 : Encoded map.
+ * @len                 : Size of @buf.
+ * @key                 : Key to look up.
+ * @out                 : Value of @key, see rmsgpack_dom_view_read().
+ *
+ * Looks a key up in an encoded map, skipping the other values
+ * without decoding them.
+ *
+ * Returns: 0 if the key was found, otherwise negative.
+ **/
+int rmsgpack_dom_view_map_value(const uint8_t *buf, size_t len,
+      const char *key, struct rmsgpack_dom_value *out);
+
 RETRO_END_DECLS
 
 #endif
@@ -0,0 +1,413 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rmsgpack_dom_test.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Checks the in place reader, rmsgpack_dom_view_*() and
+ * libretrodb_cursor_read_item_view(), against rmsgpack_dom_read().
+ *
+ * Every entry of a database is read both ways and must decode to
+ * the same values, down to each item of its maps and arrays, and
+ * each key of a map must be found by rmsgpack_dom_view_map_value().
+ *
+ * Without arguments a database of synthetic entries is written
+ * first, covering every format the writer produces. Real databases
+ * can be given instead. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <streams/file_stream.h>
+
+#include "libretrodb.h"
+#include "rmsgpack_dom.h"
+
+#define TEST_DB_PATH    "rmsgpack_dom_test.rdb"
+#define TEST_DB_ENTRIES 256
+
+static const char *test_path;
+static unsigned test_entry;
+
+static int test_fail(const char *what)
+{
+   fprintf(stderr, "%s: entry %u: %s\n", test_path, test_entry, what);
+   return -1;
+}
+
+/* Compares one decoded value, maps and arrays only by length */
+static int compare_decoded(const struct rmsgpack_dom_value *view,
+      const struct rmsgpack_dom_value *dom)
+{
+   if (view->type != dom->type)
+      return test_fail("type differs");
+
+   switch (dom->type)
+   {
+      case RDT_NULL:
+         break;
+      case RDT_BOOL:
+         if (!view->val.bool_ != !dom->val.bool_)
+            return test_fail("bool differs");
+         break;
+      case RDT_UINT:
+         if (view->val.uint_ != dom->val.uint_)
+            return test_fail("uint differs");
+         break;
+      case RDT_INT:
+         if (view->val.int_ != dom->val.int_)
+            return test_fail("int differs");
+         break;
+      case RDT_STRING:
+      case RDT_BINARY:
+         if (     view->val.string.len != dom->val.string.len
+               || memcmp(view->val.string.buff, dom->val.string.buff,
+                  dom->val.string.len))
+            return test_fail("string or binary differs");
+         break;
+      case RDT_MAP:
+         if (view->val.map.len != dom->val.map.len)
+            return test_fail("map length differs");
+         break;
+      case RDT_ARRAY:
+         if (view->val.array.len != dom->val.array.len)
+            return test_fail("array length differs");
+         break;
+   }
+
+   return 0;
+}
+
+/* Compares the value at @buf with @dom, item by item.
+ * Returns its size, negative if they differ. */
+static int64_t compare_value(const uint8_t *buf, size_t len,
+      const struct rmsgpack_dom_value *dom)
+{
+   uint32_t i;
+   int64_t item;
+   struct rmsgpack_dom_value view;
+   int64_t size = rmsgpack_dom_view_read(buf, len, &view);
+
+   if (size < 0)
+      return test_fail("view read failed");
+
+   if (compare_decoded(&view, dom) < 0)
+      return -1;
+
+   if (dom->type == RDT_MAP)
+   {
+      /* rmsgpack_dom_read() fills maps and arrays back to front */
+      for (i = dom->val.map.len; i-- > 0; )
+      {
+         char key[256];
+         const struct rmsgpack_dom_pair *pair = &dom->val.map.items[i];
+
+         if ((item = compare_value(buf + size, len - (size_t)size,
+                     &pair->key)) < 0)
+            return -1;
+         size += item;
+
+         if ((item = compare_value(buf + size, len - (size_t)size,
+                     &pair->value)) < 0)
+            return -1;
+         size += item;
+
+         if (     pair->key.type != RDT_STRING
+               || pair->key.val.string.len >= sizeof(key))
+            continue;
+
+         memcpy(key, pair->key.val.string.buff, pair->key.val.string.len);
+         key[pair->key.val.string.len] = '\0';
+
+         if (rmsgpack_dom_view_map_value(buf, len, key, &view) != 0)
+            return test_fail("map key not found");
+         if (compare_decoded(&view, &pair->value) < 0)
+            return -1;
+      }
+
+      if (rmsgpack_dom_view_map_value(buf, len, "$missing", &view) == 0)
+         return test_fail("missing map key found");
+   }
+   else if (dom->type == RDT_ARRAY)
+   {
+      for (i = dom->val.array.len; i-- > 0; )
+      {
+         if ((item = compare_value(buf + size, len - (size_t)size,
+                     &dom->val.array.items[i])) < 0)
+            return -1;
+         size += item;
+      }
+   }
+
+   if (rmsgpack_dom_view_size(buf, len) != size)
+      return test_fail("view size differs");
+
+   return size;
+}
+
+static int compare_db(const char *path)
+{
+   int rv, view_rv;
+   const uint8_t *buf;
+   size_t len;
+   struct rmsgpack_dom_value item;
+   libretrodb_t *db               = libretrodb_new();
+   libretrodb_cursor_t *cur       = libretrodb_cursor_new();
+   libretrodb_cursor_t *view_cur  = libretrodb_cursor_new();
+   int ret                        = -1;
+
+   test_path  = path;
+   test_entry = 0;
+
+   if (!db || !cur || !view_cur)
+      goto end;
+
+   if (     libretrodb_open(path, db) != 0
+         || libretrodb_cursor_open(db, cur, NULL) != 0
+         || libretrodb_cursor_open(db, view_cur, NULL) != 0)
+   {
+      fprintf(stderr, "Could not open %s\n", path);
+      goto end;
+   }
+
+   for (;;)
+   {
+      rv      = libretrodb_cursor_read_item(cur, &item);
+      view_rv = libretrodb_cursor_read_item_view(view_cur, &buf, &len);
+
+      if (rv != 0 || view_rv != 0)
+      {
+         if (rv != EOF || view_rv != EOF)
+         {
+            test_fail("cursors disagree on the number of entries");
+            if (rv == 0)
+               rmsgpack_dom_value_free(&item);
+            goto end;
+         }
+         break;
+      }
+
+      if (compare_value(buf, len, &item) != (int64_t)len)
+      {
+         test_fail("entry size differs");
+         rmsgpack_dom_value_free(&item);
+         goto end;
+      }
+
+      rmsgpack_dom_value_free(&item);
+      test_entry++;
+   }
+
+   printf("%s: %u entries match\n", path, test_entry);
+   ret = 0;
+
+end:
+   if (view_cur)
+   {
+      libretrodb_cursor_close(view_cur);
+      libretrodb_cursor_free(view_cur);
+   }
+   if (cur)
+   {
+      libretrodb_cursor_close(cur);
+      libretrodb_cursor_free(cur);
+   }
+   if (db)
+   {
+      libretrodb_close(db);
+      libretrodb_free(db);
+   }
+   return ret;
+}
+
+static void set_string(struct rmsgpack_dom_value *v,
+      enum rmsgpack_dom_type type, const char *s, uint32_t len)
+{
+   v->type            = type;
+   v->val.string.len  = len;
+   v->val.string.buff = (char*)malloc(len + 1);
+   memcpy(v->val.string.buff, s, len);
+   v->val.string.buff[len] = '\0';
+}
+
+static void set_filled(struct rmsgpack_dom_value *v,
+      enum rmsgpack_dom_type type, uint32_t len, unsigned seed)
+{
+   uint32_t i;
+
+   v->type            = type;
+   v->val.string.len  = len;
+   v->val.string.buff = (char*)malloc(len + 1);
+   for (i = 0; i < len; i++)
+      v->val.string.buff[i] = (char)('a' + (i + seed) % 26);
+   v->val.string.buff[len] = '\0';
+}
+
+static void set_array(struct rmsgpack_dom_value *v, uint32_t len)
+{
+   v->type            = RDT_ARRAY;
+   v->val.array.len   = len;
+   v->val.array.items = (struct rmsgpack_dom_value*)
+      calloc(len ? len : 1, sizeof(*v->val.array.items));
+}
+
+static void set_map(struct rmsgpack_dom_value *v, uint32_t len)
+{
+   v->type          = RDT_MAP;
+   v->val.map.len   = len;
+   v->val.map.items = (struct rmsgpack_dom_pair*)
+      calloc(len ? len : 1, sizeof(*v->val.map.items));
+}
+
+static void set_key(struct rmsgpack_dom_value *map, uint32_t i,
+      const char *key)
+{
+   set_string(&map->val.map.items[i].key, RDT_STRING, key,
+         (uint32_t)strlen(key));
+}
+
+/* Every width of every format, and the edges between them */
+static int synthetic_provider(void *ctx, struct rmsgpack_dom_value *out)
+{
+   static const int64_t ints[]   = {
+      0, 1, 127, -1, -31, -32, -33, -128, -129, -32768, -32769,
+      -2147483647 - 1, (int64_t)-2147483647 - 2, INT64_MIN };
+   static const uint64_t uints[] = {
+      0, 255, 256, 65535, 65536, 4294967295U,
+      (uint64_t)4294967295U + 1, UINT64_MAX };
+   static const uint32_t lens[]  = { 0, 1, 31, 32, 255, 256, 65535, 65536 };
+   uint8_t crc[4];
+   uint32_t i;
+   struct rmsgpack_dom_value *v;
+   unsigned *n = (unsigned*)ctx;
+   unsigned e  = *n;
+
+   if (e >= TEST_DB_ENTRIES)
+      return 1;
+   (*n)++;
+
+   crc[0] = (uint8_t)e;
+   crc[1] = (uint8_t)(e >> 8);
+   crc[2] = 0xc0;
+   crc[3] = 0xde;
+
+   set_map(out, 9);
+
+   set_key(out, 0, "name");
+   set_filled(&out->val.map.items[0].value, RDT_STRING,
+         lens[e % (sizeof(lens) / sizeof(lens[0]))], e);
+
+   set_key(out, 1, "crc");
+   set_string(&out->val.map.items[1].value, RDT_BINARY,
+         (const char*)crc, sizeof(crc));
+
+   set_key(out, 2, "int");
+   v             = &out->val.map.items[2].value;
+   v->type       = RDT_INT;
+   v->val.int_   = ints[e % (sizeof(ints) / sizeof(ints[0]))];
+
+   set_key(out, 3, "uint");
+   v             = &out->val.map.items[3].value;
+   v->type       = RDT_UINT;
+   v->val.uint_  = uints[e % (sizeof(uints) / sizeof(uints[0]))];
+
+   /* Only false, rmsgpack_write_bool() follows true with a
+    * stray false */
+   set_key(out, 4, "bool");
+   v             = &out->val.map.items[4].value;
+   v->type       = RDT_BOOL;
+   v->val.bool_  = 0;
+
+   set_key(out, 5, "nil");
+   out->val.map.items[5].value.type = RDT_NULL;
+
+   set_key(out, 6, "blob");
+   set_filled(&out->val.map.items[6].value, RDT_BINARY,
+         lens[(e / 3) % (sizeof(lens) / sizeof(lens[0]))], e);
+
+   /* 15 and 16 items straddle the fixarray and array16 formats.
+    * array32 is left out, rmsgpack_dom_read() can't hold that
+    * many items. */
+   set_key(out, 7, "array");
+   v = &out->val.map.items[7].value;
+   set_array(v, e % 20);
+   for (i = 0; i < v->val.array.len; i++)
+   {
+      v->val.array.items[i].type      = RDT_UINT;
+      v->val.array.items[i].val.uint_ = (uint64_t)i * 1000;
+   }
+
+   /* Nested map of strings, same for fixmap and map16 */
+   set_key(out, 8, "map");
+   v = &out->val.map.items[8].value;
+   set_map(v, e % 20);
+   for (i = 0; i < v->val.map.len; i++)
+   {
+      char key[16];
+      snprintf(key, sizeof(key), "k%u", (unsigned)i);
+      set_key(v, i, key);
+      set_filled(&v->val.map.items[i].value, RDT_STRING, i, e);
+   }
+
+   return 0;
+}
+
+static int create_synthetic(const char *path)
+{
+   int rv;
+   unsigned n = 0;
+   RFILE *fd  = filestream_open(path, RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!fd)
+   {
+      fprintf(stderr, "Could not create %s\n", path);
+      return -1;
+   }
+
+   rv = libretrodb_create(fd, synthetic_provider, &n);
+   filestream_close(fd);
+
+   if (rv < 0)
+      fprintf(stderr, "Could not write %s\n", path);
+
+   return rv < 0 ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   int ret = 0;
+
+   if (argc < 2)
+   {
+      if (create_synthetic(TEST_DB_PATH) < 0)
+         return 1;
+      ret = compare_db(TEST_DB_PATH);
+      filestream_delete(TEST_DB_PATH);
+      return ret < 0 ? 1 : 0;
+   }
+
+   for (i = 1; i < argc; i++)
+      if (compare_db(argv[i]) < 0)
+         ret = 1;
+
+   return ret;
+}
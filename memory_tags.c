@@ -0,0 +1,206 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+#include "memory_tags.h"
+
+/* Keeps the block behind it aligned for SIMD loads */
+#define MEMORY_TAG_HEADER_SIZE 16
+
+typedef struct memory_tag_counter
+{
+   volatile int64_t live;
+   volatile int64_t peak;
+   volatile int64_t blocks;
+} memory_tag_counter_t;
+
+static memory_tag_counter_t memory_tag_counters[MEMORY_TAG_LAST];
+
+static const char *memory_tag_idents[MEMORY_TAG_LAST] = {
+   "Menu",
+   "Thumbnails",
+   "Playlists",
+   "Rewind",
+   "Run-Ahead",
+   "Netplay",
+   "Shaders",
+   "Audio Mixer",
+   "Core"
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MEMORY_TAG_ATOMIC_ADD(p, v) __atomic_add_fetch((p), (v), __ATOMIC_RELAXED)
+#define MEMORY_TAG_ATOMIC_CAS(p, expected, v) \
+   __atomic_compare_exchange_n((p), &(expected), (v), false, \
+         __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER) && (defined(_WIN64) || _MSC_VER >= 1900)
+#define MEMORY_TAG_ATOMIC_ADD(p, v) \
+   (InterlockedExchangeAdd64((p), (v)) + (v))
+#define MEMORY_TAG_ATOMIC_CAS(p, expected, v) \
+   (InterlockedCompareExchange64((p), (v), (expected)) == (expected))
+#else
+/* Single threaded targets */
+#define MEMORY_TAG_ATOMIC_ADD(p, v) (*(p) += (v))
+#define MEMORY_TAG_ATOMIC_CAS(p, expected, v) (*(p) = (v), true)
+#endif
+
+void memory_tag_add(enum memory_tag tag, int64_t delta)
+{
+   memory_tag_counter_t *counter;
+   int64_t live;
+
+   if ((unsigned)tag >= MEMORY_TAG_LAST || !delta)
+      return;
+
+   counter = &memory_tag_counters[tag];
+   live    = MEMORY_TAG_ATOMIC_ADD(&counter->live, delta);
+
+   if (delta > 0)
+   {
+      int64_t peak = counter->peak;
+      while (live > peak)
+      {
+         if (MEMORY_TAG_ATOMIC_CAS(&counter->peak, peak, live))
+            break;
+         peak = counter->peak;
+      }
+   }
+}
+
+void *memory_tag_malloc(enum memory_tag tag, size_t size)
+{
+   uint8_t *block = (uint8_t*)malloc(size + MEMORY_TAG_HEADER_SIZE);
+
+   if (!block)
+      return NULL;
+
+   *(size_t*)block = size;
+   memory_tag_add(tag, (int64_t)size);
+   MEMORY_TAG_ATOMIC_ADD(&memory_tag_counters[tag].blocks, 1);
+
+   return block + MEMORY_TAG_HEADER_SIZE;
+}
+
+void *memory_tag_calloc(enum memory_tag tag, size_t count, size_t size)
+{
+   uint8_t *block = NULL;
+
+   if (size && count > ((size_t)-1 - MEMORY_TAG_HEADER_SIZE) / size)
+      return NULL;
+
+   if (!(block = (uint8_t*)calloc(1, count * size + MEMORY_TAG_HEADER_SIZE)))
+      return NULL;
+
+   *(size_t*)block = count * size;
+   memory_tag_add(tag, (int64_t)(count * size));
+   MEMORY_TAG_ATOMIC_ADD(&memory_tag_counters[tag].blocks, 1);
+
+   return block + MEMORY_TAG_HEADER_SIZE;
+}
+
+void *memory_tag_realloc(enum memory_tag tag, void *ptr, size_t size)
+{
+   uint8_t *block;
+   size_t old_size;
+
+   if (!ptr)
+      return memory_tag_malloc(tag, size);
+
+   block    = (uint8_t*)ptr - MEMORY_TAG_HEADER_SIZE;
+   old_size = *(size_t*)block;
+
+   if (!(block = (uint8_t*)realloc(block, size + MEMORY_TAG_HEADER_SIZE)))
+      return NULL;
+
+   *(size_t*)block = size;
+   memory_tag_add(tag, (int64_t)size - (int64_t)old_size);
+
+   return block + MEMORY_TAG_HEADER_SIZE;
+}
+
+void memory_tag_free(enum memory_tag tag, void *ptr)
+{
+   uint8_t *block;
+
+   if (!ptr)
+      return;
+
+   block = (uint8_t*)ptr - MEMORY_TAG_HEADER_SIZE;
+
+   memory_tag_add(tag, -(int64_t)*(size_t*)block);
+   MEMORY_TAG_ATOMIC_ADD(&memory_tag_counters[tag].blocks, -1);
+
+   free(block);
+}
+
+bool memory_tag_get_stats(enum memory_tag tag, memory_tag_stats_t *stats)
+{
+   if ((unsigned)tag >= MEMORY_TAG_LAST || !stats)
+      return false;
+
+   stats->ident  = memory_tag_idents[tag];
+   stats->live   = memory_tag_counters[tag].live;
+   stats->peak   = memory_tag_counters[tag].peak;
+   stats->blocks = memory_tag_counters[tag].blocks;
+
+   return true;
+}
+
+void memory_tag_reset_peaks(void)
+{
+   unsigned i;
+
+   for (i = 0; i < MEMORY_TAG_LAST; i++)
+      memory_tag_counters[i].peak = memory_tag_counters[i].live;
+}
+
+size_t memory_tag_report(char *s, size_t len)
+{
+   unsigned i;
+   size_t written = 0;
+
+   if (!s || !len)
+      return 0;
+
+   *s = '\0';
+
+   for (i = 0; i < MEMORY_TAG_LAST && written < len; i++)
+   {
+      int ret;
+      memory_tag_stats_t stats;
+
+      memory_tag_get_stats((enum memory_tag)i, &stats);
+
+      if (!stats.peak)
+         continue;
+
+      ret = snprintf(s + written, len - written,
+            " -%s: %" PRId64 " KB (peak %" PRId64 " KB)\n",
+            stats.ident, stats.live / 1024, stats.peak / 1024);
+
+      if (ret < 0)
+         break;
+
+      written += (size_t)ret;
+   }
+
+   return written < len ? written : len - 1;
+}
@@ -0,0 +1,117 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MEMORY_TAGS_H
+#define _MEMORY_TAGS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <boolean.h>
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Memory tags
+ *
+ * Live and peak byte counts per frontend subsystem, so memory
+ * budgets can be tuned on small devices. Subsystems either
+ * allocate through the memory_tag_*alloc() wrappers, which
+ * keep the size in front of the block, or report memory they
+ * allocate otherwise (aligned buffers, textures, memory owned
+ * by the core) with memory_tag_add().
+ *
+ * Only built with HAVE_MEMORY_TAGS, without it the wrappers
+ * are plain malloc() and friends and nothing is counted.
+ * Counters may be updated from any thread. */
+
+enum memory_tag
+{
+   MEMORY_TAG_MENU = 0,
+   MEMORY_TAG_THUMBNAILS,
+   MEMORY_TAG_PLAYLISTS,
+   MEMORY_TAG_REWIND,
+   MEMORY_TAG_RUNAHEAD,
+   MEMORY_TAG_NETPLAY,
+   MEMORY_TAG_SHADERS,
+   MEMORY_TAG_AUDIO_MIXER,
+   MEMORY_TAG_CORE,
+   MEMORY_TAG_LAST
+};
+
+typedef struct memory_tag_stats
+{
+   const char *ident;
+   int64_t live;
+   int64_t peak;
+   /* Blocks currently allocated through the wrappers */
+   int64_t blocks;
+} memory_tag_stats_t;
+
+#ifdef HAVE_MEMORY_TAGS
+void *memory_tag_malloc(enum memory_tag tag, size_t size);
+
+void *memory_tag_calloc(enum memory_tag tag, size_t count, size_t size);
+
+void *memory_tag_realloc(enum memory_tag tag, void *ptr, size_t size);
+
+/* @ptr must come from the wrappers above, with the same @tag */
+void memory_tag_free(enum memory_tag tag, void *ptr);
+
+/**
+ * memory_tag_add:
+ * @tag                : subsystem the memory belongs to
+ * @delta              : bytes allocated, negative when released
+ *
+ * Accounts for memory that is not allocated through the
+ * wrappers. Every addition must be matched by a release
+ * of the same size.
+ **/
+void memory_tag_add(enum memory_tag tag, int64_t delta);
+
+/**
+ * memory_tag_get_stats:
+ * @tag                : subsystem
+ * @stats              : filled in with the current counters
+ *
+ * Returns: false if @tag is out of range.
+ **/
+bool memory_tag_get_stats(enum memory_tag tag, memory_tag_stats_t *stats);
+
+/* Restarts peak tracking from the current live counts */
+void memory_tag_reset_peaks(void);
+
+/**
+ * memory_tag_report:
+ * @s                  : output buffer
+ * @len                : size of @s
+ *
+ * Writes one line per tag that has seen any memory,
+ * sizes in KB.
+ *
+ * Returns: number of characters written.
+ **/
+size_t memory_tag_report(char *s, size_t len);
+#else
+#define memory_tag_malloc(tag, size)         malloc(size)
+#define memory_tag_calloc(tag, count, size)  calloc(count, size)
+#define memory_tag_realloc(tag, ptr, size)   realloc(ptr, size)
+#define memory_tag_free(tag, ptr)            free(ptr)
+#define memory_tag_add(tag, delta)           ((void)0)
+#endif
+
+RETRO_END_DECLS
+
+#endif
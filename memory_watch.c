@@ -0,0 +1,216 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "memory_watch.h"
+#include "verbosity.h"
+
+#if defined(_MSC_VER)
+#define MEMORY_WATCH_BARRIER() MemoryBarrier()
+#elif defined(__GNUC__)
+#define MEMORY_WATCH_BARRIER() __sync_synchronize()
+#else
+#define MEMORY_WATCH_BARRIER()
+#endif
+
+struct memory_watch
+{
+   memory_watch_source_t *sources;
+   struct memory_watch_header *header;
+   uint8_t *data;
+   size_t size;
+   unsigned num_sources;
+#ifdef _WIN32
+   HANDLE mapping;
+#else
+   char name[64];
+#endif
+};
+
+memory_watch_t *memory_watch_new(const memory_watch_source_t *sources,
+      unsigned num_sources)
+{
+   unsigned i;
+   struct memory_watch_region *regions = NULL;
+   size_t header_size                  = 0;
+   size_t data_size                    = 0;
+   memory_watch_t *watch               = NULL;
+
+   /* Drop whatever does not fit, a truncated region
+    * would only confuse the reader */
+   for (i = 0; i < num_sources; i++)
+   {
+      if (data_size + sources[i].size > MEMORY_WATCH_MAX_SIZE)
+         break;
+      data_size += sources[i].size;
+   }
+
+   if (i < num_sources)
+      RARCH_WARN("[MemWatch]: Only mirroring %u of %u regions.\n",
+            i, num_sources);
+
+   if (!(num_sources = i))
+      return NULL;
+
+   if (!(watch = (memory_watch_t*)calloc(1, sizeof(*watch))))
+      return NULL;
+
+   header_size        = sizeof(struct memory_watch_header)
+      + num_sources * sizeof(struct memory_watch_region);
+   /* Keep region data aligned for readers that map it as words */
+   header_size        = (header_size + 63) & ~(size_t)63;
+   watch->num_sources = num_sources;
+   watch->sources     = (memory_watch_source_t*)malloc(
+         num_sources * sizeof(*sources));
+   if (!watch->sources)
+      goto error;
+   memcpy(watch->sources, sources, num_sources * sizeof(*sources));
+   watch->size        = header_size + data_size;
+
+#ifdef _WIN32
+   {
+      char name[64];
+      snprintf(name, sizeof(name), "Local\\RetroArch-MemWatch-%lu",
+            (unsigned long)GetCurrentProcessId());
+      watch->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL,
+            PAGE_READWRITE, 0, (DWORD)watch->size, name);
+      if (!watch->mapping)
+         goto error;
+      watch->header = (struct memory_watch_header*)MapViewOfFile(
+            watch->mapping, FILE_MAP_WRITE, 0, 0, watch->size);
+      if (!watch->header)
+         goto error;
+      RARCH_LOG("[MemWatch]: Created \"%s\", %u bytes.\n",
+            name, (unsigned)watch->size);
+   }
+#else
+   {
+      void *ptr;
+      int fd;
+
+      snprintf(watch->name, sizeof(watch->name), "/retroarch-memwatch-%ld",
+            (long)getpid());
+
+      /* Game memory is nobody else's business,
+       * tools reading it run as the same user */
+      fd = shm_open(watch->name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+      if (fd < 0)
+      {
+         watch->name[0] = '\0';
+         goto error;
+      }
+
+      if (ftruncate(fd, (off_t)watch->size) < 0)
+      {
+         close(fd);
+         goto error;
+      }
+
+      ptr = mmap(NULL, watch->size, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+      close(fd);
+      if (ptr == MAP_FAILED)
+         goto error;
+
+      watch->header = (struct memory_watch_header*)ptr;
+      RARCH_LOG("[MemWatch]: Created \"%s\", %u bytes.\n",
+            watch->name, (unsigned)watch->size);
+   }
+#endif
+
+   watch->data    = (uint8_t*)watch->header + header_size;
+   regions        = (struct memory_watch_region*)(watch->header + 1);
+   data_size      = header_size;
+
+   for (i = 0; i < num_sources; i++)
+   {
+      regions[i].address = sources[i].address;
+      regions[i].size    = sources[i].size;
+      regions[i].offset  = data_size;
+      regions[i].flags   = sources[i].flags;
+      data_size         += sources[i].size;
+   }
+
+   watch->header->version     = MEMORY_WATCH_VERSION;
+   watch->header->header_size = (uint32_t)header_size;
+   watch->header->num_regions = num_sources;
+   MEMORY_WATCH_BARRIER();
+   /* Written last, readers check it before anything else */
+   watch->header->magic       = MEMORY_WATCH_MAGIC;
+
+   return watch;
+
+error:
+   RARCH_ERR("[MemWatch]: Failed to create shared memory segment.\n");
+   memory_watch_free(watch);
+   return NULL;
+}
+
+void memory_watch_update(memory_watch_t *watch, uint64_t frame_count)
+{
+   unsigned i;
+   uint8_t *dst                       = watch->data;
+   struct memory_watch_header *header = watch->header;
+
+   header->sequence++;
+   MEMORY_WATCH_BARRIER();
+
+   for (i = 0; i < watch->num_sources; i++)
+   {
+      memcpy(dst, watch->sources[i].ptr, watch->sources[i].size);
+      dst += watch->sources[i].size;
+   }
+
+   header->frame_count = frame_count;
+   MEMORY_WATCH_BARRIER();
+   header->sequence++;
+}
+
+void memory_watch_free(memory_watch_t *watch)
+{
+   if (!watch)
+      return;
+
+   /* Tell readers that still have it mapped to reopen */
+   if (watch->header)
+      watch->header->magic = 0;
+
+#ifdef _WIN32
+   if (watch->header)
+      UnmapViewOfFile(watch->header);
+   if (watch->mapping)
+      CloseHandle(watch->mapping);
+#else
+   if (watch->header)
+      munmap(watch->header, watch->size);
+   if (*watch->name)
+      shm_unlink(watch->name);
+#endif
+
+   if (watch->sources)
+      free(watch->sources);
+   free(watch);
+}
@@ -0,0 +1,114 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MEMORY_WATCH_H
+#define __MEMORY_WATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Shared memory segment mirroring core memory for external
+ * tools (auto-splitters, achievement editors, monitoring).
+ *
+ * The segment is named "/retroarch-memwatch-<pid>" (POSIX,
+ * shm_open()) or "Local\RetroArch-MemWatch-<pid>" (Windows,
+ * OpenFileMapping()). It starts with a memory_watch_header,
+ * followed by num_regions memory_watch_region entries, followed
+ * by the region data. All fields are in host byte order.
+ *
+ * The frontend updates it after every frame using a sequence
+ * lock. Readers copy what they need and retry if the sequence
+ * was odd or changed in the meantime:
+ *
+ *    do {
+ *       seq = hdr->sequence;  (read barrier)
+ *       ...copy...            (read barrier)
+ *    } while ((seq & 1) || seq != hdr->sequence);
+ *
+ * A zero magic means the frontend has closed the segment, the
+ * reader should reopen it to pick up new content. */
+
+#define MEMORY_WATCH_MAGIC         0x574D4152 /* "RAMW" */
+#define MEMORY_WATCH_VERSION       1
+
+/* Upper bound for the mirrored data, regions past it are left out */
+#define MEMORY_WATCH_MAX_SIZE      (16 * 1024 * 1024)
+
+/* Region comes from RETRO_MEMORY_SYSTEM_RAM rather than
+ * from a memory map descriptor, address is then 0 */
+#define MEMORY_WATCH_REGION_SYSTEM_RAM 0x80000000UL
+
+struct memory_watch_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t header_size;      /* Bytes up to the first region data */
+   uint32_t num_regions;
+   volatile uint32_t sequence;
+   uint32_t pad;
+   volatile uint64_t frame_count;
+};
+
+struct memory_watch_region
+{
+   uint64_t address;          /* Start in the core's address space */
+   uint64_t size;
+   uint64_t offset;           /* Data offset from the segment start */
+   uint64_t flags;            /* RETRO_MEMDESC_* */
+};
+
+/* Source of a mirrored region, built by the frontend */
+typedef struct memory_watch_source
+{
+   const uint8_t *ptr;
+   uint64_t address;
+   uint64_t flags;
+   size_t size;
+} memory_watch_source_t;
+
+typedef struct memory_watch memory_watch_t;
+
+/**
+ * memory_watch_new:
+ * @sources          : regions to expose, copied. The memory they
+ *                     point to must stay valid until memory_watch_free().
+ * @num_sources      : number of entries in @sources.
+ *
+ * Creates the shared memory segment. Sources beyond
+ * MEMORY_WATCH_MAX_SIZE are skipped.
+ *
+ * Returns: handle on success, NULL if no segment could be created.
+ **/
+memory_watch_t *memory_watch_new(const memory_watch_source_t *sources,
+      unsigned num_sources);
+
+/**
+ * memory_watch_update:
+ * @watch            : handle returned by memory_watch_new().
+ * @frame_count      : frame counter to publish with the data.
+ *
+ * Copies all regions into the segment.
+ **/
+void memory_watch_update(memory_watch_t *watch, uint64_t frame_count);
+
+void memory_watch_free(memory_watch_t *watch);
+
+RETRO_END_DECLS
+
+#endif
@@ -4477,7 +4477,8 @@ finish:
 
       net_http_urlencode_full(parent_dir_encoded, parent_dir,
             sizeof(parent_dir_encoded));
-      task_push_http_transfer_file(parent_dir_encoded, true,
+      task_push_http_transfer_file_cached(parent_dir_encoded,
+            config_get_ptr()->paths.directory_cache, true,
             "index_dirs", cb_net_generic_subdir, transf);
    }
 
@@ -4562,7 +4563,9 @@ static int generic_action_ok_network(const char *path,
    strlcpy(transf->path, url_path, sizeof(transf->path));
 
    net_http_urlencode_full(url_path_encoded, url_path, sizeof(url_path_encoded));
-   task_push_http_transfer_file(url_path_encoded, suppress_msg, url_label, callback, transf);
+   task_push_http_transfer_file_cached(url_path_encoded,
+         settings->paths.directory_cache,
+         suppress_msg, url_label, callback, transf);
 
    return generic_action_ok_displaylist_push(path, NULL,
          label, type, idx, entry_idx, type_id2);
@@ -5763,24 +5766,37 @@ DEFAULT_ACTION_OK_DL_PUSH(action_ok_push_content_list, FILEBROWSER_SELECT_FILE,
 DEFAULT_ACTION_OK_DL_PUSH(action_ok_push_scan_file, FILEBROWSER_SCAN_FILE, ACTION_OK_DL_CONTENT_LIST, settings->paths.directory_menu_content)
 
 #ifdef HAVE_NETWORKING
-static void netplay_refresh_rooms_cb(retro_task_t *task,
-      void *task_data, void *user_data, const char *err)
+/* Rebuilds the lobby if it is still being looked at */
+static void netplay_rooms_refresh_menu(void)
 {
-   char *new_data                = NULL;
    const char *path              = NULL;
    const char *label             = NULL;
    unsigned menu_type            = 0;
    enum msg_hash_enums enum_idx  = MSG_UNKNOWN;
-
-   http_transfer_data_t *data    = (http_transfer_data_t*)task_data;
+   bool refresh                  = false;
 
    menu_entries_get_last_stack(&path, &label, &menu_type, &enum_idx, NULL);
 
-   /* Don't push the results if we left the netplay menu */
    if (!string_is_equal(label, msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB))
     && !string_is_equal(label, msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY)))
       return;
 
+   menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
+   menu_driver_ctl(RARCH_MENU_CTL_SET_PREVENT_POPULATE, NULL);
+}
+
+static void netplay_latency_probe_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   netplay_rooms_refresh_menu();
+}
+
+static void netplay_refresh_rooms_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   char *new_data                = NULL;
+   http_transfer_data_t *data    = (http_transfer_data_t*)task_data;
+
    if (!data || err)
       goto finish;
 
@@ -5796,87 +5812,32 @@ static void netplay_refresh_rooms_cb(retro_task_t *task,
             strlen(data->data),
             STRLEN_CONST("registry.lpl")))
    {
-      if (string_is_empty(data->data))
-         netplay_room_count = 0;
-      else
-      {
-         char s[PATH_MAX_LENGTH];
-         unsigned i                           = 0;
-         unsigned j                           = 0;
-         struct netplay_host_list *lan_hosts  = NULL;
-         int lan_room_count                   = 0;
-         bool refresh                         = false;
-
-#ifndef RARCH_CONSOLE
-         netplay_discovery_driver_ctl(RARCH_NETPLAY_DISCOVERY_CTL_LAN_GET_RESPONSES, &lan_hosts);
-         if (lan_hosts)
-            lan_room_count                    = (int)lan_hosts->size;
-#endif
+      int i;
+      int count                  = 0;
+      struct netplay_room *rooms = NULL;
 
+      /* The LAN scan merges its results on its own,
+       * whichever of the two finishes first */
+      if (!string_is_empty(data->data))
+      {
          netplay_rooms_parse(data->data);
+         count = netplay_rooms_get_count();
+      }
 
-         if (netplay_room_list)
-            free(netplay_room_list);
+      if (count > 0)
+         rooms = (struct netplay_room*)calloc(count, sizeof(*rooms));
 
-         /* TODO/FIXME - right now, a LAN and non-LAN netplay session might appear
-          * in the same list. If both entries are available, we want to show only
-          * the LAN one. */
+      for (i = 0; rooms && i < count; i++)
+         memcpy(&rooms[i], netplay_room_get(i), sizeof(rooms[i]));
 
-         netplay_room_count                   = netplay_rooms_get_count();
-         netplay_room_list                    = (struct netplay_room*)
-            calloc(netplay_room_count + lan_room_count,
-                  sizeof(struct netplay_room));
+      netplay_room_list_update(rooms, rooms ? count : 0, false);
+      netplay_rooms_free();
+      free(rooms);
 
-         for (i = 0; i < (unsigned)netplay_room_count; i++)
-            memcpy(&netplay_room_list[i], netplay_room_get(i), sizeof(netplay_room_list[i]));
+      netplay_rooms_refresh_menu();
 
-         if (lan_room_count != 0)
-         {
-            for (i = netplay_room_count; i < (unsigned)(netplay_room_count + lan_room_count); i++)
-            {
-               struct netplay_host *host = &lan_hosts->hosts[j++];
-
-               strlcpy(netplay_room_list[i].nickname,
-                     host->nick,
-                     sizeof(netplay_room_list[i].nickname));
-
-               strlcpy(netplay_room_list[i].address,
-                     host->address,
-                     INET6_ADDRSTRLEN);
-               strlcpy(netplay_room_list[i].corename,
-                     host->core,
-                     sizeof(netplay_room_list[i].corename));
-               strlcpy(netplay_room_list[i].retroarch_version,
-                     host->retroarch_version,
-                     sizeof(netplay_room_list[i].retroarch_version));
-               strlcpy(netplay_room_list[i].coreversion,
-                     host->core_version,
-                     sizeof(netplay_room_list[i].coreversion));
-               strlcpy(netplay_room_list[i].gamename,
-                     host->content,
-                     sizeof(netplay_room_list[i].gamename));
-               strlcpy(netplay_room_list[i].frontend,
-                     host->frontend,
-                     sizeof(netplay_room_list[i].frontend));
-               strlcpy(netplay_room_list[i].subsystem_name,
-                     host->subsystem_name,
-                     sizeof(netplay_room_list[i].subsystem_name));
-
-               netplay_room_list[i].port      = host->port;
-               netplay_room_list[i].gamecrc   = host->content_crc;
-               netplay_room_list[i].timestamp = 0;
-               netplay_room_list[i].lan       = true;
-
-               snprintf(s, sizeof(s),
-                     msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NETPLAY_ROOM_NICKNAME),
-                     netplay_room_list[i].nickname);
-            }
-            netplay_room_count += lan_room_count;
-         }
-
-         menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
-         menu_driver_ctl(RARCH_MENU_CTL_SET_PREVENT_POPULATE, NULL);
-      }
+      /* Sorts the list again once the round trips are in */
+      task_push_netplay_latency_probe(netplay_latency_probe_cb);
    }
 
 finish:
@@ -5893,56 +5854,47 @@ static void netplay_lan_scan_callback(retro_task_t *task,
       void *task_data,
       void *user_data, const char *error)
 {
+   size_t i;
+   struct netplay_room *rooms              = NULL;
    struct netplay_host_list *netplay_hosts = NULL;
-   enum msg_hash_enums enum_idx            = MSG_UNKNOWN;
-   unsigned menu_type                      = 0;
-   const char *label                       = NULL;
-   const char *path                        = NULL;
-
-   /* TODO/FIXME: I have no idea what this is supposed to be
-    * doing...
-    * As it stands, this function will never get past the
-    * following sanity check (i.e. netplay_lan_scan_callback()
-    * will never be called when we are viewing the 'lan scan
-    * settings' list, since this list doesn't even exist...).
-    * Moreover, any menu entries that get added here
-    * (menu_entries_append_enum()) will be erased by the
-    * subsequent netplay_refresh_rooms_cb() callback - and
-    * menu entries should never be added outside of
-    * menu_displaylist.c anyway.
-    * This is some legacy garbage, and someone who understands
-    * netplay needs to rip it all out. */
-
-   menu_entries_get_last_stack(&path, &label, &menu_type, &enum_idx, NULL);
-
-   /* Don't push the results if we left the LAN scan menu */
-   if (!string_is_equal(label,
-         msg_hash_to_str(
-            MENU_ENUM_LABEL_DEFERRED_NETPLAY_LAN_SCAN_SETTINGS_LIST)))
-      return;
 
    if (!netplay_discovery_driver_ctl(
             RARCH_NETPLAY_DISCOVERY_CTL_LAN_GET_RESPONSES,
             (void *) &netplay_hosts))
       return;
 
-   if (netplay_hosts->size > 0)
+   if (netplay_hosts->size > 0
+         && !(rooms = (struct netplay_room*)calloc(
+               netplay_hosts->size, sizeof(*rooms))))
+      return;
+
+   for (i = 0; i < netplay_hosts->size; i++)
    {
-      unsigned i;
-      file_list_t *file_list = menu_entries_get_selection_buf_ptr(0);
+      struct netplay_host *host = &netplay_hosts->hosts[i];
+      struct netplay_room *room = &rooms[i];
+
+      strlcpy(room->nickname, host->nick, sizeof(room->nickname));
+      strlcpy(room->address, host->address, sizeof(room->address));
+      strlcpy(room->corename, host->core, sizeof(room->corename));
+      strlcpy(room->retroarch_version, host->retroarch_version,
+            sizeof(room->retroarch_version));
+      strlcpy(room->coreversion, host->core_version,
+            sizeof(room->coreversion));
+      strlcpy(room->gamename, host->content, sizeof(room->gamename));
+      strlcpy(room->frontend, host->frontend, sizeof(room->frontend));
+      strlcpy(room->subsystem_name, host->subsystem_name,
+            sizeof(room->subsystem_name));
+
+      room->port      = host->port;
+      room->gamecrc   = host->content_crc;
+      room->latency   = host->latency;
+      room->timestamp = 0;
+   }
 
-      menu_entries_ctl(MENU_ENTRIES_CTL_CLEAR, file_list);
+   netplay_room_list_update(rooms, (int)netplay_hosts->size, true);
+   free(rooms);
 
-      for (i = 0; i < netplay_hosts->size; i++)
-      {
-         struct netplay_host *host = &netplay_hosts->hosts[i];
-         menu_entries_append_enum(file_list,
-               host->nick,
-               msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_CONNECT_TO),
-               MENU_ENUM_LABEL_NETPLAY_CONNECT_TO,
-               MENU_NETPLAY_LAN_SCAN, 0, 0);
-      }
-   }
+   netplay_rooms_refresh_menu();
 }
 #endif
 
@@ -5950,6 +5902,8 @@ static int action_ok_push_netplay_refresh_rooms(const char *path,
       const char *label, unsigned type, size_t idx, size_t entry_idx)
 {
    char url [2048] = "http://lobby.libretro.com/list/";
+   /* The cached list stays up while both of these
+    * run, each one merges its part into it */
 #ifndef RARCH_CONSOLE
    task_push_netplay_lan_scan(netplay_lan_scan_callback);
 #endif
@@ -5056,6 +5056,10 @@ static void materialui_render_menu_list(
    first_entry = (mui->first_onscreen_entry < entries_end) ? mui->first_onscreen_entry : entries_end;
    last_entry  = (mui->last_onscreen_entry  < entries_end) ? mui->last_onscreen_entry  : entries_end;
 
+   /* Entries of virtual lists are filled in
+    * for the visible window only */
+   menu_displaylist_playlist_fill(list, first_entry, last_entry);
+
    for (i = first_entry; i <= last_entry; i++)
    {
       bool entry_selected        = (selection == i);
@@ -8597,30 +8601,25 @@ static bool materialui_preswitch_tabs(
    if (stack_size < 1)
       return false;
 
-   /* Delete existing label */
-   if (menu_stack->list[stack_size - 1].label)
-      free(menu_stack->list[stack_size - 1].label);
-   menu_stack->list[stack_size - 1].label = NULL;
-
    /* Assign new label/type */
    switch (target_tab->type)
    {
       case MUI_NAV_BAR_MENU_TAB_PLAYLISTS:
-         menu_stack->list[stack_size - 1].label =
-            strdup(msg_hash_to_str(MENU_ENUM_LABEL_PLAYLISTS_TAB));
+         file_list_set_label_at_offset(menu_stack, stack_size - 1,
+               msg_hash_to_str(MENU_ENUM_LABEL_PLAYLISTS_TAB));
          menu_stack->list[stack_size - 1].type =
             MENU_PLAYLISTS_TAB;
          break;
       case MUI_NAV_BAR_MENU_TAB_SETTINGS:
-         menu_stack->list[stack_size - 1].label =
-            strdup(msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
+         file_list_set_label_at_offset(menu_stack, stack_size - 1,
+               msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
          menu_stack->list[stack_size - 1].type =
             MENU_SETTINGS;
          break;
       case MUI_NAV_BAR_MENU_TAB_MAIN:
       default:
-         menu_stack->list[stack_size - 1].label =
-            strdup(msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
+         file_list_set_label_at_offset(menu_stack, stack_size - 1,
+               msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
          menu_stack->list[stack_size - 1].type =
             MENU_SETTINGS;
          break;
@@ -962,6 +962,18 @@ static void ozone_update_thumbnail_image(void *data)
          gfx_thumbnail_upscale_threshold,
          network_on_demand_thumbnails);
    }
+
+   /* Load thumbnails of the neighbouring entries
+    * in the background, so they are ready when
+    * the user scrolls */
+   if (ozone->is_playlist && playlist)
+   {
+      gfx_thumbnail_prefetch(ozone->thumbnail_path_data,
+            playlist, selection + 1, gfx_thumbnail_upscale_threshold);
+      if (selection > 0)
+         gfx_thumbnail_prefetch(ozone->thumbnail_path_data,
+               playlist, selection - 1, gfx_thumbnail_upscale_threshold);
+   }
 }
 
 static void ozone_refresh_thumbnail_image(void *data, unsigned i)
@@ -3560,15 +3572,12 @@ static void ozone_list_deep_copy(const file_list_t *src, file_list_t *dst,
 
    for (i = first; i <= last; ++i)
    {
-      struct item_file *d = &dst->list[j];
       struct item_file *s = &src->list[i];
       void     *src_udata = s->userdata;
       void     *src_adata = s->actiondata;
 
-      *d       = *s;
-      d->alt   = string_is_empty(d->alt)   ? NULL : strdup(d->alt);
-      d->path  = string_is_empty(d->path)  ? NULL : strdup(d->path);
-      d->label = string_is_empty(d->label) ? NULL : strdup(d->label);
+      if (!file_list_append_copy(dst, src, i))
+         break;
 
       if (src_udata)
          dst->list[j].userdata = (void*)ozone_copy_node((const ozone_node_t*)src_udata);
@@ -3582,8 +3591,6 @@ static void ozone_list_deep_copy(const file_list_t *src, file_list_t *dst,
 
       ++j;
    }
-
-   dst->size = j;
 }
 
 void ozone_list_cache(void *data,
@@ -635,6 +635,11 @@ border_iterate:
 
    if (old_list)
       y += ozone->old_list_offset_y;
+   /* Entries of virtual lists are filled in
+    * for the visible window only */
+   else if (entries_end > 0)
+      menu_displaylist_playlist_fill(selection_buf,
+            ozone->first_onscreen_entry, ozone->last_onscreen_entry);
 
    for (i = 0; i < entries_end; i++)
    {
@@ -769,12 +769,8 @@ void ozone_change_tab(ozone_handle_t *ozone,
    file_list_t *selection_buf = menu_entries_get_selection_buf_ptr(0);
    size_t stack_size          = menu_stack->size;
 
-   if (menu_stack->list[stack_size - 1].label)
-      free(menu_stack->list[stack_size - 1].label);
-   menu_stack->list[stack_size - 1].label = NULL;
-
-   menu_stack->list[stack_size - 1].label =
-      strdup(msg_hash_to_str(tab));
+   file_list_set_label_at_offset(menu_stack, stack_size - 1,
+         msg_hash_to_str(tab));
    menu_stack->list[stack_size - 1].type =
       type;
 
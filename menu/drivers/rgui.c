@@ -4868,6 +4868,12 @@ static void rgui_render(void *data,
 
       menu_entries_ctl(MENU_ENTRIES_CTL_START_GET, &new_start);
 
+      /* Entries of virtual lists are filled in
+       * for the visible window only */
+      if (end > new_start)
+         menu_displaylist_playlist_fill(
+               menu_entries_get_selection_buf_ptr(0), new_start, end - 1);
+
       for (i = new_start; i < end; i++, y += rgui->font_height_stride)
       {
          char entry_title_buf[255];
@@ -976,6 +976,7 @@ static void stripes_update_savestate_thumbnail_path(void *data, unsigned i)
                || (string_is_equal(entry.label, "savestate"))))
       {
          char path[8024];
+         content_state_slot_info_t slot_info;
          global_t         *global = global_get_ptr();
 
          path[0] = '\0';
@@ -996,7 +997,11 @@ static void stripes_update_savestate_thumbnail_path(void *data, unsigned i)
 
          strlcat(path, ".png", sizeof(path));
 
-         if (path_is_valid(path))
+         /* The slot index knows whether there is a
+          * thumbnail, no need to probe for it */
+         if (content_get_state_slot_info(
+                  settings->ints.state_slot, &slot_info) &&
+             slot_info.has_thumbnail)
          {
             if (!string_is_empty(stripes->savestate_thumbnail_file_path))
                free(stripes->savestate_thumbnail_file_path);
@@ -3845,16 +3850,13 @@ static void stripes_list_deep_copy(const file_list_t *src, file_list_t *dst,
 
    for (i = first; i <= last; ++i)
    {
-      struct item_file *d = &dst->list[j];
       struct item_file *s = &src->list[i];
 
       void *src_udata = s->userdata;
       void *src_adata = s->actiondata;
 
-      *d       = *s;
-      d->alt   = string_is_empty(d->alt)   ? NULL : strdup(d->alt);
-      d->path  = string_is_empty(d->path)  ? NULL : strdup(d->path);
-      d->label = string_is_empty(d->label) ? NULL : strdup(d->label);
+      if (!file_list_append_copy(dst, src, i))
+         break;
 
       if (src_udata)
          dst->list[j].userdata = (void*)stripes_copy_node((const stripes_node_t*)src_udata);
@@ -3868,8 +3870,6 @@ static void stripes_list_deep_copy(const file_list_t *src, file_list_t *dst,
 
       ++j;
    }
-
-   dst->size = j;
 }
 
 static void stripes_list_cache(void *data, enum menu_list_type type, unsigned action)
@@ -3944,75 +3944,71 @@ static void stripes_list_cache(void *data, enum menu_list_type type, unsigned ac
 
          stack_size = menu_stack->size;
 
-         if (menu_stack->list[stack_size - 1].label)
-            free(menu_stack->list[stack_size - 1].label);
-         menu_stack->list[stack_size - 1].label = NULL;
-
          switch (stripes_get_system_tab(stripes, (unsigned)stripes->categories_selection_ptr))
          {
             case STRIPES_SYSTEM_TAB_MAIN:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTINGS;
                break;
             case STRIPES_SYSTEM_TAB_SETTINGS:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTINGS_TAB;
                break;
 #ifdef HAVE_IMAGEVIEWER
             case STRIPES_SYSTEM_TAB_IMAGES:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_IMAGES_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_IMAGES_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_IMAGES_TAB;
                break;
 #endif
             case STRIPES_SYSTEM_TAB_MUSIC:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_MUSIC_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_MUSIC_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_MUSIC_TAB;
                break;
 #ifdef HAVE_FFMPEG
             case STRIPES_SYSTEM_TAB_VIDEO:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_VIDEO_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_VIDEO_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_VIDEO_TAB;
                break;
 #endif
             case STRIPES_SYSTEM_TAB_HISTORY:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_HISTORY_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_HISTORY_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_HISTORY_TAB;
                break;
             case STRIPES_SYSTEM_TAB_FAVORITES:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_FAVORITES_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_FAVORITES_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_FAVORITES_TAB;
                break;
 #ifdef HAVE_NETWORKING
             case STRIPES_SYSTEM_TAB_NETPLAY:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_NETPLAY_TAB;
                break;
 #endif
             case STRIPES_SYSTEM_TAB_ADD:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_ADD_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_ADD_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_ADD_TAB;
                break;
             default:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_HORIZONTAL_MENU));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_HORIZONTAL_MENU));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTING_HORIZONTAL_MENU;
                break;
@@ -1103,6 +1103,7 @@ static void xmb_update_savestate_thumbnail_path(void *data, unsigned i)
              string_is_equal(entry.label, "savestate"))
          {
             char path[8204];
+            content_state_slot_info_t slot_info;
             global_t *global = global_get_ptr();
 
             path[0] = '\0';
@@ -1121,7 +1122,10 @@ static void xmb_update_savestate_thumbnail_path(void *data, unsigned i)
 
             strlcat(path, FILE_PATH_PNG_EXTENSION, sizeof(path));
 
-            if (path_is_valid(path))
+            /* The slot index knows whether there is a
+             * thumbnail, no need to probe for it */
+            if (content_get_state_slot_info(state_slot, &slot_info) &&
+                slot_info.has_thumbnail)
                strlcpy(
                      xmb->savestate_thumbnail_file_path, path,
                      sizeof(xmb->savestate_thumbnail_file_path));
@@ -1196,6 +1200,18 @@ static void xmb_update_thumbnail_image(void *data)
          &xmb->thumbnails.left,
          thumbnail_upscale_threshold,
          network_on_demand_thumbnails);
+
+      /* Load thumbnails of the neighbouring entries
+       * in the background, so they are ready when
+       * the user scrolls */
+      if (xmb->is_playlist && playlist)
+      {
+         gfx_thumbnail_prefetch(xmb->thumbnail_path_data,
+               playlist, selection + 1, thumbnail_upscale_threshold);
+         if (selection > 0)
+            gfx_thumbnail_prefetch(xmb->thumbnail_path_data,
+                  playlist, selection - 1, thumbnail_upscale_threshold);
+      }
    }
 }
 
@@ -3554,6 +3570,10 @@ static void xmb_draw_items(
    xmb_calculate_visible_range(xmb, height,
          end, (unsigned)current, &first, &last);
 
+   /* Entries of virtual lists are filled in
+    * for the visible window only */
+   menu_displaylist_playlist_fill(list, first, last);
+
    if (dispctx && dispctx->blend_begin)
       dispctx->blend_begin(userdata);
 
@@ -6464,16 +6484,13 @@ static void xmb_list_deep_copy(const file_list_t *src, file_list_t *dst,
 
    for (i = first; i <= last; ++i)
    {
-      struct item_file *d = &dst->list[j];
       struct item_file *s = &src->list[i];
 
       void *src_udata = s->userdata;
       void *src_adata = s->actiondata;
 
-      *d       = *s;
-      d->alt   = string_is_empty(d->alt)   ? NULL : strdup(d->alt);
-      d->path  = string_is_empty(d->path)  ? NULL : strdup(d->path);
-      d->label = string_is_empty(d->label) ? NULL : strdup(d->label);
+      if (!file_list_append_copy(dst, src, i))
+         break;
 
       if (src_udata)
          dst->list[j].userdata = (void*)xmb_copy_node((const xmb_node_t*)src_udata);
@@ -6487,8 +6504,6 @@ static void xmb_list_deep_copy(const file_list_t *src, file_list_t *dst,
 
       ++j;
    }
-
-   dst->size = j;
 }
 
 static void xmb_list_cache(void *data, enum menu_list_type type, unsigned action)
@@ -6564,83 +6579,79 @@ static void xmb_list_cache(void *data, enum menu_list_type type, unsigned action
 
          stack_size = menu_stack->size;
 
-         if (menu_stack->list[stack_size - 1].label)
-            free(menu_stack->list[stack_size - 1].label);
-         menu_stack->list[stack_size - 1].label = NULL;
-
          switch (xmb_get_system_tab(xmb, (unsigned)xmb->categories_selection_ptr))
          {
             case XMB_SYSTEM_TAB_MAIN:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTINGS;
                break;
             case XMB_SYSTEM_TAB_SETTINGS:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTINGS_TAB;
                break;
 #ifdef HAVE_IMAGEVIEWER
             case XMB_SYSTEM_TAB_IMAGES:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_IMAGES_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_IMAGES_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_IMAGES_TAB;
                break;
 #endif
             case XMB_SYSTEM_TAB_MUSIC:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_MUSIC_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_MUSIC_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_MUSIC_TAB;
                break;
 #if defined(HAVE_FFMPEG) || defined(HAVE_MPV)
             case XMB_SYSTEM_TAB_VIDEO:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_VIDEO_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_VIDEO_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_VIDEO_TAB;
                break;
 #endif
             case XMB_SYSTEM_TAB_HISTORY:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_HISTORY_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_HISTORY_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_HISTORY_TAB;
                break;
             case XMB_SYSTEM_TAB_FAVORITES:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_FAVORITES_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_FAVORITES_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_FAVORITES_TAB;
                break;
 #ifdef HAVE_NETWORKING
             case XMB_SYSTEM_TAB_NETPLAY:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_NETPLAY_TAB;
                break;
 #endif
             case XMB_SYSTEM_TAB_ADD:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_ADD_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_ADD_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_ADD_TAB;
                break;
 #if defined(HAVE_LIBRETRODB)
             case XMB_SYSTEM_TAB_EXPLORE:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_EXPLORE_TAB;
                break;
 #endif
             default:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_HORIZONTAL_MENU));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                     msg_hash_to_str(MENU_ENUM_LABEL_HORIZONTAL_MENU));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTING_HORIZONTAL_MENU;
                break;
@@ -82,6 +82,7 @@
 #if defined(HAVE_MATERIALUI) || defined(HAVE_XMB) || defined(HAVE_OZONE)
 #include "menu_screensaver.h"
 #endif
+#include "menu_search_index.h"
 
 #include "../configuration.h"
 #include "../file_path_special.h"
@@ -118,6 +119,10 @@
 #define PL_LABEL_SPACER_RGUI    " | "
 #define PL_LABEL_SPACER_MAXLEN  8
 
+/* Playlists with at least this many entries (and no
+ * active search filter) are displayed as virtual lists */
+#define PL_VIRTUAL_MIN_SIZE     1000
+
 #define BYTES_TO_MB(bytes) ((bytes) / 1024 / 1024)
 #define BYTES_TO_GB(bytes) (((bytes) / 1024) / 1024 / 1024)
 
@@ -129,13 +134,33 @@
 
 /* TODO/FIXME - globals - need to find a way to
  * get rid of these */
+/* Listings of the same directory are reused for this long,
+ * as long as the directory mtime hasn't changed */
+#define FILEBROWSER_CACHE_TTL 10
+
+/* The last directory read by the file browser. Going into a
+ * submenu and back, searching or toggling an option all
+ * rebuild the list, which would otherwise read it again. */
+typedef struct filebrowser_cache
+{
+   struct string_list *list;
+   char *path;
+   char *exts;
+   int64_t mtime;
+   time_t time;
+   bool show_hidden_files;
+   bool include_compressed;
+} filebrowser_cache_t;
+
 struct menu_displaylist_state
 {
+   filebrowser_cache_t cache;
    enum filebrowser_enums filebrowser_types;
 };
 
 static struct menu_displaylist_state menu_displist_st = {
-   FILEBROWSER_NONE /* filebrowser_types */
+   { NULL, NULL, NULL, 0, 0, false, false }, /* cache */
+   FILEBROWSER_NONE                          /* filebrowser_types */
 };
 
 extern struct key_desc key_descriptors[RARCH_MAX_KEYS];
@@ -158,6 +183,74 @@ void filebrowser_set_type(enum filebrowser_enums type)
    p_displist->filebrowser_types = type;
 }
 
+void filebrowser_cache_free(void)
+{
+   filebrowser_cache_t *cache = &menu_displist_st.cache;
+
+   if (cache->list)
+      string_list_free(cache->list);
+   if (cache->path)
+      free(cache->path);
+   if (cache->exts)
+      free(cache->exts);
+   memset(cache, 0, sizeof(*cache));
+}
+
+/* dir_list_initialize() for the file browser, served from
+ * the cache when the same directory was just read */
+static bool filebrowser_dir_list(struct string_list *list,
+      const char *path, const char *exts,
+      bool show_hidden_files, bool include_compressed)
+{
+   filebrowser_cache_t *cache = &menu_displist_st.cache;
+   int64_t mtime              = path_get_mtime(path);
+   time_t now                 = time(NULL);
+
+   if (     cache->list
+         && mtime
+         && mtime == cache->mtime
+         && now - cache->time < FILEBROWSER_CACHE_TTL
+         && cache->show_hidden_files  == show_hidden_files
+         && cache->include_compressed == include_compressed
+         && string_is_equal(cache->path, path)
+         && (exts ? (cache->exts && string_is_equal(cache->exts, exts))
+                  : !cache->exts))
+   {
+      struct string_list *copy = string_list_clone(cache->list);
+
+      if (copy)
+      {
+         *list = *copy;
+         free(copy);
+         return true;
+      }
+   }
+
+   if (!dir_list_initialize(list, path, exts, true,
+            show_hidden_files, include_compressed, false))
+      return false;
+
+   filebrowser_cache_free();
+
+   /* mtime only has a resolution of one second; a listing
+    * taken in the same second as the last change might miss
+    * part of it, so don't keep it. */
+   if (!mtime || now <= mtime + 1)
+      return true;
+
+   if (!(cache->list = string_list_clone(list)))
+      return true;
+
+   cache->path               = strdup(path);
+   cache->exts               = exts ? strdup(exts) : NULL;
+   cache->mtime              = mtime;
+   cache->time               = now;
+   cache->show_hidden_files  = show_hidden_files;
+   cache->include_compressed = include_compressed;
+
+   return true;
+}
+
 static void filebrowser_parse(
       menu_displaylist_info_t *info,
       unsigned type_data,
@@ -222,18 +315,18 @@ static void filebrowser_parse(
             subsystem = subsystem_data + content_get_subsystem();
 
          if (subsystem && subsystem_current_count > 0 && content_get_subsystem_rom_id() < subsystem->num_roms)
-            ret = dir_list_initialize(&str_list,
+            ret = filebrowser_dir_list(&str_list,
                   path,
                   filter_ext ? subsystem->roms[content_get_subsystem_rom_id()].valid_extensions : NULL,
-                  true, show_hidden_files, true, false);
+                  show_hidden_files, true);
       }
       else if ((info->type_default == FILE_TYPE_MANUAL_SCAN_DAT) || (info->type_default == FILE_TYPE_SIDELOAD_CORE))
-         ret = dir_list_initialize(&str_list, path,
-               info->exts, true, show_hidden_files, false, false);
+         ret = filebrowser_dir_list(&str_list, path,
+               info->exts, show_hidden_files, false);
       else
-         ret = dir_list_initialize(&str_list, path,
+         ret = filebrowser_dir_list(&str_list, path,
                filter_ext ? info->exts : NULL,
-               true, show_hidden_files, true, false);
+               show_hidden_files, true);
    }
 
    switch (filebrowser_type)
@@ -447,9 +540,10 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info,
       settings_t *settings)
 {
    char tmp[PATH_MAX_LENGTH];
-   unsigned i, count           = 0;
-   core_info_t *core_info      = NULL;
-   const char *core_path       = NULL;
+   unsigned i, count             = 0;
+   core_info_t *core_info        = NULL;
+   core_info_details_t *details  = NULL;
+   const char *core_path         = NULL;
 #if !(defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP)
    bool kiosk_mode_enable      = settings->bools.kiosk_mode_enable;
 #if defined(HAVE_NETWORKING) && defined(HAVE_ONLINE_UPDATER)
@@ -476,7 +570,9 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info,
    else if (core_info_get_current_core(&core_info) && core_info)
       core_path = core_info->path;
 
-   if (!core_info || !core_info->has_info)
+   if (     !core_info
+         || !core_info->has_info
+         || !(details = core_info_get_details(core_info)))
    {
       if (menu_entries_append_enum(info->list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_CORE_INFORMATION_AVAILABLE),
@@ -505,7 +601,7 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info,
       info_list[0].name = core_info->core_name;
       info_list[1].name = core_info->display_name;
       info_list[2].name = core_info->systemname;
-      info_list[3].name = core_info->system_manufacturer;
+      info_list[3].name = details->system_manufacturer;
 
       for (i = 0; i < ARRAY_SIZE(info_list); i++)
       {
@@ -524,40 +620,40 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info,
       }
    }
 
-   if (core_info->categories_list)
+   if (details->categories_list)
    {
       fill_pathname_noext(tmp,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_CORE_INFO_CATEGORIES),
             ": ",
             sizeof(tmp));
       string_list_join_concat(tmp, sizeof(tmp),
-            core_info->categories_list, ", ");
+            details->categories_list, ", ");
       if (menu_entries_append_enum(info->list, tmp, "",
             MENU_ENUM_LABEL_CORE_INFO_ENTRY, MENU_SETTINGS_CORE_INFO_NONE, 0, 0))
          count++;
    }
 
-   if (core_info->authors_list)
+   if (details->authors_list)
    {
       fill_pathname_noext(tmp,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_CORE_INFO_AUTHORS),
             ": ",
             sizeof(tmp));
       string_list_join_concat(tmp, sizeof(tmp),
-            core_info->authors_list, ", ");
+            details->authors_list, ", ");
       if (menu_entries_append_enum(info->list, tmp, "",
             MENU_ENUM_LABEL_CORE_INFO_ENTRY, MENU_SETTINGS_CORE_INFO_NONE, 0, 0))
          count++;
    }
 
-   if (core_info->permissions_list)
+   if (details->permissions_list)
    {
       fill_pathname_noext(tmp,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_CORE_INFO_PERMISSIONS),
             ": ",
             sizeof(tmp));
       string_list_join_concat(tmp, sizeof(tmp),
-            core_info->permissions_list, ", ");
+            details->permissions_list, ", ");
       if (menu_entries_append_enum(info->list, tmp, "",
             MENU_ENUM_LABEL_CORE_INFO_ENTRY, MENU_SETTINGS_CORE_INFO_NONE, 0, 0))
          count++;
@@ -602,7 +698,7 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info,
          count++;
    }
 
-   if (core_info->firmware_count > 0)
+   if (details->firmware_count > 0)
    {
       core_info_ctx_firmware_t firmware_info;
       bool update_missing_firmware   = false;
@@ -632,20 +728,20 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info,
          /* FIXME: This looks hacky and probably
           * needs to be improved for good translation support. */
 
-         for (i = 0; i < core_info->firmware_count; i++)
+         for (i = 0; i < details->firmware_count; i++)
          {
-            if (!core_info->firmware[i].desc)
+            if (!details->firmware[i].desc)
                continue;
 
             snprintf(tmp, sizeof(tmp), "(!) %s, %s: %s",
-                  core_info->firmware[i].missing ?
+                  details->firmware[i].missing ?
                   msg_hash_to_str(MENU_ENUM_LABEL_VALUE_MISSING) :
                   msg_hash_to_str(MENU_ENUM_LABEL_VALUE_PRESENT),
-                  core_info->firmware[i].optional ?
+                  details->firmware[i].optional ?
                   msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OPTIONAL) :
                   msg_hash_to_str(MENU_ENUM_LABEL_VALUE_REQUIRED),
-                  core_info->firmware[i].desc ?
-                  core_info->firmware[i].desc :
+                  details->firmware[i].desc ?
+                  details->firmware[i].desc :
                   msg_hash_to_str(MENU_ENUM_LABEL_VALUE_RDB_ENTRY_NAME)
                   );
 
@@ -657,12 +753,12 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info,
       }
    }
 
-   if (core_info->notes)
+   if (details->notes)
    {
-      for (i = 0; i < core_info->note_list->size; i++)
+      for (i = 0; i < details->note_list->size; i++)
       {
          strlcpy(tmp,
-               core_info->note_list->elems[i].data, sizeof(tmp));
+               details->note_list->elems[i].data, sizeof(tmp));
          if (menu_entries_append_enum(info->list, tmp, "",
                MENU_ENUM_LABEL_CORE_INFO_ENTRY, MENU_SETTINGS_CORE_INFO_NONE, 0, 0))
             count++;
@@ -1664,15 +1760,234 @@ static unsigned menu_displaylist_parse_system_info(file_list_t *list)
    return count;
 }
 
+/* State of the current virtual playlist list
+ * > Only the first entry of such a list is appended
+ *   normally; all others are appended without path,
+ *   label or callbacks, and are materialised from the
+ *   playlist when a menu driver asks for them */
+static struct
+{
+   playlist_t *playlist;
+   void (*sanitization)(char*);
+   menu_file_list_cbs_t cbs;
+   char label_spacer[PL_LABEL_SPACER_MAXLEN];
+   char path_playlist[PATH_MAX_LENGTH];
+   bool show_inline_core_name;
+   bool active;
+} menu_displaylist_virtual_pl;
+
+/* Builds the menu label of a playlist entry.
+ * Returns the path the menu entry should point to */
+static const char *menu_displaylist_playlist_label(
+      const struct playlist_entry *entry,
+      void (*sanitization)(char*),
+      bool show_inline_core_name,
+      const char *label_spacer,
+      const char *path_playlist,
+      char *s, size_t len)
+{
+   s[0] = '\0';
+
+   if (!string_is_empty(entry->path))
+   {
+      /* Standard playlist entry
+       * > Base menu entry label is always playlist label
+       *   > If playlist label is NULL, fallback to playlist entry file name
+       * > If required, add currently associated core (if any), otherwise
+       *   no further action is necessary */
+
+      if (string_is_empty(entry->label))
+         fill_short_pathname_representation(s, entry->path, len);
+      else
+         strlcpy(s, entry->label, len);
+
+      if (sanitization)
+         (*sanitization)(s);
+
+      if (show_inline_core_name)
+      {
+         /* Both core name and core path must be valid */
+         if (!string_is_empty(entry->core_name) && !string_is_equal(entry->core_name, "DETECT") &&
+             !string_is_empty(entry->core_path) && !string_is_equal(entry->core_path, "DETECT"))
+         {
+            strlcat(s, label_spacer, len);
+            strlcat(s, entry->core_name, len);
+         }
+      }
+
+      return entry->path;
+   }
+
+   /* Playlist entry without content...
+    * This is useless/broken, but have to include
+    * it otherwise synchronisation between the menu
+    * and the underlying playlist will be lost...
+    * > Use label if available, otherwise core name
+    * > If both are missing, add an empty menu entry */
+   if (!string_is_empty(entry->label))
+      strlcpy(s, entry->label, len);
+   else if (!string_is_empty(entry->core_name))
+      strlcpy(s, entry->core_name, len);
+
+   return path_playlist;
+}
+
+/* Search index over the menu labels of the last
+ * playlist searched, kept until entries change */
+static struct
+{
+   menu_search_index_t *index;
+   playlist_t *playlist;
+   void (*sanitization)(char*);
+   char label_spacer[PL_LABEL_SPACER_MAXLEN];
+   unsigned generation;
+   bool show_inline_core_name;
+} menu_displaylist_pl_search;
+
+static const char *menu_displaylist_playlist_search_label(
+      void *userdata, size_t idx, char *s, size_t len)
+{
+   const struct playlist_entry *entry = NULL;
+
+   playlist_get_index(menu_displaylist_pl_search.playlist, idx, &entry);
+
+   menu_displaylist_playlist_label(entry,
+         menu_displaylist_pl_search.sanitization,
+         menu_displaylist_pl_search.show_inline_core_name,
+         menu_displaylist_pl_search.label_spacer,
+         NULL, s, len);
+   return s;
+}
+
+/* Returns the search index of 'playlist', building
+ * it on first use */
+static menu_search_index_t *menu_displaylist_playlist_search_index(
+      playlist_t *playlist,
+      void (*sanitization)(char*),
+      bool show_inline_core_name,
+      const char *label_spacer)
+{
+   if (     menu_displaylist_pl_search.index
+         && (menu_displaylist_pl_search.playlist == playlist)
+         && (menu_displaylist_pl_search.generation ==
+            playlist_get_generation(playlist))
+         && (menu_displaylist_pl_search.sanitization == sanitization)
+         && (menu_displaylist_pl_search.show_inline_core_name ==
+            show_inline_core_name)
+         && string_is_equal(menu_displaylist_pl_search.label_spacer,
+            label_spacer))
+      return menu_displaylist_pl_search.index;
+
+   menu_search_index_free(menu_displaylist_pl_search.index);
+
+   menu_displaylist_pl_search.playlist              = playlist;
+   menu_displaylist_pl_search.generation            =
+      playlist_get_generation(playlist);
+   menu_displaylist_pl_search.sanitization          = sanitization;
+   menu_displaylist_pl_search.show_inline_core_name = show_inline_core_name;
+   strlcpy(menu_displaylist_pl_search.label_spacer, label_spacer,
+         sizeof(menu_displaylist_pl_search.label_spacer));
+   menu_displaylist_pl_search.index                 = menu_search_index_new(
+         playlist_size(playlist),
+         menu_displaylist_playlist_search_label, NULL);
+
+   return menu_displaylist_pl_search.index;
+}
+
+bool menu_displaylist_playlist_is_virtual(const file_list_t *list,
+      size_t idx)
+{
+   const struct item_file *item = NULL;
+
+   if (!menu_displaylist_virtual_pl.active || !list || idx >= list->size)
+      return false;
+
+   item = &list->list[idx];
+
+   return !item->actiondata
+      && (item->type == FILE_TYPE_RPL_ENTRY)
+      && (menu_displaylist_virtual_pl.playlist == playlist_get_cached())
+      && (item->entry_idx < playlist_size(menu_displaylist_virtual_pl.playlist));
+}
+
+const struct menu_file_list_cbs *menu_displaylist_playlist_cbs(void)
+{
+   if (!menu_displaylist_virtual_pl.active)
+      return NULL;
+   return &menu_displaylist_virtual_pl.cbs;
+}
+
+bool menu_displaylist_playlist_get_label(const file_list_t *list,
+      size_t idx, char *s, size_t len)
+{
+   const struct playlist_entry *entry = NULL;
+
+   if (!menu_displaylist_playlist_is_virtual(list, idx))
+      return false;
+
+   playlist_get_index(menu_displaylist_virtual_pl.playlist,
+         list->list[idx].entry_idx, &entry);
+
+   menu_displaylist_playlist_label(entry,
+         menu_displaylist_virtual_pl.sanitization,
+         menu_displaylist_virtual_pl.show_inline_core_name,
+         menu_displaylist_virtual_pl.label_spacer,
+         menu_displaylist_virtual_pl.path_playlist,
+         s, len);
+   return true;
+}
+
+void menu_displaylist_playlist_fill(file_list_t *list,
+      size_t first, size_t last)
+{
+   size_t i;
+
+   if (!menu_displaylist_virtual_pl.active || !list)
+      return;
+
+   for (i = first; (i <= last) && (i < list->size); i++)
+   {
+      char menu_entry_label[PATH_MAX_LENGTH];
+      const struct playlist_entry *entry = NULL;
+      const char *entry_path             = NULL;
+      menu_file_list_cbs_t *cbs          = NULL;
+
+      if (!menu_displaylist_playlist_is_virtual(list, i))
+         continue;
+
+      if (!(cbs = (menu_file_list_cbs_t*)malloc(sizeof(*cbs))))
+         return;
+
+      playlist_get_index(menu_displaylist_virtual_pl.playlist,
+            list->list[i].entry_idx, &entry);
+
+      entry_path = menu_displaylist_playlist_label(entry,
+            menu_displaylist_virtual_pl.sanitization,
+            menu_displaylist_virtual_pl.show_inline_core_name,
+            menu_displaylist_virtual_pl.label_spacer,
+            menu_displaylist_virtual_pl.path_playlist,
+            menu_entry_label, sizeof(menu_entry_label));
+
+      file_list_set_path_at_offset(list, i, menu_entry_label);
+      file_list_set_label_at_offset(list, i, entry_path);
+
+      memcpy(cbs, &menu_displaylist_virtual_pl.cbs, sizeof(*cbs));
+      list->list[i].actiondata = cbs;
+   }
+}
+
 static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
       playlist_t *playlist,
       settings_t *settings,
       const char *path_playlist, bool is_collection)
 {
-   unsigned i;
+   size_t k;
    char label_spacer[PL_LABEL_SPACER_MAXLEN];
+   const uint32_t *matches           = NULL;
+   size_t num_matches                = 0;
    size_t           list_size        = playlist_size(playlist);
    bool show_inline_core_name        = false;
+   bool is_virtual                   = false;
    const char *menu_driver           = menu_driver_ident();
    menu_serch_terms_t *search_terms  = menu_entries_search_get_terms();
    unsigned pl_show_inline_core_name = settings->uints.playlist_show_inline_core_name;
@@ -1682,6 +1997,9 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
    label_spacer[0] = '\0';
    info->count     = 0;
 
+   /* Any previous virtual list is being replaced */
+   menu_displaylist_virtual_pl.active = false;
+
    if (list_size == 0)
       goto error;
 
@@ -1761,62 +2079,60 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
          sanitization = NULL;
    }
 
-   for (i = 0; i < list_size; i++)
+   /* Huge playlists are displayed as virtual lists,
+    * unless entries have to be filtered */
+   is_virtual = !search_terms && (list_size >= PL_VIRTUAL_MIN_SIZE);
+
+   /* Search terms are looked up in the index, and only
+    * the matching entries are visited */
+   if (search_terms)
+   {
+      size_t j;
+      const char *terms[MENU_SEARCH_FILTER_MAX_TERMS];
+      menu_search_index_t *index = menu_displaylist_playlist_search_index(
+            playlist, sanitization, show_inline_core_name, label_spacer);
+
+      for (j = 0; j < search_terms->size; j++)
+         terms[j] = search_terms->terms[j];
+
+      if (index && menu_search_index_find(index, terms,
+               search_terms->size, &matches, &num_matches))
+         search_terms = NULL;
+      else
+         matches      = NULL;
+   }
+   /* Don't keep the index of a playlist left behind */
+   else if (menu_displaylist_pl_search.playlist != playlist)
+   {
+      menu_search_index_free(menu_displaylist_pl_search.index);
+      menu_displaylist_pl_search.index    = NULL;
+      menu_displaylist_pl_search.playlist = NULL;
+   }
+
+   for (k = 0; k < (matches ? num_matches : list_size); k++)
    {
       char menu_entry_label[PATH_MAX_LENGTH];
       const struct playlist_entry *entry = NULL;
       const char *entry_path             = NULL;
       bool entry_valid                   = true;
+      unsigned i                         = matches
+         ? (unsigned)matches[k] : (unsigned)k;
 
-      menu_entry_label[0] = '\0';
+      if (is_virtual && (i > 0))
+      {
+         if (menu_entries_append_virtual(info->list,
+               FILE_TYPE_RPL_ENTRY, 0, i))
+            info->count++;
+         continue;
+      }
 
       /* Read playlist entry */
       playlist_get_index(playlist, i, &entry);
 
-      if (!string_is_empty(entry->path))
-      {
-         /* Standard playlist entry
-          * > Base menu entry label is always playlist label
-          *   > If playlist label is NULL, fallback to playlist entry file name
-          * > If required, add currently associated core (if any), otherwise
-          *   no further action is necessary */
-
-         if (string_is_empty(entry->label))
-            fill_short_pathname_representation(menu_entry_label, entry->path, sizeof(menu_entry_label));
-         else
-            strlcpy(menu_entry_label, entry->label, sizeof(menu_entry_label));
-
-         if (sanitization)
-            (*sanitization)(menu_entry_label);
-
-         if (show_inline_core_name)
-         {
-            /* Both core name and core path must be valid */
-            if (!string_is_empty(entry->core_name) && !string_is_equal(entry->core_name, "DETECT") &&
-                !string_is_empty(entry->core_path) && !string_is_equal(entry->core_path, "DETECT"))
-            {
-               strlcat(menu_entry_label, label_spacer, sizeof(menu_entry_label));
-               strlcat(menu_entry_label, entry->core_name, sizeof(menu_entry_label));
-            }
-         }
-
-         entry_path = entry->path;
-      }
-      else
-      {
-         /* Playlist entry without content...
-          * This is useless/broken, but have to include
-          * it otherwise synchronisation between the menu
-          * and the underlying playlist will be lost...
-          * > Use label if available, otherwise core name
-          * > If both are missing, add an empty menu entry */
-         if (!string_is_empty(entry->label))
-            strlcpy(menu_entry_label, entry->label, sizeof(menu_entry_label));
-         else if (!string_is_empty(entry->core_name))
-            strlcpy(menu_entry_label, entry->core_name, sizeof(menu_entry_label));
-
-         entry_path = path_playlist;
-      }
+      entry_path = menu_displaylist_playlist_label(entry,
+            sanitization, show_inline_core_name,
+            label_spacer, path_playlist,
+            menu_entry_label, sizeof(menu_entry_label));
 
       /* Check whether entry matches search terms,
        * if required */
@@ -1841,7 +2157,35 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
       if (entry_valid && menu_entries_append_enum(info->list,
             menu_entry_label, entry_path,
             MENU_ENUM_LABEL_PLAYLIST_ENTRY, FILE_TYPE_RPL_ENTRY, 0, i))
+      {
          info->count++;
+
+         /* All entries of a virtual list share the
+          * callbacks bound to the first one */
+         if (is_virtual)
+         {
+            menu_file_list_cbs_t *cbs = (menu_file_list_cbs_t*)
+               info->list->list[info->list->size - 1].actiondata;
+
+            if (!cbs)
+               is_virtual = false;
+            else
+            {
+               memcpy(&menu_displaylist_virtual_pl.cbs, cbs, sizeof(*cbs));
+               menu_displaylist_virtual_pl.playlist              = playlist;
+               menu_displaylist_virtual_pl.sanitization          = sanitization;
+               menu_displaylist_virtual_pl.show_inline_core_name = show_inline_core_name;
+               strlcpy(menu_displaylist_virtual_pl.label_spacer, label_spacer,
+                     sizeof(menu_displaylist_virtual_pl.label_spacer));
+               strlcpy(menu_displaylist_virtual_pl.path_playlist,
+                     path_playlist ? path_playlist : "",
+                     sizeof(menu_displaylist_virtual_pl.path_playlist));
+               menu_displaylist_virtual_pl.active                = true;
+            }
+         }
+      }
+      else
+         is_virtual = false;
    }
 
    if (info->count < 1)
@@ -5397,6 +5741,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_PLAYLIST_SUBLABEL_LAST_PLAYED_STYLE, PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_PLAYLIST_FUZZY_ARCHIVE_MATCH,        PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SCAN_WITHOUT_CORE_MATCH,             PARSE_ONLY_BOOL, true},
+               {MENU_ENUM_LABEL_SCAN_THREADS,                        PARSE_ONLY_UINT, true},
                {MENU_ENUM_LABEL_OZONE_TRUNCATE_PLAYLIST_NAME,        PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_OZONE_SORT_AFTER_TRUNCATE_PLAYLIST_NAME, PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_CONTENT_RUNTIME_LOG,                 PARSE_ONLY_BOOL, true},
@@ -5872,6 +6217,10 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_AUDIO_SYNC,
                   PARSE_ONLY_BOOL, false) == 0)
             count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_THREADED_PROCESSING,
+                  PARSE_ONLY_BOOL, false) == 0)
+            count++;
          if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                   MENU_ENUM_LABEL_AUDIO_MAX_TIMING_SKEW,
                   PARSE_ONLY_FLOAT, false) == 0)
@@ -5880,6 +6229,14 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
                   PARSE_ONLY_FLOAT, false) == 0)
             count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_PI,
+                  PARSE_ONLY_BOOL, false) == 0)
+            count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_TARGET,
+                  PARSE_ONLY_UINT, false) == 0)
+            count++;
          break;
       case DISPLAYLIST_AUDIO_SETTINGS_LIST:
          if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
@@ -5999,12 +6356,22 @@ unsigned menu_displaylist_build_list(
                      MENU_ENUM_LABEL_VIDEO_BLACK_FRAME_INSERTION,
                      PARSE_ONLY_UINT, false) == 0)
                count++;
+            if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                     MENU_ENUM_LABEL_VIDEO_FRAME_DUPE_DETECT,
+                     PARSE_ONLY_BOOL, false) == 0)
+               count++;
 #ifdef HAVE_SCREENSHOTS
             if (video_driver_supports_viewport_read())
                if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                         MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT,
                         PARSE_ONLY_BOOL, false) == 0)
                   count++;
+#ifdef HAVE_RPNG
+            if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                     MENU_ENUM_LABEL_SCREENSHOT_MODE,
+                     PARSE_ONLY_UINT, false) == 0)
+               count++;
+#endif
 #endif
             if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                      MENU_ENUM_LABEL_VIDEO_SMOOTH,
@@ -6514,6 +6881,17 @@ unsigned menu_displaylist_build_list(
                net_ifinfo_free(&netlist);
             }
          }
+
+         {
+            unsigned k;
+            char tmp[255];
+
+            for (k = 0; netplay_get_peer_stats(k, tmp, sizeof(tmp)); k++)
+               if (menu_entries_append_enum(list, tmp, "",
+                        MENU_ENUM_LABEL_NETWORK_INFO_ENTRY,
+                        MENU_SETTINGS_CORE_INFO_NONE, 0, 0))
+                  count++;
+         }
 #endif
          break;
       case DISPLAYLIST_OPTIONS_CHEATS:
@@ -7070,6 +7448,8 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_NETPLAY_INPUT_LATENCY_FRAMES_MIN,                      PARSE_ONLY_INT,    true},
                {MENU_ENUM_LABEL_NETPLAY_INPUT_LATENCY_FRAMES_RANGE,                    PARSE_ONLY_INT,    true},
                {MENU_ENUM_LABEL_NETPLAY_NAT_TRAVERSAL,                                 PARSE_ONLY_BOOL,   true},
+               {MENU_ENUM_LABEL_NETPLAY_UDP_INPUT,                                     PARSE_ONLY_BOOL,   true},
+               {MENU_ENUM_LABEL_NETPLAY_RELAY_PORT,                                    PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_NETPLAY_SHARE_DIGITAL,                                 PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_NETPLAY_SHARE_ANALOG,                                  PARSE_ONLY_UINT,   true},
             };
@@ -7157,6 +7537,11 @@ unsigned menu_displaylist_build_list(
                      PARSE_ONLY_BOOL, false) != -1)
                count++;
 
+            if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                     MENU_ENUM_LABEL_NETWORK_THUMBNAIL_DOWNLOADS,
+                     PARSE_ONLY_UINT, false) != -1)
+               count++;
+
 #ifdef HAVE_ONLINE_UPDATER
             if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                      MENU_ENUM_LABEL_UPDATER_SETTINGS,
@@ -7490,6 +7875,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_PAUSE_NONACTIVE,                                       PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_SAVESTATE_RESUME,                                 PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_INSERT_DISK_RESUME,                               PARSE_ONLY_BOOL,   true},
+               {MENU_ENUM_LABEL_MENU_SKIP_STATIC_FRAMES,                               PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_QUIT_ON_CLOSE_CONTENT,                                 PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_SCREENSAVER_TIMEOUT,                              PARSE_ONLY_UINT,   false},
                {MENU_ENUM_LABEL_MENU_SCREENSAVER_ANIMATION,                            PARSE_ONLY_UINT,   false},
@@ -7726,6 +8112,10 @@ unsigned menu_displaylist_build_list(
                         MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,
                         PARSE_ONLY_UINT, false) == 0)
                   count++;
+               if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                        MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+                        PARSE_ONLY_BOOL, false) == 0)
+                  count++;
             }
 
             if (video_driver_test_all_flags(GFX_CTX_FLAGS_HARD_SYNC))
@@ -8101,6 +8491,7 @@ unsigned menu_displaylist_build_list(
             bool video_hard_sync          = settings->bools.video_hard_sync;
             menu_displaylist_build_info_selective_t build_list[] = {
                {MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,                     PARSE_ONLY_UINT, true },
+               {MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,                PARSE_ONLY_BOOL, true },
                {MENU_ENUM_LABEL_AUDIO_LATENCY,                         PARSE_ONLY_UINT, true },
                {MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR,              PARSE_ONLY_UINT, true },
                {MENU_ENUM_LABEL_INPUT_BLOCK_TIMEOUT,                   PARSE_ONLY_UINT, true },
@@ -8109,6 +8500,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,                      PARSE_ONLY_UINT, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,          PARSE_ONLY_BOOL, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,               PARSE_ONLY_BOOL, false },
+               {MENU_ENUM_LABEL_RUN_AHEAD_CALIBRATE,                   PARSE_ACTION,    false },
 #endif
             };
 
@@ -8147,6 +8539,11 @@ unsigned menu_displaylist_build_list(
                         case MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS:
                            build_list[i].checked = true;
                            break;
+                        case MENU_ENUM_LABEL_RUN_AHEAD_CALIBRATE:
+                           /* Needs running content */
+                           build_list[i].checked = !rarch_ctl(
+                                 RARCH_CTL_IS_DUMMY_CORE, NULL);
+                           break;
                         default:
                            break;
                      }
@@ -8188,6 +8585,7 @@ unsigned menu_displaylist_build_list(
 #endif
                {MENU_ENUM_LABEL_VIDEO_FONT_PATH,                       PARSE_ONLY_PATH,   false },
                {MENU_ENUM_LABEL_VIDEO_FONT_SIZE,                       PARSE_ONLY_FLOAT,  false },
+               {MENU_ENUM_LABEL_VIDEO_FONT_SDF_ENABLE,                 PARSE_ONLY_BOOL,   true  },
                {MENU_ENUM_LABEL_VIDEO_MESSAGE_POS_X,                   PARSE_ONLY_FLOAT,  false },
                {MENU_ENUM_LABEL_VIDEO_MESSAGE_POS_Y,                   PARSE_ONLY_FLOAT,  false },
                {MENU_ENUM_LABEL_VIDEO_MESSAGE_COLOR_RED,               PARSE_ONLY_FLOAT,  false },
@@ -8588,6 +8986,7 @@ unsigned menu_displaylist_build_list(
          {
             menu_displaylist_build_info_t build_list[] = {
                {MENU_ENUM_LABEL_SUSTAINED_PERFORMANCE_MODE, PARSE_ONLY_BOOL},
+               {MENU_ENUM_LABEL_POWER_SAVING_MODE,          PARSE_ONLY_BOOL},
                {MENU_ENUM_LABEL_CPU_PERFPOWER,              PARSE_ACTION},
             };
 
@@ -8788,6 +9187,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_CHECK_FOR_MISSING_FIRMWARE,        PARSE_ONLY_BOOL},
                {MENU_ENUM_LABEL_VIDEO_ALLOW_ROTATE,                PARSE_ONLY_BOOL},
                {MENU_ENUM_LABEL_CORE_INFO_CACHE_ENABLE,            PARSE_ONLY_BOOL},
+               {MENU_ENUM_LABEL_VFS_READ_BLOCK_SIZE,               PARSE_ONLY_UINT},
 #ifndef HAVE_DYNAMIC
                {MENU_ENUM_LABEL_ALWAYS_RELOAD_CORE_ON_RUN_CONTENT, PARSE_ONLY_BOOL},
 #endif
@@ -8924,7 +9324,9 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_LIBRETRO_LOG_LEVEL,    PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_LOG_TO_FILE,           PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_LOG_TO_FILE_TIMESTAMP, PARSE_ONLY_BOOL, false},
+               {MENU_ENUM_LABEL_LOG_ASYNC,             PARSE_ONLY_BOOL, false},
                {MENU_ENUM_LABEL_PERFCNT_ENABLE,        PARSE_ONLY_BOOL, true},
+               {MENU_ENUM_LABEL_TRACE_DURATION,        PARSE_ONLY_UINT, true},
             };
 
             for (i = 0; i < ARRAY_SIZE(build_list); i++)
@@ -8933,6 +9335,7 @@ unsigned menu_displaylist_build_list(
                {
                   case MENU_ENUM_LABEL_FRONTEND_LOG_LEVEL:
                   case MENU_ENUM_LABEL_LIBRETRO_LOG_LEVEL:
+                  case MENU_ENUM_LABEL_LOG_ASYNC:
                      if (verbosity_is_enabled())
                         build_list[i].checked = true;
                      break;
@@ -9020,6 +9423,7 @@ unsigned menu_displaylist_build_list(
 #endif
                {MENU_ENUM_LABEL_FRAME_TIME_COUNTER_SETTINGS, PARSE_ACTION},
                {MENU_ENUM_LABEL_FASTFORWARD_RATIO,       PARSE_ONLY_FLOAT},
+               {MENU_ENUM_LABEL_FASTFORWARD_FRAMESKIP,   PARSE_ONLY_BOOL },
                {MENU_ENUM_LABEL_SLOWMOTION_RATIO,        PARSE_ONLY_FLOAT},
                {MENU_ENUM_LABEL_VRR_RUNLOOP_ENABLE,      PARSE_ONLY_BOOL },
                {MENU_ENUM_LABEL_MENU_THROTTLE_FRAMERATE, PARSE_ONLY_BOOL },
@@ -9103,6 +9507,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_XMB_VERTICAL_THUMBNAILS,                      PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_XMB_THUMBNAIL_SCALE_FACTOR,              PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,             PARSE_ONLY_UINT,   true},
+               {MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,                    PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_SWAP_THUMBNAILS,                    PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,               PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DELAY,                    PARSE_ONLY_UINT,   true},
@@ -9369,6 +9774,13 @@ unsigned menu_displaylist_netplay_refresh_rooms(file_list_t *list)
                : msg_hash_to_str(MSG_INTERNET)),
             netplay_room_list[i].nickname, country);
 
+         if (netplay_room_list[i].latency >= 0)
+         {
+            size_t _len = strlen(s);
+            snprintf(s + _len, sizeof(s) - _len, " %d ms",
+                  netplay_room_list[i].latency);
+         }
+
          if (menu_entries_append_enum(list,
                s,
                msg_hash_to_str(MENU_ENUM_LABEL_CONNECT_NETPLAY_ROOM),
@@ -10500,6 +10912,15 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type,
                         0, 0, 0))
                   count++;
 
+#ifdef HAVE_SLANG
+               if (menu_entries_append_enum(info->list,
+                        msg_hash_to_str(MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_FP16_FRAMEBUFFERS),
+                        msg_hash_to_str(MENU_ENUM_LABEL_VIDEO_SHADER_FP16_FRAMEBUFFERS),
+                        MENU_ENUM_LABEL_VIDEO_SHADER_FP16_FRAMEBUFFERS,
+                        0, 0, 0))
+                  count++;
+#endif
+
                if (menu_entries_append_enum(info->list,
                         msg_hash_to_str(MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_PRESET),
                         msg_hash_to_str(MENU_ENUM_LABEL_VIDEO_SHADER_PRESET),
@@ -334,6 +334,25 @@ unsigned menu_displaylist_netplay_refresh_rooms(file_list_t *list);
 
 bool menu_displaylist_has_subsystems(void);
 
+struct menu_file_list_cbs;
+
+/* Virtual playlist lists: entries of huge playlists are
+ * appended without path, label or callbacks, and are
+ * filled in from the playlist on demand */
+bool menu_displaylist_playlist_is_virtual(const file_list_t *list,
+      size_t idx);
+
+/* Callbacks shared by all entries of the current virtual list */
+const struct menu_file_list_cbs *menu_displaylist_playlist_cbs(void);
+
+/* Builds the label of a virtual entry without filling it in */
+bool menu_displaylist_playlist_get_label(const file_list_t *list,
+      size_t idx, char *s, size_t len);
+
+/* Fills in the virtual entries in [first, last] */
+void menu_displaylist_playlist_fill(file_list_t *list,
+      size_t first, size_t last);
+
 #if defined(HAVE_LIBRETRODB)
 unsigned menu_displaylist_explore(file_list_t *list, settings_t *settings);
 #endif
@@ -344,6 +363,8 @@ void filebrowser_clear_type(void);
 
 void filebrowser_set_type(enum filebrowser_enums type);
 
+void filebrowser_cache_free(void);
+
 int menu_displaylist_parse_settings_enum(
       file_list_t *info_list,
       enum menu_displaylist_parse_type parse_type,
@@ -78,7 +78,7 @@ enum menu_entry_type
 typedef struct menu_ctx_list
 {
    const char  *path;
-   char        *fullpath;
+   const char  *fullpath;
    const char  *label;
    file_list_t *list;
    void        *entry;
@@ -192,6 +192,12 @@ bool menu_entries_append_enum(file_list_t *list,
       enum msg_hash_enums enum_idx,
       unsigned type, size_t directory_ptr, size_t entry_idx);
 
+/* Appends an entry without path, label or callbacks;
+ * the list builder is expected to fill these in on
+ * demand (see menu_displaylist_playlist_fill()) */
+bool menu_entries_append_virtual(file_list_t *list,
+      unsigned type, size_t directory_ptr, size_t entry_idx);
+
 bool menu_entries_ctl(enum menu_entries_ctl_state state, void *data);
 
 bool menu_entries_search_push(const char *search_term);
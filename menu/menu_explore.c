@@ -17,19 +17,29 @@
 #include <stddef.h>
 #include "menu_driver.h"
 #include "menu_cbs.h"
+#include "menu_search_index.h"
 #include "../retroarch.h"
 #include "../configuration.h"
 #include "../playlist.h"
 #include "../libretro-db/libretrodb.h"
+#include "../file_path_special.h"
+#include "../paths.h"
+#include "../verbosity.h"
 #include <compat/strcasestr.h>
 #include <compat/strl.h>
 #include <array/rbuf.h>
 #include <array/rhmap.h>
+#include <file/file_path.h>
+#include <queues/task_queue.h>
+#include <streams/file_stream.h>
 
 #define EX_ARENA_ALIGNMENT 8
 #define EX_ARENA_BLOCK_SIZE (64 * 1024)
 #define EX_ARENA_ALIGN_UP(n, a) (((n) + (a) - 1) & ~((a) - 1))
 
+/* top_depth of a state not displayed yet */
+#define EXPLORE_TOP_DEPTH_NONE ((unsigned)-1)
+
 /* Explore */
 enum
 {
@@ -86,6 +96,7 @@ typedef struct
    ex_arena arena; /* ptr alignment */
    explore_string_t **by[EXPLORE_CAT_COUNT];
    explore_entry_t *entries;
+   menu_search_index_t *find_index; /* over entry labels */
    playlist_t **playlists;
    uintptr_t *icons;
    const char *label_explore_item_str;
@@ -119,6 +130,7 @@ explore_by_info[EXPLORE_CAT_COUNT] =
 
 /* TODO/FIXME - static global */
 static explore_state_t* explore_state;
+static bool explore_build_pending;
 
 static void ex_arena_grow(ex_arena *arena, size_t min_size)
 {
@@ -338,6 +350,8 @@ static void explore_free(explore_state_t *state)
       RBUF_FREE(state->by[i]);
 
    RBUF_FREE(state->entries);
+   menu_search_index_free(state->find_index);
+   state->find_index = NULL;
 
    for (i = 0; i != RBUF_LEN(state->playlists); i++)
       playlist_free(state->playlists[i]);
@@ -399,10 +413,521 @@ static void explore_load_icons(explore_state_t *state)
    }
 }
 
-static explore_state_t *explore_build_list(settings_t *settings)
+/* Copies the string value of @key in an encoded rdb entry
+ * to *@strings and moves that past it */
+static char *explore_view_string(const uint8_t *item, size_t len,
+      const char *key, char **strings)
+{
+   char *str;
+   struct rmsgpack_dom_value val;
+
+   if (     rmsgpack_dom_view_map_value(item, len, key, &val) != 0
+         || val.type != RDT_STRING)
+      return NULL;
+
+   str                     = *strings;
+   memcpy(str, val.val.string.buff, val.val.string.len);
+   str[val.val.string.len] = '\0';
+   *strings               += val.val.string.len + 1;
+   return str;
+}
+
+/* The explore cache keeps a built explore state across
+ * sessions, the databases are only read again once a
+ * playlist or database changed. It is a single file in the playlist directory:
+ * a header followed by the playlist and database files it was
+ * built from, the category strings, the entries, the split
+ * lists and the string table they all point into. It is used
+ * only if every playlist and database still has the size and
+ * modification time it had. */
+#define EXPLORE_CACHE_MAGIC   0x58454152 /* 'RAEX' */
+#define EXPLORE_CACHE_VERSION 1
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t playlist_count;
+   uint32_t rdb_count;
+   uint32_t entry_count;
+   uint32_t split_count;
+   uint32_t strings_size;
+   uint32_t database_directory;
+   uint32_t has_unknown;  /* one bit per category */
+   uint32_t reserved;     /* keeps the file records 8 byte aligned */
+   uint32_t string_count[EXPLORE_CAT_COUNT];
+} explore_cache_header_t;
+
+typedef struct
+{
+   int64_t size;
+   int64_t mtime;
+   uint32_t name;
+   uint32_t entries; /* playlist size if it has explore entries, else 0 */
+} explore_cache_file_t;
+
+typedef struct
+{
+   uint32_t playlist;
+   uint32_t index;
+   uint32_t by[EXPLORE_CAT_COUNT]; /* string index + 1, 0 if unknown */
+   uint32_t split;                 /* first split reference */
+   uint32_t split_count;
+   uint32_t original_title;        /* 0 if none */
+} explore_cache_entry_t;
+
+/* A playlist or database read by explore_build_list(),
+ * playlists are named relative to their directory */
+typedef struct
+{
+   char *name;
+   int64_t size;
+   int64_t mtime;
+   uint32_t entries;
+} explore_file_t;
+
+static void explore_file_push(explore_file_t **files,
+      const char *path, const char *name, uint32_t entries)
+{
+   explore_file_t file;
+   file.name    = strdup(name);
+   file.size    = path_get_size(path);
+   file.mtime   = path_get_mtime(path);
+   file.entries = entries;
+   RBUF_PUSH(*files, file);
+}
+
+static void explore_files_free(explore_file_t *files)
+{
+   size_t i;
+   for (i = 0; i != RBUF_LEN(files); i++)
+      free(files[i].name);
+   RBUF_FREE(files);
+}
+
+static uint32_t explore_cache_add_string(char **strings, const char *str)
+{
+   size_t offset = RBUF_LEN(*strings);
+   size_t len    = strlen(str) + 1;
+
+   if (len == 1)
+      return 0;
+
+   RBUF_RESIZE(*strings, offset + len);
+   memcpy(*strings + offset, str, len);
+   return (uint32_t)offset;
+}
+
+/* Split lists mix the strings of several categories,
+ * they are referenced across all of them in order */
+static uint32_t explore_cache_string_ref(explore_state_t *explore,
+      const explore_string_t *str)
+{
+   unsigned cat;
+   uint32_t base = 0;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      size_t len = RBUF_LEN(explore->by[cat]);
+      if (str->idx < len && explore->by[cat][str->idx] == str)
+         return base + str->idx;
+      base += (uint32_t)len;
+   }
+
+   return base;
+}
+
+static void explore_cache_save(explore_state_t *explore,
+      const char *path, const char *directory_database,
+      explore_file_t *playlists, explore_file_t *rdbs)
+{
+   size_t i, offset;
+   unsigned cat;
+   explore_cache_header_t header;
+   explore_cache_file_t *files      = NULL;
+   uint32_t *cat_strings            = NULL;
+   explore_cache_entry_t *entries   = NULL;
+   uint32_t *split                  = NULL;
+   char *strings                    = NULL;
+   uint8_t *buf                     = NULL;
+   size_t entry_count               = RBUF_LEN(explore->entries);
+   size_t size                      = 0;
+
+   /* Without a modification time a changed playlist
+    * cannot be told apart, so nothing is cached */
+   if (!RBUF_LEN(playlists))
+      return;
+   for (i = 0; i != RBUF_LEN(playlists); i++)
+      if (!playlists[i].mtime || playlists[i].size < 0)
+         return;
+
+   RBUF_PUSH(strings, '\0');
+
+   memset(&header, 0, sizeof(header));
+   header.magic              = EXPLORE_CACHE_MAGIC;
+   header.version            = EXPLORE_CACHE_VERSION;
+   header.playlist_count     = (uint32_t)RBUF_LEN(playlists);
+   header.rdb_count          = (uint32_t)RBUF_LEN(rdbs);
+   header.entry_count        = (uint32_t)entry_count;
+   header.database_directory = explore_cache_add_string(
+         &strings, directory_database);
+
+   for (i = 0; i != RBUF_LEN(playlists) + RBUF_LEN(rdbs); i++)
+   {
+      explore_cache_file_t file;
+      explore_file_t *src = (i < RBUF_LEN(playlists))
+         ? &playlists[i] : &rdbs[i - RBUF_LEN(playlists)];
+      file.size           = src->size;
+      file.mtime          = src->mtime;
+      file.name           = explore_cache_add_string(&strings, src->name);
+      file.entries        = src->entries;
+      RBUF_PUSH(files, file);
+   }
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      size_t len = RBUF_LEN(explore->by[cat]);
+
+      if (explore->has_unknown[cat])
+         header.has_unknown |= (1 << cat);
+      header.string_count[cat] = (uint32_t)len;
+
+      for (i = 0; i != len; i++)
+         RBUF_PUSH(cat_strings, explore_cache_add_string(
+                  &strings, explore->by[cat][i]->str));
+   }
+
+   for (i = 0; i != entry_count; i++)
+   {
+      size_t pl_idx;
+      explore_cache_entry_t rec;
+      const explore_entry_t *e = &explore->entries[i];
+
+      for (pl_idx = 0; pl_idx != RBUF_LEN(explore->playlists); pl_idx++)
+      {
+         const struct playlist_entry *pl_first = NULL;
+         playlist_t *pl = explore->playlists[pl_idx];
+
+         playlist_get_index(pl, 0, &pl_first);
+         if (     e->playlist_entry >= pl_first
+               && e->playlist_entry <  pl_first + playlist_size(pl))
+         {
+            rec.index = (uint32_t)(e->playlist_entry - pl_first);
+            break;
+         }
+      }
+      if (pl_idx == RBUF_LEN(explore->playlists))
+         goto end;
+
+      rec.playlist       = (uint32_t)pl_idx;
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         rec.by[cat]     = e->by[cat] ? e->by[cat]->idx + 1 : 0;
+      rec.split          = (uint32_t)RBUF_LEN(split);
+      rec.split_count    = 0;
+      rec.original_title = 0;
+      if (e->split)
+      {
+         explore_string_t **it;
+         for (it = e->split; *it; it++, rec.split_count++)
+            RBUF_PUSH(split, explore_cache_string_ref(explore, *it));
+      }
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+      if (e->original_title)
+         rec.original_title = explore_cache_add_string(
+               &strings, e->original_title);
+#endif
+      RBUF_PUSH(entries, rec);
+   }
+
+   header.split_count  = (uint32_t)RBUF_LEN(split);
+   header.strings_size = (uint32_t)RBUF_LEN(strings);
+
+   size = sizeof(header)
+      + RBUF_SIZEOF(files)
+      + RBUF_SIZEOF(cat_strings)
+      + RBUF_SIZEOF(entries)
+      + RBUF_SIZEOF(split)
+      + RBUF_SIZEOF(strings);
+
+   if (!(buf = (uint8_t*)malloc(size)))
+      goto end;
+
+   memcpy(buf, &header, sizeof(header));
+   offset = sizeof(header);
+   if (files)
+      memcpy(buf + offset, files, RBUF_SIZEOF(files));
+   offset += RBUF_SIZEOF(files);
+   if (cat_strings)
+      memcpy(buf + offset, cat_strings, RBUF_SIZEOF(cat_strings));
+   offset += RBUF_SIZEOF(cat_strings);
+   if (entries)
+      memcpy(buf + offset, entries, RBUF_SIZEOF(entries));
+   offset += RBUF_SIZEOF(entries);
+   if (split)
+      memcpy(buf + offset, split, RBUF_SIZEOF(split));
+   offset += RBUF_SIZEOF(split);
+   memcpy(buf + offset, strings, RBUF_SIZEOF(strings));
+
+   if (!filestream_write_file(path, buf, size))
+      RARCH_WARN("[Explore]: Could not write \"%s\".\n", path);
+
+end:
+   free(buf);
+   RBUF_FREE(files);
+   RBUF_FREE(cat_strings);
+   RBUF_FREE(entries);
+   RBUF_FREE(split);
+   RBUF_FREE(strings);
+}
+
+static bool explore_cache_file_changed(
+      const explore_cache_file_t *file, const char *path)
+{
+   return path_get_size(path)  != file->size
+       || path_get_mtime(path) != file->mtime;
+}
+
+/* Fills @explore from the cache, fails if it is missing,
+ * invalid or any of its files changed */
+static bool explore_cache_load(explore_state_t *explore,
+      const char *path, const char *directory_playlist,
+      const char *directory_database)
+{
+   size_t i;
+   unsigned cat;
+   char tmp[PATH_MAX_LENGTH];
+   const explore_cache_header_t *header = NULL;
+   const explore_cache_file_t *files    = NULL;
+   const uint32_t *cat_strings          = NULL;
+   const explore_cache_entry_t *entries = NULL;
+   const uint32_t *split                = NULL;
+   const char *strings                  = NULL;
+   explore_string_t **all_strings       = NULL;
+   size_t *playlist_files               = NULL;
+   size_t string_total                  = 0;
+   size_t found                         = 0;
+   libretro_vfs_implementation_dir *dir = NULL;
+   void *buf                            = NULL;
+   int64_t len                          = 0;
+   bool ret                             = false;
+
+   if (     !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   header = (const explore_cache_header_t*)buf;
+
+   if (     (size_t)len < sizeof(*header)
+         || header->magic        != EXPLORE_CACHE_MAGIC
+         || header->version      != EXPLORE_CACHE_VERSION
+         || header->strings_size == 0)
+      goto end;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      string_total += header->string_count[cat];
+
+   if ((uint64_t)len != sizeof(*header)
+         + ((uint64_t)header->playlist_count + header->rdb_count)
+            * sizeof(*files)
+         + (uint64_t)string_total * sizeof(*cat_strings)
+         + (uint64_t)header->entry_count * sizeof(*entries)
+         + (uint64_t)header->split_count * sizeof(*split)
+         + header->strings_size)
+      goto end;
+
+   files       = (const explore_cache_file_t*)(header + 1);
+   cat_strings = (const uint32_t*)(files
+         + header->playlist_count + header->rdb_count);
+   entries     = (const explore_cache_entry_t*)(cat_strings + string_total);
+   split       = (const uint32_t*)(entries + header->entry_count);
+   strings     = (const char*)(split + header->split_count);
+
+   /* Every string must be terminated within the table */
+   if (     strings[0] != '\0'
+         || strings[header->strings_size - 1] != '\0'
+         || header->database_directory >= header->strings_size
+         || !string_is_equal(strings + header->database_directory,
+            directory_database))
+      goto end;
+
+   for (i = 0; i != header->playlist_count + header->rdb_count; i++)
+      if (files[i].name >= header->strings_size || !files[i].name)
+         goto end;
+   for (i = 0; i != string_total; i++)
+      if (cat_strings[i] >= header->strings_size || !cat_strings[i])
+         goto end;
+
+   /* The same playlists must still be there, unchanged */
+   for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
+   {
+      const char *fext  = NULL;
+      const char *fname = NULL;
+
+      if (!retro_vfs_readdir_impl(dir))
+      {
+         retro_vfs_closedir_impl(dir);
+         break;
+      }
+
+      fname = retro_vfs_dirent_get_name_impl(dir);
+      if (fname)
+         fext  = strrchr(fname, '.');
+
+      if (!fext || strcasecmp(fext, ".lpl"))
+         continue;
+
+      for (i = 0; i != header->playlist_count; i++)
+         if (string_is_equal(strings + files[i].name, fname))
+            break;
+
+      fill_pathname_join(tmp, directory_playlist, fname, sizeof(tmp));
+      if (     i == header->playlist_count
+            || explore_cache_file_changed(&files[i], tmp))
+      {
+         retro_vfs_closedir_impl(dir);
+         goto end;
+      }
+      found++;
+   }
+
+   if (found != header->playlist_count)
+      goto end;
+
+   for (i = 0; i != header->rdb_count; i++)
+   {
+      const explore_cache_file_t *file = &files[header->playlist_count + i];
+      if (explore_cache_file_changed(file, strings + file->name))
+         goto end;
+   }
+
+   for (i = 0; i != header->playlist_count; i++)
+   {
+      playlist_config_t playlist_config;
+      playlist_t *playlist = NULL;
+
+      if (!files[i].entries)
+         continue;
+
+      playlist_config.base_content_directory[0] = '\0';
+      playlist_config.capacity                  = COLLECTION_SIZE;
+      playlist_config.old_format                = false;
+      playlist_config.compress                  = false;
+      playlist_config.fuzzy_archive_match       = false;
+      playlist_config.autofix_paths             = false;
+      fill_pathname_join(playlist_config.path, directory_playlist,
+            strings + files[i].name, sizeof(playlist_config.path));
+
+      if (!(playlist = playlist_init(&playlist_config)))
+         goto end;
+      RBUF_PUSH(explore->playlists, playlist);
+      RBUF_PUSH(playlist_files, i);
+
+      if (playlist_size(playlist) != files[i].entries)
+         goto end;
+   }
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      uint32_t idx;
+
+      explore->has_unknown[cat] = !!(header->has_unknown & (1 << cat));
+
+      for (idx = 0; idx != header->string_count[cat]; idx++)
+      {
+         const char *str         = strings + *(cat_strings++);
+         size_t _len             = strlen(str);
+         explore_string_t *entry = (explore_string_t*)
+            ex_arena_alloc(&explore->arena,
+                  sizeof(explore_string_t) + _len);
+         memcpy(entry->str, str, _len + 1);
+         entry->idx              = idx;
+         RBUF_PUSH(explore->by[cat], entry);
+         RBUF_PUSH(all_strings, entry);
+      }
+   }
+
+   for (i = 0; i != header->entry_count; i++)
+   {
+      explore_entry_t e;
+      const explore_cache_entry_t *rec = &entries[i];
+
+      if (     rec->playlist >= RBUF_LEN(explore->playlists)
+            || rec->index    >= files[playlist_files[rec->playlist]].entries
+            || rec->original_title >= header->strings_size
+            || rec->split > header->split_count
+            || rec->split_count > header->split_count - rec->split)
+         goto end;
+
+      playlist_get_index(explore->playlists[rec->playlist],
+            rec->index, &e.playlist_entry);
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      {
+         if (rec->by[cat] > header->string_count[cat])
+            goto end;
+         e.by[cat] = rec->by[cat]
+            ? explore->by[cat][rec->by[cat] - 1] : NULL;
+      }
+
+      e.split = NULL;
+      if (rec->split_count)
+      {
+         uint32_t j;
+         e.split = (explore_string_t **)ex_arena_alloc(&explore->arena,
+               (rec->split_count + 1) * sizeof(*e.split));
+         for (j = 0; j != rec->split_count; j++)
+         {
+            if (split[rec->split + j] >= string_total)
+               goto end;
+            e.split[j] = all_strings[split[rec->split + j]];
+         }
+         e.split[j] = NULL; /* terminator */
+      }
+
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+      e.original_title = NULL;
+      if (rec->original_title)
+      {
+         size_t _len      = strlen(strings + rec->original_title) + 1;
+         e.original_title = (char*)ex_arena_alloc(&explore->arena, _len);
+         memcpy(e.original_title, strings + rec->original_title, _len);
+      }
+#endif
+
+      RBUF_PUSH(explore->entries, e);
+   }
+
+   ret = true;
+
+end:
+   RBUF_FREE(all_strings);
+   RBUF_FREE(playlist_files);
+   free(buf);
+   return ret;
+}
+
+static const char *explore_find_index_label(void *userdata,
+      size_t idx, char *s, size_t len)
+{
+   explore_state_t *explore = (explore_state_t*)userdata;
+   return explore->entries[idx].playlist_entry->label;
+}
+
+/* Indexes entry labels along with the rest of the
+ * view, so that searching doesn't have to scan them */
+static explore_state_t *explore_build_find_index(explore_state_t *explore)
+{
+   explore->find_index = menu_search_index_new(
+         RBUF_LEN(explore->entries), explore_find_index_label, explore);
+   return explore;
+}
+
+static explore_state_t *explore_build_list(
+      const char *directory_playlist, const char *directory_database)
 {
    unsigned i;
    char tmp[PATH_MAX_LENGTH];
+   char cache_path[PATH_MAX_LENGTH];
    struct explore_rdb
    {
       libretrodb_t *handle;
@@ -415,8 +940,10 @@ static explore_state_t *explore_build_list(settings_t *settings)
    int *rdb_indices                               = NULL;
    explore_string_t **cat_maps[EXPLORE_CAT_COUNT] = {NULL};
    explore_string_t **split_buf                   = NULL;
-   const char *directory_playlist                 = settings->paths.directory_playlist;
-   const char *directory_database                 = settings->paths.path_content_database;
+   char *strings_buf                              = NULL;
+   size_t strings_cap                             = 0;
+   explore_file_t *playlist_files                 = NULL;
+   explore_file_t *rdb_files                      = NULL;
    libretro_vfs_implementation_dir *dir           = NULL;
 
    explore_state_t *explore                       = (explore_state_t*)calloc(
@@ -427,6 +954,21 @@ static explore_state_t *explore_build_list(settings_t *settings)
 
    explore->label_explore_item_str    = 
       msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
+   explore->top_depth                 = EXPLORE_TOP_DEPTH_NONE;
+
+   fill_pathname_join(cache_path, directory_playlist,
+         FILE_PATH_EXPLORE_CACHE, sizeof(cache_path));
+
+   if (explore_cache_load(explore, cache_path,
+            directory_playlist, directory_database))
+      return explore_build_find_index(explore);
+
+   /* Start over from scratch with whatever the cache left */
+   explore_free(explore);
+   memset(explore, 0, sizeof(*explore));
+   explore->label_explore_item_str    = 
+      msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
+   explore->top_depth                 = EXPLORE_TOP_DEPTH_NONE;
 
    /* Index all playlists */
    for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
@@ -462,6 +1004,9 @@ static explore_state_t *explore_build_list(settings_t *settings)
       fill_pathname_join(playlist_config.path,
             directory_playlist, fname, sizeof(playlist_config.path));
       playlist_config.capacity          = COLLECTION_SIZE;
+      /* Taken before reading, so a change made meanwhile
+       * leaves the cache outdated rather than wrong */
+      explore_file_push(&playlist_files, playlist_config.path, fname, 0);
       playlist                          = playlist_init(&playlist_config);
 
       fhash = ex_hash32_nocase_filtered(
@@ -516,6 +1061,8 @@ static explore_state_t *explore_build_list(settings_t *settings)
                   tmp, directory_database, db_name, sizeof(tmp));
             strlcat(tmp, ".rdb", sizeof(tmp));
 
+            explore_file_push(&rdb_files, tmp, tmp, 0);
+
             if (libretrodb_open(tmp, newrdb.handle) != 0)
             {
                /* Invalid RDB file */
@@ -547,6 +1094,10 @@ static explore_state_t *explore_build_list(settings_t *settings)
          used_entries++;
       }
 
+      if (used_entries)
+         playlist_files[RBUF_LEN(playlist_files) - 1].entries =
+            (uint32_t)playlist_size(playlist);
+
       if (used_entries)
          RBUF_PUSH(explore->playlists, playlist);
       else
@@ -557,19 +1108,23 @@ static explore_state_t *explore_build_list(settings_t *settings)
     * and load meta data strings */
    for (i = 0; i != RBUF_LEN(rdbs); i++)
    {
-      struct rmsgpack_dom_value item;
+      const uint8_t *item;
+      size_t item_len;
       struct explore_rdb* rdb  = &rdbs[i];
       libretrodb_cursor_t *cur = libretrodb_cursor_new();
       bool more                = 
          (
           libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
-          && libretrodb_cursor_read_item(cur, &item) == 0);
+          && libretrodb_cursor_read_item_view(cur, &item, &item_len) == 0);
 
-      for (; more; more = (rmsgpack_dom_value_free(&item),
-               libretrodb_cursor_read_item(cur, &item) == 0))
+      /* Entries stay encoded, only the crc and name are looked
+       * at until one matches a playlist entry */
+      for (; more; more = (libretrodb_cursor_read_item_view(
+                  cur, &item, &item_len) == 0))
       {
-         unsigned k, l, cat;
+         unsigned l, cat;
          explore_entry_t e;
+         struct rmsgpack_dom_value val;
          char *fields[EXPLORE_CAT_COUNT];
          char numeric_buf[EXPLORE_CAT_COUNT][16];
          const struct playlist_entry *entry = NULL;
@@ -578,74 +1133,40 @@ static explore_state_t *explore_build_list(settings_t *settings)
 #ifdef EXPLORE_SHOW_ORIGINAL_TITLE
          char *original_title               = NULL;
 #endif
+         char *strings;
 
-         if (item.type != RDT_MAP)
-            continue;
-
-         for (k = 0; k < EXPLORE_CAT_COUNT; k++)
-            fields[k]                       = NULL;
-
-         for (k = 0; k < item.val.map.len; k++)
+         /* The strings of an entry and their terminators
+          * always fit in the size of its encoding */
+         if (item_len + 1 > strings_cap)
          {
-            const char *key_str             = NULL;
-            struct rmsgpack_dom_value *key  = &item.val.map.items[k].key;
-            struct rmsgpack_dom_value *val  = &item.val.map.items[k].value;
-            if (!key || !val || key->type != RDT_STRING)
-               continue;
-
-            key_str                         = key->val.string.buff;
-            if (string_is_equal(key_str, "crc"))
-            {
-               switch (strlen(val->val.binary.buff))
-               {
-                  case 1:
-                     crc32 = *(uint8_t*)val->val.binary.buff;
-                     break;
-                  case 2:
-                     crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
-                     break;
-                  case 4:
-                     crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
-                     break;
-                  default:
-                     crc32 = 0;
-                     break;
-               }
-
-               continue;
-            }
-            else if (string_is_equal(key_str, "name"))
-            {
-               name = val->val.string.buff;
+            char *new_strings = (char*)realloc(strings_buf, item_len + 1);
+            if (!new_strings)
                continue;
-            }
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-            else if (string_is_equal(key_str, "original_title"))
-            {
-               original_title = val->val.string.buff;
-               continue;
-            }
-#endif
+            strings_buf = new_strings;
+            strings_cap = item_len + 1;
+         }
+         strings = strings_buf;
 
-            for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         if (     rmsgpack_dom_view_map_value(item, item_len, "crc", &val) == 0
+               && val.type == RDT_BINARY)
+         {
+            const uint8_t *crc_buf = (const uint8_t*)val.val.binary.buff;
+            switch (val.val.binary.len)
             {
-               if (!string_is_equal(key_str, explore_by_info[cat].rdbkey))
-                  continue;
-
-               if (explore_by_info[cat].is_numeric)
-               {
-                  if (!val->val.int_)
-                     break;
-                  snprintf(numeric_buf[cat],
-                        sizeof(numeric_buf[cat]),
-                        "%d", (int)val->val.int_);
-                  fields[cat] = numeric_buf[cat];
+               case 1:
+                  crc32 = crc_buf[0];
                   break;
-               }
-               if (val->type != RDT_STRING)
+               case 2:
+                  crc32 = ((uint32_t)crc_buf[0] << 8) | crc_buf[1];
+                  break;
+               case 4:
+                  crc32 = ((uint32_t)crc_buf[0] << 24)
+                        | ((uint32_t)crc_buf[1] << 16)
+                        | ((uint32_t)crc_buf[2] << 8)
+                        |  (uint32_t)crc_buf[3];
+                  break;
+               default:
                   break;
-               fields[cat] = val->val.string.buff;
-               break;
             }
          }
 
@@ -653,13 +1174,43 @@ static explore_state_t *explore_build_list(settings_t *settings)
          {
             entry = RHMAP_GET(rdb->playlist_crcs, crc32);
          }
-         if (!entry && name)
+         if (!entry && (name = explore_view_string(item, item_len,
+                     "name", &strings)))
          {
             entry = RHMAP_GET_STR(rdb->playlist_names, name);
          }
          if (!entry)
             continue;
 
+         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         {
+            fields[cat] = NULL;
+
+            if (cat == EXPLORE_BY_SYSTEM)
+               continue;
+
+            if (explore_by_info[cat].is_numeric)
+            {
+               if (rmsgpack_dom_view_map_value(item, item_len,
+                        explore_by_info[cat].rdbkey, &val) != 0
+                     || !val.val.int_)
+                  continue;
+               snprintf(numeric_buf[cat],
+                     sizeof(numeric_buf[cat]),
+                     "%d", (int)val.val.int_);
+               fields[cat] = numeric_buf[cat];
+               continue;
+            }
+
+            fields[cat] = explore_view_string(item, item_len,
+                  explore_by_info[cat].rdbkey, &strings);
+         }
+
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+         original_title = explore_view_string(item, item_len,
+               "original_title", &strings);
+#endif
+
          e.playlist_entry  = entry;
          for (l = 0; l < EXPLORE_CAT_COUNT; l++)
             e.by[l]        = NULL;
@@ -703,10 +1254,7 @@ static explore_state_t *explore_build_list(settings_t *settings)
 
          /* if all entries have found connections, we can leave early */
          if (--rdb->count == 0)
-         {
-            rmsgpack_dom_value_free(&item);
             break;
-         }
       }
 
       libretrodb_cursor_close(cur);
@@ -717,6 +1265,7 @@ static explore_state_t *explore_build_list(settings_t *settings)
       RHMAP_FREE(rdb->playlist_names);
    }
    RBUF_FREE(split_buf);
+   free(strings_buf);
    RHMAP_FREE(rdb_indices);
    RBUF_FREE(rdbs);
 
@@ -737,7 +1286,88 @@ static explore_state_t *explore_build_list(settings_t *settings)
    qsort(explore->entries,
          RBUF_LEN(explore->entries),
          sizeof(*explore->entries), explore_qsort_func_entries);
-   return explore;
+
+   explore_cache_save(explore, cache_path, directory_database,
+         playlist_files, rdb_files);
+   explore_files_free(playlist_files);
+   explore_files_free(rdb_files);
+   return explore_build_find_index(explore);
+}
+
+typedef struct
+{
+   char directory_playlist[PATH_MAX_LENGTH];
+   char directory_database[PATH_MAX_LENGTH];
+} explore_build_task_t;
+
+static void explore_build_task_handler(retro_task_t *task)
+{
+   explore_build_task_t *build = (explore_build_task_t*)task->state;
+
+   task_set_data(task, explore_build_list(
+            build->directory_playlist, build->directory_database));
+   free(build);
+   task->state = NULL;
+   task_set_finished(task, true);
+}
+
+static void explore_build_task_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   explore_state_t *state = (explore_state_t*)task_data;
+
+   explore_build_pending  = false;
+
+   if (!state)
+      return;
+
+   /* The menu did not wait and built its own */
+   if (explore_state)
+   {
+      explore_free(state);
+      free(state);
+      return;
+   }
+
+   explore_state = state;
+}
+
+static bool explore_build_in_progress(void *data)
+{
+   return explore_build_pending;
+}
+
+/* Loads or builds the explore state on the task queue,
+ * so the first visit of the explore view doesn't have to */
+static void explore_push_build_task(settings_t *settings)
+{
+   retro_task_t *task           = NULL;
+   explore_build_task_t *build  = NULL;
+
+   if (explore_state || explore_build_pending)
+      return;
+
+   if (!(build = (explore_build_task_t*)malloc(sizeof(*build))))
+      return;
+
+   if (!(task = task_init()))
+   {
+      free(build);
+      return;
+   }
+
+   strlcpy(build->directory_playlist, settings->paths.directory_playlist,
+         sizeof(build->directory_playlist));
+   strlcpy(build->directory_database, settings->paths.path_content_database,
+         sizeof(build->directory_database));
+
+   task->handler         = explore_build_task_handler;
+   task->callback        = explore_build_task_cb;
+   task->state           = build;
+   task->mute            = true;
+
+   explore_build_pending = true;
+   task_queue_push(task);
 }
 
 static int explore_action_get_title(
@@ -844,7 +1474,21 @@ unsigned menu_displaylist_explore(file_list_t *list,
 
    if (!explore_state)
    {
-      explore_state             = explore_build_list(settings);
+      /* Rather than building it twice, wait for
+       * the build started in the background */
+      if (explore_build_pending)
+      {
+         task_queue_wait(explore_build_in_progress, NULL);
+         task_queue_check();
+      }
+      if (!explore_state)
+         explore_state          = explore_build_list(
+               settings->paths.directory_playlist,
+               settings->paths.path_content_database);
+   }
+
+   if (explore_state->top_depth == EXPLORE_TOP_DEPTH_NONE)
+   {
       explore_state->top_depth  = (unsigned)menu_stack->size - 1;
       explore_load_icons(explore_state);
    }
@@ -1008,6 +1652,9 @@ SKIP_EXPLORE_BY_CATEGORY:;
       explore_entry_t *e                  = NULL;
       explore_entry_t *e_end              = NULL;
       bool* map_filtered_category         = NULL;
+      const uint32_t *find_matches        = NULL;
+      size_t num_find_matches             = 0;
+      size_t find_pos                     = 0;
       unsigned levels                     = 0;
       bool use_find                       = (
             *explore_state->find_string != '\0');
@@ -1072,9 +1719,31 @@ SKIP_EXPLORE_BY_CATEGORY:;
       e                             = explore_state->entries;
       e_end                         = RBUF_END(explore_state->entries);
 
-      for (; e != e_end; e++)
+      /* Only visit the entries matching the search string */
+      if (use_find && explore_state->find_index)
+      {
+         const char *find_terms[1];
+         find_terms[0] = explore_state->find_string;
+         if (menu_search_index_find(explore_state->find_index,
+                  find_terms, 1, &find_matches, &num_find_matches))
+            use_find   = false;
+         else
+            find_matches = NULL;
+      }
+
+      for (find_pos = 0; ; find_pos++, e++)
       {
          unsigned lvl;
+
+         if (find_matches)
+         {
+            if (find_pos == num_find_matches)
+               break;
+            e = explore_state->entries + find_matches[find_pos];
+         }
+         else if (e == e_end)
+            break;
+
          for (lvl = 0; lvl != levels; lvl++)
          {
             if (filter[lvl] == e->by[cats[lvl]])
@@ -1209,8 +1878,17 @@ uintptr_t menu_explore_get_entry_icon(unsigned type)
 
 void menu_explore_context_init(void)
 {
+   settings_t *settings = config_get_ptr();
+
    if (!explore_state)
+   {
+      /* When launched straight into content, the view
+       * is built the first time the menu shows it */
+      if (     settings->bools.menu_content_show_explore
+            && path_is_empty(RARCH_PATH_CONTENT))
+         explore_push_build_task(settings);
       return;
+   }
 
    explore_load_icons(explore_state);
 }
@@ -0,0 +1,366 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2021 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+
+#include "menu_search_index.h"
+
+/* Trigrams are hashed into a fixed number of buckets;
+ * collisions only add candidates, which are compared
+ * with the search terms anyway */
+#define MENU_SEARCH_INDEX_BUCKET_BITS 14
+#define MENU_SEARCH_INDEX_BUCKETS     (1 << MENU_SEARCH_INDEX_BUCKET_BITS)
+
+struct menu_search_index
+{
+   char *labels;          /* lower case labels, NUL terminated */
+   uint32_t *offsets;     /* offset of each label in 'labels' */
+   uint32_t *buckets;     /* start of each bucket in 'postings' */
+   uint32_t *postings;    /* ascending entries of each bucket */
+   uint32_t *matches;     /* matches of the previous query */
+   uint32_t *scratch;
+   char *prev_terms;      /* terms of the previous query */
+   size_t count;
+   size_t num_matches;
+   size_t num_prev_terms;
+};
+
+static INLINE char menu_search_index_lower(char c)
+{
+   return ((c >= 'A') && (c <= 'Z')) ? (char)(c + ('a' - 'A')) : c;
+}
+
+static INLINE uint32_t menu_search_index_bucket(const char *s)
+{
+   uint32_t trigram = ((uint32_t)(unsigned char)s[0] << 16) |
+                      ((uint32_t)(unsigned char)s[1] <<  8) |
+                       (uint32_t)(unsigned char)s[2];
+   return (trigram * 2654435761u) >> (32 - MENU_SEARCH_INDEX_BUCKET_BITS);
+}
+
+menu_search_index_t *menu_search_index_new(size_t count,
+      menu_search_index_label_t get_label, void *userdata)
+{
+   size_t i;
+   size_t labels_size          = 0;
+   size_t labels_capacity      = 0;
+   uint32_t *last              = NULL;
+   uint32_t *cursor            = NULL;
+   menu_search_index_t *index  = NULL;
+
+   if (!get_label || (count >= UINT32_MAX))
+      return NULL;
+
+   if (!(index = (menu_search_index_t*)calloc(1, sizeof(*index))))
+      return NULL;
+
+   index->count    = count;
+   index->offsets  = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+   index->matches  = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+   index->scratch  = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+   index->buckets  = (uint32_t*)calloc(MENU_SEARCH_INDEX_BUCKETS + 1,
+         sizeof(uint32_t));
+   last            = (uint32_t*)calloc(MENU_SEARCH_INDEX_BUCKETS,
+         sizeof(uint32_t));
+   cursor          = (uint32_t*)malloc(MENU_SEARCH_INDEX_BUCKETS *
+         sizeof(uint32_t));
+
+   if (     !index->offsets
+         || !index->matches
+         || !index->scratch
+         || !index->buckets
+         || !last
+         || !cursor)
+      goto error;
+
+   /* Copy labels, in lower case */
+   for (i = 0; i < count; i++)
+   {
+      char buf[PATH_MAX_LENGTH];
+      const char *label = get_label(userdata, i, buf, sizeof(buf));
+      size_t len        = label ? strlen(label) : 0;
+      size_t j;
+
+      if (labels_size + len + 1 > labels_capacity)
+      {
+         size_t new_capacity = labels_capacity ? labels_capacity * 2 : 4096;
+         char *labels;
+
+         while (new_capacity < labels_size + len + 1)
+            new_capacity *= 2;
+
+         if (new_capacity >= UINT32_MAX)
+            goto error;
+         if (!(labels = (char*)realloc(index->labels, new_capacity)))
+            goto error;
+         index->labels   = labels;
+         labels_capacity = new_capacity;
+      }
+
+      index->offsets[i] = (uint32_t)labels_size;
+      for (j = 0; j < len; j++)
+         index->labels[labels_size + j] = menu_search_index_lower(label[j]);
+      index->labels[labels_size + len] = '\0';
+      labels_size      += len + 1;
+   }
+
+   /* Count the entries of each bucket
+    * > 'last' holds the last entry (plus one) added to a
+    *   bucket, so that repeated trigrams count once */
+   for (i = 0; i < count; i++)
+   {
+      const char *s = index->labels + index->offsets[i];
+
+      for (; s[0] && s[1] && s[2]; s++)
+      {
+         uint32_t b = menu_search_index_bucket(s);
+
+         if (last[b] == (uint32_t)i + 1)
+            continue;
+         last[b] = (uint32_t)i + 1;
+         index->buckets[b + 1]++;
+      }
+   }
+
+   for (i = 0; i < MENU_SEARCH_INDEX_BUCKETS; i++)
+   {
+      index->buckets[i + 1] += index->buckets[i];
+      cursor[i]              = index->buckets[i];
+      last[i]                = 0;
+   }
+
+   if (!(index->postings = (uint32_t*)malloc(
+               (index->buckets[MENU_SEARCH_INDEX_BUCKETS] + 1) *
+               sizeof(uint32_t))))
+      goto error;
+
+   /* Fill buckets, which leaves them sorted */
+   for (i = 0; i < count; i++)
+   {
+      const char *s = index->labels + index->offsets[i];
+
+      for (; s[0] && s[1] && s[2]; s++)
+      {
+         uint32_t b = menu_search_index_bucket(s);
+
+         if (last[b] == (uint32_t)i + 1)
+            continue;
+         last[b]                        = (uint32_t)i + 1;
+         index->postings[cursor[b]++]   = (uint32_t)i;
+      }
+   }
+
+   free(last);
+   free(cursor);
+   return index;
+
+error:
+   free(last);
+   free(cursor);
+   menu_search_index_free(index);
+   return NULL;
+}
+
+void menu_search_index_free(menu_search_index_t *index)
+{
+   if (!index)
+      return;
+
+   free(index->labels);
+   free(index->offsets);
+   free(index->buckets);
+   free(index->postings);
+   free(index->matches);
+   free(index->scratch);
+   free(index->prev_terms);
+   free(index);
+}
+
+/* Returns true if every term of the previous query is
+ * part of one of 'terms' - anything matching 'terms'
+ * then matched the previous query as well */
+static bool menu_search_index_refines(const menu_search_index_t *index,
+      char **terms, size_t num_terms)
+{
+   size_t i;
+   const char *prev = index->prev_terms;
+
+   if (!prev)
+      return false;
+
+   for (i = 0; i < index->num_prev_terms; i++)
+   {
+      size_t j;
+
+      for (j = 0; j < num_terms; j++)
+         if (strstr(terms[j], prev))
+            break;
+
+      if (j == num_terms)
+         return false;
+
+      prev += strlen(prev) + 1;
+   }
+
+   return true;
+}
+
+bool menu_search_index_find(menu_search_index_t *index,
+      const char * const *terms, size_t num_terms,
+      const uint32_t **matches, size_t *num_matches)
+{
+   size_t i;
+   char **lower         = NULL;
+   char *prev_terms     = NULL;
+   const uint32_t *cand = NULL;
+   size_t num_lower     = 0;
+   size_t terms_size    = 0;
+   size_t num_cand      = 0;
+   size_t found         = 0;
+
+   if (!index || !matches || !num_matches)
+      return false;
+
+   if (num_terms && !(lower = (char**)malloc(num_terms * sizeof(char*))))
+      goto error;
+
+   /* Search terms, in lower case */
+   for (i = 0; i < num_terms; i++)
+   {
+      size_t j, len;
+
+      if (!terms[i] || !*terms[i])
+         continue;
+
+      len = strlen(terms[i]);
+      if (!(lower[num_lower] = (char*)malloc(len + 1)))
+         goto error;
+      for (j = 0; j <= len; j++)
+         lower[num_lower][j] = menu_search_index_lower(terms[i][j]);
+
+      terms_size += len + 1;
+      num_lower++;
+   }
+
+   /* Without terms, everything matches */
+   if (!num_lower)
+   {
+      for (i = 0; i < index->count; i++)
+         index->matches[i] = (uint32_t)i;
+      index->num_matches = index->count;
+      free(index->prev_terms);
+      index->prev_terms  = NULL;
+      free(lower);
+
+      *matches           = index->matches;
+      *num_matches       = index->num_matches;
+      return true;
+   }
+
+   /* Pick the smallest candidate set: the shortest
+    * bucket of any trigram, or the previous matches */
+   num_cand = index->count;
+
+   for (i = 0; i < num_lower; i++)
+   {
+      const char *s = lower[i];
+
+      for (; s[0] && s[1] && s[2]; s++)
+      {
+         uint32_t b    = menu_search_index_bucket(s);
+         size_t size   = index->buckets[b + 1] - index->buckets[b];
+
+         if (size < num_cand || !cand)
+         {
+            cand     = index->postings + index->buckets[b];
+            num_cand = size;
+         }
+      }
+   }
+
+   if (     (index->num_matches < num_cand || !cand)
+         && menu_search_index_refines(index, lower, num_lower))
+   {
+      cand     = index->matches;
+      num_cand = index->num_matches;
+   }
+
+   /* Compare candidates with the terms */
+   for (i = 0; i < num_cand; i++)
+   {
+      size_t j;
+      uint32_t entry    = cand ? cand[i] : (uint32_t)i;
+      const char *label = index->labels + index->offsets[entry];
+
+      for (j = 0; j < num_lower; j++)
+         if (!strstr(label, lower[j]))
+            break;
+
+      if (j == num_lower)
+         index->scratch[found++] = entry;
+   }
+
+   /* Keep the matches for the next query */
+   {
+      uint32_t *tmp      = index->matches;
+      index->matches     = index->scratch;
+      index->scratch     = tmp;
+      index->num_matches = found;
+   }
+
+   free(index->prev_terms);
+   index->prev_terms     = NULL;
+   index->num_prev_terms = 0;
+
+   if ((prev_terms = (char*)malloc(terms_size)))
+   {
+      char *s = prev_terms;
+
+      for (i = 0; i < num_lower; i++)
+      {
+         size_t len = strlen(lower[i]);
+         memcpy(s, lower[i], len + 1);
+         s += len + 1;
+      }
+
+      index->prev_terms     = prev_terms;
+      index->num_prev_terms = num_lower;
+   }
+
+   for (i = 0; i < num_lower; i++)
+      free(lower[i]);
+   free(lower);
+
+   *matches     = index->matches;
+   *num_matches = index->num_matches;
+   return true;
+
+error:
+   if (lower)
+   {
+      for (i = 0; i < num_lower; i++)
+         free(lower[i]);
+      free(lower);
+   }
+   /* Matches are unknown now */
+   free(index->prev_terms);
+   index->prev_terms  = NULL;
+   index->num_matches = 0;
+   return false;
+}
@@ -0,0 +1,65 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2021 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MENU_SEARCH_INDEX_H
+#define _MENU_SEARCH_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Trigram index over a fixed set of labels, answering
+ * the same case insensitive substring queries as
+ * strcasestr() without scanning every label.
+ * > Each trigram of a search term maps to the list of
+ *   labels containing it; only the labels of the
+ *   shortest such list are compared with the terms
+ * > The matches of the previous query are kept, so a
+ *   query that refines it (one term typed further,
+ *   or one more term) only checks those */
+
+/* Prevent direct access to menu_search_index_t members */
+typedef struct menu_search_index menu_search_index_t;
+
+/* Returns the label of entry 'idx', which can be
+ * written to 's' if it has to be built */
+typedef const char *(*menu_search_index_label_t)(void *userdata,
+      size_t idx, char *s, size_t len);
+
+/* Builds an index over 'count' labels, read with 'get_label'.
+ * Returned object must be freed using menu_search_index_free().
+ * Returns NULL in the event of an error. */
+menu_search_index_t *menu_search_index_new(size_t count,
+      menu_search_index_label_t get_label, void *userdata);
+
+void menu_search_index_free(menu_search_index_t *index);
+
+/* Finds the entries whose label contains all (non-empty)
+ * 'terms', ignoring case.
+ * > On success, 'matches' is set to the ascending list of
+ *   matching entries, which remains valid until the next
+ *   call of menu_search_index_find() or menu_search_index_free()
+ * Returns false in the event of an error */
+bool menu_search_index_find(menu_search_index_t *index,
+      const char * const *terms, size_t num_terms,
+      const uint32_t **matches, size_t *num_matches);
+
+RETRO_END_DECLS
+
+#endif
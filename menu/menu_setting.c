@@ -86,10 +86,12 @@
 #include "../config.def.h"
 #include "../ui/ui_companion_driver.h"
 #include "../performance_counters.h"
+#include "../memory_tags.h"
 #include "../setting_list.h"
 #include "../lakka.h"
 #include "../retroarch.h"
 #include "../gfx/video_display_server.h"
+#include "../gfx/gfx_thumbnail.h"
 #ifdef HAVE_CHEATS
 #include "../cheat_manager.h"
 #endif
@@ -326,6 +328,22 @@ typedef struct rarch_setting_info
    int size;
 } rarch_setting_info_t;
 
+/* Open-addressed hash tables over the settings list, so that
+ * menu_setting_find() and menu_setting_find_enum() don't walk
+ * several thousand entries for every menu entry they resolve.
+ * Each slot points at the first setting (in list order) of
+ * type <= ST_GROUP with that name/enum, matching the linear
+ * scan. Rebuilt whenever the list pointer changes. */
+typedef struct menu_setting_index
+{
+   rarch_setting_t *list;
+   rarch_setting_t **by_name;
+   rarch_setting_t **by_enum;
+   uint32_t mask;
+} menu_setting_index_t;
+
+static menu_setting_index_t menu_setting_idx;
+
 /* SETTINGS LIST */
 
 static void menu_input_st_uint_cb(void *userdata, const char *str)
@@ -491,7 +509,8 @@ static bool SETTINGS_LIST_APPEND_internal(
 {
    unsigned new_size              = list_info->size * 2;
    rarch_setting_t *list_settings = (rarch_setting_t*)
-      realloc(*list, sizeof(rarch_setting_t) * new_size);
+      memory_tag_realloc(MEMORY_TAG_MENU,
+            *list, sizeof(rarch_setting_t) * new_size);
 
    if (!list_settings)
       return false;
@@ -2967,6 +2986,28 @@ static void setting_get_string_representation_video_record_quality(rarch_setting
    }
 }
 
+static void setting_get_string_representation_screenshot_mode(
+      rarch_setting_t *setting,
+      char *s, size_t len)
+{
+   if (!setting)
+      return;
+
+   /* TODO/FIXME - localize this */
+   switch (*setting->value.target.unsigned_integer)
+   {
+      case SCREENSHOT_MODE_PNG:
+         strlcpy(s, "PNG", len);
+         break;
+      case SCREENSHOT_MODE_PNG_FAST:
+         strlcpy(s, "PNG (Fast)", len);
+         break;
+      case SCREENSHOT_MODE_BMP:
+         strlcpy(s, "BMP", len);
+         break;
+   }
+}
+
 static void setting_get_string_representation_video_filter(rarch_setting_t *setting,
       char *s, size_t len)
 {
@@ -6192,6 +6233,33 @@ static void setting_get_string_representation_uint_analog_dpad_mode(
    strlcpy(s, modes[*setting->value.target.unsigned_integer % ANALOG_DPAD_LAST], len);
 }
 
+static void setting_get_string_representation_uint_trace_duration(
+      rarch_setting_t *setting,
+      char *s, size_t len)
+{
+   if (!setting)
+      return;
+
+   if (*setting->value.target.unsigned_integer)
+      snprintf(s, len, "%u %s",
+            *setting->value.target.unsigned_integer, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_SECONDS));
+   else
+      strlcpy(s, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_TRACE_DURATION_MANUAL), len);
+}
+
+static void setting_get_string_representation_uint_vfs_read_block_size(
+      rarch_setting_t *setting,
+      char *s, size_t len)
+{
+   if (!setting)
+      return;
+
+   if (*setting->value.target.unsigned_integer)
+      snprintf(s, len, "%u KB", *setting->value.target.unsigned_integer);
+   else
+      strlcpy(s, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF), len);
+}
+
 #ifdef HAVE_THREADS
 static void setting_get_string_representation_uint_autosave_interval(
       rarch_setting_t *setting,
@@ -6699,6 +6767,114 @@ int menu_action_handle_setting(rarch_setting_t *setting,
    return -1;
 }
 
+static void menu_setting_index_free(void)
+{
+   if (menu_setting_idx.by_name)
+      memory_tag_free(MEMORY_TAG_MENU, menu_setting_idx.by_name);
+   if (menu_setting_idx.by_enum)
+      memory_tag_free(MEMORY_TAG_MENU, menu_setting_idx.by_enum);
+   menu_setting_idx.list    = NULL;
+   menu_setting_idx.by_name = NULL;
+   menu_setting_idx.by_enum = NULL;
+   menu_setting_idx.mask    = 0;
+}
+
+static uint32_t menu_setting_index_hash_enum(unsigned enum_idx)
+{
+   return (uint32_t)enum_idx * 2654435761u;
+}
+
+static bool menu_setting_index_build(rarch_setting_t *list)
+{
+   rarch_setting_t *setting;
+   size_t count  = 0;
+   uint32_t size = 64;
+
+   menu_setting_index_free();
+
+   for (setting = list; setting->type != ST_NONE; setting++)
+      count++;
+
+   /* Keep the load factor under one half */
+   while (size < count * 2)
+      size <<= 1;
+
+   menu_setting_idx.by_name = (rarch_setting_t**)memory_tag_calloc(
+         MEMORY_TAG_MENU, size, sizeof(*menu_setting_idx.by_name));
+   menu_setting_idx.by_enum = (rarch_setting_t**)memory_tag_calloc(
+         MEMORY_TAG_MENU, size, sizeof(*menu_setting_idx.by_enum));
+
+   if (!menu_setting_idx.by_name || !menu_setting_idx.by_enum)
+   {
+      menu_setting_index_free();
+      return false;
+   }
+
+   menu_setting_idx.list = list;
+   menu_setting_idx.mask = size - 1;
+
+   for (setting = list; setting->type != ST_NONE; setting++)
+   {
+      uint32_t i;
+
+      if (setting->type > ST_GROUP)
+         continue;
+
+      if (!string_is_empty(setting->name))
+      {
+         for (i = msg_hash_calculate(setting->name) & menu_setting_idx.mask;
+               menu_setting_idx.by_name[i];
+               i = (i + 1) & menu_setting_idx.mask)
+            if (string_is_equal(menu_setting_idx.by_name[i]->name,
+                     setting->name))
+               break;
+         if (!menu_setting_idx.by_name[i])
+            menu_setting_idx.by_name[i] = setting;
+      }
+
+      if (setting->enum_idx != 0)
+      {
+         for (i = menu_setting_index_hash_enum(setting->enum_idx)
+               & menu_setting_idx.mask;
+               menu_setting_idx.by_enum[i];
+               i = (i + 1) & menu_setting_idx.mask)
+            if (menu_setting_idx.by_enum[i]->enum_idx == setting->enum_idx)
+               break;
+         if (!menu_setting_idx.by_enum[i])
+            menu_setting_idx.by_enum[i] = setting;
+      }
+   }
+
+   return true;
+}
+
+/* Returns the settings list with its index up to date,
+ * or NULL if there is no list (or no memory for the index) */
+static rarch_setting_t *menu_setting_index_get(void)
+{
+   rarch_setting_t *list = NULL;
+
+   menu_entries_ctl(MENU_ENTRIES_CTL_SETTINGS_GET, &list);
+
+   if (!list)
+      return NULL;
+   if (menu_setting_idx.list != list && !menu_setting_index_build(list))
+      return NULL;
+
+   return list;
+}
+
+static rarch_setting_t *menu_setting_found(rarch_setting_t *setting)
+{
+   if (!setting || string_is_empty(setting->short_description))
+      return NULL;
+
+   if (setting->read_handler)
+      setting->read_handler(setting);
+
+   return setting;
+}
+
 /**
  * menu_setting_find:
  * @settings           : pointer to settings
@@ -6710,66 +6886,32 @@ int menu_action_handle_setting(rarch_setting_t *setting,
  **/
 rarch_setting_t *menu_setting_find(const char *label)
 {
-   rarch_setting_t *setting = NULL;
-   rarch_setting_t **list   = &setting;
+   uint32_t i;
 
-   if (!label)
+   if (!label || !menu_setting_index_get())
       return NULL;
 
-   menu_entries_ctl(MENU_ENTRIES_CTL_SETTINGS_GET, &setting);
-
-   if (!setting)
-      return NULL;
-
-   for (; setting->type != ST_NONE; (*list = *list + 1))
-   {
-      const char *name              = setting->name;
-      const char *short_description = setting->short_description;
-
-      if (
-            string_is_equal(label, name) &&
-            (setting->type <= ST_GROUP))
-      {
-         if (string_is_empty(short_description))
-            break;
-
-         if (setting->read_handler)
-            setting->read_handler(setting);
-
-         return setting;
-      }
-   }
+   for (i = msg_hash_calculate(label) & menu_setting_idx.mask;
+         menu_setting_idx.by_name[i];
+         i = (i + 1) & menu_setting_idx.mask)
+      if (string_is_equal(menu_setting_idx.by_name[i]->name, label))
+         return menu_setting_found(menu_setting_idx.by_name[i]);
 
    return NULL;
 }
 
 rarch_setting_t *menu_setting_find_enum(enum msg_hash_enums enum_idx)
 {
-   rarch_setting_t *setting = NULL;
-   rarch_setting_t **list   = &setting;
+   uint32_t i;
 
-   if (enum_idx == 0)
+   if (enum_idx == 0 || !menu_setting_index_get())
       return NULL;
 
-   menu_entries_ctl(MENU_ENTRIES_CTL_SETTINGS_GET, &setting);
-
-   if (!setting)
-      return NULL;
-   for (; setting->type != ST_NONE; (*list = *list + 1))
-   {
-      if (  setting->enum_idx == enum_idx &&
-            setting->type <= ST_GROUP)
-      {
-         const char *short_description = setting->short_description;
-         if (string_is_empty(short_description))
-            return NULL;
-
-         if (setting->read_handler)
-            setting->read_handler(setting);
-
-         return setting;
-      }
-   }
+   for (i = menu_setting_index_hash_enum(enum_idx) & menu_setting_idx.mask;
+         menu_setting_idx.by_enum[i];
+         i = (i + 1) & menu_setting_idx.mask)
+      if (menu_setting_idx.by_enum[i]->enum_idx == enum_idx)
+         return menu_setting_found(menu_setting_idx.by_enum[i]);
 
    return NULL;
 }
@@ -7228,10 +7370,12 @@ static void write_handler_logging_verbosity(rarch_setting_t *setting)
             settings->bools.log_to_file_timestamp,
             settings->paths.log_dir);
       verbosity_enable();
+      verbosity_set_async(settings->bools.log_async);
    }
    else
    {
       verbosity_disable();
+      verbosity_set_async(false);
       rarch_log_file_deinit();
    }
    retroarch_override_setting_unset(RARCH_OVERRIDE_SETTING_VERBOSITY, NULL);
@@ -7451,6 +7595,10 @@ static void general_write_handler(rarch_setting_t *setting)
          }
          retroarch_override_setting_unset(RARCH_OVERRIDE_SETTING_LOG_TO_FILE, NULL);
          break;
+      case MENU_ENUM_LABEL_LOG_ASYNC:
+         if (verbosity_is_enabled())
+            verbosity_set_async(config_get_ptr()->bools.log_async);
+         break;
       case MENU_ENUM_LABEL_LOG_DIR:
       case MENU_ENUM_LABEL_LOG_TO_FILE_TIMESTAMP:
          if (verbosity_is_enabled() && is_logging_to_file())
@@ -7621,11 +7769,18 @@ static void general_write_handler(rarch_setting_t *setting)
          }
          break;
       case MENU_ENUM_LABEL_SUSTAINED_PERFORMANCE_MODE:
+      case MENU_ENUM_LABEL_POWER_SAVING_MODE:
          {
             settings_t *settings       = config_get_ptr();
-            frontend_driver_set_sustained_performance_mode(settings->bools.sustained_performance_mode);
+            frontend_driver_set_sustained_performance_mode(
+                  settings->bools.sustained_performance_mode ||
+                  settings->bools.power_saving_mode);
          }
          break;
+      case MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE:
+         gfx_thumbnail_set_cache_budget(
+               (size_t)*setting->value.target.unsigned_integer * 1024 * 1024);
+         break;
       case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
          {
             rarch_setting_t *buffer_size_setting = menu_setting_find_enum(MENU_ENUM_LABEL_REWIND_BUFFER_SIZE);
@@ -7819,6 +7974,9 @@ static void general_write_handler(rarch_setting_t *setting)
                      path_libretro_info : dir_libretro);
          }
          break;
+      case MENU_ENUM_LABEL_VFS_READ_BLOCK_SIZE:
+         retroarch_set_vfs_read_cache(*setting->value.target.unsigned_integer);
+         break;
       default:
          break;
    }
@@ -9418,6 +9576,23 @@ static bool setting_append_list(
                      bool_entries[i].flags);
             }
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.vfs_read_block_size,
+                  MENU_ENUM_LABEL_VFS_READ_BLOCK_SIZE,
+                  MENU_ENUM_LABEL_VALUE_VFS_READ_BLOCK_SIZE,
+                  DEFAULT_VFS_READ_BLOCK_SIZE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            (*list)[list_info->index - 1].get_string_representation =
+               &setting_get_string_representation_uint_vfs_read_block_size;
+            menu_settings_list_current_add_range(list, list_info, 0, 4096, 64, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
             END_SUB_GROUP(list, list_info, parent_group);
             END_GROUP(list, list_info, parent_group);
          }
@@ -9625,6 +9800,21 @@ static bool setting_append_list(
                   general_read_handler,
                   SD_FLAG_NONE);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.log_async,
+                  MENU_ENUM_LABEL_LOG_ASYNC,
+                  MENU_ENUM_LABEL_VALUE_LOG_ASYNC,
+                  DEFAULT_LOG_ASYNC,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
             END_SUB_GROUP(list, list_info, parent_group);
 
             START_SUB_GROUP(list, list_info, "Performance Counters", &group_info, &subgroup_info,
@@ -9646,6 +9836,23 @@ static bool setting_append_list(
                   general_write_handler,
                   general_read_handler,
                   SD_FLAG_ADVANCED);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.trace_duration,
+                  MENU_ENUM_LABEL_TRACE_DURATION,
+                  MENU_ENUM_LABEL_VALUE_TRACE_DURATION,
+                  DEFAULT_TRACE_DURATION,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            (*list)[list_info->index - 1].get_string_representation =
+               &setting_get_string_representation_uint_trace_duration;
+            menu_settings_list_current_add_range(list, list_info, 0, 60, 1, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
          }
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
@@ -9886,6 +10093,22 @@ static bool setting_append_list(
                   general_read_handler,
                   SD_FLAG_NONE);
 
+#ifdef HAVE_THREADS
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.scan_threads,
+                  MENU_ENUM_LABEL_SCAN_THREADS,
+                  MENU_ENUM_LABEL_VALUE_SCAN_THREADS,
+                  DEFAULT_SCAN_THREADS,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 1, 16, 1, true, true);
+#endif
+
             END_SUB_GROUP(list, list_info, parent_group);
             END_GROUP(list, list_info, parent_group);
          }
@@ -11449,6 +11672,22 @@ static bool setting_append_list(
             menu_settings_list_current_add_range(list, list_info, 0, 15, 1, true, true);
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_frame_delay_auto,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO,
+                  DEFAULT_FRAME_DELAY_AUTO,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_LAKKA_ADVANCED
+                  );
+
             /* Unlike all other shader-related menu entries
              * (which appear in the shaders quick menu, and
              * are thus hidden automatically on platforms
@@ -11508,6 +11747,24 @@ static bool setting_append_list(
                   SD_FLAG_NONE
                   );
 
+#ifdef HAVE_SLANG
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_shader_fp16_framebuffers,
+                  MENU_ENUM_LABEL_VIDEO_SHADER_FP16_FRAMEBUFFERS,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_FP16_FRAMEBUFFERS,
+                  DEFAULT_VIDEO_SHADER_FP16_FRAMEBUFFERS,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED
+                  );
+#endif
+
 #if !defined(RARCH_MOBILE)
             if (video_driver_test_all_flags(GFX_CTX_FLAGS_BLACK_FRAME_INSERTION))
             {
@@ -11536,6 +11793,23 @@ static bool setting_append_list(
                   &subgroup_info,
                   parent_group);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_frame_dupe_detect,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_DUPE_DETECT,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DUPE_DETECT,
+                  DEFAULT_VIDEO_FRAME_DUPE_DETECT,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE
+                  );
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.video_gpu_screenshot,
@@ -11553,6 +11827,24 @@ static bool setting_append_list(
                   );
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.screenshot_mode,
+                  MENU_ENUM_LABEL_SCREENSHOT_MODE,
+                  MENU_ENUM_LABEL_VALUE_SCREENSHOT_MODE,
+                  DEFAULT_SCREENSHOT_MODE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            (*list)[list_info->index - 1].get_string_representation =
+                  &setting_get_string_representation_screenshot_mode;
+            menu_settings_list_current_add_range(list, list_info, 0, SCREENSHOT_MODE_LAST - 1, 1, true, true);
+            (*list)[list_info->index - 1].ui_type   = ST_UI_TYPE_UINT_COMBOBOX;
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.video_crop_overscan,
@@ -11916,6 +12208,26 @@ static bool setting_append_list(
                );
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+#ifdef HAVE_THREADS
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_threaded_processing,
+               MENU_ENUM_LABEL_AUDIO_THREADED_PROCESSING,
+               MENU_ENUM_LABEL_VALUE_AUDIO_THREADED_PROCESSING,
+               DEFAULT_AUDIO_THREADED_PROCESSING,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_CMD_APPLY_AUTO
+               );
+         MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_AUDIO_REINIT);
+         SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+#endif
+
          CONFIG_UINT(
                list, list_info,
                &settings->uints.audio_latency,
@@ -11971,6 +12283,41 @@ static bool setting_append_list(
                false);
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_rate_control_pi,
+               MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_PI,
+               MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_PI,
+               DEFAULT_RATE_CONTROL_PI,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_CMD_APPLY_AUTO
+               );
+         MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_AUDIO_REINIT);
+         SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
+         CONFIG_UINT(
+               list, list_info,
+               &settings->uints.audio_rate_control_target,
+               MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_TARGET,
+               MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_TARGET,
+               DEFAULT_RATE_CONTROL_TARGET,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler);
+         (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+         menu_settings_list_current_add_range(list, list_info, 10, 90, 5, true, true);
+         MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_AUDIO_REINIT);
+         SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info,
+               SD_FLAG_CMD_APPLY_AUTO | SD_FLAG_ADVANCED);
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.audio_max_timing_skew,
@@ -13040,6 +13387,22 @@ static bool setting_append_list(
          MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_SET_FRAME_LIMIT);
          menu_settings_list_current_add_range(list, list_info, 0, 10, 1.0, true, true);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.fastforward_frameskip,
+               MENU_ENUM_LABEL_FASTFORWARD_FRAMESKIP,
+               MENU_ENUM_LABEL_VALUE_FASTFORWARD_FRAMESKIP,
+               DEFAULT_FASTFORWARD_FRAMESKIP,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.vrr_runloop_enable,
@@ -13140,6 +13503,15 @@ static bool setting_append_list(
                SD_FLAG_ADVANCED
                );
 
+         CONFIG_ACTION(
+               list, list_info,
+               MENU_ENUM_LABEL_RUN_AHEAD_CALIBRATE,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_CALIBRATE,
+               &group_info,
+               &subgroup_info,
+               parent_group);
+         MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_RUNAHEAD_CALIBRATE);
+
 #ifdef ANDROID
          CONFIG_UINT(
             list, list_info,
@@ -13326,6 +13698,23 @@ static bool setting_append_list(
          menu_settings_list_current_add_range(list, list_info, 1.00, 100.00, 1.0, true, true);
          MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_REINIT);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.video_font_sdf_enable,
+               MENU_ENUM_LABEL_VIDEO_FONT_SDF_ENABLE,
+               MENU_ENUM_LABEL_VALUE_VIDEO_FONT_SDF_ENABLE,
+               DEFAULT_FONT_SDF_ENABLE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+         MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_REINIT);
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.video_msg_pos_x,
@@ -14376,6 +14765,22 @@ static bool setting_append_list(
                SD_FLAG_ADVANCED
                );
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.menu_skip_static_frames,
+               MENU_ENUM_LABEL_MENU_SKIP_STATIC_FRAMES,
+               MENU_ENUM_LABEL_VALUE_MENU_SKIP_STATIC_FRAMES,
+               DEFAULT_MENU_SKIP_STATIC_FRAMES,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          CONFIG_UINT(
                list, list_info,
                &settings->uints.quit_on_close_content,
@@ -16106,6 +16511,20 @@ static bool setting_append_list(
                   general_read_handler);
             (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint_special;
             menu_settings_list_current_add_range(list, list_info, 0, 1024, 256, true, true);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.menu_thumbnail_cache_size,
+                  MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+                  MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+                  DEFAULT_MENU_THUMBNAIL_CACHE_SIZE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 512, 8, true, true);
          }
 
          if (string_is_equal(settings->arrays.menu_driver, "rgui"))
@@ -16362,6 +16781,21 @@ static bool setting_append_list(
                SD_FLAG_CMD_APPLY_AUTO);
 #endif
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.power_saving_mode,
+               MENU_ENUM_LABEL_POWER_SAVING_MODE,
+               MENU_ENUM_LABEL_VALUE_POWER_SAVING_MODE,
+               DEFAULT_POWER_SAVING_MODE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_CMD_APPLY_AUTO);
+
 #ifdef HAVE_LAKKA
 #ifndef HAVE_LAKKA_SWITCH
          CONFIG_ACTION(
@@ -18336,6 +18770,38 @@ static bool setting_append_list(
                   SD_FLAG_NONE);
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.netplay_udp_input,
+                  MENU_ENUM_LABEL_NETPLAY_UDP_INPUT,
+                  MENU_ENUM_LABEL_VALUE_NETPLAY_UDP_INPUT,
+                  netplay_udp_input,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.netplay_relay_port,
+                  MENU_ENUM_LABEL_NETPLAY_RELAY_PORT,
+                  MENU_ENUM_LABEL_VALUE_NETPLAY_RELAY_PORT,
+                  netplay_relay_port,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 65535, 1, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ALLOW_INPUT);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
             CONFIG_UINT(
                   list, list_info,
                   &settings->uints.netplay_share_digital,
@@ -18529,6 +18995,21 @@ static bool setting_append_list(
                   general_write_handler,
                   general_read_handler,
                   SD_FLAG_NONE);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.network_thumbnail_downloads,
+                  MENU_ENUM_LABEL_NETWORK_THUMBNAIL_DOWNLOADS,
+                  MENU_ENUM_LABEL_VALUE_NETWORK_THUMBNAIL_DOWNLOADS,
+                  DEFAULT_NETWORK_THUMBNAIL_DOWNLOADS,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 1, 16, 1, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
 #endif
          }
          END_SUB_GROUP(list, list_info, parent_group);
@@ -19672,6 +20153,9 @@ void menu_setting_free(rarch_setting_t *setting)
    if (!setting)
       return;
 
+   if (menu_setting_idx.list == setting)
+      menu_setting_index_free();
+
    list                   = (rarch_setting_t**)&setting;
 
    /* Free data which was previously tagged */
@@ -19811,7 +20295,7 @@ static rarch_setting_t *menu_setting_new_internal(rarch_setting_info_t *list_inf
    const char *root                     = NULL;
    rarch_setting_t **list_ptr           = NULL;
    rarch_setting_t *list                = (rarch_setting_t*)
-      malloc(list_info->size * sizeof(*list));
+      memory_tag_malloc(MEMORY_TAG_MENU, list_info->size * sizeof(*list));
 
    if (!list)
       return NULL;
@@ -19830,7 +20314,7 @@ static rarch_setting_t *menu_setting_new_internal(rarch_setting_info_t *list_inf
                settings, global,
                list_types[i], &list, list_info, root))
       {
-         free(list);
+         memory_tag_free(MEMORY_TAG_MENU, list);
          return NULL;
       }
    }
@@ -19839,7 +20323,7 @@ static rarch_setting_t *menu_setting_new_internal(rarch_setting_info_t *list_inf
 
    if (!SETTINGS_LIST_APPEND(list_ptr, list_info))
    {
-      free(list);
+      memory_tag_free(MEMORY_TAG_MENU, list);
       return NULL;
    }
 
@@ -19847,11 +20331,11 @@ static rarch_setting_t *menu_setting_new_internal(rarch_setting_info_t *list_inf
    list_info->index++;
 
    /* flatten this array to save ourselves some kilobytes. */
-   resized_list = (rarch_setting_t*)realloc(list,
-         list_info->index * sizeof(rarch_setting_t));
+   resized_list = (rarch_setting_t*)memory_tag_realloc(MEMORY_TAG_MENU,
+         list, list_info->index * sizeof(rarch_setting_t));
    if (!resized_list)
    {
-      free(list);
+      memory_tag_free(MEMORY_TAG_MENU, list);
       return NULL;
    }
 
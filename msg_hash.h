@@ -418,6 +418,7 @@ enum msg_hash_enums
    MSG_FAILED_TO_APPLY_SHADER,
    MSG_FAILED_TO_APPLY_SHADER_PRESET,
    MSG_APPLYING_SHADER,
+   MSG_COMPILING_SHADER,
    MSG_SHADER,
    MSG_REDIRECTING_SAVESTATE_TO,
    MSG_REDIRECTING_SAVEFILE_TO,
@@ -471,6 +472,9 @@ enum msg_hash_enums
    MSG_GAME_REMAP_FILE_LOADED,
    MSG_DIRECTORY_REMAP_FILE_LOADED,
    MSG_CORE_REMAP_FILE_LOADED,
+   MSG_TRACE_STARTED,
+   MSG_TRACE_WRITTEN,
+   MSG_TRACE_FAILED,
    MSG_RUNAHEAD_ENABLED,
    MSG_RUNAHEAD_ENABLED_WITH_SECOND_INSTANCE,
    MSG_RUNAHEAD_DISABLED,
@@ -478,6 +482,9 @@ enum msg_hash_enums
    MSG_RUNAHEAD_FAILED_TO_SAVE_STATE,
    MSG_RUNAHEAD_FAILED_TO_LOAD_STATE,
    MSG_RUNAHEAD_FAILED_TO_CREATE_SECONDARY_INSTANCE,
+   MSG_RUNAHEAD_CALIBRATED,
+   MSG_RUNAHEAD_CALIBRATION_NO_LAG,
+   MSG_RUNAHEAD_CALIBRATION_FAILED,
    MSG_MISSING_ASSETS,
    MSG_RGUI_MISSING_FONTS,
    MSG_RGUI_INVALID_LANGUAGE,
@@ -496,6 +503,7 @@ enum msg_hash_enums
    MENU_LABEL(MENU_XMB_ANIMATION_MOVE_UP_DOWN),
    MENU_LABEL(MENU_XMB_ANIMATION_OPENING_MAIN_MENU),
    MENU_LABEL(SCAN_WITHOUT_CORE_MATCH),
+   MENU_LABEL(SCAN_THREADS),
    MENU_LABEL(STREAMING_TITLE),
    MENU_LABEL(STREAMING_MODE),
    MENU_LABEL(VIDEO_RECORD_QUALITY),
@@ -877,6 +885,7 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_VALUE_INPUT_META_STREAMING_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_RUNAHEAD_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_AI_SERVICE,
+   MENU_ENUM_LABEL_VALUE_INPUT_META_TRACE_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_MENU_TOGGLE,
 
    MENU_ENUM_LABEL_VALUE_INPUT_DEVICE_INDEX,
@@ -930,6 +939,7 @@ enum msg_hash_enums
    MENU_ENUM_SUBLABEL_INPUT_META_STREAMING_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_RUNAHEAD_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE,
+   MENU_ENUM_SUBLABEL_INPUT_META_TRACE_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_MENU_TOGGLE,
 
    MENU_ENUM_LABEL_INPUT_DESCRIPTION,
@@ -1006,6 +1016,7 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_FONT_ENABLE),
    MENU_LABEL(VIDEO_FONT_PATH),
    MENU_LABEL(VIDEO_FONT_SIZE),
+   MENU_LABEL(VIDEO_FONT_SDF_ENABLE),
    MENU_LABEL(VIDEO_MESSAGE_POS_X),
    MENU_LABEL(VIDEO_MESSAGE_POS_Y),
    MENU_LABEL(VIDEO_MESSAGE_COLOR_RED),
@@ -1020,8 +1031,11 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_SOFT_FILTER),
    MENU_LABEL(VIDEO_MAX_SWAPCHAIN_IMAGES),
    MENU_LABEL(VIDEO_GPU_SCREENSHOT),
+   MENU_LABEL(VIDEO_FRAME_DUPE_DETECT),
+   MENU_LABEL(SCREENSHOT_MODE),
    MENU_LABEL(VIDEO_BLACK_FRAME_INSERTION),
    MENU_LABEL(VIDEO_FRAME_DELAY),
+   MENU_LABEL(VIDEO_FRAME_DELAY_AUTO),
    MENU_LABEL(VIDEO_SHADER_DELAY),
    MENU_LABEL(VIDEO_VSYNC),
    MENU_LABEL(VIDEO_ADAPTIVE_VSYNC),
@@ -1169,6 +1183,7 @@ enum msg_hash_enums
    MENU_LABEL(XMB_VERTICAL_THUMBNAILS),
    MENU_LABEL(MENU_XMB_THUMBNAIL_SCALE_FACTOR),
    MENU_LABEL(MENU_THUMBNAIL_UPSCALE_THRESHOLD),
+   MENU_LABEL(MENU_THUMBNAIL_CACHE_SIZE),
    MENU_LABEL(MENU_RGUI_INLINE_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_SWAP_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_THUMBNAIL_DOWNSCALER),
@@ -1641,6 +1656,7 @@ enum msg_hash_enums
    MENU_LABEL(PAUSE_LIBRETRO),
    MENU_LABEL(MENU_SAVESTATE_RESUME),
    MENU_LABEL(MENU_INSERT_DISK_RESUME),
+   MENU_LABEL(MENU_SKIP_STATIC_FRAMES),
    MENU_LABEL(DIRECTORY_NOT_FOUND),
    MENU_LABEL(NO_ITEMS),
    MENU_LABEL(NO_PLAYLISTS),
@@ -1676,9 +1692,12 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_MIXER_MUTE),
    MENU_LABEL(AUDIO_FASTFORWARD_MUTE),
    MENU_LABEL(AUDIO_SYNC),
+   MENU_LABEL(AUDIO_THREADED_PROCESSING),
    MENU_LABEL(AUDIO_VOLUME),
    MENU_LABEL(AUDIO_MIXER_VOLUME),
    MENU_LABEL(AUDIO_RATE_CONTROL_DELTA),
+   MENU_LABEL(AUDIO_RATE_CONTROL_PI),
+   MENU_LABEL(AUDIO_RATE_CONTROL_TARGET),
    MENU_LABEL(AUDIO_LATENCY),
    MENU_LABEL(AUDIO_RESAMPLER_QUALITY),
    MENU_LABEL(AUDIO_WASAPI_EXCLUSIVE_MODE),
@@ -1821,6 +1840,9 @@ enum msg_hash_enums
    MENU_LABEL(LOG_VERBOSITY),
    MENU_LABEL(LOG_TO_FILE),
    MENU_LABEL(LOG_TO_FILE_TIMESTAMP),
+   MENU_LABEL(LOG_ASYNC),
+   MENU_LABEL(TRACE_DURATION),
+   MENU_ENUM_LABEL_VALUE_TRACE_DURATION_MANUAL,
 
    MENU_ENUM_LABEL_OVERLAY_NEXT,
 
@@ -1844,6 +1866,8 @@ enum msg_hash_enums
    MENU_LABEL(NETPLAY_SPECTATOR_MODE_ENABLE),
    MENU_LABEL(NETPLAY_TCP_UDP_PORT),
    MENU_LABEL(NETPLAY_NAT_TRAVERSAL),
+   MENU_LABEL(NETPLAY_UDP_INPUT),
+   MENU_LABEL(NETPLAY_RELAY_PORT),
    MENU_LABEL(NETPLAY_REQUEST_DEVICE_I),
    MENU_ENUM_LABEL_NETPLAY_REQUEST_DEVICE_1,
    MENU_ENUM_LABEL_NETPLAY_REQUEST_DEVICE_LAST = MENU_ENUM_LABEL_NETPLAY_REQUEST_DEVICE_1 + MAX_USERS,
@@ -1895,6 +1919,7 @@ enum msg_hash_enums
    MENU_LABEL(OVERLAY_CENTER_Y),
 
    MENU_LABEL(FASTFORWARD_RATIO),
+   MENU_LABEL(FASTFORWARD_FRAMESKIP),
    MENU_LABEL(VRR_RUNLOOP_ENABLE),
    MENU_LABEL(REWIND_ENABLE),
    MENU_LABEL(CHEAT_APPLY_AFTER_TOGGLE),
@@ -1955,6 +1980,7 @@ enum msg_hash_enums
    MENU_LABEL(RUN_AHEAD_SECONDARY_INSTANCE),
    MENU_LABEL(RUN_AHEAD_HIDE_WARNINGS),
    MENU_LABEL(RUN_AHEAD_FRAMES),
+   MENU_LABEL(RUN_AHEAD_CALIBRATE),
    MENU_LABEL(INPUT_BLOCK_TIMEOUT),
    MENU_LABEL(TURBO),
 
@@ -2113,6 +2139,7 @@ enum msg_hash_enums
    MENU_LABEL(NETWORK_REMOTE_ENABLE),
    MENU_LABEL(NETWORK_REMOTE_PORT),
    MENU_LABEL(NETWORK_ON_DEMAND_THUMBNAILS),
+   MENU_LABEL(NETWORK_THUMBNAIL_DOWNLOADS),
 
    MENU_ENUM_LABEL_NETWORK_REMOTE_USER_1_ENABLE,
 
@@ -2123,6 +2150,7 @@ enum msg_hash_enums
    MENU_LABEL(DUMMY_ON_CORE_SHUTDOWN),
    MENU_LABEL(CHECK_FOR_MISSING_FIRMWARE),
    MENU_LABEL(CORE_INFO_CACHE_ENABLE),
+   MENU_LABEL(VFS_READ_BLOCK_SIZE),
 #ifndef HAVE_DYNAMIC
    MENU_LABEL(ALWAYS_RELOAD_CORE_ON_RUN_CONTENT),
 #endif
@@ -2373,6 +2401,7 @@ enum msg_hash_enums
    MENU_LABEL(SHADER_APPLY_CHANGES),
    MENU_LABEL(SHADER_WATCH_FOR_CHANGES),
    MENU_LABEL(VIDEO_SHADER_REMEMBER_LAST_DIR),
+   MENU_LABEL(VIDEO_SHADER_FP16_FRAMEBUFFERS),
    MENU_LABEL(SAVE_NEW_CONFIG),
    MENU_LABEL(ONSCREEN_DISPLAY_SETTINGS),
    MENU_LABEL(ONSCREEN_OVERLAY_SETTINGS),
@@ -2942,6 +2971,7 @@ enum msg_hash_enums
    MENU_LABEL(MIDI_VOLUME),
 
    MENU_LABEL(SUSTAINED_PERFORMANCE_MODE),
+   MENU_LABEL(POWER_SAVING_MODE),
    MENU_LABEL(CPU_PERF_MODE),
    MENU_LABEL(CPU_PERFPOWER),
    MENU_LABEL(CPU_POLICY_ENTRY),
@@ -88,6 +88,19 @@ enum rarch_netplay_share_analog_preference
 
 bool netplay_driver_ctl(enum rarch_netplay_ctl_state state, void *data);
 
+/**
+ * netplay_get_peer_stats:
+ * @idx                  : peer index, from 0
+ * @s                    : output string
+ * @len                  : size of @s
+ *
+ * Describes the live connection statistics of one peer
+ * (RTT, input lag, stalls, throughput) in one line.
+ *
+ * Returns: false if there is no peer with index @idx.
+ **/
+bool netplay_get_peer_stats(unsigned idx, char *s, size_t len);
+
 int netplay_rooms_parse(const char *buf);
 
 struct netplay_room* netplay_room_get(int index);
@@ -79,6 +79,12 @@ int netplay_room_count                 = 0;
 /* LAN discovery sockets */
 static int lan_ad_server_fd            = -1;
 static int lan_ad_client_fd            = -1;
+#ifdef HAVE_INET6
+static int lan_ad_server_fd6           = -1;
+static int lan_ad_client_fd6           = -1;
+#endif
+/* When the last query went out, for the reply latency */
+static retro_time_t lan_ad_query_time;
 /* Packet buffer for advertisement and responses */
 static struct ad_packet ad_packet_buffer;
 /* List of discovered hosts */
@@ -104,173 +110,552 @@ static int16_t htons_for_morons(int16_t value)
 #endif
 
 #ifdef HAVE_NETPLAYDISCOVERY
-static bool netplay_lan_ad_client(void)
+/* Datagram socket of @family bound to @port on all interfaces */
+static int netplay_discovery_socket(int family, uint16_t port)
+{
+   int fd;
+   char port_str[6];
+   struct addrinfo *addr = NULL;
+   struct addrinfo hints = {0};
+
+   hints.ai_family       = family;
+   hints.ai_socktype     = SOCK_DGRAM;
+   hints.ai_flags        = AI_PASSIVE;
+
+   snprintf(port_str, sizeof(port_str), "%hu", (unsigned short)port);
+
+   if (!network_init())
+      return -1;
+   if (getaddrinfo_retro(NULL, port_str, &hints, &addr) != 0 || !addr)
+      return -1;
+
+   fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+
+   if (fd >= 0)
+   {
+#if defined(HAVE_INET6) && defined(IPV6_V6ONLY)
+      /* The IPv4 socket gets the IPv4 traffic */
+      if (family == AF_INET6)
+      {
+         int on = 1;
+         setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY,
+               (const char*)&on, sizeof(on));
+      }
+#endif
+
+      if (!socket_bind(fd, (void*)addr))
+      {
+         socket_close(fd);
+         fd = -1;
+      }
+   }
+
+   freeaddrinfo_retro(addr);
+   return fd;
+}
+
+/* Resolves the discovery multicast group of @family */
+static struct addrinfo *netplay_discovery_group(int family)
+{
+   char port_str[6];
+   struct addrinfo *addr = NULL;
+   struct addrinfo hints = {0};
+
+   hints.ai_family       = family;
+   hints.ai_socktype     = SOCK_DGRAM;
+
+   snprintf(port_str, sizeof(port_str), "%hu",
+         (unsigned short)RARCH_DEFAULT_PORT);
+
+   if (getaddrinfo_retro(family == AF_INET
+            ? NETPLAY_DISCOVERY_MCAST_IPV4 : NETPLAY_DISCOVERY_MCAST_IPV6,
+            port_str, &hints, &addr) != 0)
+      return NULL;
+
+   return addr;
+}
+
+/* Makes the server socket @fd receive queries sent to the
+ * multicast group, on every interface we know of */
+static void netplay_discovery_join_group(int fd, int family,
+      const net_ifinfo_t *interfaces)
+{
+   struct addrinfo *group = netplay_discovery_group(family);
+
+   if (!group)
+      return;
+
+#ifdef IP_ADD_MEMBERSHIP
+   if (family == AF_INET)
+   {
+      unsigned k;
+      struct ip_mreq mreq;
+      unsigned joined  = 0;
+
+      memset(&mreq, 0, sizeof(mreq));
+      mreq.imr_multiaddr = ((struct sockaddr_in*)group->ai_addr)->sin_addr;
+
+      for (k = 0; k < (unsigned)interfaces->size; k++)
+      {
+         const char *host = interfaces->entries[k].host;
+
+         if (!host || strchr(host, ':'))
+            continue;
+
+         mreq.imr_interface.s_addr = inet_addr(host);
+         if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                  (const char*)&mreq, sizeof(mreq)) == 0)
+            joined++;
+      }
+
+      if (!joined)
+         RARCH_WARN("[Discovery] Failed to join IPv4 discovery group\n");
+   }
+#endif
+#if defined(HAVE_INET6) && defined(IPV6_JOIN_GROUP)
+   if (family == AF_INET6)
+   {
+      struct ipv6_mreq mreq6;
+
+      memset(&mreq6, 0, sizeof(mreq6));
+      mreq6.ipv6mr_multiaddr =
+         ((struct sockaddr_in6*)group->ai_addr)->sin6_addr;
+      mreq6.ipv6mr_interface = 0;
+
+      if (setsockopt(fd, IPPROTO_IPV6, IPV6_JOIN_GROUP,
+               (const char*)&mreq6, sizeof(mreq6)) < 0)
+         RARCH_WARN("[Discovery] Failed to join IPv6 discovery group\n");
+   }
+#endif
+
+   freeaddrinfo_retro(group);
+}
+
+static bool netplay_lan_ad_add_host(struct sockaddr_storage *their_addr,
+      socklen_t addr_size)
+{
+   size_t i;
+   char address[NETPLAY_HOST_LONGSTR_LEN];
+   struct netplay_host *host = NULL;
+   int port                  = ntohl(ad_packet_buffer.port);
+   int family                = ((struct sockaddr*)their_addr)->sa_family;
+   int latency               = (int)((cpu_features_get_time_usec()
+            - lan_ad_query_time) / 1000);
+
+   strlcpy(address, ad_packet_buffer.address, sizeof(address));
+
+   /* And that we know how to handle it */
+   if (family == AF_INET)
+   {
+      struct sockaddr_in *sin = (struct sockaddr_in*)their_addr;
+      sin->sin_port           = htons(port);
+   }
+#ifdef HAVE_INET6
+   else if (family == AF_INET6)
+   {
+      struct sockaddr_in6 *sin6 = (struct sockaddr_in6*)their_addr;
+      size_t _len;
+
+      /* IPv6 replies do not carry an address, use where it came from */
+      if (!inet_ntop_compat(AF_INET6, &sin6->sin6_addr,
+               address, sizeof(address)))
+         return true;
+
+      /* Link-local addresses are useless without the interface */
+      _len = strlen(address);
+      if (sin6->sin6_scope_id)
+         snprintf(address + _len, sizeof(address) - _len, "%%%u",
+               (unsigned)sin6->sin6_scope_id);
+
+      sin6->sin6_port = htons(port);
+   }
+#endif
+   else
+      return true;
+
+   /* A host that is reachable several ways (broadcast, multicast,
+    * IPv6, more than one interface) replies more than once */
+   for (i = 0; i < discovered_hosts.size; i++)
+   {
+      host = &discovered_hosts.hosts[i];
+      if (host->port == port
+            && string_is_equal(host->nick, ad_packet_buffer.nick)
+            && host->content_crc == atoi(ad_packet_buffer.content_crc))
+      {
+         if (latency < host->latency)
+            host->latency = latency;
+
+         /* IPv4 addresses are shorter and need no scope, prefer them */
+         if (family == AF_INET
+               && ((struct sockaddr*)&host->addr)->sa_family != AF_INET)
+         {
+            memcpy(&host->addr, their_addr, addr_size);
+            host->addrlen = addr_size;
+            strlcpy(host->address, address, sizeof(host->address));
+         }
+         return true;
+      }
+   }
+
+   /* Allocate space for it */
+   if (discovered_hosts.size >= discovered_hosts_allocated)
+   {
+      size_t allocated               = discovered_hosts_allocated;
+      struct netplay_host *new_hosts = NULL;
+
+      if (allocated == 0)
+         allocated  = 2;
+      else
+         allocated *= 2;
+
+      if (discovered_hosts.hosts)
+         new_hosts  = (struct netplay_host *)
+            realloc(discovered_hosts.hosts, allocated * sizeof(struct
+            netplay_host));
+      else
+         /* Should be equivalent to realloc,
+          * but I don't trust screwy libcs */
+         new_hosts = (struct netplay_host *)
+            malloc(allocated * sizeof(struct netplay_host));
+
+      if (!new_hosts)
+         return false;
+
+      discovered_hosts.hosts     = new_hosts;
+      discovered_hosts_allocated = allocated;
+   }
+
+   /* Get our host structure */
+   host = &discovered_hosts.hosts[discovered_hosts.size++];
+
+   /* Copy in the response */
+   memset(host, 0, sizeof(struct netplay_host));
+   memcpy(&host->addr, their_addr, addr_size);
+   host->addrlen = addr_size;
+
+   host->port    = port;
+   host->latency = latency;
+
+   strlcpy(host->address, address, sizeof(host->address));
+   strlcpy(host->nick, ad_packet_buffer.nick, NETPLAY_HOST_STR_LEN);
+   strlcpy(host->core, ad_packet_buffer.core, NETPLAY_HOST_STR_LEN);
+   strlcpy(host->retroarch_version, ad_packet_buffer.retroarch_version,
+      NETPLAY_HOST_STR_LEN);
+   strlcpy(host->core_version, ad_packet_buffer.core_version,
+      NETPLAY_HOST_STR_LEN);
+   strlcpy(host->content, ad_packet_buffer.content,
+      NETPLAY_HOST_LONGSTR_LEN);
+   strlcpy(host->subsystem_name, ad_packet_buffer.subsystem_name,
+      NETPLAY_HOST_LONGSTR_LEN);
+   strlcpy(host->frontend, ad_packet_buffer.frontend,
+      NETPLAY_HOST_STR_LEN);
+
+   host->content_crc                  =
+      atoi(ad_packet_buffer.content_crc);
+   host->nick[NETPLAY_HOST_STR_LEN-1] =
+      host->core[NETPLAY_HOST_STR_LEN-1] =
+      host->core_version[NETPLAY_HOST_STR_LEN-1] =
+      host->content[NETPLAY_HOST_LONGSTR_LEN-1] = '\0';
+
+   return true;
+}
+
+static bool netplay_lan_ad_client(unsigned timeout_usec)
 {
-   unsigned i;
+   int fds_max;
    fd_set fds;
    socklen_t addr_size;
-   struct sockaddr their_addr;
-   struct timeval tmp_tv    = {0};
+   struct sockaddr_storage their_addr;
+   struct timeval tmp_tv;
+   int fd                   = -1;
 
    if (lan_ad_client_fd < 0)
       return false;
 
-   their_addr.sa_family     = 0;
-   for (i = 0; i < 14; i++)
-      their_addr.sa_data[i] = 0;
+   tmp_tv.tv_sec            = timeout_usec / 1000000;
+   tmp_tv.tv_usec           = timeout_usec % 1000000;
 
    /* Check for any ad queries */
    for (;;)
    {
       FD_ZERO(&fds);
       FD_SET(lan_ad_client_fd, &fds);
-      if (socket_select(lan_ad_client_fd + 1,
+      fds_max = lan_ad_client_fd;
+#ifdef HAVE_INET6
+      if (lan_ad_client_fd6 >= 0)
+      {
+         FD_SET(lan_ad_client_fd6, &fds);
+         if (lan_ad_client_fd6 > fds_max)
+            fds_max = lan_ad_client_fd6;
+      }
+#endif
+
+      if (socket_select(fds_max + 1,
                &fds, NULL, NULL, &tmp_tv) <= 0)
          break;
 
-      if (!FD_ISSET(lan_ad_client_fd, &fds))
+      /* Only wait for the first reply, drain the rest */
+      tmp_tv.tv_sec  = 0;
+      tmp_tv.tv_usec = 0;
+
+      if (FD_ISSET(lan_ad_client_fd, &fds))
+         fd = lan_ad_client_fd;
+#ifdef HAVE_INET6
+      else if (lan_ad_client_fd6 >= 0 && FD_ISSET(lan_ad_client_fd6, &fds))
+         fd = lan_ad_client_fd6;
+#endif
+      else
          break;
 
       /* Somebody queried, so check that it's valid */
+      memset(&their_addr, 0, sizeof(their_addr));
       addr_size = sizeof(their_addr);
 
-      if (recvfrom(lan_ad_client_fd, (char*)&ad_packet_buffer,
-            sizeof(struct ad_packet), 0, &their_addr, &addr_size) >=
-            (ssize_t) sizeof(struct ad_packet))
+      if (recvfrom(fd, (char*)&ad_packet_buffer,
+            sizeof(struct ad_packet), 0, (struct sockaddr*)&their_addr,
+            &addr_size) >= (ssize_t) sizeof(struct ad_packet))
       {
-         struct netplay_host *host = NULL;
-
          /* Make sure it's a valid response */
          if (memcmp((void *) &ad_packet_buffer, "RANS", 4))
             continue;
 
          /* For this version */
-         if (ntohl(ad_packet_buffer.protocol_version) 
+         if (ntohl(ad_packet_buffer.protocol_version)
                != NETPLAY_PROTOCOL_VERSION)
             continue;
 
-         /* And that we know how to handle it */
-         if (their_addr.sa_family == AF_INET)
-         {
-            struct sockaddr_in *sin = NULL;
+         ad_packet_buffer.address[NETPLAY_HOST_STR_LEN-1]     = '\0';
+         ad_packet_buffer.content_crc[NETPLAY_HOST_STR_LEN-1] = '\0';
 
-            RARCH_WARN ("[Discovery] Using IPv4 for discovery\n");
-            sin           = (struct sockaddr_in *) &their_addr;
-            sin->sin_port = htons(ntohl(ad_packet_buffer.port));
+         if (!netplay_lan_ad_add_host(&their_addr, addr_size))
+            return false;
+      }
+   }
 
-         }
-#ifdef HAVE_INET6
-         else if (their_addr.sa_family == AF_INET6)
-         {
-            struct sockaddr_in6 *sin6 = NULL;
-            RARCH_WARN ("[Discovery] Using IPv6 for discovery\n");
-            sin6            = (struct sockaddr_in6 *) &their_addr;
-            sin6->sin6_port = htons(ad_packet_buffer.port);
+   return true;
+}
+#endif
 
-         }
+/** Initialize Netplay discovery (client) */
+bool init_netplay_discovery(void)
+{
+#ifdef HAVE_NETPLAYDISCOVERY
+   /* Kept open between scans, so late replies still arrive */
+   if (lan_ad_client_fd >= 0)
+      return true;
+
+   if ((lan_ad_client_fd = netplay_discovery_socket(AF_INET, 0)) < 0)
+   {
+      RARCH_ERR("[Discovery] Failed to initialize netplay advertisement client socket.\n");
+      return false;
+   }
+
+#ifdef HAVE_INET6
+   /* Optional, IPv4 discovery works without it */
+   lan_ad_client_fd6 = netplay_discovery_socket(AF_INET6, 0);
 #endif
-         else continue;
 
-         /* Allocate space for it */
-         if (discovered_hosts.size >= discovered_hosts_allocated)
-         {
-            size_t allocated               = discovered_hosts_allocated;
-            struct netplay_host *new_hosts = NULL;
+   return true;
+#else
+   return false;
+#endif
+}
 
-            if (allocated == 0)
-               allocated  = 2;
-            else
-               allocated *= 2;
+/** Deinitialize and free Netplay discovery */
+/* TODO/FIXME - this is apparently never called? */
+void deinit_netplay_discovery(void)
+{
+   if (lan_ad_client_fd >= 0)
+   {
+      socket_close(lan_ad_client_fd);
+      lan_ad_client_fd = -1;
+   }
+#ifdef HAVE_INET6
+   if (lan_ad_client_fd6 >= 0)
+   {
+      socket_close(lan_ad_client_fd6);
+      lan_ad_client_fd6 = -1;
+   }
+#endif
+}
 
-            if (discovered_hosts.hosts)
-               new_hosts  = (struct netplay_host *)
-                  realloc(discovered_hosts.hosts, allocated * sizeof(struct
-                  netplay_host));
-            else
-               /* Should be equivalent to realloc, 
-                * but I don't trust screwy libcs */
-               new_hosts = (struct netplay_host *)
-                  malloc(allocated * sizeof(struct netplay_host));
+void netplay_room_get_connect_address(const struct netplay_room *room,
+      const char **address, int *port)
+{
+   if (room->host_method == NETPLAY_HOST_METHOD_MITM)
+   {
+      *address = room->mitm_address;
+      *port    = room->mitm_port;
+   }
+   else
+   {
+      *address = room->address;
+      *port    = room->port;
+   }
+}
 
-            if (!new_hosts)
-               return false;
+static bool netplay_room_is_same(const struct netplay_room *a,
+      const struct netplay_room *b)
+{
+   return a->port == b->port
+      && a->host_method == b->host_method
+      && string_is_equal(a->address, b->address)
+      && string_is_equal(a->nickname, b->nickname);
+}
 
-            discovered_hosts.hosts     = new_hosts;
-            discovered_hosts_allocated = allocated;
-         }
+/* An internet room that we also found on the LAN */
+static bool netplay_room_is_lan_duplicate(const struct netplay_room *room,
+      const struct netplay_room *lan)
+{
+   return room->gamecrc == lan->gamecrc
+      && string_is_equal(room->nickname, lan->nickname)
+      && string_is_equal(room->corename, lan->corename);
+}
 
-         /* Get our host structure */
-         host = &discovered_hosts.hosts[discovered_hosts.size++];
+/* Stable, so rooms of equal (or unknown) latency keep the
+ * LAN first, then lobby server order */
+static void netplay_room_list_sort(void)
+{
+   int i, j;
+   struct netplay_room tmp;
 
-         /* Copy in the response */
-         memset(host, 0, sizeof(struct netplay_host));
-         host->addr    = their_addr;
-         host->addrlen = addr_size;
+   for (i = 1; i < netplay_room_count; i++)
+   {
+      int latency = netplay_room_list[i].latency;
 
-         host->port = ntohl(ad_packet_buffer.port);
+      if (latency < 0)
+         continue;
 
-         strlcpy(host->address, ad_packet_buffer.address, NETPLAY_HOST_STR_LEN);
-         strlcpy(host->nick, ad_packet_buffer.nick, NETPLAY_HOST_STR_LEN);
-         strlcpy(host->core, ad_packet_buffer.core, NETPLAY_HOST_STR_LEN);
-         strlcpy(host->retroarch_version, ad_packet_buffer.retroarch_version,
-            NETPLAY_HOST_STR_LEN);
-         strlcpy(host->core_version, ad_packet_buffer.core_version,
-            NETPLAY_HOST_STR_LEN);
-         strlcpy(host->content, ad_packet_buffer.content,
-            NETPLAY_HOST_LONGSTR_LEN);
-         strlcpy(host->subsystem_name, ad_packet_buffer.subsystem_name,
-            NETPLAY_HOST_LONGSTR_LEN);
-         strlcpy(host->frontend, ad_packet_buffer.frontend,
-            NETPLAY_HOST_STR_LEN);
-
-         host->content_crc                  =
-            atoi(ad_packet_buffer.content_crc);
-         host->nick[NETPLAY_HOST_STR_LEN-1] =
-            host->core[NETPLAY_HOST_STR_LEN-1] =
-            host->core_version[NETPLAY_HOST_STR_LEN-1] =
-            host->content[NETPLAY_HOST_LONGSTR_LEN-1] = '\0';
+      for (j = i; j > 0; j--)
+      {
+         int prev = netplay_room_list[j - 1].latency;
+         if (prev >= 0 && prev <= latency)
+            break;
       }
-   }
 
-   return true;
+      if (j == i)
+         continue;
+
+      memcpy(&tmp, &netplay_room_list[i], sizeof(tmp));
+      memmove(&netplay_room_list[j + 1], &netplay_room_list[j],
+            (i - j) * sizeof(tmp));
+      memcpy(&netplay_room_list[j], &tmp, sizeof(tmp));
+   }
 }
-#endif
 
-/** Initialize Netplay discovery (client) */
-bool init_netplay_discovery(void)
+void netplay_room_list_update(const struct netplay_room *rooms,
+      int count, bool lan)
 {
-   struct addrinfo *addr = NULL;
-   int fd = socket_init((void **)&addr, 0, NULL, SOCKET_TYPE_DATAGRAM);
+   int i, j;
+   int new_count             = 0;
+   struct netplay_room *list = (struct netplay_room*)
+      calloc(count + netplay_room_count + 1, sizeof(*list));
 
-   if (fd < 0)
-      goto error;
+   if (!list)
+      return;
 
-   if (!socket_bind(fd, (void*)addr))
+   /* LAN rooms first, then the lobby server's */
+   for (i = 0; i < netplay_room_count; i++)
    {
-      socket_close(fd);
-      goto error;
+      const struct netplay_room *room = &netplay_room_list[i];
+
+      if (!room->lan)
+         continue;
+
+      if (!lan)
+         memcpy(&list[new_count++], room, sizeof(*room));
+      else
+      {
+         /* LAN hosts sometimes miss a reply, only drop
+          * them after a few scans without one */
+         for (j = 0; j < count; j++)
+            if (netplay_room_is_same(room, &rooms[j]))
+               break;
+         if (j == count && room->missed_scans + 1 < NETPLAY_ROOM_LAN_MAX_MISSED)
+         {
+            memcpy(&list[new_count], room, sizeof(*room));
+            list[new_count++].missed_scans++;
+         }
+      }
    }
 
-   lan_ad_client_fd = fd;
-   freeaddrinfo_retro(addr);
-   return true;
+   for (i = 0; i < count; i++)
+   {
+      struct netplay_room *room = &list[new_count++];
 
-error:
-   if (addr)
-      freeaddrinfo_retro(addr);
-   RARCH_ERR("[Discovery] Failed to initialize netplay advertisement client socket.\n");
-   return false;
+      memcpy(room, &rooms[i], sizeof(*room));
+      room->next         = NULL;
+      room->lan          = lan;
+      room->missed_scans = 0;
+
+      /* Keep what we measured before, until a new probe is in */
+      if (!lan)
+      {
+         room->latency   = -1;
+         for (j = 0; j < netplay_room_count; j++)
+            if (netplay_room_is_same(room, &netplay_room_list[j]))
+            {
+               room->latency = netplay_room_list[j].latency;
+               break;
+            }
+      }
+   }
+
+   for (i = 0; i < netplay_room_count; i++)
+   {
+      const struct netplay_room *room = &netplay_room_list[i];
+      if (!room->lan && lan)
+         memcpy(&list[new_count++], room, sizeof(*room));
+   }
+
+   /* A LAN and an internet entry of the same session: keep the LAN one */
+   for (i = j = 0; i < new_count; i++)
+   {
+      int k;
+      bool duplicate = false;
+
+      if (!list[i].lan)
+         for (k = 0; k < new_count && !duplicate; k++)
+            duplicate = list[k].lan
+               && netplay_room_is_lan_duplicate(&list[i], &list[k]);
+
+      if (duplicate)
+         continue;
+      if (j != i)
+         memcpy(&list[j], &list[i], sizeof(*list));
+      j++;
+   }
+
+   if (netplay_room_list)
+      free(netplay_room_list);
+
+   netplay_room_list  = list;
+   netplay_room_count = j;
+
+   netplay_room_list_sort();
 }
 
-/** Deinitialize and free Netplay discovery */
-/* TODO/FIXME - this is apparently never called? */
-void deinit_netplay_discovery(void)
+void netplay_room_list_set_latency(const char *address, int port,
+      int latency)
 {
-   if (lan_ad_client_fd >= 0)
+   int i;
+
+   for (i = 0; i < netplay_room_count; i++)
    {
-      socket_close(lan_ad_client_fd);
-      lan_ad_client_fd = -1;
+      const char *room_address = NULL;
+      int room_port            = 0;
+
+      if (netplay_room_list[i].lan)
+         continue;
+
+      netplay_room_get_connect_address(&netplay_room_list[i],
+            &room_address, &room_port);
+
+      if (room_port == port && string_is_equal(room_address, address))
+         netplay_room_list[i].latency = latency;
    }
+
+   netplay_room_list_sort();
 }
 
 /** Discovery control */
@@ -292,15 +677,20 @@ bool netplay_discovery_driver_ctl(
       {
          net_ifinfo_t interfaces;
          struct addrinfo hints = {0}, *addr;
-         int can_broadcast     = 1;
+         struct addrinfo *group = NULL;
+         int can_broadcast      = 1;
 
          if (!net_ifinfo_new(&interfaces))
             return false;
 
-         /* Get the broadcast address (IPv4 only for now) */
+         /* Get the broadcast address (IPv4 only) */
+         hints.ai_family = AF_INET;
          snprintf(port_str, 6, "%hu", (unsigned short) RARCH_DEFAULT_PORT);
          if (getaddrinfo_retro("255.255.255.255", port_str, &hints, &addr) < 0)
+         {
+            net_ifinfo_free(&interfaces);
             return false;
+         }
 
          /* Make it broadcastable */
 #if defined(SOL_SOCKET) && defined(SO_BROADCAST)
@@ -309,13 +699,22 @@ bool netplay_discovery_driver_ctl(
             RARCH_WARN("[Discovery] Failed to set netplay discovery port to broadcast\n");
 #endif
 
+         group = netplay_discovery_group(AF_INET);
+
          /* Put together the request */
+         memset(&ad_packet_buffer, 0, sizeof(ad_packet_buffer));
          memcpy((void *) &ad_packet_buffer, "RANQ", 4);
          ad_packet_buffer.protocol_version = htonl(NETPLAY_PROTOCOL_VERSION);
+         lan_ad_query_time                 = cpu_features_get_time_usec();
 
          for (k = 0; k < (unsigned)interfaces.size; k++)
          {
-            strlcpy(ad_packet_buffer.address, interfaces.entries[k].host,
+            const char *host = interfaces.entries[k].host;
+
+            if (!host || strchr(host, ':'))
+               continue;
+
+            strlcpy(ad_packet_buffer.address, host,
                NETPLAY_HOST_STR_LEN);
 
             /* And send it off */
@@ -323,20 +722,57 @@ bool netplay_discovery_driver_ctl(
                sizeof(struct ad_packet), 0, addr->ai_addr, addr->ai_addrlen);
             if (ret < (ssize_t) (2*sizeof(uint32_t)))
                RARCH_WARN("[Discovery] Failed to send netplay discovery query (error: %d)\n", errno);
+
+            /* Routers often drop broadcasts between wired and
+             * wireless segments but forward multicast, so also
+             * ask the group through this very interface */
+#ifdef IP_MULTICAST_IF
+            if (group)
+            {
+               struct in_addr iface;
+               iface.s_addr = inet_addr(host);
+               if (setsockopt(lan_ad_client_fd, IPPROTO_IP, IP_MULTICAST_IF,
+                        (const char*)&iface, sizeof(iface)) == 0)
+                  sendto(lan_ad_client_fd, (const char *) &ad_packet_buffer,
+                        sizeof(struct ad_packet), 0,
+                        group->ai_addr, group->ai_addrlen);
+            }
+#endif
          }
 
+         if (group)
+            freeaddrinfo_retro(group);
          freeaddrinfo_retro(addr);
          net_ifinfo_free(&interfaces);
 
+#ifdef HAVE_INET6
+         /* The IPv6 query carries no address, hosts
+          * reply to wherever it came from */
+         if (lan_ad_client_fd6 >= 0
+               && (group = netplay_discovery_group(AF_INET6)))
+         {
+            ad_packet_buffer.address[0] = '\0';
+            sendto(lan_ad_client_fd6, (const char *) &ad_packet_buffer,
+                  sizeof(struct ad_packet), 0,
+                  group->ai_addr, group->ai_addrlen);
+            freeaddrinfo_retro(group);
+         }
+#endif
+
          break;
       }
 
       case RARCH_NETPLAY_DISCOVERY_CTL_LAN_GET_RESPONSES:
-         if (!netplay_lan_ad_client())
+         if (!netplay_lan_ad_client(0))
             return false;
          *((struct netplay_host_list **) data) = &discovered_hosts;
          break;
 
+      case RARCH_NETPLAY_DISCOVERY_CTL_LAN_WAIT_RESPONSES:
+         if (!netplay_lan_ad_client(*(unsigned*)data))
+            return false;
+         break;
+
       case RARCH_NETPLAY_DISCOVERY_CTL_LAN_CLEAR_RESPONSES:
          discovered_hosts.size = 0;
          break;
@@ -349,29 +785,123 @@ bool netplay_discovery_driver_ctl(
 }
 
 #ifdef HAVE_NETPLAYDISCOVERY
-static bool init_lan_ad_server_socket(netplay_t *netplay, uint16_t port)
+static bool init_lan_ad_server_socket(netplay_t *netplay, uint16_t port,
+      const net_ifinfo_t *interfaces)
 {
-   struct addrinfo *addr = NULL;
-   int fd = socket_init((void **) &addr, port, NULL, SOCKET_TYPE_DATAGRAM);
+   int fd = netplay_discovery_socket(AF_INET, port);
 
    if (fd < 0)
-      goto error;
+      return false;
+
+   netplay_discovery_join_group(fd, AF_INET, interfaces);
+   lan_ad_server_fd = fd;
 
-   if (!socket_bind(fd, (void*)addr))
+#ifdef HAVE_INET6
+   /* Optional, clients fall back to IPv4 */
+   if ((fd = netplay_discovery_socket(AF_INET6, port)) >= 0)
    {
-      socket_close(fd);
-      goto error;
+      netplay_discovery_join_group(fd, AF_INET6, interfaces);
+      lan_ad_server_fd6 = fd;
    }
-
-   lan_ad_server_fd = fd;
-   freeaddrinfo_retro(addr);
+#endif
 
    return true;
+}
 
-error:
-   if (addr)
-      freeaddrinfo_retro(addr);
-   return false;
+/* Puts together our reply in ad_packet_buffer */
+static void netplay_lan_ad_build_reply(netplay_t *netplay,
+      const char *address)
+{
+   char s[NETPLAY_HOST_STR_LEN];
+   char buf[4096];
+   char frontend_architecture_tmp[32];
+   char frontend[256];
+   const frontend_ctx_driver_t *frontend_drv =
+      (const frontend_ctx_driver_t*)
+      frontend_driver_get_cpu_architecture_str(
+            frontend_architecture_tmp, sizeof(frontend_architecture_tmp));
+   struct retro_system_info *info = runloop_get_libretro_system_info();
+   struct string_list *subsystem  = path_get_subsystem_list();
+   uint32_t content_crc           = content_get_crc();
+
+   snprintf(frontend, sizeof(frontend), "%s %s",
+         frontend_drv->ident, frontend_architecture_tmp);
+
+   /* Now build our response */
+   buf[0]      = '\0';
+
+   memset(&ad_packet_buffer, 0, sizeof(struct ad_packet));
+   memcpy(&ad_packet_buffer, "RANS", 4);
+
+   if (subsystem)
+   {
+      unsigned i;
+
+      for (i = 0; i < subsystem->size; i++)
+      {
+         strlcat(buf, path_basename(subsystem->elems[i].data), NETPLAY_HOST_LONGSTR_LEN);
+         if (i < subsystem->size - 1)
+            strlcat(buf, "|", NETPLAY_HOST_LONGSTR_LEN);
+      }
+      strlcpy(ad_packet_buffer.content, buf,
+         NETPLAY_HOST_LONGSTR_LEN);
+      strlcpy(ad_packet_buffer.subsystem_name, path_get(RARCH_PATH_SUBSYSTEM),
+         NETPLAY_HOST_STR_LEN);
+   }
+   else
+   {
+      strlcpy(ad_packet_buffer.content, !string_is_empty(
+               path_basename(path_get(RARCH_PATH_BASENAME)))
+            ? path_basename(path_get(RARCH_PATH_BASENAME)) : "N/A",
+            NETPLAY_HOST_LONGSTR_LEN);
+      strlcpy(ad_packet_buffer.subsystem_name, "N/A", NETPLAY_HOST_STR_LEN);
+   }
+
+   strlcpy(ad_packet_buffer.address, address,
+      NETPLAY_HOST_STR_LEN);
+   ad_packet_buffer.protocol_version =
+      htonl(NETPLAY_PROTOCOL_VERSION);
+   ad_packet_buffer.port = htonl(netplay->tcp_port);
+   strlcpy(ad_packet_buffer.retroarch_version, PACKAGE_VERSION,
+      NETPLAY_HOST_STR_LEN);
+   strlcpy(ad_packet_buffer.nick, netplay->nick, NETPLAY_HOST_STR_LEN);
+   strlcpy(ad_packet_buffer.frontend, frontend, NETPLAY_HOST_STR_LEN);
+
+   if (info)
+   {
+      strlcpy(ad_packet_buffer.core, info->library_name,
+         NETPLAY_HOST_STR_LEN);
+      strlcpy(ad_packet_buffer.core_version, info->library_version,
+         NETPLAY_HOST_STR_LEN);
+   }
+
+   snprintf(s, sizeof(s), "%d", content_crc);
+   strlcpy(ad_packet_buffer.content_crc, s,
+      NETPLAY_HOST_STR_LEN);
+}
+
+/* Validates the query in ad_packet_buffer */
+static bool netplay_lan_ad_is_query(int ret)
+{
+   if (ret < (ssize_t) (2 * sizeof(uint32_t)))
+      return false;
+
+   /* Make sure it's a valid query */
+   if (memcmp((void *) &ad_packet_buffer, "RANQ", 4))
+   {
+      RARCH_LOG("[Discovery] Invalid query\n");
+      return false;
+   }
+
+   /* For this version */
+   if (ntohl(ad_packet_buffer.protocol_version) !=
+         NETPLAY_PROTOCOL_VERSION)
+   {
+      RARCH_LOG("[Discovery] Invalid protocol version\n");
+      return false;
+   }
+
+   return true;
 }
 #endif
 
@@ -386,34 +916,56 @@ bool netplay_lan_ad_server(netplay_t *netplay)
 #ifdef HAVE_NETPLAYDISCOVERY
    fd_set fds;
    int ret;
-   unsigned i;
-   char buf[4096];
    net_ifinfo_t interfaces;
    socklen_t addr_size;
    char reply_addr[NETPLAY_HOST_STR_LEN], port_str[6];
-   struct sockaddr their_addr;
+   struct sockaddr_storage their_addr;
    struct timeval tmp_tv            = {0};
    unsigned k                       = 0;
    struct addrinfo *our_addr, hints = {0};
-   struct string_list *subsystem    = path_get_subsystem_list();
 
    interfaces.entries               = NULL;
    interfaces.size                  = 0;
-
-   their_addr.sa_family             = 0;
-   for (i = 0; i < 14; i++)
-      their_addr.sa_data[i]         = 0;
+   reply_addr[0]                    = '\0';
 
    if (!net_ifinfo_new(&interfaces))
       return false;
 
    if (     (lan_ad_server_fd < 0)
-         && !init_lan_ad_server_socket(netplay, RARCH_DEFAULT_PORT))
+         && !init_lan_ad_server_socket(netplay, RARCH_DEFAULT_PORT,
+            &interfaces))
    {
       RARCH_ERR("[Discovery] Failed to initialize netplay advertisement socket\n");
+      net_ifinfo_free(&interfaces);
       return false;
    }
 
+#ifdef HAVE_INET6
+   /* Check for any IPv6 ad queries, answered straight to the sender */
+   while (lan_ad_server_fd6 >= 0)
+   {
+      FD_ZERO(&fds);
+      FD_SET(lan_ad_server_fd6, &fds);
+      if (socket_select(lan_ad_server_fd6 + 1, &fds, NULL, NULL, &tmp_tv) <= 0)
+         break;
+      if (!FD_ISSET(lan_ad_server_fd6, &fds))
+         break;
+
+      addr_size = sizeof(their_addr);
+      ret       = (int)recvfrom(lan_ad_server_fd6, (char*)&ad_packet_buffer,
+            sizeof(struct ad_packet), 0, (struct sockaddr*)&their_addr,
+            &addr_size);
+
+      if (!netplay_lan_ad_is_query(ret))
+         continue;
+
+      netplay_lan_ad_build_reply(netplay, "");
+      sendto(lan_ad_server_fd6, (const char*)&ad_packet_buffer,
+            sizeof(struct ad_packet), 0, (struct sockaddr*)&their_addr,
+            addr_size);
+   }
+#endif
+
    /* Check for any ad queries */
    for (;;)
    {
@@ -427,27 +979,10 @@ bool netplay_lan_ad_server(netplay_t *netplay)
       /* Somebody queried, so check that it's valid */
       addr_size = sizeof(their_addr);
       ret       = (int)recvfrom(lan_ad_server_fd, (char*)&ad_packet_buffer,
-            sizeof(struct ad_packet), 0, &their_addr, &addr_size);
-      if (ret >= (ssize_t) (2 * sizeof(uint32_t)))
+            sizeof(struct ad_packet), 0, (struct sockaddr*)&their_addr,
+            &addr_size);
+      if (netplay_lan_ad_is_query(ret))
       {
-         char s[NETPLAY_HOST_STR_LEN];
-         uint32_t content_crc         = 0;
-
-         /* Make sure it's a valid query */
-         if (memcmp((void *) &ad_packet_buffer, "RANQ", 4))
-         {
-            RARCH_LOG("[Discovery] Invalid query\n");
-            continue;
-         }
-
-         /* For this version */
-         if (ntohl(ad_packet_buffer.protocol_version) !=
-               NETPLAY_PROTOCOL_VERSION)
-         {
-            RARCH_LOG("[Discovery] Invalid protocol version\n");
-            continue;
-         }
-
          if (!string_is_empty(ad_packet_buffer.address))
             strlcpy(reply_addr, ad_packet_buffer.address, NETPLAY_HOST_STR_LEN);
 
@@ -455,14 +990,6 @@ bool netplay_lan_ad_server(netplay_t *netplay)
          {
             char *p;
             char sub[NETPLAY_HOST_STR_LEN];
-            char frontend_architecture_tmp[32];
-            char frontend[256];
-            const frontend_ctx_driver_t *frontend_drv = 
-               (const frontend_ctx_driver_t*)
-            frontend_driver_get_cpu_architecture_str(
-                  frontend_architecture_tmp, sizeof(frontend_architecture_tmp));
-            snprintf(frontend, sizeof(frontend), "%s %s",
-                  frontend_drv->ident, frontend_architecture_tmp);
 
             p=strrchr(reply_addr,'.');
             if (p)
@@ -471,63 +998,11 @@ bool netplay_lan_ad_server(netplay_t *netplay)
                if (strstr(interfaces.entries[k].host, sub) &&
                   !strstr(interfaces.entries[k].host, "127.0.0.1"))
                {
-                  struct retro_system_info *info = runloop_get_libretro_system_info();
-
                   RARCH_LOG ("[Discovery] Query received on common interface: %s/%s (theirs / ours) \n",
                      reply_addr, interfaces.entries[k].host);
 
-                  /* Now build our response */
-                  buf[0]      = '\0';
-                  content_crc = content_get_crc();
-
-                  memset(&ad_packet_buffer, 0, sizeof(struct ad_packet));
-                  memcpy(&ad_packet_buffer, "RANS", 4);
-
-                  if (subsystem)
-                  {
-                     unsigned i;
-
-                     for (i = 0; i < subsystem->size; i++)
-                     {
-                        strlcat(buf, path_basename(subsystem->elems[i].data), NETPLAY_HOST_LONGSTR_LEN);
-                        if (i < subsystem->size - 1)
-                           strlcat(buf, "|", NETPLAY_HOST_LONGSTR_LEN);
-                     }
-                     strlcpy(ad_packet_buffer.content, buf,
-                        NETPLAY_HOST_LONGSTR_LEN);
-                     strlcpy(ad_packet_buffer.subsystem_name, path_get(RARCH_PATH_SUBSYSTEM),
-                        NETPLAY_HOST_STR_LEN);
-                  }
-                  else
-                  {
-                     strlcpy(ad_packet_buffer.content, !string_is_empty(
-                              path_basename(path_get(RARCH_PATH_BASENAME)))
-                           ? path_basename(path_get(RARCH_PATH_BASENAME)) : "N/A",
-                           NETPLAY_HOST_LONGSTR_LEN);
-                     strlcpy(ad_packet_buffer.subsystem_name, "N/A", NETPLAY_HOST_STR_LEN);
-                  }
-
-                  strlcpy(ad_packet_buffer.address, interfaces.entries[k].host,
-                     NETPLAY_HOST_STR_LEN);
-                  ad_packet_buffer.protocol_version =
-                     htonl(NETPLAY_PROTOCOL_VERSION);
-                  ad_packet_buffer.port = htonl(netplay->tcp_port);
-                  strlcpy(ad_packet_buffer.retroarch_version, PACKAGE_VERSION,
-                     NETPLAY_HOST_STR_LEN);
-                  strlcpy(ad_packet_buffer.nick, netplay->nick, NETPLAY_HOST_STR_LEN);
-                  strlcpy(ad_packet_buffer.frontend, frontend, NETPLAY_HOST_STR_LEN);
-
-                  if (info)
-                  {
-                     strlcpy(ad_packet_buffer.core, info->library_name,
-                        NETPLAY_HOST_STR_LEN);
-                     strlcpy(ad_packet_buffer.core_version, info->library_version,
-                        NETPLAY_HOST_STR_LEN);
-                  }
-
-                  snprintf(s, sizeof(s), "%d", content_crc);
-                  strlcpy(ad_packet_buffer.content_crc, s,
-                     NETPLAY_HOST_STR_LEN);
+                  netplay_lan_ad_build_reply(netplay,
+                        interfaces.entries[k].host);
 
                   /* Build up the destination address*/
                   snprintf(port_str, 6, "%hu", ntohs(((struct sockaddr_in*)(&their_addr))->sin_port));
@@ -23,21 +23,38 @@
 #define NETPLAY_HOST_STR_LEN 32
 #define NETPLAY_HOST_LONGSTR_LEN 256
 
+/* Groups the LAN discovery query is sent to besides the IPv4
+ * broadcast address, for networks that filter broadcasts and
+ * for IPv6-only hosts (link-local scope) */
+#define NETPLAY_DISCOVERY_MCAST_IPV4 "239.255.82.65"
+#define NETPLAY_DISCOVERY_MCAST_IPV6 "ff02::5241:4e51"
+
+/* How long a LAN scan waits for replies, in microseconds */
+#define NETPLAY_DISCOVERY_WAIT       1000000
+
+/* LAN rooms that did not answer this many scans in a row
+ * are dropped from the cached room list */
+#define NETPLAY_ROOM_LAN_MAX_MISSED  2
+
 enum rarch_netplay_discovery_ctl_state
 {
     RARCH_NETPLAY_DISCOVERY_CTL_NONE = 0,
     RARCH_NETPLAY_DISCOVERY_CTL_LAN_SEND_QUERY,
     RARCH_NETPLAY_DISCOVERY_CTL_LAN_GET_RESPONSES,
-    RARCH_NETPLAY_DISCOVERY_CTL_LAN_CLEAR_RESPONSES
+    RARCH_NETPLAY_DISCOVERY_CTL_LAN_CLEAR_RESPONSES,
+    /* Like GET_RESPONSES, but waits up to *(unsigned*)data
+     * microseconds for the next reply */
+    RARCH_NETPLAY_DISCOVERY_CTL_LAN_WAIT_RESPONSES
 };
 
 struct netplay_host
 {
-   struct sockaddr addr;
+   struct sockaddr_storage addr;
    socklen_t addrlen;
    int  content_crc;
    int  port;
-   char address[NETPLAY_HOST_STR_LEN];
+   int  latency; /* Query to reply time in ms */
+   char address[NETPLAY_HOST_LONGSTR_LEN];
    char nick[NETPLAY_HOST_STR_LEN];
    char frontend[NETPLAY_HOST_STR_LEN];
    char core[NETPLAY_HOST_STR_LEN];
@@ -71,6 +88,8 @@ struct netplay_room
    int  gamecrc;
    int  timestamp;
    int  host_method;
+   int  latency;      /* Measured round trip in ms, -1 if unknown */
+   int  missed_scans; /* LAN rooms only */
    char country           [3];
    char retroarch_version [33];
    char nickname          [33];
@@ -102,4 +121,33 @@ bool netplay_discovery_driver_ctl(enum rarch_netplay_discovery_ctl_state state,
 
 struct netplay_room* netplay_get_host_room(void);
 
+/**
+ * netplay_room_list_update:
+ * @rooms            : freshly fetched rooms.
+ * @count            : number of entries in @rooms.
+ * @lan              : true if @rooms come from a LAN scan,
+ *                     false if from the lobby server.
+ *
+ * Replaces the LAN or the internet part of netplay_room_list and
+ * keeps the other one, so both sources can refresh independently.
+ * Latencies measured for rooms that are still listed are kept,
+ * internet rooms that are also reachable on the LAN are hidden,
+ * and the list is sorted by latency.
+ **/
+void netplay_room_list_update(const struct netplay_room *rooms,
+      int count, bool lan);
+
+/**
+ * netplay_room_list_set_latency:
+ *
+ * Records the round trip measured to @address:@port for every
+ * room that is joined through it, then re-sorts the list.
+ **/
+void netplay_room_list_set_latency(const char *address, int port,
+      int latency);
+
+/* Address and port a client connects to when joining @room */
+void netplay_room_get_connect_address(const struct netplay_room *room,
+      const char **address, int *port);
+
 #endif
@@ -234,12 +234,21 @@ bool netplay_handshake_init_send(netplay_t *netplay,
 
    header[0] = htonl(NETPLAY_MAGIC);
    header[1] = htonl(netplay_platform_magic());
-   header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED);
+   /* A relay sends its spectators plain states and TCP input only */
+   if (connection->relayed)
+      header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED
+            & ~NETPLAY_COMPRESSION_XOR_DELTA);
+   else
+      header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED
+            | ((netplay->udp_fd >= 0) ? NETPLAY_FEATURE_UDP_INPUT : 0)
+            /* A relay passes CRCs on to spectators as they are */
+            | (netplay->is_relay ? 0 : NETPLAY_FEATURE_BLOCK_HASH
+               | NETPLAY_FEATURE_CHUNKED_STATE));
    header[3] = 0;
    header[4] = htonl(NETPLAY_PROTOCOL_VERSION);
    header[5] = htonl(netplay_impl_magic());
 
-   if (netplay->is_server &&
+   if (NETPLAY_IS_SERVER_END(netplay, connection) &&
        (settings->paths.netplay_password[0] ||
         settings->paths.netplay_spectate_password[0]))
    {
@@ -366,6 +375,14 @@ bool netplay_handshake_init(netplay_t *netplay,
 
    /* Check what compression is supported */
    compression  = ntohl(header[2]);
+
+   connection->udp_input = (netplay->udp_fd >= 0) && !connection->relayed
+      && (compression & NETPLAY_FEATURE_UDP_INPUT);
+   connection->block_hash = !connection->relayed && !netplay->is_relay
+      && (compression & NETPLAY_FEATURE_BLOCK_HASH);
+   connection->chunked_states = !connection->relayed && !netplay->is_relay
+      && (compression & NETPLAY_FEATURE_CHUNKED_STATE);
+
    compression &= NETPLAY_COMPRESSION_SUPPORTED;
 
    if (compression & NETPLAY_COMPRESSION_ZLIB)
@@ -391,6 +408,12 @@ bool netplay_handshake_init(netplay_t *netplay,
       connection->compression_supported = 0;
    }
 
+   connection->delta_savestates = (compression
+         & NETPLAY_COMPRESSION_XOR_DELTA) && !connection->relayed;
+   /* The streamed state is the reference for the delta that ends it */
+   connection->chunked_states   = connection->chunked_states
+      && connection->delta_savestates;
+
    if (!ctrans->decompression_backend)
       ctrans->decompression_backend = ctrans->compression_backend->reverse;
 
@@ -407,7 +430,8 @@ bool netplay_handshake_init(netplay_t *netplay,
    }
 
    /* If a password is demanded, ask for it */
-   if (!netplay->is_server && (connection->salt = ntohl(header[3])))
+   if (!NETPLAY_IS_SERVER_END(netplay, connection) &&
+         (connection->salt = ntohl(header[3])))
    {
 #ifdef HAVE_MENU
       menu_input_ctx_line_t line;
@@ -457,19 +481,27 @@ static void netplay_handshake_ready(netplay_t *netplay,
    char msg[512];
    msg[0] = '\0';
 
-   if (netplay->is_server)
+   if (NETPLAY_IS_SERVER_END(netplay, connection))
    {
-      unsigned slot = (unsigned)(connection - netplay->connections);
+      unsigned slot = connection->relayed
+         ? (unsigned)(connection - netplay->relay_connections)
+         : (unsigned)(connection - netplay->connections);
 
       netplay_log_connection(&connection->addr,
             slot, connection->nick, msg, sizeof(msg));
 
       RARCH_LOG("%s %u\n", msg_hash_to_str(MSG_CONNECTION_SLOT), slot);
 
-      /* Send them the savestate */
-      if (!(netplay->quirks &
+      /* Send them the savestate. A relay sends its spectators
+       * one of its own, see netplay_relay_poll. */
+      if (!connection->relayed && !(netplay->quirks &
                (NETPLAY_QUIRK_NO_SAVESTATES|NETPLAY_QUIRK_NO_TRANSMISSION)))
-         netplay->force_send_savestate = true;
+      {
+         if (connection->chunked_states)
+            connection->stream_pending    = true;
+         else
+            netplay->force_send_savestate = true;
+      }
    }
    else
    {
@@ -583,6 +615,15 @@ static bool netplay_handshake_sync(netplay_t *netplay,
    cmd[2]     = htonl(netplay->self_frame_count);
    client_num = (uint32_t)(connection - netplay->connections + 1);
 
+   /* A relay starts its spectators at the last frame it knows
+    * the state of. Our own client number is never a player, so
+    * no mode change we pass on can be mistaken for theirs. */
+   if (connection->relayed)
+   {
+      cmd[2]     = htonl(netplay->other_frame_count);
+      client_num = netplay->self_client_num;
+   }
+
    if (netplay->local_paused || netplay->remote_paused)
       client_num |= NETPLAY_CMD_SYNC_BIT_PAUSED;
 
@@ -673,6 +714,24 @@ static bool netplay_handshake_sync(netplay_t *netplay,
    autosave_unlock();
 #endif
 
+   /* Tell them where to send input over UDP, they'll answer from
+    * the address we should send ours to */
+   if (connection->udp_input)
+   {
+      uint32_t udp_info[2];
+
+      if (simple_rand_next == 1)
+         simple_srand((unsigned int) time(NULL));
+      connection->udp_token = simple_rand_uint32();
+
+      udp_info[0] = htonl(connection->udp_token);
+      udp_info[1] = htonl(netplay->udp_port);
+
+      if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_UDP_INFO,
+               udp_info, sizeof(udp_info)))
+         return false;
+   }
+
    /* Now we're ready! */
    connection->mode = NETPLAY_CONNECTION_SPECTATING;
    netplay_handshake_ready(netplay, connection);
@@ -702,7 +761,7 @@ static bool netplay_handshake_pre_nick(netplay_t *netplay,
        ntohl(nick_buf.cmd[0]) != NETPLAY_CMD_NICK ||
        ntohl(nick_buf.cmd[1]) != sizeof(nick_buf.nick))
    {
-      if (netplay->is_server)
+      if (NETPLAY_IS_SERVER_END(netplay, connection))
          strlcpy(msg, msg_hash_to_str(MSG_FAILED_TO_GET_NICKNAME_FROM_CLIENT),
             sizeof(msg));
       else
@@ -718,7 +777,7 @@ static bool netplay_handshake_pre_nick(netplay_t *netplay,
       (sizeof(connection->nick) < sizeof(nick_buf.nick)) ?
       sizeof(connection->nick) : sizeof(nick_buf.nick));
 
-   if (netplay->is_server)
+   if (NETPLAY_IS_SERVER_END(netplay, connection))
    {
       settings_t *settings = config_get_ptr();
 
@@ -769,7 +828,7 @@ static bool netplay_handshake_pre_password(netplay_t *netplay,
        ntohl(password_buf.cmd[0]) != NETPLAY_CMD_PASSWORD ||
        ntohl(password_buf.cmd[1]) != sizeof(password_buf.password))
    {
-      if (netplay->is_server)
+      if (NETPLAY_IS_SERVER_END(netplay, connection))
          strlcpy(msg, msg_hash_to_str(MSG_FAILED_TO_GET_NICKNAME_FROM_CLIENT),
             sizeof(msg));
       else
@@ -910,7 +969,7 @@ static bool netplay_handshake_pre_info(netplay_t *netplay,
    }
 
    /* Now switch to the right mode */
-   if (netplay->is_server)
+   if (NETPLAY_IS_SERVER_END(netplay, connection))
    {
       if (!netplay_handshake_sync(netplay, connection))
          return false;
@@ -1128,7 +1187,7 @@ static bool netplay_handshake_pre_sync(netplay_t *netplay,
    /* Ask to switch to playing mode if we should */
    {
       settings_t *settings = config_get_ptr();
-      if (!settings->bools.netplay_start_as_spectator)
+      if (!settings->bools.netplay_start_as_spectator && !netplay->is_relay)
          return netplay_cmd_mode(netplay, NETPLAY_CONNECTION_PLAYING);
    }
 
@@ -26,6 +26,8 @@
 #include <boolean.h>
 #include <compat/strl.h>
 #include <encodings/crc32.h>
+#include <memalign.h>
+#include <retro_endianness.h>
 
 #include <net/net_compat.h>
 #include <net/net_socket.h>
@@ -38,6 +40,7 @@
 #include "../../driver.h"
 #include "../../retroarch.h"
 #include "../../command.h"
+#include "../../memory_tags.h"
 #include "../../tasks/tasks_internal.h"
 
 #include "../../input/input_driver.h"
@@ -46,6 +49,15 @@
 #define HAVE_INET6 1
 #endif
 
+/* Scatter/gather sends, so a send buffer that wraps
+ * around still goes out in one syscall */
+#if !defined(HAVE_SOCKET_LEGACY) && (defined(__linux__) \
+      || defined(__APPLE__) || defined(__FreeBSD__) \
+      || defined(__OpenBSD__) || defined(__NetBSD__))
+#include <sys/uio.h>
+#define HAVE_NETPLAY_SENDMSG 1
+#endif
+
 #ifdef HAVE_DISCORD
 #include "../discord.h"
 
@@ -127,9 +139,10 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
          return false;
    }
 
-   delta->used  = true;
-   delta->frame = frame;
-   delta->crc   = 0;
+   delta->used       = true;
+   delta->frame      = frame;
+   delta->crc        = 0;
+   delta->crc_blocks = false;
 
    for (i = 0; i < MAX_INPUT_DEVICES; i++)
    {
@@ -155,6 +168,164 @@ static uint32_t netplay_delta_frame_crc(netplay_t *netplay,
          netplay->state_size);
 }
 
+/* Reads the data as little endian words, so
+ * both ends agree whatever their byte order */
+static uint32_t netplay_hash_data(const uint8_t *data, size_t len)
+{
+   size_t i;
+   uint64_t h = UINT64_C(0x9E3779B97F4A7C15) ^ len;
+
+   for (i = 0; i + 8 <= len; i += 8)
+   {
+      h  = (h ^ retro_get_unaligned_64le((void*)(data + i)))
+         * UINT64_C(0xFF51AFD7ED558CCD);
+      h ^= h >> 32;
+   }
+   for (; i < len; i++)
+      h  = (h ^ data[i]) * UINT64_C(0x100000001B3);
+
+   return (uint32_t)(h ^ (h >> 32));
+}
+
+static uint32_t netplay_hash_words(const uint32_t *words, size_t count)
+{
+   size_t i;
+   uint64_t h = UINT64_C(0x9E3779B97F4A7C15) ^ count;
+
+   for (i = 0; i < count; i++)
+   {
+      h  = (h ^ words[i]) * UINT64_C(0xFF51AFD7ED558CCD);
+      h ^= h >> 32;
+   }
+
+   return (uint32_t)(h ^ (h >> 32));
+}
+
+/**
+ * netplay_delta_frame_block_hash
+ *
+ * Get the block hash for the serialization of this frame, and
+ * its region hashes if @regions isn't NULL. Blocks that match the
+ * last state hashed keep their hash, so a state that changed
+ * little is mostly compared rather than hashed.
+ *
+ * Returns: the hash, never 0.
+ */
+static uint32_t netplay_delta_frame_block_hash(netplay_t *netplay,
+      struct delta_frame *delta, uint32_t *regions)
+{
+   size_t i;
+   uint32_t hash;
+   const uint8_t *state = (const uint8_t*)delta->state;
+   size_t size          = netplay->state_size;
+   size_t blocks        = (size + NETPLAY_HASH_BLOCK_SIZE - 1)
+      / NETPLAY_HASH_BLOCK_SIZE;
+   bool fresh           = netplay->hash_ref_size != size;
+
+   if (fresh)
+   {
+      free(netplay->hash_ref);
+      free(netplay->hash_blocks);
+      netplay->hash_ref      = (uint8_t*)malloc(size);
+      netplay->hash_blocks   = (uint32_t*)malloc(
+            blocks * sizeof(uint32_t));
+      netplay->hash_ref_size = 0;
+
+      if (!netplay->hash_ref || !netplay->hash_blocks)
+      {
+         free(netplay->hash_ref);
+         free(netplay->hash_blocks);
+         netplay->hash_ref    = NULL;
+         netplay->hash_blocks = NULL;
+         return 1;
+      }
+   }
+
+   for (i = 0; i < blocks; i++)
+   {
+      size_t offset = i * NETPLAY_HASH_BLOCK_SIZE;
+      size_t len    = MIN(NETPLAY_HASH_BLOCK_SIZE, size - offset);
+
+      if (!fresh && !memcmp(netplay->hash_ref + offset,
+               state + offset, len))
+         continue;
+
+      netplay->hash_blocks[i] = netplay_hash_data(state + offset, len);
+      memcpy(netplay->hash_ref + offset, state + offset, len);
+   }
+
+   netplay->hash_ref_size = size;
+
+   if (regions)
+   {
+      for (i = 0; i < NETPLAY_HASH_REGIONS; i++)
+      {
+         size_t first = i * blocks / NETPLAY_HASH_REGIONS;
+         size_t last  = (i + 1) * blocks / NETPLAY_HASH_REGIONS;
+         regions[i]   = netplay_hash_words(
+               netplay->hash_blocks + first, last - first);
+      }
+   }
+
+   hash = netplay_hash_words(netplay->hash_blocks, blocks);
+   return hash ? hash : 1;
+}
+
+/**
+ * netplay_frame_hash_matches
+ *
+ * Check the state of @delta against the hash the server sent for it.
+ * @regions are the server's region hashes if it sent a block hash,
+ * otherwise NULL and @hash is a CRC-32. Logs which parts of the state
+ * differ, where known.
+ */
+static bool netplay_frame_hash_matches(netplay_t *netplay,
+      struct delta_frame *delta, uint32_t hash, const uint32_t *regions)
+{
+   size_t i;
+   char msg[512];
+   uint32_t local_regions[NETPLAY_HASH_REGIONS];
+   size_t blocks     = (netplay->state_size + NETPLAY_HASH_BLOCK_SIZE - 1)
+      / NETPLAY_HASH_BLOCK_SIZE;
+   size_t msg_len    = 0;
+   uint32_t local    = 0;
+
+   if (!netplay->state_size)
+      return hash == 0;
+
+   if (!regions)
+      return netplay_delta_frame_crc(netplay, delta) == hash;
+
+   local = netplay_delta_frame_block_hash(netplay, delta, local_regions);
+   if (local == hash)
+      return true;
+
+   /* The state failed to hash locally */
+   if (!netplay->hash_blocks)
+      return true;
+
+   msg[0] = '\0';
+   for (i = 0; i < NETPLAY_HASH_REGIONS; i++)
+   {
+      size_t first, last;
+
+      if (local_regions[i] == regions[i])
+         continue;
+
+      first = i * blocks / NETPLAY_HASH_REGIONS * NETPLAY_HASH_BLOCK_SIZE;
+      last  = MIN((i + 1) * blocks / NETPLAY_HASH_REGIONS
+            * NETPLAY_HASH_BLOCK_SIZE, netplay->state_size);
+
+      if (msg_len < sizeof(msg))
+         msg_len += snprintf(msg + msg_len, sizeof(msg) - msg_len,
+               " 0x%X-0x%X", (unsigned)first, (unsigned)(last - 1));
+   }
+
+   RARCH_WARN("[Netplay]: State of frame %u differs from the host's in:%s\n",
+         delta->frame, msg);
+   return false;
+}
+
 /*
  * Free an input state list
  */
@@ -182,7 +353,7 @@ static void netplay_delta_frame_free(struct delta_frame *delta)
 
    if (delta->state)
    {
-      free(delta->state);
+      memalign_free_large(delta->state);
       delta->state = NULL;
    }
 
@@ -313,6 +484,18 @@ static size_t buf_remaining(struct socket_buffer *sbuf)
    return sbuf->bufsz - buf_used(sbuf) - 1;
 }
 
+/* Copy out part of the command being read, @offset bytes from
+ * its start, without consuming anything */
+static void buf_peek(struct socket_buffer *sbuf, size_t offset,
+      void *buf, size_t len)
+{
+   size_t i;
+   unsigned char *out = (unsigned char*)buf;
+
+   for (i = 0; i < len; i++)
+      out[i] = sbuf->data[(sbuf->start + offset + i) % sbuf->bufsz];
+}
+
 /**
  * netplay_init_socket_buffer
  *
@@ -326,6 +509,7 @@ static bool netplay_init_socket_buffer(
       return false;
    sbuf->bufsz = size;
    sbuf->start = sbuf->read = sbuf->end = 0;
+   sbuf->total = 0;
    return true;
 }
 
@@ -392,6 +576,52 @@ static void netplay_clear_socket_buffer(struct socket_buffer *sbuf)
 }
 #endif
 
+#ifdef HAVE_NETPLAY_SENDMSG
+/* Like socket_send_all_(non)blocking, for the two halves of a
+ * wrapped send buffer. Returns the number of bytes sent or -1. */
+static ssize_t netplay_send_iov(int sockfd, struct iovec *iov,
+      size_t iovcnt, bool block)
+{
+   struct msghdr msg;
+   ssize_t sent = 0;
+
+   memset(&msg, 0, sizeof(msg));
+   msg.msg_iov    = iov;
+   msg.msg_iovlen = iovcnt;
+
+   while (msg.msg_iovlen)
+   {
+      ssize_t ret = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+
+      if (ret <= 0)
+      {
+         if (ret < 0 && !isagain((int)ret))
+            return -1;
+         if (block)
+            continue;
+         break;
+      }
+
+      sent += ret;
+
+      /* Skip over whatever went out */
+      while (msg.msg_iovlen && (size_t)ret >= msg.msg_iov->iov_len)
+      {
+         ret -= msg.msg_iov->iov_len;
+         msg.msg_iov++;
+         msg.msg_iovlen--;
+      }
+      if (msg.msg_iovlen)
+      {
+         msg.msg_iov->iov_base = (char*)msg.msg_iov->iov_base + ret;
+         msg.msg_iov->iov_len -= ret;
+      }
+   }
+
+   return sent;
+}
+#endif
+
 /**
  * netplay_send
  *
@@ -402,6 +632,8 @@ bool netplay_send(
       int sockfd, const void *buf,
       size_t len)
 {
+   sbuf->total += len;
+
    if (buf_remaining(sbuf) < len)
    {
       /* Need to force a blocking send */
@@ -485,6 +717,24 @@ bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
    else
    {
       /* Unusual case: Buffer overlaps break */
+#ifdef HAVE_NETPLAY_SENDMSG
+      struct iovec iov[2];
+
+      iov[0].iov_base = sbuf->data + sbuf->start;
+      iov[0].iov_len  = sbuf->bufsz - sbuf->start;
+      iov[1].iov_base = sbuf->data;
+      iov[1].iov_len  = sbuf->end;
+
+      sent = netplay_send_iov(sockfd, iov, sbuf->end ? 2 : 1, block);
+      if (sent < 0)
+         return false;
+
+      sbuf->start += sent;
+      if (sbuf->start >= sbuf->bufsz)
+         sbuf->start -= sbuf->bufsz;
+      if (sbuf->start == sbuf->end)
+         sbuf->start = sbuf->end = 0;
+#else
       if (block)
       {
          if (!socket_send_all_blocking(
@@ -513,7 +763,7 @@ bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
             return netplay_send_flush(sbuf, sockfd, false);
          }
       }
-
+#endif
    }
 
    return true;
@@ -531,6 +781,14 @@ ssize_t netplay_recv(struct socket_buffer *sbuf, int sockfd, void *buf,
 {
    ssize_t recvd;
    bool error    = false;
+#if defined(__linux__) && defined(TCP_QUICKACK)
+   uint64_t prev = sbuf->total;
+#endif
+
+   /* Commands are read field by field, only go to the socket
+    * if what's buffered doesn't cover this one */
+   if (buf_unread(sbuf) >= len)
+      goto copy;
 
    /* Receive whatever we can into the buffer */
    if (sbuf->end >= sbuf->start)
@@ -542,7 +800,8 @@ ssize_t netplay_recv(struct socket_buffer *sbuf, int sockfd, void *buf,
       if (recvd < 0 || error)
          return -1;
 
-      sbuf->end += recvd;
+      sbuf->end   += recvd;
+      sbuf->total += recvd;
 
       if (sbuf->end >= sbuf->bufsz)
       {
@@ -554,7 +813,8 @@ ssize_t netplay_recv(struct socket_buffer *sbuf, int sockfd, void *buf,
          if (recvd < 0 || error)
             return -1;
 
-         sbuf->end += recvd;
+         sbuf->end   += recvd;
+         sbuf->total += recvd;
       }
    }
    else
@@ -566,9 +826,22 @@ ssize_t netplay_recv(struct socket_buffer *sbuf, int sockfd, void *buf,
       if (recvd < 0 || error)
          return -1;
 
-      sbuf->end += recvd;
+      sbuf->end   += recvd;
+      sbuf->total += recvd;
+   }
+
+   /* Don't let our ACKs wait for data going the other way,
+    * the kernel drops out of quick ACK mode by itself */
+#if defined(__linux__) && defined(TCP_QUICKACK)
+   if (sbuf->total != prev)
+   {
+      int flag = 1;
+      setsockopt(sockfd, IPPROTO_TCP, TCP_QUICKACK,
+            (const void*)&flag, sizeof(flag));
    }
+#endif
 
+copy:
    /* Now copy it into the reader */
    if (sbuf->end >= sbuf->read || (sbuf->bufsz - sbuf->read) >= len)
    {
@@ -612,7 +885,8 @@ ssize_t netplay_recv(struct socket_buffer *sbuf, int sockfd, void *buf,
          if (!socket_receive_all_blocking(
                   sockfd, (unsigned char *)buf + recvd, len - recvd))
             return -1;
-         recvd = len;
+         sbuf->total += len - recvd;
+         recvd        = len;
       }
    }
 
@@ -648,19 +922,58 @@ void netplay_recv_flush(struct socket_buffer *sbuf)
  */
 static bool netplay_cmd_crc(netplay_t *netplay, struct delta_frame *delta)
 {
-   size_t i;
+   size_t i, j;
    uint32_t payload[2];
-   bool success = true;
-
-   payload[0]   = htonl(delta->frame);
-   payload[1]   = htonl(delta->crc);
+   uint32_t block_payload[2 + NETPLAY_HASH_REGIONS];
+   bool have_crc    = false;
+   bool have_blocks = false;
+   bool success     = true;
 
+   /* Peers that understand block hashes get those, the
+    * rest a CRC-32; each is only computed if needed. */
    for (i = 0; i < netplay->connections_size; i++)
    {
-      if (netplay->connections[i].active &&
-            netplay->connections[i].mode >= NETPLAY_CONNECTION_CONNECTED)
-         success = netplay_send_raw_cmd(netplay, &netplay->connections[i],
-            NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      if (connection->block_hash)
+      {
+         if (!have_blocks)
+         {
+            uint32_t hash = 0;
+
+            memset(block_payload, 0, sizeof(block_payload));
+            if (netplay->state_size)
+               hash = netplay_delta_frame_block_hash(netplay, delta,
+                     block_payload + 2);
+
+            block_payload[0] = htonl(delta->frame);
+            block_payload[1] = htonl(hash);
+            for (j = 2; j < ARRAY_SIZE(block_payload); j++)
+               block_payload[j] = htonl(block_payload[j]);
+            have_blocks      = true;
+         }
+
+         success = netplay_send_raw_cmd(netplay, connection,
+               NETPLAY_CMD_CRC, block_payload, sizeof(block_payload))
+            && success;
+      }
+      else
+      {
+         if (!have_crc)
+         {
+            payload[0] = htonl(delta->frame);
+            payload[1] = htonl(netplay->state_size
+                  ? netplay_delta_frame_crc(netplay, delta) : 0);
+            have_crc   = true;
+         }
+
+         success = netplay_send_raw_cmd(netplay, connection,
+               NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
+      }
    }
    return success;
 }
@@ -1175,6 +1488,26 @@ bool netplay_resolve_input(netplay_t *netplay, size_t sim_ptr, bool resim)
    return ret;
 }
 
+/**
+ * netplay_frame_hash_needs_state
+ * @netplay              : pointer to netplay object
+ * @delta                : frame to check
+ *
+ * Returns: true if the CRC check of @delta, now or later,
+ * will need its savestate.
+ */
+static bool netplay_frame_hash_needs_state(netplay_t *netplay,
+      const struct delta_frame *delta)
+{
+   if (netplay->is_server)
+      return netplay->check_frames &&
+         delta->frame % abs(netplay->check_frames) == 0;
+
+   /* We don't know the server's check interval,
+    * a CRC may arrive for any frame. */
+   return netplay->crcs_valid;
+}
+
 static void netplay_handle_frame_hash(netplay_t *netplay,
       struct delta_frame *delta)
 {
@@ -1182,22 +1515,13 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
    {
       if (netplay->check_frames &&
           delta->frame % abs(netplay->check_frames) == 0)
-      {
-         if (netplay->state_size)
-            delta->crc = netplay_delta_frame_crc(netplay, delta);
-         else
-            delta->crc = 0;
          netplay_cmd_crc(netplay, delta);
-      }
    }
    else if (delta->crc && netplay->crcs_valid)
    {
       /* We have a remote CRC, so check it */
-      uint32_t local_crc = 0;
-      if (netplay->state_size)
-         local_crc = netplay_delta_frame_crc(netplay, delta);
-
-      if (local_crc != delta->crc)
+      if (!netplay_frame_hash_matches(netplay, delta, delta->crc,
+               delta->crc_blocks ? delta->crc_regions : NULL))
       {
          /* If the very first check frame is wrong,
           * they probably just don't work */
@@ -1221,206 +1545,441 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
 }
 
 /**
- * netplay_sync_pre_frame
- * @netplay              : pointer to netplay object
+ * netplay_accept
+ * @listen_fd            : listening socket
+ * @addr                 : where to store the peer's address
  *
- * Pre-frame for Netplay synchronization.
+ * Accept a waiting connection, if there is one.
+ *
+ * Returns: the new nonblocking socket, or -1 if nobody
+ * connected or the connection couldn't be set up.
  */
-bool netplay_sync_pre_frame(netplay_t *netplay)
+static int netplay_accept(int listen_fd, struct sockaddr_storage *addr)
 {
-   retro_ctx_serialize_info_t serial_info;
-
-   if (netplay_delta_frame_ready(netplay,
-            &netplay->buffer[netplay->run_ptr], netplay->run_frame_count))
+   fd_set fds;
+   struct timeval tmp_tv = {0};
+   int new_fd;
+   socklen_t addr_size;
+
+   /* Check for a connection */
+   FD_ZERO(&fds);
+   FD_SET(listen_fd, &fds);
+   if (socket_select(listen_fd + 1,
+            &fds, NULL, NULL, &tmp_tv) <= 0 ||
+       !FD_ISSET(listen_fd, &fds))
+      return -1;
+
+   addr_size = sizeof(*addr);
+   new_fd = accept(listen_fd, (struct sockaddr*)addr, &addr_size);
+
+   if (new_fd < 0)
    {
-      serial_info.data_const = NULL;
-      serial_info.data       = netplay->buffer[netplay->run_ptr].state;
-      serial_info.size       = netplay->state_size;
-
-      memset(serial_info.data, 0, serial_info.size);
-      if ((netplay->quirks & NETPLAY_QUIRK_INITIALIZATION)
-            || netplay->run_frame_count == 0)
-      {
-         /* Don't serialize until it's safe */
-      }
-      else if (!(netplay->quirks & NETPLAY_QUIRK_NO_SAVESTATES)
-            && core_serialize(&serial_info))
-      {
-         if (netplay->force_send_savestate && !netplay->stall
-               && !netplay->remote_paused)
-         {
-            /* Bring our running frame and input frames into
-             * parity so we don't send old info. */
-            if (netplay->run_ptr != netplay->self_ptr)
-            {
-               memcpy(netplay->buffer[netplay->self_ptr].state,
-                  netplay->buffer[netplay->run_ptr].state,
-                  netplay->state_size);
-               netplay->run_ptr         = netplay->self_ptr;
-               netplay->run_frame_count = netplay->self_frame_count;
-            }
-
-            /* Send this along to the other side */
-            serial_info.data_const = netplay->buffer[netplay->run_ptr].state;
-            netplay_load_savestate(netplay, &serial_info, false);
-            netplay->force_send_savestate = false;
-         }
-      }
-      else
-      {
-         /* If the core can't serialize properly, we must stall for the
-          * remote input on EVERY frame, because we can't recover */
-         netplay->quirks |= NETPLAY_QUIRK_NO_SAVESTATES;
-         netplay->stateless_mode = true;
-      }
-
-      /* If we can't transmit savestates, we must stall
-       * until the client is ready. */
-      if (netplay->run_frame_count > 0 &&
-          (netplay->quirks & (NETPLAY_QUIRK_NO_SAVESTATES|NETPLAY_QUIRK_NO_TRANSMISSION)) &&
-          (netplay->connections_size == 0 || !netplay->connections[0].active ||
-           netplay->connections[0].mode < NETPLAY_CONNECTION_CONNECTED))
-         netplay->stall = NETPLAY_STALL_NO_CONNECTION;
+      RARCH_ERR("%s\n", msg_hash_to_str(MSG_NETPLAY_FAILED));
+      return -1;
    }
 
-   if (netplay->is_server)
+   /* Set the socket nonblocking */
+   if (!socket_nonblock(new_fd))
    {
-      fd_set fds;
-      struct timeval tmp_tv = {0};
-      int new_fd;
-      struct sockaddr_storage their_addr;
-      socklen_t addr_size;
-      struct netplay_connection *connection;
-      size_t connection_num;
-
-      /* Check for a connection */
-      FD_ZERO(&fds);
-      FD_SET(netplay->listen_fd, &fds);
-      if (socket_select(netplay->listen_fd + 1,
-               &fds, NULL, NULL, &tmp_tv) > 0 &&
-          FD_ISSET(netplay->listen_fd, &fds))
-      {
-         addr_size = sizeof(their_addr);
-         new_fd = accept(netplay->listen_fd,
-               (struct sockaddr*)&their_addr, &addr_size);
-
-         if (new_fd < 0)
-         {
-            RARCH_ERR("%s\n", msg_hash_to_str(MSG_NETPLAY_FAILED));
-            goto process;
-         }
-
-         /* Set the socket nonblocking */
-         if (!socket_nonblock(new_fd))
-         {
-            /* Catastrophe! */
-            socket_close(new_fd);
-            goto process;
-         }
+      /* Catastrophe! */
+      socket_close(new_fd);
+      return -1;
+   }
 
 #if defined(IPPROTO_TCP) && defined(TCP_NODELAY)
-         {
-            int flag = 1;
-            if (setsockopt(new_fd, IPPROTO_TCP, TCP_NODELAY,
+   {
+      int flag = 1;
+      if (setsockopt(new_fd, IPPROTO_TCP, TCP_NODELAY,
 #ifdef _WIN32
-               (const char*)
+         (const char*)
 #else
-               (const void*)
+         (const void*)
 #endif
-               &flag,
-               sizeof(int)) < 0)
-               RARCH_WARN("Could not set netplay TCP socket to nodelay. Expect jitter.\n");
-         }
+         &flag,
+         sizeof(int)) < 0)
+         RARCH_WARN("Could not set netplay TCP socket to nodelay. Expect jitter.\n");
+   }
 #endif
 
 #if defined(F_SETFD) && defined(FD_CLOEXEC)
-         /* Don't let any inherited processes keep open our port */
-         if (fcntl(new_fd, F_SETFD, FD_CLOEXEC) < 0)
-            RARCH_WARN("Cannot set Netplay port to close-on-exec. It may fail to reopen if the client disconnects.\n");
+   /* Don't let any inherited processes keep open our port */
+   if (fcntl(new_fd, F_SETFD, FD_CLOEXEC) < 0)
+      RARCH_WARN("Cannot set Netplay port to close-on-exec. It may fail to reopen if the client disconnects.\n");
 #endif
 
-         /* Allocate a connection */
-         for (connection_num = 0; connection_num < netplay->connections_size; connection_num++)
-            if (!netplay->connections[connection_num].active &&
-                  netplay->connections[connection_num].mode != NETPLAY_CONNECTION_DELAYED_DISCONNECT)
-               break;
-         if (connection_num == netplay->connections_size)
-         {
-            if (connection_num == 0)
-            {
-               netplay->connections = (struct netplay_connection*)
-                  malloc(sizeof(struct netplay_connection));
+   return new_fd;
+}
 
-               if (!netplay->connections)
-               {
-                  socket_close(new_fd);
-                  goto process;
-               }
-               netplay->connections_size = 1;
+/**
+ * netplay_new_connection
+ * @netplay              : pointer to netplay object
+ * @connections          : connection array to add to
+ * @connections_size     : size of @connections
+ * @fd                   : socket of the new connection
+ *
+ * Find or make room for a connection and set it up for the
+ * handshake. @fd is closed on failure.
+ *
+ * Returns: the new connection, or NULL on failure.
+ */
+static struct netplay_connection *netplay_new_connection(
+      netplay_t *netplay,
+      struct netplay_connection **connections, size_t *connections_size,
+      int fd)
+{
+   struct netplay_connection *connection;
+   size_t connection_num;
 
-            }
-            else
-            {
-               size_t new_connections_size = netplay->connections_size * 2;
-               struct netplay_connection
-                  *new_connections         = (struct netplay_connection*)
+   /* Allocate a connection */
+   for (connection_num = 0; connection_num < *connections_size; connection_num++)
+      if (!(*connections)[connection_num].active &&
+            (*connections)[connection_num].mode != NETPLAY_CONNECTION_DELAYED_DISCONNECT)
+         break;
+   if (connection_num == *connections_size)
+   {
+      if (connection_num == 0)
+      {
+         *connections = (struct netplay_connection*)
+            malloc(sizeof(struct netplay_connection));
 
-                  realloc(netplay->connections,
-                     new_connections_size*sizeof(struct netplay_connection));
+         if (!*connections)
+         {
+            socket_close(fd);
+            return NULL;
+         }
+         *connections_size = 1;
 
-               if (!new_connections)
-               {
-                  socket_close(new_fd);
-                  goto process;
-               }
+      }
+      else
+      {
+         size_t new_connections_size = *connections_size * 2;
+         struct netplay_connection
+            *new_connections         = (struct netplay_connection*)
 
-               memset(new_connections + netplay->connections_size, 0,
-                  netplay->connections_size * sizeof(struct netplay_connection));
-               netplay->connections = new_connections;
-               netplay->connections_size = new_connections_size;
+            realloc(*connections,
+               new_connections_size*sizeof(struct netplay_connection));
 
-            }
-         }
-         connection         = &netplay->connections[connection_num];
-
-         /* Set it up */
-         memset(connection, 0, sizeof(*connection));
-         connection->active = true;
-         connection->fd     = new_fd;
-         connection->mode   = NETPLAY_CONNECTION_INIT;
-
-         if (!netplay_init_socket_buffer(&connection->send_packet_buffer,
-               netplay->packet_buffer_size) ||
-             !netplay_init_socket_buffer(&connection->recv_packet_buffer,
-               netplay->packet_buffer_size))
+         if (!new_connections)
          {
-            if (connection->send_packet_buffer.data)
-               netplay_deinit_socket_buffer(&connection->send_packet_buffer);
-            connection->active = false;
-            socket_close(new_fd);
-            goto process;
+            socket_close(fd);
+            return NULL;
          }
 
-         netplay_handshake_init_send(netplay, connection);
+         memset(new_connections + *connections_size, 0,
+            *connections_size * sizeof(struct netplay_connection));
+         *connections      = new_connections;
+         *connections_size = new_connections_size;
 
       }
    }
+   connection         = &(*connections)[connection_num];
+
+   /* Set it up */
+   memset(connection, 0, sizeof(*connection));
+   connection->active = true;
+   connection->fd     = fd;
+   connection->mode   = NETPLAY_CONNECTION_INIT;
+
+   if (!netplay_init_socket_buffer(&connection->send_packet_buffer,
+         netplay->packet_buffer_size) ||
+       !netplay_init_socket_buffer(&connection->recv_packet_buffer,
+         netplay->packet_buffer_size))
+   {
+      if (connection->send_packet_buffer.data)
+         netplay_deinit_socket_buffer(&connection->send_packet_buffer);
+      connection->active = false;
+      socket_close(fd);
+      return NULL;
+   }
 
-process:
-   netplay->can_poll = true;
-   input_poll_net();
+   return connection;
+}
 
-   return (netplay->stall != NETPLAY_STALL_NO_CONNECTION);
+/* Compresses a state into netplay->zbuffer as this peer expects it */
+static bool netplay_compress_state(netplay_t *netplay,
+      struct netplay_connection *connection, const uint8_t *in,
+      uint32_t *wn)
+{
+   uint32_t rd;
+   struct compression_transcoder *ctrans =
+      (connection->compression_supported == NETPLAY_COMPRESSION_ZLIB)
+      ? &netplay->compress_zlib
+      : &netplay->compress_nil;
+
+   ctrans->compression_backend->set_in(ctrans->compression_stream,
+      in, (uint32_t)netplay->state_size);
+   ctrans->compression_backend->set_out(ctrans->compression_stream,
+      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+   return ctrans->compression_backend->trans(ctrans->compression_stream,
+      true, &rd, wn, NULL);
 }
 
 /**
- * netplay_sync_post_frame
+ * netplay_start_state_streams
  * @netplay              : pointer to netplay object
+ * @state                : the current state
  *
- * Post-frame for Netplay synchronization.
- * We check if we have new input and replay from recorded input.
+ * Start streaming the current state to peers that just joined. Peers
+ * the state can't be streamed to get it whole instead.
  */
-void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
+static void netplay_start_state_streams(netplay_t *netplay,
+      const uint8_t *state)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      uint32_t wn;
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active || !connection->stream_pending ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      connection->stream_pending = false;
+      connection->stream_ref     = (uint8_t*)malloc(netplay->state_size);
+
+      if (connection->stream_ref &&
+            netplay_compress_state(netplay, connection, state, &wn))
+         connection->stream_data = (uint8_t*)malloc(wn);
+
+      if (!connection->stream_data)
+      {
+         free(connection->stream_ref);
+         connection->stream_ref        = NULL;
+         netplay->force_send_savestate = true;
+         continue;
+      }
+
+      memcpy(connection->stream_ref, state, netplay->state_size);
+      memcpy(connection->stream_data, netplay->zbuffer, wn);
+      connection->stream_frame = netplay->run_frame_count;
+      connection->stream_size  = wn;
+      connection->stream_sent  = 0;
+      connection->stream_acked = 0;
+   }
+}
+
+/**
+ * netplay_send_state_chunks
+ * @netplay              : pointer to netplay object
+ *
+ * Send the next chunks of the states being streamed, as far as
+ * the peers have acknowledged the earlier ones.
+ */
+static void netplay_send_state_chunks(netplay_t *netplay)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active || !connection->stream_ref)
+         continue;
+
+      while (connection->stream_sent < connection->stream_size &&
+            connection->stream_sent - connection->stream_acked <
+            NETPLAY_STATE_CHUNK_SIZE * NETPLAY_STATE_CHUNK_WINDOW)
+      {
+         uint32_t header[6];
+         uint32_t len = MIN(NETPLAY_STATE_CHUNK_SIZE,
+               connection->stream_size - connection->stream_sent);
+
+         header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE_CHUNK);
+         header[1] = htonl(len + 4*sizeof(uint32_t));
+         header[2] = htonl(connection->stream_frame);
+         header[3] = htonl((uint32_t)netplay->state_size);
+         header[4] = htonl(connection->stream_size);
+         header[5] = htonl(connection->stream_sent);
+
+         if (!netplay_send(&connection->send_packet_buffer, connection->fd,
+                  header, sizeof(header)) ||
+             !netplay_send(&connection->send_packet_buffer, connection->fd,
+                  connection->stream_data + connection->stream_sent, len))
+         {
+            netplay_hangup(netplay, connection);
+            break;
+         }
+
+         connection->stream_sent += len;
+      }
+   }
+}
+
+/* Is there a streamed state the peer has all of? */
+static bool netplay_state_streams_done(netplay_t *netplay)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      if (connection->active && connection->stream_ref &&
+            connection->stream_acked == connection->stream_size)
+         return true;
+   }
+
+   return false;
+}
+
+/**
+ * netplay_finish_state_streams
+ * @netplay              : pointer to netplay object
+ * @state                : the current state
+ *
+ * Bring the peers that received a streamed state up to date, by
+ * sending the current state as a delta against the streamed one.
+ */
+static void netplay_finish_state_streams(netplay_t *netplay,
+      const uint8_t *state)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      bool compressed;
+      uint32_t header[4];
+      uint32_t wn = 0;
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active || !connection->stream_ref ||
+            connection->stream_acked != connection->stream_size)
+         continue;
+
+      netplay_xor_state(connection->stream_ref, state,
+            connection->stream_ref, netplay->state_size);
+      compressed = netplay_compress_state(netplay, connection,
+            connection->stream_ref, &wn);
+
+      free(connection->stream_data);
+      free(connection->stream_ref);
+      connection->stream_data = NULL;
+      connection->stream_ref  = NULL;
+
+      header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+      header[1] = htonl(wn + 2*sizeof(uint32_t));
+      header[2] = htonl(netplay->run_frame_count);
+      header[3] = htonl((uint32_t)netplay->state_size);
+
+      if (!compressed ||
+          !netplay_send(&connection->send_packet_buffer, connection->fd,
+               header, sizeof(header)) ||
+          !netplay_send(&connection->send_packet_buffer, connection->fd,
+               netplay->zbuffer, wn))
+         netplay_hangup(netplay, connection);
+      else
+         connection->stats.savestates_sent++;
+   }
+}
+
+/**
+ * netplay_sync_pre_frame
+ * @netplay              : pointer to netplay object
+ *
+ * Pre-frame for Netplay synchronization.
+ */
+bool netplay_sync_pre_frame(netplay_t *netplay)
+{
+   retro_ctx_serialize_info_t serial_info;
+
+   if (netplay_delta_frame_ready(netplay,
+            &netplay->buffer[netplay->run_ptr], netplay->run_frame_count))
+   {
+      serial_info.data_const = NULL;
+      serial_info.data       = netplay->buffer[netplay->run_ptr].state;
+      serial_info.size       = netplay->state_size;
+
+      memset(serial_info.data, 0, serial_info.size);
+      if ((netplay->quirks & NETPLAY_QUIRK_INITIALIZATION)
+            || netplay->run_frame_count == 0)
+      {
+         /* Don't serialize until it's safe */
+      }
+      else if (!(netplay->quirks & NETPLAY_QUIRK_NO_SAVESTATES)
+            && core_serialize(&serial_info))
+      {
+         bool streams_done = netplay_state_streams_done(netplay);
+
+         if ((netplay->force_send_savestate || streams_done)
+               && !netplay->stall && !netplay->remote_paused)
+         {
+            /* Bring our running frame and input frames into
+             * parity so we don't send old info. */
+            if (netplay->run_ptr != netplay->self_ptr)
+            {
+               memcpy(netplay->buffer[netplay->self_ptr].state,
+                  netplay->buffer[netplay->run_ptr].state,
+                  netplay->state_size);
+               netplay->run_ptr         = netplay->self_ptr;
+               netplay->run_frame_count = netplay->self_frame_count;
+            }
+
+            /* Send this along to the other side */
+            serial_info.data_const = netplay->buffer[netplay->run_ptr].state;
+            if (netplay->force_send_savestate)
+            {
+               netplay_load_savestate(netplay, &serial_info, false);
+               netplay->force_send_savestate = false;
+            }
+            if (streams_done)
+               netplay_finish_state_streams(netplay,
+                     (const uint8_t*)serial_info.data_const);
+         }
+
+         netplay_start_state_streams(netplay,
+               (const uint8_t*)netplay->buffer[netplay->run_ptr].state);
+      }
+      else
+      {
+         /* If the core can't serialize properly, we must stall for the
+          * remote input on EVERY frame, because we can't recover */
+         netplay->quirks |= NETPLAY_QUIRK_NO_SAVESTATES;
+         netplay->stateless_mode = true;
+      }
+
+      /* If we can't transmit savestates, we must stall
+       * until the client is ready. */
+      if (netplay->run_frame_count > 0 &&
+          (netplay->quirks & (NETPLAY_QUIRK_NO_SAVESTATES|NETPLAY_QUIRK_NO_TRANSMISSION)) &&
+          (netplay->connections_size == 0 || !netplay->connections[0].active ||
+           netplay->connections[0].mode < NETPLAY_CONNECTION_CONNECTED))
+         netplay->stall = NETPLAY_STALL_NO_CONNECTION;
+   }
+
+   if (netplay->is_server)
+   {
+      struct sockaddr_storage their_addr;
+      struct netplay_connection *connection;
+      int new_fd = netplay_accept(netplay->listen_fd, &their_addr);
+
+      netplay_send_state_chunks(netplay);
+
+      if (new_fd >= 0)
+      {
+         connection = netplay_new_connection(netplay,
+               &netplay->connections, &netplay->connections_size, new_fd);
+         if (connection)
+            netplay_handshake_init_send(netplay, connection);
+      }
+   }
+   else if (netplay->is_relay)
+      netplay_relay_poll(netplay);
+
+   netplay->can_poll = true;
+   input_poll_net();
+
+   return (netplay->stall != NETPLAY_STALL_NO_CONNECTION);
+}
+
+/**
+ * netplay_sync_post_frame
+ * @netplay              : pointer to netplay object
+ *
+ * Post-frame for Netplay synchronization.
+ * We check if we have new input and replay from recorded input.
+ */
+void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 {
    uint32_t lo_frame_count, hi_frame_count;
 
@@ -1512,6 +2071,8 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
        netplay->replay_frame_count < netplay->run_frame_count)
    {
       retro_ctx_serialize_info_t serial_info;
+      uint32_t rollback_frames = netplay->run_frame_count
+         - netplay->replay_frame_count;
 
       /* Replay frames. */
       netplay->is_replay = true;
@@ -1558,11 +2119,26 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 
          start                   = cpu_features_get_time_usec();
 
-         /* Remember the current state */
-         memset(serial_info.data, 0, serial_info.size);
-         core_serialize(&serial_info);
-         if (netplay->replay_frame_count < netplay->unread_frame_count)
+         /* Remember the current state. Frames before
+          * unread_frame_count now have everyone's real input,
+          * so no later rollback can start from them; only the
+          * CRC check may still need their state. */
+         if (netplay->replay_frame_count >= netplay->unread_frame_count)
+         {
+            memset(serial_info.data, 0, serial_info.size);
+            core_serialize(&serial_info);
+         }
+         else
+         {
+            if (netplay_frame_hash_needs_state(netplay, ptr))
+            {
+               memset(serial_info.data, 0, serial_info.size);
+               core_serialize(&serial_info);
+            }
+            else
+               netplay->rollback_saves_skipped++;
             netplay_handle_frame_hash(netplay, ptr);
+         }
 
          /* Re-simulate this frame's input */
          netplay_resolve_input(netplay, netplay->replay_ptr, true);
@@ -1606,6 +2182,12 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
       /* Average our time */
       netplay->frame_run_time_avg   = netplay->frame_run_time_sum / NETPLAY_FRAME_RUN_TIME_WINDOW;
 
+      netplay->rollback_count++;
+      netplay->rollback_frames     += rollback_frames;
+      netplay->rollback_last        = rollback_frames;
+      if (rollback_frames > netplay->rollback_max)
+         netplay->rollback_max      = rollback_frames;
+
       if (netplay->unread_frame_count < netplay->run_frame_count)
       {
          netplay->other_ptr         = netplay->unread_ptr;
@@ -1785,6 +2367,27 @@ static void remote_unpaused(netplay_t *netplay,
  *
  * Disconnects an active Netplay connection due to an error
  */
+/**
+ * netplay_relay_hangup
+ *
+ * Drop a spectator connected to our relay. Unlike the host's
+ * peers, none of them has any part in the game.
+ */
+static void netplay_relay_hangup(netplay_t *netplay,
+      struct netplay_connection *connection)
+{
+   if (!connection->active)
+      return;
+
+   RARCH_LOG("[netplay] Relay: spectator \"%s\" disconnected.\n",
+         connection->nick);
+
+   socket_close(connection->fd);
+   connection->active = false;
+   netplay_deinit_socket_buffer(&connection->send_packet_buffer);
+   netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
+}
+
 void netplay_hangup(netplay_t *netplay,
       struct netplay_connection *connection)
 {
@@ -1796,6 +2399,11 @@ void netplay_hangup(netplay_t *netplay,
       return;
    if (!connection->active)
       return;
+   if (connection->relayed)
+   {
+      netplay_relay_hangup(netplay, connection);
+      return;
+   }
 
    msg[0] = msg[sizeof(msg)-1] = '\0';
    dmsg = msg;
@@ -1825,9 +2433,17 @@ void netplay_hangup(netplay_t *netplay,
    runloop_msg_queue_push(dmsg, 1, 180, false, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
 
    socket_close(connection->fd);
-   connection->active = false;
+   connection->active         = false;
+   connection->delta_ref_sent = false;
    netplay_deinit_socket_buffer(&connection->send_packet_buffer);
    netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
+   free(connection->delta_ref);
+   connection->delta_ref      = NULL;
+   free(connection->stream_data);
+   free(connection->stream_ref);
+   connection->stream_data    = NULL;
+   connection->stream_ref     = NULL;
+   connection->stream_pending = false;
 
    if (!netplay->is_server)
    {
@@ -1843,6 +2459,10 @@ void netplay_hangup(netplay_t *netplay,
          netplay->device_clients[i] &= (1L<<netplay->self_client_num);
       netplay->stall = NETPLAY_STALL_NONE;
 
+      /* Nothing left to relay */
+      for (i = 0; i < netplay->relay_connections_size; i++)
+         netplay_relay_hangup(netplay, &netplay->relay_connections[i]);
+
    }
    else
    {
@@ -1873,6 +2493,116 @@ void netplay_hangup(netplay_t *netplay,
       remote_unpaused(netplay, connection);
 }
 
+/**
+ * netplay_update_connection_stats
+ * @netplay              : pointer to netplay object
+ *
+ * Counts stalls per peer every frame and, every
+ * NETPLAY_STATS_INTERVAL_USEC, samples throughput and RTT.
+ */
+void netplay_update_connection_stats(netplay_t *netplay)
+{
+   size_t i;
+   retro_time_t now = cpu_features_get_time_usec();
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      bool stalled;
+      retro_time_t elapsed;
+      struct netplay_connection *connection = &netplay->connections[i];
+      struct netplay_connection_stats *stats = &connection->stats;
+
+      if (!connection->active)
+         continue;
+
+      /* A client only stalls on the server, whatever the reason */
+      stalled = connection->stall != NETPLAY_STALL_NONE ||
+         (!netplay->is_server && netplay->stall != NETPLAY_STALL_NONE
+          && netplay->stall != NETPLAY_STALL_NO_CONNECTION);
+      if (stalled)
+      {
+         if (!stats->stalled)
+            stats->stalls++;
+         stats->stall_frames++;
+      }
+      stats->stalled = stalled;
+
+      if (!stats->sample_time)
+      {
+         stats->sample_time = now;
+         stats->sample_in   = connection->recv_packet_buffer.total;
+         stats->sample_out  = connection->send_packet_buffer.total;
+         continue;
+      }
+
+      elapsed = now - stats->sample_time;
+      if (elapsed < NETPLAY_STATS_INTERVAL_USEC)
+         continue;
+
+      stats->rate_in     = (uint32_t)((connection->recv_packet_buffer.total
+            - stats->sample_in) * 1000000 / elapsed);
+      stats->rate_out    = (uint32_t)((connection->send_packet_buffer.total
+            - stats->sample_out) * 1000000 / elapsed);
+      stats->sample_time = now;
+      stats->sample_in   = connection->recv_packet_buffer.total;
+      stats->sample_out  = connection->send_packet_buffer.total;
+
+#if defined(__linux__) && defined(TCP_INFO)
+      {
+         struct tcp_info info;
+         socklen_t info_len = sizeof(info);
+
+         if (!getsockopt(connection->fd, IPPROTO_TCP, TCP_INFO,
+                  &info, &info_len) && info.tcpi_rtt)
+         {
+            unsigned bucket = info.tcpi_rtt
+               / (NETPLAY_RTT_HISTOGRAM_MS * 1000);
+            stats->rtt      = info.tcpi_rtt;
+            stats->rtt_var  = info.tcpi_rttvar;
+            stats->rtt_hist[MIN(bucket,
+                  NETPLAY_RTT_HISTOGRAM_BUCKETS - 1)]++;
+         }
+      }
+
+      /* Make sure the kernel can hold twice the bandwidth-delay
+       * product, so a frame's worth of data never has to wait in
+       * our own buffer. Only ever grows: setting it at all stops
+       * the kernel from tuning it. */
+      if (stats->rtt && stats->rate_out)
+      {
+         uint64_t bdp = (uint64_t)stats->rate_out
+            * (stats->rtt + 4 * stats->rtt_var) / 1000000;
+         int want     = (int)MIN(2 * bdp, NETPLAY_SNDBUF_MAX);
+         int cur      = 0;
+         socklen_t cur_len = sizeof(cur);
+
+         if (want > (int)stats->sndbuf
+               && !getsockopt(connection->fd, SOL_SOCKET, SO_SNDBUF,
+                  &cur, &cur_len)
+               && cur < want
+               && !setsockopt(connection->fd, SOL_SOCKET, SO_SNDBUF,
+                  &want, sizeof(want)))
+            stats->sndbuf = want;
+      }
+#endif
+   }
+}
+
+/**
+ * netplay_xor_state:
+ *
+ * XORs two savestates, to encode or decode a
+ * NETPLAY_CMD_LOAD_SAVESTATE_DELTA
+ */
+void netplay_xor_state(uint8_t *out, const uint8_t *a,
+      const uint8_t *b, size_t len)
+{
+   size_t i;
+
+   for (i = 0; i < len; i++)
+      out[i] = a[i] ^ b[i];
+}
+
 /**
  * netplay_delayed_state_change:
  *
@@ -1985,6 +2715,82 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
 #undef BUFSZ
 }
 
+/* Send our own input for the current frame and the ones before it
+ * over UDP. Lost packets are never resent, the TCP copy of the input
+ * follows anyway. */
+static void netplay_send_udp_input(netplay_t *netplay,
+      struct netplay_connection *connection)
+{
+   uint32_t packet[NETPLAY_UDP_PACKET_MAX];
+   uint32_t devices      = 0;
+   uint32_t frames       = 0;
+   size_t ptr            = netplay->self_ptr;
+   size_t used           = NETPLAY_UDP_HEADER;
+   uint32_t client_num   = netplay->self_client_num;
+
+   if (netplay->self_mode == NETPLAY_CONNECTION_PLAYING)
+   {
+      uint32_t input_size;
+
+      devices    = netplay->client_devices[client_num];
+      input_size = netplay_expected_input_size(netplay, devices);
+
+      /* Newest first, for as long as we still have the frames */
+      while (input_size
+            && frames < NETPLAY_UDP_REDUNDANCY
+            && frames <= netplay->self_frame_count
+            && used + input_size <= NETPLAY_UDP_PACKET_MAX)
+      {
+         uint32_t device;
+         struct delta_frame *dframe = &netplay->buffer[ptr];
+         size_t               start = used;
+
+         if (!dframe->used
+               || dframe->frame != netplay->self_frame_count - frames
+               || !dframe->have_real[client_num])
+            break;
+
+         for (device = 0; device < MAX_INPUT_DEVICES; device++)
+         {
+            size_t i;
+            netplay_input_state_t istate;
+            if (!(devices & (1<<device)))
+               continue;
+            istate = dframe->real_input[device];
+            while (istate && (!istate->used || istate->client_num != client_num))
+               istate = istate->next;
+            if (!istate)
+               break;
+            for (i = 0; i < istate->size; i++)
+               packet[used++] = htonl(istate->data[i]);
+         }
+
+         if (device < MAX_INPUT_DEVICES || used - start != input_size)
+         {
+            used = start;
+            break;
+         }
+
+         frames++;
+         ptr = PREV_PTR(ptr);
+      }
+   }
+
+   /* The client always sends, so that the server learns its address */
+   if (!frames && netplay->is_server)
+      return;
+
+   packet[0] = htonl(NETPLAY_UDP_MAGIC);
+   packet[1] = htonl(connection->udp_token);
+   packet[2] = htonl(client_num);
+   packet[3] = htonl(frames ? devices : 0);
+   packet[4] = htonl(netplay->self_frame_count);
+   packet[5] = htonl(frames);
+
+   sendto(netplay->udp_fd, (const char*)packet, used * sizeof(uint32_t), 0,
+         (struct sockaddr*)&connection->udp_addr, connection->udp_addrlen);
+}
+
 /**
  * netplay_send_cur_input
  *
@@ -2040,6 +2846,9 @@ bool netplay_send_cur_input(netplay_t *netplay,
          return false;
    }
 
+   if (connection->udp_ready)
+      netplay_send_udp_input(netplay, connection);
+
    if (!netplay_send_flush(&connection->send_packet_buffer, connection->fd,
          false))
       return false;
@@ -2189,6 +2998,13 @@ bool netplay_cmd_mode(netplay_t *netplay,
    if (!netplay->is_server)
       connection = &netplay->one_connection;
 
+   /* Our spectators need us to stay one */
+   if (netplay->is_relay && mode != NETPLAY_CONNECTION_SPECTATING)
+   {
+      RARCH_WARN("[netplay] A spectator relay can't play.\n");
+      return false;
+   }
+
    switch (mode)
    {
       case NETPLAY_CONNECTION_SPECTATING:
@@ -2577,11 +3393,417 @@ static void handle_play_spectate(netplay_t *netplay, uint32_t client_num,
             netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_MODE, payload, sizeof(payload));
          }
 
-         /* Announce it */
-         announce_play_spectate(netplay, connection ? connection->nick : NULL,
-               NETPLAY_CONNECTION_PLAYING, devices);
-         break;
-      }
+         /* Announce it */
+         announce_play_spectate(netplay, connection ? connection->nick : NULL,
+               NETPLAY_CONNECTION_PLAYING, devices);
+         break;
+      }
+   }
+}
+
+/* The input of client_num for its next frame (dframe) has been copied
+ * in, over TCP or UDP; advance past it. The server pointer is left
+ * alone, as mode changes and the like are timed against it. */
+static void netplay_input_received(netplay_t *netplay,
+      struct netplay_connection *connection, struct delta_frame *dframe,
+      uint32_t client_num)
+{
+   dframe->have_real[client_num] = true;
+
+   /* Slaves may go through several packets of data in the same frame
+    * if latency is choppy, so we advance and send their data after
+    * handling all network data this frame */
+   if (connection->mode == NETPLAY_CONNECTION_PLAYING)
+   {
+      netplay->read_ptr[client_num] = NEXT_PTR(netplay->read_ptr[client_num]);
+      netplay->read_frame_count[client_num]++;
+
+      if (netplay->is_server)
+      {
+         /* Forward it on if it's past data */
+         if (dframe->frame <= netplay->self_frame_count)
+            send_input_frame(netplay, dframe, NULL, connection, client_num, false);
+      }
+   }
+}
+
+/* Take whatever frames of a UDP input packet we don't have yet.
+ * Anything unexpected is dropped quietly, TCP has the same input. */
+static bool netplay_handle_udp_input(netplay_t *netplay,
+      struct netplay_connection *connection,
+      const uint32_t *packet, size_t words)
+{
+   uint32_t client_num = ntohl(packet[2]);
+   uint32_t devices    = ntohl(packet[3]);
+   uint32_t newest     = ntohl(packet[4]);
+   uint32_t frames     = ntohl(packet[5]);
+   uint32_t input_size, read_frame, i;
+   bool had_input      = false;
+
+   /* Slaves send input unnumbered, leave them to TCP */
+   if (connection->mode != NETPLAY_CONNECTION_PLAYING || !frames)
+      return false;
+
+   if (netplay->is_server)
+      client_num = (uint32_t)(connection - netplay->connections + 1);
+   else if (client_num != 0)
+      return false;
+
+   if (client_num >= MAX_CLIENTS
+         || !(netplay->connected_players & (1<<client_num))
+         || devices != netplay->client_devices[client_num])
+      return false;
+
+   input_size = netplay_expected_input_size(netplay, devices);
+   read_frame = netplay->read_frame_count[client_num];
+
+   if (!input_size
+         || frames > NETPLAY_UDP_REDUNDANCY
+         || words < NETPLAY_UDP_HEADER + frames * input_size
+         || newest < read_frame
+         || newest - read_frame >= frames)
+      return false;
+
+   /* Entry i is frame newest - i */
+   for (i = newest - read_frame; ; i--)
+   {
+      uint32_t device;
+      const uint32_t *data       = packet + NETPLAY_UDP_HEADER
+         + i * input_size;
+      struct delta_frame *dframe =
+         &netplay->buffer[netplay->read_ptr[client_num]];
+
+      if (!netplay_delta_frame_ready(netplay, dframe,
+               netplay->read_frame_count[client_num]))
+         break;
+
+      for (device = 0; device < MAX_INPUT_DEVICES; device++)
+      {
+         netplay_input_state_t istate;
+         uint32_t dsize, di;
+         if (!(devices & (1<<device)))
+            continue;
+
+         dsize  = netplay_expected_input_size(netplay, 1 << device);
+         istate = netplay_input_state_for(&dframe->real_input[device],
+               client_num, dsize, false, false);
+         if (!istate)
+            return had_input;
+         for (di = 0; di < dsize; di++)
+            istate->data[di] = ntohl(data[di]);
+         data += dsize;
+      }
+
+      netplay_input_received(netplay, connection, dframe, client_num);
+      connection->stats.udp_frames++;
+      had_input = true;
+
+      if (!i)
+         break;
+   }
+
+   return had_input;
+}
+
+/**
+ * netplay_recv_udp
+ *
+ * Read all pending UDP input packets.
+ *
+ * Returns true if any new input was received.
+ */
+static bool netplay_recv_udp(netplay_t *netplay)
+{
+   bool had_input = false;
+
+   for (;;)
+   {
+      size_t i;
+      uint32_t token;
+      uint32_t packet[NETPLAY_UDP_PACKET_MAX];
+      struct sockaddr_storage their_addr;
+      struct netplay_connection *connection = NULL;
+      socklen_t addr_size                   = sizeof(their_addr);
+      ssize_t recvd                         = recvfrom(netplay->udp_fd,
+            (char*)packet, sizeof(packet), 0,
+            (struct sockaddr*)&their_addr, &addr_size);
+
+      if (recvd < 0)
+         break;
+
+      if (recvd < (ssize_t)(NETPLAY_UDP_HEADER * sizeof(uint32_t))
+            || ntohl(packet[0]) != NETPLAY_UDP_MAGIC)
+         continue;
+
+      token = ntohl(packet[1]);
+      for (i = 0; i < netplay->connections_size; i++)
+      {
+         struct netplay_connection *conn = &netplay->connections[i];
+         if (conn->active && conn->udp_input
+               && conn->mode >= NETPLAY_CONNECTION_CONNECTED
+               && conn->udp_token == token)
+         {
+            connection = conn;
+            break;
+         }
+      }
+      if (!connection)
+         continue;
+
+      /* Answer to wherever the client's packets come from,
+       * which is not necessarily the port it told us about */
+      if (netplay->is_server)
+      {
+         connection->udp_addr    = their_addr;
+         connection->udp_addrlen = addr_size;
+         connection->udp_ready   = true;
+      }
+
+      if (netplay_handle_udp_input(netplay, connection, packet,
+               recvd / sizeof(uint32_t)))
+         had_input = true;
+   }
+
+   return had_input;
+}
+
+/* Set the port of a socket address, returns the length
+ * of the address, 0 for unsupported address families */
+static socklen_t netplay_addr_set_port(struct sockaddr_storage *addr,
+      uint16_t port)
+{
+   switch (addr->ss_family)
+   {
+      case AF_INET:
+         ((struct sockaddr_in*)addr)->sin_port = htons(port);
+         return sizeof(struct sockaddr_in);
+#ifdef HAVE_INET6
+      case AF_INET6:
+         ((struct sockaddr_in6*)addr)->sin6_port = htons(port);
+         return sizeof(struct sockaddr_in6);
+#endif
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+/**
+ * netplay_relay_send_savestate
+ * @netplay              : pointer to netplay object
+ * @only                 : spectator to send it to, NULL for all of them
+ * @delta                : frame whose state to send
+ *
+ * Send the state at the start of a frame to the spectators of our relay.
+ * They always get the full state, each compression is only run once.
+ */
+static void netplay_relay_send_savestate(netplay_t *netplay,
+      struct netplay_connection *only, struct delta_frame *delta)
+{
+   uint32_t header[4];
+   uint32_t rd, wn;
+   size_t i;
+   unsigned pass;
+
+   for (pass = 0; pass < 2; pass++)
+   {
+      uint32_t cx                      = pass ? NETPLAY_COMPRESSION_ZLIB : 0;
+      struct compression_transcoder *z = pass ?
+         &netplay->compress_zlib : &netplay->compress_nil;
+      bool compressed                  = false;
+
+      for (i = 0; i < netplay->relay_connections_size; i++)
+      {
+         struct netplay_connection *connection = &netplay->relay_connections[i];
+         if (only && connection != only)
+            continue;
+         if (!connection->active ||
+             connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+             connection->compression_supported != cx)
+            continue;
+
+         if (!compressed)
+         {
+            z->compression_backend->set_in(z->compression_stream,
+               (const uint8_t*)delta->state, (uint32_t)netplay->state_size);
+            z->compression_backend->set_out(z->compression_stream,
+               netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+            if (!z->compression_backend->trans(z->compression_stream, true,
+                  &rd, &wn, NULL))
+            {
+               RARCH_ERR("[netplay] Relay: failed to compress savestate.\n");
+               return;
+            }
+
+            header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+            header[1] = htonl(wn + 2*sizeof(uint32_t));
+            header[2] = htonl(delta->frame);
+            header[3] = htonl((uint32_t)netplay->state_size);
+            compressed = true;
+         }
+
+         if (!netplay_send(&connection->send_packet_buffer, connection->fd,
+               header, sizeof(header)) ||
+             !netplay_send(&connection->send_packet_buffer, connection->fd,
+               netplay->zbuffer, wn))
+            netplay_relay_hangup(netplay, connection);
+         else
+            connection->stats.savestates_sent++;
+      }
+   }
+}
+
+/**
+ * netplay_relay_sync
+ * @netplay              : pointer to netplay object
+ * @connection           : spectator that just got its SYNC
+ *
+ * Bring a new spectator of our relay up to date: the state at
+ * other_frame_count, the frame we sent in the SYNC, and then all the
+ * input we have from there on. Whatever the host sends after that is
+ * forwarded as it comes in.
+ *
+ * Returns: false if we don't hold those frames.
+ */
+static bool netplay_relay_sync(netplay_t *netplay,
+      struct netplay_connection *connection)
+{
+   uint32_t frame, client;
+   uint32_t hi_frame_count   = netplay->server_frame_count;
+   size_t ptr                = netplay->other_ptr;
+   struct delta_frame *delta = &netplay->buffer[ptr];
+
+   if (!delta->used || delta->frame != netplay->other_frame_count)
+      return false;
+
+   netplay_relay_send_savestate(netplay, connection, delta);
+
+   for (client = 1; client < MAX_CLIENTS; client++)
+      if ((netplay->connected_players & (1<<client)) &&
+            netplay->read_frame_count[client] > hi_frame_count)
+         hi_frame_count = netplay->read_frame_count[client];
+
+   /* In the order the host would have sent it */
+   for (frame = netplay->other_frame_count; frame < hi_frame_count;
+         frame++, ptr = NEXT_PTR(ptr))
+   {
+      delta = &netplay->buffer[ptr];
+      if (!delta->used || delta->frame != frame)
+         return false;
+
+      for (client = 1; client < MAX_CLIENTS; client++)
+      {
+         if (!(netplay->connected_players & (1<<client)) ||
+               frame >= netplay->read_frame_count[client] ||
+               !delta->have_real[client])
+            continue;
+         if (!send_input_frame(netplay, delta, connection, NULL,
+                  client, false))
+            return false;
+      }
+
+      if (frame >= netplay->server_frame_count)
+         continue;
+
+      if ((netplay->connected_players & 1) && delta->have_real[0])
+      {
+         if (!send_input_frame(netplay, delta, connection, NULL, 0, false))
+            return false;
+      }
+      else
+      {
+         uint32_t payload = htonl(frame);
+         if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_NOINPUT,
+               &payload, sizeof(payload)))
+            return false;
+      }
+   }
+
+   RARCH_LOG("[netplay] Relay: spectator \"%s\" joined at frame %u.\n",
+         connection->nick, (unsigned)netplay->other_frame_count);
+
+   return true;
+}
+
+/**
+ * netplay_relay_forward
+ * @netplay              : pointer to netplay object
+ * @connection           : the host
+ * @cmd                  : command that was just handled
+ *
+ * Pass a command from the host on to the spectators of our relay, as
+ * it came in. Whatever was meant for us alone is not passed on.
+ */
+static void netplay_relay_forward(netplay_t *netplay,
+      struct netplay_connection *connection, uint32_t cmd)
+{
+   size_t i, len, chunka;
+   struct socket_buffer *sbuf = &connection->recv_packet_buffer;
+
+   switch (cmd)
+   {
+      case NETPLAY_CMD_INPUT:
+      case NETPLAY_CMD_NOINPUT:
+      case NETPLAY_CMD_CRC:
+      case NETPLAY_CMD_RESET:
+      case NETPLAY_CMD_PAUSE:
+      case NETPLAY_CMD_RESUME:
+         break;
+
+      case NETPLAY_CMD_MODE:
+         {
+            uint32_t mode;
+
+            /* Changes to our own mode */
+            buf_peek(sbuf, 3*sizeof(uint32_t), &mode, sizeof(mode));
+            if (ntohl(mode) & NETPLAY_CMD_MODE_BIT_YOU)
+               return;
+            break;
+         }
+
+      case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
+         {
+            /* A delta would be against a state they never had,
+             * so send them the whole state we just loaded */
+            uint32_t frame;
+
+            buf_peek(sbuf, 2*sizeof(uint32_t), &frame, sizeof(frame));
+            frame = ntohl(frame);
+
+            for (i = 0; i < netplay->buffer_size; i++)
+            {
+               struct delta_frame *delta = &netplay->buffer[i];
+               if (delta->used && delta->frame == frame)
+               {
+                  netplay_relay_send_savestate(netplay, NULL, delta);
+                  break;
+               }
+            }
+            return;
+         }
+
+      default:
+         return;
+   }
+
+   /* The whole command is still in the buffer */
+   len = (sbuf->read + sbuf->bufsz - sbuf->start) % sbuf->bufsz;
+   chunka = MIN(len, sbuf->bufsz - sbuf->start);
+
+   for (i = 0; i < netplay->relay_connections_size; i++)
+   {
+      struct netplay_connection *relayed = &netplay->relay_connections[i];
+      if (!relayed->active || relayed->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      if (!netplay_send(&relayed->send_packet_buffer, relayed->fd,
+            sbuf->data + sbuf->start, chunka) ||
+          (len > chunka &&
+           !netplay_send(&relayed->send_packet_buffer, relayed->fd,
+            sbuf->data, len - chunka)))
+         netplay_relay_hangup(netplay, relayed);
    }
 }
 
@@ -2695,6 +3917,15 @@ static bool netplay_get_cmd(netplay_t *netplay,
                      RECV(&buf, sizeof(uint32_t))
                         return netplay_cmd_nak(netplay, connection);
                   }
+
+                  /* The server's input came over UDP first, but
+                   * the server pointer only follows the TCP stream */
+                  if (!netplay->is_server && client_num == 0
+                        && frame_num == netplay->server_frame_count)
+                  {
+                     netplay->server_ptr = NEXT_PTR(netplay->server_ptr);
+                     netplay->server_frame_count++;
+                  }
                   break;
                }
                else if (frame_num > netplay->read_frame_count[client_num])
@@ -2736,23 +3967,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
                for (di = 0; di < dsize; di++)
                   istate->data[di] = ntohl(istate->data[di]);
             }
-            dframe->have_real[client_num] = true;
-
-            /* Slaves may go through several packets of data in the same frame
-             * if latency is choppy, so we advance and send their data after
-             * handling all network data this frame */
-            if (connection->mode == NETPLAY_CONNECTION_PLAYING)
-            {
-               netplay->read_ptr[client_num] = NEXT_PTR(netplay->read_ptr[client_num]);
-               netplay->read_frame_count[client_num]++;
-
-               if (netplay->is_server)
-               {
-                  /* Forward it on if it's past data */
-                  if (dframe->frame <= netplay->self_frame_count)
-                     send_input_frame(netplay, dframe, NULL, connection, client_num, false);
-               }
-            }
+            netplay_input_received(netplay, connection, dframe, client_num);
 
             /* If this was server data, advance our server pointer too */
             if (!netplay->is_server && client_num == 0)
@@ -2768,6 +3983,41 @@ static bool netplay_get_cmd(netplay_t *netplay,
             break;
          }
 
+      case NETPLAY_CMD_UDP_INFO:
+         {
+            uint32_t udp_info[2];
+
+            if (netplay->is_server)
+            {
+               RARCH_ERR("NETPLAY_CMD_UDP_INFO from a client.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (cmd_size != sizeof(udp_info))
+            {
+               RARCH_ERR("NETPLAY_CMD_UDP_INFO received an unexpected payload size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(udp_info, sizeof(udp_info))
+               return false;
+
+            /* We only get this if we advertised UDP input */
+            if (netplay->udp_fd < 0)
+               break;
+
+            connection->udp_token   = ntohl(udp_info[0]);
+            connection->udp_addr    = connection->addr;
+            connection->udp_addrlen = netplay_addr_set_port(
+                  &connection->udp_addr, (uint16_t)ntohl(udp_info[1]));
+            connection->udp_input   = connection->udp_addrlen != 0;
+            connection->udp_ready   = connection->udp_input;
+
+            if (connection->udp_ready)
+               RARCH_LOG("[netplay] Sending input over UDP as well.\n");
+            break;
+         }
+
       case NETPLAY_CMD_NOINPUT:
          {
             uint32_t frame;
@@ -3179,24 +4429,27 @@ static bool netplay_get_cmd(netplay_t *netplay,
 
       case NETPLAY_CMD_CRC:
          {
-            uint32_t buffer[2];
+            /* Frame and CRC-32, or frame, block hash and region hashes */
+            uint32_t buffer[2 + NETPLAY_HASH_REGIONS];
             size_t tmp_ptr = netplay->run_ptr;
-            bool found = false;
+            size_t j;
+            bool blocks    = cmd_size == sizeof(buffer);
+            bool found     = false;
 
-            if (cmd_size != sizeof(buffer))
+            if (!blocks && cmd_size != 2 * sizeof(uint32_t))
             {
                RARCH_ERR("NETPLAY_CMD_CRC received unexpected payload size.\n");
                return netplay_cmd_nak(netplay, connection);
             }
 
-            RECV(buffer, sizeof(buffer))
+            RECV(buffer, cmd_size)
             {
                RARCH_ERR("NETPLAY_CMD_CRC failed to receive payload.\n");
                return netplay_cmd_nak(netplay, connection);
             }
 
-            buffer[0] = ntohl(buffer[0]);
-            buffer[1] = ntohl(buffer[1]);
+            for (j = 0; j < cmd_size / sizeof(uint32_t); j++)
+               buffer[j] = ntohl(buffer[j]);
 
             /* Received a CRC for some frame. If we still have it, check if it
              * matched. This approach could be improved with some quick modular
@@ -3221,31 +4474,165 @@ static bool netplay_get_cmd(netplay_t *netplay,
             {
                /* We've already replayed up to this frame, so we can check it
                 * directly */
-               uint32_t local_crc = 0;
-               if (netplay->state_size)
-                  local_crc       = netplay_delta_frame_crc(
-                        netplay, &netplay->buffer[tmp_ptr]);
-
-               /* Problem! */
-               if (buffer[1] != local_crc)
+               if (!netplay_frame_hash_matches(netplay,
+                        &netplay->buffer[tmp_ptr], buffer[1],
+                        blocks ? buffer + 2 : NULL))
                   netplay_cmd_request_savestate(netplay);
             }
             else
             {
                /* We'll have to check it when we catch up */
-               netplay->buffer[tmp_ptr].crc = buffer[1];
+               struct delta_frame *delta = &netplay->buffer[tmp_ptr];
+               delta->crc                = buffer[1];
+               delta->crc_blocks         = blocks;
+               if (blocks)
+                  memcpy(delta->crc_regions, buffer + 2,
+                        sizeof(delta->crc_regions));
             }
 
             break;
          }
 
       case NETPLAY_CMD_REQUEST_SAVESTATE:
+         /* A state being streamed to this peer brings it up to date anyway */
+         if (connection->stream_pending || connection->stream_ref)
+            break;
+
          /* Delay until next frame so we don't send the savestate after the
           * input */
          netplay->force_send_savestate = true;
          break;
 
+      case NETPLAY_CMD_LOAD_SAVESTATE_CHUNK:
+         {
+            /* Frame, inflated size, compressed size and offset */
+            uint32_t header[4];
+            uint32_t ack[2];
+            uint32_t len = (uint32_t)(cmd_size - sizeof(header));
+            size_t j;
+
+            if (netplay->is_server || cmd_size < sizeof(header) ||
+                  len > NETPLAY_STATE_CHUNK_SIZE ||
+                  len > netplay->zbuffer_size)
+            {
+               RARCH_ERR("NETPLAY_CMD_LOAD_SAVESTATE_CHUNK received an unexpected payload size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(header, sizeof(header))
+            {
+               RARCH_ERR("NETPLAY_CMD_LOAD_SAVESTATE_CHUNK failed to receive header.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(netplay->zbuffer, len)
+            {
+               RARCH_ERR("NETPLAY_CMD_LOAD_SAVESTATE_CHUNK failed to receive chunk.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            for (j = 0; j < ARRAY_SIZE(header); j++)
+               header[j] = ntohl(header[j]);
+
+            if (header[1] != netplay->state_size ||
+                  header[2] > netplay->zbuffer_size ||
+                  header[3] > header[2] || len > header[2] - header[3])
+            {
+               RARCH_ERR("NETPLAY_CMD_LOAD_SAVESTATE_CHUNK received an unexpected save state size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            /* A new stream replaces what we got of an older one */
+            if (!connection->stream_data ||
+                  connection->stream_frame != header[0] ||
+                  connection->stream_size  != header[2])
+            {
+               free(connection->stream_data);
+               connection->stream_data  = (uint8_t*)malloc(header[2]);
+               connection->stream_frame = header[0];
+               connection->stream_size  = header[2];
+               connection->stream_acked = 0;
+               if (!connection->stream_data)
+                  return netplay_cmd_nak(netplay, connection);
+            }
+
+            /* Resume from what we have, chunks before that we already got */
+            if (header[3] == connection->stream_acked)
+            {
+               memcpy(connection->stream_data + header[3],
+                     netplay->zbuffer, len);
+               connection->stream_acked += len;
+            }
+
+            ack[0] = htonl(connection->stream_frame);
+            ack[1] = htonl(connection->stream_acked);
+            if (!netplay_send_raw_cmd(netplay, connection,
+                     NETPLAY_CMD_SAVESTATE_CHUNK_ACK, ack, sizeof(ack)))
+               return netplay_cmd_nak(netplay, connection);
+
+            /* All there: it's the reference for the delta that follows */
+            if (connection->stream_acked == connection->stream_size)
+            {
+               uint32_t rd, wn;
+               struct compression_transcoder *ctrans =
+                  (connection->compression_supported
+                   == NETPLAY_COMPRESSION_ZLIB)
+                  ? &netplay->compress_zlib
+                  : &netplay->compress_nil;
+
+               if (!connection->delta_ref)
+                  connection->delta_ref = (uint8_t*)
+                     malloc(netplay->state_size);
+
+               if (connection->delta_ref)
+               {
+                  ctrans->decompression_backend->set_in(
+                        ctrans->decompression_stream,
+                        connection->stream_data, connection->stream_size);
+                  ctrans->decompression_backend->set_out(
+                        ctrans->decompression_stream,
+                        connection->delta_ref,
+                        (unsigned)netplay->state_size);
+                  ctrans->decompression_backend->trans(
+                        ctrans->decompression_stream, true, &rd, &wn, NULL);
+               }
+
+               free(connection->stream_data);
+               connection->stream_data = NULL;
+            }
+            break;
+         }
+
+      case NETPLAY_CMD_SAVESTATE_CHUNK_ACK:
+         {
+            uint32_t payload[2];
+
+            if (cmd_size != sizeof(payload))
+            {
+               RARCH_ERR("NETPLAY_CMD_SAVESTATE_CHUNK_ACK received an unexpected payload size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(payload, sizeof(payload))
+            {
+               RARCH_ERR("NETPLAY_CMD_SAVESTATE_CHUNK_ACK failed to receive payload.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            payload[0] = ntohl(payload[0]);
+            payload[1] = ntohl(payload[1]);
+
+            /* Acknowledgements of a stream we've dropped don't count */
+            if (connection->stream_ref &&
+                  payload[0] == connection->stream_frame &&
+                  payload[1] >  connection->stream_acked &&
+                  payload[1] <= connection->stream_sent)
+               connection->stream_acked = payload[1];
+            break;
+         }
+
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
       case NETPLAY_CMD_RESET:
          {
             uint32_t frame;
@@ -3301,7 +4688,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
              * too many places. */
 
             /* Check the payload size */
-            if ((cmd == NETPLAY_CMD_LOAD_SAVESTATE &&
+            if ((cmd != NETPLAY_CMD_RESET &&
                  (cmd_size < 2*sizeof(uint32_t) || cmd_size > netplay->zbuffer_size + 2*sizeof(uint32_t))) ||
                 (cmd == NETPLAY_CMD_RESET && cmd_size != sizeof(uint32_t)))
             {
@@ -3339,8 +4726,15 @@ static bool netplay_get_cmd(netplay_t *netplay,
                goto shrt;
             }
 
+            /* A delta is only meaningful against a state we got from this peer */
+            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA && !connection->delta_ref)
+            {
+               RARCH_ERR("CMD_LOAD_SAVESTATE_DELTA received without a reference state.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
             /* Now we switch based on whether we're loading a state or resetting */
-            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE)
+            if (cmd != NETPLAY_CMD_RESET)
             {
                RECV(&isize, sizeof(isize))
                {
@@ -3378,6 +4772,25 @@ static bool netplay_get_cmd(netplay_t *netplay,
                ctrans->decompression_backend->trans(ctrans->decompression_stream,
                   true, &rd, &wn, NULL);
 
+               /* Undo the XOR, and keep the state as the reference for
+                * the next delta from this peer */
+               if (connection->delta_savestates)
+               {
+                  if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+                     netplay_xor_state(
+                           (uint8_t*)netplay->buffer[load_ptr].state,
+                           (const uint8_t*)netplay->buffer[load_ptr].state,
+                           connection->delta_ref, netplay->state_size);
+                  else if (!connection->delta_ref)
+                     connection->delta_ref = (uint8_t*)
+                        malloc(netplay->state_size);
+
+                  if (connection->delta_ref)
+                     memcpy(connection->delta_ref,
+                           netplay->buffer[load_ptr].state,
+                           netplay->state_size);
+               }
+
                /* Force a rewind to the relevant frame */
                netplay->force_rewind = true;
             }
@@ -3521,6 +4934,9 @@ static bool netplay_get_cmd(netplay_t *netplay,
          return netplay_cmd_nak(netplay, connection);
    }
 
+   if (netplay->is_relay)
+      netplay_relay_forward(netplay, connection, cmd);
+
    netplay_recv_flush(&connection->recv_packet_buffer);
    netplay->timeout_cnt = 0;
    if (had_input)
@@ -3535,6 +4951,146 @@ shrt:
 #undef RECV
 }
 
+#define RECV(buf, sz) \
+recvd = netplay_recv(&connection->recv_packet_buffer, connection->fd, (buf), \
+(sz), false); \
+if (recvd >= 0 && recvd < (ssize_t) (sz)) goto shrt; \
+else if (recvd < 0)
+
+/**
+ * netplay_relay_get_cmd
+ *
+ * Handle a command from a spectator of our relay. They have no say in
+ * the game, so all that's left is refusing to let them play and asking
+ * the host for a state when they desync.
+ */
+static bool netplay_relay_get_cmd(netplay_t *netplay,
+   struct netplay_connection *connection, bool *had_input)
+{
+   uint32_t cmd;
+   uint32_t cmd_size;
+   uint32_t buf[16];
+   ssize_t recvd;
+
+   RECV(&cmd, sizeof(cmd))
+      return false;
+   RECV(&cmd_size, sizeof(cmd_size))
+      return false;
+
+   cmd      = ntohl(cmd);
+   cmd_size = ntohl(cmd_size);
+
+   /* None of the payloads matter */
+   while (cmd_size)
+   {
+      uint32_t len = MIN(cmd_size, sizeof(buf));
+      RECV(buf, len)
+         return false;
+      cmd_size -= len;
+   }
+
+   switch (cmd)
+   {
+      case NETPLAY_CMD_NAK:
+      case NETPLAY_CMD_DISCONNECT:
+         return false;
+
+      case NETPLAY_CMD_PLAY:
+         buf[0] = htonl(NETPLAY_CMD_MODE_REFUSED_REASON_NOT_AVAILABLE);
+         if (!netplay_send_raw_cmd(netplay, connection,
+                  NETPLAY_CMD_MODE_REFUSED, buf, sizeof(uint32_t)))
+            return false;
+         break;
+
+      case NETPLAY_CMD_REQUEST_SAVESTATE:
+         /* Ours would be for a frame they're already past */
+         netplay_cmd_request_savestate(netplay);
+         break;
+
+      default:
+         break;
+   }
+
+   netplay_recv_flush(&connection->recv_packet_buffer);
+   *had_input = true;
+   return true;
+
+shrt:
+   /* No more data, reset and try again */
+   netplay_recv_reset(&connection->recv_packet_buffer);
+   return true;
+}
+
+#undef RECV
+
+/**
+ * netplay_relay_poll
+ *
+ * Accept, sync and serve the spectators connected to our relay
+ */
+void netplay_relay_poll(netplay_t *netplay)
+{
+   size_t i;
+   int new_fd;
+   struct sockaddr_storage their_addr;
+
+   /* Nothing to pass on until we're watching ourselves */
+   if (!netplay->connections[0].active ||
+       netplay->connections[0].mode < NETPLAY_CONNECTION_CONNECTED)
+      return;
+
+   new_fd = netplay_accept(netplay->listen_fd, &their_addr);
+   if (new_fd >= 0)
+   {
+      struct netplay_connection *connection = netplay_new_connection(netplay,
+            &netplay->relay_connections, &netplay->relay_connections_size,
+            new_fd);
+
+      if (connection)
+      {
+         connection->relayed = true;
+         connection->addr    = their_addr;
+         if (!netplay_handshake_init_send(netplay, connection))
+            netplay_relay_hangup(netplay, connection);
+      }
+   }
+
+   for (i = 0; i < netplay->relay_connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->relay_connections[i];
+      bool had_input;
+
+      if (!connection->active)
+         continue;
+
+      do
+      {
+         bool ok;
+
+         had_input = false;
+         if (connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         {
+            ok = netplay_handshake(netplay, connection, &had_input);
+            if (ok && connection->mode >= NETPLAY_CONNECTION_CONNECTED)
+               ok = netplay_relay_sync(netplay, connection);
+         }
+         else
+            ok = netplay_relay_get_cmd(netplay, connection, &had_input);
+
+         if (!ok)
+         {
+            netplay_relay_hangup(netplay, connection);
+            break;
+         }
+      } while (had_input);
+
+      if (connection->active &&
+          !netplay_send_flush(&connection->send_packet_buffer,
+            connection->fd, false))
+         netplay_relay_hangup(netplay, connection);
+   }
+}
+
 /**
  * netplay_poll_net_input
  *
@@ -3564,6 +5120,10 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
 
       netplay->timeout_cnt++;
 
+      /* UDP input first, it makes the same input over TCP redundant */
+      if (netplay->udp_fd >= 0 && netplay_recv_udp(netplay))
+         had_input = true;
+
       /* Read input from each connection */
       for (i = 0; i < netplay->connections_size; i++)
       {
@@ -3594,6 +5154,12 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
                if (connection->active)
                   FD_SET(connection->fd, &fds);
             }
+            if (netplay->udp_fd >= 0)
+            {
+               FD_SET(netplay->udp_fd, &fds);
+               if (netplay->udp_fd >= max_fd)
+                  max_fd = netplay->udp_fd + 1;
+            }
 
             if (socket_select(max_fd, &fds, NULL, NULL, &tv) < 0)
                return -1;
@@ -3732,8 +5298,8 @@ void netplay_announce_nat_traversal(netplay_t *netplay)
 void netplay_init_nat_traversal(netplay_t *netplay)
 {
    memset(&netplay->nat_traversal_state, 0, sizeof(netplay->nat_traversal_state));
-   netplay->nat_traversal_task_oustanding = true;
-   task_push_netplay_nat_traversal(&netplay->nat_traversal_state, netplay->tcp_port);
+   netplay->nat_traversal_task_oustanding =
+      task_push_netplay_nat_traversal(netplay->tcp_port);
 }
 
 static int init_tcp_connection(const struct addrinfo *res,
@@ -3854,11 +5420,11 @@ static bool init_tcp_socket(netplay_t *netplay, void *direct_host,
    {
       /* I'll build my own addrinfo! */
       struct netplay_host *host = (struct netplay_host *)direct_host;
-      hints.ai_family           = host->addr.sa_family;
+      hints.ai_family           = ((struct sockaddr*)&host->addr)->sa_family;
       hints.ai_socktype         = SOCK_STREAM;
       hints.ai_protocol         = 0;
       hints.ai_addrlen          = host->addrlen;
-      hints.ai_addr             = &host->addr;
+      hints.ai_addr             = (struct sockaddr*)&host->addr;
       res                       = &hints;
 
    }
@@ -3895,6 +5461,10 @@ static bool init_tcp_socket(netplay_t *netplay, void *direct_host,
          ret = true;
          if (direct_host || server)
          {
+            /* Keep the server's address around for UDP input */
+            if (tmp_info->ai_addrlen <= sizeof(sad))
+               memcpy(&sad, tmp_info->ai_addr, tmp_info->ai_addrlen);
+
             netplay->connections[0].active = true;
             netplay->connections[0].fd     = fd;
             netplay->connections[0].addr   = sad;
@@ -3924,15 +5494,122 @@ static bool init_tcp_socket(netplay_t *netplay, void *direct_host,
    return ret;
 }
 
+/* The server takes UDP input on the port after its TCP port, as
+ * LAN discovery already listens on UDP RARCH_DEFAULT_PORT. The
+ * client sends from whatever port it gets. */
+static bool init_udp_socket(netplay_t *netplay)
+{
+   int fd = -1;
+
+   if (netplay->is_server)
+   {
+      char port_buf[16];
+      struct addrinfo *res  = NULL;
+      struct addrinfo hints = {0};
+
+      hints.ai_socktype = SOCK_DGRAM;
+      hints.ai_flags    = AI_PASSIVE;
+#ifdef HAVE_INET6
+      hints.ai_family   = AF_INET6;
+#endif
+
+      netplay->udp_port = netplay->tcp_port + 1;
+      snprintf(port_buf, sizeof(port_buf), "%hu",
+            (unsigned short)netplay->udp_port);
+      if (getaddrinfo_retro(NULL, port_buf, &hints, &res) != 0)
+      {
+         res = NULL;
+#ifdef HAVE_INET6
+         /* Didn't work with IPv6, try wildcard */
+         hints.ai_family = 0;
+         if (getaddrinfo_retro(NULL, port_buf, &hints, &res) != 0)
+            res = NULL;
+#endif
+      }
+
+      if (!res)
+         return false;
+
+      fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+
+#if defined(HAVE_INET6) && defined(IPPROTO_IPV6) && defined(IPV6_V6ONLY)
+      /* Take input from IPv4 clients too */
+      if (fd >= 0 && res->ai_family == AF_INET6)
+      {
+         int on = 0;
+         if (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)&on, sizeof(on)) < 0)
+            RARCH_WARN("Failed to listen on both IPv6 and IPv4\n");
+      }
+#endif
+
+      if (fd >= 0 && !socket_bind(fd, (void*)res))
+      {
+         socket_close(fd);
+         fd = -1;
+      }
+
+      freeaddrinfo_retro(res);
+   }
+   else if (netplay->connections[0].addr.ss_family)
+      fd = socket(netplay->connections[0].addr.ss_family, SOCK_DGRAM, 0);
+
+   if (fd < 0)
+      return false;
+
+   if (!socket_nonblock(fd))
+   {
+      socket_close(fd);
+      return false;
+   }
+
+   netplay->udp_fd = fd;
+   return true;
+}
+
+/* A spectator can pass the game on to spectators of its own,
+ * as long as it can send them savestates */
+static void init_relay_socket(netplay_t *netplay, uint16_t port)
+{
+   if (netplay->quirks &
+         (NETPLAY_QUIRK_NO_SAVESTATES|NETPLAY_QUIRK_NO_TRANSMISSION))
+   {
+      RARCH_WARN("[netplay] This core can't send savestates, not relaying to spectators.\n");
+      return;
+   }
+
+   if (!init_tcp_socket(netplay, NULL, NULL, port) ||
+       !socket_nonblock(netplay->listen_fd))
+   {
+      if (netplay->listen_fd >= 0)
+         socket_close(netplay->listen_fd);
+      netplay->listen_fd = -1;
+      RARCH_WARN("[netplay] Could not listen on port %hu, not relaying to spectators.\n",
+            (unsigned short)port);
+      return;
+   }
+
+   netplay->is_relay = true;
+   RARCH_LOG("[netplay] Relaying to spectators on port %hu.\n",
+         (unsigned short)port);
+}
+
 static bool init_socket(netplay_t *netplay, void *direct_host,
       const char *server, uint16_t port)
 {
+   settings_t *settings = config_get_ptr();
+
    if (!network_init())
       return false;
 
    if (!init_tcp_socket(netplay, direct_host, server, port))
       return false;
 
+   if (settings->bools.netplay_udp_input && !init_udp_socket(netplay))
+      RARCH_WARN("[netplay] Could not set up UDP input, using TCP only.\n");
+
+   if (!netplay->is_server && settings->uints.netplay_relay_port)
+      init_relay_socket(netplay, settings->uints.netplay_relay_port);
+
    if (netplay->is_server && netplay->nat_traversal)
       netplay_init_nat_traversal(netplay);
 
@@ -3992,13 +5669,16 @@ static bool netplay_init_serialization(netplay_t *netplay)
 
    for (i = 0; i < netplay->buffer_size; i++)
    {
-      netplay->buffer[i].state = calloc(netplay->state_size, 1);
+      netplay->buffer[i].state = memalign_alloc_large(
+            netplay->state_size);
 
       if (!netplay->buffer[i].state)
       {
          netplay->quirks |= NETPLAY_QUIRK_NO_SAVESTATES;
          return false;
       }
+
+      memory_tag_add(MEMORY_TAG_NETPLAY, (int64_t)netplay->state_size);
    }
 
    netplay->zbuffer_size = netplay->state_size * 2;
@@ -4010,6 +5690,8 @@ static bool netplay_init_serialization(netplay_t *netplay)
       return false;
    }
 
+   memory_tag_add(MEMORY_TAG_NETPLAY, (int64_t)netplay->zbuffer_size);
+
    return true;
 }
 
@@ -4131,6 +5813,7 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
       return NULL;
 
    netplay->listen_fd            = -1;
+   netplay->udp_fd               = -1;
    netplay->tcp_port             = port;
    netplay->cbs                  = *cb;
    netplay->is_server            = (direct_host == NULL && server == NULL);
@@ -4218,6 +5901,9 @@ error:
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
+   if (netplay->udp_fd >= 0)
+      socket_close(netplay->udp_fd);
+
    if (netplay->connections && netplay->connections[0].fd >= 0)
       socket_close(netplay->connections[0].fd);
 
@@ -4238,6 +5924,9 @@ void netplay_free(netplay_t *netplay)
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
+   if (netplay->udp_fd >= 0)
+      socket_close(netplay->udp_fd);
+
    for (i = 0; i < netplay->connections_size; i++)
    {
       struct netplay_connection *connection = &netplay->connections[i];
@@ -4247,24 +5936,43 @@ void netplay_free(netplay_t *netplay)
          netplay_deinit_socket_buffer(&connection->send_packet_buffer);
          netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
       }
+      free(connection->delta_ref);
+      free(connection->stream_data);
+      free(connection->stream_ref);
    }
 
    if (netplay->connections && netplay->connections != &netplay->one_connection)
       free(netplay->connections);
 
+   for (i = 0; i < netplay->relay_connections_size; i++)
+      netplay_relay_hangup(netplay, &netplay->relay_connections[i]);
+   free(netplay->relay_connections);
+
    if (netplay->nat_traversal)
       natt_free(&netplay->nat_traversal_state);
 
    if (netplay->buffer)
    {
       for (i = 0; i < netplay->buffer_size; i++)
+      {
+         if (netplay->buffer[i].state)
+            memory_tag_add(MEMORY_TAG_NETPLAY,
+                  -(int64_t)netplay->state_size);
          netplay_delta_frame_free(&netplay->buffer[i]);
+      }
 
       free(netplay->buffer);
    }
 
    if (netplay->zbuffer)
+   {
+      memory_tag_add(MEMORY_TAG_NETPLAY, -(int64_t)netplay->zbuffer_size);
       free(netplay->zbuffer);
+   }
+   free(netplay->delta_ref);
+   free(netplay->delta_buffer);
+   free(netplay->hash_ref);
+   free(netplay->hash_blocks);
 
    if (netplay->compress_nil.compression_stream)
    {
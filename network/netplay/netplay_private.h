@@ -89,12 +89,50 @@ typedef uint32_t client_bitmap_t;
 
 /* Compression protocols supported */
 #define NETPLAY_COMPRESSION_ZLIB (1<<0)
+/* Not a transcoder: savestates may be sent XOR'd against the
+ * last state exchanged with the peer (NETPLAY_CMD_LOAD_SAVESTATE_DELTA) */
+#define NETPLAY_COMPRESSION_XOR_DELTA (1<<1)
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED (NETPLAY_COMPRESSION_ZLIB | NETPLAY_COMPRESSION_XOR_DELTA)
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_XOR_DELTA
 #endif
 
+/* Not a compression protocol either, but advertised in the same
+ * header word: we can take input over UDP (NETPLAY_CMD_UDP_INFO) */
+#define NETPLAY_FEATURE_UDP_INPUT (1<<16)
+
+/* Same again: we understand block hashes in NETPLAY_CMD_CRC */
+#define NETPLAY_FEATURE_BLOCK_HASH (1<<17)
+
+/* Block hashes of the state for desync checks. Only blocks that
+ * changed since the last hashed state are hashed again. The block
+ * hashes are folded into NETPLAY_HASH_REGIONS region hashes, sent
+ * along with the frame hash so a mismatch can be located. */
+#define NETPLAY_HASH_BLOCK_SIZE 4096
+#define NETPLAY_HASH_REGIONS    16
+
+/* And again: we take the state of a late join in chunks
+ * (NETPLAY_CMD_LOAD_SAVESTATE_CHUNK) */
+#define NETPLAY_FEATURE_CHUNKED_STATE (1<<18)
+
+/* The joining peer's state is streamed in chunks of this size
+ * between input, with at most NETPLAY_STATE_CHUNK_WINDOW of them
+ * sent but not yet acknowledged, so the host never has to push
+ * the whole state at once. */
+#define NETPLAY_STATE_CHUNK_SIZE   16384
+#define NETPLAY_STATE_CHUNK_WINDOW 8
+
+/* UDP input packets: magic, token, client number, devices,
+ * newest frame and frame count, followed by the input of up to
+ * NETPLAY_UDP_REDUNDANCY consecutive frames, newest first. Each
+ * packet repeats the frames before the newest one, so a lost
+ * packet is made up for by the next. */
+#define NETPLAY_UDP_MAGIC       0x52415549 /* RAUI */
+#define NETPLAY_UDP_HEADER      6
+#define NETPLAY_UDP_REDUNDANCY  8
+#define NETPLAY_UDP_PACKET_MAX  256 /* In words */
+
 enum netplay_cmd
 {
    /* Basic commands */
@@ -140,6 +178,10 @@ enum netplay_cmd
    /* Report player mode refused */
    NETPLAY_CMD_MODE_REFUSED   = 0x0027,
 
+   /* Token and UDP port for input over UDP (server to client, only
+    * if the client advertised NETPLAY_FEATURE_UDP_INPUT) */
+   NETPLAY_CMD_UDP_INFO       = 0x0028,
+
    /* Loading and synchronization */
 
    /* Send the CRC hash of a frame's state */
@@ -166,6 +208,17 @@ enum netplay_cmd
    /* Sends over cheats enabled on client (unsupported) */
    NETPLAY_CMD_CHEATS         = 0x0047,
 
+   /* Send a savestate XOR'd against the last one exchanged with the
+    * peer, only sent to peers supporting NETPLAY_COMPRESSION_XOR_DELTA */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0048,
+
+   /* Send a chunk of the compressed state streamed to a joining peer,
+    * only sent to peers supporting NETPLAY_FEATURE_CHUNKED_STATE */
+   NETPLAY_CMD_LOAD_SAVESTATE_CHUNK = 0x0049,
+
+   /* Acknowledges the chunks of a streamed state received so far */
+   NETPLAY_CMD_SAVESTATE_CHUNK_ACK = 0x004A,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -303,9 +356,13 @@ struct delta_frame
 
    uint32_t frame;
 
-   /* The CRC-32 of the serialized state if we've calculated it, else 0 */
+   /* The hash of the serialized state if we've calculated or received
+    * it, else 0. CRC-32, or the block hash if crc_blocks is set. */
    uint32_t crc;
 
+   /* Region hashes that came with a block hash */
+   uint32_t crc_regions[NETPLAY_HASH_REGIONS];
+
    /* The simulated input. is_real here means the simulation is done, i.e.,
     * it's a real simulation, not real input. */
    netplay_input_state_t simlated_input[MAX_INPUT_DEVICES];
@@ -313,6 +370,9 @@ struct delta_frame
    /* Have we read local input? */
    bool have_local;
 
+   /* Is crc a block hash? */
+   bool crc_blocks;
+
    /* Have we read the real (remote) input? */
    bool have_real[MAX_CLIENTS];
 
@@ -321,6 +381,7 @@ struct delta_frame
 
 struct socket_buffer
 {
+   uint64_t total; /* Bytes that went over the socket through this buffer */
    unsigned char *data;
    size_t bufsz;
    size_t start;
@@ -328,15 +389,70 @@ struct socket_buffer
    size_t read;
 };
 
+/* How often the connection statistics are sampled */
+#define NETPLAY_STATS_INTERVAL_USEC 250000
+
+/* RTT histogram: NETPLAY_RTT_HISTOGRAM_MS wide buckets,
+ * the last one collects everything above. */
+#define NETPLAY_RTT_HISTOGRAM_BUCKETS 16
+#define NETPLAY_RTT_HISTOGRAM_MS      10
+
+/* Upper limit of the socket send buffer size we ask for */
+#define NETPLAY_SNDBUF_MAX            (4 * 1024 * 1024)
+
+/* Live statistics of one connection,
+ * see netplay_update_connection_stats() */
+struct netplay_connection_stats
+{
+   /* Start of the current sampling interval and
+    * the byte totals at that point */
+   retro_time_t sample_time;
+   uint64_t sample_in, sample_out;
+
+   /* Bytes per second over the last interval */
+   uint32_t rate_in, rate_out;
+
+   /* Smoothed RTT and its variation in usec, as
+    * seen by the TCP stack. 0 if not available. */
+   uint32_t rtt, rtt_var;
+   uint32_t rtt_hist[NETPLAY_RTT_HISTOGRAM_BUCKETS];
+
+   /* Stalls caused by this peer, and frames spent in them */
+   uint32_t stalls;
+   uint32_t stall_frames;
+
+   /* Savestates (full or delta) sent to this peer */
+   uint32_t savestates_sent;
+
+   /* Input frames from this peer that arrived over UDP first */
+   uint32_t udp_frames;
+
+   /* Socket send buffer size we set, 0 if left to the kernel */
+   uint32_t sndbuf;
+
+   bool stalled;
+};
+
+/* Whether we take the host's part of the protocol on this connection,
+ * as a relay does towards its own spectators */
+#define NETPLAY_IS_SERVER_END(netplay, connection) \
+   ((netplay)->is_server || (connection)->relayed)
+
 /* Each connection gets a connection struct */
 struct netplay_connection
 {
    /* Is this connection stalling? */
    retro_time_t stall_time;
 
+   struct netplay_connection_stats stats; /* retro_time_t alignment */
+
    /* Address of peer */
    struct sockaddr_storage addr;
 
+   /* Where to send UDP input packets to, valid if udp_ready */
+   struct sockaddr_storage udp_addr;
+   socklen_t udp_addrlen;
+
    /* Buffers for sending and receiving data */
    struct socket_buffer send_packet_buffer, recv_packet_buffer;
 
@@ -351,6 +467,16 @@ struct netplay_connection
    /* What compression does this peer support? */
    uint32_t compression_supported;
 
+   /* Last savestate received from this peer, the reference for
+    * the next NETPLAY_CMD_LOAD_SAVESTATE_DELTA it sends us */
+   uint8_t *delta_ref;
+
+   /* Compressed state being streamed to (or by) this peer, and for the
+    * server the state itself, which the peer holds as its delta
+    * reference once all chunks are acknowledged */
+   uint8_t *stream_data;
+   uint8_t *stream_ref;
+
    /* For the server: When was the last time we requested this client to stall?
     * For the client: How many frames of stall do we have left? */
    uint32_t stall_frame;
@@ -358,6 +484,16 @@ struct netplay_connection
    /* Salt associated with password transaction */
    uint32_t salt;
 
+   /* Identifies this connection in UDP input packets */
+   uint32_t udp_token;
+
+   /* Frame the streamed state is from, its compressed size, and how much
+    * of it was sent and acknowledged (the client only counts received) */
+   uint32_t stream_frame;
+   uint32_t stream_size;
+   uint32_t stream_sent;
+   uint32_t stream_acked;
+
    /* Is this connection stalling? */
    enum rarch_netplay_stall_reason stall;
 
@@ -375,6 +511,31 @@ struct netplay_connection
 
    /* Is this connection buffer in use? */
    bool active;
+
+   /* Does this peer accept NETPLAY_CMD_LOAD_SAVESTATE_DELTA? */
+   bool delta_savestates;
+
+   /* Does this peer hold the last savestate we sent (netplay->delta_ref)? */
+   bool delta_ref_sent;
+
+   /* Does this peer take input over UDP? */
+   bool udp_input;
+
+   /* Does this peer understand block hashes? */
+   bool block_hash;
+
+   /* Does this peer take its first state in chunks? */
+   bool chunked_states;
+
+   /* Should we start streaming it a state? */
+   bool stream_pending;
+
+   /* Do we know where to send it? The server learns the address
+    * from the first packet the client sends. */
+   bool udp_ready;
+
+   /* Is this a spectator connected to our relay? */
+   bool relayed;
 };
 
 /* Compression transcoder */
@@ -402,9 +563,12 @@ struct netplay
 
    struct netplay_connection one_connection; /* Client only */ /* retro_time_t alignment */
 
-   /* TCP connection for listening (server only) */
+   /* TCP connection for listening (server or relay only) */
    int listen_fd;
 
+   /* UDP socket for input packets, -1 if not in use */
+   int udp_fd;
+
    /* Our client number */
    uint32_t self_client_num;
 
@@ -412,6 +576,10 @@ struct netplay
    struct netplay_connection *connections;
    size_t connections_size;
 
+   /* Spectators we pass the host's stream on to (relay only) */
+   struct netplay_connection *relay_connections;
+   size_t relay_connections_size;
+
    /* Bitmap of clients with input devices */
    uint32_t connected_players;
 
@@ -455,6 +623,16 @@ struct netplay
    uint8_t *zbuffer;
    size_t zbuffer_size;
 
+   /* Last savestate we sent, and scratch space for XOR'ing
+    * the next one against it */
+   uint8_t *delta_ref;
+   uint8_t *delta_buffer;
+
+   /* Last state we hashed, and the hashes of its blocks */
+   uint8_t *hash_ref;
+   uint32_t *hash_blocks;
+   size_t hash_ref_size;
+
    /* The size of our packet buffers */
    size_t packet_buffer_size;
 
@@ -491,6 +669,15 @@ struct netplay
    size_t replay_ptr;
    uint32_t replay_frame_count;
 
+   /* Rollback statistics: number of replays, frames
+    * re-simulated in total and in the longest/last replay,
+    * and re-simulated frames we didn't need to serialize. */
+   uint64_t rollback_frames;
+   uint64_t rollback_saves_skipped;
+   uint32_t rollback_count;
+   uint32_t rollback_max;
+   uint32_t rollback_last;
+
    /* Our local socket info */
    struct addrinfo *addr;
 
@@ -517,6 +704,9 @@ struct netplay
    /* TCP port (only set if serving) */
    uint16_t tcp_port;
 
+   /* UDP port for input (only set if serving with UDP input) */
+   uint16_t udp_port;
+
    /* The sharing mode for each device */
    uint8_t device_share_modes[MAX_INPUT_DEVICES];
 
@@ -575,6 +765,9 @@ struct netplay
    /* Are we the server? */
    bool is_server;
 
+   /* Are we a spectator relaying the game to further spectators? */
+   bool is_relay;
+
    /* Are we the connected? */
    bool is_connected;
 
@@ -778,6 +971,23 @@ void netplay_free(netplay_t *netplay);
  */
 void netplay_hangup(netplay_t *netplay, struct netplay_connection *connection);
 
+/**
+ * netplay_update_connection_stats:
+ *
+ * Updates the live statistics of every active connection,
+ * called once per frame from netplay_poll().
+ */
+void netplay_update_connection_stats(netplay_t *netplay);
+
+/**
+ * netplay_xor_state:
+ *
+ * XORs @len bytes of @a and @b into @out, which may alias @a.
+ * Used to encode and decode NETPLAY_CMD_LOAD_SAVESTATE_DELTA.
+ */
+void netplay_xor_state(uint8_t *out, const uint8_t *a,
+      const uint8_t *b, size_t len);
+
 /**
  * netplay_delayed_state_change:
  *
@@ -840,6 +1050,13 @@ int netplay_poll_net_input(netplay_t *netplay, bool block);
  */
 void netplay_handle_slaves(netplay_t *netplay);
 
+/**
+ * netplay_relay_poll
+ *
+ * Accept, sync and serve the spectators connected to our relay
+ */
+void netplay_relay_poll(netplay_t *netplay);
+
 /**
  * netplay_announce_nat_traversal
  *
@@ -0,0 +1,805 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <compat/strl.h>
+#include <formats/rjson.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "performance_counters.h"
+#include "verbosity.h"
+
+#define PERF_SCOPE_NONE ((unsigned)-1)
+
+#define PERF_TRACE_THREADS_MAX 32
+#define PERF_TRACE_NAME_SIZE   32
+
+struct perf_scope
+{
+   const char *ident;
+   retro_time_t frame_total;
+   retro_time_t history[PERF_SCOPE_HISTORY];
+   unsigned frame_calls;
+   unsigned history_calls[PERF_SCOPE_HISTORY];
+   unsigned parent;
+   unsigned depth;
+};
+
+struct perf_scope_state
+{
+   struct perf_scope scopes[PERF_SCOPE_MAX];
+   retro_time_t stack_start[PERF_SCOPE_DEPTH];
+   unsigned stack[PERF_SCOPE_DEPTH];
+   bool stack_traced[PERF_SCOPE_DEPTH];
+   uint64_t frames;
+   unsigned count;
+   /* May exceed PERF_SCOPE_DEPTH, deeper scopes are not timed */
+   unsigned depth;
+};
+
+struct perf_trace_event
+{
+   retro_time_t ts;
+   char name[PERF_TRACE_NAME_SIZE];
+   uint8_t thread;
+   /* 'B' or 'E' */
+   char phase;
+};
+
+struct perf_trace_thread
+{
+   uintptr_t id;
+   char name[PERF_TRACE_NAME_SIZE];
+};
+
+struct perf_trace_state
+{
+   struct perf_trace_thread threads[PERF_TRACE_THREADS_MAX];
+   char path[PATH_MAX_LENGTH];
+   struct perf_trace_event *events;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   retro_time_t start;
+   retro_time_t end;
+   size_t count;
+   size_t dropped;
+   unsigned num_threads;
+   /* Read without the lock as a cheap early out */
+   volatile bool active;
+};
+
+/* Per-frame copies of all scope totals, 'totals' and
+ * 'calls' hold PERF_SCOPE_MAX entries per frame */
+struct perf_scope_capture
+{
+   retro_time_t *totals;
+   retro_time_t *frame_time;
+   unsigned *calls;
+   retro_time_t start;
+   retro_time_t last;
+   unsigned capacity;
+   unsigned count;
+   unsigned skip;
+};
+
+static struct perf_scope_state perf_scope_st;
+static struct perf_scope_capture perf_scope_cap;
+static struct perf_trace_state perf_trace_st;
+
+static unsigned perf_scope_register(const char *ident)
+{
+   struct perf_scope_state *st = &perf_scope_st;
+   struct perf_scope *scope    = NULL;
+
+   if (st->count >= PERF_SCOPE_MAX)
+      return 0;
+
+   scope         = &st->scopes[st->count];
+   scope->ident  = ident;
+   scope->depth  = MIN(st->depth, PERF_SCOPE_DEPTH);
+   scope->parent = st->depth
+      ? st->stack[MIN(st->depth, PERF_SCOPE_DEPTH) - 1]
+      : PERF_SCOPE_NONE;
+
+   return ++st->count;
+}
+
+void perf_scope_begin(unsigned *id, const char *ident)
+{
+   struct perf_scope_state *st = &perf_scope_st;
+
+   if (!*id)
+      *id = perf_scope_register(ident);
+
+   if (st->depth < PERF_SCOPE_DEPTH)
+   {
+      /* Slot 0 marks a scope that did not fit into the table */
+      st->stack[st->depth]        = *id ? *id - 1 : PERF_SCOPE_NONE;
+      st->stack_traced[st->depth] = perf_trace_st.active;
+      if (st->stack_traced[st->depth])
+         perf_trace_begin(ident);
+      st->stack_start[st->depth]  = cpu_features_get_time_usec();
+   }
+   st->depth++;
+}
+
+void perf_scope_end(void)
+{
+   unsigned idx;
+   struct perf_scope_state *st = &perf_scope_st;
+
+   if (!st->depth)
+      return;
+
+   if (--st->depth >= PERF_SCOPE_DEPTH)
+      return;
+
+   if (st->stack_traced[st->depth])
+      perf_trace_end();
+
+   idx = st->stack[st->depth];
+   if (idx != PERF_SCOPE_NONE)
+   {
+      struct perf_scope *scope = &st->scopes[idx];
+      scope->frame_total      += cpu_features_get_time_usec()
+         - st->stack_start[st->depth];
+      scope->frame_calls++;
+   }
+}
+
+static void perf_scope_capture_frame(void)
+{
+   unsigned i;
+   struct perf_scope_state *st    = &perf_scope_st;
+   struct perf_scope_capture *cap = &perf_scope_cap;
+   retro_time_t now               = cpu_features_get_time_usec();
+   size_t base;
+
+   if (cap->skip)
+   {
+      cap->skip--;
+      cap->start = cap->last = now;
+      return;
+   }
+
+   /* The first committed frame only starts the clock */
+   if (!cap->start)
+   {
+      cap->start = cap->last = now;
+      return;
+   }
+
+   if (cap->count >= cap->capacity)
+      return;
+
+   base                        = (size_t)cap->count * PERF_SCOPE_MAX;
+   cap->frame_time[cap->count] = now - cap->last;
+   cap->last                   = now;
+
+   for (i = 0; i < st->count; i++)
+   {
+      cap->totals[base + i] = st->scopes[i].frame_total;
+      cap->calls[base + i]  = st->scopes[i].frame_calls;
+   }
+
+   cap->count++;
+}
+
+void perf_scope_frame_end(void)
+{
+   unsigned i;
+   struct perf_scope_state *st = &perf_scope_st;
+   struct perf_scope_capture *cap = &perf_scope_cap;
+   unsigned slot               = (unsigned)(st->frames
+         & (PERF_SCOPE_HISTORY - 1));
+
+   if (cap->frame_time)
+      perf_scope_capture_frame();
+
+   for (i = 0; i < st->count; i++)
+   {
+      struct perf_scope *scope   = &st->scopes[i];
+      scope->history[slot]       = scope->frame_total;
+      scope->history_calls[slot] = scope->frame_calls;
+      scope->frame_total         = 0;
+      scope->frame_calls         = 0;
+   }
+
+   st->frames++;
+}
+
+unsigned perf_scope_count(void)
+{
+   return perf_scope_st.count;
+}
+
+static int perf_scope_compare(const void *a, const void *b)
+{
+   retro_time_t x = *(const retro_time_t*)a;
+   retro_time_t y = *(const retro_time_t*)b;
+   return (x > y) - (x < y);
+}
+
+/* Sorts @values in place */
+static void perf_scope_fill_stats(perf_scope_stats_t *stats,
+      retro_time_t *values, unsigned n)
+{
+   unsigned i;
+   retro_time_t accum = 0;
+
+   stats->frames = n;
+   stats->avg    = 0;
+   stats->min    = 0;
+   stats->p50    = 0;
+   stats->p90    = 0;
+   stats->p99    = 0;
+   stats->max    = 0;
+
+   if (!n)
+      return;
+
+   for (i = 0; i < n; i++)
+      accum += values[i];
+
+   qsort(values, n, sizeof(*values), perf_scope_compare);
+
+   stats->avg = accum / n;
+   stats->min = values[0];
+   stats->p50 = values[(n - 1) * 50 / 100];
+   stats->p90 = values[(n - 1) * 90 / 100];
+   stats->p99 = values[(n - 1) * 99 / 100];
+   stats->max = values[n - 1];
+}
+
+static void perf_scope_fill_info(perf_scope_stats_t *stats,
+      unsigned idx)
+{
+   const struct perf_scope *scope = &perf_scope_st.scopes[idx];
+
+   stats->ident  = scope->ident;
+   stats->depth  = scope->depth;
+   stats->parent = (scope->parent == PERF_SCOPE_NONE)
+      ? -1 : (int)scope->parent;
+}
+
+bool perf_scope_get_stats(unsigned idx, perf_scope_stats_t *stats)
+{
+   unsigned i, j;
+   retro_time_t values[PERF_SCOPE_HISTORY];
+   retro_time_t children             = 0;
+   unsigned calls                    = 0;
+   const struct perf_scope_state *st = &perf_scope_st;
+   const struct perf_scope *scope    = NULL;
+   unsigned n                        = (unsigned)MIN(st->frames,
+         PERF_SCOPE_HISTORY);
+
+   if (idx >= st->count)
+      return false;
+
+   scope = &st->scopes[idx];
+
+   for (i = 0; i < n; i++)
+   {
+      values[i] = scope->history[i];
+      calls    += scope->history_calls[i];
+   }
+
+   for (j = 0; j < st->count; j++)
+      if (st->scopes[j].parent == idx)
+         for (i = 0; i < n; i++)
+            children += st->scopes[j].history[i];
+
+   perf_scope_fill_info(stats, idx);
+   perf_scope_fill_stats(stats, values, n);
+   stats->calls = calls;
+   stats->self  = n ? stats->avg - children / n : 0;
+
+   return true;
+}
+
+bool perf_scope_capture_start(unsigned frames, unsigned skip)
+{
+   struct perf_scope_capture *cap = &perf_scope_cap;
+
+   perf_scope_capture_stop();
+
+   if (!frames)
+      return false;
+
+   cap->totals     = (retro_time_t*)calloc((size_t)frames * PERF_SCOPE_MAX,
+         sizeof(*cap->totals));
+   cap->calls      = (unsigned*)calloc((size_t)frames * PERF_SCOPE_MAX,
+         sizeof(*cap->calls));
+   cap->frame_time = (retro_time_t*)calloc(frames,
+         sizeof(*cap->frame_time));
+
+   if (!cap->totals || !cap->calls || !cap->frame_time)
+   {
+      perf_scope_capture_stop();
+      return false;
+   }
+
+   cap->capacity   = frames;
+   cap->count      = 0;
+   cap->skip       = skip;
+   cap->start      = 0;
+   cap->last       = 0;
+
+   return true;
+}
+
+void perf_scope_capture_stop(void)
+{
+   struct perf_scope_capture *cap = &perf_scope_cap;
+
+   free(cap->totals);
+   free(cap->calls);
+   free(cap->frame_time);
+
+   cap->totals     = NULL;
+   cap->calls      = NULL;
+   cap->frame_time = NULL;
+   cap->capacity   = 0;
+   cap->count      = 0;
+}
+
+unsigned perf_scope_capture_count(void)
+{
+   return perf_scope_cap.count;
+}
+
+retro_time_t perf_scope_capture_duration(void)
+{
+   const struct perf_scope_capture *cap = &perf_scope_cap;
+   return cap->count ? cap->last - cap->start : 0;
+}
+
+bool perf_scope_capture_get_stats(int idx, perf_scope_stats_t *stats)
+{
+   unsigned i, j;
+   retro_time_t *values                 = NULL;
+   retro_time_t children                = 0;
+   unsigned calls                       = 0;
+   const struct perf_scope_state *st    = &perf_scope_st;
+   const struct perf_scope_capture *cap = &perf_scope_cap;
+   unsigned n                           = cap->count;
+
+   if (idx >= (int)st->count || !cap->frame_time)
+      return false;
+
+   if (!(values = (retro_time_t*)malloc(
+               MAX(n, 1) * sizeof(*values))))
+      return false;
+
+   if (idx < 0)
+   {
+      memcpy(values, cap->frame_time, n * sizeof(*values));
+      stats->ident  = "frame";
+      stats->depth  = 0;
+      stats->parent = -1;
+      calls         = n;
+   }
+   else
+   {
+      for (i = 0; i < n; i++)
+      {
+         values[i] = cap->totals[i * PERF_SCOPE_MAX + idx];
+         calls    += cap->calls[i * PERF_SCOPE_MAX + idx];
+      }
+
+      for (j = 0; j < st->count; j++)
+         if (st->scopes[j].parent == (unsigned)idx)
+            for (i = 0; i < n; i++)
+               children += cap->totals[i * PERF_SCOPE_MAX + j];
+
+      perf_scope_fill_info(stats, idx);
+   }
+
+   perf_scope_fill_stats(stats, values, n);
+   stats->calls = calls;
+   stats->self  = (n && idx >= 0) ? stats->avg - children / n : stats->avg;
+
+   free(values);
+   return true;
+}
+
+static size_t perf_scope_report_children(char *s, size_t len,
+      size_t pos, unsigned parent, bool verbose)
+{
+   unsigned i;
+   const struct perf_scope_state *st = &perf_scope_st;
+
+   for (i = 0; i < st->count && pos < len; i++)
+   {
+      perf_scope_stats_t stats;
+
+      if (st->scopes[i].parent != parent)
+         continue;
+
+      perf_scope_get_stats(i, &stats);
+
+      if (verbose)
+         pos += snprintf(s + pos, len - pos,
+               "%*s%s calls=%u avg=%" PRId64 " p50=%" PRId64
+               " p99=%" PRId64 " max=%" PRId64 "\n",
+               (int)stats.depth, "", stats.ident, stats.calls,
+               (int64_t)stats.avg, (int64_t)stats.p50,
+               (int64_t)stats.p99, (int64_t)stats.max);
+      else
+         pos += snprintf(s + pos, len - pos,
+               " %*s-%s: %.2f / %.2f / %.2f ms\n",
+               (int)stats.depth, "", stats.ident,
+               stats.p50 / 1000.0f,
+               stats.p99 / 1000.0f,
+               stats.max / 1000.0f);
+
+      if (pos < len)
+         pos = perf_scope_report_children(s, len, pos, i, verbose);
+   }
+
+   return pos;
+}
+
+size_t perf_scope_report(char *s, size_t len, bool verbose)
+{
+   size_t pos;
+
+   if (!len)
+      return 0;
+
+   *s  = '\0';
+   pos = perf_scope_report_children(s, len, 0, PERF_SCOPE_NONE, verbose);
+
+   return MIN(pos, len - 1);
+}
+
+static unsigned perf_trace_thread_index(uintptr_t id)
+{
+   unsigned i;
+   struct perf_trace_state *st = &perf_trace_st;
+
+   for (i = 0; i < st->num_threads; i++)
+      if (st->threads[i].id == id)
+         return i;
+
+   /* Threads beyond the table share its last slot */
+   if (st->num_threads >= PERF_TRACE_THREADS_MAX)
+      return PERF_TRACE_THREADS_MAX - 1;
+
+   st->threads[st->num_threads].id      = id;
+   st->threads[st->num_threads].name[0] = '\0';
+
+   return st->num_threads++;
+}
+
+static uintptr_t perf_trace_thread_id(void)
+{
+#ifdef HAVE_THREADS
+   return sthread_get_current_thread_id();
+#else
+   return 0;
+#endif
+}
+
+static void perf_trace_lock(struct perf_trace_state *st)
+{
+#ifdef HAVE_THREADS
+   if (st->lock)
+      slock_lock(st->lock);
+#endif
+}
+
+static void perf_trace_unlock(struct perf_trace_state *st)
+{
+#ifdef HAVE_THREADS
+   if (st->lock)
+      slock_unlock(st->lock);
+#endif
+}
+
+static void perf_trace_push(const char *name, char phase)
+{
+   struct perf_trace_state *st = &perf_trace_st;
+   uintptr_t id                = perf_trace_thread_id();
+   retro_time_t ts             = cpu_features_get_time_usec();
+
+   perf_trace_lock(st);
+
+   if (st->active)
+   {
+      if (st->count < PERF_TRACE_EVENTS_MAX)
+      {
+         struct perf_trace_event *ev = &st->events[st->count++];
+
+         ev->ts     = ts;
+         ev->thread = (uint8_t)perf_trace_thread_index(id);
+         ev->phase  = phase;
+         if (name)
+            strlcpy(ev->name, name, sizeof(ev->name));
+         else
+            ev->name[0] = '\0';
+      }
+      else
+         st->dropped++;
+   }
+
+   perf_trace_unlock(st);
+}
+
+void perf_trace_begin(const char *name)
+{
+   if (perf_trace_st.active)
+      perf_trace_push(name, 'B');
+}
+
+void perf_trace_end(void)
+{
+   if (perf_trace_st.active)
+      perf_trace_push(NULL, 'E');
+}
+
+void perf_trace_set_thread_name(const char *name)
+{
+   unsigned idx;
+   struct perf_trace_state *st = &perf_trace_st;
+   uintptr_t id                = perf_trace_thread_id();
+
+   perf_trace_lock(st);
+
+   idx = perf_trace_thread_index(id);
+   if (!*st->threads[idx].name)
+      strlcpy(st->threads[idx].name, name, sizeof(st->threads[idx].name));
+
+   perf_trace_unlock(st);
+}
+
+bool perf_trace_is_active(void)
+{
+   return perf_trace_st.active;
+}
+
+const char *perf_trace_get_path(void)
+{
+   return perf_trace_st.path;
+}
+
+void perf_trace_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!perf_trace_st.lock)
+      perf_trace_st.lock = slock_new();
+#endif
+   perf_trace_set_thread_name("main");
+}
+
+void perf_trace_deinit(void)
+{
+   perf_trace_stop();
+#ifdef HAVE_THREADS
+   if (perf_trace_st.lock)
+      slock_free(perf_trace_st.lock);
+   perf_trace_st.lock = NULL;
+#endif
+   perf_trace_st.num_threads = 0;
+}
+
+bool perf_trace_start(const char *path, retro_time_t duration_usec)
+{
+   struct perf_trace_state *st     = &perf_trace_st;
+   struct perf_trace_event *events = NULL;
+
+   if (st->active || string_is_empty(path))
+      return false;
+
+   if (!(events = (struct perf_trace_event*)malloc(
+               PERF_TRACE_EVENTS_MAX * sizeof(*events))))
+      return false;
+
+   perf_trace_lock(st);
+   strlcpy(st->path, path, sizeof(st->path));
+   st->events  = events;
+   st->count   = 0;
+   st->dropped = 0;
+   st->start   = cpu_features_get_time_usec();
+   st->end     = duration_usec ? st->start + duration_usec : 0;
+   st->active  = true;
+   perf_trace_unlock(st);
+
+   RARCH_LOG("[Trace]: Recording to \"%s\".\n", path);
+
+   return true;
+}
+
+static void perf_trace_write_event(rjsonwriter_t *writer,
+      char phase, unsigned thread, int64_t ts, const char *name)
+{
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_start_object(writer);
+   rjsonwriter_add_string(writer, "ph");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string_len(writer, &phase, 1);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "pid");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, 1);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "tid");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, thread);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "ts");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_rawf(writer, "%" PRId64, ts);
+   if (name)
+   {
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "name");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, name);
+   }
+   rjsonwriter_add_end_object(writer);
+}
+
+static bool perf_trace_write(const struct perf_trace_state *st,
+      retro_time_t stop)
+{
+   size_t i;
+   unsigned t;
+   bool ret;
+   unsigned depth[PERF_TRACE_THREADS_MAX];
+   rjsonwriter_t *writer = NULL;
+   RFILE *file           = filestream_open(st->path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (!(writer = rjsonwriter_open_rfile(file)))
+   {
+      filestream_close(file);
+      return false;
+   }
+
+   memset(depth, 0, sizeof(depth));
+
+   /* Chrome trace event format, timestamps in usec */
+   rjsonwriter_add_start_object(writer);
+   rjsonwriter_add_string(writer, "displayTimeUnit");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, "ms");
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "traceEvents");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_start_array(writer);
+
+   for (t = 0; t < st->num_threads; t++)
+   {
+      char fallback[PERF_TRACE_NAME_SIZE];
+      const char *name = st->threads[t].name;
+
+      if (!*name)
+      {
+         snprintf(fallback, sizeof(fallback), "thread %u", t);
+         name = fallback;
+      }
+
+      if (t)
+         rjsonwriter_add_comma(writer);
+      rjsonwriter_add_newline(writer);
+      rjsonwriter_add_start_object(writer);
+      rjsonwriter_add_string(writer, "name");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, "thread_name");
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "ph");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, "M");
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "pid");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_unsigned(writer, 1);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "tid");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_unsigned(writer, t);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "args");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_start_object(writer);
+      rjsonwriter_add_string(writer, "name");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, name);
+      rjsonwriter_add_end_object(writer);
+      rjsonwriter_add_end_object(writer);
+   }
+
+   for (i = 0; i < st->count; i++)
+   {
+      const struct perf_trace_event *ev = &st->events[i];
+
+      /* Slices that were already open when recording started */
+      if (ev->phase == 'E')
+      {
+         if (!depth[ev->thread])
+            continue;
+         depth[ev->thread]--;
+      }
+      else
+         depth[ev->thread]++;
+
+      perf_trace_write_event(writer, ev->phase, ev->thread,
+            (int64_t)(ev->ts - st->start),
+            ev->phase == 'B' ? ev->name : NULL);
+   }
+
+   /* Close slices still open when recording stopped */
+   for (t = 0; t < PERF_TRACE_THREADS_MAX; t++)
+      for (; depth[t]; depth[t]--)
+         perf_trace_write_event(writer, 'E', t,
+               (int64_t)(stop - st->start), NULL);
+
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_end_array(writer);
+   rjsonwriter_add_end_object(writer);
+   rjsonwriter_add_newline(writer);
+
+   ret = rjsonwriter_free(writer);
+   filestream_close(file);
+
+   return ret;
+}
+
+bool perf_trace_stop(void)
+{
+   bool ret                    = false;
+   struct perf_trace_state *st = &perf_trace_st;
+   retro_time_t stop           = cpu_features_get_time_usec();
+
+   if (!st->active)
+      return false;
+
+   perf_trace_lock(st);
+   st->active = false;
+   perf_trace_unlock(st);
+
+   /* No thread touches the buffer once it is inactive */
+   if ((ret = perf_trace_write(st, stop)))
+      RARCH_LOG("[Trace]: Wrote %u events to \"%s\" (%u dropped).\n",
+            (unsigned)st->count, st->path, (unsigned)st->dropped);
+   else
+      RARCH_ERR("[Trace]: Failed to write \"%s\".\n", st->path);
+
+   free(st->events);
+   st->events = NULL;
+
+   return ret;
+}
+
+bool perf_trace_expired(retro_time_t now)
+{
+   return perf_trace_st.active
+      && perf_trace_st.end
+      && now >= perf_trace_st.end;
+}
@@ -81,6 +81,209 @@ void rarch_perf_register(struct retro_perf_counter *perf);
  **/
 #define performance_counter_stop_plus(is_perfcnt_enable, perf) performance_counter_stop_internal(is_perfcnt_enable, perf)
 
+/* Frame scopes
+ *
+ * Nestable wall-clock timers for the frontend main loop.
+ * A scope accumulates the time spent between perf_scope_begin()
+ * and perf_scope_end() during the current frame; perf_scope_frame_end()
+ * stores that total into a ring of the last PERF_SCOPE_HISTORY frames
+ * from which percentiles are computed on demand.
+ *
+ * The parent of a scope is the scope that was open when it was
+ * first entered. Scopes must be entered and left on the main thread
+ * and be properly nested. Begin/end cost one timer read each, so
+ * they are always enabled. */
+
+#ifndef PERF_SCOPE_MAX
+#define PERF_SCOPE_MAX 32
+#endif
+
+#ifndef PERF_SCOPE_DEPTH
+#define PERF_SCOPE_DEPTH 8
+#endif
+
+/* Must be a power of two */
+#ifndef PERF_SCOPE_HISTORY
+#define PERF_SCOPE_HISTORY 256
+#endif
+
+typedef struct perf_scope_stats
+{
+   const char *ident;
+   retro_time_t avg;
+   /* Average time not spent in child scopes */
+   retro_time_t self;
+   retro_time_t min;
+   retro_time_t p50;
+   retro_time_t p90;
+   retro_time_t p99;
+   retro_time_t max;
+   unsigned frames;
+   unsigned calls;
+   unsigned depth;
+   /* Index of the parent scope, -1 for top level scopes */
+   int parent;
+} perf_scope_stats_t;
+
+/**
+ * perf_scope_begin:
+ * @id                 : storage for the scope index, must be
+ *                       zero-initialised and persistent (static)
+ * @ident              : name of the scope, must outlive the scope
+ *
+ * Enters a scope, registering it on first use.
+ **/
+void perf_scope_begin(unsigned *id, const char *ident);
+
+/**
+ * perf_scope_end:
+ *
+ * Leaves the innermost open scope.
+ **/
+void perf_scope_end(void);
+
+/**
+ * perf_scope_frame_end:
+ *
+ * Commits the per-frame totals of all scopes to their
+ * history and starts a new frame. Call once per frame.
+ **/
+void perf_scope_frame_end(void);
+
+unsigned perf_scope_count(void);
+
+/**
+ * perf_scope_get_stats:
+ * @idx                : scope index, in registration order
+ * @stats              : filled in with the statistics over the
+ *                       frames still held in the history
+ *
+ * Returns: false if @idx is out of range.
+ **/
+bool perf_scope_get_stats(unsigned idx, perf_scope_stats_t *stats);
+
+/**
+ * perf_scope_report:
+ * @s                  : output buffer
+ * @len                : size of @s
+ * @verbose            : include call counts and averages
+ *
+ * Writes one line per scope in tree order, times in microseconds.
+ *
+ * Returns: number of characters written.
+ **/
+size_t perf_scope_report(char *s, size_t len, bool verbose);
+
+/**
+ * perf_scope_capture_start:
+ * @frames             : number of frames to record
+ * @skip               : number of frames to ignore first
+ *
+ * Records the totals of all scopes and the wall-clock time
+ * between calls to perf_scope_frame_end() for the next @frames
+ * frames, unlike the history this keeps every frame so
+ * percentiles cover the whole run. Used by the benchmark mode.
+ *
+ * Returns: false if the buffers could not be allocated.
+ **/
+bool perf_scope_capture_start(unsigned frames, unsigned skip);
+
+void perf_scope_capture_stop(void);
+
+/* Number of frames recorded so far */
+unsigned perf_scope_capture_count(void);
+
+/* Wall-clock time covered by the recorded frames */
+retro_time_t perf_scope_capture_duration(void);
+
+/**
+ * perf_scope_capture_get_stats:
+ * @idx                : scope index, or -1 for the frame time
+ * @stats              : filled in with the statistics over all
+ *                       recorded frames
+ *
+ * Returns: false if @idx is out of range or no capture
+ * was started.
+ **/
+bool perf_scope_capture_get_stats(int idx, perf_scope_stats_t *stats);
+
+#define PERF_SCOPE_BEGIN(ident) do { \
+   static unsigned perf_scope_id_; \
+   perf_scope_begin(&perf_scope_id_, ident); \
+} while (0)
+
+#define PERF_SCOPE_END() perf_scope_end()
+
+/* Trace recorder
+ *
+ * Records begin/end events from any thread for a limited
+ * time and writes them as Chrome trace event JSON, which
+ * chrome://tracing and ui.perfetto.dev can open. While a
+ * trace is running every frame scope is recorded as well. */
+
+#ifndef PERF_TRACE_EVENTS_MAX
+#define PERF_TRACE_EVENTS_MAX (1 << 18)
+#endif
+
+/**
+ * perf_trace_init:
+ *
+ * Sets up the recorder and names the calling thread "main".
+ * Must be called before any other thread records events.
+ **/
+void perf_trace_init(void);
+
+/**
+ * perf_trace_deinit:
+ *
+ * Writes a running trace and frees the recorder. Must
+ * be called after all recording threads have stopped.
+ **/
+void perf_trace_deinit(void);
+
+/**
+ * perf_trace_start:
+ * @path               : file the trace is written to
+ * @duration_usec      : recording time, 0 records until
+ *                       perf_trace_stop() is called
+ *
+ * Returns: true if recording started.
+ **/
+bool perf_trace_start(const char *path, retro_time_t duration_usec);
+
+/**
+ * perf_trace_stop:
+ *
+ * Stops recording and writes the trace file.
+ *
+ * Returns: true if a trace was written.
+ **/
+bool perf_trace_stop(void);
+
+/**
+ * perf_trace_expired:
+ * @now                : current time in microseconds
+ *
+ * Returns: true if a trace is running and its duration
+ * has elapsed, it should then be stopped.
+ **/
+bool perf_trace_expired(retro_time_t now);
+
+bool perf_trace_is_active(void);
+
+const char *perf_trace_get_path(void);
+
+/* Names the calling thread in the trace, unless it
+ * already has a name. */
+void perf_trace_set_thread_name(const char *name);
+
+/* Records the start of a slice on the calling thread;
+ * @name is copied. */
+void perf_trace_begin(const char *name);
+
+/* Ends the innermost slice of the calling thread */
+void perf_trace_end(void);
+
 RETRO_END_DECLS
 
 #endif
@@ -27,15 +27,24 @@
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
 #include <streams/interface_stream.h>
+#include <streams/file_stream.h>
+#include <encodings/crc32.h>
 #include <file/file_path.h>
 #include <lists/string_list.h>
 #include <formats/rjson.h>
 #include <array/rbuf.h>
+#include <array/rhmap.h>
+#include <queues/task_queue.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "playlist.h"
 #include "verbosity.h"
 #include "file_path_special.h"
 #include "core_info.h"
+#include "memory_tags.h"
 
 #if defined(ANDROID)
 #include "play_feature_delivery/play_feature_delivery.h"
@@ -56,6 +65,31 @@
 #define USING_POSIX_FILE_SYSTEM
 #endif
 
+/* Lookup index value: how many entries share a key,
+ * and the sequence number of the topmost one */
+typedef struct
+{
+   unsigned seq;
+   unsigned count;
+} playlist_index_item_t;
+
+/* Backing memory of entry strings, see playlist_strings_intern() */
+typedef struct playlist_string_block
+{
+   struct playlist_string_block *next;
+   char *data;
+   size_t size;
+   size_t used;
+} playlist_string_block_t;
+
+typedef struct
+{
+   playlist_string_block_t *blocks; /* current block first */
+   const char **slots;              /* set of interned strings */
+   size_t slot_count;               /* power of two */
+   size_t count;
+} playlist_strings_t;
+
 struct content_playlist
 {
    char *default_core_path;
@@ -64,6 +98,14 @@ struct content_playlist
 
    struct playlist_entry *entries;
 
+   /* Lookup indices (RHMAP), built on first use */
+   playlist_index_item_t *path_index;    /* real path -> entries      */
+   playlist_index_item_t *archive_index; /* archive of 'a.zip#b' path */
+   playlist_index_item_t *crc_index;     /* crc32 string -> entries   */
+
+   playlist_strings_t strings; /* storage of entry strings */
+   size_t entries_tagged;      /* bytes of 'entries' in the memory tag */
+
    playlist_config_t config;  /* size_t alignment */
 
    enum playlist_label_display_mode label_display_mode;
@@ -71,10 +113,16 @@ struct content_playlist
    enum playlist_thumbnail_mode left_thumbnail_mode;
    enum playlist_sort_mode sort_mode;
 
+   unsigned index_seq;  /* sequence number of entries[0] */
+   unsigned generation; /* see playlist_get_generation() */
+
    bool modified;
    bool old_format;
    bool compressed;
    bool cached_external;
+   bool index_seq_valid;
+   bool path_index_valid;
+   bool crc_index_valid;
 };
 
 typedef struct
@@ -352,6 +400,551 @@ static bool playlist_core_path_equal(const char *real_core_path, const char *ent
    return false;
 }
 
+/* Playlist lookup index
+ *
+ * Maps entry paths and CRCs to entries. Rather than storing
+ * array positions, which every push to the top of the list
+ * would shift, each entry gets a sequence number that decreases
+ * from the top (entries[0]) to the bottom of the playlist.
+ * Pushing or bumping an entry to the top gives it the next
+ * number, and deleting or evicting entries keeps the order,
+ * so the index only needs updating for the entries involved;
+ * positions are then found with a binary search. Sorting the
+ * playlist breaks the order and drops the index, which is
+ * rebuilt the next time it is needed. */
+
+/* Entries were added, removed, reordered or relabelled
+ * > Generations are unique across all playlists, so that
+ *   a playlist allocated at the address of a freed one
+ *   can't be mistaken for it */
+/* Reports growth of the entries buffer to the
+ * playlists memory tag, strings are counted as
+ * their blocks are allocated */
+static void playlist_tag_entries(playlist_t *playlist)
+{
+   size_t size = RBUF_CAP(playlist->entries)
+      * sizeof(struct playlist_entry);
+
+   memory_tag_add(MEMORY_TAG_PLAYLISTS,
+         (int64_t)size - (int64_t)playlist->entries_tagged);
+   playlist->entries_tagged = size;
+}
+
+static void playlist_entries_changed(playlist_t *playlist)
+{
+   static unsigned generation = 0;
+   playlist->generation       = ++generation;
+   playlist_tag_entries(playlist);
+}
+
+static void playlist_index_free_paths(playlist_t *playlist)
+{
+   RHMAP_FREE(playlist->path_index);
+   RHMAP_FREE(playlist->archive_index);
+   playlist->path_index_valid = false;
+}
+
+static void playlist_index_free_crcs(playlist_t *playlist)
+{
+   RHMAP_FREE(playlist->crc_index);
+   playlist->crc_index_valid = false;
+}
+
+static void playlist_index_reset(playlist_t *playlist)
+{
+   playlist_index_free_paths(playlist);
+   playlist_index_free_crcs(playlist);
+   playlist->index_seq_valid = false;
+}
+
+static void playlist_index_assign_seqs(playlist_t *playlist)
+{
+   size_t i;
+   size_t len = RBUF_LEN(playlist->entries);
+
+   if (playlist->index_seq_valid)
+      return;
+
+   for (i = 0; i < len; i++)
+      playlist->entries[i].index_seq = (unsigned)(len - i);
+
+   playlist->index_seq       = (unsigned)len;
+   playlist->index_seq_valid = true;
+}
+
+/* Returns the position of the entry with sequence
+ * number 'seq', or the size of the playlist if none */
+static size_t playlist_index_find_seq(playlist_t *playlist, unsigned seq)
+{
+   size_t lo = 0;
+   size_t hi = RBUF_LEN(playlist->entries);
+
+   while (lo < hi)
+   {
+      size_t mid     = lo + ((hi - lo) >> 1);
+      unsigned entry = playlist->entries[mid].index_seq;
+
+      if (entry == seq)
+         return mid;
+
+      if (entry > seq)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return RBUF_LEN(playlist->entries);
+}
+
+static void playlist_index_item_add(playlist_index_item_t **map,
+      const char *key, unsigned seq)
+{
+   /* The RHMAP macros need a plain lvalue */
+   playlist_index_item_t *items = *map;
+   uint32_t hash                = rhmap_hash_string(key);
+   ptrdiff_t idx                = RHMAP_IDX_FULL(items, hash, key);
+
+   if (idx < 0)
+   {
+      playlist_index_item_t *item = RHMAP_PTR_FULL(items, hash, key);
+      item->seq                   = seq;
+      item->count                 = 1;
+   }
+   else
+   {
+      items[idx].count++;
+      if (seq > items[idx].seq)
+         items[idx].seq = seq;
+   }
+
+   *map = items;
+}
+
+/* Returns false if the removed entry was the topmost of
+ * several sharing the key, in which case the map no longer
+ * knows which one to return and has to be rebuilt */
+static bool playlist_index_item_remove(playlist_index_item_t *map,
+      const char *key, unsigned seq)
+{
+   uint32_t hash = rhmap_hash_string(key);
+   ptrdiff_t idx = RHMAP_IDX_FULL(map, hash, key);
+
+   if (idx < 0)
+      return true;
+
+   if (map[idx].count <= 1)
+   {
+      (void)RHMAP_DEL_FULL(map, hash, key);
+      return true;
+   }
+
+   map[idx].count--;
+   return map[idx].seq != seq;
+}
+
+/* Key for a 'real' path, as compared by playlist_path_equal() */
+static void playlist_index_real_path_key(char *key)
+{
+#ifdef _WIN32
+   /* Handle case-insensitive operating systems */
+   string_to_lower(key);
+#else
+   (void)key;
+#endif
+}
+
+static void playlist_index_path_key(const char *path,
+      char *key, size_t len)
+{
+   key[0] = '\0';
+
+   if (string_is_empty(path))
+      return;
+
+   strlcpy(key, path, len);
+   path_resolve_realpath(key, len, true);
+   playlist_index_real_path_key(key);
+}
+
+/* Gets the [archive_path] part of a (non-archive)
+ * [archive_path][delimiter][rom_file] path key */
+static bool playlist_index_archive_key(const char *key,
+      char *archive_key, size_t len)
+{
+   const char *delim;
+
+   if (string_is_empty(key) || path_is_compressed_file(key))
+      return false;
+
+   if (!(delim = path_get_archive_delim(key)))
+      return false;
+
+   strlcpy(archive_key, key,
+         ((size_t)(delim - key) + 1 < len) ? (size_t)(delim - key) + 1 : len);
+   return true;
+}
+
+static void playlist_index_add_path(playlist_t *playlist,
+      const struct playlist_entry *entry)
+{
+   char key[PATH_MAX_LENGTH];
+   char archive_key[PATH_MAX_LENGTH];
+
+   playlist_index_path_key(entry->path, key, sizeof(key));
+   playlist_index_item_add(&playlist->path_index, key, entry->index_seq);
+
+   if (playlist_index_archive_key(key, archive_key, sizeof(archive_key)))
+      playlist_index_item_add(&playlist->archive_index,
+            archive_key, entry->index_seq);
+}
+
+static void playlist_index_add_entry(playlist_t *playlist,
+      const struct playlist_entry *entry)
+{
+   if (playlist->path_index_valid)
+      playlist_index_add_path(playlist, entry);
+
+   if (playlist->crc_index_valid && !string_is_empty(entry->crc32))
+      playlist_index_item_add(&playlist->crc_index,
+            entry->crc32, entry->index_seq);
+}
+
+static void playlist_index_remove_entry(playlist_t *playlist,
+      const struct playlist_entry *entry)
+{
+   if (playlist->path_index_valid)
+   {
+      char key[PATH_MAX_LENGTH];
+      char archive_key[PATH_MAX_LENGTH];
+      bool valid = true;
+
+      playlist_index_path_key(entry->path, key, sizeof(key));
+      valid = playlist_index_item_remove(playlist->path_index,
+            key, entry->index_seq);
+
+      if (playlist_index_archive_key(key, archive_key, sizeof(archive_key)))
+         valid = playlist_index_item_remove(playlist->archive_index,
+               archive_key, entry->index_seq) && valid;
+
+      if (!valid)
+         playlist_index_free_paths(playlist);
+   }
+
+   if (playlist->crc_index_valid && !string_is_empty(entry->crc32))
+      if (!playlist_index_item_remove(playlist->crc_index,
+               entry->crc32, entry->index_seq))
+         playlist_index_free_crcs(playlist);
+}
+
+static void playlist_index_item_set_top(playlist_index_item_t *map,
+      const char *key, unsigned seq)
+{
+   ptrdiff_t idx = RHMAP_IDX_STR(map, key);
+
+   if (idx >= 0)
+      map[idx].seq = seq;
+}
+
+/* Gives entries[0], just moved to the top of the
+ * list, the top sequence number */
+static void playlist_index_bump_entry(playlist_t *playlist)
+{
+   struct playlist_entry *entry = &playlist->entries[0];
+
+   if (!playlist->index_seq_valid)
+      return;
+
+   entry->index_seq = ++playlist->index_seq;
+
+   if (playlist->path_index_valid)
+   {
+      char key[PATH_MAX_LENGTH];
+      char archive_key[PATH_MAX_LENGTH];
+
+      playlist_index_path_key(entry->path, key, sizeof(key));
+      playlist_index_item_set_top(playlist->path_index,
+            key, entry->index_seq);
+
+      if (playlist_index_archive_key(key, archive_key, sizeof(archive_key)))
+         playlist_index_item_set_top(playlist->archive_index,
+               archive_key, entry->index_seq);
+   }
+
+   if (playlist->crc_index_valid && !string_is_empty(entry->crc32))
+      playlist_index_item_set_top(playlist->crc_index,
+            entry->crc32, entry->index_seq);
+}
+
+/* Registers entries[0], just pushed to the top of the list */
+static void playlist_index_push_entry(playlist_t *playlist)
+{
+   if (!playlist->index_seq_valid)
+      return;
+
+   playlist->entries[0].index_seq = ++playlist->index_seq;
+   playlist_index_add_entry(playlist, &playlist->entries[0]);
+}
+
+static void playlist_index_build_paths(playlist_t *playlist)
+{
+   size_t i, len;
+
+   if (playlist->path_index_valid)
+      return;
+
+   playlist_index_assign_seqs(playlist);
+   playlist->path_index_valid = true;
+
+   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+      playlist_index_add_path(playlist, &playlist->entries[i]);
+}
+
+static void playlist_index_build_crcs(playlist_t *playlist)
+{
+   size_t i, len;
+
+   if (playlist->crc_index_valid)
+      return;
+
+   playlist_index_assign_seqs(playlist);
+   playlist->crc_index_valid = true;
+
+   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+      if (!string_is_empty(playlist->entries[i].crc32))
+         playlist_index_item_add(&playlist->crc_index,
+               playlist->entries[i].crc32,
+               playlist->entries[i].index_seq);
+}
+
+static void playlist_index_lookup_item(playlist_index_item_t *map,
+      const char *key, unsigned *seq, unsigned *count)
+{
+   ptrdiff_t idx = RHMAP_IDX_STR(map, key);
+
+   if (idx < 0)
+      return;
+
+   *count += map[idx].count;
+   if (map[idx].seq > *seq)
+      *seq = map[idx].seq;
+}
+
+/**
+ * playlist_index_find_path:
+ * @playlist  : Playlist handle.
+ * @real_path : 'Real' search path, generated by path_resolve_realpath()
+ * @count     : Number of entries matching @real_path.
+ *
+ * Finds the first entry that playlist_path_equal() would
+ * match with @real_path. An empty @real_path matches entries
+ * with empty paths.
+ *
+ * Returns: index of the entry, or the size of the playlist
+ * if there is none.
+ **/
+static size_t playlist_index_find_path(playlist_t *playlist,
+      const char *real_path, unsigned *count)
+{
+   char key[PATH_MAX_LENGTH];
+   char archive_key[PATH_MAX_LENGTH];
+   unsigned seq = 0;
+
+   *count       = 0;
+
+   playlist_index_build_paths(playlist);
+
+   strlcpy(key, real_path, sizeof(key));
+   playlist_index_real_path_key(key);
+
+   playlist_index_lookup_item(playlist->path_index, key, &seq, count);
+
+#ifdef RARCH_INTERNAL
+   if (playlist->config.fuzzy_archive_match)
+#endif
+   {
+      /* See playlist_path_equal(): archive paths match
+       * [archive_path][delimiter][rom_file] paths */
+      if (!string_is_empty(key) && path_is_compressed_file(key))
+         playlist_index_lookup_item(playlist->archive_index,
+               key, &seq, count);
+      else if (playlist_index_archive_key(key,
+               archive_key, sizeof(archive_key)))
+         playlist_index_lookup_item(playlist->path_index,
+               archive_key, &seq, count);
+   }
+
+   if (!*count)
+      return RBUF_LEN(playlist->entries);
+
+   return playlist_index_find_seq(playlist, seq);
+}
+
+/* Entry strings (path, label, core, database, crc32 and
+ * subsystem) are not allocated one by one: they live in
+ * blocks owned by the playlist, which are released along
+ * with it. Identical values are stored once - most entries
+ * of a playlist share their core and database strings.
+ * Replaced values stay in their block, which only costs
+ * memory until the playlist is freed or cleared. */
+#define PLAYLIST_STRING_BLOCK_SIZE (64 * 1024)
+
+static void playlist_strings_free(playlist_strings_t *strings)
+{
+   playlist_string_block_t *block = strings->blocks;
+
+   while (block)
+   {
+      playlist_string_block_t *next = block->next;
+      memory_tag_add(MEMORY_TAG_PLAYLISTS, -(int64_t)block->size);
+      free(block->data);
+      free(block);
+      block = next;
+   }
+
+   if (strings->slots)
+      free((void*)strings->slots);
+   memory_tag_add(MEMORY_TAG_PLAYLISTS,
+         -(int64_t)(strings->slot_count * sizeof(*strings->slots)));
+
+   strings->blocks     = NULL;
+   strings->slots      = NULL;
+   strings->slot_count = 0;
+   strings->count      = 0;
+}
+
+/* Hands a full buffer allocated with malloc()
+ * over to the pool, e.g. the strings of a cache */
+static bool playlist_strings_adopt(playlist_strings_t *strings,
+      char *data, size_t size)
+{
+   playlist_string_block_t *block = (playlist_string_block_t*)
+      malloc(sizeof(*block));
+
+   if (!block)
+      return false;
+
+   block->data = data;
+   block->size = size;
+   block->used = size;
+
+   memory_tag_add(MEMORY_TAG_PLAYLISTS, (int64_t)size);
+
+   /* Keep the current block first */
+   if (strings->blocks)
+   {
+      block->next           = strings->blocks->next;
+      strings->blocks->next = block;
+   }
+   else
+   {
+      block->next           = NULL;
+      strings->blocks       = block;
+   }
+
+   return true;
+}
+
+static char *playlist_strings_alloc(playlist_strings_t *strings,
+      size_t len)
+{
+   playlist_string_block_t *block = strings->blocks;
+   char *s;
+
+   if (!block || block->size - block->used < len)
+   {
+      size_t size = MAX(len, PLAYLIST_STRING_BLOCK_SIZE);
+
+      if (!(block = (playlist_string_block_t*)malloc(sizeof(*block))))
+         return NULL;
+      if (!(block->data = (char*)malloc(size)))
+      {
+         free(block);
+         return NULL;
+      }
+
+      block->size     = size;
+      block->used     = 0;
+      block->next     = strings->blocks;
+      strings->blocks = block;
+
+      memory_tag_add(MEMORY_TAG_PLAYLISTS, (int64_t)size);
+   }
+
+   s            = block->data + block->used;
+   block->used += len;
+   return s;
+}
+
+static bool playlist_strings_grow(playlist_strings_t *strings)
+{
+   size_t i;
+   size_t slot_count  = strings->slot_count
+      ? strings->slot_count * 2 : 256;
+   const char **slots = (const char**)calloc(slot_count, sizeof(*slots));
+
+   if (!slots)
+      return false;
+
+   for (i = 0; i < strings->slot_count; i++)
+   {
+      size_t j;
+      const char *s = strings->slots[i];
+
+      if (!s)
+         continue;
+
+      for (j = rhmap_hash_string(s) & (slot_count - 1);
+            slots[j]; j = (j + 1) & (slot_count - 1));
+      slots[j] = s;
+   }
+
+   if (strings->slots)
+      free((void*)strings->slots);
+
+   memory_tag_add(MEMORY_TAG_PLAYLISTS, (int64_t)
+         ((slot_count - strings->slot_count) * sizeof(*slots)));
+
+   strings->slots      = slots;
+   strings->slot_count = slot_count;
+   return true;
+}
+
+/**
+ * playlist_strings_intern:
+ * @strings             : String pool of a playlist.
+ * @str                 : String to store.
+ *
+ * Returns: pooled copy of @str, which must not be
+ * freed, or NULL if @str is NULL or out of memory.
+ **/
+static char *playlist_strings_intern(playlist_strings_t *strings,
+      const char *str)
+{
+   size_t i, len;
+   char *s;
+
+   if (!str)
+      return NULL;
+
+   if (     (strings->count + 1) * 2 > strings->slot_count
+         && !playlist_strings_grow(strings))
+      return NULL;
+
+   for (i = rhmap_hash_string(str) & (strings->slot_count - 1);
+         strings->slots[i]; i = (i + 1) & (strings->slot_count - 1))
+      if (string_is_equal(strings->slots[i], str))
+         return (char*)strings->slots[i];
+
+   len = strlen(str) + 1;
+   if (!(s = playlist_strings_alloc(strings, len)))
+      return NULL;
+
+   memcpy(s, str, len);
+   strings->slots[i] = s;
+   strings->count++;
+   return s;
+}
+
 uint32_t playlist_get_size(playlist_t *playlist)
 {
    if (!playlist)
@@ -397,22 +990,7 @@ static void playlist_free_entry(struct playlist_entry *entry)
    if (!entry)
       return;
 
-   if (entry->path)
-      free(entry->path);
-   if (entry->label)
-      free(entry->label);
-   if (entry->core_path)
-      free(entry->core_path);
-   if (entry->core_name)
-      free(entry->core_name);
-   if (entry->db_name)
-      free(entry->db_name);
-   if (entry->crc32)
-      free(entry->crc32);
-   if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
-   if (entry->subsystem_name)
-      free(entry->subsystem_name);
+   /* Other strings belong to the playlist string pool */
    if (entry->runtime_str)
       free(entry->runtime_str);
    if (entry->last_played_str)
@@ -466,7 +1044,10 @@ void playlist_delete_index(playlist_t *playlist,
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
+   {
+      playlist_index_remove_entry(playlist, entry_to_delete);
       playlist_free_entry(entry_to_delete);
+   }
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
@@ -475,6 +1056,7 @@ void playlist_delete_index(playlist_t *playlist,
    RBUF_RESIZE(playlist->entries, len - 1);
 
    playlist->modified = true;
+   playlist_entries_changed(playlist);
 }
 
 /**
@@ -488,7 +1070,8 @@ void playlist_delete_index(playlist_t *playlist,
 void playlist_delete_by_path(playlist_t *playlist,
       const char *search_path)
 {
-   size_t i = 0;
+   size_t i;
+   unsigned matches;
    char real_search_path[PATH_MAX_LENGTH];
 
    real_search_path[0] = '\0';
@@ -500,28 +1083,17 @@ void playlist_delete_by_path(playlist_t *playlist,
    strlcpy(real_search_path, search_path, sizeof(real_search_path));
    path_resolve_realpath(real_search_path, sizeof(real_search_path), true);
 
-   while (i < RBUF_LEN(playlist->entries))
-   {
-      if (!playlist_path_equal(real_search_path, playlist->entries[i].path,
-            &playlist->config))
-      {
-         i++;
-         continue;
-      }
-
-      /* Paths are equal - delete entry */
+   while ((i = playlist_index_find_path(playlist,
+               real_search_path, &matches)) < RBUF_LEN(playlist->entries))
       playlist_delete_index(playlist, i);
-
-      /* Entries are shifted up by the delete
-       * operation - *do not* increment i */
-   }
 }
 
 void playlist_get_index_by_path(playlist_t *playlist,
       const char *search_path,
       const struct playlist_entry **entry)
 {
-   size_t i, len;
+   size_t i;
+   unsigned matches;
    char real_search_path[PATH_MAX_LENGTH];
 
    real_search_path[0] = '\0';
@@ -533,22 +1105,37 @@ void playlist_get_index_by_path(playlist_t *playlist,
    strlcpy(real_search_path, search_path, sizeof(real_search_path));
    path_resolve_realpath(real_search_path, sizeof(real_search_path), true);
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-   {
-      if (!playlist_path_equal(real_search_path, playlist->entries[i].path,
-               &playlist->config))
-         continue;
+   i = playlist_index_find_path(playlist, real_search_path, &matches);
 
+   if (i < RBUF_LEN(playlist->entries))
       *entry = &playlist->entries[i];
+}
 
-      break;
-   }
+void playlist_get_index_by_crc32(playlist_t *playlist,
+      const char *crc32,
+      const struct playlist_entry **entry)
+{
+   ptrdiff_t idx;
+   size_t i;
+
+   if (!playlist || !entry || string_is_empty(crc32))
+      return;
+
+   playlist_index_build_crcs(playlist);
+
+   if ((idx = RHMAP_IDX_STR(playlist->crc_index, crc32)) < 0)
+      return;
+
+   i = playlist_index_find_seq(playlist, playlist->crc_index[idx].seq);
+
+   if (i < RBUF_LEN(playlist->entries))
+      *entry = &playlist->entries[i];
 }
 
 bool playlist_entry_exists(playlist_t *playlist,
       const char *path)
 {
-   size_t i, len;
+   unsigned matches;
    char real_search_path[PATH_MAX_LENGTH];
 
    real_search_path[0] = '\0';
@@ -560,14 +1147,8 @@ bool playlist_entry_exists(playlist_t *playlist,
    strlcpy(real_search_path, path, sizeof(real_search_path));
    path_resolve_realpath(real_search_path, sizeof(real_search_path), true);
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-   {
-      if (playlist_path_equal(real_search_path, playlist->entries[i].path,
-               &playlist->config))
-         return true;
-   }
-
-   return false;
+   return playlist_index_find_path(playlist, real_search_path, &matches)
+         < RBUF_LEN(playlist->entries);
 }
 
 void playlist_update(playlist_t *playlist, size_t idx,
@@ -578,54 +1159,53 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (!playlist || idx >= RBUF_LEN(playlist->entries))
       return;
 
+   playlist_entries_changed(playlist);
+
    entry            = &playlist->entries[idx];
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
-      entry->path        = strdup(update_entry->path);
+      playlist_index_remove_entry(playlist, entry);
+      entry->path        = playlist_strings_intern(&playlist->strings,
+            update_entry->path);
+      playlist_index_add_entry(playlist, entry);
       playlist->modified = true;
    }
 
    if (update_entry->label && (update_entry->label != entry->label))
    {
-      if (entry->label)
-         free(entry->label);
-      entry->label       = strdup(update_entry->label);
+      entry->label       = playlist_strings_intern(&playlist->strings,
+            update_entry->label);
       playlist->modified = true;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
-      entry->core_path   = NULL;
-      entry->core_path   = strdup(update_entry->core_path);
+      entry->core_path   = playlist_strings_intern(&playlist->strings,
+            update_entry->core_path);
       playlist->modified = true;
    }
 
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
-      if (entry->core_name)
-         free(entry->core_name);
-      entry->core_name   = strdup(update_entry->core_name);
+      entry->core_name   = playlist_strings_intern(&playlist->strings,
+            update_entry->core_name);
       playlist->modified = true;
    }
 
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
-      if (entry->db_name)
-         free(entry->db_name);
-      entry->db_name     = strdup(update_entry->db_name);
+      entry->db_name     = playlist_strings_intern(&playlist->strings,
+            update_entry->db_name);
       playlist->modified = true;
    }
 
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
-      if (entry->crc32)
-         free(entry->crc32);
-      entry->crc32       = strdup(update_entry->crc32);
+      playlist_index_remove_entry(playlist, entry);
+      entry->crc32       = playlist_strings_intern(&playlist->strings,
+            update_entry->crc32);
+      playlist_index_add_entry(playlist, entry);
       playlist->modified = true;
    }
 }
@@ -643,19 +1223,17 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
-      entry->path        = NULL;
-      entry->path        = strdup(update_entry->path);
+      playlist_index_remove_entry(playlist, entry);
+      entry->path        = playlist_strings_intern(&playlist->strings,
+            update_entry->path);
+      playlist_index_add_entry(playlist, entry);
       playlist->modified = playlist->modified || register_update;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
-      entry->core_path   = NULL;
-      entry->core_path   = strdup(update_entry->core_path);
+      entry->core_path   = playlist_strings_intern(&playlist->strings,
+            update_entry->core_path);
       playlist->modified = playlist->modified || register_update;
    }
 
@@ -742,6 +1320,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       const struct playlist_entry *entry)
 {
    size_t i, len;
+   unsigned matches;
    char real_path[PATH_MAX_LENGTH];
    char real_core_path[PATH_MAX_LENGTH];
 
@@ -777,8 +1356,10 @@ bool playlist_push_runtime(playlist_t *playlist,
       return false;
    }
 
+   /* Only look at the entries with a matching path */
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   for (i = playlist_index_find_path(playlist, real_path, &matches);
+         matches && i < len; i++)
    {
       struct playlist_entry tmp;
       const char *entry_path = playlist->entries[i].path;
@@ -791,6 +1372,8 @@ bool playlist_push_runtime(playlist_t *playlist,
       if (!equal_path)
          continue;
 
+      matches--;
+
       if (!playlist_core_path_equal(real_core_path, playlist->entries[i].core_path, &playlist->config))
          continue;
 
@@ -804,6 +1387,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       memmove(playlist->entries + 1, playlist->entries,
             i * sizeof(struct playlist_entry));
       playlist->entries[0] = tmp;
+      playlist_index_bump_entry(playlist);
 
       goto success;
    }
@@ -814,6 +1398,7 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
+      playlist_index_remove_entry(playlist, last_entry);
       playlist_free_entry(last_entry);
       len--;
    }
@@ -834,9 +1419,11 @@ bool playlist_push_runtime(playlist_t *playlist,
       playlist->entries[0].core_path       = NULL;
 
       if (!string_is_empty(real_path))
-         playlist->entries[0].path      = strdup(real_path);
+         playlist->entries[0].path      = playlist_strings_intern(
+               &playlist->strings, real_path);
       if (!string_is_empty(real_core_path))
-         playlist->entries[0].core_path = strdup(real_core_path);
+         playlist->entries[0].core_path = playlist_strings_intern(
+               &playlist->strings, real_core_path);
 
       playlist->entries[0].runtime_status = entry->runtime_status;
       playlist->entries[0].runtime_hours = entry->runtime_hours;
@@ -856,10 +1443,13 @@ bool playlist_push_runtime(playlist_t *playlist,
          playlist->entries[0].runtime_str     = strdup(entry->runtime_str);
       if (!string_is_empty(entry->last_played_str))
          playlist->entries[0].last_played_str = strdup(entry->last_played_str);
+
+      playlist_index_push_entry(playlist);
    }
 
 success:
    playlist->modified = true;
+   playlist_entries_changed(playlist);
 
    return true;
 }
@@ -931,6 +1521,7 @@ bool playlist_push(playlist_t *playlist,
       const struct playlist_entry *entry)
 {
    size_t i, len;
+   unsigned matches;
    char real_path[PATH_MAX_LENGTH];
    char real_core_path[PATH_MAX_LENGTH];
    const char *core_name = entry->core_name;
@@ -981,8 +1572,10 @@ bool playlist_push(playlist_t *playlist,
       }
    }
 
+   /* Only look at the entries with a matching path */
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   for (i = playlist_index_find_path(playlist, real_path, &matches);
+         matches && i < len; i++)
    {
       struct playlist_entry tmp;
       const char *entry_path = playlist->entries[i].path;
@@ -995,6 +1588,8 @@ bool playlist_push(playlist_t *playlist,
       if (!equal_path)
          continue;
 
+      matches--;
+
       if (!playlist_core_path_equal(real_core_path, playlist->entries[i].core_path, &playlist->config))
          continue;
 
@@ -1063,114 +1658,587 @@ bool playlist_push(playlist_t *playlist,
        * fill in any blanks */
       if (!playlist->entries[i].label && !string_is_empty(entry->label))
       {
-         playlist->entries[i].label   = strdup(entry->label);
+         playlist->entries[i].label   = playlist_strings_intern(
+               &playlist->strings, entry->label);
          entry_updated                = true;
       }
       if (!playlist->entries[i].crc32 && !string_is_empty(entry->crc32))
       {
-         playlist->entries[i].crc32   = strdup(entry->crc32);
+         playlist->entries[i].crc32   = playlist_strings_intern(
+               &playlist->strings, entry->crc32);
          entry_updated                = true;
+
+         if (playlist->crc_index_valid)
+            playlist_index_item_add(&playlist->crc_index,
+                  entry->crc32, playlist->entries[i].index_seq);
       }
       if (!playlist->entries[i].db_name && !string_is_empty(entry->db_name))
       {
-         playlist->entries[i].db_name = strdup(entry->db_name);
+         playlist->entries[i].db_name = playlist_strings_intern(
+               &playlist->strings, entry->db_name);
          entry_updated                = true;
       }
 
-      /* If top entry, we don't want to push a new entry since
-       * the top and the entry to be pushed are the same. */
-      if (i == 0)
-      {
-         if (entry_updated)
-            goto success;
+      /* If top entry, we don't want to push a new entry since
+       * the top and the entry to be pushed are the same. */
+      if (i == 0)
+      {
+         if (entry_updated)
+            goto success;
+
+         return false;
+      }
+
+      /* Seen it before, bump to top. */
+      tmp = playlist->entries[i];
+      memmove(playlist->entries + 1, playlist->entries,
+            i * sizeof(struct playlist_entry));
+      playlist->entries[0] = tmp;
+      playlist_index_bump_entry(playlist);
+
+      goto success;
+   }
+
+   if (playlist->config.capacity == 0)
+      return false;
+
+   if (len == playlist->config.capacity)
+   {
+      struct playlist_entry *last_entry = &playlist->entries[len - 1];
+      playlist_index_remove_entry(playlist, last_entry);
+      playlist_free_entry(last_entry);
+      len--;
+   }
+   else
+   {
+      /* Allocate memory to fit one more item and resize the buffer */
+      if (!RBUF_TRYFIT(playlist->entries, len + 1))
+         return false; /* out of memory */
+      RBUF_RESIZE(playlist->entries, len + 1);
+   }
+
+   if (playlist->entries)
+   {
+      memmove(playlist->entries + 1, playlist->entries,
+            len * sizeof(struct playlist_entry));
+
+      playlist->entries[0].path               = NULL;
+      playlist->entries[0].label              = NULL;
+      playlist->entries[0].core_path          = NULL;
+      playlist->entries[0].core_name          = NULL;
+      playlist->entries[0].db_name            = NULL;
+      playlist->entries[0].crc32              = NULL;
+      playlist->entries[0].subsystem_ident    = NULL;
+      playlist->entries[0].subsystem_name     = NULL;
+      playlist->entries[0].runtime_str        = NULL;
+      playlist->entries[0].last_played_str    = NULL;
+      playlist->entries[0].subsystem_roms     = NULL;
+      playlist->entries[0].runtime_status     = PLAYLIST_RUNTIME_UNKNOWN;
+      playlist->entries[0].runtime_hours      = 0;
+      playlist->entries[0].runtime_minutes    = 0;
+      playlist->entries[0].runtime_seconds    = 0;
+      playlist->entries[0].last_played_year   = 0;
+      playlist->entries[0].last_played_month  = 0;
+      playlist->entries[0].last_played_day    = 0;
+      playlist->entries[0].last_played_hour   = 0;
+      playlist->entries[0].last_played_minute = 0;
+      playlist->entries[0].last_played_second = 0;
+      if (!string_is_empty(real_path))
+         playlist->entries[0].path            = playlist_strings_intern(
+               &playlist->strings, real_path);
+      if (!string_is_empty(entry->label))
+         playlist->entries[0].label           = playlist_strings_intern(
+               &playlist->strings, entry->label);
+      if (!string_is_empty(real_core_path))
+         playlist->entries[0].core_path       = playlist_strings_intern(
+               &playlist->strings, real_core_path);
+      if (!string_is_empty(core_name))
+         playlist->entries[0].core_name       = playlist_strings_intern(
+               &playlist->strings, core_name);
+      if (!string_is_empty(entry->db_name))
+         playlist->entries[0].db_name         = playlist_strings_intern(
+               &playlist->strings, entry->db_name);
+      if (!string_is_empty(entry->crc32))
+         playlist->entries[0].crc32           = playlist_strings_intern(
+               &playlist->strings, entry->crc32);
+      if (!string_is_empty(entry->subsystem_ident))
+         playlist->entries[0].subsystem_ident = playlist_strings_intern(
+               &playlist->strings, entry->subsystem_ident);
+      if (!string_is_empty(entry->subsystem_name))
+         playlist->entries[0].subsystem_name  = playlist_strings_intern(
+               &playlist->strings, entry->subsystem_name);
+
+      if (entry->subsystem_roms)
+      {
+         union string_list_elem_attr attributes = {0};
+
+         playlist->entries[0].subsystem_roms    = string_list_new();
+
+         for (i = 0; i < entry->subsystem_roms->size; i++)
+            string_list_append(playlist->entries[0].subsystem_roms, entry->subsystem_roms->elems[i].data, attributes);
+      }
+
+      playlist_index_push_entry(playlist);
+   }
+
+success:
+   playlist->modified = true;
+   playlist_entries_changed(playlist);
+
+   return true;
+}
+
+/* Binary cache of a playlist file, kept next to it with
+ * FILE_PATH_LPL_CACHE_EXTENSION. Entries are fixed size
+ * records whose strings are offsets into a string table,
+ * so loading it needs no parsing. It is rewritten each time
+ * the playlist is written, and whenever the playlist file
+ * had to be parsed because it changed behind our back. */
+#define PLAYLIST_CACHE_MAGIC   0x43504152 /* 'RAPC' */
+#define PLAYLIST_CACHE_VERSION 1
+
+#define PLAYLIST_CACHE_FLAG_OLD_FORMAT (1 << 0)
+#define PLAYLIST_CACHE_FLAG_COMPRESSED (1 << 1)
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   /* Size and modification time of the playlist file,
+    * a changed file invalidates the cache. Where the
+    * modification time is unknown, the CRC32 of the
+    * file is checked instead. */
+   uint32_t source_size;
+   uint32_t source_mtime_lo;
+   uint32_t source_mtime_hi;
+   uint32_t source_crc;
+   uint32_t flags;
+   uint32_t label_display_mode;
+   uint32_t right_thumbnail_mode;
+   uint32_t left_thumbnail_mode;
+   uint32_t sort_mode;
+   /* String table offsets, 0 is NULL */
+   uint32_t default_core_path;
+   uint32_t default_core_name;
+   uint32_t base_content_directory;
+   /* Followed by this many entry records, then
+    * subsystem ROM string offsets, then strings */
+   uint32_t entry_count;
+   uint32_t rom_count;
+   uint32_t strings_size;
+} playlist_cache_header_t;
+
+typedef struct
+{
+   uint32_t path;
+   uint32_t label;
+   uint32_t core_path;
+   uint32_t core_name;
+   uint32_t db_name;
+   uint32_t crc32;
+   uint32_t subsystem_ident;
+   uint32_t subsystem_name;
+   uint32_t subsystem_roms_first;
+   uint32_t subsystem_roms_count;
+   uint32_t runtime_hours;
+   uint32_t runtime_minutes;
+   uint32_t runtime_seconds;
+   uint32_t last_played_year;
+   uint32_t last_played_month;
+   uint32_t last_played_day;
+   uint32_t last_played_hour;
+   uint32_t last_played_minute;
+   uint32_t last_played_second;
+} playlist_cache_entry_t;
+
+typedef struct
+{
+   char *strings;  /* RBUF */
+   uint32_t *roms; /* RBUF */
+   bool out_of_memory;
+} playlist_cache_writer_t;
+
+static void playlist_get_cache_path(playlist_t *playlist,
+      char *s, size_t len)
+{
+   fill_pathname(s, playlist->config.path,
+         FILE_PATH_LPL_CACHE_EXTENSION, len);
+}
+
+static uint32_t playlist_cache_add_string(
+      playlist_cache_writer_t *writer, const char *str)
+{
+   size_t len, offset;
+
+   if (string_is_empty(str) || writer->out_of_memory)
+      return 0;
+
+   len    = strlen(str) + 1;
+   offset = RBUF_LEN(writer->strings);
+
+   if (!RBUF_TRYFIT(writer->strings, offset + len))
+   {
+      writer->out_of_memory = true;
+      return 0;
+   }
+
+   RBUF_RESIZE(writer->strings, offset + len);
+   memcpy(writer->strings + offset, str, len);
+   return (uint32_t)offset;
+}
+
+/**
+ * playlist_cache_write:
+ * @playlist            : Playlist handle.
+ *
+ * Writes the binary cache of the playlist file, which
+ * must hold exactly the current playlist contents.
+ **/
+static void playlist_cache_write(playlist_t *playlist)
+{
+   size_t i;
+   char cache_path[PATH_MAX_LENGTH];
+   playlist_cache_header_t header;
+   playlist_cache_writer_t writer;
+   size_t len                      = RBUF_LEN(playlist->entries);
+   playlist_cache_entry_t *records = NULL;
+   RFILE *file                     = NULL;
+   int32_t source_size             = path_get_size(playlist->config.path);
+   int64_t source_mtime            = path_get_mtime(playlist->config.path);
+
+   playlist_get_cache_path(playlist, cache_path, sizeof(cache_path));
+
+   if (source_size < 0)
+      return;
+
+   writer.strings       = NULL;
+   writer.roms          = NULL;
+   writer.out_of_memory = false;
+
+   /* Offset 0 is reserved for NULL strings */
+   if (!RBUF_TRYFIT(writer.strings, 1))
+      return;
+   RBUF_PUSH(writer.strings, '\0');
+
+   if (len && !(records = (playlist_cache_entry_t*)
+            malloc(len * sizeof(*records))))
+      goto end;
+
+   header.magic                  = PLAYLIST_CACHE_MAGIC;
+   header.version                = PLAYLIST_CACHE_VERSION;
+   header.source_size            = (uint32_t)source_size;
+   header.source_mtime_lo        = (uint32_t)source_mtime;
+   header.source_mtime_hi        = (uint32_t)((uint64_t)source_mtime >> 32);
+   header.source_crc             = source_mtime
+      ? 0 : file_crc32(0, playlist->config.path);
+   header.flags                  =
+           (playlist->old_format ? PLAYLIST_CACHE_FLAG_OLD_FORMAT : 0)
+         | (playlist->compressed ? PLAYLIST_CACHE_FLAG_COMPRESSED : 0);
+   header.label_display_mode     = (uint32_t)playlist->label_display_mode;
+   header.right_thumbnail_mode   = (uint32_t)playlist->right_thumbnail_mode;
+   header.left_thumbnail_mode    = (uint32_t)playlist->left_thumbnail_mode;
+   header.sort_mode              = (uint32_t)playlist->sort_mode;
+   header.default_core_path      = playlist_cache_add_string(&writer,
+         playlist->default_core_path);
+   header.default_core_name      = playlist_cache_add_string(&writer,
+         playlist->default_core_name);
+   header.base_content_directory = playlist_cache_add_string(&writer,
+         playlist->base_content_directory);
+   header.entry_count            = (uint32_t)len;
+
+   for (i = 0; i < len; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+      playlist_cache_entry_t *record     = &records[i];
+
+      record->path            = playlist_cache_add_string(&writer, entry->path);
+      record->label           = playlist_cache_add_string(&writer, entry->label);
+      record->crc32           = playlist_cache_add_string(&writer, entry->crc32);
+      record->subsystem_ident = playlist_cache_add_string(&writer, entry->subsystem_ident);
+      record->subsystem_name  = playlist_cache_add_string(&writer, entry->subsystem_name);
+
+      /* Core and database are usually the same as
+       * for the previous entry, store them once */
+      if (i > 0 && string_is_equal(entry->core_path, entry[-1].core_path))
+         record->core_path    = record[-1].core_path;
+      else
+         record->core_path    = playlist_cache_add_string(&writer, entry->core_path);
+
+      if (i > 0 && string_is_equal(entry->core_name, entry[-1].core_name))
+         record->core_name    = record[-1].core_name;
+      else
+         record->core_name    = playlist_cache_add_string(&writer, entry->core_name);
+
+      if (i > 0 && string_is_equal(entry->db_name, entry[-1].db_name))
+         record->db_name      = record[-1].db_name;
+      else
+         record->db_name      = playlist_cache_add_string(&writer, entry->db_name);
+
+      record->subsystem_roms_first = (uint32_t)RBUF_LEN(writer.roms);
+      record->subsystem_roms_count = 0;
+
+      if (entry->subsystem_roms)
+      {
+         size_t j;
+
+         for (j = 0; j < entry->subsystem_roms->size; j++)
+         {
+            const char *rom = entry->subsystem_roms->elems[j].data;
+
+            if (string_is_empty(rom))
+               continue;
+
+            if (!RBUF_TRYFIT(writer.roms, RBUF_LEN(writer.roms) + 1))
+            {
+               writer.out_of_memory = true;
+               break;
+            }
+            RBUF_PUSH(writer.roms, playlist_cache_add_string(&writer, rom));
+            record->subsystem_roms_count++;
+         }
+      }
+
+      record->runtime_hours      = entry->runtime_hours;
+      record->runtime_minutes    = entry->runtime_minutes;
+      record->runtime_seconds    = entry->runtime_seconds;
+      record->last_played_year   = entry->last_played_year;
+      record->last_played_month  = entry->last_played_month;
+      record->last_played_day    = entry->last_played_day;
+      record->last_played_hour   = entry->last_played_hour;
+      record->last_played_minute = entry->last_played_minute;
+      record->last_played_second = entry->last_played_second;
+   }
+
+   if (writer.out_of_memory)
+      goto end;
+
+   header.rom_count    = (uint32_t)RBUF_LEN(writer.roms);
+   header.strings_size = (uint32_t)RBUF_LEN(writer.strings);
+
+   if (!(file = filestream_open(cache_path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      goto end;
+
+   /* A partially written file fails the size check,
+    * but don't leave it around */
+   if (     filestream_write(file, &header, sizeof(header)) != sizeof(header)
+         || filestream_write(file, records, len * sizeof(*records))
+            != (int64_t)(len * sizeof(*records))
+         || filestream_write(file, writer.roms, RBUF_SIZEOF(writer.roms))
+            != (int64_t)RBUF_SIZEOF(writer.roms)
+         || filestream_write(file, writer.strings, header.strings_size)
+            != (int64_t)header.strings_size)
+   {
+      filestream_close(file);
+      filestream_delete(cache_path);
+      goto end;
+   }
+
+   filestream_close(file);
+
+end:
+   if (records)
+      free(records);
+   RBUF_FREE(writer.roms);
+   RBUF_FREE(writer.strings);
+}
+
+/**
+ * playlist_cache_read:
+ * @playlist            : Playlist handle.
+ * @source_size         : Size of the playlist file.
+ *
+ * Loads the playlist from its binary cache, provided
+ * this is up to date. The playlist must be empty.
+ * The string table becomes a block of the playlist
+ * string pool, entries point straight into it.
+ *
+ * Returns: true if the playlist was loaded.
+ **/
+static bool playlist_cache_read(playlist_t *playlist, int32_t source_size)
+{
+   size_t i, len, records_size;
+   playlist_cache_header_t header;
+   char cache_path[PATH_MAX_LENGTH];
+   const playlist_cache_entry_t *records = NULL;
+   const uint32_t *roms                  = NULL;
+   uint8_t *buf                          = NULL;
+   char *strings                         = NULL;
+   RFILE *file                           = NULL;
+   int64_t source_mtime                  = path_get_mtime(playlist->config.path);
+   bool success                          = false;
+
+   playlist_get_cache_path(playlist, cache_path, sizeof(cache_path));
+
+   if (!path_is_valid(cache_path))
+      return false;
+
+   if (!(file = filestream_open(cache_path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
 
-         return false;
-      }
+   if (filestream_read(file, &header, sizeof(header)) != sizeof(header))
+      goto end;
 
-      /* Seen it before, bump to top. */
-      tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-            i * sizeof(struct playlist_entry));
-      playlist->entries[0] = tmp;
+   records_size = (size_t)header.entry_count * sizeof(*records)
+      + (size_t)header.rom_count * sizeof(*roms);
+
+   if (     header.magic           != PLAYLIST_CACHE_MAGIC
+         || header.version         != PLAYLIST_CACHE_VERSION
+         || header.source_size     != (uint32_t)source_size
+         || header.source_mtime_lo != (uint32_t)source_mtime
+         || header.source_mtime_hi != (uint32_t)((uint64_t)source_mtime >> 32)
+         || header.strings_size    == 0
+         || filestream_get_size(file) != (int64_t)(sizeof(header)
+            + (uint64_t)header.entry_count * sizeof(*records)
+            + (uint64_t)header.rom_count   * sizeof(*roms)
+            + header.strings_size))
+      goto end;
 
-      goto success;
-   }
+   if (!source_mtime && header.source_crc !=
+         file_crc32(0, playlist->config.path))
+      goto end;
 
-   if (playlist->config.capacity == 0)
-      return false;
+   if (     (records_size && !(buf = (uint8_t*)malloc(records_size)))
+         || !(strings = (char*)malloc(header.strings_size)))
+      goto end;
 
-   if (len == playlist->config.capacity)
+   if (     filestream_read(file, buf, records_size) != (int64_t)records_size
+         || filestream_read(file, strings, header.strings_size)
+            != (int64_t)header.strings_size)
+      goto end;
+
+   records = (const playlist_cache_entry_t*)buf;
+   roms    = (const uint32_t*)(records + header.entry_count);
+
+   /* Every string must be terminated within the table */
+   if (strings[0] != '\0' || strings[header.strings_size - 1] != '\0')
+      goto end;
+
+#define PLAYLIST_CACHE_STRING_IS_VALID(offset) ((offset) < header.strings_size)
+
+   if (     !PLAYLIST_CACHE_STRING_IS_VALID(header.default_core_path)
+         || !PLAYLIST_CACHE_STRING_IS_VALID(header.default_core_name)
+         || !PLAYLIST_CACHE_STRING_IS_VALID(header.base_content_directory))
+      goto end;
+
+   for (i = 0; i < header.rom_count; i++)
+      if (!PLAYLIST_CACHE_STRING_IS_VALID(roms[i]))
+         goto end;
+
+   for (i = 0; i < header.entry_count; i++)
    {
-      struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
-      len--;
+      const playlist_cache_entry_t *record = &records[i];
+
+      if (     !PLAYLIST_CACHE_STRING_IS_VALID(record->path)
+            || !PLAYLIST_CACHE_STRING_IS_VALID(record->label)
+            || !PLAYLIST_CACHE_STRING_IS_VALID(record->core_path)
+            || !PLAYLIST_CACHE_STRING_IS_VALID(record->core_name)
+            || !PLAYLIST_CACHE_STRING_IS_VALID(record->db_name)
+            || !PLAYLIST_CACHE_STRING_IS_VALID(record->crc32)
+            || !PLAYLIST_CACHE_STRING_IS_VALID(record->subsystem_ident)
+            || !PLAYLIST_CACHE_STRING_IS_VALID(record->subsystem_name)
+            || record->subsystem_roms_first > header.rom_count
+            || record->subsystem_roms_count >
+               header.rom_count - record->subsystem_roms_first)
+         goto end;
    }
-   else
+
+#undef PLAYLIST_CACHE_STRING_IS_VALID
+
+   /* Same as when parsing, discard excess entries */
+   len = header.entry_count;
+   if (len > playlist->config.capacity)
    {
-      /* Allocate memory to fit one more item and resize the buffer */
-      if (!RBUF_TRYFIT(playlist->entries, len + 1))
-         return false; /* out of memory */
-      RBUF_RESIZE(playlist->entries, len + 1);
+      RARCH_WARN("Playlist cache contains more entries than current playlist capacity. Excess entries will be discarded.\n");
+      len                = playlist->config.capacity;
+      playlist->modified = true;
    }
 
-   if (playlist->entries)
-   {
-      memmove(playlist->entries + 1, playlist->entries,
-            len * sizeof(struct playlist_entry));
+   if (!RBUF_TRYFIT(playlist->entries, len))
+      goto end;
 
-      playlist->entries[0].path               = NULL;
-      playlist->entries[0].label              = NULL;
-      playlist->entries[0].core_path          = NULL;
-      playlist->entries[0].core_name          = NULL;
-      playlist->entries[0].db_name            = NULL;
-      playlist->entries[0].crc32              = NULL;
-      playlist->entries[0].subsystem_ident    = NULL;
-      playlist->entries[0].subsystem_name     = NULL;
-      playlist->entries[0].runtime_str        = NULL;
-      playlist->entries[0].last_played_str    = NULL;
-      playlist->entries[0].subsystem_roms     = NULL;
-      playlist->entries[0].runtime_status     = PLAYLIST_RUNTIME_UNKNOWN;
-      playlist->entries[0].runtime_hours      = 0;
-      playlist->entries[0].runtime_minutes    = 0;
-      playlist->entries[0].runtime_seconds    = 0;
-      playlist->entries[0].last_played_year   = 0;
-      playlist->entries[0].last_played_month  = 0;
-      playlist->entries[0].last_played_day    = 0;
-      playlist->entries[0].last_played_hour   = 0;
-      playlist->entries[0].last_played_minute = 0;
-      playlist->entries[0].last_played_second = 0;
-      if (!string_is_empty(real_path))
-         playlist->entries[0].path            = strdup(real_path);
-      if (!string_is_empty(entry->label))
-         playlist->entries[0].label           = strdup(entry->label);
-      if (!string_is_empty(real_core_path))
-         playlist->entries[0].core_path       = strdup(real_core_path);
-      if (!string_is_empty(core_name))
-         playlist->entries[0].core_name       = strdup(core_name);
-      if (!string_is_empty(entry->db_name))
-         playlist->entries[0].db_name         = strdup(entry->db_name);
-      if (!string_is_empty(entry->crc32))
-         playlist->entries[0].crc32           = strdup(entry->crc32);
-      if (!string_is_empty(entry->subsystem_ident))
-         playlist->entries[0].subsystem_ident = strdup(entry->subsystem_ident);
-      if (!string_is_empty(entry->subsystem_name))
-         playlist->entries[0].subsystem_name  = strdup(entry->subsystem_name);
+   if (!playlist_strings_adopt(&playlist->strings, strings,
+            header.strings_size))
+      goto end;
 
-      if (entry->subsystem_roms)
-      {
-         union string_list_elem_attr attributes = {0};
+   RBUF_RESIZE(playlist->entries, len);
 
-         playlist->entries[0].subsystem_roms    = string_list_new();
+#define PLAYLIST_CACHE_STRING(offset) ((offset) ? strings + (offset) : NULL)
 
-         for (i = 0; i < entry->subsystem_roms->size; i++)
-            string_list_append(playlist->entries[0].subsystem_roms, entry->subsystem_roms->elems[i].data, attributes);
+   for (i = 0; i < len; i++)
+   {
+      const playlist_cache_entry_t *record = &records[i];
+      struct playlist_entry *entry         = &playlist->entries[i];
+
+      memset(entry, 0, sizeof(*entry));
+
+      entry->path               = PLAYLIST_CACHE_STRING(record->path);
+      entry->label              = PLAYLIST_CACHE_STRING(record->label);
+      entry->core_path          = PLAYLIST_CACHE_STRING(record->core_path);
+      entry->core_name          = PLAYLIST_CACHE_STRING(record->core_name);
+      entry->db_name            = PLAYLIST_CACHE_STRING(record->db_name);
+      entry->crc32              = PLAYLIST_CACHE_STRING(record->crc32);
+      entry->subsystem_ident    = PLAYLIST_CACHE_STRING(record->subsystem_ident);
+      entry->subsystem_name     = PLAYLIST_CACHE_STRING(record->subsystem_name);
+      entry->runtime_hours      = record->runtime_hours;
+      entry->runtime_minutes    = record->runtime_minutes;
+      entry->runtime_seconds    = record->runtime_seconds;
+      entry->last_played_year   = record->last_played_year;
+      entry->last_played_month  = record->last_played_month;
+      entry->last_played_day    = record->last_played_day;
+      entry->last_played_hour   = record->last_played_hour;
+      entry->last_played_minute = record->last_played_minute;
+      entry->last_played_second = record->last_played_second;
+
+      if (record->subsystem_roms_count)
+      {
+         uint32_t j;
+         union string_list_elem_attr attr = {0};
+
+         if ((entry->subsystem_roms = string_list_new()))
+            for (j = 0; j < record->subsystem_roms_count; j++)
+               string_list_append(entry->subsystem_roms,
+                     strings + roms[record->subsystem_roms_first + j], attr);
       }
    }
 
-success:
-   playlist->modified = true;
+   if (header.default_core_path)
+      playlist->default_core_path      = strdup(
+            strings + header.default_core_path);
+   if (header.default_core_name)
+      playlist->default_core_name      = strdup(
+            strings + header.default_core_name);
+   if (header.base_content_directory)
+      playlist->base_content_directory = strdup(
+            strings + header.base_content_directory);
+
+#undef PLAYLIST_CACHE_STRING
+
+   playlist->label_display_mode     = (enum playlist_label_display_mode)
+      header.label_display_mode;
+   playlist->right_thumbnail_mode   = (enum playlist_thumbnail_mode)
+      header.right_thumbnail_mode;
+   playlist->left_thumbnail_mode    = (enum playlist_thumbnail_mode)
+      header.left_thumbnail_mode;
+   playlist->sort_mode              = (enum playlist_sort_mode)
+      header.sort_mode;
+   playlist->old_format             = (header.flags
+         & PLAYLIST_CACHE_FLAG_OLD_FORMAT) != 0;
+   playlist->compressed             = (header.flags
+         & PLAYLIST_CACHE_FLAG_COMPRESSED) != 0;
+
+   /* Now owned by the string pool */
+   strings = NULL;
+   success = true;
 
-   return true;
+end:
+   filestream_close(file);
+   if (buf)
+      free(buf);
+   if (strings)
+      free(strings);
+   return success;
 }
 
 void playlist_write_runtime_file(playlist_t *playlist)
@@ -1328,16 +2396,23 @@ void playlist_write_runtime_file(playlist_t *playlist)
    playlist->compressed      = false;
 
    RARCH_LOG("[Playlist]: Written to playlist file: %s\n", playlist->config.path);
+   intfstream_close(file);
+   free(file);
+
+   playlist_cache_write(playlist);
+   return;
+
 end:
    intfstream_close(file);
    free(file);
 }
 
-void playlist_write_file(playlist_t *playlist)
+static void playlist_write_file_internal(playlist_t *playlist)
 {
    size_t i, len;
    intfstream_t *file = NULL;
    bool compressed    = false;
+   bool success       = true;
 
    /* Playlist will be written if any of the
     * following are true:
@@ -1628,6 +2703,7 @@ void playlist_write_file(playlist_t *playlist)
       if (!rjsonwriter_free(writer))
       {
          RARCH_ERR("Failed to write to playlist file: %s\n", playlist->config.path);
+         success = false;
       }
 
       playlist->old_format = false;
@@ -1637,6 +2713,13 @@ void playlist_write_file(playlist_t *playlist)
    playlist->compressed = compressed;
 
    RARCH_LOG("[Playlist]: Written to playlist file: %s\n", playlist->config.path);
+   intfstream_close(file);
+   free(file);
+
+   if (success)
+      playlist_cache_write(playlist);
+   return;
+
 end:
    intfstream_close(file);
    free(file);
@@ -1680,9 +2763,309 @@ void playlist_free(playlist_t *playlist)
       RBUF_FREE(playlist->entries);
    }
 
+   playlist_tag_entries(playlist);
+   playlist_index_reset(playlist);
+   playlist_strings_free(&playlist->strings);
+
    free(playlist);
 }
 
+/* Deferred writes: playlist_write_file_deferred() hands a
+ * copy of the playlist to a task that writes it a little
+ * later, off the main thread. Until then, further deferred
+ * writes of the same file just replace that copy. Anything
+ * else that touches the file first writes out the copy,
+ * see playlist_write_deferred_flush_path(). */
+#define PLAYLIST_WRITE_DELAY_USEC 1000000
+
+typedef struct playlist_deferred_write
+{
+   struct playlist_deferred_write *next;
+   playlist_t *snapshot; /* NULL once written */
+   bool writing;         /* snapshot is being written */
+   char path[PATH_MAX_LENGTH];
+} playlist_deferred_write_t;
+
+/* TODO/FIXME - global state - perhaps move outside this file */
+static playlist_deferred_write_t *playlist_deferred_writes = NULL;
+#ifdef HAVE_THREADS
+static slock_t *playlist_deferred_lock                     = NULL;
+static scond_t *playlist_deferred_cond                     = NULL;
+
+#define PLAYLIST_DEFERRED_LOCK()   slock_lock(playlist_deferred_lock)
+#define PLAYLIST_DEFERRED_UNLOCK() slock_unlock(playlist_deferred_lock)
+#define PLAYLIST_DEFERRED_WAIT()   scond_wait(playlist_deferred_cond, playlist_deferred_lock)
+#define PLAYLIST_DEFERRED_SIGNAL() scond_broadcast(playlist_deferred_cond)
+#else
+#define PLAYLIST_DEFERRED_LOCK()
+#define PLAYLIST_DEFERRED_UNLOCK()
+#define PLAYLIST_DEFERRED_WAIT()
+#define PLAYLIST_DEFERRED_SIGNAL()
+#endif
+
+/* Copies everything playlist_write_file() writes */
+static playlist_t *playlist_clone(playlist_t *playlist)
+{
+   size_t i;
+   size_t len         = RBUF_LEN(playlist->entries);
+   playlist_t *clone  = (playlist_t*)calloc(1, sizeof(*clone));
+
+   if (!clone)
+      return NULL;
+
+   if (!playlist_config_copy(&playlist->config, &clone->config))
+      goto error;
+
+   if (playlist->default_core_path)
+      clone->default_core_path      = strdup(playlist->default_core_path);
+   if (playlist->default_core_name)
+      clone->default_core_name      = strdup(playlist->default_core_name);
+   if (playlist->base_content_directory)
+      clone->base_content_directory = strdup(playlist->base_content_directory);
+
+   clone->label_display_mode   = playlist->label_display_mode;
+   clone->right_thumbnail_mode = playlist->right_thumbnail_mode;
+   clone->left_thumbnail_mode  = playlist->left_thumbnail_mode;
+   clone->sort_mode            = playlist->sort_mode;
+   clone->old_format           = playlist->old_format;
+   clone->compressed           = playlist->compressed;
+   clone->modified             = true;
+
+   if (!RBUF_TRYFIT(clone->entries, len))
+      goto error;
+   RBUF_RESIZE(clone->entries, len);
+
+   for (i = 0; i < len; i++)
+   {
+      const struct playlist_entry *src = &playlist->entries[i];
+      struct playlist_entry *dst       = &clone->entries[i];
+
+      *dst                 = *src;
+      dst->path            = playlist_strings_intern(&clone->strings, src->path);
+      dst->label           = playlist_strings_intern(&clone->strings, src->label);
+      dst->core_path       = playlist_strings_intern(&clone->strings, src->core_path);
+      dst->core_name       = playlist_strings_intern(&clone->strings, src->core_name);
+      dst->db_name         = playlist_strings_intern(&clone->strings, src->db_name);
+      dst->crc32           = playlist_strings_intern(&clone->strings, src->crc32);
+      dst->subsystem_ident = playlist_strings_intern(&clone->strings, src->subsystem_ident);
+      dst->subsystem_name  = playlist_strings_intern(&clone->strings, src->subsystem_name);
+      dst->subsystem_roms  = src->subsystem_roms
+         ? string_list_clone(src->subsystem_roms) : NULL;
+      dst->runtime_str     = NULL;
+      dst->last_played_str = NULL;
+   }
+
+   playlist_tag_entries(clone);
+
+   return clone;
+
+error:
+   playlist_free(clone);
+   return NULL;
+}
+
+/* Writes out the pending copies of 'path', or of all
+ * files if NULL, and waits for those being written */
+static void playlist_write_deferred_flush_path(const char *path)
+{
+   for (;;)
+   {
+      playlist_t *snapshot             = NULL;
+      playlist_deferred_write_t *write = NULL;
+
+      PLAYLIST_DEFERRED_LOCK();
+      for (write = playlist_deferred_writes; write; write = write->next)
+         if (     (write->snapshot || write->writing)
+               && (!path || string_is_equal(write->path, path)))
+            break;
+
+      if (!write)
+      {
+         PLAYLIST_DEFERRED_UNLOCK();
+         return;
+      }
+
+      if (write->writing)
+      {
+         PLAYLIST_DEFERRED_WAIT();
+         PLAYLIST_DEFERRED_UNLOCK();
+         continue;
+      }
+
+      snapshot        = write->snapshot;
+      write->snapshot = NULL;
+      write->writing  = true;
+      PLAYLIST_DEFERRED_UNLOCK();
+
+      playlist_write_file_internal(snapshot);
+      playlist_free(snapshot);
+
+      PLAYLIST_DEFERRED_LOCK();
+      write->writing  = false;
+      PLAYLIST_DEFERRED_SIGNAL();
+      PLAYLIST_DEFERRED_UNLOCK();
+   }
+}
+
+static void task_playlist_write_handler(retro_task_t *task)
+{
+   playlist_deferred_write_t *write = (playlist_deferred_write_t*)task->state;
+   playlist_deferred_write_t **prev = NULL;
+   playlist_t *snapshot             = NULL;
+
+   PLAYLIST_DEFERRED_LOCK();
+   /* The copy may just be being written by a flush */
+   while (write->writing)
+      PLAYLIST_DEFERRED_WAIT();
+   snapshot        = write->snapshot;
+   write->snapshot = NULL;
+   write->writing  = (snapshot != NULL);
+   PLAYLIST_DEFERRED_UNLOCK();
+
+   if (snapshot)
+   {
+      playlist_write_file_internal(snapshot);
+      playlist_free(snapshot);
+   }
+
+   PLAYLIST_DEFERRED_LOCK();
+   for (prev = &playlist_deferred_writes; *prev; prev = &(*prev)->next)
+   {
+      if (*prev == write)
+      {
+         *prev = write->next;
+         break;
+      }
+   }
+   write->writing = false;
+   PLAYLIST_DEFERRED_SIGNAL();
+   PLAYLIST_DEFERRED_UNLOCK();
+
+   free(write);
+   task->state = NULL;
+   task_set_finished(task, true);
+}
+
+/**
+ * playlist_write_file_deferred:
+ * @playlist            : Playlist handle.
+ *
+ * Same as playlist_write_file(), but the file is written
+ * from a copy of the playlist on the task queue, about a
+ * second later. Writes of the same file requested in the
+ * meantime are folded into that one.
+ **/
+void playlist_write_file_deferred(playlist_t *playlist)
+{
+   playlist_deferred_write_t *write = NULL;
+   retro_task_t *task               = NULL;
+   playlist_t *snapshot             = NULL;
+   playlist_t *replaced             = NULL;
+
+   if (!playlist ||
+       !(playlist->modified ||
+#if defined(HAVE_ZLIB)
+        (playlist->compressed != playlist->config.compress) ||
+#endif
+        (playlist->old_format != playlist->config.old_format)))
+      return;
+
+#ifdef HAVE_THREADS
+   if (!playlist_deferred_lock)
+   {
+      playlist_deferred_lock = slock_new();
+      playlist_deferred_cond = scond_new();
+   }
+#endif
+
+   if (!(snapshot = playlist_clone(playlist)))
+      goto error;
+
+   PLAYLIST_DEFERRED_LOCK();
+   for (write = playlist_deferred_writes; write; write = write->next)
+   {
+      if (write->snapshot && string_is_equal(write->path,
+               playlist->config.path))
+      {
+         replaced        = write->snapshot;
+         write->snapshot = snapshot;
+         break;
+      }
+   }
+   PLAYLIST_DEFERRED_UNLOCK();
+
+   if (!write)
+   {
+      if (!(task = task_init()))
+         goto error;
+
+      if (!(write = (playlist_deferred_write_t*)calloc(1, sizeof(*write))))
+      {
+         free(task);
+         goto error;
+      }
+
+      strlcpy(write->path, playlist->config.path, sizeof(write->path));
+      write->snapshot = snapshot;
+
+      PLAYLIST_DEFERRED_LOCK();
+      write->next              = playlist_deferred_writes;
+      playlist_deferred_writes = write;
+      PLAYLIST_DEFERRED_UNLOCK();
+
+      task->handler = task_playlist_write_handler;
+      task->state   = write;
+      task->mute    = true;
+      task->when    = cpu_features_get_time_usec()
+         + PLAYLIST_WRITE_DELAY_USEC;
+
+      task_queue_push(task);
+   }
+
+   if (replaced)
+      playlist_free(replaced);
+
+   /* The playlist is as good as written */
+   playlist->modified   = false;
+   playlist->old_format = playlist->config.old_format;
+#if defined(HAVE_ZLIB)
+   playlist->compressed = playlist->config.compress;
+#endif
+   return;
+
+error:
+   if (snapshot)
+      playlist_free(snapshot);
+   playlist_write_file(playlist);
+}
+
+/**
+ * playlist_write_deferred_flush:
+ *
+ * Writes out all deferred playlist writes now. Must be
+ * called before the task queue is deinitialised.
+ **/
+void playlist_write_deferred_flush(void)
+{
+   playlist_write_deferred_flush_path(NULL);
+}
+
+/**
+ * playlist_write_file:
+ * @playlist            : Playlist handle.
+ *
+ * Writes the playlist file, if anything changed.
+ **/
+void playlist_write_file(playlist_t *playlist)
+{
+   if (!playlist)
+      return;
+
+   /* Don't let an older deferred write land on top */
+   playlist_write_deferred_flush_path(playlist->config.path);
+   playlist_write_file_internal(playlist);
+}
+
 /**
  * playlist_clear:
  * @playlist        	   : Playlist handle.
@@ -1703,6 +3086,9 @@ void playlist_clear(playlist_t *playlist)
          playlist_free_entry(entry);
    }
    RBUF_CLEAR(playlist->entries);
+   playlist_index_reset(playlist);
+   playlist_strings_free(&playlist->strings);
+   playlist_entries_changed(playlist);
 }
 
 /**
@@ -1712,6 +3098,13 @@ void playlist_clear(playlist_t *playlist)
  * Gets size of playlist.
  * Returns: size of playlist.
  **/
+unsigned playlist_get_generation(playlist_t *playlist)
+{
+   if (!playlist)
+      return 0;
+   return playlist->generation;
+}
+
 size_t playlist_size(playlist_t *playlist)
 {
    if (!playlist)
@@ -1844,11 +3237,8 @@ static bool JSONStringHandler(void *context, const char *pValue, size_t length)
       if (pCtx->array_depth == 1)
       {
          if (pCtx->current_string_val && length && !string_is_empty(pValue))
-         {
-            if (*pCtx->current_string_val)
-                free(*pCtx->current_string_val);
-             *pCtx->current_string_val = strdup(pValue);
-         }
+            *pCtx->current_string_val = playlist_strings_intern(
+                  &pCtx->playlist->strings, pValue);
       }
    }
    else if (pCtx->object_depth == 1)
@@ -2046,24 +3436,33 @@ static bool playlist_read_file(playlist_t *playlist)
 {
    unsigned i;
    int test_char;
-   bool res = true;
+   intfstream_t *file  = NULL;
+   bool res            = true;
+   bool parsed         = false;
+   int32_t source_size = path_get_size(playlist->config.path);
+
+   /* If playlist file does not exist,
+    * create an empty playlist instead */
+   if (source_size < 0)
+      return true;
+
+   if (playlist_cache_read(playlist, source_size))
+      return true;
 
 #if defined(HAVE_ZLIB)
       /* Always use RZIP interface when reading playlists
        * > this will automatically handle uncompressed
        *   data */
-   intfstream_t *file   = intfstream_open_rzip_file(
+   file                = intfstream_open_rzip_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ);
 #else
-   intfstream_t *file   = intfstream_open_file(
+   file                = intfstream_open_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
 #endif
 
-   /* If playlist file does not exist,
-    * create an empty playlist instead */
    if (!file)
       return true;
 
@@ -2146,6 +3545,8 @@ static bool playlist_read_file(playlist_t *playlist)
                   (*rjson_get_error(parser) ? rjson_get_error(parser) : "format error"));
          }
       }
+      else
+         parsed = true;
       rjson_free(parser);
    }
    else
@@ -2200,27 +3601,33 @@ static bool playlist_read_file(playlist_t *playlist)
 
             /* path */
             if (!string_is_empty(line_buf[0]))
-               entry->path      = strdup(line_buf[0]);
+               entry->path      = playlist_strings_intern(
+                     &playlist->strings, line_buf[0]);
 
             /* label */
             if (!string_is_empty(line_buf[1]))
-               entry->label     = strdup(line_buf[1]);
+               entry->label     = playlist_strings_intern(
+                     &playlist->strings, line_buf[1]);
 
             /* core_path */
             if (!string_is_empty(line_buf[2]))
-               entry->core_path = strdup(line_buf[2]);
+               entry->core_path = playlist_strings_intern(
+                     &playlist->strings, line_buf[2]);
 
             /* core_name */
             if (!string_is_empty(line_buf[3]))
-               entry->core_name = strdup(line_buf[3]);
+               entry->core_name = playlist_strings_intern(
+                     &playlist->strings, line_buf[3]);
 
             /* crc32 */
             if (!string_is_empty(line_buf[4]))
-               entry->crc32     = strdup(line_buf[4]);
+               entry->crc32     = playlist_strings_intern(
+                     &playlist->strings, line_buf[4]);
 
             /* db_name */
             if (!string_is_empty(line_buf[5]))
-               entry->db_name   = strdup(line_buf[5]);
+               entry->db_name   = playlist_strings_intern(
+                     &playlist->strings, line_buf[5]);
          }
          /* If fewer than 'PLAYLIST_ENTRIES' lines were
           * read, then this is metadata */
@@ -2343,11 +3750,19 @@ static bool playlist_read_file(playlist_t *playlist)
             break;
          }
       }
+
+      parsed = true;
    }
 
 end:
    intfstream_close(file);
    free(file);
+
+   /* Cache the playlist file unless entries were
+    * discarded, or may have been */
+   if (parsed && RBUF_LEN(playlist->entries) < playlist->config.capacity)
+      playlist_cache_write(playlist);
+
    return res;
 }
 
@@ -2408,6 +3823,19 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->default_core_path      = NULL;
    playlist->base_content_directory = NULL;
    playlist->entries                = NULL;
+   playlist->path_index             = NULL;
+   playlist->archive_index          = NULL;
+   playlist->crc_index              = NULL;
+   playlist->strings.blocks         = NULL;
+   playlist->strings.slots          = NULL;
+   playlist->strings.slot_count     = 0;
+   playlist->strings.count          = 0;
+   playlist->entries_tagged         = 0;
+   playlist->index_seq              = 0;
+   playlist->index_seq_valid        = false;
+   playlist->path_index_valid       = false;
+   playlist->crc_index_valid        = false;
+   playlist_entries_changed(playlist);
    playlist->label_display_mode     = LABEL_DISPLAY_MODE_DEFAULT;
    playlist->right_thumbnail_mode   = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
    playlist->left_thumbnail_mode    = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
@@ -2417,7 +3845,9 @@ playlist_t *playlist_init(const playlist_config_t *config)
    if (!playlist_config_copy(config, &playlist->config))
       goto error;
 
-   /* Attempt to read any existing playlist file */
+   /* Attempt to read any existing playlist file,
+    * after any deferred write of it is done */
+   playlist_write_deferred_flush_path(playlist->config.path);
    if (!playlist_read_file(playlist))
       goto error;
 
@@ -2444,8 +3874,8 @@ playlist_t *playlist_init(const playlist_config_t *config)
                playlist->base_content_directory, playlist->config.base_content_directory,
                sizeof(tmp_entry_path));
 
-            free(entry->path);
-            entry->path = strdup(tmp_entry_path);
+            entry->path = playlist_strings_intern(
+                  &playlist->strings, tmp_entry_path);
 
             /* Fix subsystem roms paths*/
             if (entry->subsystem_roms && (entry->subsystem_roms->size > 0))
@@ -2487,6 +3917,8 @@ playlist_t *playlist_init(const playlist_config_t *config)
       playlist_write_file(playlist);
    }
 
+   playlist_tag_entries(playlist);
+
    return playlist;
 
 error:
@@ -2585,6 +4017,10 @@ void playlist_qsort(playlist_t *playlist)
    qsort(playlist->entries, RBUF_LEN(playlist->entries),
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
+
+   /* Entries are no longer in index order */
+   playlist_index_reset(playlist);
+   playlist_entries_changed(playlist);
 }
 
 void command_playlist_push_write(
@@ -2595,7 +4031,7 @@ void command_playlist_push_write(
       return;
 
    if (playlist_push(playlist, entry))
-      playlist_write_file(playlist);
+      playlist_write_file_deferred(playlist);
 }
 
 void command_playlist_update_write(
@@ -2613,7 +4049,7 @@ void command_playlist_update_write(
          idx,
          entry);
 
-   playlist_write_file(playlist);
+   playlist_write_file_deferred(playlist);
 }
 
 bool playlist_index_is_valid(playlist_t *playlist, size_t idx,
@@ -2808,6 +4244,7 @@ void playlist_set_label_display_mode(playlist_t *playlist,
    {
       playlist->label_display_mode = label_display_mode;
       playlist->modified = true;
+      playlist_entries_changed(playlist);
    }
 }
 
@@ -111,6 +111,8 @@ struct playlist_entry
    unsigned last_played_hour;
    unsigned last_played_minute;
    unsigned last_played_second;
+   /* Used internally by the playlist lookup index */
+   unsigned index_seq;
    enum playlist_runtime_status runtime_status;
 };
 
@@ -179,6 +181,17 @@ void playlist_clear(playlist_t *playlist);
  **/
 size_t playlist_size(playlist_t *playlist);
 
+/**
+ * playlist_get_generation:
+ * @playlist        	   : Playlist handle.
+ *
+ * Gets a number that changes whenever entries
+ * are added, removed, reordered or relabelled,
+ * so that data derived from the entries can
+ * be cached.
+ **/
+unsigned playlist_get_generation(playlist_t *playlist);
+
 /**
  * playlist_capacity:
  * @playlist        	   : Playlist handle.
@@ -264,6 +277,10 @@ void playlist_get_index_by_path(playlist_t *playlist,
       const char *search_path,
       const struct playlist_entry **entry);
 
+void playlist_get_index_by_crc32(playlist_t *playlist,
+      const char *crc32,
+      const struct playlist_entry **entry);
+
 bool playlist_entry_exists(playlist_t *playlist,
       const char *path);
 
@@ -273,6 +290,16 @@ uint32_t playlist_get_size(playlist_t *playlist);
 
 void playlist_write_file(playlist_t *playlist);
 
+/* Same as playlist_write_file(), but the file is
+ * written about a second later on the task queue,
+ * from a copy of the playlist. Repeated writes of
+ * the same file in the meantime are folded into one */
+void playlist_write_file_deferred(playlist_t *playlist);
+
+/* Writes out all deferred playlist writes now.
+ * Must be called before the task queue is deinitialised */
+void playlist_write_deferred_flush(void);
+
 void playlist_write_runtime_file(playlist_t *playlist);
 
 void playlist_qsort(playlist_t *playlist);
@@ -544,6 +544,12 @@ fi
 check_header '' PARPORT linux/parport.h
 check_header '' PARPORT linux/ppdev.h
 
+if [ "$OS" = 'Linux' ]; then
+   check_header '' IO_URING linux/io_uring.h
+fi
+
+check_platform 'Linux' IO_URING 'io_uring is' user
+
 if [ "$OS" != 'Win32' ] && [ "$OS" != 'Linux' ]; then
    check_lib '' STRL "$CLIB" strlcpy
 fi
@@ -551,6 +557,14 @@ fi
 check_lib '' STRCASESTR "$CLIB" strcasestr
 check_lib '' MMAP "$CLIB" mmap
 
+if [ "$OS" = 'Win32' ]; then
+   add_opt MEMORY_WATCH yes
+elif [ "$OS" = 'Linux' ]; then
+   check_lib '' MEMORY_WATCH -lrt shm_open
+else
+   check_lib '' MEMORY_WATCH "$CLIB" shm_open
+fi
+
 check_enabled CXX VULKAN vulkan 'The C++ compiler is' false
 check_enabled CXX OPENGL_CORE 'OpenGL core' 'The C++ compiler is' false
 check_enabled THREADS VULKAN vulkan 'Threads are' false
@@ -146,6 +146,9 @@ HAVE_PRESERVE_DYLIB=no     # Enable dlclose() for Valgrind support
 HAVE_PARPORT=auto          # Parallel port joypad support
 HAVE_IMAGEVIEWER=yes       # Built-in image viewer support.
 HAVE_MMAP=auto             # MMAP support
+HAVE_IO_URING=auto         # io_uring file I/O (Linux)
+HAVE_MEMORY_WATCH=auto     # Shared memory mirror of core memory for external tools
+HAVE_MEMORY_TAGS=no        # Per subsystem memory accounting in statistics
 HAVE_QT=auto               # Qt companion support
 C89_QT=no
 HAVE_XSHM=auto             # XShm video driver support
@@ -72,6 +72,7 @@
 #include <retro_math.h>
 #include <retro_timers.h>
 #include <encodings/utf.h>
+#include <encodings/crc32.h>
 #include <time/rtime.h>
 
 #include <gfx/scaler/pixconv.h>
@@ -97,6 +98,9 @@
 #include <compat/posix_string.h>
 #include <streams/file_stream.h>
 #include <streams/interface_stream.h>
+#if defined(HAVE_BSV_MOVIE) && defined(HAVE_ZLIB)
+#include <streams/trans_stream.h>
+#endif
 #include <file/file_path.h>
 #include <retro_assert.h>
 #include <retro_miscellaneous.h>
@@ -106,6 +110,9 @@
 #ifdef HAVE_NETWORKING
 #include <net/net_http.h>
 #endif
+#ifdef HAVE_COMPRESSION
+#include <file/archive_file.h>
+#endif
 
 #ifdef WIIU
 #include <wiiu/os/energy.h>
@@ -171,6 +178,7 @@
 
 #include "input/input_keymaps.h"
 #include "input/input_remapping.h"
+#include "audio/audio_sample_accum.h"
 
 #ifdef HAVE_CHEEVOS
 #include "cheevos/cheevos.h"
@@ -196,6 +204,7 @@
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
 #endif
 
 #if defined(HAVE_OPENGL)
@@ -238,6 +247,9 @@
 #ifdef HAVE_CHEATS
 #include "cheat_manager.h"
 #endif
+#ifdef HAVE_MEMORY_WATCH
+#include "memory_watch.h"
+#endif
 #ifdef HAVE_REWIND
 #include "state_manager.h"
 #endif
@@ -249,6 +261,7 @@
 #include "tasks/task_powerstate.h"
 #include "tasks/tasks_internal.h"
 #include "performance_counters.h"
+#include "memory_tags.h"
 
 #include "version.h"
 #include "version_git.h"
@@ -458,6 +471,7 @@ static int16_t input_state_wrap(
       const input_device_driver_t *sec_joypad,
       rarch_joypad_info_t *joypad_info,
       const struct retro_keybind **binds,
+      const input_resolved_binds_t *resolved,
       bool keyboard_mapping_blocked,
       unsigned port,
       unsigned device,
@@ -482,32 +496,44 @@ static int16_t input_state_wrap(
       }
       else
       {
-         /* Do a bitwise OR to combine both input
-          * states together */
-         if (binds[port][id].valid)
+         uint16_t joykey           = NO_BTN;
+         uint32_t joyaxis          = AXIS_NONE;
+
+         if (resolved && id < RARCH_FIRST_CUSTOM_BIND)
+         {
+            joykey                 = resolved->joykey[id];
+            joyaxis                = resolved->joyaxis[id];
+         }
+         else if (binds[port][id].valid)
          {
             /* Auto-binds are per joypad, not per user. */
             const uint64_t bind_joykey     = binds[port][id].joykey;
             const uint64_t bind_joyaxis    = binds[port][id].joyaxis;
             const uint64_t autobind_joykey = joypad_info->auto_binds[id].joykey;
             const uint64_t autobind_joyaxis= joypad_info->auto_binds[id].joyaxis;
+            joykey                         = (bind_joykey != NO_BTN)
+               ? (uint16_t)bind_joykey  : (uint16_t)autobind_joykey;
+            joyaxis                        = (bind_joyaxis != AXIS_NONE)
+               ? (uint32_t)bind_joyaxis : (uint32_t)autobind_joyaxis;
+         }
+
+         /* Do a bitwise OR to combine both input
+          * states together */
+         if (joykey != NO_BTN || joyaxis != AXIS_NONE)
+         {
             uint16_t port                  = joypad_info->joy_idx;
             float axis_threshold           = joypad_info->axis_threshold;
-            const uint64_t joykey          = (bind_joykey != NO_BTN)
-               ? bind_joykey  : autobind_joykey;
-            const uint32_t joyaxis         = (bind_joyaxis != AXIS_NONE)
-               ? bind_joyaxis : autobind_joyaxis;
 
-            if ((uint16_t)joykey != NO_BTN && joypad->button(
-                     port, (uint16_t)joykey))
+            if (joykey != NO_BTN && joypad->button(
+                     port, joykey))
                return 1;
             if (joyaxis != AXIS_NONE &&
                   ((float)abs(joypad->axis(port, joyaxis))
                    / 0x8000) > axis_threshold)
                return 1;
 #ifdef HAVE_MFI
-            if ((uint16_t)joykey != NO_BTN && sec_joypad->button(
-                     port, (uint16_t)joykey))
+            if (joykey != NO_BTN && sec_joypad->button(
+                     port, joykey))
                return 1;
             if (joyaxis != AXIS_NONE &&
                   ((float)abs(sec_joypad->axis(port, joyaxis))
@@ -1950,9 +1976,15 @@ static int generic_menu_iterate(
             menu_list_t *menu_list     = menu_st->entries.list;
             file_list_t *selection_buf = menu_list ? MENU_LIST_GET_SELECTION(menu_list, (unsigned)0) : NULL;
             size_t selection           = menu_st->selection_ptr;
-            menu_file_list_cbs_t *cbs  = selection_buf ?
-               (menu_file_list_cbs_t*)selection_buf->list[selection].actiondata
-               : NULL;
+            menu_file_list_cbs_t *cbs  = NULL;
+
+            if (selection_buf)
+            {
+               menu_displaylist_playlist_fill(selection_buf,
+                     selection, selection);
+               cbs = (menu_file_list_cbs_t*)
+                  selection_buf->list[selection].actiondata;
+            }
 
             if (cbs && cbs->enum_idx != MSG_UNKNOWN)
             {
@@ -1989,15 +2021,17 @@ static int generic_menu_iterate(
 #endif
                   case MENU_ENUM_LABEL_CORE_MANAGER_ENTRY:
                      {
-                        core_info_t *core_info = NULL;
-                        const char *path       = selection_buf->list[selection].path;
+                        core_info_t *core_info         = NULL;
+                        core_info_details_t *details   = NULL;
+                        const char *path               = selection_buf->list[selection].path;
 
                         /* Search for specified core */
                         if (     path
                               && core_info_find(path, &core_info)
-                              && !string_is_empty(core_info->description))
+                              && (details = core_info_get_details(core_info))
+                              && !string_is_empty(details->description))
                            strlcpy(menu->menu_state_msg,
-                                 core_info->description,
+                                 details->description,
                                  sizeof(menu->menu_state_msg));
                         else
                            strlcpy(menu->menu_state_msg,
@@ -2460,13 +2494,19 @@ int generic_menu_entry_action(
    file_list_t *selection_buf     = menu_list ? MENU_LIST_GET_SELECTION(menu_list, (unsigned)0) : NULL;
    file_list_t *menu_stack        = menu_list ? MENU_LIST_GET(menu_list, (unsigned)0) : NULL;
    size_t selection_buf_size      = selection_buf ? selection_buf->size : 0;
-   menu_file_list_cbs_t *cbs      = selection_buf ?
-      (menu_file_list_cbs_t*)selection_buf->list[i].actiondata : NULL;
+   menu_file_list_cbs_t *cbs      = NULL;
 #ifdef HAVE_ACCESSIBILITY
    bool accessibility_enable      = settings->bools.accessibility_enable;
    unsigned accessibility_narrator_speech_speed = settings->uints.accessibility_narrator_speech_speed;
 #endif
 
+   if (selection_buf)
+   {
+      /* Actions need the callbacks of the entry */
+      menu_displaylist_playlist_fill(selection_buf, i, i);
+      cbs = (menu_file_list_cbs_t*)selection_buf->list[i].actiondata;
+   }
+
    switch (action)
    {
       case MENU_ACTION_UP:
@@ -2735,18 +2775,35 @@ void menu_entry_get(menu_entry_t *entry, size_t stack_idx,
    file_list_t *selection_buf  = MENU_ENTRIES_GET_SELECTION_BUF_PTR_INTERNAL(menu_st, stack_idx);
    file_list_t *list           = (userdata) ? (file_list_t*)userdata : selection_buf;
    bool path_enabled           = entry->path_enabled;
+   bool cache_sublabel         = true;
 
    newpath[0]                  = '\0';
 
    if (!list)
       return;
 
+   /* Entries of a virtual list are only filled in when
+    * their strings are needed - a sublabel on its own
+    * can be fetched with the shared callbacks */
+   if (menu_displaylist_playlist_is_virtual(list, i))
+   {
+      if (     path_enabled
+            || entry->label_enabled
+            || entry->rich_label_enabled
+            || entry->value_enabled)
+         menu_displaylist_playlist_fill(list, i, i);
+      else
+         cache_sublabel       = false;
+   }
+
    path                       = list->list[i].path;
    entry_label                = list->list[i].label;
    entry->type                = list->list[i].type;
    entry->entry_idx           = list->list[i].entry_idx;
 
-   cbs                        = (menu_file_list_cbs_t*)list->list[i].actiondata;
+   cbs                        = cache_sublabel
+      ? (menu_file_list_cbs_t*)list->list[i].actiondata
+      : (menu_file_list_cbs_t*)menu_displaylist_playlist_cbs();
    entry->idx                 = (unsigned)i;
 
    if (entry->label_enabled && !string_is_empty(entry_label))
@@ -2814,7 +2871,8 @@ void menu_entry_get(menu_entry_t *entry, size_t stack_idx,
                      entry->type, (unsigned)i,
                      label, path,
                      entry->sublabel,
-                     sizeof(entry->sublabel)) > 0)
+                     sizeof(entry->sublabel)) > 0
+                  && cache_sublabel)
                strlcpy(cbs->action_sublabel_cache,
                      entry->sublabel,
                      sizeof(cbs->action_sublabel_cache));
@@ -2942,18 +3000,14 @@ static menu_list_t *menu_list_new(const menu_ctx_driver_t *menu_driver_ctx)
    {
       list->menu_stack[i]           = (file_list_t*)
          malloc(sizeof(*list->menu_stack[i]));
-      list->menu_stack[i]->list     = NULL;
-      list->menu_stack[i]->capacity = 0;
-      list->menu_stack[i]->size     = 0;
+      file_list_initialize(list->menu_stack[i]);
    }
 
    for (i = 0; i < list->selection_buf_size; i++)
    {
       list->selection_buf[i]           = (file_list_t*)
          malloc(sizeof(*list->selection_buf[i]));
-      list->selection_buf[i]->list     = NULL;
-      list->selection_buf[i]->capacity = 0;
-      list->selection_buf[i]->size     = 0;
+      file_list_initialize(list->selection_buf[i]);
    }
 
    return list;
@@ -3060,10 +3114,19 @@ static void menu_list_flush_stack(
 static int menu_entries_elem_get_first_char(
       file_list_t *list, unsigned offset)
 {
+   char virtual_label[PATH_MAX_LENGTH];
    const char *path =   list->list[offset].alt
                       ? list->list[offset].alt
                       : list->list[offset].path;
-   int ret          = path ? TOLOWER((int)*path) : 0;
+   int ret;
+
+   /* Don't fill in entries of a virtual list just to
+    * build the scroll indices */
+   if (!path && menu_displaylist_playlist_get_label(list, offset,
+            virtual_label, sizeof(virtual_label)))
+      path          = virtual_label;
+
+   ret              = path ? TOLOWER((int)*path) : 0;
 
    /* "Normalize" non-alphabetical entries so they
     * are lumped together for purposes of jumping. */
@@ -3230,6 +3293,70 @@ file_list_t *menu_entries_get_selection_buf_ptr(size_t idx)
    return MENU_LIST_GET_SELECTION(menu_list, (unsigned)idx);
 }
 
+/* Menu entry callbacks of a cleared list are kept in a
+ * pool and handed out again while the next list is built,
+ * so rebuilding a list of the same size does not allocate */
+static menu_file_list_cbs_t *menu_cbs_pool_get(struct menu_state *menu_st)
+{
+   if (menu_st->cbs_pool.size)
+      return menu_st->cbs_pool.items[--menu_st->cbs_pool.size];
+   return (menu_file_list_cbs_t*)malloc(sizeof(menu_file_list_cbs_t));
+}
+
+static void menu_cbs_pool_trim(struct menu_state *menu_st)
+{
+   size_t i;
+
+   for (i = 0; i < menu_st->cbs_pool.size; i++)
+      free(menu_st->cbs_pool.items[i]);
+   menu_st->cbs_pool.size = 0;
+}
+
+static void menu_cbs_pool_refill(struct menu_state *menu_st,
+      file_list_t *list)
+{
+   size_t i;
+
+   /* Whatever the previous list build did not take back
+    * is not needed anymore */
+   menu_cbs_pool_trim(menu_st);
+
+   if (list->size > menu_st->cbs_pool.capacity)
+   {
+      menu_file_list_cbs_t **items = (menu_file_list_cbs_t**)realloc(
+            menu_st->cbs_pool.items, list->size * sizeof(*items));
+
+      if (items)
+      {
+         menu_st->cbs_pool.items    = items;
+         menu_st->cbs_pool.capacity = list->size;
+      }
+   }
+
+   for (i = 0; i < list->size; i++)
+   {
+      menu_file_list_cbs_t *cbs = (menu_file_list_cbs_t*)
+         list->list[i].actiondata;
+
+      if (!cbs)
+         continue;
+
+      if (menu_st->cbs_pool.size < menu_st->cbs_pool.capacity)
+         menu_st->cbs_pool.items[menu_st->cbs_pool.size++] = cbs;
+      else
+         free(cbs);
+      list->list[i].actiondata = NULL;
+   }
+}
+
+static void menu_cbs_pool_free(struct menu_state *menu_st)
+{
+   menu_cbs_pool_trim(menu_st);
+   free(menu_st->cbs_pool.items);
+   menu_st->cbs_pool.items    = NULL;
+   menu_st->cbs_pool.capacity = 0;
+}
+
 static void menu_entries_list_deinit(
       const menu_ctx_driver_t *menu_driver_ctx,
       struct menu_state *menu_st)
@@ -3237,13 +3364,14 @@ static void menu_entries_list_deinit(
    if (menu_st->entries.list)
       menu_list_free(menu_driver_ctx, menu_st->entries.list);
    menu_st->entries.list          = NULL;
+   menu_cbs_pool_free(menu_st);
 }
 
 static void menu_entries_settings_deinit(struct menu_state *menu_st)
 {
    menu_setting_free(menu_st->entries.list_settings);
    if (menu_st->entries.list_settings)
-      free(menu_st->entries.list_settings);
+      memory_tag_free(MEMORY_TAG_MENU, menu_st->entries.list_settings);
    menu_st->entries.list_settings = NULL;
 }
 
@@ -3255,8 +3383,8 @@ static bool menu_entries_init(
 {
    if (!(menu_st->entries.list = (menu_list_t*)menu_list_new(menu_driver_ctx)))
       return false;
-   if (!(menu_st->entries.list_settings = menu_setting_new()))
-      return false;
+   /* The settings list is built on first use, see
+    * MENU_ENTRIES_CTL_SETTINGS_GET */
    return true;
 }
 
@@ -3289,7 +3417,7 @@ void menu_entries_append(
    list_info.fullpath = NULL;
 
    if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
+      list_info.fullpath = menu_path;
 
    list_info.label       = label;
    list_info.idx         = idx;
@@ -3306,12 +3434,8 @@ void menu_entries_append(
             list_info.idx,
             list_info.entry_type);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
-   cbs                             = (menu_file_list_cbs_t*)
-      malloc(sizeof(menu_file_list_cbs_t));
+   cbs                             = menu_cbs_pool_get(menu_st);
 
    if (!cbs)
       return;
@@ -3376,7 +3500,7 @@ bool menu_entries_append_enum(
    list_info.fullpath    = NULL;
 
    if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
+      list_info.fullpath = menu_path;
    list_info.list        = list;
    list_info.path        = path;
    list_info.label       = label;
@@ -3394,12 +3518,8 @@ bool menu_entries_append_enum(
             list_info.idx,
             list_info.entry_type);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
-   cbs                             = (menu_file_list_cbs_t*)
-      malloc(sizeof(menu_file_list_cbs_t));
+   cbs                             = menu_cbs_pool_get(menu_st);
 
    if (!cbs)
       return false;
@@ -3443,6 +3563,44 @@ bool menu_entries_append_enum(
    return true;
 }
 
+bool menu_entries_append_virtual(
+      file_list_t *list,
+      unsigned type,
+      size_t directory_ptr,
+      size_t entry_idx)
+{
+   size_t idx;
+   const char *menu_path           = NULL;
+   struct rarch_state   *p_rarch   = &rarch_st;
+   struct menu_state    *menu_st   = &p_rarch->menu_driver_state;
+
+   if (!list)
+      return false;
+
+   if (!file_list_append(list, NULL, NULL, type, directory_ptr, entry_idx))
+      return false;
+   file_list_get_last(MENU_LIST_GET(menu_st->entries.list, 0),
+         &menu_path, NULL, NULL, NULL);
+
+   idx                             = list->size - 1;
+
+   /* Drivers still get a node for every entry, so that
+    * their layout and scrolling code is unchanged */
+   if (  p_rarch->menu_driver_ctx &&
+         p_rarch->menu_driver_ctx->list_insert)
+      p_rarch->menu_driver_ctx->list_insert(
+            p_rarch->menu_userdata,
+            list,
+            NULL,
+            string_is_empty(menu_path) ? NULL : menu_path,
+            NULL,
+            idx,
+            type);
+
+   file_list_free_actiondata(list, idx);
+   return true;
+}
+
 void menu_entries_prepend(file_list_t *list,
       const char *path, const char *label,
       enum msg_hash_enums enum_idx,
@@ -3465,7 +3623,7 @@ void menu_entries_prepend(file_list_t *list,
    list_info.fullpath    = NULL;
 
    if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
+      list_info.fullpath = menu_path;
    list_info.list        = list;
    list_info.path        = path;
    list_info.label       = label;
@@ -3483,12 +3641,8 @@ void menu_entries_prepend(file_list_t *list,
             list_info.idx,
             list_info.entry_type);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
-   cbs                             = (menu_file_list_cbs_t*)
-      malloc(sizeof(menu_file_list_cbs_t));
+   cbs                             = menu_cbs_pool_get(menu_st);
 
    if (!cbs)
       return;
@@ -3621,6 +3775,10 @@ bool menu_entries_ctl(enum menu_entries_ctl_state state, void *data)
             rarch_setting_t **settings  = (rarch_setting_t**)data;
             if (!settings)
                return false;
+            /* Built lazily; content launched straight from the
+             * command line may never need it */
+            if (!menu_st->entries.list_settings && menu_st->entries.list)
+               menu_st->entries.list_settings = menu_setting_new();
             *settings = menu_st->entries.list_settings;
          }
          break;
@@ -3706,12 +3864,7 @@ bool menu_entries_ctl(enum menu_entries_ctl_state state, void *data)
             if (p_rarch->menu_driver_ctx->list_clear)
                p_rarch->menu_driver_ctx->list_clear(list);
 
-            for (i = 0; i < list->size; i++)
-            {
-               if (list->list[i].actiondata)
-                  free(list->list[i].actiondata);
-               list->list[i].actiondata = NULL;
-            }
+            menu_cbs_pool_refill(menu_st, list);
 
             file_list_clear(list);
          }
@@ -4169,7 +4322,13 @@ void menu_driver_frame(bool menu_is_alive, video_frame_info_t *video_info)
 {
    struct rarch_state   *p_rarch  = &rarch_st;
    if (menu_is_alive && p_rarch->menu_driver_ctx->frame)
+   {
+      gfx_display_t *p_disp       = &p_rarch->dispgfx;
+
+      gfx_display_batch_begin(p_disp);
       p_rarch->menu_driver_ctx->frame(p_rarch->menu_userdata, video_info);
+      gfx_display_batch_end(p_disp);
+   }
 }
 
 /* Time format strings with AM-PM designation require special
@@ -4623,7 +4782,9 @@ static bool menu_driver_iterate(
       enum menu_action action,
       retro_time_t current_time)
 {
-   return (p_rarch->menu_driver_data &&
+   bool ret;
+   PERF_SCOPE_BEGIN("menu_iterate");
+   ret = (p_rarch->menu_driver_data &&
          generic_menu_iterate(
             p_rarch,
             menu_st,
@@ -4633,6 +4794,8 @@ static bool menu_driver_iterate(
             p_rarch->menu_driver_data,
             p_rarch->menu_userdata, action,
             current_time) != -1);
+   PERF_SCOPE_END();
+   return ret;
 }
 
 int menu_driver_deferred_push_content_list(file_list_t *list)
@@ -4799,6 +4962,9 @@ bool menu_driver_init(bool video_is_threaded)
             p_rarch->configuration_settings,
             video_is_threaded))
    {
+      gfx_thumbnail_set_cache_budget((size_t)p_rarch->configuration_settings
+            ->uints.menu_thumbnail_cache_size * 1024 * 1024);
+
       if (p_rarch->menu_driver_ctx && p_rarch->menu_driver_ctx->context_reset)
       {
          p_rarch->menu_driver_ctx->context_reset(p_rarch->menu_userdata,
@@ -5317,6 +5483,10 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
                && p_rarch->menu_driver_ctx->context_destroy)
             p_rarch->menu_driver_ctx->context_destroy(p_rarch->menu_userdata);
 
+         /* Cached thumbnails belong to the video context
+          * that is going away */
+         gfx_thumbnail_cache_flush();
+
          if (menu_st->data_own)
             return true;
 
@@ -5369,6 +5539,7 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
 
             menu_entries_settings_deinit(menu_st);
             menu_entries_list_deinit(p_rarch->menu_driver_ctx, menu_st);
+            filebrowser_cache_free();
 
             if (p_rarch->menu_driver_data->core_buf)
                free(p_rarch->menu_driver_data->core_buf);
@@ -5701,7 +5872,7 @@ void menu_shader_manager_free(void *data)
 {
    struct rarch_state *p_rarch = (struct rarch_state*)data;
    if (p_rarch->menu_driver_shader)
-      free(p_rarch->menu_driver_shader);
+      memory_tag_free(MEMORY_TAG_SHADERS, p_rarch->menu_driver_shader);
    p_rarch->menu_driver_shader = NULL;
 }
 
@@ -5736,8 +5907,8 @@ bool menu_shader_manager_init(void)
 
    menu_shader_manager_free(p_rarch);
 
-   menu_shader          = (struct video_shader*)
-      calloc(1, sizeof(*menu_shader));
+   menu_shader          = (struct video_shader*)memory_tag_calloc(
+         MEMORY_TAG_SHADERS, 1, sizeof(*menu_shader));
 
    if (!menu_shader)
    {
@@ -7288,6 +7459,8 @@ static bool netplay_poll(
       }
    }
 
+   netplay_update_connection_stats(netplay);
+
    /* If we're stalling, consider disconnection */
    if (netplay->stall && netplay->stall_time)
    {
@@ -7983,7 +8156,8 @@ static void netplay_force_future(netplay_t *netplay)
  * @z                    : compression backend to use
  *
  * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * scheme. Peers holding the last savestate we sent get it as a delta against
+ * that state, which compresses far better.
  */
 static void netplay_send_savestate(netplay_t *netplay,
    retro_ctx_serialize_info_t *serial_info, uint32_t cx,
@@ -7992,40 +8166,181 @@ static void netplay_send_savestate(netplay_t *netplay,
    uint32_t header[4];
    uint32_t rd, wn;
    size_t i;
+   unsigned pass;
+   /* Only full-size states can be sent as a delta */
+   bool delta = netplay->delta_ref && netplay->delta_buffer &&
+      serial_info->size == netplay->state_size;
 
-   /* Compress it */
-   z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
-   z->compression_backend->set_out(z->compression_stream,
-      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
-   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
-         &wn, NULL))
+   /* First the delta, then the full state for everyone else */
+   for (pass = delta ? 0 : 1; pass < 2; pass++)
    {
-      /* Catastrophe! */
+      bool compressed = false;
+
       for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
+      {
+         struct netplay_connection *connection = &netplay->connections[i];
+         if (!connection->active ||
+             connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+             connection->compression_supported != cx) continue;
+         /* Peers being streamed a state get the newest one once
+          * the stream is done */
+         if (connection->stream_pending || connection->stream_ref)
+            continue;
+         if ((pass == 0) != (delta && connection->delta_savestates &&
+               connection->delta_ref_sent)) continue;
+
+         if (!compressed)
+         {
+            const uint8_t *in = (const uint8_t*)serial_info->data_const;
+
+            if (pass == 0)
+            {
+               netplay_xor_state(netplay->delta_buffer, in,
+                     netplay->delta_ref, netplay->state_size);
+               in = netplay->delta_buffer;
+            }
+
+            /* Compress it */
+            z->compression_backend->set_in(z->compression_stream,
+               in, (uint32_t)serial_info->size);
+            z->compression_backend->set_out(z->compression_stream,
+               netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+            if (!z->compression_backend->trans(z->compression_stream, true, &rd,
+                  &wn, NULL))
+            {
+               /* Catastrophe! */
+               for (i = 0; i < netplay->connections_size; i++)
+                  netplay_hangup(netplay, &netplay->connections[i]);
+               return;
+            }
+
+            header[0] = htonl(pass == 0
+                  ? NETPLAY_CMD_LOAD_SAVESTATE_DELTA
+                  : NETPLAY_CMD_LOAD_SAVESTATE);
+            header[1] = htonl(wn + 2*sizeof(uint32_t));
+            header[2] = htonl(netplay->run_frame_count);
+            header[3] = htonl(serial_info->size);
+            compressed = true;
+         }
+
+         /* Send it to relevant peers */
+         if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
+               sizeof(header)) ||
+             !netplay_send(&connection->send_packet_buffer, connection->fd,
+               netplay->zbuffer, wn))
+            netplay_hangup(netplay, connection);
+         else
+            connection->stats.savestates_sent++;
+      }
+   }
+}
+
+/**
+ * netplay_update_delta_ref
+ * @netplay              : pointer to netplay object
+ * @serial_info          : the savestate that was just sent
+ *
+ * Remember a sent savestate as the reference for the next delta, for
+ * those peers that support it.
+ */
+static void netplay_update_delta_ref(netplay_t *netplay,
+   retro_ctx_serialize_info_t *serial_info)
+{
+   size_t i;
+   bool valid = serial_info->size == netplay->state_size;
+
+   for (i = 0; i < netplay->connections_size; i++)
+      if (netplay->connections[i].active &&
+          netplay->connections[i].delta_savestates)
+         break;
+
+   /* No one to send deltas to */
+   if (i == netplay->connections_size)
       return;
+
+   if (valid && !netplay->delta_ref)
+   {
+      netplay->delta_ref    = (uint8_t*)malloc(netplay->state_size);
+      netplay->delta_buffer = (uint8_t*)malloc(netplay->state_size);
+      if (!netplay->delta_ref || !netplay->delta_buffer)
+      {
+         free(netplay->delta_ref);
+         free(netplay->delta_buffer);
+         netplay->delta_ref    = NULL;
+         netplay->delta_buffer = NULL;
+      }
    }
 
-   /* Send it to relevant peers */
-   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
-   header[1] = htonl(wn + 2*sizeof(uint32_t));
-   header[2] = htonl(netplay->run_frame_count);
-   header[3] = htonl(serial_info->size);
+   valid = valid && netplay->delta_ref;
+   if (valid)
+      memcpy(netplay->delta_ref, serial_info->data_const,
+            netplay->state_size);
 
    for (i = 0; i < netplay->connections_size; i++)
    {
       struct netplay_connection *connection = &netplay->connections[i];
-      if (!connection->active ||
-          connection->mode < NETPLAY_CONNECTION_CONNECTED ||
-          connection->compression_supported != cx) continue;
+      connection->delta_ref_sent = valid && connection->active &&
+          connection->mode >= NETPLAY_CONNECTION_CONNECTED &&
+          connection->delta_savestates &&
+          !connection->stream_pending && !connection->stream_ref;
+   }
+}
 
-      if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
-            sizeof(header)) ||
-          !netplay_send(&connection->send_packet_buffer, connection->fd,
-            netplay->zbuffer, wn))
-         netplay_hangup(netplay, connection);
+/* Returns the idx-th active connection, NULL if none */
+static struct netplay_connection *netplay_get_peer(netplay_t *netplay,
+      unsigned idx, int32_t *lag)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active || connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+      if (idx--)
+         continue;
+
+      /* How many frames the peer's input trails our own, -1 if
+       * it doesn't send any. Connection i is client i+1. */
+      *lag = -1;
+      if (!netplay->is_server)
+         *lag = (int32_t)(netplay->self_frame_count
+               - netplay->server_frame_count);
+      else if (netplay->connected_players & (1 << (i + 1)))
+         *lag = (int32_t)(netplay->self_frame_count
+               - netplay->read_frame_count[i + 1]);
+
+      return connection;
    }
+
+   return NULL;
+}
+
+bool netplay_get_peer_stats(unsigned idx, char *s, size_t len)
+{
+   int32_t lag;
+   struct rarch_state *p_rarch            = &rarch_st;
+   netplay_t *netplay                     = p_rarch->netplay_data;
+   const struct netplay_connection *peer  = NULL;
+
+   if (netplay)
+      peer = netplay_get_peer(netplay, idx, &lag);
+   if (!peer)
+      return false;
+
+   snprintf(s, len,
+         "%s: RTT %.1f ms (+/- %.1f), lag %d, stalls %u (%u frames), "
+         "%.1f/%.1f KB/s in/out, %u savestates%s",
+         peer->nick,
+         peer->stats.rtt / 1000.0, peer->stats.rtt_var / 1000.0,
+         (int)lag,
+         peer->stats.stalls, peer->stats.stall_frames,
+         peer->stats.rate_in / 1000.0, peer->stats.rate_out / 1000.0,
+         peer->stats.savestates_sent,
+         peer->udp_ready ? ", UDP input" : "");
+
+   return true;
 }
 
 /**
@@ -8086,6 +8401,8 @@ void netplay_load_savestate(netplay_t *netplay,
    if (netplay->compress_zlib.compression_backend)
       netplay_send_savestate(netplay, serial_info, NETPLAY_COMPRESSION_ZLIB,
          &netplay->compress_zlib);
+
+   netplay_update_delta_ref(netplay, serial_info);
 }
 
 /**
@@ -8349,13 +8666,17 @@ bool netplay_driver_ctl(enum rarch_netplay_ctl_state state, void *data)
          ret = netplay->is_connected;
          goto done;
       case RARCH_NETPLAY_CTL_POST_FRAME:
+         PERF_SCOPE_BEGIN("netplay_post_frame");
          netplay_post_frame(p_rarch, netplay);
+         PERF_SCOPE_END();
          break;
       case RARCH_NETPLAY_CTL_PRE_FRAME:
+         PERF_SCOPE_BEGIN("netplay_pre_frame");
          ret = netplay_pre_frame(p_rarch,
                p_rarch->configuration_settings->bools.netplay_public_announce,
                p_rarch->configuration_settings->bools.netplay_use_mitm_server,
                netplay);
+         PERF_SCOPE_END();
          goto done;
       case RARCH_NETPLAY_CTL_GAME_WATCH:
          netplay_toggle_play_spectate(netplay);
@@ -8380,6 +8701,14 @@ bool netplay_driver_ctl(enum rarch_netplay_ctl_state state, void *data)
             netplay_disconnect(p_rarch, netplay);
          goto done;
       case RARCH_NETPLAY_CTL_FINISHED_NAT_TRAVERSAL:
+         /* The task ran on its own copy, take it over */
+         if (data && netplay->nat_traversal)
+         {
+            natt_free(&netplay->nat_traversal_state);
+            netplay->nat_traversal_state = *(struct natt_status*)data;
+         }
+         else
+            ret = false;
          netplay->nat_traversal_task_oustanding = false;
 #ifndef HAVE_SOCKET_LEGACY
          netplay_announce_nat_traversal(netplay);
@@ -10491,6 +10820,360 @@ bool command_get_status(command_t *cmd, const char* arg)
    return true;
 }
 
+bool command_get_frame_timings(command_t *cmd, const char* arg)
+{
+   static const char *names[FRAME_TIMING_LAST] = {
+      "core_run", "submit", "interval", "work", "present" };
+   retro_time_t values[FRAME_TIMING_SAMPLES_COUNT];
+   char reply[4096];
+   unsigned m;
+   struct rarch_state *p_rarch = &rarch_st;
+   size_t len                  = snprintf(reply, sizeof(reply),
+         "GET_FRAME_TIMINGS %" PRIu64 "\n", p_rarch->frame_timing_count);
+
+   for (m = 0; m < FRAME_TIMING_LAST && len < sizeof(reply); m++)
+   {
+      unsigned i;
+      unsigned hist[FRAME_TIMING_HISTOGRAM_BUCKETS];
+      retro_time_t accum = 0;
+      unsigned n         = video_frame_timing_values(p_rarch,
+            (enum frame_timing_metric)m, values);
+
+      memset(hist, 0, sizeof(hist));
+
+      for (i = 0; i < n; i++)
+      {
+         retro_time_t bucket = values[i] / 1000;
+         accum              += values[i];
+         hist[MIN(bucket, FRAME_TIMING_HISTOGRAM_BUCKETS - 1)]++;
+      }
+
+      if (n)
+         qsort(values, n, sizeof(*values), video_frame_timing_compare);
+      else
+         values[0] = 0;
+
+      len += snprintf(reply + len, sizeof(reply) - len,
+            "%s n=%u avg=%" PRId64 " p50=%" PRId64 " p95=%" PRId64
+            " p99=%" PRId64 " max=%" PRId64 " hist=",
+            names[m], n,
+            (int64_t)(n ? accum / n : 0),
+            (int64_t)values[n ? (n - 1) * 50 / 100 : 0],
+            (int64_t)values[n ? (n - 1) * 95 / 100 : 0],
+            (int64_t)values[n ? (n - 1) * 99 / 100 : 0],
+            (int64_t)values[n ? n - 1 : 0]);
+
+      for (i = 0; i < FRAME_TIMING_HISTOGRAM_BUCKETS && len < sizeof(reply); i++)
+         len += snprintf(reply + len, sizeof(reply) - len,
+               i ? ",%u" : "%u", hist[i]);
+
+      if (len < sizeof(reply))
+         len += snprintf(reply + len, sizeof(reply) - len, "\n");
+   }
+
+   cmd->replier(cmd, reply, MIN(len, sizeof(reply) - 1));
+
+   return true;
+}
+
+bool command_dump_frame_timings(command_t *cmd, const char* arg)
+{
+   char reply[128];
+   uint64_t i;
+   struct rarch_state *p_rarch = &rarch_st;
+   uint64_t count              = p_rarch->frame_timing_count;
+   uint64_t samples            = MIN(count, FRAME_TIMING_SAMPLES_COUNT);
+   RFILE *file                 = NULL;
+
+   if (!string_is_empty(arg))
+      file = filestream_open(arg, RETRO_VFS_FILE_ACCESS_WRITE,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+   {
+      strcpy_literal(reply, "DUMP_FRAME_TIMINGS -1\n");
+      cmd->replier(cmd, reply, strlen(reply));
+      return true;
+   }
+
+   filestream_printf(file, "frame,run_start,run_end,submit,swap,present\n");
+
+   for (i = count - samples; i < count; i++)
+   {
+      const struct frame_timing_sample *sample =
+         &p_rarch->frame_timing_samples[i & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+      filestream_printf(file, "%" PRIu64 ",%" PRId64 ",%" PRId64
+            ",%" PRId64 ",%" PRId64 ",%" PRId64 "\n", i,
+            (int64_t)sample->run_start, (int64_t)sample->run_end,
+            (int64_t)sample->submit, (int64_t)sample->swap,
+            (int64_t)sample->present);
+   }
+
+   filestream_close(file);
+
+   snprintf(reply, sizeof(reply), "DUMP_FRAME_TIMINGS %u\n",
+         (unsigned)samples);
+   cmd->replier(cmd, reply, strlen(reply));
+
+   return true;
+}
+
+bool command_get_perf_scopes(command_t *cmd, const char* arg)
+{
+   char reply[4096];
+   size_t len = snprintf(reply, sizeof(reply),
+         "GET_PERF_SCOPES %u\n", perf_scope_count());
+
+   len       += perf_scope_report(reply + len, sizeof(reply) - len, true);
+
+   cmd->replier(cmd, reply, len);
+
+   return true;
+}
+
+#ifdef HAVE_MEMORY_TAGS
+/* One line per tag with live and peak bytes,
+ * 'RESET' restarts peak tracking afterwards */
+bool command_get_memory_tags(command_t *cmd, const char* arg)
+{
+   unsigned i;
+   char reply[1024];
+   size_t len = strlcpy(reply, "GET_MEMORY_TAGS\n", sizeof(reply));
+
+   for (i = 0; i < MEMORY_TAG_LAST && len < sizeof(reply); i++)
+   {
+      memory_tag_stats_t stats;
+
+      memory_tag_get_stats((enum memory_tag)i, &stats);
+
+      len += snprintf(reply + len, sizeof(reply) - len,
+            "%s live=%" PRId64 " peak=%" PRId64 " blocks=%" PRId64 "\n",
+            stats.ident, stats.live, stats.peak, stats.blocks);
+   }
+
+   if (len >= sizeof(reply))
+      len = sizeof(reply) - 1;
+
+   cmd->replier(cmd, reply, len);
+
+   if (!string_is_empty(arg) && string_is_equal_case_insensitive(arg, "reset"))
+      memory_tag_reset_peaks();
+
+   return true;
+}
+#endif
+
+/* Plays a click train for 'seconds' (default 5) in place of the
+ * core's audio and reports the output latency of each click:
+ * what was queued in the driver buffer when it was written,
+ * plus the device latency where the driver reports it. With no
+ * argument, replies with the last report. Run a loopback or
+ * microphone recording alongside to check the estimate against
+ * the real round trip. */
+bool command_audio_latency_test(command_t *cmd, const char* arg)
+{
+   char reply[384];
+   struct rarch_state *p_rarch     = &rarch_st;
+   struct audio_latency_test *test = &p_rarch->audio_latency_test;
+   settings_t *settings            = p_rarch->configuration_settings;
+   unsigned rate                   = settings->uints.audio_out_rate;
+   unsigned seconds                = 5;
+
+   if (string_is_empty(arg))
+   {
+      audio_driver_lock_processing(p_rarch);
+      if (test->active)
+         strcpy_literal(reply, "AUDIO_LATENCY_TEST running\n");
+      else if (!string_is_empty(test->report))
+         strlcpy(reply, test->report, sizeof(reply));
+      else
+         strcpy_literal(reply, "AUDIO_LATENCY_TEST -1\n");
+      audio_driver_unlock_processing(p_rarch);
+
+      cmd->replier(cmd, reply, strlen(reply));
+      return true;
+   }
+
+   seconds = (unsigned)strtoul(arg, NULL, 10);
+
+   if (     !p_rarch->audio_driver_active
+         || !p_rarch->current_audio
+         || !rate
+         || !seconds
+         || seconds > AUDIO_LATENCY_TEST_MAX_SECONDS)
+   {
+      strcpy_literal(reply, "AUDIO_LATENCY_TEST -1\n");
+      cmd->replier(cmd, reply, strlen(reply));
+      return true;
+   }
+
+   audio_driver_lock_processing(p_rarch);
+
+   test->history_start   = p_rarch->audio_driver_free_samples_count;
+   test->click_ms_accum  = 0.0;
+   test->buffer_size     = 0;
+   test->frame_size      = p_rarch->audio_driver_use_float
+      ? 2 * sizeof(float) : 2 * sizeof(int16_t);
+   test->rate            = rate;
+   test->frames_left     = seconds * rate;
+   test->frames_to_click = 0;
+   test->pulse_left      = 0;
+   test->clicks          = 0;
+   test->click_ms_min    = 0.0f;
+   test->click_ms_max    = 0.0f;
+   test->report[0]       = '\0';
+   test->active          = true;
+
+   if (     p_rarch->current_audio->write_avail
+         && p_rarch->current_audio->buffer_size)
+      test->buffer_size  = p_rarch->current_audio->buffer_size(
+            p_rarch->audio_driver_context_audio_data);
+
+   audio_driver_unlock_processing(p_rarch);
+
+   RARCH_LOG("[Audio]: Latency test started, %u seconds.\n", seconds);
+
+   snprintf(reply, sizeof(reply),
+         "AUDIO_LATENCY_TEST started %u\n", seconds);
+   cmd->replier(cmd, reply, strlen(reply));
+
+   return true;
+}
+
+static int input_report_interval_compare(const void *a, const void *b)
+{
+   uint32_t x = *(const uint32_t*)a;
+   uint32_t y = *(const uint32_t*)b;
+   return (x > y) - (x < y);
+}
+
+/* Reports the interval between input reports of each pad
+ * that sent any. Pads that only report state changes need
+ * to be kept busy (e.g. by wiggling a stick) while measuring.
+ * 'latency' is the average delay a report interval adds
+ * to a button press, i.e. half the average interval. */
+bool command_get_input_report_stats(command_t *cmd, const char* arg)
+{
+   uint32_t values[INPUT_REPORT_SAMPLES_COUNT];
+   char reply[4096];
+   unsigned port;
+   unsigned first              = 0;
+   unsigned last               = MAX_USERS;
+   struct rarch_state *p_rarch = &rarch_st;
+   size_t len                  = 0;
+
+   if (!string_is_empty(arg))
+   {
+      first = (unsigned)strtoul(arg, NULL, 0);
+      last  = MIN(first + 1, MAX_USERS);
+   }
+
+   len = strlcpy(reply, "GET_INPUT_REPORT_STATS\n", sizeof(reply));
+
+   for (port = first; port < last && len < sizeof(reply); port++)
+   {
+      unsigned i, n;
+      uint64_t accum                    = 0;
+      const struct input_report_stats *stats
+                                        = &p_rarch->input_report_stats[port];
+      const char *name                  = input_config_get_device_name(port);
+
+      n = (unsigned)MIN(stats->count, INPUT_REPORT_SAMPLES_COUNT);
+      if (!n)
+         continue;
+
+      memcpy(values, stats->intervals, n * sizeof(*values));
+      for (i = 0; i < n; i++)
+         accum += values[i];
+      qsort(values, n, sizeof(*values), input_report_interval_compare);
+
+      len += snprintf(reply + len, sizeof(reply) - len,
+            "%u name=\"%s\" n=%u rate=%.1f avg=%u p50=%u p99=%u"
+            " max=%u latency=%u\n",
+            port, name ? name : "",
+            n,
+            accum ? 1000000.0 * n / accum : 0.0,
+            (unsigned)(accum / n),
+            values[(n - 1) * 50 / 100],
+            values[(n - 1) * 99 / 100],
+            values[n - 1],
+            (unsigned)(accum / n / 2));
+   }
+
+   cmd->replier(cmd, reply, MIN(len, sizeof(reply) - 1));
+
+   return true;
+}
+
+#ifdef HAVE_NETWORKING
+bool command_get_netplay_stats(command_t *cmd, const char* arg)
+{
+   char reply[4096];
+   struct rarch_state *p_rarch = &rarch_st;
+   netplay_t          *netplay = p_rarch->netplay_data;
+
+   int32_t lag;
+   unsigned idx;
+   size_t len;
+   const struct netplay_connection *peer;
+
+   if (!netplay)
+   {
+      strcpy_literal(reply, "GET_NETPLAY_STATS -1\n");
+      cmd->replier(cmd, reply, strlen(reply));
+      return true;
+   }
+
+   len = snprintf(reply, sizeof(reply),
+         "GET_NETPLAY_STATS rollbacks=%u frames=%" PRIu64
+         " last=%u max=%u avg=%.2f saves_skipped=%" PRIu64
+         " frame_time=%" PRId64 " delay=%d\n",
+         netplay->rollback_count,
+         netplay->rollback_frames,
+         netplay->rollback_last,
+         netplay->rollback_max,
+         netplay->rollback_count
+         ? (double)netplay->rollback_frames / netplay->rollback_count
+         : 0.0,
+         netplay->rollback_saves_skipped,
+         (int64_t)netplay->frame_run_time_avg,
+         netplay->input_latency_frames);
+
+   /* One line per peer, RTT in usec, rates in bytes/s */
+   for (idx = 0; len < sizeof(reply)
+         && (peer = netplay_get_peer(netplay, idx, &lag)); idx++)
+   {
+      unsigned i;
+      const struct netplay_connection_stats *stats = &peer->stats;
+
+      len += snprintf(reply + len, sizeof(reply) - len,
+            "%u nick=\"%s\" rtt=%u rtt_var=%u lag=%d stalls=%u"
+            " stall_frames=%u in=%u out=%u total_in=%" PRIu64
+            " total_out=%" PRIu64 " savestates=%u udp=%d udp_frames=%u"
+            " sndbuf=%u rtt_hist=",
+            idx, peer->nick, stats->rtt, stats->rtt_var, (int)lag,
+            stats->stalls, stats->stall_frames,
+            stats->rate_in, stats->rate_out,
+            peer->recv_packet_buffer.total,
+            peer->send_packet_buffer.total,
+            stats->savestates_sent,
+            peer->udp_ready ? 1 : 0, stats->udp_frames,
+            stats->sndbuf);
+
+      for (i = 0; i < NETPLAY_RTT_HISTOGRAM_BUCKETS && len < sizeof(reply); i++)
+         len += snprintf(reply + len, sizeof(reply) - len,
+               i ? ",%u" : "%u", stats->rtt_hist[i]);
+
+      if (len < sizeof(reply))
+         len += snprintf(reply + len, sizeof(reply) - len, "\n");
+   }
+
+   cmd->replier(cmd, reply, MIN(len, sizeof(reply) - 1));
+
+   return true;
+}
+#endif
+
 bool command_show_osd_msg(command_t *cmd, const char* arg)
 {
     runloop_msg_queue_push(arg, 1, 180, false, NULL,
@@ -10539,6 +11222,115 @@ bool command_get_config_param(command_t *cmd, const char* arg)
    return true;
 }
 
+#ifdef HAVE_BSV_MOVIE
+bool command_seek_replay(command_t *cmd, const char* arg)
+{
+   char reply[64];
+   struct rarch_state *p_rarch = &rarch_st;
+   int64_t frame               = bsv_movie_seek(p_rarch,
+         (uint32_t)strtoul(arg, NULL, 10));
+
+   snprintf(reply, sizeof(reply), "SEEK_REPLAY %" PRId64 "\n", frame);
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+#endif
+
+/* A file name without any directory part */
+static bool command_run_job_is_file_name(const char *name)
+{
+   return !string_is_empty(name)
+      && *name != '.'
+      && !strchr(name, '/')
+      && !strchr(name, '\\');
+}
+
+/* RUN_JOB <frames>|<core file>|<content path>|<output name>
+ *
+ * The core is a file in the cores directory. Results are
+ * written to <output name>.png, .state and .ram in the
+ * job directory, which has to be set in the config file. */
+bool command_run_job(command_t *cmd, const char *arg)
+{
+   char reply[64];
+   char args[3 * PATH_MAX_LENGTH];
+   char core_path[PATH_MAX_LENGTH];
+   static unsigned next_id     = 1;
+   char *save                  = NULL;
+   const char *frames          = NULL;
+   const char *core_file       = NULL;
+   const char *content_path    = NULL;
+   const char *output          = NULL;
+   const char *error           = NULL;
+   struct rarch_state *p_rarch = &rarch_st;
+   settings_t *settings        = p_rarch->configuration_settings;
+   const char *dir_job         = settings->paths.directory_job;
+   const char *dir_libretro    = settings->paths.directory_libretro;
+   struct rarch_job *job       = &p_rarch->job;
+
+   strlcpy(args, arg, sizeof(args));
+   frames       = strtok_r(args, "|", &save);
+   core_file    = strtok_r(NULL, "|", &save);
+   content_path = strtok_r(NULL, "|", &save);
+   output       = strtok_r(NULL, "|", &save);
+
+   core_path[0] = '\0';
+   if (command_run_job_is_file_name(core_file)
+         && !string_is_empty(dir_libretro))
+      fill_pathname_join(core_path, dir_libretro, core_file,
+            sizeof(core_path));
+
+   if (     job->state == RARCH_JOB_QUEUED
+         || job->state == RARCH_JOB_RUNNING)
+      error = "BUSY";
+   else if (!output || !strtoul(frames, NULL, 10))
+      error = "BAD_REQUEST";
+   else if (string_is_empty(dir_job))
+      error = "NO_JOB_DIRECTORY";
+   else if (!command_run_job_is_file_name(output))
+      error = "BAD_OUTPUT";
+   else if (string_is_empty(core_path) || !path_is_valid(core_path))
+      error = "BAD_CORE";
+
+   if (error)
+   {
+      snprintf(reply, sizeof(reply), "RUN_JOB -1 %s\n", error);
+      cmd->replier(cmd, reply, strlen(reply));
+      return false;
+   }
+
+   job->id     = next_id++;
+   job->frames = (unsigned)strtoul(frames, NULL, 10);
+   job->state  = RARCH_JOB_QUEUED;
+   strlcpy(job->core_path, core_path, sizeof(job->core_path));
+   strlcpy(job->content_path, content_path, sizeof(job->content_path));
+   fill_pathname_join(job->output, dir_job, output, sizeof(job->output));
+
+   snprintf(reply, sizeof(reply), "RUN_JOB %u\n", job->id);
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+
+bool command_get_job_status(command_t *cmd, const char *arg)
+{
+   static const char *states[] = {
+      "NONE", "QUEUED", "RUNNING", "DONE", "FAILED" };
+   char reply[128];
+   struct rarch_state *p_rarch = &rarch_st;
+   struct rarch_job *job       = &p_rarch->job;
+   uint64_t frames             = 0;
+
+   if (job->state == RARCH_JOB_RUNNING && job->start_frame != UINT64_MAX)
+      frames = p_rarch->video_driver_frame_count - job->start_frame;
+   else if (job->state == RARCH_JOB_DONE)
+      frames = job->frames;
+
+   snprintf(reply, sizeof(reply), "GET_JOB_STATUS %u %s %" PRIu64 "/%u\n",
+         job->id, states[job->state], frames, job->frames);
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+
 #if defined(HAVE_CHEEVOS)
 bool command_read_ram(command_t *cmd, const char *arg)
 {
@@ -10628,22 +11420,21 @@ static const rarch_memory_descriptor_t* command_memory_get_descriptor(const rarc
    return NULL;
 }
 
-static uint8_t* command_memory_get_pointer(unsigned address,
-      unsigned int* max_bytes, int for_write, char* reply_at, size_t len)
+static uint8_t* command_memory_get_data(unsigned address,
+      unsigned int* max_bytes, int for_write, const char **error)
 {
-   struct rarch_state       *p_rarch = &rarch_st;
    const rarch_system_info_t* system = &runloop_state.system;
    if (!system || system->mmaps.num_descriptors == 0)
-      strlcpy(reply_at, " -1 no memory map defined\n", len);
+      *error = "no memory map defined";
    else
    {
       const rarch_memory_descriptor_t* desc = command_memory_get_descriptor(&system->mmaps, address);
       if (!desc)
-         strlcpy(reply_at, " -1 no descriptor for address\n", len);
+         *error = "no descriptor for address";
       else if (!desc->core.ptr)
-         strlcpy(reply_at, " -1 no data for descriptor\n", len);
+         *error = "no data for descriptor";
       else if (for_write && (desc->core.flags & RETRO_MEMDESC_CONST))
-         strlcpy(reply_at, " -1 descriptor data is readonly\n", len);
+         *error = "descriptor data is readonly";
       else
       {
          const size_t offset = address - desc->core.start;
@@ -10656,6 +11447,140 @@ static uint8_t* command_memory_get_pointer(unsigned address,
    return NULL;
 }
 
+static uint8_t* command_memory_get_pointer(unsigned address,
+      unsigned int* max_bytes, int for_write, char* reply_at, size_t len)
+{
+   const char *error = NULL;
+   uint8_t *data     = command_memory_get_data(address,
+         max_bytes, for_write, &error);
+
+   if (!data)
+      snprintf(reply_at, len, " -1 %s\n", error);
+
+   return data;
+}
+
+size_t command_memory_read(enum command_memory_space space,
+      unsigned address, uint8_t *data, size_t len)
+{
+   const char *error      = NULL;
+   unsigned int max_bytes = 0;
+   const uint8_t *src     = NULL;
+
+   switch (space)
+   {
+      case CMD_MEMORY_SPACE_MAP:
+         if (!(src = command_memory_get_data(address, &max_bytes, 0, &error)))
+            return 0;
+         if (len > max_bytes)
+            len = max_bytes;
+         memcpy(data, src, len);
+         return len;
+#ifdef HAVE_CHEEVOS
+      case CMD_MEMORY_SPACE_CHEEVOS:
+         {
+            size_t i;
+
+            /* Consecutive addresses may live in different regions */
+            for (i = 0; i < len; i++)
+            {
+               if (!(src = rcheevos_patch_address(address + (unsigned)i)))
+                  break;
+               data[i] = *src;
+            }
+            return i;
+         }
+#endif
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+size_t command_memory_write(enum command_memory_space space,
+      unsigned address, const uint8_t *data, size_t len)
+{
+   size_t i;
+   const char *error      = NULL;
+   unsigned int max_bytes = 0;
+   uint8_t *dst           = NULL;
+
+   switch (space)
+   {
+      case CMD_MEMORY_SPACE_MAP:
+         if (!(dst = command_memory_get_data(address, &max_bytes, 1, &error)))
+            return 0;
+         if (len > max_bytes)
+            len = max_bytes;
+         memcpy(dst, data, len);
+         i = len;
+         break;
+#ifdef HAVE_CHEEVOS
+      case CMD_MEMORY_SPACE_CHEEVOS:
+         for (i = 0; i < len; i++)
+         {
+            if (!(dst = (uint8_t*)rcheevos_patch_address(address + (unsigned)i)))
+               break;
+            *dst = data[i];
+         }
+         break;
+#endif
+      default:
+         return 0;
+   }
+
+#ifdef HAVE_CHEEVOS
+   if (i && rcheevos_hardcore_active())
+   {
+      RARCH_LOG("Achievements hardcore mode disabled by binary memory write\n");
+      rcheevos_pause_hardcore();
+   }
+#endif
+
+   return i;
+}
+
+void command_get_frame_stats(struct command_frame_stats *stats)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   uint64_t count              = p_rarch->frame_timing_count;
+
+   stats->frame_count = p_rarch->video_driver_frame_count;
+   stats->core_run    = 0;
+   stats->interval    = 0;
+   stats->flags       = 0;
+
+   if (count > 0)
+   {
+      const struct frame_timing_sample *sample =
+         &p_rarch->frame_timing_samples[(count - 1)
+         & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+
+      if (sample->run_start && sample->run_end)
+         stats->core_run = (uint32_t)(sample->run_end - sample->run_start);
+
+      if (count > 1)
+      {
+         const struct frame_timing_sample *prev =
+            &p_rarch->frame_timing_samples[(count - 2)
+            & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+         stats->interval = (uint32_t)(sample->submit - prev->submit);
+      }
+   }
+
+   if (runloop_state.paused)
+      stats->flags |= CMD_FRAME_STATS_PAUSED;
+   if (runloop_state.fastmotion)
+      stats->flags |= CMD_FRAME_STATS_FAST_FORWARD;
+   if (runloop_state.slowmotion)
+      stats->flags |= CMD_FRAME_STATS_SLOW_MOTION;
+#ifdef HAVE_MENU
+   if (p_rarch->menu_driver_alive)
+      stats->flags |= CMD_FRAME_STATS_MENU;
+#endif
+}
+
 bool command_read_memory(command_t *cmd, const char *arg)
 {
    unsigned i;
@@ -10732,7 +11657,7 @@ bool command_write_memory(command_t *cmd, const char *arg)
 }
 #endif
 
-static bool retroarch_apply_shader(
+static bool retroarch_apply_shader_now(
       struct rarch_state *p_rarch,
       settings_t *settings,
       enum rarch_shader_type type,
@@ -10827,6 +11752,73 @@ static bool retroarch_apply_shader(
    return false;
 }
 
+#if defined(HAVE_SLANG) && defined(HAVE_GLSLANG)
+typedef struct shader_preload_request
+{
+   char path[PATH_MAX_LENGTH];
+   enum rarch_shader_type type;
+   unsigned generation;
+   bool message;
+} shader_preload_request_t;
+
+static void retroarch_shader_preload_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   struct rarch_state *p_rarch      = &rarch_st;
+   shader_preload_request_t *request = (shader_preload_request_t*)user_data;
+
+   if (!request)
+      return;
+
+   /* Skipped when another preset was requested in the meantime */
+   if (request->generation == p_rarch->shader_preload_generation)
+      retroarch_apply_shader_now(p_rarch, p_rarch->configuration_settings,
+            request->type, request->path, request->message);
+
+   free(request);
+}
+#endif
+
+/* Slang presets are compiled to SPIR-V on the task thread first,
+ * the current filter chain keeps rendering until the driver
+ * swaps in the new one from the shader cache */
+static bool retroarch_apply_shader(
+      struct rarch_state *p_rarch,
+      settings_t *settings,
+      enum rarch_shader_type type,
+      const char *preset_path, bool message)
+{
+#if defined(HAVE_SLANG) && defined(HAVE_GLSLANG)
+   /* Any request supersedes the ones still compiling */
+   p_rarch->shader_preload_generation++;
+
+   if (     type == RARCH_SHADER_SLANG
+         && !string_is_empty(preset_path)
+         && !string_is_empty(runloop_state.system.info.library_name)
+         && p_rarch->current_video->set_shader)
+   {
+      shader_preload_request_t *request = (shader_preload_request_t*)
+         calloc(1, sizeof(*request));
+
+      if (request)
+      {
+         strlcpy(request->path, preset_path, sizeof(request->path));
+         request->type       = type;
+         request->generation = p_rarch->shader_preload_generation;
+         request->message    = message;
+
+         if (task_push_shader_preload(preset_path,
+                  retroarch_shader_preload_cb, request))
+            return true;
+         free(request);
+      }
+   }
+#endif
+
+   return retroarch_apply_shader_now(p_rarch, settings,
+         type, preset_path, message);
+}
+
 #if defined(HAVE_CG) || defined(HAVE_GLSL) || defined(HAVE_SLANG) || defined(HAVE_HLSL)
 bool command_set_shader(command_t *cmd, const char *arg)
 {
@@ -10990,7 +11982,17 @@ static void handle_translation_cb(
 #endif
 #ifdef HAVE_GFX_WIDGETS
    bool gfx_widgets_paused           = p_rarch->gfx_widgets_paused;
+#endif
 
+   /* The request was cancelled while this was in flight */
+   if (user_data && *(unsigned*)user_data != p_rarch->ai_service.request_id)
+   {
+      free(user_data);
+      return;
+   }
+   p_rarch->ai_service.request_pending = false;
+
+#ifdef HAVE_GFX_WIDGETS
    /* When auto mode is on, we turn off the overlay
     * once we have the result for the next call.*/
    if (p_rarch->dispwidget_st.ai_service_overlay_state != 0
@@ -11317,6 +12319,7 @@ static void handle_translation_cb(
       params.bufsize              = new_sound_size;
       params.cb                   = NULL;
       params.basename             = NULL;
+      params.path                 = NULL;
 
       audio_driver_mixer_add_stream(&params);
 
@@ -11590,6 +12593,271 @@ static const char *ai_service_get_str(enum translation_lang id)
 }
 
 
+/* Tiles of the screen compared against the last frame sent */
+#define AI_SERVICE_TILE_SIZE         16
+/* Fewer changed tiles than this (a blinking cursor, say)
+ * don't count as a new screen in auto mode */
+#define AI_SERVICE_MIN_CHANGED_TILES 2
+/* How long auto mode waits before looking at an unchanged
+ * screen again */
+#define AI_SERVICE_RETRY_USEC        250000
+
+typedef struct ai_service_job
+{
+   uint8_t *image;            /* BGR24, bottom-up */
+   char *label;
+   rjsonwriter_t *json;       /* the request body, built by the task */
+   unsigned width;
+   unsigned height;
+   unsigned id;
+   int gamepad_state[16];
+   bool paused;
+   char url[PATH_MAX_LENGTH];
+} ai_service_job_t;
+
+static bool ai_service_frame_changed(const ai_service_state_t *st,
+      const uint8_t *frame, unsigned width, unsigned height)
+{
+   unsigned tx, ty, y;
+   unsigned changed    = 0;
+   size_t stride       = width * 3;
+
+   if (     !st->last_frame
+         || st->last_width  != width
+         || st->last_height != height)
+      return true;
+
+   for (ty = 0; ty < height; ty += AI_SERVICE_TILE_SIZE)
+   {
+      unsigned rows = MIN(AI_SERVICE_TILE_SIZE, height - ty);
+
+      for (tx = 0; tx < width; tx += AI_SERVICE_TILE_SIZE)
+      {
+         size_t offset = ty * stride + tx * 3;
+         size_t len    = MIN(AI_SERVICE_TILE_SIZE, width - tx) * 3;
+
+         for (y = 0; y < rows; y++, offset += stride)
+         {
+            if (memcmp(frame + offset, st->last_frame + offset, len))
+            {
+               if (++changed >= AI_SERVICE_MIN_CHANGED_TILES)
+                  return true;
+               break;
+            }
+         }
+      }
+   }
+
+   return false;
+}
+
+static void ai_service_frame_store(ai_service_state_t *st,
+      const uint8_t *frame, unsigned width, unsigned height)
+{
+   size_t size = (size_t)width * height * 3;
+
+   if (     !st->last_frame
+         || st->last_width  != width
+         || st->last_height != height)
+   {
+      if (st->last_frame)
+         free(st->last_frame);
+      st->last_width  = 0;
+      st->last_height = 0;
+      if (!(st->last_frame = (uint8_t*)malloc(size)))
+         return;
+   }
+
+   memcpy(st->last_frame, frame, size);
+   st->last_width  = width;
+   st->last_height = height;
+}
+
+/* Drops whatever request is in flight and the auto mode state */
+static void ai_service_cancel(struct rarch_state *p_rarch)
+{
+   ai_service_state_t *st = &p_rarch->ai_service;
+
+   st->request_id++;
+   st->request_pending    = false;
+   st->retry_time         = 0;
+
+   if (st->last_frame)
+      free(st->last_frame);
+   st->last_frame         = NULL;
+   st->last_width         = 0;
+   st->last_height        = 0;
+}
+
+static void ai_service_job_free(ai_service_job_t *job)
+{
+   if (job->image)
+      free(job->image);
+   if (job->label)
+      free(job->label);
+   if (job->json)
+      rjsonwriter_free(job->json);
+   free(job);
+}
+
+/* Runs on the task thread: encodes the frame and builds
+ * the request body */
+static void ai_service_encode_handler(retro_task_t *task)
+{
+   int i;
+   uint8_t header[54];
+   uint64_t buffer_bytes          = 0;
+   uint8_t *bmp_buffer            = NULL;
+   char *bmp64_buffer             = NULL;
+   int bmp64_length               = 0;
+   bool TRANSLATE_USE_BMP         = false;
+   ai_service_job_t *job          = (ai_service_job_t*)task->user_data;
+   unsigned width                 = job->width;
+   unsigned height                = job->height;
+   rjsonwriter_t *jsonwriter      = NULL;
+   static const char* state_labels[] = { "b", "y", "select", "start", "up", "down", "left", "right", "a", "x", "l", "r", "l2", "r2", "l3", "r3" };
+
+   if (TRANSLATE_USE_BMP)
+   {
+      /*
+        At this point, we should have a screenshot in the buffer,
+        so allocate an array to contain the BMP image along with
+        the BMP header as bytes, and then covert that to a
+        b64 encoded array for transport in JSON.
+      */
+
+      form_bmp_header(header, width, height, false);
+      bmp_buffer  = (uint8_t*)malloc(width * height * 3 + 54);
+      if (!bmp_buffer)
+         goto finish;
+
+      memcpy(bmp_buffer, header, 54 * sizeof(uint8_t));
+      memcpy(bmp_buffer + 54,
+            job->image,
+            width * height * 3 * sizeof(uint8_t));
+      buffer_bytes = sizeof(uint8_t) * (width * height * 3 + 54);
+   }
+   else
+   {
+      size_t pitch = width * 3;
+      /* Speed over size, the request is sent right away and
+       * auto mode sends one per screen */
+      bmp_buffer   = rpng_save_image_bgr24_string_fast(
+            job->image + width * (height-1) * 3,
+            width, height, (signed)-pitch, &buffer_bytes);
+   }
+
+   if (!bmp_buffer)
+      goto finish;
+
+   bmp64_buffer    = base64((void *)bmp_buffer,
+         sizeof(uint8_t) * buffer_bytes,
+         &bmp64_length);
+
+   if (!bmp64_buffer)
+      goto finish;
+
+   jsonwriter = rjsonwriter_open_memory();
+   if (!jsonwriter)
+      goto finish;
+
+   rjsonwriter_add_start_object(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_string(jsonwriter, "image");
+   rjsonwriter_add_colon(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_string_len(jsonwriter, bmp64_buffer, bmp64_length);
+
+   /* Form request... */
+   if (job->label)
+   {
+      rjsonwriter_add_comma(jsonwriter);
+      rjsonwriter_add_space(jsonwriter);
+      rjsonwriter_add_string(jsonwriter, "label");
+      rjsonwriter_add_colon(jsonwriter);
+      rjsonwriter_add_space(jsonwriter);
+      rjsonwriter_add_string(jsonwriter, job->label);
+   }
+
+   rjsonwriter_add_comma(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_string(jsonwriter, "state");
+   rjsonwriter_add_colon(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_start_object(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_string(jsonwriter, "paused");
+   rjsonwriter_add_colon(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_unsigned(jsonwriter, (job->paused ? 1 : 0));
+   for (i = 0; i < ARRAY_SIZE(state_labels); i++)
+   {
+      rjsonwriter_add_comma(jsonwriter);
+      rjsonwriter_add_space(jsonwriter);
+      rjsonwriter_add_string(jsonwriter, state_labels[i]);
+      rjsonwriter_add_colon(jsonwriter);
+      rjsonwriter_add_space(jsonwriter);
+      rjsonwriter_add_unsigned(jsonwriter,
+            (job->gamepad_state[i] ? 1 : 0));
+   }
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_end_object(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_end_object(jsonwriter);
+
+   job->json  = jsonwriter;
+   jsonwriter = NULL;
+
+#ifdef DEBUG
+   RARCH_LOG("Request size: %d\n", bmp64_length);
+#endif
+
+finish:
+   if (bmp_buffer)
+      free(bmp_buffer);
+   if (bmp64_buffer)
+      free(bmp64_buffer);
+   if (jsonwriter)
+      rjsonwriter_free(jsonwriter);
+   task_set_finished(task, true);
+}
+
+/* Back on the main thread: send the request, unless it was
+ * cancelled while encoding */
+static void ai_service_encode_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   ai_service_job_t *job       = (ai_service_job_t*)user_data;
+   const char *json_buffer     = NULL;
+
+   if (!job)
+      return;
+
+   if (job->id == p_rarch->ai_service.request_id)
+   {
+      unsigned *id = NULL;
+
+      if (job->json)
+         json_buffer = rjsonwriter_get_memory_buffer(job->json, NULL);
+
+      if (json_buffer && (id = (unsigned*)malloc(sizeof(*id))))
+      {
+         *id = job->id;
+#ifdef DEBUG
+         if (p_rarch->ai_service_auto != 2)
+            RARCH_LOG("SENDING... %s\n", job->url);
+#endif
+         task_push_http_post_transfer(job->url,
+               json_buffer, true, NULL, handle_translation_cb, id);
+      }
+      else
+         p_rarch->ai_service.request_pending = false;
+   }
+
+   ai_service_job_free(job);
+}
+
 /*
    This function does all the stuff needed to translate the game screen,
    using the URL given in the settings.  Once the image from the frame
@@ -11632,7 +12900,6 @@ static bool run_translation_service(
       bool paused)
 {
    struct video_viewport vp;
-   uint8_t header[54];
    size_t pitch;
    unsigned width, height;
    const void *data                      = NULL;
@@ -11641,15 +12908,8 @@ static bool run_translation_service(
    struct scaler_ctx *scaler             = (struct scaler_ctx*)
       calloc(1, sizeof(struct scaler_ctx));
    bool error                            = false;
-
-   uint8_t *bmp_buffer                   = NULL;
-   uint64_t buffer_bytes                 = 0;
-   char *bmp64_buffer                    = NULL;
-   rjsonwriter_t* jsonwriter             = NULL;
-   const char *json_buffer               = NULL;
-
-   int bmp64_length                      = 0;
-   bool TRANSLATE_USE_BMP                = false;
+   ai_service_job_t *job                 = NULL;
+   retro_task_t *task                    = NULL;
    bool use_overlay                      = false;
 
    const char *label                     = NULL;
@@ -11668,6 +12928,10 @@ static bool run_translation_service(
    }
 #endif
 
+   /* Only one request at a time */
+   if (p_rarch->ai_service.request_pending)
+      goto finish;
+
 #ifdef HAVE_GFX_WIDGETS
    if (     p_rarch->video_driver_poke
          && p_rarch->video_driver_poke->load_texture
@@ -11787,114 +13051,47 @@ static bool run_translation_service(
       goto finish;
    }
 
-   if (TRANSLATE_USE_BMP)
-   {
-      /*
-        At this point, we should have a screenshot in the buffer,
-        so allocate an array to contain the BMP image along with
-        the BMP header as bytes, and then covert that to a
-        b64 encoded array for transport in JSON.
-      */
-
-      form_bmp_header(header, width, height, false);
-      bmp_buffer  = (uint8_t*)malloc(width * height * 3 + 54);
-      if (!bmp_buffer)
-         goto finish;
-
-      memcpy(bmp_buffer, header, 54 * sizeof(uint8_t));
-      memcpy(bmp_buffer + 54,
-            bit24_image,
-            width * height * 3 * sizeof(uint8_t));
-      buffer_bytes = sizeof(uint8_t) * (width * height * 3 + 54);
-   }
-   else
+   /* In auto mode, only send when the screen changed since
+    * the last request, otherwise look again a bit later */
+   if (     p_rarch->ai_service_auto == 2
+         && !ai_service_frame_changed(&p_rarch->ai_service,
+            bit24_image, width, height))
    {
-      pitch        = width * 3;
-      bmp_buffer   = rpng_save_image_bgr24_string(
-            bit24_image + width * (height-1) * 3,
-            width, height, (signed)-pitch, &buffer_bytes);
-   }
-
-   bmp64_buffer    = base64((void *)bmp_buffer,
-         sizeof(uint8_t) * buffer_bytes,
-         &bmp64_length);
-
-   if (!bmp64_buffer)
+      p_rarch->ai_service.retry_time = cpu_features_get_time_usec()
+         + AI_SERVICE_RETRY_USEC;
       goto finish;
+   }
 
-   jsonwriter = rjsonwriter_open_memory();
-   if (!jsonwriter)
+   if (!(job = (ai_service_job_t*)calloc(1, sizeof(*job))))
       goto finish;
 
-   rjsonwriter_add_start_object(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_string(jsonwriter, "image");
-   rjsonwriter_add_colon(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_string_len(jsonwriter, bmp64_buffer, bmp64_length);
-
-   /* Form request... */
-   if (system_label)
-   {
-      rjsonwriter_add_comma(jsonwriter);
-      rjsonwriter_add_space(jsonwriter);
-      rjsonwriter_add_string(jsonwriter, "label");
-      rjsonwriter_add_colon(jsonwriter);
-      rjsonwriter_add_space(jsonwriter);
-      rjsonwriter_add_string(jsonwriter, system_label);
-   }
-
-   rjsonwriter_add_comma(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_string(jsonwriter, "state");
-   rjsonwriter_add_colon(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_start_object(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_string(jsonwriter, "paused");
-   rjsonwriter_add_colon(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_unsigned(jsonwriter, (paused ? 1 : 0));
+   ai_service_frame_store(&p_rarch->ai_service, bit24_image, width, height);
+
+   /* The task owns the image and label from here on */
+   job->image       = bit24_image;
+   job->label       = system_label;
+   job->width       = width;
+   job->height      = height;
+   job->paused      = paused;
+   job->id          = p_rarch->ai_service.request_id;
+   bit24_image      = NULL;
+   system_label     = NULL;
+#ifdef HAVE_ACCESSIBILITY
    {
-      static const char* state_labels[] = { "b", "y", "select", "start", "up", "down", "left", "right", "a", "x", "l", "r", "l2", "r2", "l3", "r3" };
       int i;
-      for (i = 0; i < ARRAY_SIZE(state_labels); i++)
-      {
-         rjsonwriter_add_comma(jsonwriter);
-         rjsonwriter_add_space(jsonwriter);
-         rjsonwriter_add_string(jsonwriter, state_labels[i]);
-         rjsonwriter_add_colon(jsonwriter);
-         rjsonwriter_add_space(jsonwriter);
-#ifdef HAVE_ACCESSIBILITY
-         rjsonwriter_add_unsigned(jsonwriter,
-               (p_rarch->ai_gamepad_state[i] ? 1 : 0)
-               );
-#else
-         rjsonwriter_add_unsigned(jsonwriter, 0);
-#endif
-      }
+      for (i = 0; i < ARRAY_SIZE(job->gamepad_state); i++)
+         job->gamepad_state[i] = p_rarch->ai_gamepad_state[i];
    }
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_end_object(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_end_object(jsonwriter);
-
-   json_buffer = rjsonwriter_get_memory_buffer(jsonwriter, NULL);
-   if (!json_buffer)
-      goto finish; /* ran out of memory */
-
-#ifdef DEBUG
-   if (p_rarch->ai_service_auto != 2)
-      RARCH_LOG("Request size: %d\n", bmp64_length);
 #endif
+
    {
-      char new_ai_service_url[PATH_MAX_LENGTH];
+      char *new_ai_service_url        = job->url;
       char separator                  = '?';
       unsigned ai_service_source_lang = settings->uints.ai_service_source_lang;
       unsigned ai_service_target_lang = settings->uints.ai_service_target_lang;
       const char *ai_service_url      = settings->arrays.ai_service_url;
 
-      strlcpy(new_ai_service_url, ai_service_url, sizeof(new_ai_service_url));
+      strlcpy(new_ai_service_url, ai_service_url, sizeof(job->url));
 
       /* if query already exists in url, then use &'s instead */
       if (strrchr(new_ai_service_url, '?'))
@@ -11914,7 +13111,7 @@ static bool run_translation_service(
                   "%csource_lang=%s", separator, lang_source);
             separator = '&';
             strlcat(new_ai_service_url,
-                  temp_string, sizeof(new_ai_service_url));
+                  temp_string, sizeof(job->url));
          }
       }
 
@@ -11933,7 +13130,7 @@ static bool run_translation_service(
             separator = '&';
 
             strlcat(new_ai_service_url, temp_string,
-                  sizeof(new_ai_service_url));
+                  sizeof(job->url));
          }
       }
 
@@ -11977,16 +13174,22 @@ static bool run_translation_service(
          separator = '&';
 
          strlcat(new_ai_service_url, temp_string,
-                 sizeof(new_ai_service_url));
+                 sizeof(job->url));
       }
-#ifdef DEBUG
-      if (p_rarch->ai_service_auto != 2)
-         RARCH_LOG("SENDING... %s\n", new_ai_service_url);
-#endif
-      task_push_http_post_transfer(new_ai_service_url,
-            json_buffer, true, NULL, handle_translation_cb, NULL);
    }
 
+   if (!(task = task_init()))
+      goto finish;
+
+   task->handler   = ai_service_encode_handler;
+   task->callback  = ai_service_encode_cb;
+   task->user_data = job;
+   task->mute      = true;
+   job             = NULL;
+
+   p_rarch->ai_service.request_pending = true;
+   task_queue_push(task);
+
    error = false;
 finish:
    if (bit24_image_prev)
@@ -11997,15 +13200,10 @@ finish:
    if (scaler)
       free(scaler);
 
-   if (bmp_buffer)
-      free(bmp_buffer);
-
-   if (bmp64_buffer)
-      free(bmp64_buffer);
+   if (job)
+      ai_service_job_free(job);
    if (system_label)
       free(system_label);
-   if (jsonwriter)
-      rjsonwriter_free(jsonwriter);
    return !error;
 }
 #endif
@@ -12455,7 +13653,10 @@ static void command_event_set_savestate_garbage_collect(
     *   the risk of deleting multiple incorrect files
     *   in case of accident */
    if (!string_is_empty(oldest_save) && (cnt > max_to_keep))
+   {
       filestream_delete(oldest_save);
+      content_update_state_slot_info(oldest_save);
+   }
 
    dir_list_free(dir_list);
 }
@@ -12593,6 +13794,23 @@ static void command_event_runtime_log_deinit(
          n = 0; /* Just silence any potential gcc warnings... */
       (void)n;
       RARCH_LOG("%s\n",log);
+
+      /* Main thread time neither slept nor spent in the
+       * video driver (which includes waiting for vsync
+       * and the GPU) is counted as busy */
+      if (p_rarch->power_session_start)
+      {
+         retro_time_t total = MAX(cpu_features_get_time_usec()
+               - p_rarch->power_session_start, 1);
+         retro_time_t video = MIN(p_rarch->power_video_usec, total);
+         retro_time_t idle  = MIN(p_rarch->power_sleep_usec + video, total);
+
+         RARCH_LOG("[Core]: Main thread busy %u%%, in video driver %u%%,"
+               " sleeping %u%% of the time.\n",
+               (unsigned)((total - idle) * 100 / total),
+               (unsigned)(video * 100 / total),
+               (unsigned)((idle - video) * 100 / total));
+      }
    }
 
    /* Only write to file if content has run for a non-zero length of time */
@@ -12621,6 +13839,9 @@ static void command_event_runtime_log_init(struct rarch_state *p_rarch)
 
    p_rarch->libretro_core_runtime_last = cpu_features_get_time_usec();
    p_rarch->libretro_core_runtime_usec = 0;
+   p_rarch->power_session_start        = p_rarch->libretro_core_runtime_last;
+   p_rarch->power_sleep_usec           = 0;
+   p_rarch->power_video_usec           = 0;
 
    /* Have to cache content and core path here, otherwise
     * logging fails if new content is loaded without
@@ -12649,6 +13870,47 @@ static void command_event_runtime_log_init(struct rarch_state *p_rarch)
             sizeof(p_rarch->runtime_core_path));
 }
 
+/* Margin left to retroarch_sleep_until() after sleeping,
+ * retro_sleep() only has millisecond granularity and tends
+ * to oversleep by about as much. */
+#define FRAME_LIMIT_SPIN_USEC 2000
+
+/* retro_sleep(), counting the time slept towards
+ * the power statistics of the session */
+static void retroarch_sleep(struct rarch_state *p_rarch, unsigned msec)
+{
+   retro_time_t start = cpu_features_get_time_usec();
+   retro_sleep(msec);
+   p_rarch->power_sleep_usec += cpu_features_get_time_usec() - start;
+}
+
+/**
+ * retroarch_sleep_until:
+ * @deadline           : cpu_features_get_time_usec() to wait for.
+ *
+ * Sleeps until FRAME_LIMIT_SPIN_USEC before @deadline and yields
+ * for the rest, which keeps frame intervals within a few
+ * microseconds of the target.
+ **/
+static void retroarch_sleep_until(struct rarch_state *p_rarch,
+      retro_time_t deadline)
+{
+   retro_time_t now = cpu_features_get_time_usec();
+
+   if (deadline - now > FRAME_LIMIT_SPIN_USEC)
+   {
+      retroarch_sleep(p_rarch,
+            (unsigned)((deadline - now - FRAME_LIMIT_SPIN_USEC) / 1000));
+      now = cpu_features_get_time_usec();
+   }
+
+   while (now < deadline)
+   {
+      retro_sleep(0);
+      now = cpu_features_get_time_usec();
+   }
+}
+
 static INLINE void retroarch_set_frame_limit(
       struct rarch_state *p_rarch,
       float fastforward_ratio)
@@ -12684,6 +13946,7 @@ static bool command_event_init_core(
    unsigned poll_type_behavior     = 0;
    float fastforward_ratio         = 0.0f;
    rarch_system_info_t *sys_info   = &runloop_state.system;
+   retro_time_t start_usec         = cpu_features_get_time_usec();
 
    if (!init_libretro_symbols(p_rarch,
             type, &p_rarch->current_core))
@@ -12763,18 +14026,23 @@ static bool command_event_init_core(
    p_rarch->current_core.retro_init();
    p_rarch->current_core.inited          = true;
 
+   retroarch_startup_trace_add("Core load", start_usec);
+
    /* Attempt to set initial disk index */
    disk_control_set_initial_index(
          &sys_info->disk_control,
          path_get(RARCH_PATH_CONTENT),
          p_rarch->current_savefile_dir);
 
+   start_usec = cpu_features_get_time_usec();
    if (!event_init_content(settings, p_rarch))
       return false;
+   retroarch_startup_trace_add("Content load", start_usec);
 
    /* Verify that initial disk index was set correctly */
    disk_control_verify_initial_index(&sys_info->disk_control,
          show_set_initial_disk_msg);
+   disk_control_prefetch_next(&sys_info->disk_control);
 
    if (!core_load(p_rarch, poll_type_behavior))
       return false;
@@ -13404,6 +14672,9 @@ static void runahead_clear_variables(struct rarch_state *p_rarch)
    p_rarch->runahead_secondary_core_available = true;
    p_rarch->runahead_force_input_dirty        = true;
    p_rarch->runahead_last_frame_count         = 0;
+   p_rarch->runahead_ring_size                = 0;
+   p_rarch->runahead_ring_tail                = 0;
+   p_rarch->runahead_ring_count               = 0;
 }
 #endif
 
@@ -13477,6 +14748,36 @@ bool command_event(enum event_command cmd, void *data)
          bsv_movie_check(p_rarch, settings);
 #endif
          break;
+      case CMD_EVENT_TRACE_TOGGLE:
+         if (perf_trace_is_active())
+            retroarch_trace_finished(perf_trace_stop());
+         else
+         {
+            char trace_path[PATH_MAX_LENGTH];
+            char trace_file[64];
+            const char *log_dir = settings->paths.log_dir;
+
+            trace_path[0] = '\0';
+            trace_file[0] = '\0';
+
+            fill_str_dated_filename(trace_file, "retroarch_trace",
+                  "json", sizeof(trace_file));
+
+            if (!string_is_empty(log_dir))
+               fill_pathname_join(trace_path, log_dir, trace_file,
+                     sizeof(trace_path));
+            else
+               fill_pathname_resolve_relative(trace_path,
+                     path_get(RARCH_PATH_CONFIG), trace_file,
+                     sizeof(trace_path));
+
+            if (perf_trace_start(trace_path,
+                     settings->uints.trace_duration * 1000000LL))
+               runloop_msg_queue_push(msg_hash_to_str(MSG_TRACE_STARTED),
+                     1, 100, false,
+                     NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         }
+         break;
       case CMD_EVENT_AI_SERVICE_TOGGLE:
          {
 #ifdef HAVE_TRANSLATE
@@ -13524,6 +14825,7 @@ bool command_event(enum event_command cmd, void *data)
                   /* Auto mode was turned on, but we pressed the
                    * toggle button, so turn it off now. */
                   p_rarch->ai_service_auto = 0;
+                  ai_service_cancel(p_rarch);
 #ifdef HAVE_MENU_WIDGETS
                   gfx_widgets_ai_service_overlay_unload(&p_rarch->dispwidget_st);
 #endif
@@ -13577,6 +14879,55 @@ bool command_event(enum event_command cmd, void *data)
             }
          }
          break;
+      case CMD_EVENT_RUNAHEAD_CALIBRATE:
+#ifdef HAVE_RUNAHEAD
+         {
+            char msg[256];
+            unsigned frames = 0;
+
+            msg[0] = '\0';
+
+            if (rarch_ctl(RARCH_CTL_IS_DUMMY_CORE, NULL))
+               return false;
+
+            if (!runahead_calibrate(p_rarch, &frames))
+            {
+               snprintf(msg, sizeof(msg),
+                     msg_hash_to_str(MSG_RUNAHEAD_CALIBRATION_FAILED),
+                     RUNAHEAD_CALIBRATE_MAX_FRAMES);
+               RARCH_WARN("[Run-Ahead]: %s\n", msg);
+               runloop_msg_queue_push(msg, 1, 180, true,
+                     NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_WARNING);
+               return false;
+            }
+
+            if (!frames)
+            {
+               RARCH_LOG("[Run-Ahead]: %s\n",
+                     msg_hash_to_str(MSG_RUNAHEAD_CALIBRATION_NO_LAG));
+               runloop_msg_queue_push(
+                     msg_hash_to_str(MSG_RUNAHEAD_CALIBRATION_NO_LAG),
+                     1, 180, true,
+                     NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+               break;
+            }
+
+            configuration_set_uint(settings,
+                  settings->uints.run_ahead_frames, frames);
+
+#ifdef HAVE_CONFIGFILE
+            /* Keep the result for this game only */
+            command_event_save_current_config(p_rarch, OVERRIDE_GAME);
+#endif
+
+            snprintf(msg, sizeof(msg),
+                  msg_hash_to_str(MSG_RUNAHEAD_CALIBRATED), frames);
+            RARCH_LOG("[Run-Ahead]: %s\n", msg);
+            runloop_msg_queue_push(msg, 1, 180, false,
+                  NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         }
+#endif
+         break;
       case CMD_EVENT_RECORDING_TOGGLE:
          if (recording_is_enabled())
             command_event(CMD_EVENT_RECORD_DEINIT, NULL);
@@ -14000,14 +15351,15 @@ bool command_event(enum event_command cmd, void *data)
 #ifdef HAVE_DSP_FILTER
          {
             const char *path_audio_dsp_plugin = settings->paths.path_audio_dsp_plugin;
+            audio_driver_lock_processing(p_rarch);
             audio_driver_dsp_filter_free();
-            if (string_is_empty(path_audio_dsp_plugin))
-               break;
-            if (!audio_driver_dsp_filter_init(path_audio_dsp_plugin))
+            if (     !string_is_empty(path_audio_dsp_plugin)
+                  && !audio_driver_dsp_filter_init(path_audio_dsp_plugin))
             {
                RARCH_ERR("[DSP]: Failed to initialize DSP filter \"%s\".\n",
                      path_audio_dsp_plugin);
             }
+            audio_driver_unlock_processing(p_rarch);
          }
 #endif
          break;
@@ -14128,6 +15480,7 @@ bool command_event(enum event_command cmd, void *data)
       case CMD_EVENT_CORE_INFO_INIT:
          {
             char ext_name[255];
+            retro_time_t start_usec        = cpu_features_get_time_usec();
             const char *dir_libretro       = settings->paths.directory_libretro;
             const char *path_libretro_info = settings->paths.path_libretro_info;
             bool show_hidden_files         = settings->bools.show_hidden_files;
@@ -14147,6 +15500,8 @@ bool command_event(enum event_command cmd, void *data)
                      show_hidden_files,
                      core_info_cache_enable
                      );
+
+            retroarch_startup_trace_add("Core info", start_usec);
          }
          break;
       case CMD_EVENT_CORE_DEINIT:
@@ -14330,7 +15685,7 @@ bool command_event(enum event_command cmd, void *data)
                            (current_sort_mode == PLAYLIST_SORT_MODE_ALPHABETICAL))
                         playlist_qsort(g_defaults.content_favorites);
 
-                     playlist_write_file(g_defaults.content_favorites);
+                     playlist_write_file_deferred(g_defaults.content_favorites);
                      runloop_msg_queue_push(msg_hash_to_str(MSG_ADDED_TO_FAVORITES), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
                   }
                }
@@ -15354,12 +16709,20 @@ void main_exit(void *args)
 #endif
    settings_t     *settings     = p_rarch->configuration_settings;
    bool     config_save_on_exit = settings->bools.config_save_on_exit;
+   bool            benchmarking = !string_is_empty(p_rarch->benchmark_path);
 
    video_driver_restore_cached(p_rarch, settings);
 
-   if (config_save_on_exit)
+   /* The benchmark changed the sync settings */
+   if (config_save_on_exit && !benchmarking)
       command_event(CMD_EVENT_MENU_SAVE_CURRENT_CONFIG, NULL);
 
+   if (benchmarking)
+   {
+      retroarch_benchmark_write(p_rarch, p_rarch->benchmark_path);
+      perf_scope_capture_stop();
+   }
+
 #if defined(HAVE_GFX_WIDGETS)
    /* Do not want display widgets to live any more. */
    p_rarch->widgets_persisting = false;
@@ -15373,8 +16736,12 @@ void main_exit(void *args)
 
    if (runloop_state.perfcnt_enable)
    {
+      char scopes[2048];
       RARCH_LOG("[PERF]: Performance counters (RetroArch):\n");
       log_counters(p_rarch->perf_counters_rarch, p_rarch->perf_ptr_rarch);
+
+      if (perf_scope_report(scopes, sizeof(scopes), true))
+         RARCH_LOG("[PERF]: Frame scopes (usec per frame):\n%s", scopes);
    }
 
 #if defined(HAVE_LOGGER) && !defined(ANDROID)
@@ -15396,12 +16763,29 @@ void main_exit(void *args)
 
    retroarch_msg_queue_deinit(p_rarch);
    driver_uninit(p_rarch, DRIVERS_CMD_ALL);
+   font_renderer_sdf_cache_free();
 
+   verbosity_set_async(false);
    retro_main_log_file_deinit();
 
    rarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
    global_free(p_rarch);
+   playlist_write_deferred_flush();
    task_queue_deinit();
+#ifdef HAVE_THREADS
+   task_image_pool_deinit();
+   tpool_shared_deinit();
+#endif
+   perf_trace_deinit();
+#ifdef HAVE_NETWORKING
+   net_http_pool_deinit();
+#endif
+#ifdef HAVE_COMPRESSION
+   file_archive_directory_cache_deinit();
+#ifdef HAVE_7ZIP
+   file_archive_extract_cache_deinit();
+#endif
+#endif
 
    if (p_rarch->configuration_settings)
       free(p_rarch->configuration_settings);
@@ -15529,7 +16913,9 @@ int rarch_main(int argc, char *argv[], void *data)
 #endif
       ret = runloop_iterate();
 
+      PERF_SCOPE_BEGIN("task_gather");
       task_queue_check();
+      PERF_SCOPE_END();
 
 #ifdef HAVE_QT
       app_exit = ui_companion_qt.application->exiting;
@@ -15588,7 +16974,9 @@ void emscripten_mainloop(void)
 
    ret = runloop_iterate();
 
+   PERF_SCOPE_BEGIN("task_gather");
    task_queue_check();
+   PERF_SCOPE_END();
 
    if (ret != -1)
       return;
@@ -15893,9 +17281,88 @@ static void core_option_manager_free(core_option_manager_t *opt)
    if (opt->conf)
       config_file_free(opt->conf);
    free(opt->opts);
+   free(opt->map);
    free(opt);
 }
 
+/**
+ * core_option_manager_init_map:
+ * @opt              : options manager handle
+ *
+ * Builds the key lookup table, once all options
+ * have been parsed.
+ *
+ * Returns: 'true' on success.
+ **/
+static bool core_option_manager_init_map(core_option_manager_t *opt)
+{
+   size_t i;
+   size_t map_size = 16;
+
+   /* Keep the table at most half full */
+   while (map_size < opt->size * 2)
+      map_size <<= 1;
+
+   if (!(opt->map = (size_t*)calloc(map_size, sizeof(size_t))))
+      return false;
+
+   opt->map_mask = map_size - 1;
+
+   for (i = 0; i < opt->size; i++)
+   {
+      size_t slot;
+      struct core_option *option = &opt->opts[i];
+
+      if (string_is_empty(option->key))
+         continue;
+
+      option->key_hash = msg_hash_calculate(option->key);
+
+      /* Duplicate keys resolve to the first option,
+       * as with a linear search */
+      for (slot = option->key_hash & opt->map_mask;
+           opt->map[slot];
+           slot = (slot + 1) & opt->map_mask)
+         if (string_is_equal(opt->opts[opt->map[slot] - 1].key,
+                  option->key))
+            break;
+
+      if (!opt->map[slot])
+         opt->map[slot] = i + 1;
+   }
+
+   return true;
+}
+
+bool core_option_manager_get_idx(core_option_manager_t *opt,
+      const char *key, size_t *idx)
+{
+   size_t slot;
+   uint32_t hash;
+
+   if (!opt || !opt->map || string_is_empty(key))
+      return false;
+
+   hash = msg_hash_calculate(key);
+
+   for (slot = hash & opt->map_mask;
+        opt->map[slot];
+        slot = (slot + 1) & opt->map_mask)
+   {
+      struct core_option *option = &opt->opts[opt->map[slot] - 1];
+
+      if (     (option->key_hash == hash)
+            && string_is_equal(option->key, key))
+      {
+         if (idx)
+            *idx = opt->map[slot] - 1;
+         return true;
+      }
+   }
+
+   return false;
+}
+
 /**
  * core_option_manager_new_vars:
  * @conf_path        : Filesystem path to write core option config file to.
@@ -15923,6 +17390,8 @@ static core_option_manager_t *core_option_manager_new_vars(
    opt->conf                         = NULL;
    opt->conf_path[0]                 = '\0';
    opt->opts                         = NULL;
+   opt->map                          = NULL;
+   opt->map_mask                     = 0;
    opt->size                         = 0;
    opt->updated                      = false;
 
@@ -15956,6 +17425,9 @@ static core_option_manager_t *core_option_manager_new_vars(
          goto error;
    }
 
+   if (!core_option_manager_init_map(opt))
+      goto error;
+
    if (config_src)
       config_file_free(config_src);
 
@@ -15994,6 +17466,8 @@ static core_option_manager_t *core_option_manager_new(
    opt->conf                         = NULL;
    opt->conf_path[0]                 = '\0';
    opt->opts                         = NULL;
+   opt->map                          = NULL;
+   opt->map_mask                     = 0;
    opt->size                         = 0;
    opt->updated                      = false;
 
@@ -16031,6 +17505,9 @@ static core_option_manager_t *core_option_manager_new(
       if (!core_option_manager_parse_option(opt, size, option_def, config_src))
          goto error;
 
+   if (!core_option_manager_init_map(opt))
+      goto error;
+
    if (config_src)
       config_file_free(config_src);
 
@@ -16360,22 +17837,10 @@ static struct retro_core_option_definition *core_option_manager_get_definitions(
 static void core_option_manager_set_display(core_option_manager_t *opt,
       const char *key, bool visible)
 {
-   size_t i;
-
-   if (!opt || string_is_empty(key))
-      return;
-
-   for (i = 0; i < opt->size; i++)
-   {
-      if (string_is_empty(opt->opts[i].key))
-         continue;
+   size_t idx;
 
-      if (string_is_equal(opt->opts[i].key, key))
-      {
-         opt->opts[i].visible = visible;
-         return;
-      }
-   }
+   if (core_option_manager_get_idx(opt, key, &idx))
+      opt->opts[idx].visible = visible;
 }
 
 /* DYNAMIC LIBRETRO CORE  */
@@ -17070,7 +18535,7 @@ static bool rarch_environment_cb(unsigned cmd, void *data)
             }
 
             {
-               size_t i;
+               size_t idx;
 
 #ifdef HAVE_RUNAHEAD
                if (runloop_state.core_options->updated)
@@ -17079,17 +18544,10 @@ static bool rarch_environment_cb(unsigned cmd, void *data)
 
                runloop_state.core_options->updated   = false;
 
-               for (i = 0; i < runloop_state.core_options->size; i++)
-               {
-                  if (!string_is_empty(runloop_state.core_options->opts[i].key))
-                     if (string_is_equal(
-                              runloop_state.core_options->opts[i].key, var->key))
-                     {
-                        var->value = runloop_state.core_options->opts[i].vals->elems[
-                           runloop_state.core_options->opts[i].index].data;
-                        break;
-                     }
-               }
+               if (core_option_manager_get_idx(runloop_state.core_options,
+                        var->key, &idx))
+                  var->value = runloop_state.core_options->opts[idx].vals->elems[
+                     runloop_state.core_options->opts[idx].index].data;
             }
 
             if (log_level == RETRO_LOG_DEBUG)
@@ -18105,6 +19563,13 @@ static bool rarch_environment_cb(unsigned cmd, void *data)
             rarch_memory_descriptor_t *descriptors = NULL;
 
             RARCH_LOG("[Environ]: SET_MEMORY_MAPS.\n");
+#ifdef HAVE_MEMORY_WATCH
+            /* Rebuilt from the new map on the next frame */
+            if (p_rarch->memory_watch)
+               memory_watch_free(p_rarch->memory_watch);
+            p_rarch->memory_watch       = NULL;
+            p_rarch->memory_watch_tried = false;
+#endif
             free((void*)system->mmaps.descriptors);
             system->mmaps.descriptors     = 0;
             system->mmaps.num_descriptors = 0;
@@ -18210,6 +19675,16 @@ static bool rarch_environment_cb(unsigned cmd, void *data)
       case RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER:
       {
          struct retro_framebuffer *fb = (struct retro_framebuffer*)data;
+
+         /* Softfilters and the 0RGB1555 conversion hand the driver
+          * a different buffer anyway, and reading the core's frame
+          * back from mapped GPU memory would only slow them down. */
+         if (     p_rarch->video_driver_state_filter
+               || (p_rarch->video_driver_scaler_ptr
+                  && p_rarch->video_driver_pix_fmt
+                  == RETRO_PIXEL_FORMAT_0RGB1555))
+            return false;
+
          if (
                   p_rarch->video_driver_poke
                && p_rarch->video_driver_poke->get_current_software_framebuffer
@@ -18779,9 +20254,11 @@ static bool init_libretro_symbols_custom(
             {
                /* for a secondary core, we already have a
                 * primary library loaded, so we can skip
-                * some checks and just load the library */
+                * some checks and just load the library
+                * (unless the caller loaded it already) */
                retro_assert(lib_path != NULL && lib_handle_p != NULL);
-               lib_handle_local = dylib_load(lib_path);
+               if (!(lib_handle_local = *lib_handle_p))
+                  lib_handle_local = dylib_load(lib_path);
 
                if (!lib_handle_local)
                   return false;
@@ -19049,9 +20526,12 @@ static void secondary_core_destroy(struct rarch_state *p_rarch)
 
    dylib_close(p_rarch->secondary_lib_handle);
    p_rarch->secondary_lib_handle = NULL;
-   filestream_delete(p_rarch->secondary_library_path);
+   /* Only set when the core was loaded from a temp copy */
    if (p_rarch->secondary_library_path)
+   {
+      filestream_delete(p_rarch->secondary_library_path);
       free(p_rarch->secondary_library_path);
+   }
    p_rarch->secondary_library_path = NULL;
 }
 
@@ -19325,16 +20805,37 @@ static bool secondary_core_create(struct rarch_state *p_rarch,
    if (p_rarch->secondary_library_path)
       free(p_rarch->secondary_library_path);
    p_rarch->secondary_library_path = NULL;
-   p_rarch->secondary_library_path = copy_core_to_temp_file(p_rarch,
-         settings->paths.directory_libretro);
 
-   if (!p_rarch->secondary_library_path)
-      return false;
+   /* Where the platform can load a library twice (in a
+    * namespace of its own), there is no need to copy
+    * the core to a temporary file first. The namespace
+    * gets its own libc but not the video driver's GL or
+    * Vulkan libraries, so hardware rendered cores always
+    * use the copy. */
+   if (     !p_rarch->secondary_lib_handle
+         && settings->bools.run_ahead_secondary_isolated
+         && p_rarch->hw_render.context_type == RETRO_HW_CONTEXT_NONE)
+   {
+      if ((p_rarch->secondary_lib_handle = dylib_load_isolated(
+                  path_get(RARCH_PATH_CORE))))
+         RARCH_LOG("[Run-Ahead]: Secondary instance loaded in its own namespace.\n");
+   }
+
+   if (!p_rarch->secondary_lib_handle)
+   {
+      p_rarch->secondary_library_path = copy_core_to_temp_file(p_rarch,
+            settings->paths.directory_libretro);
+
+      if (!p_rarch->secondary_library_path)
+         return false;
+   }
 
    /* Load Core */
    if (!init_libretro_symbols_custom(p_rarch,
             CORE_TYPE_PLAIN, &p_rarch->secondary_core,
-            p_rarch->secondary_library_path,
+            p_rarch->secondary_library_path
+            ? p_rarch->secondary_library_path
+            : path_get(RARCH_PATH_CORE),
             &p_rarch->secondary_lib_handle))
       return false;
 
@@ -19466,6 +20967,7 @@ const char* config_get_bluetooth_driver_options(void)
 void driver_bluetooth_scan(void)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   bluetooth_driver_ctl(RARCH_BLUETOOTH_CTL_INIT_DEFERRED, NULL);
    if ( (p_rarch->bluetooth_driver_active) &&
         (p_rarch->bluetooth_driver->scan) )
       p_rarch->bluetooth_driver->scan(p_rarch->bluetooth_data);
@@ -19474,6 +20976,7 @@ void driver_bluetooth_scan(void)
 void driver_bluetooth_get_devices(struct string_list* devices)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   bluetooth_driver_ctl(RARCH_BLUETOOTH_CTL_INIT_DEFERRED, NULL);
    if ( (p_rarch->bluetooth_driver_active) &&
         (p_rarch->bluetooth_driver->get_devices) )
       p_rarch->bluetooth_driver->get_devices(p_rarch->bluetooth_data, devices);
@@ -19482,6 +20985,7 @@ void driver_bluetooth_get_devices(struct string_list* devices)
 bool driver_bluetooth_device_is_connected(unsigned i)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   bluetooth_driver_ctl(RARCH_BLUETOOTH_CTL_INIT_DEFERRED, NULL);
    if ( (p_rarch->bluetooth_driver_active) &&
         (p_rarch->bluetooth_driver->device_is_connected) )
       return p_rarch->bluetooth_driver->device_is_connected(p_rarch->bluetooth_data, i);
@@ -19491,6 +20995,7 @@ bool driver_bluetooth_device_is_connected(unsigned i)
 void driver_bluetooth_device_get_sublabel(char *s, unsigned i, size_t len)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   bluetooth_driver_ctl(RARCH_BLUETOOTH_CTL_INIT_DEFERRED, NULL);
    if ( (p_rarch->bluetooth_driver_active) &&
         (p_rarch->bluetooth_driver->device_get_sublabel) )
       p_rarch->bluetooth_driver->device_get_sublabel(p_rarch->bluetooth_data, s, i, len);
@@ -19499,6 +21004,7 @@ void driver_bluetooth_device_get_sublabel(char *s, unsigned i, size_t len)
 bool driver_bluetooth_connect_device(unsigned i)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   bluetooth_driver_ctl(RARCH_BLUETOOTH_CTL_INIT_DEFERRED, NULL);
    if (p_rarch->bluetooth_driver_active)
       return p_rarch->bluetooth_driver->connect_device(p_rarch->bluetooth_data, i);
    return false;
@@ -19515,6 +21021,7 @@ bool bluetooth_driver_ctl(enum rarch_bluetooth_ctl_state state, void *data)
          p_rarch->bluetooth_driver          = NULL;
          p_rarch->bluetooth_data            = NULL;
          p_rarch->bluetooth_driver_active   = false;
+         p_rarch->bluetooth_driver_deferred = false;
          break;
       case RARCH_BLUETOOTH_CTL_FIND_DRIVER:
          {
@@ -19553,9 +21060,15 @@ bool bluetooth_driver_ctl(enum rarch_bluetooth_ctl_state state, void *data)
               p_rarch->bluetooth_driver->free(p_rarch->bluetooth_data);
         }
 
-        p_rarch->bluetooth_data = NULL;
-        p_rarch->bluetooth_driver_active = false;
+        p_rarch->bluetooth_data            = NULL;
+        p_rarch->bluetooth_driver_active   = false;
+        p_rarch->bluetooth_driver_deferred = false;
         break;
+      case RARCH_BLUETOOTH_CTL_INIT_DEFERRED:
+        if (!p_rarch->bluetooth_driver_deferred)
+           return false;
+        p_rarch->bluetooth_driver_deferred = false;
+        return bluetooth_driver_ctl(RARCH_BLUETOOTH_CTL_INIT, NULL);
       case RARCH_BLUETOOTH_CTL_INIT:
         /* Resource leaks will follow if bluetooth is initialized twice. */
         if (p_rarch->bluetooth_data)
@@ -19604,48 +21117,56 @@ const char* config_get_wifi_driver_options(void)
 void driver_wifi_scan(void)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
    p_rarch->wifi_driver->scan(p_rarch->wifi_data);
 }
 
 bool driver_wifi_enable(bool enabled)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
    return p_rarch->wifi_driver->enable(p_rarch->wifi_data, enabled);
 }
 
 bool driver_wifi_connection_info(wifi_network_info_t *netinfo)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
    return p_rarch->wifi_driver->connection_info(p_rarch->wifi_data, netinfo);
 }
 
 wifi_network_scan_t* driver_wifi_get_ssids()
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
    return p_rarch->wifi_driver->get_ssids(p_rarch->wifi_data);
 }
 
 bool driver_wifi_ssid_is_online(unsigned i)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
    return p_rarch->wifi_driver->ssid_is_online(p_rarch->wifi_data, i);
 }
 
 bool driver_wifi_connect_ssid(const wifi_network_info_t* net)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
    return p_rarch->wifi_driver->connect_ssid(p_rarch->wifi_data, net);
 }
 
 bool driver_wifi_disconnect_ssid(const wifi_network_info_t* net)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
    return p_rarch->wifi_driver->disconnect_ssid(p_rarch->wifi_data, net);
 }
 
 void driver_wifi_tether_start_stop(bool start, char* configfile)
 {
    struct rarch_state       *p_rarch = &rarch_st;
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
    p_rarch->wifi_driver->tether_start_stop(p_rarch->wifi_data, start, configfile);
 }
 
@@ -19658,6 +21179,7 @@ bool wifi_driver_ctl(enum rarch_wifi_ctl_state state, void *data)
    {
       case RARCH_WIFI_CTL_DESTROY:
          p_rarch->wifi_driver_active   = false;
+         p_rarch->wifi_driver_deferred = false;
          p_rarch->wifi_driver          = NULL;
          p_rarch->wifi_data            = NULL;
          break;
@@ -19706,7 +21228,8 @@ bool wifi_driver_ctl(enum rarch_wifi_ctl_state state, void *data)
               p_rarch->wifi_driver->free(p_rarch->wifi_data);
         }
 
-        p_rarch->wifi_data = NULL;
+        p_rarch->wifi_data            = NULL;
+        p_rarch->wifi_driver_deferred = false;
         break;
       case RARCH_WIFI_CTL_STOP:
         if (     p_rarch->wifi_driver
@@ -19724,6 +21247,11 @@ bool wifi_driver_ctl(enum rarch_wifi_ctl_state state, void *data)
               return p_rarch->wifi_driver->start(p_rarch->wifi_data);
         }
         return false;
+      case RARCH_WIFI_CTL_INIT_DEFERRED:
+        if (!p_rarch->wifi_driver_deferred)
+           return false;
+        p_rarch->wifi_driver_deferred = false;
+        return wifi_driver_ctl(RARCH_WIFI_CTL_INIT, NULL);
       case RARCH_WIFI_CTL_INIT:
         /* Resource leaks will follow if wifi is initialized twice. */
         if (p_rarch->wifi_data)
@@ -20073,6 +21601,7 @@ static void recording_driver_free_state(struct rarch_state *p_rarch)
    /* TODO/FIXME - this is not being called anywhere */
    p_rarch->recording_gpu_width      = 0;
    p_rarch->recording_gpu_height     = 0;
+   p_rarch->recording_gpu_max_size   = 0;
    p_rarch->recording_width          = 0;
    p_rarch->recording_height         = 0;
 }
@@ -20145,7 +21674,28 @@ static void recording_dump_frame(
          return;
       }
 
-      /* User has resized. We kinda have a problem now. */
+      /* User has resized. The recording driver scales every
+       * frame to the output size anyway, so carry on as long
+       * as the frame still fits in what it has allocated. */
+      if (  vp.width  != p_rarch->recording_gpu_width ||
+            vp.height != p_rarch->recording_gpu_height)
+      {
+         uint8_t *buf = NULL;
+
+         if ((size_t)vp.width * vp.height <= p_rarch->recording_gpu_max_size
+               && (buf = (uint8_t*)realloc(
+                     p_rarch->video_driver_record_gpu_buffer,
+                     vp.width * vp.height * 3)))
+         {
+            RARCH_LOG("[recording] %s %u x %u\n",
+                  msg_hash_to_str(MSG_DETECTED_VIEWPORT_OF),
+                  vp.width, vp.height);
+            p_rarch->video_driver_record_gpu_buffer = buf;
+            p_rarch->recording_gpu_width            = vp.width;
+            p_rarch->recording_gpu_height           = vp.height;
+         }
+      }
+
       if (  vp.width  != p_rarch->recording_gpu_width ||
             vp.height != p_rarch->recording_gpu_height)
       {
@@ -20384,8 +21934,12 @@ static bool recording_init(
 
       params.out_width                    = vp.width;
       params.out_height                   = vp.height;
-      params.fb_width                     = next_pow2(vp.width);
-      params.fb_height                    = next_pow2(vp.height);
+      /* Leave room for the viewport to grow up to the
+       * window size without having to stop recording */
+      params.fb_width                     = next_pow2(
+            MAX(vp.width, vp.full_width));
+      params.fb_height                    = next_pow2(
+            MAX(vp.height, vp.full_height));
 
       if (video_force_aspect &&
             (p_rarch->video_driver_aspect_ratio > 0.0f))
@@ -20396,6 +21950,8 @@ static bool recording_init(
       params.pix_fmt                      = FFEMU_PIX_BGR24;
       p_rarch->recording_gpu_width        = vp.width;
       p_rarch->recording_gpu_height       = vp.height;
+      p_rarch->recording_gpu_max_size     =
+         (size_t)params.fb_width * params.fb_height;
 
       RARCH_LOG("[recording] %s %u x %u\n", msg_hash_to_str(MSG_DETECTED_VIEWPORT_OF),
             vp.width, vp.height);
@@ -20519,6 +22075,822 @@ void recording_driver_update_streaming_url(void)
 
 #ifdef HAVE_BSV_MOVIE
 /* BSV MOVIE */
+
+/* Compact movies (BSV2)
+ *
+ * Input is gathered in blocks of BSV2_BLOCK_FRAMES frames.
+ * Within a block every frame starts with a varint token:
+ * (run << 1) | 1 repeats the previous frame 'run' times,
+ * (count << 1) is followed by 'count' zigzag varint deltas
+ * against the values of the previous frame. Every
+ * BSV2_KEYFRAME_INTERVAL frames a block also carries a
+ * savestate, and the list of blocks is stored as an index
+ * at the end of the file, so playback can get to any
+ * keyframe without decoding what comes before it. */
+
+static size_t bsv2_put_varint(uint8_t *out, uint32_t val)
+{
+   size_t len = 0;
+
+   while (val >= 0x80)
+   {
+      out[len++] = (uint8_t)(val | 0x80);
+      val      >>= 7;
+   }
+   out[len++]    = (uint8_t)val;
+
+   return len;
+}
+
+static bool bsv2_get_varint(const uint8_t **in,
+      const uint8_t *end, uint32_t *val)
+{
+   unsigned shift = 0;
+   uint32_t v     = 0;
+
+   while (*in < end && shift < 32)
+   {
+      uint8_t b = *(*in)++;
+      v        |= (uint32_t)(b & 0x7F) << shift;
+      if (!(b & 0x80))
+      {
+         *val = v;
+         return true;
+      }
+      shift    += 7;
+   }
+
+   return false;
+}
+
+static bool bsv2_reserve_values(bsv_movie_t *handle, size_t count)
+{
+   int16_t *values;
+   size_t new_size = handle->values_size ? handle->values_size : 1024;
+
+   if (count <= handle->values_size)
+      return true;
+
+   while (new_size < count)
+      new_size *= 2;
+
+   if (!(values = (int16_t*)realloc(handle->values,
+               new_size * sizeof(*values))))
+      return false;
+
+   handle->values      = values;
+   handle->values_size = new_size;
+   return true;
+}
+
+static bool bsv2_reserve_frames(bsv_movie_t *handle, size_t num_frames)
+{
+   uint32_t *offsets;
+
+   if (num_frames + 1 <= handle->frame_offsets_size)
+      return true;
+
+   if (!(offsets = (uint32_t*)realloc(handle->frame_offsets,
+               (num_frames + 1) * sizeof(*offsets))))
+      return false;
+
+   handle->frame_offsets      = offsets;
+   handle->frame_offsets_size = num_frames + 1;
+   return true;
+}
+
+static bool bsv2_frame_equal(const bsv_movie_t *handle,
+      uint32_t a, uint32_t b)
+{
+   uint32_t len = handle->frame_offsets[a + 1] - handle->frame_offsets[a];
+
+   if (len != handle->frame_offsets[b + 1] - handle->frame_offsets[b])
+      return false;
+
+   return !len || !memcmp(handle->values + handle->frame_offsets[a],
+         handle->values + handle->frame_offsets[b],
+         len * sizeof(int16_t));
+}
+
+/* 'out' must hold 5 bytes per frame and 3 per value */
+static size_t bsv2_encode_input(const bsv_movie_t *handle, uint8_t *out)
+{
+   size_t len      = 0;
+   uint32_t frame  = 0;
+   /* The frame before the first one has no input */
+   uint32_t prev_start = 0;
+   uint32_t prev_count = 0;
+
+   while (frame < handle->block_frames)
+   {
+      uint32_t i;
+      uint32_t start = handle->frame_offsets[frame];
+      uint32_t count = handle->frame_offsets[frame + 1] - start;
+
+      if (count == prev_count && (!count || !memcmp(handle->values + start,
+               handle->values + prev_start, count * sizeof(int16_t))))
+      {
+         uint32_t run = 1;
+
+         while (frame + run < handle->block_frames
+               && bsv2_frame_equal(handle, frame, frame + run))
+            run++;
+
+         len   += bsv2_put_varint(out + len, (run << 1) | 1);
+         frame += run;
+         continue;
+      }
+
+      len += bsv2_put_varint(out + len, count << 1);
+
+      for (i = 0; i < count; i++)
+      {
+         uint16_t prev  = (i < prev_count)
+            ? (uint16_t)handle->values[prev_start + i] : 0;
+         uint16_t delta = (uint16_t)((uint16_t)handle->values[start + i] - prev);
+         len += bsv2_put_varint(out + len,
+               (uint16_t)((delta << 1) ^ ((delta & 0x8000) ? 0xFFFF : 0)));
+      }
+
+      prev_start = start;
+      prev_count = count;
+      frame++;
+   }
+
+   return len;
+}
+
+static bool bsv2_decode_input(bsv_movie_t *handle,
+      const uint8_t *in, size_t len, uint32_t num_frames)
+{
+   const uint8_t *end  = in + len;
+   uint32_t frame      = 0;
+   uint32_t prev_start = 0;
+   uint32_t prev_count = 0;
+
+   if (!bsv2_reserve_frames(handle, num_frames))
+      return false;
+
+   handle->num_values       = 0;
+   handle->frame_offsets[0] = 0;
+
+   while (frame < num_frames)
+   {
+      uint32_t i, token;
+
+      if (!bsv2_get_varint(&in, end, &token))
+         return false;
+
+      if (token & 1)
+      {
+         uint32_t run = token >> 1;
+
+         if (run == 0 || run > num_frames - frame
+               || !bsv2_reserve_values(handle,
+                  handle->num_values + (size_t)run * prev_count))
+            return false;
+
+         while (run--)
+         {
+            if (prev_count)
+               memcpy(handle->values + handle->num_values,
+                     handle->values + prev_start,
+                     prev_count * sizeof(int16_t));
+            prev_start                     = (uint32_t)handle->num_values;
+            handle->num_values            += prev_count;
+            handle->frame_offsets[++frame] = (uint32_t)handle->num_values;
+         }
+         continue;
+      }
+
+      if (!bsv2_reserve_values(handle, handle->num_values + (token >> 1)))
+         return false;
+
+      for (i = 0; i < token >> 1; i++)
+      {
+         uint32_t zz;
+         uint16_t delta;
+         uint16_t prev = (i < prev_count)
+            ? (uint16_t)handle->values[prev_start + i] : 0;
+
+         if (!bsv2_get_varint(&in, end, &zz) || zz > 0xFFFF)
+            return false;
+
+         delta = (uint16_t)((zz >> 1) ^ ((zz & 1) ? 0xFFFF : 0));
+         handle->values[handle->num_values + i] =
+            (int16_t)(uint16_t)(prev + delta);
+      }
+
+      prev_start                     = (uint32_t)handle->num_values;
+      prev_count                     = token >> 1;
+      handle->num_values            += prev_count;
+      handle->frame_offsets[++frame] = (uint32_t)handle->num_values;
+   }
+
+   return in == end;
+}
+
+#ifdef HAVE_ZLIB
+/* Returns a deflated copy of 'data', or NULL
+ * if it doesn't get any smaller */
+static uint8_t *bsv2_deflate(const uint8_t *data, size_t len,
+      size_t *out_len)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+   size_t max_len  = len + len / 8 + 64;
+   void *stream    = backend->stream_new();
+   uint8_t *buf    = (uint8_t*)malloc(max_len);
+   uint8_t *out    = NULL;
+
+   if (!stream || !buf)
+      goto end;
+
+   backend->set_in(stream, data, (uint32_t)len);
+   backend->set_out(stream, buf, (uint32_t)max_len);
+
+   if (backend->trans(stream, true, &rd, &wn, &err) && wn < len)
+   {
+      out      = buf;
+      *out_len = wn;
+      buf      = NULL;
+   }
+
+end:
+   if (stream)
+      backend->stream_free(stream);
+   free(buf);
+   return out;
+}
+
+static bool bsv2_inflate(const uint8_t *data, size_t len,
+      uint8_t *out, size_t out_len)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_inflate_backend();
+   void *stream    = backend->stream_new();
+   bool ret        = false;
+
+   if (!stream)
+      return false;
+
+   backend->set_in(stream, data, (uint32_t)len);
+   backend->set_out(stream, out, (uint32_t)out_len);
+
+   ret = backend->trans(stream, true, &rd, &wn, &err) && wn == out_len;
+
+   backend->stream_free(stream);
+   return ret;
+}
+#endif
+
+static bool bsv2_serialize_keyframe(bsv_movie_t *handle)
+{
+   retro_ctx_size_info_t info;
+   retro_ctx_serialize_info_t serial_info;
+
+   handle->block_keyframe = false;
+
+   core_serialize_size(&info);
+   if (!info.size)
+      return true;
+
+   if (info.size != handle->keyframe_size)
+   {
+      uint8_t *buf = (uint8_t*)realloc(handle->keyframe, info.size);
+      if (!buf)
+         return false;
+      handle->keyframe      = buf;
+      handle->keyframe_size = info.size;
+   }
+
+   serial_info.data = handle->keyframe;
+   serial_info.size = handle->keyframe_size;
+
+   handle->block_keyframe = core_serialize(&serial_info);
+   return handle->block_keyframe;
+}
+
+static void bsv2_apply_keyframe(bsv_movie_t *handle)
+{
+   retro_ctx_size_info_t info;
+   retro_ctx_serialize_info_t serial_info;
+
+   if (!handle->block_keyframe)
+      return;
+
+   core_serialize_size(&info);
+
+   if (info.size != handle->keyframe_size)
+   {
+      RARCH_WARN("%s\n",
+            msg_hash_to_str(MSG_MOVIE_FORMAT_DIFFERENT_SERIALIZER_VERSION));
+      return;
+   }
+
+   serial_info.data_const = handle->keyframe;
+   serial_info.size       = handle->keyframe_size;
+   core_unserialize(&serial_info);
+}
+
+static bool bsv2_push_block(bsv_movie_t *handle,
+      uint64_t offset, uint32_t first_frame,
+      uint32_t num_frames, uint32_t flags)
+{
+   struct bsv_block *block;
+
+   if (handle->num_blocks >= handle->blocks_size)
+   {
+      size_t new_size = handle->blocks_size ? handle->blocks_size * 2 : 64;
+      struct bsv_block *blocks = (struct bsv_block*)realloc(
+            handle->blocks, new_size * sizeof(*blocks));
+      if (!blocks)
+         return false;
+      handle->blocks      = blocks;
+      handle->blocks_size = new_size;
+   }
+
+   block              = &handle->blocks[handle->num_blocks++];
+   block->offset      = offset;
+   block->first_frame = first_frame;
+   block->num_frames  = num_frames;
+   block->flags       = flags;
+   return true;
+}
+
+/* Returns the block holding 'frame'. Frames past
+ * the end of the movie map to the last block. */
+static size_t bsv2_find_block(const bsv_movie_t *handle, uint32_t frame)
+{
+   size_t lo = 0;
+   size_t hi = handle->num_blocks;
+
+   while (hi - lo > 1)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (handle->blocks[mid].first_frame <= frame)
+         lo = mid;
+      else
+         hi = mid;
+   }
+
+   return lo;
+}
+
+/* Encodes the current block and writes it at the
+ * end of the recorded data */
+static bool bsv2_write_block(bsv_movie_t *handle)
+{
+   uint32_t crc;
+   uint8_t header[BSV2_BLOCK_HEADER_SIZE];
+   uint32_t flags            = handle->block_keyframe ? BSV2_FLAG_KEYFRAME : 0;
+   size_t state_size         = handle->block_keyframe ? handle->keyframe_size : 0;
+   size_t state_stored       = state_size;
+   size_t input_size         = 0;
+   size_t input_stored       = 0;
+   const uint8_t *state_data = handle->keyframe;
+   const uint8_t *input_data = NULL;
+   uint8_t *state_packed     = NULL;
+   uint8_t *input_packed     = NULL;
+   uint8_t *input            = (uint8_t*)malloc(
+         (size_t)handle->block_frames * 5 + handle->num_values * 3 + 1);
+   bool ret                  = false;
+
+   if (!input)
+      return false;
+
+   input_size   = bsv2_encode_input(handle, input);
+   input_data   = input;
+   input_stored = input_size;
+
+#ifdef HAVE_ZLIB
+   if (state_size && (state_packed = bsv2_deflate(
+               state_data, state_size, &state_stored)))
+   {
+      state_data  = state_packed;
+      flags      |= BSV2_FLAG_STATE_DEFLATE;
+   }
+   else
+      state_stored = state_size;
+
+   if (input_size && (input_packed = bsv2_deflate(
+               input, input_size, &input_stored)))
+   {
+      input_data  = input_packed;
+      flags      |= BSV2_FLAG_INPUT_DEFLATE;
+   }
+   else
+      input_stored = input_size;
+#endif
+
+   crc = encoding_crc32(0, state_data, state_stored);
+   crc = encoding_crc32(crc, input_data, input_stored);
+
+   retro_set_unaligned_32le(header +  0, BSV2_BLOCK_MAGIC);
+   retro_set_unaligned_32le(header +  4, handle->block_first);
+   retro_set_unaligned_32le(header +  8, handle->block_frames);
+   retro_set_unaligned_32le(header + 12, flags);
+   retro_set_unaligned_32le(header + 16, (uint32_t)state_size);
+   retro_set_unaligned_32le(header + 20, (uint32_t)state_stored);
+   retro_set_unaligned_32le(header + 24, (uint32_t)input_size);
+   retro_set_unaligned_32le(header + 28, (uint32_t)input_stored);
+   retro_set_unaligned_32le(header + 32, crc);
+
+   if (     intfstream_seek(handle->file,
+               (int64_t)handle->write_pos, SEEK_SET) < 0
+         || intfstream_write(handle->file, header,
+               sizeof(header)) != sizeof(header)
+         || intfstream_write(handle->file, state_data,
+               state_stored) != (int64_t)state_stored
+         || intfstream_write(handle->file, input_data,
+               input_stored) != (int64_t)input_stored)
+      goto end;
+
+   if (!bsv2_push_block(handle, handle->write_pos,
+            handle->block_first, handle->block_frames, flags))
+      goto end;
+
+   handle->write_pos += sizeof(header) + state_stored + input_stored;
+   ret                = true;
+
+end:
+   free(input);
+   free(input_packed);
+   free(state_packed);
+   return ret;
+}
+
+/* Reads the block at 'offset' into the current block.
+ * 'first_frame' is the frame the block must start at. */
+static bool bsv2_read_block(bsv_movie_t *handle,
+      uint64_t offset, uint32_t first_frame,
+      struct bsv_block *out, uint64_t *next)
+{
+   uint8_t header[BSV2_BLOCK_HEADER_SIZE];
+   uint64_t end;
+   uint32_t flags, num_frames, state_size, state_stored;
+   uint32_t input_size, input_stored;
+   const uint8_t *input = NULL;
+   uint8_t *payload     = NULL;
+   uint8_t *unpacked    = NULL;
+   bool ret             = false;
+
+   if (     intfstream_seek(handle->file, (int64_t)offset, SEEK_SET) < 0
+         || intfstream_read(handle->file, header,
+            sizeof(header)) != sizeof(header))
+      return false;
+
+   num_frames   = retro_get_unaligned_32le(header +  8);
+   flags        = retro_get_unaligned_32le(header + 12);
+   state_size   = retro_get_unaligned_32le(header + 16);
+   state_stored = retro_get_unaligned_32le(header + 20);
+   input_size   = retro_get_unaligned_32le(header + 24);
+   input_stored = retro_get_unaligned_32le(header + 28);
+
+   /* While recording, only what was written before
+    * the current block is valid */
+   end          = handle->playback
+      ? (uint64_t)intfstream_get_size(handle->file) : handle->write_pos;
+
+   if (     retro_get_unaligned_32le(header) != BSV2_BLOCK_MAGIC
+         || retro_get_unaligned_32le(header + 4) != first_frame
+         || !num_frames
+         || offset + sizeof(header) + state_stored + input_stored > end)
+      return false;
+
+   if (!(payload = (uint8_t*)malloc((size_t)state_stored + input_stored + 1)))
+      return false;
+
+   if (     intfstream_read(handle->file, payload,
+            (uint64_t)state_stored + input_stored)
+         != (int64_t)state_stored + input_stored
+         || encoding_crc32(0, payload, (size_t)state_stored + input_stored)
+         != retro_get_unaligned_32le(header + 32))
+      goto end;
+
+#ifndef HAVE_ZLIB
+   if (flags & (BSV2_FLAG_STATE_DEFLATE | BSV2_FLAG_INPUT_DEFLATE))
+      goto end;
+#endif
+
+   handle->block_keyframe = false;
+
+   if ((flags & BSV2_FLAG_KEYFRAME) && state_size)
+   {
+      if (state_size != handle->keyframe_size)
+      {
+         uint8_t *buf = (uint8_t*)realloc(handle->keyframe, state_size);
+         if (!buf)
+            goto end;
+         handle->keyframe      = buf;
+         handle->keyframe_size = state_size;
+      }
+
+#ifdef HAVE_ZLIB
+      if (flags & BSV2_FLAG_STATE_DEFLATE)
+      {
+         if (!bsv2_inflate(payload, state_stored,
+                  handle->keyframe, state_size))
+            goto end;
+      }
+      else
+#endif
+      {
+         if (state_stored != state_size)
+            goto end;
+         memcpy(handle->keyframe, payload, state_size);
+      }
+
+      handle->block_keyframe = true;
+   }
+
+   input = payload + state_stored;
+
+#ifdef HAVE_ZLIB
+   if (flags & BSV2_FLAG_INPUT_DEFLATE)
+   {
+      if (     !(unpacked = (uint8_t*)malloc(input_size + 1))
+            || !bsv2_inflate(input, input_stored, unpacked, input_size))
+         goto end;
+      input = unpacked;
+   }
+   else
+#endif
+   {
+      if (input_stored != input_size)
+         goto end;
+   }
+
+   if (!bsv2_decode_input(handle, input, input_size, num_frames))
+      goto end;
+
+   handle->block_first  = first_frame;
+   handle->block_frames = num_frames;
+
+   if (out)
+   {
+      out->offset      = offset;
+      out->first_frame = first_frame;
+      out->num_frames  = num_frames;
+      out->flags       = flags;
+   }
+   if (next)
+      *next = offset + sizeof(header) + state_stored + input_stored;
+
+   ret = true;
+
+end:
+   free(unpacked);
+   free(payload);
+   return ret;
+}
+
+static bool bsv2_load_block(bsv_movie_t *handle, size_t index)
+{
+   const struct bsv_block *block = &handle->blocks[index];
+
+   if (!bsv2_read_block(handle, block->offset,
+            block->first_frame, NULL, NULL))
+      return false;
+
+   handle->block_index = index;
+   return true;
+}
+
+static bool bsv2_read_index(bsv_movie_t *handle, uint64_t offset)
+{
+   uint8_t info[8];
+   uint32_t i, count;
+   uint8_t *entries = NULL;
+   uint32_t frame   = 0;
+
+   if (     intfstream_seek(handle->file, (int64_t)offset, SEEK_SET) < 0
+         || intfstream_read(handle->file, info, sizeof(info)) != sizeof(info)
+         || retro_get_unaligned_32le(info) != BSV2_INDEX_MAGIC)
+      return false;
+
+   count = retro_get_unaligned_32le(info + 4);
+
+   if (     !count
+         || (uint64_t)count * BSV2_INDEX_ENTRY_SIZE
+            > (uint64_t)intfstream_get_size(handle->file)
+         || !(entries = (uint8_t*)malloc(
+               (size_t)count * BSV2_INDEX_ENTRY_SIZE)))
+      return false;
+
+   if (intfstream_read(handle->file, entries,
+            (uint64_t)count * BSV2_INDEX_ENTRY_SIZE)
+         != (int64_t)count * BSV2_INDEX_ENTRY_SIZE)
+      goto error;
+
+   for (i = 0; i < count; i++)
+   {
+      uint8_t *entry       = entries + (size_t)i * BSV2_INDEX_ENTRY_SIZE;
+      uint32_t first_frame = retro_get_unaligned_32le(entry);
+      uint32_t num_frames  = retro_get_unaligned_32le(entry + 4);
+
+      if (first_frame != frame || !num_frames
+            || !bsv2_push_block(handle,
+               retro_get_unaligned_64le(entry + 12),
+               first_frame, num_frames,
+               retro_get_unaligned_32le(entry + 8)))
+         goto error;
+
+      frame += num_frames;
+   }
+
+   free(entries);
+   return true;
+
+error:
+   free(entries);
+   handle->num_blocks = 0;
+   return false;
+}
+
+/* Recreates the index of a movie that was not closed
+ * properly, keeping every block up to the first one
+ * that is missing or damaged. */
+static void bsv2_scan_blocks(bsv_movie_t *handle)
+{
+   struct bsv_block block;
+   uint64_t offset = BSV2_HEADER_SIZE;
+   uint32_t frame  = 0;
+
+   handle->num_blocks = 0;
+
+   while (bsv2_read_block(handle, offset, frame, &block, &offset))
+   {
+      if (!bsv2_push_block(handle, block.offset,
+               block.first_frame, block.num_frames, block.flags))
+         break;
+      frame += block.num_frames;
+   }
+
+   handle->block_index = handle->num_blocks;
+}
+
+/* Moves playback to the start of 'frame' */
+static void bsv2_seek_frame(bsv_movie_t *handle, uint32_t frame)
+{
+   handle->frame = frame;
+
+   if (frame >= handle->total_frames)
+      return;
+
+   if (     frame <  handle->block_first
+         || frame >= handle->block_first + handle->block_frames
+         || handle->block_index >= handle->num_blocks)
+   {
+      size_t index = bsv2_find_block(handle, frame);
+
+      if (!bsv2_load_block(handle, index))
+      {
+         /* Treat a damaged block as the end of the movie */
+         handle->total_frames = frame;
+         handle->block_index  = handle->num_blocks;
+         return;
+      }
+   }
+
+   handle->value_ptr = handle->frame_offsets[frame - handle->block_first];
+}
+
+/* Drops the recorded input from 'frame' on */
+static void bsv2_truncate(bsv_movie_t *handle, uint32_t frame)
+{
+   if (frame < handle->block_first)
+   {
+      size_t index = bsv2_find_block(handle, frame);
+
+      /* Keep what's left of the current block */
+      if (!bsv2_load_block(handle, index))
+      {
+         handle->frame_offsets[0] = 0;
+         frame                    = handle->block_first;
+      }
+      else
+      {
+         handle->write_pos  = handle->blocks[index].offset;
+         handle->num_blocks = index;
+      }
+   }
+
+   handle->frame        = frame;
+   handle->block_frames = frame - handle->block_first;
+   handle->num_values   = handle->frame_offsets[handle->block_frames];
+
+   /* At the beginning, the recording simply
+    * restarts from the current state. */
+   if (frame == 0)
+      bsv2_serialize_keyframe(handle);
+}
+
+static bool bsv2_begin_block(bsv_movie_t *handle)
+{
+   handle->block_first      = handle->frame;
+   handle->block_frames     = 0;
+   handle->num_values       = 0;
+   handle->frame_offsets[0] = 0;
+   handle->block_keyframe   = false;
+
+   if (handle->frame % BSV2_KEYFRAME_INTERVAL == 0)
+      return bsv2_serialize_keyframe(handle);
+   return true;
+}
+
+static void bsv2_finish_record(bsv_movie_t *handle)
+{
+   size_t i;
+   uint8_t info[8];
+   uint64_t index_offset;
+
+   if (handle->block_frames || !handle->num_blocks)
+      if (!bsv2_write_block(handle))
+         goto error;
+
+   index_offset = handle->write_pos;
+
+   retro_set_unaligned_32le(info,     BSV2_INDEX_MAGIC);
+   retro_set_unaligned_32le(info + 4, (uint32_t)handle->num_blocks);
+
+   if (     intfstream_seek(handle->file,
+               (int64_t)index_offset, SEEK_SET) < 0
+         || intfstream_write(handle->file, info, sizeof(info)) != sizeof(info))
+      goto error;
+
+   for (i = 0; i < handle->num_blocks; i++)
+   {
+      uint8_t entry[BSV2_INDEX_ENTRY_SIZE];
+      const struct bsv_block *block = &handle->blocks[i];
+
+      retro_set_unaligned_32le(entry,      block->first_frame);
+      retro_set_unaligned_32le(entry +  4, block->num_frames);
+      retro_set_unaligned_32le(entry +  8, block->flags);
+      retro_set_unaligned_64le(entry + 12, block->offset);
+
+      if (intfstream_write(handle->file, entry, sizeof(entry))
+            != sizeof(entry))
+         goto error;
+   }
+
+   /* The index offset goes last, anything left
+    * behind by a rewind past it is ignored */
+   retro_set_unaligned_64le(info, index_offset);
+   if (     intfstream_seek(handle->file, 24, SEEK_SET) < 0
+         || intfstream_write(handle->file, info, sizeof(info)) != sizeof(info))
+      goto error;
+
+   return;
+
+error:
+   RARCH_ERR("Could not write BSV movie index.\n");
+}
+
+static bool bsv_movie_init_playback_compact(
+      bsv_movie_t *handle, const uint32_t *header)
+{
+   uint8_t ext[16];
+   uint32_t content_crc = content_get_crc();
+
+   if (intfstream_read(handle->file, ext, sizeof(ext)) != sizeof(ext))
+   {
+      RARCH_ERR("%s\n", msg_hash_to_str(MSG_COULD_NOT_READ_STATE_FROM_MOVIE));
+      return false;
+   }
+
+   handle->compact = true;
+
+   if (content_crc != 0)
+      if (swap_if_big32(header[CRC_INDEX]) != content_crc)
+         RARCH_WARN("%s.\n", msg_hash_to_str(MSG_CRC32_CHECKSUM_MISMATCH));
+
+   if (!bsv2_read_index(handle, retro_get_unaligned_64le(ext + 8)))
+   {
+      RARCH_WARN("BSV movie has no valid index, scanning blocks.\n");
+      bsv2_scan_blocks(handle);
+   }
+
+   if (!handle->num_blocks || !bsv2_load_block(handle, 0))
+   {
+      RARCH_ERR("%s\n", msg_hash_to_str(MSG_COULD_NOT_READ_STATE_FROM_MOVIE));
+      return false;
+   }
+
+   handle->total_frames =
+        handle->blocks[handle->num_blocks - 1].first_frame
+      + handle->blocks[handle->num_blocks - 1].num_frames;
+
+   bsv2_apply_keyframe(handle);
+   bsv2_seek_frame(handle, 0);
+
+   return true;
+}
+
 static bool bsv_movie_init_playback(
       bsv_movie_t *handle, const char *path)
 {
@@ -20539,6 +22911,10 @@ static bool bsv_movie_init_playback(
    handle->playback          = true;
 
    intfstream_read(handle->file, header, sizeof(uint32_t) * 4);
+
+   if (swap_if_little32(header[MAGIC_INDEX]) == BSV2_MAGIC)
+      return bsv_movie_init_playback_compact(handle, header);
+
    /* Compatibility with old implementation that
     * used incorrect documentation. */
    if (swap_if_little32(header[MAGIC_INDEX]) != BSV_MAGIC
@@ -20599,15 +22975,15 @@ static bool bsv_movie_init_playback(
    return true;
 }
 
+/* Movies are always recorded in the compact format,
+ * BSV1 files can only be played back. */
 static bool bsv_movie_init_record(
       bsv_movie_t *handle, const char *path)
 {
-   retro_ctx_size_info_t info;
-   uint32_t state_size       = 0;
-   uint32_t content_crc      = 0;
-   uint32_t header[4]        = {0};
+   uint32_t header[BSV2_HEADER_SIZE / sizeof(uint32_t)] = {0};
+   /* Rewinding may read back blocks already written */
    intfstream_t *file        = intfstream_open_file(path,
-         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
    if (!file)
@@ -20617,45 +22993,86 @@ static bool bsv_movie_init_record(
    }
 
    handle->file             = file;
-
-   content_crc              = content_get_crc();
+   handle->compact          = true;
 
    /* This value is supposed to show up as
-    * BSV1 in a HEX editor, big-endian. */
-   header[MAGIC_INDEX]      = swap_if_little32(BSV_MAGIC);
-   header[CRC_INDEX]        = swap_if_big32(content_crc);
+    * BSV2 in a HEX editor, big-endian. */
+   header[MAGIC_INDEX]      = swap_if_little32(BSV2_MAGIC);
+   header[SERIALIZER_INDEX] = swap_if_big32(1);
+   header[CRC_INDEX]        = swap_if_big32(content_get_crc());
+   header[3]                = swap_if_big32(BSV2_BLOCK_FRAMES);
+   header[4]                = swap_if_big32(BSV2_KEYFRAME_INTERVAL);
+   /* header[6..7]: index offset, written when the movie is closed */
+
+   if (intfstream_write(handle->file, header, sizeof(header))
+         != sizeof(header))
+      return false;
 
-   core_serialize_size(&info);
+   handle->write_pos        = sizeof(header);
 
-   state_size               = (unsigned)info.size;
+   return bsv2_reserve_frames(handle, BSV2_BLOCK_FRAMES)
+      && bsv2_begin_block(handle);
+}
 
-   header[STATE_SIZE_INDEX] = swap_if_big32(state_size);
+static bool bsv_movie_read(bsv_movie_t *handle, int16_t *value)
+{
+   int16_t bsv_result;
 
-   intfstream_write(handle->file, header, 4 * sizeof(uint32_t));
+   if (handle->compact)
+   {
+      if (handle->frame >= handle->total_frames)
+         return false;
 
-   handle->min_file_pos     = sizeof(header) + state_size;
-   handle->state_size       = state_size;
+      /* Polls the core didn't do while recording read as 0 */
+      if (handle->value_ptr < handle->frame_offsets[
+            handle->frame - handle->block_first + 1])
+         *value = handle->values[handle->value_ptr++];
+      else
+         *value = 0;
+      return true;
+   }
 
-   if (state_size)
-   {
-      retro_ctx_serialize_info_t serial_info;
-      uint8_t *st      = (uint8_t*)malloc(state_size);
+   if (intfstream_read(handle->file, &bsv_result, 2) != 2)
+      return false;
 
-      if (!st)
-         return false;
+   *value = swap_if_big16(bsv_result);
+   return true;
+}
 
-      handle->state    = st;
+static void bsv_movie_write(bsv_movie_t *handle, int16_t value)
+{
+   if (!bsv2_reserve_values(handle, handle->num_values + 1))
+      return;
+   handle->values[handle->num_values++] = value;
+}
 
-      serial_info.data = handle->state;
-      serial_info.size = state_size;
+static void bsv_movie_frame_end(bsv_movie_t *handle)
+{
+   handle->first_rewind = !handle->did_rewind;
+   handle->did_rewind   = false;
 
-      core_serialize(&serial_info);
+   if (!handle->compact)
+   {
+      handle->frame_ptr = (handle->frame_ptr + 1) & handle->frame_mask;
+      return;
+   }
 
-      intfstream_write(handle->file,
-            handle->state, state_size);
+   if (handle->playback)
+   {
+      bsv2_seek_frame(handle, handle->frame + 1);
+      return;
    }
 
-   return true;
+   handle->frame_offsets[++handle->block_frames] =
+      (uint32_t)handle->num_values;
+   handle->frame++;
+
+   if (handle->block_frames < BSV2_BLOCK_FRAMES)
+      return;
+
+   if (!bsv2_write_block(handle))
+      RARCH_ERR("Could not write BSV movie data.\n");
+   bsv2_begin_block(handle);
 }
 
 static void bsv_movie_free(bsv_movie_t *handle)
@@ -20663,11 +23080,18 @@ static void bsv_movie_free(bsv_movie_t *handle)
    if (!handle)
       return;
 
+   if (handle->compact && !handle->playback && handle->frame_offsets)
+      bsv2_finish_record(handle);
+
    intfstream_close(handle->file);
    free(handle->file);
 
    free(handle->state);
    free(handle->frame_pos);
+   free(handle->blocks);
+   free(handle->values);
+   free(handle->frame_offsets);
+   free(handle->keyframe);
    free(handle);
 }
 
@@ -20688,6 +23112,10 @@ static bsv_movie_t *bsv_movie_init_internal(const char *path,
    else if (!bsv_movie_init_record(handle, path))
       goto error;
 
+   /* Compact movies locate frames through their blocks */
+   if (handle->compact)
+      return handle;
+
    /* Just pick something really large
     * ~1 million frames rewind should do the trick. */
    if (!(frame_pos = (size_t*)calloc((1 << 20), sizeof(size_t))))
@@ -20715,6 +23143,20 @@ void bsv_movie_frame_rewind(void)
 
    handle->did_rewind = true;
 
+   if (handle->compact)
+   {
+      /* See below, the frame that was just rewound
+       * to has already been played once */
+      uint32_t back  = handle->first_rewind ? 1 : 2;
+      uint32_t frame = (handle->frame > back) ? handle->frame - back : 0;
+
+      if (handle->playback)
+         bsv2_seek_frame(handle, frame);
+      else
+         bsv2_truncate(handle, frame);
+      return;
+   }
+
    if (     (handle->frame_ptr <= 1)
          && (handle->frame_pos[0] == handle->min_file_pos))
    {
@@ -20736,30 +23178,93 @@ void bsv_movie_frame_rewind(void)
             (int)handle->frame_pos[handle->frame_ptr], SEEK_SET);
    }
 
+   /* We rewound past the beginning. */
    if (intfstream_tell(handle->file) <= (long)handle->min_file_pos)
+      intfstream_seek(handle->file, (int)handle->min_file_pos, SEEK_SET);
+}
+
+/* Runs the frames up to the seek target with audio and
+ * video suspended, for at most BSV_SEEK_SLICE_USEC per
+ * call so the frontend stays responsive. The frame at the
+ * target itself is left to the regular runloop. */
+static void bsv_movie_seek_run(struct rarch_state *p_rarch)
+{
+   retro_time_t deadline;
+   bsv_movie_t *handle       = p_rarch->bsv_movie_state_handle;
+   bool video_driver_active  = p_rarch->video_driver_active;
+
+   if (!handle->seeking)
+      return;
+
+   deadline                     = cpu_features_get_time_usec()
+      + BSV_SEEK_SLICE_USEC;
+   p_rarch->audio_suspended     = true;
+   p_rarch->video_driver_active = false;
+
+   while (     handle->frame < handle->seek_target
+         &&    cpu_features_get_time_usec() < deadline)
    {
-      /* We rewound past the beginning. */
+      core_run();
+      bsv_movie_frame_end(handle);
+   }
 
-      if (!handle->playback)
-      {
-         retro_ctx_serialize_info_t serial_info;
+   p_rarch->video_driver_active = video_driver_active;
+   p_rarch->audio_suspended     = false;
 
-         /* If recording, we simply reset
-          * the starting point. Nice and easy. */
+   if (handle->frame >= handle->seek_target)
+      handle->seeking           = false;
+}
 
-         intfstream_seek(handle->file, 4 * sizeof(uint32_t), SEEK_SET);
+#ifdef HAVE_COMMAND
+/* Seeks playback of a compact movie to 'frame': the
+ * nearest keyframe at or before it is loaded, unless
+ * playback is already between that keyframe and 'frame',
+ * and the remaining frames are run headless by
+ * bsv_movie_seek_run(). Returns the target frame, or -1
+ * if the movie can't seek. */
+static int64_t bsv_movie_seek(struct rarch_state *p_rarch, uint32_t frame)
+{
+   size_t index;
+   bsv_movie_t *handle = p_rarch->bsv_movie_state_handle;
+
+   if (!handle || !handle->compact || !handle->playback
+         || !handle->total_frames)
+      return -1;
 
-         serial_info.data = handle->state;
-         serial_info.size = handle->state_size;
+   /* Stop on the last frame, so playback doesn't end */
+   if (frame >= handle->total_frames)
+      frame = handle->total_frames - 1;
 
-         core_serialize(&serial_info);
+   index = bsv2_find_block(handle, frame);
+   while (index > 0 && !(handle->blocks[index].flags & BSV2_FLAG_KEYFRAME))
+      index--;
 
-         intfstream_write(handle->file, handle->state, handle->state_size);
-      }
-      else
-         intfstream_seek(handle->file, (int)handle->min_file_pos, SEEK_SET);
+   if (!(handle->blocks[index].flags & BSV2_FLAG_KEYFRAME))
+      return -1;
+
+   if (     handle->frame <  handle->blocks[index].first_frame
+         || handle->frame >  frame)
+   {
+      if (!bsv2_load_block(handle, index))
+         return -1;
+
+      bsv2_apply_keyframe(handle);
+      bsv2_seek_frame(handle, handle->block_first);
+
+      /* The rewind history no longer leads up to this frame */
+      command_event(CMD_EVENT_REWIND_DEINIT, NULL);
+      command_event(CMD_EVENT_REWIND_INIT, NULL);
    }
+
+   handle->first_rewind                 = true;
+   handle->did_rewind                   = false;
+   handle->seek_target                  = frame;
+   handle->seeking                      = handle->frame < frame;
+   p_rarch->bsv_movie_state.movie_end   = false;
+
+   return frame;
 }
+#endif
 
 static bool bsv_movie_init_handle(
       struct rarch_state *p_rarch,
@@ -21223,6 +23728,8 @@ static void input_overlay_scale(struct overlay *ol,
       desc->mod_x   = adj_center_x - scale_w;
       desc->mod_y   = adj_center_y - scale_h;
    }
+
+   input_overlay_build_hit_grid(ol);
 }
 
 static void input_overlay_set_vertex_geom(input_overlay_t *ol)
@@ -21297,6 +23804,13 @@ void input_overlay_free_overlay(struct overlay *overlay)
    if (overlay->descs)
       free(overlay->descs);
    overlay->descs       = NULL;
+   free(overlay->hit_grid_cells);
+   free(overlay->hit_grid_descs);
+   overlay->hit_grid_cells = NULL;
+   overlay->hit_grid_descs = NULL;
+   free(overlay->atlas_rects);
+   overlay->atlas_rects    = NULL;
+   image_texture_free(&overlay->atlas);
    image_texture_free(&overlay->image);
 }
 
@@ -21367,9 +23881,16 @@ static void input_overlay_load_active(
       struct rarch_state *p_rarch,
       input_overlay_t *ol, float opacity)
 {
-   if (ol->iface->load)
-      ol->iface->load(ol->iface_data, ol->active->load_images,
-            ol->active->load_images_size);
+   /* Prefer uploading the images as one atlas texture */
+   if (  !ol->active->atlas.pixels
+       || !ol->iface->load_atlas
+       || !ol->iface->load_atlas(ol->iface_data, &ol->active->atlas,
+            ol->active->atlas_rects, ol->active->load_images_size))
+   {
+      if (ol->iface->load)
+         ol->iface->load(ol->iface_data, ol->active->load_images,
+               ol->active->load_images_size);
+   }
 
    input_overlay_set_alpha_mod(p_rarch, ol, opacity);
    input_overlay_set_vertex_geom(ol);
@@ -21502,6 +24023,8 @@ static void input_overlay_poll(
       int16_t norm_x, int16_t norm_y, float touch_scale)
 {
    size_t i;
+   size_t count;
+   const unsigned *candidates = NULL;
 
    /* norm_x and norm_y is in [-0x7fff, 0x7fff] range,
     * like RETRO_DEVICE_POINTER. */
@@ -21516,11 +24039,18 @@ static void input_overlay_poll(
    x *= touch_scale;
    y *= touch_scale;
 
-   for (i = 0; i < ol->active->size; i++)
+   /* Only the descriptors whose hitbox overlaps the grid
+    * cell of the touch can be hit */
+   if (!(candidates = input_overlay_hit_grid_candidates(
+               ol->active, x, y, &count)))
+      count = ol->active->size;
+
+   for (i = 0; i < count; i++)
    {
       float x_dist, y_dist;
       unsigned int base         = 0;
-      struct overlay_desc *desc = &ol->active->descs[i];
+      struct overlay_desc *desc = &ol->active->descs[
+         candidates ? candidates[i] : i];
 
       if (!inside_hitbox(desc, x, y))
          continue;
@@ -21672,23 +24202,149 @@ static void input_overlay_poll_clear(
 }
 
 
+static void input_overlay_cache_free_entry(overlay_cache_entry_t *entry)
+{
+   size_t i;
+
+   for (i = 0; i < entry->size; i++)
+      input_overlay_free_overlay(&entry->overlays[i]);
+
+   free(entry->overlays);
+   free(entry->path);
+   memset(entry, 0, sizeof(*entry));
+}
+
+/**
+ * input_overlay_cache_put:
+ * @path                  : Path of the overlay config, owned by the cache.
+ * @overlays              : Decoded overlays of the config, owned by the cache.
+ * @size                  : Number of overlays.
+ *
+ * Keeps unloaded overlays in memory, so that loading the
+ * same config again is instant. Any older copy of the
+ * config is replaced; when the cache is full, the least
+ * recently unloaded config is freed.
+ **/
+static void input_overlay_cache_put(struct rarch_state *p_rarch,
+      char *path, struct overlay *overlays, size_t size)
+{
+   size_t i, j;
+   overlay_cache_entry_t *cache = p_rarch->overlay_cache;
+
+   /* Drop the state left behind by polling */
+   for (i = 0; i < size; i++)
+   {
+      for (j = 0; j < overlays[i].size; j++)
+      {
+         struct overlay_desc *desc = &overlays[i].descs[j];
+
+         desc->updated     = false;
+         desc->range_x_mod = desc->range_x;
+         desc->range_y_mod = desc->range_y;
+         desc->delta_x     = 0.0f;
+         desc->delta_y     = 0.0f;
+      }
+   }
+
+   for (i = 0; i < OVERLAY_CACHE_SIZE - 1; i++)
+      if (cache[i].path && string_is_equal(cache[i].path, path))
+         break;
+
+   input_overlay_cache_free_entry(&cache[i]);
+   memmove(&cache[1], &cache[0], i * sizeof(*cache));
+
+   cache[0].overlays = overlays;
+   cache[0].path     = path;
+   cache[0].mtime    = path_get_mtime(path);
+   cache[0].size     = size;
+}
+
+/**
+ * input_overlay_cache_take:
+ * @path                  : Path of the overlay config.
+ * @entry                 : Cached overlays of the config.
+ *
+ * Removes the overlays of @path from the cache, unless
+ * the config changed on disk since they were decoded.
+ *
+ * Returns: true if @entry was filled in.
+ **/
+static bool input_overlay_cache_take(struct rarch_state *p_rarch,
+      const char *path, overlay_cache_entry_t *entry)
+{
+   size_t i;
+   overlay_cache_entry_t *cache = p_rarch->overlay_cache;
+
+   for (i = 0; i < OVERLAY_CACHE_SIZE; i++)
+   {
+      if (!cache[i].path || !string_is_equal(cache[i].path, path))
+         continue;
+
+      if (cache[i].mtime != path_get_mtime(path))
+      {
+         input_overlay_cache_free_entry(&cache[i]);
+         return false;
+      }
+
+      *entry = cache[i];
+      memmove(&cache[i], &cache[i + 1],
+            (OVERLAY_CACHE_SIZE - 1 - i) * sizeof(*cache));
+      memset(&cache[OVERLAY_CACHE_SIZE - 1], 0, sizeof(*cache));
+      return true;
+   }
+
+   return false;
+}
+
+static void input_overlay_cache_free(struct rarch_state *p_rarch)
+{
+   size_t i;
+
+   for (i = 0; i < OVERLAY_CACHE_SIZE; i++)
+      input_overlay_cache_free_entry(&p_rarch->overlay_cache[i]);
+}
+
 /**
- * input_overlay_free:
+ * input_overlay_release:
  * @ol                    : Overlay handle.
  *
- * Frees overlay handle.
+ * Frees overlay handle, handing its overlays over to
+ * the cache. Leaves the video driver alone.
  **/
-static void input_overlay_free(input_overlay_t *ol)
+static void input_overlay_release(struct rarch_state *p_rarch,
+      input_overlay_t *ol)
 {
    if (!ol)
       return;
 
+   if (ol->path && ol->overlays)
+   {
+      input_overlay_cache_put(p_rarch, ol->path, ol->overlays, ol->size);
+      ol->path     = NULL;
+      ol->overlays = NULL;
+   }
+
    input_overlay_free_overlays(ol);
+   free(ol->path);
+   free(ol);
+}
+
+/**
+ * input_overlay_free:
+ * @ol                    : Overlay handle.
+ *
+ * Frees overlay handle and disables the overlay.
+ **/
+static void input_overlay_free(struct rarch_state *p_rarch,
+      input_overlay_t *ol)
+{
+   if (!ol)
+      return;
 
    if (ol->iface->enable)
       ol->iface->enable(ol->iface_data, false);
 
-   free(ol);
+   input_overlay_release(p_rarch, ol);
 }
 
 /* task_data = overlay_task_data_t* */
@@ -21704,8 +24360,14 @@ static void input_overlay_loaded(retro_task_t *task,
    bool input_overlay_show_mouse_cursor   = settings->bools.input_overlay_show_mouse_cursor;
    bool inp_overlay_auto_rotate           = settings->bools.input_overlay_auto_rotate;
    bool input_overlay_enable              = settings->bools.input_overlay_enable;
+
+   /* The previous overlay stays up while the next one
+    * loads, but not if the next one can't be loaded */
    if (err)
+   {
+      retroarch_overlay_deinit(p_rarch);
       return;
+   }
 
    if (data->overlay_enable)
    {
@@ -21733,6 +24395,7 @@ static void input_overlay_loaded(retro_task_t *task,
 
    ol             = (input_overlay_t*)calloc(1, sizeof(*ol));
    ol->overlays   = data->overlays;
+   ol->path       = data->overlay_path;
    ol->size       = data->size;
    ol->active     = data->active;
    ol->iface      = iface;
@@ -21752,14 +24415,9 @@ static void input_overlay_loaded(retro_task_t *task,
    ol->state      = OVERLAY_STATUS_NONE;
    ol->alive      = true;
 
-   /* Due to the asynchronous nature of overlay loading
-    * it is possible for overlay_ptr to be non-NULL here
-    * > Ensure it is free()'d before assigning new pointer */
-   if (p_rarch->overlay_ptr)
-   {
-      input_overlay_free_overlays(p_rarch->overlay_ptr);
-      free(p_rarch->overlay_ptr);
-   }
+   /* The previous overlay is kept active while the
+    * next one loads; it only goes now */
+   input_overlay_release(p_rarch, p_rarch->overlay_ptr);
    p_rarch->overlay_ptr = ol;
 
    free(data);
@@ -21776,10 +24434,19 @@ static void input_overlay_loaded(retro_task_t *task,
    return;
 
 abort_load:
-   for (i = 0; i < data->size; i++)
-      input_overlay_free_overlay(&data->overlays[i]);
+   retroarch_overlay_deinit(p_rarch);
 
-   free(data->overlays);
+   /* Nothing is shown for now, but the decoded
+    * overlays are kept for when they are wanted */
+   if (data->overlay_path)
+      input_overlay_cache_put(p_rarch, data->overlay_path,
+            data->overlays, data->size);
+   else
+   {
+      for (i = 0; i < data->size; i++)
+         input_overlay_free_overlay(&data->overlays[i]);
+      free(data->overlays);
+   }
    free(data);
 }
 
@@ -22009,7 +24676,7 @@ static void input_poll_overlay(
 
 static void retroarch_overlay_deinit(struct rarch_state *p_rarch)
 {
-   input_overlay_free(p_rarch->overlay_ptr);
+   input_overlay_free(p_rarch, p_rarch->overlay_ptr);
    p_rarch->overlay_ptr = NULL;
 }
 
@@ -22048,8 +24715,6 @@ static void retroarch_overlay_init(struct rarch_state *p_rarch)
       return;
 #endif
 
-   retroarch_overlay_deinit(p_rarch);
-
 #ifdef HAVE_MENU
    /* Cancel load if 'hide_in_menu' is enabled and
     * menu is currently active */
@@ -22062,8 +24727,17 @@ static void retroarch_overlay_init(struct rarch_state *p_rarch)
    if (overlay_hide_when_gamepad_connected)
       load_enabled = load_enabled && (input_config_get_device_name(0) == NULL);
 
+   /* Reloading the current overlay (e.g. to apply
+    * settings) takes it through the cache */
+   if (  !load_enabled
+       || (p_rarch->overlay_ptr
+          && p_rarch->overlay_ptr->path
+          && string_is_equal(p_rarch->overlay_ptr->path, path_overlay)))
+      retroarch_overlay_deinit(p_rarch);
+
    if (load_enabled)
    {
+      overlay_cache_entry_t cached;
       overlay_layout_desc_t layout_desc;
 
       layout_desc.scale_landscape         = overlay_scale_landscape;
@@ -22081,14 +24755,44 @@ static void retroarch_overlay_init(struct rarch_state *p_rarch)
       layout_desc.touch_scale             = overlay_touch_scale;
       layout_desc.auto_scale              = input_overlay_auto_scale;
 
-      task_push_overlay_load_default(input_overlay_loaded,
+      /* Overlays that were loaded before don't need
+       * to be decoded again */
+      if (input_overlay_cache_take(p_rarch, path_overlay, &cached))
+      {
+         overlay_task_data_t *data = (overlay_task_data_t*)
+            calloc(1, sizeof(*data));
+
+         if (data)
+         {
+            data->overlays                    = cached.overlays;
+            data->active                      = &cached.overlays[0];
+            data->overlay_path                = cached.path;
+            data->size                        = cached.size;
+            data->overlay_opacity             = overlay_opacity;
+            data->overlay_enable              = input_overlay_enable;
+            data->hide_in_menu                = overlay_hide_in_menu;
+            data->hide_when_gamepad_connected = overlay_hide_when_gamepad_connected;
+            data->layout_desc                 = layout_desc;
+
+            input_overlay_loaded(NULL, data, NULL, NULL);
+            return;
+         }
+
+         input_overlay_cache_put(p_rarch, cached.path,
+               cached.overlays, cached.size);
+      }
+
+      /* The current overlay stays active until the
+       * next one is decoded */
+      if (!task_push_overlay_load_default(input_overlay_loaded,
             path_overlay,
             overlay_hide_in_menu,
             overlay_hide_when_gamepad_connected,
             input_overlay_enable,
             overlay_opacity,
             &layout_desc,
-            NULL);
+            NULL))
+         retroarch_overlay_deinit(p_rarch);
    }
 }
 #endif
@@ -22327,7 +25031,54 @@ float input_sensor_get_input(unsigned port, unsigned id)
  *
  * Input polling callback function.
  **/
-static void input_driver_poll(void)
+/**
+ * input_driver_resolve_binds:
+ *
+ * Flattens the libretro binds of every user into
+ * p_rarch->input_driver_resolved_binds, see
+ * input_resolved_binds_t. Binds, auto-binds (including the
+ * temporary analog D-pad overrides) and remaps only change
+ * between frames, so doing this once per poll is enough.
+ **/
+static void input_driver_resolve_binds(
+      struct rarch_state *p_rarch,
+      settings_t *settings)
+{
+   unsigned i, j;
+
+   for (i = 0; i < MAX_USERS; i++)
+   {
+      input_resolved_binds_t *resolved  =
+         &p_rarch->input_driver_resolved_binds[i];
+      const struct retro_keybind *binds = p_rarch->libretro_input_binds[i];
+      const struct retro_keybind *auto_binds
+                                        = input_autoconf_binds[
+         settings->uints.input_joypad_map[i]];
+
+      resolved->remapped                = 0;
+
+      for (j = 0; j < RARCH_FIRST_CUSTOM_BIND; j++)
+      {
+         if (binds && binds[j].valid)
+         {
+            resolved->joykey[j]  = (binds[j].joykey != NO_BTN)
+               ? binds[j].joykey  : auto_binds[j].joykey;
+            resolved->joyaxis[j] = (binds[j].joyaxis != AXIS_NONE)
+               ? binds[j].joyaxis : auto_binds[j].joyaxis;
+
+            if (j != settings->uints.input_remap_ids[i][j])
+               resolved->remapped |= (1 << j);
+         }
+         else
+         {
+            resolved->joykey[j]  = NO_BTN;
+            resolved->joyaxis[j] = AXIS_NONE;
+         }
+      }
+   }
+}
+
+static void input_driver_poll_devices(void)
 {
    size_t i, j;
    rarch_joypad_info_t joypad_info[MAX_USERS];
@@ -22358,6 +25109,8 @@ static void input_driver_poll(void)
          && p_rarch->current_input->poll)
       p_rarch->current_input->poll(p_rarch->current_input_data);
 
+   input_driver_resolve_binds(p_rarch, settings);
+
    p_rarch->input_driver_turbo_btns.count++;
 
    if (p_rarch->input_driver_block_libretro_input)
@@ -22380,6 +25133,7 @@ static void input_driver_poll(void)
                sec_joypad,
                &joypad_info[i],
                p_rarch->libretro_input_binds,
+               NULL,
                p_rarch->keyboard_mapping_blocked,
                (unsigned)i,
                RETRO_DEVICE_JOYPAD,
@@ -22439,6 +25193,7 @@ static void input_driver_poll(void)
                         sec_joypad,
                         &joypad_info[i],
                         p_rarch->libretro_input_binds,
+                        NULL,
                         p_rarch->keyboard_mapping_blocked,
                         (unsigned)i, RETRO_DEVICE_JOYPAD,
                         0, RETRO_DEVICE_ID_JOYPAD_MASK);
@@ -22727,6 +25482,13 @@ static void input_driver_poll(void)
 #endif
 }
 
+static void input_driver_poll(void)
+{
+   PERF_SCOPE_BEGIN("input_poll");
+   input_driver_poll_devices();
+   PERF_SCOPE_END();
+}
+
 static int16_t input_state_device(
       struct rarch_state *p_rarch,
       settings_t *settings,
@@ -22752,14 +25514,17 @@ static int16_t input_state_device(
             else
 #endif
             {
-               bool bind_valid = p_rarch->libretro_input_binds[port]
-                  && p_rarch->libretro_input_binds[port][id].valid;
+               bool remapped;
 
-               if (!
-                     (      bind_valid
-                            && id != settings->uints.input_remap_ids[port][id]
-                     )
-                  )
+               if (id < RARCH_FIRST_CUSTOM_BIND)
+                  remapped = p_rarch->input_driver_resolved_binds[port].remapped
+                     & (1 << id);
+               else
+                  remapped = p_rarch->libretro_input_binds[port]
+                     && p_rarch->libretro_input_binds[port][id].valid
+                     && id != settings->uints.input_remap_ids[port][id];
+
+               if (!remapped)
                {
                   if (button_mask)
                   {
@@ -23054,6 +25819,18 @@ static int16_t input_state(unsigned port, unsigned device,
       *sec_joypad                 = NULL;
 #endif
 
+   /* Late polling: latch the input state at the core's first
+    * query of the frame rather than before retro_run(). This is
+    * checked here instead of through a separate state callback
+    * so that poll type changes from the menu or through
+    * RETRO_ENVIRONMENT_POLL_TYPE_OVERRIDE after the callbacks
+    * were set up still take effect on the next frame. */
+   if (!p_rarch->current_core.input_polled)
+   {
+      p_rarch->current_core.input_polled = true;
+      input_driver_poll();
+   }
+
    joypad_info.axis_threshold     = p_rarch->input_driver_axis_threshold;
    joypad_info.joy_idx            = settings->uints.input_joypad_map[port];
    joypad_info.auto_binds         = input_autoconf_binds[joypad_info.joy_idx];
@@ -23062,12 +25839,12 @@ static int16_t input_state(unsigned port, unsigned device,
    if (BSV_MOVIE_IS_PLAYBACK_ON())
    {
       int16_t bsv_result;
-      if (intfstream_read(p_rarch->bsv_movie_state_handle->file, &bsv_result, 2) == 2)
+      if (bsv_movie_read(p_rarch->bsv_movie_state_handle, &bsv_result))
       {
 #ifdef HAVE_CHEEVOS
          rcheevos_pause_hardcore();
 #endif
-         return swap_if_big16(bsv_result);
+         return bsv_result;
       }
 
       p_rarch->bsv_movie_state.movie_end = true;
@@ -23082,6 +25859,7 @@ static int16_t input_state(unsigned port, unsigned device,
          sec_joypad,
          &joypad_info,
          p_rarch->libretro_input_binds,
+         &p_rarch->input_driver_resolved_binds[port],
          p_rarch->keyboard_mapping_blocked,
          port, device, idx, id);
 
@@ -23166,10 +25944,7 @@ static int16_t input_state(unsigned port, unsigned device,
 
 #ifdef HAVE_BSV_MOVIE
    if (BSV_MOVIE_IS_PLAYBACK_OFF())
-   {
-      result = swap_if_big16(result);
-      intfstream_write(p_rarch->bsv_movie_state_handle->file, &result, 2);
-   }
+      bsv_movie_write(p_rarch->bsv_movie_state_handle, result);
 #endif
 
    return result;
@@ -24819,9 +27594,13 @@ static int menu_input_post_iterate(
    menu_list_t *menu_list        = menu_st->entries.list;
    file_list_t *selection_buf    = menu_list ? MENU_LIST_GET_SELECTION(menu_list, (unsigned)0) : NULL;
    size_t selection              = menu_st->selection_ptr;
-   menu_file_list_cbs_t *cbs     = selection_buf ?
-      (menu_file_list_cbs_t*)selection_buf->list[selection].actiondata
-      : NULL;
+   menu_file_list_cbs_t *cbs     = NULL;
+
+   if (selection_buf)
+   {
+      menu_displaylist_playlist_fill(selection_buf, selection, selection);
+      cbs = (menu_file_list_cbs_t*)selection_buf->list[selection].actiondata;
+   }
 
    MENU_ENTRY_INIT(entry);
    /* Note: If menu_input_pointer_post_iterate() is
@@ -24902,6 +27681,7 @@ static void input_keys_pressed(
                sec_joypad,
                joypad_info,
                &binds[port],
+               NULL,
                p_rarch->keyboard_mapping_blocked,
                port, RETRO_DEVICE_JOYPAD, 0,
                RARCH_ENABLE_HOTKEY))
@@ -24938,6 +27718,7 @@ static void input_keys_pressed(
                   sec_joypad,
                   joypad_info,
                   &binds[port],
+                  NULL,
                   p_rarch->keyboard_mapping_blocked,
                   port,
                   RETRO_DEVICE_JOYPAD, 0, RARCH_GAME_FOCUS_TOGGLE))
@@ -24956,6 +27737,7 @@ static void input_keys_pressed(
                p_rarch->joypad,
                sec_joypad,
                joypad_info, &binds[port],
+               NULL,
                p_rarch->keyboard_mapping_blocked,
                port, RETRO_DEVICE_JOYPAD, 0,
                RETRO_DEVICE_ID_JOYPAD_MASK);
@@ -24997,6 +27779,7 @@ static void input_keys_pressed(
                   sec_joypad,
                   joypad_info,
                   &binds[port],
+                  NULL,
                   p_rarch->keyboard_mapping_blocked,
                   port, RETRO_DEVICE_JOYPAD, 0, i);
          if (     bit_pressed
@@ -25132,11 +27915,13 @@ static void input_driver_init_command(struct rarch_state *p_rarch,
    }
 #endif
 
-   /* Initialize the network command interface */
+   /* Initialize the network command interface. Headless
+    * mode accepts jobs, so it is only reachable locally. */
 #ifdef HAVE_NETWORK_CMD
    if (input_network_cmd_enable)
    {
-      p_rarch->input_driver_command[1] = command_network_new(network_cmd_port);
+      p_rarch->input_driver_command[1] = command_network_new(
+            network_cmd_port, p_rarch->headless);
       if (!p_rarch->input_driver_command[1])
          RARCH_ERR("Failed to initialize the network command interface.\n");
    }
@@ -25582,6 +28367,38 @@ static bool input_mouse_button_raw(
 }
 #endif
 
+void input_driver_report_received(unsigned port, retro_time_t time)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   struct input_report_stats *stats;
+   retro_time_t interval;
+
+   if (port >= MAX_USERS)
+      return;
+
+   stats = &p_rarch->input_report_stats[port];
+
+   if (!time)
+      time     = cpu_features_get_time_usec();
+   interval    = time - stats->last;
+
+   if (!stats->last)
+   {
+      stats->last = time;
+      return;
+   }
+   stats->last    = time;
+
+   /* Reports with the same timestamp count as one,
+    * idle gaps are not report intervals. */
+   if (interval <= 0 || interval > INPUT_REPORT_IDLE_USEC)
+      return;
+
+   stats->intervals[stats->count & (INPUT_REPORT_SAMPLES_COUNT - 1)] =
+      (uint32_t)interval;
+   stats->count++;
+}
+
 void input_pad_connect(unsigned port, input_device_driver_t *driver)
 {
    struct rarch_state *p_rarch = &rarch_st;
@@ -26963,6 +29780,11 @@ void input_config_reset(void)
 
       p_rarch->libretro_input_binds[i] = input_config_binds[i];
    }
+
+   /* Nothing resolved until the first poll, all 0xFF bytes
+    * is NO_BTN and AXIS_NONE. */
+   memset(p_rarch->input_driver_resolved_binds, 0xFF,
+         sizeof(p_rarch->input_driver_resolved_binds));
 }
 
 void config_read_keybinds_conf(void *data)
@@ -27884,7 +30706,8 @@ static bool audio_compute_buffer_statistics(
          (unsigned)p_rarch->audio_driver_free_samples_count,
          AUDIO_BUFFER_FREE_SAMPLES_COUNT);
 
-   if (samples < 3)
+   /* The latency test keeps the history without rate control */
+   if (samples < 3 || !p_rarch->audio_driver_buffer_size)
       return false;
 
    stats->samples                = (unsigned)
@@ -28048,6 +30871,14 @@ static bool audio_driver_free_devices_list(struct rarch_state *p_rarch)
 static bool audio_driver_deinit(struct rarch_state *p_rarch,
       settings_t *settings)
 {
+#ifdef HAVE_THREADS
+   /* Everything below is shared with the processing thread */
+   audio_flush_thread_free(p_rarch->audio_flush_thread);
+   p_rarch->audio_flush_thread          = NULL;
+   if (p_rarch->audio_flush_thread_conv_buf)
+      memalign_free(p_rarch->audio_flush_thread_conv_buf);
+   p_rarch->audio_flush_thread_conv_buf = NULL;
+#endif
 #ifdef HAVE_AUDIOMIXER
    audio_driver_mixer_deinit(p_rarch);
 #endif
@@ -28248,6 +31079,7 @@ static bool audio_driver_init_internal(
    }
 
    p_rarch->audio_driver_data_ptr   = 0;
+   p_rarch->audio_driver_passthrough_pos = 0;
 
    retro_assert(settings->uints.audio_out_rate <
          p_rarch->audio_driver_input * AUDIO_MAX_RATIO);
@@ -28281,14 +31113,39 @@ static bool audio_driver_init_internal(
          RARCH_WARN("[Audio]: Rate control was desired, but driver does not support needed features.\n");
    }
 
+   p_rarch->audio_driver_control_pi            =
+      settings->bools.audio_rate_control_pi;
+   p_rarch->audio_driver_rate_control_target   =
+      MIN(MAX(settings->uints.audio_rate_control_target, 10), 90);
+   p_rarch->audio_driver_rate_control_integral = 0.0;
+
    command_event(CMD_EVENT_DSP_FILTER_INIT, NULL);
 
    p_rarch->audio_driver_free_samples_count = 0;
+   p_rarch->audio_latency_test.active       = false;
 
 #ifdef HAVE_AUDIOMIXER
    audio_mixer_init(settings->uints.audio_out_rate);
 #endif
 
+#ifdef HAVE_THREADS
+   if (     settings->bools.audio_threaded_processing
+         && p_rarch->audio_driver_active
+         && !audio_cb_inited)
+   {
+      p_rarch->audio_flush_thread_conv_buf = (int16_t*)
+         memalign_alloc(64, outsamples_max * sizeof(int16_t));
+
+      /* The rewind buffer is the largest chunk that gets flushed */
+      if (     p_rarch->audio_flush_thread_conv_buf
+            && (p_rarch->audio_flush_thread = audio_flush_thread_new(
+                  max_bufsamples, audio_driver_flush_thread_cb, p_rarch)))
+         RARCH_LOG("[Audio]: Processing audio on a separate thread.\n");
+      else
+         RARCH_WARN("[Audio]: Failed to start audio processing thread.\n");
+   }
+#endif
+
    /* Threaded driver is initially stopped. */
    if (
          p_rarch->audio_driver_active
@@ -28304,58 +31161,276 @@ error:
 }
 
 /**
- * audio_driver_flush:
- * @data                 : pointer to audio buffer.
- * @right                : amount of samples to write.
+ * audio_driver_flush_passthrough:
+ * @data                 : s16 interleaved stereo samples.
+ * @samples              : number of samples (not frames).
+ * @ratio                : output/input rate ratio, close to 1.0.
  *
- * Writes audio samples to audio driver. Will first
- * perform DSP processing (if enabled) and resampling.
+ * Writes s16 audio straight to the driver, doing the small
+ * rate adjustment by dropping or duplicating frames.
  **/
-static void audio_driver_flush(
+static void audio_driver_flush_passthrough(
       struct rarch_state *p_rarch,
-      float slowmotion_ratio,
-      bool audio_fastforward_mute,
-      const int16_t *data, size_t samples,
-      bool is_slowmotion, bool is_fastmotion)
+      const int16_t *data, size_t samples, double ratio)
 {
-   struct resampler_data src_data;
-   float audio_volume_gain           = (p_rarch->audio_driver_mute_enable ||
-         (audio_fastforward_mute && is_fastmotion)) ?
-               0.0f : p_rarch->audio_driver_volume_gain;
+   size_t frames_in          = samples >> 1;
+   uint32_t step             = (uint32_t)(65536.0 / ratio + 0.5);
+   uint64_t pos              = p_rarch->audio_driver_passthrough_pos;
+   const int16_t *out        = data;
+   size_t frames_out         = frames_in;
 
-   src_data.data_out                 = NULL;
-   src_data.output_frames            = 0;
+   if (step != 0x10000)
+   {
+      /* The float output buffer is more than large enough */
+      int16_t *dst           = (int16_t*)
+         p_rarch->audio_driver_output_samples_buf;
 
-   convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
-         audio_volume_gain);
+      for (frames_out = 0; (pos >> 16) < frames_in; frames_out++)
+      {
+         size_t i            = (size_t)(pos >> 16) << 1;
+         dst[frames_out * 2]     = data[i];
+         dst[frames_out * 2 + 1] = data[i + 1];
+         pos                += step;
+      }
 
-   src_data.data_in                  = p_rarch->audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
+      p_rarch->audio_driver_passthrough_pos = (uint32_t)
+         (pos - ((uint64_t)frames_in << 16));
+      out                    = dst;
+   }
 
-#ifdef HAVE_DSP_FILTER
-   if (p_rarch->audio_driver_dsp)
+   if (p_rarch->current_audio->write(
+            p_rarch->audio_driver_context_audio_data,
+            out, frames_out * 2 * sizeof(int16_t)) < 0)
+      p_rarch->audio_driver_active = false;
+}
+
+/**
+ * audio_driver_rate_control_pi:
+ *
+ * Proportional-integral alternative to the plain proportional
+ * rate control. The proportional term works on write_avail
+ * averaged over the last few flushes, so jitter in when the
+ * driver drains its buffer doesn't turn straight into pitch
+ * wobble. The integral term removes the steady offset a pure
+ * proportional controller settles at whenever the core and
+ * the audio device run at slightly different rates, so the
+ * buffer actually sits at the configured fill level.
+ *
+ * Returns: adjustment direction in [-1, 1], scaled by
+ * audio_rate_control_delta by the caller.
+ **/
+static double audio_driver_rate_control_pi(struct rarch_state *p_rarch)
+{
+   unsigned i;
+   double error;
+   double output;
+   double accum           = 0.0;
+   uint64_t count         = p_rarch->audio_driver_free_samples_count;
+   unsigned samples       = (unsigned)MIN(count,
+         AUDIO_RATE_CONTROL_PI_WINDOW);
+   double half_size       = p_rarch->audio_driver_buffer_size / 2.0;
+   double target          = (double)p_rarch->audio_driver_buffer_size *
+      (100 - p_rarch->audio_driver_rate_control_target) / 100.0;
+   double integral        = p_rarch->audio_driver_rate_control_integral;
+
+   if (samples == 0 || half_size <= 0.0)
+      return 0.0;
+
+   for (i = 1; i <= samples; i++)
+      accum += p_rarch->audio_driver_free_samples_buf[
+         (count - i) & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1)];
+
+   /* Positive when the buffer is emptier than the target */
+   error     = (accum / samples - target) / half_size;
+   integral += AUDIO_RATE_CONTROL_PI_KI * error;
+
+   /* Anti-windup: the integral alone may never ask for
+    * more than the configured maximum deviation */
+   integral  = MIN(MAX(integral, -1.0), 1.0);
+   output    = MIN(MAX(error + integral, -1.0), 1.0);
+
+   p_rarch->audio_driver_rate_control_integral = integral;
+
+   return output;
+}
+
+/**
+ * audio_latency_test_finish:
+ *
+ * Writes the latency test report, combining the click latencies
+ * with the buffer fill history recorded while the test ran.
+ * All values in ms, -1 where the driver couldn't tell.
+ **/
+static void audio_latency_test_finish(struct rarch_state *p_rarch)
+{
+   unsigned i;
+   struct audio_latency_test *test = &p_rarch->audio_latency_test;
+   unsigned writes                 = (unsigned)MIN(
+         p_rarch->audio_driver_free_samples_count - test->history_start,
+         AUDIO_BUFFER_FREE_SAMPLES_COUNT);
+   unsigned underruns              = 0;
+   unsigned near_underruns         = 0;
+   double queued_min               = -1.0;
+   double queued_max               = -1.0;
+   double queued_avg               = -1.0;
+   double click_avg                = -1.0;
+
+   if (test->buffer_size && writes)
    {
-      struct retro_dsp_data dsp_data;
+      double scale       = 1000.0 / test->frame_size / test->rate;
+      uint64_t accum     = 0;
+      unsigned avail_min = (unsigned)-1;
+      unsigned avail_max = 0;
 
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
+      for (i = 1; i <= writes; i++)
+      {
+         unsigned avail = p_rarch->audio_driver_free_samples_buf[
+            (p_rarch->audio_driver_free_samples_count - i)
+            & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1)];
 
-      dsp_data.input                 = p_rarch->audio_driver_input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
+         avail  = MIN(avail, (unsigned)test->buffer_size);
+         accum += avail;
 
-      retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
+         if (avail < avail_min)
+            avail_min = avail;
+         if (avail > avail_max)
+            avail_max = avail;
 
-      if (dsp_data.output)
+         /* Nothing left queued: the device ran dry
+          * before this write, or was about to */
+         if (avail == test->buffer_size)
+            underruns++;
+         else if (avail >= test->buffer_size * 3 / 4)
+            near_underruns++;
+      }
+
+      queued_min = (test->buffer_size - avail_max) * scale;
+      queued_max = (test->buffer_size - avail_min) * scale;
+      queued_avg = (test->buffer_size - (double)accum / writes) * scale;
+
+      if (test->clicks)
+         click_avg = test->click_ms_accum / test->clicks;
+   }
+
+   snprintf(test->report, sizeof(test->report),
+         "AUDIO_LATENCY_TEST %s clicks=%u"
+         " click_min=%.2f click_avg=%.2f click_max=%.2f"
+         " queued_min=%.2f queued_avg=%.2f queued_max=%.2f"
+         " writes=%u underruns=%u near_underruns=%u\n",
+         p_rarch->current_audio->ident,
+         test->clicks,
+         click_avg < 0.0 ? -1.0 : test->click_ms_min,
+         click_avg,
+         click_avg < 0.0 ? -1.0 : test->click_ms_max,
+         queued_min, queued_avg, queued_max,
+         writes, underruns, near_underruns);
+
+   test->active = false;
+
+   RARCH_LOG("[Audio]: Latency test done: %s", test->report
+         + STRLEN_CONST("AUDIO_LATENCY_TEST "));
+}
+
+/**
+ * audio_latency_test_process:
+ * @samples            : interleaved stereo output, at the output rate
+ * @frames             : number of frames in @samples
+ *
+ * Replaces the output with the latency test's click train. A
+ * click's latency is the audio queued ahead of it in the driver
+ * buffer, its offset in this write and the device latency on
+ * top, where the driver reports one.
+ **/
+static void audio_latency_test_process(struct rarch_state *p_rarch,
+      float *samples, size_t frames)
+{
+   size_t i;
+   struct audio_latency_test *test = &p_rarch->audio_latency_test;
+   double queued_ms                = -1.0;
+   unsigned click_frames           = MAX(1,
+         test->rate * AUDIO_LATENCY_TEST_CLICK_MS / 1000);
+
+   if (test->buffer_size)
+   {
+      unsigned avail;
+
+      /* Rate control already sampled write_avail for this write,
+       * otherwise keep the history in its place */
+      if (p_rarch->audio_driver_control)
+         avail = p_rarch->audio_driver_free_samples_buf[
+            (p_rarch->audio_driver_free_samples_count - 1)
+            & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1)];
+      else
       {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
+         avail = (unsigned)p_rarch->current_audio->write_avail(
+               p_rarch->audio_driver_context_audio_data);
+         p_rarch->audio_driver_free_samples_buf[
+            p_rarch->audio_driver_free_samples_count++
+            & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1)] = avail;
       }
+
+      avail     = MIN(avail, (unsigned)test->buffer_size);
+      queued_ms = (double)(test->buffer_size - avail)
+         / test->frame_size * 1000.0 / test->rate;
    }
-#endif
 
-   src_data.data_out                 = p_rarch->audio_driver_output_samples_buf;
+   for (i = 0; i < frames; i++)
+   {
+      float sample = 0.0f;
+
+      if (test->frames_to_click == 0)
+      {
+         test->frames_to_click = test->rate
+            * AUDIO_LATENCY_TEST_INTERVAL_MS / 1000;
+         test->pulse_left      = click_frames;
+
+         if (queued_ms >= 0.0)
+         {
+            float click_ms = (float)(queued_ms
+                  + i * 1000.0 / test->rate);
+
+            if (!test->clicks || click_ms < test->click_ms_min)
+               test->click_ms_min = click_ms;
+            if (!test->clicks || click_ms > test->click_ms_max)
+               test->click_ms_max = click_ms;
+            test->click_ms_accum += click_ms;
+         }
+
+         test->clicks++;
+      }
+
+      test->frames_to_click--;
+
+      if (test->pulse_left)
+      {
+         sample = 0.9f;
+         test->pulse_left--;
+      }
+
+      samples[i * 2 + 0] = sample;
+      samples[i * 2 + 1] = sample;
+   }
+
+   if (test->frames_left > frames)
+      test->frames_left -= (unsigned)frames;
+   else
+      audio_latency_test_finish(p_rarch);
+}
+
+static void audio_driver_process(
+      struct rarch_state *p_rarch,
+      float slowmotion_ratio,
+      bool audio_fastforward_mute,
+      const int16_t *data, size_t samples,
+      bool is_slowmotion, bool is_fastmotion)
+{
+   struct resampler_data src_data;
+   float audio_volume_gain           = (p_rarch->audio_driver_mute_enable ||
+         (audio_fastforward_mute && is_fastmotion)) ?
+               0.0f : p_rarch->audio_driver_volume_gain;
+
+   src_data.data_out                 = NULL;
+   src_data.output_frames            = 0;
 
    if (p_rarch->audio_driver_control)
    {
@@ -28365,16 +31440,24 @@ static void audio_driver_flush(
       int      avail               =
          (int)p_rarch->current_audio->write_avail(
                p_rarch->audio_driver_context_audio_data);
-      int      delta_mid           = avail - half_size;
-      double   direction           = (double)delta_mid / half_size;
-      double   adjust              = 1.0 +
-         p_rarch->audio_driver_rate_control_delta * direction;
+      double   direction;
+      double   adjust;
       unsigned write_idx           =
          p_rarch->audio_driver_free_samples_count++ &
          (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1);
 
       p_rarch->audio_driver_free_samples_buf
          [write_idx]                        = avail;
+
+      if (p_rarch->audio_driver_control_pi)
+         direction                          =
+            audio_driver_rate_control_pi(p_rarch);
+      else
+         direction                          =
+            (double)(avail - half_size) / half_size;
+
+      adjust                                = 1.0 +
+         p_rarch->audio_driver_rate_control_delta * direction;
       p_rarch->audio_source_ratio_current   =
          p_rarch->audio_source_ratio_original * adjust;
 
@@ -28413,6 +31496,56 @@ static void audio_driver_flush(
     * trying to do anything. Just leave the ratio as-is,
     * and hope for the best... */
 
+   /* Nothing to convert, filter or mix, and (nearly) no rate
+    * change: skip the float round trip entirely */
+   if (     !p_rarch->audio_driver_use_float
+         && audio_volume_gain == 1.0f
+#ifdef HAVE_DSP_FILTER
+         && !p_rarch->audio_driver_dsp
+#endif
+#ifdef HAVE_AUDIOMIXER
+         && !p_rarch->audio_mixer_active
+#endif
+         && !p_rarch->audio_latency_test.active
+         && src_data.ratio > 1.0 - AUDIO_PASSTHROUGH_MAX_SKEW
+         && src_data.ratio < 1.0 + AUDIO_PASSTHROUGH_MAX_SKEW)
+   {
+      audio_driver_flush_passthrough(p_rarch, data, samples,
+            src_data.ratio);
+      return;
+   }
+
+   convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
+         audio_volume_gain);
+
+   src_data.data_in                  = p_rarch->audio_driver_input_data;
+   src_data.input_frames             = samples >> 1;
+
+#ifdef HAVE_DSP_FILTER
+   if (p_rarch->audio_driver_dsp)
+   {
+      struct retro_dsp_data dsp_data;
+
+      dsp_data.input                 = NULL;
+      dsp_data.input_frames          = 0;
+      dsp_data.output                = NULL;
+      dsp_data.output_frames         = 0;
+
+      dsp_data.input                 = p_rarch->audio_driver_input_data;
+      dsp_data.input_frames          = (unsigned)(samples >> 1);
+
+      retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
+
+      if (dsp_data.output)
+      {
+         src_data.data_in            = dsp_data.output;
+         src_data.input_frames       = dsp_data.output_frames;
+      }
+   }
+#endif
+
+   src_data.data_out                 = p_rarch->audio_driver_output_samples_buf;
+
    p_rarch->audio_driver_resampler->process(
          p_rarch->audio_driver_resampler_data, &src_data);
 
@@ -28440,15 +31573,26 @@ static void audio_driver_flush(
    {
       const void *output_data = p_rarch->audio_driver_output_samples_buf;
       unsigned output_frames  = (unsigned)src_data.output_frames;
+      int16_t *conv_buf       = p_rarch->audio_driver_output_samples_conv_buf;
+
+#ifdef HAVE_THREADS
+      /* The emulation thread keeps filling the regular one */
+      if (p_rarch->audio_flush_thread)
+         conv_buf             = p_rarch->audio_flush_thread_conv_buf;
+#endif
+
+      if (p_rarch->audio_latency_test.active)
+         audio_latency_test_process(p_rarch,
+               p_rarch->audio_driver_output_samples_buf, output_frames);
 
       if (p_rarch->audio_driver_use_float)
          output_frames       *= sizeof(float);
       else
       {
-         convert_float_to_s16(p_rarch->audio_driver_output_samples_conv_buf,
+         convert_float_to_s16(conv_buf,
                (const float*)output_data, output_frames * 2);
 
-         output_data          = p_rarch->audio_driver_output_samples_conv_buf;
+         output_data          = conv_buf;
          output_frames       *= sizeof(int16_t);
       }
 
@@ -28459,6 +31603,82 @@ static void audio_driver_flush(
    }
 }
 
+#ifdef HAVE_THREADS
+static void audio_driver_flush_thread_cb(void *userdata,
+      const audio_flush_chunk_t *chunk, const int16_t *data)
+{
+   struct rarch_state *p_rarch = (struct rarch_state*)userdata;
+
+   if (p_rarch->audio_driver_active)
+      audio_driver_process(p_rarch,
+            chunk->slowmotion_ratio, chunk->fastforward_mute,
+            data, chunk->samples,
+            chunk->is_slowmotion, chunk->is_fastmotion);
+}
+#endif
+
+static void audio_driver_lock_processing(struct rarch_state *p_rarch)
+{
+#ifdef HAVE_THREADS
+   if (p_rarch->audio_flush_thread)
+      audio_flush_thread_lock(p_rarch->audio_flush_thread);
+#endif
+}
+
+static void audio_driver_unlock_processing(struct rarch_state *p_rarch)
+{
+#ifdef HAVE_THREADS
+   if (p_rarch->audio_flush_thread)
+      audio_flush_thread_unlock(p_rarch->audio_flush_thread);
+#endif
+}
+
+/**
+ * audio_driver_flush:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to write.
+ *
+ * Writes audio samples to audio driver. Will first
+ * perform DSP processing (if enabled) and resampling.
+ * With threaded processing, this only queues the samples
+ * for the processing thread.
+ **/
+static void audio_driver_flush(
+      struct rarch_state *p_rarch,
+      float slowmotion_ratio,
+      bool audio_fastforward_mute,
+      const int16_t *data, size_t samples,
+      bool is_slowmotion, bool is_fastmotion)
+{
+#ifdef HAVE_THREADS
+   if (p_rarch->audio_flush_thread)
+   {
+      audio_flush_chunk_t chunk;
+      /* Same condition the driver's own nonblock state is set from */
+      bool blocking          = p_rarch->configuration_settings->bools.audio_sync
+         && !p_rarch->input_driver_nonblock_state;
+
+      chunk.samples          = samples;
+      chunk.slowmotion_ratio = slowmotion_ratio;
+      chunk.fastforward_mute = audio_fastforward_mute;
+      chunk.is_slowmotion    = is_slowmotion;
+      chunk.is_fastmotion    = is_fastmotion;
+
+      PERF_SCOPE_BEGIN("audio_flush");
+      audio_flush_thread_push(p_rarch->audio_flush_thread,
+            &chunk, data, blocking);
+      PERF_SCOPE_END();
+      return;
+   }
+#endif
+
+   PERF_SCOPE_BEGIN("audio_flush");
+   audio_driver_process(p_rarch, slowmotion_ratio,
+         audio_fastforward_mute, data, samples,
+         is_slowmotion, is_fastmotion);
+   PERF_SCOPE_END();
+}
+
 /**
  * audio_driver_sample:
  * @left                 : value of the left audio channel.
@@ -28652,15 +31872,10 @@ static void audio_driver_sample_rewind(int16_t left, int16_t right)
 static size_t audio_driver_sample_batch_rewind(
       const int16_t *data, size_t frames)
 {
-   size_t i;
    struct rarch_state *p_rarch   = &rarch_st;
-   size_t              samples   = frames << 1;
 
-   for (i = 0; i < samples; i++)
-   {
-      if (p_rarch->audio_driver_rewind_ptr > 0)
-         p_rarch->audio_driver_rewind_buf[--p_rarch->audio_driver_rewind_ptr] = data[i];
-   }
+   audio_sample_rewind_fill(p_rarch->audio_driver_rewind_buf,
+         &p_rarch->audio_driver_rewind_ptr, data, frames);
 
    return frames;
 }
@@ -28732,23 +31947,15 @@ static float audio_driver_monitor_adjust_system_rates(
 #ifdef HAVE_REWIND
 void audio_driver_setup_rewind(void)
 {
-   unsigned i;
    struct rarch_state *p_rarch      = &rarch_st;
 
    /* Push audio ready to be played. */
    p_rarch->audio_driver_rewind_ptr = p_rarch->audio_driver_rewind_size;
 
-   for (i = 0; i < p_rarch->audio_driver_data_ptr; i += 2)
-   {
-      if (p_rarch->audio_driver_rewind_ptr > 0)
-         p_rarch->audio_driver_rewind_buf[
-            --p_rarch->audio_driver_rewind_ptr] =
-            p_rarch->audio_driver_output_samples_conv_buf[i + 1];
-
-      if (p_rarch->audio_driver_rewind_ptr > 0)
-         p_rarch->audio_driver_rewind_buf[--p_rarch->audio_driver_rewind_ptr] =
-            p_rarch->audio_driver_output_samples_conv_buf[i + 0];
-   }
+   audio_sample_rewind_fill(p_rarch->audio_driver_rewind_buf,
+         &p_rarch->audio_driver_rewind_ptr,
+         p_rarch->audio_driver_output_samples_conv_buf,
+         p_rarch->audio_driver_data_ptr >> 1);
 
    p_rarch->audio_driver_data_ptr = 0;
 }
@@ -28841,6 +32048,10 @@ static void audio_mixer_play_stop_cb(
             if (!string_is_empty(p_rarch->audio_mixer_streams[i].name))
                free(p_rarch->audio_mixer_streams[i].name);
 
+            memory_tag_add(MEMORY_TAG_AUDIO_MIXER,
+                  -(int64_t)p_rarch->audio_mixer_streams[i].bufsize);
+            p_rarch->audio_mixer_streams[i].bufsize = 0;
+
             p_rarch->audio_mixer_streams[i].name    = NULL;
             p_rarch->audio_mixer_streams[i].state   = AUDIO_STREAM_STATE_NONE;
             p_rarch->audio_mixer_streams[i].volume  = 0.0f;
@@ -28898,6 +32109,10 @@ static void audio_mixer_play_stop_sequential_cb(
             if (!string_is_empty(p_rarch->audio_mixer_streams[i].name))
                free(p_rarch->audio_mixer_streams[i].name);
 
+            memory_tag_add(MEMORY_TAG_AUDIO_MIXER,
+                  -(int64_t)p_rarch->audio_mixer_streams[i].bufsize);
+            p_rarch->audio_mixer_streams[i].bufsize = 0;
+
             if (i < AUDIO_MIXER_MAX_STREAMS)
                p_rarch->audio_mixer_streams[i].stream_type = AUDIO_STREAM_TYPE_USER;
             else
@@ -28918,7 +32133,13 @@ static void audio_mixer_play_stop_sequential_cb(
                if (p_rarch->audio_mixer_streams[i].state
                      == AUDIO_STREAM_STATE_STOPPED)
                {
-                  audio_driver_mixer_play_stream_sequential(i);
+                  /* Runs inside audio_mixer_mix(), so this must not
+                   * take the processing lock like the public
+                   * audio_driver_mixer_play_stream_sequential(). */
+                  p_rarch->audio_mixer_streams[i].stop_cb =
+                     audio_mixer_play_stop_sequential_cb;
+                  audio_driver_mixer_play_stream_internal(p_rarch,
+                        i, AUDIO_STREAM_STATE_PLAYING_SEQUENTIAL);
                   break;
                }
             }
@@ -28985,42 +32206,47 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
    if (params->state == AUDIO_STREAM_STATE_NONE)
       return false;
 
-   buf = malloc(params->bufsize);
+   if (params->path)
+      handle = audio_mixer_load_file(params->path, params->type);
+   else
+   {
+      buf = malloc(params->bufsize);
 
-   if (!buf)
-      return false;
+      if (!buf)
+         return false;
 
-   memcpy(buf, params->buf, params->bufsize);
+      memcpy(buf, params->buf, params->bufsize);
 
-   switch (params->type)
-   {
-      case AUDIO_MIXER_TYPE_WAV:
-         handle = audio_mixer_load_wav(buf, (int32_t)params->bufsize);
-         /* WAV is a special case - input buffer is not
-          * free()'d when sound playback is complete (it is
-          * converted to a PCM buffer, which is free()'d instead),
-          * so have to do it here */
-         free(buf);
-         buf = NULL;
-         break;
-      case AUDIO_MIXER_TYPE_OGG:
-         handle = audio_mixer_load_ogg(buf, (int32_t)params->bufsize);
-         break;
-      case AUDIO_MIXER_TYPE_MOD:
-         handle = audio_mixer_load_mod(buf, (int32_t)params->bufsize);
-         break;
-      case AUDIO_MIXER_TYPE_FLAC:
+      switch (params->type)
+      {
+         case AUDIO_MIXER_TYPE_WAV:
+            handle = audio_mixer_load_wav(buf, (int32_t)params->bufsize);
+            /* WAV is a special case - input buffer is not
+             * free()'d when sound playback is complete (it is
+             * converted to a PCM buffer, which is free()'d instead),
+             * so have to do it here */
+            free(buf);
+            buf = NULL;
+            break;
+         case AUDIO_MIXER_TYPE_OGG:
+            handle = audio_mixer_load_ogg(buf, (int32_t)params->bufsize);
+            break;
+         case AUDIO_MIXER_TYPE_MOD:
+            handle = audio_mixer_load_mod(buf, (int32_t)params->bufsize);
+            break;
+         case AUDIO_MIXER_TYPE_FLAC:
 #ifdef HAVE_DR_FLAC
-         handle = audio_mixer_load_flac(buf, (int32_t)params->bufsize);
+            handle = audio_mixer_load_flac(buf, (int32_t)params->bufsize);
 #endif
-         break;
-      case AUDIO_MIXER_TYPE_MP3:
+            break;
+         case AUDIO_MIXER_TYPE_MP3:
 #ifdef HAVE_DR_MP3
-         handle = audio_mixer_load_mp3(buf, (int32_t)params->bufsize);
+            handle = audio_mixer_load_mp3(buf, (int32_t)params->bufsize);
 #endif
-         break;
-      case AUDIO_MIXER_TYPE_NONE:
-         break;
+            break;
+         case AUDIO_MIXER_TYPE_NONE:
+            break;
+      }
    }
 
    if (!handle)
@@ -29029,6 +32255,8 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
       return false;
    }
 
+   audio_driver_lock_processing(p_rarch);
+
    switch (params->state)
    {
       case AUDIO_STREAM_STATE_PLAYING_LOOPED:
@@ -29051,6 +32279,8 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
    p_rarch->audio_mixer_streams[free_slot].name        =
       !string_is_empty(params->basename) ? strdup(params->basename) : NULL;
    p_rarch->audio_mixer_streams[free_slot].buf         = buf;
+   p_rarch->audio_mixer_streams[free_slot].bufsize     = params->path
+      ? 0 : params->bufsize;
    p_rarch->audio_mixer_streams[free_slot].handle      = handle;
    p_rarch->audio_mixer_streams[free_slot].voice       = voice;
    p_rarch->audio_mixer_streams[free_slot].stream_type = params->stream_type;
@@ -29059,6 +32289,11 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
    p_rarch->audio_mixer_streams[free_slot].volume      = params->volume;
    p_rarch->audio_mixer_streams[free_slot].stop_cb     = stop_cb;
 
+   memory_tag_add(MEMORY_TAG_AUDIO_MIXER,
+         (int64_t)p_rarch->audio_mixer_streams[free_slot].bufsize);
+
+   audio_driver_unlock_processing(p_rarch);
+
    return true;
 }
 
@@ -29215,41 +32450,51 @@ end:
 void audio_driver_mixer_play_stream(unsigned i)
 {
    struct rarch_state *p_rarch = &rarch_st;
+   audio_driver_lock_processing(p_rarch);
    p_rarch->audio_mixer_streams[i].stop_cb = audio_mixer_play_stop_cb;
    audio_driver_mixer_play_stream_internal(p_rarch,
          i, AUDIO_STREAM_STATE_PLAYING);
+   audio_driver_unlock_processing(p_rarch);
 }
 
 void audio_driver_mixer_play_menu_sound_looped(unsigned i)
 {
    struct rarch_state *p_rarch = &rarch_st;
+   audio_driver_lock_processing(p_rarch);
    p_rarch->audio_mixer_streams[i].stop_cb = audio_mixer_menu_stop_cb;
    audio_driver_mixer_play_stream_internal(p_rarch,
          i, AUDIO_STREAM_STATE_PLAYING_LOOPED);
+   audio_driver_unlock_processing(p_rarch);
 }
 
 void audio_driver_mixer_play_menu_sound(unsigned i)
 {
    struct rarch_state *p_rarch = &rarch_st;
+   audio_driver_lock_processing(p_rarch);
    p_rarch->audio_mixer_streams[i].stop_cb = audio_mixer_menu_stop_cb;
    audio_driver_mixer_play_stream_internal(p_rarch,
          i, AUDIO_STREAM_STATE_PLAYING);
+   audio_driver_unlock_processing(p_rarch);
 }
 
 void audio_driver_mixer_play_stream_looped(unsigned i)
 {
    struct rarch_state *p_rarch = &rarch_st;
+   audio_driver_lock_processing(p_rarch);
    p_rarch->audio_mixer_streams[i].stop_cb = audio_mixer_play_stop_cb;
    audio_driver_mixer_play_stream_internal(p_rarch,
          i, AUDIO_STREAM_STATE_PLAYING_LOOPED);
+   audio_driver_unlock_processing(p_rarch);
 }
 
 void audio_driver_mixer_play_stream_sequential(unsigned i)
 {
    struct rarch_state *p_rarch = &rarch_st;
+   audio_driver_lock_processing(p_rarch);
    p_rarch->audio_mixer_streams[i].stop_cb = audio_mixer_play_stop_sequential_cb;
    audio_driver_mixer_play_stream_internal(p_rarch,
          i, AUDIO_STREAM_STATE_PLAYING_SEQUENTIAL);
+   audio_driver_unlock_processing(p_rarch);
 }
 
 float audio_driver_mixer_get_stream_volume(unsigned i)
@@ -29302,10 +32547,12 @@ void audio_driver_mixer_stop_stream(unsigned i)
    {
       audio_mixer_voice_t *voice     = p_rarch->audio_mixer_streams[i].voice;
 
+      audio_driver_lock_processing(p_rarch);
       if (voice)
          audio_mixer_stop(voice);
       p_rarch->audio_mixer_streams[i].state   = AUDIO_STREAM_STATE_STOPPED;
       p_rarch->audio_mixer_streams[i].volume  = 1.0f;
+      audio_driver_unlock_processing(p_rarch);
    }
 }
 
@@ -29335,18 +32582,25 @@ void audio_driver_mixer_remove_stream(unsigned i)
    if (destroy)
    {
       audio_mixer_sound_t *handle = p_rarch->audio_mixer_streams[i].handle;
+
+      audio_driver_lock_processing(p_rarch);
       if (handle)
          audio_mixer_destroy(handle);
 
       if (!string_is_empty(p_rarch->audio_mixer_streams[i].name))
          free(p_rarch->audio_mixer_streams[i].name);
 
+      memory_tag_add(MEMORY_TAG_AUDIO_MIXER,
+            -(int64_t)p_rarch->audio_mixer_streams[i].bufsize);
+
+      p_rarch->audio_mixer_streams[i].bufsize = 0;
       p_rarch->audio_mixer_streams[i].state   = AUDIO_STREAM_STATE_NONE;
       p_rarch->audio_mixer_streams[i].stop_cb = NULL;
       p_rarch->audio_mixer_streams[i].volume  = 0.0f;
       p_rarch->audio_mixer_streams[i].handle  = NULL;
       p_rarch->audio_mixer_streams[i].voice   = NULL;
       p_rarch->audio_mixer_streams[i].name    = NULL;
+      audio_driver_unlock_processing(p_rarch);
    }
 }
 #endif
@@ -29421,11 +32675,18 @@ static INLINE bool audio_driver_alive(struct rarch_state *p_rarch)
 static bool audio_driver_start(struct rarch_state *p_rarch,
       bool is_shutdown)
 {
+   bool ret;
+
    if (!p_rarch->current_audio || !p_rarch->current_audio->start
          || !p_rarch->audio_driver_context_audio_data)
       goto error;
-   if (!p_rarch->current_audio->start(
-            p_rarch->audio_driver_context_audio_data, is_shutdown))
+
+   audio_driver_lock_processing(p_rarch);
+   ret = p_rarch->current_audio->start(
+         p_rarch->audio_driver_context_audio_data, is_shutdown);
+   audio_driver_unlock_processing(p_rarch);
+
+   if (!ret)
       goto error;
 
    return true;
@@ -29439,14 +32700,27 @@ error:
 
 static bool audio_driver_stop(struct rarch_state *p_rarch)
 {
+   bool ret;
+
    if (     !p_rarch->current_audio
          || !p_rarch->current_audio->stop
          || !p_rarch->audio_driver_context_audio_data
          || !audio_driver_alive(p_rarch)
       )
       return false;
-   return p_rarch->current_audio->stop(
+
+   audio_driver_lock_processing(p_rarch);
+#ifdef HAVE_THREADS
+   /* Writing queued audio to a stopped driver could block
+    * the processing thread until the driver is restarted. */
+   if (p_rarch->audio_flush_thread)
+      audio_flush_thread_clear(p_rarch->audio_flush_thread);
+#endif
+   ret = p_rarch->current_audio->stop(
          p_rarch->audio_driver_context_audio_data);
+   audio_driver_unlock_processing(p_rarch);
+
+   return ret;
 }
 
 #ifdef HAVE_REWIND
@@ -30266,6 +33540,9 @@ static bool video_driver_init_internal(
       video_driver_init_filter(video_driver_pix_fmt, settings);
 #endif
 
+   /* A new driver has no previous frame to show again */
+   p_rarch->video_driver_frame_hash_valid = false;
+
    max_dim   = MAX(geom->max_width, geom->max_height);
    scale     = next_pow2(max_dim) / RARCH_SCALE_BASE;
    scale     = MAX(scale, 1);
@@ -30805,6 +34082,133 @@ bool video_monitor_fps_statistics(double *refresh_rate,
    return true;
 }
 
+void video_driver_frame_presented(uint64_t frame_count,
+      retro_time_t present_time)
+{
+   unsigned i;
+   struct rarch_state *p_rarch = &rarch_st;
+   uint64_t count              = p_rarch->frame_timing_count;
+   unsigned samples            = (unsigned)MIN(count,
+         FRAME_TIMING_SAMPLES_COUNT);
+
+#ifdef HAVE_THREADS
+   if (VIDEO_DRIVER_IS_THREADED_INTERNAL())
+      return;
+#endif
+
+   /* Drivers report a few frames late, search from the newest */
+   for (i = 1; i <= samples; i++)
+   {
+      struct frame_timing_sample *sample =
+         &p_rarch->frame_timing_samples[(count - i)
+         & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+
+      if (sample->frame < frame_count)
+         break;
+
+      if (sample->frame == frame_count)
+      {
+         /* Swap interval emulation presents a frame
+          * more than once, keep when it first showed up */
+         if (!sample->present)
+            sample->present = present_time;
+         break;
+      }
+   }
+}
+
+/**
+ * video_frame_timing_values:
+ * @metric             : Which interval to collect.
+ * @out                : At least FRAME_TIMING_SAMPLES_COUNT entries.
+ *
+ * Gets the values (usec) of @metric over the recorded frames,
+ * oldest first.
+ *
+ * Returns: number of values written to @out.
+ **/
+static unsigned video_frame_timing_values(struct rarch_state *p_rarch,
+      enum frame_timing_metric metric, retro_time_t *out)
+{
+   unsigned i;
+   unsigned n                              = 0;
+   uint64_t count                          = p_rarch->frame_timing_count;
+   unsigned samples                        = (unsigned)MIN(count,
+         FRAME_TIMING_SAMPLES_COUNT);
+   const struct frame_timing_sample *prev  = NULL;
+
+   for (i = 0; i < samples; i++)
+   {
+      const struct frame_timing_sample *sample =
+         &p_rarch->frame_timing_samples[(count - samples + i)
+         & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+
+      switch (metric)
+      {
+         case FRAME_TIMING_CORE_RUN:
+            if (sample->run_start && sample->run_end)
+               out[n++] = sample->run_end - sample->run_start;
+            break;
+         case FRAME_TIMING_SUBMIT:
+            out[n++] = sample->swap - sample->submit;
+            break;
+         case FRAME_TIMING_INTERVAL:
+            if (prev)
+               out[n++] = sample->submit - prev->submit;
+            break;
+         case FRAME_TIMING_WORK:
+            if (sample->run_start && sample->run_end)
+               out[n++] = (sample->submit - sample->run_start)
+                  + (sample->run_end - sample->swap);
+            break;
+         case FRAME_TIMING_PRESENT:
+            if (prev && prev->present && sample->present
+                  && sample->frame == prev->frame + 1)
+               out[n++] = sample->present - prev->present;
+            break;
+         default:
+            break;
+      }
+
+      prev = sample;
+   }
+
+   return n;
+}
+
+static int video_frame_timing_compare(const void *a, const void *b)
+{
+   retro_time_t x = *(const retro_time_t*)a;
+   retro_time_t y = *(const retro_time_t*)b;
+   return (x > y) - (x < y);
+}
+
+/**
+ * video_frame_timing_percentile:
+ * @metric             : Which interval to look at.
+ * @percentile         : 0-100.
+ * @samples            : Number of values the result is based on.
+ *
+ * Returns: the given percentile (usec) of @metric over
+ * the recorded frames, 0 if there are none.
+ **/
+static retro_time_t video_frame_timing_percentile(
+      struct rarch_state *p_rarch,
+      enum frame_timing_metric metric,
+      unsigned percentile, unsigned *samples)
+{
+   retro_time_t values[FRAME_TIMING_SAMPLES_COUNT];
+   unsigned n = video_frame_timing_values(p_rarch, metric, values);
+
+   if (samples)
+      *samples = n;
+   if (!n)
+      return 0;
+
+   qsort(values, n, sizeof(*values), video_frame_timing_compare);
+   return values[(n - 1) * percentile / 100];
+}
+
 float video_driver_get_aspect_ratio(void)
 {
    struct rarch_state *p_rarch = &rarch_st;
@@ -30993,6 +34397,17 @@ bool video_driver_supports_rgba(void)
    return tmp;
 }
 
+bool video_driver_supports_overlay_atlas(void)
+{
+#ifdef HAVE_OVERLAY
+   const video_overlay_interface_t *iface = NULL;
+
+   if (video_driver_overlay_interface(&iface) && iface)
+      return iface->load_atlas != NULL;
+#endif
+   return false;
+}
+
 bool video_driver_get_next_video_out(void)
 {
    struct rarch_state *p_rarch = &rarch_st;
@@ -31479,6 +34894,38 @@ struct video_viewport *video_viewport_get_custom(void)
  *
  * Video frame render callback function.
  **/
+/* FNV-1a over 64 bit words of every row, seeded with
+ * the frame dimensions */
+static uint64_t video_driver_frame_hash(const void *data,
+      unsigned width, unsigned height, size_t pitch, size_t bpp)
+{
+   unsigned y;
+   size_t row_size = width * bpp;
+   uint64_t hash   = 0xcbf29ce484222325ULL;
+
+   hash = (hash ^ width)  * 0x100000001b3ULL;
+   hash = (hash ^ height) * 0x100000001b3ULL;
+   hash = (hash ^ bpp)    * 0x100000001b3ULL;
+
+   for (y = 0; y < height; y++)
+   {
+      size_t x;
+      const uint8_t *row = (const uint8_t*)data + y * pitch;
+
+      for (x = 0; x + sizeof(uint64_t) <= row_size; x += sizeof(uint64_t))
+      {
+         uint64_t word;
+         memcpy(&word, row + x, sizeof(word));
+         hash = (hash ^ word) * 0x100000001b3ULL;
+      }
+
+      for (; x < row_size; x++)
+         hash = (hash ^ row[x]) * 0x100000001b3ULL;
+   }
+
+   return hash;
+}
+
 static void video_driver_frame(const void *data, unsigned width,
       unsigned height, size_t pitch)
 {
@@ -31513,6 +34960,28 @@ static void video_driver_frame(const void *data, unsigned width,
    p_rarch->frame_cache_height  = height;
    p_rarch->frame_cache_pitch   = pitch;
 
+   /* A frame identical to the previous one is handled
+    * as a dupe. The frame cache still points at the
+    * new data, which the core may overwrite later. */
+   if (data && p_rarch->configuration_settings->bools.video_frame_dupe_detect)
+   {
+      if (data == RETRO_HW_FRAME_BUFFER_VALID)
+         p_rarch->video_driver_frame_hash_valid = false;
+      else
+      {
+         uint64_t hash = video_driver_frame_hash(data, width, height, pitch,
+               (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+               ? sizeof(uint32_t) : sizeof(uint16_t));
+
+         if (     p_rarch->video_driver_frame_hash_valid
+               && (p_rarch->video_driver_frame_hash == hash))
+            data = NULL;
+
+         p_rarch->video_driver_frame_hash       = hash;
+         p_rarch->video_driver_frame_hash_valid = true;
+      }
+   }
+
    if (
             p_rarch->video_driver_scaler_ptr
          && data
@@ -31714,6 +35183,9 @@ static void video_driver_frame(const void *data, unsigned width,
    }
 #endif
 
+   /* Once per frame, everything posted since the last one */
+   runloop_msg_queue_collect(p_rarch);
+
    if (runloop_state.msg_queue_size > 0)
    {
       /* If widgets are currently enabled, then
@@ -31827,15 +35299,68 @@ static void video_driver_frame(const void *data, unsigned width,
             av_info->timing.fps,
             av_info->timing.sample_rate);
 
+      if (p_rarch->video_driver_state_filter)
+      {
+         const char *ident = NULL;
+         size_t len        = strlen(video_info.stat_text);
+         float filter_ms   = rarch_softfilter_get_process_time(
+               p_rarch->video_driver_state_filter, &ident);
+         snprintf(video_info.stat_text + len,
+               sizeof(video_info.stat_text) - len,
+               "Softfilter:\n -%s: %.2f ms\n", ident, filter_ms);
+      }
+
+      if (perf_scope_count())
+      {
+         size_t len = strlen(video_info.stat_text);
+         len       += strlcpy(video_info.stat_text + len,
+               "Frame Scopes (p50 / p99 / max):\n",
+               sizeof(video_info.stat_text) - len);
+         if (len < sizeof(video_info.stat_text))
+            perf_scope_report(video_info.stat_text + len,
+                  sizeof(video_info.stat_text) - len, false);
+      }
+
+#ifdef HAVE_MEMORY_TAGS
+      {
+         size_t len = strlen(video_info.stat_text);
+         len       += strlcpy(video_info.stat_text + len,
+               "Memory Tags:\n",
+               sizeof(video_info.stat_text) - len);
+         if (len < sizeof(video_info.stat_text))
+            memory_tag_report(video_info.stat_text + len,
+                  sizeof(video_info.stat_text) - len);
+      }
+#endif
+
       /* TODO/FIXME - add OSD chat text here */
    }
 
    if (p_rarch->current_video && p_rarch->current_video->frame)
+   {
+      struct frame_timing_sample *sample = &p_rarch->frame_timing_samples[
+         p_rarch->frame_timing_count++ & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+
+      sample->run_start            = p_rarch->frame_timing_run_start;
+      sample->run_end              = 0;
+      sample->present              = 0;
+      sample->frame                = p_rarch->video_driver_frame_count;
+      sample->submit               = cpu_features_get_time_usec();
+
+      PERF_SCOPE_BEGIN("video_frame");
       p_rarch->video_driver_active = p_rarch->current_video->frame(
             p_rarch->video_driver_data, data, width, height,
             p_rarch->video_driver_frame_count, (unsigned)pitch,
             video_info.menu_screensaver_active ? "" : video_driver_msg,
             &video_info);
+      PERF_SCOPE_END();
+
+      sample->swap                 = cpu_features_get_time_usec();
+      p_rarch->power_video_usec   += sample->swap - sample->submit;
+   }
+
+   if (!p_rarch->startup_trace_done)
+      retroarch_startup_trace_finish(p_rarch);
 
    p_rarch->video_driver_frame_count++;
 
@@ -33087,6 +36612,577 @@ void driver_set_nonblock_state(void)
  * Initializes drivers.
  * @flags determines which drivers get initialized.
  **/
+static void retroarch_startup_trace_push(struct rarch_state *p_rarch,
+      const char *name, retro_time_t start_usec, retro_time_t end_usec)
+{
+   struct startup_trace_event *event = NULL;
+
+   if (p_rarch->startup_trace_count >= STARTUP_TRACE_EVENTS_COUNT)
+      return;
+
+   event        = &p_rarch->startup_trace_events[
+      p_rarch->startup_trace_count++];
+   event->name  = name;
+   event->start = start_usec;
+   event->end   = end_usec;
+}
+
+void retroarch_startup_trace_add(const char *name, retro_time_t start_usec)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   retro_time_t current_usec;
+
+   if (p_rarch->startup_trace_done)
+      return;
+
+   current_usec = cpu_features_get_time_usec();
+   retroarch_startup_trace_push(p_rarch, name, start_usec, current_usec);
+
+   RARCH_LOG("[Startup]: %s: %.2f ms.\n", name,
+         (double)(current_usec - start_usec) / 1000.0);
+}
+
+/* Records a stage of retroarch_main_init() ending
+ * now, the next one starts right away */
+static void retroarch_startup_trace(struct rarch_state *p_rarch,
+      const char *stage, retro_time_t *stage_start)
+{
+   if (p_rarch->startup_trace_done)
+      return;
+
+   retroarch_startup_trace_add(stage, *stage_start);
+   *stage_start = p_rarch->startup_trace_events[
+      p_rarch->startup_trace_count - 1].end;
+}
+
+static void retroarch_startup_trace_write(struct rarch_state *p_rarch,
+      const char *path)
+{
+   size_t i;
+   const char *cpu_model = frontend_driver_get_cpu_model_name();
+   rjsonwriter_t *writer = NULL;
+   RFILE *file           = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+   {
+      RARCH_ERR("[Startup]: Failed to write trace to \"%s\".\n", path);
+      return;
+   }
+
+   if (!(writer = rjsonwriter_open_rfile(file)))
+   {
+      filestream_close(file);
+      return;
+   }
+
+   /* Chrome trace event format, timestamps in usec */
+   rjsonwriter_add_start_object(writer);
+   rjsonwriter_add_string(writer, "traceEvents");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_start_array(writer);
+
+   for (i = 0; i < p_rarch->startup_trace_count; i++)
+   {
+      const struct startup_trace_event *event =
+         &p_rarch->startup_trace_events[i];
+
+      if (i)
+         rjsonwriter_add_comma(writer);
+      rjsonwriter_add_newline(writer);
+      rjsonwriter_add_spaces(writer, 2);
+      rjsonwriter_add_start_object(writer);
+      rjsonwriter_add_string(writer, "name");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, event->name);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "cat");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, "startup");
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "ph");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, event->end ? "X" : "i");
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "ts");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_unsigned(writer,
+            (unsigned)(event->start - p_rarch->startup_trace_base));
+      rjsonwriter_add_comma(writer);
+      if (event->end)
+      {
+         rjsonwriter_add_string(writer, "dur");
+         rjsonwriter_add_colon(writer);
+         rjsonwriter_add_unsigned(writer,
+               (unsigned)(event->end - event->start));
+      }
+      else
+      {
+         rjsonwriter_add_string(writer, "s");
+         rjsonwriter_add_colon(writer);
+         rjsonwriter_add_string(writer, "g");
+      }
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "pid");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_unsigned(writer, 1);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "tid");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_unsigned(writer, 1);
+      rjsonwriter_add_end_object(writer);
+   }
+
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_end_array(writer);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+
+   /* What is needed to compare builds and platforms */
+   rjsonwriter_add_string(writer, "otherData");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_start_object(writer);
+   rjsonwriter_add_string(writer, "version");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, PACKAGE_VERSION);
+#ifdef HAVE_GIT_VERSION
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "git");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, retroarch_git_version);
+#endif
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "cpu");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer,
+         string_is_empty(cpu_model) ? "" : cpu_model);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "video_driver");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, p_rarch->current_video
+         ? p_rarch->current_video->ident : "");
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "core");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, runloop_state.system.info.library_name
+         ? runloop_state.system.info.library_name : "");
+   rjsonwriter_add_end_object(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_end_object(writer);
+   rjsonwriter_add_newline(writer);
+
+   if (!rjsonwriter_free(writer))
+      RARCH_ERR("[Startup]: Failed to write trace to \"%s\".\n", path);
+   else
+      RARCH_LOG("[Startup]: Wrote trace to \"%s\".\n", path);
+
+   filestream_close(file);
+}
+
+/* Ends startup tracing, once the first frame
+ * has been handed to the video driver */
+static void retroarch_startup_trace_finish(struct rarch_state *p_rarch)
+{
+   retro_time_t current_usec = cpu_features_get_time_usec();
+
+   retroarch_startup_trace_push(p_rarch, "First frame", current_usec, 0);
+   p_rarch->startup_trace_done = true;
+
+   RARCH_LOG("[Startup]: First frame: %.2f ms.\n",
+         (double)(current_usec - p_rarch->startup_trace_base) / 1000.0);
+
+   if (!string_is_empty(p_rarch->startup_trace_path))
+      retroarch_startup_trace_write(p_rarch, p_rarch->startup_trace_path);
+}
+
+static void retroarch_vfs_stats_cb(const char *path,
+      const retro_vfs_file_stats_t *stats)
+{
+   RARCH_LOG("[VFS]: \"%s\": %u reads, %u misses, %u/%u blocks read "
+         "ahead used, %u seeks, %" PRIu64 " KB read, %" PRIu64
+         " KB fetched.\n",
+         path_basename(path), stats->reads, stats->misses,
+         stats->readahead_hits, stats->readaheads, stats->seeks,
+         stats->bytes_read / 1024, stats->bytes_fetched / 1024);
+}
+
+void retroarch_set_vfs_read_cache(unsigned block_size_kb)
+{
+   retro_vfs_set_read_cache((size_t)block_size_kb * 1024,
+         retroarch_vfs_stats_cb);
+}
+
+/* --headless: no window, input or sound, and nothing pacing the
+ * core. Work arrives as RUN_JOB network commands. */
+static void retroarch_headless_init(settings_t *settings)
+{
+   strlcpy(settings->arrays.video_driver, "null",
+         sizeof(settings->arrays.video_driver));
+   strlcpy(settings->arrays.input_driver, "null",
+         sizeof(settings->arrays.input_driver));
+
+   /* None of this is meant to end up in the config file */
+   configuration_set_bool(settings,
+         settings->bools.config_save_on_exit, false);
+   configuration_set_bool(settings, settings->bools.audio_enable, false);
+   configuration_set_bool(settings, settings->bools.video_vsync, false);
+   configuration_set_bool(settings, settings->bools.audio_sync, false);
+   configuration_set_bool(settings,
+         settings->bools.pause_nonactive, false);
+#ifdef HAVE_NETWORK_CMD
+   configuration_set_bool(settings,
+         settings->bools.network_cmd_enable, true);
+   RARCH_LOG("[Job]: Headless, taking jobs on 127.0.0.1:%u.\n",
+         settings->uints.network_cmd_port);
+   if (string_is_empty(settings->paths.directory_job))
+      RARCH_WARN("[Job]: No job_directory set, jobs will be refused.\n");
+#endif
+}
+
+/* Writes the results of the current job once it ran its frames */
+static void retroarch_job_finish(struct rarch_state *p_rarch)
+{
+   char path[PATH_MAX_LENGTH];
+   retro_ctx_size_info_t size_info;
+   retro_ctx_memory_info_t mem_info;
+   struct rarch_job *job = &p_rarch->job;
+   bool ok               = true;
+#ifdef HAVE_SCREENSHOTS
+   settings_t *settings  = p_rarch->configuration_settings;
+
+   strlcpy(path, job->output, sizeof(path));
+   strlcat(path, ".png", sizeof(path));
+   ok = take_screenshot(settings->paths.directory_screenshot, path, true,
+         video_driver_cached_frame_has_valid_framebuffer(), true, false);
+#endif
+
+   size_info.size = 0;
+   core_serialize_size(&size_info);
+   if (size_info.size)
+   {
+      retro_ctx_serialize_info_t serial_info;
+      void *data             = malloc(size_info.size);
+
+      serial_info.data_const = NULL;
+      serial_info.data       = data;
+      serial_info.size       = size_info.size;
+
+      strlcpy(path, job->output, sizeof(path));
+      strlcat(path, ".state", sizeof(path));
+      ok = data && core_serialize(&serial_info)
+         && filestream_write_file(path, data, size_info.size) && ok;
+      free(data);
+   }
+
+   mem_info.id   = RETRO_MEMORY_SYSTEM_RAM;
+   mem_info.data = NULL;
+   mem_info.size = 0;
+   if (core_get_memory(&mem_info) && mem_info.data && mem_info.size)
+   {
+      strlcpy(path, job->output, sizeof(path));
+      strlcat(path, ".ram", sizeof(path));
+      ok = filestream_write_file(path, mem_info.data, mem_info.size) && ok;
+   }
+
+   job->state = ok ? RARCH_JOB_DONE : RARCH_JOB_FAILED;
+   RARCH_LOG("[Job]: %u %s.\n", job->id,
+         ok ? "done" : "failed to write its results");
+
+   /* Idle until the next job */
+   command_event(CMD_EVENT_PAUSE, NULL);
+}
+
+/**
+ * retroarch_job_iterate:
+ *
+ * Advances the job queued by RUN_JOB. The content is loaded with the
+ * core still loaded from the previous job when they match, so only
+ * the first job of a core pays for loading it.
+ **/
+static void retroarch_job_iterate(struct rarch_state *p_rarch)
+{
+   struct rarch_job *job = &p_rarch->job;
+
+   switch (job->state)
+   {
+      case RARCH_JOB_QUEUED:
+         {
+            content_ctx_info_t content_info;
+            bool loaded                     = false;
+
+            content_info.argc               = 0;
+            content_info.argv               = NULL;
+            content_info.args               = NULL;
+            content_info.environ_get        = NULL;
+
+            if (p_rarch->current_core.inited &&
+                  string_is_equal(job->core_path, path_get(RARCH_PATH_CORE)))
+               loaded = task_push_load_content_with_current_core_from_companion_ui(
+                     job->content_path, &content_info, CORE_TYPE_PLAIN,
+                     NULL, NULL);
+#ifdef HAVE_DYNAMIC
+            else
+               loaded = task_push_load_content_with_new_core_from_companion_ui(
+                     job->core_path, job->content_path, NULL, NULL, NULL,
+                     &content_info, NULL, NULL);
+#endif
+
+            if (!loaded)
+            {
+               RARCH_ERR("[Job]: %u failed to load \"%s\".\n",
+                     job->id, job->content_path);
+               job->state = RARCH_JOB_FAILED;
+               break;
+            }
+
+            if (runloop_state.paused)
+               command_event(CMD_EVENT_UNPAUSE, NULL);
+
+            job->start_frame = UINT64_MAX;
+            job->state       = RARCH_JOB_RUNNING;
+            RARCH_LOG("[Job]: %u running \"%s\" for %u frames.\n",
+                  job->id, job->content_path, job->frames);
+         }
+         break;
+      case RARCH_JOB_RUNNING:
+         /* Count from the first frame of the new content */
+         if (job->start_frame == UINT64_MAX)
+            job->start_frame = p_rarch->video_driver_frame_count;
+         else if (p_rarch->video_driver_frame_count - job->start_frame
+               >= job->frames)
+            retroarch_job_finish(p_rarch);
+         break;
+      default:
+#ifdef HAVE_MENU
+         /* Nothing is pacing the menu, don't spin
+          * in it while waiting for the first job */
+         if (p_rarch->headless && p_rarch->menu_driver_alive)
+            retroarch_sleep(p_rarch, 10);
+#endif
+         break;
+   }
+}
+
+/* Turns off everything that paces the main loop so
+ * that --benchmark measures the core and frontend,
+ * not the display or audio device */
+static void retroarch_benchmark_init(struct rarch_state *p_rarch,
+      settings_t *settings)
+{
+   unsigned skip;
+
+   if (!runloop_state.max_frames)
+      runloop_state.max_frames = BENCHMARK_DEFAULT_FRAMES;
+
+   skip = MIN(BENCHMARK_WARMUP_FRAMES, runloop_state.max_frames / 10);
+
+   configuration_set_bool(settings, settings->bools.video_vsync, false);
+   configuration_set_bool(settings, settings->bools.audio_sync, false);
+   configuration_set_bool(settings,
+         settings->bools.vrr_runloop_enable, false);
+   configuration_set_bool(settings,
+         settings->bools.pause_nonactive, false);
+   configuration_set_bool(settings,
+         settings->bools.video_frame_delay_auto, false);
+   configuration_set_uint(settings, settings->uints.video_frame_delay, 0);
+   configuration_set_float(settings,
+         settings->floats.fastforward_ratio, 0.0f);
+
+   if (perf_scope_capture_start(runloop_state.max_frames - skip, skip))
+      RARCH_LOG("[Benchmark]: Running %u frames, skipping the first %u.\n",
+            runloop_state.max_frames, skip);
+   else
+   {
+      RARCH_ERR("[Benchmark]: Failed to allocate frame buffers.\n");
+      p_rarch->benchmark_path[0] = '\0';
+   }
+}
+
+static void retroarch_benchmark_write_stats(rjsonwriter_t *writer,
+      const perf_scope_stats_t *stats)
+{
+   rjsonwriter_add_string(writer, "avg");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, (unsigned)stats->avg);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "min");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, (unsigned)stats->min);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "p50");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, (unsigned)stats->p50);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "p90");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, (unsigned)stats->p90);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "p99");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, (unsigned)stats->p99);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "max");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, (unsigned)stats->max);
+}
+
+static void retroarch_benchmark_write_string(rjsonwriter_t *writer,
+      const char *key, const char *value)
+{
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, key);
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, string_is_empty(value) ? "" : value);
+}
+
+/* Writes the results of --benchmark, times in usec */
+static void retroarch_benchmark_write(struct rarch_state *p_rarch,
+      const char *path)
+{
+   unsigned i;
+   perf_scope_stats_t frame;
+   double seconds;
+   rjsonwriter_t *writer = NULL;
+   RFILE *file           = NULL;
+   unsigned frames       = perf_scope_capture_count();
+   retro_time_t duration = perf_scope_capture_duration();
+
+   if (!perf_scope_capture_get_stats(-1, &frame))
+      return;
+
+   seconds = duration / 1000000.0;
+
+   RARCH_LOG("[Benchmark]: %u frames in %.3f s, %.2f fps, "
+         "frame time p50 %.3f ms, p99 %.3f ms.\n",
+         frames, seconds, seconds > 0.0 ? frames / seconds : 0.0,
+         frame.p50 / 1000.0, frame.p99 / 1000.0);
+
+   if (!(file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      RARCH_ERR("[Benchmark]: Failed to write results to \"%s\".\n", path);
+      return;
+   }
+
+   if (!(writer = rjsonwriter_open_rfile(file)))
+   {
+      filestream_close(file);
+      return;
+   }
+
+   rjsonwriter_add_start_object(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "version");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, PACKAGE_VERSION);
+#ifdef HAVE_GIT_VERSION
+   retroarch_benchmark_write_string(writer, "git", retroarch_git_version);
+#endif
+   retroarch_benchmark_write_string(writer, "cpu",
+         frontend_driver_get_cpu_model_name());
+   retroarch_benchmark_write_string(writer, "video_driver",
+         p_rarch->current_video ? p_rarch->current_video->ident : NULL);
+   retroarch_benchmark_write_string(writer, "audio_driver",
+         p_rarch->current_audio ? p_rarch->current_audio->ident : NULL);
+   retroarch_benchmark_write_string(writer, "core",
+         runloop_state.system.info.library_name);
+   retroarch_benchmark_write_string(writer, "core_version",
+         runloop_state.system.info.library_version);
+   retroarch_benchmark_write_string(writer, "content",
+         path_basename(path_get(RARCH_PATH_CONTENT)));
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "cores");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, cpu_features_get_core_amount());
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "frames");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, frames);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "duration");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, (unsigned)duration);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "fps");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_double(writer, seconds > 0.0 ? frames / seconds : 0.0);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_string(writer, "frame_time");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_start_object(writer);
+   retroarch_benchmark_write_stats(writer, &frame);
+   rjsonwriter_add_end_object(writer);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+
+   /* Per-frame totals of the frame scopes, 'parent' is an
+    * index into this array and 'self' the average time
+    * not covered by nested scopes */
+   rjsonwriter_add_string(writer, "stages");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_start_array(writer);
+
+   for (i = 0; i < perf_scope_count(); i++)
+   {
+      perf_scope_stats_t stats;
+
+      if (!perf_scope_capture_get_stats((int)i, &stats))
+         continue;
+
+      if (i)
+         rjsonwriter_add_comma(writer);
+      rjsonwriter_add_newline(writer);
+      rjsonwriter_add_spaces(writer, 4);
+      rjsonwriter_add_start_object(writer);
+      rjsonwriter_add_string(writer, "name");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, stats.ident);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "parent");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_int(writer, stats.parent);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "calls");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_unsigned(writer, stats.calls);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "self");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_unsigned(writer, (unsigned)stats.self);
+      rjsonwriter_add_comma(writer);
+      retroarch_benchmark_write_stats(writer, &stats);
+      rjsonwriter_add_end_object(writer);
+   }
+
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_spaces(writer, 2);
+   rjsonwriter_add_end_array(writer);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_end_object(writer);
+   rjsonwriter_add_newline(writer);
+
+   if (!rjsonwriter_free(writer))
+      RARCH_ERR("[Benchmark]: Failed to write results to \"%s\".\n", path);
+   else
+      RARCH_LOG("[Benchmark]: Wrote results to \"%s\".\n", path);
+
+   filestream_close(file);
+}
+
 static void drivers_init(struct rarch_state *p_rarch,
       settings_t *settings,
       int flags,
@@ -33097,6 +37193,7 @@ static void drivers_init(struct rarch_state *p_rarch,
 #endif
    bool video_is_threaded      = VIDEO_DRIVER_IS_THREADED_INTERNAL();
    gfx_display_t *p_disp       = &p_rarch->dispgfx;
+   retro_time_t stage_start    = cpu_features_get_time_usec();
 #if defined(HAVE_GFX_WIDGETS)
    bool video_font_enable      = settings->bools.video_font_enable;
    bool menu_enable_widgets    = settings->bools.menu_enable_widgets;
@@ -33141,6 +37238,8 @@ static void drivers_init(struct rarch_state *p_rarch,
          hwr->context_reset();
       p_rarch->video_driver_cache_context_ack = false;
       runloop_state.frame_time_last        = 0;
+
+      retroarch_startup_trace(p_rarch, "Video driver", &stage_start);
    }
 
    /* Initialize audio driver */
@@ -33155,6 +37254,8 @@ static void drivers_init(struct rarch_state *p_rarch,
          p_rarch->audio_driver_devices_list = (struct string_list*)
             p_rarch->current_audio->device_list_new(
                   p_rarch->audio_driver_context_audio_data);
+
+      retroarch_startup_trace(p_rarch, "Audio driver", &stage_start);
    }
 
    if (flags & DRIVER_CAMERA_MASK)
@@ -33192,11 +37293,13 @@ static void drivers_init(struct rarch_state *p_rarch,
       }
    }
 
+   /* Bluetooth and wifi are only used from the menu,
+    * they are initialized on first use */
    if (flags & DRIVER_BLUETOOTH_MASK)
-      bluetooth_driver_ctl(RARCH_BLUETOOTH_CTL_INIT, NULL);
+      p_rarch->bluetooth_driver_deferred = true;
 
    if ((flags & DRIVER_WIFI_MASK))
-      wifi_driver_ctl(RARCH_WIFI_CTL_INIT, NULL);
+      p_rarch->wifi_driver_deferred      = true;
 
    if (flags & DRIVER_LOCATION_MASK)
    {
@@ -33207,6 +37310,9 @@ static void drivers_init(struct rarch_state *p_rarch,
 
    core_info_init_current_core();
 
+   retroarch_startup_trace(p_rarch, "Camera and location drivers",
+         &stage_start);
+
 #if defined(HAVE_GFX_WIDGETS)
    /* Note that we only enable widgets if 'video_font_enable'
     * is true. 'video_font_enable' corresponds to the generic
@@ -33239,6 +37345,8 @@ static void drivers_init(struct rarch_state *p_rarch,
       gfx_display_init_first_driver(p_disp, video_is_threaded);
    }
 
+   retroarch_startup_trace(p_rarch, "Widgets", &stage_start);
+
 #ifdef HAVE_MENU
    if (flags & DRIVER_VIDEO_MASK)
    {
@@ -33270,6 +37378,9 @@ static void drivers_init(struct rarch_state *p_rarch,
    command_event(CMD_EVENT_LOAD_CORE_PERSIST, NULL);
 #endif
 
+   retroarch_startup_trace(p_rarch, "Menu driver and core info",
+         &stage_start);
+
    if (flags & (DRIVER_VIDEO_MASK | DRIVER_AUDIO_MASK))
    {
       /* Keep non-throttled state as good as possible. */
@@ -33288,6 +37399,8 @@ static void drivers_init(struct rarch_state *p_rarch,
 #ifdef HAVE_LAKKA
    cpu_scaling_driver_init();
 #endif
+
+   retroarch_startup_trace(p_rarch, "LED and MIDI drivers", &stage_start);
 }
 
 /**
@@ -33846,9 +37959,12 @@ static void *runahead_save_state_alloc(void)
    if (  (p_rarch->runahead_save_state_size > 0) &&
          p_rarch->runahead_save_state_size_known)
    {
-      savestate->data       = malloc(p_rarch->runahead_save_state_size);
+      savestate->data       = memalign_alloc_large(
+            p_rarch->runahead_save_state_size);
       savestate->data_const = savestate->data;
-      savestate->size       = p_rarch->runahead_save_state_size;
+      savestate->size       = savestate->data
+         ? p_rarch->runahead_save_state_size : 0;
+      memory_tag_add(MEMORY_TAG_RUNAHEAD, (int64_t)savestate->size);
    }
 
    return savestate;
@@ -33859,7 +37975,8 @@ static void runahead_save_state_free(void *data)
    retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)data;
    if (!savestate)
       return;
-   free(savestate->data);
+   memory_tag_add(MEMORY_TAG_RUNAHEAD, -(int64_t)savestate->size);
+   memalign_free_large(savestate->data);
    free(savestate);
 }
 
@@ -33946,6 +38063,8 @@ static void runahead_error(struct rarch_state *p_rarch)
    runahead_remove_hooks(p_rarch);
    p_rarch->runahead_save_state_size       = 0;
    p_rarch->runahead_save_state_size_known = true;
+   p_rarch->runahead_ring_size             = 0;
+   p_rarch->runahead_ring_count            = 0;
 }
 
 static bool runahead_create(struct rarch_state *p_rarch)
@@ -33975,16 +38094,18 @@ static bool runahead_create(struct rarch_state *p_rarch)
    return true;
 }
 
-static bool runahead_save_state(struct rarch_state *p_rarch)
+static bool runahead_save_state_slot(struct rarch_state *p_rarch,
+      int slot)
 {
    retro_ctx_serialize_info_t *serialize_info;
    bool okay                       = false;
 
-   if (!p_rarch->runahead_save_state_list)
+   if (!p_rarch->runahead_save_state_list ||
+         slot >= p_rarch->runahead_save_state_list->size)
       return false;
 
    serialize_info                  =
-      (retro_ctx_serialize_info_t*)p_rarch->runahead_save_state_list->data[0];
+      (retro_ctx_serialize_info_t*)p_rarch->runahead_save_state_list->data[slot];
 
    p_rarch->request_fast_savestate = true;
    okay                            = core_serialize(serialize_info);
@@ -33997,11 +38118,12 @@ static bool runahead_save_state(struct rarch_state *p_rarch)
    return false;
 }
 
-static bool runahead_load_state(struct rarch_state *p_rarch)
+static bool runahead_load_state_slot(struct rarch_state *p_rarch,
+      int slot)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info = (retro_ctx_serialize_info_t*)
-      p_rarch->runahead_save_state_list->data[0];
+      p_rarch->runahead_save_state_list->data[slot];
    bool last_dirty                            = p_rarch->input_is_dirty;
 
    p_rarch->request_fast_savestate            = true;
@@ -34020,6 +38142,11 @@ static bool runahead_load_state(struct rarch_state *p_rarch)
    return okay;
 }
 
+static bool runahead_save_state(struct rarch_state *p_rarch)
+{
+   return runahead_save_state_slot(p_rarch, 0);
+}
+
 #if HAVE_DYNAMIC
 static bool runahead_load_state_secondary(struct rarch_state *p_rarch)
 {
@@ -34067,6 +38194,383 @@ static bool runahead_core_run_use_last_input(struct rarch_state *p_rarch)
    return true;
 }
 
+static void runahead_core_run_no_poll(struct rarch_state *p_rarch)
+{
+   struct retro_callbacks *cbs            = &p_rarch->retro_ctx;
+   retro_input_poll_t old_poll_function   = cbs->poll_cb;
+
+   cbs->poll_cb                           = retro_input_poll_null;
+   p_rarch->current_core.retro_set_input_poll(cbs->poll_cb);
+
+   p_rarch->current_core.retro_run();
+
+   cbs->poll_cb                           = old_poll_function;
+   p_rarch->current_core.retro_set_input_poll(cbs->poll_cb);
+}
+
+/* Compares freshly polled input against the values the core
+ * read on the previous frame. Only entries the core has
+ * queried before are considered. */
+static bool runahead_input_changed(struct rarch_state *p_rarch)
+{
+   int i;
+   unsigned id;
+
+   if (     !p_rarch->input_state_list
+         || !p_rarch->input_state_callback_original)
+      return true;
+
+   for (i = 0; i < p_rarch->input_state_list->size; i++)
+   {
+      input_list_element *element =
+         (input_list_element*)p_rarch->input_state_list->data[i];
+
+      for (id = 0; id < element->state_size; id++)
+      {
+         if (p_rarch->input_state_callback_original(
+                  element->port, element->device,
+                  element->index, id) != element->state[id])
+            return true;
+      }
+   }
+
+   return false;
+}
+
+/* Puts the core back on the real frame at runahead_ring_tail */
+static bool runahead_ring_load_real(struct rarch_state *p_rarch)
+{
+   if (!runahead_load_state_slot(p_rarch, p_rarch->runahead_ring_tail))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      return false;
+   }
+
+   return true;
+}
+
+/* Single-instance runahead, backed by a ring of
+ * (runahead_count + 1) savestates.
+ *
+ * The ring holds the state of the last 'real' frame at
+ * runahead_ring_tail, followed by the speculative frames
+ * the core has already run ahead with. While input stays
+ * the same the speculative frames are correct, so only one
+ * new frame has to be run and saved. When input changes,
+ * we re-simulate from the real frame.
+ *
+ * Either way the core is left on the real frame, as
+ * everything after core_run() in the runloop (cheevos,
+ * cheats, memory watch, rewind, autosave) expects. */
+static bool runahead_ring_run(struct rarch_state *p_rarch,
+      int runahead_count)
+{
+   int frame_number;
+   int slot;
+   int ring_size = runahead_count + 1;
+
+   if (p_rarch->runahead_ring_size != ring_size)
+   {
+      mylist_resize(p_rarch->runahead_save_state_list, 0, false);
+      mylist_resize(p_rarch->runahead_save_state_list, ring_size, true);
+      p_rarch->runahead_ring_size  = ring_size;
+      p_rarch->runahead_ring_tail  = 0;
+      p_rarch->runahead_ring_count = 0;
+   }
+
+   /* The core was reset or had a state loaded behind our back;
+    * the current core state becomes the new 'real' frame. */
+   if (p_rarch->input_is_dirty)
+      p_rarch->runahead_ring_count = 0;
+
+   input_driver_poll();
+
+   /* Cheats write into the real frame after every run, which
+    * the speculative frames in the ring haven't seen */
+   if (     p_rarch->runahead_ring_count == ring_size
+         && !p_rarch->runahead_force_input_dirty
+#ifdef HAVE_CHEATS
+         && !cheat_manager_has_retro_cheats()
+#endif
+         && !runahead_input_changed(p_rarch))
+   {
+      /* Steady input - the next 'real' frame is already in the
+       * ring, only extend the speculative frames by one */
+      slot                         = p_rarch->runahead_ring_tail;
+
+      if (!runahead_load_state_slot(p_rarch,
+               (slot + ring_size - 1) % ring_size))
+      {
+         runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         return false;
+      }
+
+      runahead_core_run_use_last_input(p_rarch);
+
+      if (!runahead_save_state_slot(p_rarch, slot))
+      {
+         runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         return false;
+      }
+
+      p_rarch->runahead_ring_tail  = (slot + 1) % ring_size;
+      p_rarch->input_is_dirty      = false;
+      return runahead_ring_load_real(p_rarch);
+   }
+
+   /* The core is already on the real frame, either left there
+    * by the previous run or set by a reset or state load */
+   if (p_rarch->runahead_ring_count > 0)
+      p_rarch->runahead_ring_tail  = (p_rarch->runahead_ring_tail + 1)
+         % ring_size;
+   else
+      p_rarch->runahead_ring_tail  = 0;
+
+   p_rarch->runahead_ring_count    = 0;
+
+   for (frame_number = 0; frame_number <= runahead_count; frame_number++)
+   {
+      bool last_frame              = frame_number == runahead_count;
+
+      if (!last_frame)
+      {
+         p_rarch->audio_suspended     = true;
+         p_rarch->video_driver_active = false;
+      }
+
+      if (frame_number == 0)
+         runahead_core_run_no_poll(p_rarch);
+      else
+         runahead_core_run_use_last_input(p_rarch);
+
+      if (!last_frame)
+      {
+         RUNAHEAD_RESUME_VIDEO(p_rarch);
+         p_rarch->audio_suspended     = false;
+      }
+
+      slot = (p_rarch->runahead_ring_tail + frame_number) % ring_size;
+
+      if (!runahead_save_state_slot(p_rarch, slot))
+      {
+         runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         return false;
+      }
+
+      p_rarch->runahead_ring_count++;
+   }
+
+   p_rarch->input_is_dirty         = false;
+   return runahead_ring_load_real(p_rarch);
+}
+
+/* Run-ahead calibration.
+ *
+ * From a savestate of the running content, the core is
+ * run for a number of frames without input and then again
+ * with one button held from the first frame on. The first
+ * frame whose output differs between both runs tells how
+ * many frames of lag run-ahead can remove. Frames are
+ * compared by hash, so only software rendered frames can
+ * be used. */
+
+static void runahead_calibrate_frame(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+   unsigned y;
+   size_t row_size;
+   uint32_t crc;
+   struct rarch_state *p_rarch = &rarch_st;
+
+   /* Duped frames keep the hash of the previous frame */
+   if (!data)
+      return;
+
+   if (data == RETRO_HW_FRAME_BUFFER_VALID)
+   {
+      p_rarch->runahead_calibrate_hw_frame = true;
+      return;
+   }
+
+   row_size = width *
+      ((p_rarch->video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+       ? sizeof(uint32_t) : sizeof(uint16_t));
+   crc      = encoding_crc32(0, (const uint8_t*)&width, sizeof(width));
+   crc      = encoding_crc32(crc, (const uint8_t*)&height, sizeof(height));
+
+   for (y = 0; y < height; y++)
+      crc = encoding_crc32(crc, (const uint8_t*)data + y * pitch, row_size);
+
+   p_rarch->runahead_calibrate_crc = crc;
+}
+
+static void runahead_calibrate_sample(int16_t left, int16_t right) { }
+
+static size_t runahead_calibrate_sample_batch(
+      const int16_t *data, size_t frames)
+{
+   return frames;
+}
+
+static int16_t runahead_calibrate_input_state(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   unsigned button = rarch_st.runahead_calibrate_button;
+
+   if (     (port != 0)
+         || ((device & RETRO_DEVICE_MASK) != RETRO_DEVICE_JOYPAD)
+         || (button == RUNAHEAD_CALIBRATE_NO_BUTTON))
+      return 0;
+
+   if (id == RETRO_DEVICE_ID_JOYPAD_MASK)
+      return (int16_t)(1 << button);
+   return (id == button) ? 1 : 0;
+}
+
+/* Loads 'state' and runs 'num_frames' frames holding
+ * 'button', recording the hash of every frame */
+static bool runahead_calibrate_run(struct rarch_state *p_rarch,
+      const retro_ctx_serialize_info_t *state, unsigned button,
+      uint32_t *hashes, unsigned num_frames)
+{
+   unsigned i;
+
+   if (!p_rarch->current_core.retro_unserialize(
+            state->data_const, state->size))
+      return false;
+
+   p_rarch->runahead_calibrate_button = button;
+   p_rarch->runahead_calibrate_crc    = 0;
+
+   for (i = 0; i < num_frames; i++)
+   {
+      p_rarch->current_core.retro_run();
+      hashes[i] = p_rarch->runahead_calibrate_crc;
+   }
+
+   return true;
+}
+
+/* Measures the input lag of the running content.
+ * Returns false if it could not be measured, otherwise
+ * 'frames' is set to the number of lag frames (0 if
+ * input shows on the very frame it was read). */
+static bool runahead_calibrate(struct rarch_state *p_rarch,
+      unsigned *frames)
+{
+   static const unsigned buttons[] = {
+      RETRO_DEVICE_ID_JOYPAD_B,
+      RETRO_DEVICE_ID_JOYPAD_A,
+      RETRO_DEVICE_ID_JOYPAD_Y,
+      RETRO_DEVICE_ID_JOYPAD_X,
+      RETRO_DEVICE_ID_JOYPAD_RIGHT,
+      RETRO_DEVICE_ID_JOYPAD_LEFT,
+      RETRO_DEVICE_ID_JOYPAD_UP,
+      RETRO_DEVICE_ID_JOYPAD_DOWN,
+      RETRO_DEVICE_ID_JOYPAD_START,
+      RETRO_DEVICE_ID_JOYPAD_SELECT,
+      RETRO_DEVICE_ID_JOYPAD_L,
+      RETRO_DEVICE_ID_JOYPAD_R
+   };
+   unsigned i, f;
+   retro_ctx_size_info_t size_info;
+   retro_ctx_serialize_info_t state;
+   uint32_t baseline[RUNAHEAD_CALIBRATE_MAX_FRAMES + 1];
+   uint32_t hashes[RUNAHEAD_CALIBRATE_MAX_FRAMES + 1];
+   struct retro_callbacks *cbs = &p_rarch->retro_ctx;
+   unsigned num_frames         = RUNAHEAD_CALIBRATE_MAX_FRAMES + 1;
+   unsigned lag                = num_frames;
+   bool okay                   = false;
+   void *data                  = NULL;
+
+#ifdef HAVE_NETWORKING
+   if (netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
+      return false;
+#endif
+
+   size_info.size = 0;
+   core_serialize_size(&size_info);
+
+   if (     !size_info.size
+         || !(data = malloc(size_info.size)))
+      return false;
+
+   state.data       = data;
+   state.data_const = data;
+   state.size       = size_info.size;
+
+   p_rarch->request_fast_savestate = true;
+   if (!core_serialize(&state))
+      goto end;
+
+   p_rarch->runahead_calibrate_hw_frame = false;
+   p_rarch->current_core.retro_set_video_refresh(runahead_calibrate_frame);
+   p_rarch->current_core.retro_set_audio_sample(runahead_calibrate_sample);
+   p_rarch->current_core.retro_set_audio_sample_batch(
+         runahead_calibrate_sample_batch);
+   p_rarch->current_core.retro_set_input_poll(retro_input_poll_null);
+   p_rarch->current_core.retro_set_input_state(
+         runahead_calibrate_input_state);
+
+   /* Without input, the output has to be the same on
+    * every run - only frames up to the first difference
+    * can be compared */
+   if (     !runahead_calibrate_run(p_rarch, &state,
+            RUNAHEAD_CALIBRATE_NO_BUTTON, baseline, num_frames)
+         || !runahead_calibrate_run(p_rarch, &state,
+            RUNAHEAD_CALIBRATE_NO_BUTTON, hashes, num_frames))
+      goto restore;
+
+   for (f = 0; f < num_frames; f++)
+      if (hashes[f] != baseline[f])
+         break;
+   num_frames = f;
+   lag        = num_frames;
+
+   if (p_rarch->runahead_calibrate_hw_frame)
+      goto restore;
+
+   /* Games react to different buttons, the first
+    * reaction to any of them is the lag */
+   for (i = 0; (i < ARRAY_SIZE(buttons)) && (lag > 0); i++)
+   {
+      if (!runahead_calibrate_run(p_rarch, &state,
+               buttons[i], hashes, lag))
+         goto restore;
+
+      for (f = 0; f < lag; f++)
+      {
+         if (hashes[f] != baseline[f])
+         {
+            lag = f;
+            break;
+         }
+      }
+   }
+
+   okay = (lag < num_frames);
+
+restore:
+   p_rarch->current_core.retro_unserialize(state.data_const, state.size);
+
+   p_rarch->current_core.retro_set_video_refresh(cbs->frame_cb);
+   p_rarch->current_core.retro_set_audio_sample(cbs->sample_cb);
+   p_rarch->current_core.retro_set_audio_sample_batch(cbs->sample_batch_cb);
+   p_rarch->current_core.retro_set_input_poll(cbs->poll_cb);
+   p_rarch->current_core.retro_set_input_state(cbs->state_cb);
+
+   p_rarch->runahead_calibrate_button  = RUNAHEAD_CALIBRATE_NO_BUTTON;
+   p_rarch->runahead_force_input_dirty = true;
+
+end:
+   p_rarch->request_fast_savestate = false;
+   free(data);
+
+   if (okay)
+      *frames = lag;
+   return okay;
+}
+
 static void do_runahead(
       struct rarch_state *p_rarch,
       int runahead_count,
@@ -34074,8 +38578,6 @@ static void do_runahead(
       bool use_secondary)
 {
    int frame_number        = 0;
-   bool last_frame         = false;
-   bool suspended_frame    = false;
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    const bool have_dynamic = true;
 #else
@@ -34107,48 +38609,8 @@ static void do_runahead(
          || !have_dynamic
          || !p_rarch->runahead_secondary_core_available)
    {
-      /* TODO: multiple savestates for higher performance
-       * when not using secondary core */
-      for (frame_number = 0; frame_number <= runahead_count; frame_number++)
-      {
-         last_frame      = frame_number == runahead_count;
-         suspended_frame = !last_frame;
-
-         if (suspended_frame)
-         {
-            p_rarch->audio_suspended     = true;
-            p_rarch->video_driver_active = false;
-         }
-
-         if (frame_number == 0)
-            core_run();
-         else
-            runahead_core_run_use_last_input(p_rarch);
-
-         if (suspended_frame)
-         {
-            RUNAHEAD_RESUME_VIDEO(p_rarch);
-            p_rarch->audio_suspended     = false;
-         }
-
-         if (frame_number == 0)
-         {
-            if (!runahead_save_state(p_rarch))
-            {
-               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-               return;
-            }
-         }
-
-         if (last_frame)
-         {
-            if (!runahead_load_state(p_rarch))
-            {
-               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-               return;
-            }
-         }
-      }
+      if (!runahead_ring_run(p_rarch, runahead_count))
+         return;
    }
    else
    {
@@ -34161,6 +38623,10 @@ static void do_runahead(
          goto force_input_dirty;
       }
 
+      /* The savestate ring is only used by single-instance
+       * runahead, rebuild it when switching back */
+      p_rarch->runahead_ring_size      = 0;
+
       /* run main core with video suspended */
       p_rarch->video_driver_active     = false;
       core_run();
@@ -34345,12 +38811,15 @@ static void retroarch_print_help(const char *arg0)
    printf("Usage: %s [OPTIONS]... [FILE]\n", arg0);
 
    {
-      char buf[2148];
+      char buf[2560];
       buf[0] = '\0';
 
       strlcpy(buf, "  -h, --help            Show this help message.\n", sizeof(buf));
       strlcat(buf, "  -v, --verbose         Verbose logging.\n",        sizeof(buf));
       strlcat(buf, "      --log-file FILE   Log messages to FILE.\n",   sizeof(buf));
+      strlcat(buf, "      --startup-trace FILE\n"
+            "                        Write the time taken by each stage of startup\n"
+            "                        to FILE as a Chrome trace.\n", sizeof(buf));
       strlcat(buf, "      --version         Show version.\n",           sizeof(buf));
       strlcat(buf, "      --features        Prints available features compiled into "
             "program.\n", sizeof(buf));
@@ -34478,6 +38947,15 @@ static void retroarch_print_help(const char *arg0)
       strlcat(buf, "      --max-frames=NUMBER\n"
             "                        Runs for the specified number of frames, "
             "then exits.\n", sizeof(buf));
+      strlcat(buf, "      --benchmark=FILE\n"
+            "                        Runs uncapped for max-frames (default 3000) "
+            "frames,\n"
+            "                        then writes frame time statistics to FILE.\n", sizeof(buf));
+      strlcat(buf, "      --headless        Runs without video, audio or menu, taking "
+            "RUN_JOB\n"
+            "                        commands on 127.0.0.1. Cores are taken from the "
+            "cores\n"
+            "                        directory, results go to job_directory.\n", sizeof(buf));
 #ifdef HAVE_SCREENSHOTS
       strlcat(buf, "      --max-frames-ss\n"
             "                        Takes a screenshot at the end of max-frames.\n", sizeof(buf));
@@ -34571,6 +39049,9 @@ static bool retroarch_parse_input_and_config(
       { "log-file",           1, NULL, RA_OPT_LOG_FILE },
       { "accessibility",      0, NULL, RA_OPT_ACCESSIBILITY},
       { "load-menu-on-error", 0, NULL, RA_OPT_LOAD_MENU_ON_ERROR },
+      { "startup-trace",      1, NULL, RA_OPT_STARTUP_TRACE },
+      { "benchmark",          1, NULL, RA_OPT_BENCHMARK },
+      { "headless",           0, NULL, RA_OPT_HEADLESS },
       { NULL, 0, NULL, 0 }
    };
 
@@ -35138,6 +39619,20 @@ static bool retroarch_parse_input_and_config(
             case RA_OPT_LOAD_MENU_ON_ERROR:
                global->cli_load_menu_on_error = true;
                break;
+
+            case RA_OPT_STARTUP_TRACE:
+               strlcpy(p_rarch->startup_trace_path, optarg,
+                     sizeof(p_rarch->startup_trace_path));
+               break;
+
+            case RA_OPT_BENCHMARK:
+               strlcpy(p_rarch->benchmark_path, optarg,
+                     sizeof(p_rarch->benchmark_path));
+               break;
+
+            case RA_OPT_HEADLESS:
+               p_rarch->headless = true;
+               break;
             default:
                RARCH_ERR("%s\n", msg_hash_to_str(MSG_ERROR_PARSING_ARGUMENTS));
                retroarch_fail(p_rarch, 1, "retroarch_parse_input()");
@@ -35148,10 +39643,17 @@ static bool retroarch_parse_input_and_config(
    verbosity_enabled = verbosity_is_enabled();
 
    if (verbosity_enabled)
+   {
       rarch_log_file_init(
             p_rarch->configuration_settings->bools.log_to_file,
             p_rarch->configuration_settings->bools.log_to_file_timestamp,
             p_rarch->configuration_settings->paths.log_dir);
+      verbosity_set_async(
+            p_rarch->configuration_settings->bools.log_async);
+   }
+
+   retroarch_set_vfs_read_cache(
+         p_rarch->configuration_settings->uints.vfs_read_block_size);
 
 #ifdef HAVE_GIT_VERSION
    RARCH_LOG("RetroArch %s (Git %s)\n",
@@ -35212,6 +39714,12 @@ static bool retroarch_parse_input_and_config(
          path_is_directory(global->name.savestate))
       dir_set(RARCH_DIR_SAVESTATE, global->name.savestate);
 
+   if (!string_is_empty(p_rarch->benchmark_path))
+      retroarch_benchmark_init(p_rarch, p_rarch->configuration_settings);
+
+   if (p_rarch->headless)
+      retroarch_headless_init(p_rarch->configuration_settings);
+
    return verbosity_enabled;
 }
 
@@ -35380,6 +39888,74 @@ static void input_mapper_reset(input_mapper_t *handle)
  *
  * Returns: true on success, otherwise false if there was an error.
  **/
+#ifdef HAVE_THREADS
+/* Sets the CPU affinity and priority of each thread role
+ * from the configuration, and applies the main thread's
+ * one right away - all other threads pick theirs up
+ * when they are created */
+static void retroarch_init_thread_policies(settings_t *settings)
+{
+   unsigned i;
+   uint64_t big_cores    = 0;
+   uint64_t little_cores = 0;
+   bool has_classes      = cpu_features_get_core_classes(
+         &big_cores, &little_cores);
+   const enum sthread_role roles[] =
+   {
+      STHREAD_ROLE_MAIN,
+      STHREAD_ROLE_VIDEO,
+      STHREAD_ROLE_AUDIO,
+      STHREAD_ROLE_TASK,
+      STHREAD_ROLE_RECORD
+   };
+   const unsigned affinity[] =
+   {
+      settings->uints.thread_affinity_main,
+      settings->uints.thread_affinity_video,
+      settings->uints.thread_affinity_audio,
+      settings->uints.thread_affinity_task,
+      settings->uints.thread_affinity_record
+   };
+   const unsigned priority[] =
+   {
+      settings->uints.thread_priority_main,
+      settings->uints.thread_priority_video,
+      settings->uints.thread_priority_audio,
+      settings->uints.thread_priority_task,
+      settings->uints.thread_priority_record
+   };
+
+   for (i = 0; i < ARRAY_SIZE(roles); i++)
+   {
+      sthread_policy_t policy;
+
+      policy.cpu_mask = 0;
+      policy.priority = 0;
+
+      /* Without big/little cores (or without knowing them),
+       * any core will do */
+      if (has_classes && little_cores)
+      {
+         if (affinity[i] == 1)
+            policy.cpu_mask = big_cores;
+         else if (affinity[i] == 2)
+            policy.cpu_mask = little_cores;
+      }
+
+      if (priority[i] == 1)
+         policy.priority = 1;
+      else if (priority[i] == 2)
+         policy.priority = -1;
+
+      sthread_set_role_policy(roles[i], &policy);
+   }
+
+   if (     (affinity[0] || priority[0])
+         && !sthread_apply_role(STHREAD_ROLE_MAIN))
+      RARCH_WARN("[Threads]: Could not apply CPU affinity/priority to the main thread.\n");
+}
+#endif
+
 bool retroarch_main_init(int argc, char *argv[])
 {
 #if defined(DEBUG) && defined(HAVE_DRMINGW)
@@ -35392,11 +39968,16 @@ bool retroarch_main_init(int argc, char *argv[])
    global_t            *global  = &p_rarch->g_extern;
    bool accessibility_enable    = false;
    unsigned accessibility_narrator_speech_speed = 0;
+   retro_time_t init_start      = cpu_features_get_time_usec();
+   retro_time_t stage_start     = init_start;
 
    p_rarch->osk_idx             = OSK_LOWERCASE_LATIN;
    p_rarch->video_driver_active = true;
    p_rarch->audio_driver_active = true;
 
+   if (!p_rarch->startup_trace_base)
+      p_rarch->startup_trace_base = init_start;
+
    if (setjmp(p_rarch->error_sjlj_context) > 0)
    {
       RARCH_ERR("%s: \"%s\"\n",
@@ -35411,6 +39992,12 @@ bool retroarch_main_init(int argc, char *argv[])
 
    verbosity_enabled = retroarch_parse_input_and_config(p_rarch, &p_rarch->g_extern, argc, argv);
 
+   retroarch_startup_trace(p_rarch, "Configuration", &stage_start);
+
+#ifdef HAVE_THREADS
+   retroarch_init_thread_policies(settings);
+#endif
+
 #ifdef HAVE_ACCESSIBILITY
    accessibility_enable                = settings->bools.accessibility_enable;
    accessibility_narrator_speech_speed = settings->uints.accessibility_narrator_speech_speed;
@@ -35482,6 +40069,8 @@ bool retroarch_main_init(int argc, char *argv[])
    retroarch_validate_cpu_features(p_rarch);
    retroarch_init_task_queue();
 
+   retroarch_startup_trace(p_rarch, "Task queue", &stage_start);
+
    {
       const char    *fullpath  = path_get(RARCH_PATH_CONTENT);
 
@@ -35552,6 +40141,8 @@ bool retroarch_main_init(int argc, char *argv[])
          "menu driver", verbosity_enabled);
 #endif
 
+   retroarch_startup_trace(p_rarch, "Driver lookup", &stage_start);
+
    /* Attempt to initialize core */
    if (p_rarch->has_set_core)
    {
@@ -35594,7 +40185,13 @@ bool retroarch_main_init(int argc, char *argv[])
                              settings->paths.path_cheat_database,
                              p_rarch);
 #endif
+
+   retroarch_startup_trace(p_rarch, "Core", &stage_start);
+
    drivers_init(p_rarch, settings, DRIVERS_CMD_ALL, verbosity_enabled);
+
+   retroarch_startup_trace(p_rarch, "Drivers", &stage_start);
+
 #ifdef HAVE_COMMAND
    input_driver_deinit_command(p_rarch);
    input_driver_init_command(p_rarch, settings);
@@ -35621,6 +40218,12 @@ bool retroarch_main_init(int argc, char *argv[])
 
    command_event(CMD_EVENT_SET_PER_GAME_RESOLUTION, NULL);
 
+   retroarch_startup_trace(p_rarch, "Input, rewind and save files",
+         &stage_start);
+
+   stage_start = init_start;
+   retroarch_startup_trace(p_rarch, "Total", &stage_start);
+
    p_rarch->rarch_error_on_init     = false;
    p_rarch->rarch_is_inited         = true;
 
@@ -36173,6 +40776,34 @@ static void rarch_init_core_options(
             core_option_manager_new(options_path, src_options_path, option_defs);
 }
 
+static void retroarch_trace_finished(bool written)
+{
+   char msg[PATH_MAX_LENGTH + 32];
+
+   if (written)
+      snprintf(msg, sizeof(msg), "%s \"%s\"",
+            msg_hash_to_str(MSG_TRACE_WRITTEN), perf_trace_get_path());
+   else
+      strlcpy(msg, msg_hash_to_str(MSG_TRACE_FAILED), sizeof(msg));
+
+   runloop_msg_queue_push(msg, 1, 180, false,
+         NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+}
+
+static void retroarch_task_trace_cb(retro_task_t *task, bool begin)
+{
+   if (!perf_trace_is_active())
+      return;
+
+   if (begin)
+   {
+      perf_trace_set_thread_name("task worker");
+      perf_trace_begin(task->title ? task->title : "task");
+   }
+   else
+      perf_trace_end();
+}
+
 void retroarch_init_task_queue(void)
 {
 #ifdef HAVE_THREADS
@@ -36183,8 +40814,32 @@ void retroarch_init_task_queue(void)
    bool threaded_enable        = false;
 #endif
 
+   playlist_write_deferred_flush();
    task_queue_deinit();
+#ifdef HAVE_THREADS
+   {
+      /* Network bound tasks keep a second worker busy
+       * even on single core devices */
+      unsigned cores           = cpu_features_get_core_amount();
+      task_queue_set_worker_count(cores < 2 ? 2 : (cores > 4 ? 4 : cores));
+      /* Callers of the shared pool help out while they wait,
+       * so one core is left to them */
+      if (cores > 1)
+         tpool_shared_init(cores - 1);
+   }
+#endif
+   perf_trace_init();
+   task_queue_set_trace_cb(retroarch_task_trace_cb);
    task_queue_init(threaded_enable, runloop_task_msg_queue_push);
+#ifdef HAVE_NETWORKING
+   net_http_pool_init();
+#endif
+#ifdef HAVE_COMPRESSION
+   file_archive_directory_cache_init();
+#ifdef HAVE_7ZIP
+   file_archive_extract_cache_init();
+#endif
+#endif
 }
 
 bool rarch_ctl(enum rarch_ctl_state state, void *data)
@@ -36386,6 +41041,9 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
          retroarch_audio_buffer_status_free(p_rarch);
          retroarch_game_focus_free(p_rarch);
          retroarch_fastmotion_override_free(p_rarch, &runloop_state);
+#ifdef HAVE_OVERLAY
+         input_overlay_cache_free(p_rarch);
+#endif
          break;
       case RARCH_CTL_IS_IDLE:
          return runloop_state.idle;
@@ -36816,6 +41474,8 @@ int retroarch_get_capabilities(enum rarch_capabilities type,
                strlcat(s, " AVX", len);
             if (cpu & RETRO_SIMD_AVX2)
                strlcat(s, " AVX2", len);
+            if (cpu & RETRO_SIMD_FMA)
+               strlcat(s, " FMA", len);
             if (cpu & RETRO_SIMD_NEON)
                strlcat(s, " NEON", len);
             if (cpu & RETRO_SIMD_VFPV3)
@@ -36970,6 +41630,9 @@ bool retroarch_main_quit(void)
    return true;
 }
 
+/* Posting does not take a lock, so tasks, the core and the
+ * video thread never wait on each other for a message. All
+ * of them are shown once video_driver_frame() collects them */
 void runloop_msg_queue_push(const char *msg,
       unsigned prio, unsigned duration,
       bool flush,
@@ -36977,39 +41640,46 @@ void runloop_msg_queue_push(const char *msg,
       enum message_queue_icon icon,
       enum message_queue_category category)
 {
-   struct rarch_state *p_rarch = &rarch_st;
-#if defined(HAVE_GFX_WIDGETS)
-   bool widgets_active         = p_rarch->widgets_active;
-#endif
+   msg_queue_post(&runloop_state.msg_queue, msg,
+         prio, duration, flush,
+         title, icon, category);
+}
+
+/* Hands a collected message to the widgets and the UI
+ * companion, only returning false when it belongs in the
+ * regular OSD queue */
+static bool runloop_msg_queue_collect_cb(void *data,
+      const queue_elem_t *elem)
+{
+   struct rarch_state *p_rarch = (struct rarch_state*)data;
+   unsigned duration           = elem->duration;
+   bool taken                  = false;
 #ifdef HAVE_ACCESSIBILITY
    settings_t *settings        = p_rarch->configuration_settings;
    bool accessibility_enable   = settings->bools.accessibility_enable;
    unsigned accessibility_narrator_speech_speed = settings->uints.accessibility_narrator_speech_speed;
-#endif
 
-   RUNLOOP_MSG_QUEUE_LOCK(runloop_state);
-#ifdef HAVE_ACCESSIBILITY
    if (is_accessibility_enabled(
             accessibility_enable,
             p_rarch->accessibility_enabled))
       accessibility_speak_priority(p_rarch,
             accessibility_enable,
             accessibility_narrator_speech_speed,
-            (char*) msg, 0);
+            elem->msg, 0);
 #endif
 #if defined(HAVE_GFX_WIDGETS)
-   if (widgets_active)
+   if (p_rarch->widgets_active)
    {
       gfx_widgets_msg_queue_push(
             &p_rarch->dispwidget_st,
             NULL,
-            msg,
+            elem->msg,
             roundf((float)duration / 60.0f * 1000.0f),
-            title,
-            icon,
-            category,
-            prio,
-            flush,
+            elem->title,
+            elem->icon,
+            elem->category,
+            elem->prio,
+            elem->flush,
 #ifdef HAVE_MENU
             p_rarch->menu_driver_alive
 #else
@@ -37017,25 +41687,24 @@ void runloop_msg_queue_push(const char *msg,
 #endif
             );
       duration = duration * 60 / 1000;
+      taken    = true;
    }
-   else
 #endif
-   {
-      if (flush)
-         msg_queue_clear(&runloop_state.msg_queue);
 
-      msg_queue_push(&runloop_state.msg_queue, msg,
-            prio, duration,
-            title, icon, category);
+   ui_companion_driver_msg_queue_push(p_rarch,
+         elem->msg,
+         elem->prio, duration, elem->flush);
+
+   return taken;
+}
 
+static void runloop_msg_queue_collect(struct rarch_state *p_rarch)
+{
+   RUNLOOP_MSG_QUEUE_LOCK(runloop_state);
+   if (msg_queue_collect(&runloop_state.msg_queue,
+            runloop_msg_queue_collect_cb, p_rarch))
       runloop_state.msg_queue_size = msg_queue_size(
             &runloop_state.msg_queue);
-   }
-
-   ui_companion_driver_msg_queue_push(p_rarch,
-         msg,
-         prio, duration, flush);
-
    RUNLOOP_MSG_QUEUE_UNLOCK(runloop_state);
 }
 
@@ -37217,6 +41886,67 @@ static bool menu_display_libretro(
 
    return true;
 }
+
+/* Keep drawing for a while after the last input,
+ * hover and press effects are not all animations */
+#define MENU_STATIC_INPUT_GRACE_US   250000
+/* Refresh static menus anyway, for clocks,
+ * battery level and background tasks */
+#define MENU_STATIC_REFRESH_US      1000000
+
+/**
+ * menu_driver_frame_is_static:
+ *
+ * Checks whether the menu would draw exactly what was
+ * presented last, i.e. nothing requested a redraw or left
+ * the framebuffer dirty, no animation or ticker runs, no
+ * input arrived recently, no OSD message is queued or
+ * waits to be collected and the video size did not change.
+ *
+ * Returns: true if presenting this frame can be skipped.
+ **/
+static bool menu_driver_frame_is_static(
+      struct rarch_state *p_rarch,
+      struct menu_state *menu_st,
+      menu_handle_t *menu,
+      settings_t *settings,
+      bool input_changed,
+      retro_time_t current_time)
+{
+   gfx_animation_t *p_anim = &p_rarch->anim;
+
+   if (     !settings->bools.menu_skip_static_frames
+         && !settings->bools.power_saving_mode)
+      return false;
+
+   if (     input_changed
+         || BIT64_GET(menu->state, MENU_STATE_RENDER_FRAMEBUFFER)
+         || BIT64_GET(menu->state, MENU_STATE_RENDER_MESSAGEBOX)
+         || p_rarch->dispgfx.framebuf_dirty
+         || ANIM_IS_ACTIVE(p_anim)
+         || menu_st->screensaver_active
+         || runloop_state.msg_queue_size > 0
+         || msg_queue_has_posted(&runloop_state.msg_queue))
+      return false;
+
+   if (     current_time - menu_st->input_last_time_us
+            < MENU_STATIC_INPUT_GRACE_US
+         || current_time - menu_st->present_last_time_us
+            >= MENU_STATIC_REFRESH_US)
+      return false;
+
+   if (     menu_st->present_width  != p_rarch->video_driver_width
+         || menu_st->present_height != p_rarch->video_driver_height)
+      return false;
+
+   /* The XMB shader backgrounds move every frame */
+   if (     p_rarch->dispgfx.menu_driver_id == MENU_DRIVER_ID_XMB
+         && settings->uints.menu_xmb_shader_pipeline
+            != XMB_SHADER_PIPELINE_WALLPAPER)
+      return false;
+
+   return true;
+}
 #endif
 
 static enum runloop_state runloop_check_state(
@@ -37858,7 +42588,37 @@ static enum runloop_state runloop_check_state(
                if (menu_display_libretro(p_rarch,
                         settings->floats.slowmotion_ratio,
                         libretro_running, current_time))
-                  video_driver_cached_frame();
+               {
+                  if (menu_driver_frame_is_static(p_rarch, menu_st,
+                           menu, settings,
+                           memcmp(&current_bits, &old_input,
+                              sizeof(current_bits)) != 0,
+                           current_time))
+                  {
+                     /* Nothing to present, wait about as
+                      * long as a vsynced swap would have */
+                     float refresh_rate = settings->floats.video_refresh_rate;
+                     retroarch_sleep(p_rarch, refresh_rate > 1.0f
+                           ? (unsigned)(1000.0f / refresh_rate) : 16);
+                  }
+                  else
+                  {
+                     video_driver_cached_frame();
+
+                     if (     settings->bools.menu_skip_static_frames
+                           || settings->bools.power_saving_mode)
+                     {
+                        /* Presented, the menu is up to date
+                         * until something changes again */
+                        p_rarch->dispgfx.framebuf_dirty = false;
+                        menu_st->present_last_time_us   = current_time;
+                        menu_st->present_width          =
+                           p_rarch->video_driver_width;
+                        menu_st->present_height         =
+                           p_rarch->video_driver_height;
+                     }
+                  }
+               }
 
             if (menu->driver_ctx->set_texture)
                menu->driver_ctx->set_texture(menu->userdata);
@@ -37952,7 +42712,9 @@ static enum runloop_state runloop_check_state(
       float fastforward_ratio = retroarch_get_runloop_fastforward_ratio(
             settings, &runloop_state);
 
-      if (!settings->bools.menu_throttle_framerate && !fastforward_ratio)
+      if (     !settings->bools.menu_throttle_framerate
+            && !settings->bools.power_saving_mode
+            && !fastforward_ratio)
          return RUNLOOP_STATE_MENU_ITERATE;
 
       return RUNLOOP_STATE_END;
@@ -37985,6 +42747,20 @@ static enum runloop_state runloop_check_state(
    /* Check if we have pressed the AI Service toggle button */
    HOTKEY_CHECK(RARCH_AI_SERVICE, CMD_EVENT_AI_SERVICE_TOGGLE, true, NULL);
 
+#ifdef HAVE_TRANSLATE
+   /* Auto mode found the screen unchanged, look again */
+   if (     p_rarch->ai_service.retry_time
+         && current_time >= p_rarch->ai_service.retry_time)
+   {
+      p_rarch->ai_service.retry_time = 0;
+      if (p_rarch->ai_service_auto == 2)
+         command_event(CMD_EVENT_AI_SERVICE_CALL, NULL);
+   }
+#endif
+
+   /* Check if we have pressed the trace recording toggle button */
+   HOTKEY_CHECK(RARCH_TRACE_TOGGLE, CMD_EVENT_TRACE_TOGGLE, true, NULL);
+
    if (BIT256_GET(current_bits, RARCH_VOLUME_UP))
       command_event(CMD_EVENT_VOLUME_UP, NULL);
    else if (BIT256_GET(current_bits, RARCH_VOLUME_DOWN))
@@ -38386,6 +43162,156 @@ static enum runloop_state runloop_check_state(
    return RUNLOOP_STATE_ITERATE;
 }
 
+/**
+ * runloop_frame_delay_auto:
+ * @refresh_rate       : Display refresh rate.
+ * @max_delay          : Largest delay (ms) to pick.
+ *
+ * Automatic frame delay: keeps the delay just below what is
+ * left of the frame after the p95 of the measured core_run()
+ * work, and backs off right away when a frame is missed.
+ *
+ * Returns: frame delay (ms) to apply before running the core.
+ **/
+static unsigned runloop_frame_delay_auto(struct rarch_state *p_rarch,
+      float refresh_rate, unsigned max_delay)
+{
+   unsigned samples;
+   retro_time_t work;
+   retro_time_t budget;
+   unsigned target;
+   uint64_t count = p_rarch->frame_timing_count;
+
+   if (refresh_rate <= 0.0f)
+      return p_rarch->frame_delay_auto;
+
+   budget = (retro_time_t)(1000000.0f / refresh_rate);
+
+   if (p_rarch->frame_delay_auto_holdoff)
+      p_rarch->frame_delay_auto_holdoff--;
+
+   /* A missed frame shows up as an interval
+    * well above the frame budget. The same two
+    * samples must not count as a miss twice when
+    * no frame was timed since the last backoff. */
+   if (     count >= 2
+         && count != p_rarch->frame_delay_auto_last
+         && p_rarch->frame_delay_auto)
+   {
+      const struct frame_timing_sample *prev = &p_rarch->frame_timing_samples[
+         (count - 2) & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+      const struct frame_timing_sample *last = &p_rarch->frame_timing_samples[
+         (count - 1) & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+
+      if (last->run_start && prev->run_start &&
+            last->submit - prev->submit > budget + budget / 2)
+      {
+         p_rarch->frame_delay_auto--;
+         p_rarch->frame_delay_auto_holdoff = FRAME_DELAY_AUTO_HOLDOFF;
+         p_rarch->frame_delay_auto_last    = count;
+         return p_rarch->frame_delay_auto;
+      }
+   }
+
+   if (count - p_rarch->frame_delay_auto_last < FRAME_DELAY_AUTO_INTERVAL)
+      return p_rarch->frame_delay_auto;
+   p_rarch->frame_delay_auto_last = count;
+
+   work = video_frame_timing_percentile(p_rarch,
+         FRAME_TIMING_WORK, 95, &samples);
+   if (samples < FRAME_DELAY_AUTO_INTERVAL)
+      return p_rarch->frame_delay_auto;
+
+   if (work + FRAME_DELAY_AUTO_MARGIN >= budget)
+      target = 0;
+   else
+      target = (unsigned)((budget - work - FRAME_DELAY_AUTO_MARGIN) / 1000);
+   target    = MIN(target, max_delay);
+
+   /* Go down as far as needed at once, but only creep up */
+   if (target < p_rarch->frame_delay_auto)
+      p_rarch->frame_delay_auto = target;
+   else if (target > p_rarch->frame_delay_auto
+         && !p_rarch->frame_delay_auto_holdoff)
+      p_rarch->frame_delay_auto++;
+
+   return p_rarch->frame_delay_auto;
+}
+
+#ifdef HAVE_MEMORY_WATCH
+static void core_memory_watch_deinit(struct rarch_state *p_rarch)
+{
+   if (p_rarch->memory_watch)
+      memory_watch_free(p_rarch->memory_watch);
+   p_rarch->memory_watch       = NULL;
+   p_rarch->memory_watch_tried = false;
+}
+
+/* Mirrors every writable memory map descriptor, or the
+ * core's system RAM if it does not provide a memory map. */
+static void core_memory_watch_init(struct rarch_state *p_rarch)
+{
+   unsigned i, j;
+   unsigned num_sources                = 0;
+   memory_watch_source_t *sources      = NULL;
+   const rarch_memory_map_t *mmaps     = &runloop_state.system.mmaps;
+
+   p_rarch->memory_watch_tried         = true;
+
+   if (!(sources = (memory_watch_source_t*)calloc(
+               mmaps->num_descriptors + 1, sizeof(*sources))))
+      return;
+
+   for (i = 0; i < mmaps->num_descriptors; i++)
+   {
+      const struct retro_memory_descriptor *desc =
+         &mmaps->descriptors[i].core;
+      const uint8_t *ptr = (const uint8_t*)desc->ptr;
+
+      if (!ptr || !desc->len || (desc->flags & RETRO_MEMDESC_CONST))
+         continue;
+
+      ptr += desc->offset;
+
+      /* Mirrors of the same memory only need to be copied once */
+      for (j = 0; j < num_sources; j++)
+         if (sources[j].ptr == ptr && sources[j].size == desc->len)
+            break;
+      if (j < num_sources)
+         continue;
+
+      sources[num_sources].ptr     = ptr;
+      sources[num_sources].address = desc->start;
+      sources[num_sources].flags   = desc->flags;
+      sources[num_sources].size    = desc->len;
+      num_sources++;
+   }
+
+   if (!num_sources)
+   {
+      const uint8_t *ptr = (const uint8_t*)
+         p_rarch->current_core.retro_get_memory_data(RETRO_MEMORY_SYSTEM_RAM);
+      size_t size        =
+         p_rarch->current_core.retro_get_memory_size(RETRO_MEMORY_SYSTEM_RAM);
+
+      if (ptr && size)
+      {
+         sources[0].ptr   = ptr;
+         sources[0].flags = MEMORY_WATCH_REGION_SYSTEM_RAM;
+         sources[0].size  = size;
+         num_sources      = 1;
+      }
+   }
+
+   if (num_sources)
+      p_rarch->memory_watch = memory_watch_new(sources, num_sources);
+   else
+      RARCH_WARN("[MemWatch]: Core exposes no memory to mirror.\n");
+
+   free(sources);
+}
+#endif
+
 /**
  * runloop_iterate:
  *
@@ -38395,6 +43321,96 @@ static enum runloop_state runloop_check_state(
  * button input in order to wake up the loop,
  * -1 if we forcibly quit out of the RetroArch iteration loop.
  **/
+/* Longest run of frames fast-forward frameskip
+ * may run without presenting one */
+#define FASTFORWARD_FRAMESKIP_MAX 32
+
+/* Fast-forward frameskip: with video and audio
+ * suspended, runs as many frames as fit into one
+ * display refresh (at most as many as the fast-forward
+ * ratio asks for), so that only the frame after them
+ * is presented. The number of frames adapts to the
+ * time the core actually takes.
+ * Returns the number of frames skipped. */
+static unsigned runloop_fastforward_frameskip(
+      struct rarch_state *p_rarch, settings_t *settings)
+{
+   retro_time_t start_time, budget;
+   unsigned frames          = 0;
+   unsigned max_frames      = FASTFORWARD_FRAMESKIP_MAX;
+   float refresh_rate       = settings->floats.video_refresh_rate;
+   double fps               = p_rarch->video_driver_av_info.timing.fps;
+   float fastforward_ratio  = retroarch_get_runloop_fastforward_ratio(
+         settings, &runloop_state);
+   bool video_driver_active = p_rarch->video_driver_active;
+
+   /* Frames that have to be seen, recorded or checked
+    * one by one */
+   if (     p_rarch->recording_data
+#ifdef HAVE_BSV_MOVIE
+         || p_rarch->bsv_movie_state_handle
+#endif
+#ifdef HAVE_NETWORKING
+         || netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL)
+#endif
+#ifdef HAVE_CHEEVOS
+         || settings->bools.cheevos_enable
+#endif
+         || !video_driver_active
+         || (refresh_rate <= 0.0f)
+         || (fps <= 0.0))
+      return 0;
+
+   /* Frames per refresh at the requested ratio,
+    * including the presented one */
+   if (fastforward_ratio >= 1.0f)
+   {
+      double per_refresh = (fps * fastforward_ratio) / refresh_rate;
+      if (per_refresh < FASTFORWARD_FRAMESKIP_MAX)
+         max_frames      = (unsigned)(per_refresh + 0.5);
+   }
+
+   if (max_frames <= 1)
+      return 0;
+
+   budget                       = (retro_time_t)(1000000.0f / refresh_rate);
+   start_time                   = cpu_features_get_time_usec();
+   p_rarch->audio_suspended     = true;
+   p_rarch->video_driver_active = false;
+
+   while (frames < max_frames - 1)
+   {
+      if (frames)
+      {
+         /* Stop when the next skipped frame and the
+          * presented one no longer fit */
+         retro_time_t elapsed    = cpu_features_get_time_usec() - start_time;
+         retro_time_t frame_time = elapsed / frames;
+
+         if (elapsed + 2 * frame_time > budget)
+            break;
+      }
+
+      /* Nonblocking fast-forward runs with the reference
+       * frame time, see runloop_iterate() */
+      if (runloop_state.frame_time.callback)
+         runloop_state.frame_time.callback(
+               runloop_state.frame_time.reference);
+
+      core_run();
+      frames++;
+   }
+
+   p_rarch->video_driver_active = video_driver_active;
+   p_rarch->audio_suspended     = false;
+#ifdef HAVE_RUNAHEAD
+   /* The core moved on without run-ahead seeing it */
+   p_rarch->runahead_force_input_dirty = true;
+#endif
+
+   return frames;
+}
+
 int runloop_iterate(void)
 {
    unsigned i;
@@ -38413,13 +43429,27 @@ int runloop_iterate(void)
    float slowmotion_ratio                       = settings->floats.slowmotion_ratio;
 #ifdef HAVE_CHEEVOS
    bool cheevos_enable                          = settings->bools.cheevos_enable;
+#endif
+#ifdef HAVE_MEMORY_WATCH
+   bool memory_watch_enable                     = settings->bools.memory_watch_enable;
 #endif
    bool audio_sync                              = settings->bools.audio_sync;
-
-
+   enum runloop_state runloop_status;
 #ifdef HAVE_DISCORD
    discord_state_t *discord_st                  = &p_rarch->discord_st;
+#endif
+
+   /* Commit the scope timings of the previous iteration */
+   perf_scope_frame_end();
+
+   retroarch_job_iterate(p_rarch);
+
+   p_rarch->fastforward_skipped_frames = 0;
 
+   if (perf_trace_expired(current_time))
+      retroarch_trace_finished(perf_trace_stop());
+
+#ifdef HAVE_DISCORD
    if (discord_is_inited)
    {
       Discord_RunCallbacks();
@@ -38496,8 +43526,11 @@ int runloop_iterate(void)
                audio_buf_active, audio_buf_occupancy, audio_buf_underrun);
    }
 
-   switch ((enum runloop_state)runloop_check_state(p_rarch,
-            settings, current_time))
+   PERF_SCOPE_BEGIN("check_state");
+   runloop_status = runloop_check_state(p_rarch, settings, current_time);
+   PERF_SCOPE_END();
+
+   switch (runloop_status)
    {
       case RUNLOOP_STATE_QUIT:
          p_rarch->frame_limit_last_time = 0.0;
@@ -38512,7 +43545,7 @@ int runloop_iterate(void)
 #if defined(HAVE_COCOATOUCH)
          if (!p_rarch->main_ui_companion_is_on_foreground)
 #endif
-            retro_sleep(10);
+            retroarch_sleep(p_rarch, 10);
          return 1;
       case RUNLOOP_STATE_END:
 #ifdef HAVE_NETWORKING
@@ -38543,9 +43576,14 @@ int runloop_iterate(void)
 
 #ifdef HAVE_BSV_MOVIE
    /* Used for rewinding while playback/record. */
-   if (p_rarch->bsv_movie_state_handle)
+   if (     p_rarch->bsv_movie_state_handle
+         && !p_rarch->bsv_movie_state_handle->compact)
       p_rarch->bsv_movie_state_handle->frame_pos[p_rarch->bsv_movie_state_handle->frame_ptr]
          = intfstream_tell(p_rarch->bsv_movie_state_handle->file);
+
+   /* Replay seeks catch up before the frame is run */
+   if (p_rarch->bsv_movie_state_handle)
+      bsv_movie_seek_run(p_rarch);
 #endif
 
    if (  p_rarch->camera_cb.caps &&
@@ -38605,9 +43643,24 @@ int runloop_iterate(void)
       }
    }
 
+   /* Power saving sleeps before running the core for as long
+    * as its measured run time allows, so less of the frame is
+    * spent waiting (possibly spinning) for vsync in the driver */
+   if (     settings->bools.video_frame_delay_auto
+         || settings->bools.power_saving_mode)
+      video_frame_delay = runloop_frame_delay_auto(p_rarch,
+            settings->floats.video_refresh_rate,
+            video_frame_delay ? video_frame_delay : 15);
+
    if ((video_frame_delay > 0) && !p_rarch->input_driver_nonblock_state)
-      retro_sleep(video_frame_delay);
+      retroarch_sleep(p_rarch, video_frame_delay);
 
+   p_rarch->frame_timing_run_start = cpu_features_get_time_usec();
+
+   PERF_SCOPE_BEGIN("core_run");
+   if (runloop_state.fastmotion && settings->bools.fastforward_frameskip)
+      p_rarch->fastforward_skipped_frames =
+         runloop_fastforward_frameskip(p_rarch, settings);
    {
 #ifdef HAVE_RUNAHEAD
       bool run_ahead_enabled            = settings->bools.run_ahead_enabled;
@@ -38630,6 +43683,17 @@ int runloop_iterate(void)
 #endif
          core_run();
    }
+   PERF_SCOPE_END();
+
+   /* Complete the timing of the frame presented during this run */
+   if (p_rarch->frame_timing_count)
+   {
+      struct frame_timing_sample *sample = &p_rarch->frame_timing_samples[
+         (p_rarch->frame_timing_count - 1) & (FRAME_TIMING_SAMPLES_COUNT - 1)];
+      if (sample->run_start == p_rarch->frame_timing_run_start)
+         sample->run_end = cpu_features_get_time_usec();
+   }
+   p_rarch->frame_timing_run_start = 0;
 
    /* Increment runtime tick counter after each call to
     * core_run() or run_ahead() */
@@ -38645,6 +43709,18 @@ int runloop_iterate(void)
 #ifdef HAVE_CHEATS
    cheat_manager_apply_retro_cheats();
 #endif
+#ifdef HAVE_MEMORY_WATCH
+   if (memory_watch_enable)
+   {
+      if (!p_rarch->memory_watch_tried)
+         core_memory_watch_init(p_rarch);
+      if (p_rarch->memory_watch)
+         memory_watch_update(p_rarch->memory_watch,
+               p_rarch->video_driver_frame_count);
+   }
+   else if (p_rarch->memory_watch_tried)
+      core_memory_watch_deinit(p_rarch);
+#endif
 #ifdef HAVE_DISCORD
    if (discord_is_inited && discord_st->ready)
       discord_update(DISCORD_PRESENCE_GAME);
@@ -38672,15 +43748,7 @@ int runloop_iterate(void)
 
 #ifdef HAVE_BSV_MOVIE
    if (p_rarch->bsv_movie_state_handle)
-   {
-      p_rarch->bsv_movie_state_handle->frame_ptr    =
-         (p_rarch->bsv_movie_state_handle->frame_ptr + 1)
-         & p_rarch->bsv_movie_state_handle->frame_mask;
-
-      p_rarch->bsv_movie_state_handle->first_rewind =
-         !p_rarch->bsv_movie_state_handle->did_rewind;
-      p_rarch->bsv_movie_state_handle->did_rewind   = false;
-   }
+      bsv_movie_frame_end(p_rarch->bsv_movie_state_handle);
 #endif
 
 #ifdef HAVE_THREADS
@@ -38734,23 +43802,30 @@ end:
    if (p_rarch->frame_limit_minimum_time)
    {
       const retro_time_t end_frame_time = cpu_features_get_time_usec();
-      const retro_time_t to_sleep_ms = (
-            (p_rarch->frame_limit_last_time + p_rarch->frame_limit_minimum_time)
-            - end_frame_time) / 1000;
+      /* Skipped fast-forward frames count towards the limit */
+      const retro_time_t deadline       = p_rarch->frame_limit_last_time
+         + p_rarch->frame_limit_minimum_time
+         * (1 + p_rarch->fastforward_skipped_frames);
 
-      if (to_sleep_ms > 0)
+      if (deadline > end_frame_time)
       {
-         unsigned               sleep_ms = (unsigned)to_sleep_ms;
-
          /* Combat jitter a bit. */
-         p_rarch->frame_limit_last_time += p_rarch->frame_limit_minimum_time;
+         p_rarch->frame_limit_last_time = deadline;
 
-         if (sleep_ms > 0)
-         {
 #if defined(HAVE_COCOATOUCH)
-            if (!p_rarch->main_ui_companion_is_on_foreground)
+         if (!p_rarch->main_ui_companion_is_on_foreground)
 #endif
-               retro_sleep(sleep_ms);
+         {
+            /* Variable refresh displays show frames when they are
+             * presented, so pace them to the exact content rate
+             * - unless saving power, which never spins */
+            if (     vrr_runloop_enable
+                  && !runloop_state.fastmotion
+                  && !settings->bools.power_saving_mode)
+               retroarch_sleep_until(p_rarch, deadline);
+            else if (deadline - end_frame_time >= 1000)
+               retroarch_sleep(p_rarch,
+                     (unsigned)((deadline - end_frame_time) / 1000));
          }
 
          return 1;
@@ -38922,30 +43997,6 @@ static void retro_frame_null(const void *data, unsigned width,
       unsigned height, size_t pitch) { }
 static void retro_input_poll_null(void) { }
 
-static int16_t core_input_state_poll_late(unsigned port,
-      unsigned device, unsigned idx, unsigned id)
-{
-   struct rarch_state *p_rarch = &rarch_st;
-   if (!p_rarch->current_core.input_polled)
-      input_driver_poll();
-   p_rarch->current_core.input_polled = true;
-
-   return input_state(port, device, idx, id);
-}
-
-static retro_input_state_t core_input_state_poll_return_cb(void)
-{
-   struct rarch_state *p_rarch = &rarch_st;
-   const enum poll_type_override_t
-      core_poll_type_override  = p_rarch->core_poll_type_override;
-   unsigned new_poll_type      = (core_poll_type_override > POLL_TYPE_OVERRIDE_DONTCARE)
-      ? (core_poll_type_override - 1)
-      : p_rarch->current_core.poll_type;
-   if (new_poll_type == POLL_TYPE_LATE)
-      return core_input_state_poll_late;
-   return input_state;
-}
-
 static void core_input_state_poll_maybe(void)
 {
    struct rarch_state *p_rarch = &rarch_st;
@@ -38969,12 +44020,10 @@ static bool core_init_libretro_cbs(
       struct rarch_state *p_rarch,
       struct retro_callbacks *cbs)
 {
-   retro_input_state_t state_cb = core_input_state_poll_return_cb();
-
    p_rarch->current_core.retro_set_video_refresh(video_driver_frame);
    p_rarch->current_core.retro_set_audio_sample(audio_driver_sample);
    p_rarch->current_core.retro_set_audio_sample_batch(audio_driver_sample_batch);
-   p_rarch->current_core.retro_set_input_state(state_cb);
+   p_rarch->current_core.retro_set_input_state(input_state);
    p_rarch->current_core.retro_set_input_poll(core_input_state_poll_maybe);
 
    core_set_default_callbacks(cbs);
@@ -38997,12 +44046,10 @@ static bool core_init_libretro_cbs(
  **/
 static bool core_set_default_callbacks(struct retro_callbacks *cbs)
 {
-   retro_input_state_t state_cb = core_input_state_poll_return_cb();
-
    cbs->frame_cb        = video_driver_frame;
    cbs->sample_cb       = audio_driver_sample;
    cbs->sample_batch_cb = audio_driver_sample_batch;
-   cbs->state_cb        = state_cb;
+   cbs->state_cb        = input_state;
    cbs->poll_cb         = input_driver_poll;
 
    return true;
@@ -39155,6 +44202,20 @@ bool core_load_game(retro_ctx_load_content_info_t *load_info)
 
    p_rarch->current_core.game_loaded = game_loaded;
 
+#ifdef HAVE_MEMORY_TAGS
+   /* The core owns these, but they are what it
+    * costs beyond its code and static data */
+   if (game_loaded)
+   {
+      p_rarch->core_memory_tagged =
+           p_rarch->current_core.retro_get_memory_size(RETRO_MEMORY_SAVE_RAM)
+         + p_rarch->current_core.retro_get_memory_size(RETRO_MEMORY_RTC)
+         + p_rarch->current_core.retro_get_memory_size(RETRO_MEMORY_SYSTEM_RAM)
+         + p_rarch->current_core.retro_get_memory_size(RETRO_MEMORY_VIDEO_RAM);
+      memory_tag_add(MEMORY_TAG_CORE, (int64_t)p_rarch->core_memory_tagged);
+   }
+#endif
+
    return game_loaded;
 }
 
@@ -39215,6 +44276,10 @@ bool core_reset(void)
 
 static bool core_unload_game(struct rarch_state *p_rarch)
 {
+#ifdef HAVE_MEMORY_WATCH
+   core_memory_watch_deinit(p_rarch);
+#endif
+
    video_driver_free_hw_context(p_rarch);
 
    video_driver_set_cached_frame_ptr(NULL);
@@ -39227,6 +44292,11 @@ static bool core_unload_game(struct rarch_state *p_rarch)
       p_rarch->current_core.game_loaded = false;
    }
 
+#ifdef HAVE_MEMORY_TAGS
+   memory_tag_add(MEMORY_TAG_CORE, -(int64_t)p_rarch->core_memory_tagged);
+   p_rarch->core_memory_tagged = 0;
+#endif
+
    audio_driver_stop(p_rarch);
 
    return true;
@@ -39261,13 +44331,18 @@ bool core_run(void)
 
    if (early_polling)
       input_driver_poll();
-   else if (late_polling)
-      current_core->input_polled = false;
+
+   /* With late polling, the first input_state() call of
+    * the frame does the poll, see input_state(). */
+   current_core->input_polled = !late_polling;
 
    current_core->retro_run();
 
-   if (late_polling && !current_core->input_polled)
+   if (!current_core->input_polled)
+   {
       input_driver_poll();
+      current_core->input_polled = true;
+   }
 
 #ifdef HAVE_NETWORKING
    netplay_driver_ctl(RARCH_NETPLAY_CTL_POST_FRAME, NULL);
@@ -39301,6 +44376,7 @@ static bool core_load(
       unsigned poll_type_behavior)
 {
    p_rarch->current_core.poll_type      = poll_type_behavior;
+   p_rarch->current_core.input_polled   = true;
 
    if (!core_verify_api_version(p_rarch))
       return false;
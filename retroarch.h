@@ -347,6 +347,27 @@ bool retroarch_is_switching_display_mode(void);
  **/
 bool retroarch_main_init(int argc, char *argv[]);
 
+/**
+ * retroarch_startup_trace_add:
+ * @name             : stage name, must be a string literal.
+ * @start_usec       : when the stage began.
+ *
+ * Records a startup stage ending now, and logs its duration.
+ * Does nothing once the first frame has been presented, at
+ * which point the stages are written to the file given with
+ * --startup-trace as a Chrome trace (chrome://tracing).
+ **/
+void retroarch_startup_trace_add(const char *name, retro_time_t start_usec);
+
+/**
+ * retroarch_set_vfs_read_cache:
+ * @block_size_kb    : block size of the VFS read cache, 0 disables it.
+ *
+ * Applies to files opened afterwards. The counters of each
+ * cached file are logged when it is closed.
+ **/
+void retroarch_set_vfs_read_cache(unsigned block_size_kb);
+
 bool retroarch_main_quit(void);
 
 global_t *global_get_ptr(void);
@@ -416,6 +437,8 @@ typedef struct audio_mixer_stream_params
 {
    void *buf;
    char *basename;
+   /* Streams from this file instead of buf when set */
+   const char *path;
    audio_mixer_stop_cb_t cb;
    size_t bufsize;
    unsigned slot_selection_idx;
@@ -1174,7 +1197,7 @@ typedef struct video_frame_info
       bool full_screen;
    } osd_stat_params;
 
-   char stat_text[512];
+   char stat_text[2048];
 
    bool widgets_active;
    bool menu_mouse_enable;
@@ -1537,6 +1560,8 @@ void video_driver_unset_rgba(void);
 
 bool video_driver_supports_rgba(void);
 
+bool video_driver_supports_overlay_atlas(void);
+
 bool video_driver_get_next_video_out(void);
 
 bool video_driver_get_prev_video_out(void);
@@ -1682,6 +1707,21 @@ void video_monitor_set_refresh_rate(float hz);
 bool video_monitor_fps_statistics(double *refresh_rate,
       double *deviation, unsigned *sample_points);
 
+/**
+ * video_driver_frame_presented:
+ * @frame_count        : frame count the video driver got in frame().
+ * @present_time       : when the frame was shown (usec), as reported
+ *                       by the presentation engine.
+ *
+ * Lets video drivers able to measure presentation (e.g. through
+ * VK_GOOGLE_display_timing) add it to the frame timings, see
+ * GET_FRAME_TIMINGS. Only intervals between reported times are
+ * used, so they need not share the cpu_features_get_time_usec()
+ * clock.
+ **/
+void video_driver_frame_presented(uint64_t frame_count,
+      retro_time_t present_time);
+
 void crt_switch_driver_reinit(void);
 
 #define video_driver_translate_coord_viewport_wrap(vp, mouse_x, mouse_y, res_x, res_y, res_screen_x, res_screen_y) \
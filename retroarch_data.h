@@ -69,6 +69,26 @@
 
 #ifdef HAVE_BSV_MOVIE
 #define BSV_MAGIC          0x42535631
+#define BSV2_MAGIC         0x42535632
+#define BSV2_BLOCK_MAGIC   0x424C4B32
+#define BSV2_INDEX_MAGIC   0x49445832
+
+#define BSV2_HEADER_SIZE       32
+#define BSV2_BLOCK_HEADER_SIZE 36
+#define BSV2_INDEX_ENTRY_SIZE  20
+
+/* Frames of input per block, and frames between
+ * embedded savestates (a multiple of the block size) */
+#define BSV2_BLOCK_FRAMES      120
+#define BSV2_KEYFRAME_INTERVAL 1800
+
+/* Longest a replay seek runs frames before
+ * handing control back to the runloop */
+#define BSV_SEEK_SLICE_USEC     50000
+
+#define BSV2_FLAG_KEYFRAME      (1 << 0)
+#define BSV2_FLAG_STATE_DEFLATE (1 << 1)
+#define BSV2_FLAG_INPUT_DEFLATE (1 << 2)
 
 #define BSV_MOVIE_IS_PLAYBACK_ON() (p_rarch->bsv_movie_state_handle && p_rarch->bsv_movie_state.movie_playback)
 #define BSV_MOVIE_IS_PLAYBACK_OFF() (p_rarch->bsv_movie_state_handle && !p_rarch->bsv_movie_state.movie_playback)
@@ -76,10 +96,51 @@
 
 #define MEASURE_FRAME_TIME_SAMPLES_COUNT (2 * 1024)
 
+/* Must be a power of two */
+#define FRAME_TIMING_SAMPLES_COUNT 1024
+
+#define STARTUP_TRACE_EVENTS_COUNT 64
+
+/* Frames --benchmark runs when --max-frames is not given,
+ * and how many of them are left out of the statistics */
+#define BENCHMARK_DEFAULT_FRAMES 3000
+#define BENCHMARK_WARMUP_FRAMES  60
+
+/* Must be a power of two */
+#define INPUT_REPORT_SAMPLES_COUNT 512
+/* Gaps longer than this are a pad sitting idle
+ * (most only report changes), not report intervals. */
+#define INPUT_REPORT_IDLE_USEC     100000
+
+/* 1 ms wide buckets, the last one collects everything above */
+#define FRAME_TIMING_HISTOGRAM_BUCKETS 33
+
+/* Automatic frame delay: how often (in frames) to re-evaluate,
+ * how much headroom (usec) to leave below the frame budget, and
+ * for how many frames not to raise the delay after a miss */
+#define FRAME_DELAY_AUTO_INTERVAL 60
+#define FRAME_DELAY_AUTO_MARGIN   2000
+#define FRAME_DELAY_AUTO_HOLDOFF  600
+
 #define TIME_TO_FPS(last_time, new_time, frames) ((1000000.0f * (frames)) / ((new_time) - (last_time)))
 
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 
+/* Largest deviation of the resampling ratio from 1.0 for which
+ * audio is passed through as s16 with plain frame drop/dup */
+#define AUDIO_PASSTHROUGH_MAX_SKEW 0.01
+
+/* Number of audio_driver_free_samples_buf entries the PI rate
+ * controller averages over, and its integral gain per flush */
+#define AUDIO_RATE_CONTROL_PI_WINDOW 8
+#define AUDIO_RATE_CONTROL_PI_KI     0.02
+
+/* Click train played by AUDIO_LATENCY_TEST: one click per
+ * interval, each a short full-scale pulse */
+#define AUDIO_LATENCY_TEST_INTERVAL_MS 500
+#define AUDIO_LATENCY_TEST_CLICK_MS    1
+#define AUDIO_LATENCY_TEST_MAX_SECONDS 60
+
 #define MENU_SOUND_FORMATS "ogg|mod|xm|s3m|mp3|flac|wav"
 
 #define MIDI_DRIVER_BUF_SIZE 4096
@@ -198,6 +259,11 @@
       p_rarch->runahead_secondary_core_available = false
 #endif
 
+/* Longest lag run-ahead calibration looks for,
+ * the maximum of 'run_ahead_frames' */
+#define RUNAHEAD_CALIBRATE_MAX_FRAMES 12
+#define RUNAHEAD_CALIBRATE_NO_BUTTON  (~0u)
+
 #define RUNAHEAD_RESUME_VIDEO(p_rarch) \
    if (p_rarch->runahead_video_driver_is_active) \
       p_rarch->video_driver_active = true; \
@@ -1259,7 +1325,10 @@ enum
    RA_OPT_MAX_FRAMES_SCREENSHOT_PATH,
    RA_OPT_SET_SHADER,
    RA_OPT_ACCESSIBILITY,
-   RA_OPT_LOAD_MENU_ON_ERROR
+   RA_OPT_LOAD_MENU_ON_ERROR,
+   RA_OPT_STARTUP_TRACE,
+   RA_OPT_BENCHMARK,
+   RA_OPT_HEADLESS
 };
 
 enum  runloop_state
@@ -1341,6 +1410,14 @@ struct bsv_state
 
 };
 
+struct bsv_block
+{
+   uint64_t offset;      /* File position of the block header */
+   uint32_t first_frame;
+   uint32_t num_frames;
+   uint32_t flags;       /* BSV2_FLAG_* */
+};
+
 struct bsv_movie
 {
    intfstream_t *file;
@@ -1353,9 +1430,33 @@ struct bsv_movie
    size_t min_file_pos;
    size_t state_size;
 
+   /* Compact (BSV2) movies: the blocks on disk,
+    * and the decoded input of the current block */
+   struct bsv_block *blocks;
+   int16_t *values;
+   uint32_t *frame_offsets;  /* block_frames + 1 entries into 'values' */
+   uint8_t *keyframe;        /* State at the start of the current block */
+   size_t num_blocks;
+   size_t blocks_size;
+   size_t num_values;
+   size_t values_size;
+   size_t frame_offsets_size;
+   size_t keyframe_size;
+   size_t block_index;
+   size_t value_ptr;
+   uint64_t write_pos;
+   uint32_t frame;           /* Frame about to run */
+   uint32_t block_first;
+   uint32_t block_frames;
+   uint32_t total_frames;
+   uint32_t seek_target;     /* Frame a seek runs up to */
+
    bool playback;
    bool first_rewind;
    bool did_rewind;
+   bool compact;
+   bool block_keyframe;
+   bool seeking;
 };
 #endif
 
@@ -1437,6 +1538,7 @@ struct input_overlay
 {
    struct overlay *overlays;
    const struct overlay *active;
+   char *path;
    void *iface_data;
    const video_overlay_interface_t *iface;
    input_overlay_state_t overlay_state;
@@ -1485,6 +1587,20 @@ struct turbo_buttons
    bool mode1_enable[MAX_USERS];
 };
 
+/* Joypad sources of one user's RetroPad buttons, with the
+ * auto-bind fallback already applied. Invalid binds resolve
+ * to NO_BTN/AXIS_NONE. Rebuilt on every input_driver_poll(),
+ * so that queries from the core during the frame are plain
+ * table lookups instead of bind/auto-bind merging. */
+typedef struct input_resolved_binds
+{
+   uint32_t joyaxis[RARCH_FIRST_CUSTOM_BIND];
+   uint16_t joykey[RARCH_FIRST_CUSTOM_BIND];
+   /* Buttons that input_state_device() must not pass through
+    * because they are remapped to another button id. */
+   uint16_t remapped;
+} input_resolved_binds_t;
+
 struct input_keyboard_line
 {
    char *buffer;
@@ -1534,6 +1650,7 @@ struct menu_state
    retro_time_t powerstate_last_time_us;
    retro_time_t datetime_last_time_us;
    retro_time_t input_last_time_us;
+   retro_time_t present_last_time_us;
 
    struct
    {
@@ -1541,8 +1658,21 @@ struct menu_state
       menu_list_t *list;
       size_t begin;
    } entries;
+
+   /* Entry callbacks of the last cleared list,
+    * see menu_cbs_pool_get() */
+   struct
+   {
+      menu_file_list_cbs_t **items;
+      size_t size;
+      size_t capacity;
+   } cbs_pool;
    size_t   selection_ptr;
 
+   /* Video size the menu was last presented at */
+   unsigned present_width;
+   unsigned present_height;
+
    /* Quick jumping indices with L/R.
     * Rebuilt when parsing directory. */
    struct
@@ -1661,6 +1791,89 @@ struct discord_state
 typedef struct discord_state discord_state_t;
 #endif
 
+/* One stage of startup (usec), see retroarch_startup_trace_add().
+ * 'end' is 0 for instant events. */
+struct startup_trace_event
+{
+   const char *name;
+   retro_time_t start;
+   retro_time_t end;
+};
+
+/* Timestamps of one presented frame (usec).
+ * run_start/run_end are 0 if the frame wasn't
+ * produced by core_run() (e.g. menu frames). */
+struct frame_timing_sample
+{
+   retro_time_t run_start; /* core_run() called */
+   retro_time_t run_end;   /* core_run() returned */
+   retro_time_t submit;    /* frame handed to the video driver */
+   retro_time_t swap;      /* video driver frame() (and swap buffers) returned */
+   retro_time_t present;   /* reported by the video driver, 0 if unknown */
+   uint64_t frame;         /* video frame count handed to frame() */
+};
+
+enum rarch_job_state
+{
+   RARCH_JOB_NONE = 0,
+   RARCH_JOB_QUEUED,
+   RARCH_JOB_RUNNING,
+   RARCH_JOB_DONE,
+   RARCH_JOB_FAILED
+};
+
+/* A batch job queued by the RUN_JOB command: load the content
+ * (with the core, reusing it if it's already loaded), run it
+ * for 'frames' frames, then write <output>.png, .state and .ram */
+struct rarch_job
+{
+   uint64_t start_frame;    /* UINT64_MAX until the first frame */
+   unsigned id;
+   unsigned frames;
+   enum rarch_job_state state;
+   char core_path[PATH_MAX_LENGTH];
+   char content_path[PATH_MAX_LENGTH];
+   char output[PATH_MAX_LENGTH];
+};
+
+/* Report intervals (usec) of the device on one joypad port,
+ * see input_driver_report_received(). */
+struct input_report_stats
+{
+   retro_time_t last;   /* previous report, 0 if none yet */
+   uint64_t count;      /* intervals recorded */
+   uint32_t intervals[INPUT_REPORT_SAMPLES_COUNT];
+};
+
+/* Audio output latency test, see command_audio_latency_test().
+ * Only touched with audio processing locked. */
+struct audio_latency_test
+{
+   uint64_t history_start;   /* audio_driver_free_samples_count at start */
+   double click_ms_accum;
+   size_t buffer_size;       /* bytes, 0 if the driver can't tell */
+   size_t frame_size;
+   unsigned rate;
+   unsigned frames_left;     /* output frames until the test ends */
+   unsigned frames_to_click;
+   unsigned pulse_left;
+   unsigned clicks;
+   float click_ms_min;
+   float click_ms_max;
+   char report[320];
+   bool active;
+};
+
+enum frame_timing_metric
+{
+   FRAME_TIMING_CORE_RUN = 0,
+   FRAME_TIMING_SUBMIT,
+   FRAME_TIMING_INTERVAL,
+   FRAME_TIMING_WORK, /* core_run() minus the time spent in the video driver */
+   FRAME_TIMING_PRESENT, /* between frames shown on the display */
+   FRAME_TIMING_LAST
+};
+
 struct runloop
 { 
    retro_usec_t frame_time_last;        /* int64_t alignment */
@@ -1711,10 +1924,27 @@ struct runloop
 
 typedef struct runloop runloop_state_t;
 
+#ifdef HAVE_TRANSLATE
+/* AI service requests. The frame is captured and converted on
+ * the main thread; PNG, base64 and JSON encoding run as a task
+ * whose callback pushes the POST. At most one request is in
+ * flight, replies carrying an older id are dropped. */
+typedef struct ai_service_state
+{
+   retro_time_t retry_time;  /* auto mode: look at the screen again */
+   uint8_t *last_frame;      /* BGR24, the last frame sent */
+   unsigned last_width;
+   unsigned last_height;
+   unsigned request_id;
+   bool request_pending;
+} ai_service_state_t;
+#endif
+
 struct rarch_state
 {
    double audio_source_ratio_original;
    double audio_source_ratio_current;
+   double audio_driver_rate_control_integral;
    struct retro_system_av_info video_driver_av_info; /* double alignment */
    videocrt_switch_t crt_switch_st;                  /* double alignment */
 
@@ -1722,8 +1952,26 @@ struct rarch_state
    retro_time_t frame_limit_last_time;
    retro_time_t libretro_core_runtime_last;
    retro_time_t libretro_core_runtime_usec;
+   retro_time_t power_session_start;
+   retro_time_t power_sleep_usec;    /* runloop sleeps this session */
+   retro_time_t power_video_usec;    /* in video driver frame() */
    retro_time_t video_driver_frame_time_samples[
       MEASURE_FRAME_TIME_SAMPLES_COUNT];
+   struct frame_timing_sample frame_timing_samples[
+      FRAME_TIMING_SAMPLES_COUNT];
+   retro_time_t frame_timing_run_start;
+   uint64_t frame_timing_count;
+   struct startup_trace_event startup_trace_events[
+      STARTUP_TRACE_EVENTS_COUNT];
+   retro_time_t startup_trace_base;
+   size_t startup_trace_count;
+   struct input_report_stats input_report_stats[MAX_USERS];
+   struct audio_latency_test audio_latency_test; /* uint64_t alignment */
+   uint64_t frame_delay_auto_last;
+   struct rarch_job job;                        /* uint64_t alignment */
+#ifdef HAVE_TRANSLATE
+   ai_service_state_t ai_service;               /* retro_time_t alignment */
+#endif
    struct global              g_extern;         /* retro_time_t alignment */
 #ifdef HAVE_MENU
    menu_input_t menu_input_state;               /* retro_time_t alignment */
@@ -1760,6 +2008,7 @@ struct rarch_state
 #endif
 
    uint64_t video_driver_frame_time_count;
+   uint64_t video_driver_frame_hash;  /* last software frame, for dupe detection */
    uint64_t video_driver_frame_count;
    struct retro_camera_callback camera_cb;    /* uint64_t alignment */
    gfx_animation_t anim;                      /* uint64_t alignment */
@@ -1854,10 +2103,16 @@ struct rarch_state
    const retro_resampler_t *audio_driver_resampler;
 
    void *audio_driver_resampler_data;
+#ifdef HAVE_THREADS
+   /* Non-NULL when audio_threaded_processing is on */
+   audio_flush_thread_t *audio_flush_thread;
+   int16_t *audio_flush_thread_conv_buf;
+#endif
    const audio_driver_t *current_audio;
    void *audio_driver_context_audio_data;
 #ifdef HAVE_OVERLAY
    input_overlay_t *overlay_ptr;
+   overlay_cache_entry_t overlay_cache[OVERLAY_CACHE_SIZE];
 #endif
 
    pad_connection_listener_t *pad_connection_listener;
@@ -1867,6 +2122,9 @@ struct rarch_state
 #ifdef HAVE_COMMAND
    command_t *input_driver_command[MAX_CMD_DRIVERS];
 #endif
+#ifdef HAVE_MEMORY_WATCH
+   memory_watch_t *memory_watch;
+#endif
 #ifdef HAVE_NETWORKGAMEPAD
    input_remote_t *input_driver_remote;
 #endif
@@ -1967,6 +2225,9 @@ struct rarch_state
 
    size_t recording_gpu_width;
    size_t recording_gpu_height;
+   /* Largest frame area (in pixels) the recording driver
+    * was set up for, viewport resizes within it are fine */
+   size_t recording_gpu_max_size;
 
    size_t frame_cache_pitch;
 
@@ -1984,11 +2245,16 @@ struct rarch_state
 #ifdef HAVE_RUNAHEAD
    size_t runahead_save_state_size;
 #endif
+#ifdef HAVE_MEMORY_TAGS
+   /* Core memory regions reported to the core memory tag */
+   size_t core_memory_tagged;
+#endif
 
    jmp_buf error_sjlj_context;              /* 4-byte alignment, 
                                                put it right before long */
 
    turbo_buttons_t input_driver_turbo_btns; /* int32_t alignment */
+   input_resolved_binds_t input_driver_resolved_binds[MAX_USERS]; /* uint32_t alignment */
    int osk_ptr;
 #if defined(HAVE_COMMAND)
 #ifdef HAVE_NETWORK_CMD
@@ -2012,6 +2278,13 @@ struct rarch_state
 #ifdef HAVE_NETWORKING
    int reannounce;
 #endif
+#ifdef HAVE_RUNAHEAD
+   int runahead_ring_size;  /* number of slots in the savestate ring */
+   int runahead_ring_tail;  /* slot holding the last 'real' frame */
+   int runahead_ring_count; /* number of valid states in the ring */
+   uint32_t runahead_calibrate_crc;    /* hash of the last frame */
+   unsigned runahead_calibrate_button; /* button held while calibrating */
+#endif
 
    input_device_info_t input_device_info[MAX_INPUT_DEVICES]; 
                                           /* unsigned alignment */
@@ -2022,6 +2295,10 @@ struct rarch_state
    sthread_tls_t rarch_tls;               /* unsigned alignment */
 #endif
    unsigned fastforward_after_frames;
+   unsigned fastforward_skipped_frames; /* frameskip of this iteration */
+#if defined(HAVE_SLANG) && defined(HAVE_GLSLANG)
+   unsigned shader_preload_generation;
+#endif
 
 #ifdef HAVE_MENU
    unsigned menu_input_dialog_keyboard_type;
@@ -2037,6 +2314,8 @@ struct rarch_state
 #endif
    unsigned frame_cache_width;
    unsigned frame_cache_height;
+   unsigned frame_delay_auto;
+   unsigned frame_delay_auto_holdoff;
    unsigned video_driver_width;
    unsigned video_driver_height;
    unsigned osk_last_codepoint;
@@ -2053,8 +2332,10 @@ struct rarch_state
 
    unsigned audio_driver_free_samples_buf[
       AUDIO_BUFFER_FREE_SAMPLES_COUNT];
+   unsigned audio_driver_rate_control_target; /* percent */
    unsigned perf_ptr_rarch;
    unsigned perf_ptr_libretro;
+   uint32_t audio_driver_passthrough_pos; /* 16.16 input frames */
 
    float *audio_driver_input_data;
    float video_driver_core_hz;
@@ -2131,6 +2412,8 @@ struct rarch_state
    char current_valid_extensions[256];
    char launch_arguments[4096];
    char path_main_basename[8192];
+   char startup_trace_path[PATH_MAX_LENGTH];
+   char benchmark_path[PATH_MAX_LENGTH];
 #if defined(HAVE_CG) || defined(HAVE_GLSL) || defined(HAVE_SLANG) || defined(HAVE_HLSL)
    char cli_shader[PATH_MAX_LENGTH];
    char runtime_shader_preset[PATH_MAX_LENGTH];
@@ -2241,8 +2524,11 @@ struct rarch_state
 #endif
 
    bool location_driver_active;
+   bool startup_trace_done;
    bool bluetooth_driver_active;
+   bool bluetooth_driver_deferred;
    bool wifi_driver_active;
+   bool wifi_driver_deferred;
    bool video_driver_active;
    bool audio_driver_active;
    bool camera_driver_active;
@@ -2256,6 +2542,7 @@ struct rarch_state
    bool video_started_fullscreen;
 
    bool audio_driver_control;
+   bool audio_driver_control_pi;
    bool audio_driver_mute_enable;
    bool audio_driver_use_float;
 
@@ -2315,12 +2602,19 @@ struct rarch_state
    bool runahead_available;
    bool runahead_secondary_core_available;
    bool runahead_force_input_dirty;
+   bool runahead_calibrate_hw_frame;
 #endif
+   bool video_driver_frame_hash_valid;
+   /* Started with --headless: null drivers, jobs over commands */
+   bool headless;
 
 #ifdef HAVE_AUDIOMIXER
    bool audio_driver_mixer_mute_enable;
    bool audio_mixer_active;
 #endif
+#ifdef HAVE_MEMORY_WATCH
+   bool memory_watch_tried;
+#endif
 };
 
 static struct rarch_state         rarch_st;
@@ -2468,6 +2762,7 @@ static const struct input_bind_map input_config_bind_map[RARCH_BIND_LIST_END_NUL
       DECLARE_META_BIND(2, streaming_toggle,      RARCH_STREAMING_TOGGLE,      MENU_ENUM_LABEL_VALUE_INPUT_META_STREAMING_TOGGLE),
       DECLARE_META_BIND(2, runahead_toggle,       RARCH_RUNAHEAD_TOGGLE,       MENU_ENUM_LABEL_VALUE_INPUT_META_RUNAHEAD_TOGGLE),
       DECLARE_META_BIND(2, ai_service,            RARCH_AI_SERVICE,            MENU_ENUM_LABEL_VALUE_INPUT_META_AI_SERVICE),
+      DECLARE_META_BIND(2, trace_toggle,          RARCH_TRACE_TOGGLE,          MENU_ENUM_LABEL_VALUE_INPUT_META_TRACE_TOGGLE),
 };
 
 /* TODO/FIXME - turn these into static global variable */
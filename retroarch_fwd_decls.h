@@ -58,11 +58,14 @@ static bool secondary_core_create(struct rarch_state *p_rarch,
 #endif
 static int16_t input_state_get_last(unsigned port,
       unsigned device, unsigned index, unsigned id);
+static bool runahead_calibrate(struct rarch_state *p_rarch,
+      unsigned *frames);
 #endif
 static int16_t input_state(unsigned port, unsigned device,
       unsigned idx, unsigned id);
 static void video_driver_frame(const void *data, unsigned width,
       unsigned height, size_t pitch);
+static void runloop_msg_queue_collect(struct rarch_state *p_rarch);
 static void retro_frame_null(const void *data, unsigned width,
       unsigned height, size_t pitch);
 static void retro_run_null(void);
@@ -84,6 +87,12 @@ static void ui_companion_driver_init_first(
       struct rarch_state *p_rarch);
 
 static bool audio_driver_stop(struct rarch_state *p_rarch);
+static void audio_driver_lock_processing(struct rarch_state *p_rarch);
+static void audio_driver_unlock_processing(struct rarch_state *p_rarch);
+#ifdef HAVE_THREADS
+static void audio_driver_flush_thread_cb(void *userdata,
+      const audio_flush_chunk_t *chunk, const int16_t *data);
+#endif
 static bool audio_driver_start(struct rarch_state *p_rarch,
       bool is_shutdown);
 
@@ -112,6 +121,9 @@ static void audio_mixer_play_stop_cb(
       audio_mixer_sound_t *sound, unsigned reason);
 static void audio_mixer_menu_stop_cb(
       audio_mixer_sound_t *sound, unsigned reason);
+static void audio_driver_mixer_play_stream_internal(
+      struct rarch_state *p_rarch,
+      unsigned i, unsigned type);
 #endif
 
 static void video_driver_gpu_record_deinit(struct rarch_state *p_rarch);
@@ -121,14 +133,26 @@ static bool video_driver_find_driver(
       struct rarch_state *p_rarch,
       settings_t *settings,
       const char *prefix, bool verbosity_enabled);
+static unsigned video_frame_timing_values(struct rarch_state *p_rarch,
+      enum frame_timing_metric metric, retro_time_t *out);
+static int video_frame_timing_compare(const void *a, const void *b);
 
 #ifdef HAVE_BSV_MOVIE
 static void bsv_movie_deinit(struct rarch_state *p_rarch);
 static bool bsv_movie_init(struct rarch_state *p_rarch);
 static bool bsv_movie_check(struct rarch_state *p_rarch,
       settings_t *settings);
+#ifdef HAVE_COMMAND
+static int64_t bsv_movie_seek(struct rarch_state *p_rarch, uint32_t frame);
+#endif
 #endif
 
+static void retroarch_startup_trace_finish(struct rarch_state *p_rarch);
+static void retroarch_benchmark_init(struct rarch_state *p_rarch,
+      settings_t *settings);
+static void retroarch_benchmark_write(struct rarch_state *p_rarch,
+      const char *path);
+
 static void driver_uninit(struct rarch_state *p_rarch, int flags);
 static void drivers_init(struct rarch_state *p_rarch,
       settings_t *settings,
@@ -210,6 +234,12 @@ static bool retroarch_apply_shader(
       enum rarch_shader_type type, const char *preset_path,
       bool message);
 
+static bool retroarch_apply_shader_now(
+      struct rarch_state *p_rarch,
+      settings_t *settings,
+      enum rarch_shader_type type, const char *preset_path,
+      bool message);
+
 static void video_driver_restore_cached(struct rarch_state *p_rarch,
       settings_t *settings);
 
@@ -219,4 +249,6 @@ static const void *find_driver_nonempty(
 
 static bool core_set_default_callbacks(struct retro_callbacks *cbs);
 
+static void retroarch_trace_finished(bool written);
+
 #endif
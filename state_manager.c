@@ -25,9 +25,18 @@
 
 #include <retro_inline.h>
 #include <compat/strl.h>
+#include <memalign.h>
 #include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+
+#if defined(HAVE_THREADS) && defined(HAVE_ZLIB)
+#define STATE_MANAGER_COLD
+#include <rthreads/rthreads.h>
+#include <streams/trans_stream.h>
+#endif
 
 #include "state_manager.h"
+#include "memory_tags.h"
 #include "msg_hash.h"
 #include "core.h"
 #include "retroarch.h"
@@ -63,6 +72,26 @@
 #include <emmintrin.h>
 #endif
 
+/* The AVX2 kernel is built with a target attribute where the
+ * compiler supports it, so it can be picked at runtime even
+ * when the rest of RetroArch is built for plain SSE2. */
+#if defined(__AVX2__)
+#define STATE_MANAGER_AVX2
+#define STATE_MANAGER_AVX2_TARGET
+#elif defined(CPU_X86) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define STATE_MANAGER_AVX2
+#define STATE_MANAGER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef STATE_MANAGER_AVX2
+#include <immintrin.h>
+#endif
+
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(HAVE_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define STATE_MANAGER_NEON
+#include <arm_neon.h>
+#endif
+
 /* Format per frame (pseudocode): */
 #if 0
 size nextstart;
@@ -84,10 +113,46 @@ size thisstart;
 #endif
 
 /* There's no equivalent in libc, you'd think so ...
- * std::mismatch exists, but it's not optimized at all. */
-static size_t find_change(const uint16_t *a, const uint16_t *b)
+ * std::mismatch exists, but it's not optimized at all.
+ *
+ * All variants rely on the sentinel and padding added by
+ * state_manager_raw_alloc() and may read up to 32 bytes past
+ * the first difference. */
+static size_t find_change_generic(const uint16_t *a, const uint16_t *b)
 {
+   const uint16_t *a_org = a;
+#ifdef NO_UNALIGNED_MEM
+   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
+   {
+      a++;
+      b++;
+   }
+   if (*a == *b)
+#endif
+   {
+      const size_t *a_big = (const size_t*)a;
+      const size_t *b_big = (const size_t*)b;
+
+      while (*a_big == *b_big)
+      {
+         a_big++;
+         b_big++;
+      }
+      a = (const uint16_t*)a_big;
+      b = (const uint16_t*)b_big;
+
+      while (*a == *b)
+      {
+         a++;
+         b++;
+      }
+   }
+   return a - a_org;
+}
+
 #if __SSE2__
+static size_t find_change_sse2(const uint16_t *a, const uint16_t *b)
+{
    const __m128i *a128 = (const __m128i*)a;
    const __m128i *b128 = (const __m128i*)b;
 
@@ -111,35 +176,93 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
       a128++;
       b128++;
    }
-#else
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
-   {
-      a++;
-      b++;
-   }
-   if (*a == *b)
+}
 #endif
+
+#ifdef STATE_MANAGER_AVX2
+STATE_MANAGER_AVX2_TARGET
+static size_t find_change_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
    {
-      const size_t *a_big = (const size_t*)a;
-      const size_t *b_big = (const size_t*)b;
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi8(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
 
-      while (*a_big == *b_big)
+      if (mask != 0xffffffff)
       {
-         a_big++;
-         b_big++;
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+         return (ret >> 1);
       }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
 
-      while (*a == *b)
+      a256++;
+      b256++;
+   }
+}
+#endif
+
+#ifdef STATE_MANAGER_NEON
+static size_t find_change_neon(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+
+   for (;;)
+   {
+      /* Narrow the 8 lane compare result to one byte per lane,
+       * so it fits in two 32-bit words. */
+      uint16x8_t c   = vceqq_u16(vld1q_u16(a), vld1q_u16(b));
+      uint32x2_t m   = vreinterpret_u32_u8(vmovn_u16(c));
+      uint32_t lo    = vget_lane_u32(m, 0);
+      uint32_t hi    = vget_lane_u32(m, 1);
+
+      if ((lo & hi) != 0xffffffff)
       {
-         a++;
-         b++;
+         if (lo != 0xffffffff)
+            return (a - a_org) + (compat_ctz(~lo) >> 3);
+         return (a - a_org) + 4 + (compat_ctz(~hi) >> 3);
       }
+
+      a += 8;
+      b += 8;
    }
-   return a - a_org;
+}
+#endif
+
+typedef size_t (*find_change_t)(const uint16_t *a, const uint16_t *b);
+
+static find_change_t find_change = find_change_generic;
+
+/**
+ * find_change_init_simd:
+ *
+ * Picks the fastest find_change() variant
+ * based on CPU features.
+ **/
+static void find_change_init_simd(void)
+{
+#if defined(STATE_MANAGER_AVX2) || defined(STATE_MANAGER_NEON)
+   uint64_t cpu = cpu_features_get();
+#endif
+
+#if __SSE2__
+   find_change = find_change_sse2;
+#endif
+#ifdef STATE_MANAGER_AVX2
+   if (cpu & RETRO_SIMD_AVX2)
+      find_change = find_change_avx2;
+#endif
+#ifdef STATE_MANAGER_NEON
+#if defined(__aarch64__)
+   find_change    = find_change_neon;
+#else
+   if (cpu & RETRO_SIMD_NEON)
+      find_change = find_change_neon;
+#endif
 #endif
 }
 
@@ -199,12 +322,16 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
 
 /*
  * See state_manager_raw_compress for information about this.
- * When you're done with it, send it to free().
+ * When you're done with it, send it to memalign_free_large().
  */
 static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)memalign_alloc_large(
+         len16 + sizeof(uint16_t) * 4 + 32);
+
+   if (!ret)
+      return NULL;
 
    /* Force in a different byte at the end, so we don't need to check
     * bounds in the innermost loop (it's expensive).
@@ -215,7 +342,7 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
+    * It doesn't make any difference to us, but sacrificing 32 bytes to get
     * Valgrind happy is worth it. */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
@@ -370,17 +497,455 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+/* Walks a patch from state_manager_raw_compress()
+ * and returns its size in bytes. */
+static size_t state_manager_raw_patchlen(const void *patch)
+{
+   const uint16_t *patch16 = (const uint16_t*)patch;
+
+   for (;;)
+   {
+      uint16_t numchanged  = *(patch16++);
+
+      if (numchanged)
+         patch16          += 1 + numchanged;
+      else
+      {
+         uint32_t numunchanged = patch16[0] | (patch16[1] << 16);
+
+         patch16          += 2;
+         if (!numunchanged)
+            break;
+      }
+   }
+
+   return (const uint8_t*)patch16 - (const uint8_t*)patch;
+}
+
+#ifdef STATE_MANAGER_COLD
+/* Cold tier.
+ *
+ * Patches that fall off the tail of the ring buffer are
+ * appended to chunks of about STATE_MANAGER_COLD_CHUNK bytes.
+ * Full chunks are deflated on a worker thread, and inflated
+ * again once rewinding reaches them. Within a chunk, each
+ * patch is followed by its size, so it can be read back to
+ * front.
+ *
+ * The chunk list runs from the oldest to the newest chunk;
+ * only the newest one is ever appended to or read from. */
+#define STATE_MANAGER_COLD_CHUNK (1024 * 1024)
+
+enum state_cold_chunk_status
+{
+   STATE_COLD_CHUNK_FILLING = 0,
+   STATE_COLD_CHUNK_QUEUED,
+   STATE_COLD_CHUNK_BUSY,
+   STATE_COLD_CHUNK_COMPRESSED
+};
+
+typedef struct state_cold_chunk
+{
+   struct state_cold_chunk *prev;
+   struct state_cold_chunk *next;
+   uint8_t *data;
+   size_t size;      /* bytes used in data */
+   size_t capacity;  /* bytes allocated for data */
+   size_t raw_size;  /* size when not compressed */
+   unsigned entries;
+   enum state_cold_chunk_status status;
+} state_cold_chunk_t;
+
+struct state_manager_cold
+{
+   state_cold_chunk_t *oldest;
+   state_cold_chunk_t *newest;
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   size_t budget;
+   size_t used;
+   unsigned entries;
+   bool quit;
+};
+
+static void state_cold_chunk_free(state_cold_chunk_t *chunk)
+{
+   memory_tag_add(MEMORY_TAG_REWIND, -(int64_t)chunk->capacity);
+   free(chunk->data);
+   free(chunk);
+}
+
+static void state_cold_compress(state_cold_chunk_t *chunk,
+      uint8_t **out, size_t *out_len)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+   size_t max_len  = chunk->raw_size + chunk->raw_size / 8 + 64;
+   void *stream    = backend->stream_new();
+   uint8_t *buf    = (uint8_t*)malloc(max_len);
+
+   *out            = NULL;
+   *out_len        = 0;
+
+   if (!stream || !buf)
+      goto end;
+
+   backend->set_in(stream, chunk->data, (uint32_t)chunk->raw_size);
+   backend->set_out(stream, buf, (uint32_t)max_len);
+
+   if (backend->trans(stream, true, &rd, &wn, &err)
+         && wn < chunk->raw_size)
+   {
+      *out         = buf;
+      *out_len     = wn;
+      buf          = NULL;
+   }
+
+end:
+   if (stream)
+      backend->stream_free(stream);
+   free(buf);
+}
+
+static bool state_cold_decompress(state_cold_chunk_t *chunk)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_inflate_backend();
+   void *stream    = backend->stream_new();
+   uint8_t *buf    = (uint8_t*)malloc(chunk->raw_size);
+   bool ret        = false;
+
+   if (!stream || !buf)
+      goto end;
+
+   backend->set_in(stream, chunk->data, (uint32_t)chunk->size);
+   backend->set_out(stream, buf, (uint32_t)chunk->raw_size);
+
+   if (backend->trans(stream, true, &rd, &wn, &err)
+         && wn == chunk->raw_size)
+   {
+      memory_tag_add(MEMORY_TAG_REWIND,
+            (int64_t)chunk->raw_size - (int64_t)chunk->capacity);
+      free(chunk->data);
+      chunk->data     = buf;
+      chunk->size     = chunk->raw_size;
+      chunk->capacity = chunk->raw_size;
+      buf             = NULL;
+      ret             = true;
+   }
+
+end:
+   if (stream)
+      backend->stream_free(stream);
+   free(buf);
+   return ret;
+}
+
+static void state_cold_thread(void *data)
+{
+   struct state_manager_cold *cold = (struct state_manager_cold*)data;
+
+   slock_lock(cold->lock);
+
+   for (;;)
+   {
+      uint8_t *out                  = NULL;
+      size_t out_len                = 0;
+      state_cold_chunk_t *chunk     = cold->oldest;
+
+      while (chunk && chunk->status != STATE_COLD_CHUNK_QUEUED)
+         chunk = chunk->next;
+
+      if (!chunk)
+      {
+         if (cold->quit)
+            break;
+         scond_wait(cold->cond, cold->lock);
+         continue;
+      }
+
+      /* The main thread leaves BUSY chunks alone,
+       * so the data can be read without the lock. */
+      chunk->status                 = STATE_COLD_CHUNK_BUSY;
+      slock_unlock(cold->lock);
+
+      state_cold_compress(chunk, &out, &out_len);
+
+      slock_lock(cold->lock);
+      if (out)
+      {
+         memory_tag_add(MEMORY_TAG_REWIND,
+               (int64_t)out_len - (int64_t)chunk->capacity);
+         free(chunk->data);
+         cold->used                -= chunk->size;
+         cold->used                += out_len;
+         chunk->data                = out;
+         chunk->size                = out_len;
+         chunk->capacity            = out_len;
+         chunk->status              = STATE_COLD_CHUNK_COMPRESSED;
+      }
+      else /* Doesn't compress, keep it as is */
+         chunk->status              = STATE_COLD_CHUNK_FILLING;
+      scond_broadcast(cold->cond);
+   }
+
+   slock_unlock(cold->lock);
+}
+
+/* Waits until the worker thread is done with 'chunk'.
+ * Must be called with the lock held. */
+static void state_cold_wait_chunk(struct state_manager_cold *cold,
+      state_cold_chunk_t *chunk)
+{
+   while (chunk->status == STATE_COLD_CHUNK_BUSY)
+      scond_wait(cold->cond, cold->lock);
+}
+
+static void state_cold_free(struct state_manager_cold *cold)
+{
+   if (!cold)
+      return;
+
+   if (cold->thread)
+   {
+      slock_lock(cold->lock);
+      cold->quit = true;
+      scond_broadcast(cold->cond);
+      slock_unlock(cold->lock);
+      sthread_join(cold->thread);
+   }
+
+   while (cold->oldest)
+   {
+      state_cold_chunk_t *next = cold->oldest->next;
+      state_cold_chunk_free(cold->oldest);
+      cold->oldest             = next;
+   }
+
+   if (cold->cond)
+      scond_free(cold->cond);
+   if (cold->lock)
+      slock_free(cold->lock);
+   free(cold);
+}
+
+static struct state_manager_cold *state_cold_new(size_t budget)
+{
+   struct state_manager_cold *cold = (struct state_manager_cold*)
+      calloc(1, sizeof(*cold));
+
+   if (!cold)
+      return NULL;
+
+   cold->budget = budget;
+   cold->lock   = slock_new();
+   cold->cond   = scond_new();
+
+   if (!cold->lock || !cold->cond)
+      goto error;
+
+   cold->thread = sthread_create(state_cold_thread, cold);
+   if (!cold->thread)
+      goto error;
+
+   return cold;
+
+error:
+   state_cold_free(cold);
+   return NULL;
+}
+
+/* Drops every chunk. Must be called with the lock held.
+ * Returns the number of entries dropped. */
+static unsigned state_cold_clear(struct state_manager_cold *cold)
+{
+   unsigned dropped = cold->entries;
+
+   while (cold->oldest)
+   {
+      state_cold_chunk_t *next = cold->oldest->next;
+      state_cold_wait_chunk(cold, cold->oldest);
+      state_cold_chunk_free(cold->oldest);
+      cold->oldest             = next;
+   }
+
+   cold->newest  = NULL;
+   cold->used    = 0;
+   cold->entries = 0;
+
+   return dropped;
+}
+
+/* Appends a patch evicted from the ring buffer.
+ * Returns the number of entries dropped to stay within
+ * budget, including 'patch' itself if it couldn't be
+ * stored. Every patch is a delta against the next newer
+ * one, so losing one breaks the chain behind it: the
+ * whole cold tier goes with it. */
+static unsigned state_cold_push(struct state_manager_cold *cold,
+      const uint8_t *patch, size_t len)
+{
+   unsigned dropped          = 0;
+   size_t need               = len + sizeof(size_t);
+   state_cold_chunk_t *chunk = NULL;
+
+   slock_lock(cold->lock);
+
+   chunk                     = cold->newest;
+
+   if (chunk && chunk->status == STATE_COLD_CHUNK_FILLING
+         && chunk->size + need > STATE_MANAGER_COLD_CHUNK
+         && chunk->size)
+   {
+      chunk->status          = STATE_COLD_CHUNK_QUEUED;
+      scond_signal(cold->cond);
+   }
+
+   if (!chunk || chunk->status != STATE_COLD_CHUNK_FILLING)
+   {
+      chunk                  = (state_cold_chunk_t*)calloc(1, sizeof(*chunk));
+      if (!chunk)
+         goto error;
+
+      chunk->prev            = cold->newest;
+      if (cold->newest)
+         cold->newest->next  = chunk;
+      else
+         cold->oldest        = chunk;
+      cold->newest           = chunk;
+   }
+
+   if (chunk->size + need > chunk->capacity)
+   {
+      size_t new_cap         = chunk->capacity ? chunk->capacity * 2
+         : STATE_MANAGER_COLD_CHUNK / 4;
+      uint8_t *new_data      = NULL;
+
+      while (new_cap < chunk->size + need)
+         new_cap            *= 2;
+
+      new_data               = (uint8_t*)realloc(chunk->data, new_cap);
+      if (!new_data)
+         goto error;
+
+      memory_tag_add(MEMORY_TAG_REWIND,
+            (int64_t)new_cap - (int64_t)chunk->capacity);
+      chunk->data            = new_data;
+      chunk->capacity        = new_cap;
+   }
+
+   memcpy(chunk->data + chunk->size, patch, len);
+   write_size_t(chunk->data + chunk->size + len, len);
+   chunk->size              += need;
+   chunk->raw_size           = chunk->size;
+   chunk->entries++;
+   cold->used               += need;
+   cold->entries++;
+
+   /* Drop the oldest chunks (never the one we just wrote to) */
+   while (cold->used > cold->budget && cold->oldest != cold->newest)
+   {
+      state_cold_chunk_t *oldest = cold->oldest;
+
+      state_cold_wait_chunk(cold, oldest);
+
+      cold->oldest           = oldest->next;
+      cold->oldest->prev     = NULL;
+      cold->used            -= oldest->size;
+      cold->entries         -= oldest->entries;
+      dropped               += oldest->entries;
+      state_cold_chunk_free(oldest);
+   }
+
+   slock_unlock(cold->lock);
+   return dropped;
+
+error:
+   dropped                   = state_cold_clear(cold) + 1;
+   slock_unlock(cold->lock);
+   return dropped;
+}
+
+/* Pops the newest patch and applies it to 'data'. */
+static bool state_cold_pop(struct state_manager_cold *cold,
+      uint8_t *data, size_t datalen)
+{
+   size_t len;
+   bool ret                  = false;
+   state_cold_chunk_t *chunk = NULL;
+
+   slock_lock(cold->lock);
+
+   chunk                     = cold->newest;
+   if (!chunk)
+      goto end;
+
+   state_cold_wait_chunk(cold, chunk);
+
+   if (chunk->status == STATE_COLD_CHUNK_COMPRESSED)
+   {
+      size_t comp_size       = chunk->size;
+      if (!state_cold_decompress(chunk))
+         goto end;
+      cold->used            -= comp_size;
+      cold->used            += chunk->size;
+   }
+
+   /* Not worth compressing anymore, we're reading from it */
+   chunk->status             = STATE_COLD_CHUNK_FILLING;
+
+   len                       = read_size_t(
+         chunk->data + chunk->size - sizeof(size_t));
+   chunk->size              -= len + sizeof(size_t);
+   chunk->raw_size           = chunk->size;
+   chunk->entries--;
+   cold->used               -= len + sizeof(size_t);
+   cold->entries--;
+
+   state_manager_raw_decompress(chunk->data + chunk->size,
+         len, data, datalen);
+
+   if (!chunk->entries)
+   {
+      cold->newest           = chunk->prev;
+      if (cold->newest)
+         cold->newest->next  = NULL;
+      else
+         cold->oldest        = NULL;
+      state_cold_chunk_free(chunk);
+   }
+
+   ret                       = true;
+
+end:
+   slock_unlock(cold->lock);
+   return ret;
+}
+#endif
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
       return;
 
+   memory_tag_add(MEMORY_TAG_REWIND, -(int64_t)state->tagged_size);
+   state->tagged_size = 0;
+
    if (state->data)
-      free(state->data);
+      memalign_free_large(state->data);
    if (state->thisblock)
-      free(state->thisblock);
+      memalign_free_large(state->thisblock);
    if (state->nextblock)
-      free(state->nextblock);
+      memalign_free_large(state->nextblock);
+#ifdef STATE_MANAGER_COLD
+   state_cold_free(state->cold);
+   state->cold        = NULL;
+#endif
 #if STRICT_BUF_SIZE
    if (state->debugblock)
       free(state->debugblock);
@@ -395,34 +960,39 @@ static state_manager_t *state_manager_new(
       size_t state_size, size_t buffer_size)
 {
    size_t max_comp_size, block_size;
-   uint8_t *next_block    = NULL;
-   uint8_t *this_block    = NULL;
-   uint8_t *state_data    = NULL;
+   size_t hot_size        = buffer_size;
    state_manager_t *state = (state_manager_t*)calloc(1, sizeof(*state));
 
    if (!state)
       return NULL;
 
+   find_change_init_simd();
+
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
    /* the compressed data is surrounded by pointers to the other side */
    max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
-   state_data         = (uint8_t*)malloc(buffer_size);
 
-   if (!state_data)
-      goto error;
+#ifdef STATE_MANAGER_COLD
+   /* Only the most recent quarter of the buffer is kept
+    * uncompressed, the rest is used by the cold tier. */
+   if (buffer_size / 4 >= max_comp_size * 4)
+   {
+      state->cold     = state_cold_new(buffer_size - buffer_size / 4);
+      if (state->cold)
+         hot_size     = buffer_size / 4;
+   }
+#endif
 
-   this_block         = (uint8_t*)state_manager_raw_alloc(state_size, 0);
-   next_block         = (uint8_t*)state_manager_raw_alloc(state_size, 1);
+   state->data        = (uint8_t*)memalign_alloc_large(hot_size);
+   state->thisblock   = (uint8_t*)state_manager_raw_alloc(state_size, 0);
+   state->nextblock   = (uint8_t*)state_manager_raw_alloc(state_size, 1);
 
-   if (!this_block || !next_block)
+   if (!state->data || !state->thisblock || !state->nextblock)
       goto error;
 
    state->blocksize   = block_size;
    state->maxcompsize = max_comp_size;
-   state->data        = state_data;
-   state->thisblock   = this_block;
-   state->nextblock   = next_block;
-   state->capacity    = buffer_size;
+   state->capacity    = hot_size;
 
    state->head        = state->data + sizeof(size_t);
    state->tail        = state->data + sizeof(size_t);
@@ -432,17 +1002,38 @@ static state_manager_t *state_manager_new(
    state->debugblock  = (uint8_t*)malloc(state_size);
 #endif
 
+   state->tagged_size = hot_size + block_size * 2;
+   memory_tag_add(MEMORY_TAG_REWIND, (int64_t)state->tagged_size);
+
    return state;
 
 error:
-   if (state_data)
-      free(state_data);
    state_manager_free(state);
    free(state);
 
    return NULL;
 }
 
+/* Drops the oldest patch from the ring buffer,
+ * handing it to the cold tier if there is one. */
+static void state_manager_evict_tail(state_manager_t *state)
+{
+   size_t next = read_size_t(state->tail);
+
+#ifdef STATE_MANAGER_COLD
+   if (state->cold)
+   {
+      const uint8_t *patch = state->tail + sizeof(size_t);
+      state->entries      -= state_cold_push(state->cold, patch,
+            state_manager_raw_patchlen(patch));
+   }
+   else
+#endif
+      state->entries--;
+
+   state->tail  = state->data + next;
+}
+
 static bool state_manager_pop(state_manager_t *state, const void **data)
 {
    size_t start;
@@ -461,7 +1052,17 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data                        = state->thisblock;
    if (state->head == state->tail)
+   {
+#ifdef STATE_MANAGER_COLD
+      if (state->cold && state_cold_pop(state->cold,
+               state->thisblock, state->blocksize))
+      {
+         state->entries--;
+         return true;
+      }
+#endif
       return false;
+   }
 
    start                        = read_size_t(state->head - sizeof(size_t));
    state->head                  = state->data + start;
@@ -521,8 +1122,7 @@ recheckcapacity:;
 
       if (remaining <= state->maxcompsize)
       {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
+         state_manager_evict_tail(state);
          goto recheckcapacity;
       }
 
@@ -537,7 +1137,7 @@ recheckcapacity:;
       {
          compressed     = state->data;
          if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
+            state_manager_evict_tail(state);
       }
       write_size_t(compressed, state->head-state->data);
       compressed       += sizeof(size_t);
@@ -36,6 +36,9 @@ struct state_manager
 
    uint8_t *thisblock;
    uint8_t *nextblock;
+   /* Older patches evicted from 'data', compressed in
+    * the background. NULL if not available. */
+   struct state_manager_cold *cold;
 #if STRICT_BUF_SIZE
    uint8_t *debugblock;
    size_t debugsize;
@@ -49,6 +52,9 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+   /* Bytes reported to the rewind memory tag */
+   size_t tagged_size;
+
    unsigned entries;
    bool thisblock_valid;
 };
@@ -35,6 +35,10 @@
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
 
+/* Files at least this large are streamed from disk
+ * by the mixer instead of being read into memory */
+#define AUDIO_MIXER_STREAM_MIN_SIZE (1024 * 1024)
+
 struct audio_mixer_userdata
 {
    unsigned slot_selection_idx;
@@ -115,6 +119,7 @@ static void task_audio_mixer_handle_upload_ogg(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -147,6 +152,7 @@ static void task_audio_mixer_handle_upload_ogg_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -179,6 +185,7 @@ static void task_audio_mixer_handle_upload_flac(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -211,6 +218,7 @@ static void task_audio_mixer_handle_upload_flac_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -243,6 +251,7 @@ static void task_audio_mixer_handle_upload_mp3(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -275,6 +284,7 @@ static void task_audio_mixer_handle_upload_mp3_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -307,6 +317,7 @@ static void task_audio_mixer_handle_upload_mod(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -339,6 +350,7 @@ static void task_audio_mixer_handle_upload_mod_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -372,6 +384,7 @@ static void task_audio_mixer_handle_upload_wav(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_STOPPED;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -404,6 +417,7 @@ static void task_audio_mixer_handle_upload_wav_and_play(retro_task_t *task,
    params.state                = AUDIO_STREAM_STATE_PLAYING;
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
+   params.path                 = img->buf ? NULL : img->path;
    params.cb                   = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
@@ -418,6 +432,35 @@ static void task_audio_mixer_handle_upload_wav_and_play(retro_task_t *task,
 }
 #endif
 
+static void task_audio_mixer_stream_handler(retro_task_t *task)
+{
+   nbio_handle_t *nbio = (nbio_handle_t*)task->state;
+   nbio_buf_t    *img  = (nbio_buf_t*)calloc(1, sizeof(*img));
+
+   /* Nothing to read, the mixer opens the file itself */
+   if (img)
+      img->path = strdup(nbio->path);
+
+   task_set_data(task, img);
+   task_set_finished(task, true);
+}
+
+static bool task_audio_mixer_can_stream(const char *path,
+      enum audio_mixer_type type)
+{
+   switch (type)
+   {
+      case AUDIO_MIXER_TYPE_WAV:
+      case AUDIO_MIXER_TYPE_FLAC:
+      case AUDIO_MIXER_TYPE_MP3:
+         return path_get_size(path) >= AUDIO_MIXER_STREAM_MIN_SIZE;
+      default:
+         break;
+   }
+
+   return false;
+}
+
 bool task_audio_mixer_load_handler(retro_task_t *task)
 {
    nbio_handle_t             *nbio  = (nbio_handle_t*)task->state;
@@ -551,7 +594,9 @@ bool task_push_audio_mixer_load_and_play(
    nbio->status              = NBIO_STATUS_INIT;
 
    t->state           = nbio;
-   t->handler         = task_file_load_handler;
+   t->handler         = task_audio_mixer_can_stream(fullpath, mixer->type)
+      ? task_audio_mixer_stream_handler
+      : task_file_load_handler;
    t->cleanup         = task_audio_mixer_load_free;
    t->user_data       = user;
 
@@ -683,7 +728,10 @@ bool task_push_audio_mixer_load(
    user->slot_selection_idx  = slot_selection_idx;
 
    t->state                  = nbio;
-   t->handler                = task_file_load_handler;
+   t->handler                = task_audio_mixer_can_stream(
+         fullpath, mixer->type)
+      ? task_audio_mixer_stream_handler
+      : task_file_load_handler;
    t->cleanup                = task_audio_mixer_load_free;
    t->user_data              = user;
 
@@ -42,6 +42,9 @@ bool task_push_bluetooth_scan(retro_task_callback_t cb)
    if (!task)
       return false;
 
+   /* The scan runs on the task thread */
+   bluetooth_driver_ctl(RARCH_BLUETOOTH_CTL_INIT_DEFERRED, NULL);
+
    /* blocking means no other task can run while this one is running,
     * which is the default */
    task->type           = TASK_TYPE_BLOCKING;
@@ -49,6 +49,17 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
 #include <boolean.h>
 
 #include <encodings/crc32.h>
@@ -66,6 +77,7 @@
 #include <retro_miscellaneous.h>
 #include <streams/file_stream.h>
 #include <retro_assert.h>
+#include <features/features_cpu.h>
 
 #include <lists/string_list.h>
 #include <string/stdstring.h>
@@ -106,6 +118,7 @@
 #include "../retroarch.h"
 #include "../file_path_special.h"
 #include "../core.h"
+#include "../memory_tags.h"
 #include "../paths.h"
 #include "../verbosity.h"
 
@@ -118,6 +131,10 @@ extern bool discord_is_inited;
 
 #define MAX_ARGS 32
 
+/* Uncompressed content at least this large is mapped
+ * instead of read into memory */
+#define CONTENT_MMAP_MIN_SIZE (16 * 1024 * 1024)
+
 typedef struct content_stream content_stream_t;
 typedef struct content_information_ctx content_information_ctx_t;
 
@@ -141,6 +158,10 @@ struct content_information_ctx
 
    struct string_list *temporary_content;
 
+   /* Size of the mapping backing each loaded content
+    * file, 0 when it was read into a buffer */
+   size_t *mapped_sizes;
+
    struct
    {
       struct retro_subsystem_info *data;
@@ -469,6 +490,52 @@ void task_push_cdrom_dump(const char *drive)
 }
 #endif
 
+#ifdef HAVE_MMAP
+/* Maps the file at 'path' copy-on-write. Like with
+ * filestream_read_file(), the data is followed by a '\0':
+ * the mapping is placed on an anonymous one that is one
+ * byte longer. Returns NULL for small files or on error. */
+static void *content_file_mmap(const char *path, int64_t *length)
+{
+   struct stat st;
+   size_t len;
+   void *base = MAP_FAILED;
+   int fd     = open(path, O_RDONLY);
+
+   if (fd < 0)
+      return NULL;
+
+   if (     fstat(fd, &st) != 0
+         || !S_ISREG(st.st_mode)
+         || st.st_size < CONTENT_MMAP_MIN_SIZE
+         || (uint64_t)st.st_size >= (uint64_t)SIZE_MAX)
+   {
+      close(fd);
+      return NULL;
+   }
+
+   len  = (size_t)st.st_size;
+   base = mmap(NULL, len + 1, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+   if (     base != MAP_FAILED
+         && mmap(base, len, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+   {
+      munmap(base, len + 1);
+      base = MAP_FAILED;
+   }
+
+   close(fd);
+
+   if (base == MAP_FAILED)
+      return NULL;
+
+   *length = (int64_t)len;
+   return base;
+}
+#endif
+
 static int64_t content_file_read(const char *path, void **buf, int64_t *length)
 {
 #ifdef HAVE_COMPRESSION
@@ -568,6 +635,7 @@ static bool content_load(content_ctx_info_t *info,
    char **rarch_argv_ptr             = (char**)info->argv;
    int *rarch_argc_ptr               = (int*)&info->argc;
    struct rarch_main_wrap *wrap_args = NULL;
+   retro_time_t start_usec           = 0;
 
    if (!(wrap_args = (struct rarch_main_wrap*)
       malloc(sizeof(*wrap_args))))
@@ -613,6 +681,8 @@ static bool content_load(content_ctx_info_t *info,
    if (!success)
       return false;
 
+   start_usec      = cpu_features_get_time_usec();
+
    if (p_content->pending_subsystem_init)
    {
       command_event(CMD_EVENT_CORE_INIT, NULL);
@@ -651,9 +721,26 @@ static bool content_load(content_ctx_info_t *info,
    frontend_driver_process_args(rarch_argc_ptr, rarch_argv_ptr);
    frontend_driver_content_loaded();
 
+   retroarch_startup_trace_add("Shaders, history and favorites", start_usec);
+
    return true;
 }
 
+#if defined(HAVE_MMAP) && defined(HAVE_PATCH)
+static bool content_file_has_patch(content_information_ctx_t *content_ctx)
+{
+   if (content_ctx->patch_is_blocked)
+      return false;
+
+   return (!string_is_empty(content_ctx->name_ips)
+            && path_is_valid(content_ctx->name_ips))
+      ||  (!string_is_empty(content_ctx->name_bps)
+            && path_is_valid(content_ctx->name_bps))
+      ||  (!string_is_empty(content_ctx->name_ups)
+            && path_is_valid(content_ctx->name_ups));
+}
+#endif
+
 /**
  * load_content_into_memory:
  * @path         : buffer of the content file.
@@ -673,10 +760,28 @@ static bool load_content_into_memory(
       int64_t *length)
 {
    uint8_t *ret_buf           = NULL;
+   bool is_mapped             = false;
 
    RARCH_LOG("[CONTENT LOAD]: %s: %s.\n",
          msg_hash_to_str(MSG_LOADING_CONTENT_FILE), path);
 
+#ifdef HAVE_MMAP
+   /* Patching replaces the buffer, so only content which
+    * will not be patched is mapped */
+   if (     content_ctx->mapped_sizes
+#ifdef HAVE_COMPRESSION
+         && !path_contains_compressed_file(path)
+#endif
+#ifdef HAVE_PATCH
+         && !(i == 0 && content_file_has_patch(content_ctx))
+#endif
+         && (ret_buf = (uint8_t*)content_file_mmap(path, length)))
+   {
+      content_ctx->mapped_sizes[i] = (size_t)*length + 1;
+      is_mapped                    = true;
+   }
+   else
+#endif
    if (!content_file_read(path, (void**) &ret_buf, length))
       return false;
 
@@ -697,7 +802,7 @@ static bool load_content_into_memory(
           * CRC checking, etc. */
 
          /* Attempt to apply a patch. */
-         if (!content_ctx->patch_is_blocked)
+         if (!content_ctx->patch_is_blocked && !is_mapped)
             has_patch = patch_content(
                   content_ctx->is_ips_pref,
                   content_ctx->is_bps_pref,
@@ -932,6 +1037,7 @@ static bool content_file_load(
          }
 
          info[i].size = len;
+         memory_tag_add(MEMORY_TAG_CORE, (int64_t)len);
       }
       else
       {
@@ -1221,7 +1327,12 @@ static bool content_file_init(
    {
       unsigned i;
       struct string_list additional_path_allocs;
-      
+
+#ifdef HAVE_MMAP
+      content_ctx->mapped_sizes = (size_t*)
+         calloc(content->size, sizeof(size_t));
+#endif
+
       if (string_list_initialize(&additional_path_allocs))
       {
          ret = content_file_load(info, p_content,
@@ -1232,7 +1343,19 @@ static bool content_file_init(
       }
 
       for (i = 0; i < content->size; i++)
-         free((void*)info[i].data);
+      {
+         memory_tag_add(MEMORY_TAG_CORE, -(int64_t)info[i].size);
+#ifdef HAVE_MMAP
+         if (content_ctx->mapped_sizes && content_ctx->mapped_sizes[i])
+            munmap((void*)info[i].data, content_ctx->mapped_sizes[i]);
+         else
+#endif
+            free((void*)info[i].data);
+      }
+
+      if (content_ctx->mapped_sizes)
+         free(content_ctx->mapped_sizes);
+      content_ctx->mapped_sizes = NULL;
 
       free(info);
    }
@@ -1515,6 +1638,7 @@ bool task_push_start_dummy_core(content_ctx_info_t *content_info)
    content_ctx.bios_is_missing                = rarch_ctl(RARCH_CTL_IS_MISSING_BIOS, NULL);
    content_ctx.directory_system               = NULL;
    content_ctx.directory_cache                = NULL;
+   content_ctx.mapped_sizes                   = NULL;
    content_ctx.name_ips                       = NULL;
    content_ctx.name_bps                       = NULL;
    content_ctx.name_ups                       = NULL;
@@ -1549,6 +1673,7 @@ bool task_push_start_dummy_core(content_ctx_info_t *content_info)
     * load the actual content. Can differ per mode. */
    sys_info->load_no_content = false;
    rarch_ctl(RARCH_CTL_STATE_FREE, NULL);
+   playlist_write_deferred_flush();
    task_queue_deinit();
    retroarch_init_task_queue();
 
@@ -1612,6 +1737,7 @@ bool task_push_load_content_from_playlist_from_menu(
    content_ctx.bios_is_missing                = rarch_ctl(RARCH_CTL_IS_MISSING_BIOS, NULL);
    content_ctx.directory_system               = NULL;
    content_ctx.directory_cache                = NULL;
+   content_ctx.mapped_sizes                   = NULL;
    content_ctx.name_ips                       = NULL;
    content_ctx.name_bps                       = NULL;
    content_ctx.name_ups                       = NULL;
@@ -1754,6 +1880,7 @@ bool task_push_start_current_core(content_ctx_info_t *content_info)
    content_ctx.bios_is_missing                = rarch_ctl(RARCH_CTL_IS_MISSING_BIOS, NULL);
    content_ctx.directory_system               = NULL;
    content_ctx.directory_cache                = NULL;
+   content_ctx.mapped_sizes                   = NULL;
    content_ctx.name_ips                       = NULL;
    content_ctx.name_bps                       = NULL;
    content_ctx.name_ups                       = NULL;
@@ -1894,6 +2021,7 @@ bool task_push_load_content_with_new_core_from_menu(
    content_ctx.bios_is_missing                = rarch_ctl(RARCH_CTL_IS_MISSING_BIOS, NULL);
    content_ctx.directory_system               = NULL;
    content_ctx.directory_cache                = NULL;
+   content_ctx.mapped_sizes                   = NULL;
    content_ctx.name_ips                       = NULL;
    content_ctx.name_bps                       = NULL;
    content_ctx.name_ups                       = NULL;
@@ -2005,6 +2133,7 @@ static bool task_load_content_internal(
    content_ctx.bios_is_missing                = rarch_ctl(RARCH_CTL_IS_MISSING_BIOS, NULL);
    content_ctx.directory_system               = NULL;
    content_ctx.directory_cache                = NULL;
+   content_ctx.mapped_sizes                   = NULL;
    content_ctx.name_ips                       = NULL;
    content_ctx.name_bps                       = NULL;
    content_ctx.name_ups                       = NULL;
@@ -2418,6 +2547,14 @@ uint32_t content_get_crc(void)
    return p_content->rom_crc;
 }
 
+uint32_t content_peek_crc(void)
+{
+   content_state_t *p_content = content_state_get_ptr();
+   if (p_content->pending_rom_crc)
+      return 0;
+   return p_content->rom_crc;
+}
+
 char* content_get_subsystem_rom(unsigned index)
 {
    content_state_t *p_content = content_state_get_ptr();
@@ -2501,6 +2638,7 @@ bool content_init(void)
    content_ctx.temporary_content              = p_content->temporary_content;
    content_ctx.directory_system               = NULL;
    content_ctx.directory_cache                = NULL;
+   content_ctx.mapped_sizes                   = NULL;
    content_ctx.name_ips                       = NULL;
    content_ctx.name_bps                       = NULL;
    content_ctx.name_ups                       = NULL;
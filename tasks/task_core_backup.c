@@ -23,6 +23,7 @@
 #include <boolean.h>
 
 #include <string/stdstring.h>
+#include <encodings/crc32.h>
 #include <file/file_path.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
@@ -40,7 +41,10 @@
 #include "../play_feature_delivery/play_feature_delivery.h"
 #endif
 
-#define CORE_BACKUP_CHUNK_SIZE 4096
+/* Data copied per task iteration, large enough that a
+ * core is copied in tens of iterations rather than
+ * thousands */
+#define CORE_BACKUP_CHUNK_SIZE (256 * 1024)
 
 enum core_backup_status
 {
@@ -68,6 +72,11 @@ typedef struct core_backup_handle
    char *core_path;
    char *core_name;
    char *backup_path;
+   /* Set while a backup is written without knowing the
+    * core CRC; renamed once it is known, deleted on
+    * failure */
+   char *backup_tmp_path;
+   uint8_t *buffer;
    intfstream_t *core_file;
    intfstream_t *backup_file;
    core_backup_list_t *backup_list;
@@ -116,6 +125,12 @@ static void free_core_backup_handle(core_backup_handle_t *backup_handle)
       backup_handle->backup_path = NULL;
    }
 
+   if (backup_handle->buffer)
+   {
+      free(backup_handle->buffer);
+      backup_handle->buffer = NULL;
+   }
+
    if (backup_handle->core_file)
    {
       intfstream_close(backup_handle->core_file);
@@ -130,6 +145,15 @@ static void free_core_backup_handle(core_backup_handle_t *backup_handle)
       backup_handle->backup_file = NULL;
    }
 
+   /* Backup was never completed */
+   if (backup_handle->backup_tmp_path)
+   {
+      if (path_is_valid(backup_handle->backup_tmp_path))
+         filestream_delete(backup_handle->backup_tmp_path);
+      free(backup_handle->backup_tmp_path);
+      backup_handle->backup_tmp_path = NULL;
+   }
+
    if (backup_handle->backup_list)
    {
       core_backup_list_free(backup_handle->backup_list);
@@ -179,6 +203,77 @@ static bool task_core_backup_finder(retro_task_t *task, void *user_data)
 /* Core Backup */
 /***************/
 
+/* Returns true if a backup of the current core
+ * CRC already exists. An automatic backup is also
+ * redundant if there is a manual one - manual backups
+ * are never pruned */
+static bool task_core_backup_find_crc(core_backup_handle_t *backup_handle,
+      const core_backup_list_entry_t **entry)
+{
+   if (!backup_handle->backup_list)
+      return false;
+
+   if (core_backup_list_get_crc(backup_handle->backup_list,
+            backup_handle->core_crc, backup_handle->backup_mode, entry))
+      return true;
+
+   return (backup_handle->backup_mode == CORE_BACKUP_MODE_AUTO)
+      && core_backup_list_get_crc(backup_handle->backup_list,
+            backup_handle->core_crc, CORE_BACKUP_MODE_MANUAL, entry);
+}
+
+/* Called once all core data has been written to the
+ * temporary backup file. Returns false on error */
+static bool task_core_backup_finalise(core_backup_handle_t *backup_handle)
+{
+   const core_backup_list_entry_t *entry = NULL;
+   char backup_path[PATH_MAX_LENGTH];
+
+   backup_path[0] = '\0';
+
+   /* Identical to an existing backup, which only
+    * the CRC computed while copying could tell */
+   if (task_core_backup_find_crc(backup_handle, &entry))
+   {
+      RARCH_LOG("[core backup] Current version of core is already backed up: %s\n",
+            entry->backup_path);
+
+      filestream_delete(backup_handle->backup_tmp_path);
+      free(backup_handle->backup_tmp_path);
+      backup_handle->backup_tmp_path = NULL;
+      backup_handle->crc_match       = true;
+      return true;
+   }
+
+   if (!core_backup_get_backup_path(
+         backup_handle->core_path,
+         backup_handle->core_crc,
+         backup_handle->backup_mode,
+         backup_handle->dir_core_assets,
+         backup_path, sizeof(backup_path)))
+   {
+      RARCH_ERR("[core backup] Failed to generate backup path for core file: %s\n",
+            backup_handle->core_path);
+      return false;
+   }
+
+   if (filestream_rename(backup_handle->backup_tmp_path, backup_path) != 0)
+   {
+      RARCH_ERR("[core backup] Failed to rename core backup file: %s\n",
+            backup_handle->backup_tmp_path);
+      return false;
+   }
+
+   free(backup_handle->backup_tmp_path);
+   backup_handle->backup_tmp_path = NULL;
+
+   if (backup_handle->backup_path)
+      free(backup_handle->backup_path);
+   backup_handle->backup_path     = strdup(backup_path);
+
+   return true;
+}
+
 static void task_core_backup_handler(retro_task_t *task)
 {
    core_backup_handle_t *backup_handle = NULL;
@@ -230,30 +325,16 @@ static void task_core_backup_handler(retro_task_t *task)
          backup_handle->status = CORE_BACKUP_CHECK_CRC;
          break;
       case CORE_BACKUP_CHECK_CRC:
-         /* Check whether we need to calculate CRC value */
-         if (backup_handle->core_crc == 0)
-         {
-            if (!intfstream_get_crc(backup_handle->core_file,
-                     &backup_handle->core_crc))
-            {
-               RARCH_ERR("[core backup] Failed to determine CRC of core file: %s\n",
-                     backup_handle->core_path);
-               backup_handle->status = CORE_BACKUP_END;
-               break;
-            }
-         }
-
-         /* Check whether a backup with this CRC already
-          * exists */
-         if (backup_handle->backup_list)
+         /* If the CRC is not known in advance it is
+          * computed while copying, instead of reading
+          * the whole core twice - see CORE_BACKUP_ITERATE */
+         if (backup_handle->core_crc != 0)
          {
             const core_backup_list_entry_t *entry = NULL;
 
-            if (core_backup_list_get_crc(
-                     backup_handle->backup_list,
-                     backup_handle->core_crc,
-                     backup_handle->backup_mode,
-                     &entry))
+            /* Check whether a backup with this CRC already
+             * exists */
+            if (task_core_backup_find_crc(backup_handle, &entry))
             {
                RARCH_LOG("[core backup] Current version of core is already backed up: %s\n",
                      entry->backup_path);
@@ -292,13 +373,28 @@ static void task_core_backup_handler(retro_task_t *task)
 
             backup_handle->backup_path = strdup(backup_path);
 
+            /* Without a CRC the final name is not known
+             * yet, write to a temporary file next to it */
+            if (backup_handle->core_crc == 0)
+            {
+               strlcat(backup_path, ".tmp", sizeof(backup_path));
+               backup_handle->backup_tmp_path = strdup(backup_path);
+            }
+
+            if (!(backup_handle->buffer = (uint8_t*)malloc(
+                        CORE_BACKUP_CHUNK_SIZE)))
+            {
+               backup_handle->status = CORE_BACKUP_END;
+               break;
+            }
+
             /* Open backup file */
 #if defined(HAVE_ZLIB)
             backup_handle->backup_file = intfstream_open_rzip_file(
-                  backup_handle->backup_path, RETRO_VFS_FILE_ACCESS_WRITE);
+                  backup_path, RETRO_VFS_FILE_ACCESS_WRITE);
 #else
             backup_handle->backup_file = intfstream_open_file(
-                  backup_handle->backup_path, RETRO_VFS_FILE_ACCESS_WRITE,
+                  backup_path, RETRO_VFS_FILE_ACCESS_WRITE,
                   RETRO_VFS_FILE_ACCESS_HINT_NONE);
 #endif
             if (!backup_handle->backup_file)
@@ -323,10 +419,10 @@ static void task_core_backup_handler(retro_task_t *task)
       case CORE_BACKUP_ITERATE:
          {
             int64_t data_written = 0;
-            uint8_t buffer[CORE_BACKUP_CHUNK_SIZE];
+            uint8_t *buffer      = backup_handle->buffer;
             /* Read a single chunk from the core file */
             int64_t data_read    = intfstream_read(
-                  backup_handle->core_file, buffer, sizeof(buffer));
+                  backup_handle->core_file, buffer, CORE_BACKUP_CHUNK_SIZE);
 
             if (data_read < 0)
             {
@@ -352,17 +448,33 @@ static void task_core_backup_handler(retro_task_t *task)
                free(backup_handle->backup_file);
                backup_handle->backup_file = NULL;
 
+               if (backup_handle->backup_tmp_path)
+               {
+                  backup_handle->core_crc = backup_handle->backup_crc;
+
+                  if (!task_core_backup_finalise(backup_handle))
+                  {
+                     backup_handle->status = CORE_BACKUP_END;
+                     break;
+                  }
+               }
+
                backup_handle->success = true;
 
                /* If this is an automatic backup, check whether
                 * any old backup files should be deleted.
                 * In all other cases, backup is complete */
-               backup_handle->status  = (backup_handle->backup_mode ==
-                     CORE_BACKUP_MODE_AUTO) ?
+               backup_handle->status  = (!backup_handle->crc_match &&
+                     (backup_handle->backup_mode == CORE_BACKUP_MODE_AUTO)) ?
                            CORE_BACKUP_CHECK_HISTORY : CORE_BACKUP_END;
                break;
             }
 
+            /* CRC of the data as it is copied */
+            if (backup_handle->backup_tmp_path)
+               backup_handle->backup_crc = encoding_crc32(
+                     backup_handle->backup_crc, buffer, (size_t)data_read);
+
             /* Write chunk to backup file */
             data_written = intfstream_write(backup_handle->backup_file, buffer, data_read);
 
@@ -582,6 +694,8 @@ void *task_push_core_backup(
    backup_handle->core_path                  = strdup(core_path);
    backup_handle->core_name                  = strdup(core_name);
    backup_handle->backup_path                = NULL;
+   backup_handle->backup_tmp_path            = NULL;
+   backup_handle->buffer                     = NULL;
    backup_handle->backup_type                = CORE_BACKUP_TYPE_ARCHIVE;
    backup_handle->backup_mode                = backup_mode;
    backup_handle->auto_backup_history_size   = auto_backup_history_size;
@@ -743,6 +857,13 @@ static void task_core_restore_handler(retro_task_t *task)
 
             task_title[0] = '\0';
 
+            if (!(backup_handle->buffer = (uint8_t*)malloc(
+                        CORE_BACKUP_CHUNK_SIZE)))
+            {
+               backup_handle->status = CORE_RESTORE_END;
+               break;
+            }
+
             /* Open backup file */
 #if defined(HAVE_ZLIB)
             backup_handle->backup_file = intfstream_open_rzip_file(
@@ -822,10 +943,11 @@ static void task_core_restore_handler(retro_task_t *task)
          {
             int64_t data_read    = 0;
             int64_t data_written = 0;
-            uint8_t buffer[CORE_BACKUP_CHUNK_SIZE];
+            uint8_t *buffer      = backup_handle->buffer;
 
             /* Read a single chunk from the backup file */
-            data_read = intfstream_read(backup_handle->backup_file, buffer, sizeof(buffer));
+            data_read = intfstream_read(backup_handle->backup_file, buffer,
+                  CORE_BACKUP_CHUNK_SIZE);
 
             if (data_read < 0)
             {
@@ -1023,6 +1145,8 @@ bool task_push_core_restore(const char *backup_path, const char *dir_libretro,
    backup_handle->core_path                  = strdup(core_path);
    backup_handle->core_name                  = strdup(core_name);
    backup_handle->backup_path                = strdup(backup_path);
+   backup_handle->backup_tmp_path            = NULL;
+   backup_handle->buffer                     = NULL;
    backup_handle->backup_type                = backup_type;
    backup_handle->backup_mode                = CORE_BACKUP_MODE_MANUAL;
    backup_handle->auto_backup_history_size   = 0;
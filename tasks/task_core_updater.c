@@ -27,6 +27,10 @@
 #include <net/net_http.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+#include <streams/trans_stream.h>
+#include <encodings/crc32.h>
+#endif
 
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
@@ -67,6 +71,41 @@ typedef struct core_updater_list_handle
    bool http_task_success;
 } core_updater_list_handle_t;
 
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+/* Extraction of core archives while they download */
+#define CORE_UPDATER_ZIP_LOCAL_SIG    0x04034b50
+#define CORE_UPDATER_ZIP_CENTRAL_SIG  0x02014b50
+#define CORE_UPDATER_ZIP_HEADER_SIZE  30
+/* Longest file name + extra field we accept */
+#define CORE_UPDATER_ZIP_MAX_NAME     1024
+#define CORE_UPDATER_ZIP_OUT_SIZE     (64 * 1024)
+
+enum core_updater_unzip_status
+{
+   CORE_UPDATER_UNZIP_HEADER = 0,
+   CORE_UPDATER_UNZIP_DATA,
+   CORE_UPDATER_UNZIP_DONE,
+   CORE_UPDATER_UNZIP_FAILED
+};
+
+typedef struct core_updater_unzip
+{
+   RFILE *file;    /* Entry being extracted */
+   void *inflate;  /* NULL for stored entries */
+   uint8_t header[CORE_UPDATER_ZIP_HEADER_SIZE + CORE_UPDATER_ZIP_MAX_NAME];
+   uint8_t out[CORE_UPDATER_ZIP_OUT_SIZE];
+   char out_dir[PATH_MAX_LENGTH];
+   char entry_path[PATH_MAX_LENGTH];
+   char entry_tmp_path[PATH_MAX_LENGTH];
+   size_t header_len;
+   uint32_t remaining; /* Compressed bytes left of the entry */
+   uint32_t crc;
+   uint32_t expected_crc;
+   enum core_updater_unzip_status status;
+   bool inflate_done;
+} core_updater_unzip_t;
+#endif
+
 /* Download core */
 enum core_updater_download_status
 {
@@ -91,6 +130,9 @@ typedef struct core_updater_download_handle
    retro_task_t *http_task;
    retro_task_t *decompress_task;
    retro_task_t *backup_task;
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   core_updater_unzip_t *unzip;
+#endif
    size_t auto_backup_history_size;
    uint32_t local_crc;
    uint32_t remote_crc;
@@ -105,6 +147,11 @@ typedef struct core_updater_download_handle
 } core_updater_download_handle_t;
 
 /* Update installed cores */
+
+/* Number of core downloads that may run at once
+ * while updating installed cores */
+#define UPDATE_INSTALLED_CORES_MAX_DOWNLOADS 4
+
 enum update_installed_cores_status
 {
    UPDATE_INSTALLED_CORES_BEGIN = 0,
@@ -121,7 +168,7 @@ typedef struct update_installed_cores_handle
    char *path_dir_core_assets;
    core_updater_list_t* core_list;
    retro_task_t *list_task;
-   retro_task_t *download_task;
+   retro_task_t *download_tasks[UPDATE_INSTALLED_CORES_MAX_DOWNLOADS];
    size_t auto_backup_history_size;
    size_t list_size;
    size_t list_index;
@@ -300,15 +347,12 @@ static void task_core_updater_get_list_handler(retro_task_t *task)
 
             buildbot_url[0] = '\0';
 
-            /* Reset core updater list */
-            core_updater_list_reset(list_handle->core_list);
-
             /* Get core listing URL */
             if (!settings)
-               goto task_finished;
+               goto list_failed;
 
             if (string_is_empty(net_buildbot_url))
-               goto task_finished;
+               goto list_failed;
 
             fill_pathname_join(
                   buildbot_url,
@@ -324,13 +368,13 @@ static void task_core_updater_get_list_handler(retro_task_t *task)
                free(tmp_url);
 
             if (string_is_empty(buildbot_url))
-               goto task_finished;
+               goto list_failed;
 
             /* Configure file transfer object */
             transf = (file_transfer_t*)calloc(1, sizeof(file_transfer_t));
 
             if (!transf)
-               goto task_finished;
+               goto list_failed;
 
             /* > Seems to be required - not sure why the
              *   underlying code is implemented like this... */
@@ -338,9 +382,11 @@ static void task_core_updater_get_list_handler(retro_task_t *task)
 
             transf->user_data = (void*)list_handle;
 
-            /* Push HTTP transfer task */
-            list_handle->http_task = (retro_task_t*)task_push_http_transfer_file(
-                  buildbot_url, true, NULL,
+            /* Push HTTP transfer task
+             * > The listing rarely changes between visits,
+             *   so ask the server whether it did */
+            list_handle->http_task = (retro_task_t*)task_push_http_transfer_file_cached(
+                  buildbot_url, settings->paths.directory_cache, true, NULL,
                   cb_http_task_core_updater_get_list, transf);
 
             /* Start waiting for HTTP transfer to complete */
@@ -378,20 +424,22 @@ static void task_core_updater_get_list_handler(retro_task_t *task)
             settings_t *settings    = config_get_ptr();
 
             /* Check whether HTTP task was successful */
-            if (list_handle->http_task_success)
+            if (list_handle->http_task_success && list_handle->http_data)
             {
-               /* Parse HTTP transfer data */
-               if (list_handle->http_data)
-                  core_updater_list_parse_network_data(
-                        list_handle->core_list,
-                        settings->paths.directory_libretro,
-                        settings->paths.path_libretro_info,
-                        settings->paths.network_buildbot_url,
-                        list_handle->http_data->data,
-                        list_handle->http_data->len);
+               /* Parse HTTP transfer data
+                * > Skipped if the listing is unchanged */
+               core_updater_list_parse_network_data(
+                     list_handle->core_list,
+                     settings->paths.directory_libretro,
+                     settings->paths.path_libretro_info,
+                     settings->paths.network_buildbot_url,
+                     list_handle->http_data->data,
+                     list_handle->http_data->len);
             }
             else
             {
+               core_updater_list_reset(list_handle->core_list);
+
                /* Notify user of error via task title */
                task_free_title(task);
                task_set_title(task, strdup(msg_hash_to_str(MSG_CORE_LIST_FAILED)));
@@ -413,6 +461,11 @@ static void task_core_updater_get_list_handler(retro_task_t *task)
 
    return;
 
+list_failed:
+   /* The existing list is kept until the new one is
+    * parsed, don't leave it behind if there is none */
+   core_updater_list_reset(list_handle->core_list);
+
 task_finished:
 
    if (task)
@@ -514,6 +567,296 @@ error:
 /* Download core */
 /*****************/
 
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+/* Core archives are zip files with a single entry and the
+ * sizes in the local file header. Those can be inflated as
+ * the bytes arrive, so that extraction is done by the time
+ * the download is. Anything else (data descriptors, other
+ * compression methods, odd file names) makes us give up,
+ * and the archive is extracted after the download instead. */
+
+/* Zip fields are little endian, and not aligned */
+static uint16_t core_updater_zip_read16(const uint8_t *data)
+{
+   return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t core_updater_zip_read32(const uint8_t *data)
+{
+   return  (uint32_t)data[0]
+        | ((uint32_t)data[1] <<  8)
+        | ((uint32_t)data[2] << 16)
+        | ((uint32_t)data[3] << 24);
+}
+
+static void core_updater_unzip_close_entry(core_updater_unzip_t *unzip,
+      bool success)
+{
+   if (unzip->inflate)
+   {
+      zlib_inflate_backend.stream_free(unzip->inflate);
+      unzip->inflate = NULL;
+   }
+
+   if (!unzip->file)
+      return;
+
+   if (filestream_close(unzip->file) != 0)
+      success   = false;
+   unzip->file  = NULL;
+
+   if (success)
+   {
+      if (path_is_valid(unzip->entry_path))
+         filestream_delete(unzip->entry_path);
+      success = filestream_rename(
+            unzip->entry_tmp_path, unzip->entry_path) == 0;
+   }
+
+   if (!success)
+      filestream_delete(unzip->entry_tmp_path);
+}
+
+static bool core_updater_unzip_fail(core_updater_unzip_t *unzip)
+{
+   core_updater_unzip_close_entry(unzip, false);
+   unzip->status = CORE_UPDATER_UNZIP_FAILED;
+   return false;
+}
+
+/* Sets up extraction of the entry whose local
+ * file header is in unzip->header */
+static bool core_updater_unzip_open_entry(core_updater_unzip_t *unzip)
+{
+   char name[CORE_UPDATER_ZIP_MAX_NAME + 1];
+   char dir[PATH_MAX_LENGTH];
+   const uint8_t *hdr = unzip->header;
+   uint16_t flags     = core_updater_zip_read16(hdr + 6);
+   uint16_t method    = core_updater_zip_read16(hdr + 8);
+   uint16_t name_len  = core_updater_zip_read16(hdr + 26);
+
+   /* Encrypted, or sizes only known after the data */
+   if (flags & (1 | 8))
+      return false;
+   if (method != 0 && method != 8)
+      return false;
+   if (name_len == 0)
+      return false;
+
+   memcpy(name, hdr + CORE_UPDATER_ZIP_HEADER_SIZE, name_len);
+   name[name_len] = '\0';
+
+   /* Don't let the archive write outside the core directory */
+   if (     strstr(name, "..")
+         || strchr(name, '\\')
+         || strchr(name, ':')
+         || name[0] == '/')
+      return false;
+
+   unzip->expected_crc = core_updater_zip_read32(hdr + 14);
+   unzip->remaining    = core_updater_zip_read32(hdr + 18);
+
+   /* Zip64 entry, real sizes are in the extra field */
+   if (     unzip->remaining == 0xFFFFFFFF
+         || core_updater_zip_read32(hdr + 22) == 0xFFFFFFFF)
+      return false;
+
+   unzip->crc          = 0;
+   unzip->inflate_done = false;
+
+   fill_pathname_join(unzip->entry_path, unzip->out_dir, name,
+         sizeof(unzip->entry_path));
+
+   /* Directory entry */
+   if (name[name_len - 1] == '/')
+      return unzip->remaining == 0 && path_mkdir(unzip->entry_path);
+
+   strlcpy(unzip->entry_tmp_path, unzip->entry_path,
+         sizeof(unzip->entry_tmp_path));
+   strlcat(unzip->entry_tmp_path, ".tmp", sizeof(unzip->entry_tmp_path));
+
+   strlcpy(dir, unzip->entry_path, sizeof(dir));
+   path_basedir_wrapper(dir);
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      return false;
+
+   if (method == 8)
+   {
+      if (!(unzip->inflate = zlib_inflate_backend.stream_new()))
+         return false;
+      /* Raw deflate data, no zlib header */
+      zlib_inflate_backend.define(unzip->inflate,
+            "window_bits", (uint32_t)-15);
+   }
+
+   if (!(unzip->file = filestream_open(unzip->entry_tmp_path,
+            RETRO_VFS_FILE_ACCESS_WRITE,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   return true;
+}
+
+static bool core_updater_unzip_write(core_updater_unzip_t *unzip,
+      const uint8_t *data, uint32_t len)
+{
+   if (filestream_write(unzip->file, data, len) != (int64_t)len)
+      return false;
+   unzip->crc = encoding_crc32(unzip->crc, data, len);
+   return true;
+}
+
+static bool core_updater_unzip_data(core_updater_unzip_t *unzip,
+      const uint8_t *data, uint32_t len)
+{
+   if (!unzip->inflate)
+      return core_updater_unzip_write(unzip, data, len);
+
+   while (len > 0)
+   {
+      uint32_t rd = 0, wn = 0;
+      enum trans_stream_error error = TRANS_STREAM_ERROR_NONE;
+
+      if (unzip->inflate_done)
+         return false;
+
+      zlib_inflate_backend.set_in(unzip->inflate, data, len);
+      zlib_inflate_backend.set_out(unzip->inflate,
+            unzip->out, sizeof(unzip->out));
+
+      if (     !zlib_inflate_backend.trans(unzip->inflate,
+                  false, &rd, &wn, &error)
+            && error != TRANS_STREAM_ERROR_BUFFER_FULL)
+         return false;
+
+      if (wn && !core_updater_unzip_write(unzip, unzip->out, wn))
+         return false;
+
+      if (error == TRANS_STREAM_ERROR_NONE)
+         unzip->inflate_done = true;
+      else if (!rd && !wn)
+         return false;
+
+      data += rd;
+      len  -= rd;
+   }
+
+   return true;
+}
+
+/* Number of bytes the local file header being read will have,
+ * as far as it's known from what's been read so far */
+static size_t core_updater_unzip_header_size(
+      const core_updater_unzip_t *unzip)
+{
+   if (unzip->header_len < 4)
+      return 4;
+   if (unzip->header_len < CORE_UPDATER_ZIP_HEADER_SIZE)
+      return CORE_UPDATER_ZIP_HEADER_SIZE;
+   return CORE_UPDATER_ZIP_HEADER_SIZE
+      + core_updater_zip_read16(unzip->header + 26)
+      + core_updater_zip_read16(unzip->header + 28);
+}
+
+/* http file tap: extracts the archive while it downloads */
+static bool core_updater_unzip_sink(void *userdata,
+      const uint8_t *data, size_t len)
+{
+   core_updater_unzip_t *unzip = (core_updater_unzip_t*)userdata;
+
+   while (len > 0)
+   {
+      switch (unzip->status)
+      {
+         case CORE_UPDATER_UNZIP_HEADER:
+            {
+               size_t want = core_updater_unzip_header_size(unzip);
+               size_t copy = MIN(want - unzip->header_len, len);
+
+               memcpy(unzip->header + unzip->header_len, data, copy);
+               unzip->header_len += copy;
+               data              += copy;
+               len               -= copy;
+
+               if (unzip->header_len < want)
+                  break;
+
+               if (want == 4)
+               {
+                  uint32_t sig = core_updater_zip_read32(unzip->header);
+
+                  /* Central directory, all entries are done */
+                  if (sig == CORE_UPDATER_ZIP_CENTRAL_SIG)
+                  {
+                     unzip->status = CORE_UPDATER_UNZIP_DONE;
+                     return true;
+                  }
+                  if (sig != CORE_UPDATER_ZIP_LOCAL_SIG)
+                     return core_updater_unzip_fail(unzip);
+                  break;
+               }
+
+               /* File name and extra field follow */
+               if (want == CORE_UPDATER_ZIP_HEADER_SIZE)
+               {
+                  want = core_updater_unzip_header_size(unzip);
+                  if (want > sizeof(unzip->header))
+                     return core_updater_unzip_fail(unzip);
+                  if (want > CORE_UPDATER_ZIP_HEADER_SIZE)
+                     break;
+               }
+
+               if (!core_updater_unzip_open_entry(unzip))
+                  return core_updater_unzip_fail(unzip);
+               unzip->header_len = 0;
+               unzip->status     = CORE_UPDATER_UNZIP_DATA;
+            }
+            break;
+         case CORE_UPDATER_UNZIP_DATA:
+            {
+               uint32_t copy = (uint32_t)MIN(unzip->remaining, len);
+
+               if (copy && !core_updater_unzip_data(unzip, data, copy))
+                  return core_updater_unzip_fail(unzip);
+
+               unzip->remaining -= copy;
+               data             += copy;
+               len              -= copy;
+            }
+            break;
+         case CORE_UPDATER_UNZIP_DONE:
+            return true;
+         case CORE_UPDATER_UNZIP_FAILED:
+         default:
+            return false;
+      }
+
+      /* End of the current entry */
+      if (unzip->status == CORE_UPDATER_UNZIP_DATA && !unzip->remaining)
+      {
+         if (unzip->file)
+         {
+            if (     (unzip->inflate && !unzip->inflate_done)
+                  || unzip->crc != unzip->expected_crc)
+               return core_updater_unzip_fail(unzip);
+            core_updater_unzip_close_entry(unzip, true);
+         }
+         unzip->status = CORE_UPDATER_UNZIP_HEADER;
+      }
+   }
+
+   return true;
+}
+
+static void core_updater_unzip_free(core_updater_unzip_t *unzip)
+{
+   if (!unzip)
+      return;
+   core_updater_unzip_close_entry(unzip, false);
+   free(unzip);
+}
+#endif
+
 static void cb_task_core_updater_download(
       retro_task_t *task, void *task_data,
       void *user_data, const char *err)
@@ -568,7 +911,10 @@ void cb_http_task_core_updater_download(
    if (!data || !transf)
       goto finish;
 
-   if (!data->data || string_is_empty(transf->path))
+   /* The core file was streamed to disk by the
+    * http task, only its status is left to check */
+   if (data->status < 200 || data->status > 299 ||
+       string_is_empty(transf->path))
       goto finish;
 
    download_handle = (core_updater_download_handle_t*)transf->user_data;
@@ -608,13 +954,6 @@ void cb_http_task_core_updater_download(
    }
 #endif
 
-   /* Write core file to disk */
-   if (!filestream_write_file(transf->path, data->data, data->len))
-   {
-      err = "Write failed.";
-      goto finish;
-   }
-
 #if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
    /* Decompress core file, if required
     * NOTE: If core is compressed and platform
@@ -624,6 +963,14 @@ void cb_http_task_core_updater_download(
     * in such a way that this cannot happen... */
    if (path_is_compressed_file(transf->path))
    {
+      /* Already extracted while it was downloading */
+      if (download_handle->unzip &&
+          download_handle->unzip->status == CORE_UPDATER_UNZIP_DONE)
+      {
+         filestream_delete(transf->path);
+         goto finish;
+      }
+
       download_handle->decompress_task = (retro_task_t*)task_push_decompress(
             transf->path, output_dir,
             NULL, NULL, NULL,
@@ -678,6 +1025,10 @@ static void free_core_updater_download_handle(core_updater_download_handle_t *do
    if (download_handle->display_name)
       free(download_handle->display_name);
 
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   core_updater_unzip_free(download_handle->unzip);
+#endif
+
    free(download_handle);
    download_handle = NULL;
 }
@@ -807,6 +1158,7 @@ static void task_core_updater_download_handler(retro_task_t *task)
       case CORE_UPDATER_DOWNLOAD_START_TRANSFER:
          {
             file_transfer_t *transf = NULL;
+            net_http_sink_t tap     = NULL;
             char task_title[PATH_MAX_LENGTH];
 
             task_title[0] = '\0';
@@ -823,9 +1175,33 @@ static void task_core_updater_download_handler(retro_task_t *task)
 
             transf->user_data = (void*)download_handle;
 
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+            /* Zip archives are extracted while they download,
+             * instead of in a separate pass afterwards */
+            if (string_is_equal_noncase(
+                     path_get_extension(download_handle->local_download_path), "zip"))
+               download_handle->unzip = (core_updater_unzip_t*)
+                     calloc(1, sizeof(core_updater_unzip_t));
+
+            if (download_handle->unzip)
+            {
+               strlcpy(download_handle->unzip->out_dir,
+                     download_handle->local_download_path,
+                     sizeof(download_handle->unzip->out_dir));
+               path_basedir_wrapper(download_handle->unzip->out_dir);
+               tap = core_updater_unzip_sink;
+            }
+#endif
+
             /* Push HTTP transfer task */
-            download_handle->http_task = (retro_task_t*)task_push_http_transfer_file(
+            download_handle->http_task = (retro_task_t*)task_push_http_transfer_file_stream(
                   download_handle->remote_core_path, true, NULL,
+                  tap,
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+                  download_handle->unzip,
+#else
+                  NULL,
+#endif
                   cb_http_task_core_updater_download, transf);
 
             /* Update task title */
@@ -1086,6 +1462,9 @@ void *task_push_core_updater_download(
    download_handle->decompress_task_complete = false;
    download_handle->backup_enabled           = false;
    download_handle->backup_task              = NULL;
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   download_handle->unzip                    = NULL;
+#endif
    download_handle->status                   = CORE_UPDATER_DOWNLOAD_BEGIN;
 
    /* Concurrent downloads of the same file are not allowed */
@@ -1108,6 +1487,7 @@ void *task_push_core_updater_download(
    strlcat(task_title, download_handle->display_name, sizeof(task_title));
 
    task->handler          = task_core_updater_download_handler;
+   task->priority         = TASK_PRIORITY_BACKGROUND;
    task->state            = download_handle;
    task->mute             = mute;
    task->title            = strdup(task_title);
@@ -1157,6 +1537,30 @@ static void free_update_installed_cores_handle(
    update_installed_handle = NULL;
 }
 
+/* Releases the download slots of all finished
+ * downloads. Returns the number still running. */
+static unsigned update_installed_cores_poll_downloads(
+      update_installed_cores_handle_t *update_installed_handle)
+{
+   unsigned i;
+   unsigned num_active = 0;
+
+   for (i = 0; i < UPDATE_INSTALLED_CORES_MAX_DOWNLOADS; i++)
+   {
+      retro_task_t *download_task = update_installed_handle->download_tasks[i];
+
+      if (!download_task)
+         continue;
+
+      if (task_get_finished(download_task))
+         update_installed_handle->download_tasks[i] = NULL;
+      else
+         num_active++;
+   }
+
+   return num_active;
+}
+
 static void task_update_installed_cores_handler(retro_task_t *task)
 {
    update_installed_cores_handle_t *update_installed_handle = NULL;
@@ -1223,10 +1627,11 @@ static void task_update_installed_cores_handler(retro_task_t *task)
             bool core_installed                         = false;
 
             /* Check whether we have reached the end
-             * of the list */
+             * of the list - any downloads still in
+             * progress must complete before we finish */
             if (update_installed_handle->list_index >= update_installed_handle->list_size)
             {
-               update_installed_handle->status = UPDATE_INSTALLED_CORES_END;
+               update_installed_handle->status = UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD;
                break;
             }
 
@@ -1276,7 +1681,14 @@ static void task_update_installed_cores_handler(retro_task_t *task)
       case UPDATE_INSTALLED_CORES_UPDATE_CORE:
          {
             const core_updater_list_entry_t *list_entry = NULL;
+            retro_task_t *download_task                 = NULL;
             uint32_t local_crc;
+            unsigned i;
+
+            /* Wait until a download slot is free */
+            if (update_installed_cores_poll_downloads(update_installed_handle) >=
+                  UPDATE_INSTALLED_CORES_MAX_DOWNLOADS)
+               break;
 
             /* Get list entry
              * > In the event of an error, just return
@@ -1325,7 +1737,7 @@ static void task_update_installed_cores_handler(retro_task_t *task)
 
             /* Existing core is not the most recent version
              * > Request download */
-            update_installed_handle->download_task = (retro_task_t*)
+            download_task = (retro_task_t*)
                   task_push_core_updater_download(
                         update_installed_handle->core_list,
                         list_entry->remote_filename,
@@ -1337,7 +1749,7 @@ static void task_update_installed_cores_handler(retro_task_t *task)
 
             /* Again, if an error occurred, just return to
              * UPDATE_INSTALLED_CORES_ITERATE state */
-            if (!update_installed_handle->download_task)
+            if (!download_task)
                update_installed_handle->status = UPDATE_INSTALLED_CORES_ITERATE;
             else
             {
@@ -1345,6 +1757,16 @@ static void task_update_installed_cores_handler(retro_task_t *task)
 
                task_title[0] = '\0';
 
+               /* Store task in a free slot */
+               for (i = 0; i < UPDATE_INSTALLED_CORES_MAX_DOWNLOADS; i++)
+               {
+                  if (!update_installed_handle->download_tasks[i])
+                  {
+                     update_installed_handle->download_tasks[i] = download_task;
+                     break;
+                  }
+               }
+
                /* Update task title */
                task_free_title(task);
 
@@ -1358,32 +1780,16 @@ static void task_update_installed_cores_handler(retro_task_t *task)
                /* Increment 'updated cores' counter */
                update_installed_handle->num_updated++;
 
-               /* Wait for download to complete */
-               update_installed_handle->status = UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD;
+               /* Download runs in the background, carry
+                * on checking the remaining cores */
+               update_installed_handle->status = UPDATE_INSTALLED_CORES_ITERATE;
             }
          }
          break;
       case UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD:
-         {
-            bool download_complete = false;
-
-            /* > If task is running, check 'is finished'
-             *   status
-             * > If task is NULL, then it is finished
-             *   by definition */
-            if (update_installed_handle->download_task)
-               download_complete = task_get_finished(update_installed_handle->download_task);
-            else
-               download_complete = true;
-
-            /* If download is complete, return to
-             * UPDATE_INSTALLED_CORES_ITERATE state */
-            if (download_complete)
-            {
-               update_installed_handle->download_task = NULL;
-               update_installed_handle->status        = UPDATE_INSTALLED_CORES_ITERATE;
-            }
-         }
+         /* Once all downloads are complete, finish */
+         if (update_installed_cores_poll_downloads(update_installed_handle) < 1)
+            update_installed_handle->status = UPDATE_INSTALLED_CORES_END;
          break;
       case UPDATE_INSTALLED_CORES_END:
          {
@@ -1490,7 +1896,6 @@ void task_push_update_installed_cores(
          NULL : strdup(path_dir_core_assets);
    update_installed_handle->core_list                = core_updater_list_init();
    update_installed_handle->list_task                = NULL;
-   update_installed_handle->download_task            = NULL;
    update_installed_handle->list_size                = 0;
    update_installed_handle->list_index               = 0;
    update_installed_handle->installed_index          = 0;
@@ -1516,6 +1921,7 @@ void task_push_update_installed_cores(
 
    /* Configure task */
    task->handler          = task_update_installed_cores_handler;
+   task->priority         = TASK_PRIORITY_BACKGROUND;
    task->state            = update_installed_handle;
    task->title            = strdup(msg_hash_to_str(MSG_FETCHING_CORE_LIST));
    task->alternative_look = true;
@@ -1843,6 +2249,7 @@ void *task_push_play_feature_delivery_core_install(
          sizeof(task_title));
 
    task->handler          = task_play_feature_delivery_core_install_handler;
+   task->priority         = TASK_PRIORITY_BACKGROUND;
    task->state            = pfd_install_handle;
    task->mute             = mute;
    task->title            = strdup(task_title);
@@ -2218,6 +2625,7 @@ void task_push_play_feature_delivery_switch_installed_cores(
 
    /* Configure task */
    task->handler          = task_play_feature_delivery_switch_cores_handler;
+   task->priority         = TASK_PRIORITY_BACKGROUND;
    task->state            = pfd_switch_cores_handle;
    task->title            = strdup(msg_hash_to_str(MSG_SCANNING_CORES));
    task->alternative_look = true;
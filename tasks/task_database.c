@@ -20,6 +20,7 @@
 #include <compat/strl.h>
 #include <retro_miscellaneous.h>
 #include <retro_endianness.h>
+#include <array/rhmap.h>
 #include <string/stdstring.h>
 #include <lists/dir_list.h>
 #include <file/file_path.h>
@@ -27,6 +28,11 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -43,6 +49,22 @@
 #endif
 #include "../verbosity.h"
 
+/* Playlists being filled by a scan are written to disk
+ * at most this often, and once more when it finishes */
+#define DATABASE_PLAYLIST_WRITE_USEC 2000000
+
+#define DATABASE_SCAN_CACHE_MAGIC   0x43534152 /* 'RASC' */
+#define DATABASE_SCAN_CACHE_VERSION 1
+
+#ifdef HAVE_THREADS
+/* Files each hash worker may be ahead of the matching */
+#define DATABASE_PROBE_AHEAD    4
+
+/* How long the task waits for a worker before
+ * giving other tasks a turn */
+#define DATABASE_PROBE_WAIT_USEC 50000
+#endif
+
 typedef struct database_state_handle
 {
    database_info_list_t *info;
@@ -56,6 +78,45 @@ typedef struct database_state_handle
    char serial[4096];
 } database_state_handle_t;
 
+struct db_handle;
+
+/* Result of reading one file of the scan list before the
+ * database matching: what kind of lookup it needs and its
+ * CRC or serial. When filled in by a hash worker, it is
+ * owned by the worker until 'done' is set. */
+typedef struct database_probe
+{
+#ifdef HAVE_THREADS
+   struct db_handle *db;
+#endif
+   char *path;
+   size_t index;
+   int64_t size;
+   int64_t mtime;
+   enum database_type type;
+   int ret;
+   uint32_t crc;
+   uint32_t archive_crc;
+   bool cached;
+   bool pending;
+   bool done;
+   char serial[4096];
+} database_probe_t;
+
+/* What an earlier scan read from a file of a given
+ * size and modification time, see database_probe_t */
+typedef struct database_scan_cache_item
+{
+   int64_t size;
+   int64_t mtime;
+   char *serial;
+   enum database_type type;
+   int ret;
+   uint32_t crc;
+   uint32_t archive_crc;
+   bool seen;
+} database_scan_cache_item_t;
+
 typedef struct db_handle
 {
    char *playlist_directory;
@@ -64,9 +125,25 @@ typedef struct db_handle
    database_info_handle_t *handle;
    database_state_handle_t state;
    playlist_config_t playlist_config; /* size_t alignment */
+   playlist_t *playlist;
+   retro_time_t playlist_written;
+   database_scan_cache_item_t *scan_cache;
+   char *scan_cache_path;
+   database_probe_t probe;
+#ifdef HAVE_THREADS
+   tpool_t *probe_pool;
+   slock_t *probe_lock;
+   scond_t *probe_cond;
+   database_probe_t *probes;
+   size_t probe_count;
+   size_t probe_next;
+#endif
+   unsigned scan_threads;
    unsigned status;
    bool is_directory;
    bool scan_started;
+   bool scan_finished;
+   bool scan_cache_dirty;
    bool scan_without_core_match;
    bool show_hidden_files;
 } db_handle_t;
@@ -211,7 +288,10 @@ static bool intfstream_file_get_serial(const char *name,
    if (file_size < 0)
       goto error;
 
-   if (offset != 0 || size < (uint64_t) file_size)
+   /* A track at the start of the file is read in place,
+    * the detection only looks at its first sectors and
+    * copying it would hold a whole disc in memory */
+   if (offset != 0)
    {
       if (intfstream_seek(fd, (int64_t)offset, SEEK_SET) == -1)
          goto error;
@@ -317,7 +397,6 @@ static bool intfstream_file_get_crc(const char *name,
    bool rv;
    intfstream_t *fd  = intfstream_open_file(name,
          RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
-   uint8_t *data     = NULL;
    int64_t file_size = -1;
 
    if (!fd)
@@ -334,39 +413,21 @@ static bool intfstream_file_get_crc(const char *name,
    if (file_size < 0)
       goto error;
 
+   /* A data track can be most of a disc image, the
+    * range is hashed in chunks instead of being loaded */
    if (offset != 0 || size < (uint64_t) file_size)
-   {
-      if (intfstream_seek(fd, (int64_t)offset, SEEK_SET) == -1)
-         goto error;
-
-      data = (uint8_t*)malloc(size);
-
-      if (intfstream_read(fd, data, size) != (int64_t) size)
-         goto error;
-
-      intfstream_close(fd);
-      free(fd);
-      fd = intfstream_open_memory(data, RETRO_VFS_FILE_ACCESS_READ,
-            RETRO_VFS_FILE_ACCESS_HINT_NONE, size);
-
-      if (!fd)
-         goto error;
-   }
+      rv = intfstream_get_crc_range(fd, (int64_t)offset,
+            (int64_t)size, crc);
+   else
+      rv = intfstream_get_crc(fd, crc);
 
-   rv = intfstream_get_crc(fd, crc);
    intfstream_close(fd);
    free(fd);
-   free(data);
    return rv;
 
 error:
-   if (fd)
-   {
-      intfstream_close(fd);
-      free(fd);
-   }
-   if (data)
-      free(data);
+   intfstream_close(fd);
+   free(fd);
    return 0;
 }
 
@@ -455,7 +516,7 @@ static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
 }
 
 static void task_database_cue_prune(database_info_handle_t *db,
-      const char *name)
+      const char *name, size_t start)
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
@@ -469,7 +530,7 @@ static void task_database_cue_prune(database_info_handle_t *db,
 
    while (cue_next_file(fd, name, path, sizeof(path)))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && string_is_equal(path, db->list->elems[i].data))
@@ -485,7 +546,8 @@ static void task_database_cue_prune(database_info_handle_t *db,
    free(fd);
 }
 
-static void gdi_prune(database_info_handle_t *db, const char *name)
+static void gdi_prune(database_info_handle_t *db, const char *name,
+      size_t start)
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
@@ -499,7 +561,7 @@ static void gdi_prune(database_info_handle_t *db, const char *name)
 
    while (gdi_next_file(fd, name, path, sizeof(path)))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && string_is_equal(path, db->list->elems[i].data))
@@ -557,68 +619,87 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+/* Drops the files a cue or gdi sheet references from
+ * the scan list, from index 'start' on */
+static void task_database_prune(database_info_handle_t *db,
+      const char *name, size_t start)
+{
+   switch (extension_to_file_type(path_get_extension(name)))
+   {
+      case FILE_TYPE_CUE:
+         task_database_cue_prune(db, name, start);
+         break;
+      case FILE_TYPE_GDI:
+         gdi_prune(db, name, start);
+         break;
+      default:
+         break;
+   }
+}
+
+/* Reads what the database lookup of a file needs, its
+ * serial or CRC. Only touches the file and the output
+ * arguments, so it can run on a hash worker. */
+static int task_database_probe_file(const char *name,
+      enum database_type *type, char *serial,
+      uint32_t *crc, uint32_t *archive_crc)
 {
    switch (extension_to_file_type(path_get_extension(name)))
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         db->type = DATABASE_TYPE_CRC_LOOKUP;
+         *type = DATABASE_TYPE_CRC_LOOKUP;
          /* first check crc of archive itself */
          return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
+               0, SIZE_MAX, archive_crc);
 #else
          break;
 #endif
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         if (task_database_cue_get_serial(name, serial))
+            *type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_cue_get_crc(name, &db_state->crc);
+            *type = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_cue_get_crc(name, crc);
          }
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
+         serial[0] = '\0';
          /* There are no serial databases, so don't bother with
             serials at the moment */
-         if (0 && task_database_gdi_get_serial(name, db_state->serial))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         if (0 && task_database_gdi_get_serial(name, serial))
+            *type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_gdi_get_crc(name, &db_state->crc);
+            *type = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_gdi_get_crc(name, crc);
          }
          break;
       /* Consider Wii WBFS files similar to ISO files. */
       case FILE_TYPE_WBFS:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial);
-         db->type            =  DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         intfstream_file_get_serial(name, 0, SIZE_MAX, serial);
+         *type     = DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial))
-            db->type         = DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         if (task_database_chd_get_serial(name, serial))
+            *type  = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type         = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_chd_get_crc(name, &db_state->crc);
+            *type  = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_chd_get_crc(name, crc);
          }
          break;
       case FILE_TYPE_LUTRO:
-         db->type            = DATABASE_TYPE_ITERATE_LUTRO;
+         *type     = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         db->type            = DATABASE_TYPE_CRC_LOOKUP;
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         *type     = DATABASE_TYPE_CRC_LOOKUP;
+         return intfstream_file_get_crc(name, 0, SIZE_MAX, crc);
    }
 
    return 1;
@@ -701,6 +782,46 @@ static int database_info_list_iterate_new(database_state_handle_t *db_state,
    return 0;
 }
 
+/* Matches usually go to the same playlist one after
+ * another, so it stays loaded instead of being read and
+ * written again for each of them */
+static void task_database_playlist_close(db_handle_t *_db)
+{
+   if (!_db->playlist)
+      return;
+
+   playlist_write_file(_db->playlist);
+   playlist_free(_db->playlist);
+   _db->playlist = NULL;
+}
+
+static playlist_t *task_database_playlist_open(db_handle_t *_db,
+      const char *path)
+{
+   if (_db->playlist)
+   {
+      if (string_is_equal(playlist_get_conf_path(_db->playlist), path))
+         return _db->playlist;
+      task_database_playlist_close(_db);
+   }
+
+   playlist_config_set_path(&_db->playlist_config, path);
+   _db->playlist         = playlist_init(&_db->playlist_config);
+   _db->playlist_written = cpu_features_get_time_usec();
+   return _db->playlist;
+}
+
+static void task_database_playlist_update(db_handle_t *_db)
+{
+   retro_time_t now = cpu_features_get_time_usec();
+
+   if (now - _db->playlist_written < DATABASE_PLAYLIST_WRITE_USEC)
+      return;
+
+   playlist_write_file(_db->playlist);
+   _db->playlist_written = now;
+}
+
 static int database_info_list_iterate_found_match(
       db_handle_t *_db,
       database_state_handle_t *db_state,
@@ -740,8 +861,7 @@ static int database_info_list_iterate_found_match(
       fill_pathname_join(db_playlist_path, _db->playlist_directory,
             db_playlist_base_str, str_len);
 
-   playlist_config_set_path(&_db->playlist_config, db_playlist_path);
-   playlist = playlist_init(&_db->playlist_config);
+   playlist = task_database_playlist_open(_db, db_playlist_path);
 
    snprintf(db_crc, str_len, "%08X|crc", db_info_entry->crc32);
 
@@ -809,8 +929,7 @@ static int database_info_list_iterate_found_match(
       playlist_push(playlist, &entry);
    }
 
-   playlist_write_file(playlist);
-   playlist_free(playlist);
+   task_database_playlist_update(_db);
 
    database_info_list_free(db_state->info);
    free(db_state->info);
@@ -968,8 +1087,7 @@ static int task_database_iterate_playlist_lutro(
             _db->playlist_directory,
             "Lutro.lpl", sizeof(db_playlist_path));
 
-   playlist_config_set_path(&_db->playlist_config, db_playlist_path);
-   playlist = playlist_init(&_db->playlist_config);
+   playlist = task_database_playlist_open(_db, db_playlist_path);
 
    if (!playlist_entry_exists(playlist, path))
    {
@@ -1005,8 +1123,7 @@ static int task_database_iterate_playlist_lutro(
       playlist_push(playlist, &entry);
    }
 
-   playlist_write_file(playlist);
-   playlist_free(playlist);
+   task_database_playlist_update(_db);
 
    return 0;
 }
@@ -1088,8 +1205,6 @@ static int task_database_iterate(
 {
    switch (db->type)
    {
-      case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
 #ifdef HAVE_COMPRESSION
          return task_database_iterate_crc_lookup(
@@ -1125,6 +1240,585 @@ static void task_database_cleanup_state(
    db_state->buf = NULL;
 }
 
+/* The scan cache remembers the CRC or serial of every
+ * file scanned before, so a rescan only reads new or
+ * modified files. It is a single file in the playlist
+ * directory: a header followed by fixed size records and
+ * the string table they point into. */
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t count;
+   uint32_t strings_size;
+} database_scan_cache_header_t;
+
+typedef struct
+{
+   int64_t size;
+   int64_t mtime;
+   uint32_t path;
+   uint32_t serial;  /* 0 if none */
+   uint32_t crc;
+   uint32_t archive_crc;
+   uint32_t type;
+   int32_t ret;
+} database_scan_cache_record_t;
+
+/* Size and modification time of a file, or of the
+ * archive containing it */
+static bool task_database_scan_cache_stat(const char *path,
+      int64_t *size, int64_t *mtime)
+{
+   char archive_path[PATH_MAX_LENGTH];
+   const char *delim = path_get_archive_delim(path);
+
+   if (delim)
+   {
+      size_t len = delim - path;
+
+      if (len >= sizeof(archive_path))
+         return false;
+
+      memcpy(archive_path, path, len);
+      archive_path[len] = '\0';
+      path              = archive_path;
+   }
+
+   /* Without a modification time a changed file
+    * cannot be told apart, so nothing is cached */
+   *mtime = path_get_mtime(path);
+   *size  = path_get_size(path);
+
+   return *mtime != 0 && *size >= 0;
+}
+
+static void task_database_scan_cache_free(db_handle_t *db)
+{
+   size_t i;
+   database_scan_cache_item_t *cache = db->scan_cache;
+
+   for (i = 0; i < RHMAP_CAP(cache); i++)
+      if (RHMAP_KEY(cache, i) && cache[i].serial)
+         free(cache[i].serial);
+   RHMAP_FREE(cache);
+
+   db->scan_cache = NULL;
+   if (db->scan_cache_path)
+      free(db->scan_cache_path);
+   db->scan_cache_path = NULL;
+}
+
+static void task_database_scan_cache_load(db_handle_t *db)
+{
+   size_t i;
+   char path[PATH_MAX_LENGTH];
+   const database_scan_cache_header_t *header   = NULL;
+   const database_scan_cache_record_t *records  = NULL;
+   const char *strings                          = NULL;
+   database_scan_cache_item_t *cache            = NULL;
+   void *buf                                    = NULL;
+   int64_t len                                  = 0;
+
+   if (string_is_empty(db->playlist_directory))
+      return;
+
+   fill_pathname_join(path, db->playlist_directory,
+         FILE_PATH_CONTENT_SCAN_CACHE, sizeof(path));
+   db->scan_cache_path = strdup(path);
+
+   if (     !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len))
+      return;
+
+   header = (const database_scan_cache_header_t*)buf;
+
+   if (     (size_t)len < sizeof(*header)
+         || header->magic        != DATABASE_SCAN_CACHE_MAGIC
+         || header->version      != DATABASE_SCAN_CACHE_VERSION
+         || header->strings_size == 0
+         || (uint64_t)len != sizeof(*header)
+            + (uint64_t)header->count * sizeof(*records)
+            + header->strings_size)
+      goto end;
+
+   records = (const database_scan_cache_record_t*)(header + 1);
+   strings = (const char*)(records + header->count);
+
+   /* Every string must be terminated within the table */
+   if (strings[0] != '\0' || strings[header->strings_size - 1] != '\0')
+      goto end;
+
+   for (i = 0; i < header->count; i++)
+   {
+      database_scan_cache_item_t item;
+      const database_scan_cache_record_t *record = &records[i];
+
+      if (     record->path   >= header->strings_size
+            || record->serial >= header->strings_size
+            || !record->path)
+         continue;
+
+      item.size        = record->size;
+      item.mtime       = record->mtime;
+      item.serial      = record->serial
+         ? strdup(strings + record->serial) : NULL;
+      item.type        = (enum database_type)record->type;
+      item.ret         = record->ret;
+      item.crc         = record->crc;
+      item.archive_crc = record->archive_crc;
+      item.seen        = false;
+
+      RHMAP_SET_STR(cache, strings + record->path, item);
+   }
+
+end:
+   db->scan_cache = cache;
+   free(buf);
+}
+
+/* Files below the scanned path that were not found
+ * again are dropped, once the whole scan went through */
+static bool task_database_scan_cache_keep(db_handle_t *db,
+      const char *path, const database_scan_cache_item_t *item)
+{
+   size_t len;
+
+   if (item->seen || !db->scan_finished || string_is_empty(db->fullpath))
+      return true;
+
+   len = strlen(db->fullpath);
+
+   if (strncmp(path, db->fullpath, len))
+      return true;
+
+   /* The scanned file, or a member of it */
+   if (path[len] == '\0' || path[len] == '#')
+      return false;
+
+   if (!db->is_directory)
+      return true;
+
+   return !(   path[len] == '/' || path[len] == '\\'
+            || db->fullpath[len - 1] == '/'
+            || db->fullpath[len - 1] == '\\');
+}
+
+static void task_database_scan_cache_save(db_handle_t *db)
+{
+   size_t i;
+   database_scan_cache_header_t *header  = NULL;
+   database_scan_cache_record_t *records = NULL;
+   database_scan_cache_item_t *cache     = db->scan_cache;
+   char *strings                         = NULL;
+   uint8_t *buf                          = NULL;
+   size_t count                          = 0;
+   size_t strings_size                   = 1;
+   size_t dropped                        = 0;
+
+   if (!db->scan_cache_path)
+      return;
+
+   for (i = 0; i < RHMAP_CAP(cache); i++)
+   {
+      const char *path = RHMAP_KEY_STR(cache, i);
+
+      if (!RHMAP_KEY(cache, i))
+         continue;
+
+      if (!task_database_scan_cache_keep(db, path, &cache[i]))
+      {
+         dropped++;
+         continue;
+      }
+
+      count++;
+      strings_size += strlen(path) + 1;
+      if (cache[i].serial)
+         strings_size += strlen(cache[i].serial) + 1;
+   }
+
+   if (!db->scan_cache_dirty && !dropped)
+      return;
+
+   if (!(buf = (uint8_t*)malloc(sizeof(*header)
+         + count * sizeof(*records) + strings_size)))
+      return;
+
+   header       = (database_scan_cache_header_t*)buf;
+   records      = (database_scan_cache_record_t*)(header + 1);
+   strings      = (char*)(records + count);
+   strings[0]   = '\0';
+   strings_size = 1;
+   count        = 0;
+
+   for (i = 0; i < RHMAP_CAP(cache); i++)
+   {
+      size_t _len;
+      const char *path                      = RHMAP_KEY_STR(cache, i);
+      database_scan_cache_record_t *record  = NULL;
+
+      if (     !RHMAP_KEY(cache, i)
+            || !task_database_scan_cache_keep(db, path, &cache[i]))
+         continue;
+
+      record              = &records[count++];
+      record->size        = cache[i].size;
+      record->mtime       = cache[i].mtime;
+      record->crc         = cache[i].crc;
+      record->archive_crc = cache[i].archive_crc;
+      record->type        = (uint32_t)cache[i].type;
+      record->ret         = cache[i].ret;
+      record->path        = (uint32_t)strings_size;
+      _len                = strlen(path) + 1;
+      memcpy(strings + strings_size, path, _len);
+      strings_size       += _len;
+      record->serial      = 0;
+
+      if (cache[i].serial)
+      {
+         record->serial   = (uint32_t)strings_size;
+         _len             = strlen(cache[i].serial) + 1;
+         memcpy(strings + strings_size, cache[i].serial, _len);
+         strings_size    += _len;
+      }
+   }
+
+   header->magic        = DATABASE_SCAN_CACHE_MAGIC;
+   header->version      = DATABASE_SCAN_CACHE_VERSION;
+   header->count        = (uint32_t)count;
+   header->strings_size = (uint32_t)strings_size;
+
+   if (!filestream_write_file(db->scan_cache_path, buf,
+         sizeof(*header) + count * sizeof(*records) + strings_size))
+      RARCH_WARN("[Scan]: Could not write \"%s\".\n", db->scan_cache_path);
+
+   db->scan_cache_dirty = false;
+   free(buf);
+}
+
+/* Fills in the probe from the cache if the file did not
+ * change since it was read */
+static bool task_database_scan_cache_find(db_handle_t *db,
+      database_probe_t *probe)
+{
+   ptrdiff_t idx;
+   database_scan_cache_item_t *item;
+   database_scan_cache_item_t *cache = db->scan_cache;
+
+   if (     !db->scan_cache_path
+         || !task_database_scan_cache_stat(probe->path,
+            &probe->size, &probe->mtime))
+      return false;
+
+   if ((idx = RHMAP_IDX_STR(cache, probe->path)) < 0)
+      return false;
+
+   item = &cache[idx];
+
+   if (item->size != probe->size || item->mtime != probe->mtime)
+      return false;
+
+   item->seen         = true;
+   probe->type        = item->type;
+   probe->ret         = item->ret;
+   probe->crc         = item->crc;
+   probe->archive_crc = item->archive_crc;
+   probe->serial[0]   = '\0';
+   if (item->serial)
+      strlcpy(probe->serial, item->serial, sizeof(probe->serial));
+
+   return true;
+}
+
+static void task_database_scan_cache_store(db_handle_t *db,
+      const database_probe_t *probe)
+{
+   ptrdiff_t idx;
+   database_scan_cache_item_t item;
+   database_scan_cache_item_t *cache = db->scan_cache;
+
+   /* Failed reads are tried again next time */
+   if (!db->scan_cache_path || !probe->mtime || !probe->ret)
+      return;
+
+   if ((idx = RHMAP_IDX_STR(cache, probe->path)) >= 0 && cache[idx].serial)
+      free(cache[idx].serial);
+
+   item.size        = probe->size;
+   item.mtime       = probe->mtime;
+   item.serial      = (probe->type == DATABASE_TYPE_SERIAL_LOOKUP
+         && probe->serial[0]) ? strdup(probe->serial) : NULL;
+   item.type        = probe->type;
+   item.ret         = probe->ret;
+   item.crc         = probe->crc;
+   item.archive_crc = probe->archive_crc;
+   item.seen        = true;
+
+   RHMAP_SET_STR(cache, probe->path, item);
+   db->scan_cache       = cache;
+   db->scan_cache_dirty = true;
+}
+
+/* Reads the file of a probe, only touches the probe */
+static void task_database_probe_run(database_probe_t *probe)
+{
+   if (path_contains_compressed_file(probe->path))
+   {
+      probe->type = DATABASE_TYPE_ITERATE_ARCHIVE;
+      probe->ret  = 1;
+   }
+   else
+      probe->ret  = task_database_probe_file(probe->path,
+            &probe->type, probe->serial,
+            &probe->crc, &probe->archive_crc);
+
+   /* Same fallback as the CRC lookup, which would
+    * otherwise open the file again later */
+   if (probe->ret && !probe->crc &&
+         (    probe->type == DATABASE_TYPE_CRC_LOOKUP
+           || probe->type == DATABASE_TYPE_ITERATE_ARCHIVE))
+      probe->crc = file_archive_get_file_crc32(probe->path);
+}
+
+/* Sets up the probe of entry 'i' of the scan list and
+ * looks it up in the scan cache */
+static bool task_database_probe_prepare(db_handle_t *db,
+      database_info_handle_t *dbinfo, database_probe_t *probe,
+      const char *name, size_t i)
+{
+   /* Pruning changes the list ahead of us, so it has
+    * to happen before later files are looked at */
+   if (!path_contains_compressed_file(name))
+      task_database_prune(dbinfo, name, i);
+
+   probe->path        = strdup(name);
+   probe->index       = i;
+   probe->size        = 0;
+   probe->mtime       = 0;
+   probe->type        = DATABASE_TYPE_ITERATE;
+   probe->ret         = 0;
+   probe->crc         = 0;
+   probe->archive_crc = 0;
+   probe->serial[0]   = '\0';
+   probe->done        = false;
+   probe->pending     = false;
+
+   if (!probe->path)
+      return false;
+
+   probe->cached      = task_database_scan_cache_find(db, probe);
+   probe->pending     = true;
+   return true;
+}
+
+static void task_database_probe_release(database_probe_t *probe)
+{
+   if (probe->path)
+      free(probe->path);
+   probe->path    = NULL;
+   probe->pending = false;
+}
+
+/* Hands the result of a probe to the database lookup */
+static void task_database_probe_apply(db_handle_t *db,
+      database_info_handle_t *dbinfo,
+      database_probe_t *probe)
+{
+   database_state_handle_t *dbstate = &db->state;
+
+   if (!probe->cached)
+      task_database_scan_cache_store(db, probe);
+
+   dbinfo->type         = probe->type;
+   dbstate->crc         = probe->crc;
+   dbstate->archive_crc = probe->archive_crc;
+   strlcpy(dbstate->serial, probe->serial, sizeof(dbstate->serial));
+
+   if (!probe->ret)
+   {
+      dbinfo->status    = DATABASE_STATUS_ITERATE_NEXT;
+      dbinfo->type      = DATABASE_TYPE_ITERATE;
+   }
+
+   task_database_probe_release(probe);
+}
+
+/* Reads the current file on the task itself */
+static void task_database_probe_current(db_handle_t *db,
+      database_info_handle_t *dbinfo, const char *name)
+{
+   database_probe_t *probe = &db->probe;
+
+   if (!task_database_probe_prepare(db, dbinfo, probe,
+            name, dbinfo->list_ptr))
+   {
+      dbinfo->status = DATABASE_STATUS_ITERATE_NEXT;
+      return;
+   }
+
+   if (!probe->cached)
+      task_database_probe_run(probe);
+
+   task_database_probe_apply(db, dbinfo, probe);
+}
+
+#ifdef HAVE_THREADS
+static void task_database_probe_work(void *data)
+{
+   database_probe_t *probe = (database_probe_t*)data;
+   db_handle_t *db         = probe->db;
+
+   task_database_probe_run(probe);
+
+   slock_lock(db->probe_lock);
+   probe->done = true;
+   scond_broadcast(db->probe_cond);
+   slock_unlock(db->probe_lock);
+}
+
+static void task_database_probe_wait(db_handle_t *db,
+      database_probe_t *probe)
+{
+   slock_lock(db->probe_lock);
+   while (!probe->done)
+      scond_wait(db->probe_cond, db->probe_lock);
+   slock_unlock(db->probe_lock);
+}
+
+static void task_database_probe_deinit(db_handle_t *db)
+{
+   size_t i;
+
+   /* Drops what has not been started and waits
+    * for the rest */
+   if (db->probe_pool)
+      tpool_destroy(db->probe_pool);
+   db->probe_pool = NULL;
+
+   if (db->probes)
+   {
+      for (i = 0; i < db->probe_count; i++)
+         task_database_probe_release(&db->probes[i]);
+      free(db->probes);
+   }
+   db->probes = NULL;
+
+   if (db->probe_lock)
+      slock_free(db->probe_lock);
+   if (db->probe_cond)
+      scond_free(db->probe_cond);
+   db->probe_lock = NULL;
+   db->probe_cond = NULL;
+}
+
+/* Splits the scan into a pipeline: the files found by the
+ * directory enumeration are read and hashed by a pool of
+ * workers ahead of the task, which only does the database
+ * matching and playlist writes. Scanning stays sequential
+ * when this fails. */
+static void task_database_probe_init(db_handle_t *db)
+{
+   size_t i;
+
+   if (db->scan_threads < 2)
+      return;
+
+   db->probe_count = db->scan_threads * DATABASE_PROBE_AHEAD;
+   db->probe_next  = 0;
+
+   if (!(db->probes = (database_probe_t*)
+            calloc(db->probe_count, sizeof(*db->probes))))
+      goto error;
+   if (!(db->probe_lock = slock_new()))
+      goto error;
+   if (!(db->probe_cond = scond_new()))
+      goto error;
+   if (!(db->probe_pool = tpool_create(db->scan_threads)))
+      goto error;
+
+   for (i = 0; i < db->probe_count; i++)
+      db->probes[i].db = db;
+
+   return;
+
+error:
+   task_database_probe_deinit(db);
+}
+
+/* Hands the files following the current one to the
+ * workers, as long as there are free slots */
+static void task_database_probe_fill(db_handle_t *db,
+      database_info_handle_t *dbinfo)
+{
+   while (     db->probe_next < dbinfo->list->size
+         &&    db->probe_next < dbinfo->list_ptr + db->probe_count)
+   {
+      size_t i                = db->probe_next;
+      database_probe_t *probe = &db->probes[i % db->probe_count];
+      const char *name        = dbinfo->list->elems[i].data;
+
+      if (probe->pending)
+      {
+         /* Result of a file that was skipped */
+         if (probe->index >= dbinfo->list_ptr)
+            break;
+         task_database_probe_wait(db, probe);
+         task_database_probe_release(probe);
+      }
+
+      db->probe_next++;
+
+      if (!name)
+         continue;
+
+      if (!task_database_probe_prepare(db, dbinfo, probe, name, i))
+         break;
+
+      /* Unchanged since the last scan */
+      if (probe->cached)
+      {
+         probe->done = true;
+         continue;
+      }
+
+      if (!tpool_add_work(db->probe_pool,
+               task_database_probe_work, probe))
+      {
+         task_database_probe_release(probe);
+         break;
+      }
+   }
+}
+
+/* Takes the result of the current file from the workers.
+ * Returns -1 if it is not ready yet, 0 if the file has to
+ * be read by the task itself, 1 otherwise. */
+static int task_database_probe_take(db_handle_t *db,
+      database_info_handle_t *dbinfo)
+{
+   database_probe_t *probe =
+      &db->probes[dbinfo->list_ptr % db->probe_count];
+   bool done               = false;
+
+   if (!probe->pending || probe->index != dbinfo->list_ptr)
+      return 0;
+
+   slock_lock(db->probe_lock);
+   if (!probe->done && task_queue_is_threaded())
+      scond_wait_timeout(db->probe_cond, db->probe_lock,
+            DATABASE_PROBE_WAIT_USEC);
+   done = probe->done;
+   slock_unlock(db->probe_lock);
+
+   if (!done)
+      return -1;
+
+   task_database_probe_apply(db, dbinfo, probe);
+   return 1;
+}
+#endif
+
 static void task_database_handler(retro_task_t *task)
 {
    const char *name                 = NULL;
@@ -1218,6 +1912,13 @@ static void task_database_handler(retro_task_t *task)
                }
             }
          }
+         if (dbstate->list && dbstate->list->size > 0)
+         {
+            task_database_scan_cache_load(db);
+#ifdef HAVE_THREADS
+            task_database_probe_init(db);
+#endif
+         }
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
@@ -1226,6 +1927,22 @@ static void task_database_handler(retro_task_t *task)
          dbstate->list_index  = 0;
          dbstate->entry_index = 0;
          task_database_iterate_start(task, dbinfo, name);
+         if (!name)
+            break;
+#ifdef HAVE_THREADS
+         if (db->probe_pool)
+         {
+            int ret;
+            task_database_probe_fill(db, dbinfo);
+            ret = task_database_probe_take(db, dbinfo);
+            /* Try again on the next run of the task */
+            if (ret < 0)
+               dbinfo->status = DATABASE_STATUS_ITERATE_START;
+            if (ret != 0)
+               break;
+         }
+#endif
+         task_database_probe_current(db, dbinfo, name);
          break;
       case DATABASE_STATUS_ITERATE:
          {
@@ -1259,6 +1976,8 @@ static void task_database_handler(retro_task_t *task)
          else
          {
             const char *msg = NULL;
+            db->scan_finished = true;
+            task_database_playlist_close(db);
             if (db->is_directory)
                msg = msg_hash_to_str(MSG_SCANNING_OF_DIRECTORY_FINISHED);
             else
@@ -1293,6 +2012,12 @@ task_finished:
 
    if (db)
    {
+#ifdef HAVE_THREADS
+      task_database_probe_deinit(db);
+#endif
+      task_database_playlist_close(db);
+      task_database_scan_cache_save(db);
+      task_database_scan_cache_free(db);
       if (!string_is_empty(db->playlist_directory))
          free(db->playlist_directory);
       if (!string_is_empty(db->content_database_path))
@@ -1338,6 +2063,7 @@ bool task_push_dbscan(
       goto error;
 
    t->handler                              = task_database_handler;
+   t->priority                             = TASK_PRIORITY_BULK;
    t->state                                = db;
    t->callback                             = cb;
    t->title                                = strdup(msg_hash_to_str(
@@ -1347,12 +2073,14 @@ bool task_push_dbscan(
 #ifdef RARCH_INTERNAL
    t->progress_cb                          = task_database_progress_cb;
    db->scan_without_core_match             = settings->bools.scan_without_core_match;
+   db->scan_threads                        = settings->uints.scan_threads;
    db->playlist_config.capacity            = COLLECTION_SIZE;
    db->playlist_config.old_format          = settings->bools.playlist_use_old_format;
    db->playlist_config.compress            = settings->bools.playlist_compression;
    db->playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
    playlist_config_set_base_content_directory(&db->playlist_config, settings->bools.playlist_portable_paths ? settings->paths.directory_menu_content : NULL);
 #else
+   db->scan_threads                        = 1;
    db->playlist_config.capacity            = COLLECTION_SIZE;
    db->playlist_config.old_format          = false;
    db->playlist_config.compress            = false;
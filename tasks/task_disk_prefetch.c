@@ -0,0 +1,211 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <boolean.h>
+
+#include <retro_miscellaneous.h>
+#include <file/file_path.h>
+#include <lists/string_list.h>
+#include <streams/file_stream.h>
+#include <streams/interface_stream.h>
+#include <string/stdstring.h>
+
+#include "tasks_internal.h"
+
+#include "../verbosity.h"
+
+/* Reading the head of the next disc image pulls it into
+ * the OS page cache (and through any network share or
+ * spun down drive), so the core's cold open on swap mostly
+ * hits memory. CHD headers, hunk maps and the first hunks
+ * all sit at the start of the file. */
+#define DISK_PREFETCH_CHUNK_SIZE (256 * 1024)
+#define DISK_PREFETCH_MAX_SIZE   (64 * 1024 * 1024)
+
+typedef struct disk_prefetch_handle
+{
+   struct string_list *files;
+   RFILE *file;
+   int64_t budget;
+   size_t file_index;
+   unsigned generation;
+   bool resolved;
+} disk_prefetch_handle_t;
+
+/* Bumped on each push; a running prefetch for an older
+ * disc gives up at its next chunk */
+static unsigned disk_prefetch_generation = 0;
+
+#ifdef HAVE_LIBRETRODB
+bool cue_next_file(intfstream_t *fd, const char *cue_path,
+      char *path, uint64_t max_len);
+bool gdi_next_file(intfstream_t *fd, const char *gdi_path,
+      char *path, uint64_t max_len);
+#endif
+
+static struct string_list *disk_prefetch_resolve(const char *image_path)
+{
+   union string_list_elem_attr attr;
+   struct string_list *files = string_list_new();
+#ifdef HAVE_LIBRETRODB
+   const char *ext           = path_get_extension(image_path);
+   bool is_cue               = string_is_equal_noncase(ext, "cue");
+   bool is_gdi               = string_is_equal_noncase(ext, "gdi");
+#endif
+
+   if (!files)
+      return NULL;
+
+   attr.i = 0;
+
+#ifdef HAVE_LIBRETRODB
+   /* Sheets are tiny, what matters is the track data */
+   if (is_cue || is_gdi)
+   {
+      intfstream_t *fd = intfstream_open_file(image_path,
+            RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (fd)
+      {
+         char track_path[PATH_MAX_LENGTH];
+
+         track_path[0] = '\0';
+
+         while (is_cue
+               ? cue_next_file(fd, image_path, track_path, sizeof(track_path))
+               : gdi_next_file(fd, image_path, track_path, sizeof(track_path)))
+         {
+            if (!string_list_find_elem(files, track_path))
+               string_list_append(files, track_path, attr);
+         }
+
+         intfstream_close(fd);
+         free(fd);
+      }
+
+      if (files->size > 0)
+         return files;
+   }
+#endif
+
+   string_list_append(files, image_path, attr);
+   return files;
+}
+
+static void task_disk_prefetch_handler(retro_task_t *task)
+{
+   disk_prefetch_handle_t *handle = (disk_prefetch_handle_t*)task->state;
+   uint8_t *buf                   = NULL;
+   int64_t len                    = 0;
+
+   if (     !handle
+         || task_get_cancelled(task)
+         || handle->generation != disk_prefetch_generation)
+      goto task_finished;
+
+   if (!handle->resolved)
+   {
+      handle->files    = disk_prefetch_resolve(
+            (const char*)task->user_data);
+      handle->resolved = true;
+      return;
+   }
+
+   if (!handle->files || handle->budget <= 0)
+      goto task_finished;
+
+   if (!handle->file)
+   {
+      if (handle->file_index >= handle->files->size)
+         goto task_finished;
+
+      handle->file = filestream_open(
+            handle->files->elems[handle->file_index++].data,
+            RETRO_VFS_FILE_ACCESS_READ,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+      return;
+   }
+
+   if (!(buf = (uint8_t*)malloc(DISK_PREFETCH_CHUNK_SIZE)))
+      goto task_finished;
+
+   len = filestream_read(handle->file, buf,
+         MIN(DISK_PREFETCH_CHUNK_SIZE, handle->budget));
+   free(buf);
+
+   if (len > 0)
+   {
+      handle->budget -= len;
+      task_set_progress(task, (int8_t)(100 -
+            (handle->budget * 100 / DISK_PREFETCH_MAX_SIZE)));
+      return;
+   }
+
+   /* End of this track, move on to the next */
+   filestream_close(handle->file);
+   handle->file = NULL;
+   return;
+
+task_finished:
+   if (handle)
+   {
+      if (handle->file)
+         filestream_close(handle->file);
+      string_list_free(handle->files);
+      free(handle);
+      task->state = NULL;
+   }
+   free(task->user_data);
+   task->user_data = NULL;
+   task_set_finished(task, true);
+}
+
+/* Reads the start of the image at 'image_path' (or of
+ * the tracks it lists, for .cue/.gdi) in the background.
+ * Supersedes any prefetch still running. */
+bool task_push_disk_prefetch(const char *image_path)
+{
+   retro_task_t *task             = NULL;
+   disk_prefetch_handle_t *handle = NULL;
+
+   if (string_is_empty(image_path) || !path_is_valid(image_path))
+      return false;
+
+   if (!(task = task_init()))
+      return false;
+
+   if (!(handle = (disk_prefetch_handle_t*)
+            calloc(1, sizeof(*handle))))
+   {
+      free(task);
+      return false;
+   }
+
+   handle->budget     = DISK_PREFETCH_MAX_SIZE;
+   handle->generation = ++disk_prefetch_generation;
+
+   task->handler      = task_disk_prefetch_handler;
+   task->state        = handle;
+   task->user_data    = strdup(image_path);
+   task->mute         = true;
+
+   RARCH_LOG("[Disk]: Prefetching \"%s\".\n", image_path);
+
+   task_queue_push(task);
+
+   return true;
+}
@@ -21,6 +21,7 @@
 #include <retro_miscellaneous.h>
 
 #include <queues/task_queue.h>
+#include <net/net_http.h>
 
 #include "../msg_hash.h"
 
@@ -81,6 +82,29 @@ typedef struct
 void* task_push_http_transfer_file(const char* url, bool mute, const char* type,
       retro_task_callback_t cb, file_transfer_t* transfer_data);
 
+/* Same as task_push_http_transfer_file(), but the body is written
+ * to transfer_data->path while it is received, so that memory use
+ * does not depend on the file size. The file is only replaced once
+ * the whole body arrived. On success the callback gets no data,
+ * just the number of bytes written in 'len'.
+ * If set, 'tap' is handed each piece of the body after it was
+ * written (on the task thread); once it returns false it is no
+ * longer called. */
+void* task_push_http_transfer_file_stream(const char* url, bool mute, const char* type,
+      net_http_sink_t tap, void *tap_data,
+      retro_task_callback_t cb, file_transfer_t* transfer_data);
+
+/* Same as task_push_http_transfer_file(), but responses that carry
+ * an ETag or Last-Modified header are kept in 'cache_dir'. The next
+ * request for the same URL asks the server whether it changed; if
+ * it answers 304, the callback gets the cached body with
+ * 'not_modified' set. Without a cache directory this is a plain
+ * transfer. Meant for small index files, the whole body is kept
+ * in memory. */
+void* task_push_http_transfer_file_cached(const char* url,
+      const char *cache_dir, bool mute, const char* type,
+      retro_task_callback_t cb, file_transfer_t* transfer_data);
+
 RETRO_END_DECLS
 
 #endif
@@ -20,6 +20,8 @@
 #include <compat/strl.h>
 #include <file/file_path.h>
 #include <net/net_compat.h>
+#include <streams/file_stream.h>
+#include <encodings/crc32.h>
 #include <retro_timers.h>
 
 #ifdef RARCH_INTERNAL
@@ -28,6 +30,10 @@
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
 
+/* Upper bound of the URL and validators stored
+ * in front of a cached response body */
+#define TASK_HTTP_CACHE_HEADER_MAX 4096
+
 enum http_status_enum
 {
    HTTP_STATUS_CONNECTION_TRANSFER = 0,
@@ -52,6 +58,20 @@ struct http_handle
       struct http_connection_t *handle;
       transfer_cb_t  cb;
    } connection;
+   /* Only set when streaming the body to disk */
+   RFILE *file;
+   char *file_path;
+   char *file_tmp_path;
+   size_t file_len;
+   /* Optionally sees the body too, while it is written */
+   net_http_sink_t file_tap;
+   void *file_tap_data;
+   /* Only set for transfers that may be answered
+    * from the local cache */
+   char *cache_path;
+   char *cache_url;
+   char *cache_body;
+   size_t cache_len;
    unsigned status;
    bool error;
    char connection_elem[255];
@@ -84,6 +104,228 @@ static int task_http_conn_iterate_transfer_parse(
    return 0;
 }
 
+/* Body sink of file transfers, writes to a temporary file
+ * that replaces the target once the transfer succeeded */
+static bool task_http_write_file(void *userdata,
+      const uint8_t *data, size_t len)
+{
+   http_handle_t *http = (http_handle_t*)userdata;
+
+   if (!http->file)
+   {
+      char dir[PATH_MAX_LENGTH];
+
+      strlcpy(dir, http->file_path, sizeof(dir));
+      path_basedir_wrapper(dir);
+
+      if (!path_is_directory(dir) && !path_mkdir(dir))
+         return false;
+
+      if (!(http->file = filestream_open(http->file_tmp_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+         return false;
+   }
+
+   if (filestream_write(http->file, data, len) != (int64_t)len)
+      return false;
+
+   http->file_len += len;
+
+   /* The file still gets written if the tap gives up */
+   if (http->file_tap && !http->file_tap(http->file_tap_data, data, len))
+      http->file_tap = NULL;
+
+   return true;
+}
+
+/* Closes the file written by a streaming transfer and
+ * moves it into place, or discards it */
+static bool task_http_finish_file(http_handle_t *http, bool success)
+{
+   if (!http->file)
+      return success && http->file_len == 0;
+
+   if (filestream_close(http->file) != 0)
+      success   = false;
+   http->file   = NULL;
+
+   if (success)
+   {
+      if (path_is_valid(http->file_path))
+         filestream_delete(http->file_path);
+      success = filestream_rename(http->file_tmp_path, http->file_path) == 0;
+   }
+
+   if (!success)
+      filestream_delete(http->file_tmp_path);
+
+   return success;
+}
+
+/* A cache file holds the URL, ETag and Last-Modified
+ * header of a response, one per line, followed by
+ * the body. Terminates the lines in place and returns
+ * the offset of the body, or 0 if 'buf' is not a
+ * cached copy of 'url'. */
+static size_t task_http_cache_parse(char *buf, size_t len,
+      const char *url, char **etag, char **last_modified)
+{
+   char *lines[3];
+   char *pos = buf;
+   char *end = buf + len;
+   unsigned i;
+
+   for (i = 0; i < 3; i++)
+   {
+      char *eol = (char*)memchr(pos, '\n', end - pos);
+
+      if (!eol)
+         return 0;
+
+      *eol     = '\0';
+      lines[i] = pos;
+      pos      = eol + 1;
+   }
+
+   if (!string_is_equal(lines[0], url))
+      return 0;
+
+   *etag          = lines[1];
+   *last_modified = lines[2];
+
+   return pos - buf;
+}
+
+/* Asks the server to only send the response
+ * again if it differs from the cached one */
+static void task_http_cache_request(http_handle_t *http)
+{
+   char buf[TASK_HTTP_CACHE_HEADER_MAX];
+   /* Room for both validators and the header names */
+   char headers[TASK_HTTP_CACHE_HEADER_MAX + 64];
+   char *etag          = NULL;
+   char *last_modified = NULL;
+   int64_t len         = 0;
+   RFILE *file         = NULL;
+
+   if (!path_is_valid(http->cache_path))
+      return;
+
+   if (!(file = filestream_open(http->cache_path,
+            RETRO_VFS_FILE_ACCESS_READ,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   len = filestream_read(file, buf, sizeof(buf));
+   filestream_close(file);
+
+   if (len <= 0 || !task_http_cache_parse(buf, (size_t)len,
+            http->cache_url, &etag, &last_modified))
+      return;
+
+   headers[0] = '\0';
+
+   if (!string_is_empty(etag))
+   {
+      strlcat(headers, "If-None-Match: ", sizeof(headers));
+      strlcat(headers, etag, sizeof(headers));
+      strlcat(headers, "\r\n", sizeof(headers));
+   }
+
+   if (!string_is_empty(last_modified))
+   {
+      strlcat(headers, "If-Modified-Since: ", sizeof(headers));
+      strlcat(headers, last_modified, sizeof(headers));
+      strlcat(headers, "\r\n", sizeof(headers));
+   }
+
+   net_http_connection_set_headers(http->connection.handle, headers);
+}
+
+/* Picks up the cached body if the server answered
+ * 304, or caches a fresh response that the server
+ * can be asked about next time */
+static void task_http_cache_update(http_handle_t *http,
+      const char *body, size_t len)
+{
+   const char *etag          = net_http_etag(http->handle);
+   const char *last_modified = net_http_last_modified(http->handle);
+   int status                = net_http_status(http->handle);
+
+   if (status == 304)
+   {
+      char *cached_etag          = NULL;
+      char *cached_last_modified = NULL;
+      void *buf                  = NULL;
+      int64_t buf_len            = 0;
+      size_t offset              = 0;
+
+      if (filestream_read_file(http->cache_path, &buf, &buf_len))
+         offset = task_http_cache_parse((char*)buf, (size_t)buf_len,
+               http->cache_url, &cached_etag, &cached_last_modified);
+
+      if (!offset)
+      {
+         if (buf)
+            free(buf);
+         filestream_delete(http->cache_path);
+         return;
+      }
+
+      /* Including the terminator added by filestream_read_file() */
+      memmove(buf, (char*)buf + offset, (size_t)buf_len - offset + 1);
+      http->cache_body = (char*)buf;
+      http->cache_len  = (size_t)buf_len - offset;
+   }
+   else if (status == 200 && body)
+   {
+      char dir[PATH_MAX_LENGTH];
+      char tmp_path[PATH_MAX_LENGTH];
+      RFILE *file = NULL;
+
+      /* Nothing to revalidate against */
+      if (string_is_empty(etag) && string_is_empty(last_modified))
+      {
+         if (path_is_valid(http->cache_path))
+            filestream_delete(http->cache_path);
+         return;
+      }
+
+      strlcpy(dir, http->cache_path, sizeof(dir));
+      path_basedir_wrapper(dir);
+
+      if (!path_is_directory(dir) && !path_mkdir(dir))
+         return;
+
+      /* Never leave a truncated body behind
+       * that could be revalidated later */
+      strlcpy(tmp_path, http->cache_path, sizeof(tmp_path));
+      strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+      if (!(file = filestream_open(tmp_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+         return;
+
+      if (     filestream_printf(file, "%s\n%s\n%s\n", http->cache_url,
+                  etag ? etag : "", last_modified ? last_modified : "") < 0
+            || filestream_write(file, body, len) != (int64_t)len)
+      {
+         filestream_close(file);
+         filestream_delete(tmp_path);
+         return;
+      }
+
+      filestream_close(file);
+
+      if (path_is_valid(http->cache_path))
+         filestream_delete(http->cache_path);
+      if (filestream_rename(tmp_path, http->cache_path) != 0)
+         filestream_delete(tmp_path);
+   }
+}
+
 static int cb_http_conn_default(void *data_, size_t len)
 {
    http_handle_t *http = (http_handle_t*)data_;
@@ -94,6 +336,9 @@ static int cb_http_conn_default(void *data_, size_t len)
    if (!network_init())
       return -1;
 
+   if (http->cache_path)
+      task_http_cache_request(http);
+
    http->handle = net_http_new(http->connection.handle);
 
    if (!http->handle)
@@ -102,6 +347,9 @@ static int cb_http_conn_default(void *data_, size_t len)
       return -1;
    }
 
+   if (http->file_path)
+      net_http_set_sink(http->handle, task_http_write_file, http);
+
    http->cb     = NULL;
 
    return 0;
@@ -183,7 +431,16 @@ task_finished:
       if (tmp && http->cb)
          http->cb(tmp, len);
 
-      if (net_http_error(http->handle) || task_get_cancelled(task))
+      if (http->file_path && !task_http_finish_file(http,
+               !net_http_error(http->handle) && !task_get_cancelled(task)))
+         http->error = true;
+
+      if (http->cache_path && !http->error && !task_get_cancelled(task))
+         task_http_cache_update(http, tmp, len);
+
+      if ((net_http_error(http->handle) && !http->cache_body)
+            || task_get_cancelled(task)
+            || http->error)
       {
          tmp = (char*)net_http_data(http->handle, &len, true);
 
@@ -199,7 +456,9 @@ task_finished:
             data = (http_transfer_data_t*)malloc(sizeof(*data));
             data->data   = NULL;
             data->len    = 0;
-            data->status = net_http_status(http->handle);
+            data->content_length = net_http_content_length(http->handle);
+            data->status = http->error ? -1 : net_http_status(http->handle);
+            data->not_modified = false;
 
             task_set_data(task, data);
 
@@ -207,12 +466,46 @@ task_finished:
                task_set_error(task, strdup("Download failed."));
          }
       }
+      else if (http->cache_body)
+      {
+         /* Whatever came with the 304 response */
+         tmp = (char*)net_http_data(http->handle, &len, true);
+
+         if (tmp)
+            free(tmp);
+
+         data = (http_transfer_data_t*)malloc(sizeof(*data));
+         data->data   = http->cache_body;
+         data->len    = http->cache_len;
+         data->content_length = http->cache_len;
+         data->status = 200;
+         data->not_modified = true;
+
+         task_set_data(task, data);
+      }
+      else if (http->file_path)
+      {
+         /* Everything is on disk already */
+         if (tmp)
+            free(tmp);
+
+         data = (http_transfer_data_t*)malloc(sizeof(*data));
+         data->data   = NULL;
+         data->len    = http->file_len;
+         data->content_length = net_http_content_length(http->handle);
+         data->status = net_http_status(http->handle);
+         data->not_modified = false;
+
+         task_set_data(task, data);
+      }
       else
       {
          data = (http_transfer_data_t*)malloc(sizeof(*data));
          data->data   = tmp;
          data->len    = len;
+         data->content_length = net_http_content_length(http->handle);
          data->status = net_http_status(http->handle);
+         data->not_modified = false;
 
          task_set_data(task, data);
       }
@@ -221,6 +514,20 @@ task_finished:
    } else if (http->error)
       task_set_error(task, strdup("Internal error."));
 
+   if (http->file_path)
+   {
+      /* Connection failures never get to open the file */
+      task_http_finish_file(http, false);
+      free(http->file_path);
+      free(http->file_tmp_path);
+   }
+
+   if (http->cache_path)
+   {
+      free(http->cache_path);
+      free(http->cache_url);
+   }
+
    free(http);
 }
 
@@ -277,7 +584,10 @@ static void http_transfer_progress_cb(retro_task_t *task)
 
 static void* task_push_http_transfer_generic(
       struct http_connection_t *conn,
-      const char *url, bool mute, const char *type,
+      const char *url, const char *file_path,
+      net_http_sink_t file_tap, void *file_tap_data,
+      const char *cache_dir,
+      bool mute, const char *type,
       retro_task_callback_t cb, void *user_data)
 {
    task_finder_data_t find_data;
@@ -312,6 +622,53 @@ static void* task_push_http_transfer_generic(
    http->cb                  = NULL;
    http->status              = 0;
    http->error               = false;
+   http->file                = NULL;
+   http->file_path           = NULL;
+   http->file_tmp_path       = NULL;
+   http->file_len            = 0;
+   http->file_tap            = file_tap;
+   http->file_tap_data       = file_tap_data;
+   http->cache_path          = NULL;
+   http->cache_url           = NULL;
+   http->cache_body          = NULL;
+   http->cache_len           = 0;
+
+   if (file_path)
+   {
+      size_t path_len          = strlen(file_path);
+
+      http->file_path          = strdup(file_path);
+      http->file_tmp_path      = (char*)malloc(path_len + STRLEN_CONST(".tmp") + 1);
+
+      if (!http->file_path || !http->file_tmp_path)
+         goto error;
+
+      memcpy(http->file_tmp_path, file_path, path_len);
+      strlcpy(http->file_tmp_path + path_len, ".tmp",
+            STRLEN_CONST(".tmp") + 1);
+   }
+
+   if (!string_is_empty(cache_dir)
+         && strlen(url) < TASK_HTTP_CACHE_HEADER_MAX / 2)
+   {
+      char cache_name[32];
+      char cache_path[PATH_MAX_LENGTH];
+
+      /* Named after the URL, which is also stored
+       * in the file in case two of them collide */
+      snprintf(cache_name, sizeof(cache_name), "%08x.http",
+            (unsigned)encoding_crc32(0, (const uint8_t*)url, strlen(url)));
+      fill_pathname_join(cache_path, cache_dir, "http",
+            sizeof(cache_path));
+      fill_pathname_join(cache_path, cache_path, cache_name,
+            sizeof(cache_path));
+
+      http->cache_path         = strdup(cache_path);
+      http->cache_url          = strdup(url);
+
+      if (!http->cache_path || !http->cache_url)
+         goto error;
+   }
 
    if (type)
       strlcpy(http->connection_elem, type, sizeof(http->connection_elem));
@@ -325,6 +682,7 @@ static void* task_push_http_transfer_generic(
       goto error;
 
    t->handler              = task_http_transfer_handler;
+   t->affinity             = TASK_AFFINITY_ANY;
    t->state                = http;
    t->mute                 = mute;
    t->callback             = cb;
@@ -341,7 +699,17 @@ error:
    if (conn)
       net_http_connection_free(conn);
    if (http)
+   {
+      if (http->file_path)
+         free(http->file_path);
+      if (http->file_tmp_path)
+         free(http->file_tmp_path);
+      if (http->cache_path)
+         free(http->cache_path);
+      if (http->cache_url)
+         free(http->cache_url);
       free(http);
+   }
 
    return NULL;
 }
@@ -355,11 +723,12 @@ void* task_push_http_transfer(const char *url, bool mute,
 
    return task_push_http_transfer_generic(
          net_http_connection_new(url, "GET", NULL),
-         url, mute, type, cb, user_data);
+         url, NULL, NULL, NULL, NULL, mute, type, cb, user_data);
 }
 
-void* task_push_http_transfer_file(const char* url, bool mute,
-      const char* type,
+static void* task_push_http_transfer_file_generic(const char* url,
+      const char *file_path, net_http_sink_t tap, void *tap_data,
+      const char *cache_dir, bool mute, const char* type,
       retro_task_callback_t cb, file_transfer_t* transfer_data)
 {
    const char *s   = NULL;
@@ -371,7 +740,8 @@ void* task_push_http_transfer_file(const char* url, bool mute,
 
    t = (retro_task_t*)task_push_http_transfer_generic(
          net_http_connection_new(url, "GET", NULL),
-         url, mute, type, cb, transfer_data);
+         url, file_path, tap, tap_data, cache_dir,
+         mute, type, cb, transfer_data);
 
    if (!t)
       return NULL;
@@ -394,6 +764,32 @@ void* task_push_http_transfer_file(const char* url, bool mute,
    return t;
 }
 
+void* task_push_http_transfer_file(const char* url, bool mute,
+      const char* type,
+      retro_task_callback_t cb, file_transfer_t* transfer_data)
+{
+   return task_push_http_transfer_file_generic(url, NULL, NULL, NULL,
+         NULL, mute, type, cb, transfer_data);
+}
+
+void* task_push_http_transfer_file_cached(const char* url,
+      const char *cache_dir, bool mute, const char* type,
+      retro_task_callback_t cb, file_transfer_t* transfer_data)
+{
+   return task_push_http_transfer_file_generic(url, NULL, NULL, NULL,
+         cache_dir, mute, type, cb, transfer_data);
+}
+
+void* task_push_http_transfer_file_stream(const char* url, bool mute,
+      const char* type, net_http_sink_t tap, void *tap_data,
+      retro_task_callback_t cb, file_transfer_t* transfer_data)
+{
+   if (!transfer_data || string_is_empty(transfer_data->path))
+      return NULL;
+   return task_push_http_transfer_file_generic(url, transfer_data->path,
+         tap, tap_data, NULL, mute, type, cb, transfer_data);
+}
+
 void* task_push_http_transfer_with_user_agent(const char *url, bool mute,
    const char *type, const char* user_agent,
    retro_task_callback_t cb, void *user_data)
@@ -411,7 +807,7 @@ void* task_push_http_transfer_with_user_agent(const char *url, bool mute,
       net_http_connection_set_user_agent(conn, user_agent);
 
    /* assert: task_push_http_transfer_generic will free conn on failure */
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, NULL, NULL, NULL, NULL, mute, type, cb, user_data);
 }
 
 void* task_push_http_post_transfer(const char *url,
@@ -422,7 +818,18 @@ void* task_push_http_post_transfer(const char *url,
       return NULL;
    return task_push_http_transfer_generic(
          net_http_connection_new(url, "POST", post_data),
-         url, mute, type, cb, user_data);
+         url, NULL, NULL, NULL, NULL, mute, type, cb, user_data);
+}
+
+void* task_push_http_head_transfer(const char *url, bool mute,
+      const char *type,
+      retro_task_callback_t cb, void *user_data)
+{
+   if (string_is_empty(url))
+      return NULL;
+   return task_push_http_transfer_generic(
+         net_http_connection_new(url, "HEAD", NULL),
+         url, NULL, NULL, NULL, NULL, mute, type, cb, user_data);
 }
 
 void* task_push_http_post_transfer_with_user_agent(const char *url,
@@ -443,7 +850,7 @@ void* task_push_http_post_transfer_with_user_agent(const char *url,
       net_http_connection_set_user_agent(conn, user_agent);
 
    /* assert: task_push_http_transfer_generic will free conn on failure */
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, NULL, NULL, NULL, NULL, mute, type, cb, user_data);
 }
 
 task_retriever_info_t *http_task_get_transfer_list(void)
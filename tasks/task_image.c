@@ -19,25 +19,64 @@
 #include <errno.h>
 
 #include <file/nbio.h>
+#include <file/file_path.h>
 #include <formats/image.h>
+#include <streams/file_stream.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
 
 #include "../configuration.h"
 
+/* Sidecar files hold a downscaled copy of an image as
+ * raw pixels, ready for upload, behind this header */
+#define IMAGE_SIDECAR_MAGIC   0x43534152 /* 'RASC' */
+#define IMAGE_SIDECAR_VERSION 1
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t width;
+   uint32_t height;
+   uint32_t max_size;
+   uint32_t supports_rgba;
+   /* Size of the source image file, a changed
+    * image invalidates the sidecar */
+   uint32_t source_size_lo;
+   uint32_t source_size_hi;
+} image_sidecar_header_t;
+
 enum image_status_enum
 {
    IMAGE_STATUS_WAIT = 0,
    IMAGE_STATUS_TRANSFER,
    IMAGE_STATUS_TRANSFER_PARSE,
    IMAGE_STATUS_PROCESS_TRANSFER,
-   IMAGE_STATUS_PROCESS_TRANSFER_PARSE
+   IMAGE_STATUS_PROCESS_TRANSFER_PARSE,
+   /* Decoding on the worker pool */
+   IMAGE_STATUS_DECODE_ASYNC
+};
+
+#ifdef HAVE_THREADS
+/* Upper bound of images decoded at the same time */
+#define IMAGE_DECODE_THREADS_MAX 4
+
+enum image_async_enum
+{
+   IMAGE_ASYNC_NONE = 0,
+   IMAGE_ASYNC_RUNNING,
+   IMAGE_ASYNC_DONE
 };
+#endif
 
 struct nbio_image_handle
 {
@@ -48,8 +87,19 @@ struct nbio_image_handle
    int processing_final_state;
    unsigned frame_duration;
    unsigned upscale_threshold;
+   unsigned max_size;
+   int64_t source_size;
+   char *sidecar_path;
+#ifdef HAVE_THREADS
+   /* Guards the fields below while a worker decodes */
+   slock_t *async_lock;
+   enum image_async_enum async_state;
+   bool async_abandoned;
+   bool async_success;
+#endif
    enum image_type_enum type;
    enum image_status_enum status;
+   bool supports_rgba;
    bool is_blocking;
    bool is_blocking_on_processing;
    bool is_finished;
@@ -162,8 +212,17 @@ static void task_image_cleanup(nbio_handle_t *nbio)
    {
       image_transfer_free(image->handle, image->type);
 
+      if (image->sidecar_path)
+         free(image->sidecar_path);
+#ifdef HAVE_THREADS
+      if (image->async_lock)
+         slock_free(image->async_lock);
+      image->async_lock             = NULL;
+#endif
+
       image->handle                 = NULL;
       image->cb                     = NULL;
+      image->sidecar_path           = NULL;
    }
    if (!string_is_empty(nbio->path))
       free(nbio->path);
@@ -179,6 +238,29 @@ static void task_image_load_free(retro_task_t *task)
 {
    nbio_handle_t       *nbio  = task ? (nbio_handle_t*)task->state : NULL;
 
+#ifdef HAVE_THREADS
+   /* A worker still decoding for a cancelled task
+    * frees everything once it is done */
+   if (nbio && nbio->data)
+   {
+      struct nbio_image_handle *image = (struct nbio_image_handle*)nbio->data;
+
+      if (image->async_lock)
+      {
+         bool running;
+
+         slock_lock(image->async_lock);
+         running = (image->async_state == IMAGE_ASYNC_RUNNING);
+         if (running)
+            image->async_abandoned = true;
+         slock_unlock(image->async_lock);
+
+         if (running)
+            return;
+      }
+   }
+#endif
+
    if (nbio)
    {
       task_image_cleanup(nbio);
@@ -206,6 +288,11 @@ static int cb_nbio_image_thumbnail(void *data, size_t len)
 
    image_transfer_set_buffer_ptr(image->handle, image->type, ptr, len);
 
+   /* Let the decoder skip what downscale_image() would throw away */
+   if (image->max_size > 0)
+      image_transfer_set_max_size(image->handle, image->type,
+            image->max_size);
+
    /* Set image size */
    image->size                     = len;
 
@@ -230,6 +317,206 @@ static int cb_nbio_image_thumbnail(void *data, size_t len)
    return 0;
 }
 
+/* Takes the pixels of a sidecar read by nbio, these
+ * need no further processing */
+static int cb_nbio_image_sidecar(void *data, size_t len)
+{
+   image_sidecar_header_t header;
+   const uint8_t *ptr              = NULL;
+   nbio_handle_t *nbio             = (nbio_handle_t*)data;
+   struct nbio_image_handle *image = nbio  ? (struct nbio_image_handle*)nbio->data : NULL;
+   size_t pixels_size              = 0;
+
+   if (!image)
+      return -1;
+
+   ptr = (const uint8_t*)nbio_get_ptr(nbio->handle, &len);
+
+   if (!ptr || len < sizeof(header))
+      return -1;
+
+   memcpy(&header, ptr, sizeof(header));
+   pixels_size = (size_t)header.width * header.height * sizeof(uint32_t);
+
+   if (     header.magic   != IMAGE_SIDECAR_MAGIC
+         || header.version != IMAGE_SIDECAR_VERSION
+         || !pixels_size
+         || len != sizeof(header) + pixels_size)
+      return -1;
+
+   if (!(image->ti.pixels = (uint32_t*)malloc(pixels_size)))
+      return -1;
+
+   memcpy(image->ti.pixels, ptr + sizeof(header), pixels_size);
+   image->ti.width                 = header.width;
+   image->ti.height                = header.height;
+
+   image->status                   = IMAGE_STATUS_PROCESS_TRANSFER_PARSE;
+   image->is_blocking              = true;
+   image->is_finished              = true;
+   nbio->is_finished               = true;
+
+   return 0;
+}
+
+/* Checks whether 'sidecar_path' holds an up to date copy of
+ * the source image, reading the header only */
+static bool task_image_sidecar_is_valid(const char *sidecar_path,
+      int64_t source_size, unsigned max_size, bool supports_rgba)
+{
+   image_sidecar_header_t header;
+   int64_t size = 0;
+   RFILE *file  = filestream_open(sidecar_path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   size = filestream_get_size(file);
+
+   if (filestream_read(file, &header, sizeof(header)) != sizeof(header))
+   {
+      filestream_close(file);
+      return false;
+   }
+
+   filestream_close(file);
+
+   return header.magic          == IMAGE_SIDECAR_MAGIC
+      &&  header.version        == IMAGE_SIDECAR_VERSION
+      &&  header.max_size       == max_size
+      &&  header.supports_rgba  == (supports_rgba ? 1 : 0)
+      &&  header.source_size_lo == (uint32_t)source_size
+      &&  header.source_size_hi == (uint32_t)((uint64_t)source_size >> 32)
+      &&  size == (int64_t)(sizeof(header) +
+            (size_t)header.width * header.height * sizeof(uint32_t));
+}
+
+static void task_image_sidecar_write(struct nbio_image_handle *image)
+{
+   size_t pixels_size;
+   image_sidecar_header_t header;
+   char dir[PATH_MAX_LENGTH];
+   RFILE *file = NULL;
+
+   dir[0] = '\0';
+
+   fill_pathname_basedir(dir, image->sidecar_path, sizeof(dir));
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      return;
+
+   header.magic          = IMAGE_SIDECAR_MAGIC;
+   header.version        = IMAGE_SIDECAR_VERSION;
+   header.width          = image->ti.width;
+   header.height         = image->ti.height;
+   header.max_size       = image->max_size;
+   header.supports_rgba  = image->supports_rgba ? 1 : 0;
+   header.source_size_lo = (uint32_t)image->source_size;
+   header.source_size_hi = (uint32_t)((uint64_t)image->source_size >> 32);
+   pixels_size           = (size_t)image->ti.width * image->ti.height
+      * sizeof(uint32_t);
+
+   if (!(file = filestream_open(image->sidecar_path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   /* A partially written file fails the size check,
+    * but don't leave it around */
+   if (     filestream_write(file, &header, sizeof(header)) != sizeof(header)
+         || filestream_write(file, image->ti.pixels, pixels_size)
+            != (int64_t)pixels_size)
+   {
+      filestream_close(file);
+      filestream_delete(image->sidecar_path);
+      return;
+   }
+
+   filestream_close(file);
+}
+
+/* Box filter, averages all source pixels covered by each
+ * destination pixel. Works on any 8 bit per channel layout. */
+static bool downscale_image(
+      unsigned max_size,
+      struct texture_image *image_src,
+      struct texture_image *image_dst)
+{
+   unsigned x_dst, y_dst;
+   unsigned max_dim;
+
+   /* Sanity check */
+   if ((max_size < 1) || !image_src || !image_dst)
+      return false;
+
+   if (!image_src->pixels || (image_src->width < 1) || (image_src->height < 1))
+      return false;
+
+   max_dim = (image_src->width > image_src->height)
+      ? image_src->width : image_src->height;
+
+   if (max_dim <= max_size)
+      return false;
+
+   /* Get output dimensions, keeping the aspect ratio */
+   image_dst->width  = (unsigned)(((uint64_t)image_src->width  * max_size) / max_dim);
+   image_dst->height = (unsigned)(((uint64_t)image_src->height * max_size) / max_dim);
+   if (image_dst->width < 1)
+      image_dst->width = 1;
+   if (image_dst->height < 1)
+      image_dst->height = 1;
+
+   /* Allocate pixel buffer */
+   image_dst->pixels = (uint32_t*)malloc(image_dst->width * image_dst->height * sizeof(uint32_t));
+   if (!image_dst->pixels)
+      return false;
+
+   for (y_dst = 0; y_dst < image_dst->height; y_dst++)
+   {
+      unsigned y0 = (unsigned)(((uint64_t)y_dst       * image_src->height) / image_dst->height);
+      unsigned y1 = (unsigned)(((uint64_t)(y_dst + 1) * image_src->height) / image_dst->height);
+
+      if (y1 <= y0)
+         y1 = y0 + 1;
+
+      for (x_dst = 0; x_dst < image_dst->width; x_dst++)
+      {
+         unsigned x, y;
+         uint32_t sum[4];
+         unsigned x0     = (unsigned)(((uint64_t)x_dst       * image_src->width) / image_dst->width);
+         unsigned x1     = (unsigned)(((uint64_t)(x_dst + 1) * image_src->width) / image_dst->width);
+         uint32_t count;
+
+         if (x1 <= x0)
+            x1 = x0 + 1;
+
+         count  = (x1 - x0) * (y1 - y0);
+         sum[0] = sum[1] = sum[2] = sum[3] = 0;
+
+         for (y = y0; y < y1; y++)
+         {
+            const uint32_t *src = image_src->pixels + (y * image_src->width);
+
+            for (x = x0; x < x1; x++)
+            {
+               uint32_t c = src[x];
+               sum[0]    += (c      ) & 0xFF;
+               sum[1]    += (c >>  8) & 0xFF;
+               sum[2]    += (c >> 16) & 0xFF;
+               sum[3]    += (c >> 24) & 0xFF;
+            }
+         }
+
+         image_dst->pixels[(y_dst * image_dst->width) + x_dst] =
+                ((sum[0] + count / 2) / count)
+             | (((sum[1] + count / 2) / count) <<  8)
+             | (((sum[2] + count / 2) / count) << 16)
+             | (((sum[3] + count / 2) / count) << 24);
+      }
+   }
+
+   return true;
+}
+
 static bool upscale_image(
       unsigned scale_factor,
       struct texture_image *image_src,
@@ -272,6 +559,169 @@ static bool upscale_image(
    return true;
 }
 
+/* Applies the downscaling and upscaling requested for
+ * a decoded image */
+static void task_image_scale(struct nbio_image_handle *image)
+{
+   /* Downscale image and keep the result around
+    * for the next time, if required */
+   if (image->max_size > 0)
+   {
+      struct texture_image img_resampled = {
+         NULL,
+         0,
+         0,
+         false
+      };
+
+      if (downscale_image(image->max_size, &image->ti, &img_resampled))
+      {
+         image->ti.width  = img_resampled.width;
+         image->ti.height = img_resampled.height;
+
+         if (image->ti.pixels)
+            free(image->ti.pixels);
+         image->ti.pixels = img_resampled.pixels;
+
+         if (image->sidecar_path)
+            task_image_sidecar_write(image);
+      }
+   }
+
+   /* Upscale image, if required */
+   if (image->upscale_threshold > 0)
+   {
+      if (((image->ti.width > 0) && (image->ti.height > 0)) &&
+          ((image->ti.width  < image->upscale_threshold) ||
+           (image->ti.height < image->upscale_threshold)))
+      {
+         unsigned min_size                  = (image->ti.width < image->ti.height) ?
+                                                image->ti.width : image->ti.height;
+         float scale_factor                 = (float)image->upscale_threshold /
+                                                (float)min_size;
+         unsigned scale_factor_int          = (unsigned)scale_factor;
+         struct texture_image img_resampled = {
+            NULL,
+            0,
+            0,
+            false
+         };
+
+         if (scale_factor - (float)scale_factor_int > 0.0f)
+            scale_factor_int += 1;
+
+         if (upscale_image(scale_factor_int, &image->ti, &img_resampled))
+         {
+            image->ti.width  = img_resampled.width;
+            image->ti.height = img_resampled.height;
+
+            if (image->ti.pixels)
+               free(image->ti.pixels);
+            image->ti.pixels = img_resampled.pixels;
+         }
+      }
+   }
+}
+
+#ifdef HAVE_THREADS
+static tpool_t *image_decode_pool = NULL;
+
+/* Runs the whole decode of an image on a worker, including
+ * everything the task would otherwise spread over frames */
+static void task_image_decode_work(void *data)
+{
+   nbio_handle_t *nbio             = (nbio_handle_t*)data;
+   struct nbio_image_handle *image = (struct nbio_image_handle*)nbio->data;
+   int retval                      = IMAGE_PROCESS_ERROR;
+   unsigned width                  = 0;
+   unsigned height                 = 0;
+   bool abandoned                  = false;
+
+   slock_lock(image->async_lock);
+   abandoned = image->async_abandoned;
+   slock_unlock(image->async_lock);
+
+   if (!abandoned)
+   {
+      while (image_transfer_iterate(image->handle, image->type));
+
+      do
+      {
+         retval = task_image_process(image, &width, &height);
+      } while (retval == IMAGE_PROCESS_NEXT);
+
+      if (     (retval != IMAGE_PROCESS_ERROR)
+            && (retval != IMAGE_PROCESS_ERROR_END))
+      {
+         unsigned r_shift, g_shift, b_shift, a_shift;
+
+         image_texture_set_color_shifts(&r_shift, &g_shift, &b_shift,
+               &a_shift, &image->ti);
+         image_texture_color_convert(r_shift, g_shift, b_shift,
+               a_shift, &image->ti);
+         task_image_scale(image);
+      }
+   }
+
+   slock_lock(image->async_lock);
+   image->async_state   = IMAGE_ASYNC_DONE;
+   image->async_success = (retval != IMAGE_PROCESS_ERROR)
+      && (retval != IMAGE_PROCESS_ERROR_END);
+   abandoned            = image->async_abandoned;
+   slock_unlock(image->async_lock);
+
+   if (abandoned)
+   {
+      if (image->ti.pixels)
+         free(image->ti.pixels);
+      image->ti.pixels = NULL;
+      task_image_cleanup(nbio);
+      free(nbio);
+   }
+}
+
+/* Hands the decode over to the worker pool, so several
+ * images decode at the same time while the task queue
+ * thread only waits for them. Returns false if the
+ * image has to be decoded by the task itself. */
+static bool task_image_decode_async(nbio_handle_t *nbio)
+{
+   struct nbio_image_handle *image = (struct nbio_image_handle*)nbio->data;
+
+   if (!image_decode_pool)
+   {
+      unsigned cores = cpu_features_get_core_amount();
+      unsigned num   = (cores > 1) ? cores - 1 : 1;
+
+      if (num > IMAGE_DECODE_THREADS_MAX)
+         num = IMAGE_DECODE_THREADS_MAX;
+
+      if (!(image_decode_pool = tpool_create(num)))
+         return false;
+   }
+
+   if (!image->async_lock && !(image->async_lock = slock_new()))
+      return false;
+
+   image->async_state = IMAGE_ASYNC_RUNNING;
+
+   if (!tpool_add_work(image_decode_pool, task_image_decode_work, nbio))
+   {
+      image->async_state = IMAGE_ASYNC_NONE;
+      return false;
+   }
+
+   return true;
+}
+
+void task_image_pool_deinit(void)
+{
+   if (image_decode_pool)
+      tpool_destroy(image_decode_pool);
+   image_decode_pool = NULL;
+}
+#endif
+
 bool task_image_load_handler(retro_task_t *task)
 {
    nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
@@ -298,6 +748,14 @@ bool task_image_load_handler(retro_task_t *task)
                image->status = IMAGE_STATUS_PROCESS_TRANSFER;
             break;
          case IMAGE_STATUS_TRANSFER:
+#ifdef HAVE_THREADS
+            if (     !image->is_blocking && !image->is_finished
+                  && task_image_decode_async(nbio))
+            {
+               image->status = IMAGE_STATUS_DECODE_ASYNC;
+               break;
+            }
+#endif
             if (!image->is_blocking && !image->is_finished)
             {
                retro_time_t start_time = cpu_features_get_time_usec();
@@ -319,8 +777,27 @@ bool task_image_load_handler(retro_task_t *task)
                if (image->cb(nbio, len) == -1)
                   return false;
             }
-            if (!image->is_finished)
-               break;
+            break;
+         case IMAGE_STATUS_DECODE_ASYNC:
+#ifdef HAVE_THREADS
+            {
+               bool done    = false;
+               bool success = false;
+
+               slock_lock(image->async_lock);
+               done    = (image->async_state == IMAGE_ASYNC_DONE);
+               success = image->async_success;
+               slock_unlock(image->async_lock);
+
+               if (!done)
+                  return true;
+               if (!success)
+                  return false;
+
+               image->is_finished = true;
+            }
+#endif
+            break;
       }
    }
 
@@ -332,39 +809,11 @@ bool task_image_load_handler(retro_task_t *task)
 
       if (img)
       {
-         /* Upscale image, if required */
-         if (image->upscale_threshold > 0)
-         {
-            if (((image->ti.width > 0) && (image->ti.height > 0)) &&
-                ((image->ti.width  < image->upscale_threshold) ||
-                 (image->ti.height < image->upscale_threshold)))
-            {
-               unsigned min_size                  = (image->ti.width < image->ti.height) ?
-                                                      image->ti.width : image->ti.height;
-               float scale_factor                 = (float)image->upscale_threshold /
-                                                      (float)min_size;
-               unsigned scale_factor_int          = (unsigned)scale_factor;
-               struct texture_image img_resampled = {
-                  NULL,
-                  0,
-                  0,
-                  false
-               };
-
-               if (scale_factor - (float)scale_factor_int > 0.0f)
-                  scale_factor_int += 1;
-
-               if (upscale_image(scale_factor_int, &image->ti, &img_resampled))
-               {
-                  image->ti.width  = img_resampled.width;
-                  image->ti.height = img_resampled.height;
-
-                  if (image->ti.pixels)
-                     free(image->ti.pixels);
-                  image->ti.pixels = img_resampled.pixels;
-               }
-            }
-         }
+#ifdef HAVE_THREADS
+         /* Workers scale the image themselves */
+         if (image->status != IMAGE_STATUS_DECODE_ASYNC)
+#endif
+            task_image_scale(image);
 
          img->width         = image->ti.width;
          img->height        = image->ti.height;
@@ -383,6 +832,15 @@ bool task_image_load_handler(retro_task_t *task)
 bool task_push_image_load(const char *fullpath, 
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *user_data)
+{
+   return task_push_image_load_sidecar(fullpath, NULL, 0,
+         supports_rgba, upscale_threshold, cb, user_data);
+}
+
+bool task_push_image_load_sidecar(const char *fullpath,
+      const char *sidecar_path, unsigned max_size,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
 {
    nbio_handle_t             *nbio   = NULL;
    struct nbio_image_handle   *image = NULL;
@@ -430,7 +888,17 @@ bool task_push_image_load(const char *fullpath,
    image->frame_duration             = 0;
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
+   image->max_size                   = max_size;
+   image->source_size                = 0;
+   image->sidecar_path               = NULL;
+   image->supports_rgba              = supports_rgba;
    image->handle                     = NULL;
+#ifdef HAVE_THREADS
+   image->async_lock                 = NULL;
+   image->async_state                = IMAGE_ASYNC_NONE;
+   image->async_abandoned            = false;
+   image->async_success              = false;
+#endif
 
    image->ti.width                   = 0;
    image->ti.height                  = 0;
@@ -457,6 +925,28 @@ bool task_push_image_load(const char *fullpath,
          break;
    }
 
+   /* Read the sidecar instead of decoding the image
+    * when it is up to date, otherwise have it written
+    * once the image is scaled down */
+   if (max_size > 0 && !string_is_empty(sidecar_path))
+   {
+      image->source_size = path_get_size(fullpath);
+
+      if (image->source_size > 0)
+      {
+         if (task_image_sidecar_is_valid(sidecar_path,
+                  image->source_size, max_size, supports_rgba))
+         {
+            free(nbio->path);
+            nbio->path      = strdup(sidecar_path);
+            nbio->cb        = &cb_nbio_image_sidecar;
+            image->max_size = 0;
+         }
+         else
+            image->sidecar_path = strdup(sidecar_path);
+      }
+   }
+
    nbio->data          = (struct nbio_image_handle*)image;
 
    t->state           = nbio;
@@ -14,7 +14,13 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
+
+#include <compat/strl.h>
+#include <features/features_cpu.h>
 #include <lists/file_list.h>
+#include <net/net_compat.h>
+#include <net/net_socket.h>
 #include <string/stdstring.h>
 #include "../paths.h"
 
@@ -28,31 +34,99 @@
 #include "../verbosity.h"
 #include "../network/netplay/netplay_discovery.h"
 
+#define NETPLAY_LAN_SCAN_POLL_USEC      10000
+
+/* How long a round trip probe waits for each room */
+#define NETPLAY_LATENCY_PROBE_TIMEOUT   2000000
+
+typedef struct netplay_lan_scan_state
+{
+   retro_time_t start;
+   bool sent;
+} netplay_lan_scan_state_t;
+
+typedef struct netplay_latency_probe
+{
+   struct addrinfo *addr;
+   retro_time_t start;
+   int fd;
+   int port;
+   int latency;
+   char address[256];
+} netplay_latency_probe_t;
+
+typedef struct netplay_latency_probe_state
+{
+   netplay_latency_probe_t *probes;
+   retro_task_callback_t cb;
+   retro_time_t start;
+   size_t count;
+   bool started;
+} netplay_latency_probe_state_t;
+
+/* Sends the query, then collects replies for
+ * NETPLAY_DISCOVERY_WAIT without blocking the queue
+ * for longer than NETPLAY_LAN_SCAN_POLL_USEC at a time */
 static void task_netplay_lan_scan_handler(retro_task_t *task)
 {
-   if (init_netplay_discovery())
+   netplay_lan_scan_state_t *state = (netplay_lan_scan_state_t*)task->state;
+   unsigned timeout                = NETPLAY_LAN_SCAN_POLL_USEC;
+   retro_time_t elapsed;
+
+   if (!state->sent)
    {
+      state->sent  = true;
+      state->start = cpu_features_get_time_usec();
+
+      if (!init_netplay_discovery())
+         goto finish;
+
       netplay_discovery_driver_ctl(
             RARCH_NETPLAY_DISCOVERY_CTL_LAN_CLEAR_RESPONSES, NULL);
-      netplay_discovery_driver_ctl(
-            RARCH_NETPLAY_DISCOVERY_CTL_LAN_SEND_QUERY, NULL);
+      if (!netplay_discovery_driver_ctl(
+            RARCH_NETPLAY_DISCOVERY_CTL_LAN_SEND_QUERY, NULL))
+         goto finish;
    }
 
+   if (!netplay_discovery_driver_ctl(
+            RARCH_NETPLAY_DISCOVERY_CTL_LAN_WAIT_RESPONSES, &timeout))
+      goto finish;
+
+   elapsed = cpu_features_get_time_usec() - state->start;
+   if (elapsed < NETPLAY_DISCOVERY_WAIT && !task_get_cancelled(task))
+   {
+      task_set_progress(task, (int8_t)(elapsed * 100 / NETPLAY_DISCOVERY_WAIT));
+      return;
+   }
+
+finish:
    task_set_progress(task, 100);
    task_set_finished(task, true);
+}
 
-   return;
+static void task_netplay_lan_scan_cleanup(retro_task_t *task)
+{
+   if (task->state)
+      free(task->state);
+   task->state = NULL;
 }
 
-bool task_push_netplay_lan_scan(retro_task_callback_t cb)
+static bool task_netplay_lan_scan_push(retro_task_callback_t cb)
 {
    retro_task_t *task = task_init();
 
    if (!task)
       return false;
 
+   if (!(task->state = calloc(1, sizeof(netplay_lan_scan_state_t))))
+   {
+      free(task);
+      return false;
+   }
+
    task->type     = TASK_TYPE_BLOCKING;
    task->handler  = task_netplay_lan_scan_handler;
+   task->cleanup  = task_netplay_lan_scan_cleanup;
    task->callback = cb;
    task->title    = strdup(msg_hash_to_str(MSG_NETPLAY_LAN_SCANNING));
 
@@ -61,17 +135,231 @@ bool task_push_netplay_lan_scan(retro_task_callback_t cb)
    return true;
 }
 
+bool task_push_netplay_lan_scan(retro_task_callback_t cb)
+{
+   return task_netplay_lan_scan_push(cb);
+}
+
 bool task_push_netplay_lan_scan_rooms(retro_task_callback_t cb)
 {
-   retro_task_t *task = task_init();
+   return task_netplay_lan_scan_push(cb);
+}
 
-   if (!task)
+static void netplay_latency_probe_close(netplay_latency_probe_t *probe)
+{
+   if (probe->fd >= 0)
+      socket_close(probe->fd);
+   if (probe->addr)
+      freeaddrinfo_retro(probe->addr);
+   probe->fd   = -1;
+   probe->addr = NULL;
+}
+
+static void netplay_latency_probe_start(netplay_latency_probe_t *probe)
+{
+   char port_str[6];
+   struct addrinfo hints = {0};
+
+   hints.ai_socktype     = SOCK_STREAM;
+   snprintf(port_str, sizeof(port_str), "%hu", (unsigned short)probe->port);
+
+   if (getaddrinfo_retro(probe->address, port_str, &hints, &probe->addr) != 0
+         || !probe->addr)
+   {
+      probe->addr = NULL;
+      return;
+   }
+
+   probe->fd = socket(probe->addr->ai_family,
+         probe->addr->ai_socktype, probe->addr->ai_protocol);
+   if (probe->fd < 0)
+      return;
+
+   if (!socket_nonblock(probe->fd))
+   {
+      netplay_latency_probe_close(probe);
+      return;
+   }
+
+   /* Completes in the background, the handshake
+    * round trip is what we measure */
+   probe->start = cpu_features_get_time_usec();
+   socket_connect(probe->fd, (void*)probe->addr, false);
+}
+
+/* Times a TCP handshake with every room at once. The
+ * connection is closed again before any netplay data is
+ * exchanged, as if a client had given up. */
+static void task_netplay_latency_probe_handler(retro_task_t *task)
+{
+   size_t i;
+   fd_set fds;
+   int fds_max                           = -1;
+   struct timeval tv;
+   netplay_latency_probe_state_t *state  =
+      (netplay_latency_probe_state_t*)task->state;
+
+   if (!state->started)
+   {
+      state->started = true;
+      state->start   = cpu_features_get_time_usec();
+      for (i = 0; i < state->count; i++)
+         netplay_latency_probe_start(&state->probes[i]);
+   }
+
+   FD_ZERO(&fds);
+   for (i = 0; i < state->count; i++)
+   {
+      if (state->probes[i].fd < 0)
+         continue;
+      FD_SET(state->probes[i].fd, &fds);
+      if (state->probes[i].fd > fds_max)
+         fds_max = state->probes[i].fd;
+   }
+
+   if (fds_max >= 0 && !task_get_cancelled(task))
+   {
+      tv.tv_sec  = 0;
+      tv.tv_usec = NETPLAY_LAN_SCAN_POLL_USEC;
+
+      if (socket_select(fds_max + 1, NULL, &fds, NULL, &tv) > 0)
+      {
+         retro_time_t now = cpu_features_get_time_usec();
+
+         for (i = 0; i < state->count; i++)
+         {
+            int error                      = 0;
+            socklen_t error_len            = sizeof(error);
+            netplay_latency_probe_t *probe = &state->probes[i];
+
+            if (probe->fd < 0 || !FD_ISSET(probe->fd, &fds))
+               continue;
+
+            if (getsockopt(probe->fd, SOL_SOCKET, SO_ERROR,
+                     (char*)&error, &error_len) == 0 && !error)
+               probe->latency = (int)((now - probe->start) / 1000);
+
+            netplay_latency_probe_close(probe);
+         }
+      }
+
+      if (cpu_features_get_time_usec() - state->start
+            < NETPLAY_LATENCY_PROBE_TIMEOUT)
+         return;
+   }
+
+   for (i = 0; i < state->count; i++)
+      netplay_latency_probe_close(&state->probes[i]);
+
+   /* Handed over to the callback */
+   task_set_data(task, state);
+   task->state = NULL;
+   task_set_progress(task, 100);
+   task_set_finished(task, true);
+}
+
+static void task_netplay_latency_probe_free(
+      netplay_latency_probe_state_t *state)
+{
+   size_t i;
+
+   if (!state)
+      return;
+
+   for (i = 0; i < state->count; i++)
+      netplay_latency_probe_close(&state->probes[i]);
+
+   free(state->probes);
+   free(state);
+}
+
+static void task_netplay_latency_probe_cleanup(retro_task_t *task)
+{
+   task_netplay_latency_probe_free(
+         (netplay_latency_probe_state_t*)task->state);
+   task_netplay_latency_probe_free(
+         (netplay_latency_probe_state_t*)task->task_data);
+   task->state     = NULL;
+   task->task_data = NULL;
+}
+
+static void task_netplay_latency_probe_callback(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   size_t i;
+   netplay_latency_probe_state_t *state =
+      (netplay_latency_probe_state_t*)task_data;
+
+   if (!state)
+      return;
+
+   for (i = 0; i < state->count; i++)
+      netplay_room_list_set_latency(state->probes[i].address,
+            state->probes[i].port, state->probes[i].latency);
+
+   if (state->cb)
+      state->cb(task, NULL, user_data, error);
+}
+
+bool task_push_netplay_latency_probe(retro_task_callback_t cb)
+{
+   int i;
+   size_t count                         = 0;
+   retro_task_t *task                   = NULL;
+   netplay_latency_probe_state_t *state = NULL;
+
+   if (netplay_room_count <= 0)
       return false;
 
-   task->type     = TASK_TYPE_BLOCKING;
-   task->handler  = task_netplay_lan_scan_handler;
-   task->callback = cb;
-   task->title    = strdup(msg_hash_to_str(MSG_NETPLAY_LAN_SCANNING));
+   if (!(state = (netplay_latency_probe_state_t*)
+            calloc(1, sizeof(*state))))
+      return false;
+
+   if (!(state->probes = (netplay_latency_probe_t*)
+            calloc(netplay_room_count, sizeof(*state->probes))))
+   {
+      free(state);
+      return false;
+   }
+
+   /* Snapshot the addresses, the room list can
+    * change while the probes are in flight */
+   for (i = 0; i < netplay_room_count; i++)
+   {
+      const char *address            = NULL;
+      int port                       = 0;
+      netplay_latency_probe_t *probe = &state->probes[count];
+
+      if (netplay_room_list[i].lan)
+         continue;
+
+      netplay_room_get_connect_address(&netplay_room_list[i],
+            &address, &port);
+      if (string_is_empty(address) || port <= 0)
+         continue;
+
+      strlcpy(probe->address, address, sizeof(probe->address));
+      probe->port    = port;
+      probe->fd      = -1;
+      probe->latency = -1;
+      count++;
+   }
+
+   state->count = count;
+   state->cb    = cb;
+
+   if (!count || !(task = task_init()))
+   {
+      task_netplay_latency_probe_free(state);
+      return false;
+   }
+
+   task->type              = TASK_TYPE_NONE;
+   task->state             = state;
+   task->handler           = task_netplay_latency_probe_handler;
+   task->cleanup           = task_netplay_latency_probe_cleanup;
+   task->callback          = task_netplay_latency_probe_callback;
+   task->mute              = true;
 
    task_queue_push(task);
 
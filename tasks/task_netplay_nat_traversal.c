@@ -28,10 +28,16 @@
 #include "../network/netplay/netplay.h"
 
 #ifdef HAVE_NETWORKING
+#include <features/features_cpu.h>
+
+/* How often the task looks for router responses, in microseconds */
+#define NAT_TRAVERSAL_POLL 10000
+
 struct nat_traversal_state_data
 {
    struct natt_status *nat_traversal_state;
    uint16_t port;
+   bool started;
 };
 
 static void netplay_nat_traversal_callback(retro_task_t *task,
@@ -41,27 +47,48 @@ static void netplay_nat_traversal_callback(retro_task_t *task,
    struct nat_traversal_state_data *ntsd =
       (struct nat_traversal_state_data *) task_data;
 
-   free(ntsd);
+   /* Netplay takes over the mapping, unless it was
+    * deinitialized while we were waiting for the router */
+   if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_DATA_INITED, NULL) ||
+       !netplay_driver_ctl(RARCH_NETPLAY_CTL_FINISHED_NAT_TRAVERSAL,
+          ntsd->nat_traversal_state))
+      natt_free(ntsd->nat_traversal_state);
 
-   netplay_driver_ctl(RARCH_NETPLAY_CTL_FINISHED_NAT_TRAVERSAL, NULL);
+   free(ntsd->nat_traversal_state);
+   free(ntsd);
 }
 
 static void task_netplay_nat_traversal_handler(retro_task_t *task)
 {
    struct nat_traversal_state_data *ntsd =
       (struct nat_traversal_state_data *) task->task_data;
+   struct natt_status *status            = ntsd->nat_traversal_state;
 
-   natt_init();
+   if (!ntsd->started)
+   {
+      ntsd->started = true;
+
+      natt_init();
+
+      if (!natt_new(status) ||
+          !natt_open_port_any(status, ntsd->port, SOCKET_PROTOCOL_TCP))
+         status->request_outstanding = false;
+   }
+   else
+      natt_read(status);
 
-   if (natt_new(ntsd->nat_traversal_state))
-      natt_open_port_any(ntsd->nat_traversal_state,
-            ntsd->port, SOCKET_PROTOCOL_TCP);
+   /* Hosting is already up, only the announcement waits for this */
+   if (status->request_outstanding)
+   {
+      task->when = cpu_features_get_time_usec() + NAT_TRAVERSAL_POLL;
+      return;
+   }
 
    task_set_progress(task, 100);
    task_set_finished(task, true);
 }
 
-bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port)
+bool task_push_netplay_nat_traversal(uint16_t port)
 {
    struct nat_traversal_state_data *ntsd;
    retro_task_t *task        = task_init();
@@ -78,10 +105,19 @@ bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port)
       return false;
    }
 
-   ntsd->nat_traversal_state = (struct natt_status *)nat_traversal_state;
+   ntsd->nat_traversal_state = (struct natt_status *)
+      calloc(1, sizeof(*ntsd->nat_traversal_state));
+
+   if (!ntsd->nat_traversal_state)
+   {
+      free(ntsd);
+      free(task);
+      return false;
+   }
+
    ntsd->port                = port;
 
-   task->type                = TASK_TYPE_BLOCKING;
+   task->type                = TASK_TYPE_NONE;
    task->handler             = task_netplay_nat_traversal_handler;
    task->callback            = netplay_nat_traversal_callback;
    task->task_data           = ntsd;
@@ -91,5 +127,5 @@ bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port)
    return true;
 }
 #else
-bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port) { return false; }
+bool task_push_netplay_nat_traversal(uint16_t port) { return false; }
 #endif
@@ -14,6 +14,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <compat/strl.h>
 #include <compat/posix_string.h>
@@ -52,11 +53,159 @@ struct overlay_loader
    enum overlay_image_transfer_status loading_status;
 
    bool driver_rgba_support;
+   bool driver_atlas_support;
    bool overlay_enable;
    bool overlay_hide_in_menu;
    bool overlay_hide_when_gamepad_connected;
 };
 
+/* Largest atlas the loader will build, in pixels per side;
+ * the video driver may still reject smaller ones */
+#define OVERLAY_ATLAS_MAX_SIZE 4096
+/* Images are surrounded by a copy of their edge pixels,
+ * so that linear filtering doesn't bleed neighbours in */
+#define OVERLAY_ATLAS_PADDING  1
+
+/**
+ * task_overlay_build_atlas:
+ * @overlay : overlay whose images are all loaded
+ *
+ * Packs the images of @overlay into a single atlas
+ * texture. Images are placed tallest first, left to
+ * right in rows ('shelves') of an atlas about as wide
+ * as it is tall.
+ *
+ * Returns: true if an atlas was built.
+ **/
+static bool task_overlay_build_atlas(struct overlay *overlay)
+{
+   unsigned i, j, k;
+   unsigned atlas_width    = 0;
+   unsigned atlas_height   = 0;
+   unsigned shelf_x        = 0;
+   unsigned shelf_y        = 0;
+   unsigned shelf_height   = 0;
+   uint64_t area           = 0;
+   unsigned num_images     = overlay->load_images_size;
+   unsigned *order         = NULL;
+   unsigned *pos           = NULL;
+   uint32_t *pixels        = NULL;
+   float *rects            = NULL;
+
+   if (num_images < 2)
+      return false;
+
+   if (!(order = (unsigned*)malloc(num_images * sizeof(*order))))
+      return false;
+   if (!(pos = (unsigned*)malloc(2 * num_images * sizeof(*pos))))
+      goto error;
+
+   for (i = 0; i < num_images; i++)
+   {
+      const struct texture_image *img = &overlay->load_images[i];
+      unsigned w = img->width  + 2 * OVERLAY_ATLAS_PADDING;
+      unsigned h = img->height + 2 * OVERLAY_ATLAS_PADDING;
+
+      if (!img->pixels || !img->width || !img->height)
+         goto error;
+
+      area += (uint64_t)w * h;
+      if (w > atlas_width)
+         atlas_width = w;
+
+      /* Insertion sort by descending height */
+      for (j = i; j > 0 &&
+            overlay->load_images[order[j - 1]].height < img->height; j--)
+         order[j] = order[j - 1];
+      order[j] = i;
+   }
+
+   while ((uint64_t)atlas_width * atlas_width < area)
+      atlas_width += atlas_width / 8 + 1;
+
+   if (atlas_width > OVERLAY_ATLAS_MAX_SIZE)
+      goto error;
+
+   for (i = 0; i < num_images; i++)
+   {
+      const struct texture_image *img = &overlay->load_images[order[i]];
+      unsigned w = img->width  + 2 * OVERLAY_ATLAS_PADDING;
+      unsigned h = img->height + 2 * OVERLAY_ATLAS_PADDING;
+
+      if (shelf_x + w > atlas_width)
+      {
+         shelf_y     += shelf_height;
+         shelf_x      = 0;
+         shelf_height = 0;
+      }
+
+      pos[2 * order[i] + 0] = shelf_x;
+      pos[2 * order[i] + 1] = shelf_y;
+
+      shelf_x += w;
+      if (h > shelf_height)
+         shelf_height = h;
+   }
+
+   atlas_height = shelf_y + shelf_height;
+
+   if (atlas_height > OVERLAY_ATLAS_MAX_SIZE)
+      goto error;
+
+   if (!(pixels = (uint32_t*)calloc(
+         (size_t)atlas_width * atlas_height, sizeof(*pixels))))
+      goto error;
+   if (!(rects = (float*)malloc(4 * num_images * sizeof(*rects))))
+      goto error;
+
+   for (i = 0; i < num_images; i++)
+   {
+      const struct texture_image *img = &overlay->load_images[i];
+      unsigned x0 = pos[2 * i + 0];
+      unsigned y0 = pos[2 * i + 1];
+
+      for (j = 0; j < img->height + 2 * OVERLAY_ATLAS_PADDING; j++)
+      {
+         /* Rows and columns of the padding repeat the edge */
+         unsigned src_y      = (j < OVERLAY_ATLAS_PADDING) ? 0
+            : MIN(j - OVERLAY_ATLAS_PADDING, img->height - 1);
+         const uint32_t *src = img->pixels + (size_t)src_y * img->width;
+         uint32_t *dst       = pixels + (size_t)(y0 + j) * atlas_width + x0;
+
+         for (k = 0; k < OVERLAY_ATLAS_PADDING; k++)
+         {
+            dst[k] = src[0];
+            dst[OVERLAY_ATLAS_PADDING + img->width + k] = src[img->width - 1];
+         }
+
+         memcpy(dst + OVERLAY_ATLAS_PADDING, src,
+               img->width * sizeof(*src));
+      }
+
+      rects[4 * i + 0] = (float)(x0 + OVERLAY_ATLAS_PADDING) / atlas_width;
+      rects[4 * i + 1] = (float)(y0 + OVERLAY_ATLAS_PADDING) / atlas_height;
+      rects[4 * i + 2] = (float)img->width  / atlas_width;
+      rects[4 * i + 3] = (float)img->height / atlas_height;
+   }
+
+   overlay->atlas.pixels        = pixels;
+   overlay->atlas.width         = atlas_width;
+   overlay->atlas.height        = atlas_height;
+   overlay->atlas.supports_rgba = overlay->load_images[0].supports_rgba;
+   overlay->atlas_rects         = rects;
+
+   free(order);
+   free(pos);
+   return true;
+
+error:
+   free(order);
+   free(pos);
+   free(pixels);
+   free(rects);
+   return false;
+}
+
 static void task_overlay_image_done(struct overlay *overlay)
 {
    overlay->pos           = 0;
@@ -430,6 +579,9 @@ static void task_overlay_deferred_loading(retro_task_t *task)
             {
                overlay->pos       = 0;
                loader->loading_status = OVERLAY_IMAGE_TRANSFER_DESC_ITERATE;
+
+               if (loader->driver_atlas_support)
+                  task_overlay_build_atlas(overlay);
                break;
             }
 
@@ -743,6 +895,8 @@ static void task_overlay_handler(retro_task_t *task)
 
       data->overlays                    = loader->overlays;
       data->active                      = loader->active;
+      data->overlay_path                = loader->overlay_path;
+      loader->overlay_path              = NULL;
       data->size                        = loader->size;
       data->overlay_opacity             = loader->overlay_opacity;
       data->overlay_enable              = loader->overlay_enable;
@@ -836,6 +990,7 @@ bool task_push_overlay_load_default(
    loader->pos_increment                       = (loader->size / 4) ? (loader->size / 4) : 4;
 #ifdef RARCH_INTERNAL
    loader->driver_rgba_support                 = video_driver_supports_rgba();
+   loader->driver_atlas_support                = video_driver_supports_overlay_atlas();
 #endif
 
    memcpy(&loader->layout_desc, layout_desc,
@@ -20,10 +20,14 @@
 #include <stdio.h>
 #include <ctype.h>
 
+#include <array/rhmap.h>
 #include <string/stdstring.h>
 #include <file/file_path.h>
 #include <net/net_http.h>
 #include <streams/file_stream.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "tasks_internal.h"
 #include "task_file_transfer.h"
@@ -41,6 +45,9 @@
 #endif
 #endif
 
+/* Upper limit of the 'network_thumbnail_downloads' setting */
+#define PL_THUMB_MAX_TRANSFERS 16
+
 enum pl_thumb_status
 {
    PL_THUMB_BEGIN = 0,
@@ -49,6 +56,17 @@ enum pl_thumb_status
    PL_THUMB_END
 };
 
+/* One in-flight thumbnail download */
+typedef struct pl_thumb_transfer
+{
+   retro_task_t *http_task;
+   int32_t local_size; /* Size of the existing file, for HEAD checks */
+   char url[2048];
+   char path[PATH_MAX_LENGTH];
+   bool http_task_complete;
+   bool modified;      /* HEAD check found a different file */
+} pl_thumb_transfer_t;
+
 typedef struct pl_thumb_handle
 {
    char *system;
@@ -56,20 +74,20 @@ typedef struct pl_thumb_handle
    char *dir_thumbnails;
    playlist_t *playlist;
    gfx_thumbnail_path_data_t *thumbnail_path_data;
-   retro_task_t *http_task;
+   pl_thumb_transfer_t *transfers;
 
    playlist_config_t playlist_config; /* size_t alignment */
 
    size_t list_size;
    size_t list_index;
    unsigned type_idx;
+   unsigned num_transfers;
 
    enum pl_thumb_status status;
 
    bool overwrite;
    bool right_thumbnail_exists;
    bool left_thumbnail_exists;
-   bool http_task_complete;
 } pl_thumb_handle_t;
 
 typedef struct pl_entry_id
@@ -78,10 +96,64 @@ typedef struct pl_entry_id
    size_t idx;
 } pl_entry_id_t;
 
+/* URLs the server had no thumbnail for during this session.
+ * Shared by all thumbnail tasks, so that the same missing
+ * image is not requested again for every playlist that
+ * contains the game. Written by http callbacks on the main
+ * thread, read by the task handlers. */
+static uint8_t *pl_thumb_missing_urls = NULL;
+#ifdef HAVE_THREADS
+static slock_t *pl_thumb_missing_lock = NULL;
+#endif
+
 /*********************/
 /* Utility Functions */
 /*********************/
 
+static bool pl_thumb_url_is_missing(const char *url)
+{
+   bool missing;
+#ifdef HAVE_THREADS
+   slock_lock(pl_thumb_missing_lock);
+#endif
+   missing = RHMAP_HAS_STR(pl_thumb_missing_urls, url);
+#ifdef HAVE_THREADS
+   slock_unlock(pl_thumb_missing_lock);
+#endif
+   return missing;
+}
+
+static void pl_thumb_url_set_missing(const char *url)
+{
+#ifdef HAVE_THREADS
+   slock_lock(pl_thumb_missing_lock);
+#endif
+   RHMAP_SET_STR(pl_thumb_missing_urls, url, 1);
+#ifdef HAVE_THREADS
+   slock_unlock(pl_thumb_missing_lock);
+#endif
+}
+
+/* Allocates the transfer slots of a new handle
+ * > Must be called on the main thread */
+static bool pl_thumb_init_transfers(pl_thumb_handle_t *pl_thumb,
+      unsigned num_transfers)
+{
+#ifdef HAVE_THREADS
+   if (!pl_thumb_missing_lock)
+      if (!(pl_thumb_missing_lock = slock_new()))
+         return false;
+#endif
+
+   num_transfers            = MAX(num_transfers, 1);
+   num_transfers            = MIN(num_transfers, PL_THUMB_MAX_TRANSFERS);
+   pl_thumb->transfers      = (pl_thumb_transfer_t*)calloc(
+         num_transfers, sizeof(pl_thumb_transfer_t));
+   pl_thumb->num_transfers  = num_transfers;
+
+   return pl_thumb->transfers != NULL;
+}
+
 /* Fetches local and remote paths for current thumbnail
  * of current type */
 static bool get_thumbnail_paths(
@@ -183,10 +255,10 @@ void cb_http_task_download_pl_thumbnail(
       void *user_data, const char *err)
 {
    char output_dir[PATH_MAX_LENGTH];
-   http_transfer_data_t *data  = (http_transfer_data_t*)task_data;
-   file_transfer_t *transf     = (file_transfer_t*)user_data;
-   pl_thumb_handle_t *pl_thumb = NULL;
-   output_dir[0]               = '\0';
+   http_transfer_data_t *data    = (http_transfer_data_t*)task_data;
+   file_transfer_t *transf       = (file_transfer_t*)user_data;
+   pl_thumb_transfer_t *transfer = NULL;
+   output_dir[0]                 = '\0';
 
    /* Update pl_thumb task status
     * > Do this first, to minimise the risk of hanging
@@ -194,12 +266,18 @@ void cb_http_task_download_pl_thumbnail(
    if (!transf)
       goto finish;
 
-   pl_thumb = (pl_thumb_handle_t*)transf->user_data;
+   transfer = (pl_thumb_transfer_t*)transf->user_data;
 
-   if (!pl_thumb)
+   if (!transfer)
       goto finish;
 
-   pl_thumb->http_task_complete = true;
+   /* Remember that the server has nothing here
+    * > Must happen before the transfer slot is
+    *   released and reused */
+   if (data && data->status == 404)
+      pl_thumb_url_set_missing(transfer->url);
+
+   transfer->http_task_complete = true;
 
    /* Remaining sanity checks... */
    if (!data)
@@ -238,51 +316,151 @@ finish:
       free(transf);
 }
 
-/* Download thumbnail of the current type for the current
- * playlist entry */
-static void download_pl_thumbnail(pl_thumb_handle_t *pl_thumb)
+/* Thumbnail HEAD request http task callback function
+ * > Flags the transfer for download if the server
+ *   has a file that differs from the existing one */
+static void cb_http_task_check_pl_thumbnail(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *err)
 {
-   char path[PATH_MAX_LENGTH];
-   char url[2048];
+   http_transfer_data_t *data    = (http_transfer_data_t*)task_data;
+   pl_thumb_transfer_t *transfer = (pl_thumb_transfer_t*)user_data;
 
-   path[0] = '\0';
-   url[0]  = '\0';
+   if (!transfer)
+      return;
 
+   /* Without a usable answer, fall back to
+    * downloading the file */
+   if (data && data->status == 404)
+   {
+      pl_thumb_url_set_missing(transfer->url);
+      transfer->modified = false;
+   }
+   else
+      transfer->modified = !data
+            || data->status != 200
+            || data->content_length != (size_t)transfer->local_size;
+
+   transfer->http_task_complete = true;
+}
+
+/* Starts downloading the thumbnail set up in the
+ * specified transfer slot */
+static void start_pl_thumbnail_transfer(pl_thumb_transfer_t *transfer)
+{
+   file_transfer_t *transf = (file_transfer_t*)malloc(sizeof(file_transfer_t));
+   if (!transf)
+      return; /* If this happens then everything is broken anyway... */
+
+   /* Initialise http task status */
+   transfer->http_task_complete = false;
+   transfer->modified           = false;
+
+   transf->enum_idx             = MSG_UNKNOWN;
+   transf->path[0]              = '\0';
+   /* Initialise file transfer */
+   transf->user_data            = (void*)transfer;
+   strlcpy(transf->path, transfer->path, sizeof(transf->path));
+
+   /* Note: We don't actually care if this fails since that
+    * just means the file is missing from the server, so it's
+    * not something we can handle here... */
+   transfer->http_task = (retro_task_t*)task_push_http_transfer_file(
+         transfer->url, true, NULL, cb_http_task_download_pl_thumbnail, transf);
+
+   /* ...if it does fail, however, the transfer slot
+    * is immediately free again (this also happens if
+    * another task is already fetching the same URL) */
+   if (!transfer->http_task)
+      free(transf);
+}
+
+/* Download thumbnail of the current type for the current
+ * playlist entry, using the specified (free) transfer slot */
+static void download_pl_thumbnail(pl_thumb_handle_t *pl_thumb,
+      pl_thumb_transfer_t *transfer)
+{
    /* Sanity check */
-   if (!pl_thumb)
+   if (!pl_thumb || !transfer)
       return;
 
    /* Check if paths are valid */
-   if (get_thumbnail_paths(pl_thumb, path, sizeof(path), url, sizeof(url)))
+   if (!get_thumbnail_paths(pl_thumb,
+            transfer->path, sizeof(transfer->path),
+            transfer->url, sizeof(transfer->url)))
+      return;
+
+   if (pl_thumb_url_is_missing(transfer->url))
+      return;
+
+   /* Only download missing thumbnails... */
+   if (!path_is_valid(transfer->path))
+   {
+      start_pl_thumbnail_transfer(transfer);
+      return;
+   }
+
+   if (!pl_thumb->overwrite)
+      return;
+
+   /* ...or, when overwriting, those that differ in size
+    * from the server copy (checked with a HEAD request,
+    * which saves fetching unchanged images in full) */
+   transfer->local_size         = path_get_size(transfer->path);
+   transfer->http_task_complete = false;
+   transfer->modified           = false;
+   transfer->http_task          = (retro_task_t*)task_push_http_head_transfer(
+         transfer->url, true, NULL, cb_http_task_check_pl_thumbnail, transfer);
+}
+
+/* Releases the slots of finished transfers, starting the
+ * download of any file a HEAD check found to be modified.
+ * Returns the number of transfers still in flight. */
+static unsigned update_pl_thumbnail_transfers(pl_thumb_handle_t *pl_thumb)
+{
+   unsigned i;
+   unsigned active = 0;
+
+   for (i = 0; i < pl_thumb->num_transfers; i++)
    {
-      /* Only download missing thumbnails */
-      if (!path_is_valid(path) || pl_thumb->overwrite)
+      pl_thumb_transfer_t *transfer = &pl_thumb->transfers[i];
+
+      /* > If HTTP task is NULL, then it either finished
+       *   or an error occurred - in either case, the
+       *   slot is free */
+      if (!transfer->http_task)
+         continue;
+
+      /* > Wait for the http task callback to trigger */
+      if (!transfer->http_task_complete)
       {
-         file_transfer_t *transf = (file_transfer_t*)malloc(sizeof(file_transfer_t));
-         if (!transf)
-            return; /* If this happens then everything is broken anyway... */
-
-         /* Initialise http task status */
-         pl_thumb->http_task_complete = false;
-
-         transf->enum_idx             = MSG_UNKNOWN;
-         transf->path[0]              = '\0';
-         /* Initialise file transfer */
-         transf->user_data            = (void*)pl_thumb;
-         strlcpy(transf->path, path, sizeof(transf->path));
-
-         /* Note: We don't actually care if this fails since that
-          * just means the file is missing from the server, so it's
-          * not something we can handle here... */
-         pl_thumb->http_task = (retro_task_t*)task_push_http_transfer_file(
-               url, true, NULL, cb_http_task_download_pl_thumbnail, transf);
-
-         /* ...if it does fail, however, we can immediately
-          * signal that the task is 'complete' */
-         if (!pl_thumb->http_task)
-            pl_thumb->http_task_complete = true;
+         active++;
+         continue;
+      }
+
+      transfer->http_task = NULL;
+
+      if (transfer->modified)
+      {
+         start_pl_thumbnail_transfer(transfer);
+         if (transfer->http_task)
+            active++;
       }
    }
+
+   return active;
+}
+
+static pl_thumb_transfer_t *get_free_pl_thumbnail_transfer(
+      pl_thumb_handle_t *pl_thumb)
+{
+   unsigned i;
+
+   for (i = 0; i < pl_thumb->num_transfers; i++)
+      if (!pl_thumb->transfers[i].http_task)
+         return &pl_thumb->transfers[i];
+
+   return NULL;
 }
 
 static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
@@ -320,6 +498,12 @@ static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
       pl_thumb->thumbnail_path_data = NULL;
    }
 
+   if (pl_thumb->transfers)
+   {
+      free(pl_thumb->transfers);
+      pl_thumb->transfers = NULL;
+   }
+
    free(pl_thumb);
    pl_thumb = NULL;
 }
@@ -340,8 +524,10 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
    if (!pl_thumb)
       goto task_finished;
    
+   /* Transfers in flight reference the handle,
+    * it can only go once they are done */
    if (task_get_cancelled(task))
-      goto task_finished;
+      pl_thumb->status = PL_THUMB_END;
    
    switch (pl_thumb->status)
    {
@@ -403,21 +589,25 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
          }
          break;
       case PL_THUMB_ITERATE_TYPE:
-         /* Ensure that we only enqueue one transfer
-          * at a time... */
-
-         /* > If HTTP task is NULL, then it either finished
-          *   or an error occurred - in either case,
-          *   current task is 'complete' */
-         if (!pl_thumb->http_task)
-            pl_thumb->http_task_complete = true;
-
-         /* > Wait for task_push_http_transfer_file()
-          *   callback to trigger */
-         if (!pl_thumb->http_task_complete)
-            break;
+         /* Keep up to 'num_transfers' downloads in flight,
+          * moving on as soon as a transfer slot is free
+          * (entries are not waited for one at a time) */
+         update_pl_thumbnail_transfers(pl_thumb);
+
+         while (pl_thumb->type_idx <= 3)
+         {
+            pl_thumb_transfer_t *transfer =
+               get_free_pl_thumbnail_transfer(pl_thumb);
 
-         pl_thumb->http_task = NULL;
+            if (!transfer)
+               break;
+
+            /* Download current thumbnail */
+            download_pl_thumbnail(pl_thumb, transfer);
+
+            /* Increment thumbnail type */
+            pl_thumb->type_idx++;
+         }
 
          /* Check whether all thumbnail types have been processed */
          if (pl_thumb->type_idx > 3)
@@ -428,17 +618,13 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
                pl_thumb->status = PL_THUMB_ITERATE_ENTRY;
             else
                pl_thumb->status = PL_THUMB_END;
-            break;
          }
-
-         /* Download current thumbnail */
-         download_pl_thumbnail(pl_thumb);
-
-         /* Increment thumbnail type */
-         pl_thumb->type_idx++;
          break;
       case PL_THUMB_END:
       default:
+         /* Wait for the remaining transfers */
+         if (update_pl_thumbnail_transfers(pl_thumb) > 0)
+            break;
          task_set_progress(task, 100);
          goto task_finished;
    }
@@ -518,14 +704,16 @@ bool task_push_pl_thumbnail_download(
    /* Configure handle */
    if (!playlist_config_copy(playlist_config, &pl_thumb->playlist_config))
       goto error;
+
+   if (!pl_thumb_init_transfers(pl_thumb,
+            config_get_ptr()->uints.network_thumbnail_downloads))
+      goto error;
    
    pl_thumb->system              = strdup(system);
    pl_thumb->playlist_path       = NULL;
    pl_thumb->dir_thumbnails      = strdup(dir_thumbnails);
    pl_thumb->playlist            = NULL;
    pl_thumb->thumbnail_path_data = NULL;
-   pl_thumb->http_task           = NULL;
-   pl_thumb->http_task_complete  = false;
    pl_thumb->list_size           = 0;
    pl_thumb->list_index          = 0;
    pl_thumb->type_idx            = 1;
@@ -534,6 +722,7 @@ bool task_push_pl_thumbnail_download(
    
    /* Configure task */
    task->handler                 = task_pl_thumbnail_download_handler;
+   task->priority                = TASK_PRIORITY_BULK;
    task->state                   = pl_thumb;
    task->title                   = strdup(system);
    task->alternative_look        = true;
@@ -553,6 +742,8 @@ error:
    
    if (pl_thumb)
    {
+      if (pl_thumb->transfers)
+         free(pl_thumb->transfers);
       free(pl_thumb);
       pl_thumb = NULL;
    }
@@ -668,8 +859,10 @@ static void task_pl_entry_thumbnail_download_handler(retro_task_t *task)
    if (!pl_thumb)
       goto task_finished;
    
+   /* Transfers in flight reference the handle,
+    * it can only go once they are done */
    if (task_get_cancelled(task))
-      goto task_finished;
+      pl_thumb->status = PL_THUMB_END;
    
    switch (pl_thumb->status)
    {
@@ -705,21 +898,9 @@ static void task_pl_entry_thumbnail_download_handler(retro_task_t *task)
          break;
       case PL_THUMB_ITERATE_TYPE:
          {
-            /* Ensure that we only enqueue one transfer
-             * at a time... */
+            pl_thumb_transfer_t *transfer = NULL;
             
-            /* > If HTTP task is NULL, then it either finished
-             *   or an error occurred - in either case,
-             *   current task is 'complete' */
-            if (!pl_thumb->http_task)
-               pl_thumb->http_task_complete = true;
-            
-            /* > Wait for task_push_http_transfer_file()
-             *   callback to trigger */
-            if (pl_thumb->http_task_complete)
-               pl_thumb->http_task = NULL;
-            else
-               break;
+            update_pl_thumbnail_transfers(pl_thumb);
             
             /* Check whether all thumbnail types have been processed */
             if (pl_thumb->type_idx > 3)
@@ -728,11 +909,14 @@ static void task_pl_entry_thumbnail_download_handler(retro_task_t *task)
                break;
             }
             
+            if (!(transfer = get_free_pl_thumbnail_transfer(pl_thumb)))
+               break;
+            
             /* Update progress */
             task_set_progress(task, ((pl_thumb->type_idx - 1) * 100) / 3);
             
             /* Download current thumbnail */
-            download_pl_thumbnail(pl_thumb);
+            download_pl_thumbnail(pl_thumb, transfer);
             
             /* Increment thumbnail type */
             pl_thumb->type_idx++;
@@ -740,6 +924,9 @@ static void task_pl_entry_thumbnail_download_handler(retro_task_t *task)
          break;
       case PL_THUMB_END:
       default:
+         /* Wait for the remaining transfers */
+         if (update_pl_thumbnail_transfers(pl_thumb) > 0)
+            break;
          task_set_progress(task, 100);
          goto task_finished;
    }
@@ -847,6 +1034,10 @@ bool task_push_pl_entry_thumbnail_download(
          thumbnail_path_data, playlist, idx))
       goto error;
    
+   if (!pl_thumb_init_transfers(pl_thumb,
+            settings->uints.network_thumbnail_downloads))
+      goto error;
+   
    /* Configure handle
     * > Note: playlist_config is unused by this task */
    pl_thumb->system              = NULL;
@@ -854,8 +1045,6 @@ bool task_push_pl_entry_thumbnail_download(
    pl_thumb->dir_thumbnails      = strdup(dir_thumbnails);
    pl_thumb->playlist            = NULL;
    pl_thumb->thumbnail_path_data = thumbnail_path_data;
-   pl_thumb->http_task           = NULL;
-   pl_thumb->http_task_complete  = false;
    pl_thumb->list_size           = playlist_size(playlist);
    pl_thumb->list_index          = idx;
    pl_thumb->type_idx            = 1;
@@ -886,6 +1075,8 @@ error:
    
    if (pl_thumb)
    {
+      if (pl_thumb->transfers)
+         free(pl_thumb->transfers);
       free(pl_thumb);
       pl_thumb = NULL;
    }
@@ -14,6 +14,7 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
 #include <string.h>
@@ -29,12 +30,14 @@
 #include <compat/strl.h>
 #include <retro_assert.h>
 #include <lists/string_list.h>
+#include <lists/dir_list.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
 #include <streams/rzip_stream.h>
 #include <rthreads/rthreads.h>
 #include <file/file_path.h>
 #include <retro_miscellaneous.h>
+#include <retro_endianness.h>
 #include <string/stdstring.h>
 #include <time/rtime.h>
 
@@ -98,6 +101,13 @@ typedef struct
    intfstream_t *file;
    void *data;
    void *undo_data;
+   /* Copy of the core's frame the savestate
+    * thumbnail is made from, top-down */
+   void *thumbnail;
+   size_t thumbnail_pitch;
+   unsigned thumbnail_width;
+   unsigned thumbnail_height;
+   unsigned thumbnail_format;
    ssize_t size;
    ssize_t undo_size;
    ssize_t written;
@@ -112,8 +122,12 @@ typedef struct
    bool thumbnail_enable;
    bool has_valid_framebuffer;
    bool compress_files;
+   bool thumbnail_captured;
 } save_task_state_t;
 
+/* Savestate thumbnails wider than this are scaled down */
+#define SAVESTATE_THUMBNAIL_MAX_WIDTH 640
+
 #ifdef HAVE_THREADS
 typedef struct autosave autosave_t;
 
@@ -124,19 +138,30 @@ struct autosave_st
    unsigned num;
 };
 
+/* Save memory is compared, copied and written back in
+ * blocks of this size, so a change only costs the blocks
+ * it touches */
+#define AUTOSAVE_BLOCK_SIZE 4096
+
 struct autosave
 {
    void *buffer;
    const void *retro_buffer;
    const char *path;
+   /* Blocks of 'buffer' that differ from the file */
+   uint8_t *dirty;
    slock_t *lock;
    slock_t *cond_lock;
    scond_t *cond;
    sthread_t *thread;
    size_t bufsize;
+   size_t num_blocks;
    unsigned interval;
    volatile bool quit;
    bool compress_files;
+   /* Set once the file is known to hold 'buffer'
+    * apart from the dirty blocks */
+   bool file_valid;
 };
 #endif
 
@@ -156,6 +181,56 @@ static struct save_state_buf undo_load_buf;
 static struct autosave_st autosave_state;
 #endif
 
+/* Savestate buffers handed to the save task are recycled
+ * instead of allocated for every save, so saving doesn't
+ * have to fault in (and zero) fresh pages each time.
+ * Two slots let a new save be serialized while the previous
+ * one is still being written out. */
+#define SAVE_STATE_POOL_SLOTS 2
+
+struct save_state_pool_slot
+{
+   void *data;
+   size_t size;
+   bool in_use;
+};
+
+/* TODO/FIXME - global state - perhaps move outside this file */
+static struct save_state_pool_slot save_state_pool[SAVE_STATE_POOL_SLOTS];
+#ifdef HAVE_THREADS
+static slock_t *save_state_pool_lock       = NULL;
+#endif
+
+/* The slot index records which savestate slots of the
+ * current content hold a state, so that menus can show
+ * them without probing the filesystem for every slot.
+ * It is kept next to the states as '<content>.state.idx':
+ *
+ *   header: magic, version, entry count (uint32 each),
+ *           savestate directory mtime (int64)
+ *   entry:  slot (int32), flags (uint32), size (uint64),
+ *           timestamp (int64)
+ *
+ * all little endian. The index is rebuilt from a single
+ * directory listing whenever it is missing or the
+ * directory was modified behind its back. */
+#define SAVESTATE_INDEX_MAGIC          0x49534152 /* 'RASI' */
+#define SAVESTATE_INDEX_VERSION        1
+#define SAVESTATE_INDEX_HEADER_SIZE    20
+#define SAVESTATE_INDEX_ENTRY_SIZE     24
+#define SAVESTATE_INDEX_FLAG_THUMBNAIL (1 << 0)
+
+struct savestate_index
+{
+   content_state_slot_info_t *slots;
+   size_t count;
+   size_t capacity;
+   char base[PATH_MAX_LENGTH];
+};
+
+/* TODO/FIXME - global state - perhaps move outside this file */
+static struct savestate_index savestate_index;
+
 /* TODO/FIXME - global state - perhaps move outside this file */
 static bool save_state_in_background       = false;
 static struct string_list *task_save_files = NULL;
@@ -170,6 +245,161 @@ typedef struct rastate_size_info
 } rastate_size_info_t;
 
 #ifdef HAVE_THREADS
+/* Copies the blocks of save memory that changed since the
+ * last pass into the autosave buffer and marks them dirty.
+ * Returns the number of blocks that changed. */
+static size_t autosave_update_blocks(autosave_t *save)
+{
+   size_t i;
+   size_t changed      = 0;
+   uint8_t *buf        = (uint8_t*)save->buffer;
+   const uint8_t *src  = (const uint8_t*)save->retro_buffer;
+
+   for (i = 0; i < save->num_blocks; i++)
+   {
+      size_t offset = i * AUTOSAVE_BLOCK_SIZE;
+      size_t len    = MIN(AUTOSAVE_BLOCK_SIZE, save->bufsize - offset);
+
+      if (!memcmp(buf + offset, src + offset, len))
+         continue;
+
+      memcpy(buf + offset, src + offset, len);
+      save->dirty[i] = 1;
+      changed++;
+   }
+
+   return changed;
+}
+
+/* Forces written data to the storage device, so the
+ * file doesn't lose it (or get renamed over an older copy
+ * before its data is on disk) in a crash. One sync covers
+ * every block written during a pass. */
+static void autosave_sync(RFILE *file)
+{
+#if defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) \
+   || defined(__NetBSD__) || defined(__OpenBSD__)
+   libretro_vfs_implementation_file *handle =
+      filestream_get_vfs_handle(file);
+
+   if (!handle)
+      return;
+   if (handle->fp)
+      fsync(fileno(handle->fp));
+   else if (handle->fd >= 0)
+      fsync(handle->fd);
+#endif
+}
+
+/* Rewrites the dirty blocks of an uncompressed save file
+ * in place, coalescing adjacent blocks into one write */
+static bool autosave_write_blocks(autosave_t *save)
+{
+   size_t i            = 0;
+   const uint8_t *buf  = (const uint8_t*)save->buffer;
+   RFILE *file         = filestream_open(save->path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (filestream_get_size(file) != (int64_t)save->bufsize)
+      goto error;
+
+   while (i < save->num_blocks)
+   {
+      size_t j, offset, len;
+
+      if (!save->dirty[i])
+      {
+         i++;
+         continue;
+      }
+
+      for (j = i + 1; j < save->num_blocks && save->dirty[j]; j++);
+
+      offset = i * AUTOSAVE_BLOCK_SIZE;
+      len    = MIN(j * AUTOSAVE_BLOCK_SIZE, save->bufsize) - offset;
+
+      if (     filestream_seek(file, (int64_t)offset,
+                  RETRO_VFS_SEEK_POSITION_START) < 0
+            || filestream_write(file, buf + offset, (int64_t)len)
+                  != (int64_t)len)
+         goto error;
+
+      i = j;
+   }
+
+   if (filestream_flush(file) != 0)
+      goto error;
+
+   autosave_sync(file);
+   filestream_close(file);
+   return true;
+
+error:
+   filestream_close(file);
+   return false;
+}
+
+/* Writes the whole save file next to its destination and
+ * renames it into place, so an interrupted save never
+ * leaves a truncated file behind */
+static bool autosave_write_file(autosave_t *save)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   intfstream_t *file = NULL;
+   bool ret           = false;
+
+   strlcpy(tmp_path, save->path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (save->compress_files)
+      file = intfstream_open_rzip_file(tmp_path,
+            RETRO_VFS_FILE_ACCESS_WRITE);
+   else
+      file = intfstream_open_file(tmp_path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   ret = intfstream_write(file, save->buffer, save->bufsize)
+      == (int64_t)save->bufsize;
+   /* Closing flushes the last rzip chunk and its index */
+   if (intfstream_close(file) != 0)
+      ret = false;
+   free(file);
+
+   if (ret)
+   {
+      RFILE *tmp = filestream_open(tmp_path,
+            RETRO_VFS_FILE_ACCESS_READ_WRITE
+            | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+      if (tmp)
+      {
+         autosave_sync(tmp);
+         filestream_close(tmp);
+      }
+
+      /* rename() replaces the file atomically where
+       * it can, otherwise the old copy goes first */
+      if (filestream_rename(tmp_path, save->path) != 0)
+      {
+         filestream_delete(save->path);
+         ret = filestream_rename(tmp_path, save->path) == 0;
+      }
+   }
+
+   if (!ret)
+      filestream_delete(tmp_path);
+
+   return ret;
+}
+
 /**
  * autosave_thread:
  * @data            : pointer to autosave object
@@ -179,36 +409,32 @@ typedef struct rastate_size_info
 static void autosave_thread(void *data)
 {
    autosave_t *save = (autosave_t*)data;
+   size_t pending   = 0;
 
    while (!save->quit)
    {
-      bool differ;
-
       slock_lock(save->lock);
-      differ = string_is_not_equal_fast(save->buffer, save->retro_buffer,
-            save->bufsize);
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
+      pending += autosave_update_blocks(save);
       slock_unlock(save->lock);
 
-      if (differ)
+      if (pending)
       {
-         intfstream_t *file = NULL;
+         bool written = false;
 
-         /* Should probably deal with this more elegantly. */
-         if (save->compress_files)
-            file = intfstream_open_rzip_file(save->path,
-                  RETRO_VFS_FILE_ACCESS_WRITE);
-         else
-            file = intfstream_open_file(save->path,
-                  RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         /* Compressed files, and files that don't hold the
+          * previous autosave, are rewritten as a whole */
+         if (save->file_valid && !save->compress_files)
+            written = autosave_write_blocks(save);
+         if (!written)
+            written = autosave_write_file(save);
+
+         save->file_valid = written;
 
-         if (file)
+         /* Failed blocks are retried on the next pass */
+         if (written)
          {
-            intfstream_write(file, save->buffer, save->bufsize);
-            intfstream_flush(file);
-            intfstream_close(file);
-            free(file);
+            memset(save->dirty, 0, save->num_blocks);
+            pending = 0;
          }
       }
 
@@ -257,10 +483,19 @@ static autosave_t *autosave_new(const char *path,
    handle->retro_buffer          = data;
    handle->path                  = path;
 
+   handle->num_blocks            = (size + AUTOSAVE_BLOCK_SIZE - 1)
+      / AUTOSAVE_BLOCK_SIZE;
+   handle->dirty                 = (uint8_t*)calloc(handle->num_blocks, 1);
+   /* The file is only patched in place once it was
+    * written by us at least once */
+   handle->file_valid            = false;
+
    buf                           = malloc(size);
 
-   if (!buf)
+   if (!buf || !handle->dirty)
    {
+      free(buf);
+      free(handle->dirty);
       free(handle);
       return NULL;
    }
@@ -298,6 +533,8 @@ static void autosave_free(autosave_t *handle)
    if (handle->buffer)
       free(handle->buffer);
    handle->buffer = NULL;
+   free(handle->dirty);
+   handle->dirty  = NULL;
 }
 
 bool autosave_init(void)
@@ -488,10 +725,13 @@ bool content_undo_load_state(void)
       }
    }
 
-   /* We need to make a temporary copy of the buffer, to allow the swap below */
-   temp_data              = malloc(undo_load_buf.size);
+   /* Take ownership of the backup buffer to allow the swap below;
+    * content_save_state() then serializes into a new one instead
+    * of us having to copy the whole state aside first */
+   temp_data              = undo_load_buf.data;
    temp_data_size         = undo_load_buf.size;
-   memcpy(temp_data, undo_load_buf.data, undo_load_buf.size);
+   undo_load_buf.data     = NULL;
+   undo_load_buf.size     = 0;
 
    /* Swap the current state with the backup state. This way, we can undo
    what we're undoing */
@@ -499,7 +739,7 @@ bool content_undo_load_state(void)
 
    ret                    = content_deserialize_state(temp_data, temp_data_size);
 
-   /* Clean up the temporary copy */
+   /* Clean up the old backup */
    free(temp_data);
    temp_data              = NULL;
 
@@ -535,12 +775,402 @@ bool content_undo_load_state(void)
    return ret;
 }
 
+/**
+ * savestate_index_parse_slot:
+ * @base : savestate base path of the content
+ * @path : path of a savestate file
+ * @slot : slot the state belongs to
+ *
+ * Returns true if @path is the state of a slot of @base,
+ * i.e. '<base>', '<base>.auto' or '<base><number>'.
+ **/
+static bool savestate_index_parse_slot(const char *base,
+      const char *path, int *slot)
+{
+   size_t base_len = strlen(base);
+   const char *end = path + base_len;
+
+   if (!string_starts_with_size(path, base, base_len))
+      return false;
+
+   if (!*end)
+      *slot = 0;
+   else if (string_is_equal(end, ".auto"))
+      *slot = -1;
+   else
+   {
+      const char *c = end;
+
+      for (; *c; c++)
+         if (!ISDIGIT((int)*c))
+            return false;
+
+      *slot = (int)strtoul(end, NULL, 10);
+   }
+
+   return true;
+}
+
+static content_state_slot_info_t *savestate_index_find(int slot)
+{
+   size_t lo = 0;
+   size_t hi = savestate_index.count;
+
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (savestate_index.slots[mid].slot == slot)
+         return &savestate_index.slots[mid];
+      if (savestate_index.slots[mid].slot < slot)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return NULL;
+}
+
+/* Returns the entry of @slot, inserting an empty
+ * one in slot order if there is none */
+static content_state_slot_info_t *savestate_index_add(int slot)
+{
+   size_t i;
+   content_state_slot_info_t *info = savestate_index_find(slot);
+
+   if (info)
+      return info;
+
+   if (savestate_index.count >= savestate_index.capacity)
+   {
+      size_t new_capacity = savestate_index.capacity
+         ? savestate_index.capacity * 2 : 16;
+      content_state_slot_info_t *slots = (content_state_slot_info_t*)
+         realloc(savestate_index.slots, new_capacity * sizeof(*slots));
+
+      if (!slots)
+         return NULL;
+
+      savestate_index.slots    = slots;
+      savestate_index.capacity = new_capacity;
+   }
+
+   for (i = savestate_index.count; i > 0; i--)
+   {
+      if (savestate_index.slots[i - 1].slot < slot)
+         break;
+      savestate_index.slots[i] = savestate_index.slots[i - 1];
+   }
+
+   savestate_index.count++;
+
+   info       = &savestate_index.slots[i];
+   memset(info, 0, sizeof(*info));
+   info->slot = slot;
+
+   return info;
+}
+
+static void savestate_index_remove(int slot)
+{
+   content_state_slot_info_t *info = savestate_index_find(slot);
+   size_t i;
+
+   if (!info)
+      return;
+
+   i = info - savestate_index.slots;
+   memmove(info, info + 1,
+         (savestate_index.count - i - 1) * sizeof(*info));
+   savestate_index.count--;
+}
+
+static int64_t savestate_index_dir_mtime(const char *base)
+{
+   char dir[PATH_MAX_LENGTH];
+
+   dir[0] = '\0';
+   fill_pathname_basedir(dir, base, sizeof(dir));
+
+   return path_get_mtime(dir);
+}
+
+static void savestate_index_write(void)
+{
+   size_t i;
+   char path[PATH_MAX_LENGTH];
+   size_t len   = SAVESTATE_INDEX_HEADER_SIZE +
+      savestate_index.count * SAVESTATE_INDEX_ENTRY_SIZE;
+   uint8_t *buf = NULL;
+   uint8_t *ptr = NULL;
+   int tries;
+
+   if (!(buf = (uint8_t*)malloc(len)))
+      return;
+
+   strlcpy(path, savestate_index.base, sizeof(path));
+   strlcat(path, ".idx", sizeof(path));
+
+   retro_set_unaligned_32le(buf,     SAVESTATE_INDEX_MAGIC);
+   retro_set_unaligned_32le(buf + 4, SAVESTATE_INDEX_VERSION);
+   retro_set_unaligned_32le(buf + 8, (uint32_t)savestate_index.count);
+
+   ptr = buf + SAVESTATE_INDEX_HEADER_SIZE;
+   for (i = 0; i < savestate_index.count; i++)
+   {
+      const content_state_slot_info_t *info = &savestate_index.slots[i];
+
+      retro_set_unaligned_32le(ptr,      (uint32_t)info->slot);
+      retro_set_unaligned_32le(ptr + 4,  info->has_thumbnail
+            ? SAVESTATE_INDEX_FLAG_THUMBNAIL : 0);
+      retro_set_unaligned_64le(ptr + 8,  info->size);
+      retro_set_unaligned_64le(ptr + 16, (uint64_t)info->timestamp);
+      ptr += SAVESTATE_INDEX_ENTRY_SIZE;
+   }
+
+   /* Creating the index modifies the directory itself,
+    * in which case it is rewritten (in place, which
+    * leaves the directory alone) with the new time */
+   for (tries = 0; tries < 2; tries++)
+   {
+      int64_t dir_mtime = savestate_index_dir_mtime(savestate_index.base);
+
+      retro_set_unaligned_64le(buf + 12, (uint64_t)dir_mtime);
+
+      if (!filestream_write_file(path, buf, (int64_t)len))
+         break;
+
+      if (savestate_index_dir_mtime(savestate_index.base) == dir_mtime)
+         break;
+   }
+
+   free(buf);
+}
+
+static bool savestate_index_read(void)
+{
+   uint32_t i, count;
+   char path[PATH_MAX_LENGTH];
+   int64_t len   = 0;
+   void *buf     = NULL;
+   uint8_t *data = NULL;
+   bool ret      = false;
+
+   strlcpy(path, savestate_index.base, sizeof(path));
+   strlcat(path, ".idx", sizeof(path));
+
+   if (!path_is_valid(path) ||
+       !filestream_read_file(path, &buf, &len))
+      return false;
+
+   data = (uint8_t*)buf;
+
+   if (len < SAVESTATE_INDEX_HEADER_SIZE ||
+       retro_get_unaligned_32le(data)     != SAVESTATE_INDEX_MAGIC ||
+       retro_get_unaligned_32le(data + 4) != SAVESTATE_INDEX_VERSION)
+      goto end;
+
+   count = retro_get_unaligned_32le(data + 8);
+
+   if ((uint64_t)len < SAVESTATE_INDEX_HEADER_SIZE +
+         (uint64_t)count * SAVESTATE_INDEX_ENTRY_SIZE)
+      goto end;
+
+   /* Anything added or removed since the index was
+    * written invalidates it */
+   if ((int64_t)retro_get_unaligned_64le(data + 12) !=
+         savestate_index_dir_mtime(savestate_index.base))
+      goto end;
+
+   for (i = 0; i < count; i++)
+   {
+      uint8_t *ptr = data + SAVESTATE_INDEX_HEADER_SIZE
+         + i * SAVESTATE_INDEX_ENTRY_SIZE;
+      content_state_slot_info_t *info = savestate_index_add(
+            (int)retro_get_unaligned_32le(ptr));
+
+      if (!info)
+         goto end;
+
+      info->has_thumbnail = (retro_get_unaligned_32le(ptr + 4)
+            & SAVESTATE_INDEX_FLAG_THUMBNAIL) != 0;
+      info->size          = retro_get_unaligned_64le(ptr + 8);
+      info->timestamp     = (int64_t)retro_get_unaligned_64le(ptr + 16);
+   }
+
+   ret = true;
+
+end:
+   free(buf);
+   return ret;
+}
+
+/* Fills the index from one listing of the savestate
+ * directory; only files that are states of one of
+ * the slots get stat'ed */
+static void savestate_index_rebuild(void)
+{
+   size_t i;
+   char dir[PATH_MAX_LENGTH];
+   struct string_list *list = NULL;
+
+   savestate_index.count = 0;
+
+   dir[0] = '\0';
+   fill_pathname_basedir(dir, savestate_index.base, sizeof(dir));
+
+   if (!(list = dir_list_new(dir, NULL, false, true, false, false)))
+      return;
+
+   for (i = 0; i < list->size; i++)
+   {
+      int slot;
+      const char *path = list->elems[i].data;
+      content_state_slot_info_t *info;
+
+      if (!savestate_index_parse_slot(savestate_index.base, path, &slot))
+         continue;
+
+      if (!(info = savestate_index_add(slot)))
+         break;
+
+      info->size      = (uint64_t)path_get_size(path);
+      info->timestamp = path_get_mtime(path);
+   }
+
+   /* Thumbnails are '<state>.png' */
+   for (i = 0; i < list->size; i++)
+   {
+      int slot;
+      char state_path[PATH_MAX_LENGTH];
+      content_state_slot_info_t *info;
+
+      strlcpy(state_path, list->elems[i].data, sizeof(state_path));
+
+      if (!string_is_equal_noncase(path_get_extension(state_path), "png"))
+         continue;
+
+      path_remove_extension(state_path);
+
+      if (savestate_index_parse_slot(savestate_index.base,
+               state_path, &slot) &&
+          (info = savestate_index_find(slot)))
+         info->has_thumbnail = true;
+   }
+
+   dir_list_free(list);
+}
+
+/* Makes sure the index describes the current content */
+static bool savestate_index_load(void)
+{
+   global_t *global = global_get_ptr();
+
+   if (!global || string_is_empty(global->name.savestate))
+      return false;
+
+   if (string_is_equal(savestate_index.base, global->name.savestate))
+      return true;
+
+   savestate_index.count = 0;
+   strlcpy(savestate_index.base, global->name.savestate,
+         sizeof(savestate_index.base));
+
+   if (!savestate_index_read())
+   {
+      savestate_index.count = 0;
+      savestate_index_rebuild();
+      savestate_index_write();
+   }
+
+   return true;
+}
+
+/* Records a state just written to @path by a save task */
+static void savestate_index_set(const char *path,
+      uint64_t size, bool has_thumbnail)
+{
+   int slot;
+   content_state_slot_info_t *info = NULL;
+
+   if (!savestate_index_load() ||
+       !savestate_index_parse_slot(savestate_index.base, path, &slot))
+      return;
+
+   if (!(info = savestate_index_add(slot)))
+      return;
+
+   info->size          = size;
+   info->timestamp     = (int64_t)time(NULL);
+   info->has_thumbnail = info->has_thumbnail || has_thumbnail;
+
+   savestate_index_write();
+}
+
+bool content_get_state_slot_info(int slot, content_state_slot_info_t *info)
+{
+   content_state_slot_info_t *entry = NULL;
+
+   if (!savestate_index_load() || !(entry = savestate_index_find(slot)))
+      return false;
+
+   if (info)
+      *info = *entry;
+
+   return true;
+}
+
+const content_state_slot_info_t *content_get_state_slots(size_t *count)
+{
+   if (!savestate_index_load())
+   {
+      *count = 0;
+      return NULL;
+   }
+
+   *count = savestate_index.count;
+   return savestate_index.slots;
+}
+
+void content_update_state_slot_info(const char *path)
+{
+   int slot;
+   char thumbnail_path[PATH_MAX_LENGTH];
+
+   if (!savestate_index_load() ||
+       !savestate_index_parse_slot(savestate_index.base, path, &slot))
+      return;
+
+   if (path_is_valid(path))
+   {
+      content_state_slot_info_t *info = savestate_index_add(slot);
+
+      if (!info)
+         return;
+
+      strlcpy(thumbnail_path, path, sizeof(thumbnail_path));
+      strlcat(thumbnail_path, FILE_PATH_PNG_EXTENSION,
+            sizeof(thumbnail_path));
+
+      info->size          = (uint64_t)path_get_size(path);
+      info->timestamp     = path_get_mtime(path);
+      info->has_thumbnail = path_is_valid(thumbnail_path);
+   }
+   else
+      savestate_index_remove(slot);
+
+   savestate_index_write();
+}
+
 static void undo_save_state_cb(retro_task_t *task,
       void *task_data,
       void *user_data, const char *error)
 {
    save_task_state_t *state = (save_task_state_t*)task_data;
 
+   if (!error)
+      savestate_index_set(state->path, state->size, false);
+
    /* Wipe the save file buffer as it's intended to be one use only */
    undo_save_buf.path[0] = '\0';
    undo_save_buf.size    = 0;
@@ -553,6 +1183,120 @@ static void undo_save_state_cb(retro_task_t *task,
    free(state);
 }
 
+/**
+ * save_state_pool_acquire:
+ * @size : size of the buffer
+ *
+ * Returns a zero-initialised buffer of @size bytes, recycled
+ * from the savestate pool if possible. Release it with
+ * save_state_pool_release().
+ *
+ * Recycled buffers are cleared with memset(), which is far
+ * cheaper than faulting in freshly allocated pages.
+ **/
+static void *save_state_pool_acquire(size_t size)
+{
+   unsigned i;
+   struct save_state_pool_slot *slot = NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_SLOTS; i++)
+   {
+      if (save_state_pool[i].in_use)
+         continue;
+      if (save_state_pool[i].size == size)
+      {
+         slot = &save_state_pool[i];
+         break;
+      }
+      if (!slot)
+         slot = &save_state_pool[i];
+   }
+
+   if (slot)
+   {
+      if (slot->size != size)
+      {
+         free(slot->data);
+         slot->data = calloc(size, 1);
+         slot->size = slot->data ? size : 0;
+      }
+      else
+         memset(slot->data, 0, size);
+      if (slot->data)
+         slot->in_use = true;
+      else
+         slot       = NULL;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(save_state_pool_lock);
+#endif
+
+   if (slot)
+      return slot->data;
+
+   /* All slots busy - fall back to a one-off buffer */
+   return calloc(size, 1);
+}
+
+static void save_state_pool_release(void *data)
+{
+   unsigned i;
+
+   if (!data)
+      return;
+
+#ifdef HAVE_THREADS
+   slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_SLOTS; i++)
+   {
+      if (save_state_pool[i].data == data)
+      {
+         save_state_pool[i].in_use = false;
+         data                      = NULL;
+         break;
+      }
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(save_state_pool_lock);
+#endif
+
+   free(data);
+}
+
+static void save_state_pool_free(void)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   if (!save_state_pool_lock)
+      return;
+   slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_SLOTS; i++)
+   {
+      /* Buffers still owned by a save task are freed
+       * when it releases them */
+      if (save_state_pool[i].in_use)
+         continue;
+      free(save_state_pool[i].data);
+      save_state_pool[i].data = NULL;
+      save_state_pool[i].size = 0;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(save_state_pool_lock);
+#endif
+}
+
 /**
  * task_save_handler_finished:
  * @task : the task to finish
@@ -570,6 +1314,9 @@ static void task_save_handler_finished(retro_task_t *task,
    intfstream_close(state->file);
    free(state->file);
 
+   free(state->thumbnail);
+   state->thumbnail = NULL;
+
    if (!task_get_error(task) && task_get_cancelled(task))
       task_set_error(task, strdup("Task canceled"));
 
@@ -582,7 +1329,7 @@ static void task_save_handler_finished(retro_task_t *task,
    {
       if (state->undo_save && state->data == undo_save_buf.data)
          undo_save_buf.data = NULL;
-      free(state->data);
+      save_state_pool_release(state->data);
       state->data = NULL;
    }
 
@@ -683,7 +1430,16 @@ bool content_serialize_state(void* buffer, size_t buffer_size)
    return content_write_serialized_state(buffer, &size);
 }
 
-static void *content_get_serialized_data(size_t* serial_size)
+/**
+ * content_get_serialized_data:
+ * @serial_size : size of the returned state
+ * @pooled      : take the buffer from the savestate pool;
+ *                must then be released with
+ *                save_state_pool_release()
+ *
+ * Serializes the current state into a new buffer.
+ **/
+static void *content_get_serialized_data(size_t* serial_size, bool pooled)
 {
    void* data;
 
@@ -696,13 +1452,19 @@ static void *content_get_serialized_data(size_t* serial_size)
     *   sizes when core requests a larger buffer
     *   than it needs (and leaves the excess
     *   as uninitialised garbage) */
-   data = calloc(size.total_size, 1);
+   if (pooled)
+      data = save_state_pool_acquire(size.total_size);
+   else
+      data = calloc(size.total_size, 1);
    if (!data)
       return NULL;
 
    if (!content_write_serialized_state(data, &size))
    {
-      free(data);
+      if (pooled)
+         save_state_pool_release(data);
+      else
+         free(data);
       return NULL;
    }
 
@@ -739,7 +1501,7 @@ static void task_save_handler(retro_task_t *task)
    if (!state->data)
    {
       size_t size;
-      state->data = content_get_serialized_data(&size);
+      state->data = content_get_serialized_data(&size, true);
       state->size = (ssize_t)size;
    }
 
@@ -788,6 +1550,22 @@ static void task_save_handler(retro_task_t *task)
 
       task_free_title(task);
 
+#ifdef HAVE_SCREENSHOTS
+      if (state->thumbnail)
+      {
+         char thumbnail_path[PATH_MAX_LENGTH];
+
+         strlcpy(thumbnail_path, state->path, sizeof(thumbnail_path));
+         strlcat(thumbnail_path, ".png", sizeof(thumbnail_path));
+
+         if (!screenshot_dump_frame(thumbnail_path, state->thumbnail,
+                  state->thumbnail_width, state->thumbnail_height,
+                  state->thumbnail_pitch, state->thumbnail_format,
+                  SAVESTATE_THUMBNAIL_MAX_WIDTH))
+            state->thumbnail_captured = false;
+      }
+#endif
+
       if (state->undo_save)
          msg = strdup(msg_hash_to_str(MSG_RESTORED_OLD_SAVE_STATE));
       else if (state->state_slot < 0)
@@ -1271,6 +2049,43 @@ error:
    free(load_data);
 }
 
+#ifdef HAVE_SCREENSHOTS
+/* Copies the software frame the core last rendered, so the
+ * save task can turn it into a thumbnail off the main thread
+ * instead of reading back from the video driver. */
+static void save_state_capture_thumbnail(save_task_state_t *state)
+{
+   size_t pitch;
+   unsigned width, height, y;
+   size_t row_size;
+   const void *data = NULL;
+   uint8_t *copy    = NULL;
+   unsigned format  = video_driver_get_pixel_format();
+
+   video_driver_cached_frame_get(&data, &width, &height, &pitch);
+
+   if (!data || data == RETRO_HW_FRAME_BUFFER_VALID || !width || !height)
+      return;
+
+   row_size = width * ((format == RETRO_PIXEL_FORMAT_XRGB8888)
+         ? sizeof(uint32_t) : sizeof(uint16_t));
+
+   if (row_size > pitch || !(copy = (uint8_t*)malloc(row_size * height)))
+      return;
+
+   for (y = 0; y < height; y++)
+      memcpy(copy + y * row_size,
+            (const uint8_t*)data + y * pitch, row_size);
+
+   state->thumbnail          = copy;
+   state->thumbnail_pitch    = row_size;
+   state->thumbnail_width    = width;
+   state->thumbnail_height   = height;
+   state->thumbnail_format   = format;
+   state->thumbnail_captured = true;
+}
+#endif
+
 /**
  * save_state_cb:
  *
@@ -1286,10 +2101,20 @@ static void save_state_cb(retro_task_t *task,
    settings_t     *settings   = config_get_ptr();
    const char *dir_screenshot = settings->paths.directory_screenshot; 
 
-   if (state->thumbnail_enable)
+   /* Thumbnails made from a copy of the frame were
+    * already written by the save task; fall back to a
+    * readback only if that wasn't possible */
+   if (state->thumbnail_enable && !state->thumbnail_captured)
       take_screenshot(dir_screenshot,
             path, true, state->has_valid_framebuffer, false, true);
    free(path);
+
+   if (!error)
+      savestate_index_set(state->path, state->size,
+            state->thumbnail_enable);
+#else
+   if (!error)
+      savestate_index_set(state->path, state->size, false);
 #endif
 
    free(state);
@@ -1329,6 +2154,11 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
    state->compress_files         = compress_files;
 
+#ifdef HAVE_SCREENSHOTS
+   if (savestate_thumbnail_enable && !state->has_valid_framebuffer)
+      save_state_capture_thumbnail(state);
+#endif
+
    task->type              = TASK_TYPE_BLOCKING;
    task->state             = state;
    task->handler           = task_save_handler;
@@ -1339,8 +2169,7 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    if (!task_queue_push(task))
    {
       /* Another blocking task is already active. */
-      if (data)
-         free(data);
+      save_state_pool_release(data);
       if (task->title)
          task_free_title(task);
       free(task);
@@ -1350,8 +2179,7 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    return;
 
 error:
-   if (data)
-      free(data);
+   save_state_pool_release(data);
    if (state)
       free(state);
    if (task)
@@ -1445,8 +2273,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
    if (!task_queue_push(task))
    {
       /* Another blocking task is already active. */
-      if (data)
-         free(data);
+      save_state_pool_release(data);
       if (task->title)
          task_free_title(task);
       free(task);
@@ -1474,9 +2301,14 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
       return false;
    serial_size = info.size;
 
-   if (!save_state_in_background)
+#ifdef HAVE_THREADS
+   if (!save_state_pool_lock)
+      save_state_pool_lock = slock_new();
+#endif
+
+   if (!save_to_disk)
    {
-      data = content_get_serialized_data(&serial_size);
+      data = content_get_serialized_data(&serial_size, false);
 
       if (!data)
       {
@@ -1485,33 +2317,27 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
                path);
          return false;
       }
+      /* save_to_disk is false, which means we are saving the state
+      in undo_load_buf to allow content_undo_load_state() to restore it */
 
-      RARCH_LOG("[State]: %s \"%s\", %u %s.\n",
-            msg_hash_to_str(MSG_SAVING_STATE),
-            path,
-            (unsigned)serial_size,
-            msg_hash_to_str(MSG_BYTES));
-   }
-
-   if (save_to_disk)
-   {
-      if (path_is_valid(path) && !autosave)
+      /* If we were holding onto an old state already, clean it up first */
+      if (undo_load_buf.data)
       {
-         /* Before overwriting the savestate file, load it into a buffer
-         to allow undo_save_state() to work */
-         /* TODO/FIXME - Use msg_hash_to_str here */
-         RARCH_LOG("[State]: %s ...\n",
-               msg_hash_to_str(MSG_FILE_ALREADY_EXISTS_SAVING_TO_BACKUP_BUFFER));
-
-         task_push_load_and_save_state(path, data, serial_size, true, autosave);
+         free(undo_load_buf.data);
+         undo_load_buf.data = NULL;
       }
-      else
-         task_push_save_state(path, data, serial_size, autosave);
+
+      undo_load_buf.data = data;
+      undo_load_buf.size = serial_size;
+      strlcpy(undo_load_buf.path, path, sizeof(undo_load_buf.path));
+      return true;
    }
-   else
+
+   if (!save_state_in_background)
    {
-      if (!data)
-         data = content_get_serialized_data(&serial_size);
+      /* Only serialize here; compression and writing
+       * the file are done by the save task */
+      data = content_get_serialized_data(&serial_size, true);
 
       if (!data)
       {
@@ -1520,28 +2346,26 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
                path);
          return false;
       }
-      /* save_to_disk is false, which means we are saving the state
-      in undo_load_buf to allow content_undo_load_state() to restore it */
 
-      /* If we were holding onto an old state already, clean it up first */
-      if (undo_load_buf.data)
-      {
-         free(undo_load_buf.data);
-         undo_load_buf.data = NULL;
-      }
+      RARCH_LOG("[State]: %s \"%s\", %u %s.\n",
+            msg_hash_to_str(MSG_SAVING_STATE),
+            path,
+            (unsigned)serial_size,
+            msg_hash_to_str(MSG_BYTES));
+   }
 
-      undo_load_buf.data = malloc(serial_size);
-      if (!undo_load_buf.data)
-      {
-         free(data);
-         return false;
-      }
+   if (path_is_valid(path) && !autosave)
+   {
+      /* Before overwriting the savestate file, load it into a buffer
+      to allow undo_save_state() to work */
+      /* TODO/FIXME - Use msg_hash_to_str here */
+      RARCH_LOG("[State]: %s ...\n",
+            msg_hash_to_str(MSG_FILE_ALREADY_EXISTS_SAVING_TO_BACKUP_BUFFER));
 
-      memcpy(undo_load_buf.data, data, serial_size);
-      free(data);
-      undo_load_buf.size = serial_size;
-      strlcpy(undo_load_buf.path, path, sizeof(undo_load_buf.path));
+      task_push_load_and_save_state(path, data, serial_size, true, autosave);
    }
+   else
+      task_push_save_state(path, data, serial_size, autosave);
 
    return true;
 }
@@ -1651,6 +2475,8 @@ bool content_rename_state(const char *origin, const char *dest)
 */
 bool content_reset_savestate_backups(void)
 {
+   save_state_pool_free();
+
    if (undo_save_buf.data)
    {
       free(undo_save_buf.data);
@@ -31,10 +31,8 @@
 #include <string/stdstring.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
-
-#ifdef HAVE_RBMP
+#include <features/features_cpu.h>
 #include <formats/rbmp.h>
-#endif
 
 #ifdef HAVE_RPNG
 #include <formats/rpng.h>
@@ -70,6 +68,7 @@ struct screenshot_task_state
    unsigned width;
    unsigned height;
    unsigned pixel_format_type;
+   unsigned mode;
 
    char filename[PATH_MAX_LENGTH];
    char shotname[256];
@@ -82,12 +81,33 @@ struct screenshot_task_state
    bool widgets_ready;
 };
 
+static bool screenshot_dump_bmp(screenshot_task_state_t *state)
+{
+   enum rbmp_source_type bmp_type = RBMP_SOURCE_TYPE_RGB565;
+
+   if (state->bgr24)
+      bmp_type = RBMP_SOURCE_TYPE_BGR24;
+   else if (state->pixel_format_type == RETRO_PIXEL_FORMAT_XRGB8888)
+      bmp_type = RBMP_SOURCE_TYPE_XRGB888;
+
+   /* The frame is bottom-up already, which is what BMP stores */
+   return rbmp_save_image(state->filename,
+         state->frame,
+         state->width,
+         state->height,
+         state->pitch,
+         bmp_type);
+}
+
 static bool screenshot_dump_direct(screenshot_task_state_t *state)
 {
    struct scaler_ctx *scaler      = (struct scaler_ctx*)&state->scaler;
    bool ret                       = false;
 
 #if defined(HAVE_RPNG)
+   if (state->mode == SCREENSHOT_MODE_BMP)
+      return screenshot_dump_bmp(state);
+
    if (state->bgr24)
       scaler->in_fmt              = SCALER_FMT_BGR24;
    else if (state->pixel_format_type == RETRO_PIXEL_FORMAT_XRGB8888)
@@ -105,33 +125,82 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
 
    scaler_ctx_gen_reset(&state->scaler);
 
-   ret = rpng_save_image_bgr24(
-         state->filename,
-         state->out_buffer,
-         state->width,
-         state->height,
-         state->width * 3
-         );
+   if (state->mode == SCREENSHOT_MODE_PNG_FAST)
+      ret = rpng_save_image_bgr24_fast(
+            state->filename,
+            state->out_buffer,
+            state->width,
+            state->height,
+            state->width * 3,
+            cpu_features_get_core_amount());
+   else
+      ret = rpng_save_image_bgr24(
+            state->filename,
+            state->out_buffer,
+            state->width,
+            state->height,
+            state->width * 3
+            );
 
    free(state->out_buffer);
-#elif defined(HAVE_RBMP)
+#else
+   ret = screenshot_dump_bmp(state);
+#endif
+
+   return ret;
+}
+
+bool screenshot_dump_frame(const char *path, const void *frame,
+      unsigned width, unsigned height, size_t pitch,
+      unsigned pixel_format_type, unsigned max_width)
+{
+#if defined(HAVE_RPNG)
+   struct scaler_ctx scaler;
+   struct scaler_ctx *ctx = &scaler;
+   uint8_t *out_buffer = NULL;
+   unsigned out_width  = width;
+   unsigned out_height = height;
+   bool ret            = false;
+
+   if (max_width && width > max_width)
    {
-      enum rbmp_source_type bmp_type = RBMP_SOURCE_TYPE_DONT_CARE;
-      if (state->bgr24)
-         bmp_type = RBMP_SOURCE_TYPE_BGR24;
-      else if (state->pixel_format_type == RETRO_PIXEL_FORMAT_XRGB8888)
-         bmp_type = RBMP_SOURCE_TYPE_XRGB888;
-
-      ret = rbmp_save_image(state->filename,
-            state->frame,
-            state->width,
-            state->height,
-            state->pitch,
-            bmp_type);
+      out_width  = max_width;
+      out_height = (unsigned)((uint64_t)height * max_width / width);
+      if (!out_height)
+         out_height = 1;
+   }
+
+   memset(&scaler, 0, sizeof(scaler));
+
+   scaler.in_fmt       = (pixel_format_type == RETRO_PIXEL_FORMAT_XRGB8888)
+      ? SCALER_FMT_ARGB8888 : SCALER_FMT_RGB565;
+   scaler.out_fmt      = SCALER_FMT_BGR24;
+   scaler.in_width     = width;
+   scaler.in_height    = height;
+   scaler.out_width    = out_width;
+   scaler.out_height   = out_height;
+   scaler.in_stride    = (int)pitch;
+   scaler.out_stride   = out_width * 3;
+   scaler.scaler_type  = (out_width != width)
+      ? SCALER_TYPE_BILINEAR : SCALER_TYPE_POINT;
+
+   if (!(out_buffer = (uint8_t*)malloc(out_width * out_height * 3)))
+      return false;
+
+   if (scaler_ctx_gen_filter(ctx))
+   {
+      scaler_ctx_scale_direct(ctx, out_buffer, frame);
+      ret = rpng_save_image_bgr24(path, out_buffer,
+            out_width, out_height, out_width * 3);
    }
-#endif
+
+   scaler_ctx_gen_reset(ctx);
+   free(out_buffer);
 
    return ret;
+#else
+   return false;
+#endif
 }
 
 /**
@@ -293,6 +362,13 @@ static bool screenshot_dump(
    state->silence                = savestate;
    state->history_list_enable    = settings->bools.history_list_enable;
    state->pixel_format_type      = pixel_format_type;
+#if defined(HAVE_RPNG)
+   /* Savestate thumbnails are always loaded back as PNG */
+   state->mode                   = savestate
+      ? SCREENSHOT_MODE_PNG : settings->uints.screenshot_mode;
+#else
+   state->mode                   = SCREENSHOT_MODE_BMP;
+#endif
 
    if (!fullpath)
    {
@@ -355,13 +431,16 @@ static bool screenshot_dump(
                screenshot_name = path_basename(name_base);
 
             fill_str_dated_filename(state->shotname, screenshot_name,
-                  IMG_EXT, sizeof(state->shotname));
+                  state->mode == SCREENSHOT_MODE_BMP ? "bmp" : IMG_EXT,
+                  sizeof(state->shotname));
          }
          else
          {
             strlcpy(state->shotname, path_basename(name_base),
                   sizeof(state->shotname));
-            strlcat(state->shotname, ".png", sizeof(state->shotname));
+            strlcat(state->shotname,
+                  state->mode == SCREENSHOT_MODE_BMP ? ".bmp" : ".png",
+                  sizeof(state->shotname));
          }
 
          if (  string_is_empty(new_screenshot_dir) || 
@@ -384,13 +463,16 @@ static bool screenshot_dump(
    }
 
 #if defined(HAVE_RPNG)
-   buf = (uint8_t*)malloc(width * height * 3);
-   if (!buf)
+   if (state->mode != SCREENSHOT_MODE_BMP)
    {
-      free(state);
-      return false;
+      buf = (uint8_t*)malloc(width * height * 3);
+      if (!buf)
+      {
+         free(state);
+         return false;
+      }
+      state->out_buffer = buf;
    }
-   state->out_buffer = buf;
 #endif
 
    if (use_thread)
@@ -0,0 +1,115 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <compat/strl.h>
+#include <queues/task_queue.h>
+#include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+
+#include "../gfx/video_shader_parse.h"
+#include "../gfx/drivers_shader/glslang_util.h"
+#include "../msg_hash.h"
+#include "../verbosity.h"
+#include "tasks_internal.h"
+
+typedef struct shader_preload
+{
+   struct video_shader *shader;
+   char path[PATH_MAX_LENGTH];
+   unsigned pass;
+   bool loaded;
+} shader_preload_t;
+
+/* Compiles one pass per iteration so the task can be
+ * cancelled and reports progress in between */
+static void task_shader_preload_handler(retro_task_t *task)
+{
+   shader_preload_t *preload = (shader_preload_t*)task->state;
+   struct video_shader *shader = preload->shader;
+
+   if (task_get_cancelled(task))
+      goto end;
+
+   if (!preload->loaded)
+   {
+      preload->loaded = true;
+      if (!video_shader_load_preset_into_shader(preload->path, shader))
+         goto end;
+      return;
+   }
+
+   if (preload->pass >= shader->passes)
+      goto end;
+
+   /* Failures are reported again when the driver loads the preset */
+   glslang_precompile_shader(shader->pass[preload->pass].source.path);
+   preload->pass++;
+   task_set_progress(task, (int8_t)((preload->pass * 100) / shader->passes));
+   return;
+
+end:
+   task_set_progress(task, 100);
+   task_set_finished(task, true);
+}
+
+static void task_shader_preload_free(retro_task_t *task)
+{
+   shader_preload_t *preload = (shader_preload_t*)task->state;
+
+   if (preload)
+   {
+      free(preload->shader);
+      free(preload);
+   }
+}
+
+bool task_push_shader_preload(const char *path,
+      retro_task_callback_t cb, void *user_data)
+{
+   retro_task_t *task        = NULL;
+   shader_preload_t *preload = NULL;
+
+   if (string_is_empty(path))
+      return false;
+
+   if (!(task = task_init()))
+      return false;
+
+   if (!(preload = (shader_preload_t*)calloc(1, sizeof(*preload))))
+      goto error;
+   if (!(preload->shader = (struct video_shader*)
+            calloc(1, sizeof(*preload->shader))))
+      goto error;
+   strlcpy(preload->path, path, sizeof(preload->path));
+
+   task->type      = TASK_TYPE_NONE;
+   task->state     = preload;
+   task->handler   = task_shader_preload_handler;
+   task->cleanup   = task_shader_preload_free;
+   task->callback  = cb;
+   task->user_data = user_data;
+   task->title     = strdup(msg_hash_to_str(MSG_COMPILING_SHADER));
+
+   task_queue_push(task);
+   return true;
+
+error:
+   if (preload)
+      free(preload);
+   free(task);
+   return false;
+}
@@ -32,6 +32,7 @@
       retro_task_t   *task = task_init(); \
       if (!task) \
          return false; \
+      wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL); \
       task->type           = TASK_TYPE_BLOCKING; \
       task->state          = NULL; \
       task->handler        = handlerfunc; \
@@ -108,7 +109,9 @@ bool task_push_wifi_connect(retro_task_callback_t cb, void *netptr) {
    wifi_network_info_t *netinfo = (wifi_network_info_t*)netptr;
    if (!task)
       return false;
-      
+
+   wifi_driver_ctl(RARCH_WIFI_CTL_INIT_DEFERRED, NULL);
+
    snprintf(msg, sizeof(msg), msg_hash_to_str(MSG_WIFI_CONNECTING_TO), netinfo->ssid);
 
    task->type           = TASK_TYPE_BLOCKING;
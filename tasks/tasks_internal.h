@@ -55,7 +55,9 @@ typedef struct
 {
    char *data;
    size_t len;
+   size_t content_length; /* Content-Length header, 0 if none */
    int status;
+   bool not_modified;     /* Body is the cached copy, the server sent 304 */
 } http_transfer_data_t;
 
 void *task_push_http_transfer(const char *url, bool mute, const char *type,
@@ -67,6 +69,9 @@ void *task_push_http_transfer_with_user_agent(const char *url, bool mute, const
 void *task_push_http_post_transfer(const char *url, const char *post_data, bool mute, const char *type,
       retro_task_callback_t cb, void *userdata);
 
+void *task_push_http_head_transfer(const char *url, bool mute, const char *type,
+      retro_task_callback_t cb, void *userdata);
+
 void *task_push_http_post_transfer_with_user_agent(const char* url, const char* post_data, bool mute,
    const char* type, const char* user_agent, retro_task_callback_t cb, void* user_data);
 
@@ -87,7 +92,11 @@ bool task_push_netplay_crc_scan(uint32_t crc, char* name,
 
 bool task_push_netplay_lan_scan_rooms(retro_task_callback_t cb);
 
-bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port);
+/* Measures the round trip to every internet room in
+ * netplay_room_list and stores it there before @cb runs */
+bool task_push_netplay_latency_probe(retro_task_callback_t cb);
+
+bool task_push_netplay_nat_traversal(uint16_t port);
 
 /* Core updater tasks */
 
@@ -158,6 +167,19 @@ bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
+/* Same as task_push_image_load(), but scales images larger
+ * than 'max_size' down and stores the result as raw pixels
+ * in 'sidecar_path', which later loads read instead */
+bool task_push_image_load_sidecar(const char *fullpath,
+      const char *sidecar_path, unsigned max_size,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *userdata);
+
+#ifdef HAVE_THREADS
+/* Stops the threads image loads decode on */
+void task_image_pool_deinit(void);
+#endif
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,
@@ -167,6 +189,18 @@ bool task_push_dbscan(
       retro_task_callback_t cb);
 #endif
 
+#ifdef HAVE_SLANG
+/* Compiles every pass of the slang preset at @path in the
+ * background, @cb runs on the main thread once the driver can
+ * load the preset from the shader cache */
+bool task_push_shader_preload(const char *path,
+      retro_task_callback_t cb, void *user_data);
+#endif
+
+/* Reads the head of a disc image in the background so a
+ * following disc swap opens it warm */
+bool task_push_disk_prefetch(const char *image_path);
+
 bool task_push_manual_content_scan(
       const playlist_config_t *playlist_config,
       const char *playlist_directory);
@@ -213,6 +247,14 @@ bool take_screenshot(
       const char *path, bool silence,
       bool has_valid_framebuffer, bool fullpath, bool use_thread);
 
+/* Writes a top-down frame in the core's pixel format to
+ * 'path' as PNG, scaled down to at most 'max_width' pixels
+ * wide (0 keeps the size). Doesn't touch the video driver,
+ * so it is safe to call from a task thread. */
+bool screenshot_dump_frame(const char *path, const void *frame,
+      unsigned width, unsigned height, size_t pitch,
+      unsigned pixel_format_type, unsigned max_width);
+
 bool event_load_save_files(bool is_sram_load_disabled);
 
 bool event_save_files(bool sram_used);
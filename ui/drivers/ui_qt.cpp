@@ -2310,6 +2310,7 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
    QVector<QHash<QString, QString> > infoList;
    QHash<QString, QString> currentCore = getSelectedCore();
    core_info_t *core_info              = NULL;
+   core_info_details_t *details        = NULL;
    QByteArray currentCorePathArray     = currentCore["core_path"].toUtf8();
    const char *current_core_path_data  = currentCorePathArray.constData();
 
@@ -2318,7 +2319,8 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
 
    if (     currentCore["core_path"].isEmpty() 
          || !core_info 
-         || !core_info->has_info)
+         || !core_info->has_info
+         || !(details = core_info_get_details(core_info)))
    {
       QHash<QString, QString> hash;
 
@@ -2363,26 +2365,26 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
       infoList.append(hash);
    }
 
-   if (core_info->system_manufacturer)
+   if (details->system_manufacturer)
    {
       QHash<QString, QString> hash;
 
       hash["key"]   = QString(msg_hash_to_str(MENU_ENUM_LABEL_VALUE_CORE_INFO_SYSTEM_MANUFACTURER)) + ":";
-      hash["value"] = core_info->system_manufacturer;
+      hash["value"] = details->system_manufacturer;
 
       infoList.append(hash);
    }
 
-   if (core_info->categories_list)
+   if (details->categories_list)
    {
       QHash<QString, QString> hash;
       QString categories;
 
-      for (i = 0; i < core_info->categories_list->size; i++)
+      for (i = 0; i < details->categories_list->size; i++)
       {
-         categories += core_info->categories_list->elems[i].data;
+         categories += details->categories_list->elems[i].data;
 
-         if (i < core_info->categories_list->size - 1)
+         if (i < details->categories_list->size - 1)
             categories += ", ";
       }
 
@@ -2393,16 +2395,16 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
       infoList.append(hash);
    }
 
-   if (core_info->authors_list)
+   if (details->authors_list)
    {
       QHash<QString, QString> hash;
       QString authors;
 
-      for (i = 0; i < core_info->authors_list->size; i++)
+      for (i = 0; i < details->authors_list->size; i++)
       {
-         authors += core_info->authors_list->elems[i].data;
+         authors += details->authors_list->elems[i].data;
 
-         if (i < core_info->authors_list->size - 1)
+         if (i < details->authors_list->size - 1)
             authors += ", ";
       }
 
@@ -2413,16 +2415,16 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
       infoList.append(hash);
    }
 
-   if (core_info->permissions_list)
+   if (details->permissions_list)
    {
       QHash<QString, QString> hash;
       QString permissions;
 
-      for (i = 0; i < core_info->permissions_list->size; i++)
+      for (i = 0; i < details->permissions_list->size; i++)
       {
-         permissions += core_info->permissions_list->elems[i].data;
+         permissions += details->permissions_list->elems[i].data;
 
-         if (i < core_info->permissions_list->size - 1)
+         if (i < details->permissions_list->size - 1)
             permissions += ", ";
       }
 
@@ -2473,7 +2475,7 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
       infoList.append(hash);
    }
 
-   if (core_info->firmware_count > 0)
+   if (details->firmware_count > 0)
    {
       core_info_ctx_firmware_t firmware_info;
       bool update_missing_firmware   = false;
@@ -2502,16 +2504,16 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
          /* FIXME: This looks hacky and probably
           * needs to be improved for good translation support. */
 
-         for (i = 0; i < core_info->firmware_count; i++)
+         for (i = 0; i < details->firmware_count; i++)
          {
-            if (core_info->firmware[i].desc)
+            if (details->firmware[i].desc)
             {
                QString valueText;
                QHash<QString, QString> hash;
                QString labelText = "(!) ";
                bool missing      = false;
 
-               if (core_info->firmware[i].missing)
+               if (details->firmware[i].missing)
                {
                   missing        = true;
                   labelText     += msg_hash_to_str(
@@ -2523,7 +2525,7 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
 
                labelText        += ", ";
 
-               if (core_info->firmware[i].optional)
+               if (details->firmware[i].optional)
                   labelText     += msg_hash_to_str(
                         MENU_ENUM_LABEL_VALUE_OPTIONAL);
                else
@@ -2532,8 +2534,8 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
 
                labelText        += ":";
 
-               if (core_info->firmware[i].desc)
-                  valueText      = core_info->firmware[i].desc;
+               if (details->firmware[i].desc)
+                  valueText      = details->firmware[i].desc;
                else
                   valueText      = msg_hash_to_str(
                         MENU_ENUM_LABEL_VALUE_RDB_ENTRY_NAME);
@@ -2564,14 +2566,14 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
       }
    }
 
-   if (core_info->notes)
+   if (details->notes)
    {
-      for (i = 0; i < core_info->note_list->size; i++)
+      for (i = 0; i < details->note_list->size; i++)
       {
          QHash<QString, QString> hash;
 
          hash["key"]   = "";
-         hash["value"] = core_info->note_list->elems[i].data;
+         hash["value"] = details->note_list->elems[i].data;
 
          infoList.append(hash);
       }
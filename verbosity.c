@@ -89,6 +89,97 @@
 #define FILE_PATH_PROGRAM_NAME "RetroArch"
 #endif
 
+/* Asynchronous logging is available where messages end up
+ * in plain stdio streams and the compiler has atomics */
+#if defined(HAVE_THREADS) && !defined(IS_SALAMANDER) && !defined(HAVE_LOGGER) \
+   && !TARGET_OS_IPHONE && !defined(_XBOX1) && !defined(ANDROID) \
+   && !defined(HAVE_QT) && !defined(__WINRT__)
+#if defined(_MSC_VER) && !defined(_XBOX)
+#define VERBOSITY_HAVE_ASYNC
+#define VERBOSITY_CAS32(ptr, oldval, newval) ((uint32_t)InterlockedCompareExchange( \
+         (LONG volatile*)(ptr), (LONG)(newval), (LONG)(oldval)))
+#define VERBOSITY_XCHG32(ptr, val) ((uint32_t)InterlockedExchange( \
+         (LONG volatile*)(ptr), (LONG)(val)))
+#define VERBOSITY_ADD32(ptr, val) InterlockedExchangeAdd( \
+         (LONG volatile*)(ptr), (LONG)(val))
+#define VERBOSITY_CASPTR(ptr, oldval, newval) InterlockedCompareExchangePointer( \
+         (PVOID volatile*)(ptr), (PVOID)(newval), (PVOID)(oldval))
+#elif defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+#define VERBOSITY_HAVE_ASYNC
+#define VERBOSITY_CAS32(ptr, oldval, newval) \
+         __sync_val_compare_and_swap((ptr), (oldval), (newval))
+#define VERBOSITY_XCHG32(ptr, val) verbosity_xchg32((ptr), (val))
+#define VERBOSITY_ADD32(ptr, val) __sync_fetch_and_add((ptr), (val))
+#define VERBOSITY_CASPTR(ptr, oldval, newval) \
+         __sync_val_compare_and_swap((ptr), (oldval), (newval))
+#endif
+#endif
+
+#ifdef VERBOSITY_HAVE_ASYNC
+#include <stdint.h>
+#include <string.h>
+
+#include <rthreads/rthreads.h>
+#include <retro_timers.h>
+
+#define VERBOSITY_LOAD32(ptr) VERBOSITY_CAS32(ptr, 0, 0)
+
+#if !defined(_MSC_VER)
+/* __sync_lock_test_and_set() is only an acquire barrier,
+ * publishing a slot needs a full one */
+static uint32_t verbosity_xchg32(volatile uint32_t *ptr, uint32_t val)
+{
+   uint32_t old = VERBOSITY_LOAD32(ptr);
+   uint32_t prev;
+
+   while ((prev = VERBOSITY_CAS32(ptr, old, val)) != old)
+      old = prev;
+   return old;
+}
+#endif
+
+/* Records are formatted into fixed size slots */
+#define VERBOSITY_ASYNC_SLOTS      512
+#define VERBOSITY_ASYNC_LINE_SIZE  1024
+/* How often the writer thread looks for new records */
+#define VERBOSITY_ASYNC_INTERVAL   10000
+/* Log files are moved to <path>.1 beyond this size */
+#ifndef VERBOSITY_LOG_ROTATE_SIZE
+#define VERBOSITY_LOG_ROTATE_SIZE  (8 * 1024 * 1024)
+#endif
+
+struct verbosity_async_slot
+{
+   /* Equals the write position once a producer may fill
+    * the slot, and the position + 1 once it is filled */
+   volatile uint32_t seq;
+   char text[VERBOSITY_ASYNC_LINE_SIZE];
+};
+
+struct verbosity_async_ring
+{
+   struct verbosity_async_slot *slots;
+   char last[VERBOSITY_ASYNC_LINE_SIZE]; /* Last line written */
+   volatile uint32_t write;              /* Next slot for producers */
+   volatile uint32_t dropped;            /* Records lost to a full ring */
+   volatile uint32_t read_hint;          /* Copy of 'read' for producers */
+   uint32_t read;                        /* Next slot for the writer */
+   unsigned repeats;                     /* Times 'last' came again */
+};
+
+/* Lives for the whole session, so producers can always
+ * check whether a ring is active, see verbosity_async_push() */
+typedef struct verbosity_async
+{
+   struct verbosity_async_ring *volatile ring;
+   slock_t *lock;                        /* Held while writing to the stream */
+   scond_t *cond;
+   sthread_t *thread;
+   volatile uint32_t users;              /* Producers looking at 'ring' */
+   bool stop;
+} verbosity_async_t;
+#endif
+
 typedef struct verbosity_state
 {
 #ifdef HAVE_LIBNX
@@ -98,8 +189,12 @@ typedef struct verbosity_state
     * will write to this file. */
    FILE *fp;
    void *buf;
+   /* Bytes in the log file, kept up to date
+    * for rotation by the asynchronous writer */
+   size_t log_size;
 
    char override_path[PATH_MAX_LENGTH];
+   char log_path[PATH_MAX_LENGTH];
    bool verbosity;
    bool initialized;
    bool override_active;
@@ -109,6 +204,14 @@ typedef struct verbosity_state
 static verbosity_state_t main_verbosity_st;
 static unsigned verbosity_log_level           = 
 DEFAULT_FRONTEND_LOG_LEVEL;
+#ifdef VERBOSITY_HAVE_ASYNC
+static verbosity_async_t verbosity_async_st;
+#define VERBOSITY_ASYNC_LOCK() if (verbosity_async_st.lock) slock_lock(verbosity_async_st.lock)
+#define VERBOSITY_ASYNC_UNLOCK() if (verbosity_async_st.lock) slock_unlock(verbosity_async_st.lock)
+#else
+#define VERBOSITY_ASYNC_LOCK()
+#define VERBOSITY_ASYNC_UNLOCK()
+#endif
 
 #ifdef HAVE_LIBNX
 #ifdef NXLINK
@@ -175,7 +278,9 @@ void retro_main_log_file_init(const char *path, bool append)
    mutexInit(&g_verbosity->mtx);
 #endif
 
+   VERBOSITY_ASYNC_LOCK();
    g_verbosity->fp      = stderr;
+   VERBOSITY_ASYNC_UNLOCK();
    if (!path)
       return;
 
@@ -187,18 +292,30 @@ void retro_main_log_file_init(const char *path, bool append)
       return;
    }
 
+   VERBOSITY_ASYNC_LOCK();
    g_verbosity->fp          = tmp;
    g_verbosity->initialized = true;
+   g_verbosity->log_size    = 0;
+   strlcpy(g_verbosity->log_path, path, sizeof(g_verbosity->log_path));
+
+   if (append && fseek(tmp, 0, SEEK_END) == 0)
+   {
+      long pos = ftell(tmp);
+      if (pos > 0)
+         g_verbosity->log_size = (size_t)pos;
+   }
 
    /* TODO: this is only useful for a few platforms, find which and add ifdef */
    g_verbosity->buf         = calloc(1, 0x4000);
    setvbuf(g_verbosity->fp, (char*)g_verbosity->buf, _IOFBF, 0x4000);
+   VERBOSITY_ASYNC_UNLOCK();
 }
 
 void retro_main_log_file_deinit(void)
 {
    verbosity_state_t *g_verbosity = &main_verbosity_st;
 
+   VERBOSITY_ASYNC_LOCK();
    if (g_verbosity->fp && g_verbosity->initialized)
    {
       fclose(g_verbosity->fp);
@@ -208,6 +325,278 @@ void retro_main_log_file_deinit(void)
       free(g_verbosity->buf);
    g_verbosity->buf         = NULL;
    g_verbosity->initialized = false;
+   VERBOSITY_ASYNC_UNLOCK();
+}
+
+#ifdef VERBOSITY_HAVE_ASYNC
+/* Called by the writer thread with the lock held */
+static void verbosity_async_rotate(verbosity_state_t *g_verbosity)
+{
+   char old_path[PATH_MAX_LENGTH];
+   FILE *tmp = NULL;
+
+   fclose(g_verbosity->fp);
+   g_verbosity->fp          = stderr;
+   g_verbosity->initialized = false;
+   g_verbosity->log_size    = 0;
+
+   strlcpy(old_path, g_verbosity->log_path, sizeof(old_path));
+   strlcat(old_path, ".1", sizeof(old_path));
+   filestream_delete(old_path);
+   filestream_rename(g_verbosity->log_path, old_path);
+
+   if (!(tmp = (FILE*)fopen_utf8(g_verbosity->log_path, "wb")))
+      return;
+
+   g_verbosity->fp          = tmp;
+   g_verbosity->initialized = true;
+   setvbuf(tmp, (char*)g_verbosity->buf, _IOFBF, 0x4000);
+}
+
+/* Called by the writer thread with the lock held */
+static void verbosity_async_write_line(verbosity_state_t *g_verbosity,
+      const char *line)
+{
+   if (!g_verbosity->fp || fputs(line, g_verbosity->fp) < 0)
+      return;
+
+   if (g_verbosity->initialized)
+   {
+      g_verbosity->log_size += strlen(line);
+      if (g_verbosity->log_size >= VERBOSITY_LOG_ROTATE_SIZE)
+         verbosity_async_rotate(g_verbosity);
+   }
+}
+
+static void verbosity_async_flush_repeats(verbosity_state_t *g_verbosity,
+      struct verbosity_async_ring *ring)
+{
+   char line[64];
+
+   if (!ring->repeats)
+      return;
+
+   snprintf(line, sizeof(line),
+         "[Log]: Last message repeated %u times.\n", ring->repeats);
+   verbosity_async_write_line(g_verbosity, line);
+   ring->repeats = 0;
+}
+
+/* Writes out all filled slots. Called with the lock held */
+static void verbosity_async_drain(struct verbosity_async_ring *ring)
+{
+   verbosity_state_t *g_verbosity = &main_verbosity_st;
+   bool written                   = false;
+   uint32_t dropped;
+
+   for (;;)
+   {
+      struct verbosity_async_slot *slot =
+         &ring->slots[ring->read & (VERBOSITY_ASYNC_SLOTS - 1)];
+
+      if (VERBOSITY_LOAD32(&slot->seq) != ring->read + 1)
+         break;
+
+      /* Collapse consecutive repeats of the same line */
+      if (string_is_equal(slot->text, ring->last))
+         ring->repeats++;
+      else
+      {
+         verbosity_async_flush_repeats(g_verbosity, ring);
+         verbosity_async_write_line(g_verbosity, slot->text);
+         strlcpy(ring->last, slot->text, sizeof(ring->last));
+      }
+
+      /* Hand the slot back for the next lap */
+      (void)VERBOSITY_XCHG32(&slot->seq, ring->read + VERBOSITY_ASYNC_SLOTS);
+      ring->read++;
+      written = true;
+   }
+
+   (void)VERBOSITY_XCHG32(&ring->read_hint, ring->read);
+
+   /* Report repeats once the flood is over */
+   if (!written)
+      verbosity_async_flush_repeats(g_verbosity, ring);
+
+   if ((dropped = VERBOSITY_XCHG32(&ring->dropped, 0)))
+   {
+      char line[64];
+      verbosity_async_flush_repeats(g_verbosity, ring);
+      snprintf(line, sizeof(line),
+            "[Log]: %u messages dropped.\n", (unsigned)dropped);
+      verbosity_async_write_line(g_verbosity, line);
+      ring->last[0] = '\0';
+      written       = true;
+   }
+
+   if (written && g_verbosity->fp)
+      fflush(g_verbosity->fp);
+}
+
+static void verbosity_async_thread(void *data)
+{
+   struct verbosity_async_ring *ring = (struct verbosity_async_ring*)data;
+   verbosity_async_t *async          = &verbosity_async_st;
+
+   slock_lock(async->lock);
+   for (;;)
+   {
+      bool stop = async->stop;
+
+      verbosity_async_drain(ring);
+      if (stop)
+         break;
+      scond_wait_timeout(async->cond, async->lock,
+            VERBOSITY_ASYNC_INTERVAL);
+   }
+   verbosity_async_flush_repeats(&main_verbosity_st, ring);
+   if (main_verbosity_st.fp)
+      fflush(main_verbosity_st.fp);
+   slock_unlock(async->lock);
+}
+
+/* Formats a record into the ring without taking any lock.
+ * Returns false if asynchronous logging is not active. */
+static bool verbosity_async_push(const char *tag,
+      const char *fmt, va_list ap)
+{
+   struct verbosity_async_ring *ring;
+   verbosity_async_t *async = &verbosity_async_st;
+   bool queued              = false;
+
+   /* Counting ourselves in before looking at the ring
+    * keeps it alive until we are done with it */
+   VERBOSITY_ADD32(&async->users, 1);
+
+   if ((ring = (struct verbosity_async_ring*)
+            VERBOSITY_CASPTR(&async->ring, NULL, NULL)))
+   {
+      uint32_t pos = VERBOSITY_LOAD32(&ring->write);
+
+      for (;;)
+      {
+         struct verbosity_async_slot *slot =
+            &ring->slots[pos & (VERBOSITY_ASYNC_SLOTS - 1)];
+         int32_t diff = (int32_t)(VERBOSITY_LOAD32(&slot->seq) - pos);
+
+         if (diff == 0)
+         {
+            uint32_t prev = VERBOSITY_CAS32(&ring->write, pos, pos + 1);
+
+            if (prev == pos)
+            {
+               size_t len = strlcpy(slot->text, tag, sizeof(slot->text));
+
+               if (len + 1 < sizeof(slot->text))
+               {
+                  slot->text[len++] = ' ';
+                  vsnprintf(slot->text + len,
+                        sizeof(slot->text) - len, fmt, ap);
+               }
+               slot->text[sizeof(slot->text) - 1] = '\0';
+
+               /* Truncated lines still end the line */
+               if ((len = strlen(slot->text)) == sizeof(slot->text) - 1)
+                  slot->text[len - 1] = '\n';
+
+               (void)VERBOSITY_XCHG32(&slot->seq, pos + 1);
+
+               /* Wake the writer early once half the ring is
+                * used, unless it is busy writing already */
+               if (     pos - VERBOSITY_LOAD32(&ring->read_hint) >= VERBOSITY_ASYNC_SLOTS / 2
+                     && slock_try_lock(async->lock))
+               {
+                  scond_signal(async->cond);
+                  slock_unlock(async->lock);
+               }
+               break;
+            }
+            pos = prev;
+         }
+         /* Full, never make the caller wait */
+         else if (diff < 0)
+         {
+            VERBOSITY_ADD32(&ring->dropped, 1);
+            break;
+         }
+         else
+            pos = VERBOSITY_LOAD32(&ring->write);
+      }
+
+      queued = true;
+   }
+
+   VERBOSITY_ADD32(&async->users, -1);
+   return queued;
+}
+#endif
+
+void verbosity_set_async(bool enable)
+{
+#ifdef VERBOSITY_HAVE_ASYNC
+   verbosity_async_t *async = &verbosity_async_st;
+   struct verbosity_async_ring *ring;
+
+   if (enable == (async->ring != NULL))
+      return;
+
+   /* The lock and condition stay for the whole session,
+    * retro_main_log_file_init() may take the lock any time */
+   if (!async->lock)
+   {
+      if (!(async->lock = slock_new()))
+         return;
+   }
+   if (!async->cond && !(async->cond = scond_new()))
+      return;
+
+   if (enable)
+   {
+      uint32_t i;
+
+      if (!(ring = (struct verbosity_async_ring*)calloc(1, sizeof(*ring))))
+         return;
+      if (!(ring->slots = (struct verbosity_async_slot*)malloc(
+                  VERBOSITY_ASYNC_SLOTS * sizeof(*ring->slots))))
+      {
+         free(ring);
+         return;
+      }
+      for (i = 0; i < VERBOSITY_ASYNC_SLOTS; i++)
+         ring->slots[i].seq = i;
+
+      async->stop = false;
+      if (!(async->thread = sthread_create(verbosity_async_thread, ring)))
+      {
+         free(ring->slots);
+         free(ring);
+         return;
+      }
+
+      (void)VERBOSITY_CASPTR(&async->ring, NULL, ring);
+      return;
+   }
+
+   /* Producers seeing the ring are counted, so once none are
+    * left nobody can write to it anymore */
+   ring = (struct verbosity_async_ring*)async->ring;
+   (void)VERBOSITY_CASPTR(&async->ring, ring, NULL);
+   while (VERBOSITY_LOAD32(&async->users))
+      retro_sleep(0);
+
+   slock_lock(async->lock);
+   async->stop = true;
+   scond_signal(async->cond);
+   slock_unlock(async->lock);
+   sthread_join(async->thread);
+   async->thread = NULL;
+
+   free(ring->slots);
+   free(ring);
+#else
+   (void)enable;
+#endif
 }
 
 #if !defined(HAVE_LOGGER)
@@ -265,10 +654,11 @@ void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap)
    else
       __android_log_vprint(prio, FILE_PATH_PROGRAM_NAME, fmt, ap);
 #else
-   FILE *fp = (FILE*)g_verbosity->fp;
+   FILE *fp = NULL;
 #if defined(HAVE_QT) || defined(__WINRT__)
    char buffer[256];
    buffer[0] = '\0';
+   fp        = (FILE*)g_verbosity->fp;
 
    /* Ensure null termination and line break in error case */
    if (vsnprintf(buffer, sizeof(buffer), fmt, ap) < 0)
@@ -299,6 +689,12 @@ void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap)
    OutputDebugStringA(buffer);
 #endif
 #else
+#ifdef VERBOSITY_HAVE_ASYNC
+   /* The writer thread owns the stream meanwhile */
+   if (verbosity_async_push(tag_v, fmt, ap))
+      return;
+#endif
+   fp = (FILE*)g_verbosity->fp;
 #if defined(HAVE_LIBNX)
    mutexLock(&g_verbosity->mtx);
 #endif
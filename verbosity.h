@@ -166,6 +166,11 @@ void rarch_log_file_deinit(void);
 
 void rarch_log_file_set_override(const char *path);
 
+/* Lets a background thread do the writing, callers only
+ * format their message into a lock-free ring. Records are
+ * dropped rather than waited for when the ring is full */
+void verbosity_set_async(bool enable);
+
 
 RETRO_END_DECLS
 
@@ -37,7 +37,10 @@ enum rarch_wifi_ctl_state
    RARCH_WIFI_CTL_SET_CB,
    RARCH_WIFI_CTL_STOP,
    RARCH_WIFI_CTL_START,
-   RARCH_WIFI_CTL_INIT
+   RARCH_WIFI_CTL_INIT,
+   /* Initializes the driver if drivers_init()
+    * deferred it, must be called before first use */
+   RARCH_WIFI_CTL_INIT_DEFERRED
 };
 
 typedef struct wifi_network_info